@@ -0,0 +1,83 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_BINTRACE_H
+#define DOSBOX_BINTRACE_H
+
+/* Binary access trace. I/O port accesses, and memory accesses within one linear address range
+ * that go through a page handler, are stored as fixed size records in a ring buffer on the
+ * emulation thread. A background thread writes them to a file. Nothing is formatted on the
+ * emulation thread. If the writer falls behind, records are dropped and counted rather than
+ * stalling the emulation. scripts/bintrace-decode.py turns the file back into text.
+ *
+ * File layout: BinTraceHeader, then BinTraceRecord after BinTraceRecord in host byte order. */
+
+#define BINTRACE_MAGIC      "DBXTRACE"
+#define BINTRACE_VERSION    1u
+
+enum {
+    BINTRACE_IO_READ = 0,
+    BINTRACE_IO_WRITE,
+    BINTRACE_MEM_READ,
+    BINTRACE_MEM_WRITE
+};
+
+struct BinTraceHeader {
+    char        magic[8];       // BINTRACE_MAGIC
+    uint32_t    version;        // BINTRACE_VERSION
+    uint32_t    record_size;    // sizeof(BinTraceRecord)
+    uint32_t    byte_order;     // 0x01020304 as written by the host
+    uint32_t    reserved;
+};
+
+struct BinTraceRecord {
+    double      time;           // emulated time in ms (PIC_FullIndex)
+    uint32_t    addr;           // I/O port, or linear address for memory
+    uint32_t    value;
+    uint32_t    eip;
+    uint16_t    cs;
+    uint8_t     kind;           // BINTRACE_*
+    uint8_t     width;          // access size in bytes
+};
+
+extern bool bintrace_io;
+extern bool bintrace_mem;
+extern uint32_t bintrace_mem_base;
+extern uint32_t bintrace_mem_size;
+
+void BINTRACE_Record(uint8_t kind,uint8_t width,uint32_t addr,uint32_t value);
+
+/* mem_size == 0 disables memory tracing */
+bool BINTRACE_Start(const char *path,bool io,uint32_t mem_base,uint32_t mem_size);
+void BINTRACE_Stop(void);
+bool BINTRACE_Running(void);
+void BINTRACE_GetStats(uint64_t &records,uint64_t &dropped);
+bool BINTRACE_ParseRange(const char *s,uint32_t &base,uint32_t &size);
+void BINTRACE_Init(void);
+
+static INLINE void BINTRACE_IO(const bool write,const uint8_t width,const Bitu port,const uint32_t val) {
+    if (GCC_UNLIKELY(bintrace_io))
+        BINTRACE_Record(write ? BINTRACE_IO_WRITE : BINTRACE_IO_READ,width,(uint32_t)port,val);
+}
+
+static INLINE void BINTRACE_Mem(const bool write,const uint8_t width,const uint32_t addr,const uint32_t val) {
+    if (GCC_UNLIKELY(bintrace_mem) && (uint32_t)(addr - bintrace_mem_base) < bintrace_mem_size)
+        BINTRACE_Record(write ? BINTRACE_MEM_WRITE : BINTRACE_MEM_READ,width,addr,val);
+}
+
+#endif
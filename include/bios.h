@@ -246,6 +246,8 @@ extern RegionAllocTracking rombios_alloc;
 void BIOS_ZeroExtendedSize(bool in);
 
 bool BIOS_AddKeyToBuffer(uint16_t code);
+/* keys BIOS_AddKeyToBuffer can still take, 0 while paused */
+unsigned int BIOS_KeyboardBufferFree(void);
 
 void INT10_ReloadRomFonts();
 
@@ -19,6 +19,9 @@
 #ifndef DOSBOX_BIOS_DISK_H
 #define DOSBOX_BIOS_DISK_H
 
+#include <list>
+#include <unordered_map>
+#include <vector>
 #include "dos_inc.h"
 #include "logging.h"
 #include "../src/dos/cdrom.h"
@@ -27,6 +30,10 @@
 #define BIOS_MAX_DISK 10
 
 #define MAX_SWAPPABLE_DISKS 20
+
+/* Size of the blocks kept by the imageDisk sector cache. Every miss reads a whole block,
+ * which doubles as read-ahead of the sectors that follow. */
+#define IMAGE_CACHE_BLOCK 8192u
 struct diskGeo {
 	uint32_t ksize;  /* Size in kilobytes */
 	uint16_t secttrack; /* Sectors per track */
@@ -81,13 +88,18 @@ class imageDisk {
 			ID_D88,
 			ID_NFD,
 			ID_EMPTY_DRIVE,
-			ID_INT13
+			ID_INT13,
+			ID_CHD
 		};
 
 		virtual uint8_t Read_Sector(uint32_t head,uint32_t cylinder,uint32_t sector,void * data,unsigned int req_sector_size=0);
 		virtual uint8_t Write_Sector(uint32_t head,uint32_t cylinder,uint32_t sector,const void * data,unsigned int req_sector_size=0);
 		virtual uint8_t Read_AbsoluteSector(uint32_t sectnum, void * data);
 		virtual uint8_t Write_AbsoluteSector(uint32_t sectnum, const void * data);
+		/* Transfer count consecutive sectors. The default loops over the single sector
+		 * functions above, formats that can do better (raw, VHD, QCow2, memory) override them. */
+		virtual uint8_t Read_AbsoluteSectors(uint32_t sectnum, uint32_t count, void * data);
+		virtual uint8_t Write_AbsoluteSectors(uint32_t sectnum, uint32_t count, const void * data);
 
 		virtual void UpdateFloppyType(void);
 		virtual void Set_Reserved_Cylinders(Bitu resCyl);
@@ -101,6 +113,8 @@ class imageDisk {
 		imageDisk(FILE* diskimg, const char* diskName, uint32_t cylinders, uint32_t heads, uint32_t sectors, uint32_t sector_size, bool hardDrive);
 		virtual ~imageDisk();
 		void Set_GeometryForHardDisk();
+		void FlushCache(bool discard=false);
+		void UnmapImage(void);
 		struct fatFromDOSDrive* ffdd = NULL;
 		unsigned int drvnum = DOS_DRIVES;
 
@@ -132,6 +146,40 @@ class imageDisk {
 		std::vector<bool> partition_in_use; /* used by FAT driver to prevent mounting a partition twice */
 		uint64_t current_fpos = 0;
 
+		/* LRU cache of image file blocks ("disk image cache size"), used by the base class
+		 * Read_AbsoluteSector() and Write_AbsoluteSector() only. Writes are kept in the cache
+		 * and written back on eviction, FlushCache() or when the disk is destroyed, unless the
+		 * image file is read-only: then writes bypass the cache and fail as before. */
+		struct cacheBlock {
+			uint64_t offset = 0;    /* file offset of the block */
+			uint32_t length = 0;    /* bytes actually read, short at the end of the image */
+			bool dirty = false;
+			std::vector<uint8_t> data;
+		};
+		std::list<cacheBlock> cache_lru; /* most recently used first */
+		std::unordered_map<uint64_t,std::list<cacheBlock>::iterator> cache_index;
+
+		bool cacheEnabled(void);
+		cacheBlock *cacheLookup(uint64_t bytenum);
+		bool cacheWriteBack(cacheBlock &blk);
+		bool cacheWritable(void);
+		int8_t cache_writable = -1; /* -1 until the file access mode has been checked */
+
+		/* Raw images can instead be memory-mapped ("disk image mmap"), in which case the
+		 * base class reads and writes sectors straight from the mapping. The mapping is
+		 * set up on first access and covers the image file up to image_base + image_length. */
+		enum { MAP_UNTRIED=0, MAP_ACTIVE, MAP_UNAVAILABLE } map_state = MAP_UNTRIED;
+		uint8_t *mapped = NULL;
+		uint64_t mapped_size = 0;
+		bool mapped_writable = false;
+		bool mapped_dirty = false;
+		void *mapped_handle = NULL; /* Windows file mapping object */
+		uint32_t mapped_next_sect = 0; /* for detecting sequential scans */
+		uint32_t mapped_run = 0;
+
+		bool MapImage(void);
+		void MapAdviseSequential(uint32_t sectnum, uint64_t bytenum);
+
 	public:
 		int Addref() {
 			return ++refcount;
@@ -284,6 +332,7 @@ class imageDiskMemory : public imageDisk {
 public:
 	uint8_t Read_AbsoluteSector(uint32_t sectnum, void * data) override;
 	uint8_t Write_AbsoluteSector(uint32_t sectnum, const void * data) override;
+	uint8_t Read_AbsoluteSectors(uint32_t sectnum, uint32_t count, void * data) override;
 	uint8_t GetBiosType(void) override;
 	void Set_Geometry(uint32_t setHeads, uint32_t setCyl, uint32_t setSect, uint32_t setSectSize) override;
 	// Partition and format the ramdrive
@@ -299,8 +348,16 @@ public:
 	imageDiskMemory(imageDisk* underlyingImage);
 	virtual ~imageDiskMemory();
 
+	// Write the chunks changed since the last commit back to the underlying image
+	uint8_t Commit();
+	// Commit when released, and if interval_ms is not zero, also every interval_ms milliseconds
+	void SetCommitMode(bool commit_on_release, uint32_t interval_ms);
+	// Parse an overlay mode: "discard", "commit", or a commit interval in seconds
+	static bool ParseOverlayMode(const std::string& mode, bool* commit_on_release, uint32_t* interval_ms);
+
 private:
 	void init(diskGeo diskParams, bool isHardDrive, imageDisk* underlyingImage);
+	static void CommitEvent(Bitu val);
 	bool CalculateFAT(uint32_t partitionStartingSector, uint32_t partitionLength, bool isHardDrive, uint32_t rootEntries, uint32_t* rootSectors, uint32_t* sectorsPerCluster, bool* isFat16, uint32_t* fatSectors, uint32_t* reservedSectors);
 
 	uint8_t * * ChunkMap;
@@ -309,6 +366,10 @@ private:
 	uint32_t total_chunks;
     uint32_t total_sectors = 0;
     imageDisk* underlyingImage = NULL;
+	std::vector<bool> dirty_chunks;
+	bool commit_on_release = false;
+	uint32_t commit_interval_ms = 0;
+	double next_commit = 0;
 
 	diskGeo floppyInfo;
 };
@@ -380,6 +441,8 @@ public:
     VHDTypes vhdType = VHD_TYPE_NONE;
 	uint8_t Read_AbsoluteSector(uint32_t sectnum, void * data) override;
 	uint8_t Write_AbsoluteSector(uint32_t sectnum, const void * data) override;
+	uint8_t Read_AbsoluteSectors(uint32_t sectnum, uint32_t count, void * data) override;
+	uint8_t Write_AbsoluteSectors(uint32_t sectnum, uint32_t count, const void * data) override;
 	static ErrorCodes Open(const char* fileName, const bool readOnly, imageDisk** disk);
 	static VHDTypes GetVHDType(const char* fileName);
 	VHDTypes GetVHDType(void) const;
@@ -394,6 +457,7 @@ public:
     static void DetectGeometry(uint8_t* buf, Bitu sizes[], uint64_t currentSize);
     static uint64_t scanMBR(uint8_t* mbr, Bitu sizes[], uint64_t disksize=0);
     bool MergeSnapshot(uint32_t* totalSectorsMerged, uint32_t* totalBlocksUpdated);
+    static uint32_t Flatten(const char* filename, const char* newname, uint32_t* totalBlocksCopied);
     static void SizeToCHS(uint64_t size, uint16_t* c, uint8_t* h, uint8_t* s);
     bool UpdateUUID();
     static void mk_uuid(uint8_t* buf);
@@ -407,6 +471,19 @@ private:
 		uint32_t reserved;
 		uint64_t platformDataOffset;
 	};
+	struct BlockBitmap {
+		uint32_t block;
+		std::vector<uint8_t> map;
+	};
+	//a run of sectors resolved to the layer of a differencing chain that holds them
+	struct SectorExtent {
+		uint32_t sector;
+		uint32_t count;
+		imageDiskVHD* layer;	//NULL if no layer holds the sectors (they read as zeros)
+		uint64_t offset;		//file offset of the first sector in a dynamic layer
+	};
+	static const size_t bitmapCacheBlocks = 256;
+	static const size_t extentCacheSize = 64;
 	struct DynamicHeader {
 		char cookie[8];
 		uint64_t dataOffset;
@@ -435,6 +512,8 @@ private:
 	static bool convert_UTF16_for_fopen(std::string &string, const void* data, const uint32_t dataLength);
     bool is_zeroed_sector(const void* data);
 	bool is_block_allocated(uint32_t blockNumber);
+	bool ResolveExtent(uint32_t sectnum, uint32_t count, SectorExtent& extent);
+	void InvalidateExtents();
 
     imageDisk* parentDisk = NULL;
     imageDisk* fixedDisk = NULL;
@@ -449,7 +528,33 @@ private:
 	uint32_t currentBlock = 0xFFFFFFFF;
     bool currentBlockAllocated = false;
 	uint32_t currentBlockSectorOffset = 0;
-	uint8_t* currentBlockDirtyMap = nullptr;
+	uint8_t* currentBlockDirtyMap = nullptr;	//points into bitmapCache
+	std::vector<uint32_t> blockTable;			//the BAT, in host byte order
+	std::list<BlockBitmap> bitmapCache;			//most recently used first
+	std::vector<SectorExtent> extentCache;
+	size_t extentCacheNext = 0;
+};
+
+struct _chd_file;
+class CHDHunkCache;
+
+/* MAME CHD hard disk image, read through libchdr. The format is read only, mount it
+ * with IMGMOUNT -overlay to let the guest write to it. */
+class imageDiskCHD : public imageDisk {
+public:
+	uint8_t Read_AbsoluteSector(uint32_t sectnum, void * data) override;
+	uint8_t Write_AbsoluteSector(uint32_t sectnum, const void * data) override;
+	uint8_t Read_AbsoluteSectors(uint32_t sectnum, uint32_t count, void * data) override;
+	uint8_t Write_AbsoluteSectors(uint32_t sectnum, uint32_t count, const void * data) override;
+	/* NULL if the file cannot be opened or is not a hard disk CHD */
+	static imageDiskCHD* Open(const char* fileName);
+	virtual ~imageDiskCHD();
+
+private:
+	imageDiskCHD(_chd_file* chd, const char* fileName);
+
+	_chd_file* chd = NULL;
+	CHDHunkCache* hunks = NULL;
 };
 
 /* C++ class implementing El Torito floppy emulation */
@@ -586,6 +691,9 @@ extern uint16_t imgDTASeg; /* Real memory location of temporary DTA pointer for
 extern RealPt imgDTAPtr; /* Real memory location of temporary DTA pointer for fat image disk access */
 extern DOS_DTA *imgDTA;
 
+/* guest data moved by DOS file I/O on non-device handles, INT 13h and IDE, for QMP query-perf */
+extern uint64_t disk_io_bytes_read, disk_io_bytes_written;
+
 void swapInDisks(int drive);
 bool getSwapRequest(void);
 imageDisk *GetINT13HardDrive(unsigned char drv);
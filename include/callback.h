@@ -59,6 +59,12 @@ static inline PhysPt CALLBACK_GetBase(void) {
 
 uint8_t CALLBACK_Allocate();
 
+/* Called by the CPU core right after INT n. If the vector led to one of our own callback stubs,
+ * does what the stub's STI and callback instruction would and returns the callback number for
+ * the core to hand back, saving the fetch and decode of the stub. 0 means CS:IP is elsewhere
+ * (the vector is hooked) and the code there runs as usual. */
+Bitu CALLBACK_DirectDispatch(void);
+
 void CALLBACK_Idle(void);
 
 
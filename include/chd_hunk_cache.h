@@ -0,0 +1,80 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_CHD_HUNK_CACHE_H
+#define DOSBOX_CHD_HUNK_CACHE_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "threadpool.h"
+
+struct _chd_file;
+
+/* Decompressed hunks of one CHD file, shared by CD-ROM images (CDROM_Interface_Image::CHDFile)
+ * and CHD hard disk images (imageDiskCHD). Hunks are kept in an LRU list of "chd cache size" KB.
+ * After every access the next "chd prefetch hunks" hunks are decompressed ahead on the worker
+ * pool. libchdr handles are not thread safe, so the caller's handle is only used on the calling
+ * thread and each prefetch task borrows a handle of its own, opened on demand. */
+class CHDHunkCache {
+public:
+    CHDHunkCache(_chd_file *chd, const char *filename);
+    ~CHDHunkCache();
+
+    CHDHunkCache(const CHDHunkCache&) = delete;
+    CHDHunkCache& operator=(const CHDHunkCache&) = delete;
+
+    /* data of the hunk, NULL on error. Valid until the next call. */
+    const uint8_t*  GetHunk(uint32_t hunk);
+    uint32_t        HunkBytes(void) const { return hunk_bytes; }
+    uint32_t        TotalHunks(void) const { return total_hunks; }
+private:
+    enum HunkState { HUNK_PENDING, HUNK_READY, HUNK_ERROR };
+
+    struct Hunk {
+        uint32_t                index = 0;
+        HunkState               state = HUNK_PENDING;   // protected by lock while a prefetch task owns the hunk
+        std::vector<uint8_t>    data;
+    };
+
+    std::list<Hunk>::iterator Allocate(uint32_t hunk, bool prefetched);
+    void            Prefetch(uint32_t hunk);
+    void            PrefetchTask(Hunk *hunk);
+
+    _chd_file*      chd;                // caller's handle, calling thread only
+    std::string     filename;
+    uint32_t        hunk_bytes;
+    uint32_t        total_hunks;
+    size_t          capacity;           // hunks
+    unsigned int    prefetch;           // hunks
+
+    std::list<Hunk> lru;                // most recently used first, changed by the calling thread only
+    std::unordered_map<uint32_t,std::list<Hunk>::iterator> index;
+
+    std::mutex                  lock;
+    std::condition_variable     loaded;
+    std::vector<_chd_file*>     spare;  // handles for prefetch tasks, protected by lock
+    ThreadPoolGroup             tasks;
+};
+
+#endif
@@ -22,6 +22,8 @@
 
 #include "regs.h"
 
+#include <vector>
+
 #define CPU_AUTODETERMINE_NONE		0x00
 #define CPU_AUTODETERMINE_CORE		0x01
 #define CPU_AUTODETERMINE_CYCLES	0x02
@@ -64,12 +66,39 @@ extern cpu_cycles_count_t CPU_CyclePercUsed;
 extern cpu_cycles_count_t CPU_CycleLimit;
 extern cpu_cycles_count_t CPU_IODelayRemoved;
 extern cpu_cycles_count_t CPU_CyclesSet;
+extern uint64_t CPU_CyclesTotal;            /* cycles handed to the cores since startup, CPU_CycleMax per tick */
 extern unsigned char CPU_AutoDetermineMode;
 extern char core_mode[16];
 
 extern bool CPU_CycleAutoAdjust;
 extern bool CPU_SkipCycleAutoAdjust;
 
+/* Cycle governor for cycles=auto/max: sizes CPU_CycleMax from the measured host time
+ * spent emulating, rendering and mixing instead of guessing it from the time slept */
+enum CPU_GovernorMode_t {
+    CPU_GOVERNOR_OFF=0,
+    CPU_GOVERNOR_SHARE,         /* host time used stays at a share of real time */
+    CPU_GOVERNOR_DEADLINE       /* work of every video frame stays within a share of the frame period */
+};
+
+enum {
+    CPU_GOVERNOR_RENDER=0,
+    CPU_GOVERNOR_AUDIO
+};
+
+extern CPU_GovernorMode_t CPU_GovernorMode;
+extern cpu_cycles_count_t CPU_GovernorTarget;  /* percent of real time */
+
+uint64_t CPU_Governor_Clock(void);                              /* host time in ns */
+void CPU_Governor_Account(unsigned int what,uint64_t start);   /* add host time spent since start */
+void CPU_Governor_FrameEnd(void);
+void CPU_Governor_Reset(void);
+
+/* Idle detection: BIOS and device code report polls that found nothing new */
+extern bool CPU_IdleDetect;
+void CPU_IdlePoll(void);        /* guest polled and got nothing (no key, empty keyboard controller, same tick) */
+void CPU_IdleProgress(void);    /* guest got what it was polling for */
+
 extern bool enable_weitek;
 
 extern unsigned char CPU_ArchitectureType;
@@ -107,6 +136,7 @@ Bits CPU_Core8086_Prefetch_Run(void);
 #if defined(C_HAVE_LINUX_KVM_X86)
 Bits CPU_Core_KVM_Run(void);
 Bits CPU_Core_KVM_Trap_Run(void);
+bool CPU_Core_KVM_Init(void);
 #endif
 
 void CPU_Enable_SkipAutoAdjust(void);
@@ -123,8 +153,14 @@ bool CPU_LLDT(Bitu selector);
 bool CPU_LTR(Bitu selector);
 void CPU_LIDT(Bitu limit,Bitu base);
 void CPU_LGDT(Bitu limit,Bitu base);
+/* Descriptors read from the GDT and LDT are cached by linear address. The tables are watched by
+ * the paging code (PAGING_SetDescriptorWatch), which flushes the cache on writes to them. */
+void CPU_DescriptorCacheFlush(void);
+void CPU_DescriptorCacheWatch(void);
 
 Bitu CPU_STR(void);
+void CPU_STR_Get(Bitu &selector,PhysPt &base,Bitu &limit,bool &is386);
+void CPU_STR_Set(Bitu selector,PhysPt base,Bitu limit,bool is386);
 Bitu CPU_SLDT(void);
 Bitu CPU_SIDT_base(void);
 Bitu CPU_SIDT_limit(void);
@@ -388,6 +424,8 @@ public:
 	Descriptor() { saved.fill[0]=saved.fill[1]=0; }
 
 	void Load(LinearPt address);
+	/* Load, through the descriptor cache */
+	void LoadCached(LinearPt address);
 	void Save(LinearPt address);
 
 	LinearPt GetBase (void) const {
@@ -494,11 +532,11 @@ public:
 		Bitu address=selector & ~7U;
 		if (selector & 4U) {
 			if (address>=ldt_limit) return false;
-			desc.Load((LinearPt)(ldt_base+address));
+			desc.LoadCached((LinearPt)(ldt_base+address));
 			return true;
 		} else {
 			if (address>=table_limit) return false;
-			desc.Load((LinearPt)(table_base+address));
+			desc.LoadCached((LinearPt)(table_base+address));
 			return true;
 		}
 	}
@@ -517,6 +555,18 @@ public:
 	Bitu SLDT(void) const {
 		return ldt_value;
 	}
+	LinearPt GetLDTBase(void) const {
+		return ldt_base;
+	}
+	Bitu GetLDTLimit(void) const {
+		return ldt_limit;
+	}
+	/* load the LDT register without reading the descriptor, for cores that keep their own copy */
+	void SetLDT(Bitu value,LinearPt base,Bitu limit) {
+		ldt_value=value;
+		ldt_base=base;
+		ldt_limit=limit;
+	}
 	bool LLDT(Bitu value) {
 		if ((value&0xfffc)==0) {
 			ldt_value=0;
@@ -620,7 +670,7 @@ enum dyncore_alloc_t {
     DYNCOREALLOC_NONE=0,
     DYNCOREALLOC_MALLOC,            /* allocated with malloc(), base pointer and size rounded up to page size */
     DYNCOREALLOC_MMAP_ANON,         /* allocated with mmap() and MAP_ANONYMOUS|MAP_PRIVATE */
-    DYNCOREALLOC_SHM_MMAP,          /* allocated as a file in shared memory (i.e. /dev/shm) using shmget */
+    DYNCOREALLOC_SHM_MMAP,          /* allocated as an unnamed POSIX shared memory object (shm_open) */
     DYNCOREALLOC_MEMFD,             /* allocated with a Linux memfd handle */
     DYNCOREALLOC_VIRTUALALLOC,      /* allocated with VirtualAlloc() (in Windows) */
 
@@ -650,4 +700,46 @@ extern dyncore_method_t     dyncore_method;
 int64_t CPU_RDTSC();
 void RDTSC_rebase();
 
+/* dynamic recompiler (core_dynrec) hot-block profiler */
+struct DynrecProfileEntry {
+    uint32_t    lin_addr = 0;       /* linear address of the first guest instruction */
+    uint32_t    eip = 0;
+    uint16_t    cs = 0;
+    uint16_t    length = 0;         /* guest code bytes covered by the block (within the first page) */
+    uint64_t    execs = 0;          /* block executions, counted by the translated code itself */
+    uint64_t    entries = 0;        /* times the dispatcher entered the block (start of a linked chain) */
+    uint64_t    host_ns = 0;        /* host time spent in block chains entered through this block */
+    uint32_t    translations = 0;   /* times the code at this address was (re)translated */
+};
+
+struct DynrecProfileSummary {
+    bool        enabled = false;
+    uint64_t    exec_ns = 0;        /* host time spent in translated code */
+    uint64_t    lookup_ns = 0;      /* host time spent finding/linking blocks */
+    uint64_t    translate_ns = 0;   /* host time spent translating guest code */
+    uint64_t    invalidate_ns = 0;  /* host time spent invalidating blocks on code page writes */
+    uint64_t    lookups = 0;
+    uint64_t    translations = 0;
+    uint64_t    invalidations = 0;  /* blocks thrown away due to self-modifying code */
+    uint64_t    page_flushes = 0;   /* code pages evicted to make room in the cache */
+    uint64_t    invalidations_per_sec = 0; /* blocks invalidated during the last second of emulated time, always counted */
+};
+
+/* dynamic recompiler code cache occupancy, always collected */
+struct DynrecCacheStats {
+    uint32_t    pages_used = 0;     /* guest code pages with translated blocks */
+    uint32_t    pages_total = 0;    /* code pages the cache can hold */
+    uint64_t    page_flushes = 0;   /* code pages evicted to make room in the cache */
+    uint64_t    wraps = 0;          /* times translation restarted at the start of the code cache */
+    uint64_t    resets = 0;         /* times the whole cache was thrown away */
+};
+
+bool CPU_Core_Dynrec_GetCacheStats(DynrecCacheStats &st);
+void CPU_Core_Dynrec_Profile_Enable(bool enable);
+void CPU_Core_Dynrec_Profile_Reset(void);
+/* runs handler on the emulation thread the next time the dynamic core is entered */
+void CPU_Core_Dynrec_Profile_Collect(void (*handler)(void));
+/* reads the block table, main (emulation) thread only */
+bool CPU_Core_Dynrec_Profile_Get(DynrecProfileSummary &summary,std::vector<DynrecProfileEntry> &top,size_t count,bool by_execs);
+
 #endif
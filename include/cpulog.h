@@ -0,0 +1,68 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_CPULOG_H
+#define DOSBOX_CPULOG_H
+
+#include <string>
+#include <vector>
+
+/* Binary CPU log (debugger command LOGB). The heavy debugger stores the registers and the
+ * instruction bytes of every executed instruction as a fixed size record in a ring buffer, a
+ * background thread writes them to the file. Nothing is disassembled or formatted while the
+ * guest runs. When the writer falls behind the emulation waits for it, the log has no holes.
+ * dosbox-x -decodecpulog turns the file into the text of the LOGL command.
+ *
+ * File layout: CpuLogHeader, then CpuLogRecord after CpuLogRecord in host byte order. */
+
+#define CPULOG_MAGIC        "DBXCPULG"
+#define CPULOG_VERSION      1u
+
+struct CpuLogHeader {
+    char        magic[8];       // CPULOG_MAGIC
+    uint32_t    version;        // CPULOG_VERSION
+    uint32_t    record_size;    // sizeof(CpuLogRecord)
+    uint32_t    byte_order;     // 0x01020304 as written by the host
+    uint32_t    reserved;
+};
+
+struct CpuLogRecord {
+    uint64_t    count;          // instructions executed (cycle_count)
+    uint32_t    eip;
+    uint32_t    eax,ebx,ecx,edx,esi,edi,ebp,esp;
+    uint32_t    flags;          // with the lazy flags filled in
+    uint32_t    cr0;
+    uint32_t    cs_base;        // linear address of CS:0
+    uint16_t    cs,ds,es,fs,gs,ss;
+    uint8_t     code_big;       // 32-bit code segment
+    uint8_t     length;         // valid bytes in code, less at the end of mapped memory
+    uint8_t     code[16];       // bytes from CS:EIP on, enough for the longest instruction
+    uint8_t     reserved[2];
+};
+
+bool CPULOG_Start(const char *path);
+void CPULOG_Stop(void);
+bool CPULOG_Running(void);
+/* the instruction at CS:EIP, called from the heavy debugger before it runs */
+void CPULOG_Record(void);
+
+/* offline: disassemble the file to stdout. Filters, all optional:
+ *   cs=XXXX  eip=LO-HI  lin=LO-HI (hex)  match=TEXT (in the disassembly)  from=N  count=N (records) */
+bool CPULOG_Decode(const std::string &path,const std::vector<std::string> &filters);
+
+#endif
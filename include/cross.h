@@ -21,7 +21,9 @@
 #define DOSBOX_CROSS_H
 
 #include <stdio.h>
+#include <stdint.h>
 #include <string>
+#include <vector>
 
 #if defined (_MSC_VER)						/* MS Visual C++ */
 #include <direct.h>
@@ -128,6 +130,23 @@ bool read_directory_next(dir_information* dirp, char* entry_name, char* entry_sn
 
 void close_directory(dir_information* dirp);
 
+/* Host directory change notification (inotify, kqueue or ReadDirectoryChangesW).
+ * Directories are watched one by one under an id chosen by the caller. read_dir_watch() does not
+ * block, it appends the ids of watched directories whose entries changed since the last call and
+ * returns false if the host dropped events, in which case anything may have changed. */
+typedef struct dir_watch_struct dir_watch_information;
+
+dir_watch_information* open_dir_watch(void);
+bool add_dir_watch(dir_watch_information* watch, const char* dirname, uint32_t id);
+#if defined (WIN32)
+bool add_dir_watchw(dir_watch_information* watch, const wchar_t* dirname, uint32_t id);
+#else
+#define add_dir_watchw add_dir_watch
+#endif
+void remove_dir_watch(dir_watch_information* watch, uint32_t id);
+bool read_dir_watch(dir_watch_information* watch, std::vector<uint32_t>& changed);
+void close_dir_watch(dir_watch_information* watch);
+
 FILE* fopen_wrap(const char* path, const char* mode);
 
 const char* get_time(void);
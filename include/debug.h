@@ -36,6 +36,16 @@ void DEBUG_Continue();
 bool DEBUG_SetBreakpoint(uint32_t address);
 bool DEBUG_RemoveBreakpoint(uint32_t address);
 bool DEBUG_SaveMemoryBin(const char* filepath, uint32_t address, uint32_t size);
+// Breakpoints by linear address that the normal and the dynamic core check without heavy debugging,
+// and write watchpoints the TLB traps (see PAGING_AddWriteWatch)
+extern bool debug_exec_breakpoints;
+bool DEBUG_IsExecBreakpoint(uint32_t linear);
+bool DEBUG_ExecBreakpointHit(Bitu linear);   // the instruction at linear is about to run
+bool DEBUG_AddExecBreakpoint(uint32_t linear);
+bool DEBUG_RemoveExecBreakpoint(uint32_t linear);
+void DEBUG_ClearExecBreakpoints(void);
+bool DEBUG_AddWatchpoint(uint32_t address, uint32_t len);
+bool DEBUG_RemoveWatchpoint(uint32_t address, uint32_t len);
 #if C_REMOTEDEBUG
 void DEBUG_StartGDBServer(int port);
 void DEBUG_StopGDBServer();
@@ -144,7 +144,9 @@ class DmaChannel {
 			request=false;
 		}
 		Bitu Read(Bitu want, uint8_t * buffer);
+		Bitu ReadSpan(Bitu want, const uint8_t * &span);
 		Bitu Write(Bitu want, uint8_t * buffer);
+		bool AdvanceTransfer(Bitu cando);
 
 		void SaveState( std::ostream& stream );
 		void LoadState( std::istream& stream );
@@ -100,12 +100,17 @@ bool MEM_unmap_physmem(Bitu start,Bitu end);
 bool MEM_map_RAM_physmem(Bitu start,Bitu end);
 bool MEM_map_ROM_physmem(Bitu start,Bitu end);
 
+/* packed_length != 0: data holds that many bytes of gzip stream, expanded to length bytes the
+ * first time the file is opened (BuiltinFileBlob_Data) */
 struct BuiltinFileBlob {
 	const char		*recommended_file_name;
 	const unsigned char	*data;
 	size_t			length;
+	size_t			packed_length;
 };
 
+const unsigned char *BuiltinFileBlob_Data(const struct BuiltinFileBlob &b);
+
 struct DOS_Date {
 	uint16_t year;
 	uint8_t month;
@@ -24,6 +24,11 @@
 #include "string.h"
 #include "support.h"
 #include "mem.h"
+#include "hostmem.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #define DOS_NAMELENGTH 12u
 #define DOS_NAMELENGTH_ASCII (DOS_NAMELENGTH+1)
@@ -189,10 +194,23 @@ public:
 	void FlagReadOnlyMedium(void);
 	void Flush(void) override;
 	uint32_t GetSeekPos(void) override;
-	FILE * fhandle;
+	bool FlushBuffer(void);
+	void DisableBuffering(void);
+	FILE * fhandle = nullptr;
 private:
+	bool BufferActive(void);
+	bool WriteBack(void);
+	int64_t HostFileSize(void);
 	bool read_only_medium = false;
 	enum { NONE,READ,WRITE } last_action;
+	/* Read-ahead / write-behind window over the host file. While buf_active is set,
+	 * file_pos is the DOS file pointer and the stdio position is meaningless. */
+	std::vector<uint8_t> buffer;
+	bool buf_active = false;
+	bool unbuffered = false;
+	uint32_t file_pos = 0;
+	uint32_t buf_start = 0, buf_len = 0;
+	uint32_t dirty_start = 0, dirty_end = 0;
 };
 
 /* The following variable can be lowered to free up some memory.
@@ -219,8 +237,9 @@ public:
 	char*		GetExpandName		(const char* path);
 	bool		GetShortName		(const char* fullname, char* shortname);
 
-	bool		FindFirst			(char* path, uint16_t& id);
+	bool		FindFirst			(char* path, uint16_t& id, const char* pattern = NULL);
     bool        FindNext            (uint16_t id, char* &result, char* &lresult);
+	const char*	FindDirPath			(uint16_t id);
 
 	void		CacheOut			(const char* path, bool ignoreLastDir = false);
 	void		AddEntry			(const char* path, bool checkExists = false);
@@ -238,22 +257,31 @@ public:
 			orgname[0] = shortname[0] = 0;
 			isOverlayDir = isDir = false;
 			nextEntry = shortNr = 0;
+			HOSTMEM_Count(HOSTMEM_DRIVECACHE,(int64_t)hostBytes());
 		}
 		~CFileInfo(void) {
 			for (uint32_t i=0; i<fileList.size(); i++) delete fileList[i];
 			fileList.clear();
-			longNameList.clear();
+			HOSTMEM_Count(HOSTMEM_DRIVECACHE,-(int64_t)hostBytes());
 		};
+		// the entry, and about 64 bytes for each of its nodes in the indexes of its directory
+		static size_t hostBytes(void) { return sizeof(CFileInfo) + 4 * 64; }
 		char		orgname		[CROSS_LEN];
 		char		shortname	[DOS_NAMELENGTH_ASCII];
 		bool        isOverlayDir;
 		bool		isDir;
 		uint16_t		id = MAX_OPENDIRS;
+		uint32_t	watchId = 0;		// host change notification id, 0 = not watched
 		Bitu		nextEntry;
 		Bitu		shortNr;
 		// contents
 		std::vector<CFileInfo*>	fileList;
-		std::vector<CFileInfo*>	longNameList;
+		// hash indexes over fileList, so lookups in huge host directories don't have to walk it
+		std::unordered_map<std::string,CFileInfo*>	shortNameIndex;		// shortname -> entry
+		std::unordered_map<std::string,CFileInfo*>	longNameIndex;		// orgname -> entry
+		std::unordered_map<std::string,CFileInfo*>	longNameIndexNoCase;	// case folded orgname -> entry
+		std::unordered_set<std::string>			shortNameStems;		// generated "NAME~N", without extension
+		std::unordered_map<std::string,Bitu>		shortNrNext;		// 8 char base -> next ~N to try
 	};
 
 private:
@@ -262,16 +290,21 @@ private:
 
 	bool		RemoveTrailingDot	(char* shortname);
 	Bits		GetLongName		(CFileInfo* curDir, char* shortName);
+	CFileInfo*	FindLongName		(CFileInfo* curDir, char* shortName);
 	void		CreateShortName		(CFileInfo* curDir, CFileInfo* info);
 	Bitu		CreateShortNameID	(CFileInfo* curDir, const char* name);
-	int		CompareShortname	(const char* compareName, const char* shortName);
+	void		IndexEntry		(CFileInfo* dir, CFileInfo* info);
+	void		ClearIndexes		(CFileInfo* dir);
+	void		RemoveEntry		(CFileInfo* dir, CFileInfo* info);
+	void		WatchDir		(CFileInfo* dir, const char* path);
+	void		ProcessHostChanges	(void);
+	void		RefreshDir		(CFileInfo* dir, const char* path);
     bool        SetResult       (CFileInfo* dir, char * &result, char * &lresult, Bitu entryNr);
 	bool		IsCachedIn		(CFileInfo* curDir);
 	CFileInfo*	FindDirInfo		(const char* path, char* expandedPath);
 	bool		RemoveSpaces		(char* str);
 	bool		OpenDir			(CFileInfo* dir, const char* expand, uint16_t& id);
     char*       CreateEntry     (CFileInfo* dir, const char* name, const char* sname, bool is_directory, bool skipSort=false);
-	void		CopyEntry		(CFileInfo* dir, CFileInfo* from);
 	uint16_t		GetFreeID		(CFileInfo* dir);
 	void		Clear			(void);
 
@@ -285,14 +318,31 @@ private:
 	char		save_path			[CROSS_LEN] = {};
 	char		save_expanded		[CROSS_LEN] = {};
 
+	// what FindFirst found, so that FindNext only has to step through it: the entries
+	// matching the search pattern in output order, packed as "shortname\0longname\0"
+	struct FindSnapshot {
+		std::vector<char>	names;
+		std::vector<uint32_t>	entries;	// offset of each short name in names
+		size_t			next = 0;
+		std::string		dirPath;	// expanded host directory, ends with CROSS_FILESPLIT
+	};
+
 	uint16_t		srchNr;
 	CFileInfo*	dirSearch			[MAX_OPENDIRS];
 	char		dirSearchName		[MAX_OPENDIRS] = {};
-	CFileInfo*	dirFindFirst		[MAX_OPENDIRS];
+	FindSnapshot*	dirFindFirst		[MAX_OPENDIRS];
 	uint16_t		nextFreeFindFirst;
 
 	char		label				[CROSS_LEN];
 	bool		updatelabel;
+
+	// watched directories (by watchId) and the expanded path they were cached in from
+	struct WatchedDir {
+		CFileInfo*	dir;
+		std::string	path;
+	};
+	std::unordered_map<uint32_t,WatchedDir>	watchDirs;
+	uint32_t	nextWatchId = 1;
 };
 
 class DOS_Drive {
@@ -332,6 +382,10 @@ public:
 	virtual void closedir(void *handle) { (void)handle; };
     virtual bool read_directory_first(void *handle, char* entry_name, char* entry_sname, bool& is_directory) { (void)handle; (void)entry_name; (void)entry_sname; (void)is_directory; return false; };
     virtual bool read_directory_next(void *handle, char* entry_name, char* entry_sname, bool& is_directory) { (void)handle; (void)entry_name; (void)entry_sname; (void)is_directory; return false; };
+	/* host change notification for DOS_Drive_Cache, see read_dir_watch() in cross.h */
+	virtual bool watchdir(const char *dir, uint32_t id) { (void)dir; (void)id; return false; };
+	virtual void unwatchdir(uint32_t id) { (void)id; };
+	virtual bool read_dir_changes(std::vector<uint32_t> &changed) { (void)changed; return true; };
 	virtual const char * GetInfo(void);
 	char * GetBaseDir(void);
 
@@ -378,4 +432,5 @@ void DOS_DelDevice(DOS_Device * dev);
 
 void VFILE_Register(const char * name,uint8_t * data,uint32_t size,const char *dir = "");
 void VFILE_RegisterBuiltinFileBlob(const struct BuiltinFileBlob &b,const char *dir = "");
+const uint8_t * VFILE_GetOpenFileData(uint16_t entry,uint32_t &size,unsigned int &generation);
 #endif
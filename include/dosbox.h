@@ -185,8 +185,9 @@ extern bool				mono_cga;
 extern bool				DEPRECATED mainline_compatible_mapping;
 extern bool				DEPRECATED mainline_compatible_bios_mapping;
 
-#ifdef __SSE__
+#if defined(__SSE__) || defined(_M_AMD64) || defined(__e2k__)
 extern bool				sse2_available;
+extern bool				ssse3_available;
 extern bool				avx2_available;
 #endif
 
@@ -197,6 +198,10 @@ std::string             formatString(const char* format, ...); // Generates a fo
 void					DOSBOX_RunMachine();
 void					DOSBOX_SetLoop(LoopHandler * handler);
 void					DOSBOX_SetNormalLoop();
+/* turbo while the guest loads from disk, see [cpu] "turbo while loading" */
+bool					DOSBOX_AutoTurboActive();
+void					DOSBOX_AutoTurboInput();       // a key or mouse button from the user
+double					DOSBOX_EmulatedHostTicks(void);
 
 /* machine tests for use with if() statements */
 #define IS_TANDY_ARCH			((machine==MCH_TANDY) || (machine==MCH_PCJR))
@@ -360,21 +365,74 @@ public:
     void removeState(size_t slot) const;
     std::string getName(size_t slot, bool nl=false) const;
 
+    //chunked serialization: spans of a component's data are handed to the compressor as they are
+    //and reads fill the component's memory directly, nothing is copied into a buffer in between
+    struct Writer
+    {
+        virtual ~Writer() noexcept = default;
+        virtual void write(const void *data, size_t size) = 0;
+    };
+    struct Reader
+    {
+        virtual ~Reader() noexcept = default;
+        virtual size_t read(void *data, size_t size) = 0; //bytes read, less at the end of the data
+    };
+
     //initialization: register relevant components on program startup
     struct Component
     {
         virtual ~Component() noexcept = default;
         virtual void getBytes(std::ostream& stream) = 0;
         virtual void setBytes(std::istream& stream) = 0;
+
+        //the state as spans, by default getBytes/setBytes on unbuffered streams over the writer or
+        //reader, so every WRITE_POD_SIZE/READ_POD_SIZE reaches it as a single span
+        virtual void getChunks(Writer& out);
+        virtual void setChunks(Reader& in);
+
+        //incremental save states: a component may write only what changed since the state saved or
+        //loaded before, which is applied on top of that state when loading
+        virtual bool hasDelta() { return false; }
+        virtual void getDelta(std::ostream& stream) { getBytes(stream); }
+        virtual void setDelta(std::istream& stream) { setBytes(stream); }
+        virtual void resetDelta() {} //the current state is the new base
     };
 
     void registerComponent(const std::string& uniqueName, Component& comp); //comp must have global lifetime!
 
+    //in-memory copy of every component, no file and no dialogs (used by run-ahead)
+    typedef std::vector<std::string> MemoryState;
+    void saveMemory(MemoryState& state);
+    void loadMemory(const MemoryState& state) const;
+    bool writeMemory(const std::string& save, const MemoryState& state, const char *program); //as a full state file, true on error
+
+    //a state file as its entries, name and contents, in the order they are written
+    typedef std::vector<std::pair<std::string, std::string> > Entries;
+
+    //the next save is a full state, also after a failed background save
+    void resetChain() { chain.clear(); }
+
 private:
+    //incremental save states: the files the emulator state is made of, full state first, and their ids
+    struct ChainLink
+    {
+        std::string file;
+        std::string id;
+    };
+
     SaveState() {}
     SaveState(const SaveState&);
+    void captureHeader(Entries& entries, const char *save_remark, const std::string& id, const ChainLink *base);
+    void captureState(Entries& entries, const char *save_remark, const std::string& id, const ChainLink *base); //base: NULL for a full state
+    static bool writeEntries(const std::string& save, const Entries& entries, bool compresssaveparts, int zstd_level); //zstd_level: -1 for a ZIP file, true on error
+    bool writeState(const std::string& save, const char *save_remark, bool compresssaveparts, int zstd_level,
+                    const std::string& id, const ChainLink *base); //true on error
     SaveState& operator=(const SaveState&);
 
+    mutable std::vector<ChainLink> chain;
+    bool readChain(const std::string& save, std::vector<ChainLink>& files) const;
+    bool loadDelta(const std::vector<ChainLink>& files, const std::string& name, Component& comp) const;
+
     struct CompData
     {
         CompData(Component& cmp) : comp(cmp) {}
@@ -485,6 +543,34 @@ void readString(std::istream& stream, std::string& data)
     data.resize(stringSize);
     stream.read(&data[0], stringSize * sizeof(std::string::value_type));
 }
+
+/* "snapshot savestates": SaveState::save() forks and the child writes the state in the background.
+ * "background savestates": the state is captured in memory and compressed and written on a thread.
+ * savestate_snapshot_running is set while either is busy, SAVESTATE_FinishSnapshot() collects it. */
+extern bool savestate_snapshot_running;
+void SAVESTATE_FinishSnapshot(bool wait);
+
+/* "runahead frames": every emulated frame is saved in memory, run ahead that many frames with the
+ * current input and the last one shown, then rolled back. runahead_hidden frames are not presented,
+ * runahead_ahead frames are rolled back later so they take no input, make no sound and are not throttled. */
+extern unsigned int runahead_frames;
+extern bool runahead_hidden;
+extern bool runahead_ahead;
+extern bool runahead_pending;
+void RUNAHEAD_Retrace(void);
+void RUNAHEAD_Check(void);
+void RUNAHEAD_Reset(void);
+
+/* "rewind interval"/"rewind buffer size": every rewind_interval real frames the state is captured in
+ * memory and kept as a delta against the capture after it, in up to rewind_budget bytes. REWIND_Step
+ * (mapper) goes back one capture at a time. */
+extern unsigned int rewind_interval;
+extern size_t rewind_budget;
+extern bool rewind_pending;
+void REWIND_Retrace(void);
+void REWIND_Step(bool pressed);
+void REWIND_Check(void);
+void REWIND_Reset(void);
 #endif //SAVE_STATE_H_INCLUDED
 
 #if C_REMOTEDEBUG
@@ -493,6 +579,13 @@ void SAVESTATE_RequestSave(const std::string& filepath);
 void SAVESTATE_RequestLoad(const std::string& filepath);
 bool SAVESTATE_IsPending();
 bool SAVESTATE_IsComplete(std::string& error_out);
+bool SAVESTATE_WaitComplete(int timeout_ms, std::string& error_out);
+// Named states in host memory, never written unless persisted to a file
+void SAVESTATE_RequestSaveSlot(const std::string& slot);
+void SAVESTATE_RequestLoadSlot(const std::string& slot);
+void SAVESTATE_RequestDeleteSlot(const std::string& slot);
+void SAVESTATE_RequestPersistSlot(const std::string& slot, const std::string& filepath);
+void SAVESTATE_ListSlots(std::vector<std::pair<std::string, size_t> >& slots);
 bool SAVESTATE_CheckPendingRequest();
 #endif
 
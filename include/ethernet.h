@@ -73,6 +73,17 @@ class EthernetConnection
          * @param callback The function called for each pending packet
          */
         virtual void GetPackets(std::function<void(const uint8_t*, int)> callback) = 0;
+
+        /** Tells the connection the MAC address of the emulated adapter.
+         * Backends that see other hosts' traffic may use it to drop frames
+         * that are neither addressed to the adapter nor broadcast/multicast
+         * before they reach the emulator. The default does nothing.
+         * @param mac The MAC address of the adapter
+         */
+        virtual void SetReceiveFilter(const uint8_t* mac)
+        {
+            (void)mac;//UNUSED
+        }
 };
 
 /** Opens a virtual Ethernet connection to a backend.
@@ -83,9 +94,22 @@ class EthernetConnection
  * It will attempt to initialize the connection and return a pointer to it.
  * On failure (whether after creating a connection or if no backend is found)
  * this function will clean up after itself and return nullptr.
+ * With threaded set, the slirp and pcap backends are polled on a network thread of their
+ * own, which exchanges frames with the caller through queues. GetPackets and SendPacket
+ * then only touch those queues.
  * @param backend The name of the connection backend
+ * @param threaded Poll the backend on a network thread
+ * @param mac The MAC address of the adapter, passed to SetReceiveFilter when not nullptr
  * @return An initialized Ethernet connection, nullptr otherwise
  */
-EthernetConnection* OpenEthernetConnection(std::string backendstr);
+EthernetConnection* OpenEthernetConnection(std::string backendstr, bool threaded = false, const uint8_t* mac = nullptr);
+
+/** Parses the "macaddr" setting of a network card.
+ * "random" picks a random locally administered unicast address, anything that
+ * is not of the form xx:xx:xx:xx:xx:xx gives the default AC:DE:48:88:BB:AA.
+ * @param macstring The setting
+ * @param mac Receives the MAC address
+ */
+void ETHERNET_ParseMacAddress(const char *macstring, uint8_t mac[6]);
 
 #endif
@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_FRAMEPACING_H
+#define DOSBOX_FRAMEPACING_H
+
+/* Frame pacing statistics. The host time is taken at the emulated vertical retrace, at RENDER_EndUpdate
+ * and once the output presented the frame. A present misses its deadline when the frame before it was
+ * presented too, but more than one and a half frame periods earlier: the host showed a frame twice. */
+
+#define FRAMEPACE_BUCKETS           64
+#define FRAMEPACE_INTERVAL_BUCKET   1.0     // ms per bucket, frame intervals
+#define FRAMEPACE_LATENCY_BUCKET    0.25    // ms per bucket, present latency
+#define FRAMEPACE_RECENT            256     // frames kept for the graph
+
+struct FramePacingStats {
+    double      period_ms = 0;              // frame period of the emulated display
+    uint64_t    retraces = 0;
+    uint64_t    presents = 0;
+    uint64_t    missed = 0;
+    /* the last bucket also counts everything above it */
+    uint32_t    retrace_interval[FRAMEPACE_BUCKETS] = {};   // retrace to retrace
+    uint32_t    present_interval[FRAMEPACE_BUCKETS] = {};   // present to present, consecutive frames only
+    uint32_t    present_latency[FRAMEPACE_BUCKETS] = {};    // RENDER_EndUpdate to the end of the present
+};
+
+/* frame pacing graph in the video debug overlay */
+extern bool framepace_graph;
+#define FRAMEPACE_GRAPH_HEIGHT      32
+
+void FRAMEPACE_Retrace(double period_ms);
+void FRAMEPACE_EndUpdate(void);
+void FRAMEPACE_Presented(void);
+
+void FRAMEPACE_GetStats(FramePacingStats &st);
+void FRAMEPACE_Reset(void);
+/* present intervals of the last frames in ms, oldest first, negative for missed deadlines. Returns how many. */
+unsigned int FRAMEPACE_GetRecent(float *intervals,unsigned int count);
+
+#endif
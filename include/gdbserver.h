@@ -43,6 +43,7 @@ public:
 
     // Called by debugger when execution stops (breakpoint, step complete, etc.)
     void send_stop_reply(int signal = 5);  // Default SIGTRAP
+    void send_watch_reply(uint32_t addr);  // SIGTRAP from a write watchpoint
 
 private:
     int port;
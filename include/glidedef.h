@@ -175,6 +175,9 @@ extern void GLIDE_DisableScreen(void);
 #define	_ConvertAndDownloadRle64	129	// void ConvertAndDownloadRle(GrChipID_t tmu, FxU32 startAddress, GrLOD_t thisLod, GrLOD_t largeLod, GrAspectRatio_t aspectRatio, GrTextureFormat_t format, FxU32 evenOdd, FxU8 *bm_data, long  bm_h, FxU32 u0, FxU32 v0, FxU32 width, FxU32 height, FxU32 dest_width, FxU32 dest_height, FxU16 *tlut)
 #define GLIDE_MAX			129
 
+// Not a Glide call: runs the calls queued in the command ring, see run_batch() in glide.cpp
+#define GLIDE_BATCH			0xFE
+
 #endif // __3DFX_H__
 
 #endif // GLIDEDEF_H
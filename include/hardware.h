@@ -60,5 +60,6 @@ void CAPTURE_VideoStop();
 // Screenshot API for remote debugging
 void CAPTURE_TakeScreenshot();               // Trigger screenshot capture
 bool CAPTURE_IsScreenshotPending();          // Returns true if screenshot is in progress
+bool CAPTURE_WaitScreenshot(unsigned int timeout_ms); // Wait until it is written, false on timeout
 std::string CAPTURE_GetLastScreenshotPath(); // Get path of last screenshot (clears after read)
 void CAPTURE_ClearLastScreenshotPath();      // Clear the last screenshot path
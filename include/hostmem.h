@@ -0,0 +1,84 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_HOSTMEM_H
+#define DOSBOX_HOSTMEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Host memory per subsystem, shown by the debugger (HOSTMEM) and QMP (query-host-memory).
+ * Unlike RegionAllocTracking, which hands out guest address space, this is about what the
+ * emulator itself takes from the host. Fixed buffers are asked for when the report is made;
+ * caches that grow and shrink (drive cache, disk image caches) keep a running count instead.
+ * Large blocks are checked page by page where the host can tell (mincore on Linux), so that
+ * guest RAM and buffers the guest never touched do not count as resident. */
+
+enum {
+    HOSTMEM_GUESTRAM = 0,   // guest RAM, memory file, page handler tables
+    HOSTMEM_TLB,            // paging TLB
+    HOSTMEM_DYNREC,         // dynamic core code cache and blocks
+    HOSTMEM_VGA,            // video memory
+    HOSTMEM_RENDER,         // scaler caches and buffers
+    HOSTMEM_VOODOO,         // 3dfx frame buffer and texture memory
+    HOSTMEM_MIXER,          // mixer buffers, channels and resampler tables
+    HOSTMEM_DRIVECACHE,     // directory cache of local drives
+    HOSTMEM_IMAGECACHE,     // disk image, ISO and CHD caches
+    HOSTMEM_FONTS,          // DOS/V and TrueType fonts
+    HOSTMEM_MAX
+};
+
+struct HostMemSize {
+    uint64_t    allocated = 0;
+    uint64_t    resident = 0;
+
+    /* a block the host may commit lazily */
+    void add(const void *p,size_t size);
+    /* heap allocations, taken as resident */
+    void add_heap(size_t size) { allocated += size; resident += size; }
+};
+
+struct HostMemUsage {
+    HostMemSize what[HOSTMEM_MAX];
+    uint64_t    rss = 0;        // of the process, 0 where the host cannot tell
+    uint64_t    peak_rss = 0;
+    bool        mergeable = false;  // guest memory offered for merging, see MEM_Mergeable
+    bool        merging = false;    // the host is merging pages (Linux KSM running)
+    uint64_t    merged = 0;         // of the process, shared with identical pages elsewhere
+};
+
+const char *HOSTMEM_Name(unsigned int what);
+/* bytes of the block the host has committed, all of it where it cannot tell */
+uint64_t HOSTMEM_Resident(const void *p,size_t size);
+/* running count of a cache, bytes may be negative. Any thread may call it. */
+void HOSTMEM_Count(unsigned int what,int64_t bytes);
+void HOSTMEM_GetUsage(HostMemUsage &usage);
+
+/* provided by the subsystems */
+void MEM_GetHostMemory(HostMemSize &sz);
+void PAGING_GetHostMemory(HostMemSize &sz);
+void CPU_Core_Dynrec_GetHostMemory(HostMemSize &sz);
+void CPU_Core_Dyn_X86_GetHostMemory(HostMemSize &sz);
+void VGA_GetHostMemory(HostMemSize &sz);
+void RENDER_GetHostMemory(HostMemSize &sz);
+void Voodoo_GetHostMemory(HostMemSize &sz);
+void MIXER_GetHostMemory(HostMemSize &sz);
+void DOSV_GetHostMemory(HostMemSize &sz);
+void TTF_GetHostMemory(HostMemSize &sz);
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_HOSTTIME_H
+#define DOSBOX_HOSTTIME_H
+
+#include <string>
+#include <vector>
+
+/* Host time accounting ("host time accounting" in [dosbox]). The main parts of the emulation loop are
+ * timed on the emulation thread, each scope for its own time only: a scope inside another one, like
+ * the scaler inside VGA line drawing, is taken off the time of the one around it. The shares of host
+ * time are averaged over windows of 500ms and shown in the title bar, the video debug overlay and the
+ * debugger (HOSTSTAT). */
+
+enum {
+    HOSTTIME_CPU = 0,       // CPU core
+    HOSTTIME_EVENTS,        // PIC event and tick handlers, per handler
+    HOSTTIME_VGA,           // VGA line drawing
+    HOSTTIME_RENDER,        // scalers, RENDER_EndUpdate
+    HOSTTIME_OUTPUT,        // GFX_EndUpdate, the present
+    HOSTTIME_MIXER,         // mixing, per MixerChannel
+    HOSTTIME_DISK,          // DOS file, INT 13h and IDE I/O
+    HOSTTIME_IDLE,          // sleeping until the host catches up with emulated time
+    HOSTTIME_MAX
+};
+
+struct HostTimeEntry {
+    std::string     name;
+    unsigned int    what;   // HOSTTIME_EVENTS or HOSTTIME_MIXER
+    double          share;  // of host time
+};
+
+extern bool hosttime_enabled;
+/* accounting or the trace recorder (tracerec.h) is on, the scopes have to call HOSTTIME_Begin */
+extern bool hosttime_scopes;
+
+bool HOSTTIME_Begin(unsigned int what,const void *key,const char *name);
+void HOSTTIME_End(void);
+
+class HostTimeScope {
+public:
+    HostTimeScope(unsigned int what,const void *key=NULL,const char *name=NULL) {
+        active = GCC_UNLIKELY(hosttime_scopes) && HOSTTIME_Begin(what,key,name);
+    }
+    ~HostTimeScope() {
+        if (active) HOSTTIME_End();
+    }
+private:
+    bool active;
+};
+
+void HOSTTIME_Enable(bool enable);
+/* the main loop: closes the window every 500ms */
+void HOSTTIME_Update(void);
+const char *HOSTTIME_Name(unsigned int what);
+/* "cpu 61% ev 4% ..." for the title bar and the overlay */
+std::string HOSTTIME_Summary(void);
+/* shares of the last windows. Only reads plain doubles, other threads (QMP) may call it. */
+void HOSTTIME_GetShares(double share[HOSTTIME_MAX],double &other);
+/* the same, and the handlers and channels sorted by share */
+void HOSTTIME_GetStats(double share[HOSTTIME_MAX],double &other,std::vector<HostTimeEntry> &entries);
+
+#endif
@@ -7,6 +7,9 @@
 
 #define MAX_IDE_CONTROLLERS 	8
 
+/* default I/O base of the PCI IDE bus master registers (BAR4), 16 ports */
+#define IDE_BUSMASTER_DEFAULT_IO	0xFFA0
+
 extern const char *ide_names[MAX_IDE_CONTROLLERS];
 extern void (*ide_inits[MAX_IDE_CONTROLLERS])(Section *);
 
@@ -18,5 +21,7 @@ void IDE_Hard_Disk_Attach(signed char index,bool slave,unsigned char bios_disk_i
 void IDE_Hard_Disk_Detach(unsigned char bios_disk_index);
 void IDE_ResetDiskByBIOS(unsigned char disk);
 bool IDE_controller_occupied(signed char index, bool slave);
+void IDE_BusMaster_SetIO(unsigned int base,bool enable);
+void IDE_AsyncIO_Drain(void);
 
 #endif
@@ -51,6 +51,10 @@ void IO_FreeWriteHandler(Bitu port,Bitu mask,Bitu range=1);
 
 void IO_InvalidateCachedHandler(Bitu port,Bitu range=1);
 
+/* Number of reads or writes of a port that had to be resolved through the device callouts
+ * since startup. A port that keeps counting up is being invalidated over and over. */
+uint32_t IO_GetSlowPathHits(Bitu port,bool write);
+
 void IO_WriteB(Bitu port,uint8_t val);
 void IO_WriteW(Bitu port,uint16_t val);
 void IO_WriteD(Bitu port,uint32_t val);
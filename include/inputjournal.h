@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_INPUTJOURNAL_H
+#define DOSBOX_INPUTJOURNAL_H
+
+#include "keyboard.h"
+
+/* Input journal. Keyboard, mouse and joystick input is recorded at the emulated time the guest got it,
+ * the tick (PIC_Ticks) and the cycle within it, from every source: the mapper, QMP and the clipboard.
+ * Replaying feeds the same events back at the same emulated time and ignores live input. With fixed
+ * "cycles" the guest sees exactly the same input, which makes runs of real games repeatable.
+ *
+ * File layout: InputJournalHeader, then InputJournalRecord after InputJournalRecord in host byte order. */
+
+#define INPUTJOURNAL_MAGIC      "DBXINPUT"
+#define INPUTJOURNAL_VERSION    1u
+
+enum {
+    INPUTJOURNAL_KEY = 0,           // which = KBD_KEYS
+    INPUTJOURNAL_MOUSE_BUTTON,      // which = button
+    INPUTJOURNAL_MOUSE_MOVE,        // v = xrel, yrel, x, y
+    INPUTJOURNAL_JOY_BUTTON,        // which = stick, num = button
+    INPUTJOURNAL_JOY_X,             // which = stick, v[0] = position
+    INPUTJOURNAL_JOY_Y
+};
+
+#define INPUTJOURNAL_PRESSED    0x01u
+#define INPUTJOURNAL_EMULATE    0x02u   // Mouse_CursorMoved emulate
+
+struct InputJournalHeader {
+    char        magic[8];       // INPUTJOURNAL_MAGIC
+    uint32_t    version;        // INPUTJOURNAL_VERSION
+    uint32_t    record_size;    // sizeof(InputJournalRecord)
+    uint32_t    byte_order;     // 0x01020304 as written by the host
+    uint32_t    cycles;         // cycles per ms while recording, 0 if they were not fixed
+};
+
+struct InputJournalRecord {
+    uint64_t    tick;           // PIC_Ticks
+    uint32_t    cycle;          // PIC_TickIndexND, can be past the end of the tick
+    uint8_t     kind;           // INPUTJOURNAL_*
+    uint8_t     which;
+    uint8_t     num;
+    uint8_t     flags;          // INPUTJOURNAL_PRESSED, INPUTJOURNAL_EMULATE
+    float       v[4];
+};
+
+extern bool input_journal_active;
+
+/* called by the input functions while input_journal_active is set. False if they must ignore
+ * the event, which is live input while replaying. */
+bool INPUTJOURNAL_Key(KBD_KEYS key,bool pressed);
+bool INPUTJOURNAL_MouseButton(uint8_t button,bool pressed);
+bool INPUTJOURNAL_MouseMove(float xrel,float yrel,float x,float y,bool emulate);
+bool INPUTJOURNAL_JoyButton(Bitu which,Bitu num,bool pressed);
+bool INPUTJOURNAL_JoyMove(Bitu which,bool y,float pos);
+
+/* the main loop, at the end of every tick: events of the tick the guest has not got yet */
+void INPUTJOURNAL_Poll(void);
+bool INPUTJOURNAL_Replaying(void);
+
+/* record to or replay from a file, at most one of the paths set */
+void INPUTJOURNAL_Init(const std::string& record,const std::string& replay);
+
+#endif
@@ -1565,7 +1565,8 @@ uint8_t JPNHN19X[]=
 	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
 };
 
-uint8_t JPNZN16X[]=
+/* built-in FONTX2 fallback for DBCS glyphs, read-only so the pages stay shared between instances */
+const uint8_t JPNZN16X[]=
 {
 	0x46,0x4F,0x4E,0x54,0x58,0x32,0x54,0x4C,0x47,0x4F,0x54,
 	0x48,0x43,0x20,0x10,0x10,0x01,0x59,0x40,0x81,0x7E,0x81,
@@ -51,6 +51,17 @@ typedef int32_t               MemHandle;
 extern HostPt                 MemBase;
 extern size_t                 MemSize;
 
+/* incremental save states: one byte per page of MemBase, set when the page may have been written
+ * since the last save state was saved or loaded. Anything that writes MemBase other than through
+ * a page handler's host write pointer has to mark what it wrote. */
+extern uint8_t*               MemDirty;
+void                        MEM_MarkDirtyRange(PhysPt addr,Bitu len);
+void                        MEM_ResetDirty(bool all);
+bool                        MEM_MapHostFromFile(void *dst,size_t size,int fd,uint64_t offset);
+/* "memory allocation = mergeable": guest RAM, and video memory, are offered to the host for merging
+ * with identical pages of other instances (KSM on Linux) */
+bool                        MEM_Mergeable(void);
+
 HostPt                      GetMemBase(void);
 bool                        MEM_A20_Enabled(void);
 void                        MEM_A20_Enable(bool enabled);
@@ -232,16 +243,22 @@ void phys_writes(PhysPt addr, const char* string, Bitu length);
  *      memory addresse could be a useful guide on how to do that. --J.C. */
 
 static INLINE void phys_writeb(const PhysPt addr,const uint8_t val) {
-    if (addr < MemSize)
+    if (addr < MemSize) {
         host_writeb(MemBase+addr,val);
+        MemDirty[addr>>12u] = 1;
+    }
 }
 static INLINE void phys_writew(const PhysPt addr,const uint16_t val) {
-    if (addr < (MemSize-1u))
+    if (addr < (MemSize-1u)) {
         host_writew(MemBase+addr,val);
+        MemDirty[addr>>12u] = MemDirty[(addr+1u)>>12u] = 1;
+    }
 }
 static INLINE void phys_writed(const PhysPt addr,const uint32_t val) {
-    if (addr < (MemSize-3u))
+    if (addr < (MemSize-3u)) {
         host_writed(MemBase+addr,val);
+        MemDirty[addr>>12u] = MemDirty[(addr+3u)>>12u] = 1;
+    }
 }
 
 static INLINE uint8_t phys_readb(const PhysPt addr) {
@@ -270,6 +287,8 @@ void MEM_BlockRead(LinearPt pt,void * data,Bitu size);
 void MEM_BlockWrite32(LinearPt pt,void * data,Bitu size);
 void MEM_BlockRead32(LinearPt pt,void * data,Bitu size);
 void MEM_BlockCopy(LinearPt dest,LinearPt src,Bitu size);
+/* memmove() for guest memory, RAM to RAM is copied a page span at a time on the host */
+void MEM_BlockMove(LinearPt dest,LinearPt src,Bitu size);
 void MEM_StrCopy(LinearPt pt,char * data,Bitu size);
 
 void mem_memcpy(LinearPt dest,LinearPt src,Bitu size);
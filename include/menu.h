@@ -17,6 +17,7 @@
  */
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -248,6 +249,20 @@ class DOSBoxMenu {
                 bool                    itemHoverDrawn = false;
                 bool                    itemHilightDrawn = false;
                 bool                    borderTop = false;
+                /* retained copies of what drawMenuItem() rendered, one for the plain look and one
+                 * for hover/highlight, reused while the visual state they were drawn from holds
+                 * (surface output only, OpenGL draws directly) */
+                struct drawcache_t {
+                    std::shared_ptr<SDL_Surface> surface;
+                    std::string         text;
+                    std::string         shortcut;
+                    uint64_t            state = 0;
+                };
+                drawcache_t             drawCache[2];
+            protected:
+                uint64_t                drawState(DOSBoxMenu &menu) const;
+                bool                    drawFromCache(DOSBoxMenu &menu);
+                void                    updateDrawCache(DOSBoxMenu &menu);
             public:
                 void                    removeFocus(DOSBoxMenu &menu);
                 void                    removeHover(DOSBoxMenu &menu);
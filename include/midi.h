@@ -29,7 +29,17 @@ public:
 	virtual void Close(void) {};
 	virtual void PlayMsg(uint8_t * /*msg*/) {};
 	virtual void PlaySysex(uint8_t * /*sysex*/,Bitu /*len*/) {};
+	/* Batched output ([midi] batch output=true): once per mixer tick the messages queued since the
+	   last tick are delivered between BeginBatch() and EndBatch(). offset is the emulated time in ms
+	   since the first message of the batch, so handlers that can schedule output keep the spacing. */
+	virtual void BeginBatch(void) {};
+	virtual void PlayMsgAt(uint8_t * msg,double /*offset*/) { PlayMsg(msg); };
+	virtual void PlaySysexAt(uint8_t * sysex,Bitu len,double /*offset*/) { PlaySysex(sysex,len); };
+	virtual void EndBatch(void) {};
 	virtual const char * GetName(void) { return "none"; };
+	/* true for devices whose Open() loads ROMs or a sound font. With [midi] open synth on demand
+	   they are opened when the guest first sends MIDI data, not at startup. */
+	virtual bool OpenOnDemand(void) { return false; };
 	virtual void ListAll(Program * /*base*/) {};
 	virtual ~MidiHandler() { };
 	MidiHandler * next;
@@ -46,6 +46,10 @@ extern uint8_t MixTemp[MIXER_BUFSIZE];
 
 #define LOWPASS_ORDER 8
 
+#define MIXER_SINC_MAXTAPS 128
+
+struct MixerSincTable;
+
 class MixerChannel {
 public:
 	void SetVolume(float _left,float _right);
@@ -60,8 +64,8 @@ public:
 	void EndFrame(Bitu samples);
 
 	void lowpassUpdate();
-	int32_t lowpassStep(int32_t in,const unsigned int iteration,const unsigned int channel);
-	void lowpassProc(int32_t ch[2]);
+	float lowpassStep(float in,const unsigned int iteration,const unsigned int channel);
+	void lowpassProc(float ch[2]);
 
 	template<class Type,bool stereo,bool signeddata,bool nativeorder,bool lowpass>
 	void loadCurrentSample(Bitu &len, const Type* &data);
@@ -73,6 +77,8 @@ public:
 	bool runSampleInterpolation(const Bitu upto);
 
 	void updateSlew(void);
+	void sincUpdate(void);
+	void sincRender(float out[2]);
 	void padFillSampleInterpolation(const Bitu upto);
 	void finishSampleInterpolation(const Bitu upto);
 	void AddSamples_m8(Bitu len, const uint8_t * data);
@@ -94,15 +100,18 @@ public:
 
 	void FillUp(void);
 	void Enable(bool _yesno);
+	void SetIdleTimeout(unsigned int ms);	// disable the channel after this many ms of silence, 0 = never
+	void Wake(void);			// the device was written to, enable the channel again if it was disabled
 	void SaveState( std::ostream& stream );
 	void LoadState( std::istream& stream );
 
 	MIXER_Handler handler;
 	float volmain[2];
 	float scale[2];
-	int32_t volmul[2];
-	int32_t lowpass[LOWPASS_ORDER][2];	// lowpass filter
-	int32_t lowpass_alpha;			// "alpha" multiplier for lowpass (16.16 fixed point)
+	int32_t volmul[2];			// volume in 1 << MIXER_VOLSHIFT fixed point, kept for save states
+	float volgain[2];			// volume the samples are scaled by
+	float lowpass[LOWPASS_ORDER][2];	// lowpass filter
+	float lowpass_alpha;			// "alpha" multiplier for lowpass
 	Bitu lowpass_freq;
 	unsigned int lowpass_order;
 	bool lowpass_on_load;			// apply lowpass on sample load (if source rate > mixer rate)
@@ -113,9 +122,14 @@ public:
 	unsigned int rend_n,rend_d;
 	unsigned int freq_n,freq_d,freq_d_orig;
 	bool current_loaded;
-	int32_t current[2],last[2],delta[2],max_change;
-	int32_t msbuffer[2048][2];		// more than enough for 1ms of audio, at mixer sample rate
+	float current[2],last[2],delta[2],max_change;	// in 16-bit sample units
+	float msbuffer[2048][2];		// more than enough for 1ms of audio, at mixer sample rate
+	const MixerSincTable *sinc;		// polyphase filter for this rate pair, or nullptr to interpolate linearly
+	float sinc_hist[2][MIXER_SINC_MAXTAPS*2];	// loaded samples, each written twice so the newest are always contiguous
+	unsigned int sinc_pos;			// where the newest loaded sample is in sinc_hist
 	Bits last_sample_write;
+	unsigned int idle_timeout;		// ms of silent output before the channel is disabled, 0 to never
+	unsigned int idle_silent;		// ms of silent output so far
 	Bitu msbuffer_o;
 	Bitu msbuffer_i;
 	const char * name;
@@ -125,6 +139,22 @@ public:
 
 void MIXER_SetMaster(float vol0,float vol1);
 
+struct MIXER_AudioStats {
+	bool adaptive;				// adaptive buffering is on
+	uint32_t rate;				// mixer rate in Hz
+	uint32_t blocksize;			// sound device block size in frames
+	uint32_t prebuffer;			// frames collected before playing resumes
+	uint32_t buffered;			// frames mixed and waiting for the sound device
+	double latency_ms;			// buffered plus one device block
+	double jitter_ms;			// smoothed deviation of the callback interval
+	int32_t rate_adjust_ppm;		// drift correction applied to the mix
+	uint32_t underruns;			// callbacks that ran out of frames
+	uint32_t overruns;			// frames lost to a full buffer
+	uint32_t dropped;			// frames dropped to keep time
+};
+
+void MIXER_GetAudioStats(MIXER_AudioStats &st);
+
 MixerChannel * MIXER_AddChannel(MIXER_Handler handler,Bitu freq,const char * name);
 MixerChannel * MIXER_FindChannel(const char * name);
 /* Find the device you want to delete with findchannel "delchan gets deleted" */
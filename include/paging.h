@@ -23,6 +23,7 @@
 #include <exception>
 
 #include "mem.h"
+#include "bintrace.h"
 #include "bitop.h"
 
 class PageHandler;
@@ -135,6 +136,7 @@ public:
 	Bitu range_mask = 0;
 	Bitu alias_mask = 0xFFFFFFFF;
 	unsigned int getcounter = 0;
+	uint32_t resolvecounter = 0;			/* pages this device claimed in MEM_SlowPath */
 	MEM_CalloutHandler *m_handler = NULL;
 	Bitu m_base = 0;
 	bool alloc = false;
@@ -183,6 +185,10 @@ MEM_Callout_t MEM_AllocateCallout(MEM_Type_t t);
 void MEM_FreeCallout(MEM_Callout_t c);
 MEM_CalloutObject *MEM_GetCallout(MEM_Callout_t c);
 void MEM_PutCallout(MEM_CalloutObject *obj);
+/* number of callout slots of type 't', for walking them with MEM_GetCallout() */
+unsigned int MEM_GetCalloutSlots(MEM_Type_t t);
+/* MEM_SlowPath lookups since startup, how many found no device, and how many found more than one */
+void MEM_GetSlowPathStats(uint64_t &lookups,uint64_t &unmapped,uint64_t &conflicts);
 
 /* Some other functions */
 void PAGING_Enable(bool enabled);
@@ -194,6 +200,25 @@ Bitu PAGING_GetDirBase(void);
 void PAGING_SetDirBase(Bitu cr3);
 void PAGING_InitTLB(void);
 void PAGING_ClearTLB(void);
+/* full TLB flushes since startup, and during the last second of emulated time */
+void PAGING_GetTLBFlushStats(uint64_t &flushes,uint64_t &flushes_per_sec);
+
+/* Debugger write watchpoints. The TLB sends writes to a watched linear page through a trap
+ * handler instead of the direct pointer, other pages run at full speed. A write into a watched
+ * range ends the CPU slice once the instruction is done and is reported once. */
+bool PAGING_AddWriteWatch(LinearPt addr,Bitu len);
+bool PAGING_RemoveWriteWatch(LinearPt addr,Bitu len);
+void PAGING_ClearWriteWatches(void);
+bool PAGING_GetWriteWatchHit(LinearPt &addr);
+/* set by the dynamic core while translated code runs: a watched write gives up the instruction
+ * like self-modifying code does and the normal core repeats it, so the stop is exact */
+extern bool paging_watch_retry;
+/* The CPU caches the descriptors it reads from the GDT (which 0) and the LDT (which 1). Writes
+ * to these ranges go through the same trap handler as the watchpoints and flush the cache
+ * (CPU_DescriptorCacheFlush), so do remaps of any page. len 0 stops watching. */
+void PAGING_SetDescriptorWatch(unsigned int which,LinearPt addr,Bitu len);
+/* true if the range lies in a watched descriptor table, only those descriptors are cached */
+bool PAGING_DescriptorWatched(LinearPt addr,Bitu len);
 
 void PAGING_LinkPage(PageNum lin_page,PageNum phys_page);
 void PAGING_UnlinkPages(PageNum lin_page,PageNum pages);
@@ -351,6 +376,33 @@ union X86PageEntry {
 
 static_assert( sizeof(X86PageEntry) == 4, "oops" );
 
+#if C_SPARSE_TLB
+/* Sparse TLB: the 1M entry TLB is split into banks of one page table (4MB of linear
+ * address space) each, which are only allocated once a page in them gets mapped.
+ * Lookups go through a small direct mapped TLB that is refilled from the banks on a
+ * miss. Code that changes TLB entries has to go through the tlb_*() functions below,
+ * which allocate the bank and drop the entry from the hot TLB.
+ *
+ * Entries are tagged with the linear page and the flush generation (upper 32 bits) they
+ * were linked in. PAGING_ClearTLB() only starts a new generation, entries of an older
+ * one read as unmapped on the next miss. */
+#define TLB_BANK_BITS		10
+#define TLB_BANK_SIZE		(1u << TLB_BANK_BITS)
+#define TLB_BANKS		(TLB_SIZE >> TLB_BANK_BITS)
+#define TLB_HOT_SIZE		1024
+#define TLB_TAG_NONE		(~(uint64_t)0)
+#define TLB_GEN_STEP		((uint64_t)1 << 32)
+
+struct TLBEntry {
+	HostPt read;
+	HostPt write;
+	PageHandler *readhandler;
+	PageHandler *writehandler;
+	tlbentry_t phys_page;
+	uint64_t tag;				/* generation | linear page */
+};
+#endif
+
 struct PagingBlock {
 	uint32_t		cr3;
 	uint32_t		cr2;
@@ -358,6 +410,14 @@ struct PagingBlock {
 		PageNum page;
 		PhysPt addr;
 	} base;
+#if C_SPARSE_TLB
+	struct {
+		TLBEntry hot[TLB_HOT_SIZE];		/* direct mapped */
+		TLBEntry *bank[TLB_BANKS];		/* unused banks point to empty */
+		TLBEntry *empty;
+		uint64_t gen;				/* current flush generation, in the upper 32 bits */
+	} tlb;
+#else
 	struct {
 		HostPt read[TLB_SIZE];
 		HostPt write[TLB_SIZE];
@@ -365,6 +425,7 @@ struct PagingBlock {
 		PageHandler *writehandler[TLB_SIZE];
 		tlbentry_t phys_page[TLB_SIZE];
 	} tlb;
+#endif
 	struct {
 		uint32_t used;
 		uint32_t entries[PAGING_LINKS]; /* does not require more than 32 bits */
@@ -404,6 +465,91 @@ bool mem_unalignedreadd_checked(const LinearPt address,uint32_t * const val);
 bool mem_unalignedwritew_checked(const LinearPt address,uint16_t const val);
 bool mem_unalignedwrited_checked(const LinearPt address,uint32_t const val);
 
+/* REP MOVS/STOS/LODS fast path. Each helper runs up to count elements of step bytes (negative
+ * when the direction flag is set) directly on host RAM, as long as the elements stay in one page
+ * per operand that the TLB maps to host memory and the indexes don't wrap around add_mask.
+ * Returns the number of elements done and advances the indexes, 0 leaves the element to the
+ * caller's regular path, which also links the page into the TLB. */
+Bitu PAGING_StringMove(const LinearPt src_base,uint32_t &src_index,const LinearPt dst_base,uint32_t &dst_index,const uint32_t add_mask,const Bits step,const Bitu count);
+Bitu PAGING_StringStore(const LinearPt dst_base,uint32_t &dst_index,const uint32_t add_mask,const Bits step,const Bitu count,const uint32_t val);
+Bitu PAGING_StringLoad(const LinearPt src_base,uint32_t &src_index,const uint32_t add_mask,const Bits step,const Bitu count,uint32_t &val);
+
+#if C_SPARSE_TLB
+const TLBEntry &PAGING_TLBMiss(const PageNum page);
+TLBEntry *PAGING_TLBAllocBank(const Bitu bank);
+
+static INLINE const TLBEntry &get_tlb_entry(const LinearPt address) {
+	const PageNum page = address>>12;
+	const TLBEntry &hot = paging.tlb.hot[page&(TLB_HOT_SIZE-1)];
+	if (GCC_LIKELY(hot.tag == (paging.tlb.gen|page))) return hot;
+	return PAGING_TLBMiss(page);
+}
+
+/* entry of lin_page to be changed */
+static INLINE TLBEntry &tlb_entry(const PageNum lin_page) {
+	TLBEntry *bank = paging.tlb.bank[lin_page>>TLB_BANK_BITS];
+	if (GCC_UNLIKELY(bank == paging.tlb.empty)) bank = PAGING_TLBAllocBank(lin_page>>TLB_BANK_BITS);
+	TLBEntry &hot = paging.tlb.hot[lin_page&(TLB_HOT_SIZE-1)];
+	if ((uint32_t)hot.tag == lin_page) hot.tag = TLB_TAG_NONE;
+	return bank[lin_page&(TLB_BANK_SIZE-1)];
+}
+
+/* mark the entry of lin_page as linked in the current generation */
+static INLINE void tlb_validate(const PageNum lin_page) {
+	tlb_entry(lin_page).tag = paging.tlb.gen|lin_page;
+}
+
+static INLINE HostPt &tlb_read(const PageNum lin_page) {
+	return tlb_entry(lin_page).read;
+}
+static INLINE HostPt &tlb_write(const PageNum lin_page) {
+	return tlb_entry(lin_page).write;
+}
+static INLINE PageHandler* &tlb_readhandler(const PageNum lin_page) {
+	return tlb_entry(lin_page).readhandler;
+}
+static INLINE PageHandler* &tlb_writehandler(const PageNum lin_page) {
+	return tlb_entry(lin_page).writehandler;
+}
+static INLINE tlbentry_t &tlb_phys_page(const PageNum lin_page) {
+	return tlb_entry(lin_page).phys_page;
+}
+
+static INLINE HostPt get_tlb_read(const LinearPt address) {
+	return get_tlb_entry(address).read;
+}
+static INLINE HostPt get_tlb_write(const LinearPt address) {
+	return get_tlb_entry(address).write;
+}
+static INLINE PageHandler* get_tlb_readhandler(const LinearPt address) {
+	return get_tlb_entry(address).readhandler;
+}
+static INLINE PageHandler* get_tlb_writehandler(const LinearPt address) {
+	return get_tlb_entry(address).writehandler;
+}
+static INLINE tlbentry_t get_tlb_phys_page(const LinearPt address) {
+	return get_tlb_entry(address).phys_page;
+}
+#else
+static INLINE void tlb_validate(const PageNum /*lin_page*/) {
+}
+
+static INLINE HostPt &tlb_read(const PageNum lin_page) {
+	return paging.tlb.read[lin_page];
+}
+static INLINE HostPt &tlb_write(const PageNum lin_page) {
+	return paging.tlb.write[lin_page];
+}
+static INLINE PageHandler* &tlb_readhandler(const PageNum lin_page) {
+	return paging.tlb.readhandler[lin_page];
+}
+static INLINE PageHandler* &tlb_writehandler(const PageNum lin_page) {
+	return paging.tlb.writehandler[lin_page];
+}
+static INLINE tlbentry_t &tlb_phys_page(const PageNum lin_page) {
+	return paging.tlb.phys_page[lin_page];
+}
+
 static INLINE HostPt get_tlb_read(const LinearPt address) {
 	return paging.tlb.read[address>>12];
 }
@@ -416,24 +562,28 @@ static INLINE PageHandler* get_tlb_readhandler(const LinearPt address) {
 static INLINE PageHandler* get_tlb_writehandler(const LinearPt address) {
 	return paging.tlb.writehandler[address>>12];
 }
+static INLINE tlbentry_t get_tlb_phys_page(const LinearPt address) {
+	return paging.tlb.phys_page[address>>12];
+}
+#endif
 
 /* Use these helper functions to access linear addresses in readX/writeX functions */
 /* NTS: 12-bit shift 32-bit constant, upper bits get shifted out, therefore no need to bitmask */
 static INLINE PhysPt PAGING_GetPhysicalPage(const LinearPt linePage) {
-	return (paging.tlb.phys_page[linePage>>12]<<12);
+	return (get_tlb_phys_page(linePage)<<12);
 }
 
 static INLINE PhysPt PAGING_GetPhysicalPageNumber(const LinearPt linePage) {
-	return paging.tlb.phys_page[linePage>>12]&PHYSPAGE_ADDR;
+	return get_tlb_phys_page(linePage)&PHYSPAGE_ADDR;
 }
 
 /* NTS: 12-bit shift 32-bit constant, upper bits get shifted out, therefore no need to bitmask */
 static INLINE PhysPt PAGING_GetPhysicalAddress(const LinearPt linAddr) {
-	return (paging.tlb.phys_page[linAddr>>12]<<12)|(linAddr&0xfff);
+	return (get_tlb_phys_page(linAddr)<<12)|(linAddr&0xfff);
 }
 
 static INLINE PhysPt64 PAGING_GetPhysicalAddress64(const LinearPt linAddr) {
-	return ((PhysPt64)(paging.tlb.phys_page[linAddr>>12]&PHYSPAGE_ADDR)<<(PhysPt64)12)|(linAddr&0xfff);
+	return ((PhysPt64)(get_tlb_phys_page(linAddr)&PHYSPAGE_ADDR)<<(PhysPt64)12)|(linAddr&0xfff);
 }
 
 /* Special inlined memory reading/writing */
@@ -441,14 +591,22 @@ static INLINE PhysPt64 PAGING_GetPhysicalAddress64(const LinearPt linAddr) {
 static INLINE uint8_t mem_readb_inline(const LinearPt address) {
 	const HostPt tlb_addr=get_tlb_read(address);
 	if (tlb_addr) return host_readb(tlb_addr+address);
-	else return (uint8_t)(get_tlb_readhandler(address))->readb(address);
+	else {
+		const uint8_t val=(uint8_t)(get_tlb_readhandler(address))->readb(address);
+		BINTRACE_Mem(false,1,address,val);
+		return val;
+	}
 }
 
 static INLINE uint16_t mem_readw_inline(const LinearPt address) {
 	if ((address & 0xfff)<0xfff) {
 		const HostPt tlb_addr=get_tlb_read(address);
 		if (tlb_addr) return host_readw(tlb_addr+address);
-		else return (uint16_t)(get_tlb_readhandler(address))->readw(address);
+		else {
+			const uint16_t val=(uint16_t)(get_tlb_readhandler(address))->readw(address);
+			BINTRACE_Mem(false,2,address,val);
+			return val;
+		}
 	} else return mem_unalignedreadw(address);
 }
 
@@ -456,21 +614,31 @@ static INLINE uint32_t mem_readd_inline(const LinearPt address) {
 	if ((address & 0xfff)<0xffd) {
 		const HostPt tlb_addr=get_tlb_read(address);
 		if (tlb_addr) return host_readd(tlb_addr+address);
-		else return (uint32_t)(get_tlb_readhandler(address))->readd(address);
+		else {
+			const uint32_t val=(uint32_t)(get_tlb_readhandler(address))->readd(address);
+			BINTRACE_Mem(false,4,address,val);
+			return val;
+		}
 	} else return mem_unalignedreadd(address);
 }
 
 static INLINE void mem_writeb_inline(const LinearPt address,const uint8_t val) {
 	const HostPt tlb_addr=get_tlb_write(address);
 	if (tlb_addr) host_writeb(tlb_addr+address,val);
-	else (get_tlb_writehandler(address))->writeb(address,val);
+	else {
+		BINTRACE_Mem(true,1,address,val);
+		(get_tlb_writehandler(address))->writeb(address,val);
+	}
 }
 
 static INLINE void mem_writew_inline(const LinearPt address,const uint16_t val) {
 	if ((address & 0xfffu)<0xfffu) {
 		const HostPt tlb_addr=get_tlb_write(address);
 		if (tlb_addr) host_writew(tlb_addr+address,val);
-		else (get_tlb_writehandler(address))->writew(address,val);
+		else {
+			BINTRACE_Mem(true,2,address,val);
+			(get_tlb_writehandler(address))->writew(address,val);
+		}
 	} else mem_unalignedwritew(address,val);
 }
 
@@ -478,7 +646,10 @@ static INLINE void mem_writed_inline(const LinearPt address,const uint32_t val)
 	if ((address & 0xfffu)<0xffdu) {
 		const HostPt tlb_addr=get_tlb_write(address);
 		if (tlb_addr) host_writed(tlb_addr+address,val);
-		else (get_tlb_writehandler(address))->writed(address,val);
+		else {
+			BINTRACE_Mem(true,4,address,val);
+			(get_tlb_writehandler(address))->writed(address,val);
+		}
 	} else mem_unalignedwrited(address,val);
 }
 
@@ -488,7 +659,11 @@ static INLINE bool mem_readb_checked(const LinearPt address, uint8_t * const val
 	if (tlb_addr) {
 		*val=host_readb(tlb_addr+address);
 		return false;
-	} else return (get_tlb_readhandler(address))->readb_checked(address, val);
+	} else {
+		if ((get_tlb_readhandler(address))->readb_checked(address, val)) return true;
+		BINTRACE_Mem(false,1,address,*val);
+		return false;
+	}
 }
 
 static INLINE bool mem_readw_checked(const LinearPt address, uint16_t * const val) {
@@ -497,7 +672,11 @@ static INLINE bool mem_readw_checked(const LinearPt address, uint16_t * const va
 		if (tlb_addr) {
 			*val=host_readw(tlb_addr+address);
 			return false;
-		} else return (get_tlb_readhandler(address))->readw_checked(address, val);
+		} else {
+			if ((get_tlb_readhandler(address))->readw_checked(address, val)) return true;
+			BINTRACE_Mem(false,2,address,*val);
+			return false;
+		}
 	} else return mem_unalignedreadw_checked(address, val);
 }
 
@@ -507,7 +686,11 @@ static INLINE bool mem_readd_checked(const LinearPt address, uint32_t * const va
 		if (tlb_addr) {
 			*val=host_readd(tlb_addr+address);
 			return false;
-		} else return (get_tlb_readhandler(address))->readd_checked(address, val);
+		} else {
+			if ((get_tlb_readhandler(address))->readd_checked(address, val)) return true;
+			BINTRACE_Mem(false,4,address,*val);
+			return false;
+		}
 	} else return mem_unalignedreadd_checked(address, val);
 }
 
@@ -516,7 +699,10 @@ static INLINE bool mem_writeb_checked(const LinearPt address,const uint8_t val)
 	if (tlb_addr) {
 		host_writeb(tlb_addr+address,val);
 		return false;
-	} else return (get_tlb_writehandler(address))->writeb_checked(address,val);
+	} else {
+		BINTRACE_Mem(true,1,address,val);
+		return (get_tlb_writehandler(address))->writeb_checked(address,val);
+	}
 }
 
 static INLINE bool mem_writew_checked(const LinearPt address,const uint16_t val) {
@@ -525,7 +711,10 @@ static INLINE bool mem_writew_checked(const LinearPt address,const uint16_t val)
 		if (tlb_addr) {
 			host_writew(tlb_addr+address,val);
 			return false;
-		} else return (get_tlb_writehandler(address))->writew_checked(address,val);
+		} else {
+			BINTRACE_Mem(true,2,address,val);
+			return (get_tlb_writehandler(address))->writew_checked(address,val);
+		}
 	} else return mem_unalignedwritew_checked(address,val);
 }
 
@@ -535,7 +724,10 @@ static INLINE bool mem_writed_checked(const LinearPt address,const uint32_t val)
 		if (tlb_addr) {
 			host_writed(tlb_addr+address,val);
 			return false;
-		} else return (get_tlb_writehandler(address))->writed_checked(address,val);
+		} else {
+			BINTRACE_Mem(true,4,address,val);
+			return (get_tlb_writehandler(address))->writed_checked(address,val);
+		}
 	} else return mem_unalignedwrited_checked(address,val);
 }
 
@@ -37,6 +37,10 @@ static inline uint8_t pc98_font_char_read(const uint16_t code,const uint8_t line
     return vga.draw.font[pc98_font_char_to_ofs(code,line,right_half)];
 }
 
+/* incremented whenever font RAM changes, so that the text layer glyph cache knows to re-read the CG */
+extern uint32_t pc98_font_serial;
+
 static inline void pc98_font_char_write(const uint16_t code,const uint8_t line,const uint8_t right_half,const uint8_t byte) {
     vga.draw.font[pc98_font_char_to_ofs(code,line,right_half)] = byte;
+    pc98_font_serial++;
 }
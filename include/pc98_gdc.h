@@ -58,11 +58,13 @@ struct PC98_GDC_state {
     void exec(uint8_t command);
     void prepare(void);
     void draw_dot(uint16_t x, uint16_t y);
+    void draw_hline(uint16_t &x, uint16_t y, int16_t step, uint32_t count);
     void pset(void);
     void line(void);
     void text(void);
     void circle(void);
     void box(void);
+    void box_edge(uint16_t &x, uint16_t &y, int16_t dx, int16_t dy, uint16_t count);
     void set_vectl(int x1, int y1, int x2, int y2);
     void set_mode(uint8_t mode);
     void set_csrw(uint32_t ead, uint8_t dad);
@@ -23,11 +23,20 @@
 #define PCI_MAX_PCIDEVICES		    32
 #define PCI_MAX_PCIFUNCTIONS		8
 
+/* config_hooks[] flags */
+#define PCI_CONFIG_HOOK_READ		0x01
+#define PCI_CONFIG_HOOK_WRITE		0x02
+
 class PCI_Device {
 public:
 	/* configuration space */
 	unsigned char config[256];
 	unsigned char config_writemask[256];
+	/* Registers whose access has a side effect in the device model. Accesses that
+	 * touch no hooked byte are served straight from config[] by the CF8h/CFCh
+	 * handlers; only the rest go through config_read()/config_write(). A subclass
+	 * overriding those must mark the registers it acts on. */
+	unsigned char config_hooks[256];
 
 	PCI_Device(uint16_t vendor, uint16_t device);
 	virtual ~PCI_Device();
@@ -48,6 +57,18 @@ public:
 		return host_writew(config + 0x00,vendor);
 	}
 
+	void setConfigHooks(const uint8_t regnum,const unsigned int count,const unsigned char hooks) {
+		for (unsigned int i=0;i < count && (regnum+i) < 256u;i++)
+			config_hooks[regnum+i] |= hooks;
+	}
+	bool configHooked(const uint8_t regnum,const Bitu iolen,const unsigned char hook) const {
+		if (((Bitu)regnum + iolen) > 256u) return true;
+		for (Bitu i=0;i < iolen;i++) {
+			if (config_hooks[regnum+i] & hook) return true;
+		}
+		return false;
+	}
+
 	/* configuration space I/O */
 	virtual void config_write(uint8_t regnum,Bitu iolen,uint32_t value) {
 		if (iolen == 1) {
@@ -102,6 +123,12 @@ void PCI_RemoveSVGADOSBoxIG_Device(void);
 void PCI_AddSST_Device(Bitu type);
 void PCI_RemoveSST_Device(void);
 
+void PCI_AddIDEBusMaster_Device(void);
+void PCI_RemoveIDEBusMaster_Device(void);
+
+void PCI_AddRTL8139_Device(unsigned int irq);
+void PCI_RemoveRTL8139_Device(void);
+
 RealPt PCI_GetPModeInterface(void);
 bool has_pcibus_enable(void);
 
@@ -0,0 +1,31 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_PERFREPORT_H
+#define DOSBOX_PERFREPORT_H
+
+#include <string>
+
+/* -perf-report: the performance counters of the whole run (the ones of the QMP query-perf command)
+ * are written as one JSON object when the emulator exits, to a file or with "-" to stdout. Headless
+ * test runs get a throughput benchmark for free: emulated time, host time and instructions. */
+
+/* called once the emulator is set up, the run is measured from here */
+void PERFREPORT_Start(const std::string& path);
+
+#endif
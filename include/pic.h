@@ -28,6 +28,7 @@ extern cpu_cycles_count_t CPU_CycleMax;
 
 typedef void (PIC_EOIHandler) (void);
 typedef void (* PIC_EventHandler)(Bitu val);
+typedef uint32_t PIC_EventHandle;
 
 enum PIC_irq_hacks {
 	PIC_irq_hack_none=0,		        // dispatch IRQ normally
@@ -82,8 +83,20 @@ bool PIC_RunQueue(void);
 
 //Delay in milliseconds
 void PIC_AddEvent(PIC_EventHandler handler,pic_tickindex_t delay,Bitu val=0);
+//Same as PIC_AddEvent, returns a handle (never 0) to remove that one event in O(log n)
+PIC_EventHandle PIC_AddEventHandle(PIC_EventHandler handler,pic_tickindex_t delay,Bitu val=0);
+//Returns false if the event already fired or was removed
+bool PIC_RemoveEventHandle(PIC_EventHandle handle);
+//Safe to call from any host thread. The event is scheduled "delay" ms of emulated time after
+//PIC_RunQueue next picks it up on the emulation thread.
+void PIC_PostEvent(PIC_EventHandler handler,pic_tickindex_t delay,Bitu val=0);
 void PIC_RemoveEvents(PIC_EventHandler handler);
 void PIC_RemoveSpecificEvents(PIC_EventHandler handler, Bitu val);
+//Removes the events of handler whose (val & mask) matches val
+void PIC_RemoveMaskedEvents(PIC_EventHandler handler, Bitu val, Bitu mask);
+//Events currently scheduled
+unsigned int PIC_QueueDepth(void);
 
 void PIC_SetIRQMask(Bitu irq, bool masked);
+bool PIC_IRQMasked(Bitu irq);
 #endif
@@ -22,6 +22,8 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <list>
+#include <vector>
 
 #include "bios_disk.h"
 
@@ -55,15 +57,29 @@ public:
 	
 	uint8_t read_sector(uint32_t sectnum, uint8_t* data);
 
+	uint8_t read_sectors(uint32_t sectnum, uint32_t count, uint8_t* data);
+
 	uint8_t write_sector(uint32_t sectnum, const uint8_t* data);
+
+	uint8_t write_sectors(uint32_t sectnum, uint32_t count, const uint8_t* data);
 	
 private:
 
+	/* A cached L2 table or refcount block, entries in host byte order. */
+	template <typename T> struct CachedTable {
+		uint64_t offset;
+		std::vector<T> entries;
+	};
+
+	static const size_t l2_cache_tables = 16;
+	static const size_t refcount_cache_blocks = 4;
+
 	FILE* file;
 	QCow2Header header;
 	static const uint64_t copy_flag;
-	static const uint64_t empty_mask;
+	static const uint64_t compressed_flag;
 	static const uint64_t table_entry_mask;
+	static const uint64_t cluster_offset_mask;
 	uint32_t sector_size;
 	uint64_t cluster_mask;
 	uint64_t cluster_size;
@@ -74,6 +90,13 @@ private:
 	uint64_t refcount_mask;
 	uint64_t refcount_bits;
 	QCow2Image* backing_image;
+	std::vector<uint64_t> l1_table;
+	std::vector<uint64_t> refcount_table;
+	std::list< CachedTable<uint64_t> > l2_cache;		/* most recently used first */
+	std::list< CachedTable<uint16_t> > refcount_cache;	/* most recently used first */
+	uint64_t file_end;					/* where the next cluster is allocated, 0 if not known yet */
+	uint64_t compressed_entry;				/* L2 entry of the cluster held in compressed_data */
+	std::vector<uint8_t> compressed_data;
 
 	static uint16_t host_read16(uint16_t buffer);
 
@@ -89,27 +112,33 @@ private:
 
 	uint8_t read_cluster(uint64_t data_cluster_number, uint8_t* data);
 
-	uint8_t read_l1_table(uint64_t address, uint64_t& l2_table_offset);
+	uint8_t load_table(uint64_t file_offset, uint64_t entries, std::vector<uint64_t>& table);
+
+	uint8_t allocate_clusters(uint64_t count, uint64_t& cluster_offset);
 
-	uint8_t read_l2_table(uint64_t l2_table_offset, uint64_t address, uint64_t& data_cluster_offset);
+	uint8_t get_l2_table(uint64_t l2_table_offset, std::vector<uint64_t>*& table);
 
-	uint8_t read_refcount_table(uint64_t data_cluster_offset, uint64_t& refcount_cluster_offset);
+	uint8_t get_refcount_block(uint64_t refcount_cluster_offset, std::vector<uint16_t>*& block);
 
-	uint8_t read_table(uint64_t entry_offset, uint64_t entry_mask, uint64_t& entry_value);
+	uint8_t lookup_cluster(uint64_t address, uint64_t& l2_table_offset, uint64_t& l2_entry);
+
+	uint8_t read_compressed_data(uint64_t l2_entry, uint64_t offset, uint8_t* data, uint64_t data_size);
+
+	uint8_t read_existing_cluster(uint64_t address, uint64_t l2_entry, uint8_t* data);
 
 	uint8_t read_unallocated_cluster(uint64_t data_cluster_number, uint8_t* data);
 
-	uint8_t read_unallocated_sector(uint32_t sectnum, uint8_t* data);
+	uint8_t release_compressed_cluster(uint64_t l2_entry);
 
-	uint8_t update_reference_count(uint64_t cluster_offset, uint8_t* cluster_buffer);
+	uint8_t update_reference_count(uint64_t cluster_offset, uint64_t count);
 
 	uint8_t write_data(uint64_t file_offset, const uint8_t* data, uint64_t data_size);
 
 	uint8_t write_l1_table_entry(uint64_t address, uint64_t l2_table_offset);
 
-	uint8_t write_l2_table_entry(uint64_t l2_table_offset, uint64_t address, uint64_t data_cluster_offset);
+	uint8_t write_l2_table_entries(uint64_t l2_table_offset, uint64_t address, uint64_t count, uint64_t data_cluster_offset);
 
-	uint8_t write_refcount(uint64_t cluster_offset, uint64_t refcount_cluster_offset, uint16_t refcount);
+	uint8_t write_refcounts(uint64_t cluster_offset, uint64_t count, uint64_t refcount_cluster_offset, uint16_t refcount);
 
 	uint8_t write_refcount_table_entry(uint64_t cluster_offset, uint64_t refcount_cluster_offset);
 
@@ -126,8 +155,12 @@ public:
 	
 	uint8_t Read_AbsoluteSector(uint32_t sectnum, void* data) override;
 
+	uint8_t Read_AbsoluteSectors(uint32_t sectnum, uint32_t count, void* data) override;
+
 	uint8_t Write_AbsoluteSector(uint32_t sectnum, const void* data) override;
 
+	uint8_t Write_AbsoluteSectors(uint32_t sectnum, uint32_t count, const void* data) override;
+
 private:
 
 	QCow2Image qcowImage;
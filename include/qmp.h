@@ -109,11 +109,31 @@ private:
     void handle_screendump(const std::string& cmd);
     void handle_savestate(const std::string& cmd);
     void handle_loadstate(const std::string& cmd);
+    void handle_memstate(const std::string& cmd, const std::string& execute);
+    void handle_query_memstates();
     void handle_stop();
     void handle_cont();
     void handle_system_reset(const std::string& cmd);
     void handle_query_status();
     void handle_debug_break_on_exec(const std::string& cmd);
+    void handle_dynrec_profile(const std::string& cmd);
+    void handle_query_dynrec_profile(const std::string& cmd);
+    void handle_guest_profile_start(const std::string& cmd);
+    void handle_guest_profile_stop(const std::string& cmd);
+    void handle_query_tlb_stats();
+    void handle_query_io_stats(const std::string& cmd);
+    void handle_query_audio_stats();
+    void handle_query_perf();
+    void handle_trace(const std::string& cmd, bool start);
+    void handle_query_frame_pacing(const std::string& cmd);
+    void handle_query_host_memory();
+
+    // query-perf: counters at the previous poll, the rates are over the time since
+    bool perf_have_last = false;
+    std::chrono::steady_clock::time_point perf_last_time;
+    uint64_t perf_last_cycles = 0;
+    uint64_t perf_last_frames = 0;
+    Bitu perf_last_ticks = 0;
 
     // Key mapping
     static KBD_KEYS qcode_to_kbd(const std::string& qcode);
@@ -124,13 +144,13 @@ private:
     static int extract_int(const std::string& json, const std::string& key, int default_val);
     static bool extract_bool(const std::string& json, const std::string& key, bool default_val);
     static std::vector<std::string> extract_array(const std::string& json, const std::string& key);
+    static std::string extract_object(const std::string& json, const std::string& key);
 };
 
 // Public interface for debug.cpp
 void QMP_StartServer(int port);
 void QMP_StopServer();
 bool QMP_IsServerRunning();
-void QMP_ProcessPendingInputEvents();
 
 #endif /* C_REMOTEDEBUG */
 
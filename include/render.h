@@ -95,7 +95,16 @@ typedef struct Render_t {
 		Bitu cachePitch;
 		uint8_t *cacheRead;
 		Bitu inHeight, inLine, outLine;
+		bool direct;
 	} scale;
+	struct {
+		Bitu width, height;			/* room the video debug overlay takes right of and below the frame */
+		bool composited;			/* the output draws it as a layer over the frame, see RENDER_OverlayLine */
+		uint32_t *pixels;			/* the layer, (src.width+width) x (src.height+height) ARGB */
+		Bitu pitch;
+		Bitu outHeight;				/* output lines below the scaled frame that belong to the layer */
+		Bitu dirtyTop, dirtyBottom;
+	} overlay;
 	struct {
 		uint8_t *pointer;
 		Bitu width, height;
@@ -184,9 +193,18 @@ extern Render_ttf ttf;
 extern Render_t render;
 extern Bitu last_gfx_flags;
 extern ScalerLineHandler_t RENDER_DrawLine;
+extern uint64_t render_frames_rendered;            // frames that went through RENDER_EndUpdate
+extern uint64_t render_frames_skipped;             // frames dropped by frameskip
 void RENDER_SetSize(Bitu width,Bitu height,Bitu bpp,float fps,double scrn_ratio);
 bool RENDER_StartUpdate(void);
 void RENDER_EndUpdate(bool abort);
+bool RENDER_SkipLine(void);
+uint8_t *RENDER_DirectLine(void);
+void RENDER_OverlayLine(Bitu y,Bitu x,const uint8_t *src,Bitu count);
+bool RENDER_CachingLines(void);
+void RENDER_ScaleBand(const Render_t &frame,ScalerBand_t &band);
+typedef bool (*RENDER_CacheHitHandler_t)(const Bitu *src,const Bitu *cache,Bits count);
+RENDER_CacheHitHandler_t RENDER_GetCacheHit(const char *name);
 void RENDER_SetPal(uint8_t entry,uint8_t red,uint8_t green,uint8_t blue);
 bool RENDER_GetForceUpdate(void);
 void RENDER_SetForceUpdate(bool);
@@ -0,0 +1,32 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Realtek RTL8139 PCI bus mastering Ethernet controller emulation
+ */
+
+#ifndef DOSBOX_RTL8139_H
+#define DOSBOX_RTL8139_H
+
+/* default I/O base of the RTL8139 registers (BAR0), 256 ports */
+#define RTL8139_DEFAULT_IO	0xE000
+
+/* called by the PCI function when its I/O base, command register or interrupt line changes */
+void RTL8139_SetPCIState(unsigned int base,bool io_enable,bool bus_master,unsigned int irq);
+
+#endif
@@ -15,6 +15,8 @@
 #include "zipfile.h"
 
 #include <output/output_gamelink.h>
+#include <output/output_vulkan.h>
+#include <output/output_direct3d11.h>
 
 enum SCREEN_TYPES {
     SCREEN_SURFACE
@@ -24,6 +26,13 @@ enum SCREEN_TYPES {
 #endif
     ,SCREEN_TTF
     ,SCREEN_GAMELINK
+    ,SCREEN_NULL
+#if C_VULKAN
+    ,SCREEN_VULKAN
+#endif
+#if C_DIRECT3D11
+    ,SCREEN_DIRECT3D11
+#endif
 };
 
 enum AUTOLOCK_FEEDBACK
@@ -132,6 +141,7 @@ struct SDL_Block {
     struct {
         Bitu pitch;
         void * framebuf;
+        GameLink::sFrameRect dirty; // part of framebuf changed since the last transfer
         GameLink::sSharedMMapInput_R2 input_prev;
         GameLink::sSharedMMapInput_R2 input;
         GameLink::sSharedMMapAudio_R1 audio;
@@ -139,6 +149,7 @@ struct SDL_Block {
         bool enable;
         bool snoop;
         Bitu loadaddr;
+        int frame_slots; // frame ring size, 0 for none
     } gamelink;
 #endif // C_GAMELINK
     struct {
@@ -245,6 +256,7 @@ void SDL_GL_SwapBuffers(void);
 
 #if defined(C_SDL2)
 void GFX_KeyboardCapture(bool enabled);
+void GFX_PresentWindowSurface(const SDL_Rect *rects, int count);
 #endif
 
 #if defined(WIN32) && !defined(HX_DOS)
@@ -21,6 +21,7 @@
 #define DOSBOX_SERIALPORT_H
 
 #include "inout.h"
+#include "pic.h"
 #include "programs.h"
 
 // set this to 1 for serial debugging in release mode
@@ -424,6 +425,15 @@ private:
 	MyFifo* errorfifo;
 	Bitu errors_in_fifo;
 	Bitu rx_interrupt_threshold;
+	// The FIFO timeout is kept as a deadline that every received or read byte
+	// pushes back. At most one PIC event is outstanding for it; when that fires
+	// early it re-arms itself for the remainder instead of being removed and
+	// re-added for every byte.
+	pic_tickindex_t rx_timeout_deadline;
+	bool rx_timeout_armed;
+	bool rx_timeout_queued;
+	void armRxTimeout();
+	void disarmRxTimeout();
 	Bitu fifosize;
 	uint8_t FCR;
 	bool sync_guardtime;
@@ -0,0 +1,41 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_SHAREDASSET_H
+#define DOSBOX_SHAREDASSET_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/* Read-only data that every DOSBox-X process on the host can share. The built-in program
+ * images and static tables are const data of the executable and already shared by the host's
+ * page cache; this is for what a process loads or builds at runtime. Files are mapped instead
+ * of read into the heap, and data built at runtime goes to the [dosbox] "shared asset directory"
+ * the first time, from where later processes map it. */
+
+/* Maps size bytes of the open file read-only, or reads them into the heap where the host
+ * cannot map files. The data stays after fclose(). NULL on failure. */
+const void *SHARED_MapFile(FILE *fp,size_t size);
+
+/* Data built at runtime, size bytes under a name that identifies the content. build fills the
+ * buffer and returns false on failure. Returns the shared copy, a private one if the directory
+ * cannot be written, or NULL if there is no shared asset directory or build failed. */
+typedef bool (*SHARED_BuildFunc)(void *buf,size_t size,const void *ctx);
+const void *SHARED_Build(const char *name,size_t size,SHARED_BuildFunc build,const void *ctx);
+
+#endif
@@ -73,6 +73,18 @@ public:
 	BatchFile * prev;
 	CommandLine * cmd;
 	std::string filename;
+private:
+	bool LoadContents(void);
+
+	/* In-memory copy of the batch file, reloaded when its size or date changes.
+	 * location stays a byte offset into the file, so a batch file that modifies
+	 * itself continues at the same offset like it does under DOS. */
+	bool loaded = false;
+	uint32_t file_size = 0;
+	uint16_t file_time = 0, file_date = 0;
+	std::vector<char> contents;			// up to the first ^Z
+	std::vector<uint32_t> line_starts;		// offset of every line in contents
+	std::map<std::string,uint32_t> labels;		// upper case label -> offset of the line after it
 };
 
 class AutoexecEditor;
@@ -0,0 +1,50 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_STARTUPPROF_H
+#define DOSBOX_STARTUPPROF_H
+
+#include <stdint.h>
+
+/* Cold start timing, from the process start to the first DOS prompt. Every init function and
+ * VM event handler run before the prompt is timed; the time to the prompt goes into the
+ * -perf-report JSON, and with -startup-profile the phases are logged, slowest first, once the
+ * prompt comes up. Phases nested in another phase are part of the outer one. */
+
+/* true until the first DOS prompt */
+bool STARTUP_Profiling(void);
+void STARTUP_AddPhase(const char *name,uint64_t ns);
+/* the shell calls this whenever it shows the prompt, only the first call counts */
+void STARTUP_PromptReached(void);
+/* milliseconds from the process start to the first DOS prompt, negative if not there yet */
+double STARTUP_PromptMs(void);
+
+class StartupPhase {
+public:
+    StartupPhase(const char *name);
+    ~StartupPhase();
+private:
+    const char *name;
+    uint64_t start;
+    bool counted;
+    bool outer;
+};
+
+#define STARTUP_PHASE(f) do { StartupPhase startup_phase(#f); f; } while (0)
+
+#endif
@@ -0,0 +1,57 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_THREADPOOL_H
+#define DOSBOX_THREADPOOL_H
+
+#include <atomic>
+#include <functional>
+
+/* Process-wide worker pool ("worker threads" and "worker thread affinity" in [dosbox]).
+ * Everything that splits a frame or a buffer into independent slices (xBRZ, the aspect
+ * post-scaler, the threaded simple scalers) hands the slices to this pool instead of starting
+ * threads of its own, so the total number of helper threads is set in one place.
+ *
+ * Each worker has its own task queue. Tasks queued from a worker go to that worker's queue,
+ * tasks queued from any other thread are spread over the queues round robin. An idle worker
+ * takes the newest task of its own queue and otherwise steals the oldest task of another
+ * queue. A thread waiting for a group runs queued tasks itself until the group is done.
+ *
+ * With no workers (one host CPU, or "worker threads=0") tasks run at once on the calling
+ * thread, so callers need no separate single threaded path. */
+class ThreadPoolGroup {
+public:
+    ThreadPoolGroup() {}
+    ~ThreadPoolGroup() { wait(); }
+
+    ThreadPoolGroup(const ThreadPoolGroup&) = delete;
+    ThreadPoolGroup& operator=(const ThreadPoolGroup&) = delete;
+
+    /* queue a task, which may start before run() returns */
+    void run(std::function<void()> task);
+    /* return once every task queued to this group has finished */
+    void wait(void);
+    bool done(void) const { return pending.load(std::memory_order_acquire) == 0; }
+
+    std::atomic<unsigned int> pending{0};
+};
+
+void THREADPOOL_Init(void);
+unsigned int THREADPOOL_Workers(void);
+
+#endif
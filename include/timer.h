@@ -45,4 +45,7 @@ void TIMER_AddTick(void);
 bool TIMER_GetOutput2();
 void TIMER_SetGate2(bool in);
 
+/* Called by the PIC when the guest unmasks IRQ 0 */
+void TIMER_IRQ0Unmasked(void);
+
 #endif
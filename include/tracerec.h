@@ -0,0 +1,63 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_TRACEREC_H
+#define DOSBOX_TRACEREC_H
+
+#include <string>
+
+#include "hosttime.h"
+
+/* Trace recorder. Every host time scope (CPU slices between events, each PIC event and tick handler,
+ * VGA drawing, scalers, present, mixing, disk I/O), frames from RENDER_StartUpdate to RENDER_EndUpdate
+ * and save state phases are written as Chrome trace-event JSON, which chrome://tracing and
+ * ui.perfetto.dev open. Each span is there twice: process 1 is the host time line, process 2 the
+ * emulated time line (PIC_FullIndex). Only the emulation thread is traced. */
+
+#define TRACE_STATE     HOSTTIME_MAX    // save state phases, next to the HOSTTIME_* categories
+
+extern bool trace_recording;
+
+/* path empty: the next file in the capture directory */
+bool TRACE_Start(const std::string& path);
+void TRACE_Stop(void);
+
+/* from another thread (QMP), applied by TRACE_CheckPending on the emulation thread */
+void TRACE_Request(bool start,const std::string& path);
+void TRACE_CheckPending(void);
+
+/* HOSTTIME_Begin and HOSTTIME_End while trace_recording is set */
+bool TRACE_Begin(unsigned int what,const void *key,const char *name);
+void TRACE_End(void);
+
+/* frames span many other scopes, they have their own track */
+void TRACE_Frame(bool start);
+
+class TraceScope {
+public:
+    TraceScope(const char *name) {
+        active = GCC_UNLIKELY(trace_recording) && TRACE_Begin(TRACE_STATE,NULL,name);
+    }
+    ~TraceScope() {
+        if (active) TRACE_End();
+    }
+private:
+    bool active;
+};
+
+#endif
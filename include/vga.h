@@ -66,6 +66,7 @@ enum VGA_Vsync {
 	VS_On,
 	VS_Force,
 	VS_Host,
+	VS_Adaptive,
 };
 
 struct vsync_state {
@@ -216,6 +217,9 @@ typedef struct {
 	bool doublescan_set;
 	bool doublescan_effect;
 	bool char9_set;
+	bool indexed_set;			// [render] "indexed color"
+	bool indexed;				// 256-color lines go out as DAC indices, the output applies the palette
+	bool indexed_blocked;		// palette rewritten mid-frame in this mode, expand on the CPU instead
 	Bitu bpp;
 	double clock;
 	double oscclock;
@@ -689,6 +693,21 @@ typedef struct VGA_DOSBoxIG {
 	uint8_t			vscale = 0; /* vertical pixel duplication */
 } VGA_DOSBoxIG;
 
+/* VRAM write tracking for the scanline renderer. Each 4KB chunk of vga.mem.linear holds the frame
+ * serial of its last write. A scanline that reads only from chunks older than the serial it was last
+ * drawn at is known to produce the same pixels, and VGA_DrawSingleLine can skip it entirely. */
+#define VGA_DIRTY_SHIFT		12u
+
+typedef struct {
+	uint32_t*		stamp = NULL;			/* serial of the last write, per chunk */
+	uint32_t		chunks = 0;
+	uint32_t		serial = 1;			/* advanced at the start of every rendered frame */
+	uint32_t		last_write = 0;			/* serial of the last write anywhere in VRAM */
+	uint32_t		all = 0;			/* serial of the last write not attributed to a chunk */
+	uint32_t		regs = 0;			/* serial of the last register write that can change the picture */
+	bool			direct = false;			/* guest has a direct host pointer, writes bypass tracking */
+} VGA_Dirty;
+
 typedef struct VGA_Type_t {
     VGAModes mode = {};                              /* The mode the vga system is in */
     VGAModes lastmode = {};
@@ -714,6 +733,7 @@ typedef struct VGA_Type_t {
     VGA_Complexity complexity = {};
     VGA_Override overopts = {};
     VGA_DOSBoxIG dosboxig = {};
+    VGA_Dirty dirty = {};
 } VGA_Type;
 
 
@@ -727,8 +747,10 @@ void Mono_CGA_Palette(void);
 void VGA_SetMode(VGAModes mode);
 void VGA_DetermineMode(void);
 void VGA_SetupHandlers(void);
+void VGA_SetupBankWindow(void);
 void VGA_StartResize(Bitu delay=50);
 void VGA_SetupDrawing(Bitu val);
+void VGA_IndexedPaletteSplit(void);
 void VGA_CheckScanLength(void);
 void VGA_ChangedBank(void);
 
@@ -768,6 +790,23 @@ void VGA_SetOverride(bool vga_override);
 
 extern VGA_Type vga;
 
+static inline void VGA_MarkDirty(const Bitu offset) {
+	const Bitu chunk = offset >> VGA_DIRTY_SHIFT;
+	if (GCC_LIKELY(chunk < vga.dirty.chunks))
+		vga.dirty.stamp[chunk] = vga.dirty.serial;
+	else
+		vga.dirty.all = vga.dirty.serial;
+	vga.dirty.last_write = vga.dirty.serial;
+}
+
+static inline void VGA_MarkAllDirty(void) {
+	vga.dirty.all = vga.dirty.last_write = vga.dirty.serial;
+}
+
+static inline void VGA_MarkRegsDirty(void) {
+	vga.dirty.regs = vga.dirty.serial;
+}
+
 /* Support for modular SVGA implementation */
 /* Video mode extra data to be passed to FinishSetMode_SVGA().
    This structure will be in flux until all drivers (including S3)
@@ -845,6 +884,10 @@ bool VGA_DetermineMode_IsDCGA(void);
 void VGA_DetermineMode_StandardVGA(void);
 void VGA_DetermineMode_S3(void);
 
+typedef uint8_t * (* VGA_Line_Handler)(Bitu vidstart, Bitu line);
+/* A line drawer by name for the microbenchmarks in tests/, NULL if unknown. It draws from vga.draw as the caller set it up. */
+VGA_Line_Handler VGA_GetLineDrawer(const char *name);
+
 extern uint32_t ExpandTable[256];
 extern uint32_t FillTable[16];
 extern uint32_t CGA_2_Table[16];
@@ -979,6 +1022,7 @@ void UpdateCGAFromSaveState(void);
 void INT10_PC98_CurMode_Relocate(void);
 unsigned int VGA_ComplexityCheck_ODDEVEN(void);
 void VGA_VsyncUpdateMode(VGA_Vsync vsyncmode);
+void VGA_VsyncPresented(double blocked_ms,double now_ms);
 uint32_t GetReportedVideoMemorySize(void);
 extern void VGA_TweakUserVsyncOffset(float val);
 void VGA_UnsetupMisc(void);
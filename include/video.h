@@ -54,6 +54,7 @@ struct GFX_PalEntry {
 #define GFX_HARDWARE	0x2000u
 
 #define GFX_CAN_RANDOM	0x4000u		//If the interface can also do random access surface
+#define GFX_CAN_DIRECT	0x8000u		//StartUpdate gives plain memory that keeps its contents, lines can be drawn into it in place
 
 void GFX_Events(void);
 void GFX_SetPalette(Bitu start,Bitu count,GFX_PalEntry * entries);
@@ -68,7 +69,21 @@ void GFX_Start(void);
 void GFX_Stop(void);
 void GFX_SwitchFullScreen(void);
 bool GFX_StartUpdate(uint8_t * & pixels,Bitu & pitch);
-void GFX_EndUpdate( const uint16_t *changedLines );
+/* Columns a run of changed lines touched, in output pixels, right exclusive. changedSpans has
+ * one entry per changedLines entry; only those of changed runs (odd index) mean anything, and
+ * right may be past the output width when the renderer did not narrow the run down. */
+struct GFX_ChangedSpan {
+    uint16_t left, right;
+};
+
+void GFX_EndUpdate( const uint16_t *changedLines, const GFX_ChangedSpan *changedSpans = nullptr );
+/* Video debug overlay as a layer of its own ("video debug overlay = composited"). The layer is
+ * width x height ARGB with pitch in pixels, stretched over the same rectangle as the frame and
+ * blended on top of it; rows top to bottom-1 changed. pixels stays valid until the next
+ * GFX_SetSize, which also drops the layer. Call between GFX_StartUpdate and GFX_EndUpdate. */
+bool GFX_CanCompositeOverlay(void);
+void GFX_SetOverlay(const uint32_t *pixels,Bitu width,Bitu height,Bitu pitch,Bitu top,Bitu bottom);
+double GFX_GetHostRefreshRate(void);
 void GFX_GetSize(int &width, int &height, bool &fullscreen);
 void GFX_LosingFocus(void);
 
@@ -78,6 +93,24 @@ bool GFX_LazyFullscreenRequested(void);
 void GFX_SwitchFullscreenNoReset(void);
 void GFX_UpdateSDLCaptureState(void);
 
+/* Output thread ("output thread" in [sdl]). When active, a second thread presents finished
+ * frames and pumps the SDL event queue while the CPU core runs. The emulation owns SDL and
+ * only gives it up for stretches that never call into SDL, see GFX_SDLReleased below. */
+void GFX_OutputThreadStart(void);
+void GFX_OutputThreadStop(void);
+void GFX_ReleaseSDL(void);
+void GFX_AcquireSDL(void);
+void GFX_Delay(uint32_t ms);
+
+//! \brief Gives SDL to the output thread for the lifetime of the object
+class GFX_SDLReleased {
+public:
+    GFX_SDLReleased() { GFX_ReleaseSDL(); }
+    ~GFX_SDLReleased() { GFX_AcquireSDL(); }
+    GFX_SDLReleased(const GFX_SDLReleased&) = delete;
+    GFX_SDLReleased& operator=(const GFX_SDLReleased&) = delete;
+};
+
 #if defined (WIN32)
 bool GFX_SDLUsingWinDIB(void);
 #endif
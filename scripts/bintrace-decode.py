@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+#
+# Decode a DOSBox-X binary access trace ([log] "binary trace file", or the
+# debugger BTRACE command) into one text line per access.
+#
+# usage: bintrace-decode.py [--kind io|mem] [--port XXXX] [--range START-END] trace.dbt
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"DBXTRACE"
+HEADER = struct.Struct("8sIIII")
+KINDS = ("ior", "iow", "memr", "memw")
+
+
+def parse_range(text):
+    start, _, end = text.partition("-")
+    return int(start, 16), int(end or start, 16)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Decode a DOSBox-X binary access trace")
+    ap.add_argument("trace")
+    ap.add_argument("--kind", choices=("io", "mem"), help="only show I/O or memory accesses")
+    ap.add_argument("--port", type=lambda v: int(v, 16), help="only show this I/O port (hex)")
+    ap.add_argument("--range", type=parse_range, help="only show memory accesses in START-END (hex)")
+    args = ap.parse_args()
+
+    with open(args.trace, "rb") as f:
+        raw = f.read(HEADER.size)
+        if len(raw) < HEADER.size:
+            sys.exit("%s: too short for a trace header" % args.trace)
+
+        magic, version, record_size, byte_order, _ = HEADER.unpack(raw)
+        endian = "<"
+        if byte_order != 0x01020304:
+            endian = ">"
+            magic, version, record_size, byte_order, _ = struct.unpack(">8sIIII", raw)
+        if magic != MAGIC or byte_order != 0x01020304:
+            sys.exit("%s: not a DOSBox-X binary trace" % args.trace)
+        if version != 1 or record_size != 24:
+            sys.exit("%s: unsupported trace version %u (record size %u)" % (args.trace, version, record_size))
+
+        record = struct.Struct(endian + "dIIIHBB")
+        while True:
+            raw = f.read(record.size)
+            if len(raw) < record.size:
+                break
+
+            time, addr, value, eip, cs, kind, width = record.unpack(raw)
+            is_io = kind < 2
+            if args.kind == "io" and not is_io:
+                continue
+            if args.kind == "mem" and is_io:
+                continue
+            if args.port is not None and (not is_io or addr != args.port):
+                continue
+            if args.range is not None and (is_io or not args.range[0] <= addr <= args.range[1]):
+                continue
+
+            name = KINDS[kind] if kind < len(KINDS) else "?%u" % kind
+            print("%14.6f %04x:%08x %-6s %08x %0*x" % (time, cs, eip, name + str(width * 8), addr, width * 2, value))
+
+
+if __name__ == "__main__":
+    main()
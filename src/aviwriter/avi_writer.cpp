@@ -46,6 +46,9 @@
 int avi_writer_stream_check_samplecount(avi_writer_stream *s,unsigned int len) {
     if (s == NULL) return 0;
 
+    /* len counts samples from the start of the stream, the array starts at sample_index_base */
+    len -= s->sample_index_base;
+
     if (s->sample_index == NULL) {
         s->sample_index_alloc = len + 256;
         s->sample_index = (avi_writer_stream_index*)
@@ -191,7 +194,7 @@ int avi_writer_open_file(avi_writer *w,const char *path) {
     if ((w->riff = riff_stack_create(256)) == NULL)
         goto errout;
 
-    assert(riff_stack_assign_fd(w->riff,w->fd));
+    assert(riff_stack_assign_fd_writebehind(w->riff,w->fd));
     assert(riff_stack_empty(w->riff));
     assert(riff_stack_prepare_for_writing(w->riff,1));
 
@@ -359,6 +362,68 @@ int avi_writer_begin_header(avi_writer *w) {
     return 1;
 }
 
+/* drop the index entries that are already in ix## chunks (and AVIOLDINDEX, if any), keeping
+ * the last one of each stream for avi_writer_stream_repeat_last_chunk(). a capture of many
+ * hours then holds on to one movi chunk worth of index at a time */
+static void avi_writer_trim_sample_index(avi_writer *w) {
+    avi_writer_stream *s;
+    unsigned int drop;
+    int stream;
+
+    if (w->enable_avioldindex && !w->wrote_idx1) return;
+
+    for (stream=0;stream < w->avi_stream_max;stream++) {
+        s = w->avi_stream + stream;
+        if (s->sample_index == NULL || s->sample_index_emitted <= (s->sample_index_base + 1)) continue;
+
+        drop = s->sample_index_emitted - 1 - s->sample_index_base;
+        memmove(s->sample_index,s->sample_index + drop,
+            sizeof(avi_writer_stream_index) * (s->sample_index_max - s->sample_index_base - drop));
+        s->sample_index_base += drop;
+    }
+}
+
+/* OpenDML: close off this RIFF:AVI(X) and movi at about 1GB and start a RIFF:AVIX.
+ * caller must ensure we're at the movi chunk level */
+static void avi_writer_begin_avix(avi_writer *w) {
+    riff_chunk chunk;
+
+    /* index the samples of this movi now, inside it, rather than all of them at the end */
+    avi_writer_emit_opendml_indexes(w);
+
+    riff_stack_writing_sync(w->riff); /* sync all headers and pop all chunks */
+    assert(w->riff->current == -1); /* should be at top level */
+
+    /* at the first 1GB boundary emit AVIOLDINDEX for older AVI applications */
+    if (w->group == 0 && w->enable_avioldindex)
+        avi_writer_emit_avioldindex(w);
+
+    avi_writer_trim_sample_index(w);
+
+    /* [1] RIFF:AVIX */
+    assert(riff_stack_begin_new_chunk_here(w->riff,&chunk));
+    assert(riff_stack_set_chunk_list_type(&chunk,riff_RIFF,riff_fourcc_const('A','V','I','X')));
+    if (w->enable_stream_writing) {
+        assert(riff_stack_enable_placeholder(w->riff,&chunk));
+        chunk.disable_sync = 1;
+    }
+    assert(riff_stack_push(w->riff,&chunk)); /* NTS: we can reuse chunk, the stack copies it here */
+    if (w->enable_stream_writing) riff_stack_header_sync(w->riff,riff_stack_top(w->riff));
+
+    /* start the movi chunk */
+    assert(riff_stack_begin_new_chunk_here(w->riff,&chunk));
+    assert(riff_stack_set_chunk_list_type(&chunk,riff_LIST,riff_fourcc_const('m','o','v','i')));
+    if (w->enable_stream_writing) {
+        assert(riff_stack_enable_placeholder(w->riff,&chunk));
+        chunk.disable_sync = 1;
+    }
+    assert(riff_stack_push(w->riff,&chunk)); /* NTS: we can reuse chunk, the stack copies it here */
+    if (w->enable_stream_writing) riff_stack_header_sync(w->riff,riff_stack_top(w->riff));
+    w->movi = chunk;
+
+    w->group++;
+}
+
 int avi_writer_stream_repeat_last_chunk(avi_writer *w,avi_writer_stream *s) {
     avi_writer_stream_index *si,*psi;
     riff_chunk chunk;
@@ -383,37 +448,8 @@ int avi_writer_stream_repeat_last_chunk(avi_writer *w,avi_writer_stream *s) {
     if (w->enable_opendml) {
         /* if we're writing an OpenDML 2.0 compliant file, and we're approaching a movi size of 1GB,
          * then split the movi chunk and start another RIFF:AVIX */
-        if ((unsigned long long)(w->riff->top->write_offset + 8) >= 0x3FF00000ULL) { /* 1GB - 16MB */
-            riff_stack_writing_sync(w->riff); /* sync all headers and pop all chunks */
-            assert(w->riff->current == -1); /* should be at top level */
-
-            /* at the first 1GB boundary emit AVIOLDINDEX for older AVI applications */
-            if (w->group == 0 && w->enable_avioldindex)
-                avi_writer_emit_avioldindex(w);
-
-            /* [1] RIFF:AVIX */
-            assert(riff_stack_begin_new_chunk_here(w->riff,&chunk));
-            assert(riff_stack_set_chunk_list_type(&chunk,riff_RIFF,riff_fourcc_const('A','V','I','X')));
-            if (w->enable_stream_writing) {
-                assert(riff_stack_enable_placeholder(w->riff,&chunk));
-                chunk.disable_sync = 1;
-            }
-            assert(riff_stack_push(w->riff,&chunk)); /* NTS: we can reuse chunk, the stack copies it here */
-            if (w->enable_stream_writing) riff_stack_header_sync(w->riff,riff_stack_top(w->riff));
-
-            /* start the movi chunk */
-            assert(riff_stack_begin_new_chunk_here(w->riff,&chunk));
-            assert(riff_stack_set_chunk_list_type(&chunk,riff_LIST,riff_fourcc_const('m','o','v','i')));
-            if (w->enable_stream_writing) {
-                assert(riff_stack_enable_placeholder(w->riff,&chunk));
-                chunk.disable_sync = 1;
-            }
-            assert(riff_stack_push(w->riff,&chunk)); /* NTS: we can reuse chunk, the stack copies it here */
-            if (w->enable_stream_writing) riff_stack_header_sync(w->riff,riff_stack_top(w->riff));
-            w->movi = chunk;
-
-            w->group++;
-        }
+        if ((unsigned long long)(w->riff->top->write_offset + 8) >= 0x3FF00000ULL) /* 1GB - 16MB */
+            avi_writer_begin_avix(w);
     }
     else {
         /* else, if we're about to pass 2GB, then stop allowing any more data, because the traditional
@@ -438,11 +474,12 @@ int avi_writer_stream_repeat_last_chunk(avi_writer *w,avi_writer_stream *s) {
      *      to fulfill the request */
     assert(s->sample_index != NULL);
     assert(s->sample_index_max >= s->sample_write_chunk);
-    psi = s->sample_index + s->sample_write_chunk - 1;
+    assert(s->sample_write_chunk > s->sample_index_base);
+    psi = s->sample_index + (s->sample_write_chunk - s->sample_index_base) - 1;
 
     s->sample_index_max = s->sample_write_chunk+1;
-    assert(s->sample_index_max < s->sample_index_alloc);
-    si = s->sample_index + s->sample_write_chunk;
+    assert((s->sample_index_max - s->sample_index_base) < s->sample_index_alloc);
+    si = s->sample_index + (s->sample_write_chunk - s->sample_index_base);
 
     *si = *psi;
     si->stream_offset = s->sample_write_offset;
@@ -483,37 +520,8 @@ int avi_writer_stream_write(avi_writer *w,avi_writer_stream *s,void *data,size_t
     if (w->enable_opendml) {
         /* if we're writing an OpenDML 2.0 compliant file, and we're approaching a movi size of 1GB,
          * then split the movi chunk and start another RIFF:AVIX */
-        if (((unsigned long long)w->riff->top->write_offset + (unsigned long long)len) >= 0x3FF00000ULL) { /* 1GB - 16MB */
-            riff_stack_writing_sync(w->riff); /* sync all headers and pop all chunks */
-            assert(w->riff->current == -1); /* should be at top level */
-
-            /* at the first 1GB boundary emit AVIOLDINDEX for older AVI applications */
-            if (w->group == 0 && w->enable_avioldindex)
-                avi_writer_emit_avioldindex(w);
-
-            /* [1] RIFF:AVIX */
-            assert(riff_stack_begin_new_chunk_here(w->riff,&chunk));
-            assert(riff_stack_set_chunk_list_type(&chunk,riff_RIFF,riff_fourcc_const('A','V','I','X')));
-            if (w->enable_stream_writing) {
-                assert(riff_stack_enable_placeholder(w->riff,&chunk));
-                chunk.disable_sync = 1;
-            }
-            assert(riff_stack_push(w->riff,&chunk)); /* NTS: we can reuse chunk, the stack copies it here */
-            if (w->enable_stream_writing) riff_stack_header_sync(w->riff,riff_stack_top(w->riff));
-
-            /* start the movi chunk */
-            assert(riff_stack_begin_new_chunk_here(w->riff,&chunk));
-            assert(riff_stack_set_chunk_list_type(&chunk,riff_LIST,riff_fourcc_const('m','o','v','i')));
-            if (w->enable_stream_writing) {
-                assert(riff_stack_enable_placeholder(w->riff,&chunk));
-                chunk.disable_sync = 1;
-            }
-            assert(riff_stack_push(w->riff,&chunk)); /* NTS: we can reuse chunk, the stack copies it here */
-            if (w->enable_stream_writing) riff_stack_header_sync(w->riff,riff_stack_top(w->riff));
-            w->movi = chunk;
-
-            w->group++;
-        }
+        if (((unsigned long long)w->riff->top->write_offset + (unsigned long long)len) >= 0x3FF00000ULL) /* 1GB - 16MB */
+            avi_writer_begin_avix(w);
     }
     else {
         /* else, if we're about to pass 2GB, then stop allowing any more data, because the traditional
@@ -546,8 +554,8 @@ int avi_writer_stream_write(avi_writer *w,avi_writer_stream *s,void *data,size_t
         return 0;
 
     s->sample_index_max = s->sample_write_chunk+1;
-    assert(s->sample_index_max < s->sample_index_alloc);
-    si = s->sample_index + s->sample_write_chunk;
+    assert((s->sample_index_max - s->sample_index_base) < s->sample_index_alloc);
+    si = s->sample_index + (s->sample_write_chunk - s->sample_index_base);
 
     si->stream_offset = s->sample_write_offset;
     si->offset = (uint64_t)chunk.absolute_data_offset;
@@ -772,16 +780,16 @@ int avi_writer_emit_opendml_indexes(avi_writer *w) {
     if (!w->enable_opendml_index) return 0;
     if (avi_io_buffer_init(sizeof(*stdie)) == NULL) return 0;
 
+    /* may be called once per movi chunk, each call indexes the samples written since the last one */
     for (stream=0;stream < w->avi_stream_max;stream++) {
         s = w->avi_stream + stream;
-        if (s->indx_entryofs != 0) break;
         if (s->sample_index == NULL) continue;
         in1 = ((stream / 10) % 10) + '0';
         in2 = (stream % 10) + '0';
 
-        for (chunk=0;chunk < s->sample_index_max;) {
+        for (chunk=s->sample_index_emitted;chunk < s->sample_index_max;) {
             /* scan up to 2000 samples, and determine a good base offset for them */
-            si = s->sample_index + chunk;
+            si = s->sample_index + (chunk - s->sample_index_base);
             chunk_ofs = chunk_max = si->offset;
             chks = chunk + 1; si++;
             while (chks < (chunk + 2000) && chks < s->sample_index_max) {
@@ -826,7 +834,7 @@ int avi_writer_emit_opendml_indexes(avi_writer *w) {
 
             avi_io_write = avi_io_buf;
             while (chunk < s->sample_index_max) {
-                si = s->sample_index + chunk;
+                si = s->sample_index + (chunk - s->sample_index_base);
 
                 offset = (long long)si->offset - (long long)chunk_ofs;
                 if (offset < 0LL || offset >= 0x7FFF0000LL)
@@ -871,6 +879,7 @@ int avi_writer_emit_opendml_indexes(avi_writer *w) {
             suie.dwSize = newchunk.data_length + 8;
             assert(riff_stack_seek(w->riff,NULL,(int64_t)superindex) == (int64_t)superindex);
             assert(riff_stack_write(w->riff,NULL,&suie,sizeof(suie)) == (int)sizeof(suie));
+            s->sample_index_emitted = chunk;
         }
     }
 
@@ -47,6 +47,8 @@ typedef struct avi_writer_stream {
 	riff_chunk			strh,indx,indx_junk;
 	avi_writer_stream_index*	sample_index;
 	unsigned int			sample_index_alloc,sample_index_max;
+	unsigned int			sample_index_base;	/* sample number of sample_index[0], earlier entries were dropped once indexed */
+	unsigned int			sample_index_emitted;	/* samples up to here are in ix## chunks already */
 	unsigned int			sample_write_offset;
 	unsigned int			sample_write_chunk;
 	unsigned int			indx_entryofs;
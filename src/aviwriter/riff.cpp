@@ -28,6 +28,12 @@
 # include <io.h>
 #endif
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 int riff_std_read(void *a,void *b,size_t c) {
 	riff_stack *rs;
 	int rd;
@@ -113,7 +119,10 @@ void riff_stack_close_source(riff_stack *s) {
  *      If you want the RIFF stack to take ownership, and automatically
  *      free the descriptor on destruction/close, then you would call
  *      this function then call riff_stack_assign_fd_ownershop() */
+static void riff_stack_writebehind_stop(riff_stack *s);
+
 int riff_stack_assign_fd(riff_stack *s,int fd) {
+	riff_stack_writebehind_stop(s);
 	if (fd != s->fd) {
 		riff_stack_close_source(s);
 		s->fd_owner = 0;
@@ -133,6 +142,7 @@ int riff_stack_assign_fd_ownership(riff_stack *s) {
 }
 
 int riff_stack_assign_buffer(riff_stack *s,void *buffer,size_t len) {
+	riff_stack_writebehind_stop(s);
 	s->fd = -1;
 	s->buflen = len;
 	s->buffer = buffer;
@@ -144,6 +154,269 @@ int riff_stack_assign_buffer(riff_stack *s,void *buffer,size_t len) {
 	return 1;
 }
 
+/* Write-behind output. Writes are gathered in large page aligned blocks that a background
+ * thread writes to the file while the caller goes on, so a capture is not held up by the
+ * latency of the disk or network share for every chunk. Small writes to data behind the
+ * block being filled (header size updates from riff_stack_header_sync() and friends) are
+ * kept as patches in that block and written right after its data, which keeps them in order
+ * with the blocks queued before. The caller only waits when every block is in flight. */
+#define RIFF_WB_BLOCK_SIZE		(4UL << 20UL)
+#define RIFF_WB_BLOCKS			4
+#define RIFF_WB_PATCH_MAX		4096		/* bytes, larger writes behind the block start a new block */
+#define RIFF_WB_PATCHES_MAX		256
+
+struct riff_wb_patch {
+	int64_t				offset;
+	std::vector<unsigned char>	data;
+};
+
+struct riff_wb_block {
+	int64_t				offset;
+	size_t				len;
+	unsigned char*			mem;
+	unsigned char*			buf;		/* mem, aligned to a page */
+	std::vector<riff_wb_patch>	patches;
+};
+
+struct riff_writebehind {
+	int				fd;
+	int64_t				pos;		/* the caller's file pointer */
+	riff_wb_block*			cur;		/* block being filled */
+	std::vector<riff_wb_block*>	blocks;
+	std::vector<riff_wb_block*>	idle;
+	std::deque<riff_wb_block*>	queue;
+	unsigned int			busy;		/* blocks queued or being written */
+	bool				run;
+	bool				failed;
+	std::mutex			mutex;
+	std::condition_variable		cond;
+	std::thread			thread;
+};
+
+static bool riff_wb_pwrite(int fd,const unsigned char *p,size_t len,int64_t offset) {
+	while (len > 0) {
+		size_t n = len > 0x40000000UL ? 0x40000000UL : len;
+#if defined(_WIN32)
+		if (_lseeki64(fd,offset,SEEK_SET) != offset) return false;
+		int rd = (int)write(fd,p,(unsigned int)n);
+#else
+		ssize_t rd = pwrite(fd,p,n,(off_t)offset);
+#endif
+		if (rd <= 0) return false;
+		p += rd;
+		len -= (size_t)rd;
+		offset += rd;
+	}
+	return true;
+}
+
+static void riff_wb_thread(riff_writebehind *wb) {
+	std::unique_lock<std::mutex> lock(wb->mutex);
+
+	for (;;) {
+		wb->cond.wait(lock,[wb] { return !wb->queue.empty() || !wb->run; });
+		if (wb->queue.empty()) break; /* stopping and drained */
+
+		riff_wb_block *b = wb->queue.front();
+		wb->queue.pop_front();
+		lock.unlock();
+
+		bool ok = riff_wb_pwrite(wb->fd,b->buf,b->len,b->offset);
+		for (auto &p : b->patches) {
+			if (!ok) break;
+			ok = riff_wb_pwrite(wb->fd,p.data.data(),p.data.size(),p.offset);
+		}
+		b->len = 0;
+		b->patches.clear();
+
+		lock.lock();
+		if (!ok) wb->failed = true;
+		wb->idle.push_back(b);
+		wb->busy--;
+		wb->cond.notify_all();
+	}
+}
+
+/* hand the current block to the thread and take an idle one, waiting if there is none */
+static void riff_wb_submit(riff_writebehind *wb) {
+	std::unique_lock<std::mutex> lock(wb->mutex);
+
+	if (wb->cur->len != 0 || !wb->cur->patches.empty()) {
+		wb->queue.push_back(wb->cur);
+		wb->busy++;
+		wb->cond.notify_all();
+		wb->cond.wait(lock,[wb] { return !wb->idle.empty(); });
+		wb->cur = wb->idle.back();
+		wb->idle.pop_back();
+	}
+	wb->cur->len = 0;
+	wb->cur->offset = wb->pos;
+}
+
+int riff_wb_write(void *a,const void *b,size_t c) {
+	riff_stack *rs = (riff_stack*)a;
+	riff_writebehind *wb = rs->writebehind;
+	const unsigned char *p = (const unsigned char*)b;
+	size_t left = c;
+
+	if (wb == NULL) return -1;
+	{
+		std::lock_guard<std::mutex> lock(wb->mutex);
+		if (wb->failed) return -1;
+	}
+
+	riff_wb_block *blk = wb->cur;
+	if (blk->len == 0) {
+		blk->offset = wb->pos;
+	}
+	else if ((wb->pos + (int64_t)c) <= blk->offset && c <= RIFF_WB_PATCH_MAX) {
+		/* patch something already passed on. rewriting the same field again just replaces
+		 * the data, unless a later patch overlaps it and the order matters */
+		riff_wb_patch *same = NULL;
+		for (size_t i=blk->patches.size();i-- > 0;) {
+			riff_wb_patch &pt = blk->patches[i];
+			if ((pt.offset + (int64_t)pt.data.size()) <= wb->pos || (wb->pos + (int64_t)c) <= pt.offset) continue;
+			if (pt.offset == wb->pos && pt.data.size() == c) same = &pt;
+			break;
+		}
+		if (same != NULL) {
+			memcpy(same->data.data(),p,c);
+		}
+		else {
+			riff_wb_patch pt;
+			pt.offset = wb->pos;
+			pt.data.assign(p,p+c);
+			blk->patches.push_back(std::move(pt));
+		}
+		wb->pos += (int64_t)c;
+		if (blk->patches.size() >= RIFF_WB_PATCHES_MAX) riff_wb_submit(wb);
+		return (int)c;
+	}
+	else if (wb->pos < blk->offset || wb->pos > (blk->offset + (int64_t)blk->len)) {
+		/* not contiguous with the block */
+		riff_wb_submit(wb);
+		blk = wb->cur;
+	}
+
+	while (left > 0) {
+		size_t at = (size_t)(wb->pos - blk->offset);
+		if (at >= RIFF_WB_BLOCK_SIZE) {
+			riff_wb_submit(wb);
+			blk = wb->cur;
+			continue;
+		}
+
+		size_t n = RIFF_WB_BLOCK_SIZE - at;
+		if (n > left) n = left;
+		memcpy(blk->buf+at,p,n);
+		if (blk->len < (at+n)) blk->len = at+n;
+		wb->pos += (int64_t)n;
+		p += n;
+		left -= n;
+	}
+
+	return (int)c;
+}
+
+int64_t riff_wb_seek(void *a,int64_t offset) {
+	riff_stack *rs = (riff_stack*)a;
+	if (rs->writebehind == NULL || offset < 0LL) return -1;
+	rs->writebehind->pos = offset;
+	return offset;
+}
+
+int riff_wb_read(void *a,void *b,size_t c) {
+	riff_stack *rs = (riff_stack*)a;
+	riff_writebehind *wb = rs->writebehind;
+	int rd;
+
+	/* reading back has to see everything written so far */
+	if (wb == NULL || !riff_stack_writebehind_flush(rs)) return -1;
+#if defined(_MSC_VER)
+	if (_lseeki64(wb->fd,wb->pos,SEEK_SET) != wb->pos) return -1;
+#else
+	if (lseek(wb->fd,(off_t)wb->pos,SEEK_SET) != (off_t)wb->pos) return -1;
+#endif
+	rd = (int)read(wb->fd,b,(unsigned int)c);
+	if (rd > 0) wb->pos += rd;
+	return rd;
+}
+
+/* write out everything buffered and wait for it. returns 0 if any write failed */
+int riff_stack_writebehind_flush(riff_stack *s) {
+	riff_writebehind *wb = s->writebehind;
+	if (wb == NULL) return 1;
+
+	riff_wb_submit(wb);
+
+	std::unique_lock<std::mutex> lock(wb->mutex);
+	wb->cond.wait(lock,[wb] { return wb->busy == 0; });
+	return wb->failed ? 0 : 1;
+}
+
+static void riff_stack_writebehind_stop(riff_stack *s) {
+	riff_writebehind *wb = s->writebehind;
+	if (wb == NULL) return;
+
+	riff_stack_writebehind_flush(s);
+	{
+		std::lock_guard<std::mutex> lock(wb->mutex);
+		wb->run = false;
+	}
+	wb->cond.notify_all();
+	wb->thread.join();
+
+	for (auto b : wb->blocks) {
+		free(b->mem);
+		delete b;
+	}
+	delete wb;
+	s->writebehind = NULL;
+}
+
+/* like riff_stack_assign_fd() but with write-behind buffering, for files that are only written */
+int riff_stack_assign_fd_writebehind(riff_stack *s,int fd) {
+	riff_writebehind *wb;
+
+	if (!riff_stack_assign_fd(s,fd)) return 0;
+
+	wb = new riff_writebehind();
+	wb->fd = fd;
+	wb->pos = 0;
+	wb->busy = 0;
+	wb->run = true;
+	wb->failed = false;
+	for (unsigned int i=0;i < RIFF_WB_BLOCKS;i++) {
+		riff_wb_block *b = new riff_wb_block();
+		b->mem = (unsigned char*)malloc(RIFF_WB_BLOCK_SIZE + 4095UL);
+		if (b->mem == NULL) {
+			delete b;
+			break;
+		}
+		b->buf = (unsigned char*)(((uintptr_t)b->mem + 4095UL) & ~((uintptr_t)4095UL));
+		b->offset = 0;
+		b->len = 0;
+		wb->blocks.push_back(b);
+	}
+	if (wb->blocks.size() < 2) {
+		for (auto b : wb->blocks) {
+			free(b->mem);
+			delete b;
+		}
+		delete wb;
+		return 1; /* plain synchronous writes then */
+	}
+	wb->cur = wb->blocks[0];
+	wb->idle.assign(wb->blocks.begin()+1,wb->blocks.end());
+
+	s->writebehind = wb;
+	s->read = riff_wb_read;
+	s->seek = riff_wb_seek;
+	s->write = riff_wb_write;
+	wb->thread = std::thread(riff_wb_thread,wb);
+	return 1;
+}
+
 riff_stack *riff_stack_create(int depth) {
 	riff_stack *s = (riff_stack*)malloc(sizeof(riff_stack));
 	if (!s) return NULL;
@@ -167,6 +440,7 @@ riff_stack *riff_stack_create(int depth) {
 
 riff_stack *riff_stack_destroy(riff_stack *s) {
 	if (s) {
+		riff_stack_writebehind_stop(s);
 		riff_stack_close_source(s);
 		if (s->stack) free(s->stack);
 		free(s);
@@ -70,6 +70,8 @@ static const riff_chunk RIFF_CHUNK_INIT = {
 	0
 };
 
+struct riff_writebehind;
+
 typedef struct {
 	int			current,depth;
 	riff_chunk		*stack,*top;
@@ -100,6 +102,9 @@ typedef struct {
 
 	/* more flags */
 	unsigned int		fd_owner:1;		/* if set, we take ownership of the file descriptor */
+
+	/* write-behind state, if riff_stack_assign_fd_writebehind() was used */
+	struct riff_writebehind*	writebehind;
 } riff_stack;
 
 int riff_std_read(void *a,void *b,size_t c);
@@ -120,6 +125,8 @@ int riff_stack_streamwrite(riff_stack *s,riff_chunk *c,const void *buf,size_t le
 int64_t riff_stack_current_chunk_offset(riff_stack *s);
 int riff_stack_assign_fd(riff_stack *s,int fd);
 int riff_stack_assign_fd_ownership(riff_stack *s);
+int riff_stack_assign_fd_writebehind(riff_stack *s,int fd);
+int riff_stack_writebehind_flush(riff_stack *s);
 int riff_stack_assign_buffer(riff_stack *s,void *buffer,size_t len);
 int riff_stack_chunk_contains_subchunks(riff_chunk *c);
 int riff_stack_readchunk(riff_stack *s,riff_chunk *pc,riff_chunk *c);
@@ -131,7 +131,7 @@ int riff_wav_writer_open_file(riff_wav_writer *w,const char *path) {
 		return 0;
 	if ((w->fd = open(path,O_WRONLY|O_CREAT|O_TRUNC|O_BINARY,0644)) < 0)
 		return 0;
-	if (!riff_stack_assign_fd(w->riff,w->fd)) {
+	if (!riff_stack_assign_fd_writebehind(w->riff,w->fd)) {
 		close(w->fd);
 		w->fd = -1;
 	}
@@ -192,8 +192,9 @@ riff_wav_writer *riff_wav_writer_destroy(riff_wav_writer *w) {
 	if (w) {
 		riff_wav_writer_fsync(w);
 		if (w->fmt) free(w->fmt);
-		if (w->fd >= 0 && w->own_fd) close(w->fd);
+		/* the RIFF stack may still have writes in flight, finish them before closing */
 		if (w->riff) riff_stack_destroy(w->riff);
+		if (w->fd >= 0 && w->own_fd) close(w->fd);
 		free(w);
 	}
 	return NULL;
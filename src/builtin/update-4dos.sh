@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+# Regenerates 4dos.cpp from the files of a 4DOS directory (default /usr/src/4dos).
+# The files are stored gzip compressed and expanded when first opened on drive Z:
+# (see BuiltinFileBlob in dos_inc.h).
+srcdir="${1:-/usr/src/4dos}"
+cppfile="4dos.cpp"
+
+cat >$cppfile <<_EOF
+
+#include "dos_inc.h"
+
+_EOF
+
+blobs=""
+for filename in 4DOS.COM 4DOS.HLP 4HELP.EXE BATCOMP.EXE EXAMPLES.BTM LICENSE.TXT OPTION.EXE; do
+    [ -f "$srcdir/$filename" ] || { echo "$srcdir/$filename not found"; exit 1; }
+    lower=$(echo "$filename" | tr 'A-Z.' 'a-z_')
+    upper=$(echo "$filename" | tr '.' '_')
+    dst_sym="bin_$lower"
+    length=$(wc -c <"$srcdir/$filename")
+
+    echo "static const unsigned char $dst_sym[] = {" >>$cppfile
+    gzip -9 -n -c "$srcdir/$filename" | xxd -i >>$cppfile || exit 1
+    echo "};" >>$cppfile
+    echo >>$cppfile
+
+    blobs="$blobs
+struct BuiltinFileBlob bfb_$upper = {
+    /*recommended file name*/	\"$filename\",
+	/*data*/			$dst_sym,
+	/*length*/			$length,
+	/*packed length*/		sizeof($dst_sym)
+};
+"
+done
+
+echo "$blobs" >>$cppfile
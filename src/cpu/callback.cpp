@@ -107,6 +107,31 @@ void CALLBACK_DeAllocate(Bitu in) {
 	CALLBACK_SetDescription(in,NULL);
 }
 
+Bitu CALLBACK_DirectDispatch(void) {
+	/* real mode only, and not while single stepping so the trap lands on the stub as before */
+	if (cpu.pmode || GETFLAG(TF) || SegValue(cs) != CB_SEG) return 0;
+	if (reg_eip < CB_SOFFSET) return 0;
+
+	const uint32_t off = reg_eip - CB_SOFFSET;
+	if ((off % CB_SIZE) != 0 || (off / CB_SIZE) >= CB_MAX) return 0;
+
+	/* the stub is [STI] GRP4 callback imm16, check it is still there and its own */
+	PhysPt p = SegPhys(cs) + reg_eip;
+	bool sti = false;
+	if (phys_readb(p) == 0xFB) {
+		sti = true;
+		p++;
+	}
+	if (phys_readb(p) != 0xFE || phys_readb(p+1) != 0x38) return 0;
+
+	const Bitu cb = phys_readw(p+2);
+	if (cb == 0 || cb != (off / CB_SIZE) || CallBack_Handlers[cb] == NULL || CallBack_Handlers[cb] == &illegal_handler) return 0;
+
+	if (sti) reg_flags|=FLAG_IF;
+	reg_eip = (uint32_t)(p + 4 - SegPhys(cs));
+	return cb;
+}
+
 
 void CALLBACK_Idle(void) {
 #if C_EMSCRIPTEN
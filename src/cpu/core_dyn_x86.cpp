@@ -40,6 +40,7 @@
 #include "debug.h"
 #include "paging.h"
 #include "fpu.h"
+#include "hostmem.h"
 
 #define CACHE_MAXSIZE	(4096*8)
 #define CACHE_TOTAL		(1024*1024*8)
@@ -627,6 +628,12 @@ void CPU_Core_Dyn_X86_Cache_Reset(void) {
 	cache_reset();
 }
 
+void CPU_Core_Dyn_X86_GetHostMemory(HostMemSize &sz) {
+	if (cache_code_start_ptr) sz.add(cache_code_start_ptr,CACHE_TOTAL+CACHE_MAXSIZE+PAGESIZE_TEMP);
+	if (cache_blocks) sz.add_heap(CACHE_BLOCKS*sizeof(CacheBlock));
+	if (cache_initialized) sz.add_heap(CACHE_PAGES*sizeof(CodePageHandler));
+}
+
 void CPU_Core_Dyn_X86_SetFPUMode(bool dh_fpu) {
 #if defined(X86_DYNFPU_DH_ENABLED)
 	dyn_dh_fpu.dh_fpu_enabled=dh_fpu;
@@ -20,7 +20,9 @@
 #include <stddef.h>
 
 #define X86_DYNFPU_DH_ENABLED
+#if !C_SPARSE_TLB /* the inlined accesses index the flat tlb arrays */
 #define X86_INLINED_MEMACCESS
+#endif
 
 #define X86_DYNREC_MMX_ENABLED
 
@@ -657,8 +659,8 @@ static void dyn_read_word(DynReg * addr,DynReg * dst,bool dword) {
 }
 static void dyn_write_word(DynReg * addr,DynReg * val,bool dword) {
 	gen_protectflags();
-	if (dword) dyn_call_function_pagefault_check((void *)&mem_writed_checked_pf,"%Dd%Dd",addr,val)
-	else dyn_call_function_pagefault_check((void *)&mem_writew_checked_pf,"%Dd%Dd",addr,val)
+	if (dword) dyn_call_function_pagefault_check((void *)&mem_writed_checked,"%Dd%Dd",addr,val)
+	else dyn_call_function_pagefault_check((void *)&mem_writew_checked,"%Dd%Dd",addr,val)
 	dyn_check_bool_exception_al();
 }
 static void dyn_read_byte_release(DynReg * addr,DynReg * dst,bool high) {
@@ -2462,6 +2464,90 @@ static void dyn_larlsl(bool islar) {
 	gen_fill_branch(br);
 }
 
+/* Flag liveness look-ahead: the flags are dead during the instruction at
+   decode.code if it doesn't read them and the next instruction overwrites
+   all of them without reading. Then nothing has to be saved when host
+   code clobbers the flags, see set_deadflags. Only simple instructions
+   are considered and both have to be in the current page, so the next
+   instruction is always translated into the same block. */
+static bool dyn_lookahead_deadflags(void) {
+	Bitu index=decode.page.index;
+	PhysPt code=decode.code;
+	if (decode.page.invmap && index<4096 && decode.page.invmap[index]) return false;
+	bool big_op=cpu.code.big,big_addr=cpu.code.big;
+	Bitu len=0,opcode;
+	for (;;) {
+		if (index+len>=4096) return false;
+		opcode=mem_readb(code+len++);
+		if (opcode==0x66) big_op=!cpu.code.big;
+		else if (opcode==0x67) big_addr=!cpu.code.big;
+		else if (opcode!=0x26 && opcode!=0x2e && opcode!=0x36 && opcode!=0x3e &&
+			opcode!=0x64 && opcode!=0x65) break;
+	}
+	bool modrm=false;
+	Bitu imm=0;
+	if (opcode<0x40) {
+		/* add/or/and/sub/xor/cmp, adc/sbb read the carry */
+		if ((opcode&7)>5 || (opcode&0x38)==0x10 || (opcode&0x38)==0x18) return false;
+		if ((opcode&7)<4) modrm=true;
+		else imm=((opcode&7)==4) ? 1 : (big_op ? 4 : 2);
+	} else if (opcode<0x60) {
+		/* inc/dec, push/pop reg */
+	} else if (opcode>=0x80 && opcode<=0x83) {
+		if (index+len>=4096) return false;
+		Bitu reg=(mem_readb(code+len)>>3)&7;
+		if (reg==2 || reg==3) return false;
+		modrm=true;
+		imm=(opcode==0x81) ? (big_op ? 4 : 2) : 1;
+	} else if ((opcode>=0x84 && opcode<=0x85) || (opcode>=0x88 && opcode<=0x8b)) {
+		modrm=true;
+	} else if (opcode>=0xb0 && opcode<=0xbf) {
+		imm=(opcode<0xb8) ? 1 : (big_op ? 4 : 2);
+	} else if (opcode==0xc6 || opcode==0xc7) {
+		modrm=true;
+		imm=(opcode==0xc6) ? 1 : (big_op ? 4 : 2);
+	} else return false;
+	if (modrm) {
+		if (index+len>=4096) return false;
+		Bitu rm=mem_readb(code+len++);
+		Bitu mod=rm>>6;
+		rm&=7;
+		if (mod!=3) {
+			if (!big_addr) {
+				if (mod==1) len+=1;
+				else if (mod==2 || rm==6) len+=2;
+			} else {
+				if (rm==4) {
+					if (index+len>=4096) return false;
+					if (mod==0 && (mem_readb(code+len)&7)==5) len+=4;
+					len++;
+				}
+				if (mod==1) len+=1;
+				else if (mod==2 || (mod==0 && rm==5)) len+=4;
+			}
+		}
+	}
+	len+=imm;
+	/* the next instruction has to overwrite all flags without reading any */
+	index+=len;
+	code+=len;
+	if (decode.page.invmap && index<4096 && decode.page.invmap[index]>=4) return false;
+	for (len=0;;) {
+		if (index+len>=4096) return false;
+		opcode=mem_readb(code+len++);
+		if (opcode!=0x66 && opcode!=0x67 && opcode!=0x26 && opcode!=0x2e &&
+			opcode!=0x36 && opcode!=0x3e && opcode!=0x64 && opcode!=0x65) break;
+	}
+	if (opcode<0x40) {
+		return (opcode&7)<=5 && (opcode&0x38)!=0x10 && (opcode&0x38)!=0x18;
+	} else if (opcode>=0x80 && opcode<=0x83) {
+		if (index+len>=4096) return false;
+		Bitu reg=(mem_readb(code+len)>>3)&7;
+		return reg!=2 && reg!=3;
+	}
+	return opcode==0x84 || opcode==0x85 || opcode==0xa8 || opcode==0xa9;
+}
+
 #ifdef X86_DYNFPU_DH_ENABLED
 #include "dyn_fpu_dh.h"
 #define dh_fpu_startup() {		\
@@ -2521,6 +2607,7 @@ static CacheBlock * CreateCacheBlock(CodePageHandler * codepage,PhysPt start,Bit
 #endif
 	while (max_opcodes--) {
 		if (decoder_pagefault.had_pagefault) goto illegalopcode;
+		set_deadflags(max_opcodes && dyn_lookahead_deadflags());
 /* Init prefixes */
 		decode.big_addr=cpu.code.big;
 		decode.big_op=cpu.code.big;
@@ -3258,6 +3345,7 @@ restart_prefix:
 		}
 	}
 	// link to next block because the maximum number of opcodes has been reached
+	set_deadflags(false);
 	dyn_set_eip_end();
 	dyn_reduce_cycles();
 	dyn_save_critical_regs();
@@ -3265,12 +3353,14 @@ restart_prefix:
 	dyn_closeblock();
 	goto finish_block;
 core_close_block:
+	set_deadflags(false);
 	dyn_reduce_cycles();
 	dyn_save_critical_regs();
 	gen_return(BR_Normal);
 	dyn_closeblock();
 	goto finish_block;
 illegalopcode:
+	set_deadflags(false);
 	dyn_set_eip_last();
 	dyn_reduce_cycles();
 	dyn_save_critical_regs();
@@ -3278,6 +3368,7 @@ illegalopcode:
 	dyn_closeblock();
 	goto finish_block;
 illegalopcode2:
+	set_deadflags(false);
 	dyn_set_eip_last();
 	dyn_reduce_cycles();
 	dyn_save_critical_regs();
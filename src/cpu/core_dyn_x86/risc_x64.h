@@ -454,9 +454,16 @@ static void gen_needflags(void) {
 	}
 }
 
+static bool dead_flags=false;
+
 static void gen_protectflags(void) {
 	if (x64gen.flagsactive) {
 		x64gen.flagsactive=false;
+		if (GCC_UNLIKELY(dead_flags)) {
+			// nobody reads the flags, only reserve their stack slot
+			opcode(4).set64().setea(4,-1,0,-(CALLSTACK+8)).Emit8(0x8D); // lea rsp, [rsp-16/48]
+			return;
+		}
 		cache_addb(0x9c);		//PUSHFQ
 		opcode(4).set64().setea(4,-1,0,-(CALLSTACK)).Emit8(0x8D); // lea rsp, [rsp-8/40]
 	}
@@ -496,9 +503,15 @@ static void set_skipflags(bool state) {
 	skip_flags=state;
 }
 
+// the flags are overwritten before being read again (see dyn_lookahead_deadflags)
+static void set_deadflags(bool state) {
+	dead_flags=state;
+}
+
 static void gen_reinit(void) {
 	x64gen.last_used=0;
 	x64gen.flagsactive=false;
+	dead_flags=false;
 	for (Bitu i=0;i<X64_REGS;i++) {
 		x64gen.regs[i]->dynreg=nullptr;
 	}
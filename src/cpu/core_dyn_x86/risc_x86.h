@@ -244,9 +244,17 @@ static void gen_needflags(void) {
 	}
 }
 
+static bool dead_flags=false;
+
 static void gen_protectflags(void) {
 	if (x86gen.flagsactive) {
 		x86gen.flagsactive=false;
+		if (GCC_UNLIKELY(dead_flags)) {
+			// nobody reads the flags, only reserve their stack slot
+			cache_addw(0xec83);		//SUB ESP,4
+			cache_addb(0x4);
+			return;
+		}
 		cache_addb(0x9c);		//PUSHFD
 	}
 }
@@ -287,9 +295,15 @@ static void set_skipflags(bool state) {
 	skip_flags=state;
 }
 
+// the flags are overwritten before being read again (see dyn_lookahead_deadflags)
+static void set_deadflags(bool state) {
+	dead_flags=state;
+}
+
 static void gen_reinit(void) {
 	x86gen.last_used=0;
 	x86gen.flagsactive=false;
+	dead_flags=false;
 	for (Bitu i=0;i<X86_REGS;i++) {
 		x86gen.regs[i]->dynreg=0;
 	}
@@ -28,6 +28,50 @@ enum STRING_OP_DYNX86 {
 	STR_CMPSB=24,STR_CMPSW,STR_CMPSD
 };
 
+/* Bulk part of a REP MOVS/STOS/LODS, called with the guest registers written back before the
+ * generated element loop, which then picks up whatever is left. At least one cycle is left over
+ * so the loop's own cycle check stays in charge of leaving the block. */
+static void dyn_string_bulk(Bitu op,Bitu big_addr,PhysPt si_base,PhysPt di_base) {
+	const uint32_t add_mask = big_addr ? 0xffffffffu : 0xffffu;
+	const Bits step = cpu.direction * (Bits)(1u << (op & 3));
+	uint32_t si_index = reg_esi & add_mask;
+	uint32_t di_index = reg_edi & add_mask;
+	uint32_t val;
+	Bitu count = reg_ecx & add_mask;
+	Bitu done = 0,n;
+
+	if (CPU_Cycles <= 1) return;
+	if (count > (Bitu)(CPU_Cycles - 1)) count = (Bitu)(CPU_Cycles - 1);
+
+	do {
+		switch (op & ~3u) {
+			case STR_MOVSB:
+				n = PAGING_StringMove(si_base,si_index,di_base,di_index,add_mask,step,count-done);
+				break;
+			case STR_STOSB:
+				n = PAGING_StringStore(di_base,di_index,add_mask,step,count-done,reg_eax);
+				break;
+			default:
+				n = PAGING_StringLoad(si_base,si_index,add_mask,step,count-done,val);
+				if (n != 0) {
+					switch (op & 3) {
+						case 0:  reg_al = (uint8_t)val; break;
+						case 1:  reg_ax = (uint16_t)val; break;
+						default: reg_eax = val; break;
+					}
+				}
+				break;
+		}
+		done += n;
+	} while (n != 0 && done < count);
+	if (done == 0) return;
+
+	reg_esi = (reg_esi & ~add_mask) | si_index;
+	reg_edi = (reg_edi & ~add_mask) | di_index;
+	reg_ecx = (reg_ecx & ~add_mask) | ((reg_ecx - (uint32_t)done) & add_mask);
+	CPU_Cycles -= (cpu_cycles_count_t)done;
+}
+
 static void dyn_string(STRING_OP_DYNX86 op) {
 	DynReg * si_base=decode.segprefix ? decode.segprefix : DREG(DS);
 	DynReg * di_base=DREG(ES);
@@ -57,6 +101,12 @@ static void dyn_string(STRING_OP_DYNX86 op) {
 	default:
 		IllegalOption("dyn_string op");
 	}
+	if (decode.rep && op >= STR_MOVSB && op <= STR_STOSD) {
+		/* RAM-backed runs are done in one go, the loop below does the rest */
+		dyn_save_noncritical_regs();
+		gen_releasereg(DREG(CYCLES));
+		gen_call_function((void *)&dyn_string_bulk,"%Id%Id%Dd%Dd",(Bitu)op,(Bitu)decode.big_addr,si_base,di_base);
+	}
 	gen_load_host(&cpu.direction,DREG(TMPW),4);
 	switch (op & 3) {
 	case 0:break;
@@ -20,6 +20,12 @@
 
 #if (C_DYNREC)
 #include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #if defined (WIN32)
 #include <windows.h>
@@ -44,6 +50,7 @@
 #include "inout.h"
 #include "lazyflags.h"
 #include "pic.h"
+#include "hostmem.h"
 
 extern bool do_lds_wraparound;
 
@@ -54,7 +61,11 @@ extern bool do_lds_wraparound;
 #define CACHE_ALIGN		(16)
 #define DYN_HASH_SHIFT	(4)
 #define DYN_PAGE_HASH	(4096>>DYN_HASH_SHIFT)
-#define DYN_LINKS		(16)
+#define DYN_SMC_GRANULE_SHIFT	(6)
+#define DYN_SMC_GRANULE	(1<<DYN_SMC_GRANULE_SHIFT)
+#define DYN_SMC_HOT_LIMIT	(16)	// invalidations of a granule until its code isn't translated anymore
+#define DYN_LINKS		(4)		// links per block: end of block paths and side exits
+#define DYN_SIDE_EXITS	(DYN_LINKS-2)
 
 
 //#define DYN_LOG 1 //Turn Logging on.
@@ -102,10 +113,11 @@ extern bool do_lds_wraparound;
 enum BlockReturnDynRec {
 	BR_Normal=0,
 	BR_Cycles,
-	BR_Link1,BR_Link2,
+	BR_Link1,BR_Link2,BR_Link3,BR_Link4,	// one per link index, see DYN_LINKS
 	BR_Opcode,
 #if (C_DEBUG)
 	BR_OpcodeFull,
+	BR_Breakpoint,
 #endif
 	BR_Iret,
 	BR_CallBack,
@@ -129,6 +141,9 @@ static struct {
 } core_dynrec;
 
 
+extern bool dynamic_core_side_exits;
+extern int dynamic_core_translate_threshold;
+
 #include "core_dynrec/cache.h"
 
 #define X86			0x01
@@ -137,6 +152,7 @@ static struct {
 #define ARMV4LE		0x04
 #define ARMV7LE		0x05
 #define ARMV8LE		0x07
+#define RISCV64		0x08
 
 #if !defined(C_TARGETCPU)
 # if defined(_MSC_VER) && defined(_M_AMD64)
@@ -163,6 +179,8 @@ static struct {
 #include "core_dynrec/risc_armv4le.h"
 #elif C_TARGETCPU == ARMV8LE
 #include "core_dynrec/risc_armv8le.h"
+#elif C_TARGETCPU == RISCV64
+#include "core_dynrec/risc_riscv64.h"
 #endif
 
 #include "core_dynrec/decoder.h"
@@ -205,12 +223,128 @@ CacheBlockDynRec * LinkBlocks(BlockReturnDynRec ret) {
 		if (!block) return NULL;
 
 		// found it, link the current block to
-		cache.block.running->LinkTo(ret==BR_Link2,block);
+		cache.block.running->LinkTo((Bitu)(ret-BR_Link1),block);
 		return block;
 	}
 	return NULL;
 }
 
+#define DYN_PCACHE_MAGIC "DBXDRC01"
+
+static void dynrec_pcache_load(void) {
+	FILE * f=fopen(dynrec_pcache.file.c_str(),"rb");
+	if (!f) return;
+	char magic[8];
+	uint32_t count=0;
+	if (fread(magic,8,1,f)!=1 || memcmp(magic,DYN_PCACHE_MAGIC,8) || fread(&count,sizeof(count),1,f)!=1) {
+		LOG_MSG("DYNREC: Ignoring cache file %s, unknown format",dynrec_pcache.file.c_str());
+		fclose(f);
+		return;
+	}
+	for (uint32_t i=0;i<count && dynrec_pcache_pages.size()<DYN_PCACHE_MAX_PAGES;i++) {
+		uint64_t hash;
+		uint16_t n;
+		if (fread(&hash,sizeof(hash),1,f)!=1 || fread(&n,sizeof(n),1,f)!=1 || n>DYN_PCACHE_MAX_ENTRIES) break;
+		std::vector<uint16_t> entries(n);
+		if (n && fread(&entries[0],sizeof(uint16_t),n,f)!=n) break;
+		dynrec_pcache_pages[hash]=entries;
+	}
+	fclose(f);
+	LOG(LOG_CPU,LOG_NORMAL)("DYNREC: Loaded entry points of %u code pages from %s",(unsigned int)dynrec_pcache_pages.size(),dynrec_pcache.file.c_str());
+}
+
+static void dynrec_pcache_save(void) {
+	FILE * f=fopen(dynrec_pcache.file.c_str(),"wb");
+	if (!f) {
+		LOG_MSG("DYNREC: Unable to write cache file %s",dynrec_pcache.file.c_str());
+		return;
+	}
+	const uint32_t count=(uint32_t)dynrec_pcache_pages.size();
+	fwrite(DYN_PCACHE_MAGIC,8,1,f);
+	fwrite(&count,sizeof(count),1,f);
+	for (const auto &it : dynrec_pcache_pages) {
+		const uint16_t n=(uint16_t)it.second.size();
+		fwrite(&it.first,sizeof(it.first),1,f);
+		fwrite(&n,sizeof(n),1,f);
+		if (n) fwrite(&it.second[0],sizeof(uint16_t),n,f);
+	}
+	fclose(f);
+}
+
+// translate the blocks known for this page contents before they are executed.
+// Only done while paging is off: a retranslated block might end up crossing
+// into the next page, and touching that page must not cause a page fault.
+static void dynrec_pcache_prewarm(CodePageHandlerDynRec * chandler,PhysPt ip_point) {
+	chandler->prewarm_pending=false;
+	if (paging.enabled) return;
+	const auto it=dynrec_pcache_pages.find(dynrec_pcache_hash(chandler->GetPageHostPt()));
+	if (it==dynrec_pcache_pages.end()) return;
+
+	const uint16_t mode=dynrec_pcache_mode();
+	const Bitu ip_offset=ip_point&4095;
+	for (const uint16_t entry : it->second) {
+		if ((entry&DYN_PCACHE_MODE_MASK)!=mode) continue;
+		const Bitu offset=entry&4095;
+		if (chandler->FindCacheBlock(offset)) continue;
+		CacheBlockDynRec * block=CreateCacheBlock(chandler,(PhysPt)(ip_point-ip_offset+offset),32);
+		block->prof.eip=(uint32_t)(reg_eip-ip_offset+offset);
+		dynrec_pcache.prewarmed++;
+	}
+}
+
+// profiler requests may come from other threads (QMP), they are applied
+// when the core is entered the next time
+static std::atomic<bool> dynrec_prof_pending(false);
+static std::atomic<bool> dynrec_prof_want_enabled(false);
+static std::atomic<bool> dynrec_prof_want_reset(false);
+static std::atomic<void (*)(void)> dynrec_prof_collect(nullptr);
+
+static void dynrec_prof_clear(void) {
+	std::lock_guard<std::mutex> guard(dynrec_prof_mutex);
+	dynrec_prof_retired.clear();
+	const bool enabled=dynrec_prof.enabled;
+	memset(&dynrec_prof,0,sizeof(dynrec_prof));
+	dynrec_prof.enabled=enabled;
+	if (cache_blocks) for (Bitu i=0;i<CACHE_BLOCKS;i++) {
+		cache_blocks[i].prof.execs=0;
+		cache_blocks[i].prof.entries=0;
+		cache_blocks[i].prof.host_ns=0;
+	}
+}
+
+static void dynrec_prof_apply(void) {
+	dynrec_prof_pending.store(false);
+	const bool enable=dynrec_prof_want_enabled.load();
+	if (enable!=dynrec_prof.enabled) {
+		// retranslate everything so that the blocks do (or no longer) carry
+		// the execution counter. When stopping, the flush retires the counters
+		// of all live blocks, so the results stay available after stopping.
+		if (enable) {
+			dynrec_prof_clear();
+			cache_reset();
+		} else {
+			cache_reset();
+		}
+		dynrec_prof.enabled=enable;
+	}
+	if (dynrec_prof_want_reset.exchange(false)) dynrec_prof_clear();
+	void (*collect)(void)=dynrec_prof_collect.exchange(nullptr);
+	if (collect) collect();
+}
+
+static BlockReturnDynRec dynrec_prof_runblock(CacheBlockDynRec * block) {
+	const uint64_t t0=dynrec_prof_now();
+	BlockReturnDynRec ret=core_dynrec.runcode(block->cache.xstart);
+	const uint64_t ns=dynrec_prof_now()-t0;
+	dynrec_prof.exec_ns+=ns;
+	// the block may have been thrown away by self-modifying code while running
+	if (block->page.handler) {
+		block->prof.entries++;
+		block->prof.host_ns+=ns;
+	}
+	return ret;
+}
+
 /*
 	The core tries to find the block that should be executed next.
 	If such a block is found, it is run, otherwise the instruction
@@ -260,6 +394,8 @@ Bits CPU_Core_Dynrec_Run(void) {
         return CPU_Core_Normal_Run();
     }
 
+	if (GCC_UNLIKELY(dynrec_prof_pending.load(std::memory_order_relaxed))) dynrec_prof_apply();
+
 	for (;;) {
 		dosbox_allow_nonrecursive_page_fault = false;
 		// Determine the linear address of CS:EIP
@@ -267,6 +403,8 @@ Bits CPU_Core_Dynrec_Run(void) {
 		#if C_HEAVY_DEBUG
 			if (DEBUG_HeavyIsBreakpoint()) return (Bits)debugCallback;
 		#endif
+		uint64_t prof_t=0;
+		if (GCC_UNLIKELY(dynrec_prof.enabled)) prof_t=dynrec_prof_now();
 
 		CodePageHandlerDynRec * chandler=nullptr;
 		// see if the current page is present and contains code
@@ -282,17 +420,30 @@ Bits CPU_Core_Dynrec_Run(void) {
 			return CPU_Core_Normal_Run();
 		}
 
+		// page just became a code page, see if its blocks are already known
+		if (GCC_UNLIKELY(chandler->prewarm_pending)) dynrec_pcache_prewarm(chandler,ip_point);
+
 		// find correct Dynamic Block to run
 		CacheBlockDynRec * block=chandler->FindCacheBlock(ip_point&4095);
+		if (GCC_UNLIKELY(dynrec_prof.enabled)) {
+			const uint64_t t=dynrec_prof_now();
+			dynrec_prof.lookup_ns+=t-prof_t;
+			dynrec_prof.lookups++;
+			prof_t=t;
+		}
 		if (!block) {
 			// no block found, thus translate the instruction stream
-			// unless the instruction is known to be modified
-			if (!chandler->invalidation_map || (chandler->invalidation_map[ip_point&4095]<4)) {
+			// unless the instruction is known to be modified or has
+			// not been executed often enough yet
+			if ((!chandler->invalidation_map || ((chandler->invalidation_map[ip_point&4095]<4) &&
+				!chandler->IsSMCHot(ip_point&4095))) && chandler->CountEntry(ip_point&4095)) {
 				// translate up to 32 instructions
 				block=CreateCacheBlock(chandler,ip_point,32);
+				if (GCC_UNLIKELY(dynrec_prof.enabled)) dynrec_prof.translate_ns+=dynrec_prof_now()-prof_t;
 			} else {
 				dosbox_allow_nonrecursive_page_fault = true;
 				// let the normal core handle this instruction to avoid zero-sized blocks
+				// or translating code that is not hot yet
 				cpu_cycles_count_t old_cycles=CPU_Cycles;
 				CPU_Cycles=1;
 				CPU_CycleLeft+=old_cycles;
@@ -310,7 +461,12 @@ run_block:
 		cache.block.running=nullptr;
 		// now we're ready to run the dynamic code block
 //		BlockReturnDynRec ret=((BlockReturnDynRec (*)(void))(block->cache.start))();
-		BlockReturnDynRec ret=core_dynrec.runcode(block->cache.xstart);
+		BlockReturnDynRec ret;
+		// a write to a watched page gives up the instruction, see PAGING_AddWriteWatch
+		paging_watch_retry=true;
+		if (GCC_UNLIKELY(dynrec_prof.enabled)) ret=dynrec_prof_runblock(block);
+		else ret=core_dynrec.runcode(block->cache.xstart);
+		paging_watch_retry=false;
 
         if (sizeof(CPU_Cycles) > 4) {
             // HACK: All dynrec cores for each processor assume CPU_Cycles is 32-bit wide.
@@ -359,6 +515,12 @@ run_block:
 #endif
 			return CBRET_NONE;
 
+#if (C_DEBUG)
+		case BR_Breakpoint:
+			// reg_eip points to the instruction with the breakpoint
+			return (Bits)debugCallback;
+#endif
+
 		case BR_CallBack:
 			// the callback code is executed in dosbox-x.conf, return the callback number
 			FillFlags();
@@ -382,7 +544,14 @@ run_block:
 
 		case BR_Link1:
 		case BR_Link2:
-			block=LinkBlocks(ret);
+		case BR_Link3:
+		case BR_Link4:
+			if (GCC_UNLIKELY(dynrec_prof.enabled)) {
+				const uint64_t t=dynrec_prof_now();
+				block=LinkBlocks(ret);
+				dynrec_prof.lookup_ns+=dynrec_prof_now()-t;
+				dynrec_prof.lookups++;
+			} else block=LinkBlocks(ret);
 			if (block) goto run_block;
 			break;
 
@@ -435,6 +604,14 @@ void CPU_Core_Dynrec_Cache_Init(bool enable_cache) {
 	cache_init(enable_cache);
 }
 
+void CPU_Core_Dynrec_Cache_SetFile(const char * path) {
+	// the file is read once, later changes only affect where it is written
+	const bool load=!dynrec_pcache.enabled;
+	dynrec_pcache.file=path?path:"";
+	dynrec_pcache.enabled=!dynrec_pcache.file.empty();
+	if (dynrec_pcache.enabled && load) dynrec_pcache_load();
+}
+
 void CPU_Core_Dynrec_Cache_Close(void) {
 	cache_close();
 }
@@ -442,4 +619,80 @@ void CPU_Core_Dynrec_Cache_Close(void) {
 void CPU_Core_Dynrec_Cache_Reset(void) {
 	cache_reset();
 }
+
+void CPU_Core_Dynrec_Profile_Enable(bool enable) {
+	dynrec_prof_want_enabled.store(enable);
+	dynrec_prof_pending.store(true);
+}
+
+void CPU_Core_Dynrec_Profile_Reset(void) {
+	dynrec_prof_want_reset.store(true);
+	dynrec_prof_pending.store(true);
+}
+
+void CPU_Core_Dynrec_Profile_Collect(void (*handler)(void)) {
+	dynrec_prof_collect.store(handler);
+	dynrec_prof_pending.store(true);
+}
+
+void CPU_Core_Dynrec_GetHostMemory(HostMemSize &sz) {
+	if (cache_code_start_ptr) sz.add(cache_code_start_ptr,CACHE_TOTAL+CACHE_MAXSIZE+PAGESIZE_TEMP);
+	if (cache_blocks) sz.add_heap(CACHE_BLOCKS*sizeof(CacheBlockDynRec));
+	if (cache_initialized) sz.add_heap(CACHE_PAGES*sizeof(CodePageHandlerDynRec));
+}
+
+bool CPU_Core_Dynrec_GetCacheStats(DynrecCacheStats &st) {
+	st.pages_used=(uint32_t)dynrec_cstat.used_pages;
+	st.pages_total=CACHE_PAGES;
+	st.page_flushes=dynrec_cstat.page_flushes;
+	st.wraps=dynrec_cstat.wraps;
+	st.resets=dynrec_cstat.resets;
+	return cache_initialized;
+}
+
+bool CPU_Core_Dynrec_Profile_Get(DynrecProfileSummary &summary,std::vector<DynrecProfileEntry> &top,size_t count,bool by_execs) {
+	std::unordered_map<uint64_t,DynrecProfileEntry> merged;
+	{
+		std::lock_guard<std::mutex> guard(dynrec_prof_mutex);
+		merged=dynrec_prof_retired;
+	}
+	// add the counters of the blocks that are still in the cache
+	if (cache_blocks) for (Bitu i=0;i<CACHE_BLOCKS;i++) {
+		const CacheBlockDynRec * block=&cache_blocks[i];
+		if (!block->page.handler || !block->hash.index) continue;
+		if (!block->prof.execs && !block->prof.entries) continue;
+		DynrecProfileEntry &e=merged[dynrec_prof_key(block)];
+		e.lin_addr=block->prof.lin_addr;
+		e.eip=block->prof.eip;
+		e.cs=block->prof.cs;
+		e.length=(uint16_t)(block->page.end-block->page.start+1);
+		e.execs+=block->prof.execs;
+		e.entries+=block->prof.entries;
+		e.host_ns+=block->prof.host_ns;
+	}
+
+	summary.enabled=dynrec_prof.enabled;
+	summary.exec_ns=dynrec_prof.exec_ns;
+	summary.lookup_ns=dynrec_prof.lookup_ns;
+	summary.translate_ns=dynrec_prof.translate_ns;
+	summary.invalidate_ns=dynrec_prof.invalidate_ns;
+	summary.lookups=dynrec_prof.lookups;
+	summary.translations=dynrec_prof.translations;
+	summary.invalidations=dynrec_prof.invalidations;
+	summary.page_flushes=dynrec_prof.page_flushes;
+	dynrec_smc_roll();
+	summary.invalidations_per_sec=dynrec_smc.rate;
+
+	top.clear();
+	top.reserve(merged.size());
+	for (const auto &it : merged) top.push_back(it.second);
+	const size_t n=std::min(count,top.size());
+	std::partial_sort(top.begin(),top.begin()+(ptrdiff_t)n,top.end(),
+		[by_execs](const DynrecProfileEntry &a,const DynrecProfileEntry &b) {
+			if (by_execs) return (a.execs!=b.execs)?(a.execs>b.execs):(a.host_ns>b.host_ns);
+			return (a.host_ns!=b.host_ns)?(a.host_ns>b.host_ns):(a.execs>b.execs);
+		});
+	top.resize(n);
+	return cache_initialized;
+}
 #endif
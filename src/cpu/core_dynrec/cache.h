@@ -27,7 +27,8 @@ class CacheBlockDynRec {
 public:
 	void Clear(void);
 	// link this cache block to another block, index specifies the code
-	// path (always zero for unconditional links, 0/1 for conditional ones
+	// path (always zero for unconditional links, 0/1 for conditional ones,
+	// 2 and up for the side exits of a block)
 	void LinkTo(Bitu index,CacheBlockDynRec * toblock) {
 		assert(toblock);
 		link[index].to=toblock;
@@ -57,8 +58,17 @@ public:
 		CacheBlockDynRec * to;		// this block can transfer control to the to-block
 		CacheBlockDynRec * next;
 		CacheBlockDynRec * from;	// the from-block can transfer control to this block
-	} link[2];	// maximum two links (conditional jumps)
+	} link[DYN_LINKS];	// end of block links (conditional jumps) and side exits
 	CacheBlockDynRec * crossblock;
+	struct {
+		uint32_t execs;			// incremented by the block itself while profiling
+		uint32_t entries;		// times the dispatcher entered this block
+		uint64_t host_ns;		// host time of the block chains entered through this block
+		uint32_t lin_addr;		// guest address the block was translated from
+		uint32_t eip;
+		uint16_t cs;
+	} prof;
+	uint16_t xlat_mode;		// cpu mode the block was translated in, see dynrec_pcache_mode
 };
 
 static struct {
@@ -81,8 +91,123 @@ static uint8_t * cache_code=NULL;
 static uint8_t * cache_code_link_blocks=NULL;
 
 static CacheBlockDynRec * cache_blocks=NULL;
-static CacheBlockDynRec link_blocks[2];		// default linking (specially marked)
+static CacheBlockDynRec link_blocks[DYN_LINKS];		// default linking (specially marked)
+
+
+// hot-block profiler, counters are only updated while enabled
+static struct {
+	bool enabled;
+	uint64_t exec_ns,lookup_ns,translate_ns,invalidate_ns;
+	uint64_t lookups,translations,invalidations,page_flushes;
+} dynrec_prof;
+
+// statistics of blocks that have been cleared, keyed by guest cs:eip
+static std::unordered_map<uint64_t,DynrecProfileEntry> dynrec_prof_retired;
+static std::mutex dynrec_prof_mutex;
+
+static INLINE uint64_t dynrec_prof_now(void) {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static INLINE uint64_t dynrec_prof_key(const CacheBlockDynRec * block) {
+	return ((uint64_t)block->prof.cs << 32u) | (uint64_t)block->prof.eip;
+}
+
+static void dynrec_prof_note_translation(CacheBlockDynRec * block) {
+	std::lock_guard<std::mutex> guard(dynrec_prof_mutex);
+	DynrecProfileEntry &e=dynrec_prof_retired[dynrec_prof_key(block)];
+	e.lin_addr=block->prof.lin_addr;
+	e.eip=block->prof.eip;
+	e.cs=block->prof.cs;
+	e.translations++;
+	dynrec_prof.translations++;
+}
+
+// move the counters of a block into the retired table before the block goes away
+static void dynrec_prof_retire(CacheBlockDynRec * block) {
+	if (!block->prof.execs && !block->prof.entries) return;
+	std::lock_guard<std::mutex> guard(dynrec_prof_mutex);
+	DynrecProfileEntry &e=dynrec_prof_retired[dynrec_prof_key(block)];
+	e.lin_addr=block->prof.lin_addr;
+	e.eip=block->prof.eip;
+	e.cs=block->prof.cs;
+	e.length=(uint16_t)(block->page.end-block->page.start+1);
+	e.execs+=block->prof.execs;
+	e.entries+=block->prof.entries;
+	e.host_ns+=block->prof.host_ns;
+	block->prof.execs=0;
+	block->prof.entries=0;
+	block->prof.host_ns=0;
+}
+
+
+// self-modifying code statistics, always collected: number of blocks
+// invalidated during the last second of emulated time
+static struct {
+	Bitu window_start;		// PIC_Ticks at the start of the current window
+	uint64_t count;			// invalidations in the current window
+	uint64_t rate;			// invalidations of the last complete window, per second
+} dynrec_smc;
+
+static void dynrec_smc_roll(void) {
+	const Bitu elapsed=PIC_Ticks-dynrec_smc.window_start;
+	if (elapsed<1000) return;
+	dynrec_smc.rate=(elapsed<2000) ? dynrec_smc.count : (dynrec_smc.count*1000/elapsed);
+	dynrec_smc.count=0;
+	dynrec_smc.window_start=PIC_Ticks;
+}
+
+static INLINE void dynrec_smc_note(void) {
+	dynrec_smc_roll();
+	dynrec_smc.count++;
+}
+
+// code cache occupancy, always collected
+static struct {
+	Bitu used_pages;		// code pages taken from cache.free_pages
+	uint64_t page_flushes;	// pages evicted because no free page was left
+	uint64_t wraps;			// translation went back to the first cache block
+	uint64_t resets;		// whole cache thrown away by cache_reset
+} dynrec_cstat;
+
+
+// persistent record of translated entry points ("dynamic core cache file").
+// The generated code itself refers to host addresses of this process and
+// can't be reused, so only the block start offsets of each code page are
+// kept, keyed by a hash of the page contents. When a page with a known hash
+// becomes a code page again, the recorded blocks are translated in one go.
+#define DYN_PCACHE_MAX_PAGES	(65536)
+#define DYN_PCACHE_MAX_ENTRIES	(512)
+#define DYN_PCACHE_MODE_BIG		(0x8000)
+#define DYN_PCACHE_MODE_PMODE	(0x4000)
+#define DYN_PCACHE_MODE_MASK	(0xc000)
+
+static struct {
+	bool enabled;
+	std::string file;
+	uint64_t prewarmed;		// blocks translated ahead of their first execution
+} dynrec_pcache;
+
+static std::unordered_map<uint64_t,std::vector<uint16_t> > dynrec_pcache_pages;
+
+static INLINE uint16_t dynrec_pcache_mode(void) {
+	return (cpu.code.big?DYN_PCACHE_MODE_BIG:0)|(cpu.pmode?DYN_PCACHE_MODE_PMODE:0);
+}
+
+static uint64_t dynrec_pcache_hash(const uint8_t * data) {
+	// FNV-1a over the page, a word at a time
+	uint64_t hash=0xcbf29ce484222325ULL;
+	for (Bitu i=0;i<4096;i+=8) {
+		uint64_t w;
+		memcpy(&w,data+i,8);
+		hash=(hash^w)*0x100000001b3ULL;
+	}
+	return hash;
+}
 
+static void dynrec_pcache_remember(CodePageHandlerDynRec * page);
+static void dynrec_pcache_save(void);
 
 // the CodePageHandlerDynRec class provides access to the contained
 // cache blocks and intercepts writes to the code for special treatment
@@ -104,6 +229,9 @@ public:
 
 		active_blocks=0;
 		active_count=16;
+		prewarm_pending=dynrec_pcache.enabled;
+		code_granules=0;
+		memset(&smc_hits,0,sizeof(smc_hits));
 
 		// initialize the maps with zero (no cache blocks as well as code present)
 		memset(&hash_map,0,sizeof(hash_map));
@@ -112,10 +240,37 @@ public:
 			free(invalidation_map);
 			invalidation_map=NULL;
 		}
+		if (entry_counts!=NULL) {
+			free(entry_counts);
+			entry_counts=NULL;
+		}
+	}
+
+	// count an execution of the untranslated code at start, returns true
+	// once it has been executed often enough to be worth translating
+	bool CountEntry(Bitu start) {
+		if (dynamic_core_translate_threshold<=0) return true;
+		if (!entry_counts) {
+			entry_counts=(uint8_t*)malloc(4096);
+			if (entry_counts==NULL) return true;
+			memset(entry_counts,0,4096);
+		}
+		if (entry_counts[start]>=dynamic_core_translate_threshold) return true;
+		entry_counts[start]++;
+		return false;
 	}
 
 	// clear out blocks that contain code which has been modified
 	bool InvalidateRange(Bitu start,Bitu end) {
+		if (GCC_UNLIKELY(dynrec_prof.enabled)) {
+			const uint64_t t0=dynrec_prof_now();
+			const bool ret=InvalidateRangeInner(start,end);
+			dynrec_prof.invalidate_ns+=dynrec_prof_now()-t0;
+			return ret;
+		}
+		return InvalidateRangeInner(start,end);
+	}
+	bool InvalidateRangeInner(Bitu start,Bitu end) {
 		Bits index=1+(Bits)(end>>(Bitu)DYN_HASH_SHIFT);
 		bool is_current_block=false;	// if the current block is modified, it has to be exited as soon as possible
 
@@ -133,6 +288,10 @@ public:
 				// test if this block is in the range
 				if (start<=block->page.end && end>=block->page.start) {
 					if (ip_point<=block->page.end && ip_point>=block->page.start) is_current_block=true;
+					if (GCC_UNLIKELY(dynrec_prof.enabled)) dynrec_prof.invalidations++;
+					dynrec_smc_note();
+					uint8_t &hits=smc_hits[start>>DYN_SMC_GRANULE_SHIFT];
+					if (hits<0xff) hits++;
 					block->Clear();		// clear the block, decrements the write_map accordingly
 				}
 				block=nextblock;
@@ -148,7 +307,7 @@ public:
 		if (host_readb(hostmem+addr)==val) return;
 		host_writeb(hostmem+addr,val);
 		// see if there's code where we are writing to
-		if (!host_readb(&write_map[addr])) {
+		if (!HasCode(addr,addr) || !host_readb(&write_map[addr])) {
 			if (active_blocks) return;		// still some blocks in this page
 			active_count--;
 			if (!active_count) Release();	// delay page releasing until active_count is zero
@@ -169,7 +328,7 @@ public:
 		if (host_readw(hostmem+addr)==val) return;
 		host_writew(hostmem+addr,val);
 		// see if there's code where we are writing to
-		if (!host_readw(&write_map[addr])) {
+		if (!HasCode(addr,addr+(Bitu)1) || !host_readw(&write_map[addr])) {
 			if (active_blocks) return;		// still some blocks in this page
 			active_count--;
 			if (!active_count) Release();	// delay page releasing until active_count is zero
@@ -195,7 +354,7 @@ public:
 		if (host_readd(hostmem+addr)==val) return;
 		host_writed(hostmem+addr,val);
 		// see if there's code where we are writing to
-		if (!host_readd(&write_map[addr])) {
+		if (!HasCode(addr,addr+(Bitu)3) || !host_readd(&write_map[addr])) {
 			if (active_blocks) return;		// still some blocks in this page
 			active_count--;
 			if (!active_count) Release();	// delay page releasing until active_count is zero
@@ -220,7 +379,7 @@ public:
 		addr&=4095;
 		if (host_readb(hostmem+addr)==val) return false;
 		// see if there's code where we are writing to
-		if (!host_readb(&write_map[addr])) {
+		if (!HasCode(addr,addr) || !host_readb(&write_map[addr])) {
 			if (!active_blocks) {
 				// no blocks left in this page, still delay the page releasing a bit
 				active_count--;
@@ -249,7 +408,7 @@ public:
 		addr&=4095;
 		if (host_readw(hostmem+addr)==val) return false;
 		// see if there's code where we are writing to
-		if (!host_readw(&write_map[addr])) {
+		if (!HasCode(addr,addr+(Bitu)1) || !host_readw(&write_map[addr])) {
 			if (!active_blocks) {
 				// no blocks left in this page, still delay the page releasing a bit
 				active_count--;
@@ -282,7 +441,7 @@ public:
 		addr&=4095;
 		if (host_readd(hostmem+addr)==val) return false;
 		// see if there's code where we are writing to
-		if (!host_readd(&write_map[addr])) {
+		if (!HasCode(addr,addr+(Bitu)3) || !host_readd(&write_map[addr])) {
 			if (!active_blocks) {
 				// no blocks left in this page, still delay the page releasing a bit
 				active_count--;
@@ -329,6 +488,20 @@ public:
 		block->page.handler=this;
 		active_blocks++;
 	}
+	// note that the range contains code now (see code_granules)
+	void MarkCode(Bitu start,Bitu end) {
+		for (Bitu g=start>>DYN_SMC_GRANULE_SHIFT;g<=(end>>DYN_SMC_GRANULE_SHIFT);g++)
+			code_granules|=(uint64_t)1<<g;
+	}
+	// quick test if there may be code in the range
+	bool HasCode(Bitu start,Bitu end) const {
+		return ((code_granules>>(start>>DYN_SMC_GRANULE_SHIFT)) |
+			(code_granules>>(end>>DYN_SMC_GRANULE_SHIFT)))&1;
+	}
+	// the range is often invalidated by writes, don't translate code there
+	bool IsSMCHot(Bitu index) const {
+		return smc_hits[index>>DYN_SMC_GRANULE_SHIFT]>=DYN_SMC_HOT_LIMIT;
+	}
 	// remove a cache block
 	void DelCacheBlock(CacheBlockDynRec * block) {
 		active_blocks--;
@@ -361,6 +534,16 @@ public:
 				if (write_map[i]) write_map[i]--;
 			}
 		}
+		// drop the granules that hold no code anymore
+		for (Bitu g=block->page.start>>DYN_SMC_GRANULE_SHIFT;g<=((Bitu)block->page.end>>DYN_SMC_GRANULE_SHIFT);g++) {
+			uint64_t used=0;
+			for (Bitu i=0;i<DYN_SMC_GRANULE;i+=8) {
+				uint64_t w;
+				memcpy(&w,&write_map[(g<<DYN_SMC_GRANULE_SHIFT)+i],8);
+				used|=w;
+			}
+			if (!used) code_granules&=~((uint64_t)1<<g);
+		}
 	}
 
 	void Release(void) {
@@ -375,8 +558,11 @@ public:
 		next=cache.free_pages;
 		cache.free_pages=this;
 		prev=nullptr;
+		dynrec_cstat.used_pages--;
 	}
 	void ClearRelease(void) {
+		if (GCC_UNLIKELY(dynrec_prof.enabled)) dynrec_prof.page_flushes++;
+		if (dynrec_pcache.enabled) dynrec_pcache_remember(this);
 		// clear out all cache blocks in this page
 		Bitu count=active_blocks;
 		CacheBlockDynRec **map=hash_map;
@@ -401,6 +587,20 @@ public:
 		return nullptr;	// none found
 	}
 
+	// collect the start offsets (and translation mode) of the blocks that
+	// begin in this page and don't continue into the next one
+	void CollectEntries(std::vector<uint16_t> &entries) {
+		for (Bitu i=1;i<=DYN_PAGE_HASH;i++) {
+			for (CacheBlockDynRec * block=hash_map[i];block;block=block->hash.next) {
+				if (!block->crossblock) entries.push_back(block->page.start|block->xlat_mode);
+			}
+		}
+	}
+	// direct pointer to the guest memory of this page
+	HostPt GetPageHostPt(void) {
+		return old_pagehandler->GetHostReadPt(phys_page);
+	}
+
 	HostPt GetHostReadPt(PageNum phys_page) override {
 		hostmem=old_pagehandler->GetHostReadPt(phys_page);
 		return hostmem;
@@ -412,8 +612,12 @@ public:
 	// the write map, there are write_map[i] cache blocks that cover the byte at address i
     uint8_t write_map[4096] = {};
     uint8_t* invalidation_map = NULL;
+    uint8_t* entry_counts = NULL;       // executions of untranslated code per address, see CountEntry
     CodePageHandlerDynRec* next = NULL; // page linking
     CodePageHandlerDynRec* prev = NULL; // page linking
+    bool prewarm_pending = false;       // page not yet checked against the persistent cache
+    uint64_t code_granules = 0;         // bit n set if DYN_SMC_GRANULE sized granule n may hold code
+    uint8_t smc_hits[4096 >> DYN_SMC_GRANULE_SHIFT] = {}; // code invalidations per granule
 private:
     PageHandler* old_pagehandler = NULL;
 
@@ -427,6 +631,24 @@ private:
 };
 
 
+static void dynrec_pcache_remember(CodePageHandlerDynRec * page) {
+	std::vector<uint16_t> entries;
+	page->CollectEntries(entries);
+	if (entries.empty()) return;
+
+	const uint64_t hash=dynrec_pcache_hash(page->GetPageHostPt());
+	auto it=dynrec_pcache_pages.find(hash);
+	if (it==dynrec_pcache_pages.end()) {
+		if (dynrec_pcache_pages.size()>=DYN_PCACHE_MAX_PAGES) return;
+		it=dynrec_pcache_pages.emplace(hash,std::vector<uint16_t>()).first;
+	}
+	std::vector<uint16_t> &known=it->second;
+	known.insert(known.end(),entries.begin(),entries.end());
+	std::sort(known.begin(),known.end());
+	known.erase(std::unique(known.begin(),known.end()),known.end());
+	if (known.size()>DYN_PCACHE_MAX_ENTRIES) known.resize(DYN_PCACHE_MAX_ENTRIES);
+}
+
 static INLINE void cache_addunusedblock(CacheBlockDynRec * block) {
 	// block has become unused, add it to the freelist
 	block->cache.next=cache.block.free;
@@ -446,8 +668,9 @@ static CacheBlockDynRec * cache_getblock(void) {
 }
 
 void CacheBlockDynRec::Clear(void) {
+	if (GCC_UNLIKELY(dynrec_prof.enabled) && hash.index) dynrec_prof_retire(this);
 	// check if this is not a cross page block
-	if (hash.index) for (Bitu ind=0;ind<2;ind++) {
+	if (hash.index) for (Bitu ind=0;ind<DYN_LINKS;ind++) {
 		CacheBlockDynRec * fromlink=link[ind].from;
 		link[ind].from=nullptr;
 		while (fromlink) {
@@ -523,12 +746,11 @@ skipresize:
 static void cache_closeblock(void) {
 	CacheBlockDynRec * block=cache.block.active;
 	// links point to the default linking code
-	block->link[0].to=&link_blocks[0];
-	block->link[1].to=&link_blocks[1];
-	block->link[0].from=nullptr;
-	block->link[1].from=nullptr;
-	block->link[0].next=nullptr;
-	block->link[1].next=nullptr;
+	for (Bitu ind=0;ind<DYN_LINKS;ind++) {
+		block->link[ind].to=&link_blocks[ind];
+		block->link[ind].from=nullptr;
+		block->link[ind].next=nullptr;
+	}
 	// close the block with correct alignment
 	Bitu written=(Bitu)(cache.pos-block->cache.start);
 	if (written>block->cache.size) {
@@ -553,6 +775,7 @@ static void cache_closeblock(void) {
 	// advance the active block pointer
 	if (!block->cache.next || (block->cache.next->cache.start>(cache_code_start_ptr + CACHE_TOTAL - CACHE_MAXSIZE))) {
 //		LOG_MSG("Cache full restarting");
+		dynrec_cstat.wraps++;
 		cache.block.active=cache.block.first;
 	} else {
 		cache.block.active=block->cache.next;
@@ -617,6 +840,17 @@ static void cache_ensure_allocation(void) {
 	}
 }
 
+// link code that returns with a special return code, one stub per link
+// index; the stubs of the side exits are placed behind the run code
+static void cache_setup_link_blocks(void) {
+	for (Bitu ind=0;ind<DYN_LINKS;ind++) {
+		cache.pos=&cache_code_link_blocks[(ind<2)?(ind*32):(512+(ind-2)*32)];
+		link_blocks[ind].cache.start=cache.pos;
+		link_blocks[ind].cache.xstart=(uint8_t*)cache_rwtox(link_blocks[ind].cache.start);
+		dyn_return((BlockReturnDynRec)(BR_Link1+ind),false);
+	}
+}
+
 static void cache_reset(void) {
 	if (cache_initialized) {
 		for (;;) {
@@ -628,6 +862,8 @@ static void cache_reset(void) {
 				cache.used_pages=npage;
 			} else break;
 		}
+		dynrec_cstat.used_pages=0;
+		dynrec_cstat.resets++;
 
 		if (cache_blocks == NULL) {
 			cache_blocks=(CacheBlockDynRec*)malloc(CACHE_BLOCKS*sizeof(CacheBlockDynRec));
@@ -636,8 +872,8 @@ static void cache_reset(void) {
 		memset(cache_blocks,0,sizeof(CacheBlockDynRec)*CACHE_BLOCKS);
 		cache.block.free=&cache_blocks[0];
 		for (Bits i=0;i<CACHE_BLOCKS-1;i++) {
-			cache_blocks[i].link[0].to=(CacheBlockDynRec *)1;
-			cache_blocks[i].link[1].to=(CacheBlockDynRec *)1;
+			for (Bitu ind=0;ind<DYN_LINKS;ind++)
+				cache_blocks[i].link[ind].to=(CacheBlockDynRec *)1;
 			cache_blocks[i].cache.next=&cache_blocks[i+1];
 		}
 
@@ -654,14 +890,7 @@ static void cache_reset(void) {
 		block->cache.next=nullptr;								//Last block in the list
 
 		/* Setup the default blocks for block linkage returns */
-		cache.pos=&cache_code_link_blocks[0];
-		link_blocks[0].cache.start=cache.pos;
-		link_blocks[0].cache.xstart=(uint8_t*)cache_rwtox(link_blocks[0].cache.start);
-		dyn_return(BR_Link1,false);
-		cache.pos=&cache_code_link_blocks[32];
-		link_blocks[1].cache.start=cache.pos;
-		link_blocks[1].cache.xstart=(uint8_t*)cache_rwtox(link_blocks[1].cache.start);
-		dyn_return(BR_Link2,false);
+		cache_setup_link_blocks();
 		cache.free_pages=nullptr;
 		cache.last_page=nullptr;
 		cache.used_pages=nullptr;
@@ -694,8 +923,8 @@ static void cache_init(bool enable) {
 			// initialize the cache blocks
             if (cache_blocks != NULL) {
                 for (i = 0; i < CACHE_BLOCKS - 1; i++) {
-                    cache_blocks[i].link[0].to = (CacheBlockDynRec*)1;
-                    cache_blocks[i].link[1].to = (CacheBlockDynRec*)1;
+                    for (Bitu ind = 0; ind < DYN_LINKS; ind++)
+                        cache_blocks[i].link[ind].to = (CacheBlockDynRec*)1;
                     cache_blocks[i].cache.next = &cache_blocks[i + 1];
                 }
             }
@@ -713,16 +942,7 @@ static void cache_init(bool enable) {
 			block->cache.next=nullptr;						// last block in the list
 		}
 		// setup the default blocks for block linkage returns
-		cache.pos=&cache_code_link_blocks[0];
-		link_blocks[0].cache.start=cache.pos;
-		link_blocks[0].cache.xstart=(uint8_t*)cache_rwtox(link_blocks[0].cache.start);
-		// link code that returns with a special return code
-		dyn_return(BR_Link1,false);
-		cache.pos=&cache_code_link_blocks[32];
-		link_blocks[1].cache.start=cache.pos;
-		link_blocks[1].cache.xstart=(uint8_t*)cache_rwtox(link_blocks[1].cache.start);
-		// link code that returns with a special return code
-		dyn_return(BR_Link2,false);
+		cache_setup_link_blocks();
 
 		cache.pos=&cache_code_link_blocks[64];
 		*(void**)(&core_dynrec.runcode) = (void*)cache_rwtox(cache.pos);
@@ -742,6 +962,11 @@ static void cache_init(bool enable) {
 }
 
 static void cache_close(void) {
+	if (dynrec_pcache.enabled && cache_initialized) {
+		for (CodePageHandlerDynRec * cpage=cache.used_pages;cpage;cpage=cpage->next)
+			dynrec_pcache_remember(cpage);
+		dynrec_pcache_save();
+	}
 /*	for (;;) {
 		if (cache.used_pages) {
 			CodePageHandler * cpage=cache.used_pages;
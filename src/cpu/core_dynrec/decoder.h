@@ -23,6 +23,7 @@
 #include "decoder_opcodes.h"
 
 #include "dyn_fpu.h"
+#include "dyn_mmx.h"
 #include <stddef.h>
 
 /*
@@ -47,6 +48,20 @@ static CacheBlockDynRec * CreateCacheBlock(CodePageHandlerDynRec * codepage,Phys
 	decode.block->page.start=(uint16_t)decode.page.index;
 	codepage->AddCacheBlock(decode.block);
 
+	decode.block->prof.execs=0;
+	decode.block->prof.entries=0;
+	decode.block->prof.host_ns=0;
+	decode.block->prof.lin_addr=(uint32_t)start;
+	decode.block->prof.eip=reg_eip;
+	decode.block->prof.cs=(uint16_t)SegValue(cs);
+	decode.block->xlat_mode=dynrec_pcache_mode();
+	if (GCC_UNLIKELY(dynrec_prof.enabled)) {
+		dynrec_prof_note_translation(decode.block);
+		// linked blocks transfer control without returning to the
+		// dispatcher, so the block has to count its own executions
+		gen_add_direct_word(&decode.block->prof.execs,1,true);
+	}
+
 	InitFlagsOptimization();
 
 	// every codeblock that is run sets cache.block.running to itself
@@ -60,7 +75,11 @@ static CacheBlockDynRec * CreateCacheBlock(CodePageHandlerDynRec * codepage,Phys
 	used_save_info_dynrec++;
 
 	decode.cycles=0;
+	decode.side_exits=0;
 	while (max_opcodes--) {
+		// code past a side exit may never run, so it must not fetch from the next page
+		// (possibly raising a page fault, or a page that can't hold code) unless that is safe
+		if (decode.side_exits && decode.page.index>4096-15 && !decode_nextpage_codeable()) break;
 		// Init prefixes
 		decode.big_addr=cpu.code.big;
 		decode.big_op=cpu.code.big;
@@ -69,20 +88,26 @@ static CacheBlockDynRec * CreateCacheBlock(CodePageHandlerDynRec * codepage,Phys
 		decode.rep=REP_NONE;
 		decode.cycles++;
 		decode.op_start=decode.code;
+#if (C_DEBUG)
+		if (GCC_UNLIKELY(debug_exec_breakpoints) && DEBUG_IsExecBreakpoint((uint32_t)decode.op_start)) dyn_check_breakpoint();
+#endif
 restart_prefix:
 		Bitu opcode;
 		if (!decode.page.invmap) opcode=decode_fetchb();
 		else {
 			// some entries in the invalidation map, see if the next
-			// instruction is known to be modified a lot
+			// instruction is known to be modified a lot or sits close
+			// to data that is written frequently
 			if (decode.page.index<4096) {
 				if (GCC_UNLIKELY(decode.page.invmap[decode.page.index]>=4)) goto illegalopcode;
+				if (GCC_UNLIKELY(decode.page.code->IsSMCHot(decode.page.index))) goto illegalopcode;
 				opcode=decode_fetchb();
 			} else {
 				// switch to the next page
 				opcode=decode_fetchb();
 				if (GCC_UNLIKELY(decode.page.invmap && 
 					(decode.page.invmap[decode.page.index-1]>=4))) goto illegalopcode;
+				if (GCC_UNLIKELY(decode.page.code->IsSMCHot(decode.page.index-1))) goto illegalopcode;
 			}
 		}
 		switch (opcode) {
@@ -201,8 +226,11 @@ restart_prefix:
 				// short conditional jumps
 				case 0x80:case 0x81:case 0x82:case 0x83:case 0x84:case 0x85:case 0x86:case 0x87:	
 				case 0x88:case 0x89:case 0x8a:case 0x8b:case 0x8c:case 0x8d:case 0x8e:case 0x8f:	
-					dyn_branched_exit((BranchTypes)(dual_code&0xf),
-						decode.big_op ? (int32_t)decode_fetchd() : (int16_t)decode_fetchw());
+					{
+						int32_t eip_add=decode.big_op ? (int32_t)decode_fetchd() : (int16_t)decode_fetchw();
+						if (dyn_branched_sideexit((BranchTypes)(dual_code&0xf),eip_add)) break;
+						dyn_branched_exit((BranchTypes)(dual_code&0xf),eip_add);
+					}
 					goto finish_block;
 
 				// conditional byte set instructions
@@ -247,6 +275,20 @@ restart_prefix:
 				case 0xbe:dyn_movx_ev_gb(true);break;
 				case 0xbf:dyn_movx_ev_gw(true);break;
 
+#ifdef CPU_FPU
+				// mmx instructions
+				case 0x60:case 0x61:case 0x62:case 0x63:case 0x64:case 0x65:case 0x66:case 0x67:
+				case 0x68:case 0x69:case 0x6a:case 0x6b:case 0x6e:case 0x6f:
+				case 0x71:case 0x72:case 0x73:case 0x74:case 0x75:case 0x76:case 0x77:
+				case 0x7e:case 0x7f:
+				case 0xd1:case 0xd2:case 0xd3:case 0xd5:case 0xd8:case 0xd9:case 0xdb:
+				case 0xdc:case 0xdd:case 0xdf:case 0xe1:case 0xe2:case 0xe5:case 0xe8:
+				case 0xe9:case 0xeb:case 0xec:case 0xed:case 0xef:case 0xf1:case 0xf2:
+				case 0xf3:case 0xf5:case 0xf8:case 0xf9:case 0xfa:case 0xfc:case 0xfd:case 0xfe:
+					if (!dyn_mmx_op(dual_code)) goto illegalopcode;
+					break;
+#endif
+
 				default:
 #if DYN_LOG
 //					LOG_MSG("Unhandled dual opcode 0F%02X",dual_code);
@@ -304,7 +346,11 @@ restart_prefix:
 		// short conditional jumps
 		case 0x70:case 0x71:case 0x72:case 0x73:case 0x74:case 0x75:case 0x76:case 0x77:	
 		case 0x78:case 0x79:case 0x7a:case 0x7b:case 0x7c:case 0x7d:case 0x7e:case 0x7f:	
-			dyn_branched_exit((BranchTypes)(opcode&0xf),(int8_t)decode_fetchb());	
+			{
+				int32_t eip_add=(int8_t)decode_fetchb();
+				if (dyn_branched_sideexit((BranchTypes)(opcode&0xf),eip_add)) break;
+				dyn_branched_exit((BranchTypes)(opcode&0xf),eip_add);
+			}
 			goto finish_block;
 
 		// 'op []/reg8,imm8'
@@ -623,6 +669,7 @@ finish_block:
 	// setup the correct end-address
 	decode.page.index--;
 	decode.active_block->page.end=(uint16_t)decode.page.index;
+	decode.page.code->MarkCode(decode.active_block->page.start,decode.page.index);
 //	LOG_MSG("Created block size %d start %d end %d",decode.block->cache.size,decode.block->page.start,decode.block->page.end);
 
 	cache_remap_rx();
@@ -101,6 +101,7 @@ static struct DynDecodeDynRec {
 	bool big_addr;			// address modifier
 	REP_Type rep;			// current repeat prefix
 	Bitu cycles;			// number cycles used by currently translated code
+	Bitu side_exits;		// conditional jumps translated as side exits of the block
 	bool seg_prefix_used;	// segment overridden
 	uint8_t seg_prefix;		// segment prefix (if seg_prefix_used==true)
 
@@ -163,6 +164,7 @@ static bool MakeCodePage(Bitu lin_addr,CodePageHandlerDynRec * &cph) {
 	}
 	// find a free CodePage
 	if (!cache.free_pages) {
+		dynrec_cstat.page_flushes++;
 		if (cache.used_pages!=decode.page.code) cache.used_pages->ClearRelease();
 		else {
 			// try another page to avoid clearing our source-crosspage
@@ -177,6 +179,7 @@ static bool MakeCodePage(Bitu lin_addr,CodePageHandlerDynRec * &cph) {
 	CodePageHandlerDynRec * cpagehandler=cache.free_pages;
     if (cache.free_pages != NULL) {
         cache.free_pages = cache.free_pages->next;
+        dynrec_cstat.used_pages++;
         // adjust previous and next page pointer
         cpagehandler->prev = cache.last_page;
         cpagehandler->next = nullptr;
@@ -196,9 +199,18 @@ static bool MakeCodePage(Bitu lin_addr,CodePageHandlerDynRec * &cph) {
 	return false;
 }
 
+// true if decoding may run into the next page without side effects: it is already
+// mapped (no page walk that could fault) and is plain RAM or already holds code
+static bool decode_nextpage_codeable(void) {
+	PageHandler * handler=get_tlb_readhandler((PhysPt)((decode.page.first+1) << 12));
+	if (handler->flags & PFLAG_HASCODE) return true;
+	return (handler->flags & (PFLAG_READABLE|PFLAG_WRITEABLE|PFLAG_HASROM|PFLAG_NOCODE|PFLAG_INIT))==(PFLAG_READABLE|PFLAG_WRITEABLE);
+}
+
 static void decode_advancepage(void) {
 	// Advance to the next page
 	decode.active_block->page.end=4095;
+	decode.page.code->MarkCode(decode.active_block->page.start,4095);
 	// trigger possible page fault here
 	decode.page.first++;
 	Bitu faddr=decode.page.first << 12;
@@ -614,7 +626,7 @@ template <typename T> static DRC_PTR_SIZE_IM INLINE gen_call_function_mm(const T
 
 
 
-enum save_info_type_dynrec {db_exception, cycle_check, string_break, trap};
+enum save_info_type_dynrec {db_exception, cycle_check, string_break, trap, breakpoint};
 
 
 // function that is called on exceptions
@@ -681,6 +693,14 @@ static void dyn_fill_blocks(void) {
 				gen_add_direct_word(&reg_eip,save_info_dynrec[sct].eip_change,decode.big_op);
 				dyn_return(BR_Trap);
 				break;
+#if (C_DEBUG)
+			case breakpoint:
+				// stop in front of the instruction, only the ones before it count
+				if (save_info_dynrec[sct].cycles) gen_sub_direct_word(&CPU_Cycles,(uint32_t)save_info_dynrec[sct].cycles,true);
+				gen_add_direct_word(&reg_eip,save_info_dynrec[sct].eip_change,cpu.code.big);
+				dyn_return(BR_Breakpoint);
+				break;
+#endif
 		}
 	}
 	used_save_info_dynrec=0;
@@ -1245,6 +1265,9 @@ template <typename T> static void InvalidateFlags(const T current_simple_functio
 	mf_functions[0].pos=cache.pos;
 	mf_functions[0].fct_ptr=reinterpret_cast<void*>((uintptr_t)current_simple_function);
 	mf_functions[0].ftype=flags_type;
+#ifdef DRC_USE_REG_CACHE
+	gen_regcache_keep_next_call();
+#endif
 #endif
 }
 
@@ -1257,6 +1280,9 @@ template <typename T> static void InvalidateFlagsPartially(const T current_simpl
 	mf_functions[mf_functions_num].fct_ptr=reinterpret_cast<void*>((uintptr_t)current_simple_function);
 	mf_functions[mf_functions_num].ftype=flags_type;
 	mf_functions_num++;
+#ifdef DRC_USE_REG_CACHE
+	gen_regcache_keep_next_call();
+#endif
 #endif
 }
 
@@ -1280,3 +1306,17 @@ static void AcquireFlags(Bitu flags_mask) {
 	mf_functions_num=0;
 #endif
 }
+
+#if (C_DEBUG)
+// only translated for instructions with a breakpoint, blocks without one run unchanged
+static void dyn_check_breakpoint(void) {
+	AcquireFlags(FMASK_TEST);
+	gen_call_function_I(DEBUG_ExecBreakpointHit,(Bitu)decode.op_start);
+	save_info_dynrec[used_save_info_dynrec].branch_pos=gen_create_branch_long_nonzero(FC_RETOP,false);
+	save_info_dynrec[used_save_info_dynrec].cycles=decode.cycles-1;
+	save_info_dynrec[used_save_info_dynrec].eip_change=decode.op_start-decode.code_start;
+	if (!cpu.code.big) save_info_dynrec[used_save_info_dynrec].eip_change&=0xffff;
+	save_info_dynrec[used_save_info_dynrec].type=breakpoint;
+	used_save_info_dynrec++;
+}
+#endif
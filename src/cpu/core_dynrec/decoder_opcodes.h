@@ -1123,6 +1123,29 @@ static void dyn_branched_exit(BranchTypes btype,int32_t eip_add) {
  	dyn_closeblock();
 }
 
+// forward conditional jumps are assumed not to be taken: translation continues
+// with the following instruction, the taken path leaves the block through one
+// of the side exit links. Returns false if the jump has to end the block.
+static bool dyn_branched_sideexit(BranchTypes btype,int32_t eip_add) {
+	if (!dynamic_core_side_exits || eip_add<=0 || decode.side_exits>=DYN_SIDE_EXITS) return false;
+	uint32_t eip_base=decode.code-decode.code_start;
+	// the flags may be needed on both paths
+	AcquireFlags(FMASK_TEST);
+
+	dyn_branchflag_to_reg(btype);
+	DRC_PTR_SIZE_IM data=gen_create_branch_on_zero(FC_RETOP,true);
+
+	// Branch taken
+	dyn_reduce_cycles();
+	gen_add_direct_word(&reg_eip,eip_base+eip_add,decode.big_op);
+	gen_jmp_ptr(&decode.block->link[2+decode.side_exits].to,offsetof(CacheBlockDynRec,cache.xstart));
+	gen_fill_branch(data);
+
+	// Branch not taken, continue with the next instruction
+	decode.side_exits++;
+	return true;
+}
+
 /*
 static void dyn_set_byte_on_condition(BranchTypes btype) {
 	dyn_get_modrm();
@@ -61,6 +61,93 @@ static void FPU_FFREE(Bitu st) {
 #include "../../fpu/fpu_instructions.h"
 #endif
 
+#if !C_FPU_X86 && !defined(HAS_LONG_DOUBLE)
+/* Fast path for the host double FPU emulation ("dynamic core fast fpu").
+   The arithmetic instructions are translated into a single call that
+   fetches the operands relative to TOP itself. The helpers only take the
+   shortcut while all exceptions are masked and precision control selects
+   extended precision, otherwise they use the regular FPU_* function. */
+#define DYN_FPU_FAST 1
+
+extern bool dynamic_core_fast_fpu;
+
+typedef void (* DynFpuOp)(Bitu st,Bitu other);
+
+// indexed by the modrm reg field, 2 and 3 are the compares
+static const DynFpuOp dyn_fpu_precise_ops[8]={
+	FPU_FADD,FPU_FMUL,NULL,NULL,FPU_FSUB,FPU_FSUBR,FPU_FDIV,FPU_FDIVR
+};
+
+static INLINE bool dyn_fpu_fast_ok(void) {
+	// exception masks in bits 0-5, precision control in bits 8-9
+	return (fpu.cw.reg & 0x33f)==0x33f;
+}
+
+template <Bitu group> static INLINE void dyn_fpu_fast_op(Bitu st,Bitu other) {
+	if (GCC_UNLIKELY(!dyn_fpu_fast_ok())) {
+		dyn_fpu_precise_ops[group](st,other);
+		return;
+	}
+	double& d=fpu.regs[st].d;
+	const double o=fpu.regs[other].d;
+	switch (group) {
+		case 0:d+=o;break;
+		case 1:d*=o;break;
+		case 4:d-=o;break;
+		case 5:d=o-d;break;
+		case 6:d/=o;break;
+		case 7:d=o/d;break;
+	}
+	fpu.use80[st]=false;
+}
+
+template <Bitu group> static void dyn_fpu_fast_st_sti(Bitu rm) {
+	dyn_fpu_fast_op<group>(TOP,STV(rm));
+}
+template <Bitu group> static void dyn_fpu_fast_sti_st(Bitu rm) {
+	dyn_fpu_fast_op<group>(STV(rm),TOP);
+}
+template <Bitu group> static void dyn_fpu_fast_sti_st_pop(Bitu rm) {
+	dyn_fpu_fast_op<group>(STV(rm),TOP);
+	FPU_FPOP();
+}
+template <Bitu group> static void dyn_fpu_fast_m32(PhysPt addr) {
+	FPU_FLD_F32(addr,8);
+	dyn_fpu_fast_op<group>(TOP,8);
+}
+template <Bitu group> static void dyn_fpu_fast_m64(PhysPt addr) {
+	FPU_FLD_F64(addr,8);
+	dyn_fpu_fast_op<group>(TOP,8);
+}
+template <Bitu group> static void dyn_fpu_fast_i32(PhysPt addr) {
+	FPU_FLD_I32(addr,8);
+	dyn_fpu_fast_op<group>(TOP,8);
+}
+template <Bitu group> static void dyn_fpu_fast_i16(PhysPt addr) {
+	FPU_FLD_I16(addr,8);
+	dyn_fpu_fast_op<group>(TOP,8);
+}
+
+#define DYN_FPU_FAST_TABLE(name,type)				\
+static void (* const name##_ops[8])(type)={			\
+	name<0>,name<1>,NULL,NULL,name<4>,name<5>,name<6>,name<7>	\
+};
+
+DYN_FPU_FAST_TABLE(dyn_fpu_fast_st_sti,Bitu)
+DYN_FPU_FAST_TABLE(dyn_fpu_fast_sti_st,Bitu)
+DYN_FPU_FAST_TABLE(dyn_fpu_fast_sti_st_pop,Bitu)
+DYN_FPU_FAST_TABLE(dyn_fpu_fast_m32,PhysPt)
+DYN_FPU_FAST_TABLE(dyn_fpu_fast_m64,PhysPt)
+DYN_FPU_FAST_TABLE(dyn_fpu_fast_i32,PhysPt)
+DYN_FPU_FAST_TABLE(dyn_fpu_fast_i16,PhysPt)
+
+#undef DYN_FPU_FAST_TABLE
+
+// true if the instruction given by the current modrm can use the fast path
+static INLINE bool dyn_fpu_use_fast(void) {
+	return dynamic_core_fast_fpu && ((decode.modrm.reg&6)!=2);
+}
+#endif
 
 static INLINE void dyn_fpu_top() {
 	gen_mov_word_to_reg(FC_OP2,(void*)(&FPUSW),true);
@@ -120,6 +207,12 @@ static void dyn_fpu_esc0(){
 	dyn_get_modrm(); 
 //	if (decode.modrm.val >= 0xc0) {
 	if (decode.modrm.mod == 3) { 
+#if DYN_FPU_FAST
+		if (dyn_fpu_use_fast()) {
+			gen_call_function_I(dyn_fpu_fast_st_sti_ops[decode.modrm.reg],decode.modrm.rm);
+			return;
+		}
+#endif
 		dyn_fpu_top();
 		switch (decode.modrm.reg){
 		case 0x00:		//FADD ST,STi
@@ -152,6 +245,12 @@ static void dyn_fpu_esc0(){
 		}
 	} else { 
 		dyn_fill_ea(FC_ADDR);
+#if DYN_FPU_FAST
+		if (dyn_fpu_use_fast()) {
+			gen_call_function_R(dyn_fpu_fast_m32_ops[decode.modrm.reg],FC_ADDR);
+			return;
+		}
+#endif
 		gen_call_function_R(FPU_FLD_F32_EA,FC_ADDR); 
 		gen_mov_word_to_reg(FC_OP1,(void*)(&FPUSW),true);
 		gen_shr_imm(FC_OP1,11); /* stack top is 3-bit value starting at bit 11 */
@@ -384,6 +483,12 @@ static void dyn_fpu_esc2(){
 		}
 	} else {
 		dyn_fill_ea(FC_ADDR);
+#if DYN_FPU_FAST
+		if (dyn_fpu_use_fast()) {
+			gen_call_function_R(dyn_fpu_fast_i32_ops[decode.modrm.reg],FC_ADDR);
+			return;
+		}
+#endif
 		gen_call_function_R(FPU_FLD_I32_EA,FC_ADDR); 
 		gen_mov_word_to_reg(FC_OP1,(void*)(&FPUSW),true);
 		gen_shr_imm(FC_OP1,11); /* stack top is 3-bit value starting at bit 11 */
@@ -463,6 +568,12 @@ static void dyn_fpu_esc4(){
 	dyn_get_modrm();  
 //	if (decode.modrm.val >= 0xc0) { 
 	if (decode.modrm.mod == 3) {
+#if DYN_FPU_FAST
+		if (dyn_fpu_use_fast()) {
+			gen_call_function_I(dyn_fpu_fast_sti_st_ops[decode.modrm.reg],decode.modrm.rm);
+			return;
+		}
+#endif
 		switch(decode.modrm.reg){
 		case 0x00:	/* FADD STi,ST*/
 			dyn_fpu_top_swapped();
@@ -502,6 +613,12 @@ static void dyn_fpu_esc4(){
 		}
 	} else { 
 		dyn_fill_ea(FC_ADDR);
+#if DYN_FPU_FAST
+		if (dyn_fpu_use_fast()) {
+			gen_call_function_R(dyn_fpu_fast_m64_ops[decode.modrm.reg],FC_ADDR);
+			return;
+		}
+#endif
 		gen_call_function_R(FPU_FLD_F64_EA,FC_ADDR); 
 		gen_mov_word_to_reg(FC_OP1,(void*)(&FPUSW),true);
 		gen_shr_imm(FC_OP1,11); /* stack top is 3-bit value starting at bit 11 */
@@ -585,6 +702,12 @@ static void dyn_fpu_esc6(){
 	dyn_get_modrm();  
 //	if (decode.modrm.val >= 0xc0) { 
 	if (decode.modrm.mod == 3) {
+#if DYN_FPU_FAST
+		if (dyn_fpu_use_fast()) {
+			gen_call_function_I(dyn_fpu_fast_sti_st_pop_ops[decode.modrm.reg],decode.modrm.rm);
+			return;
+		}
+#endif
 		switch(decode.modrm.reg){
 		case 0x00:	/*FADDP STi,ST*/
 			dyn_fpu_top_swapped();
@@ -635,6 +758,12 @@ static void dyn_fpu_esc6(){
 		gen_call_function_raw(FPU_FPOP);		
 	} else {
 		dyn_fill_ea(FC_ADDR);
+#if DYN_FPU_FAST
+		if (dyn_fpu_use_fast()) {
+			gen_call_function_R(dyn_fpu_fast_i16_ops[decode.modrm.reg],FC_ADDR);
+			return;
+		}
+#endif
 		gen_call_function_R(FPU_FLD_I16_EA,FC_ADDR); 
 		gen_mov_word_to_reg(FC_OP1,(void*)(&FPUSW),true);
 		gen_shr_imm(FC_OP1,11); /* stack top is 3-bit value starting at bit 11 */
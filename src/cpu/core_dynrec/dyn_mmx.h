@@ -0,0 +1,410 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* MMX support for the recompiler.
+
+   The register file is the FPU register file (see reg_mmx), so a
+   translated MMX instruction is a call to one of the small helpers below
+   with the destination and source register index. Memory operands are
+   first read into dynrec_mmxtmp through the checked memory handlers, so
+   a page fault is taken before any MMX register is modified; the helper
+   is then called with DYN_MMX_TMP as source index.
+
+   The helpers are plain per-lane loops that the host compiler lowers to
+   its own packed integer instructions (SSE2 on x86-64, NEON on ARMv8).
+   The SSE/SSE2 forms (66/F2/F3 prefixed) are left to the normal core. */
+
+#include "dosbox.h"
+#if C_FPU
+
+#include "fpu.h"
+#include "cpu.h"
+
+#define DYN_MMX_TMP 8
+
+static MMX_reg dynrec_mmxtmp;
+
+static INLINE const MMX_reg& dynrec_mmx_src(Bitu src) {
+	return (src==DYN_MMX_TMP) ? dynrec_mmxtmp : *reg_mmx[src];
+}
+
+static INLINE int dynrec_mmx_clamp(int value,int lo,int hi) {
+	return (value<lo) ? lo : ((value>hi) ? hi : value);
+}
+
+// helper applying expr to every lane of the given width
+#define DYN_MMX_LANES(name,lanes,type,count,expr)					\
+static void dynrec_mmx_##name(Bitu dest,Bitu src) {					\
+	MMX_reg& d=*reg_mmx[dest];										\
+	const MMX_reg s=dynrec_mmx_src(src);							\
+	for (Bitu i=0;i<count;i++) {									\
+		const type a=(type)d.lanes[i];								\
+		const type b=(type)s.lanes[i];								\
+		d.lanes[i]=(expr);											\
+	}																\
+}
+
+DYN_MMX_LANES(paddb,  uba,uint8_t, 8,a+b)
+DYN_MMX_LANES(paddw,  uwa,uint16_t,4,a+b)
+DYN_MMX_LANES(paddd,  uda,uint32_t,2,a+b)
+DYN_MMX_LANES(psubb,  uba,uint8_t, 8,a-b)
+DYN_MMX_LANES(psubw,  uwa,uint16_t,4,a-b)
+DYN_MMX_LANES(psubd,  uda,uint32_t,2,a-b)
+DYN_MMX_LANES(paddsb, uba,int8_t,  8,dynrec_mmx_clamp(a+b,-128,127))
+DYN_MMX_LANES(paddsw, uwa,int16_t, 4,dynrec_mmx_clamp(a+b,-32768,32767))
+DYN_MMX_LANES(paddusb,uba,uint8_t, 8,dynrec_mmx_clamp(a+b,0,255))
+DYN_MMX_LANES(paddusw,uwa,uint16_t,4,dynrec_mmx_clamp(a+b,0,65535))
+DYN_MMX_LANES(psubsb, uba,int8_t,  8,dynrec_mmx_clamp(a-b,-128,127))
+DYN_MMX_LANES(psubsw, uwa,int16_t, 4,dynrec_mmx_clamp(a-b,-32768,32767))
+DYN_MMX_LANES(psubusb,uba,uint8_t, 8,dynrec_mmx_clamp(a-b,0,255))
+DYN_MMX_LANES(psubusw,uwa,uint16_t,4,dynrec_mmx_clamp(a-b,0,65535))
+DYN_MMX_LANES(pcmpeqb,uba,uint8_t, 8,(a==b) ? 0xffu : 0u)
+DYN_MMX_LANES(pcmpeqw,uwa,uint16_t,4,(a==b) ? 0xffffu : 0u)
+DYN_MMX_LANES(pcmpeqd,uda,uint32_t,2,(a==b) ? 0xffffffffu : 0u)
+DYN_MMX_LANES(pcmpgtb,uba,int8_t,  8,(a>b) ? 0xffu : 0u)
+DYN_MMX_LANES(pcmpgtw,uwa,int16_t, 4,(a>b) ? 0xffffu : 0u)
+DYN_MMX_LANES(pcmpgtd,uda,int32_t, 2,(a>b) ? 0xffffffffu : 0u)
+DYN_MMX_LANES(pmullw, uwa,int16_t, 4,a*b)
+DYN_MMX_LANES(pmulhw, uwa,int16_t, 4,(a*b)>>16)
+
+#undef DYN_MMX_LANES
+
+static void dynrec_mmx_pand(Bitu dest,Bitu src) {
+	reg_mmx[dest]->q&=dynrec_mmx_src(src).q;
+}
+
+static void dynrec_mmx_pandn(Bitu dest,Bitu src) {
+	reg_mmx[dest]->q=~reg_mmx[dest]->q & dynrec_mmx_src(src).q;
+}
+
+static void dynrec_mmx_por(Bitu dest,Bitu src) {
+	reg_mmx[dest]->q|=dynrec_mmx_src(src).q;
+}
+
+static void dynrec_mmx_pxor(Bitu dest,Bitu src) {
+	reg_mmx[dest]->q^=dynrec_mmx_src(src).q;
+}
+
+static void dynrec_mmx_pmaddwd(Bitu dest,Bitu src) {
+	MMX_reg& d=*reg_mmx[dest];
+	const MMX_reg s=dynrec_mmx_src(src);
+	// summing as unsigned gives the 0x80000000 result for 0x8000*0x8000 pairs
+	const uint32_t lo=(uint32_t)((int32_t)d.sw.w0*s.sw.w0)+(uint32_t)((int32_t)d.sw.w1*s.sw.w1);
+	const uint32_t hi=(uint32_t)((int32_t)d.sw.w2*s.sw.w2)+(uint32_t)((int32_t)d.sw.w3*s.sw.w3);
+	d.ud.d0=lo;
+	d.ud.d1=hi;
+}
+
+static void dynrec_mmx_packsswb(Bitu dest,Bitu src) {
+	MMX_reg& d=*reg_mmx[dest];
+	const MMX_reg s=dynrec_mmx_src(src);
+	MMX_reg r;
+	r.sb.b0=(int8_t)dynrec_mmx_clamp(d.sw.w0,-128,127);
+	r.sb.b1=(int8_t)dynrec_mmx_clamp(d.sw.w1,-128,127);
+	r.sb.b2=(int8_t)dynrec_mmx_clamp(d.sw.w2,-128,127);
+	r.sb.b3=(int8_t)dynrec_mmx_clamp(d.sw.w3,-128,127);
+	r.sb.b4=(int8_t)dynrec_mmx_clamp(s.sw.w0,-128,127);
+	r.sb.b5=(int8_t)dynrec_mmx_clamp(s.sw.w1,-128,127);
+	r.sb.b6=(int8_t)dynrec_mmx_clamp(s.sw.w2,-128,127);
+	r.sb.b7=(int8_t)dynrec_mmx_clamp(s.sw.w3,-128,127);
+	d.q=r.q;
+}
+
+static void dynrec_mmx_packuswb(Bitu dest,Bitu src) {
+	MMX_reg& d=*reg_mmx[dest];
+	const MMX_reg s=dynrec_mmx_src(src);
+	MMX_reg r;
+	r.ub.b0=(uint8_t)dynrec_mmx_clamp(d.sw.w0,0,255);
+	r.ub.b1=(uint8_t)dynrec_mmx_clamp(d.sw.w1,0,255);
+	r.ub.b2=(uint8_t)dynrec_mmx_clamp(d.sw.w2,0,255);
+	r.ub.b3=(uint8_t)dynrec_mmx_clamp(d.sw.w3,0,255);
+	r.ub.b4=(uint8_t)dynrec_mmx_clamp(s.sw.w0,0,255);
+	r.ub.b5=(uint8_t)dynrec_mmx_clamp(s.sw.w1,0,255);
+	r.ub.b6=(uint8_t)dynrec_mmx_clamp(s.sw.w2,0,255);
+	r.ub.b7=(uint8_t)dynrec_mmx_clamp(s.sw.w3,0,255);
+	d.q=r.q;
+}
+
+static void dynrec_mmx_packssdw(Bitu dest,Bitu src) {
+	MMX_reg& d=*reg_mmx[dest];
+	const MMX_reg s=dynrec_mmx_src(src);
+	MMX_reg r;
+	r.sw.w0=(int16_t)dynrec_mmx_clamp(d.sd.d0,-32768,32767);
+	r.sw.w1=(int16_t)dynrec_mmx_clamp(d.sd.d1,-32768,32767);
+	r.sw.w2=(int16_t)dynrec_mmx_clamp(s.sd.d0,-32768,32767);
+	r.sw.w3=(int16_t)dynrec_mmx_clamp(s.sd.d1,-32768,32767);
+	d.q=r.q;
+}
+
+static void dynrec_mmx_punpcklbw(Bitu dest,Bitu src) {
+	MMX_reg& d=*reg_mmx[dest];
+	const MMX_reg s=dynrec_mmx_src(src);
+	MMX_reg r;
+	r.ub.b0=d.ub.b0;r.ub.b1=s.ub.b0;
+	r.ub.b2=d.ub.b1;r.ub.b3=s.ub.b1;
+	r.ub.b4=d.ub.b2;r.ub.b5=s.ub.b2;
+	r.ub.b6=d.ub.b3;r.ub.b7=s.ub.b3;
+	d.q=r.q;
+}
+
+static void dynrec_mmx_punpckhbw(Bitu dest,Bitu src) {
+	MMX_reg& d=*reg_mmx[dest];
+	const MMX_reg s=dynrec_mmx_src(src);
+	MMX_reg r;
+	r.ub.b0=d.ub.b4;r.ub.b1=s.ub.b4;
+	r.ub.b2=d.ub.b5;r.ub.b3=s.ub.b5;
+	r.ub.b4=d.ub.b6;r.ub.b5=s.ub.b6;
+	r.ub.b6=d.ub.b7;r.ub.b7=s.ub.b7;
+	d.q=r.q;
+}
+
+static void dynrec_mmx_punpcklwd(Bitu dest,Bitu src) {
+	MMX_reg& d=*reg_mmx[dest];
+	const MMX_reg s=dynrec_mmx_src(src);
+	MMX_reg r;
+	r.uw.w0=d.uw.w0;r.uw.w1=s.uw.w0;
+	r.uw.w2=d.uw.w1;r.uw.w3=s.uw.w1;
+	d.q=r.q;
+}
+
+static void dynrec_mmx_punpckhwd(Bitu dest,Bitu src) {
+	MMX_reg& d=*reg_mmx[dest];
+	const MMX_reg s=dynrec_mmx_src(src);
+	MMX_reg r;
+	r.uw.w0=d.uw.w2;r.uw.w1=s.uw.w2;
+	r.uw.w2=d.uw.w3;r.uw.w3=s.uw.w3;
+	d.q=r.q;
+}
+
+static void dynrec_mmx_punpckldq(Bitu dest,Bitu src) {
+	reg_mmx[dest]->ud.d1=dynrec_mmx_src(src).ud.d0;
+}
+
+static void dynrec_mmx_punpckhdq(Bitu dest,Bitu src) {
+	MMX_reg& d=*reg_mmx[dest];
+	d.ud.d0=d.ud.d1;
+	d.ud.d1=dynrec_mmx_src(src).ud.d1;
+}
+
+// shifts; counts beyond the lane width clear the lane (or fill it with
+// the sign bit for the arithmetic shifts)
+static INLINE void dynrec_mmx_shift_psrlw(MMX_reg& d,uint64_t count) {
+	if (count>15) { d.q=0; return; }
+	for (Bitu i=0;i<4;i++) d.uwa[i]>>=count;
+}
+static INLINE void dynrec_mmx_shift_psraw(MMX_reg& d,uint64_t count) {
+	if (count>15) count=15;
+	for (Bitu i=0;i<4;i++) d.uwa[i]=(uint16_t)((int16_t)d.uwa[i]>>count);
+}
+static INLINE void dynrec_mmx_shift_psllw(MMX_reg& d,uint64_t count) {
+	if (count>15) { d.q=0; return; }
+	for (Bitu i=0;i<4;i++) d.uwa[i]<<=count;
+}
+static INLINE void dynrec_mmx_shift_psrld(MMX_reg& d,uint64_t count) {
+	if (count>31) { d.q=0; return; }
+	for (Bitu i=0;i<2;i++) d.uda[i]>>=count;
+}
+static INLINE void dynrec_mmx_shift_psrad(MMX_reg& d,uint64_t count) {
+	if (count>31) count=31;
+	for (Bitu i=0;i<2;i++) d.uda[i]=(uint32_t)((int32_t)d.uda[i]>>count);
+}
+static INLINE void dynrec_mmx_shift_pslld(MMX_reg& d,uint64_t count) {
+	if (count>31) { d.q=0; return; }
+	for (Bitu i=0;i<2;i++) d.uda[i]<<=count;
+}
+static INLINE void dynrec_mmx_shift_psrlq(MMX_reg& d,uint64_t count) {
+	d.q=(count>63) ? 0 : (d.q>>count);
+}
+static INLINE void dynrec_mmx_shift_psllq(MMX_reg& d,uint64_t count) {
+	d.q=(count>63) ? 0 : (d.q<<count);
+}
+
+// register/memory count form and immediate count form of each shift
+#define DYN_MMX_SHIFT(name)											\
+static void dynrec_mmx_##name(Bitu dest,Bitu src) {					\
+	dynrec_mmx_shift_##name(*reg_mmx[dest],dynrec_mmx_src(src).q);	\
+}																	\
+static void dynrec_mmx_##name##_imm(Bitu dest,Bitu imm) {			\
+	dynrec_mmx_shift_##name(*reg_mmx[dest],imm);					\
+}
+
+DYN_MMX_SHIFT(psrlw)
+DYN_MMX_SHIFT(psraw)
+DYN_MMX_SHIFT(psllw)
+DYN_MMX_SHIFT(psrld)
+DYN_MMX_SHIFT(psrad)
+DYN_MMX_SHIFT(pslld)
+DYN_MMX_SHIFT(psrlq)
+DYN_MMX_SHIFT(psllq)
+
+#undef DYN_MMX_SHIFT
+
+static void dynrec_mmx_emms(void) {
+	setFPUTagEmpty();
+	fpu.sw.top=0;
+}
+
+typedef void (* DynMMXHelper)(Bitu dest,Bitu src);
+
+// 0f 71/72/73 groups, indexed by opcode and reg field 2 (srl), 4 (sra), 6 (sll)
+static const DynMMXHelper dyn_mmx_shift_imm_ops[3][3]={
+	{dynrec_mmx_psrlw_imm,dynrec_mmx_psraw_imm,dynrec_mmx_psllw_imm},
+	{dynrec_mmx_psrld_imm,dynrec_mmx_psrad_imm,dynrec_mmx_pslld_imm},
+	{dynrec_mmx_psrlq_imm,NULL,                dynrec_mmx_psllq_imm}
+};
+
+
+// make the Qq operand available, returns the index to pass as source
+static Bitu dyn_mmx_get_qq(void) {
+	if (decode.modrm.mod<3) {
+		dyn_fill_ea(FC_ADDR);
+		gen_protect_addr_reg();
+		dyn_read_word(FC_ADDR,FC_OP1,true);
+		gen_mov_word_from_reg(FC_OP1,&dynrec_mmxtmp.ud.d0,true);
+		gen_restore_addr_reg();
+		gen_add_imm(FC_ADDR,4);
+		dyn_read_word(FC_ADDR,FC_OP1,true);
+		gen_mov_word_from_reg(FC_OP1,&dynrec_mmxtmp.ud.d1,true);
+		return DYN_MMX_TMP;
+	}
+	return decode.modrm.rm;
+}
+
+static void dyn_mmx_copy(MMX_reg * dest,const MMX_reg * src) {
+	gen_mov_word_to_reg(FC_OP1,(void*)&src->ud.d0,true);
+	gen_mov_word_from_reg(FC_OP1,&dest->ud.d0,true);
+	gen_mov_word_to_reg(FC_OP1,(void*)&src->ud.d1,true);
+	gen_mov_word_from_reg(FC_OP1,&dest->ud.d1,true);
+}
+
+// translate the MMX instruction 0f op, returns false if the
+// instruction has to be handled by the normal core
+static bool dyn_mmx_op(Bitu op) {
+	if (CPU_ArchitectureType<CPU_ARCHTYPE_PMMXSLOW) return false;
+	// the operand size and repeat prefixes select the SSE forms
+	if (decode.big_op!=cpu.code.big || decode.rep!=REP_NONE) return false;
+
+	if (op==0x77) {		// emms
+		gen_call_function_raw(dynrec_mmx_emms);
+		return true;
+	}
+
+	dyn_get_modrm();
+	DynMMXHelper helper=NULL;
+	switch (op) {
+		case 0x6e:		// movd Pq,Ed
+			if (decode.modrm.mod<3) {
+				dyn_fill_ea(FC_ADDR);
+				dyn_read_word(FC_ADDR,FC_OP1,true);
+			} else {
+				MOV_REG_WORD_TO_HOST_REG(FC_OP1,decode.modrm.rm,true);
+			}
+			gen_mov_word_from_reg(FC_OP1,&reg_mmx[decode.modrm.reg]->ud.d0,true);
+			gen_mov_direct_dword(&reg_mmx[decode.modrm.reg]->ud.d1,0);
+			return true;
+		case 0x7e:		// movd Ed,Pq
+			if (decode.modrm.mod<3) {
+				dyn_fill_ea(FC_ADDR);
+				gen_mov_word_to_reg(FC_OP2,&reg_mmx[decode.modrm.reg]->ud.d0,true);
+				dyn_write_word(FC_ADDR,FC_OP2,true);
+			} else {
+				gen_mov_word_to_reg(FC_OP1,&reg_mmx[decode.modrm.reg]->ud.d0,true);
+				MOV_REG_WORD_FROM_HOST_REG(FC_OP1,decode.modrm.rm,true);
+			}
+			return true;
+		case 0x6f:		// movq Pq,Qq
+			dyn_mmx_copy(reg_mmx[decode.modrm.reg],&dynrec_mmx_src(dyn_mmx_get_qq()));
+			return true;
+		case 0x7f:		// movq Qq,Pq
+			if (decode.modrm.mod<3) {
+				dyn_fill_ea(FC_ADDR);
+				gen_protect_addr_reg();
+				gen_mov_word_to_reg(FC_OP2,&reg_mmx[decode.modrm.reg]->ud.d0,true);
+				dyn_write_word(FC_ADDR,FC_OP2,true);
+				gen_restore_addr_reg();
+				gen_add_imm(FC_ADDR,4);
+				gen_mov_word_to_reg(FC_OP2,&reg_mmx[decode.modrm.reg]->ud.d1,true);
+				dyn_write_word(FC_ADDR,FC_OP2,true);
+			} else {
+				dyn_mmx_copy(reg_mmx[decode.modrm.rm],reg_mmx[decode.modrm.reg]);
+			}
+			return true;
+		case 0x71:case 0x72:case 0x73:		// shift by immediate
+			if (decode.modrm.mod!=3) return false;
+			switch (decode.modrm.reg) {
+				case 2:case 4:case 6:
+					helper=dyn_mmx_shift_imm_ops[op-0x71][(decode.modrm.reg>>1)-1];
+					break;
+			}
+			if (helper==NULL) return false;
+			gen_call_function_II(helper,decode.modrm.rm,decode_fetchb());
+			return true;
+
+		case 0x60:helper=dynrec_mmx_punpcklbw;break;
+		case 0x61:helper=dynrec_mmx_punpcklwd;break;
+		case 0x62:helper=dynrec_mmx_punpckldq;break;
+		case 0x63:helper=dynrec_mmx_packsswb;break;
+		case 0x64:helper=dynrec_mmx_pcmpgtb;break;
+		case 0x65:helper=dynrec_mmx_pcmpgtw;break;
+		case 0x66:helper=dynrec_mmx_pcmpgtd;break;
+		case 0x67:helper=dynrec_mmx_packuswb;break;
+		case 0x68:helper=dynrec_mmx_punpckhbw;break;
+		case 0x69:helper=dynrec_mmx_punpckhwd;break;
+		case 0x6a:helper=dynrec_mmx_punpckhdq;break;
+		case 0x6b:helper=dynrec_mmx_packssdw;break;
+		case 0x74:helper=dynrec_mmx_pcmpeqb;break;
+		case 0x75:helper=dynrec_mmx_pcmpeqw;break;
+		case 0x76:helper=dynrec_mmx_pcmpeqd;break;
+		case 0xd1:helper=dynrec_mmx_psrlw;break;
+		case 0xd2:helper=dynrec_mmx_psrld;break;
+		case 0xd3:helper=dynrec_mmx_psrlq;break;
+		case 0xd5:helper=dynrec_mmx_pmullw;break;
+		case 0xd8:helper=dynrec_mmx_psubusb;break;
+		case 0xd9:helper=dynrec_mmx_psubusw;break;
+		case 0xdb:helper=dynrec_mmx_pand;break;
+		case 0xdc:helper=dynrec_mmx_paddusb;break;
+		case 0xdd:helper=dynrec_mmx_paddusw;break;
+		case 0xdf:helper=dynrec_mmx_pandn;break;
+		case 0xe1:helper=dynrec_mmx_psraw;break;
+		case 0xe2:helper=dynrec_mmx_psrad;break;
+		case 0xe5:helper=dynrec_mmx_pmulhw;break;
+		case 0xe8:helper=dynrec_mmx_psubsb;break;
+		case 0xe9:helper=dynrec_mmx_psubsw;break;
+		case 0xeb:helper=dynrec_mmx_por;break;
+		case 0xec:helper=dynrec_mmx_paddsb;break;
+		case 0xed:helper=dynrec_mmx_paddsw;break;
+		case 0xef:helper=dynrec_mmx_pxor;break;
+		case 0xf1:helper=dynrec_mmx_psllw;break;
+		case 0xf2:helper=dynrec_mmx_pslld;break;
+		case 0xf3:helper=dynrec_mmx_psllq;break;
+		case 0xf5:helper=dynrec_mmx_pmaddwd;break;
+		case 0xf8:helper=dynrec_mmx_psubb;break;
+		case 0xf9:helper=dynrec_mmx_psubw;break;
+		case 0xfa:helper=dynrec_mmx_psubd;break;
+		case 0xfc:helper=dynrec_mmx_paddb;break;
+		case 0xfd:helper=dynrec_mmx_paddw;break;
+		case 0xfe:helper=dynrec_mmx_paddd;break;
+		default:
+			return false;
+	}
+	Bitu src=dyn_mmx_get_qq();
+	gen_call_function_II(helper,decode.modrm.reg,src);
+	return true;
+}
+
+#endif
@@ -44,6 +44,9 @@
 // use FC_SEGS_ADDR to hold the address of "Segs" and to access it using FC_SEGS_ADDR
 #define DRC_USE_SEGS_ADDR
 
+// keep guest registers in host registers across the instructions of a block
+#define DRC_USE_REG_CACHE
+
 // register mapping
 typedef uint8_t HostReg;
 
@@ -195,6 +198,8 @@ typedef uint8_t HostReg;
 // used to hold the address of "core_dynrec.readdata" - filled in function gen_run_code
 #define readdata_addr HOST_r22
 
+// registers x23-x28 hold cached guest registers, see gen_regcache_*
+
 
 // instruction encodings
 
@@ -363,6 +368,106 @@ static void gen_mov_dword_to_reg_imm(HostReg dest_reg,uint32_t imm) {
 	}
 }
 
+// guest register cache
+// eax, ecx, edx, ebx, esi and edi are kept in callee-saved host registers while a block
+// is running. They are loaded on first use and written back to cpu_regs before anything
+// that may look at cpu_regs (function calls, conditional branches, block exits).
+// esp and ebp stay in memory, they are mostly accessed by the stack helper functions.
+static const HostReg regcache_host[8] = {
+	HOST_x23, HOST_x24, HOST_x25, HOST_x26, HOST_zr, HOST_zr, HOST_x27, HOST_x28
+};
+
+static struct {
+	uint8_t loaded;         // bit i set: cpu_regs.regs[i] is held in regcache_host[i]
+	uint8_t dirty;          // bit i set: regcache_host[i] is newer than cpu_regs.regs[i]
+	bool keep_next_call;    // the next function call does not access cpu_regs
+} regcache;
+
+// memory access functions of the decoder, they don't access cpu_regs
+bool DRC_CALL_CONV mem_readb_checked_drc(PhysPt address) DRC_FC;
+bool DRC_CALL_CONV mem_writeb_checked_drc(PhysPt address,uint8_t val) DRC_FC;
+bool DRC_CALL_CONV mem_readw_checked_drc(PhysPt address) DRC_FC;
+bool DRC_CALL_CONV mem_readd_checked_drc(PhysPt address) DRC_FC;
+bool DRC_CALL_CONV mem_writew_checked_drc(PhysPt address,uint16_t val) DRC_FC;
+bool DRC_CALL_CONV mem_writed_checked_drc(PhysPt address,uint32_t val) DRC_FC;
+
+// write all modified guest registers back to cpu_regs
+static void gen_regcache_flush(void) {
+	for (Bitu i=0; i<8; i++) {
+		if (regcache.dirty & (1 << i)) {
+			cache_addd( STR_IMM(regcache_host[i], FC_REGS_ADDR, i*4) );      // str host_reg, [FC_REGS_ADDR, #(i*4)]
+		}
+	}
+	regcache.dirty = 0;
+}
+
+// forget the cached values, either cpu_regs may have been changed
+// or control flow merges here; modified registers must be flushed first
+static void INLINE gen_regcache_invalidate(void) {
+	regcache.loaded = 0;
+}
+
+static void INLINE gen_regcache_reset(void) {
+	regcache.loaded = 0;
+	regcache.dirty = 0;
+	regcache.keep_next_call = false;
+}
+
+// the next function call (flags calculation) neither reads nor writes cpu_regs,
+// no code may be emitted in front of it as the call can be replaced later
+static void INLINE gen_regcache_keep_next_call(void) {
+	regcache.keep_next_call = true;
+}
+
+// helper function - find the cached register for size bytes at offset of cpu_regs
+// returns -1 if the access has to go to memory
+static Bits gen_regcache_lookup(Bitu offset, Bitu size) {
+	if (offset >= sizeof(cpu_regs.regs)) return -1;
+	if (((offset & 3) + size) > 4) {
+		// access spans several registers, make memory current
+		gen_regcache_flush();
+		gen_regcache_invalidate();
+		return -1;
+	}
+	if (regcache_host[offset >> 2] == HOST_zr) return -1;
+	return (Bits)(offset >> 2);
+}
+
+// helper function - make sure the cached register holds the guest value
+static HostReg gen_regcache_load(Bitu index) {
+	if ((regcache.loaded & (1 << index)) == 0) {
+		cache_addd( LDR_IMM(regcache_host[index], FC_REGS_ADDR, index*4) );  // ldr host_reg, [FC_REGS_ADDR, #(index*4)]
+		regcache.loaded |= 1 << index;
+	}
+	return regcache_host[index];
+}
+
+// move size bytes at offset of cpu_regs into dest_reg (zero-extended) if cached
+static bool gen_regcache_to_reg(HostReg dest_reg, Bitu offset, Bitu size) {
+	Bits index = gen_regcache_lookup(offset, size);
+	if (index < 0) return false;
+	HostReg host_reg = gen_regcache_load(index);
+	Bitu lsb = (offset & 3) * 8;
+	cache_addd( UBFM(dest_reg, host_reg, lsb, lsb + size*8 - 1) );  // ubfx dest_reg, host_reg, #lsb, #(size*8)
+	return true;
+}
+
+// move the lower size bytes of src_reg to offset of cpu_regs if cached
+static bool gen_regcache_from_reg(HostReg src_reg, Bitu offset, Bitu size) {
+	Bits index = gen_regcache_lookup(offset, size);
+	if (index < 0) return false;
+	HostReg host_reg = regcache_host[index];
+	if (size == 4) {
+		cache_addd( MOV_REG_LSL_IMM(host_reg, src_reg, 0) );    // mov host_reg, src_reg
+		regcache.loaded |= 1 << index;
+	} else {
+		gen_regcache_load(index);
+		cache_addd( BFI(host_reg, src_reg, (offset & 3) * 8, size * 8) );  // bfi host_reg, src_reg, #lsb, #(size*8)
+	}
+	regcache.dirty |= 1 << index;
+	return true;
+}
+
 // helper function
 static bool gen_mov_memval_to_reg_helper(HostReg dest_reg, uint64_t data, Bitu size, HostReg addr_reg, uint64_t addr_data) {
 	switch (size) {
@@ -409,6 +514,7 @@ static bool gen_mov_memval_to_reg_helper(HostReg dest_reg, uint64_t data, Bitu s
 
 // helper function
 static bool gen_mov_memval_to_reg(HostReg dest_reg, void *data, Bitu size) {
+	if (gen_regcache_to_reg(dest_reg, (uint64_t)data - (uint64_t)&cpu_regs, size)) return true;
 	if (gen_mov_memval_to_reg_helper(dest_reg, (uint64_t)data, size, FC_REGS_ADDR, (uint64_t)&cpu_regs)) return true;
 	if (gen_mov_memval_to_reg_helper(dest_reg, (uint64_t)data, size, readdata_addr, (uint64_t)&core_dynrec.readdata)) return true;
 	if (gen_mov_memval_to_reg_helper(dest_reg, (uint64_t)data, size, FC_SEGS_ADDR, (uint64_t)&Segs)) return true;
@@ -522,6 +628,7 @@ static bool gen_mov_memval_from_reg_helper(HostReg src_reg, uint64_t data, Bitu
 
 // helper function
 static bool gen_mov_memval_from_reg(HostReg src_reg, void *dest, Bitu size) {
+	if (gen_regcache_from_reg(src_reg, (uint64_t)dest - (uint64_t)&cpu_regs, size)) return true;
 	if (gen_mov_memval_from_reg_helper(src_reg, (uint64_t)dest, size, FC_REGS_ADDR, (uint64_t)&cpu_regs)) return true;
 	if (gen_mov_memval_from_reg_helper(src_reg, (uint64_t)dest, size, readdata_addr, (uint64_t)&core_dynrec.readdata)) return true;
 	if (gen_mov_memval_from_reg_helper(src_reg, (uint64_t)dest, size, FC_SEGS_ADDR, (uint64_t)&Segs)) return true;
@@ -763,17 +870,36 @@ static INLINE void gen_lea(HostReg dest_reg,Bitu scale,Bits imm) {
 
 // generate a call to a parameterless function
 template <typename T> static void INLINE gen_call_function_raw(const T func) {
+    bool keep_regs = regcache.keep_next_call;
+    regcache.keep_next_call = false;
+    if (!keep_regs) gen_regcache_flush();
+
     cache_addd( MOVZ64(temp1, ((uint64_t)func) & 0xffff, 0) );            // movz dest_reg, #(func & 0xffff)
     cache_addd( MOVK64(temp1, (((uint64_t)func) >> 16) & 0xffff, 16) );   // movk dest_reg, #((func >> 16) & 0xffff), lsl #16
     cache_addd( MOVK64(temp1, (((uint64_t)func) >> 32) & 0xffff, 32) );   // movk dest_reg, #((func >> 32) & 0xffff), lsl #32
     cache_addd( MOVK64(temp1, (((uint64_t)func) >> 48) & 0xffff, 48) );   // movk dest_reg, #((func >> 48) & 0xffff), lsl #48
     cache_addd( BLR_REG(temp1) );      // blr temp1
+
+    // the cached registers survive the call (callee-saved),
+    // but they are stale if the function changed cpu_regs
+    if (!keep_regs) {
+        void *fct_ptr = reinterpret_cast<void*>((uintptr_t)func);
+        if ((fct_ptr != reinterpret_cast<void*>((uintptr_t)mem_readb_checked_drc)) &&
+            (fct_ptr != reinterpret_cast<void*>((uintptr_t)mem_writeb_checked_drc)) &&
+            (fct_ptr != reinterpret_cast<void*>((uintptr_t)mem_readw_checked_drc)) &&
+            (fct_ptr != reinterpret_cast<void*>((uintptr_t)mem_readd_checked_drc)) &&
+            (fct_ptr != reinterpret_cast<void*>((uintptr_t)mem_writew_checked_drc)) &&
+            (fct_ptr != reinterpret_cast<void*>((uintptr_t)mem_writed_checked_drc))) {
+            gen_regcache_invalidate();
+        }
+    }
 }
 
 // generate a call to a function with paramcount parameters
 // note: the parameters are loaded in the architecture specific way
 // using the gen_load_param_ functions below
 template <typename T> static DRC_PTR_SIZE_IM INLINE gen_call_function_setup(const T func,Bitu paramcount,bool fastcall=false) {
+    gen_regcache_flush();
     DRC_PTR_SIZE_IM proc_addr = (DRC_PTR_SIZE_IM)cache.pos;
 	gen_call_function_raw(func);
 	return proc_addr;
@@ -801,6 +927,9 @@ static void INLINE gen_load_param_mem(Bitu mem,Bitu param) {
 
 // jump to an address pointed at by ptr, offset is in imm
 static void gen_jmp_ptr(void * ptr,Bits imm=0) {
+	gen_regcache_flush();
+	gen_regcache_reset();
+
 	if (!gen_mov_memval_to_reg(temp3, ptr, 8)) {
 		gen_mov_qword_to_reg_imm(temp1, (uint64_t)ptr);
 		cache_addd( LDR64_IMM(temp3, temp1, 0) );     // ldr temp3, [temp1]
@@ -821,6 +950,7 @@ static void gen_jmp_ptr(void * ptr,Bits imm=0) {
 // short conditional jump (+-127 bytes) if register is zero
 // the destination is set by gen_fill_branch() later
 static DRC_PTR_SIZE_IM gen_create_branch_on_zero(HostReg reg,bool dword) {
+	gen_regcache_flush();
 	if (dword) {
 		cache_addd( CBZ_FWD(reg, 0) );      // cbz reg, j
 	} else {
@@ -833,6 +963,7 @@ static DRC_PTR_SIZE_IM gen_create_branch_on_zero(HostReg reg,bool dword) {
 // short conditional jump (+-127 bytes) if register is nonzero
 // the destination is set by gen_fill_branch() later
 static DRC_PTR_SIZE_IM gen_create_branch_on_nonzero(HostReg reg,bool dword) {
+	gen_regcache_flush();
 	if (dword) {
 		cache_addd( CBNZ_FWD(reg, 0) );     // cbnz reg, j
 	} else {
@@ -844,6 +975,9 @@ static DRC_PTR_SIZE_IM gen_create_branch_on_nonzero(HostReg reg,bool dword) {
 
 // calculate relative offset and fill it into the location pointed to by data
 static void INLINE gen_fill_branch(DRC_PTR_SIZE_IM data) {
+	// the branch target is reached from two paths
+	gen_regcache_flush();
+	gen_regcache_invalidate();
 #if C_DEBUG
 	Bits len=(uint64_t)cache.pos-data;
 	if (len<0) len=-len;
@@ -856,6 +990,7 @@ static void INLINE gen_fill_branch(DRC_PTR_SIZE_IM data) {
 // for isdword==true the 32bit of the register are tested
 // for isdword==false the lowest 8bit of the register are tested
 static DRC_PTR_SIZE_IM gen_create_branch_long_nonzero(HostReg reg,bool isdword) {
+	gen_regcache_flush();
 	if (isdword) {
 		cache_addd( CBZ_FWD(reg, 8) );      // cbz reg, pc+8    // skip next instruction
 	} else {
@@ -868,6 +1003,7 @@ static DRC_PTR_SIZE_IM gen_create_branch_long_nonzero(HostReg reg,bool isdword)
 
 // compare 32bit-register against zero and jump if value less/equal than zero
 static DRC_PTR_SIZE_IM gen_create_branch_long_leqzero(HostReg reg) {
+	gen_regcache_flush();
 	cache_addd( CMP_IMM(reg, 0, 0) );       // cmp reg, #0
 	cache_addd( BGT_FWD(8) );               // bgt pc+8 // skip next instruction
 	cache_addd( B_FWD(0) );                 // b j
@@ -876,6 +1012,8 @@ static DRC_PTR_SIZE_IM gen_create_branch_long_leqzero(HostReg reg) {
 
 // calculate long relative offset and fill it into the location pointed to by data
 static void INLINE gen_fill_branch_long(DRC_PTR_SIZE_IM data) {
+	gen_regcache_flush();
+	gen_regcache_invalidate();
 	// optimize for shorter branches ?
 	*(uint32_t*)data=( (*(uint32_t*)data) & 0xfc000000 ) | ( ( ((uint64_t)cache.pos - data) >> 2 ) & 0x03ffffff );
 }
@@ -883,10 +1021,13 @@ static void INLINE gen_fill_branch_long(DRC_PTR_SIZE_IM data) {
 static void gen_run_code(void) {
 	uint8_t *pos1, *pos2, *pos3;
 
-	cache_addd( 0xa9bd7bfd );                                           // stp fp, lr, [sp, #-48]!
+	cache_addd( 0xa9ba7bfd );                                           // stp fp, lr, [sp, #-96]!
 	cache_addd( 0x910003fd );                                           // mov fp, sp
 	cache_addd( STP64_IMM(FC_ADDR, FC_REGS_ADDR, HOST_sp, 16) );        // stp FC_ADDR, FC_REGS_ADDR, [sp, #16]
 	cache_addd( STP64_IMM(FC_SEGS_ADDR, readdata_addr, HOST_sp, 32) );  // stp FC_SEGS_ADDR, readdata_addr, [sp, #32]
+	cache_addd( STP64_IMM(HOST_x23, HOST_x24, HOST_sp, 48) );           // stp x23, x24, [sp, #48]
+	cache_addd( STP64_IMM(HOST_x25, HOST_x26, HOST_sp, 64) );           // stp x25, x26, [sp, #64]
+	cache_addd( STP64_IMM(HOST_x27, HOST_x28, HOST_sp, 80) );           // stp x27, x28, [sp, #80]
 
 	pos1 = cache.pos;
 	cache_addd( 0 );
@@ -919,9 +1060,15 @@ static void gen_run_code(void) {
 
 // return from a function
 static void gen_return_function(void) {
+	gen_regcache_flush();
+	gen_regcache_reset();
+
 	cache_addd( LDP64_IMM(FC_ADDR, FC_REGS_ADDR, HOST_sp, 16) );        // ldp FC_ADDR, FC_REGS_ADDR, [sp, #16]
 	cache_addd( LDP64_IMM(FC_SEGS_ADDR, readdata_addr, HOST_sp, 32) );  // ldp FC_SEGS_ADDR, readdata_addr, [sp, #32]
-	cache_addd( 0xa8c37bfd );                                           // ldp fp, lr, [sp], #48
+	cache_addd( LDP64_IMM(HOST_x23, HOST_x24, HOST_sp, 48) );           // ldp x23, x24, [sp, #48]
+	cache_addd( LDP64_IMM(HOST_x25, HOST_x26, HOST_sp, 64) );           // ldp x25, x26, [sp, #64]
+	cache_addd( LDP64_IMM(HOST_x27, HOST_x28, HOST_sp, 80) );           // ldp x27, x28, [sp, #80]
+	cache_addd( 0xa8c67bfd );                                           // ldp fp, lr, [sp], #96
 	cache_addd( RET );                                                  // ret
 }
 
@@ -1151,7 +1298,9 @@ static void cache_block_closing(uint8_t* block_start,Bitu block_size) {
 #endif
 }
 
-static void cache_block_before_close(void) { }
+static void cache_block_before_close(void) {
+	gen_regcache_reset();
+}
 
 #ifdef DRC_USE_SEGS_ADDR
 
@@ -1179,17 +1328,20 @@ static void gen_add_seg32_to_reg(HostReg reg,Bitu index) {
 // mov 16bit value from cpu_regs[index] into dest_reg using FC_REGS_ADDR (index modulo 2 must be zero)
 // 16bit moves may destroy the upper 16bit of the destination register
 static void gen_mov_regval16_to_reg(HostReg dest_reg,Bitu index) {
+	if (gen_regcache_to_reg(dest_reg, index, 2)) return;
 	cache_addd( LDRH_IMM(dest_reg, FC_REGS_ADDR, index) );      // ldrh dest_reg, [FC_REGS_ADDR, #index]
 }
 
 // mov 32bit value from cpu_regs[index] into dest_reg using FC_REGS_ADDR (index modulo 4 must be zero)
 static void gen_mov_regval32_to_reg(HostReg dest_reg,Bitu index) {
+	if (gen_regcache_to_reg(dest_reg, index, 4)) return;
 	cache_addd( LDR_IMM(dest_reg, FC_REGS_ADDR, index) );      // ldr dest_reg, [FC_REGS_ADDR, #index]
 }
 
 // move a 32bit (dword==true) or 16bit (dword==false) value from cpu_regs[index] into dest_reg using FC_REGS_ADDR (if dword==true index modulo 4 must be zero) (if dword==false index modulo 2 must be zero)
 // 16bit moves may destroy the upper 16bit of the destination register
 static void gen_mov_regword_to_reg(HostReg dest_reg,Bitu index,bool dword) {
+	if (gen_regcache_to_reg(dest_reg, index, (dword)?4:2)) return;
 	if (dword) {
 		cache_addd( LDR_IMM(dest_reg, FC_REGS_ADDR, index) );      // ldr dest_reg, [FC_REGS_ADDR, #index]
 	} else {
@@ -1202,6 +1354,7 @@ static void gen_mov_regword_to_reg(HostReg dest_reg,Bitu index,bool dword) {
 // this function does not use FC_OP1/FC_OP2 as dest_reg as these
 // registers might not be directly byte-accessible on some architectures
 static void gen_mov_regbyte_to_reg_low(HostReg dest_reg,Bitu index) {
+	if (gen_regcache_to_reg(dest_reg, index, 1)) return;
 	cache_addd( LDRB_IMM(dest_reg, FC_REGS_ADDR, index) );      // ldrb dest_reg, [FC_REGS_ADDR, #index]
 }
 
@@ -1210,12 +1363,18 @@ static void gen_mov_regbyte_to_reg_low(HostReg dest_reg,Bitu index) {
 // this function can use FC_OP1/FC_OP2 as dest_reg which are
 // not directly byte-accessible on some architectures
 static void gen_mov_regbyte_to_reg_low_canuseword(HostReg dest_reg,Bitu index) {
+	if (gen_regcache_to_reg(dest_reg, index, 1)) return;
 	cache_addd( LDRB_IMM(dest_reg, FC_REGS_ADDR, index) );      // ldrb dest_reg, [FC_REGS_ADDR, #index]
 }
 
 
 // add a 32bit value from cpu_regs[index] to a full register using FC_REGS_ADDR (index modulo 4 must be zero)
 static void gen_add_regval32_to_reg(HostReg reg,Bitu index) {
+	Bits cached = gen_regcache_lookup(index, 4);
+	if (cached >= 0) {
+		cache_addd( ADD_REG_LSL_IMM(reg, reg, gen_regcache_load(cached), 0) );  // add reg, reg, host_reg
+		return;
+	}
 	cache_addd( LDR_IMM(temp2, FC_REGS_ADDR, index) );      // ldr temp2, [FC_REGS_ADDR, #index]
 	cache_addd( ADD_REG_LSL_IMM(reg, reg, temp2, 0) );      // add reg, reg, temp2
 }
@@ -1223,16 +1382,19 @@ static void gen_add_regval32_to_reg(HostReg reg,Bitu index) {
 
 // move 16bit of register into cpu_regs[index] using FC_REGS_ADDR (index modulo 2 must be zero)
 static void gen_mov_regval16_from_reg(HostReg src_reg,Bitu index) {
+	if (gen_regcache_from_reg(src_reg, index, 2)) return;
 	cache_addd( STRH_IMM(src_reg, FC_REGS_ADDR, index) );      // strh src_reg, [FC_REGS_ADDR, #index]
 }
 
 // move 32bit of register into cpu_regs[index] using FC_REGS_ADDR (index modulo 4 must be zero)
 static void gen_mov_regval32_from_reg(HostReg src_reg,Bitu index) {
+	if (gen_regcache_from_reg(src_reg, index, 4)) return;
 	cache_addd( STR_IMM(src_reg, FC_REGS_ADDR, index) );      // str src_reg, [FC_REGS_ADDR, #index]
 }
 
 // move 32bit (dword==true) or 16bit (dword==false) of a register into cpu_regs[index] using FC_REGS_ADDR (if dword==true index modulo 4 must be zero) (if dword==false index modulo 2 must be zero)
 static void gen_mov_regword_from_reg(HostReg src_reg,Bitu index,bool dword) {
+	if (gen_regcache_from_reg(src_reg, index, (dword)?4:2)) return;
 	if (dword) {
 		cache_addd( STR_IMM(src_reg, FC_REGS_ADDR, index) );      // str src_reg, [FC_REGS_ADDR, #index]
 	} else {
@@ -1242,6 +1404,7 @@ static void gen_mov_regword_from_reg(HostReg src_reg,Bitu index,bool dword) {
 
 // move the lowest 8bit of a register into cpu_regs[index] using FC_REGS_ADDR
 static void gen_mov_regbyte_from_reg_low(HostReg src_reg,Bitu index) {
+	if (gen_regcache_from_reg(src_reg, index, 1)) return;
 	cache_addd( STRB_IMM(src_reg, FC_REGS_ADDR, index) );      // strb src_reg, [FC_REGS_ADDR, #index]
 }
 
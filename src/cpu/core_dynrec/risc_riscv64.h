@@ -0,0 +1,988 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+
+/* RISC-V (RV64GC, little endian) backend, modelled after the ARMv8 backend */
+
+#include <type_traits>
+
+
+// some configuring defines that specify the capabilities of this architecture
+// or aspects of the recompiling
+
+// protect FC_ADDR over function calls if necessary
+// #define DRC_PROTECT_ADDR_REG
+
+// try to use non-flags generating functions if possible
+#define DRC_FLAGS_INVALIDATION
+// try to replace _simple functions by code
+#define DRC_FLAGS_INVALIDATION_DCODE
+
+// type with the same size as a pointer
+#define DRC_PTR_SIZE_IM uint64_t
+
+// calling convention modifier
+#define DRC_CALL_CONV	/* nothing */
+#define DRC_FC			/* nothing */
+
+// use FC_REGS_ADDR to hold the address of "cpu_regs" and to access it using FC_REGS_ADDR
+#define DRC_USE_REGS_ADDR
+// use FC_SEGS_ADDR to hold the address of "Segs" and to access it using FC_SEGS_ADDR
+#define DRC_USE_SEGS_ADDR
+
+// register mapping
+typedef uint8_t HostReg;
+
+// registers
+#define HOST_x0		 0
+#define HOST_x1		 1
+#define HOST_x2		 2
+#define HOST_x3		 3
+#define HOST_x4		 4
+#define HOST_x5		 5
+#define HOST_x6		 6
+#define HOST_x7		 7
+#define HOST_x8		 8
+#define HOST_x9		 9
+#define HOST_x10	10
+#define HOST_x11	11
+#define HOST_x12	12
+#define HOST_x13	13
+#define HOST_x14	14
+#define HOST_x15	15
+#define HOST_x16	16
+#define HOST_x17	17
+#define HOST_x18	18
+#define HOST_x19	19
+#define HOST_x20	20
+#define HOST_x21	21
+#define HOST_x22	22
+#define HOST_x23	23
+#define HOST_x24	24
+#define HOST_x25	25
+#define HOST_x26	26
+#define HOST_x27	27
+#define HOST_x28	28
+#define HOST_x29	29
+#define HOST_x30	30
+#define HOST_x31	31
+
+// register aliases (ABI names)
+#define HOST_zero	HOST_x0
+#define HOST_ra		HOST_x1
+#define HOST_sp		HOST_x2
+#define HOST_t0		HOST_x5
+#define HOST_t1		HOST_x6
+#define HOST_t2		HOST_x7
+#define HOST_s1		HOST_x9
+#define HOST_a0		HOST_x10
+#define HOST_a1		HOST_x11
+#define HOST_a2		HOST_x12
+#define HOST_a3		HOST_x13
+#define HOST_s2		HOST_x18
+#define HOST_s3		HOST_x19
+#define HOST_s4		HOST_x20
+#define HOST_t3		HOST_x28
+#define HOST_t4		HOST_x29
+
+
+// temporary registers
+#define temp1 HOST_t0
+#define temp2 HOST_t1
+#define temp3 HOST_t2
+#define temp4 HOST_t3			// only used by gen_mov_qword_to_reg_imm
+
+// register that holds function return values
+#define FC_RETOP HOST_a0
+
+// register used for address calculations,
+#define FC_ADDR HOST_s1			// has to be saved across calls, see DRC_PROTECT_ADDR_REG
+
+// register that holds the first parameter
+#define FC_OP1 HOST_a0
+
+// register that holds the second parameter
+#define FC_OP2 HOST_a1
+
+// special register that holds the third parameter for _R3 calls (byte accessible)
+#define FC_OP3 HOST_a2
+
+// register that holds byte-accessible temporary values
+#define FC_TMP_BA1 HOST_a0
+
+// register that holds byte-accessible temporary values
+#define FC_TMP_BA2 HOST_a1
+
+// temporary register for LEA
+#define TEMP_REG_DRC HOST_t4
+
+// used to hold the address of "cpu_regs" - preferably filled in function gen_run_code
+#define FC_REGS_ADDR HOST_s2
+
+// used to hold the address of "Segs" - preferably filled in function gen_run_code
+#define FC_SEGS_ADDR HOST_s3
+
+// used to hold the address of "core_dynrec.readdata" - filled in function gen_run_code
+#define readdata_addr HOST_s4
+
+
+// instruction encodings
+
+// instruction formats
+#define RV_R(opcode, funct3, funct7, rd, rs1, rs2) ((opcode) + ((rd) << 7) + ((funct3) << 12) + ((rs1) << 15) + ((rs2) << 20) + ((funct7) << 25) )
+#define RV_I(opcode, funct3, rd, rs1, imm) ((opcode) + ((rd) << 7) + ((funct3) << 12) + ((rs1) << 15) + ((((uint32_t)(imm)) & 0xfff) << 20) )
+#define RV_S(opcode, funct3, rs1, rs2, imm) ((opcode) + ((((uint32_t)(imm)) & 0x1f) << 7) + ((funct3) << 12) + ((rs1) << 15) + ((rs2) << 20) + (((((uint32_t)(imm)) >> 5) & 0x7f) << 25) )
+// immediate field of conditional branches		@	-4K <= imm < 4K	&	imm mod 2 = 0
+#define RV_B_IMM(imm) ( ((((uint32_t)(imm)) & 0x1000) << 19) + ((((uint32_t)(imm)) & 0x7e0) << 20) + ((((uint32_t)(imm)) & 0x1e) << 7) + ((((uint32_t)(imm)) & 0x800) >> 4) )
+// immediate field of jal		@	-1M <= imm < 1M	&	imm mod 2 = 0
+#define RV_J_IMM(imm) ( ((((uint32_t)(imm)) & 0x100000) << 11) + ((((uint32_t)(imm)) & 0x7fe) << 20) + ((((uint32_t)(imm)) & 0x800) << 9) + (((uint32_t)(imm)) & 0xff000) )
+// sign-extend the lowest 12 bits
+#define SEXT12(imm) (((int32_t)(((uint32_t)(imm)) << 20)) >> 20)
+
+// move
+// mv dst, src
+#define MV(dst, src) ADDI(dst, src, 0)
+// lui dst, #(imm << 12)		@	0 <= imm < 1M
+#define LUI(dst, imm) (0x00000037 + ((dst) << 7) + (((uint32_t)(imm)) << 12) )
+
+// arithmetic
+// add dst, src1, src2
+#define ADD(dst, src1, src2) RV_R(0x33, 0, 0x00, dst, src1, src2)
+// addw dst, src1, src2
+#define ADDW(dst, src1, src2) RV_R(0x3b, 0, 0x00, dst, src1, src2)
+// subw dst, src1, src2
+#define SUBW(dst, src1, src2) RV_R(0x3b, 0, 0x20, dst, src1, src2)
+// addi dst, src, #imm		@	-2048 <= imm < 2048
+#define ADDI(dst, src, imm) RV_I(0x13, 0, dst, src, imm)
+// addiw dst, src, #imm		@	-2048 <= imm < 2048
+#define ADDIW(dst, src, imm) RV_I(0x1b, 0, dst, src, imm)
+// nop
+#define NOP ADDI(HOST_zero, HOST_zero, 0)
+
+// logical
+// and dst, src1, src2
+#define AND(dst, src1, src2) RV_R(0x33, 7, 0x00, dst, src1, src2)
+// or dst, src1, src2
+#define OR(dst, src1, src2) RV_R(0x33, 6, 0x00, dst, src1, src2)
+// xor dst, src1, src2
+#define XOR(dst, src1, src2) RV_R(0x33, 4, 0x00, dst, src1, src2)
+// andi dst, src, #imm		@	-2048 <= imm < 2048
+#define ANDI(dst, src, imm) RV_I(0x13, 7, dst, src, imm)
+
+// shift
+// slli dst, src, #imm		@	0 <= imm < 64
+#define SLLI(dst, src, imm) RV_I(0x13, 1, dst, src, imm)
+// srli dst, src, #imm		@	0 <= imm < 64
+#define SRLI(dst, src, imm) RV_I(0x13, 5, dst, src, imm)
+// srai dst, src, #imm		@	0 <= imm < 64
+#define SRAI(dst, src, imm) RV_I(0x13, 5, dst, src, 0x400 + (imm))
+// srliw dst, src, #imm		@	0 <= imm < 32
+#define SRLIW(dst, src, imm) RV_I(0x1b, 5, dst, src, imm)
+// sllw dst, src, rreg
+#define SLLW(dst, src, rreg) RV_R(0x3b, 1, 0x00, dst, src, rreg)
+// srlw dst, src, rreg
+#define SRLW(dst, src, rreg) RV_R(0x3b, 5, 0x00, dst, src, rreg)
+// sraw dst, src, rreg
+#define SRAW(dst, src, rreg) RV_R(0x3b, 5, 0x20, dst, src, rreg)
+
+// load
+// ld reg, [addr, #imm]		@	-2048 <= imm < 2048
+#define LD(reg, addr, imm) RV_I(0x03, 3, reg, addr, imm)
+// lw reg, [addr, #imm]		@	-2048 <= imm < 2048
+#define LW(reg, addr, imm) RV_I(0x03, 2, reg, addr, imm)
+// lhu reg, [addr, #imm]		@	-2048 <= imm < 2048
+#define LHU(reg, addr, imm) RV_I(0x03, 5, reg, addr, imm)
+// lbu reg, [addr, #imm]		@	-2048 <= imm < 2048
+#define LBU(reg, addr, imm) RV_I(0x03, 4, reg, addr, imm)
+
+// store
+// sd reg, [addr, #imm]		@	-2048 <= imm < 2048
+#define SD(reg, addr, imm) RV_S(0x23, 3, addr, reg, imm)
+// sw reg, [addr, #imm]		@	-2048 <= imm < 2048
+#define SW(reg, addr, imm) RV_S(0x23, 2, addr, reg, imm)
+// sh reg, [addr, #imm]		@	-2048 <= imm < 2048
+#define SH(reg, addr, imm) RV_S(0x23, 1, addr, reg, imm)
+// sb reg, [addr, #imm]		@	-2048 <= imm < 2048
+#define SB(reg, addr, imm) RV_S(0x23, 0, addr, reg, imm)
+
+// branch
+// beq reg1, reg2, pc+imm		@	-4K <= imm < 4K
+#define BEQ(reg1, reg2, imm) (0x00000063 + ((reg1) << 15) + ((reg2) << 20) + RV_B_IMM(imm) )
+// bne reg1, reg2, pc+imm		@	-4K <= imm < 4K
+#define BNE(reg1, reg2, imm) (0x00001063 + ((reg1) << 15) + ((reg2) << 20) + RV_B_IMM(imm) )
+// blt reg1, reg2, pc+imm		@	-4K <= imm < 4K
+#define BLT(reg1, reg2, imm) (0x00004063 + ((reg1) << 15) + ((reg2) << 20) + RV_B_IMM(imm) )
+// j pc+imm		@	-1M <= imm < 1M
+#define J(imm) (0x0000006f + RV_J_IMM(imm) )
+// jalr dst, [reg, #imm]
+#define JALR(dst, reg, imm) RV_I(0x67, 0, dst, reg, imm)
+// jr reg
+#define JR(reg) JALR(HOST_zero, reg, 0)
+// ret
+#define RET JR(HOST_ra)
+
+// last instruction of a call generated by gen_call_function_raw
+#define CALL_JALR JALR(HOST_ra, temp1, 0)
+
+
+// move a full register from reg_src to reg_dst
+static void gen_mov_regs(HostReg reg_dst,HostReg reg_src) {
+	if(reg_src == reg_dst) return;
+	cache_addd( MV(reg_dst, reg_src) );      // mv reg_dst, reg_src
+}
+
+// move a 32bit constant value into dest_reg
+// the value is sign-extended to 64bit
+static void gen_mov_dword_to_reg_imm(HostReg dest_reg,uint32_t imm) {
+	if ( ((int32_t)imm >= -2048) && ((int32_t)imm < 2048) ) {
+		cache_addd( ADDI(dest_reg, HOST_zero, imm) );                   // li dest_reg, #imm
+	} else {
+		cache_addd( LUI(dest_reg, ((imm + 0x800) >> 12) & 0xfffff) );   // lui dest_reg, #((imm + 0x800) >> 12)
+		if (imm & 0xfff) {
+			cache_addd( ADDIW(dest_reg, dest_reg, SEXT12(imm)) );       // addiw dest_reg, dest_reg, #sext(imm & 0xfff)
+		}
+	}
+}
+
+// helper function
+static bool gen_mov_memval_to_reg_helper(HostReg dest_reg, uint64_t data, Bitu size, HostReg addr_reg, uint64_t addr_data) {
+	int64_t offset = (int64_t)(data - addr_data);
+	if ((offset < -2048) || (offset >= 2048)) return false;
+	switch (size) {
+		case 8:
+			cache_addd( LD(dest_reg, addr_reg, offset) );      // ld dest_reg, [addr_reg, #(data - addr_data)]
+			return true;
+		case 4:
+			cache_addd( LW(dest_reg, addr_reg, offset) );      // lw dest_reg, [addr_reg, #(data - addr_data)]
+			return true;
+		case 2:
+			cache_addd( LHU(dest_reg, addr_reg, offset) );     // lhu dest_reg, [addr_reg, #(data - addr_data)]
+			return true;
+		case 1:
+			cache_addd( LBU(dest_reg, addr_reg, offset) );     // lbu dest_reg, [addr_reg, #(data - addr_data)]
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+// helper function
+static bool gen_mov_memval_to_reg(HostReg dest_reg, void *data, Bitu size) {
+	if (gen_mov_memval_to_reg_helper(dest_reg, (uint64_t)data, size, FC_REGS_ADDR, (uint64_t)&cpu_regs)) return true;
+	if (gen_mov_memval_to_reg_helper(dest_reg, (uint64_t)data, size, readdata_addr, (uint64_t)&core_dynrec.readdata)) return true;
+	if (gen_mov_memval_to_reg_helper(dest_reg, (uint64_t)data, size, FC_SEGS_ADDR, (uint64_t)&Segs)) return true;
+	return false;
+}
+
+// helper function - move a 64bit constant value into dest_reg
+static void gen_mov_qword_to_reg_imm(HostReg dest_reg,uint64_t imm) {
+	if ((int64_t)imm == (int64_t)(int32_t)imm) {
+		gen_mov_dword_to_reg_imm(dest_reg, (uint32_t)imm);
+		return;
+	}
+
+	// the lower half is added sign-extended, compensate in the upper half
+	gen_mov_dword_to_reg_imm(dest_reg, (uint32_t)(imm >> 32) + (uint32_t)((imm >> 31) & 1));
+	cache_addd( SLLI(dest_reg, dest_reg, 32) );                     // slli dest_reg, dest_reg, #32
+	if ( ((int32_t)imm >= -2048) && ((int32_t)imm < 2048) ) {
+		if ((uint32_t)imm != 0) {
+			cache_addd( ADDI(dest_reg, dest_reg, (uint32_t)imm) );  // addi dest_reg, dest_reg, #sext(imm & 0xffffffff)
+		}
+	} else {
+		gen_mov_dword_to_reg_imm(temp4, (uint32_t)imm);
+		cache_addd( ADD(dest_reg, dest_reg, temp4) );               // add dest_reg, dest_reg, temp4
+	}
+}
+
+// helper function for gen_mov_word_to_reg
+static void gen_mov_word_to_reg_helper(HostReg dest_reg,void* data,bool dword,HostReg data_reg) {
+	if (dword) {
+		cache_addd( LW(dest_reg, data_reg, 0) );       // lw dest_reg, [data_reg]
+	} else {
+		cache_addd( LHU(dest_reg, data_reg, 0) );      // lhu dest_reg, [data_reg]
+	}
+}
+
+// move a 32bit (dword==true) or 16bit (dword==false) value from memory into dest_reg
+// 16bit moves may destroy the upper 16bit of the destination register
+static void gen_mov_word_to_reg(HostReg dest_reg,void* data,bool dword) {
+	if (!gen_mov_memval_to_reg(dest_reg, data, (dword)?4:2)) {
+		gen_mov_qword_to_reg_imm(temp1, (uint64_t)data);
+		gen_mov_word_to_reg_helper(dest_reg, data, dword, temp1);
+	}
+}
+
+// move a 16bit constant value into dest_reg
+// the upper 16bit of the destination register may be destroyed
+static void INLINE gen_mov_word_to_reg_imm(HostReg dest_reg,uint16_t imm) {
+	gen_mov_dword_to_reg_imm(dest_reg, imm);
+}
+
+// helper function
+static bool gen_mov_memval_from_reg_helper(HostReg src_reg, uint64_t data, Bitu size, HostReg addr_reg, uint64_t addr_data) {
+	int64_t offset = (int64_t)(data - addr_data);
+	if ((offset < -2048) || (offset >= 2048)) return false;
+	switch (size) {
+		case 8:
+			cache_addd( SD(src_reg, addr_reg, offset) );       // sd src_reg, [addr_reg, #(data - addr_data)]
+			return true;
+		case 4:
+			cache_addd( SW(src_reg, addr_reg, offset) );       // sw src_reg, [addr_reg, #(data - addr_data)]
+			return true;
+		case 2:
+			cache_addd( SH(src_reg, addr_reg, offset) );       // sh src_reg, [addr_reg, #(data - addr_data)]
+			return true;
+		case 1:
+			cache_addd( SB(src_reg, addr_reg, offset) );       // sb src_reg, [addr_reg, #(data - addr_data)]
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+// helper function
+static bool gen_mov_memval_from_reg(HostReg src_reg, void *dest, Bitu size) {
+	if (gen_mov_memval_from_reg_helper(src_reg, (uint64_t)dest, size, FC_REGS_ADDR, (uint64_t)&cpu_regs)) return true;
+	if (gen_mov_memval_from_reg_helper(src_reg, (uint64_t)dest, size, readdata_addr, (uint64_t)&core_dynrec.readdata)) return true;
+	if (gen_mov_memval_from_reg_helper(src_reg, (uint64_t)dest, size, FC_SEGS_ADDR, (uint64_t)&Segs)) return true;
+	return false;
+}
+
+// helper function for gen_mov_word_from_reg
+static void gen_mov_word_from_reg_helper(HostReg src_reg,void* dest,bool dword, HostReg data_reg) {
+	if (dword) {
+		cache_addd( SW(src_reg, data_reg, 0) );        // sw src_reg, [data_reg]
+	} else {
+		cache_addd( SH(src_reg, data_reg, 0) );        // sh src_reg, [data_reg]
+	}
+}
+
+// move 32bit (dword==true) or 16bit (dword==false) of a register into memory
+static void gen_mov_word_from_reg(HostReg src_reg,void* dest,bool dword) {
+	if (!gen_mov_memval_from_reg(src_reg, dest, (dword)?4:2)) {
+		gen_mov_qword_to_reg_imm(temp1, (uint64_t)dest);
+		gen_mov_word_from_reg_helper(src_reg, dest, dword, temp1);
+	}
+}
+
+// move an 8bit value from memory into dest_reg
+// the upper 24bit of the destination register can be destroyed
+// this function does not use FC_OP1/FC_OP2 as dest_reg as these
+// registers might not be directly byte-accessible on some architectures
+static void gen_mov_byte_to_reg_low(HostReg dest_reg,void* data) {
+	if (!gen_mov_memval_to_reg(dest_reg, data, 1)) {
+		gen_mov_qword_to_reg_imm(temp1, (uint64_t)data);
+		cache_addd( LBU(dest_reg, temp1, 0) );     // lbu dest_reg, [temp1]
+	}
+}
+
+// move an 8bit value from memory into dest_reg
+// the upper 24bit of the destination register can be destroyed
+// this function can use FC_OP1/FC_OP2 as dest_reg which are
+// not directly byte-accessible on some architectures
+static void INLINE gen_mov_byte_to_reg_low_canuseword(HostReg dest_reg,void* data) {
+	gen_mov_byte_to_reg_low(dest_reg, data);
+}
+
+// move an 8bit constant value into dest_reg
+// the upper 24bit of the destination register can be destroyed
+// this function does not use FC_OP1/FC_OP2 as dest_reg as these
+// registers might not be directly byte-accessible on some architectures
+static void gen_mov_byte_to_reg_low_imm(HostReg dest_reg,uint8_t imm) {
+	cache_addd( ADDI(dest_reg, HOST_zero, imm) );   // li dest_reg, #imm
+}
+
+// move an 8bit constant value into dest_reg
+// the upper 24bit of the destination register can be destroyed
+// this function can use FC_OP1/FC_OP2 as dest_reg which are
+// not directly byte-accessible on some architectures
+static void INLINE gen_mov_byte_to_reg_low_imm_canuseword(HostReg dest_reg,uint8_t imm) {
+	gen_mov_byte_to_reg_low_imm(dest_reg, imm);
+}
+
+// move the lowest 8bit of a register into memory
+static void gen_mov_byte_from_reg_low(HostReg src_reg,void* dest) {
+	if (!gen_mov_memval_from_reg(src_reg, dest, 1)) {
+		gen_mov_qword_to_reg_imm(temp1, (uint64_t)dest);
+		cache_addd( SB(src_reg, temp1, 0) );      // sb src_reg, [temp1]
+	}
+}
+
+
+
+// convert an 8bit word to a 32bit dword
+// the register is zero-extended (sign==false) or sign-extended (sign==true)
+static void gen_extend_byte(bool sign,HostReg reg) {
+	if (sign) {
+		cache_addd( SLLI(reg, reg, 56) );      // slli reg, reg, #56
+		cache_addd( SRAI(reg, reg, 56) );      // srai reg, reg, #56
+	} else {
+		cache_addd( ANDI(reg, reg, 0xff) );    // andi reg, reg, #0xff
+	}
+}
+
+// convert a 16bit word to a 32bit dword
+// the register is zero-extended (sign==false) or sign-extended (sign==true)
+static void gen_extend_word(bool sign,HostReg reg) {
+	cache_addd( SLLI(reg, reg, 48) );          // slli reg, reg, #48
+	if (sign) {
+		cache_addd( SRAI(reg, reg, 48) );      // srai reg, reg, #48
+	} else {
+		cache_addd( SRLI(reg, reg, 48) );      // srli reg, reg, #48
+	}
+}
+
+// add a 32bit value from memory to a full register
+static void gen_add(HostReg reg,void* op) {
+	gen_mov_word_to_reg(temp3, op, 1);
+	cache_addd( ADDW(reg, reg, temp3) );      // addw reg, reg, temp3
+}
+
+// add a 32bit constant value to a full register
+static void gen_add_imm(HostReg reg,uint32_t imm) {
+	if(!imm) return;
+
+	if ( ((int32_t)imm >= -2048) && ((int32_t)imm < 2048) ) {
+		cache_addd( ADDIW(reg, reg, imm) );             // addiw reg, reg, #imm
+	} else {
+		gen_mov_dword_to_reg_imm(temp2, imm);
+		cache_addd( ADDW(reg, reg, temp2) );            // addw reg, reg, temp2
+	}
+}
+
+// and a 32bit constant value with a full register
+static void gen_and_imm(HostReg reg,uint32_t imm) {
+	if(imm == 0xffffffff) return;
+
+	if ( ((int32_t)imm >= -2048) && ((int32_t)imm < 2048) ) {
+		cache_addd( ANDI(reg, reg, imm) );              // andi reg, reg, #imm
+	} else {
+		gen_mov_dword_to_reg_imm(temp2, imm);
+		cache_addd( AND(reg, reg, temp2) );             // and reg, reg, temp2
+	}
+}
+
+// shift right a register by an 8-bit constant
+static void gen_shr_imm(HostReg reg,uint8_t imm) {
+	cache_addd( SRLIW(reg, reg, imm & 0x1f) );      // srliw reg, reg, #imm
+}
+
+
+// move a 32bit constant value into memory
+static void gen_mov_direct_dword(void* dest,uint32_t imm) {
+	gen_mov_dword_to_reg_imm(temp3, imm);
+	gen_mov_word_from_reg(temp3, dest, 1);
+}
+
+// move an address into memory
+static void INLINE gen_mov_direct_ptr(void* dest,DRC_PTR_SIZE_IM imm) {
+	gen_mov_qword_to_reg_imm(temp3, imm);
+	if (!gen_mov_memval_from_reg(temp3, dest, 8)) {
+		gen_mov_qword_to_reg_imm(temp1, (uint64_t)dest);
+		cache_addd( SD(temp3, temp1, 0) );       // sd temp3, [temp1]
+	}
+}
+
+// add a 32bit (dword==true) or 16bit (dword==false) constant value to a memory value
+static void gen_add_direct_word(void* dest,uint32_t imm,bool dword) {
+	if (!dword) imm &= 0xffff;
+	if(!imm) return;
+
+	if (!gen_mov_memval_to_reg(temp3, dest, (dword)?4:2)) {
+		gen_mov_qword_to_reg_imm(temp1, (uint64_t)dest);
+		gen_mov_word_to_reg_helper(temp3, dest, dword, temp1);
+	}
+	gen_add_imm(temp3, imm);
+	if (!gen_mov_memval_from_reg(temp3, dest, (dword)?4:2)) {
+		gen_mov_word_from_reg_helper(temp3, dest, dword, temp1);
+	}
+}
+
+// add an 8bit constant value to a dword memory value
+static void gen_add_direct_byte(void* dest,int8_t imm) {
+	gen_add_direct_word(dest, (int32_t)imm, 1);
+}
+
+// subtract a 32bit (dword==true) or 16bit (dword==false) constant value from a memory value
+static void gen_sub_direct_word(void* dest,uint32_t imm,bool dword) {
+	if (!dword) imm &= 0xffff;
+	if(!imm) return;
+
+	if (!gen_mov_memval_to_reg(temp3, dest, (dword)?4:2)) {
+		gen_mov_qword_to_reg_imm(temp1, (uint64_t)dest);
+		gen_mov_word_to_reg_helper(temp3, dest, dword, temp1);
+	}
+	gen_add_imm(temp3, (uint32_t) (-((int32_t)imm)));
+	if (!gen_mov_memval_from_reg(temp3, dest, (dword)?4:2)) {
+		gen_mov_word_from_reg_helper(temp3, dest, dword, temp1);
+	}
+}
+
+// subtract an 8bit constant value from a dword memory value
+static void gen_sub_direct_byte(void* dest,int8_t imm) {
+	gen_sub_direct_word(dest, (int32_t)imm, 1);
+}
+
+// effective address calculation, destination is dest_reg
+// scale_reg is scaled by scale (scale_reg*(2^scale)) and
+// added to dest_reg, then the immediate value is added
+static INLINE void gen_lea(HostReg dest_reg,HostReg scale_reg,Bitu scale,Bits imm) {
+	if (scale) {
+		cache_addd( SLLI(temp2, scale_reg, scale) );       // slli temp2, scale_reg, #scale
+		cache_addd( ADD(dest_reg, dest_reg, temp2) );      // add dest_reg, dest_reg, temp2
+	} else {
+		cache_addd( ADD(dest_reg, dest_reg, scale_reg) );  // add dest_reg, dest_reg, scale_reg
+	}
+	gen_add_imm(dest_reg, imm);
+}
+
+// effective address calculation, destination is dest_reg
+// dest_reg is scaled by scale (dest_reg*(2^scale)),
+// then the immediate value is added
+static INLINE void gen_lea(HostReg dest_reg,Bitu scale,Bits imm) {
+	if (scale) {
+		cache_addd( SLLI(dest_reg, dest_reg, scale) );     // slli dest_reg, dest_reg, #scale
+	}
+	gen_add_imm(dest_reg, imm);
+}
+
+// helper function - the calling convention requires integer parameters to be
+// extended to 64bit according to their type (32bit values always sign-extended)
+// while the recompiled code only keeps the low 32bit of a register valid
+template <typename A> static void gen_extend_param(HostReg reg) {
+	if (std::is_pointer<A>::value || std::is_floating_point<A>::value || (sizeof(A) >= 8)) return;
+	if (sizeof(A) == 4) {
+		cache_addd( ADDIW(reg, reg, 0) );                          // sext.w reg, reg
+	} else if (std::is_signed<A>::value) {
+		cache_addd( SLLI(reg, reg, 64 - 8*sizeof(A)) );            // slli reg, reg, #(64 - bits)
+		cache_addd( SRAI(reg, reg, 64 - 8*sizeof(A)) );            // srai reg, reg, #(64 - bits)
+	} else if (sizeof(A) == 1) {
+		cache_addd( ANDI(reg, reg, 0xff) );                        // andi reg, reg, #0xff
+	} else {
+		cache_addd( SLLI(reg, reg, 48) );                          // slli reg, reg, #48
+		cache_addd( SRLI(reg, reg, 48) );                          // srli reg, reg, #48
+	}
+}
+
+template <typename T> struct gen_call_params {
+	static void extend(void) { }
+};
+
+template <typename R, typename... A> struct gen_call_params<R (*)(A...)> {
+	static void extend(void) {
+		HostReg reg = HOST_a0;
+		int expand[] = { 0, (gen_extend_param<A>(reg++), 0)... };
+		(void)expand;
+	}
+};
+
+// helper function - fill the function address into the first six instructions
+// of a call generated by gen_call_function_raw
+static void gen_fill_call_address(uint8_t * pos,uint64_t addr) {
+	// the lower half is added sign-extended, compensate in the upper half
+	uint32_t upper = (uint32_t)(addr >> 32) + (uint32_t)((addr >> 31) & 1);
+	uint32_t lower = (uint32_t)addr;
+	*(uint32_t*)pos=LUI(temp1, ((upper + 0x800) >> 12) & 0xfffff);        // lui temp1, #((upper + 0x800) >> 12)
+	*(uint32_t*)(pos+4)=ADDIW(temp1, temp1, SEXT12(upper));                // addiw temp1, temp1, #sext(upper & 0xfff)
+	*(uint32_t*)(pos+8)=SLLI(temp1, temp1, 32);                            // slli temp1, temp1, #32
+	*(uint32_t*)(pos+12)=LUI(temp2, ((lower + 0x800) >> 12) & 0xfffff);    // lui temp2, #((lower + 0x800) >> 12)
+	*(uint32_t*)(pos+16)=ADDIW(temp2, temp2, SEXT12(lower));               // addiw temp2, temp2, #sext(lower & 0xfff)
+	*(uint32_t*)(pos+20)=ADD(temp1, temp1, temp2);                         // add temp1, temp1, temp2
+}
+
+// generate a call to a parameterless function
+// layout: six instructions loading the address into temp1 (can be patched by
+// gen_fill_function_ptr), the parameter extension, then the jalr
+template <typename T> static void INLINE gen_call_function_raw(const T func) {
+	uint8_t * pos = cache.pos;
+	cache.pos += 6*4;
+	gen_fill_call_address(pos, (uint64_t)func);
+	gen_call_params<T>::extend();
+	cache_addd( CALL_JALR );      // jalr ra, [temp1]
+}
+
+// generate a call to a function with paramcount parameters
+// note: the parameters are loaded in the architecture specific way
+// using the gen_load_param_ functions below
+template <typename T> static DRC_PTR_SIZE_IM INLINE gen_call_function_setup(const T func,Bitu paramcount,bool fastcall=false) {
+	DRC_PTR_SIZE_IM proc_addr = (DRC_PTR_SIZE_IM)cache.pos;
+	gen_call_function_raw(func);
+	return proc_addr;
+}
+
+// load an immediate value as param'th function parameter
+static void INLINE gen_load_param_imm(Bitu imm,Bitu param) {
+	gen_mov_qword_to_reg_imm(HOST_a0 + param, imm);
+}
+
+// load an address as param'th function parameter
+static void INLINE gen_load_param_addr(DRC_PTR_SIZE_IM addr,Bitu param) {
+	gen_mov_qword_to_reg_imm(HOST_a0 + param, addr);
+}
+
+// load a host-register as param'th function parameter
+static void INLINE gen_load_param_reg(Bitu reg,Bitu param) {
+	gen_mov_regs(HOST_a0 + param, reg);
+}
+
+// load a value from memory as param'th function parameter
+static void INLINE gen_load_param_mem(Bitu mem,Bitu param) {
+	gen_mov_word_to_reg(HOST_a0 + param, (void *)mem, 1);
+}
+
+// jump to an address pointed at by ptr, offset is in imm
+static void gen_jmp_ptr(void * ptr,Bits imm=0) {
+	if (!gen_mov_memval_to_reg(temp3, ptr, 8)) {
+		gen_mov_qword_to_reg_imm(temp1, (uint64_t)ptr);
+		cache_addd( LD(temp3, temp1, 0) );          // ld temp3, [temp1]
+	}
+
+	if ((imm < 2048) && (imm >= -2048)) {
+		cache_addd( LD(temp1, temp3, imm) );        // ld temp1, [temp3, #imm]
+	} else {
+		gen_mov_qword_to_reg_imm(temp2, imm);
+		cache_addd( ADD(temp3, temp3, temp2) );     // add temp3, temp3, temp2
+		cache_addd( LD(temp1, temp3, 0) );          // ld temp1, [temp3]
+	}
+
+	cache_addd( JR(temp1) );      // jr temp1
+}
+
+// short conditional jump (+-127 bytes) if register is zero
+// the destination is set by gen_fill_branch() later
+static DRC_PTR_SIZE_IM gen_create_branch_on_zero(HostReg reg,bool dword) {
+	cache_addd( SLLI(temp1, reg, (dword)?32:48) );  // slli temp1, reg, #(64 - bits)
+	cache_addd( BEQ(temp1, HOST_zero, 0) );         // beqz temp1, j
+	return ((DRC_PTR_SIZE_IM)cache.pos-4);
+}
+
+// short conditional jump (+-127 bytes) if register is nonzero
+// the destination is set by gen_fill_branch() later
+static DRC_PTR_SIZE_IM gen_create_branch_on_nonzero(HostReg reg,bool dword) {
+	cache_addd( SLLI(temp1, reg, (dword)?32:48) );  // slli temp1, reg, #(64 - bits)
+	cache_addd( BNE(temp1, HOST_zero, 0) );         // bnez temp1, j
+	return ((DRC_PTR_SIZE_IM)cache.pos-4);
+}
+
+// calculate relative offset and fill it into the location pointed to by data
+static void INLINE gen_fill_branch(DRC_PTR_SIZE_IM data) {
+#if C_DEBUG
+	Bits len=(uint64_t)cache.pos-data;
+	if (len<0) len=-len;
+	if (len>=0x00001000) LOG_MSG("Big jump %d",(int)len);
+#endif
+	*(uint32_t*)data=( (*(uint32_t*)data) & 0x01fff07f ) | RV_B_IMM((uint64_t)cache.pos - data);
+}
+
+// conditional jump if register is nonzero
+// for isdword==true the 32bit of the register are tested
+// for isdword==false the lowest 8bit of the register are tested
+static DRC_PTR_SIZE_IM gen_create_branch_long_nonzero(HostReg reg,bool isdword) {
+	if (isdword) {
+		cache_addd( SLLI(temp1, reg, 32) );         // slli temp1, reg, #32
+	} else {
+		cache_addd( ANDI(temp1, reg, 0xff) );       // andi temp1, reg, #0xff
+	}
+	cache_addd( BEQ(temp1, HOST_zero, 8) );         // beqz temp1, pc+8  // skip next instruction
+	cache_addd( J(0) );                             // j j
+	return ((DRC_PTR_SIZE_IM)cache.pos-4);
+}
+
+// compare 32bit-register against zero and jump if value less/equal than zero
+static DRC_PTR_SIZE_IM gen_create_branch_long_leqzero(HostReg reg) {
+	cache_addd( ADDIW(temp1, reg, 0) );             // sext.w temp1, reg
+	cache_addd( BLT(HOST_zero, temp1, 8) );         // bgtz temp1, pc+8 // skip next instruction
+	cache_addd( J(0) );                             // j j
+	return ((DRC_PTR_SIZE_IM)cache.pos-4);
+}
+
+// calculate long relative offset and fill it into the location pointed to by data
+static void INLINE gen_fill_branch_long(DRC_PTR_SIZE_IM data) {
+	*(uint32_t*)data=( (*(uint32_t*)data) & 0x00000fff ) | RV_J_IMM((uint64_t)cache.pos - data);
+}
+
+static void gen_run_code(void) {
+	cache_addd( ADDI(HOST_sp, HOST_sp, -48) );          // addi sp, sp, #-48
+	cache_addd( SD(HOST_ra, HOST_sp, 40) );             // sd ra, [sp, #40]
+	cache_addd( SD(FC_ADDR, HOST_sp, 32) );             // sd FC_ADDR, [sp, #32]
+	cache_addd( SD(FC_REGS_ADDR, HOST_sp, 24) );        // sd FC_REGS_ADDR, [sp, #24]
+	cache_addd( SD(FC_SEGS_ADDR, HOST_sp, 16) );        // sd FC_SEGS_ADDR, [sp, #16]
+	cache_addd( SD(readdata_addr, HOST_sp, 8) );        // sd readdata_addr, [sp, #8]
+
+	gen_mov_qword_to_reg_imm(FC_SEGS_ADDR, (uint64_t)&Segs);
+	gen_mov_qword_to_reg_imm(FC_REGS_ADDR, (uint64_t)&cpu_regs);
+	gen_mov_qword_to_reg_imm(readdata_addr, (uint64_t)&core_dynrec.readdata);
+
+	cache_addd( JR(HOST_a0) );          // jr a0
+
+	// align cache.pos to 32 bytes
+	if ((((Bitu)cache.pos) & 0x1f) != 0) {
+		cache.pos = cache.pos + (32 - (((Bitu)cache.pos) & 0x1f));
+	}
+}
+
+// return from a function
+static void gen_return_function(void) {
+	cache_addd( LD(readdata_addr, HOST_sp, 8) );        // ld readdata_addr, [sp, #8]
+	cache_addd( LD(FC_SEGS_ADDR, HOST_sp, 16) );        // ld FC_SEGS_ADDR, [sp, #16]
+	cache_addd( LD(FC_REGS_ADDR, HOST_sp, 24) );        // ld FC_REGS_ADDR, [sp, #24]
+	cache_addd( LD(FC_ADDR, HOST_sp, 32) );             // ld FC_ADDR, [sp, #32]
+	cache_addd( LD(HOST_ra, HOST_sp, 40) );             // ld ra, [sp, #40]
+	cache_addd( ADDI(HOST_sp, HOST_sp, 48) );           // addi sp, sp, #48
+	cache_addd( RET );                                  // ret
+}
+
+#ifdef DRC_FLAGS_INVALIDATION
+
+#ifdef DRC_FLAGS_INVALIDATION_DCODE
+// helper function - replace a call generated by gen_call_function_raw
+// by count instructions (at most five) and a jump behind the call
+static void gen_fill_inline_code(uint8_t * pos,const uint32_t * code,Bitu count) {
+	// skip the parameter extension
+	uint8_t * end = pos + 6*4;
+	while (*(uint32_t*)end != CALL_JALR) end += 4;
+	end += 4;
+
+	for (Bitu i=0; i<count; i++) {
+		*(uint32_t*)(pos+i*4)=code[i];
+	}
+	*(uint32_t*)(pos+count*4)=J(end - (pos+count*4));		// j end
+}
+#endif
+
+// called when a call to a function can be replaced by a
+// call to a simpler function
+static void gen_fill_function_ptr(uint8_t * pos,void* fct_ptr,Bitu flags_type) {
+#ifdef DRC_FLAGS_INVALIDATION_DCODE
+	// try to avoid function calls but rather directly fill in code
+	// the parameters are not extended yet, only their relevant bits are used
+	switch (flags_type) {
+		case t_ADDb:
+		case t_ADDw:
+		case t_ADDd: {
+			const uint32_t code[] = { ADDW(FC_RETOP, HOST_a0, HOST_a1) };	// addw FC_RETOP, a0, a1
+			gen_fill_inline_code(pos, code, 1);
+			} break;
+		case t_ORb:
+		case t_ORw:
+		case t_ORd: {
+			const uint32_t code[] = { OR(FC_RETOP, HOST_a0, HOST_a1) };	// or FC_RETOP, a0, a1
+			gen_fill_inline_code(pos, code, 1);
+			} break;
+		case t_ANDb:
+		case t_ANDw:
+		case t_ANDd: {
+			const uint32_t code[] = { AND(FC_RETOP, HOST_a0, HOST_a1) };	// and FC_RETOP, a0, a1
+			gen_fill_inline_code(pos, code, 1);
+			} break;
+		case t_SUBb:
+		case t_SUBw:
+		case t_SUBd: {
+			const uint32_t code[] = { SUBW(FC_RETOP, HOST_a0, HOST_a1) };	// subw FC_RETOP, a0, a1
+			gen_fill_inline_code(pos, code, 1);
+			} break;
+		case t_XORb:
+		case t_XORw:
+		case t_XORd: {
+			const uint32_t code[] = { XOR(FC_RETOP, HOST_a0, HOST_a1) };	// xor FC_RETOP, a0, a1
+			gen_fill_inline_code(pos, code, 1);
+			} break;
+		case t_CMPb:
+		case t_CMPw:
+		case t_CMPd:
+		case t_TESTb:
+		case t_TESTw:
+		case t_TESTd:
+			gen_fill_inline_code(pos, NULL, 0);
+			break;
+		case t_INCb:
+		case t_INCw:
+		case t_INCd: {
+			const uint32_t code[] = { ADDIW(FC_RETOP, HOST_a0, 1) };	// addiw FC_RETOP, a0, #1
+			gen_fill_inline_code(pos, code, 1);
+			} break;
+		case t_DECb:
+		case t_DECw:
+		case t_DECd: {
+			const uint32_t code[] = { ADDIW(FC_RETOP, HOST_a0, -1) };	// addiw FC_RETOP, a0, #-1
+			gen_fill_inline_code(pos, code, 1);
+			} break;
+		case t_SHLb:
+		case t_SHLw:
+		case t_SHLd: {
+			const uint32_t code[] = { SLLW(FC_RETOP, HOST_a0, HOST_a1) };	// sllw FC_RETOP, a0, a1
+			gen_fill_inline_code(pos, code, 1);
+			} break;
+		case t_SHRb: {
+			const uint32_t code[] = {
+				ANDI(FC_RETOP, HOST_a0, 0xff),			// andi FC_RETOP, a0, #0xff
+				SRLW(FC_RETOP, FC_RETOP, HOST_a1)		// srlw FC_RETOP, FC_RETOP, a1
+			};
+			gen_fill_inline_code(pos, code, 2);
+			} break;
+		case t_SHRw: {
+			const uint32_t code[] = {
+				SLLI(FC_RETOP, HOST_a0, 48),			// slli FC_RETOP, a0, #48
+				SRLI(FC_RETOP, FC_RETOP, 48),			// srli FC_RETOP, FC_RETOP, #48
+				SRLW(FC_RETOP, FC_RETOP, HOST_a1)		// srlw FC_RETOP, FC_RETOP, a1
+			};
+			gen_fill_inline_code(pos, code, 3);
+			} break;
+		case t_SHRd: {
+			const uint32_t code[] = { SRLW(FC_RETOP, HOST_a0, HOST_a1) };	// srlw FC_RETOP, a0, a1
+			gen_fill_inline_code(pos, code, 1);
+			} break;
+		case t_SARb: {
+			const uint32_t code[] = {
+				SLLI(FC_RETOP, HOST_a0, 56),			// slli FC_RETOP, a0, #56
+				SRAI(FC_RETOP, FC_RETOP, 56),			// srai FC_RETOP, FC_RETOP, #56
+				SRAW(FC_RETOP, FC_RETOP, HOST_a1)		// sraw FC_RETOP, FC_RETOP, a1
+			};
+			gen_fill_inline_code(pos, code, 3);
+			} break;
+		case t_SARw: {
+			const uint32_t code[] = {
+				SLLI(FC_RETOP, HOST_a0, 48),			// slli FC_RETOP, a0, #48
+				SRAI(FC_RETOP, FC_RETOP, 48),			// srai FC_RETOP, FC_RETOP, #48
+				SRAW(FC_RETOP, FC_RETOP, HOST_a1)		// sraw FC_RETOP, FC_RETOP, a1
+			};
+			gen_fill_inline_code(pos, code, 3);
+			} break;
+		case t_SARd: {
+			const uint32_t code[] = { SRAW(FC_RETOP, HOST_a0, HOST_a1) };	// sraw FC_RETOP, a0, a1
+			gen_fill_inline_code(pos, code, 1);
+			} break;
+		case t_NEGb:
+		case t_NEGw:
+		case t_NEGd: {
+			const uint32_t code[] = { SUBW(FC_RETOP, HOST_zero, HOST_a0) };	// negw FC_RETOP, a0
+			gen_fill_inline_code(pos, code, 1);
+			} break;
+		default:
+			gen_fill_call_address(pos, (uint64_t)fct_ptr);
+			break;
+	}
+#else
+	gen_fill_call_address(pos, (uint64_t)fct_ptr);
+#endif
+}
+#endif
+
+static void cache_block_closing(uint8_t* block_start,Bitu block_size) {
+	//flush cache - GCC/LLVM builtin
+	__builtin___clear_cache((char *)block_start, (char *)(block_start+block_size));
+}
+
+static void cache_block_before_close(void) { }
+
+#ifdef DRC_USE_SEGS_ADDR
+
+// mov 16bit value from Segs[index] into dest_reg using FC_SEGS_ADDR (index modulo 2 must be zero)
+// 16bit moves may destroy the upper 16bit of the destination register
+static void gen_mov_seg16_to_reg(HostReg dest_reg,Bitu index) {
+	cache_addd( LHU(dest_reg, FC_SEGS_ADDR, index) );      // lhu dest_reg, [FC_SEGS_ADDR, #index]
+}
+
+// mov 32bit value from Segs[index] into dest_reg using FC_SEGS_ADDR (index modulo 4 must be zero)
+static void gen_mov_seg32_to_reg(HostReg dest_reg,Bitu index) {
+	cache_addd( LW(dest_reg, FC_SEGS_ADDR, index) );       // lw dest_reg, [FC_SEGS_ADDR, #index]
+}
+
+// add a 32bit value from Segs[index] to a full register using FC_SEGS_ADDR (index modulo 4 must be zero)
+static void gen_add_seg32_to_reg(HostReg reg,Bitu index) {
+	cache_addd( LW(temp1, FC_SEGS_ADDR, index) );      // lw temp1, [FC_SEGS_ADDR, #index]
+	cache_addd( ADDW(reg, reg, temp1) );               // addw reg, reg, temp1
+}
+
+#endif
+
+#ifdef DRC_USE_REGS_ADDR
+
+// mov 16bit value from cpu_regs[index] into dest_reg using FC_REGS_ADDR (index modulo 2 must be zero)
+// 16bit moves may destroy the upper 16bit of the destination register
+static void gen_mov_regval16_to_reg(HostReg dest_reg,Bitu index) {
+	cache_addd( LHU(dest_reg, FC_REGS_ADDR, index) );      // lhu dest_reg, [FC_REGS_ADDR, #index]
+}
+
+// mov 32bit value from cpu_regs[index] into dest_reg using FC_REGS_ADDR (index modulo 4 must be zero)
+static void gen_mov_regval32_to_reg(HostReg dest_reg,Bitu index) {
+	cache_addd( LW(dest_reg, FC_REGS_ADDR, index) );       // lw dest_reg, [FC_REGS_ADDR, #index]
+}
+
+// move a 32bit (dword==true) or 16bit (dword==false) value from cpu_regs[index] into dest_reg using FC_REGS_ADDR (if dword==true index modulo 4 must be zero) (if dword==false index modulo 2 must be zero)
+// 16bit moves may destroy the upper 16bit of the destination register
+static void gen_mov_regword_to_reg(HostReg dest_reg,Bitu index,bool dword) {
+	if (dword) {
+		cache_addd( LW(dest_reg, FC_REGS_ADDR, index) );       // lw dest_reg, [FC_REGS_ADDR, #index]
+	} else {
+		cache_addd( LHU(dest_reg, FC_REGS_ADDR, index) );      // lhu dest_reg, [FC_REGS_ADDR, #index]
+	}
+}
+
+// move an 8bit value from cpu_regs[index]  into dest_reg using FC_REGS_ADDR
+// the upper 24bit of the destination register can be destroyed
+// this function does not use FC_OP1/FC_OP2 as dest_reg as these
+// registers might not be directly byte-accessible on some architectures
+static void gen_mov_regbyte_to_reg_low(HostReg dest_reg,Bitu index) {
+	cache_addd( LBU(dest_reg, FC_REGS_ADDR, index) );      // lbu dest_reg, [FC_REGS_ADDR, #index]
+}
+
+// move an 8bit value from cpu_regs[index]  into dest_reg using FC_REGS_ADDR
+// the upper 24bit of the destination register can be destroyed
+// this function can use FC_OP1/FC_OP2 as dest_reg which are
+// not directly byte-accessible on some architectures
+static void gen_mov_regbyte_to_reg_low_canuseword(HostReg dest_reg,Bitu index) {
+	cache_addd( LBU(dest_reg, FC_REGS_ADDR, index) );      // lbu dest_reg, [FC_REGS_ADDR, #index]
+}
+
+
+// add a 32bit value from cpu_regs[index] to a full register using FC_REGS_ADDR (index modulo 4 must be zero)
+static void gen_add_regval32_to_reg(HostReg reg,Bitu index) {
+	cache_addd( LW(temp2, FC_REGS_ADDR, index) );      // lw temp2, [FC_REGS_ADDR, #index]
+	cache_addd( ADDW(reg, reg, temp2) );               // addw reg, reg, temp2
+}
+
+
+// move 16bit of register into cpu_regs[index] using FC_REGS_ADDR (index modulo 2 must be zero)
+static void gen_mov_regval16_from_reg(HostReg src_reg,Bitu index) {
+	cache_addd( SH(src_reg, FC_REGS_ADDR, index) );      // sh src_reg, [FC_REGS_ADDR, #index]
+}
+
+// move 32bit of register into cpu_regs[index] using FC_REGS_ADDR (index modulo 4 must be zero)
+static void gen_mov_regval32_from_reg(HostReg src_reg,Bitu index) {
+	cache_addd( SW(src_reg, FC_REGS_ADDR, index) );      // sw src_reg, [FC_REGS_ADDR, #index]
+}
+
+// move 32bit (dword==true) or 16bit (dword==false) of a register into cpu_regs[index] using FC_REGS_ADDR (if dword==true index modulo 4 must be zero) (if dword==false index modulo 2 must be zero)
+static void gen_mov_regword_from_reg(HostReg src_reg,Bitu index,bool dword) {
+	if (dword) {
+		cache_addd( SW(src_reg, FC_REGS_ADDR, index) );      // sw src_reg, [FC_REGS_ADDR, #index]
+	} else {
+		cache_addd( SH(src_reg, FC_REGS_ADDR, index) );      // sh src_reg, [FC_REGS_ADDR, #index]
+	}
+}
+
+// move the lowest 8bit of a register into cpu_regs[index] using FC_REGS_ADDR
+static void gen_mov_regbyte_from_reg_low(HostReg src_reg,Bitu index) {
+	cache_addd( SB(src_reg, FC_REGS_ADDR, index) );      // sb src_reg, [FC_REGS_ADDR, #index]
+}
+
+#endif
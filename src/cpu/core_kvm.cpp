@@ -0,0 +1,723 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* KVM core: runs the guest on the host cpu using Linux KVM.
+ *
+ * The emulator stays the owner of the cpu state. It is handed to the vcpu at the start of
+ * every time slice and taken back at its end, so interrupts, callbacks and the debugger keep
+ * working on Segs/cpu_regs like with every other core. Only plain RAM is mapped into the vm;
+ * port I/O and every other memory access (VGA, LFB, ROM, ...) exits back here and goes through
+ * IO_ReadX/IO_WriteX and the page handlers. Code outside of mapped RAM, like the callbacks in
+ * the BIOS ROM, is run on the normal core until it returns into RAM.
+ *
+ * The x87/MMX/SSE state lives in the vcpu while this core is active. It is only copied over
+ * around the instructions the normal core steps over for the vcpu. */
+
+#include "dosbox.h"
+
+#if defined(C_HAVE_LINUX_KVM_X86)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/kvm.h>
+#include <vector>
+
+#include "cpu.h"
+#include "regs.h"
+#include "mem.h"
+#include "paging.h"
+#include "inout.h"
+#include "lazyflags.h"
+#include "callback.h"
+#include "pic.h"
+#include "fpu.h"
+#include "logging.h"
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+#define KVM_MAX_SLOTS		32
+#define KVM_CPUID_ENTRIES	128
+#define KVM_TSS_ADDR		0xfffbd000
+#define KVM_SLICE_MIN_NS	10000		// don't arm the slice timer for less than this
+#define KVM_TIMER_SIGNAL	(SIGRTMIN+4)
+
+extern bool cpu_triple_fault_reset;
+void On_Software_CPU_Reset();
+
+enum KVM_SliceResult {
+	KVM_SLICE_DONE,		// time slice used up or interrupt window open
+	KVM_SLICE_HLT,		// guest executed HLT
+	KVM_SLICE_STEP,		// the vcpu couldn't run the next instruction, let the normal core do it
+	KVM_SLICE_SHUTDOWN,	// triple fault
+	KVM_SLICE_FAIL		// KVM itself failed, give up on it
+};
+
+static struct {
+	int sys_fd,vm_fd,vcpu_fd;
+	struct kvm_run * run;
+	size_t run_size;
+	timer_t timer;
+	bool timer_valid;
+	bool ready;
+	bool complete;			// the last exit was I/O or MMIO and has to be completed by the vcpu
+	/* state as it was last handed to or taken from the vcpu */
+	struct kvm_sregs sregs;
+	Segments segs;
+	Bitu mode,cpl;
+	bool code_big,stack_big;
+	bool synced;
+	/* x87/MMX/SSE state as taken from the vcpu for a normal core step */
+	struct kvm_fpu fpu;
+	uint8_t mmx[8][8];
+	bool fpu_valid;
+	/* guest physical memory map */
+	std::vector<uint8_t> mapped;
+	HostPt low[LINK_START];
+	bool low_paging;
+	unsigned int slots;
+} kvm;
+
+static void KVM_TimerSignal(int) {
+	if (kvm.run) kvm.run->immediate_exit=1;
+}
+
+static void KVM_Close(void) {
+	if (kvm.timer_valid) timer_delete(kvm.timer);
+	if (kvm.run) munmap(kvm.run,kvm.run_size);
+	if (kvm.vcpu_fd>=0) close(kvm.vcpu_fd);
+	if (kvm.vm_fd>=0) close(kvm.vm_fd);
+	if (kvm.sys_fd>=0) close(kvm.sys_fd);
+	kvm.timer_valid=false;
+	kvm.run=NULL;
+	kvm.sys_fd=kvm.vm_fd=kvm.vcpu_fd=-1;
+	kvm.ready=false;
+}
+
+static bool KVM_Fail(const char * what) {
+	LOG_MSG("KVM: %s failed (%s), using the normal core instead",what,strerror(errno));
+	KVM_Close();
+	return false;
+}
+
+bool CPU_Core_KVM_Init(void) {
+	if (kvm.ready) return true;
+	kvm.sys_fd=kvm.vm_fd=kvm.vcpu_fd=-1;
+	kvm.sys_fd=open("/dev/kvm",O_RDWR|O_CLOEXEC);
+	if (kvm.sys_fd<0) return KVM_Fail("opening /dev/kvm");
+	if (ioctl(kvm.sys_fd,KVM_GET_API_VERSION,0)!=KVM_API_VERSION) return KVM_Fail("API version check");
+	if (ioctl(kvm.sys_fd,KVM_CHECK_EXTENSION,KVM_CAP_IMMEDIATE_EXIT)<=0) return KVM_Fail("immediate exit check");
+	kvm.vm_fd=ioctl(kvm.sys_fd,KVM_CREATE_VM,0);
+	if (kvm.vm_fd<0) return KVM_Fail("KVM_CREATE_VM");
+	// needed by Intel hosts to run real mode code
+	if (ioctl(kvm.vm_fd,KVM_SET_TSS_ADDR,KVM_TSS_ADDR)<0) return KVM_Fail("KVM_SET_TSS_ADDR");
+	kvm.vcpu_fd=ioctl(kvm.vm_fd,KVM_CREATE_VCPU,0);
+	if (kvm.vcpu_fd<0) return KVM_Fail("KVM_CREATE_VCPU");
+	int run_size=ioctl(kvm.sys_fd,KVM_GET_VCPU_MMAP_SIZE,0);
+	if (run_size<=0) return KVM_Fail("KVM_GET_VCPU_MMAP_SIZE");
+	kvm.run_size=(size_t)run_size;
+	void * run=mmap(NULL,kvm.run_size,PROT_READ|PROT_WRITE,MAP_SHARED,kvm.vcpu_fd,0);
+	if (run==MAP_FAILED) return KVM_Fail("mapping the vcpu");
+	kvm.run=(struct kvm_run *)run;
+
+	// pass the host cpuid through, minus the local APIC which isn't emulated here
+	struct kvm_cpuid2 * cpuid=(struct kvm_cpuid2 *)calloc(1,sizeof(struct kvm_cpuid2)+KVM_CPUID_ENTRIES*sizeof(struct kvm_cpuid_entry2));
+	if (cpuid==NULL) return KVM_Fail("allocating cpuid");
+	cpuid->nent=KVM_CPUID_ENTRIES;
+	bool cpuid_ok=ioctl(kvm.sys_fd,KVM_GET_SUPPORTED_CPUID,cpuid)==0;
+	if (cpuid_ok) {
+		for (uint32_t i=0;i<cpuid->nent;i++) {
+			if (cpuid->entries[i].function!=1) continue;
+			cpuid->entries[i].edx&=~(1u<<9);
+			cpuid->entries[i].ecx&=~(1u<<21);
+		}
+		cpuid_ok=ioctl(kvm.vcpu_fd,KVM_SET_CPUID2,cpuid)==0;
+	}
+	free(cpuid);
+	if (!cpuid_ok) return KVM_Fail("setting up cpuid");
+
+	// the slice timer kicks the vcpu out of KVM_RUN, directed at this thread only
+	struct sigaction sa;
+	memset(&sa,0,sizeof(sa));
+	sa.sa_handler=KVM_TimerSignal;
+	sigemptyset(&sa.sa_mask);
+	if (sigaction(KVM_TIMER_SIGNAL,&sa,NULL)<0) return KVM_Fail("installing the timer signal");
+	struct sigevent sev;
+	memset(&sev,0,sizeof(sev));
+	sev.sigev_notify=SIGEV_THREAD_ID;
+	sev.sigev_signo=KVM_TIMER_SIGNAL;
+	sev.sigev_notify_thread_id=(pid_t)syscall(SYS_gettid);
+	if (timer_create(CLOCK_MONOTONIC,&sev,&kvm.timer)<0) return KVM_Fail("timer_create");
+	kvm.timer_valid=true;
+
+	kvm.synced=false;
+	kvm.complete=false;
+	kvm.slots=0;
+	kvm.mapped.clear();
+	kvm.ready=true;
+	LOG_MSG("KVM: hardware virtualization enabled");
+	return true;
+}
+
+/* Memory map */
+
+static HostPt KVM_RAMPage(PageNum page) {
+	PageHandler * handler=MEM_GetPageHandler(page);
+	if (handler->getFlags()!=(PFLAG_READABLE|PFLAG_WRITEABLE)) return NULL;
+	HostPt host=handler->GetHostWritePt(page);
+	if (host==NULL || host!=handler->GetHostReadPt(page)) return NULL;
+	if ((uintptr_t)host & (MEM_PAGESIZE-1)) return NULL;
+	return host;
+}
+
+static HostPt KVM_GuestPage(PageNum page) {
+	// without paging the guest physical address is the linear one, which may be remapped by EMS
+	if (page<LINK_START && !paging.enabled) page=paging.firstmb[page];
+	return KVM_RAMPage(page);
+}
+
+static bool KVM_SetSlot(unsigned int slot,PageNum start,PageNum pages,HostPt host) {
+	struct kvm_userspace_memory_region region;
+	memset(&region,0,sizeof(region));
+	region.slot=slot;
+	region.guest_phys_addr=(uint64_t)start*MEM_PAGESIZE;
+	region.memory_size=(uint64_t)pages*MEM_PAGESIZE;
+	region.userspace_addr=(uintptr_t)host;
+	return ioctl(kvm.vm_fd,KVM_SET_USER_MEMORY_REGION,&region)==0;
+}
+
+static void KVM_MapMemory(void) {
+	for (unsigned int i=0;i<kvm.slots;i++) KVM_SetSlot(i,0,0,NULL);
+	kvm.slots=0;
+
+	const PageNum total=(PageNum)MEM_TotalPages();
+	kvm.mapped.assign(total,0);
+	PageNum start=0,pages=0;
+	HostPt host=NULL;
+	for (PageNum page=0;page<=total;page++) {
+		HostPt ptr=(page<total)?KVM_GuestPage(page):NULL;
+		if (page<LINK_START) kvm.low[page]=ptr;
+		if (pages && ptr==host+pages*MEM_PAGESIZE) {
+			pages++;
+			continue;
+		}
+		if (pages && kvm.slots<KVM_MAX_SLOTS && KVM_SetSlot(kvm.slots,start,pages,host)) {
+			kvm.slots++;
+			memset(&kvm.mapped[start],1,pages);
+		}
+		pages=0;
+		if (ptr) {
+			start=page;
+			host=ptr;
+			pages=1;
+		}
+	}
+	kvm.low_paging=paging.enabled;
+}
+
+static bool KVM_MemoryChanged(void) {
+	if (kvm.mapped.size()!=MEM_TotalPages() || kvm.low_paging!=paging.enabled) return true;
+	for (PageNum page=0;page<LINK_START;page++)
+		if (kvm.low[page]!=KVM_GuestPage(page)) return true;
+	return false;
+}
+
+static bool KVM_CodeInRAM(void) {
+	PageNum page=(PageNum)((SegPhys(cs)+reg_eip)>>12);
+	// a page that isn't present is the guest's own page fault to handle
+	if (paging.enabled && !PAGING_MakePhysPage(page)) return true;
+	return page<kvm.mapped.size() && kvm.mapped[page];
+}
+
+/* MMIO, routed through the page handlers. Device handlers translate the address through the
+ * TLB, so the TLB entry of the same page number is borrowed to map it back onto the physical page. */
+static void KVM_MMIO(uint64_t addr,uint8_t * data,uint32_t len,bool write) {
+	while (len) {
+		uint32_t size=1;
+		if (len>=4 && !(addr&3)) size=4;
+		else if (len>=2 && !(addr&1)) size=2;
+		if (addr>=((uint64_t)TLB_SIZE*MEM_PAGESIZE)) {
+			if (!write) memset(data,0xff,size);
+		} else {
+			const PhysPt phys=(PhysPt)addr;
+			const PageNum page=phys>>12;
+			PageHandler * handler=MEM_GetPageHandler(page);
+			const tlbentry_t old_entry=tlb_phys_page(page);
+			tlb_phys_page(page)=(tlbentry_t)page;
+			if (write) {
+				switch (size) {
+					case 4:handler->writed(phys,host_readd(data));break;
+					case 2:handler->writew(phys,host_readw(data));break;
+					default:handler->writeb(phys,host_readb(data));break;
+				}
+			} else {
+				switch (size) {
+					case 4:host_writed(data,handler->readd(phys));break;
+					case 2:host_writew(data,handler->readw(phys));break;
+					default:host_writeb(data,handler->readb(phys));break;
+				}
+			}
+			tlb_phys_page(page)=old_entry;
+		}
+		addr+=size;
+		data+=size;
+		len-=size;
+	}
+}
+
+static void KVM_IO(void) {
+	uint8_t * data=(uint8_t *)kvm.run+kvm.run->io.data_offset;
+	const Bitu port=kvm.run->io.port;
+	for (uint32_t i=0;i<kvm.run->io.count;i++,data+=kvm.run->io.size) {
+		if (kvm.run->io.direction==KVM_EXIT_IO_OUT) {
+			switch (kvm.run->io.size) {
+				case 4:IO_WriteD(port,host_readd(data));break;
+				case 2:IO_WriteW(port,host_readw(data));break;
+				default:IO_WriteB(port,host_readb(data));break;
+			}
+		} else {
+			switch (kvm.run->io.size) {
+				case 4:host_writed(data,IO_ReadD(port));break;
+				case 2:host_writew(data,IO_ReadW(port));break;
+				default:host_writeb(data,IO_ReadB(port));break;
+			}
+		}
+	}
+}
+
+/* State exchange */
+
+static Bitu KVM_Mode(void) {
+	if (!cpu.pmode) return 0;
+	return (reg_flags & FLAG_VM)?2:1;
+}
+
+static void KVM_PutSegment(struct kvm_segment & kseg,SegNames seg) {
+	memset(&kseg,0,sizeof(kseg));
+	kseg.selector=(uint16_t)SegValue(seg);
+	kseg.base=SegPhys(seg);
+	kseg.limit=SegLimit(seg);
+	kseg.type=(seg==cs)?0xb:0x3;
+	kseg.s=1;
+	kseg.present=1;
+	if (seg==cs) kseg.db=cpu.code.big;
+	else if (seg==ss) kseg.db=cpu.stack.big;
+	if (reg_flags & FLAG_VM) {
+		kseg.dpl=3;
+		kseg.limit=0xffff;
+		kseg.db=0;
+	} else if (cpu.pmode) {
+		Descriptor desc;
+		if ((kseg.selector & 0xfffc)==0 && seg!=cs && seg!=ss) {
+			kseg.unusable=1;
+			kseg.present=0;
+		} else if (cpu.gdt.GetDescriptor(kseg.selector,desc) && desc.GetBase()==SegPhys(seg) && (desc.Type() & 0x10)) {
+			// the segment cache isn't kept around, so use the descriptor if it still matches
+			kseg.type=(uint8_t)((desc.Type() & 0xf) | 1);
+			kseg.dpl=(uint8_t)desc.DPL();
+			kseg.avl=desc.saved.seg.avl;
+			if (seg!=cs && seg!=ss) kseg.db=(uint8_t)desc.Big();
+			if (kseg.limit==0xffffffff && desc.GetExpandDown()) kseg.limit=(uint32_t)desc.GetLimit();
+		} else {
+			kseg.dpl=(uint8_t)cpu.cpl;
+		}
+		if (seg==ss) kseg.dpl=(uint8_t)cpu.cpl;
+	}
+	kseg.g=kseg.limit>0xfffff;
+	if (kseg.g) kseg.limit|=0xfff;
+}
+
+static void KVM_GetSegment(const struct kvm_segment & kseg,SegNames seg) {
+	Segs.val[seg]=kseg.selector;
+	Segs.phys[seg]=(PhysPt)kseg.base;
+	Segs.limit[seg]=do_seg_limits?kseg.limit:((PhysPt)(~0UL));
+	Segs.expanddown[seg]=kseg.s && !(kseg.type & 8) && (kseg.type & 4);
+}
+
+static bool KVM_PutState(void) {
+	FillFlags();
+	struct kvm_regs regs;
+	memset(&regs,0,sizeof(regs));
+	regs.rax=reg_eax;regs.rbx=reg_ebx;regs.rcx=reg_ecx;regs.rdx=reg_edx;
+	regs.rsi=reg_esi;regs.rdi=reg_edi;regs.rsp=reg_esp;regs.rbp=reg_ebp;
+	regs.rip=reg_eip;
+	regs.rflags=reg_flags|2;
+	if (ioctl(kvm.vcpu_fd,KVM_SET_REGS,&regs)<0) return false;
+
+	struct kvm_sregs & sregs=kvm.sregs;
+	if (!kvm.synced && ioctl(kvm.vcpu_fd,KVM_GET_SREGS,&sregs)<0) return false;
+	const Bitu mode=KVM_Mode();
+	const bool all=!kvm.synced || mode!=kvm.mode || cpu.cpl!=kvm.cpl ||
+		cpu.code.big!=kvm.code_big || cpu.stack.big!=kvm.stack_big;
+	struct kvm_segment * ksegs[6]={&sregs.es,&sregs.cs,&sregs.ss,&sregs.ds,&sregs.fs,&sregs.gs};
+	for (Bitu i=0;i<6;i++) {
+		if (all || Segs.val[i]!=kvm.segs.val[i] || Segs.phys[i]!=kvm.segs.phys[i] || Segs.limit[i]!=kvm.segs.limit[i])
+			KVM_PutSegment(*ksegs[i],(SegNames)i);
+	}
+
+	sregs.cr0=cpu.cr0;
+	sregs.cr2=paging.cr2;
+	sregs.cr3=paging.cr3;
+	sregs.cr4=cpu.cr4;
+	sregs.gdt.base=cpu.gdt.GetBase();
+	sregs.gdt.limit=(uint16_t)cpu.gdt.GetLimit();
+	sregs.idt.base=cpu.idt.GetBase();
+	sregs.idt.limit=(uint16_t)cpu.idt.GetLimit();
+
+	memset(&sregs.ldt,0,sizeof(sregs.ldt));
+	sregs.ldt.selector=(uint16_t)cpu.gdt.SLDT();
+	if (sregs.ldt.selector & 0xfffc) {
+		sregs.ldt.base=cpu.gdt.GetLDTBase();
+		sregs.ldt.limit=(uint32_t)cpu.gdt.GetLDTLimit();
+		sregs.ldt.type=2;
+		sregs.ldt.present=1;
+		sregs.ldt.g=sregs.ldt.limit>0xfffff;
+	} else {
+		sregs.ldt.unusable=1;
+	}
+
+	Bitu tr_sel,tr_limit;
+	PhysPt tr_base;
+	bool tr_386;
+	CPU_STR_Get(tr_sel,tr_base,tr_limit,tr_386);
+	memset(&sregs.tr,0,sizeof(sregs.tr));
+	sregs.tr.selector=(uint16_t)tr_sel;
+	sregs.tr.base=tr_base;
+	sregs.tr.limit=(tr_sel & 0xfffc)?(uint32_t)tr_limit:0xffff;
+	sregs.tr.type=tr_386?11:3;		// busy TSS, an unloaded task register still has to have a valid type
+	sregs.tr.present=1;
+	sregs.tr.g=sregs.tr.limit>0xfffff;
+
+	memset(sregs.interrupt_bitmap,0,sizeof(sregs.interrupt_bitmap));
+	if (ioctl(kvm.vcpu_fd,KVM_SET_SREGS,&sregs)<0) return false;
+	kvm.synced=true;
+	return true;
+}
+
+static bool KVM_GetState(void) {
+	struct kvm_regs regs;
+	if (ioctl(kvm.vcpu_fd,KVM_GET_REGS,&regs)<0) return false;
+	reg_eax=(uint32_t)regs.rax;reg_ebx=(uint32_t)regs.rbx;reg_ecx=(uint32_t)regs.rcx;reg_edx=(uint32_t)regs.rdx;
+	reg_esi=(uint32_t)regs.rsi;reg_edi=(uint32_t)regs.rdi;reg_esp=(uint32_t)regs.rsp;reg_ebp=(uint32_t)regs.rbp;
+	reg_eip=(uint32_t)regs.rip;
+	reg_flags=(uint32_t)regs.rflags;
+	cpu.direction=1 - (int)((reg_flags & FLAG_DF) >> 9U);
+
+	struct kvm_sregs & sregs=kvm.sregs;
+	if (ioctl(kvm.vcpu_fd,KVM_GET_SREGS,&sregs)<0) return false;
+	KVM_GetSegment(sregs.es,es);
+	KVM_GetSegment(sregs.cs,cs);
+	KVM_GetSegment(sregs.ss,ss);
+	KVM_GetSegment(sregs.ds,ds);
+	KVM_GetSegment(sregs.fs,fs);
+	KVM_GetSegment(sregs.gs,gs);
+	cpu.code.big=sregs.cs.db!=0;
+	cpu.stack.big=sregs.ss.db!=0;
+	cpu.stack.mask=cpu.stack.big?0xffffffffu:0xffffu;
+	cpu.stack.notmask=~cpu.stack.mask;
+
+	CPU_SET_CRX(0,(Bitu)sregs.cr0);
+	if (sregs.cr3!=paging.cr3) CPU_SET_CRX(3,(Bitu)sregs.cr3);
+	if (sregs.cr4!=cpu.cr4) CPU_SET_CRX(4,(Bitu)sregs.cr4);
+	paging.cr2=(uint32_t)sregs.cr2;
+	cpu.gdt.SetBase((LinearPt)sregs.gdt.base);
+	cpu.gdt.SetLimit(sregs.gdt.limit);
+	cpu.idt.SetBase((LinearPt)sregs.idt.base);
+	cpu.idt.SetLimit(sregs.idt.limit);
+	if (sregs.ldt.unusable || !(sregs.ldt.selector & 0xfffc)) cpu.gdt.SetLDT(0,0,0);
+	else cpu.gdt.SetLDT(sregs.ldt.selector,(LinearPt)sregs.ldt.base,sregs.ldt.limit);
+	// guest writes to the GDT and LDT never went through our TLB
+	CPU_DescriptorCacheFlush();
+	CPU_STR_Set(sregs.tr.selector,(PhysPt)sregs.tr.base,sregs.tr.limit,(sregs.tr.type & 8)!=0);
+	CPU_SetCPL(!cpu.pmode?0:((reg_flags & FLAG_VM)?3:sregs.ss.dpl));
+	// the guest may have changed its page tables behind our back
+	if (paging.enabled) PAGING_ClearTLB();
+
+	kvm.segs=Segs;
+	kvm.mode=KVM_Mode();
+	kvm.cpl=cpu.cpl;
+	kvm.code_big=cpu.code.big;
+	kvm.stack_big=cpu.stack.big;
+	return true;
+}
+
+/* Time slices */
+
+static int64_t KVM_CyclesToNs(cpu_cycles_count_t cycles) {
+	return (int64_t)((double)cycles*1000000.0/(double)CPU_CycleMax);
+}
+
+static cpu_cycles_count_t KVM_NsToCycles(int64_t ns) {
+	return (cpu_cycles_count_t)((double)ns*(double)CPU_CycleMax/1000000.0);
+}
+
+static int64_t KVM_Now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return (int64_t)ts.tv_sec*1000000000ll+ts.tv_nsec;
+}
+
+static void KVM_ArmTimer(int64_t ns) {
+	struct itimerspec its;
+	memset(&its,0,sizeof(its));
+	if (ns>0) {
+		if (ns<KVM_SLICE_MIN_NS) ns=KVM_SLICE_MIN_NS;
+		its.it_value.tv_sec=(time_t)(ns/1000000000ll);
+		its.it_value.tv_nsec=(long)(ns%1000000000ll);
+	}
+	timer_settime(kvm.timer,0,&its,NULL);
+}
+
+/* finish a pending I/O or MMIO exit without running any further guest code */
+static void KVM_Complete(void) {
+	kvm.run->immediate_exit=1;
+	while (kvm.complete) {
+		kvm.complete=false;
+		if (ioctl(kvm.vcpu_fd,KVM_RUN,0)<0) break;
+		if (kvm.run->exit_reason==KVM_EXIT_IO) {
+			kvm.complete=true;
+			KVM_IO();
+		} else if (kvm.run->exit_reason==KVM_EXIT_MMIO) {
+			kvm.complete=true;
+			KVM_MMIO(kvm.run->mmio.phys_addr,kvm.run->mmio.data,kvm.run->mmio.len,kvm.run->mmio.is_write!=0);
+		}
+	}
+	kvm.run->immediate_exit=0;
+}
+
+static KVM_SliceResult KVM_RunSlice(void) {
+	if (KVM_MemoryChanged()) KVM_MapMemory();
+	// an exception thrown from a device handler can leave the last exit pending
+	if (kvm.complete) KVM_Complete();
+	if (!KVM_PutState()) return KVM_SLICE_FAIL;
+
+	KVM_SliceResult result=KVM_SLICE_DONE;
+	const int64_t start=KVM_Now();
+	cpu_cycles_count_t armed=CPU_Cycles,used=0;
+	kvm.run->immediate_exit=0;
+	KVM_ArmTimer(KVM_CyclesToNs(armed));
+	for (;;) {
+		// leave as soon as the guest can take the interrupt, the PIC delivers it
+		kvm.run->request_interrupt_window=PIC_IRQCheck?1:0;
+		const int r=ioctl(kvm.vcpu_fd,KVM_RUN,0);
+		kvm.complete=false;
+		if (r<0) {
+			if (errno==EINTR || errno==EAGAIN) {
+				if (kvm.run->immediate_exit) break;
+				continue;
+			}
+			LOG_MSG("KVM: KVM_RUN failed (%s), using the normal core instead",strerror(errno));
+			result=KVM_SLICE_FAIL;
+			break;
+		}
+		bool stop=false;
+		switch (kvm.run->exit_reason) {
+			case KVM_EXIT_IO:
+				kvm.complete=true;
+				KVM_IO();
+				break;
+			case KVM_EXIT_MMIO:
+				kvm.complete=true;
+				KVM_MMIO(kvm.run->mmio.phys_addr,kvm.run->mmio.data,kvm.run->mmio.len,kvm.run->mmio.is_write!=0);
+				break;
+			case KVM_EXIT_IRQ_WINDOW_OPEN:
+				stop=true;
+				break;
+			case KVM_EXIT_HLT:
+				result=KVM_SLICE_HLT;
+				stop=true;
+				break;
+			case KVM_EXIT_SHUTDOWN:
+				result=KVM_SLICE_SHUTDOWN;
+				stop=true;
+				break;
+			case KVM_EXIT_INTR:
+				break;
+			default:
+				// mostly KVM_EXIT_INTERNAL_ERROR: code fetched from outside of RAM or an instruction KVM can't emulate
+				result=KVM_SLICE_STEP;
+				stop=true;
+				break;
+		}
+		if (stop) break;
+		used=KVM_NsToCycles(KVM_Now()-start);
+		if (used>=CPU_Cycles) break;
+		// device handlers may have scheduled an event and shortened the slice
+		if (CPU_Cycles!=armed) {
+			armed=CPU_Cycles;
+			KVM_ArmTimer(KVM_CyclesToNs(armed-used));
+		}
+	}
+	KVM_ArmTimer(0);
+	if (kvm.complete) KVM_Complete();
+	used=KVM_NsToCycles(KVM_Now()-start);
+	CPU_Cycles=(used>=CPU_Cycles)?0:(CPU_Cycles-used);
+	if (!KVM_GetState()) return KVM_SLICE_FAIL;
+	return result;
+}
+
+/* let the normal core run a single instruction */
+#if C_FPU && (C_FPU_X86 || defined(HAS_LONG_DOUBLE))
+/* fpr[] is in st(i) order like FXSAVE, ftwx is the abridged tag word in register order.
+ * DOSBox keeps the MMX registers apart from the x87 ones, so MMX registers the step changed
+ * are handed back the way the hardware stores them: mantissa, exponent all ones. */
+static void KVM_GetFPU(void) {
+	kvm.fpu_valid=ioctl(kvm.vcpu_fd,KVM_GET_FPU,&kvm.fpu)>=0;
+	if (!kvm.fpu_valid) return;
+	fpu.cw=kvm.fpu.fcw;
+	fpu.sw=kvm.fpu.fsw;
+	fpu.mxcsr=kvm.fpu.mxcsr;
+	for (Bitu i=0;i<8;i++) {
+		const uint8_t * st=kvm.fpu.fpr[i];
+		Bitu r=STV(i);
+#if C_FPU_X86
+		memcpy(&fpu.p_regs[r].m1,st+0,4);
+		memcpy(&fpu.p_regs[r].m2,st+4,4);
+		memcpy(&fpu.p_regs[r].m3,st+8,2);
+#else
+		memcpy(&fpu.regs_80[r].raw.l,st+0,8);
+		memcpy(&fpu.regs_80[r].raw.h,st+8,2);
+#endif
+		memcpy(reg_mmx[r]->uba,st,8);
+		memcpy(kvm.mmx[r],st,8);
+		fpu.tags[r]=(kvm.fpu.ftwx & (1u<<r)) ? TAG_Valid : TAG_Empty;
+	}
+	if (CPU_SSE()) {
+		for (Bitu i=0;i<8;i++) memcpy(fpu.xmmreg[i].u32,kvm.fpu.xmm[i],16);
+	}
+}
+
+static void KVM_PutFPU(void) {
+	if (!kvm.fpu_valid) return;
+	kvm.fpu_valid=false;
+	kvm.fpu.fcw=(uint16_t)fpu.cw;
+	kvm.fpu.fsw=(uint16_t)fpu.sw;
+	kvm.fpu.mxcsr=fpu.mxcsr;
+	kvm.fpu.ftwx=0;
+	for (Bitu i=0;i<8;i++) {
+		uint8_t * st=kvm.fpu.fpr[i];
+		Bitu r=STV(i);
+		if (memcmp(reg_mmx[r]->uba,kvm.mmx[r],8)) {
+			memcpy(st,reg_mmx[r]->uba,8);
+			st[8]=st[9]=0xff;
+			fpu.tags[r]=TAG_Valid;
+		} else {
+#if C_FPU_X86
+			memcpy(st+0,&fpu.p_regs[r].m1,4);
+			memcpy(st+4,&fpu.p_regs[r].m2,4);
+			memcpy(st+8,&fpu.p_regs[r].m3,2);
+#else
+			memcpy(st+0,&fpu.regs_80[r].raw.l,8);
+			memcpy(st+8,&fpu.regs_80[r].raw.h,2);
+#endif
+		}
+		if (fpu.tags[r]!=TAG_Empty) kvm.fpu.ftwx|=(uint8_t)(1u<<r);
+	}
+	if (CPU_SSE()) {
+		for (Bitu i=0;i<8;i++) memcpy(kvm.fpu.xmm[i],fpu.xmmreg[i].u32,16);
+	}
+	if (ioctl(kvm.vcpu_fd,KVM_SET_FPU,&kvm.fpu)<0) LOG_MSG("KVM: KVM_SET_FPU failed (%s)",strerror(errno));
+}
+#else
+static void KVM_GetFPU(void) {}
+static void KVM_PutFPU(void) {}
+#endif
+
+static Bits KVM_NormalStep(void) {
+	cpu_cycles_count_t old_cycles=CPU_Cycles;
+	CPU_Cycles=1;
+	CPU_CycleLeft+=old_cycles;
+	KVM_GetFPU();
+	Bits ret=CPU_Core_Normal_Run();
+	KVM_PutFPU();
+	if (cpudecoder==&CPU_Core_Normal_Trap_Run) cpudecoder=&CPU_Core_KVM_Trap_Run;
+	if (!ret) {
+		CPU_Cycles=old_cycles-1;
+		CPU_CycleLeft-=old_cycles;
+	}
+	return ret;
+}
+
+Bits CPU_Core_KVM_Run(void) {
+	if (GCC_UNLIKELY(!kvm.ready)) {
+		cpudecoder=&CPU_Core_Normal_Run;
+		return CPU_Core_Normal_Run();
+	}
+	if (KVM_MemoryChanged()) KVM_MapMemory();
+	while (CPU_Cycles>0) {
+		if (!KVM_CodeInRAM()) {
+			Bits ret=KVM_NormalStep();
+			if (ret || cpudecoder!=&CPU_Core_KVM_Run) return ret;
+			continue;
+		}
+		switch (KVM_RunSlice()) {
+			case KVM_SLICE_DONE:
+				return CBRET_NONE;
+			case KVM_SLICE_HLT:
+				CPU_HLT(reg_eip);
+				return CBRET_NONE;
+			case KVM_SLICE_STEP: {
+				Bits ret=KVM_NormalStep();
+				if (ret || cpudecoder!=&CPU_Core_KVM_Run) return ret;
+				break;
+			}
+			case KVM_SLICE_SHUTDOWN:
+				kvm.synced=false;
+				if (!cpu_triple_fault_reset) E_Exit("KVM: Triple fault");
+				LOG_MSG("KVM: Triple fault. Resetting CPU.");
+				On_Software_CPU_Reset();
+				return CBRET_NONE;
+			case KVM_SLICE_FAIL:
+				KVM_GetFPU();
+				KVM_Close();
+				cpudecoder=&CPU_Core_Normal_Run;
+				return CBRET_NONE;
+		}
+	}
+	return CBRET_NONE;
+}
+
+Bits CPU_Core_KVM_Trap_Run(void) {
+	Bits oldCycles = CPU_Cycles;
+	CPU_Cycles = 1;
+	cpu.trap_skip = false;
+
+	// let the normal core execute the next (only one!) instruction
+	Bits ret=CPU_Core_Normal_Run();
+
+	// trap to int1 unless the last instruction deferred this
+	// (allows hardware interrupts to be served without interaction)
+	if (!cpu.trap_skip) CPU_DebugException(DBINT_STEP,reg_eip);
+
+	CPU_Cycles = oldCycles-1;
+	// continue (either the trapflag was clear anyways, or the int1 cleared it)
+	cpudecoder = &CPU_Core_KVM_Run;
+
+	return ret;
+}
+
+#endif // C_HAVE_LINUX_KVM_X86
@@ -65,6 +65,12 @@ Bitu cycle_count;
 
 #define CPU_TRAP_DECODER	CPU_Core_Normal_Trap_Run
 
+/* Threaded dispatch through a table of handler labels, needs the GNU
+ * labels-as-values extension (see CASE_THREAD in core_normal/helpers.h) */
+#if defined(__GNUC__)
+#define CORE_NORMAL_THREADED
+#endif
+
 #define OPCODE_NONE			0x000u
 #define OPCODE_0F			0x100u
 #define OPCODE_SIZE			0x200u
@@ -157,10 +163,21 @@ static INLINE uint32_t Fetchd() {
 
 #define EALookupTable (core.ea_table)
 
+#if defined(CORE_NORMAL_THREADED)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
 Bits CPU_Core_Normal_Run(void) {
 	if (CPU_Cycles <= 0)
 		return CBRET_NONE;
 
+#if defined(CORE_NORMAL_THREADED)
+	static void * dispatch_table[(OPCODE_0F|OPCODE_SIZE)+0x100u]={};
+	Bitu dispatch_index;
+	bool dispatch_learn=false;
+#endif
+
 	while (CPU_Cycles-->0) {
 		LOADIP;
 		last_prefix=MP_NONE;
@@ -178,16 +195,30 @@ Bits CPU_Core_Normal_Run(void) {
 			return (Bits)debugCallback;
 		}
 #endif
+		if (GCC_UNLIKELY(debug_exec_breakpoints) && DEBUG_ExecBreakpointHit(core.cseip)) {
+			FillFlags();
+			return (Bits)debugCallback;
+		}
 #endif
 		cycle_count++;
 restart_opcode:
+#if defined(CORE_NORMAL_THREADED)
+		dispatch_index=core.opcode_index+Fetchb();
+		if (GCC_LIKELY(dispatch_table[dispatch_index]!=NULL)) goto *dispatch_table[dispatch_index];
+		dispatch_learn=true;
+		switch (dispatch_index) {
+#else
 		switch (core.opcode_index+Fetchb()) {
+#endif
 		#include "core_normal/prefix_none.h"
 		#include "core_normal/prefix_0f.h"
 		#include "core_normal/prefix_66.h"
 		#include "core_normal/prefix_66_0f.h"
 		default:
 		illegal_opcode:
+#if defined(CORE_NORMAL_THREADED)
+			dispatch_learn=false;
+#endif
 #if C_DEBUG	
 			{
 				bool ignore=false;
@@ -222,6 +253,10 @@ decode_end:
 	return CBRET_NONE;
 }
 
+#if defined(CORE_NORMAL_THREADED)
+#pragma GCC diagnostic pop
+#endif
+
 Bits CPU_Core_Normal_Trap_Run(void) {
 	Bits oldCycles = CPU_Cycles;
 	CPU_Cycles = 1;
@@ -174,33 +174,59 @@
 	}																		\
 }
 
+/* With CORE_NORMAL_THREADED every opcode handler gets a label of its own.
+ * The first time an opcode index is decoded through the switch the label
+ * is stored in the dispatch table, later fetches jump to it directly. */
+#if defined(CORE_NORMAL_THREADED)
+# define CASE_THREAD_LABEL(_N)					\
+	if (GCC_UNLIKELY(dispatch_learn)) {			\
+		dispatch_table[dispatch_index]=__extension__ &&core_op_ ## _N;	\
+		dispatch_learn=false;					\
+	}											\
+	core_op_ ## _N:
+# define CASE_THREAD_LABEL_N(_N)	CASE_THREAD_LABEL(_N)
+# define CASE_THREAD			CASE_THREAD_LABEL_N(__COUNTER__)
+#else
+# define CASE_THREAD
+#endif
+
+#if CPU_CORE >= CPU_ARCHTYPE_386
+# define CASE_D_RAW(_WHICH)						\
+	case (OPCODE_SIZE+_WHICH):
+# define CASE_0F_D_RAW(_WHICH)					\
+	case ((OPCODE_0F|OPCODE_SIZE)+_WHICH):
+#else
+# define CASE_D_RAW(_WHICH)
+# define CASE_0F_D_RAW(_WHICH)
+#endif
+
 #define CASE_W(_WHICH)							\
-	case (OPCODE_NONE+_WHICH):
+	case (OPCODE_NONE+_WHICH): CASE_THREAD
 
 #if CPU_CORE >= CPU_ARCHTYPE_386
 # define CASE_D(_WHICH)							\
-	case (OPCODE_SIZE+_WHICH):
+	CASE_D_RAW(_WHICH) CASE_THREAD
 #else
 # define CASE_D(_WHICH)
 #endif
 
 #define CASE_B(_WHICH)							\
-	CASE_W(_WHICH)								\
-	CASE_D(_WHICH)
+	case (OPCODE_NONE+_WHICH):					\
+	CASE_D_RAW(_WHICH) CASE_THREAD
 
 #define CASE_0F_W(_WHICH)						\
-	case ((OPCODE_0F|OPCODE_NONE)+_WHICH):
+	case ((OPCODE_0F|OPCODE_NONE)+_WHICH): CASE_THREAD
 
 #if CPU_CORE >= CPU_ARCHTYPE_386
 # define CASE_0F_D(_WHICH)						\
-	case ((OPCODE_0F|OPCODE_SIZE)+_WHICH):
+	CASE_0F_D_RAW(_WHICH) CASE_THREAD
 #else
 # define CASE_0F_D(_WHICH)
 #endif
 
 #define CASE_0F_B(_WHICH)						\
-	CASE_0F_W(_WHICH)							\
-	CASE_0F_D(_WHICH)
+	case ((OPCODE_0F|OPCODE_NONE)+_WHICH):		\
+	CASE_0F_D_RAW(_WHICH) CASE_THREAD
 
 #define FixEA16 do {							\
 		switch (rm & 7) {						\
@@ -1066,6 +1066,11 @@
 			}
 #endif
 			CPU_SW_Interrupt(num,GETIP);
+			{
+				/* vector still points at our own stub: run the callback without decoding it */
+				const Bitu cb = CALLBACK_DirectDispatch();
+				if (cb != 0) return (Bits)cb;
+			}
 #if CPU_TRAP_CHECK
 			cpu.trap_skip=true;
 #endif
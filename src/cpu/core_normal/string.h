@@ -35,6 +35,30 @@ enum STRING_OP_NORMAL {
 
 extern int cpu_rep_max;
 
+/* Elements a REP MOVS/STOS/LODS may hand to the PAGING_String* bulk helpers: no more than the
+ * element loop would do before running out of cycles, and none the segment limit checks below
+ * would fault on, so the fault is still raised by the element loop at the right element. */
+static Bitu DoStringBulkCount(Bitu count,SegNames seg,uint32_t index,Bits step) {
+	if ((Bits)count > (Bits)CPU_Cycles) count = (CPU_Cycles > 0) ? (Bitu)CPU_Cycles : 1u;
+	if (!do_seg_limits) return count;
+
+	const Bitu size = (Bitu)(step < 0 ? -step : step);
+	const uint64_t limit = (uint64_t)SegLimit(seg);
+	uint64_t n;
+	if (Segs.expanddown[seg]) {
+		if (index <= limit) return 0;
+		if (step > 0) return count;
+		n = (index - limit - 1u) / size + 1u;
+	}
+	else {
+		if (limit == EANoSegmentLimitMagic) return count;
+		if ((uint64_t)index + size - 1u > limit) return 0;
+		if (step < 0) return count;
+		n = (limit + 1u - index) / size;
+	}
+	return (n < (uint64_t)count) ? (Bitu)n : count;
+}
+
 void DoString(STRING_OP_NORMAL type) {
 	static PhysPt  si_base,di_base;
 	static uint32_t	si_index,di_index;
@@ -162,6 +186,16 @@ void DoString(STRING_OP_NORMAL type) {
 							break_flag = false;
 						}
 						do {
+							if (TEST_PREFIX_REP) {
+								const Bitu n=PAGING_StringStore(di_base,di_index,add_mask,add_index,
+									DoStringBulkCount(count,es,di_index,add_index),reg_al);
+								if (n != 0) {
+									count-=n;
+									if ((CPU_Cycles-=(Bits)n) <= 0 && break_flag) break;
+									continue;
+								}
+							}
+
 							if (do_seg_limits) {
 								if (Segs.expanddown[es]) {
 									if (di_index <= SegLimit(es)) {
@@ -192,6 +226,16 @@ void DoString(STRING_OP_NORMAL type) {
 				case R_STOSW:
 					add_index<<=1;
 					do {
+						if (TEST_PREFIX_REP) {
+							const Bitu n=PAGING_StringStore(di_base,di_index,add_mask,add_index,
+								DoStringBulkCount(count,es,di_index,add_index),reg_ax);
+							if (n != 0) {
+								count-=n;
+								if ((CPU_Cycles-=(Bits)n) <= 0) break;
+								continue;
+							}
+						}
+
 						if (do_seg_limits) {
 							if (Segs.expanddown[es]) {
 								if (di_index <= SegLimit(es)) {
@@ -221,6 +265,16 @@ void DoString(STRING_OP_NORMAL type) {
 				case R_STOSD:
 					add_index<<=2;
 					do {
+						if (TEST_PREFIX_REP) {
+							const Bitu n=PAGING_StringStore(di_base,di_index,add_mask,add_index,
+								DoStringBulkCount(count,es,di_index,add_index),reg_eax);
+							if (n != 0) {
+								count-=n;
+								if ((CPU_Cycles-=(Bits)n) <= 0) break;
+								continue;
+							}
+						}
+
 						if (do_seg_limits) {
 							if (Segs.expanddown[es]) {
 								if (di_index <= SegLimit(es)) {
@@ -250,6 +304,16 @@ void DoString(STRING_OP_NORMAL type) {
 
 				case R_MOVSB:
 					do {
+						if (TEST_PREFIX_REP) {
+							const Bitu n=PAGING_StringMove(si_base,si_index,di_base,di_index,add_mask,add_index,
+								DoStringBulkCount(DoStringBulkCount(count,core.base_val_ds,si_index,add_index),es,di_index,add_index));
+							if (n != 0) {
+								count-=n;
+								if ((CPU_Cycles-=(Bits)n) <= 0) break;
+								continue;
+							}
+						}
+
 						if (do_seg_limits) {
 							if (Segs.expanddown[core.base_val_ds]) {
 								if (si_index <= SegLimit(core.base_val_ds)) {
@@ -298,6 +362,16 @@ void DoString(STRING_OP_NORMAL type) {
 				case R_MOVSW:
 					add_index<<=1;
 					do {
+						if (TEST_PREFIX_REP) {
+							const Bitu n=PAGING_StringMove(si_base,si_index,di_base,di_index,add_mask,add_index,
+								DoStringBulkCount(DoStringBulkCount(count,core.base_val_ds,si_index,add_index),es,di_index,add_index));
+							if (n != 0) {
+								count-=n;
+								if ((CPU_Cycles-=(Bits)n) <= 0) break;
+								continue;
+							}
+						}
+
 						if (do_seg_limits) {
 							if (Segs.expanddown[core.base_val_ds]) {
 								if (si_index <= SegLimit(core.base_val_ds)) {
@@ -346,6 +420,16 @@ void DoString(STRING_OP_NORMAL type) {
 				case R_MOVSD:
 					add_index<<=2;
 					do {
+						if (TEST_PREFIX_REP) {
+							const Bitu n=PAGING_StringMove(si_base,si_index,di_base,di_index,add_mask,add_index,
+								DoStringBulkCount(DoStringBulkCount(count,core.base_val_ds,si_index,add_index),es,di_index,add_index));
+							if (n != 0) {
+								count-=n;
+								if ((CPU_Cycles-=(Bits)n) <= 0) break;
+								continue;
+							}
+						}
+
 						/* NTS: Some demoscene productions use VESA BIOS modes in bank switched mode, and then write
 						 *      to it like a linear framebuffer through a segment with a limit the size of the bank
 						 *      switching window. In a way it's similar to the page fault based way Windows 95 treats
@@ -407,6 +491,18 @@ void DoString(STRING_OP_NORMAL type) {
 
 				case R_LODSB:
 					do {
+						if (TEST_PREFIX_REP) {
+							uint32_t val;
+							const Bitu n=PAGING_StringLoad(si_base,si_index,add_mask,add_index,
+								DoStringBulkCount(count,core.base_val_ds,si_index,add_index),val);
+							if (n != 0) {
+								reg_al=(uint8_t)val;
+								count-=n;
+								if ((CPU_Cycles-=(Bits)n) <= 0) break;
+								continue;
+							}
+						}
+
 						reg_al=LoadMb(si_base+si_index);
 						si_index=(si_index+(Bitu)add_index) & add_mask;
 						count--;
@@ -416,6 +512,18 @@ void DoString(STRING_OP_NORMAL type) {
 				case R_LODSW:
 					add_index<<=1;
 					do {
+						if (TEST_PREFIX_REP) {
+							uint32_t val;
+							const Bitu n=PAGING_StringLoad(si_base,si_index,add_mask,add_index,
+								DoStringBulkCount(count,core.base_val_ds,si_index,add_index),val);
+							if (n != 0) {
+								reg_ax=(uint16_t)val;
+								count-=n;
+								if ((CPU_Cycles-=(Bits)n) <= 0) break;
+								continue;
+							}
+						}
+
 						reg_ax=LoadMw(si_base+si_index);
 						si_index=(si_index+(Bitu)add_index) & add_mask;
 						count--;
@@ -425,6 +533,18 @@ void DoString(STRING_OP_NORMAL type) {
 				case R_LODSD:
 					add_index<<=2;
 					do {
+						if (TEST_PREFIX_REP) {
+							uint32_t val;
+							const Bitu n=PAGING_StringLoad(si_base,si_index,add_mask,add_index,
+								DoStringBulkCount(count,core.base_val_ds,si_index,add_index),val);
+							if (n != 0) {
+								reg_eax=val;
+								count-=n;
+								if ((CPU_Cycles-=(Bits)n) <= 0) break;
+								continue;
+							}
+						}
+
 						reg_eax=LoadMd(si_base+si_index);
 						si_index=(si_index+(Bitu)add_index) & add_mask;
 						count--;
@@ -120,7 +120,7 @@ static struct {
 //#define PREFETCH_DEBUG
 
 #define MAX_PQ_SIZE 32
-static uint8_t prefetch_buffer[MAX_PQ_SIZE];
+static uint8_t prefetch_buffer[MAX_PQ_SIZE*2]; /* ring buffer plus mirror, see core_prefetch_buf.h */
 static bool pq_valid=false;
 static Bitu pq_start;
 static Bitu pq_fill;
@@ -18,19 +18,26 @@ template <class T> static inline void prefetch_read_check(const Bitu w) {
 #endif
 }
 
+/* The queue is a ring buffer indexed by the low bits of the address, so advancing pq_start never
+ * moves any bytes. Every dword is stored twice, MAX_PQ_SIZE bytes apart, so that a word or dword
+ * read at the end of the ring is still contiguous. Requires pq_limit + 4 <= MAX_PQ_SIZE. */
+static inline uint8_t *prefetch_ptr(const Bitu w) {
+    return &prefetch_buffer[w & (MAX_PQ_SIZE - 1ul)];
+}
+
 template <> uint8_t prefetch_read<uint8_t>(const Bitu w) {
     prefetch_read_check<uint8_t>(w);
-    return prefetch_buffer[w - pq_start];
+    return *prefetch_ptr(w);
 }
 
 template <> uint16_t prefetch_read<uint16_t>(const Bitu w) {
     prefetch_read_check<uint16_t>(w);
-    return host_readw(&prefetch_buffer[w - pq_start]);
+    return host_readw(prefetch_ptr(w));
 }
 
 template <> uint32_t prefetch_read<uint32_t>(const Bitu w) {
     prefetch_read_check<uint32_t>(w);
-    return host_readd(&prefetch_buffer[w - pq_start]);
+    return host_readd(prefetch_ptr(w));
 }
 
 static inline void prefetch_init(const Bitu start) {
@@ -39,12 +46,27 @@ static inline void prefetch_init(const Bitu start) {
     pq_valid = true;
 }
 
-static inline void prefetch_filldword(void) {
-    host_writed(&prefetch_buffer[pq_fill - pq_start],LoadMd((PhysPt)pq_fill));
+static inline void prefetch_store(const uint32_t val) {
+    uint8_t * const p = prefetch_ptr(pq_fill);
+    host_writed(p,val);
+    host_writed(p + MAX_PQ_SIZE,val);
     pq_fill += prefetch_unit;
 }
 
+static inline void prefetch_filldword(void) {
+    prefetch_store(LoadMd((PhysPt)pq_fill));
+}
+
 static inline void prefetch_refill(const Bitu stop) {
+    /* a refill within one page of plain RAM only needs one TLB lookup */
+    if (pq_fill < stop && (((PhysPt)pq_fill ^ (PhysPt)(stop + 3ul)) & ~0xfffu) == 0) {
+        const HostPt tlb_addr = get_tlb_read((PhysPt)pq_fill);
+        if (tlb_addr) {
+            while (pq_fill < stop) prefetch_store(host_readd(tlb_addr + (PhysPt)pq_fill));
+            return;
+        }
+    }
+
     while (pq_fill < stop) prefetch_filldword();
 }
 
@@ -56,7 +78,6 @@ static inline void prefetch_lazyflush(const Bitu w) {
      * assume: pq_start is DWORD aligned.
      * assume: CPU_PrefetchQueueSize >= 4 */
     if ((w - pq_start) >= pq_limit) {
-        memmove(prefetch_buffer,prefetch_buffer+prefetch_unit,pq_limit-prefetch_unit);
         pq_start += prefetch_unit;
 
         prefetch_filldword();
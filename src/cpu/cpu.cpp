@@ -212,10 +212,13 @@ cpu_cycles_count_t CPU_CycleUp = 0;
 cpu_cycles_count_t CPU_CycleDown = 0;
 cpu_cycles_count_t CPU_CyclesSet = 3000;
 cpu_cycles_count_t CPU_IODelayRemoved = 0;
+uint64_t CPU_CyclesTotal = 0;
 char core_mode[16];
 CPU_Decoder * cpudecoder;
 bool CPU_CycleAutoAdjust = false;
 bool CPU_SkipCycleAutoAdjust = false;
+CPU_GovernorMode_t CPU_GovernorMode = CPU_GOVERNOR_OFF;
+cpu_cycles_count_t CPU_GovernorTarget = 80;
 unsigned char CPU_AutoDetermineMode = 0;
 
 unsigned char CPU_ArchitectureType = CPU_ARCHTYPE_MIXED;
@@ -242,6 +245,7 @@ void CPU_Core_Dyn_X86_Cache_Reset(void);
 void CPU_Core_Dynrec_Init(void);
 void CPU_Core_Dynrec_Cache_Init(bool enable_cache);
 void CPU_Core_Dynrec_Cache_Close(void);
+void CPU_Core_Dynrec_Cache_SetFile(const char * path);
 void CPU_Core_Dynrec_Cache_Reset(void);
 #endif
 
@@ -665,6 +669,51 @@ void Descriptor::Load(PhysPt address) {
 	*(data+1) = mem_readd(address+4);
 	cpu.mpl=3;
 }
+/* protected mode code reloads segment registers all the time, mostly with a few selectors */
+#define DESC_CACHE_SIZE		256u
+
+struct DescriptorCacheEntry {
+	LinearPt	addr;
+	uint32_t	gen;		// valid while it matches desc_cache_gen
+	uint32_t	data[2];
+};
+
+static DescriptorCacheEntry desc_cache[DESC_CACHE_SIZE];
+static uint32_t desc_cache_gen = 1;
+static bool desc_cache_enabled = false;
+
+void CPU_DescriptorCacheFlush(void) {
+	if (GCC_UNLIKELY(++desc_cache_gen == 0)) {
+		memset(desc_cache,0,sizeof(desc_cache));
+		desc_cache_gen = 1;
+	}
+}
+
+/* point the paging watches at the current tables */
+void CPU_DescriptorCacheWatch(void) {
+	if (!desc_cache_enabled) return;
+	PAGING_SetDescriptorWatch(0,cpu.gdt.GetBase(),cpu.gdt.GetLimit()+1u);
+	if (cpu.gdt.SLDT() & 0xfffc) PAGING_SetDescriptorWatch(1,cpu.gdt.GetLDTBase(),cpu.gdt.GetLDTLimit()+1u);
+	else PAGING_SetDescriptorWatch(1,0,0);
+}
+
+void Descriptor::LoadCached(LinearPt address) {
+	DescriptorCacheEntry &e = desc_cache[(address >> 3u) & (DESC_CACHE_SIZE - 1u)];
+	if (e.addr == address && e.gen == desc_cache_gen) {
+		saved.fill[0] = e.data[0];
+		saved.fill[1] = e.data[1];
+		return;
+	}
+	Load(address);
+	// only what the paging code watches for writes can be kept
+	if (desc_cache_enabled && PAGING_DescriptorWatched(address,8)) {
+		e.addr = address;
+		e.gen = desc_cache_gen;
+		e.data[0] = saved.fill[0];
+		e.data[1] = saved.fill[1];
+	}
+}
+
 void Descriptor:: Save(PhysPt address) {
 	cpu.mpl=0;
 	const uint32_t* data = (uint32_t*)&saved;
@@ -2432,6 +2481,7 @@ bool CPU_LLDT(Bitu selector) {
 		LOG(LOG_CPU,LOG_ERROR)("LLDT failed, selector=%X",selector);
 		return true;
 	}
+	CPU_DescriptorCacheWatch();
 	LOG(LOG_CPU,LOG_NORMAL)("LDT Set to %X",selector);
 	return false;
 }
@@ -2440,6 +2490,22 @@ Bitu CPU_STR(void) {
 	return cpu_tss.selector;
 }
 
+/* the KVM core keeps the task register in the vcpu and syncs it between time slices */
+void CPU_STR_Get(Bitu &selector,PhysPt &base,Bitu &limit,bool &is386) {
+	selector=cpu_tss.selector;
+	base=cpu_tss.base;
+	limit=cpu_tss.limit;
+	is386=cpu_tss.is386!=0;
+}
+
+void CPU_STR_Set(Bitu selector,PhysPt base,Bitu limit,bool is386) {
+	if (selector==cpu_tss.selector && base==cpu_tss.base && limit==cpu_tss.limit) return;
+	if (!cpu_tss.SetSelector(selector)) cpu_tss.valid=false;
+	cpu_tss.base=base;
+	cpu_tss.limit=limit;
+	cpu_tss.is386=is386?1:0;
+}
+
 void CPU_TSS_ForceBusy(bool busy) {
 	if (cpu_tss.selector != 0) {
 		cpu_tss.desc.SetBusy(busy);
@@ -2478,6 +2544,7 @@ void CPU_LGDT(Bitu limit,Bitu base) {
 	LOG(LOG_CPU,LOG_NORMAL)("GDT Set to base:%X limit:%X",base,limit);
 	cpu.gdt.SetLimit(limit);
 	cpu.gdt.SetBase((PhysPt)base);
+	CPU_DescriptorCacheWatch();
 }
 
 void CPU_LIDT(Bitu limit,Bitu base) {
@@ -3270,6 +3337,50 @@ void CPU_HLT(uint32_t oldeip) {
 	cpudecoder=&HLT_Decode;
 }
 
+bool CPU_IdleDetect = false;
+
+/* Polls closer together than this many cycles count as the same spin loop, and this many
+ * of them in a row mean the guest is idle. A game checking the keyboard once per frame does
+ * far more work in between. */
+#define CPU_IDLE_POLL_GAP	2000u
+#define CPU_IDLE_POLL_COUNT	16u
+
+static struct {
+	uint64_t	last = 0;	/* cycle position of the previous poll */
+	unsigned int	polls = 0;	/* polls in a row no further apart than CPU_IDLE_POLL_GAP */
+} cpu_idle;
+
+static inline uint64_t CPU_IdleClock(void) {
+	return ((uint64_t)PIC_Ticks * (uint64_t)CPU_CycleMax) + (uint64_t)PIC_TickIndexND();
+}
+
+void CPU_IdlePoll(void) {
+	if (!CPU_IdleDetect) return;
+
+	const uint64_t now = CPU_IdleClock();
+	if (now < cpu_idle.last || (now - cpu_idle.last) > CPU_IDLE_POLL_GAP)
+		cpu_idle.polls = 0;
+	cpu_idle.last = now;
+
+	if (++cpu_idle.polls < CPU_IDLE_POLL_COUNT) return;
+	cpu_idle.polls = CPU_IDLE_POLL_COUNT;
+
+	/* Nothing can change for the guest before the next PIC event, so skip to it like
+	 * HLT_Decode does. The time left over in the millisecond is then slept away in
+	 * increaseticks() instead of being spent spinning. */
+	if (CPU_Cycles > 0) {
+		CPU_IODelayRemoved += CPU_Cycles;
+		CPU_Cycles = 0;
+	}
+
+	/* the next poll after the event continues the streak */
+	cpu_idle.last = CPU_IdleClock();
+}
+
+void CPU_IdleProgress(void) {
+	cpu_idle.polls = 0;
+}
+
 void CPU_ENTER(bool use32,Bitu bytes,Bitu level) {
 	level&=0x1f;
 	uint32_t sp_index=reg_esp&cpu.stack.mask;
@@ -3467,11 +3578,15 @@ void CPU_Disable_SkipAutoAdjust(void) {
 extern int32_t ticksDone;
 extern uint32_t ticksScheduled;
 extern int dynamic_core_cache_block_size;
+extern bool dynamic_core_side_exits;
+extern bool dynamic_core_fast_fpu;
+extern int dynamic_core_translate_threshold;
 
 void CPU_Reset_AutoAdjust(void) {
 	CPU_IODelayRemoved = 0;
 	ticksDone = 0;
 	ticksScheduled = 0;
+	CPU_Governor_Reset();
 }
 
 class Weitek_PageHandler : public PageHandler {
@@ -3608,6 +3723,7 @@ public:
 
 		do_lds_wraparound = section->Get_bool("lds wraparound");
 		do_seg_limits = section->Get_bool("segment limits");
+		desc_cache_enabled = section->Get_bool("descriptor cache");
 	
 		SegSet16(cs,0); Segs.limit[cs] = do_seg_limits ? 0xFFFF : ((PhysPt)(~0UL)); Segs.expanddown[cs] = false;
 		SegSet16(ds,0); Segs.limit[ds] = do_seg_limits ? 0xFFFF : ((PhysPt)(~0UL)); Segs.expanddown[ds] = false;
@@ -3764,6 +3880,19 @@ public:
 
 		dynamic_core_cache_block_size = section->Get_int("dynamic core cache block size");
 		if (dynamic_core_cache_block_size < 1 || dynamic_core_cache_block_size > 65536) dynamic_core_cache_block_size = 32;
+		dynamic_core_side_exits = section->Get_bool("dynamic core side exits");
+		dynamic_core_fast_fpu = section->Get_bool("dynamic core fast fpu");
+		dynamic_core_translate_threshold = section->Get_int("dynamic core translate threshold");
+		if (dynamic_core_translate_threshold < 0 || dynamic_core_translate_threshold > 255) dynamic_core_translate_threshold = 2;
+
+		std::string governor = section->Get_string("cycle governor");
+		if (governor == "share") CPU_GovernorMode = CPU_GOVERNOR_SHARE;
+		else if (governor == "deadline") CPU_GovernorMode = CPU_GOVERNOR_DEADLINE;
+		else CPU_GovernorMode = CPU_GOVERNOR_OFF;
+		CPU_GovernorTarget = section->Get_int("cycle governor target");
+		if (CPU_GovernorTarget < 10 || CPU_GovernorTarget > 100) CPU_GovernorTarget = 80;
+		CPU_IdleDetect = section->Get_bool("idle detection");
+		CPU_IdleProgress();
 
 		Prop_multival* p = section->Get_multival("cycles");
 		std::string type = p->GetSection()->Get_string("type");
@@ -3850,6 +3979,7 @@ public:
 		}
 
 		menu_update_autocycle();
+		CPU_Governor_Reset();
 
 		cpu_rep_max=section->Get_int("interruptible rep string op");
 		ignore_undefined_msr=section->Get_bool("ignore undefined msr");
@@ -3900,6 +4030,15 @@ public:
 #if (C_DYNREC)
 		} else if ((core == "dynamic" && GetDynamicType()==2) || core == "dynamic_rec") {
 			cpudecoder=&CPU_Core_Dynrec_Run;
+#endif
+#if defined(C_HAVE_LINUX_KVM_X86)
+		} else if (core == "kvm") {
+			if (CPU_Core_KVM_Init()) {
+				cpudecoder=&CPU_Core_KVM_Run;
+			} else {
+				strcpy(core_mode,"normal");
+				cpudecoder=&CPU_Core_Normal_Run;
+			}
 #endif
 		} else {
 			strcpy(core_mode,"normal");
@@ -3911,6 +4050,7 @@ public:
 		CPU_Core_Dyn_X86_Cache_Init((core == "dynamic" && GetDynamicType()==1) || (core == "dynamic_x86") || (core == "dynamic_nodhfpu"));
 #endif
 #if (C_DYNREC)
+		CPU_Core_Dynrec_Cache_SetFile(section->Get_string("dynamic core cache file"));
 		CPU_Core_Dynrec_Cache_Init((core == "dynamic" && GetDynamicType()==2) || (core == "dynamic_rec"));
 #endif
 
@@ -4372,6 +4512,9 @@ void GDTDescriptorTable::LoadState(std::istream& stream)
 	READ_POD( &ldt_base, ldt_base );
 	READ_POD( &ldt_limit, ldt_limit );
 	READ_POD( &ldt_value, ldt_value );
+
+	CPU_DescriptorCacheWatch();
+	CPU_DescriptorCacheFlush();
 }
 
 
@@ -4419,6 +4562,9 @@ uint16_t CPU_FindDecoderType( CPU_Decoder *decoder )
 #endif
 #if (C_DYNREC)
 	else if( cpudecoder == &CPU_Core_Dynrec_Run ) decoder_idx = 5;
+#endif
+#if defined(C_HAVE_LINUX_KVM_X86)
+	else if( cpudecoder == &CPU_Core_KVM_Run ) decoder_idx = 6;
 #endif
 	else if( cpudecoder == &CPU_Core_Normal_Trap_Run ) decoder_idx = 100;
 #if C_DYNAMIC_X86
@@ -4426,6 +4572,9 @@ uint16_t CPU_FindDecoderType( CPU_Decoder *decoder )
 #endif
 #if(C_DYNREC)
 	else if( cpudecoder == &CPU_Core_Dynrec_Trap_Run ) decoder_idx = 102;
+#endif
+#if defined(C_HAVE_LINUX_KVM_X86)
+	else if( cpudecoder == &CPU_Core_KVM_Trap_Run ) decoder_idx = 103;
 #endif
 	else if( cpudecoder == &HLT_Decode ) decoder_idx = 200;
 
@@ -4448,6 +4597,9 @@ CPU_Decoder* CPU_IndexDecoderType(uint16_t decoder_idx)
 #endif
 #if (C_DYNREC)
 	    case 5: return &CPU_Core_Dynrec_Run;
+#endif
+#if defined(C_HAVE_LINUX_KVM_X86)
+	    case 6: return &CPU_Core_KVM_Run;
 #endif
 	    case 100: return &CPU_Core_Normal_Trap_Run;
 #if C_DYNAMIC_X86
@@ -4455,6 +4607,9 @@ CPU_Decoder* CPU_IndexDecoderType(uint16_t decoder_idx)
 #endif
 #if(C_DYNREC)
 	    case 102: return &CPU_Core_Dynrec_Trap_Run;
+#endif
+#if defined(C_HAVE_LINUX_KVM_X86)
+	    case 103: return &CPU_Core_KVM_Trap_Run;
 #endif
 	    case 200: return &HLT_Decode;
 	    default: return nullptr;
@@ -18,13 +18,50 @@
 /* DEBUG: Force dual rw/rx on a Linux system that otherwise allows rwx */
 //#define DEBUG_LINUX_FORCE_MEMFD_DUAL_RW_X
 
-#if defined(C_HAVE_MEMFD_CREATE) && !defined(__ANDROID__) && !defined(ANDROID)
-static int cache_fd = -1;
-#endif
 static uint8_t *cache_code_init = NULL; // NTS: Because dynamic code modifies cache_code as needed
 static uint8_t *cache_exec_ptr = NULL;
 static Bitu cache_map_size = 0;
 
+/* Android NDK doesn't really have memfd_create, but automake claims so? */
+#if defined(C_HAVE_MMAP) && (defined(C_HAVE_MEMFD_CREATE) || defined(C_HAVE_SHM_OPEN)) && !defined(__ANDROID__) && !defined(ANDROID)
+#define DYNCORE_FD_MAPPING 1
+#include <fcntl.h>
+#include <sys/mman.h>
+
+static int cache_fd = -1;
+
+/* Map the memory object cache_fd read/write/execute, or where the host enforces W^X, twice:
+ * once read/write and once read/execute. Code is written through the one view and run from
+ * the other, so translating a block never has to change protections. */
+static bool cache_map_fd(Bitu actualsz) {
+    if (ftruncate(cache_fd,(off_t)actualsz) != 0)
+        return false;
+
+#if !defined(DEBUG_LINUX_FORCE_MEMFD_DUAL_RW_X)
+    cache_code_start_ptr=(uint8_t*)mmap(NULL,actualsz,PROT_READ|PROT_WRITE|PROT_EXEC,MAP_SHARED,cache_fd,0);
+    if (cache_code_start_ptr != (uint8_t*)MAP_FAILED)
+        return true;
+#endif
+
+    cache_code_start_ptr = NULL;
+    uint8_t *rx=(uint8_t*)mmap(NULL,actualsz,PROT_READ|PROT_EXEC,MAP_SHARED,cache_fd,0);
+    if (rx == (uint8_t*)MAP_FAILED)
+        return false;
+
+    uint8_t *rw=(uint8_t*)mmap(rx/*place after this!*/,actualsz,PROT_READ|PROT_WRITE,MAP_SHARED,cache_fd,0);
+    if (rw == (uint8_t*)MAP_FAILED) {
+        munmap(rx,actualsz);
+        return false;
+    }
+
+    cache_code_start_ptr = rw;
+    cache_exec_ptr = rx;
+    dyncore_method = DYNCOREM_DUAL_RW_X;
+    dyncore_flags |= DYNCOREF_W_XOR_X;
+    return true;
+}
+#endif
+
 static INLINE void *cache_rwtox(void *x) {
     return (void*)((uintptr_t)((char*)x) + (uintptr_t)((char*)cache_exec_ptr) - (uintptr_t)((char*)cache_code_init));
 }
@@ -76,42 +113,37 @@ static void cache_dynamic_common_alloc(Bitu allocsz) {
         else cache_code_start_ptr = NULL; /* MAP_FAILED is NOT NULL (or at least we cannot assume that) */
     }
 #endif
-#if defined(C_HAVE_MEMFD_CREATE) && !defined(__ANDROID__) && !defined(ANDROID) /* Try a Linux memfd which we can mmap twice, one read/write, one read/execute */
-/* Android NDK doesn't really have memfd_create, but automake claims so? */
+#if defined(DYNCORE_FD_MAPPING) && defined(C_HAVE_MEMFD_CREATE) /* Try a Linux memfd which we can mmap twice, one read/write, one read/execute */
     if (cache_code_start_ptr == NULL) {
         assert(cache_fd < 0);
         cache_fd = memfd_create("dosbox-dynamic-core-cache",MFD_CLOEXEC);
         if (cache_fd >= 0) {
-            if (ftruncate(cache_fd,actualsz) == 0) {
-#if defined(DEBUG_LINUX_FORCE_MEMFD_DUAL_RW_X)
-                cache_code_start_ptr=(uint8_t*)MAP_FAILED; // fail on purpose, trigger dual map mode
+            if (cache_map_fd(actualsz)) {
+                dyncore_alloc = DYNCOREALLOC_MEMFD;
+            }
+            else {
+                close(cache_fd);
+                cache_fd = -1;
+            }
+        }
+    }
+#endif
+#if defined(DYNCORE_FD_MAPPING) && defined(C_HAVE_SHM_OPEN) /* No memfd (the BSDs, older libc): an unnamed POSIX shared memory object maps twice just as well, which beats mprotect() on every translated block */
+    if (cache_code_start_ptr == NULL) {
+        assert(cache_fd < 0);
+#if defined(SHM_ANON)
+        cache_fd = shm_open(SHM_ANON,O_RDWR,0600);
 #else
-                cache_code_start_ptr=(uint8_t*)mmap(NULL,actualsz,PROT_READ|PROT_WRITE|PROT_EXEC,MAP_SHARED,cache_fd,0);
-#endif
-                if (cache_code_start_ptr == MAP_FAILED) {
-                    cache_code_start_ptr=(uint8_t*)mmap(NULL,actualsz,PROT_READ|PROT_EXEC,MAP_SHARED,cache_fd,0);
-                    if (cache_code_start_ptr != MAP_FAILED) {
-                        cache_exec_ptr=(uint8_t*)mmap(cache_code_start_ptr/*place after this!*/,actualsz,PROT_READ|PROT_WRITE,MAP_SHARED,cache_fd,0);
-                        if (cache_exec_ptr != MAP_FAILED) {
-                            std::swap(cache_exec_ptr,cache_code_start_ptr);
-                            dyncore_method = DYNCOREM_DUAL_RW_X;
-                            dyncore_flags |= DYNCOREF_W_XOR_X;
-                        }
-                        else {
-                            assert(munmap(cache_code_start_ptr,actualsz) == 0);
-                            cache_code_start_ptr = NULL;
-                        }
-                    }
-                }
-                if (cache_code_start_ptr != MAP_FAILED) {
-                    dyncore_alloc = DYNCOREALLOC_MEMFD;
-                }
+        char shm_name[64];
+        snprintf(shm_name,sizeof(shm_name),"/dosbox-x-dyncore-%ld",(long)getpid());
+        cache_fd = shm_open(shm_name,O_RDWR|O_CREAT|O_EXCL,0600);
+        if (cache_fd >= 0) shm_unlink(shm_name); /* only the mappings keep it now */
+#endif
+        if (cache_fd >= 0) {
+            if (cache_map_fd(actualsz)) {
+                dyncore_alloc = DYNCOREALLOC_SHM_MMAP;
             }
-
-            if (cache_code_start_ptr == MAP_FAILED)
-                cache_code_start_ptr = NULL;
-
-            if (cache_code_start_ptr == NULL) {
+            else {
                 close(cache_fd);
                 cache_fd = -1;
             }
@@ -197,6 +229,7 @@ static void cache_dynamic_common_alloc(Bitu allocsz) {
         case DYNCOREALLOC_MMAP_ANON:        LOG(LOG_MISC,LOG_DEBUG)("dyncore alloc: mmap using MAP_PRIVATE|MAP_ANONYMOUS"); break;
         case DYNCOREALLOC_MALLOC:           LOG(LOG_MISC,LOG_DEBUG)("dyncore alloc: malloc"); break;
         case DYNCOREALLOC_MEMFD:            LOG(LOG_MISC,LOG_DEBUG)("dyncore alloc: memfd"); break;
+        case DYNCOREALLOC_SHM_MMAP:         LOG(LOG_MISC,LOG_DEBUG)("dyncore alloc: shm_open"); break;
         default:                            LOG(LOG_MISC,LOG_DEBUG)("dyncore alloc: ?"); break;
     };
 
@@ -20,11 +20,14 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <vector>
 
 #include "paging.h"
 #include "lazyflags.h"
 #include "cpu.h"
 #include "logging.h"
+#include "pic.h"
+#include "hostmem.h"
 
 extern bool do_pse;
 extern bool enable_pse;
@@ -325,15 +328,31 @@ static void PAGING_NewPageFault(PhysPt lin_addr, Bitu page_addr, bool prepare_on
 	}
 }
 
+// debugger write watchpoints, see PAGING_AddWriteWatch
+struct PagingWriteWatch {
+	LinearPt	start;
+	Bitu		len;
+};
+
+static std::vector<PagingWriteWatch> paging_watches;
+// the GDT and LDT while the CPU caches their descriptors, see PAGING_SetDescriptorWatch
+static PagingWriteWatch paging_desc_watches[2] = {};
+static bool paging_desc_watched = false;
+static bool paging_watch_hit = false;
+static LinearPt paging_watch_hit_addr = 0;
+bool paging_watch_retry = false;
+
+static void PAGING_WatchLink(PageNum lin_page);
+
 class PageFoilHandler : public PageHandler {
 private:
 	void work(PhysPt addr) {
 		const PageNum lin_page = PageNum(addr >> 12u);
-		const PageNum phys_page = PageNum(paging.tlb.phys_page[lin_page] & PHYSPAGE_ADDR);
+		const PageNum phys_page = PageNum(tlb_phys_page(lin_page) & PHYSPAGE_ADDR);
 		X86PageEntry dir_entry, table_entry;
 			
 		// set the page dirty in the tlb
-		paging.tlb.phys_page[lin_page] |= PHYSPAGE_DIRTY;
+		tlb_phys_page(lin_page) |= PHYSPAGE_DIRTY;
 
 		// mark the page table entry dirty
 		const PhysPt dirEntryAddr = GetPageDirectoryEntryAddr(addr);
@@ -374,11 +393,12 @@ private:
 		// replace this handler with the real thing
 		PageHandler* const handler = MEM_GetPageHandler(phys_page);
 		if (handler->getFlags() & PFLAG_WRITEABLE)
-			paging.tlb.write[lin_page] = handler->GetHostWritePt(phys_page) - (lin_page << 12);
+			tlb_write(lin_page) = handler->GetHostWritePt(phys_page) - (lin_page << 12);
 		else
-			paging.tlb.write[lin_page] = nullptr;
+			tlb_write(lin_page) = nullptr;
 
-		paging.tlb.writehandler[lin_page] = handler;
+		tlb_writehandler(lin_page) = handler;
+		PAGING_WatchLink(lin_page);
 	}
 
 	void read() {
@@ -431,7 +451,7 @@ class ExceptionPageHandler : public PageHandler {
 private:
 	PageHandler* getHandler(PhysPt addr) {
 		const PageNum lin_page = PageNum(addr >> 12u);
-		const PageNum phys_page = paging.tlb.phys_page[lin_page] & PHYSPAGE_ADDR;
+		const PageNum phys_page = tlb_phys_page(lin_page) & PHYSPAGE_ADDR;
 		PageHandler* const handler = MEM_GetPageHandler(phys_page);
 		return handler;
 	}
@@ -453,7 +473,7 @@ private:
 		// unlikely to use those page table features. --J.C.
 
 		if (!do_pse) {
-			const uint8_t old_attirbs = uint8_t(paging.tlb.phys_page[addr>>12] >> PHYSPAGE_ACCESS_BITS_SHIFT);
+			const uint8_t old_attirbs = uint8_t(tlb_phys_page(addr>>12) >> PHYSPAGE_ACCESS_BITS_SHIFT);
 			X86PageEntry dir_entry, table_entry;
 
 			dir_entry.load = phys_readd(GetPageDirectoryEntryAddr(addr));
@@ -492,7 +512,7 @@ private:
 
 	uint8_t readb_through(PhysPt addr) {
 		Bitu lin_page = addr >> 12;
-		uint32_t phys_page = paging.tlb.phys_page[lin_page] & PHYSPAGE_ADDR;
+		uint32_t phys_page = tlb_phys_page(lin_page) & PHYSPAGE_ADDR;
 		PageHandler* handler = MEM_GetPageHandler(phys_page);
 		if (handler->getFlags() & PFLAG_READABLE) {
 			return host_readb(handler->GetHostReadPt(phys_page) + (addr&0xfff));
@@ -501,7 +521,7 @@ private:
 	}
 	uint16_t readw_through(PhysPt addr) {
 		Bitu lin_page = addr >> 12;
-		uint32_t phys_page = paging.tlb.phys_page[lin_page] & PHYSPAGE_ADDR;
+		uint32_t phys_page = tlb_phys_page(lin_page) & PHYSPAGE_ADDR;
 		PageHandler* handler = MEM_GetPageHandler(phys_page);
 		if (handler->getFlags() & PFLAG_READABLE) {
 			return host_readw(handler->GetHostReadPt(phys_page) + (addr&0xfff));
@@ -510,7 +530,7 @@ private:
 	}
 	uint32_t readd_through(PhysPt addr) {
 		Bitu lin_page = addr >> 12;
-		uint32_t phys_page = paging.tlb.phys_page[lin_page] & PHYSPAGE_ADDR;
+		uint32_t phys_page = tlb_phys_page(lin_page) & PHYSPAGE_ADDR;
 		PageHandler* handler = MEM_GetPageHandler(phys_page);
 		if (handler->getFlags() & PFLAG_READABLE) {
 			return host_readd(handler->GetHostReadPt(phys_page) + (addr&0xfff));
@@ -520,7 +540,7 @@ private:
 
 	void writeb_through(PhysPt addr, uint8_t val) {
 		Bitu lin_page = addr >> 12;
-		uint32_t phys_page = paging.tlb.phys_page[lin_page] & PHYSPAGE_ADDR;
+		uint32_t phys_page = tlb_phys_page(lin_page) & PHYSPAGE_ADDR;
 		PageHandler* handler = MEM_GetPageHandler(phys_page);
 		if (handler->getFlags() & PFLAG_WRITEABLE) {
 			return host_writeb(handler->GetHostWritePt(phys_page) + (addr&0xfff), val);
@@ -530,7 +550,7 @@ private:
 
 	void writew_through(PhysPt addr, uint16_t val) {
 		Bitu lin_page = addr >> 12;
-		uint32_t phys_page = paging.tlb.phys_page[lin_page] & PHYSPAGE_ADDR;
+		uint32_t phys_page = tlb_phys_page(lin_page) & PHYSPAGE_ADDR;
 		PageHandler* handler = MEM_GetPageHandler(phys_page);
 		if (handler->getFlags() & PFLAG_WRITEABLE) {
 			return host_writew(handler->GetHostWritePt(phys_page) + (addr&0xfff), val);
@@ -540,7 +560,7 @@ private:
 
 	void writed_through(PhysPt addr, uint32_t val) {
 		Bitu lin_page = addr >> 12;
-		uint32_t phys_page = paging.tlb.phys_page[lin_page] & PHYSPAGE_ADDR;
+		uint32_t phys_page = tlb_phys_page(lin_page) & PHYSPAGE_ADDR;
 		PageHandler* handler = MEM_GetPageHandler(phys_page);
 		if (handler->getFlags() & PFLAG_WRITEABLE) {
 			return host_writed(handler->GetHostWritePt(phys_page) + (addr&0xfff), val);
@@ -641,6 +661,97 @@ public:
 	}
 };
 
+// writes to a watched page, everything else on the page goes on to the real handler
+class WatchPageHandler : public PageHandler {
+private:
+	static bool watched(PhysPt addr,Bitu len) {
+		for (const auto &w : paging_watches) {
+			if ((uint64_t)addr < (uint64_t)w.start + w.len && (uint64_t)addr + len > (uint64_t)w.start) return true;
+		}
+		return false;
+	}
+	static void check(PhysPt addr,Bitu len) {
+		if (watched(addr,len)) hit(addr);
+		if (paging_desc_watched) {
+			for (const auto &w : paging_desc_watches) {
+				if ((uint64_t)addr < (uint64_t)w.start + w.len && (uint64_t)addr + len > (uint64_t)w.start) {
+					CPU_DescriptorCacheFlush();
+					break;
+				}
+			}
+		}
+	}
+	static void hit(PhysPt addr) {
+		if (!paging_watch_hit) {
+			paging_watch_hit = true;
+			paging_watch_hit_addr = addr;
+		}
+		// leave the core once this instruction is done
+		CPU_CycleLeft += CPU_Cycles;
+		CPU_Cycles = 0;
+	}
+	// translated code gives up the instruction like it does for self-modifying code (SMC_CURRENT_BLOCK)
+	static bool retry(PhysPt addr,Bitu len) {
+		if (!paging_watch_retry || !watched(addr,len)) return false;
+		cpu.exception.which = 0xffff;
+		return true;
+	}
+	static PageHandler* getHandler(PhysPt addr,PageNum &phys_page) {
+		phys_page = tlb_phys_page(addr >> 12) & PHYSPAGE_ADDR;
+		return MEM_GetPageHandler(phys_page);
+	}
+public:
+	WatchPageHandler() : PageHandler(PFLAG_INIT|PFLAG_NOCODE) {}
+	void writeb(PhysPt addr,uint8_t val) override {
+		check(addr,1);
+		PageNum phys_page;
+		PageHandler* const handler = getHandler(addr,phys_page);
+		if (handler->getFlags() & PFLAG_WRITEABLE) host_writeb(handler->GetHostWritePt(phys_page) + (addr&0xfff), val);
+		else handler->writeb(addr, val);
+	}
+	void writew(PhysPt addr,uint16_t val) override {
+		check(addr,2);
+		PageNum phys_page;
+		PageHandler* const handler = getHandler(addr,phys_page);
+		if (handler->getFlags() & PFLAG_WRITEABLE) host_writew(handler->GetHostWritePt(phys_page) + (addr&0xfff), val);
+		else handler->writew(addr, val);
+	}
+	void writed(PhysPt addr,uint32_t val) override {
+		check(addr,4);
+		PageNum phys_page;
+		PageHandler* const handler = getHandler(addr,phys_page);
+		if (handler->getFlags() & PFLAG_WRITEABLE) host_writed(handler->GetHostWritePt(phys_page) + (addr&0xfff), val);
+		else handler->writed(addr, val);
+	}
+	bool writeb_checked(PhysPt addr,uint8_t val) override {
+		if (retry(addr,1)) return true;
+		check(addr,1);
+		PageNum phys_page;
+		PageHandler* const handler = getHandler(addr,phys_page);
+		if (!(handler->getFlags() & PFLAG_WRITEABLE)) return handler->writeb_checked(addr, val);
+		host_writeb(handler->GetHostWritePt(phys_page) + (addr&0xfff), val);
+		return false;
+	}
+	bool writew_checked(PhysPt addr,uint16_t val) override {
+		if (retry(addr,2)) return true;
+		check(addr,2);
+		PageNum phys_page;
+		PageHandler* const handler = getHandler(addr,phys_page);
+		if (!(handler->getFlags() & PFLAG_WRITEABLE)) return handler->writew_checked(addr, val);
+		host_writew(handler->GetHostWritePt(phys_page) + (addr&0xfff), val);
+		return false;
+	}
+	bool writed_checked(PhysPt addr,uint32_t val) override {
+		if (retry(addr,4)) return true;
+		check(addr,4);
+		PageNum phys_page;
+		PageHandler* const handler = getHandler(addr,phys_page);
+		if (!(handler->getFlags() & PFLAG_WRITEABLE)) return handler->writed_checked(addr, val);
+		host_writed(handler->GetHostWritePt(phys_page) + (addr&0xfff), val);
+		return false;
+	}
+};
+
 static void PAGING_LinkPageNew(PageNum lin_page, PageNum phys_page, const uint8_t linkmode, bool dirty);
 
 static INLINE void InitPageCheckPresence(PhysPt lin_addr,bool writing,X86PageEntry& table,X86PageEntry& entry) {
@@ -969,36 +1080,210 @@ bool PAGING_MakePhysPage(PageNum &page) {
 static NewInitPageHandler init_page_handler;
 static ExceptionPageHandler exception_handler;
 static PageFoilHandler foiling_handler;
+static WatchPageHandler watch_handler;
+
+static inline bool PAGING_WatchOnPage(const PagingWriteWatch &w,PageNum lin_page) {
+	return w.len != 0 && (PageNum)(w.start >> 12) <= lin_page && lin_page <= (PageNum)(((uint64_t)w.start + w.len - 1) >> 12);
+}
+
+// watched pages stay on the trap handler whenever a real write handler is linked
+static void PAGING_WatchLink(PageNum lin_page) {
+	if (GCC_LIKELY(paging_watches.empty() && !paging_desc_watched)) return;
+	if (tlb_writehandler(lin_page)->getFlags() & PFLAG_INIT) return;
+	bool trap = false;
+	for (const auto &w : paging_watches) trap |= PAGING_WatchOnPage(w,lin_page);
+	for (const auto &w : paging_desc_watches) trap |= PAGING_WatchOnPage(w,lin_page);
+	if (trap) {
+		tlb_write(lin_page) = nullptr;
+		tlb_writehandler(lin_page) = &watch_handler;
+	}
+}
+
+static void PAGING_UnlinkWatch(const PagingWriteWatch &w) {
+	if (w.len == 0) return;
+	const PageNum first = (PageNum)(w.start >> 12);
+	const PageNum last = (PageNum)(((uint64_t)w.start + w.len - 1) >> 12);
+	if (last >= TLB_SIZE) return PAGING_ClearTLB();
+	PAGING_UnlinkPages(first,last - first + 1);
+}
+
+void PAGING_SetDescriptorWatch(unsigned int which,LinearPt addr,Bitu len) {
+	assert(which < 2);
+	PagingWriteWatch &w = paging_desc_watches[which];
+	if (w.start == addr && w.len == len) return;
+	// drop the pages of the old and the new range, they pick up the right write handler when linked again
+	PAGING_UnlinkWatch(w);
+	w.start = addr;
+	w.len = len;
+	PAGING_UnlinkWatch(w);
+	paging_desc_watched = paging_desc_watches[0].len != 0 || paging_desc_watches[1].len != 0;
+	CPU_DescriptorCacheFlush();
+}
+
+bool PAGING_DescriptorWatched(LinearPt addr,Bitu len) {
+	for (const auto &w : paging_desc_watches) {
+		if ((uint64_t)addr >= (uint64_t)w.start && (uint64_t)addr + len <= (uint64_t)w.start + w.len) return true;
+	}
+	return false;
+}
+
+bool PAGING_AddWriteWatch(LinearPt addr,Bitu len) {
+	if (len == 0) return false;
+	PagingWriteWatch w;
+	w.start = addr;
+	w.len = len;
+	paging_watches.push_back(w);
+	// relink every page, the watched ones pick up the trap handler
+	PAGING_ClearTLB();
+	return true;
+}
+
+bool PAGING_RemoveWriteWatch(LinearPt addr,Bitu len) {
+	for (auto i = paging_watches.begin(); i != paging_watches.end(); ++i) {
+		if (i->start == addr && i->len == len) {
+			paging_watches.erase(i);
+			PAGING_ClearTLB();
+			return true;
+		}
+	}
+	return false;
+}
+
+void PAGING_ClearWriteWatches(void) {
+	if (paging_watches.empty()) return;
+	paging_watches.clear();
+	paging_watch_hit = false;
+	PAGING_ClearTLB();
+}
+
+bool PAGING_GetWriteWatchHit(LinearPt &addr) {
+	if (!paging_watch_hit) return false;
+	paging_watch_hit = false;
+	addr = paging_watch_hit_addr;
+	return true;
+}
 
 Bitu PAGING_GetDirBase(void) {
 	return paging.cr3;
 }
 
+#if C_SPARSE_TLB
+static TLBEntry tlb_empty_bank[TLB_BANK_SIZE];
+
+static void PAGING_InitTLBEntries(TLBEntry *entry,Bitu count) {
+	for (;count>0;count--,entry++) {
+		entry->read=nullptr;
+		entry->write=nullptr;
+		entry->readhandler=&init_page_handler;
+		entry->writehandler=&init_page_handler;
+		entry->phys_page=0;
+		entry->tag=TLB_TAG_NONE;
+	}
+}
+
+TLBEntry *PAGING_TLBAllocBank(const Bitu bank) {
+	TLBEntry *entries=new TLBEntry[TLB_BANK_SIZE];
+	PAGING_InitTLBEntries(entries,TLB_BANK_SIZE);
+	paging.tlb.bank[bank]=entries;
+	return entries;
+}
+
+const TLBEntry &PAGING_TLBMiss(const PageNum page) {
+	TLBEntry &hot=paging.tlb.hot[page&(TLB_HOT_SIZE-1)];
+	const TLBEntry &entry=paging.tlb.bank[page>>TLB_BANK_BITS][page&(TLB_BANK_SIZE-1)];
+	const uint64_t tag=paging.tlb.gen|page;
+	// entries linked before the last flush read as unmapped
+	hot=(entry.tag==tag) ? entry : tlb_empty_bank[0];
+	hot.tag=tag;
+	return hot;
+}
+
+void PAGING_InitTLB(void) {
+	PAGING_InitTLBEntries(tlb_empty_bank,TLB_BANK_SIZE);
+	PAGING_InitTLBEntries(paging.tlb.hot,TLB_HOT_SIZE);
+	paging.tlb.empty=tlb_empty_bank;
+	paging.tlb.gen=0;
+	for (Bitu i=0;i<TLB_BANKS;i++) {
+		if (paging.tlb.bank[i] && paging.tlb.bank[i]!=tlb_empty_bank) delete[] paging.tlb.bank[i];
+		paging.tlb.bank[i]=tlb_empty_bank;
+	}
+#else
 void PAGING_InitTLB(void) {
 	for (Bitu i=0;i<TLB_SIZE;i++) {
-		paging.tlb.read[i]=nullptr;
-		paging.tlb.write[i]=nullptr;
-		paging.tlb.readhandler[i]=&init_page_handler;
-		paging.tlb.writehandler[i]=&init_page_handler;
+		tlb_read(i)=nullptr;
+		tlb_write(i)=nullptr;
+		tlb_readhandler(i)=&init_page_handler;
+		tlb_writehandler(i)=&init_page_handler;
 	}
+#endif
 	paging.ur_links.used=0;
 	paging.krw_links.used=0;
 	paging.kr_links.used=0;
 	paging.links.used=0;
 }
 
+// full TLB flushes, always counted
+static struct {
+	uint64_t total;
+	Bitu window_start;		// PIC_Ticks at the start of the current window
+	uint64_t count;			// flushes in the current window
+	uint64_t rate;			// flushes of the last complete window, per second
+} tlb_flush_stats;
+
+static void PAGING_TLBFlushRoll(void) {
+	const Bitu elapsed=PIC_Ticks-tlb_flush_stats.window_start;
+	if (elapsed<1000) return;
+	tlb_flush_stats.rate=(elapsed<2000) ? tlb_flush_stats.count : (tlb_flush_stats.count*1000/elapsed);
+	tlb_flush_stats.count=0;
+	tlb_flush_stats.window_start=PIC_Ticks;
+}
+
+// may be called from other threads (QMP), so this does not roll the window
+void PAGING_GetTLBFlushStats(uint64_t &flushes,uint64_t &flushes_per_sec) {
+	const Bitu elapsed=PIC_Ticks-tlb_flush_stats.window_start;
+	flushes=tlb_flush_stats.total;
+	flushes_per_sec=(elapsed<2000) ? tlb_flush_stats.rate : (tlb_flush_stats.count*1000/elapsed);
+}
+
+void PAGING_GetHostMemory(HostMemSize &sz) {
+	sz.add(&paging,sizeof(paging));
+#if C_SPARSE_TLB
+	sz.add_heap(sizeof(tlb_empty_bank));
+	for (Bitu i=0;i<TLB_BANKS;i++) {
+		if (paging.tlb.bank[i] && paging.tlb.bank[i]!=tlb_empty_bank) sz.add_heap(sizeof(TLBEntry)*TLB_BANK_SIZE);
+	}
+#endif
+}
+
 void PAGING_ClearTLB(void) {
 //	LOG_MSG("CLEAR                          m% 4u, kr% 4u, krw% 4u, ur% 4u",
 //		paging.links.used, paging.kro_links.used, paging.krw_links.used, paging.ure_links.used);
 
+	PAGING_TLBFlushRoll();
+	tlb_flush_stats.total++;
+	tlb_flush_stats.count++;
+	// the descriptor tables may map somewhere else now
+	CPU_DescriptorCacheFlush();
+
+#if C_SPARSE_TLB
+	paging.tlb.gen+=TLB_GEN_STEP;
+	if (GCC_UNLIKELY(paging.tlb.gen==0)) {
+		// generation wrapped around, old entries could match again
+		PAGING_InitTLBEntries(paging.tlb.hot,TLB_HOT_SIZE);
+		for (Bitu i=0;i<TLB_BANKS;i++) {
+			if (paging.tlb.bank[i]!=tlb_empty_bank) PAGING_InitTLBEntries(paging.tlb.bank[i],TLB_BANK_SIZE);
+		}
+	}
+#else
 	uint32_t * entries=&paging.links.entries[0];
 	for (;paging.links.used>0;paging.links.used--) {
 		Bitu page=*entries++;
-		paging.tlb.read[page]=nullptr;
-		paging.tlb.write[page]=nullptr;
-		paging.tlb.readhandler[page]=&init_page_handler;
-		paging.tlb.writehandler[page]=&init_page_handler;
+		tlb_read(page)=nullptr;
+		tlb_write(page)=nullptr;
+		tlb_readhandler(page)=&init_page_handler;
+		tlb_writehandler(page)=&init_page_handler;
 	}
+#endif
 	paging.ur_links.used=0;
 	paging.krw_links.used=0;
 	paging.kr_links.used=0;
@@ -1006,22 +1291,24 @@ void PAGING_ClearTLB(void) {
 }
 
 void PAGING_UnlinkPages(PageNum lin_page,PageNum pages) {
+	CPU_DescriptorCacheFlush();
 	for (;pages>0;pages--) {
-		paging.tlb.read[lin_page]=nullptr;
-		paging.tlb.write[lin_page]=nullptr;
-		paging.tlb.readhandler[lin_page]=&init_page_handler;
-		paging.tlb.writehandler[lin_page]=&init_page_handler;
+		tlb_read(lin_page)=nullptr;
+		tlb_write(lin_page)=nullptr;
+		tlb_readhandler(lin_page)=&init_page_handler;
+		tlb_writehandler(lin_page)=&init_page_handler;
 		lin_page++;
 	}
 }
 
 void PAGING_MapPage(PageNum lin_page,PageNum phys_page) {
 	if (lin_page<LINK_START) {
+		CPU_DescriptorCacheFlush();
 		paging.firstmb[lin_page]=(uint32_t)phys_page;
-		paging.tlb.read[lin_page]=nullptr;
-		paging.tlb.write[lin_page]=nullptr;
-		paging.tlb.readhandler[lin_page]=&init_page_handler;
-		paging.tlb.writehandler[lin_page]=&init_page_handler;
+		tlb_read(lin_page)=nullptr;
+		tlb_write(lin_page)=nullptr;
+		tlb_readhandler(lin_page)=&init_page_handler;
+		tlb_writehandler(lin_page)=&init_page_handler;
 	} else {
 		PAGING_LinkPage(lin_page,phys_page);
 	}
@@ -1050,45 +1337,45 @@ static void PAGING_LinkPageNew(PageNum lin_page, PageNum phys_page, const uint8_
 	// needed in the exception handler and foiler so they can replace themselves appropriately
 	// bit31-30 ACMAP_
 	// bit29	dirty
-	// these bits are shifted off at the places paging.tlb.phys_page is read
-	paging.tlb.phys_page[lin_page]= (uint32_t)(phys_page | (linkmode << 30u) | (dirty ? PHYSPAGE_DIRTY : 0));
+	// these bits are shifted off at the places the tlb phys_page is read
+	tlb_phys_page(lin_page)= (uint32_t)(phys_page | (linkmode << 30u) | (dirty ? PHYSPAGE_DIRTY : 0));
 	switch(outcome) {
 	case ACMAP_RW:
 		// read
-		if (handler->getFlags() & PFLAG_READABLE) paging.tlb.read[lin_page] = 
+		if (handler->getFlags() & PFLAG_READABLE) tlb_read(lin_page) = 
 			handler->GetHostReadPt(phys_page)-lin_base;
 		else
-			paging.tlb.read[lin_page]=nullptr;
-		paging.tlb.readhandler[lin_page]=handler;
+			tlb_read(lin_page)=nullptr;
+		tlb_readhandler(lin_page)=handler;
 
 		// write
 		if (dirty) { // in case it is already dirty we don't need to check
-			if (handler->getFlags() & PFLAG_WRITEABLE) paging.tlb.write[lin_page] = 
+			if (handler->getFlags() & PFLAG_WRITEABLE) tlb_write(lin_page) = 
 				handler->GetHostWritePt(phys_page)-lin_base;
 			else
-				paging.tlb.write[lin_page]=nullptr;
-			paging.tlb.writehandler[lin_page]=handler;
+				tlb_write(lin_page)=nullptr;
+			tlb_writehandler(lin_page)=handler;
 		} else {
-			paging.tlb.writehandler[lin_page]= &foiling_handler;
-			paging.tlb.write[lin_page]=nullptr;
+			tlb_writehandler(lin_page)= &foiling_handler;
+			tlb_write(lin_page)=nullptr;
 		}
 		break;
 	case ACMAP_RE:
 		// read
-		if (handler->getFlags() & PFLAG_READABLE) paging.tlb.read[lin_page] = 
+		if (handler->getFlags() & PFLAG_READABLE) tlb_read(lin_page) = 
 			handler->GetHostReadPt(phys_page)-lin_base;
 		else
-			paging.tlb.read[lin_page]=nullptr;
-		paging.tlb.readhandler[lin_page]=handler;
+			tlb_read(lin_page)=nullptr;
+		tlb_readhandler(lin_page)=handler;
 		// exception
-		paging.tlb.writehandler[lin_page]= &exception_handler;
-		paging.tlb.write[lin_page]=nullptr;
+		tlb_writehandler(lin_page)= &exception_handler;
+		tlb_write(lin_page)=nullptr;
 		break;
 	case ACMAP_EE:
-		paging.tlb.readhandler[lin_page]= &exception_handler;
-		paging.tlb.writehandler[lin_page]= &exception_handler;
-		paging.tlb.read[lin_page]=nullptr;
-		paging.tlb.write[lin_page]=nullptr;
+		tlb_readhandler(lin_page)= &exception_handler;
+		tlb_writehandler(lin_page)= &exception_handler;
+		tlb_read(lin_page)=nullptr;
+		tlb_write(lin_page)=nullptr;
 		break;
 	}
 
@@ -1107,6 +1394,8 @@ static void PAGING_LinkPageNew(PageNum lin_page, PageNum phys_page, const uint8_
 			break;
 	}
 	paging.links.entries[paging.links.used++]= (uint32_t)lin_page; // "master table"
+	tlb_validate(lin_page);
+	PAGING_WatchLink(lin_page);
 }
 
 void PAGING_LinkPage(PageNum lin_page,PageNum phys_page) {
@@ -1124,15 +1413,17 @@ void PAGING_LinkPage(PageNum lin_page,PageNum phys_page) {
 		PAGING_ClearTLB();
 	}
 
-	paging.tlb.phys_page[lin_page]= (uint32_t)phys_page;
-	if (handler->getFlags() & PFLAG_READABLE) paging.tlb.read[lin_page]=handler->GetHostReadPt(phys_page)-lin_base;
-	else paging.tlb.read[lin_page]=nullptr;
-	if (handler->getFlags() & PFLAG_WRITEABLE) paging.tlb.write[lin_page]=handler->GetHostWritePt(phys_page)-lin_base;
-	else paging.tlb.write[lin_page]=nullptr;
+	tlb_phys_page(lin_page)= (uint32_t)phys_page;
+	if (handler->getFlags() & PFLAG_READABLE) tlb_read(lin_page)=handler->GetHostReadPt(phys_page)-lin_base;
+	else tlb_read(lin_page)=nullptr;
+	if (handler->getFlags() & PFLAG_WRITEABLE) tlb_write(lin_page)=handler->GetHostWritePt(phys_page)-lin_base;
+	else tlb_write(lin_page)=nullptr;
 
 	paging.links.entries[paging.links.used++]= (uint32_t)lin_page;
-	paging.tlb.readhandler[lin_page]=handler;
-	paging.tlb.writehandler[lin_page]=handler;
+	tlb_readhandler(lin_page)=handler;
+	tlb_writehandler(lin_page)=handler;
+	tlb_validate(lin_page);
+	PAGING_WatchLink(lin_page);
 }
 
 // parameter is the new cpl mode
@@ -1148,38 +1439,39 @@ void PAGING_SwitchCPL(bool isUser) {
 		// sv -> us: rw -> ee 
 		for(Bitu i = 0; i < paging.krw_links.used; i++) {
 			const tlbentry_t tlb_index = paging.krw_links.entries[i];
-			paging.tlb.readhandler[tlb_index] = &exception_handler;
-			paging.tlb.writehandler[tlb_index] = &exception_handler;
-			paging.tlb.read[tlb_index] = nullptr;
-			paging.tlb.write[tlb_index] = nullptr;
+			tlb_readhandler(tlb_index) = &exception_handler;
+			tlb_writehandler(tlb_index) = &exception_handler;
+			tlb_read(tlb_index) = nullptr;
+			tlb_write(tlb_index) = nullptr;
 		}
 	} else {
 		// us -> sv: ee -> rw
 		for(Bitu i = 0; i < paging.krw_links.used; i++) {
 			const tlbentry_t tlb_index = paging.krw_links.entries[i];
-			const PageNum phys_page = paging.tlb.phys_page[tlb_index] & PHYSPAGE_ADDR;
+			const PageNum phys_page = tlb_phys_page(tlb_index) & PHYSPAGE_ADDR;
 			const LinearPt lin_base = LinearPt(tlb_index << 12u);
 			const bool dirty = (phys_page & PHYSPAGE_DIRTY) ? true : false;
 			PageHandler* const handler = MEM_GetPageHandler(phys_page);
 			
 			// map read handler
-			paging.tlb.readhandler[tlb_index] = handler;
+			tlb_readhandler(tlb_index) = handler;
 			if (handler->getFlags()&PFLAG_READABLE)
-				paging.tlb.read[tlb_index] = handler->GetHostReadPt(phys_page)-lin_base;
+				tlb_read(tlb_index) = handler->GetHostReadPt(phys_page)-lin_base;
 			else
-				paging.tlb.read[tlb_index] = nullptr;
+				tlb_read(tlb_index) = nullptr;
 			
 			// map write handler
 			if (dirty) {
-				paging.tlb.writehandler[tlb_index] = handler;
+				tlb_writehandler(tlb_index) = handler;
 				if (handler->getFlags()&PFLAG_WRITEABLE)
-					paging.tlb.write[tlb_index] = handler->GetHostWritePt(phys_page)-lin_base;
+					tlb_write(tlb_index) = handler->GetHostWritePt(phys_page)-lin_base;
 				else
-					paging.tlb.write[tlb_index] = nullptr;
+					tlb_write(tlb_index) = nullptr;
 			} else {
-				paging.tlb.writehandler[tlb_index] = &foiling_handler;
-				paging.tlb.write[tlb_index] = nullptr;
+				tlb_writehandler(tlb_index) = &foiling_handler;
+				tlb_write(tlb_index) = nullptr;
 			}
+			PAGING_WatchLink(tlb_index);
 		}
 	}
 	
@@ -1190,22 +1482,22 @@ void PAGING_SwitchCPL(bool isUser) {
 			// sv -> us: re -> ee 
 			for(Bitu i = 0; i < paging.kr_links.used; i++) {
 				const tlbentry_t tlb_index = paging.kr_links.entries[i];
-				paging.tlb.readhandler[tlb_index] = &exception_handler;
-				paging.tlb.read[tlb_index] = nullptr;
+				tlb_readhandler(tlb_index) = &exception_handler;
+				tlb_read(tlb_index) = nullptr;
 			}
 		} else {
 			// us -> sv: ee -> re
 			for(Bitu i = 0; i < paging.kr_links.used; i++) {
 				const tlbentry_t tlb_index = paging.kr_links.entries[i];
 				const LinearPt lin_base = LinearPt(tlb_index << 12);
-				const PageNum phys_page = paging.tlb.phys_page[tlb_index] & PHYSPAGE_ADDR;
+				const PageNum phys_page = tlb_phys_page(tlb_index) & PHYSPAGE_ADDR;
 				PageHandler* const handler = MEM_GetPageHandler(phys_page);
 
-				paging.tlb.readhandler[tlb_index] = handler;
+				tlb_readhandler(tlb_index) = handler;
 				if (handler->getFlags()&PFLAG_READABLE)
-					paging.tlb.read[tlb_index] = handler->GetHostReadPt(phys_page)-lin_base;
+					tlb_read(tlb_index) = handler->GetHostReadPt(phys_page)-lin_base;
 				else
-					paging.tlb.read[tlb_index] = nullptr;
+					tlb_read(tlb_index) = nullptr;
 			}
 		}
 	} else { // WP=0
@@ -1214,28 +1506,29 @@ void PAGING_SwitchCPL(bool isUser) {
 			// sv -> us: rw -> re 
 			for(Bitu i = 0; i < paging.ur_links.used; i++) {
 				const tlbentry_t tlb_index = paging.ur_links.entries[i];
-				paging.tlb.writehandler[tlb_index] = &exception_handler;
-				paging.tlb.write[tlb_index] = nullptr;
+				tlb_writehandler(tlb_index) = &exception_handler;
+				tlb_write(tlb_index) = nullptr;
 			}
 		} else {
 			// us -> sv: re -> rw
 			for(Bitu i = 0; i < paging.ur_links.used; i++) {
 				const tlbentry_t tlb_index = paging.ur_links.entries[i];
-				const PageNum phys_page = paging.tlb.phys_page[tlb_index] & PHYSPAGE_ADDR;
+				const PageNum phys_page = tlb_phys_page(tlb_index) & PHYSPAGE_ADDR;
 				const bool dirty = (phys_page & PHYSPAGE_DIRTY) ? true : false;
 				PageHandler* const handler = MEM_GetPageHandler(phys_page);
 
 				if (dirty) {
 					const LinearPt lin_base = LinearPt(tlb_index << 12);
-					paging.tlb.writehandler[tlb_index] = handler;
+					tlb_writehandler(tlb_index) = handler;
 					if (handler->getFlags()&PFLAG_WRITEABLE)
-						paging.tlb.write[tlb_index] = handler->GetHostWritePt(phys_page)-lin_base;
+						tlb_write(tlb_index) = handler->GetHostWritePt(phys_page)-lin_base;
 					else
-						paging.tlb.write[tlb_index] = nullptr;
+						tlb_write(tlb_index) = nullptr;
 				} else {
-					paging.tlb.writehandler[tlb_index] = &foiling_handler;
-					paging.tlb.write[tlb_index] = nullptr;
+					tlb_writehandler(tlb_index) = &foiling_handler;
+					tlb_write(tlb_index) = nullptr;
 				}
+				PAGING_WatchLink(tlb_index);
 			}
 		}
 	}
@@ -1462,9 +1755,11 @@ void POD_Save_CPU_Paging( std::ostream& stream )
 //	WRITE_POD( &paging.wp, paging.wp );
 	WRITE_POD( &paging.base, paging.base );
 
+#if !C_SPARSE_TLB
 	WRITE_POD( &paging.tlb.read, paging.tlb.read );
 	WRITE_POD( &paging.tlb.write, paging.tlb.write );
 	WRITE_POD( &paging.tlb.phys_page, paging.tlb.phys_page );
+#endif
 
 	WRITE_POD( &paging.links, paging.links );
 //	WRITE_POD( &paging.ur_links, paging.ur_links );
@@ -1484,9 +1779,11 @@ void POD_Load_CPU_Paging( std::istream& stream )
 //	READ_POD( &paging.wp, paging.wp );
 	READ_POD( &paging.base, paging.base );
 
+#if !C_SPARSE_TLB
 	READ_POD( &paging.tlb.read, paging.tlb.read );
 	READ_POD( &paging.tlb.write, paging.tlb.write );
 	READ_POD( &paging.tlb.phys_page, paging.tlb.phys_page );
+#endif
 
 	READ_POD( &paging.links, paging.links );
 //	READ_POD( &paging.ur_links, paging.ur_links );
@@ -1502,12 +1799,16 @@ void POD_Load_CPU_Paging( std::istream& stream )
 	paging.links.used = PAGING_LINKS;
 	PAGING_ClearTLB();
 
+#if C_SPARSE_TLB
+	PAGING_InitTLB();
+#else
 	for( int lcv=0; lcv<TLB_SIZE; lcv++ ) {
-		paging.tlb.read[lcv] = nullptr;
-		paging.tlb.write[lcv] = nullptr;
-		paging.tlb.readhandler[lcv] = &init_page_handler;
-		paging.tlb.writehandler[lcv] = &init_page_handler;
+		tlb_read(lcv) = nullptr;
+		tlb_write(lcv) = nullptr;
+		tlb_readhandler(lcv) = &init_page_handler;
+		tlb_writehandler(lcv) = &init_page_handler;
 	}
+#endif
 }
 
 uint8_t PageHandler_HostPtReadB(PageHandler *p,PhysPt addr) {
@@ -1562,3 +1863,117 @@ void PageHandler_HostPtWriteD(PageHandler *p,PhysPt addr,uint32_t val) {
 	}
 }
 
+
+/* number of elements from base+index on that stay within the page and don't wrap the index */
+static Bitu PAGING_StringSpan(const LinearPt base,const uint32_t index,const uint32_t add_mask,const Bits step,const Bitu count) {
+	const Bitu size = (Bitu)(step < 0 ? -step : step);
+	const Bitu offset = (base + index) & 0xfffu;
+	Bitu n;
+
+	if (step > 0) {
+		n = (0x1000u - offset) / size;
+		const uint64_t wrap = ((uint64_t)(add_mask - index) + 1u) / size;
+		if ((uint64_t)n > wrap) n = (Bitu)wrap;
+	}
+	else {
+		if (offset + size > 0x1000u) return 0;
+		n = offset / size + 1u;
+		const Bitu wrap = index / size + 1u;
+		if (n > wrap) n = wrap;
+	}
+
+	return n < count ? n : count;
+}
+
+/* host address of the lowest byte touched by n elements starting at base+index */
+static INLINE HostPt PAGING_StringHostPt(HostPt tlb_addr,const LinearPt base,const uint32_t index,const Bits step,const Bitu n) {
+	LinearPt addr = base + index;
+	if (step < 0) addr -= (LinearPt)((Bitu)(-step) * (n - 1u));
+	return tlb_addr + addr;
+}
+
+Bitu PAGING_StringMove(const LinearPt src_base,uint32_t &src_index,const LinearPt dst_base,uint32_t &dst_index,const uint32_t add_mask,const Bits step,const Bitu count) {
+	Bitu n = PAGING_StringSpan(src_base,src_index,add_mask,step,count);
+	n = PAGING_StringSpan(dst_base,dst_index,add_mask,step,n);
+	if (n == 0) return 0;
+
+	const HostPt src_tlb = get_tlb_read(src_base+src_index);
+	const HostPt dst_tlb = get_tlb_write(dst_base+dst_index);
+	if (src_tlb == NULL || dst_tlb == NULL) return 0;
+
+	const Bitu size = (Bitu)(step < 0 ? -step : step);
+	const Bitu bytes = n * size;
+	HostPt src = PAGING_StringHostPt(src_tlb,src_base,src_index,step,n);
+	HostPt dst = PAGING_StringHostPt(dst_tlb,dst_base,dst_index,step,n);
+
+	if (src + bytes <= dst || dst + bytes <= src) {
+		memcpy(dst,src,bytes);
+	}
+	else {
+		/* overlapping copies have to replicate like the element loop does, e.g. MOVSB with DI=SI+1 */
+		Bitu i;
+		if (step < 0) {
+			src += bytes - size;
+			dst += bytes - size;
+		}
+		switch (size) {
+			case 1:
+				for (i=0;i < n;i++,src+=step,dst+=step) host_writeb(dst,host_readb(src));
+				break;
+			case 2:
+				for (i=0;i < n;i++,src+=step,dst+=step) host_writew(dst,host_readw(src));
+				break;
+			default:
+				for (i=0;i < n;i++,src+=step,dst+=step) host_writed(dst,host_readd(src));
+				break;
+		}
+	}
+
+	src_index = (src_index + (uint32_t)(step * (Bits)n)) & add_mask;
+	dst_index = (dst_index + (uint32_t)(step * (Bits)n)) & add_mask;
+	return n;
+}
+
+Bitu PAGING_StringStore(const LinearPt dst_base,uint32_t &dst_index,const uint32_t add_mask,const Bits step,const Bitu count,const uint32_t val) {
+	const Bitu n = PAGING_StringSpan(dst_base,dst_index,add_mask,step,count);
+	if (n == 0) return 0;
+
+	const HostPt dst_tlb = get_tlb_write(dst_base+dst_index);
+	if (dst_tlb == NULL) return 0;
+
+	HostPt dst = PAGING_StringHostPt(dst_tlb,dst_base,dst_index,step,n);
+	Bitu i;
+	switch (step < 0 ? -step : step) {
+		case 1:
+			memset(dst,(int)(val & 0xffu),n);
+			break;
+		case 2:
+			for (i=0;i < n;i++,dst+=2) host_writew(dst,(uint16_t)val);
+			break;
+		default:
+			for (i=0;i < n;i++,dst+=4) host_writed(dst,val);
+			break;
+	}
+
+	dst_index = (dst_index + (uint32_t)(step * (Bits)n)) & add_mask;
+	return n;
+}
+
+Bitu PAGING_StringLoad(const LinearPt src_base,uint32_t &src_index,const uint32_t add_mask,const Bits step,const Bitu count,uint32_t &val) {
+	const Bitu n = PAGING_StringSpan(src_base,src_index,add_mask,step,count);
+	if (n == 0) return 0;
+
+	const HostPt src_tlb = get_tlb_read(src_base+src_index);
+	if (src_tlb == NULL) return 0;
+
+	/* plain RAM has no side effects on reads, only the last element ends up in the register */
+	const HostPt src = src_tlb + (LinearPt)(src_base + src_index + (uint32_t)(step * (Bits)(n - 1u)));
+	switch (step < 0 ? -step : step) {
+		case 1:  val = host_readb(src); break;
+		case 2:  val = host_readw(src); break;
+		default: val = host_readd(src); break;
+	}
+
+	src_index = (src_index + (uint32_t)(step * (Bits)n)) & add_mask;
+	return n;
+}
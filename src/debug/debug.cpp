@@ -25,6 +25,8 @@
 #include <string.h>
 #include <list>
 #include <vector>
+#include <algorithm>
+#include <set>
 #include <ctype.h>
 #include <fstream>
 #include <iomanip>
@@ -49,6 +51,12 @@ using namespace std;
 #endif
 #include "inout.h"
 #include "paging.h"
+#include "mixer.h"
+#include "bintrace.h"
+#include "cpulog.h"
+#include "hosttime.h"
+#include "hostmem.h"
+#include "tracerec.h"
 #include "shell.h"
 #include "debug_inc.h"
 #include "../cpu/lazyflags.h"
@@ -85,6 +93,9 @@ void GFX_SetTitle(int32_t cycles, int frameskip, Bits timing, bool paused);
 bool pc98_pegc_linear_framebuffer_enabled(void);
 
 bool DEBUG_HaltOnRetrace = false;
+#if (C_DYNREC)
+void CPU_Core_Dynrec_Cache_Reset(void);
+#endif
 
 extern bool                 dos_kernel_disabled;
 extern bool                 is_paused;
@@ -2782,15 +2793,28 @@ bool ParseCommand(char* str) {
 		command = "logcode";
 	}
 
+	if (command == "LOGB") { // Create Cpu binary log file
+		cpuLogType = 4;
+		command = "logcode";
+	}
+
 	if (command == "logcode") { //Shared code between all logs
 		DEBUG_ShowMsg("DEBUG: Starting log\n");
-		cpuLogFile.open("LOGCPU.TXT");
-		if (!cpuLogFile.is_open()) {
-			DEBUG_ShowMsg("DEBUG: Logfile couldn't be created.\n");
-			return false;
+		if (cpuLogType == 4) {
+			if (!CPULOG_Start("LOGCPU.DBL")) {
+				DEBUG_ShowMsg("DEBUG: Logfile couldn't be created.\n");
+				return false;
+			}
+		}
+		else {
+			cpuLogFile.open("LOGCPU.TXT");
+			if (!cpuLogFile.is_open()) {
+				DEBUG_ShowMsg("DEBUG: Logfile couldn't be created.\n");
+				return false;
+			}
+			//Initialize log object
+			cpuLogFile << hex << noshowbase << setfill('0') << uppercase;
 		}
-		//Initialize log object
-		cpuLogFile << hex << noshowbase << setfill('0') << uppercase;
 		cpuLog = true;
 		cpuLogCounter = (int)GetHexValue(found,found);
 
@@ -3798,6 +3822,58 @@ bool ParseCommand(char* str) {
         return true;
     }
 
+#if (C_DYNREC)
+    if (command == "DYNPROF") { // dynrec hot-block profiler
+        std::string sub;
+        stream >> sub;
+
+        if (sub == "ON" || sub == "OFF") {
+            CPU_Core_Dynrec_Profile_Enable(sub == "ON");
+            DEBUG_ShowMsg("Dynrec profiler %s (the translation cache is flushed when the core runs next)\n",sub == "ON" ? "enabled" : "disabled");
+            return true;
+        }
+        if (sub == "RESET") {
+            CPU_Core_Dynrec_Profile_Reset();
+            DEBUG_ShowMsg("Dynrec profiler counters will be reset\n");
+            return true;
+        }
+
+        bool by_execs = false;
+        if (sub == "EXECS") {
+            by_execs = true;
+            sub.clear();
+            stream >> sub;
+        }
+        size_t count = 20;
+        if (!sub.empty()) count = (size_t)strtoul(sub.c_str(),NULL,10);
+        if (count == 0) count = 20;
+
+        DynrecProfileSummary summary;
+        std::vector<DynrecProfileEntry> top;
+        if (!CPU_Core_Dynrec_Profile_Get(summary,top,count,by_execs)) {
+            DEBUG_ShowMsg("Dynrec core has not been initialized\n");
+            return true;
+        }
+
+        DEBUG_BeginPagedContent();
+        DEBUG_ShowMsg("Dynrec profiler: %s\n",summary.enabled ? "enabled" : "disabled");
+        DEBUG_ShowMsg("Host time: exec %.3fms lookup %.3fms (%llu) translate %.3fms (%llu) invalidate %.3fms (%llu blocks)\n",
+            summary.exec_ns / 1e6,summary.lookup_ns / 1e6,(unsigned long long)summary.lookups,
+            summary.translate_ns / 1e6,(unsigned long long)summary.translations,
+            summary.invalidate_ns / 1e6,(unsigned long long)summary.invalidations);
+        DEBUG_ShowMsg("Code page flushes: %llu, invalidations/s: %llu\n",(unsigned long long)summary.page_flushes,
+            (unsigned long long)summary.invalidations_per_sec);
+        DEBUG_ShowMsg("CS:EIP          Linear    Len  Execs       Entries     Host ms    Xlat\n");
+        for (const auto &e : top) {
+            DEBUG_ShowMsg("%04X:%08X  %08X  %4u %-11llu %-11llu %-10.3f %u\n",
+                (unsigned int)e.cs,(unsigned int)e.eip,(unsigned int)e.lin_addr,(unsigned int)e.length,
+                (unsigned long long)e.execs,(unsigned long long)e.entries,e.host_ns / 1e6,(unsigned int)e.translations);
+        }
+        DEBUG_EndPagedContent();
+        return true;
+    }
+#endif
+
     if (command == "INP" || command == "INB") {
         uint16_t port = (uint16_t)GetHexValue(found,found);
         uint8_t r = IO_ReadB(port);
@@ -3848,6 +3924,140 @@ bool ParseCommand(char* str) {
 
 	if (command == "PAGING") {LogPages(found); return true;}
 
+	if (command == "TLBSTAT") {
+		uint64_t flushes,flushes_per_sec;
+		PAGING_GetTLBFlushStats(flushes,flushes_per_sec);
+		DEBUG_ShowMsg("TLB flushes: %llu, flushes/s: %llu\n",(unsigned long long)flushes,(unsigned long long)flushes_per_sec);
+		return true;
+	}
+
+	if (command == "IOSTAT") {
+		std::vector< std::pair<uint64_t,Bitu> > ports;
+		for (Bitu port=0;port < IO_MAX;port++) {
+			const uint64_t hits = (uint64_t)IO_GetSlowPathHits(port,false) + IO_GetSlowPathHits(port,true);
+			if (hits != 0) ports.push_back(std::make_pair(hits,port));
+		}
+		std::sort(ports.begin(),ports.end(),std::greater< std::pair<uint64_t,Bitu> >());
+		if (ports.size() > 16) ports.resize(16);
+		DEBUG_ShowMsg("I/O slow path hits, busiest ports first:\n");
+		for (size_t i=0;i < ports.size();i++) {
+			const Bitu port = ports[i].second;
+			DEBUG_ShowMsg("  %04X: %u reads, %u writes\n",(unsigned int)port,
+				(unsigned int)IO_GetSlowPathHits(port,false),(unsigned int)IO_GetSlowPathHits(port,true));
+		}
+		return true;
+	}
+
+	if (command == "BTRACE") {
+		if (!strncmp(found,"ON",2)) {
+			/* file from [log] "binary trace file", memory range optional after ON */
+			const Section_prop *sect = static_cast<Section_prop *>(control->GetSection("log"));
+			std::string path = sect->Get_string("binary trace file");
+			if (path.empty()) path = "bintrace.dbt";
+			uint32_t base = 0,size = 0;
+			found = trim(found+2);
+			if (*found != 0 && !BINTRACE_ParseRange(found,base,size)) {
+				DEBUG_ShowMsg("Bad memory range, use start-end or start+length\n");
+				return true;
+			}
+			if (BINTRACE_Start(path.c_str(),true,base,size))
+				DEBUG_ShowMsg("Binary trace started, writing to %s\n",path.c_str());
+			else
+				DEBUG_ShowMsg("Binary trace could not open %s\n",path.c_str());
+		}
+		else if (!strncmp(found,"OFF",3)) {
+			BINTRACE_Stop();
+		}
+		else {
+			uint64_t records,dropped;
+			BINTRACE_GetStats(records,dropped);
+			DEBUG_ShowMsg("Binary trace %s, %llu records, %llu dropped\n",BINTRACE_Running() ? "running" : "stopped",
+				(unsigned long long)records,(unsigned long long)dropped);
+		}
+		return true;
+	}
+
+	if (command == "MEMSTAT") {
+		static const char *type_names[MEM_TYPE_MAX] = { "", "ISA", "PCI", "MB" };
+		uint64_t lookups,unmapped,conflicts;
+		MEM_GetSlowPathStats(lookups,unmapped,conflicts);
+		DEBUG_ShowMsg("Memory slow path lookups: %llu, unmapped: %llu, conflicts: %llu\n",
+			(unsigned long long)lookups,(unsigned long long)unmapped,(unsigned long long)conflicts);
+		for (int t=MEM_TYPE_MIN;t < MEM_TYPE_MAX;t++) {
+			const unsigned int slots = MEM_GetCalloutSlots((MEM_Type_t)t);
+			for (unsigned int idx=0;idx < slots;idx++) {
+				MEM_CalloutObject *obj = MEM_GetCallout(MEM_Callout_t_comb((MEM_Type_t)t,idx));
+				if (obj == NULL) continue;
+				if (obj->isInstalled() && obj->resolvecounter != 0)
+					DEBUG_ShowMsg("  %-3s #%-3u page %05X mask %05X: %u pages resolved\n",type_names[t],idx,
+						(unsigned int)obj->m_base,(unsigned int)obj->mem_mask,(unsigned int)obj->resolvecounter);
+				MEM_PutCallout(obj);
+			}
+		}
+		return true;
+	}
+
+	if (command == "HOSTSTAT") {
+		found = trim(found);
+		if (!strncmp(found,"ON",2)) HOSTTIME_Enable(true);
+		else if (!strncmp(found,"OFF",3)) HOSTTIME_Enable(false);
+		if (!hosttime_enabled) {
+			DEBUG_ShowMsg("Host time accounting is off, HOSTSTAT ON starts it\n");
+			return true;
+		}
+
+		double share[HOSTTIME_MAX],other;
+		std::vector<HostTimeEntry> entries;
+		HOSTTIME_GetStats(share,other,entries);
+		DEBUG_ShowMsg("Host time share, averaged over windows of 500ms:\n");
+		for (unsigned int i=0;i < HOSTTIME_MAX;i++)
+			DEBUG_ShowMsg("  %-5s %5.1f%%\n",HOSTTIME_Name(i),share[i] * 100);
+		DEBUG_ShowMsg("  %-5s %5.1f%%\n","other",other * 100);
+		if (entries.size() > 16) entries.resize(16);
+		if (!entries.empty()) DEBUG_ShowMsg("Event handlers and mixer channels, busiest first:\n");
+		for (const HostTimeEntry &e : entries)
+			DEBUG_ShowMsg("  %-5s %5.1f%%  %s\n",HOSTTIME_Name(e.what),e.share * 100,e.name.c_str());
+		return true;
+	}
+
+	if (command == "TIMELINE") {
+		found = trim(found);
+		if (!strncmp(found,"ON",2)) TRACE_Start("");
+		else if (!strncmp(found,"OFF",3)) TRACE_Stop();
+		DEBUG_ShowMsg("Trace recorder is %s\n",trace_recording ? "recording" : "stopped");
+		return true;
+	}
+
+	if (command == "AUDIOSTAT") {
+		MIXER_AudioStats st;
+		MIXER_GetAudioStats(st);
+		DEBUG_ShowMsg("Audio: %uHz, block %u, prebuffer %u, buffered %u frames, latency %.1fms, jitter %.2fms%s\n",
+			(unsigned int)st.rate,(unsigned int)st.blocksize,(unsigned int)st.prebuffer,(unsigned int)st.buffered,
+			st.latency_ms,st.jitter_ms,st.adaptive ? ", adaptive" : "");
+		DEBUG_ShowMsg("Underruns: %u, overrun frames: %u, dropped frames: %u, rate adjust: %dppm\n",
+			(unsigned int)st.underruns,(unsigned int)st.overruns,(unsigned int)st.dropped,(int)st.rate_adjust_ppm);
+		return true;
+	}
+
+	if (command == "HOSTMEM") {
+		HostMemUsage usage;
+		HOSTMEM_GetUsage(usage);
+		uint64_t resident = 0;
+		DEBUG_ShowMsg("Host memory         allocated     resident\n");
+		for (unsigned int i=0;i < HOSTMEM_MAX;i++) {
+			resident += usage.what[i].resident;
+			DEBUG_ShowMsg("  %-12s %10lluKB %10lluKB\n",HOSTMEM_Name(i),
+				(unsigned long long)(usage.what[i].allocated >> 10),(unsigned long long)(usage.what[i].resident >> 10));
+		}
+		if (usage.rss != 0)
+			DEBUG_ShowMsg("Process RSS %lluKB (peak %lluKB), other %lluKB\n",(unsigned long long)(usage.rss >> 10),
+				(unsigned long long)(usage.peak_rss >> 10),(unsigned long long)(usage.rss > resident ? (usage.rss - resident) >> 10 : 0));
+		if (usage.mergeable)
+			DEBUG_ShowMsg("Merged with other instances %lluKB, host merging %s\n",(unsigned long long)(usage.merged >> 10),
+				usage.merging ? "on" : "off");
+		return true;
+	}
+
 	if (command == "CPU") {LogCPUInfo(); return true;}
 
 	if (command == "FPU") {LogFPUInfo(); return true;}
@@ -3981,6 +4191,7 @@ bool ParseCommand(char* str) {
 #if C_HEAVY_DEBUG
 		DEBUG_ShowMsg("LOG [num]                 - Write CPU log file.\n");
 		DEBUG_ShowMsg("LOGS/LOGL/LOGC [num]      - Write short/long/cs:ip-only CPU log file.\n");
+		DEBUG_ShowMsg("LOGB [num]                - Write binary CPU log file (dosbox-x -decodecpulog).\n");
 		DEBUG_ShowMsg("HEAVYLOG                  - Enable/Disable automatic CPU log when DOSBox-X exits.\n");
 		DEBUG_ShowMsg("ZEROPROTECT               - Enable/Disable zero code execution detection.\n");
 #endif
@@ -4017,12 +4228,24 @@ bool ParseCommand(char* str) {
 		DEBUG_ShowMsg("LDT                       - Lists descriptors of the LDT.\n");
 		DEBUG_ShowMsg("IDT                       - Lists descriptors of the IDT.\n");
 		DEBUG_ShowMsg("PAGING [page]             - Display content of page table.\n");
+		DEBUG_ShowMsg("TLBSTAT                   - Display TLB flush statistics.\n");
+		DEBUG_ShowMsg("IOSTAT                    - Display the ports resolved most often by the I/O slow path.\n");
+		DEBUG_ShowMsg("MEMSTAT                   - Display memory slow path lookups per device callout.\n");
+		DEBUG_ShowMsg("AUDIOSTAT                 - Display audio buffering, latency and underrun statistics.\n");
+		DEBUG_ShowMsg("HOSTSTAT [ON|OFF]         - Display host time spent per subsystem, handler and channel.\n");
+		DEBUG_ShowMsg("HOSTMEM                   - Display host memory used per subsystem.\n");
+		DEBUG_ShowMsg("BTRACE [ON [range]|OFF]   - Start/stop the binary I/O and memory trace, or show its status.\n");
+		DEBUG_ShowMsg("TIMELINE [ON|OFF]         - Start/stop the Chrome/Perfetto trace of emulator activity.\n");
 		DEBUG_ShowMsg("EXTEND                    - Toggle additional info.\n");
 		DEBUG_ShowMsg("TIMERIRQ                  - Run the system timer.\n");
 		DEBUG_ShowMsg("TIME [time]               - Display or change the internal time.\n");
 		DEBUG_ShowMsg("DATE [date]               - Display or change the internal date.\n");
 		DEBUG_ShowMsg("VRT                       - Run, then enter debugger at next vertical retrace.\n");
 
+#if (C_DYNREC)
+		DEBUG_ShowMsg("DYNPROF ON/OFF/RESET      - Enable/disable/reset the dynrec hot-block profiler.\n");
+		DEBUG_ShowMsg("DYNPROF [EXECS] [n]       - Show the top n dynrec blocks by host time (or executions).\n");
+#endif
 		DEBUG_ShowMsg("IN[P|W|D] [port]          - I/O port read byte/word/dword.\n");
 		DEBUG_ShowMsg("OUT[P|W|D] [port] [data]  - I/O port write byte/word/dword.\n");
 
@@ -5062,6 +5285,7 @@ bool EMS_GetHandle(Bitu &size,PhysPt &addr,std::string &name,Bitu handle);
 const char *EMS_Type_String(void);
 Bitu EMS_Max_Handles(void);
 bool EMS_Active(void);
+void EMS_GetRemapStats(uint64_t &remaps,uint64_t &remaps_per_sec);
 
 static void LogFNKEY(void) {
     DEBUG_BeginPagedContent();
@@ -5140,6 +5364,12 @@ static void LogEMS(void) {
         }
     }
 
+    {
+        uint64_t remaps,remaps_per_sec;
+        EMS_GetRemapStats(remaps,remaps_per_sec);
+        DEBUG_ShowMsg("EMS remaps: %llu, remaps/s: %llu",(unsigned long long)remaps,(unsigned long long)remaps_per_sec);
+    }
+
     DEBUG_EndPagedContent();
 }
 
@@ -5657,6 +5887,7 @@ void DEBUG_SetupConsole(void) {
 }
 
 void DEBUG_ShutDown(Section * /*sec*/) {
+	CPULOG_Stop();
 	CBreakpoint::DeleteAll();
 	CDebugVar::DeleteAll();
 	if (dbg.win_main != NULL) {
@@ -6074,13 +6305,20 @@ void DEBUG_HeavyWriteLogInstruction(void) {
 bool DEBUG_HeavyIsBreakpoint(void) {
 	if (cpuLog) {
 		if (cpuLogCounter>0) {
-			LogInstruction(SegValue(cs),reg_eip,cpuLogFile);
+			if (cpuLogType == 4) CPULOG_Record();
+			else LogInstruction(SegValue(cs),reg_eip,cpuLogFile);
 			cpuLogCounter--;
 		}
 		if (cpuLogCounter<=0) {
-			cpuLogFile.flush();
-			cpuLogFile.close();
-			DEBUG_ShowMsg("DEBUG: cpu log LOGCPU.TXT created\n");
+			if (cpuLogType == 4) {
+				CPULOG_Stop();
+				DEBUG_ShowMsg("DEBUG: cpu log LOGCPU.DBL created\n");
+			}
+			else {
+				cpuLogFile.flush();
+				cpuLogFile.close();
+				DEBUG_ShowMsg("DEBUG: cpu log LOGCPU.TXT created\n");
+			}
 			cpuLog = false;
 			DEBUG_EnableDebugger();
 			return true;
@@ -6112,8 +6350,14 @@ bool DEBUG_HeavyIsBreakpoint(void) {
 void DEBUG_StopLog(void) {
 	if (cpuLog) {
         cpuLogCounter = 0;
-        cpuLogFile.close();
-        DEBUG_ShowMsg("DEBUG: cpu log LOGCPU.TXT stopped\n");
+        if (cpuLogType == 4) {
+            CPULOG_Stop();
+            DEBUG_ShowMsg("DEBUG: cpu log LOGCPU.DBL stopped\n");
+        }
+        else {
+            cpuLogFile.close();
+            DEBUG_ShowMsg("DEBUG: cpu log LOGCPU.TXT stopped\n");
+        }
         cpuLog = false;
     }
 }
@@ -6174,6 +6418,9 @@ uint32_t DEBUG_GetRegister(int reg) {
 
  void DEBUG_WriteMemory(uint32_t address, uint8_t value) {
      mem_writeb_checked(address, value);
+     // the debugger writing into a watched range is not the guest writing
+     LinearPt hit;
+     PAGING_GetWriteWatchHit(hit);
  }
 
  void DEBUG_Step() {
@@ -6186,6 +6433,67 @@ uint32_t DEBUG_GetRegister(int reg) {
     DEBUG_CheckKeys(KEY_F(5));
  }
 
+ // Execution breakpoints by linear address. Unlike the breakpoint list these do not need the
+ // normal core: the dynamic core checks them in the blocks that contain one.
+ bool debug_exec_breakpoints = false;
+ static std::set<uint32_t> exec_breakpoints;
+ static bool exec_breakpoint_skip = false;    // resuming at a breakpoint runs its instruction once
+ static uint32_t exec_breakpoint_skip_addr = 0;
+
+ bool DEBUG_IsExecBreakpoint(uint32_t linear) {
+     return exec_breakpoints.find(linear) != exec_breakpoints.end();
+ }
+
+ bool DEBUG_ExecBreakpointHit(Bitu linear) {
+     if (exec_breakpoint_skip) {
+         exec_breakpoint_skip = false;
+         if ((uint32_t)linear == exec_breakpoint_skip_addr) return false;
+     }
+     return DEBUG_IsExecBreakpoint((uint32_t)linear);
+ }
+
+#if C_REMOTEDEBUG
+ // the GDB stub sets the execution breakpoints, and resumes through here after one was hit
+ static void DEBUG_SkipExecBreakpoint(uint32_t linear) {
+     exec_breakpoint_skip = debug_exec_breakpoints;
+     exec_breakpoint_skip_addr = linear;
+ }
+#endif
+
+ bool DEBUG_AddExecBreakpoint(uint32_t linear) {
+     DEBUG_ShowMsg("Adding hardware breakpoint %08x", linear);
+     exec_breakpoints.insert(linear);
+     debug_exec_breakpoints = true;
+#if (C_DYNREC)
+     // blocks translated before have no check, translate them again
+     CPU_Core_Dynrec_Cache_Reset();
+#endif
+     return true;
+ }
+
+ bool DEBUG_RemoveExecBreakpoint(uint32_t linear) {
+     DEBUG_ShowMsg("Removing hardware breakpoint %08x", linear);
+     if (exec_breakpoints.erase(linear) == 0) return false;
+     debug_exec_breakpoints = !exec_breakpoints.empty();
+     return true;
+ }
+
+ void DEBUG_ClearExecBreakpoints(void) {
+     exec_breakpoints.clear();
+     debug_exec_breakpoints = false;
+     exec_breakpoint_skip = false;
+ }
+
+ bool DEBUG_AddWatchpoint(uint32_t address, uint32_t len) {
+     DEBUG_ShowMsg("Adding write watchpoint %08x len %u", address, len);
+     return PAGING_AddWriteWatch(address, len);
+ }
+
+ bool DEBUG_RemoveWatchpoint(uint32_t address, uint32_t len) {
+     DEBUG_ShowMsg("Removing write watchpoint %08x len %u", address, len);
+     return PAGING_RemoveWriteWatch(address, len);
+ }
+
 #if C_REMOTEDEBUG
  // Called by the main loop to check and handle GDB commands.
  // Polls the GDB server (non-blocking) and processes any received commands.
@@ -6195,6 +6503,15 @@ uint32_t DEBUG_GetRegister(int reg) {
         return false;
     }
 
+    // A write watchpoint ended the last CPU slice
+    LinearPt watch_addr;
+    if (PAGING_GetWriteWatchHit(watch_addr) && gdbServer->has_client() && !gdb_cpu_paused) {
+        LOG(LOG_REMOTE, LOG_NORMAL)("DEBUG: Write watchpoint hit at 0x%X", (unsigned int)watch_addr);
+        gdbServer->send_watch_reply((uint32_t)watch_addr);
+        gdb_cpu_paused = true;
+        return true;
+    }
+
     // Poll for incoming GDB commands (non-blocking)
     GDBAction action = gdbServer->poll();
 
@@ -6209,6 +6526,7 @@ uint32_t DEBUG_GetRegister(int reg) {
             }
 
             // Execute exactly one instruction
+            DEBUG_SkipExecBreakpoint(eip_before);
             skipFirstInstruction = true;
             mustCompleteInstruction = true;
             DEBUG_Run(1, true);
@@ -6226,6 +6544,7 @@ uint32_t DEBUG_GetRegister(int reg) {
         case GDBAction::CONTINUE:
             LOG(LOG_REMOTE, LOG_DEBUG)("DEBUG: GDB continue request");
             CBreakpoint::ActivateBreakpoints();
+            DEBUG_SkipExecBreakpoint(DEBUG_GetRegister(8));
             gdb_cpu_paused = false;
             return false;  // Continue normal execution
 
@@ -6236,6 +6555,8 @@ uint32_t DEBUG_GetRegister(int reg) {
 
         case GDBAction::DISCONNECT:
             LOG(LOG_REMOTE, LOG_NORMAL)("DEBUG: GDB client disconnected");
+            DEBUG_ClearExecBreakpoints();
+            PAGING_ClearWriteWatches();
             gdb_cpu_paused = false;
             return false;
 
@@ -6266,6 +6587,7 @@ uint32_t DEBUG_GetRegister(int reg) {
      return CBreakpoint::DeleteBreakpoint(seg, off);
  }
 
+
 #if C_REMOTEDEBUG
  // GDB server start/stop functions
  void DEBUG_StartGDBServer(int port) {
@@ -0,0 +1,321 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "dosbox.h"
+
+#if C_DEBUG
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "logging.h"
+#include "regs.h"
+#include "cpu.h"
+#include "paging.h"
+#include "debug.h"
+#include "cpulog.h"
+#include "debug_inc.h"
+#include "../cpu/lazyflags.h"
+
+static_assert(sizeof(CpuLogRecord) == 88, "CpuLogRecord layout changed, bump CPULOG_VERSION");
+
+/* Single producer (emulation thread), single consumer (writer thread), like the binary
+ * access trace. head and tail count records forever and are masked on use. */
+#define CPULOG_RING_RECORDS (1u << 16u)
+
+static CpuLogRecord *cpulog_ring = NULL;
+static std::atomic<uint32_t> cpulog_head{0};
+static std::atomic<uint32_t> cpulog_tail{0};
+
+static FILE *cpulog_fp = NULL;
+static std::thread cpulog_writer;
+static std::atomic<bool> cpulog_writer_run{false};
+
+static uint64_t cpulog_records = 0;
+static uint64_t cpulog_waits = 0;       // times the emulation waited for the writer
+
+void CPULOG_Record(void) {
+    const uint32_t head = cpulog_head.load(std::memory_order_relaxed);
+
+    if ((head - cpulog_tail.load(std::memory_order_acquire)) >= CPULOG_RING_RECORDS) {
+        cpulog_waits++;
+        do {
+            std::this_thread::yield();
+        } while ((head - cpulog_tail.load(std::memory_order_acquire)) >= CPULOG_RING_RECORDS);
+    }
+
+    FillFlags();
+
+    CpuLogRecord &r = cpulog_ring[head & (CPULOG_RING_RECORDS - 1u)];
+    r.count = (uint64_t)cycle_count;
+    r.eip = reg_eip;
+    r.eax = reg_eax;
+    r.ebx = reg_ebx;
+    r.ecx = reg_ecx;
+    r.edx = reg_edx;
+    r.esi = reg_esi;
+    r.edi = reg_edi;
+    r.ebp = reg_ebp;
+    r.esp = reg_esp;
+    r.flags = (uint32_t)reg_flags;
+    r.cr0 = (uint32_t)cpu.cr0;
+    r.cs_base = (uint32_t)SegPhys(cs);
+    r.cs = (uint16_t)SegValue(cs);
+    r.ds = (uint16_t)SegValue(ds);
+    r.es = (uint16_t)SegValue(es);
+    r.fs = (uint16_t)SegValue(fs);
+    r.gs = (uint16_t)SegValue(gs);
+    r.ss = (uint16_t)SegValue(ss);
+    r.code_big = cpu.code.big ? 1 : 0;
+    r.reserved[0] = r.reserved[1] = 0;
+
+    /* straight from the TLB when all of it is on one mapped page */
+    const PhysPt pc = (PhysPt)(r.cs_base + reg_eip);
+    const HostPt tlb_addr = ((pc & 0xfffu) <= (0x1000u - sizeof(r.code))) ? get_tlb_read(pc) : NULL;
+    if (tlb_addr != NULL) {
+        memcpy(r.code,tlb_addr + pc,sizeof(r.code));
+        r.length = (uint8_t)sizeof(r.code);
+    }
+    else {
+        uint8_t n = 0;
+        while (n < sizeof(r.code) && !mem_readb_checked((PhysPt)(pc + n),&r.code[n])) n++;
+        r.length = n;
+    }
+
+    cpulog_head.store(head + 1u,std::memory_order_release);
+    cpulog_records++;
+}
+
+static void CPULOG_WriterThread(void) {
+    for (;;) {
+        /* read the flag first so that the last pass drains whatever was recorded before Stop */
+        const bool stopping = !cpulog_writer_run.load(std::memory_order_acquire);
+        const uint32_t head = cpulog_head.load(std::memory_order_acquire);
+        uint32_t tail = cpulog_tail.load(std::memory_order_relaxed);
+
+        while (tail != head) {
+            const uint32_t idx = tail & (CPULOG_RING_RECORDS - 1u);
+            uint32_t count = head - tail;
+            if (count > (CPULOG_RING_RECORDS - idx)) count = CPULOG_RING_RECORDS - idx;
+
+            fwrite(&cpulog_ring[idx],sizeof(CpuLogRecord),count,cpulog_fp);
+            tail += count;
+            cpulog_tail.store(tail,std::memory_order_release);
+        }
+
+        if (stopping) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+bool CPULOG_Running(void) {
+    return cpulog_fp != NULL;
+}
+
+bool CPULOG_Start(const char *path) {
+    if (CPULOG_Running()) CPULOG_Stop();
+
+    cpulog_fp = fopen(path,"wb");
+    if (cpulog_fp == NULL) {
+        LOG_MSG("CPU log: cannot open '%s': %s",path,strerror(errno));
+        return false;
+    }
+    setvbuf(cpulog_fp,NULL,_IOFBF,1u << 20u);
+
+    CpuLogHeader hdr;
+    memset(&hdr,0,sizeof(hdr));
+    memcpy(hdr.magic,CPULOG_MAGIC,sizeof(hdr.magic));
+    hdr.version = CPULOG_VERSION;
+    hdr.record_size = sizeof(CpuLogRecord);
+    hdr.byte_order = 0x01020304u;
+    fwrite(&hdr,sizeof(hdr),1,cpulog_fp);
+
+    if (cpulog_ring == NULL) cpulog_ring = new CpuLogRecord[CPULOG_RING_RECORDS];
+    cpulog_head.store(0);
+    cpulog_tail.store(0);
+    cpulog_records = 0;
+    cpulog_waits = 0;
+
+    cpulog_writer_run.store(true);
+    cpulog_writer = std::thread(CPULOG_WriterThread);
+    return true;
+}
+
+void CPULOG_Stop(void) {
+    if (!CPULOG_Running()) return;
+
+    cpulog_writer_run.store(false,std::memory_order_release);
+    if (cpulog_writer.joinable()) cpulog_writer.join();
+
+    fclose(cpulog_fp);
+    cpulog_fp = NULL;
+
+    delete[] cpulog_ring;
+    cpulog_ring = NULL;
+
+    LOG_MSG("CPU log: %llu instructions written, waited for the disk %llu times",
+        (unsigned long long)cpulog_records,(unsigned long long)cpulog_waits);
+}
+
+/* ---------- offline decoding ---------- */
+
+struct CpuLogFilter {
+    bool        cs_set = false;
+    uint16_t    cs = 0;
+    uint32_t    eip_lo = 0,eip_hi = 0xFFFFFFFFu;
+    uint32_t    lin_lo = 0,lin_hi = 0xFFFFFFFFu;
+    std::string match;                      // lower case
+    uint64_t    from = 0;
+    uint64_t    count = ~((uint64_t)0u);
+};
+
+static void CPULOG_Lower(std::string &s) {
+    for (auto &c : s) c = (char)tolower((unsigned char)c);
+}
+
+/* "LO-HI" or a single address, hex */
+static bool CPULOG_ParseRange(const char *s,uint32_t &lo,uint32_t &hi) {
+    char *end;
+    lo = (uint32_t)strtoul(s,&end,16);
+    if (end == s) return false;
+    if (*end == 0) {
+        hi = lo;
+        return true;
+    }
+    if (*end != '-') return false;
+    const char *h = end + 1;
+    hi = (uint32_t)strtoul(h,&end,16);
+    return end != h && *end == 0 && hi >= lo;
+}
+
+static bool CPULOG_ParseFilter(const std::string &f,CpuLogFilter &flt) {
+    const size_t eq = f.find('=');
+    if (eq == std::string::npos) return false;
+    std::string key = f.substr(0,eq);
+    const std::string val = f.substr(eq + 1);
+    CPULOG_Lower(key);
+
+    if (key == "cs") {
+        char *end;
+        flt.cs = (uint16_t)strtoul(val.c_str(),&end,16);
+        flt.cs_set = true;
+        return end != val.c_str() && *end == 0;
+    }
+    else if (key == "eip") {
+        return CPULOG_ParseRange(val.c_str(),flt.eip_lo,flt.eip_hi);
+    }
+    else if (key == "lin") {
+        return CPULOG_ParseRange(val.c_str(),flt.lin_lo,flt.lin_hi);
+    }
+    else if (key == "match") {
+        flt.match = val;
+        CPULOG_Lower(flt.match);
+        return !flt.match.empty();
+    }
+    else if (key == "from") {
+        flt.from = strtoull(val.c_str(),NULL,10);
+        return true;
+    }
+    else if (key == "count") {
+        flt.count = strtoull(val.c_str(),NULL,10);
+        return true;
+    }
+    return false;
+}
+
+/* one line in the layout of the LOGL command, without the operand values it reads from live memory */
+static void CPULOG_Print(const CpuLogRecord &r,const char *dline,Bitu size) {
+    char ibytes[64] = "";
+    for (Bitu i = 0;i < size;i++) {
+        char tmp[4];
+        if (i < r.length) sprintf(tmp,"%02X ",r.code[i]);
+        else strcpy(tmp,"?? ");
+        strcat(ibytes,tmp);
+    }
+
+    const uint32_t f = r.flags;
+    printf("%04X:%08X  %-30s  %-21s EAX:%08X EBX:%08X ECX:%08X EDX:%08X ESI:%08X EDI:%08X EBP:%08X ESP:%08X"
+        " DS:%04X ES:%04X FS:%04X GS:%04X SS:%04X CF:%u ZF:%u SF:%u OF:%u AF:%u PF:%u IF:%u TF:%u VM:%u FLG:%08X CR0:%08X\n",
+        r.cs,r.eip,dline,ibytes,r.eax,r.ebx,r.ecx,r.edx,r.esi,r.edi,r.ebp,r.esp,
+        r.ds,r.es,r.fs,r.gs,r.ss,
+        (f & FLAG_CF) ? 1u : 0u,(f & FLAG_ZF) ? 1u : 0u,(f & FLAG_SF) ? 1u : 0u,(f & FLAG_OF) ? 1u : 0u,
+        (f & FLAG_AF) ? 1u : 0u,(f & FLAG_PF) ? 1u : 0u,(f & FLAG_IF) ? 1u : 0u,(f & FLAG_TF) ? 1u : 0u,
+        (f & FLAG_VM) ? 1u : 0u,f,r.cr0);
+}
+
+bool CPULOG_Decode(const std::string &path,const std::vector<std::string> &filters) {
+    CpuLogFilter flt;
+    for (const auto &f : filters) {
+        if (!CPULOG_ParseFilter(f,flt)) {
+            fprintf(stderr,"Bad CPU log filter '%s'\n",f.c_str());
+            return false;
+        }
+    }
+
+    FILE *fp = fopen(path.c_str(),"rb");
+    if (fp == NULL) {
+        fprintf(stderr,"Cannot open '%s': %s\n",path.c_str(),strerror(errno));
+        return false;
+    }
+
+    CpuLogHeader hdr;
+    if (fread(&hdr,sizeof(hdr),1,fp) != 1 || memcmp(hdr.magic,CPULOG_MAGIC,sizeof(hdr.magic)) != 0 ||
+        hdr.version != CPULOG_VERSION || hdr.record_size != sizeof(CpuLogRecord) || hdr.byte_order != 0x01020304u) {
+        fprintf(stderr,"'%s' is not a CPU log of this version and host\n",path.c_str());
+        fclose(fp);
+        return false;
+    }
+
+    std::vector<CpuLogRecord> chunk(4096);
+    uint64_t index = 0,shown = 0;
+    size_t got;
+    while (shown < flt.count && (got = fread(chunk.data(),sizeof(CpuLogRecord),chunk.size(),fp)) > 0) {
+        for (size_t i = 0;i < got && shown < flt.count;i++,index++) {
+            const CpuLogRecord &r = chunk[i];
+            if (index < flt.from) continue;
+            if (flt.cs_set && r.cs != flt.cs) continue;
+            if (r.eip < flt.eip_lo || r.eip > flt.eip_hi) continue;
+            const uint32_t lin = r.cs_base + r.eip;
+            if (lin < flt.lin_lo || lin > flt.lin_hi) continue;
+
+            char dline[200];
+            const Bitu size = DasmI386Bytes(dline,r.code,r.length,r.eip,r.code_big != 0);
+            if (!flt.match.empty()) {
+                std::string low(dline);
+                CPULOG_Lower(low);
+                if (low.find(flt.match) == std::string::npos) continue;
+            }
+
+            CPULOG_Print(r,dline,size);
+            shown++;
+        }
+    }
+
+    fclose(fp);
+    fprintf(stderr,"%llu instructions shown, %llu read\n",(unsigned long long)shown,(unsigned long long)index);
+    return true;
+}
+
+#endif
@@ -654,10 +654,17 @@ static char *addr_to_hex(UINT32 addr, int splitup) {
 
 static PhysPt getbyte_mac;
 static PhysPt startPtr;
+static const uint8_t *getbyte_buf = nullptr;	// DasmI386Bytes
+static Bitu getbyte_buf_len = 0;
 
 static UINT8 getbyte(void) {
     uint8_t c;
 
+	if (getbyte_buf != nullptr) {
+		const Bitu i = (Bitu)(getbyte_mac++ - startPtr);
+		return (i < getbyte_buf_len) ? getbyte_buf[i] : 0xFF;
+	}
+
 	if (!mem_readb_checked(getbyte_mac++,&c))
         return c;
 
@@ -1355,6 +1362,16 @@ Bitu DasmI386(char* buffer, PhysPt pc, uint32_t cur_ip, bool bit32)
 	return getbyte_mac-pc;
 }
 
+/* same from a copy of the instruction bytes instead of guest memory */
+Bitu DasmI386Bytes(char* buffer, const uint8_t* bytes, Bitu len, uint32_t cur_ip, bool bit32)
+{
+	getbyte_buf = bytes;
+	getbyte_buf_len = len;
+	const Bitu size = DasmI386(buffer, 0, cur_ip, bit32);
+	getbyte_buf = nullptr;
+	return size;
+}
+
 int DasmLastOperandSize()
 {
 	return opsize;
@@ -36,6 +36,7 @@
 #include "debug.h"
 #include "debug_inc.h"
 #include "pic.h"
+#include "bintrace.h"
 
 #include <stdexcept>
 #include <exception>
@@ -917,6 +918,8 @@ void LOG::Init() {
     log_int21 = sect->Get_bool("int21") || control->opt_logint21;
     log_fileio = sect->Get_bool("fileio") || control->opt_logfileio;
 
+    BINTRACE_Init();
+
 	/* end of early init logging */
 	do_LOG_stderr = false;
 
@@ -1029,6 +1032,17 @@ void LOG::SetupConfigSection(void) {
     Pbool = sect->Add_bool("fileio",Property::Changeable::Always,false);
     Pbool->Set_help("Log file I/O through INT 21h");
 
+    Pstring = sect->Add_string("binary trace file",Property::Changeable::OnlyAtStart,"");
+    Pstring->Set_help("If set, record I/O port and memory accesses as binary records to this file from startup.\n"
+                      "The file is written by a background thread; decode it with scripts/bintrace-decode.py.");
+
+    Pbool = sect->Add_bool("binary trace io",Property::Changeable::OnlyAtStart,true);
+    Pbool->Set_help("Record I/O port accesses in the binary trace.");
+
+    Pstring = sect->Add_string("binary trace memory",Property::Changeable::OnlyAtStart,"");
+    Pstring->Set_help("Linear address range to record in the binary trace, as hex start-end or start+length (e.g. A0000-AFFFF).\n"
+                      "Only accesses that go through a device page handler (video memory, MMIO, ROM) are seen, plain RAM is not.");
+
 	const char* debuggerrunopt[] = { "debugger", "normal", "watch", nullptr };
 	Pstring = sect->Add_string("debuggerrun",Property::Changeable::OnlyAtStart,"debugger");
 	Pstring->Set_help("The run mode when the DOSBox-X Debugger starts.");
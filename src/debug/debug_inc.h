@@ -117,6 +117,7 @@ extern DBGBlock dbg;
 
 /* Local Debug Stuff */
 Bitu DasmI386(char* buffer, PhysPt pc, uint32_t cur_ip, bool bit32);
+Bitu DasmI386Bytes(char* buffer, const uint8_t* bytes, Bitu len, uint32_t cur_ip, bool bit32);
 int  DasmLastOperandSize(void);
 #endif
 
@@ -284,6 +284,12 @@ void GDBServer::send_stop_reply(int signal) {
     send_packet(reply);
 }
 
+void GDBServer::send_watch_reply(uint32_t addr) {
+    char reply[32];
+    snprintf(reply, sizeof(reply), "T05watch:%08x;", addr);
+    send_packet(reply);
+}
+
 GDBAction GDBServer::process_command(const std::string& cmd) {
     // Handle Ctrl-C interrupt
     if (cmd == "\x03") {
@@ -447,16 +453,26 @@ void GDBServer::handle_breakpoint(const std::string& args) {
     int bp_type = std::stoi(args.substr(1, comma1 - 1));
     uint32_t address = std::stoul(args.substr(comma1 + 1, comma2 - comma1 - 1), nullptr, 16);
 
-    if (bp_type != 0) {  // Only software breakpoints supported
-        send_packet("");
-        return;
-    }
-
     bool success;
-    if (type == 'Z') {
-        success = DEBUG_SetBreakpoint(address);
-    } else {
-        success = DEBUG_RemoveBreakpoint(address);
+    switch (bp_type) {
+        case 0:     // software breakpoint
+            if (type == 'Z') success = DEBUG_SetBreakpoint(address);
+            else success = DEBUG_RemoveBreakpoint(address);
+            break;
+        case 1:     // hardware breakpoint, linear address, works in the dynamic core
+            if (type == 'Z') success = DEBUG_AddExecBreakpoint(address);
+            else success = DEBUG_RemoveExecBreakpoint(address);
+            break;
+        case 2: {   // write watchpoint
+            size_t end = args.find(';', comma2 + 1);
+            uint32_t len = std::stoul(args.substr(comma2 + 1, end == std::string::npos ? std::string::npos : end - comma2 - 1), nullptr, 16);
+            if (type == 'Z') success = DEBUG_AddWatchpoint(address, len);
+            else success = DEBUG_RemoveWatchpoint(address, len);
+            break;
+        }
+        default:    // read and access watchpoints are not supported
+            send_packet("");
+            return;
     }
 
     send_packet(success ? "OK" : "E01");
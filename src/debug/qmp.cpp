@@ -23,18 +23,116 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <condition_variable>
 #include <cstring>
 #include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <unordered_map>
 #include "qmp.h"
 #include "logging.h"
 #include "debug.h"
 #include "hardware.h"
 #include "mouse.h"
+#include "cpu.h"
+#include "pic.h"
+#include "paging.h"
+#include "inout.h"
+#include "mixer.h"
+#include "render.h"
+#include "bios_disk.h"
+#include "hosttime.h"
+#include "tracerec.h"
+#include "framepacing.h"
+#include "hostmem.h"
 
 static QMPServer* qmpServer = nullptr;
 
+// Guest profiler: samples CS:EIP from a PIC event while running, so it sees
+// the guest exactly between two instructions on every core. Start/stop come
+// from the QMP thread and are applied on the main thread.
+#define GUEST_PROF_PMODE    (1ull << 51)
+#define GUEST_PROF_V86      (1ull << 50)
+
+static struct {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, uint64_t> samples;    // mode/cpl:cs:eip -> count
+    uint64_t total = 0;
+    double interval_ms = 1.0;
+    std::atomic<bool> running{false};
+} guest_prof;
+
+static void QMP_GuestProfileSample(Bitu /*val*/) {
+    if (!guest_prof.running.load()) return;
+
+    uint64_t key = (uint64_t)reg_eip | ((uint64_t)SegValue(cs) << 32);
+    if (cpu.pmode) {
+        key |= GUEST_PROF_PMODE | ((uint64_t)(cpu.cpl & 3) << 48);
+        if (GETFLAG(VM)) key |= GUEST_PROF_V86;
+    }
+    {
+        std::lock_guard<std::mutex> lock(guest_prof.mutex);
+        guest_prof.samples[key]++;
+        guest_prof.total++;
+    }
+    PIC_AddEvent(QMP_GuestProfileSample, guest_prof.interval_ms);
+}
+
+// Posted by guest-profile-start, restarts sampling at the current interval
+static void QMP_GuestProfileRestart(Bitu /*val*/) {
+    PIC_RemoveEvents(QMP_GuestProfileSample);
+    if (guest_prof.running.load())
+        PIC_AddEvent(QMP_GuestProfileSample, guest_prof.interval_ms);
+}
+
+static const char* guest_prof_mode(uint64_t key) {
+    static const char* const rings[4] = { "ring0", "ring1", "ring2", "ring3" };
+    if (!(key & GUEST_PROF_PMODE)) return "real";
+    if (key & GUEST_PROF_V86) return "v86";
+    return rings[(key >> 48) & 3];
+}
+
+#if C_DYNREC
+// Dynrec profile snapshot: the block table belongs to the main thread, so
+// query-dynrec-profile posts a request and waits for the dynamic core to
+// collect the counters and hand the copy over.
+static struct {
+    std::mutex mutex;
+    std::condition_variable done;
+    uint64_t requested = 0;
+    uint64_t collected = 0;
+    size_t count = 0;
+    bool by_execs = false;
+    bool valid = false;
+    DynrecProfileSummary summary;
+    std::vector<DynrecProfileEntry> top;
+} dynrec_snap;
+
+static void QMP_DynrecProfileSnapshot(void) {
+    DynrecProfileSummary summary;
+    std::vector<DynrecProfileEntry> top;
+    uint64_t serial;
+    size_t count;
+    bool by_execs;
+    {
+        std::lock_guard<std::mutex> lock(dynrec_snap.mutex);
+        if (dynrec_snap.collected == dynrec_snap.requested) return;
+        serial = dynrec_snap.requested;
+        count = dynrec_snap.count;
+        by_execs = dynrec_snap.by_execs;
+    }
+    const bool valid = CPU_Core_Dynrec_Profile_Get(summary, top, count, by_execs);
+    {
+        std::lock_guard<std::mutex> lock(dynrec_snap.mutex);
+        dynrec_snap.summary = summary;
+        dynrec_snap.top.swap(top);
+        dynrec_snap.valid = valid;
+        dynrec_snap.collected = serial;
+    }
+    dynrec_snap.done.notify_all();
+}
+#endif
+
 // Base64 encoding table
 static const char base64_chars[] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
@@ -237,6 +335,25 @@ std::vector<std::string> QMPServer::extract_array(const std::string& json, const
     return result;
 }
 
+// Returns the nested object stored under key (including braces), or "" if absent
+std::string QMPServer::extract_object(const std::string& json, const std::string& key) {
+    std::string search = "\"" + key + "\"";
+    size_t pos = json.find(search);
+    if (pos == std::string::npos) return "";
+
+    size_t brace = json.find("{", pos);
+    if (brace == std::string::npos) return "";
+
+    int depth = 1;
+    size_t end = brace + 1;
+    while (end < json.size() && depth > 0) {
+        if (json[end] == '{') depth++;
+        else if (json[end] == '}') depth--;
+        end++;
+    }
+    return json.substr(brace, end - brace);
+}
+
 void QMPServer::start() {
     if (running.load()) {
         LOG(LOG_REMOTE, LOG_WARN)("QMP: Server already running");
@@ -417,6 +534,11 @@ void QMPServer::process_command(const std::string& cmd) {
         handle_savestate(cmd);
     } else if (execute == "loadstate") {
         handle_loadstate(cmd);
+    } else if (execute == "memstate-save" || execute == "memstate-load" ||
+               execute == "memstate-persist" || execute == "memstate-delete") {
+        handle_memstate(cmd, execute);
+    } else if (execute == "query-memstates") {
+        handle_query_memstates();
     } else if (execute == "stop") {
         handle_stop();
     } else if (execute == "cont") {
@@ -427,6 +549,30 @@ void QMPServer::process_command(const std::string& cmd) {
         handle_query_status();
     } else if (execute == "debug-break-on-exec") {
         handle_debug_break_on_exec(cmd);
+    } else if (execute == "dynrec-profile") {
+        handle_dynrec_profile(cmd);
+    } else if (execute == "query-dynrec-profile") {
+        handle_query_dynrec_profile(cmd);
+    } else if (execute == "guest-profile-start") {
+        handle_guest_profile_start(cmd);
+    } else if (execute == "guest-profile-stop") {
+        handle_guest_profile_stop(cmd);
+    } else if (execute == "query-tlb-stats") {
+        handle_query_tlb_stats();
+    } else if (execute == "query-io-stats") {
+        handle_query_io_stats(cmd);
+    } else if (execute == "query-audio-stats") {
+        handle_query_audio_stats();
+    } else if (execute == "query-perf") {
+        handle_query_perf();
+    } else if (execute == "trace-start") {
+        handle_trace(cmd, true);
+    } else if (execute == "trace-stop") {
+        handle_trace(cmd, false);
+    } else if (execute == "query-frame-pacing") {
+        handle_query_frame_pacing(cmd);
+    } else if (execute == "query-host-memory") {
+        handle_query_host_memory();
     } else if (execute == "quit" || execute == "system_powerdown") {
         send_success();
         // Don't actually quit DOSBox, just acknowledge
@@ -453,17 +599,42 @@ void QMPServer::handle_query_commands() {
         "{\"name\": \"screendump\"},"
         "{\"name\": \"savestate\"},"
         "{\"name\": \"loadstate\"},"
+        "{\"name\": \"memstate-save\"},"
+        "{\"name\": \"memstate-load\"},"
+        "{\"name\": \"memstate-persist\"},"
+        "{\"name\": \"memstate-delete\"},"
+        "{\"name\": \"query-memstates\"},"
         "{\"name\": \"stop\"},"
         "{\"name\": \"cont\"},"
         "{\"name\": \"system_reset\"},"
-        "{\"name\": \"debug-break-on-exec\"}"
+        "{\"name\": \"debug-break-on-exec\"},"
+        "{\"name\": \"dynrec-profile\"},"
+        "{\"name\": \"query-dynrec-profile\"},"
+        "{\"name\": \"guest-profile-start\"},"
+        "{\"name\": \"guest-profile-stop\"},"
+        "{\"name\": \"query-tlb-stats\"},"
+        "{\"name\": \"query-io-stats\"},"
+        "{\"name\": \"query-audio-stats\"},"
+        "{\"name\": \"query-perf\"},"
+        "{\"name\": \"trace-start\"},"
+        "{\"name\": \"trace-stop\"},"
+        "{\"name\": \"query-frame-pacing\"},"
+        "{\"name\": \"query-host-memory\"}"
     "]}\r\n";
     send_response(response);
 }
 
+static void QMP_InputEventsPosted(Bitu /*val*/) {
+    if (qmpServer != nullptr)
+        qmpServer->process_pending_input_events();
+}
+
 void QMPServer::queue_input_event(const QMPInputEvent& event) {
-    std::lock_guard<std::mutex> lock(input_queue_mutex);
-    input_queue.push(event);
+    {
+        std::lock_guard<std::mutex> lock(input_queue_mutex);
+        input_queue.push(event);
+    }
+    PIC_PostEvent(QMP_InputEventsPosted, 0);
 }
 
 void QMPServer::process_pending_input_events() {
@@ -761,24 +932,12 @@ void QMPServer::handle_screendump(const std::string& cmd) {
     // Trigger screenshot capture
     CAPTURE_TakeScreenshot();
 
-    // Wait for screenshot to complete (poll with timeout)
-    const int timeout_ms = 5000;  // 5 second timeout
-    const int poll_interval_ms = 50;
-    int waited = 0;
-
-    while (CAPTURE_IsScreenshotPending() && waited < timeout_ms) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(poll_interval_ms));
-        waited += poll_interval_ms;
-    }
-
-    if (waited >= timeout_ms) {
+    // Wait for the screenshot writer to finish the file (5 second timeout)
+    if (!CAPTURE_WaitScreenshot(5000)) {
         send_error("GenericError", "Screenshot capture timed out");
         return;
     }
 
-    // Give a little extra time for the path to be set
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
-
     // Get the screenshot path
     std::string screenshot_path = CAPTURE_GetLastScreenshotPath();
     if (screenshot_path.empty()) {
@@ -786,6 +945,11 @@ void QMPServer::handle_screendump(const std::string& cmd) {
         return;
     }
 
+    // Format follows the "screenshot format" setting, tell it by the extension
+    std::string format = "png";
+    size_t dot = screenshot_path.find_last_of('.');
+    if (dot != std::string::npos) format = screenshot_path.substr(dot + 1);
+
     std::ostringstream response;
     if (file.empty()) {
         // Return base64-encoded screenshot data
@@ -801,7 +965,7 @@ void QMPServer::handle_screendump(const std::string& cmd) {
 
         std::string b64 = base64_encode(data);
         response << "{\"return\": {\"data\": \"" << b64 << "\", \"size\": " << data.size()
-                 << ", \"format\": \"png\", \"file\": \"" << screenshot_path << "\"}}\r\n";
+                 << ", \"format\": \"" << format << "\", \"file\": \"" << screenshot_path << "\"}}\r\n";
     } else {
         // Copy to requested file path
         std::ifstream src(screenshot_path, std::ios::binary);
@@ -820,7 +984,7 @@ void QMPServer::handle_screendump(const std::string& cmd) {
         check.close();
 
         response << "{\"return\": {\"file\": \"" << file << "\", \"size\": " << size
-                 << ", \"format\": \"png\"}}\r\n";
+                 << ", \"format\": \"" << format << "\"}}\r\n";
     }
 
     send_response(response.str());
@@ -952,6 +1116,61 @@ void QMPServer::handle_loadstate(const std::string& cmd) {
     }
 }
 
+// Named states in host memory. Clients that restore hundreds of times a run use these instead of
+// savestate/loadstate, the answer comes as soon as the main loop is done with it.
+void QMPServer::handle_memstate(const std::string& cmd, const std::string& execute) {
+    std::string args_str = extract_object(cmd, "arguments");
+
+    std::string slot = extract_string(args_str, "slot");
+    if (slot.empty()) {
+        send_error("GenericError", "Missing required 'slot' argument");
+        return;
+    }
+
+    if (execute == "memstate-save") {
+        SAVESTATE_RequestSaveSlot(slot);
+    } else if (execute == "memstate-load") {
+        SAVESTATE_RequestLoadSlot(slot);
+    } else if (execute == "memstate-delete") {
+        SAVESTATE_RequestDeleteSlot(slot);
+    } else {
+        std::string file = extract_string(args_str, "file");
+        if (file.empty()) {
+            send_error("GenericError", "Missing required 'file' argument");
+            return;
+        }
+        SAVESTATE_RequestPersistSlot(slot, file);
+    }
+
+    std::string error;
+    if (!SAVESTATE_WaitComplete(30000, error)) {
+        send_error("GenericError", "In-memory state operation timed out");
+        return;
+    }
+    if (!error.empty()) {
+        send_error("GenericError", error);
+        return;
+    }
+
+    std::ostringstream response;
+    response << "{\"return\": {\"slot\": \"" << slot << "\"}}\r\n";
+    send_response(response.str());
+}
+
+void QMPServer::handle_query_memstates() {
+    std::vector<std::pair<std::string, size_t>> slots;
+    SAVESTATE_ListSlots(slots);
+
+    std::ostringstream response;
+    response << "{\"return\": [";
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (i) response << ", ";
+        response << "{\"slot\": \"" << slots[i].first << "\", \"bytes\": " << slots[i].second << "}";
+    }
+    response << "]}\r\n";
+    send_response(response.str());
+}
+
 void QMPServer::handle_stop() {
     // Pause the emulator
     if (EMULATOR_IsPaused()) {
@@ -1095,6 +1314,418 @@ void QMPServer::handle_debug_break_on_exec(const std::string& cmd) {
     send_response(response.str());
 }
 
+void QMPServer::handle_dynrec_profile(const std::string& cmd) {
+#if C_DYNREC
+    std::string args_str = extract_object(cmd, "arguments");
+
+    // Start/stop the hot-block profiler and/or clear its counters.
+    // The request is applied the next time the dynamic core runs.
+    bool enable = extract_bool(args_str, "enable", true);
+    bool reset = extract_bool(args_str, "reset", false);
+
+    if (reset) CPU_Core_Dynrec_Profile_Reset();
+    CPU_Core_Dynrec_Profile_Enable(enable);
+
+    std::ostringstream response;
+    response << "{\"return\": {\"enabled\": " << (enable ? "true" : "false")
+             << ", \"reset\": " << (reset ? "true" : "false") << "}}\r\n";
+    send_response(response.str());
+#else
+    (void)cmd;
+    send_error("GenericError", "Dynamic recompiler core not available in this build");
+#endif
+}
+
+void QMPServer::handle_query_dynrec_profile(const std::string& cmd) {
+#if C_DYNREC
+    std::string args_str = extract_object(cmd, "arguments");
+
+    int top_n = extract_int(args_str, "top", 20);
+    if (top_n <= 0) top_n = 20;
+    bool by_execs = extract_string(args_str, "sort") == "execs";
+
+    DynrecProfileSummary summary;
+    std::vector<DynrecProfileEntry> top;
+    {
+        std::unique_lock<std::mutex> lock(dynrec_snap.mutex);
+        const uint64_t serial = ++dynrec_snap.requested;
+        dynrec_snap.count = (size_t)top_n;
+        dynrec_snap.by_execs = by_execs;
+        CPU_Core_Dynrec_Profile_Collect(QMP_DynrecProfileSnapshot);
+        // Nothing is collected while emulation is paused or another core runs
+        if (!dynrec_snap.done.wait_for(lock, std::chrono::seconds(2),
+                [serial] { return dynrec_snap.collected == serial; })) {
+            send_error("GenericError", "The dynamic core is not running, the profile cannot be collected");
+            return;
+        }
+        if (!dynrec_snap.valid) {
+            send_error("GenericError", "Dynamic recompiler core has not been initialized");
+            return;
+        }
+        summary = dynrec_snap.summary;
+        top.swap(dynrec_snap.top);
+    }
+
+    std::ostringstream response;
+    response << "{\"return\": {"
+             << "\"enabled\": " << (summary.enabled ? "true" : "false") << ", "
+             << "\"exec-ns\": " << summary.exec_ns << ", "
+             << "\"lookup-ns\": " << summary.lookup_ns << ", "
+             << "\"translate-ns\": " << summary.translate_ns << ", "
+             << "\"invalidate-ns\": " << summary.invalidate_ns << ", "
+             << "\"lookups\": " << summary.lookups << ", "
+             << "\"translations\": " << summary.translations << ", "
+             << "\"invalidations\": " << summary.invalidations << ", "
+             << "\"page-flushes\": " << summary.page_flushes << ", "
+             << "\"invalidations-per-sec\": " << summary.invalidations_per_sec << ", "
+             << "\"blocks\": [";
+    for (size_t i = 0; i < top.size(); i++) {
+        const DynrecProfileEntry& e = top[i];
+        if (i) response << ", ";
+        response << "{\"cs\": " << e.cs
+                 << ", \"eip\": " << e.eip
+                 << ", \"linear\": " << e.lin_addr
+                 << ", \"length\": " << e.length
+                 << ", \"execs\": " << e.execs
+                 << ", \"entries\": " << e.entries
+                 << ", \"host-ns\": " << e.host_ns
+                 << ", \"translations\": " << e.translations << "}";
+    }
+    response << "]}}\r\n";
+    send_response(response.str());
+#else
+    (void)cmd;
+    send_error("GenericError", "Dynamic recompiler core not available in this build");
+#endif
+}
+
+void QMPServer::handle_guest_profile_start(const std::string& cmd) {
+    std::string args_str = extract_object(cmd, "arguments");
+
+    // Sampling rate in samples per emulated second
+    int rate = extract_int(args_str, "rate", 1000);
+    if (rate < 1) rate = 1;
+    if (rate > 100000) rate = 100000;
+    bool reset = extract_bool(args_str, "reset", true);
+
+    {
+        std::lock_guard<std::mutex> lock(guest_prof.mutex);
+        if (reset) {
+            guest_prof.samples.clear();
+            guest_prof.total = 0;
+        }
+        guest_prof.interval_ms = 1000.0 / rate;
+    }
+    guest_prof.running = true;
+    PIC_PostEvent(QMP_GuestProfileRestart, 0);
+
+    LOG(LOG_REMOTE, LOG_NORMAL)("QMP: guest-profile-start rate=%d", rate);
+
+    std::ostringstream response;
+    response << "{\"return\": {\"running\": true, \"rate\": " << rate
+             << ", \"reset\": " << (reset ? "true" : "false") << "}}\r\n";
+    send_response(response.str());
+}
+
+void QMPServer::handle_guest_profile_stop(const std::string& cmd) {
+    std::string args_str = extract_object(cmd, "arguments");
+
+    // "histogram" returns the hottest addresses, "folded" returns the whole
+    // profile as mode;cs;cs:eip count lines for flamegraph.pl and friends.
+    std::string format = extract_string(args_str, "format");
+    bool folded = format == "folded";
+    if (!format.empty() && !folded && format != "histogram") {
+        send_error("GenericError", "Unknown format: " + format);
+        return;
+    }
+    int top_n = extract_int(args_str, "top", 50);
+    if (top_n <= 0) top_n = 50;
+
+    // The sample event stops rescheduling itself once this is clear
+    guest_prof.running = false;
+
+    std::vector<std::pair<uint64_t, uint64_t>> sorted;
+    uint64_t total;
+    {
+        std::lock_guard<std::mutex> lock(guest_prof.mutex);
+        sorted.assign(guest_prof.samples.begin(), guest_prof.samples.end());
+        total = guest_prof.total;
+    }
+    std::sort(sorted.begin(), sorted.end(),
+        [](const std::pair<uint64_t, uint64_t>& a, const std::pair<uint64_t, uint64_t>& b) {
+            return (a.second != b.second) ? (a.second > b.second) : (a.first < b.first);
+        });
+
+    std::ostringstream response;
+    response << "{\"return\": {\"samples\": " << total << ", ";
+    char buf[64];
+    if (folded) {
+        response << "\"folded\": \"";
+        for (const auto& e : sorted) {
+            const unsigned int seg = (unsigned int)((e.first >> 32) & 0xFFFF);
+            snprintf(buf, sizeof(buf), "%s;%04X;%04X:%08X ", guest_prof_mode(e.first),
+                seg, seg, (unsigned int)(e.first & 0xFFFFFFFF));
+            response << buf << e.second << "\\n";
+        }
+        response << "\"";
+    } else {
+        if (sorted.size() > (size_t)top_n) sorted.resize((size_t)top_n);
+        response << "\"histogram\": [";
+        for (size_t i = 0; i < sorted.size(); i++) {
+            const uint64_t key = sorted[i].first;
+            if (i) response << ", ";
+            response << "{\"cs\": " << ((key >> 32) & 0xFFFF)
+                     << ", \"eip\": " << (key & 0xFFFFFFFF)
+                     << ", \"mode\": \"" << guest_prof_mode(key) << "\""
+                     << ", \"cpl\": " << ((key >> 48) & 3)
+                     << ", \"v86\": " << ((key & GUEST_PROF_V86) ? "true" : "false")
+                     << ", \"count\": " << sorted[i].second << "}";
+        }
+        response << "]";
+    }
+    response << "}}\r\n";
+    send_response(response.str());
+}
+
+void QMPServer::handle_query_tlb_stats() {
+    uint64_t flushes, flushes_per_sec;
+    PAGING_GetTLBFlushStats(flushes, flushes_per_sec);
+
+    std::ostringstream response;
+    response << "{\"return\": {"
+             << "\"flushes\": " << flushes << ", "
+             << "\"flushes-per-sec\": " << flushes_per_sec << "}}\r\n";
+    send_response(response.str());
+}
+
+void QMPServer::handle_query_io_stats(const std::string& cmd) {
+    std::string args_str = extract_object(cmd, "arguments");
+
+    int top_n = extract_int(args_str, "top", 20);
+    if (top_n <= 0) top_n = 20;
+
+    uint64_t total_reads = 0, total_writes = 0;
+    std::vector<std::pair<uint64_t, Bitu>> ports;
+    for (Bitu port = 0; port < IO_MAX; port++) {
+        const uint32_t reads = IO_GetSlowPathHits(port, false);
+        const uint32_t writes = IO_GetSlowPathHits(port, true);
+        total_reads += reads;
+        total_writes += writes;
+        if (reads || writes) ports.push_back(std::make_pair((uint64_t)reads + writes, port));
+    }
+    std::sort(ports.begin(), ports.end(), std::greater<std::pair<uint64_t, Bitu>>());
+    if (ports.size() > (size_t)top_n) ports.resize((size_t)top_n);
+
+    std::ostringstream response;
+    response << "{\"return\": {"
+             << "\"slow-reads\": " << total_reads << ", "
+             << "\"slow-writes\": " << total_writes << ", "
+             << "\"ports\": [";
+    for (size_t i = 0; i < ports.size(); i++) {
+        const Bitu port = ports[i].second;
+        if (i) response << ", ";
+        response << "{\"port\": " << port
+                 << ", \"reads\": " << IO_GetSlowPathHits(port, false)
+                 << ", \"writes\": " << IO_GetSlowPathHits(port, true) << "}";
+    }
+    response << "]}}\r\n";
+    send_response(response.str());
+}
+
+void QMPServer::handle_query_audio_stats() {
+    MIXER_AudioStats st;
+    MIXER_GetAudioStats(st);
+
+    char buf[64];
+    std::ostringstream response;
+    response << "{\"return\": {"
+             << "\"adaptive\": " << (st.adaptive ? "true" : "false") << ", "
+             << "\"rate\": " << st.rate << ", "
+             << "\"blocksize\": " << st.blocksize << ", "
+             << "\"prebuffer\": " << st.prebuffer << ", "
+             << "\"buffered\": " << st.buffered << ", ";
+    snprintf(buf, sizeof(buf), "\"latency-ms\": %.3f, \"jitter-ms\": %.3f, ", st.latency_ms, st.jitter_ms);
+    response << buf
+             << "\"rate-adjust-ppm\": " << st.rate_adjust_ppm << ", "
+             << "\"underruns\": " << st.underruns << ", "
+             << "\"overruns\": " << st.overruns << ", "
+             << "\"dropped\": " << st.dropped << "}}\r\n";
+    send_response(response.str());
+}
+
+/* Host memory per subsystem. "other" is what the process has resident beyond the subsystems:
+ * code, libraries, the output surfaces and the heap of everything not broken out. */
+void QMPServer::handle_query_host_memory() {
+    HostMemUsage usage;
+    HOSTMEM_GetUsage(usage);
+
+    uint64_t resident = 0;
+    std::ostringstream response;
+    response << "{\"return\": {\"subsystems\": {";
+    for (unsigned int i = 0; i < HOSTMEM_MAX; i++) {
+        resident += usage.what[i].resident;
+        response << (i ? ", " : "") << "\"" << HOSTMEM_Name(i) << "\": {"
+                 << "\"allocated\": " << usage.what[i].allocated << ", "
+                 << "\"resident\": " << usage.what[i].resident << "}";
+    }
+    response << "}, "
+             << "\"rss\": " << usage.rss << ", "
+             << "\"peak-rss\": " << usage.peak_rss << ", "
+             << "\"other\": " << (usage.rss > resident ? usage.rss - resident : 0) << ", "
+             << "\"merge\": {\"mergeable\": " << (usage.mergeable ? "true" : "false") << ", "
+             << "\"merging\": " << (usage.merging ? "true" : "false") << ", "
+             << "\"merged\": " << usage.merged << "}}}\r\n";
+    send_response(response.str());
+}
+
+/* One call for the counters a monitoring client wants every second. Everything is a plain
+ * counter read, the rates are taken against the previous call. */
+void QMPServer::handle_query_perf() {
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t cycles = CPU_CyclesTotal;
+    const uint64_t frames = render_frames_rendered;
+    const Bitu ticks = PIC_Ticks;
+
+    double interval = 0, cycles_per_sec = 0, fps = 0, speed = 0;
+    if (perf_have_last) {
+        interval = std::chrono::duration<double>(now - perf_last_time).count();
+        if (interval > 0) {
+            cycles_per_sec = (double)(cycles - perf_last_cycles) / interval;
+            fps = (double)(frames - perf_last_frames) / interval;
+            speed = (double)(ticks - perf_last_ticks) / (interval * 1000.0);
+        }
+    }
+    perf_have_last = true;
+    perf_last_time = now;
+    perf_last_cycles = cycles;
+    perf_last_frames = frames;
+    perf_last_ticks = ticks;
+
+    uint64_t tlb_flushes, tlb_flushes_per_sec;
+    PAGING_GetTLBFlushStats(tlb_flushes, tlb_flushes_per_sec);
+
+    MIXER_AudioStats audio;
+    MIXER_GetAudioStats(audio);
+
+    double share[HOSTTIME_MAX], other;
+    HOSTTIME_GetShares(share, other);
+
+    char buf[160];
+    std::ostringstream response;
+    snprintf(buf, sizeof(buf), "\"interval-ms\": %.1f, \"cycles-per-sec\": %.0f, \"mips\": %.3f, \"emulated-speed\": %.3f, ",
+        interval * 1000.0, cycles_per_sec, cycles_per_sec / 1000000.0, speed);
+    response << "{\"return\": {" << buf
+             << "\"cycles\": " << cycles << ", "
+             << "\"cycle-max\": " << (int64_t)CPU_CycleMax << ", "
+             << "\"cycles-auto\": " << (CPU_CycleAutoAdjust ? "true" : "false") << ", "
+             << "\"emulated-ms\": " << (uint64_t)ticks << ", ";
+    snprintf(buf, sizeof(buf), "\"fps\": %.2f, ", fps);
+    response << "\"frames-rendered\": " << frames << ", "
+             << "\"frames-skipped\": " << render_frames_skipped << ", " << buf
+             << "\"audio-underruns\": " << audio.underruns << ", "
+             << "\"pic-queue-depth\": " << PIC_QueueDepth() << ", "
+             << "\"tlb-flushes\": " << tlb_flushes << ", "
+             << "\"tlb-flushes-per-sec\": " << tlb_flushes_per_sec << ", "
+             << "\"disk-bytes-read\": " << disk_io_bytes_read << ", "
+             << "\"disk-bytes-written\": " << disk_io_bytes_written << ", "
+             << "\"dynrec\": ";
+#if C_DYNREC
+    DynrecCacheStats dynrec;
+    if (CPU_Core_Dynrec_GetCacheStats(dynrec)) {
+        response << "{\"pages-used\": " << dynrec.pages_used
+                 << ", \"pages-total\": " << dynrec.pages_total
+                 << ", \"page-flushes\": " << dynrec.page_flushes
+                 << ", \"wraps\": " << dynrec.wraps
+                 << ", \"resets\": " << dynrec.resets << "}";
+    } else {
+        response << "null";
+    }
+#else
+    response << "null";
+#endif
+    static const char *const host_time_names[HOSTTIME_MAX] = {
+        "cpu", "events", "vga", "render", "output", "mixer", "disk", "idle"
+    };
+    response << ", \"host-time\": {\"enabled\": " << (hosttime_enabled ? "true" : "false");
+    for (unsigned int i = 0; i < HOSTTIME_MAX; i++) {
+        snprintf(buf, sizeof(buf), ", \"%s\": %.4f", host_time_names[i], share[i]);
+        response << buf;
+    }
+    snprintf(buf, sizeof(buf), ", \"other\": %.4f", other);
+    response << buf << "}}}\r\n";
+    send_response(response.str());
+}
+
+// The recorder runs on the main thread, the request is applied there before the next
+// CPU slice. Without a "file" the trace goes to the capture directory.
+void QMPServer::handle_trace(const std::string& cmd, bool start) {
+    std::string file;
+    if (start) {
+        std::string args_str = extract_object(cmd, "arguments");
+        file = extract_string(args_str, "file");
+    }
+    TRACE_Request(start, file);
+    send_success();
+}
+
+// Percentiles are the upper edge of the bucket they fall in, the last bucket has no upper edge
+static void QMP_WriteFramePacingHistogram(std::ostringstream& response, const char *name, const uint32_t *hist, double bucket_ms) {
+    uint64_t total = 0;
+    unsigned int last = 0;
+    for (unsigned int i = 0; i < FRAMEPACE_BUCKETS; i++) {
+        total += hist[i];
+        if (hist[i] != 0) last = i + 1;
+    }
+
+    static const double pct[3] = { 0.50, 0.95, 0.99 };
+    static const char *const pct_names[3] = { "p50", "p95", "p99" };
+    char buf[64];
+
+    response << "\"" << name << "\": {\"count\": " << total;
+    snprintf(buf, sizeof(buf), ", \"bucket-ms\": %.2f", bucket_ms);
+    response << buf;
+    for (unsigned int p = 0; p < 3; p++) {
+        if (total == 0) {
+            response << ", \"" << pct_names[p] << "-ms\": null";
+            continue;
+        }
+        const uint64_t want = (uint64_t)(pct[p] * (double)total + 0.999999);
+        uint64_t sum = 0;
+        unsigned int i = 0;
+        while (i < FRAMEPACE_BUCKETS - 1 && (sum += hist[i]) < want) i++;
+        snprintf(buf, sizeof(buf), ", \"%s-ms\": %.2f", pct_names[p], (double)(i + 1) * bucket_ms);
+        response << buf;
+    }
+    response << ", \"buckets\": [";
+    for (unsigned int i = 0; i < last; i++)
+        response << (i != 0 ? ", " : "") << hist[i];
+    response << "]}";
+}
+
+void QMPServer::handle_query_frame_pacing(const std::string& cmd) {
+    std::string args_str = extract_object(cmd, "arguments");
+    bool reset = extract_bool(args_str, "reset", false);
+
+    FramePacingStats st;
+    FRAMEPACE_GetStats(st);
+    if (reset) FRAMEPACE_Reset();
+
+    char buf[64];
+    std::ostringstream response;
+    snprintf(buf, sizeof(buf), "\"period-ms\": %.3f, ", st.period_ms);
+    response << "{\"return\": {" << buf
+             << "\"retraces\": " << st.retraces << ", "
+             << "\"presents\": " << st.presents << ", "
+             << "\"missed\": " << st.missed << ", ";
+    QMP_WriteFramePacingHistogram(response, "retrace-interval", st.retrace_interval, FRAMEPACE_INTERVAL_BUCKET);
+    response << ", ";
+    QMP_WriteFramePacingHistogram(response, "present-interval", st.present_interval, FRAMEPACE_INTERVAL_BUCKET);
+    response << ", ";
+    QMP_WriteFramePacingHistogram(response, "present-latency", st.present_latency, FRAMEPACE_LATENCY_BUCKET);
+    response << "}}\r\n";
+    send_response(response.str());
+}
+
 // Public interface
 void QMP_StartServer(int port) {
     if (qmpServer != nullptr) {
@@ -1118,10 +1749,4 @@ bool QMP_IsServerRunning() {
     return qmpServer != nullptr && qmpServer->is_running();
 }
 
-void QMP_ProcessPendingInputEvents() {
-    if (qmpServer != nullptr) {
-        qmpServer->process_pending_input_events();
-    }
-}
-
 #endif /* C_REMOTEDEBUG */
@@ -30,6 +30,9 @@
 #include <sstream>
 #if !defined(HX_DOS) && !(defined(__MINGW32__) && !defined(__MINGW64_VERSION_MAJOR))
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#define CDROM_AUDIO_READAHEAD 1
 #endif
 
 #include "mem.h"
@@ -37,6 +40,8 @@
 #include "../libs/decoders/SDL_sound.h"
 #include "../libs/libchdr/chd.h"
 
+class CHDHunkCache;
+
 #if defined(C_SDL2) /* SDL 1.x defines this, SDL 2.x does not */
 /** @name Frames / MSF Conversion Functions
  *  Conversion functions from frames to Minute/Second/Frames and vice versa
@@ -245,6 +250,10 @@ private:
 		virtual uint8_t    getChannels() = 0;
 		virtual int64_t    getLength() = 0;
 		virtual void setAudioPosition(uint32_t pos) = 0;
+		//! \brief Start producing audio at a Red Book byte offset in the background, if supported
+		virtual void prefetch(int64_t offset) { (void)offset; }
+		//! \brief Whether decode() can be called without waiting on the codec
+		virtual bool ready() { return true; }
 		const uint16_t chunkSize = 0;
 		uint32_t audio_pos = UINT32_MAX; // last position when playing audio
 	};
@@ -269,6 +278,14 @@ private:
 		void setAudioPosition(uint32_t pos) override { audio_pos = pos; }
 	private:
 		std::ifstream   *file;
+		/* Data read-ahead. While reads run sequentially the window doubles up to
+		 * BINARYFILE_READAHEAD_MAX, a jump elsewhere drops back to direct reads. */
+		bool            readAhead(uint8_t *buffer, int64_t offset, int count);
+		std::vector<uint8_t> ra_buffer;
+		int64_t         ra_start          = -1;    // image offset of ra_buffer[0], -1 if empty
+		size_t          ra_valid          = 0;     // bytes of ra_buffer holding data
+		int64_t         ra_next           = -1;    // end of the previous read
+		size_t          ra_window         = 0;     // bytes to read on the next miss, 0 = direct
 	};
 
 	class AudioFile : public TrackFile {
@@ -288,8 +305,29 @@ private:
 		uint8_t           getChannels() override;
 		int64_t           getLength() override;
         void setAudioPosition(uint32_t pos) override { (void)pos;/*unused*/ }
+#if defined(CDROM_AUDIO_READAHEAD)
+		void            prefetch(int64_t offset) override { seek(offset); }
+		bool            ready() override;
+#endif
 	private:
 		Sound_Sample    *sample = nullptr;
+#if defined(CDROM_AUDIO_READAHEAD)
+		/* Read-ahead decoder. The worker owns the Sound_Sample and keeps
+		 * ring[] filled with PCM starting at Red Book offset window_start.
+		 * Everything below is protected by ring_mutex. */
+		void            decodeThread();
+		std::thread*    decode_thread     = nullptr;
+		std::mutex      ring_mutex;
+		std::condition_variable ring_cond;
+		std::vector<uint8_t> ring;
+		uint64_t        ring_read         = 0;     // bytes consumed
+		uint64_t        ring_write        = 0;     // bytes decoded
+		int64_t         window_start      = -1;    // Red Book offset of ring_read, -1 if unknown
+		int64_t         seek_target       = -1;    // pending seek for the worker, -1 if none
+		uint32_t        seek_generation   = 0;
+		bool            decode_eof        = true;
+		bool            decode_quit       = false;
+#endif
 	};
 
     class CHDFile : public TrackFile {
@@ -313,17 +351,7 @@ private:
     private:
               chd_file*   chd               = nullptr;
         const chd_header* header            = nullptr; // chd header
-                /*
-                    TODO: cache more than one hunk
-                    or wait for https://github.com/rtissera/libchdr/issues/36
-                */
-              uint8_t*     hunk_buffer       = nullptr; // buffer to hold one hunk // size of hunks in CHD up to 1 MiB
-              uint8_t*     hunk_buffer_next  = nullptr; // index + 1 prefetch
-              int          hunk_buffer_index = -1;      // hunk index for buffer
-#if !defined(HX_DOS) && !(defined(__MINGW32__) && !defined(__MINGW64_VERSION_MAJOR))
-              std::thread* hunk_thread       = nullptr; // used for prefetch
-              bool         hunk_thread_error = true;
-#endif
+              CHDHunkCache* hunk_cache      = nullptr; // decompressed hunks, see chd_hunk_cache.h
     public:
               bool         skip_sync         = false;   // this will fail if a CHD contains 2048 and 2352 sector tracks
      };
@@ -17,6 +17,7 @@
  */
 
 #include "cdrom.h"
+#include <algorithm>
 #include <cassert>
 #include <cctype>
 #include <chrono>
@@ -42,6 +43,8 @@
 #define IS_BIGENDIAN false
 #endif
 
+#include "chd_hunk_cache.h"
+#include "hostmem.h"
 #include "cross.h"
 #include "drives.h"
 #include "logging.h"
@@ -140,14 +143,55 @@ CDROM_Interface_Image::BinaryFile::~BinaryFile()
 	file = nullptr;
 }
 
+#define BINARYFILE_READAHEAD_MIN (32u*1024u)
+#define BINARYFILE_READAHEAD_MAX (512u*1024u)
+
 bool CDROM_Interface_Image::BinaryFile::read(uint8_t *buffer,int64_t offset, int count)
 {
+	if (count <= 0) return count == 0;
+
+	/* Sequential means starting at or just past the end of the previous read: cooked reads
+	 * from a raw image skip the sector header and trailer between sectors. */
+	const bool sequential = ra_next >= 0 && offset >= ra_next && (offset - ra_next) <= RAW_SECTOR_SIZE;
+	ra_next = offset + count;
+
+	if (ra_start >= 0 && offset >= ra_start && (offset + count) <= (ra_start + (int64_t)ra_valid)) {
+		memcpy(buffer, &ra_buffer[(size_t)(offset - ra_start)], (size_t)count);
+		return true;
+	}
+
+	if (sequential)
+		ra_window = std::min(std::max(ra_window * 2u, (size_t)BINARYFILE_READAHEAD_MIN), (size_t)BINARYFILE_READAHEAD_MAX);
+	else
+		ra_window = 0;
+
+	if (ra_window > (size_t)count)
+		return readAhead(buffer, offset, count);
+
     if (!seek(offset)) return false;
 	file->seekg((streampos)offset, ios::beg);
 	file->read((char*)buffer, count);
 	return !(file->fail());
 }
 
+bool CDROM_Interface_Image::BinaryFile::readAhead(uint8_t *buffer, int64_t offset, int count)
+{
+	ra_start = -1;
+	ra_valid = 0;
+	if (!seek(offset)) return false;
+
+	ra_buffer.resize(ra_window);
+	file->read((char*)&ra_buffer[0], (streamsize)ra_window);
+	const size_t got = (size_t)file->gcount();
+	if (file->fail()) file->clear(); /* short read at the end of the image */
+	if (got < (size_t)count) return false;
+
+	ra_start = offset;
+	ra_valid = got;
+	memcpy(buffer, &ra_buffer[0], (size_t)count);
+	return true;
+}
+
 int64_t CDROM_Interface_Image::BinaryFile::getLength()
 {
 	file->seekg(0, ios::end);
@@ -211,6 +255,19 @@ CDROM_Interface_Image::AudioFile::AudioFile(const char *filename, bool &error)
 
 CDROM_Interface_Image::AudioFile::~AudioFile()
 {
+#if defined(CDROM_AUDIO_READAHEAD)
+	if (decode_thread) {
+		{
+			std::lock_guard<std::mutex> lock(ring_mutex);
+			decode_quit = true;
+		}
+		ring_cond.notify_all();
+		decode_thread->join();
+		delete decode_thread;
+		decode_thread = nullptr;
+	}
+#endif
+
 	// Guard to prevent double-free or nullptr free
 	if (sample == nullptr)
 		return;
@@ -230,9 +287,45 @@ CDROM_Interface_Image::AudioFile::~AudioFile()
  *  within the track, regardless of the track's sampling rate, bit-depth,
  *  or number of channels.  To do this, we convert the byte offset to a
  *  time-offset, and use the Sound_Seek() function to move the read position.
+ *
+ *  With read-ahead, the seek is handed to the decode thread instead and
+ *  always succeeds here; seeks that land inside the PCM already decoded
+ *  (such as the start of a prefetched track) just drop the bytes before it.
  */
 bool CDROM_Interface_Image::AudioFile::seek(int64_t offset)
 {
+#if defined(CDROM_AUDIO_READAHEAD)
+	if (sample == nullptr)
+		return false;
+
+	std::unique_lock<std::mutex> lock(ring_mutex);
+	if (seek_target == offset)
+		return true;
+
+	if (seek_target < 0 && window_start >= 0 && offset >= window_start) {
+		const uint64_t skip = (uint64_t)(offset - window_start);
+		const bool redbook = sample->actual.rate == 44100 && sample->actual.channels == 2;
+		if ((skip == 0 || (redbook && (skip & 3) == 0)) && skip <= (ring_write - ring_read)) {
+			ring_read += skip;
+			window_start = offset;
+			audio_pos = (uint32_t)offset;
+			lock.unlock();
+			ring_cond.notify_all();
+			return true;
+		}
+	}
+
+	seek_target = offset;
+	seek_generation++;
+	audio_pos = (uint32_t)offset;
+	if (decode_thread == nullptr) {
+		ring.resize(256 * 1024); // about 1.5 seconds of Red Book audio
+		decode_thread = new std::thread([this]() { decodeThread(); });
+	}
+	lock.unlock();
+	ring_cond.notify_all();
+	return true;
+#else
 	#ifdef DEBUG
 	const auto begin = std::chrono::steady_clock::now();
 	#endif
@@ -254,10 +347,92 @@ bool CDROM_Interface_Image::AudioFile::seek(int64_t offset)
 	#endif
 
 	return result;
+#endif
 }
 
+#if defined(CDROM_AUDIO_READAHEAD)
+void CDROM_Interface_Image::AudioFile::decodeThread()
+{
+	std::unique_lock<std::mutex> lock(ring_mutex);
+	while (!decode_quit) {
+		if (seek_target >= 0) {
+			const int64_t target = seek_target;
+			const uint32_t generation = seek_generation;
+			lock.unlock();
+			// Convert the byte-offset to a time offset (milliseconds)
+			const bool result = Sound_Seek(sample, lround(target/176.4f)) != 0;
+			lock.lock();
+			if (generation != seek_generation)
+				continue; // superseded while seeking
+
+			seek_target = -1;
+			ring_read = ring_write = 0;
+			window_start = target;
+			decode_eof = !result;
+			ring_cond.notify_all();
+			continue;
+		}
+
+		if (decode_eof || (ring_write - ring_read) + chunkSize > ring.size()) {
+			ring_cond.wait(lock);
+			continue;
+		}
+
+		const uint32_t generation = seek_generation;
+		lock.unlock();
+		const uint32_t bytes = Sound_Decode(sample);
+		lock.lock();
+		if (generation != seek_generation)
+			continue;
+
+		const size_t at = (size_t)(ring_write % ring.size());
+		const size_t first = std::min((size_t)bytes, ring.size() - at);
+		memcpy(&ring[at], sample->buffer, first);
+		memcpy(&ring[0], (const uint8_t*)sample->buffer + first, bytes - first);
+		ring_write += bytes;
+		if (bytes == 0 || (sample->flags & (SOUND_SAMPLEFLAG_EOF | SOUND_SAMPLEFLAG_ERROR)))
+			decode_eof = true;
+		ring_cond.notify_all();
+	}
+}
+
+bool CDROM_Interface_Image::AudioFile::ready()
+{
+	if (decode_thread == nullptr)
+		return true;
+
+	std::lock_guard<std::mutex> lock(ring_mutex);
+	return seek_target < 0 && (decode_eof || (ring_write - ring_read) >= AUDIO_DECODE_BUFFER_SIZE);
+}
+#endif
+
 uint16_t CDROM_Interface_Image::AudioFile::decode(uint8_t *buffer)
 {
+#if defined(CDROM_AUDIO_READAHEAD)
+	if (decode_thread != nullptr) {
+		std::unique_lock<std::mutex> lock(ring_mutex);
+		while (!decode_quit && (seek_target >= 0 || (!decode_eof && (ring_write - ring_read) < chunkSize)))
+			ring_cond.wait(lock);
+
+		const uint16_t bytes = (uint16_t)std::min((uint64_t)chunkSize, ring_write - ring_read);
+		const size_t at = (size_t)(ring_read % ring.size());
+		const size_t first = std::min((size_t)bytes, ring.size() - at);
+		memcpy(buffer, &ring[at], first);
+		memcpy(buffer + first, &ring[0], bytes - first);
+		ring_read += bytes;
+		if (window_start >= 0) {
+			if (sample->actual.rate == 44100 && sample->actual.channels == 2)
+				window_start += bytes;
+			else
+				window_start = -1;
+		}
+		audio_pos += bytes;
+		lock.unlock();
+		ring_cond.notify_all();
+		return bytes;
+	}
+#endif
+
 	const uint16_t bytes = Sound_Decode(sample);
     audio_pos += bytes;
 	memcpy(buffer, sample->buffer, bytes);
@@ -306,47 +481,144 @@ int64_t CDROM_Interface_Image::AudioFile::getLength()
 	return length;
 }
 
+int chd_cache_size = 4096; /* KB */
+int chd_prefetch_hunks = 4;
+
+CHDHunkCache::CHDHunkCache(chd_file *chd, const char *filename) : chd(chd), filename(filename)
+{
+    const chd_header *header = chd_get_header(chd);
+    hunk_bytes  = header->hunkbytes;
+    total_hunks = header->totalhunks;
+    prefetch    = (unsigned int)std::max(chd_prefetch_hunks, 0);
+    capacity    = ((size_t)std::max(chd_cache_size, 0) * 1024u) / std::max(hunk_bytes, 1u);
+    // room for the hunk being read plus everything prefetched after it
+    capacity    = std::max(capacity, (size_t)prefetch + 2u);
+}
+
+CHDHunkCache::~CHDHunkCache()
+{
+    tasks.wait();
+    for (auto handle : spare)
+        chd_close(handle);
+    HOSTMEM_Count(HOSTMEM_IMAGECACHE, -(int64_t)(lru.size() * hunk_bytes));
+}
+
+/* take a hunk for the given index: a new one, or the least recently used one that no prefetch task
+ * owns. The most recently used hunk is never taken, GetHunk() is about to hand it out. Prefetched
+ * hunks go right behind it so that it stays in front. */
+std::list<CHDHunkCache::Hunk>::iterator CHDHunkCache::Allocate(uint32_t hunk, bool prefetched)
+{
+    std::list<Hunk>::iterator i = lru.end();
+
+    if (lru.size() >= capacity) {
+        std::lock_guard<std::mutex> guard(lock);
+        for (auto r = std::prev(lru.end()); r != lru.begin(); --r) {
+            if (r->state != HUNK_PENDING) {
+                i = r;
+                break;
+            }
+        }
+    }
+
+    const auto pos = prefetched ? std::next(lru.begin()) : lru.begin();
+    if (i != lru.end()) {
+        index.erase(i->index);
+        lru.splice(pos, lru, i);
+    }
+    else {
+        i = lru.emplace(pos);
+        i->data.resize(hunk_bytes);
+        HOSTMEM_Count(HOSTMEM_IMAGECACHE, hunk_bytes);
+    }
+
+    i->index = hunk;
+    i->state = HUNK_PENDING;
+    index[hunk] = i;
+    return i;
+}
+
+void CHDHunkCache::PrefetchTask(Hunk *hunk)
+{
+    chd_file *handle = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!spare.empty()) {
+            handle = spare.back();
+            spare.pop_back();
+        }
+    }
+    if (handle == nullptr && chd_open(filename.c_str(), CHD_OPEN_READ, NULL, &handle) != CHDERR_NONE)
+        handle = nullptr;
+
+    const bool ok = handle != nullptr && chd_read(handle, hunk->index, hunk->data.data()) == CHDERR_NONE;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (handle != nullptr) spare.push_back(handle);
+        hunk->state = ok ? HUNK_READY : HUNK_ERROR;
+    }
+    loaded.notify_all();
+}
+
+void CHDHunkCache::Prefetch(uint32_t hunk)
+{
+    // without worker threads the tasks would run right here, which only delays the caller
+    if (prefetch == 0 || THREADPOOL_Workers() == 0) return;
+
+    for (uint32_t next = hunk + 1; next <= hunk + prefetch && next < total_hunks; next++) {
+        if (index.find(next) != index.end()) continue;
+        Hunk *h = &*Allocate(next, true);
+        tasks.run([this, h]() { PrefetchTask(h); });
+    }
+}
+
+const uint8_t* CHDHunkCache::GetHunk(uint32_t hunk)
+{
+    if (hunk >= total_hunks) return nullptr;
+
+    Hunk *h;
+    auto i = index.find(hunk);
+    if (i != index.end()) {
+        lru.splice(lru.begin(), lru, i->second);
+        h = &lru.front();
+
+        std::unique_lock<std::mutex> guard(lock);
+        loaded.wait(guard, [h]() { return h->state != HUNK_PENDING; });
+    }
+    else {
+        h = &*Allocate(hunk, false);
+    }
+
+    // not cached, or the prefetch failed: read it here
+    if (h->state != HUNK_READY)
+        h->state = chd_read(chd, hunk, h->data.data()) == CHDERR_NONE ? HUNK_READY : HUNK_ERROR;
+
+    Prefetch(hunk);
+    return h->state == HUNK_READY ? h->data.data() : nullptr;
+}
+
 CDROM_Interface_Image::CHDFile::CHDFile(const char* filename, bool& error)
     :TrackFile(RAW_SECTOR_SIZE) // CDAudioCallBack needs 2352
 {
     error = chd_open(filename, CHD_OPEN_READ, NULL, &this->chd) != CHDERR_NONE;
     if (!error) {
-        this->header           = chd_get_header(this->chd);
-        this->hunk_buffer      = new uint8_t[this->header->hunkbytes];
-        this->hunk_buffer_next = new uint8_t[this->header->hunkbytes];
+        this->header     = chd_get_header(this->chd);
+        this->hunk_cache = new CHDHunkCache(this->chd, filename);
     }
 }
 
 CDROM_Interface_Image::CHDFile::~CHDFile()
 {
+    // the cache may still have prefetch tasks running
+    delete this->hunk_cache;
+    this->hunk_cache = nullptr;
+
     // Guard: only cleanup if needed
     if (this->chd) {
         chd_close(this->chd);
         this->chd = nullptr;
     }
-
-    if (this->hunk_buffer) {
-        delete[] this->hunk_buffer;
-        this->hunk_buffer = nullptr;
-    }
-
-#if !defined(HX_DOS) && !(defined(__MINGW32__) && !defined(__MINGW64_VERSION_MAJOR))
-    if (this->hunk_thread) {
-        this->hunk_thread->join();
-        delete hunk_thread;
-        this->hunk_thread = nullptr;
-    }
-#endif
 }
 
-#if !defined(HX_DOS) && !(defined(__MINGW32__) && !defined(__MINGW64_VERSION_MAJOR))
-void hunk_thread_func(chd_file* chd, int hunk_index, uint8_t* buffer, bool* error)
-{
-    // loads one hunk into buffer
-    *error = chd_read(chd, hunk_index, buffer) != CHDERR_NONE;
-}
-#endif
-
 bool CDROM_Interface_Image::CHDFile::read(uint8_t* buffer,int64_t offset, int count)
 {
     // we can not read more than a single sector currently
@@ -357,51 +629,19 @@ bool CDROM_Interface_Image::CHDFile::read(uint8_t* buffer,int64_t offset, int co
     uint64_t needed_hunk = (uint64_t)offset / (uint64_t)this->header->hunkbytes;
 
     // EOF
-    if (needed_hunk > this->header->totalhunks) {
+    if (needed_hunk >= this->header->totalhunks) {
         return false;
     }
 
-    // read new hunk if needed
-    if ((int)needed_hunk != this->hunk_buffer_index) {
-#if defined(HX_DOS) || defined(__MINGW32__) && !defined(__MINGW64_VERSION_MAJOR)
-        if (chd_read(this->chd, needed_hunk, this->hunk_buffer) != CHDERR_NONE)
-            return false;
-#else
-        // make sure our thread is done
-        if (this->hunk_thread) this->hunk_thread->join();
-
-        // can we use our prefetched hunk
-        if (((int)needed_hunk == (this->hunk_buffer_index + 1)) && (!this->hunk_thread_error)) {
-            // swap pointers and we're good :)
-            std::swap(this->hunk_buffer, this->hunk_buffer_next);
-
-        } else {
-            // read new hunk
-            bool error = true;
-            hunk_thread_func(this->chd, (int)needed_hunk, this->hunk_buffer, &error);
-            if (error) {
-                return false;
-            }
-        }
-#endif
-
-        this->hunk_buffer_index = (int)needed_hunk;
-
-#if !defined(HX_DOS) && !(defined(__MINGW32__) && !defined(__MINGW64_VERSION_MAJOR))
-        // prefetch: let our thread decode the next hunk
-        if (hunk_thread) delete this->hunk_thread;
-        this->hunk_thread = new std::thread(
-            [this, needed_hunk]() {
-                hunk_thread_func(this->chd, (int)(needed_hunk + 1), this->hunk_buffer_next, &this->hunk_thread_error);
-            }
-        );
-#endif
+    const uint8_t* hunk = this->hunk_cache->GetHunk((uint32_t)needed_hunk);
+    if (hunk == nullptr) {
+        return false;
     }
 
     // copy data
     // the overlying read code thinks there is a sync header
     // so for 2048 sector size images we need to subtract 16 from the offset to account for the missing sync header
-    uint8_t* source = this->hunk_buffer + ((uint64_t)offset - (uint64_t)needed_hunk * this->header->hunkbytes) - ((uint64_t)16 * this->skip_sync);
+    const uint8_t* source = hunk + ((uint64_t)offset - (uint64_t)needed_hunk * this->header->hunkbytes) - ((uint64_t)16 * this->skip_sync);
     memcpy(buffer, source, min(count, RAW_SECTOR_SIZE));
 
     return true;
@@ -527,6 +767,14 @@ bool CDROM_Interface_Image::SetDevice(char* path, int forceCD)
     LOG_MSG("CDROM: Image loaded No. of data tracks=%d, audio tracks=%d",
         datatracks, audiotracks-1
         );
+
+    // start decoding the first audio track so that the first play doesn't wait on the codec
+    for(const auto& track : tracks) {
+        if(track.attr == 0 && track.file != NULL) {
+            track.file->prefetch(track.skip);
+            break;
+        }
+    }
     return result;
 }
 
@@ -737,6 +985,11 @@ bool CDROM_Interface_Image::PlayAudioSector(unsigned long start, unsigned long l
 			// start the channel!
 			player.channel->SetFreq(rate);
 			player.channel->Enable(true);
+
+			// get the start of the next track decoding so that it doesn't wait on the codec either
+			if (track + 1 < (int)tracks.size() && tracks[track + 1].attr == 0 &&
+			    tracks[track + 1].file != NULL && tracks[track + 1].file != trackFile)
+				tracks[track + 1].file->prefetch(tracks[track + 1].skip);
 		}
 	}
 	if (!is_playable) StopAudio();
@@ -863,6 +1116,11 @@ void CDROM_Interface_Image::CDAudioCallBack(Bitu len)
 	// decrement this counter each callback until we're done.
 	if (len == 0 || !player.isPlaying || player.isPaused) return;
 
+	// Still seeking or priming in the background, play silence rather than wait on the codec
+	if (!player.trackFile->ready()) {
+		player.channel->AddSilence();
+		return;
+	}
 
 	// determine bytes per request (16-bit samples)
 	const uint8_t channels = player.trackFile->getChannels();
@@ -1054,6 +1054,23 @@ uint8_t temp_char = 0;
 void WriteChar(uint16_t col, uint16_t row, uint8_t page, uint16_t chr, uint8_t attr, bool useattr);
 extern bool dbcs_sbcs;
 
+RealPt DOS_Get_INT29_entry(void);
+RealPt GetSystemBiosINT10Vector(void);
+
+/* Without ANSI.SYS every byte goes INT 29h -> INT 10h AH=0Eh. While nobody has
+   hooked either vector that round trip can be skipped and a run of plain
+   characters handed to the BIOS teletype in one call. */
+static bool CON_CanBatchOutput(bool ansi_installed) {
+	if (ansi_installed || IS_PC98_ARCH || log_dev_con || isDBCSCP()) return false;
+	const RealPt int10 = GetSystemBiosINT10Vector();
+	const RealPt int29 = DOS_Get_INT29_entry();
+	return int10 != 0 && int29 != 0 && RealGetVec(0x10) == int10 && RealGetVec(0x29) == int29;
+}
+
+static inline bool CON_IsPlainChar(uint8_t c) {
+	return c >= 0x20 || c == '\r' || c == '\n' || c == 8;
+}
+
 bool device_CON::Write(const uint8_t * data,uint16_t * size) {
 	uint16_t count=0;
 #if defined(USE_TTF)
@@ -1173,6 +1190,12 @@ bool device_CON::Write(const uint8_t * data,uint16_t * size) {
                 Real_INT10_SetCursorPos(0,0,page);
             } else if (data[count] == 0x1E && IS_PC98_ARCH) {
                 Real_INT10_SetCursorPos(0,0,page);
+            } else if (CON_IsPlainChar(data[count]) && CON_CanBatchOutput(ansi.installed)) {
+                uint16_t run=1;
+                while ((count+run) < *size && CON_IsPlainChar(data[count+run])) run++;
+                INT10_TeletypeOutputString(data+count,run,7);
+                count+=run;
+                continue;
             } else { 
                 Output(data[count]);
                 count++;
@@ -151,6 +151,7 @@ bool packerr = false;
 bool incall = false;
 bool startnopause = false;
 int file_access_tries = 0;
+int file_buffer_size = 16;
 int dos_initial_hma_free = 34*1024;
 bool auto_repair_dos_psp_mcb_corruption = false;
 int dos_sda_size = 0x560;
@@ -182,6 +183,7 @@ void InitFontHandle(void);
 void ShutFontHandle(void);
 void DOSBox_SetSysMenu(void);
 void runRescan(const char *str);
+void FlushBIOSDiskCaches(void);
 bool GFX_GetPreventFullscreen(void);
 
 bool DOS_IS_IN_HMA() {
@@ -1353,7 +1355,7 @@ static Bitu DOS_21Handler(void) {
             //TODO Find out the values for when reg_al!=0
             //TODO Hope this doesn't do anything special
         case 0x0d:      /* Disk Reset */
-            //Sure let's reset a virtual disk
+            FlushBIOSDiskCaches();
             break;  
         case 0x0e:      /* Select Default Drive */
             DOS_SetDefaultDrive(reg_dl);
@@ -4051,6 +4053,10 @@ public:
 		return callback[8].Get_RealPointer();
 	}
 
+	RealPt DOS_Get_INT29_entry(void) {
+		return callback[6].Get_RealPointer();
+	}
+
 	DOS(Section* configuration):Module_base(configuration){
 		const Section_prop* section = static_cast<Section_prop*>(configuration);
 
@@ -4154,6 +4160,7 @@ public:
 		hidenonrep = section->Get_bool("hidenonrepresentable");
 		enable_filenamechar = section->Get_bool("filenamechar");
 		file_access_tries = section->Get_int("file access tries");
+		file_buffer_size = section->Get_int("file buffer size");
 		dos_initial_hma_free = section->Get_int("hma free space");
 		auto_repair_dos_psp_mcb_corruption = section->Get_bool("mcb corruption becomes application free memory");
 		minimum_mcb_free = section->Get_hex("minimum mcb free");
@@ -4786,6 +4793,10 @@ uint32_t DOS_Get_CPM_entry_direct(void) {
 	return test->DOS_Get_CPM_entry_direct();
 }
 
+RealPt DOS_Get_INT29_entry(void) {
+	return test != NULL ? test->DOS_Get_INT29_entry() : 0;
+}
+
 void DOS_ShutdownFiles() {
 	if (Files != NULL) {
 		for (Bitu i=0;i<DOS_FILES;i++) {
@@ -19,6 +19,8 @@
 
 #include <string.h>
 #include <ctype.h>
+#include <map>
+#include <vector>
 
 #include "dosbox.h"
 #include "logging.h"
@@ -28,6 +30,7 @@
 #include "callback.h"
 #include "debug.h"
 #include "cpu.h"
+#include "paging.h"
 #include "menu.h"
 #include "crc32.h"
 
@@ -273,6 +276,76 @@ static void SetupCMDLine(uint16_t pspseg, const DOS_ParamBlock& block) {
 	psp.SetCommandTail(block.exec.cmdtail);
 }
 
+/* Reads size bytes of a program image from the file straight into guest memory and adds them to the
+ * checksum. Runs of plain RAM pages are read in place through their host pointers. Pages that need a
+ * write handler, such as code translated by the dynamic core, go through loadbuf and MEM_BlockWrite.
+ * Returns the number of bytes read, less than size if the file ends early. */
+static uint32_t ReadImageToMemory(uint16_t fhandle,PhysPt address,uint32_t size,uint8_t *loadbuf,uint32_t &checksum) {
+	uint32_t done=0;
+	while (done<size) {
+		const PhysPt pt=address+done;
+		const HostPt host=get_tlb_write(pt);
+		uint32_t run=0x1000u-(pt&0xFFFu);
+		if (host) {
+			/* extend over following pages that are contiguous in host memory too */
+			while (run<0x8000u && (done+run)<size && get_tlb_write(pt+run)==host) run+=0x1000u;
+		}
+		if (run>size-done) run=size-done;
+		uint16_t readsize=(uint16_t)run;
+		if (host) {
+			if (!DOS_ReadFile(fhandle,host+pt,&readsize)) break;
+			checksum = crc32(checksum, host+pt, readsize);
+		} else {
+			if (!DOS_ReadFile(fhandle,loadbuf,&readsize)) break;
+			checksum = crc32(checksum, loadbuf, readsize);
+			MEM_BlockWrite(pt,loadbuf,readsize);
+		}
+		done+=readsize;
+		if (readsize<run) break;
+	}
+	return done;
+}
+
+/* Load image and relocation table of an EXE file on the Z: drive. Those files are served from memory
+ * and programs like DOS4GW or XCOPY are often run many times from batch files, so EXEC keeps what it
+ * parsed and copies the image straight from the file data instead of reading it through the handle. */
+struct ExecImage {
+	const uint8_t*		image = NULL;		/* load image within the file data */
+	uint32_t		size = 0;		/* bytes of the load image present in the file */
+	uint32_t		checksum = 0;		/* crc32 of those bytes */
+	std::vector<RealPt>	relocations;		/* host byte order */
+};
+
+static std::map<std::pair<const uint8_t*,uint32_t>,ExecImage> exec_images;
+static unsigned int exec_images_generation = 0;
+
+static const ExecImage *GetExecImage(uint16_t fhandle,const EXE_Header &head,uint32_t headersize,uint32_t imagesize) {
+	uint32_t filesize;
+	unsigned int generation;
+	const uint8_t *data = VFILE_GetOpenFileData(fhandle,filesize,generation);
+	if (data == NULL) return NULL;
+	if (generation != exec_images_generation) {
+		exec_images.clear();
+		exec_images_generation = generation;
+	}
+
+	const std::pair<const uint8_t*,uint32_t> key(data,filesize);
+	std::map<std::pair<const uint8_t*,uint32_t>,ExecImage>::const_iterator it = exec_images.find(key);
+	if (it != exec_images.end()) return &it->second;
+
+	/* leave truncated files to the normal loader */
+	if (headersize > filesize || ((uint32_t)head.reloctable + (uint32_t)head.relocations * 4u) > filesize) return NULL;
+
+	ExecImage &exe = exec_images[key];
+	exe.image = data + headersize;
+	exe.size = (imagesize < filesize - headersize) ? imagesize : filesize - headersize;
+	exe.checksum = crc32(0, (uint8_t*)exe.image, exe.size);
+	exe.relocations.resize(head.relocations);
+	for (Bitu i=0;i<head.relocations;i++)
+		exe.relocations[i] = host_readd((ConstHostPt)(data + head.reloctable + i*4u));
+	return &exe;
+}
+
 /* FIXME: This code (or the shell perhaps) isn't very good at returning or
  *        printing an error message when it is unable to load and run an
  *        executable for whatever reason. Worst offense is that if it can't
@@ -428,38 +501,55 @@ bool DOS_Execute(const char* name, PhysPt block_pt, uint8_t flags) {
 		if (pos > (unsigned int)(memsize*0x10)) E_Exit("DOS:Not enough memory for COM executable");
 
 		pos=0;DOS_SeekFile(fhandle,&pos,DOS_SEEK_SET);	
-		DOS_ReadFile(fhandle,loadbuf,&readsize);
-		checksum = crc32(checksum, loadbuf, readsize);
-		checksum_bytes += readsize;
-		MEM_BlockWrite(loadaddress,loadbuf,readsize);
-	} else {	/* EXE Load in 32kb blocks and then relocate */
+		checksum_bytes += ReadImageToMemory(fhandle,loadaddress,readsize,loadbuf,checksum);
+	} else if (const ExecImage *exe = GetExecImage(fhandle,head,headersize,imagesize)) {	/* EXE from memory, relocate while copying */
 		if (imagesize > (unsigned int)(memsize*0x10)) E_Exit("DOS:Not enough memory for EXE image");
-		pos=headersize;DOS_SeekFile(fhandle,&pos,DOS_SEEK_SET);	
-		while (imagesize>0x7FFF) {
-			readsize=0x8000;DOS_ReadFile(fhandle,loadbuf,&readsize);
-			checksum = crc32(checksum, loadbuf, readsize);
-			checksum_bytes += readsize;
-			MEM_BlockWrite(loadaddress,loadbuf,readsize);
-//			if (readsize!=0x8000) LOG(LOG_EXEC,LOG_NORMAL)("Illegal header");
-			loadaddress+=0x8000;imagesize-=0x8000;
+		uint16_t relocate;
+		if (flags==OVERLAY) relocate=block.overlay.relocation;
+		else relocate=loadseg;
+		/* Relocations are patched in a copy of the image, unless one points outside of it */
+		static std::vector<uint8_t> image;
+		image.assign(exe->image,exe->image+exe->size);
+		bool inside=true;
+		for (i=0;i<exe->relocations.size() && inside;i++) {
+			const PhysPt address=PhysMake(RealSeg(exe->relocations[i])+loadseg,RealOff(exe->relocations[i]));
+			inside=(address>=loadaddress && (address-loadaddress+2u)<=exe->size);
 		}
-		if (imagesize>0) {
-			readsize=(uint16_t)imagesize;DOS_ReadFile(fhandle,loadbuf,&readsize);
-			checksum = crc32(checksum, loadbuf, readsize);
-			checksum_bytes += readsize;
-			MEM_BlockWrite(loadaddress,loadbuf,readsize);
-//			if (readsize!=imagesize) LOG(LOG_EXEC,LOG_NORMAL)("Illegal header");
+		if (inside) {
+			for (i=0;i<exe->relocations.size();i++) {
+				uint8_t *word=&image[PhysMake(RealSeg(exe->relocations[i])+loadseg,RealOff(exe->relocations[i]))-loadaddress];
+				host_writew(word,host_readw(word)+relocate);
+			}
 		}
-		/* Relocate the exe image */
+		MEM_BlockWrite(loadaddress,image.data(),exe->size);
+		if (!inside) {
+			for (i=0;i<exe->relocations.size();i++) {
+				PhysPt address=PhysMake(RealSeg(exe->relocations[i])+loadseg,RealOff(exe->relocations[i]));
+				mem_writew(address,mem_readw(address)+relocate);
+			}
+		}
+		checksum = exe->checksum;
+		checksum_bytes = exe->size;
+	} else {	/* EXE Load straight into memory and then relocate */
+		if (imagesize > (unsigned int)(memsize*0x10)) E_Exit("DOS:Not enough memory for EXE image");
+		pos=headersize;DOS_SeekFile(fhandle,&pos,DOS_SEEK_SET);	
+		checksum_bytes += ReadImageToMemory(fhandle,loadaddress,imagesize,loadbuf,checksum);
+		/* Relocate the exe image, reading the table in 32kb blocks */
 		uint16_t relocate;
 		if (flags==OVERLAY) relocate=block.overlay.relocation;
 		else relocate=loadseg;
 		pos=head.reloctable;DOS_SeekFile(fhandle,&pos,0);
-		for (i=0;i<head.relocations;i++) {
-			readsize=4;DOS_ReadFile(fhandle,(uint8_t *)&relocpt,&readsize);
-			relocpt=host_readd((HostPt)&relocpt);		//Endianize
-			PhysPt address=PhysMake(RealSeg(relocpt)+loadseg,RealOff(relocpt));
-			mem_writew(address,mem_readw(address)+relocate);
+		relocpt=0;
+		for (i=0;i<head.relocations;) {
+			Bitu count=head.relocations-i;
+			if (count>0x2000) count=0x2000;
+			readsize=(uint16_t)(count*4);DOS_ReadFile(fhandle,loadbuf,&readsize);
+			/* entries missing from a truncated table reuse the last one, like reading them one by one did */
+			for (Bitu j=0;j<count;j++,i++) {
+				if ((j*4+4)<=readsize) relocpt=host_readd(loadbuf+j*4);		//Endianize
+				PhysPt address=PhysMake(RealSeg(relocpt)+loadseg,RealOff(relocpt));
+				mem_writew(address,mem_readw(address)+relocate);
+			}
 		}
 	}
 	delete[] loadbuf;
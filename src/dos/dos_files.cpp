@@ -39,6 +39,7 @@
 #include "cdrom.h"
 #include "ide.h"
 #include "bios_disk.h"
+#include "hosttime.h"
 
 #define DOS_FILESTART 4
 
@@ -800,7 +801,14 @@ bool DOS_ReadFile(uint16_t entry,uint8_t * data,uint16_t * amount,bool fcb) {
 	}
 */
 	uint16_t toread=*amount;
-	bool ret=Files[handle]->Read(data,&toread);
+	bool ret;
+	if (Files[handle]->GetInformation() & DeviceInfoFlags::Device) {
+		ret=Files[handle]->Read(data,&toread);
+	} else {
+		HostTimeScope scope(HOSTTIME_DISK);
+		ret=Files[handle]->Read(data,&toread);
+		disk_io_bytes_read+=toread;
+	}
 	*amount=toread;
 	return ret;
 }
@@ -830,7 +838,14 @@ bool DOS_WriteFile(uint16_t entry,const uint8_t * data,uint16_t * amount,bool fc
 	}
 */
 	uint16_t towrite=*amount;
-	bool ret=Files[handle]->Write(data,&towrite);
+	bool ret;
+	if (Files[handle]->GetInformation() & DeviceInfoFlags::Device) {
+		ret=Files[handle]->Write(data,&towrite);
+	} else {
+		HostTimeScope scope(HOSTTIME_DISK);
+		ret=Files[handle]->Write(data,&towrite);
+		disk_io_bytes_written+=towrite;
+	}
 	*amount=towrite;
 	return ret;
 }
@@ -678,6 +678,7 @@ bool CMscdex::ReadSectors(uint8_t subUnit, bool raw, uint32_t sector, uint16_t n
 	if ((cpu_cycles_count_t)(4u*num*2048u+5u) < CPU_Cycles) CPU_Cycles -= cpu_cycles_count_t(4u*num*2048u);
 	else CPU_Cycles = 5u;
 	dinfo[subUnit].lastResult = cdrom[subUnit]->ReadSectors(data,raw,sector,num);
+	if (dinfo[subUnit].lastResult) disk_io_bytes_read += (uint64_t)num * (raw ? 2352u : 2048u);
 	return dinfo[subUnit].lastResult;
 }
 
@@ -31,6 +31,7 @@
 #include <algorithm>
 #include <string>
 #include <vector>
+#include <chrono>
 #include <sys/stat.h>
 
 #include "menudef.h"
@@ -108,6 +109,7 @@ char lastmount = 0;
 bool Mouse_Drv=true;
 bool Mouse_Vertical = false;
 bool force_nocachedir = false;
+bool watchhostdir = true;
 bool lockmount = true;
 bool wpcolon = true;
 bool convertimg = true;
@@ -5537,6 +5539,21 @@ class IMGMOUNT : public Program {
 					options.push_back(s);
 			}
 
+			//look for -overlay, which keeps writes in memory on top of the image
+			std::string overlay;
+			bool overlay_commit = false;
+			uint32_t overlay_interval = 0;
+			if (cmd->FindString("-overlay", overlay, true)) {
+				std::transform(overlay.begin(), overlay.end(), overlay.begin(), ::tolower);
+				if (!imageDiskMemory::ParseOverlayMode(overlay, &overlay_commit, &overlay_interval)) {
+					WriteOut(MSG_Get("PROGRAM_IMGMOUNT_OVERLAY_INVALID"), overlay.c_str());
+					return;
+				}
+				options.push_back("overlay=" + overlay);
+				/* a discarded overlay never writes to the image, so it is opened read-only and can be shared */
+				if (!overlay_commit) roflag = true;
+			}
+
 			//look for -el-torito parameter and remove it from the command line
 			cmd->FindString("-el-torito",el_torito,true);
 			if(el_torito == "") cmd->FindString("-bootcd", el_torito, true);
@@ -5771,6 +5788,11 @@ class IMGMOUNT : public Program {
 				}
 				else {
 					newImage = MountImageNone(paths[0].c_str(), NULL, sizes, reserved_cylinders, roflag);
+					if (newImage != NULL && !overlay.empty()) {
+						imageDiskMemory* overlayImage = new imageDiskMemory(newImage);
+						overlayImage->SetCommitMode(overlay_commit, overlay_interval);
+						newImage = overlayImage;
+					}
 				}
 				if (newImage == NULL) return;
 				newImage->Addref();
@@ -6505,6 +6527,17 @@ class IMGMOUNT : public Program {
 									newImage = NULL;
 								}
 							}
+							else if(!strcasecmp(ext, ".chd")) {
+								ro = wpcolon && paths[i].length() > 1 && paths[i].c_str()[0] == ':';
+								const char* fname = ro ? paths[i].c_str() + 1 : paths[i].c_str();
+								newImage = imageDiskCHD::Open(fname);
+								if(!newImage) {
+									WriteOut(MSG_Get("PROGRAM_IMGMOUNT_CHD_INVALID"), fname);
+									return false;
+								}
+								skipDetectGeometry = true;
+								options.emplace_back("readonly"); // CHD images are read only
+							}
 							else if (!strcasecmp(ext,".img") || !strcasecmp(ext,".ima")){ // Raw MFM image format is typically .img or .ima
 								unsupported_ext = false;
 							}
@@ -6532,9 +6565,16 @@ class IMGMOUNT : public Program {
 						newDrive = new fatDrive(newImage, options);
 						strcpy(newDrive->info, "fatDrive ");
 						strcat(newDrive->info, ro ? paths[i].c_str() + 1 : paths[i].c_str());
-						LOG_MSG("IMGMOUNT: qcow2 image mounted (experimental)");
-						LOG_MSG("IMGMOUNT: qcow2 SS,S,H,C: %u,%u,%u,%u",
-							(uint32_t)newImage->sector_size, (uint32_t)newImage->sectors, (uint32_t)newImage->heads, (uint32_t)newImage->cylinders);
+						if(newImage->class_id == imageDisk::ID_CHD) {
+							LOG_MSG("IMGMOUNT: CHD image mounted read only");
+							LOG_MSG("IMGMOUNT: CHD SS,S,H,C: %u,%u,%u,%u",
+								(uint32_t)newImage->sector_size, (uint32_t)newImage->sectors, (uint32_t)newImage->heads, (uint32_t)newImage->cylinders);
+						}
+						else {
+							LOG_MSG("IMGMOUNT: qcow2 image mounted (experimental)");
+							LOG_MSG("IMGMOUNT: qcow2 SS,S,H,C: %u,%u,%u,%u",
+								(uint32_t)newImage->sector_size, (uint32_t)newImage->sectors, (uint32_t)newImage->heads, (uint32_t)newImage->cylinders);
+						}
 						newImage = NULL;
 					}
 					else {
@@ -6552,7 +6592,7 @@ class IMGMOUNT : public Program {
 						}
 					} else {
 						if (imgDisks.size() == 1) mediaid = (int)((unsigned char)fdrive->GetMediaByte());
-						if ((vhdImage&&ro)||roflag) fdrive->readonly=true;
+						if (((vhdImage&&ro)||roflag) && dynamic_cast<imageDiskMemory*>(fdrive->loadedDisk) == NULL) fdrive->readonly=true;
 					}
 					unformatted = fdrive->unformatted;
 				}
@@ -7025,6 +7065,13 @@ class IMGMOUNT : public Program {
 						}
 						return newImage;
 					}
+					else if (!strcasecmp(ext, ".chd")) {
+						bool ro=wpcolon&&strlen(fileName)>1&&fileName[0]==':';
+						newImage = imageDiskCHD::Open(ro?fileName+1:fileName);
+						if (newImage == NULL) WriteOut(MSG_Get("PROGRAM_IMGMOUNT_CHD_INVALID"), ro?fileName+1:fileName);
+						else roflag = true;
+						return newImage;
+					}
 					else if (!strcasecmp(ext, ".hdi")) {
 						assumeHardDisk = true; /* bugfix for HDI images smaller than 2.88MB so that the .hdi file is not mistaken for a floppy disk image */
 					}
@@ -7450,6 +7497,230 @@ static void NMITEST_ProgramStart(Program * * make) {
 }
 #endif
 
+/* CPU core benchmark. The kernels are loops of a few instructions, assembled once, that leave their
+ * iteration count in ECX on the far call. Each one runs under every core this build has and the
+ * result is emulated instructions per host second; REP iterations count as instructions. */
+static const uint8_t cpubench_code[] = {
+    0x50,0x00,0x5e,0x00,0x77,0x00,0xcb,0x00,0x47,0x01,0x5c,0x01,0x7b,0x01,0x00,0x00,
+    0x27,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x01,0xd8,0x31,0xc2,0x43,0xd1,0xe0,0x29,0xda,0x66,0x49,0x75,0xf3,0xcb,0x66,0x01,
+    0xd8,0x66,0x0f,0xaf,0xd0,0x66,0x31,0xd6,0x66,0xc1,0xc0,0x03,0x67,0x66,0x8d,0x5c,
+    0x43,0x01,0x66,0x49,0x75,0xe8,0xcb,0x9c,0xfa,0x1e,0x06,0x0e,0x68,0xc7,0x00,0x2e,
+    0x66,0x0f,0x01,0x16,0x10,0x00,0x0f,0x20,0xc0,0x0c,0x01,0x0f,0x22,0xc0,0xea,0x93,
+    0x00,0x08,0x00,0x66,0xb8,0x10,0x00,0x8e,0xd8,0x8e,0xc0,0x2e,0x8b,0x3d,0x20,0x00,
+    0x00,0x00,0x8b,0x07,0x01,0xc8,0x89,0x47,0x04,0x31,0xc2,0xd1,0xc2,0x49,0x75,0xf2,
+    0xea,0xb7,0x00,0x00,0x00,0x18,0x00,0xb8,0x20,0x00,0x8e,0xd8,0x8e,0xc0,0x0f,0x20,
+    0xc0,0x24,0xfe,0x0f,0x22,0xc0,0xcb,0x07,0x1f,0x9d,0xcb,0x9c,0xfa,0x1e,0x06,0x0e,
+    0x68,0xc7,0x00,0x0f,0x20,0xd8,0x2e,0x66,0xa3,0x1c,0x00,0x2e,0x66,0x0f,0x01,0x16,
+    0x10,0x00,0x0f,0x20,0xc0,0x0c,0x01,0x0f,0x22,0xc0,0xea,0xef,0x00,0x08,0x00,0x66,
+    0xb8,0x10,0x00,0x8e,0xd8,0x8e,0xc0,0x2e,0xa1,0x18,0x00,0x00,0x00,0x0f,0x22,0xd8,
+    0x0f,0x20,0xc0,0x0d,0x00,0x00,0x00,0x80,0x0f,0x22,0xc0,0xbe,0x00,0x00,0x40,0x00,
+    0x8b,0x06,0x01,0xc8,0x89,0x46,0x08,0x81,0xc6,0x04,0x10,0x00,0x00,0x81,0xe6,0xf0,
+    0xff,0x3f,0x00,0x81,0xce,0x00,0x00,0x40,0x00,0x49,0x75,0xe4,0x0f,0x20,0xc0,0x25,
+    0xff,0xff,0xff,0x7f,0x0f,0x22,0xc0,0x2e,0xa1,0x1c,0x00,0x00,0x00,0x0f,0x22,0xd8,
+    0xea,0xb7,0x00,0x00,0x00,0x18,0x00,0xdb,0xe3,0xd9,0xe8,0xd9,0xe8,0xd8,0xc1,0xd8,
+    0xc9,0xd9,0xfa,0x66,0x49,0x75,0xf6,0xdd,0xd8,0xdd,0xd8,0xcb,0x66,0xb8,0x01,0x00,
+    0x03,0x00,0x0f,0x6e,0xc8,0x0f,0xef,0xc0,0x0f,0xef,0xd2,0x0f,0xfd,0xc1,0x0f,0xd5,
+    0xd0,0x0f,0xef,0xca,0x66,0x49,0x75,0xf3,0x0f,0x77,0xcb,0x66,0x89,0xcd,0xfc,0xbe,
+    0x00,0x10,0xbf,0x00,0x50,0xb9,0x00,0x10,0x66,0xf3,0xa5,0x66,0x4d,0x75,0xf0,0xcb
+};
+
+enum {
+    CPUBENCH_GDTR = 0x10,       // limit, base
+    CPUBENCH_CR3 = 0x18,        // page directory of the paging kernel
+    CPUBENCH_BUFFER = 0x20,     // linear address of the protected mode kernel's data
+    CPUBENCH_GDT = 0x28,        // null, 0x08 code32, 0x10 flat data, 0x18 code16, 0x20 data16
+    CPUBENCH_PARAGRAPHS = 0x1400
+};
+
+struct CPUBenchKernel {
+    const char*     name;
+    uint32_t        per_iteration;      // instructions
+    bool            needs_386;
+    bool            needs_real_mode;    // switches to protected mode itself, not from virtual 8086 mode
+};
+
+static const CPUBenchKernel cpubench_kernels[] = {
+    { "real16",     7,          false,  false },
+    { "real32",     7,          true,   false },
+    { "pmode32",    7,          true,   true  },
+    { "paging",     8,          true,   true  },
+    { "fpu",        5,          false,  false },
+    { "mmx",        5,          true,   false },
+    { "string",     5 + 4096,   true,   false }
+};
+
+struct CPUBenchCore {
+    const char*     name;
+    CPU_Decoder*    decoder;
+    bool            has_mmx;            // the full core decodes no MMX opcodes
+};
+
+#if (C_DYNAMIC_X86)
+void CPU_Core_Dyn_X86_Cache_Init(bool enable_cache);
+#endif
+#if (C_DYNREC)
+void CPU_Core_Dynrec_Cache_Init(bool enable_cache);
+#endif
+extern bool enable_fpu;
+extern bool ticksLocked;
+
+static const CPUBenchCore cpubench_cores[] = {
+    { "normal",         &CPU_Core_Normal_Run,       true  },
+#if !defined(C_EMSCRIPTEN)
+    { "simple",         &CPU_Core_Simple_Run,       true  },
+    { "full",           &CPU_Core_Full_Run,         false },
+#endif
+    { "prefetch",       &CPU_Core_Prefetch_Run,     true  },
+#if (C_DYNAMIC_X86)
+    { "dynamic_x86",    &CPU_Core_Dyn_X86_Run,      true  },
+#endif
+#if (C_DYNREC)
+    { "dynamic_rec",    &CPU_Core_Dynrec_Run,       true  },
+#endif
+};
+
+class CPUBENCH : public Program {
+public:
+    void Run(void) override {
+        if (cmd->FindExist("-?", false) || cmd->FindExist("/?", false)) {
+            WriteOut(MSG_Get("PROGRAM_CPUBENCH_HELP"));
+            return;
+        }
+
+        const bool csv = cmd->FindExist("-csv", true) || cmd->FindExist("/csv", true);
+        int millions = 20;
+        cmd->FindInt("-n", millions, true);
+        if (millions < 1) millions = 1;
+        std::string only_core, only_kernel;
+        cmd->FindString("-core", only_core, true);
+        cmd->FindString("-kernel", only_kernel, true);
+
+        uint16_t segment, blocks = CPUBENCH_PARAGRAPHS;
+        if (!DOS_AllocateMemory(&segment, &blocks)) {
+            WriteOut(MSG_Get("PROGRAM_CPUBENCH_NOMEM"));
+            return;
+        }
+        Setup(segment);
+
+        /* unthrottled, fixed cycles and the core this program picks: the host's speed is measured */
+        const CPU_Regs saved_regs = cpu_regs;
+        const Segments saved_segs = Segs;
+        CPU_Decoder * const saved_decoder = cpudecoder;
+        const unsigned char saved_autodetermine = CPU_AutoDetermineMode;
+        const bool saved_autoadjust = CPU_CycleAutoAdjust;
+        const int32_t saved_cyclemax = CPU_CycleMax;
+        const bool saved_locked = ticksLocked;
+        CPU_AutoDetermineMode = 0;
+        CPU_CycleAutoAdjust = false;
+        if (saved_autoadjust) CPU_CycleMax = 1000000;
+        ticksLocked = true;
+
+        if (csv) WriteOut("core,kernel,instructions,seconds,ips\n");
+        else {
+            WriteOut("Million instructions per host second, %d million per kernel\n\n%-12s", millions, "");
+            for (const CPUBenchKernel &k : cpubench_kernels)
+                if (only_kernel.empty() || !strcasecmp(only_kernel.c_str(), k.name)) WriteOut("%9s", k.name);
+            WriteOut("\n");
+        }
+
+        for (const CPUBenchCore &c : cpubench_cores) {
+            if (!only_core.empty() && strcasecmp(only_core.c_str(), c.name)) continue;
+            if (!csv) WriteOut("%-12s", c.name);
+#if (C_DYNAMIC_X86)
+            if (c.decoder == &CPU_Core_Dyn_X86_Run) CPU_Core_Dyn_X86_Cache_Init(true);
+#endif
+#if (C_DYNREC)
+            if (c.decoder == &CPU_Core_Dynrec_Run) CPU_Core_Dynrec_Cache_Init(true);
+#endif
+            for (unsigned int i = 0; i < sizeof(cpubench_kernels) / sizeof(cpubench_kernels[0]); i++) {
+                const CPUBenchKernel &k = cpubench_kernels[i];
+                if (!only_kernel.empty() && strcasecmp(only_kernel.c_str(), k.name)) continue;
+                if (!Runnable(c, k)) {
+                    if (!csv) WriteOut("%9s", "-");
+                    continue;
+                }
+
+                const uint32_t iterations = (uint32_t)(((uint64_t)millions * 1000000u + k.per_iteration - 1u) / k.per_iteration);
+                const uint64_t instructions = (uint64_t)iterations * k.per_iteration;
+                const uint16_t offset = real_readw(segment, (uint16_t)(i * 2u));
+
+                cpudecoder = c.decoder;
+                SegSet16(ds, segment);
+                SegSet16(es, segment);
+                reg_ecx = iterations;
+                const auto start = std::chrono::steady_clock::now();
+                CALLBACK_RunRealFar(segment, offset);
+                const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                cpudecoder = saved_decoder;
+
+                const double ips = seconds > 0 ? (double)instructions / seconds : 0;
+                if (csv) WriteOut("%s,%s,%llu,%.6f,%.0f\n", c.name, k.name, (unsigned long long)instructions, seconds, ips);
+                else WriteOut("%9.1f", ips / 1000000.0);
+            }
+            if (!csv) WriteOut("\n");
+        }
+
+        ticksLocked = saved_locked;
+        CPU_CycleMax = saved_cyclemax;
+        CPU_CycleAutoAdjust = saved_autoadjust;
+        CPU_AutoDetermineMode = saved_autodetermine;
+        cpudecoder = saved_decoder;
+        cpu_regs = saved_regs;
+        Segs = saved_segs;
+        DOS_FreeMemory(segment);
+    }
+private:
+    static bool Runnable(const CPUBenchCore &c, const CPUBenchKernel &k) {
+        if (k.needs_386 && CPU_ArchitectureType < CPU_ARCHTYPE_386) return false;
+        if (k.needs_real_mode && cpu.pmode) return false;
+        if (!strcmp(k.name, "fpu") && !enable_fpu) return false;
+        if (!strcmp(k.name, "mmx") && (CPU_ArchitectureType < CPU_ARCHTYPE_PMMXSLOW || !c.has_mmx)) return false;
+        return true;
+    }
+
+    static void WriteDescriptor(PhysPt at, uint32_t base, uint32_t limit, uint8_t access, uint8_t flags) {
+        phys_writed(at, (limit & 0xFFFFu) | (base << 16u));
+        phys_writed(at + 4, ((base >> 16u) & 0xFFu) | ((uint32_t)access << 8u) | (limit & 0xF0000u) |
+            ((uint32_t)flags << 20u) | (base & 0xFF000000u));
+    }
+
+    /* the code at the start of the block, then the data of the memory kernels,
+     * then the page directory and two page tables: 0-4MB identity mapped, 4-8MB
+     * cycling through the pages of the data */
+    static void Setup(uint16_t segment) {
+        const PhysPt base = (PhysPt)segment << 4u;
+        MEM_BlockWrite(base, cpubench_code, sizeof(cpubench_code));
+
+        phys_writed(base + CPUBENCH_GDTR + 2, base + CPUBENCH_GDT);
+        WriteDescriptor(base + CPUBENCH_GDT + 0x00, 0, 0, 0, 0);
+        WriteDescriptor(base + CPUBENCH_GDT + 0x08, base, 0xFFFF, 0x9A, 0x4);
+        WriteDescriptor(base + CPUBENCH_GDT + 0x10, 0, 0xFFFFF, 0x92, 0xC);
+        WriteDescriptor(base + CPUBENCH_GDT + 0x18, base, 0xFFFF, 0x9A, 0x0);
+        WriteDescriptor(base + CPUBENCH_GDT + 0x20, base, 0xFFFF, 0x92, 0x0);
+        phys_writed(base + CPUBENCH_BUFFER, base + 0x1000);
+
+        const PhysPt alias = (base + 0x1000 + 0xFFF) & ~0xFFFu;
+        const PhysPt dir = (base + 0x10000 + 0xFFF) & ~0xFFFu;
+        const Bitu alias_pages = 14;
+        for (Bitu i = 0; i < 1024; i++) {
+            phys_writed(dir + i * 4, 0);
+            phys_writed(dir + 0x1000 + i * 4, (uint32_t)(i << 12u) | 7u);
+            phys_writed(dir + 0x2000 + i * 4, (uint32_t)(alias + (i % alias_pages) * 0x1000) | 7u);
+        }
+        phys_writed(dir + 0, (dir + 0x1000) | 7u);
+        phys_writed(dir + 4, (dir + 0x2000) | 7u);
+        phys_writed(base + CPUBENCH_CR3, dir);
+    }
+};
+
+static void CPUBENCH_ProgramStart(Program * * make) {
+    *make=new CPUBENCH;
+}
+
 class CAPMOUSE : public Program
 {
 public:
@@ -8521,6 +8792,28 @@ void VHDMAKE::Run()
                 WriteOut(MSG_Get("PROGRAM_VHDMAKE_RENAME"));
         }
     }
+    else if(cmd->FindExist("-flat", true) || cmd->FindExist("-flatten", true)) {
+        if(cmd->GetCount() != 2) {
+            PrintUsage();
+            return;
+        }
+        cmd->FindCommand(1, temp_line);
+        safe_strcpy(basename, temp_line.c_str()); // image (chain) to flatten
+        cmd->FindCommand(2, temp_line);
+        safe_strcpy(filename, temp_line.c_str()); // resulting Dynamic VHD
+        if(!bOverwrite && _access(filename, 0) == 0) {
+            WriteOut(MSG_Get("PROGRAM_VHDMAKE_FNEEDED"));
+            return;
+        }
+        uint32_t totalBlocksCopied;
+        ret = imageDiskVHD::Flatten(basename, filename, &totalBlocksCopied);
+        if(ret == imageDiskVHD::ERROR_OPENING) {
+            WriteOut(MSG_Get("PROGRAM_VHDMAKE_ERROPEN"), basename);
+            return;
+        }
+        if(ret == imageDiskVHD::OPEN_SUCCESS)
+            WriteOut(MSG_Get("PROGRAM_VHDMAKE_FLATREPORT"), totalBlocksCopied, basename, filename);
+    }
     else if(cmd->FindExist("-l", true) || cmd->FindExist("-link", true)) {
         if(cmd->GetCount() > 2) {
             PrintUsage();
@@ -9470,6 +9763,7 @@ void Add_VFiles(bool usecp) {
     PROGRAMS_MakeFile("BIOSTEST.COM", BIOSTEST_ProgramStart,"/DEBUG/");
 #endif
     PROGRAMS_MakeFile("A20GATE.COM",A20GATE_ProgramStart,"/DEBUG/");
+    PROGRAMS_MakeFile("CPUBENCH.COM",CPUBENCH_ProgramStart,"/DEBUG/");
 
     if (IS_PC98_ARCH)
         PROGRAMS_MakeFile("PC98UTIL.COM",PC98UTIL_ProgramStart,"/BIN/");
@@ -10018,10 +10312,12 @@ void DOS_SetupPrograms(void) {
             "Sector size must be larger than 512 bytes and evenly divide the image cluster size of %lu bytes.\n");
     MSG_Add("PROGRAM_IMGMOUNT_OPEN_ERROR","Unable to open '%s'\n");
     MSG_Add("PROGRAM_IMGMOUNT_QCOW2_INVALID","qcow2 image '%s' is not supported\n");
+    MSG_Add("PROGRAM_IMGMOUNT_CHD_INVALID","CHD image '%s' is not a hard disk image or could not be opened\n");
     MSG_Add("PROGRAM_IMGMOUNT_GEOMETRY_ERROR", "Unable to detect geometry\n");
     MSG_Add("PROGRAM_IMGMOUNT_DOS_VERSION",
             "Mounting this image file requires a reported DOS version of %u.%u or higher.\n%s");
     MSG_Add("PROGRAM_IMGMOUNT_INVALID_FLOPPYSIZE","Floppy size not recognized\n");
+    MSG_Add("PROGRAM_IMGMOUNT_OVERLAY_INVALID","Overlay mode \"%s\" not recognized, use discard, commit or a number of seconds.\n");
             
     MSG_Add("PROGRAM_IMGMOUNT_HELP",
         "Mounts floppy, hard drive and optical disc images.\n"
@@ -10046,6 +10342,8 @@ void DOS_SetupPrograms(void) {
         " -bootcd cdDrive     Specify the CD drive to load the bootable floppy from.\n"
         " -o partidx=#        Specify a hard disk partition number to mount as drive.\n"
         " -ro                 Mount image(s) read-only (or leading ':' for read-only).\n"
+        " -overlay mode       Keep writes in memory: discard (on unmount), commit (on\n"
+        "                     unmount) or commit every # seconds.\n"
         " -u                  Unmount the drive or drive number.\n"
         " \033[32;1m-examples           Show some usage examples.\033[0m"
     );
@@ -10213,14 +10511,16 @@ void DOS_SetupPrograms(void) {
     MSG_Add("PROGRAM_VHDMAKE_MERGEOKDELETE", "Snapshot VHD merged and deleted.\n");
     MSG_Add("PROGRAM_VHDMAKE_MERGEFAILED", "Failure while merging, aborted!\n");
     MSG_Add("PROGRAM_VHDMAKE_MERGEWARNCORRUPTION", " Parent \"%s\" contents could be corrupted!\n");
+    MSG_Add("PROGRAM_VHDMAKE_FLATREPORT", "%d blocks from \"%s\" and its parents copied into \"%s\".\n");
     MSG_Add("PROGRAM_VHDMAKE_ABSPATH", "Warning: an absolute path to parent prevents portability.\nPlease prefer a path relative to the differencing image file!\n");
     MSG_Add("PROGRAM_VHDMAKE_HELP",
         "Creates Dynamic or Differencing VHD images, converts raw images into Fixed VHD,\n"
-        "shows information about VHD images and merges them.\n"
+        "shows information about VHD images, merges and flattens them.\n"
         "\033[32;1mVHDMAKE\033[0m [-f] new.vhd size[BKMGT]\n"
         "\033[32;1mVHDMAKE\033[0m \033[34;1m-convert\033[0m raw.hdd new.vhd\n"
         "\033[32;1mVHDMAKE\033[0m [-f] \033[34;1m-link\033[0m parent.vhd new.vhd\n"
         "\033[32;1mVHDMAKE\033[0m \033[34;1m-merge\033[0m delta.vhd\n"
+        "\033[32;1mVHDMAKE\033[0m [-f] \033[34;1m-flatten\033[0m delta.vhd new.vhd\n"
         "\033[32;1mVHDMAKE\033[0m \033[34;1m-info\033[0m a.vhd\n"
         " -c | -convert  convert a raw hd image to Fixed VHD, renaming it to new.vhd\n"
         " -l | -link     create a new Differencing VHD new.vhd and link it to the\n"
@@ -10228,6 +10528,8 @@ void DOS_SetupPrograms(void) {
         " -f | -force    force overwriting a pre-existing image file\n"
         " -i | -info     show useful information about a.vhd image\n"
         " -m | -merge    merge differencing delta.vhd to its parent\n"
+        " -flat | -flatten copy delta.vhd and all its parents into a new standalone\n"
+        "                Dynamic VHD new.vhd\n"
         " new.vhd        name of the new Dynamic VHD image to create\n"
         " size           disk size (eventually with size unit, Bytes is implicit)\n"
         "When converting a raw disk image to Fixed VHD, it has to be partitioned with\n"
@@ -10362,6 +10664,14 @@ void DOS_SetupPrograms(void) {
     MSG_Add("PROGRAM_NMITEST_HELP", "Generates a non-maskable interrupt (NMI).\n\n"
             "NMITEST\n\nNote: This is a debugging tool to test if the interrupt handler works properly.\n");
     MSG_Add("PROGRAM_NMITEST_GENERATE_NMI","Generating a non-maskable interrupt (NMI)...\n");
+    MSG_Add("PROGRAM_CPUBENCH_HELP", "Measures how fast each CPU core runs a set of small loops.\n\n"
+            "CPUBENCH [-n millions] [-core name] [-kernel name] [-csv]\n\n"
+            "  -n       Million instructions per loop (default 20)\n"
+            "  -core    Only this core: normal, simple, full, prefetch, dynamic_x86, dynamic_rec\n"
+            "  -kernel  Only this loop: real16, real32, pmode32, paging, fpu, mmx, string\n"
+            "  -csv     Comma-separated output: core, kernel, instructions, seconds, instructions per second\n\n"
+            "Note: Runs unthrottled; loops the emulated CPU cannot run are skipped.\n");
+    MSG_Add("PROGRAM_CPUBENCH_NOMEM","Not enough conventional memory for the benchmark.\n");
     MSG_Add("PROGRAM_CAPMOUSE_HELP","Captures or releases the mouse inside DOSBox-X.\n\n"
             "CAPMOUSE [/C|/R]\n"
             "  /C Capture the mouse\n"
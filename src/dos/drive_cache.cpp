@@ -90,7 +90,7 @@ DOS_Drive_Cache::DOS_Drive_Cache(const char* path, DOS_Drive *drive) {
 
 DOS_Drive_Cache::~DOS_Drive_Cache(void) {
     Clear();
-    for (uint32_t i=0; i<MAX_OPENDIRS; i++) { DeleteFileInfo(dirFindFirst[i]); dirFindFirst[i]=nullptr; }
+    for (uint32_t i=0; i<MAX_OPENDIRS; i++) { delete dirFindFirst[i]; dirFindFirst[i]=nullptr; }
 }
 
 void DOS_Drive_Cache::Clear(void) {
@@ -219,7 +219,7 @@ void DOS_Drive_Cache::AddEntry(const char* path, bool checkExists) {
         strcpy(file,pos+1);
         // Check if file already exists, then don't add new entry...
         if (checkExists) {
-            if (GetLongName(dir,file)>=0) return;
+            if (FindLongName(dir,file)!=nullptr) return;
         }
 
         char sfile[DOS_NAMELENGTH];
@@ -367,7 +367,7 @@ void DOS_Drive_Cache::CacheOut(const char* path, bool ignoreLastDir) {
     }
     // clear lists
     dir->fileList.clear();
-    dir->longNameList.clear();
+    ClearIndexes(dir);
     save_dir = nullptr;
 }
 
@@ -384,78 +384,161 @@ bool DOS_Drive_Cache::GetShortName(const char* fullname, char* shortname) {
     const char* pos = strrchr_dbcs((char *)fullname,CROSS_FILESPLIT);
     if (pos) pos++; else return false;
 
-    std::vector<CFileInfo*>::size_type filelist_size = curDir->longNameList.size();
-    if (GCC_UNLIKELY(filelist_size<=0)) return false;
+    // Only entries that got a generated short name count
+    std::unordered_map<std::string,CFileInfo*>::const_iterator it = curDir->longNameIndex.find(pos);
+    if (it == curDir->longNameIndex.end() || it->second->shortNr == 0) return false;
 
-    // The orgname part of the list is not sorted (shortname is)! So we can only walk through it.
-    for(Bitu i = 0; i < filelist_size; i++) {
-#if defined (WIN32) || defined (OS2)                        /* Win 32 & OS/2*/
-        if (strcmp(pos,curDir->longNameList[i]->orgname) == 0) {
-#else
-        if (strcmp(pos,curDir->longNameList[i]->orgname) == 0) {
-#endif
-            strcpy(shortname,curDir->longNameList[i]->shortname);
-            return true;
-        }
+    strcpy(shortname,it->second->shortname);
+    return true;
+}
+
+// Key for the short name ID hint: the part of the name before the extension, at most 8 chars
+static std::string ShortNameKey(const char* name) {
+    return std::string(name,std::min<size_t>(strcspn(name,"."),8));
+}
+
+Bitu DOS_Drive_Cache::CreateShortNameID(CFileInfo* curDir, const char* name) {
+    // IDs are handed out incrementally per name, CreateShortName checks the result for collisions
+    std::unordered_map<std::string,Bitu>::const_iterator it = curDir->shortNrNext.find(ShortNameKey(name));
+    if (it == curDir->shortNrNext.end()) return 1;  // shortener IDs start with 1
+    return it->second;
+}
+
+// strcasecmp() compatible key for the case insensitive long name index
+static std::string FoldName(const char* name) {
+    std::string key(name);
+    for (size_t i=0; i<key.size(); i++) {
+        if (key[i] >= 'A' && key[i] <= 'Z') key[i] += 'a' - 'A';
     }
-    return false;
+    return key;
 }
 
-int DOS_Drive_Cache::CompareShortname(const char* compareName, const char* shortName) {
-    char const* cpos = strchr(shortName,'~');
-    if (cpos) {
-/* the following code is replaced as it's not safe when char* is 64 bits */
-/*      Bits compareCount1  = (int)cpos - (int)shortName;
-        char* endPos        = strchr(cpos,'.');
-        Bitu numberSize     = endPos ? int(endPos)-int(cpos) : strlen(cpos);
+void DOS_Drive_Cache::IndexEntry(CFileInfo* dir, CFileInfo* info) {
+    // first entry wins, same as a front to back search of the list would
+    dir->shortNameIndex.emplace(info->shortname,info);
+    dir->longNameIndex.emplace(info->orgname,info);
+    dir->longNameIndexNoCase.emplace(FoldName(info->orgname),info);
+}
+
+void DOS_Drive_Cache::ClearIndexes(CFileInfo* dir) {
+    dir->shortNameIndex.clear();
+    dir->longNameIndex.clear();
+    dir->longNameIndexNoCase.clear();
+    dir->shortNameStems.clear();
+    dir->shortNrNext.clear();
+}
 
-        char* lpos          = strchr(compareName,'.');
-        Bits compareCount2  = lpos ? int(lpos)-int(compareName) : strlen(compareName);
-        if (compareCount2>8) compareCount2 = 8;
+void DOS_Drive_Cache::RemoveEntry(CFileInfo* dir, CFileInfo* info) {
+    std::vector<CFileInfo*>::iterator it = std::find(dir->fileList.begin(),dir->fileList.end(),info);
+    if (it == dir->fileList.end()) return;
 
-        compareCount2 -= numberSize;
-        if (compareCount2>compareCount1) compareCount1 = compareCount2;
-*/
-        size_t compareCount1 = strcspn(shortName,"~");
-        size_t numberSize    = strcspn(cpos,".");
-        size_t compareCount2 = strcspn(compareName,".");
-        if(compareCount2 > 8) compareCount2 = 8;
-        /* We want
-         * compareCount2 -= numberSize;
-         * if (compareCount2>compareCount1) compareCount1 = compareCount2;
-         * but to prevent negative numbers:
-         */
-        if(compareCount2 > compareCount1 + numberSize)
-            compareCount1 = compareCount2 - numberSize;
-        return strncmp(compareName,shortName,compareCount1);
+    const Bitu index = (Bitu)(it - dir->fileList.begin());
+    dir->fileList.erase(it);
+    // Check if there are any open search dir that are affected by this...
+    for (uint32_t i=0; i<MAX_OPENDIRS; i++) {
+        if ((dirSearch[i]==dir) && (index<dirSearch[i]->nextEntry))
+            dirSearch[i]->nextEntry--;
     }
-    return strcmp(compareName,shortName);
+
+    std::unordered_map<std::string,CFileInfo*>::iterator ix = dir->shortNameIndex.find(info->shortname);
+    if (ix != dir->shortNameIndex.end() && ix->second == info) dir->shortNameIndex.erase(ix);
+    ix = dir->longNameIndex.find(info->orgname);
+    if (ix != dir->longNameIndex.end() && ix->second == info) dir->longNameIndex.erase(ix);
+    ix = dir->longNameIndexNoCase.find(FoldName(info->orgname));
+    if (ix != dir->longNameIndexNoCase.end() && ix->second == info) dir->longNameIndexNoCase.erase(ix);
+    if (info->shortNr) dir->shortNameStems.erase(std::string(info->shortname,strcspn(info->shortname,".")));
+
+    save_dir = nullptr;
+    DeleteFileInfo(info);
 }
 
-Bitu DOS_Drive_Cache::CreateShortNameID(CFileInfo* curDir, const char* name) {
-    std::vector<CFileInfo*>::size_type filelist_size = curDir->longNameList.size();
-    if (GCC_UNLIKELY(filelist_size<=0)) return 1;   // shortener IDs start with 1
-
-    Bitu foundNr    = 0;
-    Bits low        = 0;
-    Bits high       = (Bits)(filelist_size-1);
-
-    while (low<=high) {
-        Bits mid = (low+high)/2;
-        Bits res = CompareShortname(name,curDir->longNameList[(size_t)mid]->shortname);
-
-        if (res>0)  low  = mid+1; else
-        if (res<0)  high = mid-1;
-        else {
-            // any more same x chars in next entries ?
-            do {
-                foundNr = curDir->longNameList[(size_t)mid]->shortNr;
-                mid++;
-            } while((Bitu)mid<curDir->longNameList.size() && (CompareShortname(name,curDir->longNameList[(size_t)mid]->shortname)==0));
-            break;
+void DOS_Drive_Cache::WatchDir(CFileInfo* dir, const char* path) {
+    if (drive == nullptr || dir->watchId) return;
+
+    const uint32_t watchId = nextWatchId++;
+    if (drive->watchdir(path,watchId)) {
+        WatchedDir &w = watchDirs[watchId];
+        w.dir = dir;
+        w.path = path;
+        dir->watchId = watchId;
+    }
+}
+
+void DOS_Drive_Cache::ProcessHostChanges(void) {
+    if (drive == nullptr || watchDirs.empty()) return;
+
+    std::vector<uint32_t> changed;
+    if (!drive->read_dir_changes(changed)) {
+        LOG(LOG_DOSMISC,LOG_NORMAL)("DIRCACHE: Host dropped change notifications, rescanning %s",basePath);
+        EmptyCache();
+        return;
+    }
+    if (changed.empty()) return;
+
+    std::sort(changed.begin(),changed.end());
+    changed.erase(std::unique(changed.begin(),changed.end()),changed.end());
+    for (size_t i=0; i<changed.size(); i++) {
+        // refreshing a directory can drop watches of removed subdirectories, look each one up again
+        std::unordered_map<uint32_t,WatchedDir>::iterator it = watchDirs.find(changed[i]);
+        if (it == watchDirs.end()) continue;
+        const std::string path = it->second.path;
+        RefreshDir(it->second.dir,path.c_str());
+    }
+}
+
+void DOS_Drive_Cache::RefreshDir(CFileInfo* dir, const char* path) {
+    // Bring a cached directory in line with the host, entries that are still there are kept as they are
+    if (!IsCachedIn(dir) || dir->isOverlayDir) return;
+
+    struct HostEntry {
+        std::string name;
+        std::string sname;
+        bool is_directory;
+    };
+    std::vector<HostEntry> entries;
+    std::unordered_map<std::string,bool> present;
+
+    void* dirp = drive->opendir(path);
+    if (!dirp) return; // removed, the parent directory gets notified as well
+    char dir_name[CROSS_LEN], dir_sname[DOS_NAMELENGTH+1];
+    bool is_directory;
+    if (drive->read_directory_first(dirp, dir_name, dir_sname, is_directory)) {
+        do {
+            HostEntry e;
+            e.name = dir_name;
+            e.sname = dir_sname;
+            e.is_directory = is_directory;
+            entries.push_back(e);
+            present.emplace(e.name,is_directory);
+        } while (drive->read_directory_next(dirp, dir_name, dir_sname, is_directory));
+    }
+    drive->closedir(dirp);
+
+    // Drop what is gone, or turned from a file into a directory or the other way around
+    std::vector<CFileInfo*> stale;
+    for (size_t i=0; i<dir->fileList.size(); i++) {
+        CFileInfo* info = dir->fileList[i];
+        std::unordered_map<std::string,bool>::const_iterator it = present.find(info->orgname);
+        if (it == present.end() || it->second != info->isDir) stale.push_back(info);
+    }
+    for (size_t i=0; i<stale.size(); i++) RemoveEntry(dir,stale[i]);
+
+    // Add what is new
+    for (size_t i=0; i<entries.size(); i++) {
+        if (dir->longNameIndex.find(entries[i].name) != dir->longNameIndex.end()) continue;
+
+        char sname[CROSS_LEN];
+        strcpy(sname,CreateEntry(dir,entries[i].name.c_str(),entries[i].sname.c_str(),entries[i].is_directory));
+        Bits index = GetLongName(dir,sname);
+        if (index>=0) {
+            // Check if there are any open search dir that are affected by this...
+            for (uint32_t j=0; j<MAX_OPENDIRS; j++) {
+                if ((dirSearch[j]==dir) && ((uint32_t)index<=dirSearch[j]->nextEntry))
+                    dirSearch[j]->nextEntry++;
+            }
         }
+        save_dir = nullptr;
     }
-    return foundNr+1;
 }
 
 bool DOS_Drive_Cache::RemoveTrailingDot(char* shortname) {
@@ -525,52 +608,53 @@ static Bits wine_hash_short_file_name( char* name, char* buffer )
 #endif
 
 Bits DOS_Drive_Cache::GetLongName(CFileInfo* curDir, char* shortName) {
+    CFileInfo* info = FindLongName(curDir,shortName);
+    if (info == nullptr) return -1;
+
+    // Return array number of element, fileList is sorted by short name
+    std::vector<CFileInfo*>::iterator it = std::lower_bound(curDir->fileList.begin(),curDir->fileList.end(),info,SortByName);
+    if (it == curDir->fileList.end() || *it != info)
+        it = std::find(curDir->fileList.begin(),curDir->fileList.end(),info);
+    return (Bits)(it - curDir->fileList.begin());
+}
+
+DOS_Drive_Cache::CFileInfo* DOS_Drive_Cache::FindLongName(CFileInfo* curDir, char* shortName) {
     std::vector<CFileInfo*>::size_type filelist_size = curDir->fileList.size();
-    if (GCC_UNLIKELY(filelist_size<=0)) return -1;
+    if (GCC_UNLIKELY(filelist_size<=0)) return nullptr;
 
     // Remove dot, if no extension...
     RemoveTrailingDot(shortName);
-    // Search long name and return array number of element
-    Bits res;
-	Bits low	= 0;
-	Bits high	= (Bits)(filelist_size-1);
-	Bits mid;
-	while (low<=high) {
-		mid = (low+high)/2;
-		res = strcmp(shortName,curDir->fileList[mid]->shortname);
-		if (res>0)	low  = mid+1; else
-		if (res<0)	high = mid-1; else
-		{	// Found
-			strcpy(shortName,curDir->fileList[mid]->orgname);
-			return mid;
-		};
-	}
-	if (uselfn && strlen(shortName)) {
-		for (Bitu i=0; i<filelist_size; i++) {
-			if (!strcasecmp(shortName,curDir->fileList[i]->orgname)) {
-				strcpy(shortName,curDir->fileList[i]->orgname);
-				return (Bits)i;
-		    }
-		}
-	}
+    // Search long name and return the element
+    std::unordered_map<std::string,CFileInfo*>::const_iterator it = curDir->shortNameIndex.find(shortName);
+    if (it != curDir->shortNameIndex.end()) {
+        strcpy(shortName,it->second->orgname);
+        return it->second;
+    }
+    if (uselfn && strlen(shortName)) {
+        it = curDir->longNameIndexNoCase.find(FoldName(shortName));
+        if (it != curDir->longNameIndexNoCase.end()) {
+            strcpy(shortName,it->second->orgname);
+            return it->second;
+        }
+    }
 
 #ifdef WINE_DRIVE_SUPPORT
-    if (strlen(shortName) < 8 || shortName[4] != '~' || shortName[5] == '.' || shortName[6] == '.' || shortName[7] == '.') return -1; // not available
+    if (strlen(shortName) < 8 || shortName[4] != '~' || shortName[5] == '.' || shortName[6] == '.' || shortName[7] == '.') return nullptr; // not available
     // else it's most likely a Wine style short name ABCD~###, # = not dot  (length at least 8)
     // The above test is rather strict as the following loop can be really slow if filelist_size is large.
     char buff[CROSS_LEN];
     for (Bitu i = 0; i < filelist_size; i++) {
-        res = wine_hash_short_file_name(curDir->fileList[i]->orgname,buff);
+        Bits res = wine_hash_short_file_name(curDir->fileList[i]->orgname,buff);
         buff[res] = 0;
         if (!strcmp(shortName,buff)) {
             // Found
             strcpy(shortName,curDir->fileList[i]->orgname);
-            return (Bits)i;
+            return curDir->fileList[i];
         }
     }
 #endif
     // not available
-    return -1;
+    return nullptr;
 }
 
 bool DOS_Drive_Cache::RemoveSpaces(char* str) {
@@ -633,33 +717,39 @@ void DOS_Drive_Cache::CreateShortName(CFileInfo* curDir, CFileInfo* info) {
     if (!createShort) {
         char buffer[CROSS_LEN];
         strcpy(buffer,tmpName);
-        createShort = (GetLongName(curDir,buffer)>=0);
+        createShort = (FindLongName(curDir,buffer)!=nullptr);
     }
 
     if (createShort) {
         // Create number
         char buffer[8];
         info->shortNr = CreateShortNameID(curDir,tmpName);
-        if (GCC_UNLIKELY(info->shortNr > 9999999)) E_Exit("~9999999 same name files overflow");
-        sprintf(buffer, "%d", static_cast<unsigned int>(info->shortNr));
-        // Copy first letters
-        Bits tocopy = 0;
-        size_t buflen = strlen(buffer);
-        if ((size_t)len+buflen+1u>8u) {
-            tocopy = (Bits)(8u - buflen - 1u);
-            bool lead = false;
-            if (IS_PC98_ARCH || isDBCSCP())
-                for (int i=0; i<tocopy; i++) {
-                    if (lead) lead = false;
-                    else if ((IS_PC98_ARCH && shiftjis_lead_byte(tmpName[i]&0xFF)) || (isDBCSCP() && isKanji1_gbk(tmpName[i]&0xFF))) lead = true;
-                }
-            if (lead) tocopy--;
+        for (;;) {
+            if (GCC_UNLIKELY(info->shortNr > 9999999)) E_Exit("~9999999 same name files overflow");
+            sprintf(buffer, "%d", static_cast<unsigned int>(info->shortNr));
+            // Copy first letters
+            Bits tocopy = 0;
+            size_t buflen = strlen(buffer);
+            if ((size_t)len+buflen+1u>8u) {
+                tocopy = (Bits)(8u - buflen - 1u);
+                bool lead = false;
+                if (IS_PC98_ARCH || isDBCSCP())
+                    for (int i=0; i<tocopy; i++) {
+                        if (lead) lead = false;
+                        else if ((IS_PC98_ARCH && shiftjis_lead_byte(tmpName[i]&0xFF)) || (isDBCSCP() && isKanji1_gbk(tmpName[i]&0xFF))) lead = true;
+                    }
+                if (lead) tocopy--;
+            }
+            else                          tocopy = len;
+            safe_strncpy(info->shortname,tmpName,tocopy+1);
+            // Copy number
+            strcat(info->shortname,"~");
+            strcat(info->shortname,buffer);
+            // Done if no other generated name uses this one (the extension is not taken into account)
+            if (curDir->shortNameStems.insert(info->shortname).second) break;
+            info->shortNr++;
         }
-        else                          tocopy = len;
-        safe_strncpy(info->shortname,tmpName,tocopy+1);
-        // Copy number
-        strcat(info->shortname,"~");
-        strcat(info->shortname,buffer);
+        curDir->shortNrNext[ShortNameKey(tmpName)] = info->shortNr + 1;
         // Add (and cut) Extension, if available
         if (pos) {
             // Step to last extension...
@@ -669,29 +759,6 @@ void DOS_Drive_Cache::CreateShortName(CFileInfo* curDir, CFileInfo* info) {
             info->shortname[DOS_NAMELENGTH] = 0;
         }
 
-        // keep list sorted for CreateShortNameID to work correctly
-        if (curDir->longNameList.size()>0) {
-            if (!(strcmp(info->shortname,curDir->longNameList.back()->shortname)<0)) {
-                // append at end of list
-                curDir->longNameList.push_back(info);
-            } else {
-                // look for position where to insert this element
-                bool found=false;
-                std::vector<CFileInfo*>::iterator it;
-                for (it=curDir->longNameList.begin(); it!=curDir->longNameList.end(); ++it) {
-                    if (strcmp(info->shortname,(*it)->shortname)<0) {
-                        found = true;
-                        break;
-                    }
-                }
-                // Put it in longname list...
-                if (found) curDir->longNameList.insert(it,info);
-                else curDir->longNameList.push_back(info);
-            }
-        } else {
-            // empty file list, append
-            curDir->longNameList.push_back(info);
-        }
     } else {
         strcpy(info->shortname,tmpName);
     }
@@ -699,6 +766,9 @@ void DOS_Drive_Cache::CreateShortName(CFileInfo* curDir, CFileInfo* info) {
 }
 
 DOS_Drive_Cache::CFileInfo* DOS_Drive_Cache::FindDirInfo(const char* path, char* expandedPath) {
+    // Pick up changes made on the host first, this may replace dirBase
+    ProcessHostChanges();
+
     // statics
     static char split[2] = { CROSS_FILESPLIT,0 };
     char        dir  [CROSS_LEN];
@@ -742,7 +812,7 @@ DOS_Drive_Cache::CFileInfo* DOS_Drive_Cache::FindDirInfo(const char* path, char*
         else     { strcpy(dir,start); }
 
         // Path found
-        Bits nextDir = GetLongName(curDir,dir);
+        CFileInfo* nextDir = FindLongName(curDir,dir);
         strcat(expandedPath,dir);
 
         // Error check
@@ -751,8 +821,8 @@ DOS_Drive_Cache::CFileInfo* DOS_Drive_Cache::FindDirInfo(const char* path, char*
         };
 */
         // Follow Directory
-        if ((nextDir>=0) && curDir->fileList[(size_t)nextDir]->isDir) {
-            curDir = curDir->fileList[(size_t)nextDir];
+        if ((nextDir!=nullptr) && nextDir->isDir) {
+            curDir = nextDir;
             strcpy (curDir->orgname,dir);
             if (!IsCachedIn(curDir)) {
                 if (OpenDir(curDir,expandedPath,id)) {
@@ -834,45 +904,25 @@ char* DOS_Drive_Cache::CreateEntry(CFileInfo* dir, const char* name, const char*
     // Check for long filenames...
     if (sname[0]==0) CreateShortName(dir, info);
 
-    // keep list sorted (so GetLongName works correctly, used by CreateShortName in this routine)
+    // keep list sorted (so GetLongName can return the position of an entry)
     if (dir->fileList.size()>0 && !skipSort) {
         if (!(strcmp(info->shortname,dir->fileList.back()->shortname)<0)) {
             // append at end of list
             dir->fileList.push_back(info);
         } else {
-            bool found = false;
-            // look for position where to insert this element
-            std::vector<CFileInfo*>::iterator it;
-            for (it=dir->fileList.begin(); it!=dir->fileList.end(); ++it) {
-                if (strcmp(info->shortname,(*it)->shortname)<0) {
-                    found = true;
-                    break;
-                }
-            }
-            // Put file in lists
-            if (found) dir->fileList.insert(it,info);
-            else dir->fileList.push_back(info);
+            // insert after the last element that does not sort after this one
+            dir->fileList.insert(std::upper_bound(dir->fileList.begin(),dir->fileList.end(),info,SortByName),info);
         }
     } else {
         // empty file list, append
         dir->fileList.push_back(info);
     }
+    IndexEntry(dir,info);
 	static char sgenname[DOS_NAMELENGTH+1];
 	strcpy(sgenname, info->shortname);
 	return sgenname;
 }
 
-void DOS_Drive_Cache::CopyEntry(CFileInfo* dir, CFileInfo* from) {
-    CFileInfo* info = new CFileInfo;
-    // just copy things into new fileinfo
-    strcpy(info->orgname, from->orgname);
-    strcpy(info->shortname, from->shortname);
-    info->shortNr = from->shortNr;
-    info->isDir = from->isDir;
-
-    dir->fileList.push_back(info);
-}
-
 bool DOS_Drive_Cache::ReadDir(uint16_t id, char* &result, char * &lresult) {
     // shouldn't happen...
     if (id>=MAX_OPENDIRS) return false;
@@ -903,6 +953,9 @@ bool DOS_Drive_Cache::ReadDir(uint16_t id, char* &result, char * &lresult) {
         // close dir
         drive->closedir(dirp);
 
+        // Follow host side changes from now on
+        WatchDir(dirSearch[id],dirPath);
+
         // Info
 /*      if (!dirp) {
             LOG_DEBUG("DIR: Error Caching in %s",dirPath);
@@ -940,7 +993,8 @@ bool DOS_Drive_Cache::SetResult(CFileInfo* dir, char* &result, char* &lresult, B
 }
 
 // FindFirst / FindNext
-bool DOS_Drive_Cache::FindFirst(char* path, uint16_t& id) {
+// With a pattern, only the entries matching it are kept for FindNext.
+bool DOS_Drive_Cache::FindFirst(char* path, uint16_t& id, const char* pattern) {
     uint16_t  dirID;
     // Cache directory in
     if (!OpenDir(path,dirID)) return false;
@@ -965,28 +1019,43 @@ bool DOS_Drive_Cache::FindFirst(char* path, uint16_t& id) {
         this->nextFreeFindFirst = 1; //the next free one after this search
         for(Bitu n=0; n<MAX_OPENDIRS;n++) {
             // Clear and reuse slot
-            DeleteFileInfo(dirFindFirst[n]);
+            delete dirFindFirst[n];
             dirFindFirst[n]=nullptr;
         }
 
     }
-    dirFindFirst[dirFindFirstID] = new CFileInfo();
-    dirFindFirst[dirFindFirstID]-> nextEntry    = 0;
 
-    // Copy entries to use with FindNext
-    for (Bitu i=0; i<dirSearch[dirID]->fileList.size(); i++) {
-        CopyEntry(dirFindFirst[dirFindFirstID],dirSearch[dirID]->fileList[i]);
+    // Pick the matching entries
+    std::vector<CFileInfo*> found;
+    const std::vector<CFileInfo*>& fileList = dirSearch[dirID]->fileList;
+    found.reserve(pattern ? 16 : fileList.size());
+    for (Bitu i=0; i<fileList.size(); i++) {
+        CFileInfo* info = fileList[i];
+        if (!pattern || WildFileCmp(info->shortname,pattern) || LWildFileCmp(info->orgname,pattern))
+            found.push_back(info);
     }
-    // Now re-sort the fileList accordingly to output
+    // Now re-sort them accordingly to output
     switch (sortDirType) {
         case ALPHABETICAL       : break;
-//      case ALPHABETICAL       : std::sort(dirFindFirst[dirFindFirstID]->fileList.begin(), dirFindFirst[dirFindFirstID]->fileList.end(), SortByName);      break;
-        case DIRALPHABETICAL    : std::sort(dirFindFirst[dirFindFirstID]->fileList.begin(), dirFindFirst[dirFindFirstID]->fileList.end(), SortByDirName);       break;
-        case ALPHABETICALREV    : std::sort(dirFindFirst[dirFindFirstID]->fileList.begin(), dirFindFirst[dirFindFirstID]->fileList.end(), SortByNameRev);       break;
-        case DIRALPHABETICALREV : std::sort(dirFindFirst[dirFindFirstID]->fileList.begin(), dirFindFirst[dirFindFirstID]->fileList.end(), SortByDirNameRev);    break;
+//      case ALPHABETICAL       : std::sort(found.begin(), found.end(), SortByName);      break;
+        case DIRALPHABETICAL    : std::sort(found.begin(), found.end(), SortByDirName);       break;
+        case ALPHABETICALREV    : std::sort(found.begin(), found.end(), SortByNameRev);       break;
+        case DIRALPHABETICALREV : std::sort(found.begin(), found.end(), SortByDirNameRev);    break;
         case NOSORT             : break;
     }
 
+    // and pack them for FindNext
+    FindSnapshot* snap = new FindSnapshot;
+    snap->entries.reserve(found.size());
+    for (CFileInfo* info : found) {
+        const size_t slen = strlen(info->shortname) + 1, llen = strlen(info->orgname) + 1;
+        snap->entries.push_back((uint32_t)snap->names.size());
+        snap->names.insert(snap->names.end(), info->shortname, info->shortname + slen);
+        snap->names.insert(snap->names.end(), info->orgname, info->orgname + llen);
+    }
+    snap->dirPath = dirPath;
+    dirFindFirst[dirFindFirstID] = snap;
+
 //  LOG(LOG_DOSMISC,LOG_ERROR)("DIRCACHE: FindFirst : %s (ID:%02X)",path,dirFindFirstID);
     id = dirFindFirstID;
     return true;
@@ -998,14 +1067,24 @@ bool DOS_Drive_Cache::FindNext(uint16_t id, char* &result, char* &lresult) {
         LOG(LOG_DOSMISC,LOG_ERROR)("DIRCACHE: FindFirst/Next failure : ID out of range: %04X",id);
         return false;
     }
-    if (!SetResult(dirFindFirst[id], result, lresult, dirFindFirst[id]->nextEntry)) {
+    FindSnapshot* snap = dirFindFirst[id];
+    if (snap->next >= snap->entries.size()) {
         // free slot
-        DeleteFileInfo(dirFindFirst[id]); dirFindFirst[id] = nullptr;
+        delete snap; dirFindFirst[id] = nullptr;
         return false;
     }
+    // valid until the search ends
+    result = &snap->names[snap->entries[snap->next++]];
+    lresult = result + strlen(result) + 1;
     return true;
 }
 
+// Host directory of a search started with FindFirst, NULL once it has ended
+const char* DOS_Drive_Cache::FindDirPath(uint16_t id) {
+    if ((id>=MAX_OPENDIRS) || !dirFindFirst[id]) return NULL;
+    return dirFindFirst[id]->dirPath.c_str();
+}
+
 void DOS_Drive_Cache::ClearFileInfo(CFileInfo *dir) {
     for(uint32_t i=0; i<dir->fileList.size(); i++) {
         if (CFileInfo *info = dir->fileList[i])
@@ -1015,6 +1094,12 @@ void DOS_Drive_Cache::ClearFileInfo(CFileInfo *dir) {
         dirSearch[dir->id] = nullptr;
         dir->id = MAX_OPENDIRS;
     }
+    if (dir->watchId) {
+        if (drive) drive->unwatchdir(dir->watchId);
+        watchDirs.erase(dir->watchId);
+        dir->watchId = 0;
+    }
+    if (dir == save_dir) save_dir = nullptr;
 }
 
 void DOS_Drive_Cache::DeleteFileInfo(CFileInfo *dir) {
@@ -33,6 +33,7 @@
 #include "bios.h"
 #include "bios_disk.h"
 #include "qcow2_disk.h"
+#include "ide.h"
 #include "bitop.h"
 #include "callback.h"
 #include "regs.h"
@@ -257,6 +258,7 @@ class fatFile : public DOS_File {
                 uint32_t currentSector = 0;
                 uint32_t curSectOff = 0;
                 uint8_t sectorBuffer[SECTOR_SIZE_MAX];
+                fatDrive::clusterChainMemory chainMap;
                 /* Record of where in the directory structure this file is located */
                 uint32_t dirCluster = 0;
                 uint32_t dirIndex = 0;
@@ -376,7 +378,7 @@ bool fatFile::Read(uint8_t * data, uint16_t *size) {
 	}
 
 	if (!loadedSector) {
-		currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+		currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &chainMap);
 		if(currentSector == 0) {
 			/* EOC reached before EOF */
 			*size = 0;
@@ -398,7 +400,7 @@ bool fatFile::Read(uint8_t * data, uint16_t *size) {
 		data[sizecount++] = sectorBuffer[curSectOff++];
 		seekpos++;
 		if(curSectOff >= myDrive->getSectorSize()) {
-			currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+			currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &chainMap);
 			if(currentSector == 0) {
 				/* EOC reached before EOF */
 				//LOG_MSG("EOC reached before EOF, seekpos %d, filelen %d", seekpos, filelength);
@@ -472,7 +474,7 @@ bool fatFile::Write(const uint8_t * data, uint16_t *size) {
 				firstCluster = myDrive->getFirstFreeClust();
 				if(firstCluster == 0) goto finalizeWrite; // out of space
 				myDrive->allocateCluster(firstCluster, 0);
-				currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+				currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &chainMap);
 				if (currentSector == 0) {
 					/* I guess allocateCluster() didn't work after all. This check is necessary to prevent
 					 * this condition from treating the BOOT SECTOR as a file. */
@@ -483,12 +485,12 @@ bool fatFile::Write(const uint8_t * data, uint16_t *size) {
 				loadedSector = true;
 			}
 			if (!loadedSector) {
-				currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+				currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &chainMap);
 				if(currentSector == 0) {
 					/* EOC reached before EOF - try to increase file allocation */
 					myDrive->appendCluster(firstCluster);
 					/* Try getting sector again */
-					currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+					currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &chainMap);
 					if(currentSector == 0) {
 						/* No can do. lets give up and go home.  We must be out of room */
 						goto finalizeWrite;
@@ -508,13 +510,13 @@ bool fatFile::Write(const uint8_t * data, uint16_t *size) {
 			if(loadedSector) myDrive->writeSector(currentSector, sectorBuffer);
 			loadedSector = false;
 
-			currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+			currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &chainMap);
 			if(currentSector == 0) {
 			    if (sizedec == 0) goto finalizeWrite;
 				/* EOC reached before EOF - try to increase file allocation */
 				myDrive->appendCluster(firstCluster);
 				/* Try getting sector again */
-				currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+				currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &chainMap);
 				if(currentSector == 0) {
 					/* No can do. lets give up and go home.  We must be out of room */
 					goto finalizeWrite;
@@ -561,7 +563,7 @@ bool fatFile::Seek(uint32_t *pos, uint32_t type) {
 
 	if(seekto<0) seekto = 0;
 	seekpos = (uint32_t)seekto;
-	currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+	currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &chainMap);
 	if (currentSector == 0) {
 		/* not within file size, thus no sector is available */
 		loadedSector = false;
@@ -619,6 +621,59 @@ uint32_t fatDrive::getClustFirstSect(uint32_t clustNum) {
 	return ((clustNum - 2) * BPB.v.BPB_SecPerClus) + firstDataSector;
 }
 
+/* Return a pointer to the given FAT sector (and the one after it for FAT12, where an entry
+ * can straddle a sector boundary). Serves from fatCache, loading the sectors on first use,
+ * unless the FAT is too large to cache in which case fatSectBuffer is used as before. */
+uint8_t *fatDrive::getFatSectors(uint32_t fatsectnum) {
+	const uint32_t bps = BPB.v.BPB_BytsPerSec;
+	const uint32_t fatstart = BPB.v.BPB_RsvdSecCnt + partSectOff;
+	const uint32_t fatsize = BPB.is_fat32() ? BPB.v32.BPB_FATSz32 : BPB.v.BPB_FATSz16;
+
+	if (fatCacheLoaded.empty() && fatsize != 0 && ((uint64_t)fatsize * bps) <= (64ull << 20ull)) {
+		/* one extra sector so that a FAT12 entry at the very end can be read as 16 bits */
+		fatCache.assign(((size_t)fatsize + 1u) * bps, 0);
+		fatCacheLoaded.assign(fatsize, false);
+	}
+
+	if (fatCacheLoaded.empty()) {
+		assert((bps * (Bitu)2) <= sizeof(fatSectBuffer));
+
+		if(curFatSect != fatsectnum) {
+			/* Load two sectors at once for FAT12 */
+			readSector(fatsectnum, &fatSectBuffer[0]);
+			if (fattype==FAT12)
+				readSector(fatsectnum+1, &fatSectBuffer[bps]);
+			curFatSect = fatsectnum;
+		}
+
+		return fatSectBuffer;
+	}
+
+	const uint32_t index = fatsectnum - fatstart;
+	const uint32_t count = (fattype == FAT12) ? 2u : 1u;
+
+	assert(index < fatsize);
+	for (uint32_t i=index;i < (index+count) && i < fatsize;i++) {
+		if (!fatCacheLoaded[i]) {
+			readSector(fatstart + i, &fatCache[(size_t)i * bps]);
+			fatCacheLoaded[i] = true;
+		}
+	}
+
+	return &fatCache[(size_t)index * bps];
+}
+
+void fatDrive::invalidateFatCache(void) {
+	fatCache.clear();
+	fatCacheLoaded.clear();
+	curFatSect = 0xffffffff;
+	chainGeneration++;
+}
+
+void fatDrive::MediaChange(void) {
+	invalidateFatCache();
+}
+
 uint32_t fatDrive::getClusterValue(uint32_t clustNum) {
 	uint32_t fatoffset=0;
 	uint32_t fatsectnum;
@@ -654,19 +709,11 @@ uint32_t fatDrive::getClusterValue(uint32_t clustNum) {
         }
     }
 
-    assert((BPB.v.BPB_BytsPerSec * (Bitu)2) <= sizeof(fatSectBuffer));
-
-	if(curFatSect != fatsectnum) {
-		/* Load two sectors at once for FAT12 */
-		readSector(fatsectnum, &fatSectBuffer[0]);
-		if (fattype==FAT12)
-			readSector(fatsectnum+1, &fatSectBuffer[BPB.v.BPB_BytsPerSec]);
-		curFatSect = fatsectnum;
-	}
+	uint8_t *fatbuf = getFatSectors(fatsectnum);
 
 	switch(fattype) {
 		case FAT12:
-			clustValue = var_read((uint16_t*)&fatSectBuffer[fatentoff]);
+			clustValue = var_read((uint16_t*)&fatbuf[fatentoff]);
 			if(clustNum & 0x1) {
 				clustValue >>= 4;
 			} else {
@@ -674,10 +721,10 @@ uint32_t fatDrive::getClusterValue(uint32_t clustNum) {
 			}
 			break;
 		case FAT16:
-			clustValue = var_read((uint16_t*)&fatSectBuffer[fatentoff]);
+			clustValue = var_read((uint16_t*)&fatbuf[fatentoff]);
 			break;
 		case FAT32:
-			clustValue = var_read((uint32_t*)&fatSectBuffer[fatentoff]) & 0x0FFFFFFFul; /* Well, actually it's FAT28. Upper 4 bits are "reserved". */
+			clustValue = var_read((uint32_t*)&fatbuf[fatentoff]) & 0x0FFFFFFFul; /* Well, actually it's FAT28. Upper 4 bits are "reserved". */
 			break;
 	}
 
@@ -718,19 +765,16 @@ void fatDrive::setClusterValue(uint32_t clustNum, uint32_t clustValue) {
         }
     }
 
-    assert((BPB.v.BPB_BytsPerSec * (Bitu)2) <= sizeof(fatSectBuffer));
+	/* Freeing a cluster, or relinking one that pointed to another, changes a chain that
+	 * an open file may have mapped already. Extending a chain past its EOF does not. */
+	if (clustValue == 0 || !iseofFAT(getClusterValue(clustNum)))
+		chainGeneration++;
 
-	if(curFatSect != fatsectnum) {
-		/* Load two sectors at once for FAT12 */
-		readSector(fatsectnum, &fatSectBuffer[0]);
-		if (fattype==FAT12)
-			readSector(fatsectnum+1, &fatSectBuffer[BPB.v.BPB_BytsPerSec]);
-		curFatSect = fatsectnum;
-	}
+	uint8_t *fatbuf = getFatSectors(fatsectnum);
 
 	switch(fattype) {
 		case FAT12: {
-			uint16_t tmpValue = var_read((uint16_t *)&fatSectBuffer[fatentoff]);
+			uint16_t tmpValue = var_read((uint16_t *)&fatbuf[fatentoff]);
 			if(clustNum & 0x1) {
 				clustValue &= 0xfff;
 				clustValue <<= 4;
@@ -742,21 +786,21 @@ void fatDrive::setClusterValue(uint32_t clustNum, uint32_t clustValue) {
 				tmpValue &= 0xf000;
 				tmpValue |= (uint16_t)clustValue;
 			}
-			var_write((uint16_t *)&fatSectBuffer[fatentoff], tmpValue);
+			var_write((uint16_t *)&fatbuf[fatentoff], tmpValue);
 			break;
 			}
 		case FAT16:
-			var_write(((uint16_t *)&fatSectBuffer[fatentoff]), (uint16_t)clustValue);
+			var_write(((uint16_t *)&fatbuf[fatentoff]), (uint16_t)clustValue);
 			break;
 		case FAT32:
-			var_write(((uint32_t *)&fatSectBuffer[fatentoff]), clustValue);
+			var_write(((uint32_t *)&fatbuf[fatentoff]), clustValue);
 			break;
 	}
 	for(unsigned int fc=0;fc<BPB.v.BPB_NumFATs;fc++) {
-		writeSector(fatsectnum + (fc * (BPB.is_fat32() ? BPB.v32.BPB_FATSz32 : BPB.v.BPB_FATSz16)), &fatSectBuffer[0]);
+		writeSector(fatsectnum + (fc * (BPB.is_fat32() ? BPB.v32.BPB_FATSz32 : BPB.v.BPB_FATSz16)), &fatbuf[0]);
 		if (fattype==FAT12) {
 			if (fatentoff >= (BPB.v.BPB_BytsPerSec-1U))
-				writeSector(fatsectnum+1u+(fc * (BPB.is_fat32() ? BPB.v32.BPB_FATSz32 : BPB.v.BPB_FATSz16)), &fatSectBuffer[BPB.v.BPB_BytsPerSec]);
+				writeSector(fatsectnum+1u+(fc * (BPB.is_fat32() ? BPB.v32.BPB_FATSz32 : BPB.v.BPB_FATSz16)), &fatbuf[BPB.v.BPB_BytsPerSec]);
 		}
 	}
 }
@@ -1066,6 +1110,7 @@ bool fatDrive::getDirClustNum(const char *dir, uint32_t *clustNum, bool parDir)
    (instead of fatDrive's, which can differ), VHD access works fine, and
    RAW images keep working.  2023.05.11 - maxpat78 */
 uint8_t fatDrive::readSector(uint32_t sectnum, void * data) {
+	IDE_AsyncIO_Drain(); /* don't access the image while IDE emulation is */
 	if (absolute) return Read_AbsoluteSector(sectnum, data);
     assert(!IS_PC98_ARCH);
 #ifdef OLD_CHS_CONVERSION
@@ -1085,6 +1130,31 @@ uint8_t fatDrive::readSector(uint32_t sectnum, void * data) {
 }	
 
 uint8_t fatDrive::writeSector(uint32_t sectnum, void * data) {
+	/* Keep the FAT cache coherent with writes that did not come from setClusterValue(),
+	 * such as INT 26h absolute disk writes. */
+	if (!unformatted) {
+		const uint32_t fatstart = BPB.v.BPB_RsvdSecCnt + partSectOff;
+		const uint32_t fatsize = BPB.is_fat32() ? BPB.v32.BPB_FATSz32 : BPB.v.BPB_FATSz16;
+
+		if (sectnum >= fatstart && sectnum < (fatstart + fatsize)) {
+			const uint32_t index = sectnum - fatstart;
+
+			if (index < fatCacheLoaded.size()) {
+				uint8_t *cached = &fatCache[(size_t)index * BPB.v.BPB_BytsPerSec];
+				if (cached != data) {
+					memcpy(cached, data, BPB.v.BPB_BytsPerSec);
+					fatCacheLoaded[index] = true;
+					chainGeneration++;
+				}
+			}
+			else if (data != fatSectBuffer && data != &fatSectBuffer[BPB.v.BPB_BytsPerSec]) {
+				curFatSect = 0xffffffff;
+				chainGeneration++;
+			}
+		}
+	}
+
+	IDE_AsyncIO_Drain(); /* don't access the image while IDE emulation is */
 	if (absolute) return Write_AbsoluteSector(sectnum, data);
     assert(!IS_PC98_ARCH);
 #ifdef OLD_CHS_CONVERSION
@@ -1151,15 +1221,24 @@ uint32_t fatDrive::getAbsoluteSectFromChain(uint32_t startClustNum, uint32_t log
 
 	uint32_t currentClust = startClustNum;
 
-	if (ccm != NULL && ccm->current_cluster_no >= 2) {
-		/* If the cluster index is the same as last time or farther down, avoid re-reading the
-		 * entire allocation chain again and start from where we last read from. If the
-		 * cluster index is going back from current, then re-read the entire allocation chain again.
-		 * This is the nature of a singly-linked file allocation table and is the reason seek()
-		 * is faster going forward than backwards in MS-DOS, especially on FAT32 partitions. */
-		if (targClust >= ccm->current_cluster_index) {
-			indxClust = ccm->current_cluster_index;
-			currentClust = ccm->current_cluster_no;
+	if (ccm != NULL) {
+		/* Remember every cluster of the chain walked so far. A singly-linked file allocation
+		 * table otherwise has to be walked from the start for every backwards seek, which is
+		 * why seek() is slow in MS-DOS on large files, especially on FAT32 partitions. */
+		if (ccm->first_cluster != startClustNum || ccm->generation != chainGeneration || ccm->chain.empty()) {
+			ccm->chain.clear();
+			ccm->chain.push_back(startClustNum);
+			ccm->first_cluster = startClustNum;
+			ccm->generation = chainGeneration;
+		}
+
+		if (targClust < ccm->chain.size()) {
+			currentClust = ccm->chain[targClust];
+			indxClust = targClust;
+		}
+		else {
+			indxClust = (uint32_t)(ccm->chain.size() - 1u);
+			currentClust = ccm->chain.back();
 		}
 	}
 
@@ -1173,15 +1252,11 @@ uint32_t fatDrive::getAbsoluteSectFromChain(uint32_t startClustNum, uint32_t log
 		}
 
 		currentClust = testvalue;
+		if (ccm != NULL) ccm->chain.push_back(currentClust);
 	}
 
 	assert(indxClust<=targClust);
 
-	if (ccm != NULL) {
-		ccm->current_cluster_index = currentClust;
-		ccm->current_cluster_no = indxClust;
-	}
-
 	/* this should not happen! */
 	assert(currentClust != 0);
 
@@ -1476,14 +1551,10 @@ uint8_t fatDrive::Read_AbsoluteSector(uint32_t sectnum, void * data) {
         unsigned int c = sector_size / lsz;
 
         if (c != 0 && (sector_size % lsz) == 0) {
-            uint32_t ssect = (sectnum * c) + physToLogAdj;
-
-            while (c-- != 0) {
-                if (loadedDisk->Read_AbsoluteSector(ssect++,data) != 0)
-                    return 0x05;
+            const uint32_t ssect = (sectnum * c) + physToLogAdj;
 
-                data = (void*)((char*)data + lsz);
-            }
+            if (loadedDisk->Read_AbsoluteSectors(ssect,c,data) != 0)
+                return 0x05;
 
             return 0;
         }
@@ -1499,14 +1570,10 @@ uint8_t fatDrive::Write_AbsoluteSector(uint32_t sectnum, void * data) {
         unsigned int c = sector_size / lsz;
 
         if (c != 0 && (sector_size % lsz) == 0) {
-            uint32_t ssect = (sectnum * c) + physToLogAdj;
-
-            while (c-- != 0) {
-                if (loadedDisk->Write_AbsoluteSector(ssect++,data) != 0)
-                    return 0x05;
+            const uint32_t ssect = (sectnum * c) + physToLogAdj;
 
-                data = (void*)((char*)data + lsz);
-            }
+            if (loadedDisk->Write_AbsoluteSectors(ssect,c,data) != 0)
+                return 0x05;
 
             return 0;
         }
@@ -1572,6 +1639,8 @@ void fatDrive::fatDriveInit(const char *sysFilename, uint32_t bytesector, uint32
 	bool pc98_512_to_1024_allow = false;
 	int opt_partition_index = -1;
 	int int13 = -1;
+	bool overlay = false, overlay_commit = false;
+	uint32_t overlay_interval = 0;
 	bool is_hdd = (filesize > 2880);
 	if(!is_hdd) {
 		char* ext = strrchr((char*)sysFilename, '.');
@@ -1616,6 +1685,10 @@ void fatDrive::fatDriveInit(const char *sysFilename, uint32_t bytesector, uint32
 			if (!value.empty())
 				int13 = strtoul(value.c_str(),NULL,0);
 		}
+		else if (name == "overlay") {
+			overlay = imageDiskMemory::ParseOverlayMode(value,&overlay_commit,&overlay_interval);
+			if (!overlay) LOG_MSG("FAT: overlay mode '%s' not recognized",value.c_str());
+		}
 		else {
 			LOG(LOG_DOSMISC,LOG_DEBUG)("FAT: option '%s' = '%s' ignored, unknown",name.c_str(),value.c_str());
 		}
@@ -1629,6 +1702,14 @@ void fatDrive::fatDriveInit(const char *sysFilename, uint32_t bytesector, uint32
 		loadedDisk = x;
 	}
 
+	/* writes go to a copy-on-write memory image on top of the disk, the disk itself stays untouched unless committed */
+	if (overlay) {
+		imageDiskMemory *x = new imageDiskMemory(loadedDisk);
+		x->SetCommitMode(overlay_commit,overlay_interval);
+		loadedDisk = x;
+		readonly = false;
+	}
+
 	loadedDisk->Addref();
 	bool isipl1 = false;
 
@@ -2476,6 +2557,8 @@ void fatDrive::SetBPB(const FAT_BootSector::bpb_union_t &bpb) {
 	bootbuffer.bpb.v=BPB.v;
 	loadedDisk->Write_AbsoluteSector(0+partSectOff,&bootbuffer);
 
+	invalidateFatCache();
+
 	/* Get size of root dir in sectors */
 	uint32_t RootDirSectors;
 	uint32_t DataSectors;
@@ -3699,8 +3782,9 @@ uint32_t fatDrive::GetHighestClusterNumber(void) {
 }
 
 void fatDrive::clusterChainMemory::clear(void) {
-	current_cluster_no = 0;
-	current_cluster_index = 0;
+	chain.clear();
+	first_cluster = 0;
+	generation = 0;
 }
 
 void fatDrive::checkDiskChange(void) {
@@ -3774,7 +3858,7 @@ void fatDrive::checkDiskChange(void) {
 		cwdDirCluster = 0;
 
 		memset(fatSectBuffer,0,1024);
-		curFatSect = 0xffffffff;
+		invalidateFatCache();
 
 		LOG(LOG_MISC,LOG_DEBUG)("NEW FAT: data=%llu root=%llu rootdirsect=%lu datasect=%lu",
 			(unsigned long long)firstDataSector,(unsigned long long)firstRootDirSect,
@@ -27,6 +27,7 @@
 #include "dosbox.h"
 #include "byteorder.h"
 #include "dos_system.h"
+#include "hostmem.h"
 #include "logging.h"
 #include "support.h"
 #include "drives.h"
@@ -815,16 +816,10 @@ unsigned int isoDrive::UDFextent_read(struct UDFextents &ex,unsigned char *buf,s
 			uint32_t sector = exs.ex.ExtentLocation + ((ex.relofs-sctofs) / (uint32_t)COOKED_SECTOR_SIZE);
 
 			if (sctodo != size_t(0)) {
-				if (ex.sector_buffer_n != sector) {
-					ex.sector_buffer_n = 0xFFFFFFFFu;
-					ex.sector_buffer.resize(COOKED_SECTOR_SIZE);
-					if (readSector(&ex.sector_buffer[0], (unsigned int)sector))
-						ex.sector_buffer_n = sector;
-					else
-						break;
-				}
+				const uint8_t *src = readSectorCached(sector);
+				if (src == NULL) break;
 
-				memcpy(buf,&ex.sector_buffer[sctofs],sctodo);
+				memcpy(buf,&src[sctofs],sctodo);
 				ex.relofs += sctodo;
 				count -= sctodo;
 				buf += sctodo;
@@ -859,8 +854,6 @@ public:
 	bool udf = false;
 private:
 	isoDrive *drive;
-    uint8_t buffer[ISO_FRAMESIZE] = {};
-    int cachedSector = -1;
 	uint32_t fileBegin;
 	uint32_t filePos;
 	uint32_t fileEnd;
@@ -889,14 +882,13 @@ bool isoFile::Read(uint8_t *data, uint16_t *size) {
 		*size = (uint16_t)(fileEnd - filePos);
 	
 	uint16_t nowSize = 0;
-	int sector = (int)(filePos / ISO_FRAMESIZE);
+	uint32_t sector = filePos / ISO_FRAMESIZE;
 	uint16_t sectorPos = (uint16_t)(filePos % ISO_FRAMESIZE);
-	
-	if (sector != cachedSector) {
-		if (drive->readSector(buffer, (unsigned int)sector)) cachedSector = sector;
-		else { *size = 0; cachedSector = -1; }
-	}
+
 	while (nowSize < *size) {
+		const uint8_t *buffer = drive->readSectorCached(sector);
+		if (buffer == NULL) break;
+
 		uint16_t remSector = ISO_FRAMESIZE - sectorPos;
 		uint16_t remSize = *size - nowSize;
 		if(remSector < remSize) {
@@ -904,16 +896,10 @@ bool isoFile::Read(uint8_t *data, uint16_t *size) {
 			nowSize += remSector;
 			sectorPos = 0;
 			sector++;
-			cachedSector++;
-			if (!drive->readSector(buffer, (unsigned int)sector)) {
-				*size = nowSize;
-				cachedSector = -1;
-			}
 		} else {
 			memcpy(&data[nowSize], &buffer[sectorPos], remSize);
 			nowSize += remSize;
 		}
-			
 	}
 	
 	*size = nowSize;
@@ -1053,7 +1039,9 @@ isoDrive::isoDrive(char driveLetter, const char* fileName, uint8_t mediaid, int&
 	}
 }
 
-isoDrive::~isoDrive() { }
+isoDrive::~isoDrive() {
+	ClearCaches();
+}
 
 void isoDrive::setFileName(const char* fileName) {
 	safe_strncpy(this->fileName, fileName, CROSS_LEN);
@@ -1095,6 +1083,7 @@ int isoDrive::UpdateMscdex(char driveLetter, const char* path, uint8_t& subUnit)
 }
 
 void isoDrive::Activate(void) {
+	ClearCaches();
 	UpdateMscdex(driveLetter, fileName, subUnit);
 }
 
@@ -1188,6 +1177,7 @@ bool isoDrive::FindFirst(const char *dir, DOS_DTA &dta, bool fcb_findfirst) {
 		int dirIterator = GetDirIterator(fe);
 		bool isRoot = (*dir == 0);
 		dirIterators[dirIterator].root = isRoot;
+		UDFFileEntryToExtents(dirIterators[dirIterator].udfdirext,fe);
 		if (lfn_filefind_handle>=LFN_FILEFIND_MAX)
 			dta.SetDirID((uint16_t)dirIterator);
 		else
@@ -1208,7 +1198,6 @@ bool isoDrive::FindFirst(const char *dir, DOS_DTA &dta, bool fcb_findfirst) {
 			}
 		}
 
-		UDFFileEntryToExtents(dirIterators[dirIterator].udfdirext,fe);
 		return FindNext(dta);
 	}
 	else {
@@ -1253,19 +1242,24 @@ bool isoDrive::FindNext(DOS_DTA &dta) {
 	dta.GetSearchParams(attr, pattern, false);
 
 	int dirIterator = lfn_filefind_handle>=LFN_FILEFIND_MAX?dta.GetDirID():sdid[lfn_filefind_handle];
-	bool isRoot = dirIterators[dirIterator].root;
+	DirIterator &it = dirIterators[dirIterator];
+	bool isRoot = it.root;
+	const std::vector<DirIndexEntry> &entries = GetDirIndex(it);
 
 	if (is_udf) {
-		UDFFileIdentifierDescriptor fid;
-		UDFFileEntry fe;
-		while (GetNextDirEntry(dirIterator, fid, fe, dirIterators[dirIterator].udfdirext, fname, dirIterators[dirIterator].index)) {
+		while (it.valid && it.indexPos < entries.size()) {
+			const DirIndexEntry &ent = entries[it.indexPos++];
+			const UDFFileIdentifierDescriptor &fid = ent.fid;
+			const UDFFileEntry &fe = ent.fe;
+			safe_strncpy(fname, ent.shortName.c_str(), LFN_NAMELENGTH);
+
 			uint8_t findAttr = DOS_ATTR_ARCHIVE | DOS_ATTR_READ_ONLY;
 			if (fid.FileCharacteristics & 0x02/*Directory*/) findAttr |= DOS_ATTR_DIRECTORY;
 
 			/* skip parent directory */
 			if (fid.LengthOfFileIdentifier == 0 || (fid.FileCharacteristics & 0x08)) continue;
 
-			strcpy(lfindName,fullname);
+			safe_strncpy(lfindName, ent.longName.c_str(), ISO_MAXPATHNAME);
 			if (!(isRoot && fname[0]=='.') && (WildFileCmp((char*)fname, pattern) || LWildFileCmp(lfindName, pattern))
 					&& !(~attr & findAttr & (DOS_ATTR_DIRECTORY | DOS_ATTR_HIDDEN | DOS_ATTR_SYSTEM))) {
 
@@ -1284,12 +1278,13 @@ bool isoDrive::FindNext(DOS_DTA &dta) {
 		}
 	}
 	else {
-		isoDirEntry de = {};
-		while (GetNextDirEntry(dirIterator, &de)) {
+		while (it.valid && it.indexPos < entries.size()) {
+			const DirIndexEntry &ent = entries[it.indexPos++];
+			const isoDirEntry &de = ent.de;
 			uint8_t findAttr = DOS_ATTR_ARCHIVE | DOS_ATTR_READ_ONLY;
 			if (IS_DIR(FLAGS1)) findAttr |= DOS_ATTR_DIRECTORY;
 			if (IS_HIDDEN(FLAGS1)) findAttr |= DOS_ATTR_HIDDEN;
-			strcpy(lfindName,fullname);
+			safe_strncpy(lfindName, ent.longName.c_str(), ISO_MAXPATHNAME);
 			if (!IS_ASSOC(FLAGS1) && !(isRoot && de.ident[0]=='.') && (WildFileCmp((char*)de.ident, pattern) || LWildFileCmp(lfindName, pattern))
 					&& !(~attr & findAttr & (DOS_ATTR_DIRECTORY | DOS_ATTR_HIDDEN | DOS_ATTR_SYSTEM))) {
 
@@ -1453,13 +1448,14 @@ Bits isoDrive::UnMount(void) {
 }
 
 int isoDrive::GetDirIterator(const UDFFileEntry &fe) {
-    (void)fe;
 	if (!is_udf) return 0;
 
 	int dirIterator = nextFreeDirIterator;
 
 	dirIterators[dirIterator].currentSector = 0; // irrelevant
 	dirIterators[dirIterator].endSector = 0; // irrelevant
+	dirIterators[dirIterator].indexKey = fe.DescriptorTag.TagLocation;
+	dirIterators[dirIterator].indexPos = 0;
 
 	// reset position and mark as valid
 	dirIterators[dirIterator].pos = 0;
@@ -1484,6 +1480,8 @@ int isoDrive::GetDirIterator(const isoDirEntry* de) {
 		EXTENT_LOCATION(*de) + DATA_LENGTH(*de) / ISO_FRAMESIZE - 1;
 	if (DATA_LENGTH(*de) % ISO_FRAMESIZE != 0)
 		dirIterators[dirIterator].endSector++;
+	dirIterators[dirIterator].indexKey = EXTENT_LOCATION(*de);
+	dirIterators[dirIterator].indexPos = 0;
 
 	// reset position and mark as valid
 	dirIterators[dirIterator].pos = 0;
@@ -1496,12 +1494,11 @@ int isoDrive::GetDirIterator(const isoDirEntry* de) {
 	return dirIterator;
 }
 
-bool isoDrive::GetNextDirEntry(const int dirIteratorHandle, UDFFileIdentifierDescriptor &fid, UDFFileEntry &fe, UDFextents &dirext, char fname[LFN_NAMELENGTH],unsigned int dirIteratorIndex) {
+bool isoDrive::GetNextDirEntry(DirIterator &dirIterator, UDFFileIdentifierDescriptor &fid, UDFFileEntry &fe, UDFextents &dirext, char fname[LFN_NAMELENGTH],unsigned int dirIteratorIndex) {
 	if (!is_udf) return 0;
 
 	UDFTagId ctag;
 	unsigned char dirent[4096];
-	DirIterator& dirIterator = dirIterators[dirIteratorHandle];
 
 	/* this code only concerns itself with File Identifier Descriptors */
 	if (UDFextent_read(dirext, dirent, 38) != 38) return false;
@@ -1669,13 +1666,12 @@ bool isoDrive::GetNextDirEntry(const int dirIteratorHandle, UDFFileIdentifierDes
 	return true;
 }
 
-bool isoDrive::GetNextDirEntry(const int dirIteratorHandle, isoDirEntry* de) {
+bool isoDrive::GetNextDirEntry(DirIterator &dirIterator, isoDirEntry* de) {
 	// Not for UDF filesystem use!
 	if (is_udf) return 0;
 
 	bool result = false;
 	uint8_t* buffer = NULL;
-	DirIterator& dirIterator = dirIterators[dirIteratorHandle];
 
 	// check if the directory entry is valid
 	if (dirIterator.valid && ReadCachedSector(&buffer, dirIterator.currentSector)) {
@@ -1718,6 +1714,54 @@ void isoDrive::FreeDirIterator(const int dirIterator) {
 	}
 }
 
+/* Parse the directory the iterator was opened on, or return it if it was parsed before.
+ * The returned reference stays valid until the next call. */
+const std::vector<isoDrive::DirIndexEntry>& isoDrive::GetDirIndex(const DirIterator &dirIterator) {
+	static const std::vector<DirIndexEntry> none;
+	if (!dirIterator.valid) return none;
+
+	auto i = dirIndex.find(dirIterator.indexKey);
+	if (i != dirIndex.end()) return i->second;
+
+	// keep memory bounded on discs with huge directory trees, everything is simply parsed again
+	if (dirIndexEntries >= ISO_MAX_DIR_INDEX_ENTRIES) {
+		dirIndex.clear();
+		dirIndexEntries = 0;
+	}
+
+	std::vector<DirIndexEntry> &entries = dirIndex[dirIterator.indexKey];
+	DirIterator scan = dirIterator;
+	DirIndexEntry ent = {};
+	scan.pos = 0;
+	scan.index = 0;
+
+	if (is_udf) {
+		char fname[LFN_NAMELENGTH];
+		UDFextent_rewind(scan.udfdirext);
+		while (GetNextDirEntry(scan, ent.fid, ent.fe, scan.udfdirext, fname, scan.index)) {
+			ent.shortName = fname;
+			ent.longName = fullname;
+			entries.push_back(ent);
+		}
+	}
+	else {
+		while (GetNextDirEntry(scan, &ent.de)) {
+			ent.longName = fullname;
+			entries.push_back(ent);
+		}
+	}
+
+	dirIndexEntries += entries.size();
+	return entries;
+}
+
+void isoDrive::ClearCaches(void) {
+	dirIndex.clear();
+	dirIndexEntries = 0;
+	HOSTMEM_Count(HOSTMEM_IMAGECACHE, -(int64_t)(sectorCache.size() * ISO_READAHEAD_SECTORS * ISO_FRAMESIZE));
+	sectorCache.clear();
+}
+
 bool isoDrive::ReadCachedSector(uint8_t** buffer, const uint32_t sector) {
 	// get hash table entry
 	unsigned int pos = sector % ISO_MAX_HASH_TABLE_SIZE;
@@ -1741,6 +1785,35 @@ inline bool isoDrive :: readSector(uint8_t *buffer, uint32_t sector) const {
     return CDROM_Interface_Image::images[subUnit]->ReadSector(buffer, false, sector);
 }
 
+/* File data read through a small LRU of read-ahead blocks. On a miss up to ISO_READAHEAD_SECTORS
+ * sectors starting at the requested one are read, stopping early at the first unreadable sector.
+ * Returns NULL if the sector itself cannot be read, else a pointer valid until the next call. */
+const uint8_t* isoDrive :: readSectorCached(uint32_t sector) const {
+	for (auto i = sectorCache.begin(); i != sectorCache.end(); ++i) {
+		if (sector >= i->sector && (sector - i->sector) < i->count) {
+			if (i != sectorCache.begin()) sectorCache.splice(sectorCache.begin(), sectorCache, i);
+			return &sectorCache.front().data[(sector - sectorCache.front().sector) * ISO_FRAMESIZE];
+		}
+	}
+
+	if (sectorCache.size() < ISO_SECTOR_CACHE_BLOCKS) {
+		sectorCache.emplace_front();
+		sectorCache.front().data.resize(ISO_READAHEAD_SECTORS * ISO_FRAMESIZE);
+		HOSTMEM_Count(HOSTMEM_IMAGECACHE, ISO_READAHEAD_SECTORS * ISO_FRAMESIZE);
+	}
+	else {
+		sectorCache.splice(sectorCache.begin(), sectorCache, std::prev(sectorCache.end()));
+	}
+
+	SectorCacheBlock &blk = sectorCache.front();
+	blk.sector = sector;
+	blk.count = 0;
+	while (blk.count < ISO_READAHEAD_SECTORS && readSector(&blk.data[blk.count * ISO_FRAMESIZE], sector + blk.count))
+		blk.count++;
+
+	return blk.count != 0 ? &blk.data[0] : NULL;
+}
+
 int isoDrive::readDirEntry(isoDirEntry* de, const uint8_t* data,unsigned int dirIteratorIndex) const {
 	// This code is NOT for UDF filesystem access!
 	if (is_udf) return -1;
@@ -2237,7 +2310,6 @@ bool isoDrive :: loadImage() {
 
 bool isoDrive :: lookup(UDFFileIdentifierDescriptor &fid, UDFFileEntry &fe, const char *path) {
 	uint8_t pvd[COOKED_SECTOR_SIZE];
-	char fname[LFN_NAMELENGTH];
 	bool cisdir = false;
 	UDFextents dirext;
 	UDFTagId ctag;
@@ -2283,14 +2355,18 @@ bool isoDrive :: lookup(UDFFileIdentifierDescriptor &fid, UDFFileEntry &fe, cons
 
 			// look for the current path element
 			int dirIterator = GetDirIterator(fe);
-			while (!found && GetNextDirEntry(dirIterator, fid, fe, dirext, fname, dirIterators[dirIterator].index)) {
+			dirIterators[dirIterator].udfdirext = dirext;
+			for (const DirIndexEntry &ent : GetDirIndex(dirIterators[dirIterator])) {
 				/* skip parent directory */
-				if (fid.LengthOfFileIdentifier == 0 || (fid.FileCharacteristics & 0x08)) continue;
+				if (ent.fid.LengthOfFileIdentifier == 0 || (ent.fid.FileCharacteristics & 0x08)) continue;
 
-				if (0 == strncasecmp((char*)fname, name, ISO_MAX_FILENAME_LENGTH) || 0 == strncasecmp((char*) fullname, name, ISO_MAXPATHNAME)) {
+				if (0 == strncasecmp(ent.shortName.c_str(), name, ISO_MAX_FILENAME_LENGTH) || 0 == strncasecmp(ent.longName.c_str(), name, ISO_MAXPATHNAME)) {
+					fid = ent.fid;
+					fe = ent.fe;
 					cisdir = !!(fid.FileCharacteristics & 0x02/*Directory*/);
 					UDFFileEntryToExtents(dirext,fe);
 					found = true;
+					break;
 				}
 			}
 			FreeDirIterator(dirIterator);
@@ -2328,9 +2404,11 @@ bool isoDrive :: lookup(isoDirEntry *de, const char *path) {
 
 			// look for the current path element
 			int dirIterator = GetDirIterator(de);
-			while (!found && GetNextDirEntry(dirIterator, de)) {
-				if (!IS_ASSOC(FLAGS2) && ((0 == strncasecmp((char*) de->ident, name, ISO_MAX_FILENAME_LENGTH)) || 0 == strncasecmp((char*) fullname, name, ISO_MAXPATHNAME))) {
+			for (const DirIndexEntry &ent : GetDirIndex(dirIterators[dirIterator])) {
+				if (!IS_ASSOC((iso ? ent.de.fileFlags : ent.de.timeZone)) && ((0 == strncasecmp((const char*) ent.de.ident, name, ISO_MAX_FILENAME_LENGTH)) || 0 == strncasecmp(ent.longName.c_str(), name, ISO_MAXPATHNAME))) {
+					*de = ent.de;
 					found = true;
+					break;
 				}
 			}
 			FreeDirIterator(dirIterator);
@@ -2373,6 +2451,7 @@ void isoDrive :: EmptyCache(void) {
 	}
 	memset(sectorHashEntries, 0, sizeof(sectorHashEntries));
 	memset(&rootEntry, 0, sizeof(isoDirEntry));
+	ClearCaches();
 	//safe_strncpy(this->fileName, fileName, CROSS_LEN); /* deleted to fix issue #3848. Revert this if there are any flaws */
 	loadImage();
 }
@@ -116,7 +116,8 @@ static host_cnv_char_t cpcnv_ltemp[4096];
 host_cnv_char_t *CodePageGuestToHost(const char *s);
 bool isDBCSCP(), isKanji1(uint8_t chr), shiftjis_lead_byte(int c), CheckDBCSCP(int32_t codepage);
 extern bool rsize, morelen, force_sfn, enable_share_exe, chinasea, uao, halfwidthkana, dbcs_sbcs, inmsg, forceswk;
-extern int lfn_filefind_handle, freesizecap, file_access_tries;
+extern int lfn_filefind_handle, freesizecap, file_access_tries, file_buffer_size;
+extern bool watchhostdir;
 extern unsigned long totalc, freec;
 uint16_t customcp_to_unicode[256], altcp_to_unicode[256];
 extern uint16_t cpMap_AX[32];
@@ -734,9 +735,11 @@ bool CodePageHostToGuestUTF16(char *d/*CROSS_LEN*/,const uint16_t *s/*CROSS_LEN*
         case 949:
             return String_HOST_TO_DBCS_UTF16<uint16_t>(d,s,cp949_to_unicode_hitbl,cp949_to_unicode_raw,sizeof(cp949_to_unicode_raw)/sizeof(cp949_to_unicode_raw[0]));
         case 950:
+            makestdcp950table();
             if (chinasea) return String_HOST_TO_DBCS_UTF16<uint16_t>(d,s,cp950ext_to_unicode_hitbl,cp950ext_to_unicode_raw,sizeof(cp950ext_to_unicode_raw)/sizeof(cp950ext_to_unicode_raw[0]));
             return String_HOST_TO_DBCS_UTF16<uint16_t>(d,s,cp950_to_unicode_hitbl,cp950_to_unicode_raw,sizeof(cp950_to_unicode_raw)/sizeof(cp950_to_unicode_raw[0]));
         case 951:
+            makeseacp951table();
             if (chinasea && uao) return String_HOST_TO_DBCS_UTF16<uint16_t>(d,s,cp951_to_unicode_hitbl,cp951uaosea_to_unicode_raw,sizeof(cp951uaosea_to_unicode_raw)/sizeof(cp951uaosea_to_unicode_raw[0]));
             if (chinasea && !uao) return String_HOST_TO_DBCS_UTF16<uint16_t>(d,s,cp951_to_unicode_hitbl,cp951sea_to_unicode_raw,sizeof(cp951sea_to_unicode_raw)/sizeof(cp951sea_to_unicode_raw[0]));
             if (!chinasea && uao) return String_HOST_TO_DBCS_UTF16<uint16_t>(d,s,cp951_to_unicode_hitbl,cp951uao_to_unicode_raw,sizeof(cp951uao_to_unicode_raw)/sizeof(cp951uao_to_unicode_raw[0]));
@@ -832,9 +835,11 @@ bool CodePageHostToGuestUTF8(char *d/*CROSS_LEN*/,const char *s/*CROSS_LEN*/) {
         case 949:
             return String_HOST_TO_DBCS_UTF8<uint16_t>(d,s,cp949_to_unicode_hitbl,cp949_to_unicode_raw,sizeof(cp949_to_unicode_raw)/sizeof(cp949_to_unicode_raw[0]));
         case 950:
+            makestdcp950table();
             if (chinasea) return String_HOST_TO_DBCS_UTF8<uint16_t>(d,s,cp950ext_to_unicode_hitbl,cp950ext_to_unicode_raw,sizeof(cp950ext_to_unicode_raw)/sizeof(cp950ext_to_unicode_raw[0]));
             return String_HOST_TO_DBCS_UTF8<uint16_t>(d,s,cp950_to_unicode_hitbl,cp950_to_unicode_raw,sizeof(cp950_to_unicode_raw)/sizeof(cp950_to_unicode_raw[0]));
         case 951:
+            makeseacp951table();
             if (chinasea && uao) return String_HOST_TO_DBCS_UTF8<uint16_t>(d,s,cp951_to_unicode_hitbl,cp951uaosea_to_unicode_raw,sizeof(cp951uaosea_to_unicode_raw)/sizeof(cp951uaosea_to_unicode_raw[0]));
             if (chinasea && !uao) return String_HOST_TO_DBCS_UTF8<uint16_t>(d,s,cp951_to_unicode_hitbl,cp951sea_to_unicode_raw,sizeof(cp951sea_to_unicode_raw)/sizeof(cp951sea_to_unicode_raw[0]));
             if (!chinasea && uao) return String_HOST_TO_DBCS_UTF8<uint16_t>(d,s,cp951_to_unicode_hitbl,cp951uao_to_unicode_raw,sizeof(cp951uao_to_unicode_raw)/sizeof(cp951uao_to_unicode_raw[0]));
@@ -930,9 +935,11 @@ bool CodePageGuestToHostUTF16(uint16_t *d/*CROSS_LEN*/,const char *s/*CROSS_LEN*
         case 949:
             return String_DBCS_TO_HOST_UTF16<uint16_t>(d,s,cp949_to_unicode_hitbl,cp949_to_unicode_raw,sizeof(cp949_to_unicode_raw)/sizeof(cp949_to_unicode_raw[0]));
         case 950:
+            makestdcp950table();
             if (chinasea) return String_DBCS_TO_HOST_UTF16<uint16_t>(d,s,cp950ext_to_unicode_hitbl,cp950ext_to_unicode_raw,sizeof(cp950ext_to_unicode_raw)/sizeof(cp950ext_to_unicode_raw[0]));
             return String_DBCS_TO_HOST_UTF16<uint16_t>(d,s,cp950_to_unicode_hitbl,cp950_to_unicode_raw,sizeof(cp950_to_unicode_raw)/sizeof(cp950_to_unicode_raw[0]));
         case 951:
+            makeseacp951table();
             if (chinasea && uao) return String_DBCS_TO_HOST_UTF16<uint16_t>(d,s,cp951_to_unicode_hitbl,cp951uaosea_to_unicode_raw,sizeof(cp951uaosea_to_unicode_raw)/sizeof(cp951uaosea_to_unicode_raw[0]));
             if (chinasea && !uao) return String_DBCS_TO_HOST_UTF16<uint16_t>(d,s,cp951_to_unicode_hitbl,cp951sea_to_unicode_raw,sizeof(cp951sea_to_unicode_raw)/sizeof(cp951sea_to_unicode_raw[0]));
             if (!chinasea && uao) return String_DBCS_TO_HOST_UTF16<uint16_t>(d,s,cp951_to_unicode_hitbl,cp951uao_to_unicode_raw,sizeof(cp951uao_to_unicode_raw)/sizeof(cp951uao_to_unicode_raw[0]));
@@ -1028,9 +1035,11 @@ bool CodePageGuestToHostUTF8(char *d/*CROSS_LEN*/,const char *s/*CROSS_LEN*/) {
         case 949:
             return String_DBCS_TO_HOST_UTF8<uint16_t>(d,s,cp949_to_unicode_hitbl,cp949_to_unicode_raw,sizeof(cp949_to_unicode_raw)/sizeof(cp949_to_unicode_raw[0]));
         case 950:
+            makestdcp950table();
             if (chinasea) return String_DBCS_TO_HOST_UTF8<uint16_t>(d,s,cp950ext_to_unicode_hitbl,cp950ext_to_unicode_raw,sizeof(cp950ext_to_unicode_raw)/sizeof(cp950ext_to_unicode_raw[0]));
             return String_DBCS_TO_HOST_UTF8<uint16_t>(d,s,cp950_to_unicode_hitbl,cp950_to_unicode_raw,sizeof(cp950_to_unicode_raw)/sizeof(cp950_to_unicode_raw[0]));
         case 951:
+            makeseacp951table();
             if (chinasea && uao) return String_DBCS_TO_HOST_UTF8<uint16_t>(d,s,cp951_to_unicode_hitbl,cp951uaosea_to_unicode_raw,sizeof(cp951uaosea_to_unicode_raw)/sizeof(cp951uaosea_to_unicode_raw[0]));
             if (chinasea && !uao) return String_DBCS_TO_HOST_UTF8<uint16_t>(d,s,cp951_to_unicode_hitbl,cp951sea_to_unicode_raw,sizeof(cp951sea_to_unicode_raw)/sizeof(cp951sea_to_unicode_raw[0]));
             if (!chinasea && uao) return String_DBCS_TO_HOST_UTF8<uint16_t>(d,s,cp951_to_unicode_hitbl,cp951uao_to_unicode_raw,sizeof(cp951uao_to_unicode_raw)/sizeof(cp951uao_to_unicode_raw[0]));
@@ -1568,6 +1577,7 @@ bool localDrive::FileOpen(DOS_File * * file,const char * name,uint32_t flags) {
 	//Flush the buffer of handles for the same file. (Betrayal in Antara)
 	uint8_t i,drive=DOS_DRIVES;
 	LocalFile *lfp;
+	bool shared_writer = false;
 	for (i=0;i<DOS_DRIVES;i++) {
 		if (Drives[i]==this) {
 			drive=i;
@@ -1578,7 +1588,14 @@ bool localDrive::FileOpen(DOS_File * * file,const char * name,uint32_t flags) {
         for(i = 0; i < DOS_FILES; i++) {
             if(Files[i] && Files[i]->IsOpen() && Files[i]->GetDrive() == drive && Files[i]->IsName(name)) {
                 lfp = dynamic_cast<LocalFile*>(Files[i]);
-                if(lfp) lfp->Flush();
+                if(lfp) {
+                    lfp->Flush();
+                    // Two handles on one file with a writer among them can not keep private buffers
+                    if(((flags&0xf) != OPEN_READ && (flags&0xf) != OPEN_READ_NO_MOD) || ((lfp->flags&0xf) != OPEN_READ && (lfp->flags&0xf) != OPEN_READ_NO_MOD)) {
+                        lfp->DisableBuffering();
+                        shared_writer = true;
+                    }
+                }
             }
         }
 
@@ -1638,7 +1655,9 @@ bool localDrive::FileOpen(DOS_File * * file,const char * name,uint32_t flags) {
 		return false;
 	}
 
-	*file=new LocalFile(name,hand);
+	lfp=new LocalFile(name,hand);
+	if (shared_writer) lfp->DisableBuffering();
+	*file=lfp;
 	(*file)->flags=flags;  //for the inheritance flag and maybe check for others.
 //	(*file)->SetFileName(host_name);
 	return true;
@@ -1786,8 +1805,12 @@ bool localDrive::FindFirst(const char * _dir,DOS_DTA & dta,bool fcb_findfirst) {
 		strcat(tempDir,end);
 	}
 
+	uint8_t sAttr;
+	char pattern[LFN_NAMELENGTH+1];
+	dta.GetSearchParams(sAttr,pattern,false);
+
 	uint16_t id;
-	if (!dirCache.FindFirst(tempDir,id)) {
+	if (!dirCache.FindFirst(tempDir,id,pattern)) {
 		DOS_SetError(DOSERR_PATH_NOT_FOUND);
 		return false;
 	}
@@ -1799,8 +1822,7 @@ bool localDrive::FindFirst(const char * _dir,DOS_DTA & dta,bool fcb_findfirst) {
 		ldir[lfn_filefind_handle]=tempDir;
 	}
 
-	uint8_t sAttr;
-	dta.GetSearchParams(sAttr,tempDir,false);
+	strcpy(tempDir,pattern);
 
 	if (this->isRemote() && this->isRemovable()) {
 		// cdroms behave a bit different than regular drives
@@ -1855,7 +1877,7 @@ again:
 		DOS_SetError(DOSERR_NO_MORE_FILES);
 		return false;
 	}
-	if(!WildFileCmp(dir_ent,srch_pattern)&&!LWildFileCmp(ldir_ent,srch_pattern)) goto again;
+	// FindFirst only kept the entries matching srch_pattern
 
 	strcpy(full_name,lfn_filefind_handle>=LFN_FILEFIND_MAX?srchInfo[id].srch_dir:(ldir[lfn_filefind_handle]!=""?ldir[lfn_filefind_handle].c_str():"\\"));
 	strcpy(lfull_name,full_name);
@@ -1869,7 +1891,14 @@ again:
 	strcpy(dir_entcopy,dir_ent);
 	strcpy(ldir_entcopy,ldir_ent);
 
-	char *temp_name = dirCache.GetExpandName(full_name);
+	//The search knows the expanded host directory already, no need to expand full_name again
+	char temp_name[CROSS_LEN];
+	const char *host_dir = dirCache.FindDirPath(id);
+	if (host_dir != NULL && strlen(host_dir) + strlen(ldir_entcopy) < CROSS_LEN) {
+		strcpy(temp_name,host_dir);
+		strcat(temp_name,ldir_entcopy);
+	} else
+		safe_strncpy(temp_name,dirCache.GetExpandName(full_name),CROSS_LEN);
 
 	// guest to host code page translation
 	const host_cnv_char_t* host_name = CodePageGuestToHost(temp_name);
@@ -2728,6 +2757,38 @@ next:
     return false;
 }
 
+bool localDrive::watchdir(const char *name, uint32_t id) {
+    if (!watchhostdir || nocachedir || dirWatchFailed) return false;
+    if (dirWatch == NULL) {
+        dirWatch = open_dir_watch();
+        if (dirWatch == NULL) {
+            LOG_MSG("%s: Host directory change notification not available, use RESCAN after changing files on the host",__FUNCTION__);
+            dirWatchFailed = true;
+            return false;
+        }
+    }
+
+    // guest to host code page translation
+    const host_cnv_char_t* host_name = CodePageGuestToHost(name);
+    if (host_name == NULL) return false;
+
+    return add_dir_watchw(dirWatch,host_name,id);
+}
+
+void localDrive::unwatchdir(uint32_t id) {
+    remove_dir_watch(dirWatch,id);
+}
+
+bool localDrive::read_dir_changes(std::vector<uint32_t> &changed) {
+    return read_dir_watch(dirWatch,changed);
+}
+
+localDrive::~localDrive() {
+    // dirCache is destroyed after this, its unwatchdir() calls find dirWatch already gone
+    close_dir_watch(dirWatch);
+    dirWatch = NULL;
+}
+
 localDrive::localDrive(const char * startdir,uint16_t _bytes_sector,uint8_t _sectors_cluster,uint16_t _total_clusters,uint16_t _free_clusters,uint8_t _mediaid, std::vector<std::string> &options) : special_prefix_local(prefix_local.c_str()) {
 	strcpy(basedir,startdir);
 	sprintf(info,"local directory %s",startdir);
@@ -2773,12 +2834,107 @@ localDrive::localDrive(const char * startdir,uint16_t _bytes_sector,uint8_t _sec
 }
 
 
+// DOS programs (compilers, databases) tend to read and write files in tiny pieces
+// with seeks in between, and every fseek() throws away the stdio buffer. LocalFile
+// therefore keeps its own window over the host file while it is the only user of it.
+// The window is written back and dropped on commit, close, truncation, locking and
+// whenever another handle opens the same file.
+bool LocalFile::BufferActive(void) {
+	if (buf_active) return true;
+	if (unbuffered || file_buffer_size <= 0 || file_access_tries > 0 || fhandle == nullptr) return false;
+	const uint32_t share = flags & 0x70;
+	if (enable_share_exe && (share == 0x30 || share == 0x40)) {	// deny read / deny none: others may write
+		unbuffered = true;
+		return false;
+	}
+	const long pos = ftell(fhandle);
+	if (pos < 0) {
+		unbuffered = true;
+		return false;
+	}
+	if (buffer.size() != (size_t)file_buffer_size * 1024u) buffer.resize((size_t)file_buffer_size * 1024u);
+	file_pos = (uint32_t)pos;
+	buf_start = file_pos;
+	buf_len = dirty_start = dirty_end = 0;
+	buf_active = true;
+	return true;
+}
+
+bool LocalFile::WriteBack(void) {
+	if (dirty_end <= dirty_start) return true;
+	const uint32_t len = dirty_end - dirty_start;
+	const bool ok = fseek(fhandle,(long)(buf_start + dirty_start),SEEK_SET) == 0 &&
+		fwrite(&buffer[dirty_start],1,len,fhandle) == len;
+	dirty_start = dirty_end = 0;
+	if (!ok) LOG_MSG("Failed to write back %u buffered bytes to %s",(unsigned int)len,GetName());
+	return ok;
+}
+
+int64_t LocalFile::HostFileSize(void) {
+	WriteBack();
+	fflush(fhandle);
+	struct stat temp_stat;
+	if (fstat(fileno(fhandle),&temp_stat)) return -1;
+	return (int64_t)temp_stat.st_size;
+}
+
+bool LocalFile::FlushBuffer(void) {
+	if (!buf_active) return true;
+	const bool ok = WriteBack();
+	fseek(fhandle,(long)file_pos,SEEK_SET);
+	buf_active = false;
+	buf_len = 0;
+	return ok;
+}
+
+void LocalFile::DisableBuffering(void) {
+	if (buf_active) {
+		FlushBuffer();
+		fflush(fhandle);
+	}
+	unbuffered = true;
+}
+
 //TODO Maybe use fflush, but that seemed to fuck up in visual c
 bool LocalFile::Read(uint8_t * data,uint16_t * size) {
 	if ((this->flags & 0xf) == OPEN_WRITE) {	// check if file opened in write-only mode
 		DOS_SetError(DOSERR_ACCESS_DENIED);
 		return false;
 	}
+	if (BufferActive()) {
+		if (last_action==WRITE && !newtime) UpdateLocalDateTime();
+		last_action=READ;
+		const uint32_t cap = (uint32_t)buffer.size();
+		uint32_t done = 0;
+		while (done < *size) {
+			const uint32_t left = *size - done;
+			if (file_pos >= buf_start && file_pos < buf_start + buf_len) {
+				const uint32_t n = std::min(buf_start + buf_len - file_pos, left);
+				memcpy(data + done,&buffer[file_pos - buf_start],n);
+				done += n;
+				file_pos += n;
+				continue;
+			}
+			if (!WriteBack()) break;
+			buf_len = 0;
+			if (fseek(fhandle,(long)file_pos,SEEK_SET) != 0) break;
+			if (left >= cap) {	// large transfers go straight to the caller
+				const size_t n = fread(data + done,1,left,fhandle);
+				done += (uint32_t)n;
+				file_pos += (uint32_t)n;
+				break;
+			}
+			buf_start = file_pos;
+			buf_len = (uint32_t)fread(buffer.data(),1,cap,fhandle);
+			if (buf_len == 0) break;
+		}
+		*size = (uint16_t)done;
+		if (!IS_PC98_ARCH) {
+			uint8_t mask = IO_Read(0x21);
+			if(mask & 0x4 ) IO_Write(0x21,mask&0xfb);
+		}
+		return true;
+	}
 #if defined(WIN32)
     if (file_access_tries>0) {
         HANDLE hFile = (HANDLE)_get_osfhandle(_fileno(fhandle));
@@ -2822,6 +2978,43 @@ bool LocalFile::Write(const uint8_t * data,uint16_t * size) {
 		DOS_SetError(DOSERR_ACCESS_DENIED);
 		return false;
 	}
+	if (*size == 0) FlushBuffer();
+	else if (BufferActive()) {
+		last_action=WRITE;
+		const uint32_t cap = (uint32_t)buffer.size();
+		uint32_t done = 0;
+		while (done < *size) {
+			const uint32_t left = *size - done;
+			if (file_pos >= buf_start && file_pos <= buf_start + buf_len && file_pos - buf_start < cap) {
+				const uint32_t off = file_pos - buf_start;
+				const uint32_t n = std::min(cap - off, left);
+				memcpy(&buffer[off],data + done,n);
+				if (dirty_end <= dirty_start) {
+					dirty_start = off;
+					dirty_end = off + n;
+				} else {
+					dirty_start = std::min(dirty_start, off);
+					dirty_end = std::max(dirty_end, off + n);
+				}
+				if (off + n > buf_len) buf_len = off + n;
+				done += n;
+				file_pos += n;
+				continue;
+			}
+			if (!WriteBack()) break;
+			buf_start = file_pos;
+			buf_len = 0;
+			if (left >= cap) {	// large transfers go straight to the host
+				if (fseek(fhandle,(long)file_pos,SEEK_SET) != 0) break;
+				const size_t n = fwrite(data + done,1,left,fhandle);
+				done += (uint32_t)n;
+				file_pos += (uint32_t)n;
+				break;
+			}
+		}
+		*size = (uint16_t)done;
+		return true;
+	}
 #if defined(WIN32)
     if (file_access_tries>0) {
         HANDLE hFile = (HANDLE)_get_osfhandle(_fileno(fhandle));
@@ -2857,6 +3050,7 @@ bool LocalFile::Write(const uint8_t * data,uint16_t * size) {
 	last_action=WRITE;
 	if (*size==0){
 		uint32_t pos=file_access_tries>0?lseek(fileno(fhandle),0,SEEK_CUR):ftell(fhandle);
+		if (file_access_tries<=0) fflush(fhandle);	// push pending output and drop stale read-ahead before truncating
 		return !ftruncate(fileno(fhandle),pos);
 	} else {
 		*size=file_access_tries>0?(uint16_t)write(fileno(fhandle),data,*size):(uint16_t)fwrite(data,1,*size,fhandle);
@@ -2888,6 +3082,7 @@ bool toLock(int fd, bool is_lock, uint32_t pos, uint16_t size) {
 // ert, 20100711: Locking extensions
 // Wengier, 20201230: All platforms
 bool LocalFile::LockFile(uint8_t mode, uint32_t pos, uint16_t size) {
+	DisableBuffering();	// record locking means someone else wants to see our writes
 #if defined(WIN32)
     static bool lockWarn = true;
 	HANDLE hFile = (HANDLE)_get_osfhandle(_fileno(fhandle));
@@ -2989,6 +3184,18 @@ bool LocalFile::Seek(uint32_t * pos,uint32_t type) {
 	//TODO Give some doserrorcode;
 		return false;//ERROR
 	}
+	if (BufferActive()) {
+		int64_t newpos = *reinterpret_cast<int32_t*>(pos);
+		if (seektype == SEEK_CUR) newpos += file_pos;
+		else if (seektype == SEEK_END) newpos += HostFileSize();
+		// Out of file range, pretend everything is ok
+		// and move file pointer top end of file... ?! (Black Thorne)
+		if (newpos < 0) newpos = std::max(HostFileSize(), (int64_t)0);
+		file_pos = (uint32_t)newpos;
+		*pos = file_pos;
+		last_action=NONE;
+		return true;
+	}
 #if defined(WIN32)
     if (file_access_tries>0) {
         HANDLE hFile = (HANDLE)_get_osfhandle(_fileno(fhandle));
@@ -3026,6 +3233,7 @@ bool LocalFile::Seek(uint32_t * pos,uint32_t type) {
 }
 
 bool LocalFile::Close() {
+    if (fhandle) FlushBuffer();
     if (!newtime && fhandle && last_action == WRITE) UpdateLocalDateTime();
     if (newtime && fhandle) {
         // force STDIO to flush buffers on this file handle, or else fclose() will write buffered data
@@ -3099,6 +3307,7 @@ uint16_t LocalFile::GetInformation(void) {
 
 
 uint32_t LocalFile::GetSeekPos() {
+	if (buf_active) return file_pos;
 	return file_access_tries>0?(uint32_t)lseek(fileno(fhandle),0,SEEK_CUR):(uint32_t)ftell( fhandle );
 }
 
@@ -3172,6 +3381,8 @@ void LocalFile::Flush(void) {
 #if defined(WIN32)
     if (file_access_tries>0) return;
 #endif
+	if (buf_active && dirty_end > dirty_start) last_action=WRITE;
+	FlushBuffer();
 	if (last_action==WRITE) {
 		if (file_access_tries>0) {
 			off_t pos = lseek(fileno(fhandle),0,SEEK_CUR);
@@ -25,6 +25,7 @@
 #include "timer.h"
 #include "logging.h"
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <cassert>
@@ -45,6 +46,14 @@ std::string prefix_overlay = ".DBOVERLAY";
 
 using namespace std;
 
+/* Lookup key for the name sets below: DOS names compare case insensitively (as strcasecmp did). */
+static std::string overlay_key(const char* name) {
+	std::string key(name);
+	for (std::string::iterator c = key.begin(); c != key.end(); ++c)
+		if (*c >= 'a' && *c <= 'z') *c -= 'a' - 'A';
+	return key;
+}
+
 /* 
  * Wengier: Long filenames are supported in all including overlay drives.
  * Shift-JIS characters (Kana, Kanji, etc) are also supported in PC-98 mode.
@@ -386,14 +395,9 @@ FILE* Overlay_Drive::create_file_in_overlay(const char* dos_filename, char const
 		char *p=strrchr_dbcs(tmp, '\\');
 		assert(p!=NULL);
 		*p=0;
-		bool found=false;
-		for(std::vector<std::string>::iterator it = DOSdirs_cache.begin(); it != DOSdirs_cache.end(); it+=2)
-			if ((*(it+1)).length()&&!strcasecmp((*(it+1)).c_str(), tmp)) {
-				found=true;
-				strcpy(tmp, (*it).c_str());
-				break;
-			}
-		if (found) {
+		const std::string* longdir = find_DOSdir_by_short(tmp);
+		if (longdir) strcpy(tmp, longdir->c_str());
+		if (longdir) {
 			strcpy(temp_name,overlaydir);
 			strcat(temp_name,tmp);
 			strcat(temp_name,dir);
@@ -441,6 +445,7 @@ FILE* Overlay_Drive::create_file_in_overlay(const char* dos_filename, char const
 bool OverlayFile::create_copy() {
 	//test if open/valid/etc
 	//ensure file position
+	FlushBuffer();
 	FILE* lhandle = this->fhandle;
 	fseek(lhandle,ftell(lhandle),SEEK_SET);
 	int location_in_old_file = ftell(lhandle);
@@ -472,6 +477,7 @@ bool OverlayFile::create_copy() {
 static OverlayFile* ccc(DOS_File* file) {
 	LocalFile* l = dynamic_cast<LocalFile*>(file);
 	if (!l) E_Exit("overlay input file is not a LocalFile");
+	l->FlushBuffer();
 	//Create an overlayFile
 	OverlayFile* ret = new OverlayFile(l->GetName(),l->fhandle);
 	ret->flags = l->flags;
@@ -514,7 +520,8 @@ Overlay_Drive::Overlay_Drive(const char * startdir,const char* overlay, uint16_t
 	//add_deleted_path(dirname); //update_cache will add the overlap_folder
 	overlap_folder = dirname;
 
-	update_cache(true);
+	if (load_overlay_index()) update_cache(false);
+	else update_cache(true);
 }
 
 void Overlay_Drive::convert_overlay_to_DOSname_in_base(char* dirname ) 
@@ -703,17 +710,17 @@ bool Overlay_Drive::FileCreate(DOS_File * * file,const char * name,uint16_t /*at
 }
 
 void Overlay_Drive::add_DOSname_to_cache(const char* name) {
-	for (std::vector<std::string>::const_iterator itc = DOSnames_cache.begin(); itc != DOSnames_cache.end(); ++itc){
-		if (!strcasecmp((*itc).c_str(), name)) return;
-	}
+	if (!DOSnames_index.insert(overlay_key(name)).second) return;
 	DOSnames_cache.push_back(name);
+	journal_overlay_index('N',name);
 }
 
 void Overlay_Drive::remove_DOSname_from_cache(const char* name) {
+	if (!DOSnames_index.erase(overlay_key(name))) return;
 	for (std::vector<std::string>::iterator it = DOSnames_cache.begin(); it != DOSnames_cache.end(); ++it) {
-		if (!strcasecmp((*it).c_str(), name)) { DOSnames_cache.erase(it); return;}
+		if (!strcasecmp((*it).c_str(), name)) { DOSnames_cache.erase(it); break;}
 	}
-
+	journal_overlay_index('n',name);
 }
 
 bool Overlay_Drive::Sync_leading_dirs(const char* dos_filename){
@@ -775,10 +782,22 @@ void Overlay_Drive::update_cache(bool read_directory_contents) {
 	std::vector<std::string> specials;
 	std::vector<std::string> dirnames;
 	std::vector<std::string> filenames;
+	std::string old_state;
+	bool had_index = false;
 	if (read_directory_contents) {
+		//The rescan below replaces the indexed state, only rewrite the index if it turns out different.
+		if (index_journal) {
+			had_index = true;
+			old_state = overlay_index_state();
+			fclose(index_journal);
+			index_journal = nullptr;
+		}
 		//Clear all lists
 		DOSnames_cache.clear();
+		DOSnames_index.clear();
 		DOSdirs_cache.clear();
+		DOSdirs_index.clear();
+		DOSdirs_byshort.clear();
 		deleted_files_in_base.clear();
 		deleted_paths_in_base.clear();
 		//Ensure hiding of the folder that contains the overlay, if it is part of the base folder.
@@ -921,7 +940,7 @@ void Overlay_Drive::update_cache(bool read_directory_contents) {
 			//upcase(dosname);  //Should not be really needed, as uppercase in the overlay is a requirement...
 			CROSS_DOSFILENAME(dosname);
 			if (logoverlay) LOG_MSG("update cache add dosname %s",dosname);
-			DOSnames_cache.emplace_back(dosname);
+			if (DOSnames_index.insert(overlay_key(dosname)).second) DOSnames_cache.emplace_back(dosname);
 		}
 	}
 
@@ -951,6 +970,7 @@ void Overlay_Drive::update_cache(bool read_directory_contents) {
 			}
 		}
 	}
+	rebuild_DOSdirs_index();
 #endif
 
 	for (i = DOSnames_cache.begin(); i != DOSnames_cache.end(); ++i) {
@@ -995,12 +1015,18 @@ void Overlay_Drive::update_cache(bool read_directory_contents) {
 				while ( (s = name.find('/')) != std::string::npos) name.replace(s,1,"\\");
 				add_deleted_path(name.c_str(),false);
 
+			} else if (special_operation == "IDX") {
+				//The overlay index itself (and its temporary file)
 			} else {
 				if (logoverlay) LOG_MSG("unsupported operation %s on %s",special_operation.c_str(),(*i).c_str());
 			}
 
 		}
 	}
+	if (read_directory_contents) {
+		if (!had_index || overlay_index_state() != old_state) save_overlay_index();
+		else open_overlay_journal();
+	}
 	if (logoverlay) LOG_MSG("OPTIMISE: update cache took %d",GetTicks()-a);
 }
 
@@ -1498,7 +1524,8 @@ void Overlay_Drive::add_deleted_file(const char* name,bool create_on_disk) {
 	else
 		strcat(tname,temp_name);
 	if (!is_deleted_file(tname)) {
-		deleted_files_in_base.emplace_back(tname);
+		deleted_files_in_base.insert(overlay_key(tname));
+		journal_overlay_index('X',overlay_key(tname));
 		if (create_on_disk) add_special_file_to_disk(name, "DEL");
 	}
 }
@@ -1606,10 +1633,21 @@ bool Overlay_Drive::is_dir_only_in_overlay(const char* name) {
 		strcpy(fname,temp_name+strlen(basedir)+(*(temp_name+strlen(basedir))=='\\'?1:0));
 		CROSS_DOSFILENAME(fname);
 	}
-	for(std::vector<std::string>::iterator it = DOSdirs_cache.begin(); it != DOSdirs_cache.end(); it+=2) {
-		if (!strcasecmp((*it).c_str(), name)||(strlen(fname)&&!strcasecmp((*it).c_str(), fname))||((*(it+1)).length()&&!strcasecmp((*(it+1)).c_str(), name))) return true;
+	return DOSdirs_index.count(overlay_key(name)) || (strlen(fname) && DOSdirs_index.count(overlay_key(fname))) || DOSdirs_byshort.count(overlay_key(name));
+}
+
+void Overlay_Drive::rebuild_DOSdirs_index(void) {
+	DOSdirs_index.clear();
+	DOSdirs_byshort.clear();
+	for(std::vector<std::string>::const_iterator it = DOSdirs_cache.begin(); it != DOSdirs_cache.end(); it+=2) {
+		DOSdirs_index.insert(overlay_key((*it).c_str()));
+		if ((*(it+1)).length()) DOSdirs_byshort.emplace(overlay_key((*(it+1)).c_str()),*it); //first one wins
 	}
-	return false;
+}
+
+const std::string* Overlay_Drive::find_DOSdir_by_short(const char* sname) {
+	std::unordered_map<std::string,std::string>::const_iterator it = DOSdirs_byshort.find(overlay_key(sname));
+	return it == DOSdirs_byshort.end() ? nullptr : &it->second;
 }
 
 bool Overlay_Drive::is_deleted_file(const char* name) {
@@ -1634,10 +1672,7 @@ bool Overlay_Drive::is_deleted_file(const char* name) {
 		strcpy(fname,temp_name+strlen(basedir)+(*(temp_name+strlen(basedir))=='\\'?1:0));
 		CROSS_DOSFILENAME(fname);
 	}
-	for(std::vector<std::string>::iterator it = deleted_files_in_base.begin(); it != deleted_files_in_base.end(); it++) {
-		if (!strcasecmp((*it).c_str(), name)||!strcasecmp((*it).c_str(), tname)||(strlen(fname)&&!strcasecmp((*it).c_str(), fname))) return true;
-	}
-	return false;
+	return deleted_files_in_base.count(overlay_key(name)) || deleted_files_in_base.count(overlay_key(tname)) || (strlen(fname) && deleted_files_in_base.count(overlay_key(fname)));
 }
 
 void Overlay_Drive::add_DOSdir_to_cache(const char* name, const char *sname) {
@@ -1646,6 +1681,9 @@ void Overlay_Drive::add_DOSdir_to_cache(const char* name, const char *sname) {
 	if (!is_dir_only_in_overlay(name)) {
 		DOSdirs_cache.emplace_back(name);
 		DOSdirs_cache.emplace_back(sname);
+		DOSdirs_index.insert(overlay_key(name));
+		if (*sname) DOSdirs_byshort.emplace(overlay_key(sname),name);
+		journal_overlay_index('D',name,sname);
 	}
 }
 
@@ -1659,8 +1697,10 @@ void Overlay_Drive::remove_DOSdir_from_cache(const char* name) {
 	}
 	for(std::vector<std::string>::iterator it = DOSdirs_cache.begin(); it != DOSdirs_cache.end(); it+=2) {
 		if (!strcasecmp((*it).c_str(), name)||(strlen(fname)&&!strcasecmp((*it).c_str(), fname))||((*(it+1)).length()&&!strcasecmp((*(it+1)).c_str(), name))) {
+			journal_overlay_index('d',*it);
 			DOSdirs_cache.erase(it+1);
 			DOSdirs_cache.erase(it);
+			rebuild_DOSdirs_index();
 			return;
 		}
 	}
@@ -1686,9 +1726,12 @@ void Overlay_Drive::remove_deleted_file(const char* name,bool create_on_disk) {
 		strcpy(fname,temp_name+strlen(basedir)+(*(temp_name+strlen(basedir))=='\\'?1:0));
 		CROSS_DOSFILENAME(fname);
 	}
-	for(std::vector<std::string>::iterator it = deleted_files_in_base.begin(); it != deleted_files_in_base.end(); ++it) {
-		if (!strcasecmp((*it).c_str(), name)||!strcasecmp((*it).c_str(), tname)||(strlen(fname)&&!strcasecmp((*it).c_str(), fname))) {
-			deleted_files_in_base.erase(it);
+	const char* candidates[3] = {name, tname, fname};
+	for (unsigned int c = 0; c < 3; c++) {
+		if (!*candidates[c]) continue;
+		const std::string key = overlay_key(candidates[c]);
+		if (deleted_files_in_base.erase(key)) {
+			journal_overlay_index('x',key);
 			if (create_on_disk) remove_special_file_from_disk(name, "DEL");
 			return;
 		}
@@ -1697,7 +1740,8 @@ void Overlay_Drive::remove_deleted_file(const char* name,bool create_on_disk) {
 void Overlay_Drive::add_deleted_path(const char* name, bool create_on_disk) {
 	if (!name || !*name ) return; //Skip empty file.
 	if (!is_deleted_path(name)) {
-		deleted_paths_in_base.emplace_back(name);
+		deleted_paths_in_base.insert(overlay_key(name));
+		journal_overlay_index('P',overlay_key(name));
 		//Add it to deleted files as well, so it gets skipped in FindNext. 
 		//Maybe revise that.
 		if (create_on_disk) add_special_file_to_disk(name,"RMD");
@@ -1707,26 +1751,22 @@ void Overlay_Drive::add_deleted_path(const char* name, bool create_on_disk) {
 bool Overlay_Drive::is_deleted_path(const char* name) {
 	if (!name || !*name) return false;
 	if (deleted_paths_in_base.empty()) return false;
-	std::string sname(name);
-	std::string::size_type namelen = sname.length();;
-	for(std::vector<std::string>::iterator it = deleted_paths_in_base.begin(); it != deleted_paths_in_base.end(); ++it) {
-		std::string::size_type blockedlen = (*it).length();
-		if (namelen < blockedlen) continue;
-		//See if input starts with name. 
-		std::string::size_type n = sname.find(*it);
-		if (n == 0 && ((namelen == blockedlen) || *(name + blockedlen) == '\\' )) return true;
+	//The name itself or any of its leading directories
+	const std::string key = overlay_key(name);
+	if (deleted_paths_in_base.count(key)) return true;
+	const char* sep = name;
+	while ((sep = strchr_dbcs((char *)sep,'\\')) != NULL) {
+		if (deleted_paths_in_base.count(key.substr(0,(size_t)(sep - name)))) return true;
+		sep++;
 	}
 	return false;
 }
 
 void Overlay_Drive::remove_deleted_path(const char* name, bool create_on_disk) {
-	for(std::vector<std::string>::iterator it = deleted_paths_in_base.begin(); it != deleted_paths_in_base.end(); ++it) {
-		if (!strcasecmp((*it).c_str(), name)) {
-			deleted_paths_in_base.erase(it);
-			remove_deleted_file(name,false); //Rethink maybe.
-			if (create_on_disk) remove_special_file_from_disk(name,"RMD");
-			break;
-		}
+	if (deleted_paths_in_base.erase(overlay_key(name))) {
+		journal_overlay_index('p',overlay_key(name));
+		remove_deleted_file(name,false); //Rethink maybe.
+		if (create_on_disk) remove_special_file_from_disk(name,"RMD");
 	}
 }
 bool Overlay_Drive::check_if_leading_is_deleted(const char* name){
@@ -2007,15 +2047,9 @@ bool Overlay_Drive::FindFirst(const char * _dir,DOS_DTA & dta,bool fcb_findfirst
 				return localDrive::FindFirst(temp_name,dta,fcb_findfirst);
 			}
 			strcpy(tmp, _dir);
-			bool found=false;
-			for(std::vector<std::string>::iterator it = DOSdirs_cache.begin(); it != DOSdirs_cache.end(); it+=2) {
-				if ((*(it+1)).length()&&!strcasecmp((*(it+1)).c_str(), tmp)) {
-					found=true;
-					strcpy(tmp, (*it).c_str());
-					break;
-				}
-			}
-			if (found) {
+			const std::string* longdir = find_DOSdir_by_short(tmp);
+			if (longdir) {
+				strcpy(tmp, longdir->c_str());
 				return localDrive::FindFirst(tmp,dta,fcb_findfirst);
 			}
 		}
@@ -2053,11 +2087,8 @@ bool Overlay_Drive::FileStat(const char* name, FileStat_Block * const stat_block
 		char *p=strrchr_dbcs(tmp, '\\'), *q=strrchr_dbcs(temp_name, '\\');
 		if (p!=NULL&&q!=NULL) {
 			*p=0;
-			for(std::vector<std::string>::iterator it = DOSdirs_cache.begin(); it != DOSdirs_cache.end(); it+=2)
-				if ((*(it+1)).length()&&!strcasecmp((*(it+1)).c_str(), tmp)) {
-					strcpy(tmp, (*it).c_str());
-					break;
-				}
+			const std::string* longdir = find_DOSdir_by_short(tmp);
+			if (longdir) strcpy(tmp, longdir->c_str());
 			strcat(tmp, "\\");
 			strcat(tmp, q+1);
 		}
@@ -2099,3 +2130,157 @@ void Overlay_Drive::EmptyCache(void){
 	localDrive::EmptyCache();
 	update_cache(true);//lets rebuild it.
 }
+
+/* Persistent overlay index
+ *
+ * Scanning the whole overlay tree at mount time gets slow for big overlays, so the result of
+ * update_cache(true) is kept in the overlay directory itself (.DBOVERLAY_IDX_INDEX). After a
+ * header it holds one record per line:
+ *   N name             file present in the overlay             (n name: removed again)
+ *   D name<TAB>sname   directory that only exists in overlay   (d name)
+ *   X name             file deleted from the base              (x name)
+ *   P name             directory deleted from the base         (p name)
+ *   C mtime            clean unmount, modification time of the overlay directory at that point
+ * Changes are appended and flushed as they happen. Mounting replays the records and rewrites the
+ * file as a compacted snapshot (temporary file + rename). The index is only trusted if it ends with
+ * a C record that matches the overlay directory, so a crash or a change made on the host in the
+ * overlay root falls back to scanning. Changes made on the host further down need a RESCAN.
+ */
+static const char overlay_index_magic[] = "DBOVERLAY INDEX 1";
+
+static bool overlay_dir_mtime(const char* dir, long long &mtime) {
+	std::string path(dir);
+	if (path.length() > 1 && path[path.length()-1] == CROSS_FILESPLIT) path.erase(path.length()-1);
+	struct stat st;
+	if (stat(path.c_str(),&st) != 0) return false;
+	mtime = (long long)st.st_mtime;
+	return true;
+}
+
+std::string Overlay_Drive::overlay_index_path(bool temporary) const {
+	return std::string(overlaydir) + special_prefix + "_IDX_INDEX" + (temporary ? ".TMP" : "");
+}
+
+std::string Overlay_Drive::overlay_index_state(void) const {
+	std::string state;
+	for (std::vector<std::string>::const_iterator it = DOSnames_cache.begin(); it != DOSnames_cache.end(); ++it)
+		state += "N " + *it + "\n";
+	for (std::vector<std::string>::const_iterator it = DOSdirs_cache.begin(); it != DOSdirs_cache.end(); it+=2)
+		state += "D " + *it + "\t" + *(it+1) + "\n";
+	std::vector<std::string> files(deleted_files_in_base.begin(),deleted_files_in_base.end());
+	std::vector<std::string> paths(deleted_paths_in_base.begin(),deleted_paths_in_base.end());
+	std::sort(files.begin(),files.end());
+	std::sort(paths.begin(),paths.end());
+	for (std::vector<std::string>::const_iterator it = files.begin(); it != files.end(); ++it)
+		state += "X " + *it + "\n";
+	for (std::vector<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++it)
+		state += "P " + *it + "\n";
+	return state;
+}
+
+bool Overlay_Drive::load_overlay_index(void) {
+	FILE* f = fopen(overlay_index_path(false).c_str(),"rb");
+	if (!f) return false;
+	std::vector<std::string> names, dirs;
+	std::unordered_set<std::string> names_index, files, paths;
+	bool valid = true, clean = false;
+	long long mtime = 0, current = 0;
+	unsigned int lineno = 0;
+	char line[CROSS_LEN * 2 + 8];
+	while (valid && fgets(line,sizeof(line),f)) {
+		size_t len = strlen(line);
+		if (!len || line[len-1] != '\n') { valid = false; break; } //torn write or overlong line
+		line[--len] = 0;
+		if (++lineno == 1) { valid = !strcmp(line,overlay_index_magic); continue; }
+		if (lineno == 2) { valid = line[0] == 'B' && line[1] == ' ' && !strcmp(line+2,basedir); continue; }
+		if (len < 2 || line[1] != ' ' || clean) { valid = false; break; } //nothing may follow the clean unmount
+		const char* arg = line + 2;
+		switch (line[0]) {
+		case 'N':
+			if (names_index.insert(overlay_key(arg)).second) names.emplace_back(arg);
+			break;
+		case 'n':
+			if (names_index.erase(overlay_key(arg))) {
+				for (std::vector<std::string>::iterator it = names.begin(); it != names.end(); ++it)
+					if (!strcasecmp((*it).c_str(), arg)) { names.erase(it); break; }
+			}
+			break;
+		case 'D': {
+			const char* tab = strchr(arg,'\t');
+			if (!tab) { valid = false; break; }
+			dirs.emplace_back(arg,(size_t)(tab - arg));
+			dirs.emplace_back(tab + 1);
+			break;
+		}
+		case 'd':
+			for (std::vector<std::string>::iterator it = dirs.begin(); it != dirs.end(); it+=2)
+				if (*it == arg) { dirs.erase(it,it+2); break; }
+			break;
+		case 'X': files.insert(arg); break;
+		case 'x': files.erase(arg); break;
+		case 'P': paths.insert(arg); break;
+		case 'p': paths.erase(arg); break;
+		case 'C': clean = true; mtime = strtoll(arg,NULL,10); break;
+		default: valid = false; break;
+		}
+	}
+	fclose(f);
+	if (!valid || !clean || !overlay_dir_mtime(overlaydir,current) || current != mtime) {
+		if (logoverlay) LOG_MSG("Overlay index of %s is not usable, scanning the overlay",overlaydir);
+		return false;
+	}
+	DOSnames_cache.swap(names);
+	DOSnames_index.swap(names_index);
+	DOSdirs_cache.swap(dirs);
+	rebuild_DOSdirs_index();
+	deleted_files_in_base.swap(files);
+	deleted_paths_in_base.swap(paths);
+	//Ensure hiding of the folder that contains the overlay, if it is part of the base folder.
+	add_deleted_path(overlap_folder.c_str(), false);
+	//Compact the index and keep it open for changes, it is no longer clean until unmounted.
+	save_overlay_index();
+	if (logoverlay) LOG_MSG("Overlay index of %s loaded: %u files, %u directories, %u deletions",overlaydir,
+		(unsigned int)DOSnames_cache.size(),(unsigned int)(DOSdirs_cache.size()/2),(unsigned int)deleted_files_in_base.size());
+	return true;
+}
+
+void Overlay_Drive::save_overlay_index(void) {
+	if (index_journal) {
+		fclose(index_journal);
+		index_journal = nullptr;
+	}
+	const std::string path = overlay_index_path(false), temp = overlay_index_path(true);
+	FILE* f = fopen(temp.c_str(),"wb");
+	if (!f) return; //read-only overlay, go without
+	const std::string state = overlay_index_state();
+	bool ok = fprintf(f,"%s\nB %s\n",overlay_index_magic,basedir) > 0;
+	ok = fwrite(state.data(),1,state.size(),f) == state.size() && ok;
+	ok = fclose(f) == 0 && ok;
+#if defined(WIN32)
+	if (ok) remove(path.c_str()); //rename() does not replace existing files on Windows
+#endif
+	if (!ok || rename(temp.c_str(),path.c_str()) != 0) {
+		LOG_MSG("Failed to write overlay index %s",path.c_str());
+		remove(temp.c_str());
+		return;
+	}
+	open_overlay_journal();
+}
+
+void Overlay_Drive::open_overlay_journal(void) {
+	if (!index_journal) index_journal = fopen(overlay_index_path(false).c_str(),"ab");
+}
+
+void Overlay_Drive::journal_overlay_index(char op, const std::string& name, const std::string& sname) {
+	if (!index_journal) return;
+	if (op == 'D') fprintf(index_journal,"%c %s\t%s\n",op,name.c_str(),sname.c_str());
+	else fprintf(index_journal,"%c %s\n",op,name.c_str());
+	fflush(index_journal);
+}
+
+Overlay_Drive::~Overlay_Drive() {
+	if (!index_journal) return;
+	long long mtime;
+	if (overlay_dir_mtime(overlaydir,mtime)) fprintf(index_journal,"C %lld\n",mtime);
+	fclose(index_journal);
+}
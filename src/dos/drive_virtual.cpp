@@ -20,6 +20,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <map>
+#include <vector>
+#include <zlib.h>
 #include "dosbox.h"
 #include "dos_inc.h"
 #include "drives.h"
@@ -28,6 +31,7 @@
 #include "control.h"
 #include "cross.h"
 #include "regs.h"
+#include "sharedasset.h"
 
 extern bool gbk, isDBCSCP(), isKanji1_gbk(uint8_t chr), shiftjis_lead_byte(int c);
 
@@ -36,6 +40,7 @@ struct VFILE_Block {
 	const char * lname;
 	uint8_t * data;
 	uint32_t size;
+	const BuiltinFileBlob * packed = NULL;	// data is NULL until the file is first opened
 	uint16_t date;
 	uint16_t time;
 	unsigned int onpos;
@@ -50,6 +55,7 @@ unsigned int vfpos=1, lfn_id[256];
 bool internal_program = false, skipintprog = false;
 char sfn[DOS_NAMELENGTH_ASCII],vfnames[MAX_VFILES][CROSS_LEN],vfsnames[MAX_VFILES][DOS_NAMELENGTH_ASCII];
 static VFILE_Block * first_file, * lfn_search[256], * parent_dir = NULL;
+static unsigned int vfile_generation = 0;	/* changes whenever files are added or removed */
 
 extern int lfn_filefind_handle;
 extern bool filename_not_8x3(const char *n), filename_not_strict_8x3(const char *n);
@@ -195,10 +201,62 @@ void VFILE_Shutdown(void) {
 		first_file = n;
 	}
     vfpos=1;
+    vfile_generation++;
+}
+
+static bool BuiltinFileBlob_Unpack(void *buf, size_t size, const void *ctx) {
+	const BuiltinFileBlob &b = *static_cast<const BuiltinFileBlob*>(ctx);
+	z_stream z;
+	memset(&z, 0, sizeof(z));
+	if (inflateInit2(&z, 16 + MAX_WBITS) != Z_OK) return false;
+	z.next_in = (Bytef*)b.data;
+	z.avail_in = (uInt)b.packed_length;
+	z.next_out = (Bytef*)buf;
+	z.avail_out = (uInt)size;
+	const int err = inflate(&z, Z_FINISH);
+	inflateEnd(&z);
+	return err == Z_STREAM_END && z.total_out == size;
+}
+
+const unsigned char *BuiltinFileBlob_Data(const struct BuiltinFileBlob &b) {
+	static std::map<const BuiltinFileBlob*, const unsigned char*> unpacked;
+
+	if (b.packed_length == 0) return b.data;
+
+	const unsigned char *&data = unpacked[&b];
+	if (data != NULL) return data;
+
+	/* other processes may have unpacked it already, the CRC-32 in the gzip trailer names the content */
+	const unsigned char *trailer = b.data + b.packed_length - 8;
+	char name[64];
+	snprintf(name, sizeof(name), "builtin-%02x%02x%02x%02x-%u-%s", trailer[3], trailer[2], trailer[1], trailer[0],
+		(unsigned int)b.length, b.recommended_file_name);
+	data = (const unsigned char*)SHARED_Build(name, b.length, BuiltinFileBlob_Unpack, &b);
+	if (data == NULL) {
+		unsigned char *buf = new unsigned char[b.length];
+		if (!BuiltinFileBlob_Unpack(buf, b.length, &b)) E_Exit("Built-in file %s is damaged", b.recommended_file_name);
+		data = buf;
+	}
+
+	LOG(LOG_DOSMISC, LOG_DEBUG)("Unpacked built-in file %s, %u bytes", b.recommended_file_name, (unsigned int)b.length);
+	return data;
+}
+
+static uint8_t *VFILE_Data(const VFILE_Block *file) {
+	if (file->data == NULL && file->packed != NULL) return (uint8_t*)BuiltinFileBlob_Data(*file->packed);
+	return file->data;
 }
 
 void VFILE_RegisterBuiltinFileBlob(const struct BuiltinFileBlob &b, const char *dir) {
-	VFILE_Register(b.recommended_file_name, (uint8_t*)b.data, (uint32_t)b.length, dir);
+	if (b.packed_length == 0) {
+		VFILE_Register(b.recommended_file_name, (uint8_t*)b.data, (uint32_t)b.length, dir);
+		return;
+	}
+
+	/* the size is known up front, the data is unpacked by the first open */
+	const VFILE_Block *prev = first_file;
+	VFILE_Register(b.recommended_file_name, NULL, (uint32_t)b.length, dir);
+	if (first_file != prev) first_file->packed = &b;
 }
 
 uint16_t fztime=0, fzdate=0;
@@ -261,6 +319,7 @@ void VFILE_Register(const char * name,uint8_t * data,uint32_t size,const char *d
 	new_file->hidden=hidden;
 	new_file->next=first_file;
 	first_file=new_file;
+	vfile_generation++;
 }
 
 void VFILE_Remove(const char *name,const char *dir = "") {
@@ -280,6 +339,7 @@ void VFILE_Remove(const char *name,const char *dir = "") {
 			*where = chan->next;
 			if(chan == first_file) first_file = chan->next;
 			delete chan;
+			vfile_generation++;
 			return;
 		}
 		where=&chan->next;
@@ -300,7 +360,8 @@ uint32_t VFILE_GetCPIData(const char *filename, std::vector<uint8_t> &cpibuf) {
 	while (chan) {
 		if (onpos==chan->onpos && (strcmp(filename,chan->name) == 0 || strcmp(filename,chan->lname) == 0)) {
             if (chan->size>65535) return 0;
-            for (size_t bct=0; bct<chan->size; bct++) cpibuf.push_back(chan->data[bct]);
+            const uint8_t *data = VFILE_Data(chan);
+            for (size_t bct=0; bct<chan->size; bct++) cpibuf.push_back(data[bct]);
             return chan->size;
 		}
 		chan=chan->next;
@@ -320,6 +381,7 @@ private:
 	uint32_t file_size;
     uint32_t file_pos = 0;
 	uint8_t * file_data;
+	friend const uint8_t * VFILE_GetOpenFileData(uint16_t entry,uint32_t &size,unsigned int &generation);
 };
 
 Virtual_File::Virtual_File(uint8_t* in_data, uint32_t in_size) : file_size(in_size), file_data(in_data) {
@@ -375,6 +437,18 @@ uint16_t Virtual_File::GetInformation(void) {
 	return DeviceInfoFlags::NotWritten;  // read-only drive
 }
 
+/* Contents of the Z: drive file open on a DOS handle, NULL if the handle is not one. Anything
+ * derived from the data stays valid as long as the returned generation does not change. */
+const uint8_t * VFILE_GetOpenFileData(uint16_t entry,uint32_t &size,unsigned int &generation) {
+	const uint8_t handle=RealHandle(entry);
+	if (handle>=DOS_FILES || Files[handle]==NULL) return NULL;
+	const Virtual_File *file=dynamic_cast<Virtual_File*>(Files[handle]);
+	if (file==NULL || file->file_data==NULL) return NULL;
+	size=file->file_size;
+	generation=vfile_generation;
+	return file->file_data;
+}
+
 
 Virtual_Drive::Virtual_Drive() {
 	strcpy(info,"Internal Virtual Drive");
@@ -398,7 +472,7 @@ bool Virtual_Drive::FileOpen(DOS_File * * file,const char * name,uint32_t flags)
             strcasecmp(name,(std::string(onpos?vfnames[onpos]+std::string(1, '\\'):"")+cur_file->name).c_str())==0||
             strcasecmp(name,(std::string(onpos?vfnames[onpos]+std::string(1, '\\'):"")+cur_file->lname).c_str())==0))) {
 			/* We have a match */
-			*file=new Virtual_File(cur_file->data,cur_file->size);
+			*file=new Virtual_File(VFILE_Data(cur_file),cur_file->size);
             (*file)->SetName(cur_file->name);
 			(*file)->flags=flags;
 			return true;
@@ -20,6 +20,9 @@
 #ifndef _DRIVES_H__
 #define _DRIVES_H__
 
+#include <list>
+#include <map>
+#include <string>
 #include <vector>
 #include <sys/types.h>
 #include "dos_system.h"
@@ -97,10 +100,14 @@ public:
 	void closedir(void *handle) override;
 	bool read_directory_first(void *handle, char* entry_name, char* entry_sname, bool& is_directory) override;
 	bool read_directory_next(void *handle, char* entry_name, char* entry_sname, bool& is_directory) override;
+	bool watchdir(const char *name, uint32_t id) override;
+	void unwatchdir(uint32_t id) override;
+	bool read_dir_changes(std::vector<uint32_t> &changed) override;
 	virtual void remove_special_file_from_disk(const char* dosname, const char* operation);
 	virtual std::string create_filename_of_special_operation(const char* dosname, const char* operation, bool expand);
 	virtual bool add_special_file_to_disk(const char* dosname, const char* operation, uint16_t value, bool isdir);
 	void EmptyCache(void) override { dirCache.EmptyCache(); };
+	~localDrive() override;
 	void MediaChange() override {};
 	const char* getBasedir() const {return basedir;};
 	struct {
@@ -119,6 +126,8 @@ private:
 protected:
 	DOS_Drive_Cache dirCache;
 	char basedir[CROSS_LEN];
+	dir_watch_information *dirWatch = NULL;
+	bool dirWatchFailed = false;
 	friend void DOS_Shell::CMD_SUBST(char* args); 	
 	struct {
 		char srch_dir[CROSS_LEN];
@@ -158,6 +167,7 @@ public:
 	void closedir(void *handle) override;
 	bool read_directory_first(void *handle, char* entry_name, char* entry_sname, bool& is_directory) override;
 	bool read_directory_next(void *handle, char* entry_name, char* entry_sname, bool& is_directory) override;
+	bool watchdir(const char *dir, uint32_t id) override { (void)dir; (void)id; return false; }; /* not host paths */
 	const char *GetInfo(void) override;
 	virtual const char *getOverlaydir(void);
 	virtual bool setOverlaydir(const char * name);
@@ -395,10 +405,16 @@ public:
 	bool isRemote(void) override;
 	bool isRemovable(void) override;
 	Bits UnMount(void) override;
+	void MediaChange(void) override;
 public:
+	/* Cluster map of an open file: chain[i] is the i-th cluster of the allocation chain
+	 * starting at first_cluster. Grown on demand by getAbsoluteSectFromChain() and thrown
+	 * away when generation no longer matches chainGeneration, so seeking anywhere within
+	 * the part of the file already visited costs one lookup instead of a walk of the FAT. */
 	struct clusterChainMemory {
-		uint32_t	current_cluster_no = 0;
-		uint32_t	current_cluster_index = 0;
+		std::vector<uint32_t>	chain;
+		uint32_t	first_cluster = 0;
+		uint32_t	generation = 0;
 
 		void clear(void);
 	};
@@ -441,6 +457,8 @@ private:
 	uint32_t getClusterValue(uint32_t clustNum);
 	void setClusterValue(uint32_t clustNum, uint32_t clustValue);
 	uint32_t getClustFirstSect(uint32_t clustNum);
+	uint8_t *getFatSectors(uint32_t fatsectnum);
+	void invalidateFatCache(void);
 	bool FindNextInternal(uint32_t dirClustNumber, DOS_DTA & dta, direntry *foundEntry);
 	bool getDirClustNum(const char * dir, uint32_t * clustNum, bool parDir);
 	bool getFileDirEntry(char const * const filename, direntry * useEntry, uint32_t * dirClust, uint32_t * subEntry,bool dirOk=false);
@@ -495,6 +513,14 @@ private:
 	uint8_t fatSectBuffer[SECTOR_SIZE_MAX * 2] = {};
 	uint32_t curFatSect = 0;
 
+	/* Copy of the first FAT, loaded a sector at a time as it is accessed. Writes go through
+	 * to every FAT on disk immediately, so there is nothing to flush on unmount. Left empty
+	 * (falling back to fatSectBuffer) if the FAT is too large to keep in memory. */
+	std::vector<uint8_t> fatCache;
+	std::vector<bool> fatCacheLoaded;
+	/* bumped whenever an existing link in the FAT changes, invalidating clusterChainMemory */
+	uint32_t chainGeneration = 0;
+
 	DOS_Drive_Cache labelCache;
 public:
 	/* the driver code must use THESE functions to read the disk, not directly from the disk drive,
@@ -653,6 +679,9 @@ struct isoDirEntry {
 #define IS_DIR(fileFlags)	(fileFlags & ISO_DIRECTORY)
 #define IS_HIDDEN(fileFlags)	(fileFlags & ISO_HIDDEN)
 #define ISO_MAX_HASH_TABLE_SIZE 	100u
+#define ISO_READAHEAD_SECTORS		16u	/* sectors read at once by the file data cache */
+#define ISO_SECTOR_CACHE_BLOCKS		32u	/* read-ahead blocks kept by the file data cache */
+#define ISO_MAX_DIR_INDEX_ENTRIES	16384u	/* directory index is dropped and rebuilt past this many entries */
 
 ////////////////////////////////////
 
@@ -1034,8 +1063,6 @@ struct UDFextents {
 	size_t			extent = 0;	// which extent
 	uint64_t		filesz = 0;	// file size
 
-	std::vector<uint8_t>	sector_buffer;
-	uint32_t		sector_buffer_n = 0xFFFFFFFFu;
 
 				UDFextents();
 				UDFextents(const struct UDFextent_ad &s);
@@ -1076,6 +1103,7 @@ public:
 	bool loadImageUDF();
 	bool loadImageUDFAnchorVolumePointer(UDFAnchorVolumeDescriptorPointer &avdp,uint8_t *pvd/*COOKED_SECTOR_SIZE*/,uint32_t sector) const;
 	bool readSector(uint8_t *buffer, uint32_t sector) const;
+	const uint8_t* readSectorCached(uint32_t sector) const;
 	void setFileName(const char* fileName);
 	char const* GetLabel(void) override {return discLabel;};
 	void Activate(void) override;
@@ -1086,9 +1114,9 @@ private:
 	int  UpdateMscdex(char driveLetter, const char* path, uint8_t& subUnit);
 	int  GetDirIterator(const isoDirEntry* de);
 	int  GetDirIterator(const UDFFileEntry &fe);
-	bool GetNextDirEntry(const int dirIteratorHandle, isoDirEntry* de);
 	void FreeDirIterator(const int dirIterator);
 	bool ReadCachedSector(uint8_t** buffer, const uint32_t sector);
+	void ClearCaches(void);
 
 	int nextFreeDirIterator;
 	
@@ -1143,10 +1171,36 @@ private:
 		uint32_t endSector;
 		uint32_t index;
 		uint32_t pos;
+		uint32_t indexKey;	// directory index this iterator walks
+		size_t indexPos;	// next entry of the directory index
 		UDFextents udfdirext;
     } dirIterators[MAX_OPENDIRS] = {};
+
+	/* One parsed directory entry. ISO 9660 fills de (with the 8.3 name in de.ident),
+	 * UDF fills fid, fe and shortName. longName is what readDirEntry/GetNextDirEntry
+	 * leave in fullname. */
+	struct DirIndexEntry {
+		isoDirEntry de;
+		UDFFileIdentifierDescriptor fid;
+		UDFFileEntry fe;
+		std::string shortName;
+		std::string longName;
+	};
+	/* Parsed directories, keyed by extent location (ISO 9660) or File Entry location (UDF) */
+	std::map< uint32_t, std::vector<DirIndexEntry> > dirIndex;
+	size_t dirIndexEntries = 0;
+
+	/* File data cache: runs of up to ISO_READAHEAD_SECTORS sectors */
+	struct SectorCacheBlock {
+		uint32_t sector;
+		uint32_t count;
+		std::vector<uint8_t> data;
+	};
+	mutable std::list<SectorCacheBlock> sectorCache;	// most recently used first
 private:
-	bool GetNextDirEntry(const int dirIteratorHandle, UDFFileIdentifierDescriptor &fid, UDFFileEntry &fe, UDFextents &dirext, char fname[LFN_NAMELENGTH],unsigned int dirIteratorIndex);
+	const std::vector<DirIndexEntry>& GetDirIndex(const DirIterator &dirIterator);
+	bool GetNextDirEntry(DirIterator &dirIterator, isoDirEntry* de);
+	bool GetNextDirEntry(DirIterator &dirIterator, UDFFileIdentifierDescriptor &fid, UDFFileEntry &fe, UDFextents &dirext, char fname[LFN_NAMELENGTH],unsigned int dirIteratorIndex);
 };
 
 struct VFILE_Block;
@@ -1187,6 +1241,7 @@ private:
 class Overlay_Drive: public localDrive {
 public:
 	Overlay_Drive(const char * startdir,const char* overlay, uint16_t _bytes_sector,uint8_t _sectors_cluster,uint16_t _total_clusters,uint16_t _free_clusters,uint8_t _mediaid,uint8_t &error, std::vector<std::string> &options);
+	~Overlay_Drive() override;
 
 	bool FileOpen(DOS_File * * file,const char * name,uint32_t flags) override;
 	bool FileCreate(DOS_File * * file,const char * name,uint16_t /*attributes*/) override;
@@ -1206,6 +1261,7 @@ public:
 	bool TestDir(const char * dir) override;
 	bool RemoveDir(const char * dir) override;
 	bool MakeDir(const char * dir) override;
+	bool watchdir(const char *dir, uint32_t id) override { (void)dir; (void)id; return false; }; /* overlay entries are managed by the drive */
 	const char* getOverlaydir() const {return overlaydir;};
 	bool ovlnocachedir = false;
 	bool ovlreadonly = false;
@@ -1219,8 +1275,8 @@ private:
 	void remove_DOSdir_from_cache(const char* name);
 	void update_cache(bool read_directory_contents = false);
 	
-	std::vector<std::string> deleted_files_in_base; //Set is probably better, or some other solution (involving the disk).
-	std::vector<std::string> deleted_paths_in_base; //Currently only used to hide the overlay folder.
+	std::unordered_set<std::string> deleted_files_in_base; //Keys are upcased, see overlay_key()
+	std::unordered_set<std::string> deleted_paths_in_base; //Currently only used to hide the overlay folder.
 	std::string overlap_folder;
 	void add_deleted_file(const char* name, bool create_on_disk);
 	void remove_deleted_file(const char* name, bool create_on_disk);
@@ -1238,9 +1294,23 @@ private:
 	std::string create_filename_of_special_operation(const char* dosname, const char* operation, bool expand = false) override;
 	void convert_overlay_to_DOSname_in_base(char* dirname );
 	//For caching the update_cache routine.
-	std::vector<std::string> DOSnames_cache; //Also set is probably better.
+	std::vector<std::string> DOSnames_cache; //Order is kept for the drive cache, lookups go through DOSnames_index.
 	std::vector<std::string> DOSdirs_cache; //Can not blindly change its type. it is important that subdirs come after the parent directory.
+	std::unordered_set<std::string> DOSnames_index;
+	std::unordered_set<std::string> DOSdirs_index; //long names of DOSdirs_cache
+	std::unordered_map<std::string,std::string> DOSdirs_byshort; //short name => long name
+	void rebuild_DOSdirs_index(void);
+	const std::string* find_DOSdir_by_short(const char* sname);
 	const std::string special_prefix;
+
+	//Persistent index of the above, kept in the overlay directory so mounting does not have to scan it.
+	FILE* index_journal = nullptr;
+	std::string overlay_index_path(bool temporary) const;
+	std::string overlay_index_state(void) const;
+	bool load_overlay_index(void);
+	void save_overlay_index(void);
+	void open_overlay_journal(void);
+	void journal_overlay_index(char op, const std::string& name, const std::string& sname = std::string());
 };
 
 int get_expanded_files(const std::string &path, std::vector<std::string> &paths, bool readonly);
@@ -75,6 +75,7 @@
 #include "support.h"
 #include "mapper.h"
 #include "ints/int10.h"
+#include "output/output_null.h"
 #include "menu.h"
 #include "jfont.h"
 #include "render.h"
@@ -82,6 +83,12 @@
 #include "parport.h"
 #include "keyboard.h"
 #include "clockdomain.h"
+#include "threadpool.h"
+#include "inputjournal.h"
+#include "hosttime.h"
+#include "dma.h"
+#include "bios_disk.h"
+#include "tracerec.h"
 
 #if __APPLE__ && __MAC_OS_X_VERSION_MIN_REQUIRED < 101200
 /* FIX_ME: A workaround to avoid build error. Change version to 101300 if error occurs for Sierra (10.12) */
@@ -103,6 +110,7 @@ struct __processor_model {
 #endif
 
 #include <list>
+#include <chrono>
 
 bool int10_vp_use_always = false;
 bool int10_vp_use_auto = true;
@@ -191,30 +199,41 @@ bool CheckPreventCap(void) {
 }
 
 /*===================================TODO: Move to its own file==============================*/
-#if defined(__SSE__) && !(defined(_M_AMD64) || defined(__e2k__))
+#if defined(__SSE__) || defined(_M_AMD64) || defined(__e2k__)
 bool sse2_available = false;
+bool ssse3_available = false;
 bool avx2_available = false;
 
 # if defined(_MSC_VER)
-#  define cpuid(func,a,b,c,d)\
-    __asm mov eax, func\
-    __asm cpuid\
-    __asm mov a, eax\
-    __asm mov b, ebx\
-    __asm mov c, ecx\
-    __asm mov d, edx
+#  include <intrin.h>
 # endif /* _MSC_VER */
 
 static void CheckX86ExtensionsSupport()
 {
-#if defined(__GNUC__) && !defined(EMSCRIPTEN)
+#if defined(__e2k__)
+    /* Elbrus translates SSE2, but not AVX2 */
+    sse2_available = true;
+#elif defined(EMSCRIPTEN) && defined(__wasm_simd128__)
+    /* Emscripten translates the SSE intrinsics it was built for to SIMD128 */
+# if defined(__SSE2__)
+    sse2_available = true;
+# endif
+# if defined(__SSSE3__)
+    ssse3_available = true;
+# endif
+#elif defined(__GNUC__) && !defined(EMSCRIPTEN)
     sse2_available = __builtin_cpu_supports("sse2");
+    ssse3_available = __builtin_cpu_supports("ssse3");
     avx2_available = __builtin_cpu_supports("avx2");
 #elif (_MSC_VER) && !defined(EMSCRIPTEN)
-    Bitu a, b, c, d;
-    cpuid(1, a, b, c, d);
-    sse2_available = ((d >> 26) & 1)?true:false;
-    avx2_available = ((b >> 5) & 1)?true:false;
+    int r[4];
+    __cpuid(r, 1);
+    sse2_available = ((r[3] >> 26) & 1)?true:false;
+    ssse3_available = ((r[2] >> 9) & 1)?true:false;
+    /* AVX2 is CPUID leaf 7 EBX bit 5, and needs the OS to save YMM state (OSXSAVE + XCR0) */
+    const bool ymm_saved = ((r[2] >> 27) & 1) && ((_xgetbv(0) & 6) == 6);
+    __cpuidex(r, 7, 0);
+    avx2_available = ymm_saved && ((r[1] >> 5) & 1);
 #endif
 }
 #endif
@@ -223,9 +242,14 @@ static void CheckX86ExtensionsSupport()
 extern void         GFX_SetTitle(int32_t cycles, int frameskip, Bits timing, bool paused);
 extern void         AddSaveStateMapper(), AddMessages(), JFONT_Init(), J3_SetType(std::string type, std::string back, std::string text);
 extern bool         force_nocachedir;
+extern bool         watchhostdir;
 extern bool         convertimg;
 extern bool         wpcolon;
 extern bool         lockmount;
+extern int          disk_image_cache_size;
+extern bool         disk_image_mmap;
+extern int          chd_cache_size;
+extern int          chd_prefetch_hunks;
 extern bool         clearline;
 
 extern Bitu         frames;
@@ -295,6 +319,9 @@ bool                ticksLocked;
 bool                mono_cga=false;
 bool                ignore_opcode_63 = true;
 int                 dynamic_core_cache_block_size = 32;
+bool                dynamic_core_side_exits = true;
+bool                dynamic_core_fast_fpu = false;
+int                 dynamic_core_translate_threshold = 2;
 Bitu                VGA_BIOS_Size_override = 0;
 Bitu                VGA_BIOS_SEG = 0xC000;
 Bitu                VGA_BIOS_SEG_END = 0xC800;
@@ -315,7 +342,7 @@ static uint32_t           Ticks = 0;
 extern double           rtdelta;
 static LoopHandler*     loop;
 
-void increaseticks(), makestdcp950table(), makeseacp951table();
+void increaseticks();
 
 /* The whole load of startups for all the subfunctions */
 void                MEM_Init(Section *);
@@ -423,7 +450,10 @@ extern bool DOSBox_Paused(), isDBCSCP(), InitCodePage();
 //#define DEBUG_CYCLE_OVERRUN_CALLBACK
 
 //For trying other delays
-#define wrap_delay(a) SDL_Delay(a)
+static void wrap_delay(uint32_t ms) {
+    HostTimeScope scope(HOSTTIME_IDLE);
+    GFX_Delay(ms);
+}
 
 static Uint32 SDL_ticks_last = 0,SDL_ticks_next = 0;
 
@@ -464,6 +494,14 @@ static Bitu Normal_Loop(void) {
 
     try {
         while (1) {
+            if (GCC_UNLIKELY(savestate_snapshot_running))
+                SAVESTATE_FinishSnapshot(false);
+            if (GCC_UNLIKELY(rewind_pending))
+                REWIND_Check();
+            if (GCC_UNLIKELY(runahead_pending))
+                RUNAHEAD_Check();
+            if (GCC_UNLIKELY(hosttime_enabled))
+                HOSTTIME_Update();
 #if C_REMOTEDEBUG
             // Check for GDB step/continue requests from the GDB server thread
             if (DEBUG_CheckGDBStep()) {
@@ -474,8 +512,8 @@ static Bitu Normal_Loop(void) {
             SAVESTATE_CheckPendingRequest();
             // Check for emulator control requests from QMP (pause/reset)
             EMULATOR_CheckPendingControl();
-            // Process pending QMP input events (keyboard, mouse) - thread-safe queue
-            QMP_ProcessPendingInputEvents();
+            // Check for trace recorder start/stop requests from QMP
+            TRACE_CheckPending();
 #endif
             if (PIC_RunQueue()) {
                 /* now is the time to check for the NMI (Non-maskable interrupt) */
@@ -483,7 +521,11 @@ static Bitu Normal_Loop(void) {
 
                 saved_allow = dosbox_allow_nonrecursive_page_fault;
                 dosbox_allow_nonrecursive_page_fault = true;
-                ret = (*cpudecoder)();
+                {
+                    GFX_SDLReleased released;
+                    HostTimeScope scope(HOSTTIME_CPU);
+                    ret = (*cpudecoder)();
+                }
                 dosbox_allow_nonrecursive_page_fault = saved_allow;
 
                 if (GCC_UNLIKELY(ret<0))
@@ -523,10 +565,12 @@ static Bitu Normal_Loop(void) {
                     return 0;
 #endif
             } else {
-                GFX_Events();
-                if (DOSBox_Paused() == false && ticksRemain > 0) {
+                /* input waits for the real frame, and frames that are rolled back run unthrottled */
+                if (GCC_LIKELY(!runahead_ahead)) GFX_Events();
+                if (GCC_UNLIKELY(input_journal_active)) INPUTJOURNAL_Poll();
+                if (DOSBox_Paused() == false && (ticksRemain > 0 || runahead_ahead)) {
                     TIMER_AddTick();
-                    ticksRemain--;
+                    if (!runahead_ahead) ticksRemain--;
                 } else {
                     increaseticks();
                     return 0;
@@ -574,9 +618,147 @@ static Bitu Normal_Loop(void) {
 	return 0;
 }
 
+/* Cycle governor. Host time is split into time slept, time spent rendering
+ * (RENDER_EndUpdate) and mixing (MIXER_Mix), the rest is emulation. The cost of
+ * emulation is taken to scale with CPU_CycleMax, the rendering and mixing cost
+ * is taken as fixed. Every 250ms CPU_CycleMax is scaled so that the measured cost
+ * fits the budget. The totals only ever grow, a window or frame is the difference
+ * between two marks. */
+struct GovernorMark {
+    uint64_t    when;           /* host ns */
+    double      emu_ms;         /* PIC_FullIndex() */
+    uint64_t    sleep_ns;
+    uint64_t    fixed_ns;       /* render + audio */
+};
+
+struct GovernorCost {
+    uint64_t    cpu_ns;         /* host time spent emulating */
+    uint64_t    fixed_ns;       /* host time spent rendering and mixing */
+    uint64_t    budget_ns;
+};
+
+static struct {
+    uint64_t        sleep_ns;
+    uint64_t        fixed_ns;
+    GovernorMark    window;
+    GovernorMark    frame;
+    GovernorCost    worst;      /* deadline: the frame of this window that used most of its budget */
+    bool            have_worst;
+} governor;
+
+uint64_t CPU_Governor_Clock(void) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void CPU_Governor_Account(unsigned int what,uint64_t start) {
+    (void)what; /* render and audio are both fixed cost for now */
+    governor.fixed_ns += CPU_Governor_Clock() - start;
+}
+
+static GovernorMark CPU_Governor_Mark(void) {
+    GovernorMark m;
+    m.when = CPU_Governor_Clock();
+    m.emu_ms = PIC_FullIndex();
+    m.sleep_ns = governor.sleep_ns;
+    m.fixed_ns = governor.fixed_ns;
+    return m;
+}
+
+static GovernorCost CPU_Governor_Cost(const GovernorMark &from,const GovernorMark &to,uint64_t budget_ns) {
+    GovernorCost c;
+    const uint64_t wall = to.when - from.when;
+    const uint64_t slept = to.sleep_ns - from.sleep_ns;
+    const uint64_t busy = (wall > slept) ? (wall - slept) : 0;
+    c.fixed_ns = to.fixed_ns - from.fixed_ns;
+    c.cpu_ns = (busy > c.fixed_ns) ? (busy - c.fixed_ns) : 0;
+    c.budget_ns = budget_ns * (uint64_t)CPU_GovernorTarget / 100u * (uint64_t)CPU_CyclePercUsed / 100u;
+    return c;
+}
+
+void CPU_Governor_Reset(void) {
+    governor.window = governor.frame = CPU_Governor_Mark();
+    governor.have_worst = false;
+}
+
+void CPU_Governor_FrameEnd(void) {
+    if (CPU_GovernorMode != CPU_GOVERNOR_DEADLINE) return;
+
+    const GovernorMark now = CPU_Governor_Mark();
+    const double period_ms = now.emu_ms - governor.frame.emu_ms;
+    if (period_ms > 0) {
+        const GovernorCost c = CPU_Governor_Cost(governor.frame,now,(uint64_t)(period_ms * 1000000.0));
+        /* compare the fraction of the budget used without dividing */
+        if (!governor.have_worst ||
+            (double)(c.cpu_ns + c.fixed_ns) * governor.worst.budget_ns >
+            (double)(governor.worst.cpu_ns + governor.worst.fixed_ns) * c.budget_ns) {
+            governor.worst = c;
+            governor.have_worst = true;
+        }
+    }
+    governor.frame = now;
+}
+
+static void CPU_Governor_Adjust(void) {
+    const GovernorMark now = CPU_Governor_Mark();
+    const uint64_t wall = now.when - governor.window.when;
+    if (wall < 250000000u) return;
+
+    GovernorCost c;
+    if (CPU_GovernorMode == CPU_GOVERNOR_DEADLINE && governor.have_worst)
+        c = governor.worst;
+    else /* share, or no frames were rendered */
+        c = CPU_Governor_Cost(governor.window,now,wall);
+
+    if (c.cpu_ns != 0 && CPU_CycleMax > 0) {
+        /* host time left for emulation */
+        const double room = (double)c.budget_ns - (double)c.fixed_ns;
+        double scale = (room > 0) ? (room / (double)c.cpu_ns) : 0.25;
+
+        /* go down at once, approach higher values halfway to avoid overshooting */
+        if (scale > 1.0) scale = 1.0 + (scale - 1.0) / 2;
+        if (scale > 2.0) scale = 2.0;
+        if (scale < 0.25) scale = 0.25;
+
+        if (scale < 0.97 || scale > 1.03) {
+            int64_t new_cmax = (int64_t)((double)CPU_CycleMax * scale);
+            if (new_cmax < CPU_CYCLES_LOWER_LIMIT) new_cmax = CPU_CYCLES_LOWER_LIMIT;
+            if (CPU_CycleLimit > 0) {
+                if (new_cmax > CPU_CycleLimit) new_cmax = CPU_CycleLimit;
+            }
+            else if (new_cmax > 2000000) new_cmax = 2000000; //Hardcoded limit, if no limit was specified.
+
+            /*
+            LOG_MSG("governor: cmax %6d -> %6d  cpu %.2fms fixed %.2fms budget %.2fms",
+                (int)CPU_CycleMax,(int)new_cmax,c.cpu_ns/1e6,c.fixed_ns/1e6,c.budget_ns/1e6);
+            */
+            if (new_cmax != CPU_CycleMax) {
+                RDTSC_rebase();
+                CPU_CycleMax = (cpu_cycles_count_t)new_cmax;
+            }
+        }
+    }
+
+    CPU_IODelayRemoved = 0;
+    ticksDone = 0;
+    ticksScheduled = 0;
+    governor.window = now;
+    governor.have_worst = false;
+}
+
+static void DOSBOX_AutoTurboCheck(void);
+
+/* The host time (GetTicks) the emulation has got to: the ticks run in bursts after each sleep,
+ * each standing for one millisecond of the host time that passed. Negative when the emulation
+ * does not run in step with the host (turbo, other speeds, paused, frames run ahead). */
+double DOSBOX_EmulatedHostTicks(void) {
+    if (ticksLocked || emulator_speed != 100u || runahead_ahead || DOSBox_Paused()) return -1;
+    return (double)ticksLast - (double)ticksRemain - 1.0 + (double)PIC_TickIndex();
+}
+
 void increaseticks() { //Make it return ticksRemain and set it in the function above to remove the global variable.
     static int32_t lastsleepDone = -1;
     static Bitu sleep1count = 0;
+    DOSBOX_AutoTurboCheck();
     if (GCC_UNLIKELY(ticksLocked)) { // For Fast Forward Mode
         ticksRemainSpeedFrac = 0;
         ticksRemain = 5;
@@ -585,6 +767,7 @@ void increaseticks() { //Make it return ticksRemain and set it in the function a
         ticksAdded = 0;
         ticksDone = 0;
         ticksScheduled = 0;
+        if (CPU_GovernorMode != CPU_GOVERNOR_OFF) CPU_Governor_Reset();
         return;
     }
     uint32_t ticksNew = GetTicks();
@@ -593,6 +776,13 @@ void increaseticks() { //Make it return ticksRemain and set it in the function a
     if (ticksNew <= ticksLast) { //lower should not be possible, only equal.
         ticksAdded = 0;
 
+        if (CPU_GovernorMode != CPU_GOVERNOR_OFF) {
+            const uint64_t start = CPU_Governor_Clock();
+            wrap_delay(1);
+            governor.sleep_ns += CPU_Governor_Clock() - start;
+            return;
+        }
+
         if (!CPU_CycleAutoAdjust || CPU_SkipCycleAutoAdjust || sleep1count < 3) {
             wrap_delay(1);
         }
@@ -644,6 +834,11 @@ void increaseticks() { //Make it return ticksRemain and set it in the function a
     if (!CPU_CycleAutoAdjust || CPU_SkipCycleAutoAdjust)
         return;
 
+    if (CPU_GovernorMode != CPU_GOVERNOR_OFF) {
+        CPU_Governor_Adjust();
+        return;
+    }
+
     if (ticksScheduled >= 250 || ticksDone >= 250 || (ticksAdded > 15 && ticksScheduled >= 5)) {
         if (ticksDone < 1) ticksDone = 1; // Protect against div by zero
         /* ratio we are aiming for is around 90% usage*/
@@ -771,6 +966,7 @@ void DOSBOX_RunMachine(void){
 }
 
 uint32_t turbolasttick = 0;
+static bool autoturbo_active = false;
 static void DOSBOX_UnlockSpeed( bool pressed ) {
     static bool autoadjust = false;
     if (pressed) {
@@ -789,6 +985,7 @@ static void DOSBOX_UnlockSpeed( bool pressed ) {
         LOG_MSG("Fast Forward OFF");
         ticksLocked = false;
         turbolasttick = 0;
+        autoturbo_active = false;
         if (autoadjust) {
             autoadjust = false;
             CPU_CycleAutoAdjust = true;
@@ -808,6 +1005,99 @@ void DOSBOX_UnlockSpeed2( bool pressed ) {
     }
 }
 
+/* Automatic turbo while the guest is loading: sustained reads from disk or CD (counted in
+ * disk_io_bytes_read by DOS, INT 13h, IDE and MSCDEX), no input from the user and no sound
+ * DMA running. The windows are host time, so a loading phase is over quickly once it runs
+ * unlocked. Turbo the user turned on is left alone. */
+#define AUTOTURBO_WINDOW_MS         250u
+#define AUTOTURBO_BUSY_BYTES        (32u * 1024u)   /* read in a window to count as loading */
+#define AUTOTURBO_BUSY_WINDOWS      2u              /* busy windows in a row to turn it on */
+#define AUTOTURBO_IDLE_WINDOWS      2u              /* quiet windows in a row to turn it off */
+#define AUTOTURBO_INPUT_MS          2000u           /* not this soon after a key or mouse button */
+
+static uint32_t autoturbo_window = 0;
+static uint32_t autoturbo_input = 0;
+static uint64_t autoturbo_bytes = 0;
+static unsigned int autoturbo_busy = 0;
+static unsigned int autoturbo_idle = 0;
+
+/* DMA channels with a device attached that are unmasked, other than the floppy and cascade */
+static bool DOSBOX_SoundDMAActive(void) {
+    for (uint8_t ch=0;ch < 8;ch++) {
+        if (ch == 2 || ch == 4) continue;
+        DmaChannel *chan = GetDMAChannel(ch);
+        if (chan != NULL && !chan->masked && chan->callback != NULL) return true;
+    }
+    return false;
+}
+
+static void DOSBOX_AutoTurboStop(void) {
+    if (autoturbo_active && ticksLocked) {
+        LOG(LOG_MISC,LOG_DEBUG)("Loading phase over, back to normal speed");
+        DOSBOX_UnlockSpeed(false);
+    }
+    autoturbo_active = false;
+    autoturbo_busy = 0;
+    autoturbo_idle = 0;
+}
+
+bool DOSBOX_AutoTurboActive() {
+    return autoturbo_active;
+}
+
+void DOSBOX_AutoTurboInput() {
+    autoturbo_input = GetTicks();
+    if (autoturbo_active) DOSBOX_AutoTurboStop();
+}
+
+static void DOSBOX_AutoTurboCheck(void) {
+    const uint32_t now = GetTicks();
+    if ((now - autoturbo_window) < AUTOTURBO_WINDOW_MS) return;
+    autoturbo_window = now;
+
+    const uint64_t bytes = disk_io_bytes_read - autoturbo_bytes;
+    autoturbo_bytes = disk_io_bytes_read;
+
+    if (control == NULL || !static_cast<Section_prop *>(control->GetSection("cpu"))->Get_bool("turbo while loading")) {
+        if (autoturbo_active) DOSBOX_AutoTurboStop();
+        return;
+    }
+
+    /* turbo the user turned on, or off again */
+    if (ticksLocked != autoturbo_active) {
+        autoturbo_active = false;
+        autoturbo_busy = 0;
+        return;
+    }
+
+    if (autoturbo_active) {
+        if (DOSBOX_SoundDMAActive()) {
+            DOSBOX_AutoTurboStop();
+        }
+        else if (bytes < AUTOTURBO_BUSY_BYTES) {
+            if (++autoturbo_idle >= AUTOTURBO_IDLE_WINDOWS) DOSBOX_AutoTurboStop();
+        }
+        else {
+            autoturbo_idle = 0;
+        }
+        return;
+    }
+
+    if (bytes < AUTOTURBO_BUSY_BYTES || (now - autoturbo_input) < AUTOTURBO_INPUT_MS || DOSBOX_SoundDMAActive()) {
+        autoturbo_busy = 0;
+        return;
+    }
+    if (++autoturbo_busy < AUTOTURBO_BUSY_WINDOWS) return;
+
+    LOG(LOG_MISC,LOG_DEBUG)("Loading phase detected, running unlocked");
+    DOSBOX_UnlockSpeed(true);
+    /* no time limit, it ends with the loading */
+    turbolasttick = 0;
+    autoturbo_active = true;
+    autoturbo_busy = 0;
+    autoturbo_idle = 0;
+}
+
 void DOSBOX_NormalSpeed( bool pressed ) {
     if (pressed) {
         /* should also cancel turbo mode */
@@ -915,6 +1205,11 @@ void DOSBOX_InitTickLoop() {
 
     ticksRemain = 0;
     ticksLocked = section->Get_bool("turbo");
+    /* output=null: nobody is watching, run as fast as the host allows */
+    if (OUTPUT_NULL_Unthrottled()) ticksLocked = true;
+    /* benchmark replays: emulated time is all that matters */
+    Section_prop *dosbox_section = static_cast<Section_prop *>(control->GetSection("dosbox"));
+    if (*dosbox_section->Get_string("replay input") != 0 && dosbox_section->Get_bool("replay unthrottled")) ticksLocked = true;
     ticksLastRTtime = 0;
     ticksLast = GetTicks();
     ticksLastRTcounter = GetTicks();
@@ -1160,6 +1455,8 @@ void DOSBOX_RealInit() {
     //       on the title= setting now to auto-update the titlebar when this changes.
     dosbox_title = section->Get_string("title");
 
+    THREADPOOL_Init();
+
     // TODO: these should be parsed by DOS kernel at startup
     dosbox_shell_env_size = (unsigned int)section->Get_int("shell environment size");
 
@@ -1181,6 +1478,7 @@ void DOSBOX_RealInit() {
     allow_port_92_reset = section->Get_bool("allow port 92 reset");
 
     force_nocachedir = section->Get_bool("nocachedir");
+    watchhostdir = section->Get_bool("watchhostdir");
     std::string freesizestr = section->Get_string("freesizecap");
     if (freesizestr == "fixed" || freesizestr == "false" || freesizestr == "0") freesizecap = 0;
     else if (freesizestr == "relative" || freesizestr == "2") freesizecap = 2;
@@ -1188,6 +1486,18 @@ void DOSBOX_RealInit() {
     convertimg = section->Get_bool("convertdrivefat");
     wpcolon = section->Get_bool("leading colon write protect image");
     lockmount = section->Get_bool("locking disk image mount");
+    disk_image_cache_size = section->Get_int("disk image cache size");
+    disk_image_mmap = section->Get_bool("disk image mmap");
+    chd_cache_size = section->Get_int("chd cache size");
+    chd_prefetch_hunks = section->Get_int("chd prefetch hunks");
+
+    runahead_frames = (unsigned int)section->Get_int("runahead frames");
+    RUNAHEAD_Reset();
+    rewind_interval = (unsigned int)section->Get_int("rewind interval");
+    rewind_budget = (size_t)section->Get_int("rewind buffer size") * 1024u * 1024u;
+    REWIND_Reset();
+    INPUTJOURNAL_Init(section->Get_string("record input"),section->Get_string("replay input"));
+    HOSTTIME_Enable(section->Get_bool("host time accounting"));
 
     // CGA/EGA/VGA-specific
     extern unsigned char vga_p3da_undefined_bits;
@@ -1309,10 +1619,7 @@ void DOSBOX_RealInit() {
     gbk = ttf_section->Get_bool("gbk");
     chinasea = ttf_section->Get_bool("chinasea");
     uao = ttf_section->Get_bool("uao");
-    if (IS_PDOSV || IS_TDOSV || dos.loaded_codepage == 936 || dos.loaded_codepage == 950 || dos.loaded_codepage == 951 || control->opt_langcp) {
-        makestdcp950table();
-        makeseacp951table();
-    }
+    /* the code page 950/951 tables are built by the file name conversion when first needed */
     dos.loaded_codepage = cp;
     if (!tonoime) SetIME();
 #if defined(USE_TTF)
@@ -1399,11 +1706,16 @@ void DOSBOX_SetupConfigSections(void) {
     const char* vsyncrate[] = { "%u", nullptr };
     const char* force[] = { "", "forced", "prompt", nullptr };
     const char* cyclest[] = { "auto","fixed","max","%u", nullptr };
+    const char* cyclegovernors[] = { "off", "share", "deadline", nullptr };
     const char* mputypes[] = { "intelligent", "uart", "none", nullptr };
-    const char* vsyncmode[] = { "off", "on" ,"force", "host", nullptr };
+    const char* mixerresamplers[] = { "linear", "fast", "medium", "high", nullptr };
+    const char* vsyncmode[] = { "off", "on" ,"force", "host", "adaptive", nullptr };
     const char* captureformats[] = { "default", "avi-zmbv", "mpegts-h264", nullptr };
     const char* blocksizes[] = {"1024", "2048", "4096", "8192", "512", "256", nullptr };
     const char* capturechromaformats[] = { "auto", "4:4:4", "4:2:2", "4:2:0", nullptr };
+    const char* capturequeuepolicies[] = { "drop", "block", nullptr };
+    const char* screenshotformats[] = { "png", "qoi", "bmp", nullptr };
+    const char* captureencoders[] = { "software", "auto", "nvenc", "vaapi", "qsv", "videotoolbox", "amf", nullptr };
     const char* controllertypes[] = { "auto", "at", "xt", "pcjr", "pc98", nullptr }; // Future work: Tandy(?) and USB
     const char* auxdevices[] = {"none","2button","3button","intellimouse","intellimouse45",nullptr};
     const char* cputype_values[] = {"auto", "8086", "8086_prefetch", "80186", "80186_prefetch", "286", "286_prefetch", "386", "386_prefetch", "486old", "486old_prefetch", "486", "486_prefetch", "pentium", "pentium_mmx", "ppro_slow", "pentium_ii", "pentium_iii", "experimental", nullptr };
@@ -1454,6 +1766,7 @@ void DOSBOX_SetupConfigSections(void) {
     const char* lfn_settings[] = { "true", "false", "1", "0", "auto", "autostart", nullptr };
     const char* fat32setver_settings[] = { "ask", "auto", "manual", nullptr };
     const char* quit_settings[] = { "true", "false", "1", "0", "auto", "autofile", nullptr };
+    const char* savestate_formats[] = { "zip", "zstd", nullptr };
     const char* autofix_settings[] = { "true", "false", "1", "0", "both", "a20fix", "loadfix", "none", nullptr };
     const char* color_themes[] = { "default", "black", "red", "green", "yellow", "blue", "magenta", "cyan", "white", nullptr };
     const char* color_themes_config[] = {
@@ -1466,12 +1779,14 @@ void DOSBOX_SetupConfigSections(void) {
     const char* dmasgus[] = { "3", "0", "1", "5", "6", "7", nullptr };
     const char* dmassb[] = { "1", "5", "0", "3", "6", "7", "-1", nullptr };
     const char* oplemus[] = { "default", "compat", "fast", "nuked", "mame", "opl2board", "opl3duoboard", "retrowave_opl3", "esfmu", nullptr };
-    const char *qualityno[] = { "0", "1", "2", "3", nullptr };
+    const char *qualityno[] = { "0", "1", "2", "3", "4", nullptr };
     const char* tandys[] = { "auto", "on", "off", nullptr };
     const char* ps1opt[] = { "on", "off", nullptr };
     const char* numopt[] = { "on", "off", "", nullptr };
     const char* freesizeopt[] = {"true", "false", "fixed", "relative", "cap", "2", "1", "0", nullptr };
     const char* truefalseautoopt[] = { "true", "false", "1", "0", "auto", nullptr };
+    const char* videodebugoverlays[] = { "framebuffer", "composited", nullptr };
+    const char* renderondemandopt[] = { "true", "false", "1", "0", "auto", "adaptive", nullptr };
     const char* truefalsequietopts[] = { "true", "false", "1", "0", "quiet", nullptr };
     const char* pc98fmboards[] = { "auto", "off", "false", "board14", "board26k", "board86", "board86c", nullptr };
     const char* pc98videomodeopt[] = { "", "24khz", "31khz", "15khz", nullptr };
@@ -1537,6 +1852,8 @@ void DOSBOX_SetupConfigSections(void) {
         "pcap", "slirp", "nothing", "auto", "none",
         nullptr };
 
+    const char* nictypes[] = { "ne2000", "rtl8139", nullptr };
+
     const char* workdiropts[] = {
         "autoprompt", "config", "custom", "default", "force", "noprompt", "program", "prompt", "userconfig",
         nullptr };
@@ -1576,6 +1893,9 @@ void DOSBOX_SetupConfigSections(void) {
 #endif
 #if (C_DYNREC)
         "dynamic_rec",
+#endif
+#if defined(C_HAVE_LINUX_KVM_X86)
+        "kvm",
 #endif
         "normal", "full", "simple", nullptr };
 
@@ -1589,7 +1909,7 @@ void DOSBOX_SetupConfigSections(void) {
         nullptr
     };
 
-#if defined(__SSE__) && !(defined(_M_AMD64) || defined(__e2k__)) && !defined(EMSCRIPTEN)
+#if (defined(__SSE__) || defined(_M_AMD64) || defined(__e2k__)) && !defined(EMSCRIPTEN)
     CheckX86ExtensionsSupport();
 #endif
     SDLNetInited = false;
@@ -1619,6 +1939,11 @@ void DOSBOX_SetupConfigSections(void) {
     Pbool->Set_help("If set, DOSBox-X will skip the BIOS screen by activating fast BIOS logo mode (without 1-second pause).");
     Pbool->SetBasic(true);
 
+    Pbool = secprop->Add_bool("quickboot",Property::Changeable::OnlyAtStart,false);
+    Pbool->Set_help("If set, the BIOS POST skips the delays real hardware needs: the BIOS screen and its pause are not shown, there is no\n"
+                    "reboot delay unless one is given, keyboard resets finish at once, floppy seeks are instant and CD-ROM drives\n"
+                    "spin up almost at once unless a spinup time is given. Useful to get to the DOS prompt or a booted guest OS sooner.");
+
     Pbool = secprop->Add_bool("disable graphical splash",Property::Changeable::OnlyAtStart,false);
     Pbool->Set_help("If set, DOSBox-X will always display text-mode BIOS splash screen instead of the graphical one.\n"
                     "The text-mode BIOS screen will automatically be used if the TrueType font (TTF) output is enabled.");
@@ -1675,6 +2000,12 @@ void DOSBOX_SetupConfigSections(void) {
             "For working directory option=prompt, the specified directory becomes the default directory for the folder selection.");
     Pstring->SetBasic(true);
 
+    Pstring = secprop->Add_path("shared asset directory",Property::Changeable::OnlyAtStart,"");
+    Pstring->Set_help("If set, read-only data that DOSBox-X builds at runtime, such as the unpacked built-in DOS programs,\n"
+            "is kept in this directory, and every DOSBox-X instance pointing here maps the same copy instead of building\n"
+            "its own. Useful when running many instances on one host; a directory in memory (e.g. /dev/shm/dosbox-x) is best.\n"
+            "The directory must exist and be writable. TrueType font files are mapped and shared in any case.");
+
     Pbool = secprop->Add_bool("show advanced options", Property::Changeable::Always, false);
     Pbool->Set_help("If set, the Configuration Tool will display all config options (including advanced ones) by default.");
     Pbool->SetBasic(true);
@@ -1763,6 +2094,13 @@ void DOSBOX_SetupConfigSections(void) {
     Pbool = secprop->Add_bool("video debug at startup", Property::Changeable::WhenIdle,false);
     Pbool->Set_help("If set, have video debug displays on by default");
 
+    Pstring = secprop->Add_string("video debug overlay", Property::Changeable::WhenIdle,"framebuffer");
+    Pstring->Set_values(videodebugoverlays);
+    Pstring->Set_help("How the video debug displays are drawn.\n"
+                      "  framebuffer: Drawn into the emulated screen, so they appear in screenshots and video captures.\n"
+                      "  composited:  Drawn by the OpenGL or Direct3D 11 output as a layer over the screen, which leaves the\n"
+                      "               emulated screen and the scaler work unchanged. Other outputs use framebuffer.");
+
     Pbool = secprop->Add_bool("saveremark", Property::Changeable::WhenIdle,true);
     Pbool->Set_help("If set, the save state feature will ask users to enter remarks when saving a state.");
     Pbool->SetBasic(true);
@@ -1774,6 +2112,65 @@ void DOSBOX_SetupConfigSections(void) {
     Pbool = secprop->Add_bool("compresssaveparts", Property::Changeable::WhenIdle,true);
     Pbool->Set_help("If set, DOSBox-X will compress components of saved states to save space.");
 
+    Pbool = secprop->Add_bool("snapshot savestates", Property::Changeable::WhenIdle,false);
+    Pbool->Set_help("If set, saving a state only pauses emulation long enough to take a copy-on-write snapshot of the\n"
+                    "emulator, and the state file is written in the background. Only supported on Linux, macOS and other POSIX hosts.");
+
+    Pbool = secprop->Add_bool("background savestates", Property::Changeable::WhenIdle,true);
+    Pbool->Set_help("If set, saving a state only pauses emulation long enough to copy the state into memory, it is then\n"
+                    "compressed and written to the file on a thread of its own. \"snapshot savestates\" takes precedence where supported.");
+
+    Pstring = secprop->Add_string("savestate format",Property::Changeable::WhenIdle,"zip");
+    Pstring->Set_values(savestate_formats);
+    Pstring->Set_help("Format of saved state files. \"zip\" files can be opened by any ZIP tool. \"zstd\" files are compressed and\n"
+                    "decompressed on every worker thread in parallel, which makes saving and loading large states much faster.\n"
+                    "States in either format can always be loaded.");
+
+    Pint = secprop->Add_int("savestate compression level",Property::Changeable::WhenIdle,3);
+    Pint->SetMinMax(0,19);
+    Pint->Set_help("Compression level of \"zstd\" save state files, from 1 (fastest) to 19 (smallest).\n"
+                   "0 stores the state uncompressed, which lets loading map the guest memory straight from the file.");
+
+    Pint = secprop->Add_int("incremental savestates", Property::Changeable::WhenIdle,0);
+    Pint->SetMinMax(0,1000);
+    Pint->Set_help("If nonzero, a saved state only holds the memory pages the guest wrote since the state saved or loaded\n"
+                    "before it, up to this many in a row before a full state is saved again. Loading one reads every state it\n"
+                    "was saved on top of, so those must not be removed or overwritten. Set to 0 to always save full states.");
+
+    Pint = secprop->Add_int("runahead frames", Property::Changeable::WhenIdle,0);
+    Pint->SetMinMax(0,4);
+    Pint->Set_help("Reduce input latency by running this many frames ahead of what is shown. Every emulated frame is saved\n"
+                    "in memory, run ahead with the current input and the last frame shown, then rolled back. Helps games that\n"
+                    "react to input a frame or two late. Costs a save and load state per frame, so it suits small memory sizes and\n"
+                    "fixed cycles best. Set to 0 to disable. Not active while capturing audio, video or screenshots.");
+
+    Pint = secprop->Add_int("rewind interval", Property::Changeable::WhenIdle,0);
+    Pint->SetMinMax(0,3600);
+    Pint->Set_help("Capture the state in memory every this many frames, so the \"Rewind\" shortcut (Host+Z) can step back through\n"
+                    "them. Only what changed since the capture before is kept, within \"rewind buffer size\". Set to 0 to disable.");
+
+    Pint = secprop->Add_int("rewind buffer size", Property::Changeable::WhenIdle,64);
+    Pint->SetMinMax(1,4096);
+    Pint->Set_help("Memory in MB for the steps \"rewind interval\" keeps. The oldest steps are dropped when it is full. The latest\n"
+                    "capture is kept whole on top of this.");
+
+    Pstring = secprop->Add_path("record input", Property::Changeable::OnlyAtStart,"");
+    Pstring->Set_help("If set, keyboard, mouse and joystick input is recorded to this file at the emulated time the guest gets it.\n"
+                      "Set a fixed \"cycles\" value so that \"replay input\" can repeat the run exactly.");
+
+    Pstring = secprop->Add_path("replay input", Property::Changeable::OnlyAtStart,"");
+    Pstring->Set_help("If set, the input recorded by \"record input\" in this file is given to the guest again at the same emulated\n"
+                      "time, and live input is ignored. Use the same fixed \"cycles\" value as the recording.");
+
+    Pbool = secprop->Add_bool("replay unthrottled", Property::Changeable::OnlyAtStart,false);
+    Pbool->Set_help("Run as fast as the host allows while \"replay input\" is set, for benchmarks. The -time-limit command line\n"
+                    "option ends the run at a fixed emulated time.");
+
+    Pbool = secprop->Add_bool("host time accounting", Property::Changeable::WhenIdle,false);
+    Pbool->Set_help("Time the CPU core, event handlers, VGA line drawing, scalers, output, mixer channels and disk I/O on the host,\n"
+                    "and show their share of host time in the title bar, the video debug overlay and the debugger (HOSTSTAT).\n"
+                    "Shows whether a slow run is spent emulating, rendering, mixing or waiting on I/O.");
+
     Pbool = secprop->Add_bool("show recorded filename", Property::Changeable::WhenIdle,false);
     Pbool->Set_help("If set, DOSBox-X will show message boxes with recorded filenames when making audio or video captures.");
 
@@ -1781,6 +2178,28 @@ void DOSBOX_SetupConfigSections(void) {
     Pbool = secprop->Add_bool("skip encoding unchanged frames",Property::Changeable::WhenIdle,false);
     Pbool->Set_help("Unchanged frames will not be sent to the video codec as a possible performance and bandwidth optimization.");
 
+    Pint = secprop->Add_int("video capture queue",Property::Changeable::WhenIdle,8);
+    Pint->SetMinMax(0,64);
+    Pint->Set_help("Number of frames that can wait for the video encoder, which then runs on its own thread so that\n"
+                   "recording does not slow down the emulation. Set to 0 to encode on the emulation thread.");
+
+    Pstring = secprop->Add_string("video capture queue policy",Property::Changeable::WhenIdle,"drop");
+    Pstring->Set_values(capturequeuepolicies);
+    Pstring->Set_help("What to do when the video capture queue is full:\n"
+                      "  drop: Record the frame as a repeat of the previous one. The number of dropped frames is logged when recording stops.\n"
+                      "  block: Wait for the encoder. No frames are lost but the emulation may stutter.");
+
+    Pstring = secprop->Add_string("screenshot format",Property::Changeable::WhenIdle,"png");
+    Pstring->Set_values(screenshotformats);
+    Pstring->Set_help("File format of screenshots, which are written on their own thread:\n"
+                      "  png: Compressed with the zlib level set by 'screenshot png level'.\n"
+                      "  qoi: Quite OK Image format. Much faster to write than PNG, but fewer programs can open it.\n"
+                      "  bmp: Uncompressed Windows bitmap.");
+
+    Pint = secprop->Add_int("screenshot png level",Property::Changeable::WhenIdle,9);
+    Pint->SetMinMax(0,9);
+    Pint->Set_help("zlib compression level of PNG screenshots, from 0 (none, fastest) to 9 (smallest files).");
+
     Pstring = secprop->Add_string("capture chroma format", Property::Changeable::OnlyAtStart,"auto");
     Pstring->Set_values(capturechromaformats);
     Pstring->Set_help("Chroma format to use when capturing to H.264. 'auto' picks the best quality option.\n"
@@ -1789,6 +2208,20 @@ void DOSBOX_SetupConfigSections(void) {
             "4:2:0       Chroma is at quarter resolution, which may cause minor color smearing.\n"
             "            However, this chroma format is most likely to be compatible with video editing software.");
 
+    Pstring = secprop->Add_string("capture video encoder", Property::Changeable::OnlyAtStart,"software");
+    Pstring->Set_values(captureencoders);
+    Pstring->Set_help("H.264 encoder to use when capturing to MPEG transport stream.\n"
+            "software      FFmpeg's software encoder (normally x264), which takes CPU time away from emulation.\n"
+            "auto          Try the hardware encoders usual on this platform, then the software encoder.\n"
+            "nvenc         NVIDIA NVENC.\n"
+            "vaapi         VA-API (Intel and AMD on Linux).\n"
+            "qsv           Intel Quick Sync Video.\n"
+            "videotoolbox  Apple VideoToolbox.\n"
+            "amf           AMD AMF.\n"
+            "A hardware encoder that is missing or fails to open falls back to the software encoder. Where the encoder takes\n"
+            "RGB frames (NVENC, AMF, VideoToolbox for 32-bit and 8-bit modes) the conversion to YUV is left to the GPU and the\n"
+            "capture chroma format does not apply.");
+
     Pstring = secprop->Add_string("capture format", Property::Changeable::OnlyAtStart,"default");
     Pstring->Set_values(captureformats);
     Pstring->Set_help("Capture format to use when capturing video. The availability of the format depends on how DOSBox-X was compiled.\n"
@@ -1914,6 +2347,20 @@ void DOSBOX_SetupConfigSections(void) {
                     "This is a more precise version of the irqdelay= setting.\n"
                     "There are some old DOS games and demos that have race conditions with IRQs that need a nonzero value here to work properly.");
 
+    Pbool = secprop->Add_bool("coalesce masked timer irq", Property::Changeable::WhenIdle,true);
+    Pbool->Set_help("If set, the PIT stops scheduling timer (IRQ 0) events while IRQ 0 is masked at the PIC and resumes\n"
+                    "in phase when it is unmasked. Counter reads are unaffected. Clear this if a program misbehaves with it.");
+
+    Pint = secprop->Add_int("worker threads", Property::Changeable::OnlyAtStart,-1);
+    Pint->SetMinMax(-1,64);
+    Pint->Set_help("Number of threads in the worker pool shared by xBRZ, the post-scaler and the threaded scaler.\n"
+                    "-1 (default) uses one thread less than the number of host CPUs, 0 runs all of that work on the calling thread.\n"
+                    "Lower this when several instances share a host.");
+
+    Pstring = secprop->Add_string("worker thread affinity", Property::Changeable::OnlyAtStart,"");
+    Pstring->Set_help("Host CPUs to pin the worker threads to, as a list such as \"2,3\" or \"4-7\". Worker n runs on the n-th CPU of the\n"
+                    "list, wrapping around. Empty (default) leaves placement to the host. Supported on Windows and Linux.");
+
     Pint = secprop->Add_int("iodelay", Property::Changeable::WhenIdle,-1);
     Pint->SetMinMax(-1,100000);
     Pint->Set_help( "I/O delay in nanoseconds for I/O port access. Set to -1 to use default, 0 to disable.\n"
@@ -1971,6 +2418,20 @@ void DOSBOX_SetupConfigSections(void) {
                       "and it does not require any special maintenance or formatting.");
     Pstring->SetBasic(true);
 
+    const char* memallocopts[] = { "eager", "lazy", "hugepages", "mergeable", 0 };
+    Pstring = secprop->Add_string("memory allocation",Property::Changeable::OnlyAtStart,"lazy");
+    Pstring->Set_values(memallocopts);
+    Pstring->Set_help("How guest memory is allocated from the host when no memory file is set.\n"
+                      "  eager:      Allocate and clear all of memsize at startup.\n"
+                      "  lazy:       Reserve memsize and let the host commit pages the first time the guest touches them.\n"
+                      "              Large memsize values cost little host RAM unless the guest actually uses the memory.\n"
+                      "  hugepages:  As lazy, but back guest memory with transparent huge pages (Linux) or large pages\n"
+                      "              (Windows, needs the \"Lock pages in memory\" privilege and commits all memory at startup)\n"
+                      "              to reduce host TLB misses. Falls back to lazy if the host refuses.\n"
+                      "  mergeable:  As lazy, but let the host merge guest and video memory pages that are identical across\n"
+                      "              DOSBox-X instances, e.g. many instances booting the same OS image (Linux, needs KSM enabled\n"
+                      "              in /sys/kernel/mm/ksm/run). The debugger HOSTMEM command and QMP show how much was merged.");
+
 #if defined(C_EMSCRIPTEN)
     Pint = secprop->Add_int("memsize", Property::Changeable::OnlyAtStart,4);
 #else
@@ -2050,6 +2511,12 @@ void DOSBOX_SetupConfigSections(void) {
     Pbool->Set_help("If set, MOUNT commands will mount with -nocachedir (disable directory caching) by default.");
     Pbool->SetBasic(true);
 
+    Pbool = secprop->Add_bool("watchhostdir",Property::Changeable::WhenIdle,true);
+    Pbool->Set_help("If set, the directory cache of local drives follows file and directory changes made on the host\n"
+                    "(through inotify, kqueue or ReadDirectoryChangesW), so RESCAN is no longer needed after them.\n"
+                    "Only the directories that changed are read again.");
+    Pbool->SetBasic(false);
+
     Pstring = secprop->Add_string("freesizecap",Property::Changeable::WhenIdle,"cap");
     Pstring->Set_values(freesizeopt);
     Pstring->Set_help("If set to \"cap\" (=\"true\"), the value of MOUNT -freesize will apply only if the actual free size is greater than the specified value.\n"
@@ -2075,6 +2542,28 @@ void DOSBOX_SetupConfigSections(void) {
     Pbool->Set_help("If set, BOOT and IMGMOUNT commands will try to lock the mounted disk image files. As a result, you cannot\n"
                     "mount the same disk image files in read/write mode at the same time as this can cause possible disk corruptions.");
 
+    Pint = secprop->Add_int("disk image cache size",Property::Changeable::WhenIdle,2048);
+    Pint->SetMinMax(0,262144);
+    Pint->Set_help("Size in KB of the sector cache kept for each mounted raw disk image. Sectors are read in 8KB blocks, and\n"
+                   "writes are held in the cache until evicted, the guest resets the disk (INT 21h AH=0Dh) or the image is unmounted.\n"
+                   "Set to 0 to read and write the image file directly.");
+
+    Pbool = secprop->Add_bool("disk image mmap",Property::Changeable::WhenIdle,true);
+    Pbool->Set_help("If set, raw disk images (including fixed VHDs) are memory-mapped and sectors are read and written directly\n"
+                    "from the mapping, instead of through the disk image cache. Images too large for the address space of a\n"
+                    "32-bit build, and files that cannot be mapped, fall back to regular file access.");
+
+    Pint = secprop->Add_int("chd cache size",Property::Changeable::WhenIdle,4096);
+    Pint->SetMinMax(0,262144);
+    Pint->Set_help("Size in KB of the cache of decompressed hunks kept for each mounted CHD image (CD-ROM or hard disk).\n"
+                   "A larger cache helps programs that seek back and forth, such as FMV playback or data mixed with CD audio.\n"
+                   "Takes effect for images mounted afterwards.");
+
+    Pint = secprop->Add_int("chd prefetch hunks",Property::Changeable::WhenIdle,4);
+    Pint->SetMinMax(0,64);
+    Pint->Set_help("Number of CHD hunks following the one just read that are decompressed ahead of time on the worker threads\n"
+                   "(see 'worker threads'). Set to 0 to decompress hunks only when they are read.");
+
     Pbool = secprop->Add_bool("unmask keyboard on int 16 read",Property::Changeable::OnlyAtStart,true);
     Pbool->Set_help("If set, INT 16h will unmask IRQ 1 (keyboard) when asked to read keyboard input.\n"
                     "It is strongly recommended that you set this option if running Windows 3.11 Windows for Workgroups in DOSBox-X.");
@@ -2273,6 +2762,12 @@ void DOSBOX_SetupConfigSections(void) {
             "advinterp2x, advinterp3x, advmame2x, advmame3x, rgb2x, rgb3x, scan2x, scan3x, tv2x, tv3x, sharp.");
     Pstring->SetBasic(true);
 
+    Pint = secprop->Add_int("glpbo",Property::Changeable::Always,3);
+    Pint->SetMinMax(0,3);
+    Pint->Set_help("Number of persistently mapped pixel buffers the OpenGL output cycles through to upload the changed lines\n"
+            "of each frame without waiting for the GPU (2 or 3). 0 uploads straight from memory, which can stall.\n"
+            "Needs OpenGL 4.4 or the ARB_buffer_storage extension, and is not used otherwise.");
+
     Pmulti = secprop->Add_multi("pixelshader",Property::Changeable::Always," ");
     Pmulti->SetValue("none",/*init*/true);
     Pmulti->Set_help("Set Direct3D pixel shader program (effect file must be in Shaders subdirectory). If 'forced' is appended, "
@@ -2302,6 +2797,17 @@ void DOSBOX_SetupConfigSections(void) {
            "  Intended for output=direct3d, fullresolution=original, aspect=true");
     Pbool->SetBasic(true);
 
+    Pbool = secprop->Add_bool("threaded scaler",Property::Changeable::OnlyAtStart,false);
+    Pbool->Set_help("If set, the simple scalers (normal, tv, rgb, scan, gray) run on bands of scanlines in the worker pool\n"
+            "(\"worker threads\" in [dosbox]) while the emulation goes on. Otherwise the scaler runs on the emulation thread.\n"
+            "Complex scalers such as hq2x and super2xsai always run on the emulation thread.");
+
+    Pbool = secprop->Add_bool("indexed color",Property::Changeable::Always,true);
+    Pbool->Set_help("If set, 256-color VGA modes are passed to the output as palette indices. The OpenGL output then applies\n"
+            "the palette in a shader, other outputs expand it in the scaler. Frames that change the palette mid-screen\n"
+            "(raster bars), hretrace effects and the video debug overlay fall back to expanding the palette on the CPU.\n"
+            "Not used with GLSL shaders or the xBRZ scaler.");
+
     Pmulti = secprop->Add_multi("monochrome_pal",Property::Changeable::Always," ");
     Pmulti->SetValue("green",/*init*/true);
     Pmulti->Set_help("Specify the color of monochrome display.\n"
@@ -2777,6 +3283,13 @@ void DOSBOX_SetupConfigSections(void) {
                     "If clear, Window B is presented as not available and attempts to use it will fail. Only Window A\n"
                     "will be available, which is also DOSBox SVN behavior.");
 
+    Pbool = secprop->Add_bool("vesa prefer lfb",Property::Changeable::Always,false);
+    Pbool->Set_help("If set, VESA BIOS modes that offer a linear framebuffer also report that the windowed (bank\n"
+                    "switched) memory model is not available (ModeAttributes bit 6). VBE 2.0 aware programs that\n"
+                    "honor this bit will map the linear framebuffer directly instead of bank switching through\n"
+                    "A0000h, which is considerably faster. The bank switching window still works for programs\n"
+                    "that ignore the bit. Has no effect with machine=vesa_nolfb or vesa_oldvbe.");
+
     Pbool = secprop->Add_bool("vesa bank switching window range check",Property::Changeable::Always,true);
     Pbool->Set_help("Controls whether calls to bank switch (set the window number) through the VESA BIOS apply\n"
                     "range checking. If set, out of range window numbers will return with an error code. This\n"
@@ -2974,29 +3487,40 @@ void DOSBOX_SetupConfigSections(void) {
     Pbool->SetBasic(true);
 
     Pstring = secprop->Add_string("scanline render on demand",Property::Changeable::Always,"auto");
-    Pstring->Set_values(truefalseautoopt);
+    Pstring->Set_values(renderondemandopt);
     Pstring->Set_help("Render video output at vsync or when something is changed mid frame, instead of stopping to render every scanline.\n"
 		    "May provide a performance benefit to most DOS games. However this may also break timing-dependent game or Demoscene effects.\n"
-		    "Default auto, which will turn if off for VGA modes and turn it on for SVGA modes.");
+		    "Default auto, which will turn if off for VGA modes and turn it on for SVGA modes.\n"
+		    "adaptive decides every frame: if the previous frame changed no raster-relevant register (palette, line compare, offset, panning...)\n"
+		    "during active display the frame is rendered at vsync, else it is rendered scanline by scanline.");
     Pstring->SetBasic(true);
 
     secprop=control->AddSection_prop("vsync",&Null_Init,true);//done
 
     Pstring = secprop->Add_string("vsyncmode",Property::Changeable::WhenIdle,"off");
     Pstring->Set_values(vsyncmode);
-    Pstring->Set_help("Synchronize vsync timing to the host display. Requires calibration within DOSBox-X.");
+    Pstring->Set_help("Synchronize vsync timing to the host display. Requires calibration within DOSBox-X.\n"
+            "adaptive measures the host refresh rate and present latency. If the guest refresh rate is close to\n"
+            "the host (see adaptive vsync range) the emulated retrace is locked to the host, else the guest runs\n"
+            "at its own rate, which suits variable refresh rate (VRR) displays.");
     Pstring->SetBasic(true);
     Pstring = secprop->Add_string("vsyncrate",Property::Changeable::WhenIdle,"75");
     Pstring->Set_values(vsyncrate);
-    Pstring->Set_help("Vsync rate used if vsync is enabled. Ignored if vsyncmode is set to host (win32).");
+    Pstring->Set_help("Vsync rate used if vsync is enabled. Ignored if vsyncmode is set to host (win32),\n"
+            "or to adaptive where the host refresh rate can be queried.");
     Pstring->SetBasic(true);
+    Pint = secprop->Add_int("adaptive vsync range",Property::Changeable::WhenIdle,5);
+    Pint->SetMinMax(1,10);
+    Pint->Set_help("With vsyncmode=adaptive, how far in percent the emulated refresh rate may be sped up or slowed down\n"
+            "to lock to the host display. Guest refresh rates further from the host are not locked.");
 
     secprop=control->AddSection_prop("cpu",&Null_Init,true);//done
     Pstring = secprop->Add_string("core",Property::Changeable::WhenIdle,"auto");
     Pstring->Set_values(cores);
     Pstring->Set_help("CPU Core used in emulation. auto will switch to dynamic if available and appropriate.\n"
             "For the dynamic core, both dynamic_x86 and dynamic_rec are supported (dynamic_x86 is preferred).\n"
-            "Windows 95 or other preemptive multitasking OSes will not work with the dynamic_rec core.");
+            "Windows 95 or other preemptive multitasking OSes will not work with the dynamic_rec core.\n"
+            "kvm runs the guest with Linux KVM hardware virtualization where /dev/kvm is available. It is not cycle accurate.");
     Pstring->SetBasic(true);
 
     /* I would like "auto" as the default so FPU emulation is enabled for 486 or higher, disabled for 386 and lower.
@@ -3026,6 +3550,12 @@ void DOSBOX_SetupConfigSections(void) {
     Pbool->Set_help("Enforce checks for segment limits on 80286 and higher CPU types.");
     Pbool->SetBasic(true);
 
+    Pbool = secprop->Add_bool("descriptor cache",Property::Changeable::OnlyAtStart,false);
+    Pbool->Set_help("Keep the segment descriptors read from the GDT and LDT in protected mode, so that segment loads\n"
+                    "need not read the tables again. Writes to the tables through their own linear address invalidate\n"
+                    "them, but writes through another linear mapping of the same memory or by DMA are NOT seen and\n"
+                    "leave stale descriptors in use. Only enable this for software known not to do that.");
+
     Pbool = secprop->Add_bool("lds wraparound",Property::Changeable::Always,true);
     Pbool->Set_help("For LDS/LES instructions, in 16-bit code, check for 64KB wraparound case.");
     Pbool->SetBasic(true);
@@ -3106,6 +3636,24 @@ void DOSBOX_SetupConfigSections(void) {
             "According to forum discussions, setting this to 1 can aid debugging, however doing so also causes\n"
             "problems with 32-bit protected mode DOS games and reduces the performance of the dynamic core.\n");
 
+    Pbool = secprop->Add_bool("dynamic core side exits",Property::Changeable::Always,true);
+    Pbool->Set_help("If set, the dynamic_rec core keeps translating past forward conditional jumps and leaves\n"
+            "the block through a side exit when the jump is taken, which results in longer blocks.\n"
+            "Changes only affect code translated afterwards.");
+
+    Pint = secprop->Add_int("dynamic core translate threshold",Property::Changeable::Always,2);
+    Pint->SetMinMax(0,255);
+    Pint->Set_help("Number of times the dynamic_rec core lets the normal core run code at a given address before\n"
+            "translating it. Code that only runs once or twice (setup, loaders) then never pays the translation cost.\n"
+            "Set to 0 to translate code the first time it is reached.");
+
+    Pbool = secprop->Add_bool("dynamic core fast fpu",Property::Changeable::Always,false);
+    Pbool->Set_help("If set, the dynamic_rec core translates the common x87 arithmetic instructions into single calls\n"
+            "that work on the register stack directly, as long as all FPU exceptions are masked and precision control\n"
+            "is set to extended precision. The denormal status flag is not updated on this path.\n"
+            "Only has an effect on hosts that emulate the FPU with host doubles (e.g. ARM).\n"
+            "Changes only affect code translated afterwards.");
+
     Pstring = secprop->Add_string("cputype",Property::Changeable::Always,"auto");
     Pstring->Set_values(cputype_values);
     Pstring->Set_help("CPU Type used in emulation. \"auto\" emulates a 486 which tolerates Pentium instructions.\n"
@@ -3132,6 +3680,28 @@ void DOSBOX_SetupConfigSections(void) {
 
     Pmulti_remain->GetSection()->Add_string("parameters",Property::Changeable::Always,"");
 
+    Pstring = secprop->Add_string("cycle governor",Property::Changeable::Always,"off");
+    Pstring->Set_values(cyclegovernors);
+    Pstring->Set_help("How 'auto' and 'max' cycles are adjusted while running.\n"
+            "  'off'      guesses the cycles from the time DOSBox-X sleeps between emulated milliseconds.\n"
+            "  'share'    measures the host time spent emulating, rendering and mixing audio and keeps the total\n"
+            "             at 'cycle governor target' percent of real time, averaged over a quarter second.\n"
+            "  'deadline' like 'share', but the slowest video frame of each quarter second has to be done within\n"
+            "             'cycle governor target' percent of the frame period.\n"
+            "The governor does not depend on the host sleep granularity, so the cycles stay steady under host load.");
+
+    Pint = secprop->Add_int("cycle governor target",Property::Changeable::Always,80);
+    Pint->SetMinMax(10,100);
+    Pint->Set_help("Percentage of real time (share) or of the video frame period (deadline) the cycle governor may use.\n"
+            "The percentage given with 'cycles=max' or 'cycles=auto' and the cycle up/down keys scale this further.");
+
+    Pbool = secprop->Add_bool("idle detection",Property::Changeable::Always,false);
+    Pbool->Set_help("If set, DOSBox-X watches for the guest spinning on an idle poll: INT 16h keyboard checks and waits\n"
+            "without a key, keyboard controller status reads with nothing to read, and INT 1Ah timer reads with the\n"
+            "tick count unchanged. Once the polls come in quick succession, emulated time skips ahead to the next\n"
+            "timer or device event the way HLT does, so an idle DOS prompt no longer keeps a host core busy.\n"
+            "Programs that calibrate delay loops by counting such polls may measure a slower CPU.");
+
     Pint = secprop->Add_int("cycleup",Property::Changeable::Always,10);
     Pint->SetMinMax(1,1000000);
     Pint->Set_help("Amount of cycles to decrease/increase with the mapped keyboard shortcut.");
@@ -3156,6 +3726,17 @@ void DOSBOX_SetupConfigSections(void) {
     Pint = secprop->Add_int("stop turbo after second",Property::Changeable::Always,0);
     Pint->Set_help("If a positive integer is specified, the Turbo function will last for specific seconds.");
 
+    Pbool = secprop->Add_bool("turbo while loading",Property::Changeable::Always,false);
+    Pbool->Set_help("If set, Turbo mode is turned on by itself while the guest keeps reading from disk or CD-ROM (through DOS, INT 13h, IDE or MSCDEX)\n"
+                    "with no keyboard or mouse input and no sound DMA running, and turned off again once the reads stop or input arrives.\n"
+                    "Only every few frames are drawn while it is on. Turbo turned on by hand is not affected.");
+
+    Pstring = secprop->Add_string("dynamic core cache file",Property::Changeable::OnlyAtStart,"");
+    Pstring->Set_help("If set, the dynamic_rec core records the entry points of the code it translated in this file when DOSBox-X exits.\n"
+                    "On the next run, code pages whose contents and CPU mode match the recorded ones are translated in one go\n"
+                    "when they are first executed, instead of block by block. This is only done while 386 paging is off.\n"
+                    "Useful for guests that are booted over and over again from the same disk image.");
+
     Pstring = secprop->Add_string("use dynamic core with paging on",Property::Changeable::Always,"auto");
     Pstring->Set_values(truefalseautoopt);
     Pstring->Set_help("Allow dynamic cores (dynamic_x86 and dynamic_rec) to be used with 386 paging enabled.\n"
@@ -3428,6 +4009,17 @@ void DOSBOX_SetupConfigSections(void) {
     Pbool->Set_help("Swaps the left and right stereo channels.");
     Pbool->SetBasic(true);
 
+    Pstring = secprop->Add_string("resampler",Property::Changeable::OnlyAtStart,"linear");
+    Pstring->Set_values(mixerresamplers);
+    Pstring->Set_help("How devices running at a rate other than the mixer rate are converted to it.\n"
+            "  linear: Linear interpolation, as DOSBox-X has always done. Cheapest, but aliases.\n"
+            "  fast:   Short windowed sinc filter, for slower hosts.\n"
+            "  medium: Windowed sinc filter, a good balance of quality and CPU use.\n"
+            "  high:   Long windowed sinc filter with interpolated phases.\n"
+            "The sinc filters delay each device by a few of its samples. Devices that emulate slew limiting\n"
+            "always use linear interpolation.");
+    Pstring->SetBasic(true);
+
     Pint = secprop->Add_int("rate",Property::Changeable::OnlyAtStart,48000);
     Pint->SetMinMax(8000,192000);
     Pint->Set_help("Mixer sample rate, setting any device's rate higher than this will probably lower their sound quality.");
@@ -3443,6 +4035,13 @@ void DOSBOX_SetupConfigSections(void) {
     Pint->Set_help("How many milliseconds of data to keep on top of the blocksize.");
     Pint->SetBasic(true);
 
+    Pbool = secprop->Add_bool("adaptive buffering",Property::Changeable::OnlyAtStart,false);
+    Pbool->Set_help("Tune the prebuffer and block size while running, starting from the values above. Underruns make\n"
+            "them grow, a long stretch without any shrinks them again as far as the host's timing allows. The fill\n"
+            "level is held steady by adjusting the playback rate by a fraction of a percent instead of dropping audio.\n"
+            "The block size can only change with SDL2.");
+    Pbool->SetBasic(true);
+
     secprop=control->AddSection_prop("midi",&Null_Init,true);//done
 
     Pbool = secprop->Add_bool("roland gs sysex",Property::Changeable::OnlyAtStart,true);
@@ -3451,6 +4050,20 @@ void DOSBOX_SetupConfigSections(void) {
                     "messages to reset the synth rather than using standard MIDI commands.");
     Pbool->SetBasic(false);
 
+    Pbool = secprop->Add_bool("batch output",Property::Changeable::WhenIdle,false);
+    Pbool->Set_help("Queue outgoing MIDI messages with their emulated time and deliver them to the MIDI device once per mixer tick\n"
+                    "instead of one at a time. The alsa and coremidi devices schedule each message at its original offset\n"
+                    "within the batch, which cuts down system calls and jitter for dense SysEx and controller streams.\n"
+                    "This adds up to one millisecond of latency.");
+    Pbool->SetBasic(false);
+
+    Pbool = secprop->Add_bool("open synth on demand",Property::Changeable::WhenIdle,true);
+    Pbool->Set_help("Load the ROMs or the sound font of the mt32, synth and fluidsynth devices when the guest first sends MIDI\n"
+                    "data instead of at startup. This makes the startup faster, but the first notes may be late while they load.\n"
+                    "Errors in the device settings are only reported then.\n"
+                    "When disabled, sound fonts are still loaded in the background, so only MIDI output waits for them.");
+    Pbool->SetBasic(false);
+
     Pstring = secprop->Add_string("mpu401",Property::Changeable::WhenIdle,"intelligent");
     Pstring->Set_values(mputypes);
     Pstring->Set_help("Type of MPU-401 to emulate.");
@@ -3645,6 +4258,20 @@ void DOSBOX_SetupConfigSections(void) {
 	Pstring = secprop->Add_string("fluid.cores",Property::Changeable::WhenIdle,"default");
 	Pstring->Set_help("Fluidsynth CPU cores to use, or default.");
 
+	Pbool = secprop->Add_bool("fluid.thread",Property::Changeable::WhenIdle,false);
+	Pbool->Set_help("Render the built-in synth (mididevice=synth) ahead of time in a separate thread instead of in the mixer callback.");
+
+	Pint = secprop->Add_int("fluid.prebuffer",Property::Changeable::WhenIdle,40);
+	Pint->SetMinMax(8,200);
+	Pint->Set_help("How many milliseconds of built-in synth audio to render ahead. (min 8, max 200)\n"
+		"Valid for rendering in separate thread only.");
+
+	Pint = secprop->Add_int("fluid.budget",Property::Changeable::WhenIdle,0);
+	Pint->SetMinMax(0,100);
+	Pint->Set_help("Percentage of real time the built-in synth render thread may spend rendering. (0 to disable)\n"
+		"When exceeded, interpolation is lowered to linear and then polyphony is reduced until it fits again.\n"
+		"Valid for rendering in separate thread only.");
+
 	Pstring = secprop->Add_string("fluid.periods",Property::Changeable::WhenIdle,"default");
 	Pstring->Set_help("Fluidsynth periods, or default.");
 
@@ -3725,6 +4352,11 @@ void DOSBOX_SetupConfigSections(void) {
 					"the DMA transfer per block poorly in a way that causes popping and artifacts. Setting this option to 0 for\n"
 					"such DOS applications may reduce audible popping and artifacts.");
 
+			Pbool = secprop->Add_bool("block dma",Property::Changeable::OnlyAtStart,false);
+			Pbool->Set_help("Transfer DMA audio only in blocks on mixer ticks instead of also whenever the guest reads the DMA counter.\n"
+					"The IRQ at the end of each DSP block is still raised at the exact emulated time the block ends, from its own event.\n"
+					"This cuts the overhead of high rate 16-bit stereo playback, but the DMA counter only moves once per mixer tick.");
+
 			Pbool = secprop->Add_bool("listen to recording source",Property::Changeable::WhenIdle,false);
 			Pbool->Set_help("When the guest records audio from the Sound Blaster card, send the input source to the speakers as well so it can be heard.");
 			Pbool->SetBasic(true);
@@ -3841,8 +4473,8 @@ void DOSBOX_SetupConfigSections(void) {
 
 			Pstring = secprop->Add_string("oplemu",Property::Changeable::WhenIdle,"default");
 			Pstring->Set_values(oplemus);
-			Pstring->Set_help("Provider for the OPL emulation. 'compat' might provide better quality.\n"
-					"'nuked' is the most accurate (but the most CPU-intensive). See oplrate as well.");
+			Pstring->Set_help("Provider for the OPL emulation. 'default' is 'nuked', the most accurate one.\n"
+					"'fast' is lighter on the CPU, 'compat' might provide better quality. See oplrate as well.");
 			Pstring->SetBasic(true);
 
 			Pint = secprop->Add_int("oplrate",Property::Changeable::WhenIdle,48000);
@@ -3850,6 +4482,11 @@ void DOSBOX_SetupConfigSections(void) {
 			Pint->Set_help("Sample rate of OPL music emulation. Use 49716 for highest quality (set the mixer rate accordingly).");
 			Pint->SetBasic(true);
 
+			Pbool = secprop->Add_bool("oplthread",Property::Changeable::WhenIdle,false);
+			Pbool->Set_help("Render OPL music on the worker threads (see 'worker threads' in [dosbox]) instead of the emulation thread.\n"
+					"Register writes are queued with the time they happen at, so the music sounds the same, only 4ms later.\n"
+					"Has no effect with the OPL hardware passthrough options of oplemu.");
+
 			Pstring = secprop->Add_string("oplport", Property::Changeable::WhenIdle, "");
 			Pstring->Set_help("Serial port of the OPL2 Audio Board when oplemu=opl2board, opl2mode will become 'opl2' automatically.");
 			Pstring->SetBasic(true);
@@ -4093,7 +4730,10 @@ void DOSBOX_SetupConfigSections(void) {
     Phex->SetBasic(true);
     Pint = secprop->Add_int("quality",Property::Changeable::WhenIdle,0);
     Pint->Set_values(qualityno);
-    Pint->Set_help("Set SID emulation quality level (0 to 3).");
+    Pint->Set_help("Set SID emulation quality level (0 to 4).\n"
+                   "  0, 1: fast and interpolated sampling, cheapest but aliased.\n"
+                   "  2, 3: reSID's resampler, best quality and by far the most expensive.\n"
+                   "  4:    fast sampling at four times the rate, then decimated with a short filter. Close to 2 at a fraction of the cost.");
     Pint->SetBasic(true);
 
     secprop = control->AddSection_prop("imfc", &Null_Init, Property::Changeable::WhenIdle);
@@ -4140,6 +4780,14 @@ void DOSBOX_SetupConfigSections(void) {
     Pint->Set_help("Sample rate of the PC-Speaker sound generation.");
     Pint->SetBasic(true);
 
+    const char* pcsynthesis[] = { "integrate", "blep", nullptr };
+    Pstring = secprop->Add_string("pcspeaker synthesis",Property::Changeable::WhenIdle,"integrate");
+    Pstring->Set_values(pcsynthesis);
+    Pstring->Set_help("How PC speaker output transitions are turned into samples.\n"
+                      "  integrate: Average the output level over each sample period.\n"
+                      "  blep: Add a band-limited step per transition. Aliases less and costs less with\n"
+                      "        high-rate PWM (\"RealSound\") digitized speech.");
+
     Pstring = secprop->Add_string("tandy",Property::Changeable::WhenIdle,"auto");
     Pstring->Set_values(tandys);
     Pstring->Set_help("Enable Tandy Sound System emulation. For 'auto', emulation is present only if machine is set to 'tandy'.");
@@ -4180,6 +4828,11 @@ void DOSBOX_SetupConfigSections(void) {
     Pbool->Set_help("enable timed intervals for axis. Experiment with this option, if your joystick drifts (away).");
     Pbool->SetBasic(true);
 
+    Pbool = secprop->Add_bool("fastpoll",Property::Changeable::WhenIdle,false);
+    Pbool->Set_help("With timed intervals, recognize the tight IN/TEST/LOOP loops games use to read the axes and skip\n"
+            "ahead to just before an axis times out, advancing the loop counter by the passes skipped. The count\n"
+            "the game reads stays the same, but the CPU time spent on joystick reads drops.");
+
     Pbool = secprop->Add_bool("autofire",Property::Changeable::WhenIdle,false);
     Pbool->Set_help("continuously fires as long as you keep the button pressed.");
     Pbool->SetBasic(true);
@@ -4295,6 +4948,8 @@ void DOSBOX_SetupConfigSections(void) {
         "for nullmodem: server, rxdelay, txdelay, telnet, usedtr,\n"
         "               transparent, port, inhsocket, sock, nonlocal (all optional).\n"
         "               connections are limited to localhost unless you specify nonlocal:1\n"
+        "               txdelay is the longest time (ms) sent data is gathered, txidle:<n> sends it\n"
+        "               earlier once the port was idle for n characters at its baud rate (default 2, 0 disables).\n"
         "               \"sock\" parameter specifies the protocol to be used by both sides\n"
         "               of the connection. 0 for TCP and 1 for ENet reliable UDP.\n"
         "Example: serial1=modem listenport:5000 sock:1\n"
@@ -4482,13 +5137,14 @@ void DOSBOX_SetupConfigSections(void) {
         "  png     : Creates PNG images (default)\n"
 #endif
         "  ps      : Creates PostScript\n"
+        "  pdf     : Creates PDF, with the text as text in the standard PDF fonts\n"
         "  bmp     : Creates BMP images (very huge files, not recommended)\n"
         "  printer : Send to an actual printer in Windows (specify a printer, or Print dialog will appear)"
     );
     Pstring->SetBasic(true);
 
     Pbool = secprop->Add_bool("multipage", Property::Changeable::WhenIdle, false);
-    Pbool->Set_help("Adds all pages to one PostScript file or printer job until CTRL-F2 is pressed.");
+    Pbool->Set_help("Adds all pages to one PostScript or PDF file or printer job until CTRL-F2 is pressed.");
     Pbool->SetBasic(true);
 
     Pstring = secprop->Add_string("device", Property::Changeable::WhenIdle, "-");
@@ -4666,6 +5322,13 @@ void DOSBOX_SetupConfigSections(void) {
             "For networked database applications (e.g. dBase, FoxPro, etc), it is strongly recommended to set this to e.g. 3 for correct operations.");
     Pint->SetBasic(true);
 
+    Pint = secprop->Add_int("file buffer size",Property::Changeable::WhenIdle,16);
+    Pint->SetMinMax(0,1024);
+    Pint->Set_help("Size in KB of the read-ahead/write-behind buffer kept for each open file on mounted local drives.\n"
+            "Small sequential reads and writes are served from this buffer instead of going to the host file one by one.\n"
+            "The buffer is written back on commit, close and record locking, and is not used while another handle or program may write to the file.\n"
+            "Set to 0 to disable. Not used if \"file access tries\" is set.");
+
     Pbool = secprop->Add_bool("network redirector",Property::Changeable::WhenIdle,true);
     Pbool->Set_help("Report DOS network redirector as resident. This will allow the host name to be returned unless the secure mode is enabled.\n"
             "You can also directly access UNC network paths in the form \\\\MACHINE\\SHARE even if they are not mounted as drives on Windows systems.\n"
@@ -5048,6 +5711,14 @@ void DOSBOX_SetupConfigSections(void) {
                     "Once properly set, load the NE2000 packet driver inside DOSBox-X with base address and interrupt specified below.");
     Pbool->SetBasic(true);
 
+    Pstring = secprop->Add_string("nic type", Property::Changeable::WhenIdle, "ne2000");
+    Pstring->Set_help("The network card emulated when \"ne2000\" is enabled.\n"
+        "  ne2000:  NE2000 compatible ISA card at \"nicbase\" and \"nicirq\".\n"
+        "  rtl8139: Realtek RTL8139 PCI bus mastering card, which needs the PCI bus. Frames are moved\n"
+        "           to and from guest memory by the card, which is much faster than the NE2000 data port.\n"
+        "           \"nicbase\" is ignored and \"nicirq\" is the PCI interrupt line (IRQ 11 if not valid).");
+    Pstring->Set_values(nictypes);
+
     Phex = secprop->Add_hex("nicbase", Property::Changeable::WhenIdle, 0x300);
     Phex->Set_help("The base address of the NE2000 board.");
     Phex->SetBasic(true);
@@ -5071,6 +5742,10 @@ void DOSBOX_SetupConfigSections(void) {
     Pstring->Set_values(backendopts);
     Pstring->SetBasic(true);
 
+    Pbool = secprop->Add_bool("backend thread", Property::Changeable::WhenIdle, true);
+    Pbool->Set_help("If set, the pcap or slirp backend is polled on a network thread of its own instead of\n"
+        "from the emulation loop, so host network activity does not slow down emulation.");
+
     secprop = control->AddSection_prop("ethernet, pcap", &Null_Init, true);
 
     Pstring = secprop->Add_string("realnic", Property::Changeable::WhenIdle,"list");
@@ -5085,6 +5760,11 @@ void DOSBOX_SetupConfigSections(void) {
     Pstring->Set_help("Specifies the read timeout for the device in milliseconds for the pcap backend, or the default value will be used.");
     Pstring->SetBasic(true);
 
+    Pbool = secprop->Add_bool("filter", Property::Changeable::WhenIdle, true);
+    Pbool->Set_help("If set, a capture filter on the host interface drops all frames that are not addressed to the MAC address\n"
+        "of the emulated network card, or broadcast/multicast, before they reach DOSBox-X. This saves a lot of CPU time\n"
+        "on busy networks. Disable it for guest software that puts the card in promiscuous mode to watch all traffic.");
+
     secprop = control->AddSection_prop("ethernet, slirp", &Null_Init, true);
 
     Pbool = secprop->Add_bool("restricted", Property::Changeable::WhenIdle, false);
@@ -5203,6 +5883,21 @@ void DOSBOX_SetupConfigSections(void) {
                 "In this way, you can have DOSBox-X emulate one of the strange quirks of 1995-1997 era\n"
                 "laptop hardware");
 
+        Pbool = secprop->Add_bool("async io",Property::Changeable::OnlyAtStart,false);
+        if (i == 0) Pbool->Set_help(
+                "If set, hard disk reads and writes issued through the IDE controller are carried out on a\n"
+                "separate thread. The drive stays busy until the host finishes, so slow host storage (network\n"
+                "shares, spinning disks) delays the guest's disk access instead of freezing the whole emulator.\n"
+                "Emulated disk timing then depends on host I/O speed.");
+
+        Pbool = secprop->Add_bool("bus master dma",Property::Changeable::OnlyAtStart,false);
+        if (i == 0) Pbool->Set_help(
+                "If set, and the PCI bus is enabled, the primary and secondary IDE controllers are exposed\n"
+                "as a PCI bus master IDE controller (Intel PIIX4) and hard disks report multiword and\n"
+                "Ultra DMA support. Guests with bus master drivers (Windows 9x/NT, Linux) then transfer\n"
+                "whole blocks of sectors per command instead of one word per I/O port access.\n"
+                "Has no effect on the tertiary and higher IDE controllers or in PC-98 mode.");
+
         Pint = secprop->Add_int("cd-rom spinup time",Property::Changeable::WhenIdle,0/*use IDE or CD-ROM default*/);
         if (i == 0) Pint->Set_help("Emulated CD-ROM time in ms to spin up if CD is stationary.\n"
                 "Set to 0 to use controller or CD-ROM drive-specific default.");
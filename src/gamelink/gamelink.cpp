@@ -35,6 +35,8 @@
 #include <errno.h>
 #include <semaphore.h>
 #endif // WIN32
+#include <algorithm>
+#include <atomic>
 
 // SDL Dependencies
 #include "SDL_syswm.h"
@@ -61,10 +63,14 @@ extern uint32_t RunningProgramLoadAddress;
 
 #ifdef MACOSX
 #define GAMELINK_MMAP_NAME		"/DWD_GAMELINK_MMAP_R4"
+#define GAMELINK_RING_NAME		"/DWD_GAMELINK_FRAMES_R1"
 #else // MACOSX
 #define GAMELINK_MMAP_NAME		"DWD_GAMELINK_MMAP_R4"
+#define GAMELINK_RING_NAME		"DWD_GAMELINK_FRAMES_R1"
 #endif // MACOSX
 
+#define RING_VER			1
+
 
 //------------------------------------------------------------------------------
 // Local Data
@@ -74,11 +80,13 @@ extern uint32_t RunningProgramLoadAddress;
 
 static HANDLE g_mutex_handle;
 static HANDLE g_mmap_handle;
+static HANDLE g_ring_handle;
 
 #else // WIN32
 
 static sem_t* g_mutex_handle;
 static int g_mmap_handle; // fd!
+static int g_ring_handle = -1; // fd!
 
 #endif // WIN32
 
@@ -88,6 +96,22 @@ static uint32_t g_membase_size;
 
 static GameLink::sSharedMemoryMap_R4* g_p_shared_memory;
 
+static GameLink::sSharedMMapFrameRing_R1* g_p_ring;
+static uint32_t g_ring_map_size;
+static uint32_t g_ring_frame;
+
+// A frame buffer in shared memory: its size, and the part of it older than the newest frame.
+// Only that part is copied while the size stays the same.
+struct sFrameCopy
+{
+	uint16_t width;
+	uint16_t height;
+	GameLink::sFrameRect stale;
+};
+
+static sFrameCopy g_frame_copy;
+static sFrameCopy g_ring_copy[ GameLink::sSharedMMapFrameRing_R1::MAX_SLOTS ];
+
 #define MEMORY_MAP_CORE_SIZE sizeof( GameLink::sSharedMemoryMap_R4 )
 
 
@@ -136,6 +160,7 @@ static void shared_memory_init()
 	g_p_shared_memory->frame.par_x = 1;
 	g_p_shared_memory->frame.par_y = 1;
 	memset( g_p_shared_memory->frame.buffer, 0, GameLink::sSharedMMapFrame_R1::MAX_PAYLOAD );
+	g_frame_copy = sFrameCopy();
 
 	// audio: 100%
 	g_p_shared_memory->audio.master_vol_l = 100;
@@ -360,6 +385,207 @@ static void destroy_shared_memory()
 
 }
 
+//
+// create_frame_ring
+//
+// Create the frame ring shared memory with the given number of slots.
+//
+// \returns 1 if we made one, 0 if it failed.
+//
+static int create_frame_ring( const uint32_t slots )
+{
+	const uint32_t slot_size = sizeof( GameLink::sSharedMMapFrameSlot_R1 );
+	g_ring_map_size = sizeof( GameLink::sSharedMMapFrameRing_R1 ) + slots * slot_size;
+	g_p_ring = NULL;
+
+#ifdef WIN32
+
+	g_ring_handle = CreateFileMappingA( INVALID_HANDLE_VALUE, NULL,
+			PAGE_READWRITE, 0, g_ring_map_size, GAMELINK_RING_NAME );
+
+	if ( g_ring_handle )
+	{
+		g_p_ring = reinterpret_cast< GameLink::sSharedMMapFrameRing_R1* >(
+			MapViewOfFile( g_ring_handle, FILE_MAP_ALL_ACCESS, 0, 0, g_ring_map_size )
+			);
+
+		if ( g_p_ring == NULL )
+		{
+			CloseHandle( g_ring_handle );
+			g_ring_handle = NULL;
+		}
+	}
+
+#else // WIN32
+
+	g_ring_handle = shm_open( GAMELINK_RING_NAME, O_CREAT
+#ifndef MACOSX
+								| O_TRUNC
+#endif // !MACOSX
+								| O_RDWR, 0666 );
+
+	if ( g_ring_handle < 0 )
+	{
+		LOG_MSG( "GAMELINK: shm_open( \"" GAMELINK_RING_NAME "\" ) failed. errno = %d", errno );
+	}
+	else if ( ftruncate( g_ring_handle, g_ring_map_size ) < 0 ||
+		( g_p_ring = reinterpret_cast< GameLink::sSharedMMapFrameRing_R1* >(
+			mmap( nullptr, g_ring_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, g_ring_handle, 0 ) ) ) == MAP_FAILED )
+	{
+		LOG_MSG( "GAMELINK: Frame ring setup failed. errno = %d", errno );
+		close( g_ring_handle );
+		g_ring_handle = -1;
+		shm_unlink( GAMELINK_RING_NAME );
+		g_p_ring = NULL;
+	}
+
+#endif // WIN32
+
+	if ( g_p_ring == NULL )
+		return 0;
+
+	// Initialise, slots start out empty
+	memset( g_p_ring, 0, g_ring_map_size );
+	g_p_ring->slot_count = slots;
+	g_p_ring->slot_size = slot_size;
+	g_p_ring->latest = GameLink::sSharedMMapFrameRing_R1::NO_FRAME;
+	for ( uint32_t i = 0; i < GameLink::sSharedMMapFrameRing_R1::MAX_SLOTS; ++i )
+		g_ring_copy[ i ] = sFrameCopy();
+	g_ring_frame = 0;
+
+	std::atomic_thread_fence( std::memory_order_release );
+	g_p_ring->version = RING_VER;
+	return 1;
+}
+
+//
+// destroy_frame_ring
+//
+// Destroy the frame ring shared memory.
+//
+static void destroy_frame_ring()
+{
+	if ( g_p_ring )
+		g_p_ring->version = 0; // tell readers
+
+#ifdef WIN32
+
+	if ( g_p_ring )
+	{
+		UnmapViewOfFile( g_p_ring );
+		g_p_ring = NULL;
+	}
+
+	if ( g_ring_handle )
+	{
+		CloseHandle( g_ring_handle );
+		g_ring_handle = NULL;
+	}
+
+#else // WIN32
+
+	if ( g_p_ring )
+	{
+		munmap( g_p_ring, g_ring_map_size );
+		g_p_ring = NULL;
+	}
+
+	if ( g_ring_handle >= 0 )
+	{
+		close( g_ring_handle );
+		g_ring_handle = -1;
+		shm_unlink( GAMELINK_RING_NAME );
+	}
+
+#endif // WIN32
+}
+
+//
+// add_stale
+//
+// Grow the stale part of a frame copy to include rect.
+//
+static void add_stale( sFrameCopy& copy, const GameLink::sFrameRect& rect )
+{
+	if ( rect.width == 0 || rect.height == 0 )
+		return;
+
+	GameLink::sFrameRect& s = copy.stale;
+	if ( s.width == 0 || s.height == 0 )
+	{
+		s = rect;
+		return;
+	}
+
+	const uint32_t x1 = std::max< uint32_t >( s.x + s.width, rect.x + rect.width );
+	const uint32_t y1 = std::max< uint32_t >( s.y + s.height, rect.y + rect.height );
+	s.x = std::min( s.x, rect.x );
+	s.y = std::min( s.y, rect.y );
+	s.width = static_cast< uint16_t >( x1 - s.x );
+	s.height = static_cast< uint16_t >( y1 - s.y );
+}
+
+//
+// copy_frame
+//
+// Bring a frame copy up to date: all of it if the frame size changed, else the stale part.
+//
+static void copy_frame( uint8_t* p_dest, sFrameCopy& copy,
+						const uint8_t* p_frame, const uint16_t frame_width, const uint16_t frame_height )
+{
+	if ( frame_width != copy.width || frame_height != copy.height )
+	{
+		memcpy( p_dest, p_frame, frame_width * frame_height * 4 );
+		copy.width = frame_width;
+		copy.height = frame_height;
+	}
+	else
+	{
+		const GameLink::sFrameRect& dirty = copy.stale;
+		const uint32_t x1 = std::min< uint32_t >( dirty.x + dirty.width, frame_width );
+		const uint32_t y1 = std::min< uint32_t >( dirty.y + dirty.height, frame_height );
+		for ( uint32_t y = dirty.y; y < y1 && dirty.x < x1; ++y )
+		{
+			const uint32_t offset = ( y * frame_width + dirty.x ) * 4;
+			memcpy( p_dest + offset, p_frame + offset, ( x1 - dirty.x ) * 4 );
+		}
+	}
+
+	copy.stale = GameLink::sFrameRect();
+}
+
+//
+// ring_out
+//
+// Put a frame into the slot after the newest one, without locking.
+//
+static void ring_out( const uint16_t frame_width, const uint16_t frame_height,
+					  const uint16_t par_x, const uint16_t par_y, const uint8_t* p_frame )
+{
+	const uint32_t latest = g_p_ring->latest;
+	const uint32_t index = ( latest >= g_p_ring->slot_count ) ? 0 : ( latest + 1 ) % g_p_ring->slot_count;
+	GameLink::sSharedMMapFrameSlot_R1* p_slot = reinterpret_cast< GameLink::sSharedMMapFrameSlot_R1* >(
+		reinterpret_cast< uint8_t* >( g_p_ring ) + sizeof( GameLink::sSharedMMapFrameRing_R1 ) + index * g_p_ring->slot_size );
+
+	// odd: readers of this slot start over
+	p_slot->seq = p_slot->seq + 1;
+	std::atomic_thread_fence( std::memory_order_release );
+
+	p_slot->frame = ++g_ring_frame;
+	p_slot->image_fmt = 1; // = 32-bit RGBA
+	p_slot->width = frame_width;
+	p_slot->height = frame_height;
+	p_slot->par_x = par_x;
+	p_slot->par_y = par_y;
+	copy_frame( p_slot->buffer, g_ring_copy[ index ], p_frame, frame_width, frame_height );
+
+	// even again: complete, and the newest
+	std::atomic_thread_fence( std::memory_order_release );
+	p_slot->seq = p_slot->seq + 1;
+	std::atomic_thread_fence( std::memory_order_release );
+	g_p_ring->latest = index;
+}
+
 //==============================================================================
 
 //------------------------------------------------------------------------------
@@ -423,6 +649,16 @@ uint8_t* GameLink::AllocRAM( const uint32_t size )
 
 	GameLink::InitTerminal();
 
+	// Frames for readers that do not want to lock, optional
+	if ( !sdl.gamelink.snoop && sdl.gamelink.frame_slots > 0 )
+	{
+		const uint32_t slots = std::min< uint32_t >( (uint32_t)sdl.gamelink.frame_slots, sSharedMMapFrameRing_R1::MAX_SLOTS );
+		if ( create_frame_ring( slots ) )
+			LOG_MSG( "GAMELINK: Frame ring with %u slots.", (unsigned int)slots );
+		else
+			LOG_MSG( "GAMELINK: Frame ring not available, frames only go to the main shared memory." );
+	}
+
 	const int memory_map_size = MEMORY_MAP_CORE_SIZE + g_membase_size;
 	LOG_MSG( "GAMELINK: Initialised. Allocated %d MB of shared memory.", (memory_map_size + (1024*1024) - 1) / (1024*1024) );
 
@@ -455,6 +691,8 @@ void GameLink::Term()
 	if (!sdl.gamelink.snoop && g_p_shared_memory)
 		g_p_shared_memory->version = 0;
 
+	destroy_frame_ring();
+
 	destroy_shared_memory();
 
 	destroy_mutex( GAMELINK_MUTEX_NAME );
@@ -515,6 +753,7 @@ void GameLink::Out( const uint16_t frame_width,
 					const char* p_program,
 					const uint32_t* p_program_hash,
 					const uint8_t* p_frame,
+					const sFrameRect& dirty,
 					const uint8_t* p_sysmem )
 {
 	//LOG_MSG("GAMELINK: Out %i %i %i", frame_width, frame_height, g_trackonly_mode);
@@ -564,19 +803,40 @@ void GameLink::Out( const uint16_t frame_width,
 	sSharedMMapBuffer_R1 proc_mech_buffer;
 	proc_mech_buffer.payload = 0;
 
+	// Frame
+	const bool send_frame = !sdl.gamelink.snoop && !g_trackonly_mode &&
+		frame_width <= sSharedMMapFrame_R1::MAX_WIDTH && frame_height <= sSharedMMapFrame_R1::MAX_HEIGHT;
+	if ( send_frame )
+	{
+		// everything that changed has to reach every copy, also ones skipped this time
+		add_stale( g_frame_copy, dirty );
+		if ( g_p_ring )
+		{
+			for ( uint32_t i = 0; i < g_p_ring->slot_count; ++i )
+				add_stale( g_ring_copy[ i ], dirty );
+
+			ring_out( frame_width, frame_height, par_x, par_y, p_frame );
+		}
+	}
+
+	// With the frame ring, a reader holding the mutex costs it the update of the main
+	// shared memory for this frame instead of holding up emulation.
+	const bool wait_mutex = ( g_p_ring == NULL );
+
 #ifdef WIN32
 
 	DWORD mutex_result;
-	mutex_result = WaitForSingleObject( g_mutex_handle, INFINITE );
+	mutex_result = WaitForSingleObject( g_mutex_handle, wait_mutex ? INFINITE : 0 );
 	if ( mutex_result == WAIT_OBJECT_0 )
 
 #else // WIN32
 
 	int mutex_result;
-	mutex_result = sem_wait( g_mutex_handle );
+	mutex_result = wait_mutex ? sem_wait( g_mutex_handle ) : sem_trywait( g_mutex_handle );
 	if ( mutex_result < 0 )
 	{
-		LOG_MSG( "GAMELINK: MUTEX lock failed with %d. errno = %d", mutex_result, errno );
+		if ( wait_mutex || errno != EAGAIN )
+			LOG_MSG( "GAMELINK: MUTEX lock failed with %d. errno = %d", mutex_result, errno );
 	}
 	else
 
@@ -612,12 +872,8 @@ void GameLink::Out( const uint16_t frame_width,
 				g_p_shared_memory->frame.par_y = par_y;
 
 				// Frame Buffer
-				uint32_t payload;
-				payload = frame_width * frame_height * 4;
-				if ( frame_width <= sSharedMMapFrame_R1::MAX_WIDTH && frame_height <= sSharedMMapFrame_R1::MAX_HEIGHT )
-				{
-					memcpy( g_p_shared_memory->frame.buffer, p_frame, payload );
-				}
+				if ( send_frame )
+					copy_frame( g_p_shared_memory->frame.buffer, g_frame_copy, p_frame, frame_width, frame_height );
 			}
 		} else {
 #ifdef DEBUG_SNOOP
@@ -141,6 +141,57 @@ namespace GameLink
 
 #pragma pack( pop )
 
+	//
+	// sSharedMMapFrameSlot_R1
+	//
+	// One frame of the frame ring, see below.
+	//
+	struct sSharedMMapFrameSlot_R1
+	{
+		volatile uint32_t seq; // odd while the slot is being written
+		uint32_t frame; // counts up by one per frame sent
+
+		uint16_t width;
+		uint16_t height;
+		uint16_t par_x; // pixel aspect ratio
+		uint16_t par_y;
+
+		uint8_t image_fmt; // 0 = no frame; 1 = 32-bit 0xAARRGGBB
+		uint8_t reserved0[ 3 ];
+
+		uint8_t buffer[ sSharedMMapFrame_R1::MAX_PAYLOAD ];
+	};
+
+	//
+	// sSharedMMapFrameRing_R1
+	//
+	// Server -> Client frames in a shared memory of their own ("DWD_GAMELINK_FRAMES_R1"),
+	// written without taking the mutex so that a slow reader never holds up emulation.
+	// This header is followed by slot_count slots, slot_size bytes apart.
+	//
+	// Slots are written seqlock style. To read the newest frame, take the slot at latest,
+	// read its seq, copy the frame and read seq again. If seq was odd or has changed, the
+	// slot was rewritten meanwhile and the reader starts over. The next frame always goes
+	// to the slot after latest, so a reader has slot_count - 1 frames of time to copy one.
+	//
+	struct sSharedMMapFrameRing_R1
+	{
+		enum { MAX_SLOTS = 8 };
+		enum : uint32_t { NO_FRAME = 0xFFFFFFFFu };
+
+		uint32_t version; // = 1, 0 once the server has gone
+		uint32_t slot_count;
+		uint32_t slot_size;
+		volatile uint32_t latest; // newest complete slot, or NO_FRAME
+	};
+
+	// Part of the frame that changed since the last Out(), in pixels
+	struct sFrameRect
+	{
+		uint16_t x, y;
+		uint16_t width, height;
+	};
+
 
 	//--------------------------------------------------------------------------
 	// Global Functions
@@ -163,6 +214,7 @@ namespace GameLink
 					 const char* p_program,
 					 const uint32_t* p_program_hash,
 					 const uint8_t* p_frame,
+					 const sFrameRect& dirty,
 					 const uint8_t* p_sysmem );
 
 	extern void ExecTerminal( sSharedMMapBuffer_R1* p_inbuf,
@@ -397,6 +397,14 @@ static const char *def_menu_video_output[] =
 #endif
 #if C_GAMELINK
     "output_gamelink",
+#endif
+#if C_VULKAN
+    "output_vulkan",
+    "output_vulkannb",
+#endif
+#if C_DIRECT3D11
+    "output_direct3d11",
+    "output_direct3d11nb",
 #endif
     "--",
     "doublescan",
@@ -475,6 +483,7 @@ static const char *def_menu_video_vsync[] =
     "vsync_on",
     "vsync_force",
     "vsync_host",
+    "vsync_adaptive",
     "vsync_off",
     "--",
     "vsync_set_syncrate",
@@ -710,10 +719,12 @@ static const char *def_menu_capture[] =
     "mapper_caprawopl",
     "mapper_caprawmidi",
     "mapper_capnetrf",
+    "mapper_captrace",
     "--",
 #endif
     "mapper_savestate",
     "mapper_loadstate",
+    "mapper_rewind",
     "saveoptionmenu",
     "saveslotmenu",
     "autosavecfg",
@@ -843,6 +854,7 @@ static const char* def_menu_debug[] =
     "wait_on_error",
     "--",
     "video_debug_overlay",
+    "video_frame_pacing_graph",
     "--",
     "debug_logint21",
     "debug_logfileio",
@@ -857,6 +869,7 @@ static const char* def_menu_help_debug[] =
     "wait_on_error",
     "--",
     "video_debug_overlay",
+    "video_frame_pacing_graph",
     NULL
 };
 #endif
@@ -3283,6 +3296,11 @@ void DOSBoxMenu::item::drawMenuItem(DOSBoxMenu &menu) {
     itemHoverDrawn = itemHover;
     itemHilightDrawn = itemHilight;
 
+    if (drawFromCache(menu)) {
+        dos.loaded_codepage = cp;
+        return;
+    }
+
     if (SDL_MUSTLOCK(sdl.surface))
         SDL_LockSurface(sdl.surface);
 
@@ -3307,9 +3325,73 @@ void DOSBoxMenu::item::drawMenuItem(DOSBoxMenu &menu) {
 
     if (SDL_MUSTLOCK(sdl.surface))
         SDL_UnlockSurface(sdl.surface);
+
+    updateDrawCache(menu);
     dos.loaded_codepage = cp;
 }
 
+/* everything besides the text that changes how drawMenuItem() renders the item */
+uint64_t DOSBoxMenu::item::drawState(DOSBoxMenu &menu) const {
+    uint64_t st = 1; /* never 0, which means "no cache" */
+    if (status.enabled) st |= 1u << 1u;
+    if (status.checked) st |= 1u << 2u;
+    if (itemHover)      st |= 1u << 3u;
+    if (itemHilight)    st |= 1u << 4u;
+    if (showdbcs)       st |= 1u << 5u;
+    st |= (uint64_t)(menu.fontCharScale & 0xFFu) << 8u;
+    st |= (uint64_t)((unsigned int)dos.loaded_codepage & 0xFFFFu) << 16u;
+    st |= (uint64_t)(sdl.surface->format->BitsPerPixel) << 32u;
+    return st;
+}
+
+bool DOSBoxMenu::item::drawFromCache(DOSBoxMenu &menu) {
+    const drawcache_t &c = drawCache[(itemHover || itemHilight) ? 1 : 0];
+
+    if (OpenGL_using() || !c.surface || c.state != drawState(menu))
+        return false;
+    if (c.surface->w != screenBox.w || c.surface->h != screenBox.h)
+        return false;
+    if (c.text != text || c.shortcut != shortcut_text)
+        return false;
+
+    SDL_Rect dst = screenBox;
+    return SDL_BlitSurface(c.surface.get(), NULL, sdl.surface, &dst) == 0;
+}
+
+void DOSBoxMenu::item::updateDrawCache(DOSBoxMenu &menu) {
+    drawcache_t &c = drawCache[(itemHover || itemHilight) ? 1 : 0];
+
+    c.state = 0;
+    if (OpenGL_using() || sdl.surface->format->BytesPerPixel < 2)
+        return;
+    /* only cache items that are completely on screen */
+    if (screenBox.w <= 0 || screenBox.h <= 0 || screenBox.x < 0 || screenBox.y < 0 ||
+        (screenBox.x + screenBox.w) > sdl.surface->w || (screenBox.y + screenBox.h) > sdl.surface->h)
+        return;
+
+    const SDL_PixelFormat *fmt = sdl.surface->format;
+    if (!c.surface || c.surface->w != screenBox.w || c.surface->h != screenBox.h ||
+        c.surface->format->BitsPerPixel != fmt->BitsPerPixel ||
+        c.surface->format->Rmask != fmt->Rmask || c.surface->format->Gmask != fmt->Gmask ||
+        c.surface->format->Bmask != fmt->Bmask) {
+        SDL_Surface *s = SDL_CreateRGBSurface(0, screenBox.w, screenBox.h, fmt->BitsPerPixel,
+                                              fmt->Rmask, fmt->Gmask, fmt->Bmask, 0);
+        if (s == NULL) {
+            c.surface.reset();
+            return;
+        }
+        c.surface = std::shared_ptr<SDL_Surface>(s, SDL_FreeSurface);
+    }
+
+    SDL_Rect src = screenBox;
+    if (SDL_BlitSurface(sdl.surface, &src, c.surface.get(), NULL) != 0)
+        return;
+
+    c.text = text;
+    c.shortcut = shortcut_text;
+    c.state = drawState(menu);
+}
+
 void DOSBoxMenu::displaylist::DrawDisplayList(DOSBoxMenu &menu,bool updateScreen) {
     for (auto &id : disp_list) {
         DOSBoxMenu::item &item = menu.get_item(id);
@@ -33,6 +33,7 @@
 #include "inout.h"
 #include "regs.h"
 #include "cpu.h"
+#include "framepacing.h"
 #if C_DEBUG
 #include "debug.h"
 #endif
@@ -2520,6 +2521,24 @@ bool video_debug_callback(DOSBoxMenu * const menu, DOSBoxMenu::item * const menu
     return true;
 }
 
+bool frame_pacing_graph_callback(DOSBoxMenu * const menu, DOSBoxMenu::item * const menuitem) {
+    (void)menu;//UNUSED
+    (void)menuitem;//UNUSED
+    framepace_graph = !framepace_graph;
+    mainMenu.get_item("video_frame_pacing_graph").check(framepace_graph).refresh_item(mainMenu);
+
+    /* the graph is drawn in the debug overlay */
+    if (framepace_graph && !video_debug_overlay) {
+        video_debug_overlay = true;
+        mainMenu.get_item("video_debug_overlay").check(video_debug_overlay).refresh_item(mainMenu);
+    }
+
+    if (!vga.draw.vga_override)
+        RENDER_SetSize(vga.draw.width,vga.draw.height,render.src.bpp,render.src.fps,render.src.scrn_ratio);
+
+    return true;
+}
+
 bool disable_log_menu_callback(DOSBoxMenu * const menu, DOSBoxMenu::item * const menuitem) {
     (void)menu;//UNUSED
     (void)menuitem;//UNUSED
@@ -3302,6 +3321,18 @@ void AllocCallback1() {
 #if C_GAMELINK
                 mainMenu.alloc_item(DOSBoxMenu::item_type_id,"output_gamelink").set_text("Game Link").
                     set_callback_function(output_menu_callback);
+#endif
+#if C_VULKAN
+                mainMenu.alloc_item(DOSBoxMenu::item_type_id,"output_vulkan").set_text("Vulkan").
+                    set_callback_function(output_menu_callback);
+                mainMenu.alloc_item(DOSBoxMenu::item_type_id,"output_vulkannb").set_text("Vulkan nearest").
+                    set_callback_function(output_menu_callback);
+#endif
+#if C_DIRECT3D11
+                mainMenu.alloc_item(DOSBoxMenu::item_type_id,"output_direct3d11").set_text("Direct3D 11").
+                    set_callback_function(output_menu_callback);
+                mainMenu.alloc_item(DOSBoxMenu::item_type_id,"output_direct3d11nb").set_text("Direct3D 11 nearest").
+                    set_callback_function(output_menu_callback);
 #endif
                 mainMenu.alloc_item(DOSBoxMenu::item_type_id,"doublescan").set_text("Doublescan").
                     set_callback_function(doublescan_menu_callback);
@@ -3320,6 +3351,8 @@ void AllocCallback1() {
                     set_callback_function(vsync_menu_callback);
                 mainMenu.alloc_item(DOSBoxMenu::item_type_id,"vsync_host").set_text("Host").
                     set_callback_function(vsync_menu_callback);
+                mainMenu.alloc_item(DOSBoxMenu::item_type_id,"vsync_adaptive").set_text("Adaptive").
+                    set_callback_function(vsync_menu_callback);
                 mainMenu.alloc_item(DOSBoxMenu::item_type_id,"vsync_off").set_text("Off").
                     set_callback_function(vsync_menu_callback);
                 mainMenu.alloc_item(DOSBoxMenu::item_type_id,"vsync_set_syncrate").set_text("Set syncrate").
@@ -3730,6 +3763,7 @@ void AllocCallback1() {
                 mainMenu.alloc_item(DOSBoxMenu::item_type_id,"debugger_runwatch").set_text("Debugger option: Run watch").set_callback_function(debugger_runwatch_menu_callback).check(debugrunmode==2);
 #endif
                 mainMenu.alloc_item(DOSBoxMenu::item_type_id,"video_debug_overlay").set_text("Video debug overlay").set_callback_function(video_debug_callback).check(video_debug_overlay);
+                mainMenu.alloc_item(DOSBoxMenu::item_type_id,"video_frame_pacing_graph").set_text("Frame pacing graph").set_callback_function(frame_pacing_graph_callback).check(framepace_graph);
             }
 
             {
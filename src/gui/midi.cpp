@@ -20,6 +20,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <string>
+#include <vector>
 #include <algorithm>
 
 #include "SDL.h"
@@ -73,6 +74,72 @@ MidiHandler Midi_none;
 DB_Midi midi;
 std::string sffile="Not available";
 
+/* MIDI output queue, used when batch output is enabled. Completed messages are stamped with
+ * the emulated time and handed to the handler once per mixer tick instead of one at a time. */
+struct MIDI_QueuedEvent {
+	pic_tickindex_t time;
+	Bitu sysex_len;			// 0 for a short message in msg[]
+	size_t sysex_pos;		// offset of the SysEx data in midi_queue_data
+	uint8_t msg[4];
+};
+
+static bool midi_batch = false;
+/* device left closed at startup ([midi] open synth on demand), opened by the first MIDI byte */
+static MidiHandler *midi_on_demand = NULL;
+static std::string midi_on_demand_conf;
+static std::vector<MIDI_QueuedEvent> midi_queue;
+static std::vector<uint8_t> midi_queue_data;
+
+static void MIDI_FlushQueue(void) {
+	if (midi_queue.empty()) return;
+
+	if (midi.handler != NULL) {
+		const pic_tickindex_t base = midi_queue[0].time;
+
+		midi.handler->BeginBatch();
+		for (auto &ev : midi_queue) {
+			const double offset = (double)(ev.time - base);
+			if (ev.sysex_len)
+				midi.handler->PlaySysexAt(&midi_queue_data[ev.sysex_pos],ev.sysex_len,offset);
+			else
+				midi.handler->PlayMsgAt(ev.msg,offset);
+		}
+		midi.handler->EndBatch();
+	}
+
+	midi_queue.clear();
+	midi_queue_data.clear();
+}
+
+static void MIDI_OutMsg(uint8_t *msg) {
+	if (midi_batch) {
+		MIDI_QueuedEvent ev;
+		ev.time = PIC_FullIndex();
+		ev.sysex_len = 0;
+		ev.sysex_pos = 0;
+		memcpy(ev.msg,msg,sizeof(ev.msg));
+		midi_queue.push_back(ev);
+	}
+	else {
+		midi.handler->PlayMsg(msg);
+	}
+}
+
+static void MIDI_OutSysex(uint8_t *sysex,Bitu len) {
+	if (midi_batch) {
+		MIDI_QueuedEvent ev;
+		ev.time = PIC_FullIndex();
+		ev.sysex_len = len;
+		ev.sysex_pos = midi_queue_data.size();
+		memset(ev.msg,0,sizeof(ev.msg));
+		midi_queue_data.insert(midi_queue_data.end(),sysex,sysex+len);
+		midi_queue.push_back(ev);
+	}
+	else {
+		midi.handler->PlaySysex(sysex,len);
+	}
+}
+
 static struct {
 	bool init;
 	bool ignore;
@@ -509,16 +576,49 @@ void MIDI_State_LoadMessage()
 }
 
 
+static void MIDI_OpenOnDemand(void) {
+	MidiHandler *handler = midi_on_demand;
+	const char *conf = midi_on_demand_conf.c_str();
+	midi_on_demand = NULL;
+
+	bool opened = handler->Open(conf);
+	if (!opened) {
+		LOG_MSG("MIDI:Cannot open device:%s with config:%s. Finding default handler.",handler->GetName(),conf);
+		for (handler = handler_list; handler; handler = handler->next) {
+			opened = handler->Open(conf);
+			if (opened) break;
+		}
+	}
+
+	if (!opened) {
+		// This shouldn't be possible
+		LOG_MSG("MIDI:Could not open a handler");
+		return;
+	}
+
+	midi.handler=handler;
+	LOG_MSG("MIDI:Opened device:%s",handler->GetName());
+
+	midi_state[0].init = false;
+	MIDI_State_LoadMessage();
+}
+
 void MIDI_RawOutByte(uint8_t data) {
+	if (midi_on_demand != NULL) MIDI_OpenOnDemand();
+
 	if (midi.sysex.start) {
 		uint32_t passed_ticks = GetTicks() - midi.sysex.start;
-		if (passed_ticks < midi.sysex.delay) SDL_Delay((Uint32)(midi.sysex.delay - passed_ticks));
+		if (passed_ticks < midi.sysex.delay) {
+			/* the delay paces the real device, so whatever is queued has to go out first */
+			MIDI_FlushQueue();
+			SDL_Delay((Uint32)(midi.sysex.delay - passed_ticks));
+		}
 	}
 
 	/* Test for a realtime MIDI message */
 	if (data>=0xf8) {
 		midi.rt_buf[0]=data;
-		midi.handler->PlayMsg(midi.rt_buf);
+		MIDI_OutMsg(midi.rt_buf);
 		return;
 	}	 
 	/* Test for an active sysex transfer */
@@ -533,7 +633,7 @@ void MIDI_RawOutByte(uint8_t data) {
 				LOG(LOG_ALL,LOG_ERROR)("MIDI:Skipping invalid MT-32 SysEx midi message (too short to contain a checksum)");
 			} else {
 //				LOG(LOG_ALL,LOG_NORMAL)("Play sysex; address:%02X %02X %02X, length:%4d, delay:%3d", midi.sysex.buf[5], midi.sysex.buf[6], midi.sysex.buf[7], midi.sysex.used, midi.sysex.delay);
-				midi.handler->PlaySysex(midi.sysex.buf, midi.sysex.used);
+				MIDI_OutSysex(midi.sysex.buf, midi.sysex.used);
 
 				if (roland_gs_sysex) {
 					if (midi.sysex.buf[1] == 0x41/*Roland*/ && midi.sysex.buf[3] == 0x42/*GS*/ && midi.sysex.buf[4] == 0x12/*Send*/) {
@@ -546,7 +646,7 @@ void MIDI_RawOutByte(uint8_t data) {
 							case 0x40007F: /* GS reset */
 								{
 									uint8_t msg[] = {0xFF};
-									midi.handler->PlayMsg(msg); /* MIDI reset */
+									MIDI_OutMsg(msg); /* MIDI reset */
 								}
 								break;
 							default:
@@ -594,7 +694,7 @@ void MIDI_RawOutByte(uint8_t data) {
 				CAPTURE_AddMidi(false, midi.cmd_len, midi.cmd_buf);
 			}
 
-			midi.handler->PlayMsg(midi.cmd_buf);
+			MIDI_OutMsg(midi.cmd_buf);
 			midi.cmd_pos=1;		//Use Running status
 
 			MIDI_State_SaveMessage();
@@ -623,6 +723,7 @@ public:
 		bool opened = false;
 
 		roland_gs_sysex = section->Get_bool("roland gs sysex");
+		midi_batch = section->Get_bool("batch output");
 
 //		MAPPER_AddHandler(MIDI_SaveRawEvent,MK_f8,MMOD1|MMOD2,"caprawmidi","Cap MIDI");
 		midi.sysex.delay = 0;
@@ -642,6 +743,15 @@ public:
 		if (strcasecmp(dev,"default")) {
 			for (handler = handler_list; handler; handler = handler->next) {
 				if (!strcasecmp(dev,handler->GetName())) {
+					if (handler->OpenOnDemand() && section->Get_bool("open synth on demand")) {
+						LOG(LOG_MISC,LOG_DEBUG)("MIDI:Device %s is opened when first used",dev);
+						midi_on_demand = handler;
+						midi_on_demand_conf = conf;
+						midi.available=true;
+						midi.handler=&Midi_none;
+						if (midi_batch) TIMER_AddTickHandler(MIDI_FlushQueue);
+						return;
+					}
 					opened = handler->Open(conf);
 					break;
 				}
@@ -668,6 +778,7 @@ public:
 		midi.available=true;
 		midi.handler=handler;
 		LOG_MSG("MIDI:Opened device:%s",handler->GetName());
+		if (midi_batch) TIMER_AddTickHandler(MIDI_FlushQueue);
 
 		// force reset to prevent crashes (when not properly shutdown)
 		// ex. Roland VSC = unexpected hard system crash
@@ -675,6 +786,9 @@ public:
 		MIDI_State_LoadMessage();
 	}
 	~MIDI(){
+		/* never opened, nothing to shut down */
+		midi_on_demand = NULL;
+
 		if( midi.status < 0xf0 ) {
 			// throw invalid midi message - start new cmd
 			MIDI_RawOutByte(0x80);
@@ -683,7 +797,11 @@ public:
 			// SysEx - throw invalid midi message
 			MIDI_RawOutByte(0xf7);
 		}
-		if(midi.available) midi.handler->Close();
+		if(midi.available) {
+			TIMER_DelTickHandler(MIDI_FlushQueue);
+			MIDI_FlushQueue();
+			midi.handler->Close();
+		}
 		midi.available = false;
 		midi.handler = nullptr;
 	}
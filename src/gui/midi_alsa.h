@@ -47,6 +47,9 @@ private:
 	alsa_address seq = {-1, -1}; // address of input port we're connected to
 	int seq_client, seq_port;
 	int my_client, my_port;
+	int queue_id = -1;		// sequencer queue used to schedule batched output (-2 = unavailable)
+	bool batching = false;
+	double batch_offset = 0;
 
     using port_action_t = std::function<void(snd_seq_client_info_t *client_info, snd_seq_port_info_t *port_info)>;
 
@@ -88,12 +91,21 @@ private:
     }
 
     void send_event(int do_flush) {
-		snd_seq_ev_set_direct(&ev);
+		if (batching) {
+			// schedule relative to the start of the batch, the whole batch is drained at once
+			snd_seq_real_time_t t;
+			t.tv_sec = (unsigned int)(batch_offset / 1000.0);
+			t.tv_nsec = (unsigned int)((batch_offset - (t.tv_sec * 1000.0)) * 1000000.0);
+			snd_seq_ev_schedule_real(&ev, queue_id, 1, &t);
+		}
+		else {
+			snd_seq_ev_set_direct(&ev);
+		}
 		snd_seq_ev_set_source(&ev, my_port);
 		snd_seq_ev_set_dest(&ev, seq_client, seq_port);
 
 		snd_seq_event_output(seq_handle, &ev);
-		if (do_flush)
+		if (do_flush && !batching)
 			snd_seq_flush_output(seq_handle);
 	}
 
@@ -204,9 +216,43 @@ public:
 		}
 	}	
 
+	void BeginBatch(void) override {
+		if (queue_id == -1) {
+			queue_id = snd_seq_alloc_named_queue(seq_handle, "DOSBOX-X");
+			if (queue_id < 0) {
+				LOG(LOG_MISC,LOG_WARN)("ALSA:Can't allocate queue, batched MIDI output is sent directly");
+				queue_id = -2;
+				return;
+			}
+			snd_seq_start_queue(seq_handle, queue_id, NULL);
+		}
+		batching = (queue_id >= 0);
+	}
+
+	void PlayMsgAt(uint8_t * msg,double offset) override {
+		batch_offset = offset;
+		PlayMsg(msg);
+	}
+
+	void PlaySysexAt(uint8_t * sysex,Bitu len,double offset) override {
+		batch_offset = offset;
+		PlaySysex(sysex, len);
+	}
+
+	void EndBatch(void) override {
+		batching = false;
+		snd_seq_flush_output(seq_handle);
+	}
+
 	void Close(void) override {
-		if (seq_handle)
+		if (seq_handle) {
+			if (queue_id >= 0) {
+				snd_seq_drain_output(seq_handle);
+				snd_seq_free_queue(seq_handle, queue_id);
+			}
 			snd_seq_close(seq_handle);
+		}
+		queue_id = -1;
 	}
 
 	void log_list_alsa_seqclient(void) {
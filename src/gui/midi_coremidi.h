@@ -15,8 +15,10 @@
  */
 
 #include <CoreMIDI/MIDIServices.h>
+#include <mach/mach_time.h>
 #include <sstream>
 #include <string>
+#include <vector>
 
 class MidiHandler_coremidi : public MidiHandler {
 private:
@@ -24,8 +26,35 @@ private:
 	MIDIClientRef m_client;
 	MIDIEndpointRef m_endpoint;
 	MIDIPacket* m_pCurPacket;
+
+	// batched output: one timestamped packet list per batch
+	std::vector<Byte> m_batchBuf;
+	MIDIPacket* m_pBatchPacket;
+	MIDITimeStamp m_batchBase;
+	double m_hostTicksPerMs;
+
+	void BatchAdd(const Byte* data, Bitu len, double offset) {
+		if (len == 0) return;
+		MIDIPacketList *packetList = (MIDIPacketList *)m_batchBuf.data();
+		const MIDITimeStamp when = m_batchBase + (MIDITimeStamp)(offset * m_hostTicksPerMs);
+		MIDIPacket *next = MIDIPacketListAdd(packetList, (ByteCount)m_batchBuf.size(), m_pBatchPacket, when, (ByteCount)len, data);
+		if (next == NULL) {
+			// list is full, send what we have and start a new one
+			MIDISend(m_port,m_endpoint,packetList);
+			m_pBatchPacket = MIDIPacketListInit(packetList);
+			next = MIDIPacketListAdd(packetList, (ByteCount)m_batchBuf.size(), m_pBatchPacket, when, (ByteCount)len, data);
+		}
+		if (next != NULL) m_pBatchPacket = next;
+	}
 public:
-	MidiHandler_coremidi()  {m_pCurPacket = 0;}
+	MidiHandler_coremidi()  {
+		m_pCurPacket = 0;
+		m_pBatchPacket = 0;
+		m_batchBase = 0;
+		mach_timebase_info_data_t tb;
+		mach_timebase_info(&tb);
+		m_hostTicksPerMs = 1000000.0 * (double)tb.denom / (double)tb.numer;
+	}
 	const char * GetName(void) { return "coremidi"; }
 	bool Open(const char * conf) {	
 		// Get the MIDIEndPoint
@@ -133,6 +162,25 @@ public:
 		MIDISend(m_port,m_endpoint,packetList);
 	}
 	
+	void BeginBatch(void) {
+		if (m_batchBuf.empty()) m_batchBuf.resize(SYSEX_SIZE*4);
+		m_pBatchPacket = MIDIPacketListInit((MIDIPacketList *)m_batchBuf.data());
+		m_batchBase = (MIDITimeStamp)mach_absolute_time();
+	}
+
+	void PlayMsgAt(uint8_t * msg, double offset) {
+		BatchAdd(msg, MIDI_evt_len[*msg], offset);
+	}
+
+	void PlaySysexAt(uint8_t * sysex, Bitu len, double offset) {
+		BatchAdd(sysex, len, offset);
+	}
+
+	void EndBatch(void) {
+		MIDIPacketList *packetList = (MIDIPacketList *)m_batchBuf.data();
+		if (packetList->numPackets) MIDISend(m_port,m_endpoint,packetList);
+	}
+
 	void ListAll(Program* base) {
 		Bitu numDests = MIDIGetNumberOfDestinations();
 		for(Bitu i = 0; i < numDests; i++){
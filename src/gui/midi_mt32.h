@@ -229,6 +229,10 @@ public:
 		return "mt32";
 	}
 
+	bool OpenOnDemand(void) override {
+		return true;
+	}
+
     bool Open(const char *conf) override {
         (void)conf;//UNUSED
         service = new MT32Emu::Service();
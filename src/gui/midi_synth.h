@@ -23,6 +23,9 @@
 #endif
 #include <math.h>
 #include <string.h>
+#include <chrono>
+#include <vector>
+#include <SDL_thread.h>
 #include "control.h"
 
 /* Protect against multiple inclusions */
@@ -35,6 +38,138 @@ static fluid_synth_t *synth_soft = NULL;
 static int synthsamplerate = 0;
 static uint8_t master_volume = 128;
 
+/* Render-ahead state, used when fluid.thread is set. The worker renders
+ * into synth_buffer (stereo frames) and the mixer callback plays from it.
+ * MIDI events are queued as <len:4><bytes> and applied by the worker
+ * before the next chunk. Positions and the queue are protected by synth_lock. */
+static SDL_Thread *synth_thread = NULL;
+static SDL_mutex *synth_lock = NULL;
+static SDL_cond *synth_cond = NULL;
+static int16_t *synth_buffer = NULL;
+static Bitu synth_buffer_frames = 0;
+static Bitu synth_chunk_frames = 0;
+static Bitu synth_render_pos = 0, synth_play_pos = 0;
+static bool synth_stop = false;
+static std::vector<uint8_t> synth_events;
+
+/* CPU budget: percentage of real time the worker may spend rendering.
+ * Level 0 is full quality, level 1 drops to linear interpolation, and each
+ * level after that halves the polyphony (not below 16 voices). */
+static int synth_budget = 0;
+static int synth_budget_level = 0;
+static int synth_polyphony = 0;
+static uint64_t synth_budget_us = 0;
+static Bitu synth_budget_frames = 0;
+
+static void synth_SendEvent(const uint8_t *msg, Bitu len) {
+	uint8_t event = msg[0], channel, p1, p2;
+
+	switch (event) {
+	case 0xf0:
+	case 0xf7:
+		fluid_synth_sysex(synth_soft, (char *)(msg + 1), (int)(len - 1), NULL, NULL, NULL, 0);
+		return;
+	case 0xff:
+		fluid_synth_system_reset(synth_soft);
+		return;
+	}
+
+	channel = event & 0xf;
+	p1 = len > 1 ? msg[1] : 0;
+	p2 = len > 2 ? msg[2] : 0;
+
+	switch (event & 0xf0) {
+	case 0x80:
+		fluid_synth_noteoff(synth_soft, channel, p1);
+		break;
+	case 0x90:
+		fluid_synth_noteon(synth_soft, channel, p1, p2);
+		break;
+	case 0xb0:
+		fluid_synth_cc(synth_soft, channel, p1, p2);
+		break;
+	case 0xc0:
+		fluid_synth_program_change(synth_soft, channel, p1);
+		break;
+	case 0xd0:
+		fluid_synth_channel_pressure(synth_soft, channel, p1);
+		break;
+	case 0xe0:
+		fluid_synth_pitch_bend(synth_soft, channel, (p2 << 7) | p1);
+		break;
+	}
+}
+
+static void synth_SetBudgetLevel(int level) {
+	int polyphony = synth_polyphony;
+	for (int i = 1; i < level; i++) polyphony >>= 1;
+	if (polyphony < 16) polyphony = 16;
+	fluid_synth_set_interp_method(synth_soft, -1, level > 0 ? FLUID_INTERP_LINEAR : FLUID_INTERP_DEFAULT);
+	fluid_synth_set_polyphony(synth_soft, polyphony);
+	synth_budget_level = level;
+}
+
+/* Called by the worker after each chunk; re-evaluates the quality level once per second of audio */
+static void synth_CheckBudget(Bitu frames, uint64_t us) {
+	synth_budget_us += us;
+	synth_budget_frames += frames;
+	if (synth_budget_frames < (Bitu)synthsamplerate) return;
+
+	const uint64_t audio_us = ((uint64_t)synth_budget_frames * 1000000u) / (uint64_t)synthsamplerate;
+	const int load = (int)((synth_budget_us * 100u) / audio_us);
+	synth_budget_us = 0;
+	synth_budget_frames = 0;
+
+	if (load > synth_budget) {
+		if ((synth_polyphony >> (synth_budget_level > 0 ? synth_budget_level - 1 : 0)) > 16)
+			synth_SetBudgetLevel(synth_budget_level + 1);
+	}
+	else if (load < (synth_budget / 2) && synth_budget_level > 0) {
+		synth_SetBudgetLevel(synth_budget_level - 1);
+	}
+}
+
+static int synth_ProcessingThread(void *) {
+	std::vector<uint8_t> events;
+
+	SDL_LockMutex(synth_lock);
+	while (!synth_stop) {
+		const Bitu used = (synth_render_pos + synth_buffer_frames - synth_play_pos) % synth_buffer_frames;
+		if ((synth_buffer_frames - 1 - used) < synth_chunk_frames) {
+			SDL_CondWait(synth_cond, synth_lock);
+			continue;
+		}
+
+		const Bitu pos = synth_render_pos;
+		events.swap(synth_events);
+		SDL_UnlockMutex(synth_lock);
+
+		for (size_t i = 0; (i + 4) <= events.size();) {
+			uint32_t len;
+			memcpy(&len, &events[i], 4);
+			synth_SendEvent(&events[i + 4], len);
+			i += 4 + len;
+		}
+		events.clear();
+
+		Bitu frames = synth_chunk_frames;
+		if ((pos + frames) > synth_buffer_frames) frames = synth_buffer_frames - pos;
+
+		const auto t0 = std::chrono::steady_clock::now();
+		fluid_synth_write_s16(synth_soft, (int)frames, synth_buffer + (pos * 2), 0, 2, synth_buffer + (pos * 2), 1, 2);
+		if (synth_budget > 0) {
+			const auto t1 = std::chrono::steady_clock::now();
+			synth_CheckBudget(frames, (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count());
+		}
+
+		SDL_LockMutex(synth_lock);
+		synth_render_pos = (pos + frames) % synth_buffer_frames;
+		SDL_CondSignal(synth_cond);
+	}
+	SDL_UnlockMutex(synth_lock);
+	return 0;
+}
+
 static void synth_log(int level,
 #if !defined (FLUIDSYNTH_VERSION_MAJOR) || FLUIDSYNTH_VERSION_MAJOR >= 2 // Let version 2.x be the default
                       const
@@ -59,9 +194,95 @@ static void synth_log(int level,
 	}
 }
 
+/* Sound fonts can be hundreds of megabytes, so they are loaded on a worker thread while the
+ * emulator carries on. Whatever needs the font (the first MIDI message, closing the synth)
+ * calls Wait(), which only blocks if the load is still running. Fluidsynth allows loading
+ * a font while its audio driver is rendering, and the mixer channel stays disabled until
+ * the first message. */
+class synth_SoundFontLoader {
+public:
+	/* Try the paths in order, the first that loads wins */
+	void Start(fluid_synth_t *_synth, const std::vector<std::string> &_paths, int _reset_presets) {
+		synth = _synth;
+		paths = _paths;
+		reset_presets = _reset_presets;
+		id = -1;
+		loaded.clear();
+		pending = true;
+#if defined(C_SDL2)
+		thread = SDL_CreateThread(Run, "SFLOAD", this);
+#else
+		thread = SDL_CreateThread(Run, this);
+#endif
+		if (thread == NULL) Run(this);
+	}
+
+	/* The font id (-1 if none of the paths loaded), waiting for the worker if needed */
+	int Wait(void) {
+		if (thread != NULL) {
+			SDL_WaitThread(thread, NULL);
+			thread = NULL;
+		}
+		pending = false;
+		return id;
+	}
+
+	bool Pending(void) const {
+		return pending;
+	}
+
+	const std::string &Loaded(void) const {
+		return loaded;
+	}
+
+private:
+	static int Run(void *p) {
+		synth_SoundFontLoader *self = (synth_SoundFontLoader *)p;
+		for (const auto &path : self->paths) {
+			self->id = fluid_synth_sfload(self->synth, path.c_str(), self->reset_presets);
+			if (self->id != -1) {
+				self->loaded = path;
+				break;
+			}
+		}
+		return 0;
+	}
+
+	SDL_Thread *thread = NULL;
+	fluid_synth_t *synth = NULL;
+	std::vector<std::string> paths;
+	std::string loaded;
+	int reset_presets = 0;
+	int id = -1;
+	bool pending = false;
+};
+
 static void synth_CallBack(Bitu len) {
 	if (synth_soft != NULL) {
-		fluid_synth_write_s16(synth_soft, (int)len, MixTemp, 0, 2, MixTemp, 1, 2);
+		if (synth_thread != NULL) {
+			int16_t *out = (int16_t *)MixTemp;
+			Bitu done = 0;
+
+			SDL_LockMutex(synth_lock);
+			while (done < len && !synth_stop) {
+				Bitu avail = (synth_render_pos + synth_buffer_frames - synth_play_pos) % synth_buffer_frames;
+				if (avail == 0) {
+					SDL_CondWait(synth_cond, synth_lock);
+					continue;
+				}
+				if (avail > (synth_buffer_frames - synth_play_pos)) avail = synth_buffer_frames - synth_play_pos;
+				if (avail > (len - done)) avail = len - done;
+				memcpy(out + (done * 2), synth_buffer + (synth_play_pos * 2), avail * 2 * sizeof(int16_t));
+				synth_play_pos = (synth_play_pos + avail) % synth_buffer_frames;
+				done += avail;
+				SDL_CondSignal(synth_cond);
+			}
+			SDL_UnlockMutex(synth_lock);
+			if (done < len) memset(out + (done * 2), 0, (len - done) * 2 * sizeof(int16_t));
+		}
+		else {
+			fluid_synth_write_s16(synth_soft, (int)len, MixTemp, 0, 2, MixTemp, 1, 2);
+		}
 		if (master_volume < 128) {
 			for (unsigned int i=0;i < (len*2);i++) {
 				((int16_t*)MixTemp)[i] = (int16_t)(((((int16_t*)MixTemp)[i]) * master_volume) >> 7);
@@ -84,6 +305,87 @@ private:
 	fluid_settings_t *settings;
 	int sfont_id;
 	bool isOpen;
+	synth_SoundFontLoader sfont_loader;
+
+	/* The part of Open() that needs the sound font, run once it is in */
+	void FinishLoad(void) {
+		if (!sfont_loader.Pending()) return;
+
+		sfont_id = sfont_loader.Wait();
+		if (sfont_id == -1) {
+			LOG(LOG_MISC,LOG_WARN)("SYNTH: Failed to load MIDI sound font file \"%s\"", sffile.c_str());
+			fsinfo = "Sound font: none";
+			sffile = "Not available";
+			return;
+		}
+		fsinfo = "Sound font: "+sfont_loader.Loaded();
+
+		Section_prop *section = static_cast<Section_prop *>(control->GetSection("midi"));
+		if (section->Get_bool("fluid.thread")) StartThread(section);
+	}
+
+	void QueueEvent(const uint8_t *msg, Bitu len) {
+		if (synth_thread == NULL) {
+			synth_SendEvent(msg, len);
+			return;
+		}
+
+		const uint32_t len32 = (uint32_t)len;
+		SDL_LockMutex(synth_lock);
+		const size_t at = synth_events.size();
+		synth_events.resize(at + 4 + len);
+		memcpy(&synth_events[at], &len32, 4);
+		memcpy(&synth_events[at + 4], msg, len);
+		SDL_UnlockMutex(synth_lock);
+	}
+
+	void StartThread(Section_prop *section) {
+		synth_budget = section->Get_int("fluid.budget");
+		synth_budget_level = 0;
+		synth_budget_us = 0;
+		synth_budget_frames = 0;
+		synth_polyphony = fluid_synth_get_polyphony(synth_soft);
+
+		Bitu prebuffer = (Bitu)section->Get_int("fluid.prebuffer");
+		synth_chunk_frames = (prebuffer * (Bitu)synthsamplerate) / 4000u;
+		if (synth_chunk_frames < 64) synth_chunk_frames = 64;
+		synth_buffer_frames = (prebuffer * (Bitu)synthsamplerate) / 1000u;
+		if (synth_buffer_frames < (synth_chunk_frames * 2 + 1)) synth_buffer_frames = synth_chunk_frames * 2 + 1;
+		synth_buffer = new int16_t[synth_buffer_frames * 2];
+		synth_render_pos = synth_play_pos = 0;
+		synth_stop = false;
+		synth_events.clear();
+
+		synth_lock = SDL_CreateMutex();
+		synth_cond = SDL_CreateCond();
+#if defined(C_SDL2)
+		synth_thread = SDL_CreateThread(synth_ProcessingThread, "SYNTH", NULL);
+#else
+		synth_thread = SDL_CreateThread(synth_ProcessingThread, NULL);
+#endif
+		if (synth_thread == NULL) {
+			LOG(LOG_MISC,LOG_WARN)("SYNTH: Unable to start render thread, rendering in mixer callback");
+			StopThread();
+		}
+	}
+
+	void StopThread(void) {
+		if (synth_thread != NULL) {
+			SDL_LockMutex(synth_lock);
+			synth_stop = true;
+			SDL_CondSignal(synth_cond);
+			SDL_UnlockMutex(synth_lock);
+			SDL_WaitThread(synth_thread, NULL);
+			synth_thread = NULL;
+		}
+		if (synth_cond != NULL) SDL_DestroyCond(synth_cond);
+		if (synth_lock != NULL) SDL_DestroyMutex(synth_lock);
+		delete[] synth_buffer;
+		synth_cond = NULL;
+		synth_lock = NULL;
+		synth_buffer = NULL;
+		synth_events.clear();
+	}
 
 	void PlayEvent(uint8_t *msg, Bitu len) {
 		uint8_t event = msg[0], channel, p1, p2;
@@ -109,7 +411,7 @@ private:
 		case 0xf0:
 		case 0xf7:
 			LOG(LOG_MISC,LOG_DEBUG)("SYNTH: sysex 0x%02x len %lu", (int)event, (long unsigned)len);
-			fluid_synth_sysex(synth_soft, (char *)(msg + 1), (int)(len - 1), NULL, NULL, NULL, 0);
+			QueueEvent(msg, len);
 			return;
 		case 0xf9:
 			LOG(LOG_MISC,LOG_DEBUG)("SYNTH: midi tick");
@@ -117,7 +419,7 @@ private:
 		case 0xff:
 			master_volume = 128;
 			LOG(LOG_MISC,LOG_DEBUG)("SYNTH: system reset");
-			fluid_synth_system_reset(synth_soft);
+			QueueEvent(msg, len);
 			return;
 		case 0xf1: case 0xf2: case 0xf3: case 0xf4:
 		case 0xf5: case 0xf6: case 0xf8: case 0xfa:
@@ -133,26 +435,7 @@ private:
 		LOG(LOG_MISC,LOG_DEBUG)("SYNTH: event 0x%02x channel %d, 0x%02x 0x%02x",
 			(int)event, (int)channel, (int)p1, (int)p2);
 
-		switch (event & 0xf0) {
-		case 0x80:
-			fluid_synth_noteoff(synth_soft, channel, p1);
-			break;
-		case 0x90:
-			fluid_synth_noteon(synth_soft, channel, p1, p2);
-			break;
-		case 0xb0:
-			fluid_synth_cc(synth_soft, channel, p1, p2);
-			break;
-		case 0xc0:
-			fluid_synth_program_change(synth_soft, channel, p1);
-			break;
-		case 0xd0:
-			fluid_synth_channel_pressure(synth_soft, channel, p1);
-			break;
-		case 0xe0:
-			fluid_synth_pitch_bend(synth_soft, channel, (p2 << 7) | p1);
-			break;
-		}
+		QueueEvent(msg, len);
 	};
 
 public:
@@ -162,6 +445,10 @@ public:
 		return "synth";
 	};
 
+	bool OpenOnDemand(void) override {
+		return true;
+	};
+
 	bool Open(const char *conf) override {
 		if (isOpen) return false;
 
@@ -231,26 +518,36 @@ public:
 			return false;
 		}
 
-		/* Load a SoundFont */
-		sfont_id = fluid_synth_sfload(synth_soft, sf.c_str(), 0);
-		if (sfont_id == -1) {
-			extern std::string capturedir;
-			std::string str = capturedir + std::string(PATH_SEP) + sf;
-			sfont_id = fluid_synth_sfload(synth_soft, str.c_str(), 0);
+		/* Load a SoundFont, in the background. A missing file still fails here so that
+		 * another device can be picked, a damaged one is reported on first use. */
+		extern std::string capturedir;
+		std::vector<std::string> paths;
+		paths.push_back(sf);
+		paths.push_back(capturedir + std::string(PATH_SEP) + sf);
+		bool found = false;
+		for (const auto &path : paths) {
+			if (FILE *file = fopen(path.c_str(), "rb")) {
+				fclose(file);
+				found = true;
+				break;
+			}
 		}
 
-		if (sfont_id == -1) {
+		if (!found) {
 			LOG(LOG_MISC,LOG_WARN)("SYNTH: Failed to load MIDI sound font file \"%s\"", sf.c_str());
 			delete_fluid_synth(synth_soft);
 			delete_fluid_settings(settings);
 			return false;
 		}
 		sffile=sf;
-        fsinfo="Sound font: "+sf;
+        fsinfo="Sound font: "+sf+" (loading)";
+		sfont_id = -1;
+		sfont_loader.Start(synth_soft, paths, 0);
 
 		master_volume = 128;
 		synthchan = MIXER_AddChannel(synth_CallBack, (unsigned int)synthsamplerate, "SYNTH");
 		synthchan->Enable(false);
+
 		isOpen = true;
 		return true;
 	};
@@ -258,7 +555,9 @@ public:
 	void Close(void) override {
 		if (!isOpen) return;
 
+		FinishLoad();
 		synthchan->Enable(false);
+		StopThread();
 		MIXER_DelChannel(synthchan);
 		delete_fluid_synth(synth_soft);
 		delete_fluid_settings(settings);
@@ -270,15 +569,18 @@ public:
 	};
 
 	void PlayMsg(uint8_t *msg) override {
+		FinishLoad();
 		synthchan->Enable(true);
 		PlayEvent(msg, MIDI_evt_len[*msg]);
 	};
 
 	void PlaySysex(uint8_t *sysex, Bitu len) override {
+		FinishLoad();
 		PlayEvent(sysex, len);
 	};
 
 	void ListAll(Program* base) override {
+		FinishLoad();
 		base->WriteOut("  %s\n",fsinfo.c_str());
 	}
 
@@ -294,14 +596,34 @@ private:
 	fluid_settings_t *settings;
 	fluid_synth_t *synth;
 	fluid_audio_driver_t* adriver;
+	synth_SoundFontLoader soundfont_loader;
+
+	void FinishLoad(void) {
+		if (!soundfont_loader.Pending()) return;
+
+		soundfont_id = soundfont_loader.Wait();
+		if (soundfont_id == -1) {
+			/* Just consider this a warning (fluidsynth already prints) */
+			soundfont.clear();
+			sffile = "Not available";
+		}
+		else {
+			sffile=soundfont;
+			fsinfo="Sound font: "+soundfont;
+			LOG_MSG("MIDI:fluidsynth: Loaded SoundFont: %s", soundfont.c_str());
+		}
+	}
 public:
 	MidiHandler_fluidsynth() : MidiHandler() {};
 	const char* GetName(void) override { return "fluidsynth"; }
+	bool OpenOnDemand(void) override { return true; }
 	void PlaySysex(uint8_t * sysex, Bitu len) override {
+		FinishLoad();
 		fluid_synth_sysex(synth, (char*)sysex, (int)len, NULL, NULL, NULL, 0);
 	}
 
 	void PlayMsg(uint8_t * msg) override {
+		FinishLoad();
 		unsigned char chanID = msg[0] & 0x0F;
 		switch (msg[0] & 0xF0) {
 		case 0x80:
@@ -331,6 +653,7 @@ public:
 	}
 
 	void Close(void) override {
+		FinishLoad();
 		if (soundfont_id >= 0) {
 			fluid_synth_sfunload(synth, soundfont_id, 0);
 		}
@@ -459,29 +782,22 @@ public:
 
 		fluid_synth_set_chorus(synth, section->Get_int("fluid.chorus.number"), atof(section->Get_string("fluid.chorus.level")), atof(section->Get_string("fluid.chorus.speed")), atof(section->Get_string("fluid.chorus.depth")), section->Get_int("fluid.chorus.type"));
 		LOG_MSG("MIDI:fluidsynth: version %d.%d.%d", major, minor, micro);
-		/* Optionally load a soundfont */
+		/* Optionally load a soundfont, in the background (see synth_SoundFontLoader) */
+		soundfont_id = -1;
 		if (!soundfont.empty()) {
-			soundfont_id = fluid_synth_sfload(synth, soundfont.c_str(), 1);
-			if (soundfont_id == FLUID_FAILED) {
-				/* Just consider this a warning (fluidsynth already prints) */
-                soundfont.clear();
-				soundfont_id = -1;
-			}
-			else {
-				sffile=soundfont;
-				fsinfo="Sound font: "+soundfont;
-				LOG_MSG("MIDI:fluidsynth: Loaded SoundFont: %s", soundfont.c_str());
-			}
+			sffile=soundfont;
+			fsinfo="Sound font: "+soundfont+" (loading)";
+			soundfont_loader.Start(synth, std::vector<std::string>(1, soundfont), 1);
 		}
 		else {
-            soundfont_id = -1;
 			LOG_MSG("MIDI:fluidsynth: No SoundFont loaded");
+			sffile = "Not available";
 		}
-        if(soundfont_id == -1) sffile = "Not available";
         return true;
 	}
 
 	void ListAll(Program* base) override {
+		FinishLoad();
 		base->WriteOut("  %s\n",fsinfo.c_str());
 	}
 };
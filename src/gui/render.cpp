@@ -22,6 +22,7 @@
 #include <math.h>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
 #include "dosbox.h"
 #include "logging.h"
@@ -33,6 +34,7 @@
 #include "menudef.h"
 #include "vga.h"
 #include "pic.h"
+#include "cpu.h"
 #include "cross.h"
 #include "hardware.h"
 #include "support.h"
@@ -41,6 +43,11 @@
 #include "pc98_cg.h"
 #include "pc98_gdc.h"
 #include "pc98_gdc_const.h"
+#include "threadpool.h"
+#include "hosttime.h"
+#include "tracerec.h"
+#include "framepacing.h"
+#include "hostmem.h"
 
 #include "render_scalers.h"
 #include "render_glsl.h"
@@ -53,6 +60,7 @@
 #include <output/output_opengl.h>
 
 extern bool video_debug_overlay;
+extern bool video_debug_composited;
 
 Render_t                                render;
 int                                     eurAscii = -1;
@@ -60,6 +68,8 @@ int                                     aspect_ratio_x = 0;
 int                                     aspect_ratio_y = 0;
 Bitu                                    last_gfx_flags = 0;
 ScalerLineHandler_t                     RENDER_DrawLine;
+uint64_t                                render_frames_rendered = 0;
+uint64_t                                render_frames_skipped = 0;
 
 uint32_t                                GFX_palette32bpp[256] = {0};
 
@@ -86,6 +96,8 @@ static void Check_Palette(void) {
     switch (render.scale.outMode) {
         case scalerMode8:
             GFX_SetPalette(render.pal.first,render.pal.last-render.pal.first+1,(GFX_PalEntry *)&render.pal.rgb[render.pal.first]);
+            /* outputs that apply the palette themselves (indexed OpenGL) must present this frame even if no line changed */
+            render.pal.changed = true;
             break;
         case scalerMode15:
         case scalerMode16:
@@ -146,40 +158,130 @@ static void RENDER_EmptyLineHandler(const void * src) {
     (void)src;//UNUSED
 }
 
-/*HACK*/
-#if defined(_M_AMD64) || defined(__amd64__) || defined(__e2k__)
-/* SSE2 is always available on x86_64 and Elbrus */
-# define sse2_available (1)
-extern bool             avx2_available;
-#elif defined(__SSE__)
-#ifdef __AVX2__
-/* We are building with -mavx2 */
-# define sse2_available (1)
-# define avx2_available (1)
-#else
-extern bool             sse2_available;
-extern bool             avx2_available;
+/* Scanline cache compare. Each variant returns true if the first count Bitu of src and cache
+ * are equal. RENDER_SelectCacheHit picks the best one the host CPU has when the renderer
+ * starts; the SIMD ones finish the tail of the line with the plain C loop. Win9x builds stay
+ * on the C loop since those systems may not save SSE state. */
+#if (defined(__SSE__) || defined(_M_AMD64)) && !defined(__e2k__) && !defined(_WIN32_WINDOWS)
+# define RENDER_CACHEHIT_X86 1
+# if !defined(C_EMSCRIPTEN)
+#  define RENDER_CACHEHIT_AVX2 1
+# endif
+# include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# define RENDER_CACHEHIT_NEON 1
+# include <arm_neon.h>
 #endif
-/*END HACK*/
 
-#include <immintrin.h>
+static bool RENDER_CacheHit_C(const Bitu *src, const Bitu *cache, Bits count) {
+    while (count) {
+        if (GCC_UNLIKELY(src[0] != cache[0]))
+            return false;
+        count--; src++; cache++;
+    }
+    return true;
+}
+
+#if defined(RENDER_CACHEHIT_X86)
+#ifdef __GNUC__
+__attribute__((__target__("sse2")))
+#endif
+static bool RENDER_CacheHit_SSE2(const Bitu *src, const Bitu *cache, Bits count) {
+    static const Bits simd_inc = 16 / sizeof(*src);
+    while (count >= simd_inc) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)src);
+        const __m128i c = _mm_loadu_si128((const __m128i*)cache);
+        if (GCC_UNLIKELY(_mm_movemask_epi8(_mm_cmpeq_epi32(v, c)) != 0xFFFF))
+            return false;
+        count -= simd_inc; src += simd_inc; cache += simd_inc;
+    }
+    return RENDER_CacheHit_C(src, cache, count);
+}
 
+#if defined(RENDER_CACHEHIT_AVX2)
 #ifdef __GNUC__
 __attribute__((__target__("avx2")))
 #endif
-static inline bool cacheHit_AVX2(const Bitu *src, Bitu *cache, Bits count) {
-    static const Bitu simd_inc = 32 / sizeof(*src);
-    while (count >= (Bits)simd_inc) {
-        __m256i v = _mm256_loadu_si256((const __m256i*)src);
-        __m256i c = _mm256_loadu_si256((const __m256i*)cache);
-        __m256i cmp = _mm256_cmpeq_epi32(v, c);
-        if (GCC_UNLIKELY((unsigned int)_mm256_movemask_epi8(cmp) != 0xFFFFFFFF))
+static bool RENDER_CacheHit_AVX2(const Bitu *src, const Bitu *cache, Bits count) {
+    static const Bits simd_inc = 32 / sizeof(*src);
+    while (count >= simd_inc) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)src);
+        const __m256i c = _mm256_loadu_si256((const __m256i*)cache);
+        if (GCC_UNLIKELY((unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi32(v, c)) != 0xFFFFFFFFu))
             return false;
-        count-=(Bits)simd_inc; src+=simd_inc; cache+=simd_inc;
+        count -= simd_inc; src += simd_inc; cache += simd_inc;
+    }
+    return RENDER_CacheHit_C(src, cache, count);
+}
+#endif
+#endif // RENDER_CACHEHIT_X86
+
+#if defined(RENDER_CACHEHIT_NEON)
+/* two vectors per round, any bit left over after XOR means a difference */
+static bool RENDER_CacheHit_NEON(const Bitu *src, const Bitu *cache, Bits count) {
+    static const Bits simd_inc = 32 / sizeof(*src);
+    while (count >= simd_inc) {
+        const uint32x4_t d0 = veorq_u32(vld1q_u32((const uint32_t*)src), vld1q_u32((const uint32_t*)cache));
+        const uint32x4_t d1 = veorq_u32(vld1q_u32((const uint32_t*)src + 4), vld1q_u32((const uint32_t*)cache + 4));
+        const uint32x4_t d = vorrq_u32(d0, d1);
+#if defined(__aarch64__)
+        if (GCC_UNLIKELY(vmaxvq_u32(d) != 0))
+            return false;
+#else
+        const uint32x2_t h = vorr_u32(vget_low_u32(d), vget_high_u32(d));
+        if (GCC_UNLIKELY((vget_lane_u32(h, 0) | vget_lane_u32(h, 1)) != 0))
+            return false;
+#endif
+        count -= simd_inc; src += simd_inc; cache += simd_inc;
+    }
+    return RENDER_CacheHit_C(src, cache, count);
+}
+#endif // RENDER_CACHEHIT_NEON
+
+/* best first */
+static const struct {
+    const char*                 name;
+    RENDER_CacheHitHandler_t    handler;
+} render_cachehit_variants[] = {
+#if defined(RENDER_CACHEHIT_AVX2)
+    { "avx2",   RENDER_CacheHit_AVX2 },
+#endif
+#if defined(RENDER_CACHEHIT_X86)
+    { "sse2",   RENDER_CacheHit_SSE2 },
+#endif
+#if defined(RENDER_CACHEHIT_NEON)
+    { "neon",   RENDER_CacheHit_NEON },
+#endif
+    { "c",      RENDER_CacheHit_C }
+};
+
+static RENDER_CacheHitHandler_t RENDER_CacheHit = RENDER_CacheHit_C;
+
+/* The named compare if it is built in and the host CPU can run it, else NULL */
+RENDER_CacheHitHandler_t RENDER_GetCacheHit(const char *name) {
+#if defined(RENDER_CACHEHIT_AVX2)
+    if (!strcmp(name, "avx2") && !avx2_available) return NULL;
+#endif
+#if defined(RENDER_CACHEHIT_X86)
+    if (!strcmp(name, "sse2") && !sse2_available) return NULL;
+#endif
+    for (const auto &variant : render_cachehit_variants) {
+        if (!strcmp(name, variant.name))
+            return variant.handler;
+    }
+    return NULL;
+}
+
+static void RENDER_SelectCacheHit(void) {
+    for (const auto &variant : render_cachehit_variants) {
+        RENDER_CacheHitHandler_t handler = RENDER_GetCacheHit(variant.name);
+        if (handler != NULL) {
+            RENDER_CacheHit = handler;
+            LOG(LOG_MISC,LOG_DEBUG)("Render cache compare: %s", variant.name);
+            return;
+        }
     }
-    return true;
 }
-#endif // __SSE__
 
 /* NTS: In normal conditions, the renderer at the start of the frame
  *      does not call the scaler but instead compares line by line
@@ -200,41 +302,8 @@ static inline bool cacheHit_AVX2(const Bitu *src, Bitu *cache, Bits count) {
  *      and video bandwidth are more limited. */
 
 static inline bool RENDER_DrawLine_scanline_cacheHit(const void *s) {
-    if (s) {
-        const Bitu *src = (Bitu*)s;
-        Bitu *cache = (Bitu*)(render.scale.cacheRead);
-        Bits count = (Bits)render.src.start;
-#if defined(__SSE__) && !(defined(_M_AMD64) || defined(__amd64__) || defined(__e2k__) || defined(_WIN32_WINDOWS))
-#define MY_SIZEOF_INT_P sizeof(*src)
-        if (GCC_LIKELY(avx2_available)) {
-            if (!cacheHit_AVX2(src, cache, count))
-                goto cacheMiss;
-        } else if (sse2_available) {
-            static const Bitu simd_inc = 16/MY_SIZEOF_INT_P;
-            while (count >= (Bits)simd_inc) {
-                __m128i v = _mm_loadu_si128((const __m128i*)src);
-                __m128i c = _mm_loadu_si128((const __m128i*)cache);
-                __m128i cmp = _mm_cmpeq_epi32(v, c);
-                if (GCC_UNLIKELY(_mm_movemask_epi8(cmp) != 0xFFFF))
-                    goto cacheMiss;
-                count-=(Bits)simd_inc; src+=simd_inc; cache+=simd_inc;
-            }
-        }
-#undef MY_SIZEOF_INT_P
-        else
-#endif // __SSE__
-        {
-            while (count) {
-                if (GCC_UNLIKELY(src[0] != cache[0]))
-                    goto cacheMiss;
-                count--; src++; cache++;
-            }
-        }
-    }
-/* cacheHit */
-    return true;
-cacheMiss:
-    return false;
+    if (!s) return true;
+    return RENDER_CacheHit((const Bitu*)s, (const Bitu*)render.scale.cacheRead, (Bits)render.src.start);
 }
 
 #if defined(C_SCALER_FULL_LINE)
@@ -272,6 +341,166 @@ static void RENDER_DrawLine_countdown(const void * s) {
 }
 #endif
 
+/* Threaded scaler ("threaded scaler" in [render]). A simple scaler only looks at the line it
+ * is given, so once the first changed line of a frame turns up the emulation thread stops
+ * running it. Source lines are copied to a staging copy of the source cache instead and
+ * every SCALER_BANDLINES lines the band is handed to the worker pool, which scales it into its own
+ * part of the output while the emulation goes on. The emulation thread only keeps the line
+ * and output position. RENDER_EndUpdate waits for the bands and appends their changed
+ * lines to Scaler_ChangedLines. Complex scalers carry state from one line to the next and
+ * keep running on the emulation thread. */
+static struct {
+    ThreadPoolGroup             group;
+    bool                        enabled = false;
+    /* the rest is only written by the emulation thread, and not while a band is pending */
+    Render_t                    frame;
+    std::vector<ScalerBand_t>   bands;
+    Bitu                        used = 0;
+    uint8_t*                    staging = nullptr;
+    ScalerLineHandler_t         handler = nullptr;
+    bool                        clearCache = false;
+    bool                        active = false;
+} render_bands;
+
+static inline bool RENDER_UseBands(void) {
+    return render_bands.enabled && render.scale.complexHandler == nullptr;
+}
+
+static void RENDER_QueueBand(void) {
+    ScalerBand_t &band = render_bands.bands[render_bands.used];
+    if (band.lines == 0) return;
+
+    ScalerBand_t *queued = &band;
+    render_bands.group.run([queued] { RENDER_ScaleBand(render_bands.frame, *queued); });
+
+    if (++render_bands.used < render_bands.bands.size())
+        render_bands.bands[render_bands.used].lines = 0;
+}
+
+static void RENDER_BandLineHandler(const void * s) {
+    if (GCC_UNLIKELY(render_bands.used >= render_bands.bands.size()))
+        return;
+
+    ScalerBand_t &band = render_bands.bands[render_bands.used];
+    if (band.lines == 0) {
+        band.handler = render_bands.handler;
+        band.clearCache = render_bands.clearCache;
+        band.cacheRead = render.scale.cacheRead;
+        band.outWrite = render.scale.outWrite;
+        band.outLine = render.scale.outLine;
+    }
+
+    const uint8_t *line = nullptr;
+    if (s) {
+        uint8_t *staged = render_bands.staging + (render.scale.cacheRead - (uint8_t*)&scalerSourceCache);
+        memcpy(staged, s, render.scale.cachePitch);
+        line = staged;
+    }
+    band.line[band.lines++] = line;
+
+    render.scale.cacheRead += render.scale.cachePitch;
+    render.scale.outWrite += render.scale.outPitch * Scaler_Aspect[ render.scale.outLine ];
+    render.scale.inLine++;
+    render.scale.outLine++;
+
+    if (band.lines == SCALER_BANDLINES)
+        RENDER_QueueBand();
+}
+
+/* Hand the rest of the frame, from the current line on, to the worker pool */
+static void RENDER_StartBands(ScalerLineHandler_t handler, bool clearCache) {
+    render_bands.frame = render;
+    render_bands.handler = handler;
+    render_bands.clearCache = clearCache;
+    render_bands.used = 0;
+    render_bands.bands[0].lines = 0;
+    render_bands.active = true;
+    RENDER_DrawLine = RENDER_BandLineHandler;
+}
+
+/* Wait for the bands of this frame. With merge, the last partial band is scaled too and the
+ * changed lines of all bands are appended to Scaler_ChangedLines in order, with their spans. */
+static void RENDER_FinishBands(bool merge) {
+    if (!render_bands.active) return;
+    render_bands.active = false;
+
+    if (merge && render_bands.used < render_bands.bands.size())
+        RENDER_QueueBand();
+
+    render_bands.group.wait();
+
+    if (!merge) return;
+
+    for (Bitu b=0;b<render_bands.used;b++) {
+        const ScalerBand_t &band = render_bands.bands[b];
+        for (Bitu i=0;i<=band.changedIndex;i++) {
+            const Bitu changed = i & 1;
+            const uint16_t count = band.changed[i];
+            if (count == 0) continue;
+            if ((Scaler_ChangedLineIndex & 1) == changed) {
+                Scaler_ChangedLines[Scaler_ChangedLineIndex] += count;
+                if (changed) {
+                    GFX_ChangedSpan &span = Scaler_ChangedSpans[Scaler_ChangedLineIndex];
+                    const GFX_ChangedSpan &add = band.spans[i];
+                    if (span.left >= span.right)
+                        span = add;
+                    else if (add.left < add.right) {
+                        if (span.left > add.left) span.left = add.left;
+                        if (span.right < add.right) span.right = add.right;
+                    }
+                }
+            }
+            else {
+                Scaler_ChangedLines[++Scaler_ChangedLineIndex] = count;
+                Scaler_ChangedSpans[Scaler_ChangedLineIndex] = band.spans[i];
+            }
+        }
+    }
+}
+
+static void RENDER_StopScalerBands(void) {
+    RENDER_FinishBands(false);
+    render_bands.enabled = false;
+
+    delete[] render_bands.staging;
+    render_bands.staging = nullptr;
+}
+
+static void RENDER_StartScalerBands(bool enable) {
+    RENDER_StopScalerBands();
+    if (!enable) return;
+
+    /* without workers the bands would only add a copy on the emulation thread */
+    if (THREADPOOL_Workers() == 0) {
+        LOG(LOG_MISC,LOG_DEBUG)("Threaded scaler: no worker threads, scaling on the emulation thread");
+        return;
+    }
+
+    render_bands.staging = new uint8_t[sizeof(scalerSourceCache_t)];
+    render_bands.bands.resize(SCALER_MAXHEIGHT / SCALER_BANDLINES + 1);
+    render_bands.enabled = true;
+}
+
+static void RENDER_ShutDownScalerBands(Section * sec) {
+    (void)sec;//UNUSED
+    RENDER_StopScalerBands();
+}
+
+void RENDER_GetHostMemory(HostMemSize &sz) {
+    /* the line write cache of render_scalers.cpp, the threaded scaler has one per worker */
+    const size_t write_cache = sizeof(uint32_t) * 4 * SCALER_MAXWIDTH * 3;
+
+    sz.add(&scalerSourceCache, sizeof(scalerSourceCache));
+#if RENDER_USE_ADVANCED_SCALERS>1
+    sz.add(&scalerChangeCache, sizeof(scalerChangeCache));
+#endif
+    sz.add_heap(write_cache);
+    if (render_bands.staging != nullptr) {
+        sz.add(render_bands.staging, sizeof(scalerSourceCache_t));
+        sz.add_heap(render_bands.bands.size() * sizeof(ScalerBand_t) + THREADPOOL_Workers() * write_cache);
+    }
+}
+
 static void RENDER_StartLineHandler(const void * s) {
     if (RENDER_DrawLine_scanline_cacheHit(s)) { // line has not changed
         render.scale.cacheRead += render.scale.cachePitch;
@@ -285,6 +514,11 @@ static void RENDER_StartLineHandler(const void * s) {
             return;
         }
         render.scale.outWrite += render.scale.outPitch * Scaler_ChangedLines[0];
+        if (RENDER_UseBands()) {
+            RENDER_StartBands(render.scale.lineHandler, false);
+            RENDER_DrawLine( s );
+            return;
+        }
 #if defined(C_SCALER_FULL_LINE)
         RENDER_scaler_countdown = RENDER_scaler_countdown_init;
         RENDER_DrawLine = RENDER_DrawLine_countdown;
@@ -319,6 +553,138 @@ static void RENDER_ClearCacheHandler(const void * src) {
     render.scale.lineHandler( src );
 }
 
+/* Direct mode (render.scale.direct). With scaler none and the same pixel format on both
+ * sides the scaler would only copy lines into the output, so the output buffer is fetched
+ * at the start of every frame and the VGA code draws lines straight into it, see
+ * RENDER_DirectLine. Lines that turn up anywhere else are copied in. What is left is the
+ * compare against the source cache, which still tells the output which lines changed. */
+static void RENDER_DirectAddLine(Bitu changed) {
+    if ((Scaler_ChangedLineIndex & 1) == changed) {
+        Scaler_ChangedLines[Scaler_ChangedLineIndex]++;
+    } else {
+        Scaler_ChangedLines[++Scaler_ChangedLineIndex] = 1;
+        Scaler_ChangedSpans[Scaler_ChangedLineIndex].left = 0;
+        Scaler_ChangedSpans[Scaler_ChangedLineIndex].right = SCALER_SPAN_FULL;
+    }
+    render.scale.cacheRead += render.scale.cachePitch;
+    render.scale.outWrite += render.scale.outPitch;
+    render.scale.inLine++;
+    render.scale.outLine++;
+}
+
+static void RENDER_DirectLineHandler(const void * s) {
+    if (GCC_UNLIKELY(render.scale.inLine >= render.src.height))
+        return;
+
+    bool changed = false;
+    if (s) {
+        if (s != render.scale.outWrite)
+            memcpy(render.scale.outWrite, s, render.scale.cachePitch);
+        /* the cache is stale on the first frame, everything counts as changed */
+        changed = render.scale.clearCache ||
+            !RENDER_CacheHit((const Bitu*)s, (const Bitu*)render.scale.cacheRead, (Bits)render.src.start);
+        if (changed)
+            memcpy(render.scale.cacheRead, s, render.scale.cachePitch);
+    }
+    RENDER_DirectAddLine(changed ? 1 : 0);
+}
+
+/* Where the caller may draw the next source line itself, or NULL if it has to be drawn
+ * elsewhere. Either way the line is then passed to RENDER_DrawLine. */
+uint8_t *RENDER_DirectLine(void) {
+    if (RENDER_DrawLine != RENDER_DirectLineHandler || render.scale.inLine >= render.src.height)
+        return nullptr;
+    return render.scale.outWrite;
+}
+
+/* Account for a source line the caller knows to be identical to the cached copy, exactly as
+ * RENDER_StartLineHandler would on a cache hit but without handing it the line. This is only
+ * possible until the first changed line of the frame starts the scaler. In direct mode the
+ * output still holds the line from the last frame, so it is possible all the time. */
+bool RENDER_SkipLine(void) {
+    if (RENDER_DrawLine == RENDER_DirectLineHandler && !render.fullFrame && render.scale.inLine < render.src.height) {
+        RENDER_DirectAddLine(0);
+        return true;
+    }
+    if (RENDER_DrawLine != RENDER_StartLineHandler || render.fullFrame)
+        return false;
+
+    render.scale.cacheRead += render.scale.cachePitch;
+    Scaler_ChangedLines[0] += Scaler_Aspect[ render.scale.inLine ];
+    render.scale.inLine++;
+    render.scale.outLine++;
+    return true;
+}
+
+/* Put count pixels of the frame format at x,y of the composited debug overlay layer. Pixels are
+ * converted to ARGB here so the output needs no palette, and only rows that really changed are
+ * handed to the output at the end of the frame. */
+void RENDER_OverlayLine(Bitu y,Bitu x,const uint8_t *src,Bitu count) {
+    const Bitu lw = render.src.width + render.overlay.width;
+    if (render.overlay.pixels == nullptr || y >= render.src.height + render.overlay.height || x >= lw)
+        return;
+    if (count > lw - x) count = lw - x;
+
+    uint32_t *dst = render.overlay.pixels + (y * render.overlay.pitch) + x;
+    bool changed = false;
+    for (Bitu i=0;i < count;i++) {
+        uint32_t c;
+        switch (render.src.bpp) {
+            case 8:
+                c = ((uint32_t)render.pal.rgb[src[i]].red << 16u) | ((uint32_t)render.pal.rgb[src[i]].green << 8u) |
+                    (uint32_t)render.pal.rgb[src[i]].blue;
+                break;
+            case 15: {
+                const uint32_t p = ((const uint16_t*)src)[i];
+                const uint32_t r = (p >> 10u) & 0x1Fu, g = (p >> 5u) & 0x1Fu, b = p & 0x1Fu;
+                c = (((r << 3u) | (r >> 2u)) << 16u) | (((g << 3u) | (g >> 2u)) << 8u) | ((b << 3u) | (b >> 2u));
+                break; }
+            case 16: {
+                const uint32_t p = ((const uint16_t*)src)[i];
+                const uint32_t r = (p >> 11u) & 0x1Fu, g = (p >> 5u) & 0x3Fu, b = p & 0x1Fu;
+                c = (((r << 3u) | (r >> 2u)) << 16u) | (((g << 2u) | (g >> 4u)) << 8u) | ((b << 3u) | (b >> 2u));
+                break; }
+            default: {
+                const uint32_t p = ((const uint32_t*)src)[i];
+                c = (((p & GFX_Rmask) >> GFX_Rshift) << 16u) | (((p & GFX_Gmask) >> GFX_Gshift) << 8u) | ((p & GFX_Bmask) >> GFX_Bshift);
+                break; }
+        }
+        c |= 0xFF000000u;
+        if (dst[i] != c) {
+            dst[i] = c;
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        if (render.overlay.dirtyTop > y) render.overlay.dirtyTop = y;
+        if (render.overlay.dirtyBottom <= y) render.overlay.dirtyBottom = y + 1;
+    }
+}
+
+/* whether the debug overlay can be drawn as a layer by the output that is about to be used */
+static bool RENDER_CompositeOverlay(void) {
+    bool GFX_CanCompositeOverlay(void);
+    return video_debug_overlay && video_debug_composited && GFX_CanCompositeOverlay();
+}
+
+static void RENDER_ResetOverlay(void) {
+    free(render.overlay.pixels);
+    render.overlay.pixels = nullptr;
+    if (render.overlay.composited) {
+        render.overlay.pitch = render.src.width + render.overlay.width;
+        render.overlay.pixels = (uint32_t*)calloc(render.overlay.pitch * (render.src.height + render.overlay.height), sizeof(uint32_t));
+    }
+    /* the output starts without a layer after a mode set, send all of it */
+    render.overlay.dirtyTop = 0;
+    render.overlay.dirtyBottom = render.overlay.pixels ? (render.src.height + render.overlay.height) : 0;
+}
+
+/* true if lines passed to RENDER_DrawLine right now end up in the scaler source cache */
+bool RENDER_CachingLines(void) {
+    return render.updating && RENDER_DrawLine != RENDER_EmptyLineHandler;
+}
+
 extern void GFX_SetTitle(int32_t cycles, int frameskip, Bits timing, bool paused);
 
 bool RENDER_StartUpdate(void) {
@@ -326,8 +692,20 @@ bool RENDER_StartUpdate(void) {
         return false;
     if (GCC_UNLIKELY(!render.active))
         return false;
+    if (GCC_UNLIKELY(runahead_hidden))
+        return false;
+    /* loading in turbo, see DOSBOX_AutoTurboActive: only every few frames are worth drawing */
+    if (GCC_UNLIKELY(DOSBOX_AutoTurboActive())) {
+        static unsigned int autoturbo_skip = 0;
+        if (++autoturbo_skip < 8u) {
+            render_frames_skipped++;
+            return false;
+        }
+        autoturbo_skip = 0;
+    }
     if (GCC_UNLIKELY(render.frameskip.count<render.frameskip.max)) {
         render.frameskip.count++;
+        render_frames_skipped++;
         return false;
     }
     render.frameskip.count=0;
@@ -341,19 +719,30 @@ bool RENDER_StartUpdate(void) {
     render.scale.outPitch = 0;
     Scaler_ChangedLines[0] = 0;
     Scaler_ChangedLineIndex = 0;
-    if (GCC_UNLIKELY( render.scale.clearCache) ) {
+    if (render.scale.direct) {
+        if (GCC_UNLIKELY(!GFX_StartUpdate( render.scale.outWrite, render.scale.outPitch )))
+            return false;
+        RENDER_DrawLine = RENDER_DirectLineHandler;
+        render.fullFrame = render.scale.clearCache || (CaptureState & (CAPTURE_IMAGE|CAPTURE_VIDEO));
+    } else if (GCC_UNLIKELY( render.scale.clearCache) ) {
 //      LOG_MSG("Clearing cache");
         //Will always have to update the screen with this one anyway, so let's update already
         if (GCC_UNLIKELY(!GFX_StartUpdate( render.scale.outWrite, render.scale.outPitch )))
             return false;
         render.fullFrame = true;
-        RENDER_DrawLine = RENDER_ClearCacheHandler;
+        if (RENDER_UseBands())
+            RENDER_StartBands(render.scale.lineHandler, true);
+        else
+            RENDER_DrawLine = RENDER_ClearCacheHandler;
     } else {
         if (render.pal.changed) {
             /* Assume pal changes always do a full screen update anyway */
             if (GCC_UNLIKELY(!GFX_StartUpdate( render.scale.outWrite, render.scale.outPitch )))
                 return false;
-            RENDER_DrawLine = render.scale.linePalHandler;
+            if (RENDER_UseBands())
+                RENDER_StartBands(render.scale.linePalHandler, false);
+            else
+                RENDER_DrawLine = render.scale.linePalHandler;
             render.fullFrame = true;
         } else {
             RENDER_DrawLine = RENDER_StartLineHandler;
@@ -364,10 +753,12 @@ bool RENDER_StartUpdate(void) {
         }
     }
     render.updating = true;
+    if (GCC_UNLIKELY(trace_recording)) TRACE_Frame(true);
     return true;
 }
 
 static void RENDER_Halt( void ) {
+    RENDER_FinishBands(false);
     RENDER_DrawLine = RENDER_EmptyLineHandler;
     GFX_EndUpdate(nullptr);
     render.updating=false;
@@ -394,13 +785,29 @@ void RENDER_EndUpdate( bool abort ) {
     if (GCC_UNLIKELY(!render.updating))
         return;
 
+    HostTimeScope scope(HOSTTIME_RENDER);
+    const uint64_t governor_start = (CPU_GovernorMode != CPU_GOVERNOR_OFF) ? CPU_Governor_Clock() : 0;
+
     if (video_debug_overlay && !abort && render.active)
         VGA_DebugOverlay();
 
-    if (!abort && render.active && RENDER_DrawLine == RENDER_ClearCacheHandler)
+    if (render.overlay.dirtyTop < render.overlay.dirtyBottom && !abort && render.active) {
+        /* the layer changed, the output has to present even if the frame did not */
+        if (render.scale.outWrite != nullptr || GFX_StartUpdate( render.scale.outWrite, render.scale.outPitch )) {
+            GFX_SetOverlay(render.overlay.pixels, render.src.width + render.overlay.width, render.src.height + render.overlay.height,
+                render.overlay.pitch, render.overlay.dirtyTop, render.overlay.dirtyBottom);
+            render.overlay.dirtyTop = render.src.height + render.overlay.height;
+            render.overlay.dirtyBottom = 0;
+        }
+    }
+
+    if (!abort && render.active && (RENDER_DrawLine == RENDER_ClearCacheHandler ||
+        RENDER_DrawLine == RENDER_DirectLineHandler || (render_bands.active && render_bands.clearCache)))
         render.scale.clearCache = false;
 
+    RENDER_FinishBands(true);
     RENDER_DrawLine = RENDER_EmptyLineHandler;
+    if (!abort) render_frames_rendered++;
     if (GCC_UNLIKELY(CaptureState & (CAPTURE_IMAGE|CAPTURE_VIDEO))) {
         Bitu pitch, flags;
         flags = 0;
@@ -420,7 +827,14 @@ void RENDER_EndUpdate( bool abort ) {
             flags, fps, (uint8_t *)&scalerSourceCache, (uint8_t*)&render.pal.rgb );
     }
     if ( render.scale.outWrite ) {
-        GFX_EndUpdate( abort? NULL : Scaler_ChangedLines );
+        /* output lines below the frame belong to the overlay layer and never change */
+        if (render.overlay.outHeight != 0 && !abort) {
+            if ((Scaler_ChangedLineIndex & 1) && (Scaler_ChangedLineIndex + 1) < SCALER_MAXHEIGHT)
+                Scaler_ChangedLines[++Scaler_ChangedLineIndex] = 0;
+            Scaler_ChangedLines[Scaler_ChangedLineIndex] += (uint16_t)render.overlay.outHeight;
+        }
+        if (!abort) FRAMEPACE_EndUpdate();
+        GFX_EndUpdate( abort? NULL : Scaler_ChangedLines, Scaler_ChangedSpans );
         render.frameskip.hadSkip[render.frameskip.index] = 0;
     } else {
 #if 0
@@ -436,6 +850,12 @@ void RENDER_EndUpdate( bool abort ) {
     }
     render.frameskip.index = (render.frameskip.index + 1) & (RENDER_SKIP_CACHE - 1);
     render.updating=false;
+    if (GCC_UNLIKELY(trace_recording)) TRACE_Frame(false);
+
+    if (CPU_GovernorMode != CPU_GOVERNOR_OFF) {
+        CPU_Governor_Account(CPU_GOVERNOR_RENDER,governor_start);
+        CPU_Governor_FrameEnd();
+    }
 
     if (pause_on_vsync) {
         pause_on_vsync = false;
@@ -715,7 +1135,7 @@ forcenormal:
 #if !defined(C_SDL2)
 	gfx_flags=GFX_GetBestMode(gfx_flags);
 #else
-	if (sdl.desktop.want_type == SCREEN_TTF)
+	if (sdl.desktop.want_type == SCREEN_TTF || sdl.desktop.want_type == SCREEN_NULL)
 		gfx_flags = GFX_CAN_32 | GFX_SCALING;
 	else
 		gfx_flags |= GFX_RGBONLY | GFX_CAN_RANDOM;
@@ -782,9 +1202,19 @@ forcenormal:
 			height = MakeAspectTable( skip, render.src.height, (double)yscale, yscale);
 		}
 	}
+	/* a composited debug overlay takes the same room in the output as one drawn into the frame */
+	Bitu gfx_width = width, gfx_height = height;
+	render.overlay.outHeight = 0;
+	if (render.overlay.composited) {
+		gfx_width += (render.overlay.width * width) / render.src.width;
+		render.overlay.outHeight = (render.overlay.height * height) / render.src.height;
+		gfx_height += render.overlay.outHeight;
+	}
+	const Bitu shown_width = render.src.width + (render.overlay.composited ? render.overlay.width : 0);
+	const Bitu shown_height = render.src.height + (render.overlay.composited ? render.overlay.height : 0);
 	/* update the aspect ratio */
-	sdl.srcAspect.x = aspect_ratio_x>0?aspect_ratio_x:(int)(render.src.width * (render.src.dblw ? 2 : 1));
-	sdl.srcAspect.y = aspect_ratio_y>0?aspect_ratio_y:(int)floor((render.src.height * (render.src.dblh ? 2 : 1) * render.src.ratio) + 0.5);
+	sdl.srcAspect.x = aspect_ratio_x>0?aspect_ratio_x:(int)(shown_width * (render.src.dblw ? 2 : 1));
+	sdl.srcAspect.y = aspect_ratio_y>0?aspect_ratio_y:(int)floor((shown_height * (render.src.dblh ? 2 : 1) * render.src.ratio) + 0.5);
 	sdl.srcAspect.xToY = (double)sdl.srcAspect.x / sdl.srcAspect.y;
 	sdl.srcAspect.yToX = (double)sdl.srcAspect.y / sdl.srcAspect.x;
 	if(aspect_x != sdl.srcAspect.x || aspect_y != sdl.srcAspect.y) {
@@ -796,7 +1226,8 @@ forcenormal:
 #if C_OPENGL
 	GFX_SetShader(render.shader_src);
 #endif
-	gfx_flags=GFX_SetSize(width,height,gfx_flags,gfx_scalew,gfx_scaleh,&RENDER_CallBack);
+	gfx_flags=GFX_SetSize(gfx_width,gfx_height,gfx_flags,gfx_scalew,gfx_scaleh,&RENDER_CallBack);
+	RENDER_ResetOverlay();
 	if (gfx_flags & GFX_CAN_8)
 		render.scale.outMode = scalerMode8;
 	else if (gfx_flags & GFX_CAN_15)
@@ -868,6 +1299,12 @@ forcenormal:
 	render.scale.blocks = render.src.width / SCALER_BLOCKSIZE;
 	render.scale.lastBlock = render.src.width % SCALER_BLOCKSIZE;
 	render.scale.inHeight = render.src.height;
+	/* scaler none, no conversion and no aspect lines: lines can be drawn into the output */
+	render.scale.direct = (gfx_flags & GFX_CAN_DIRECT) && !complexBlock && simpleBlock == &ScaleNormal1x &&
+		xscale == 1 && height == render.src.height &&
+		render.scale.inMode == render.scale.outMode && render.scale.inMode != scalerMode8;
+	if (render.scale.direct)
+		LOG(LOG_MISC,LOG_DEBUG)("Render: drawing lines directly into the output");
 	/* Reset the palette change detection to its initial value */
 	render.pal.first= 0;
 	render.pal.last = 255;
@@ -906,7 +1343,13 @@ void RENDER_CallBack( GFX_CallBackFunctions_t function ) {
         render.scale.clearCache = true;
         return;
     } else if ( function == GFX_CallBackReset) {
+        RENDER_FinishBands(false);
         GFX_EndUpdate(nullptr);
+        /* a new output may draw the debug overlay differently, which changes the frame size */
+        if (render.overlay.composited != RENDER_CompositeOverlay() && !vga.draw.vga_override) {
+            RENDER_SetSize(vga.draw.width,vga.draw.height,render.src.bpp,render.src.fps,render.src.scrn_ratio);
+            return;
+        }
         RENDER_Reset();
     } else {
         E_Exit("Unhandled GFX_CallBackReset %d", function );
@@ -946,6 +1389,7 @@ void RENDER_SetSize(Bitu width,Bitu height,Bitu bpp,float fps,double scrn_ratio)
     /* this must be done after dblw/dblh so extra room can be added without screwing up the screen.
      * debug information is drawn into the buffer pre-scaler to make sure that if the user wants it
      * in still image or video capture, they can. */
+    const Bitu frame_width = width, frame_height = height;
     if (video_debug_overlay) {
 	if (width < 320) width = 320;
 	height += 4;
@@ -1013,6 +1457,7 @@ void RENDER_SetSize(Bitu width,Bitu height,Bitu bpp,float fps,double scrn_ratio)
 		height += 8*2;
 	}
 	height += 4;
+	if (framepace_graph) height += FRAMEPACE_GRAPH_HEIGHT + 4;
     }
 
     if ( ratio > 1.0 ) {
@@ -1021,6 +1466,14 @@ void RENDER_SetSize(Bitu width,Bitu height,Bitu bpp,float fps,double scrn_ratio)
     } else {
         //This would alter the width of the screen, we don't care about rounding errors here
     }
+    /* composited, the frame stays as it is and the output makes room for the overlay */
+    render.overlay.width = width - frame_width;
+    render.overlay.height = height - frame_height;
+    render.overlay.composited = RENDER_CompositeOverlay();
+    if (render.overlay.composited) {
+        width = frame_width;
+        height = frame_height;
+    }
     render.src.width=width;
     render.src.height=height;
     render.src.bpp=bpp;
@@ -1164,6 +1617,7 @@ void RENDER_OnSectionPropChange(Section *x) {
 
     bool p_doublescan = vga.draw.doublescan_set;
     bool p_char9 = vga.draw.char9_set;
+    bool p_indexed = vga.draw.indexed_set;
     bool p_modeswitch = vga.draw.modeswitch_set;
     int p_aspect = render.aspect;
 
@@ -1179,6 +1633,7 @@ void RENDER_OnSectionPropChange(Section *x) {
 
     vga.draw.doublescan_set=section->Get_bool("doublescan");
     vga.draw.char9_set=section->Get_bool("char9");
+    vga.draw.indexed_set=section->Get_bool("indexed color");
     
 #if C_SDL2
 	vga.draw.modeswitch_set=section->Get_bool("modeswitch");
@@ -1188,7 +1643,7 @@ void RENDER_OnSectionPropChange(Section *x) {
 		vga.draw.char9_set != p_char9 || vga.draw.modeswitch_set != p_modeswitch)
         RENDER_CallBack(GFX_CallBackReset);
     if (vga.draw.doublescan_set != p_doublescan || vga.draw.char9_set != p_char9 || \
-		vga.draw.modeswitch_set != p_modeswitch)
+		vga.draw.modeswitch_set != p_modeswitch || vga.draw.indexed_set != p_indexed)
         VGA_StartResize();
 
     mainMenu.get_item("vga_9widetext").check(vga.draw.char9_set).refresh_item(mainMenu);
@@ -1373,11 +1828,16 @@ void RENDER_Init() {
 
     vga.draw.doublescan_set=section->Get_bool("doublescan");
     vga.draw.char9_set=section->Get_bool("char9");
+    vga.draw.indexed_set=section->Get_bool("indexed color");
 
 #if C_SDL2
 	vga.draw.modeswitch_set=section->Get_bool("modeswitch");
 #endif
 
+	RENDER_SelectCacheHit();
+	RENDER_StartScalerBands(section->Get_bool("threaded scaler"));
+	AddExitFunction(AddExitFunctionFuncPair(RENDER_ShutDownScalerBands));
+
 	eurAscii = section->Get_int("euro");
 	if (eurAscii != -1 && (eurAscii < 33 || eurAscii > 255)) {
 		LOG_MSG("Euro ASCII value has to be between 33 and 255\n");
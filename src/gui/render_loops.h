@@ -49,6 +49,8 @@ lastagain:
 	const PTYPE * fc = &FC[render.scale.outLine][1];
 	PTYPE * line0=(PTYPE *)(render.scale.outWrite);
 	uint8_t * changed = &CC[render.scale.outLine][1];
+	/* first and last block that was scaled */
+	Bitu changeFirst = render.scale.blocks, changeLast = 0;
 	Bitu b;
 	for (b=0;b<render.scale.blocks;b++) {
 #if (SCALERHEIGHT > 1) 
@@ -194,6 +196,8 @@ lastagain:
 #endif //defined(SCALERLINEAR)
 			break;
 		}
+		if (changeFirst > b) changeFirst = b;
+		changeLast = b;
 	}
 #if defined(SCALERLINEAR) 
 	Bitu scaleLines = SCALERHEIGHT;
@@ -205,7 +209,10 @@ lastagain:
 			render.src.width * SCALERWIDTH * PSIZE);
 	}
 #endif
-	ScalerAddLines( 1, scaleLines );
+	if (changeFirst > changeLast)
+		ScalerAddLines( 1, scaleLines, 0, 0 );
+	else
+		ScalerAddLines( 1, scaleLines, changeFirst * SCALER_BLOCKSIZE * SCALERWIDTH, (changeLast + 1) * SCALER_BLOCKSIZE * SCALERWIDTH );
 	if (++render.scale.outLine == render.scale.inHeight)
 		goto lastagain;
 }
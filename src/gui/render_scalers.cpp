@@ -23,23 +23,42 @@
 
 #include "dosbox.h"
 #include "render.h"
+#include "render_simd.h"
 #include <string.h>
 
 uint8_t Scaler_Aspect[SCALER_MAXHEIGHT];
 uint16_t Scaler_ChangedLines[SCALER_MAXHEIGHT];
+GFX_ChangedSpan Scaler_ChangedSpans[SCALER_MAXHEIGHT];
 Bitu Scaler_ChangedLineIndex;
 
-static union {
+typedef union {
 	uint32_t b32 [4][SCALER_MAXWIDTH*3];
 	uint16_t b16 [4][SCALER_MAXWIDTH*3];
 	uint8_t b8 [4][SCALER_MAXWIDTH*3];
-} scalerWriteCache;
+} scalerWriteCache_t;
+static scalerWriteCache_t scalerWriteCache;
 //scalerFrameCache_t scalerFrameCache;
 scalerSourceCache_t scalerSourceCache;
 #if RENDER_USE_ADVANCED_SCALERS>1
 scalerChangeCache_t scalerChangeCache;
 #endif
 
+/* The scalers below keep their position in render.scale, collect changed lines in
+ * Scaler_ChangedLines (and the columns they touched in Scaler_ChangedSpans) and stage output in scalerWriteCache. On the emulation thread these
+ * are the globals; a worker of the threaded scaler points them at its own copies for the
+ * band it works on, see RENDER_ScaleBand. */
+static thread_local Render_t *scaler_render = &render;
+static thread_local uint16_t *scaler_changed_lines = Scaler_ChangedLines;
+static thread_local Bitu *scaler_changed_index = &Scaler_ChangedLineIndex;
+static thread_local GFX_ChangedSpan *scaler_changed_spans = Scaler_ChangedSpans;
+static thread_local scalerWriteCache_t *scaler_write_cache = &scalerWriteCache;
+
+#define render					(*scaler_render)
+#define Scaler_ChangedLines		scaler_changed_lines
+#define Scaler_ChangedLineIndex	(*scaler_changed_index)
+#define Scaler_ChangedSpans		scaler_changed_spans
+#define scalerWriteCache		(*scaler_write_cache)
+
 #define _conc2(A,B) A ## B
 #define _conc3(A,B,C) A ## B ## C
 #define _conc4(A,B,C,D) A ## B ## C ## D
@@ -61,11 +80,25 @@ static INLINE void BituMove( void *_dst, const void * _src, Bitu size) {
 		dst[x] = src[x];
 }
 
-static INLINE void ScalerAddLines( Bitu changed, Bitu count ) {
+/* left and right are the output columns a changed line touched, the span of the run is
+ * the union over its lines. left == right means none. */
+static INLINE void ScalerAddLines( Bitu changed, Bitu count, Bitu left = 0, Bitu right = SCALER_SPAN_FULL ) {
 	if ((Scaler_ChangedLineIndex & 1) == changed ) {
 		Scaler_ChangedLines[Scaler_ChangedLineIndex] += (uint16_t)count;
+		if (changed && left < right) {
+			GFX_ChangedSpan &span = Scaler_ChangedSpans[Scaler_ChangedLineIndex];
+			if (span.left >= span.right) {
+				span.left = (uint16_t)left;
+				span.right = (uint16_t)right;
+			} else {
+				if (span.left > left) span.left = (uint16_t)left;
+				if (span.right < right) span.right = (uint16_t)right;
+			}
+		}
 	} else {
 		Scaler_ChangedLines[++Scaler_ChangedLineIndex] = (uint16_t)count;
+		Scaler_ChangedSpans[Scaler_ChangedLineIndex].left = (uint16_t)left;
+		Scaler_ChangedSpans[Scaler_ChangedLineIndex].right = (uint16_t)right;
 	}
 	render.scale.outWrite += render.scale.outPitch * count;
 }
@@ -640,3 +673,48 @@ ScalerComplexBlock_t ScaleAdvInterp3x = {
 };
 
 #endif
+
+#undef render
+#undef Scaler_ChangedLines
+#undef Scaler_ChangedLineIndex
+#undef Scaler_ChangedSpans
+#undef scalerWriteCache
+
+/* Scale one band of the threaded scaler on the calling thread. frame is the render state
+ * at the start of the band; the band brings its own source, cache and output position and
+ * gets back the changed lines it produced, in the Scaler_ChangedLines format, and their spans. */
+void RENDER_ScaleBand(const Render_t &frame,ScalerBand_t &band) {
+	static thread_local scalerWriteCache_t *band_write_cache = nullptr;
+	if (band_write_cache == nullptr)
+		band_write_cache = new scalerWriteCache_t;
+
+	Render_t state = frame;
+	state.scale.cacheRead = band.cacheRead;
+	state.scale.outWrite = band.outWrite;
+	state.scale.outLine = band.outLine;
+	band.changed[0] = 0;
+	band.changedIndex = 0;
+
+	scaler_render = &state;
+	scaler_changed_lines = band.changed;
+	scaler_changed_index = &band.changedIndex;
+	scaler_changed_spans = band.spans;
+	scaler_write_cache = band_write_cache;
+
+	for (Bitu i=0;i<band.lines;i++) {
+		if (band.clearCache && band.line[i] != nullptr) {
+			/* same as RENDER_ClearCacheHandler */
+			const uint32_t *srcLine = (const uint32_t *)band.line[i];
+			uint32_t *cacheLine = (uint32_t *)state.scale.cacheRead;
+			for (Bitu x=0;x<state.scale.cachePitch/4;x++)
+				cacheLine[x] = ~srcLine[x];
+		}
+		band.handler(band.line[i]);
+	}
+
+	scaler_render = &render;
+	scaler_changed_lines = Scaler_ChangedLines;
+	scaler_changed_index = &Scaler_ChangedLineIndex;
+	scaler_changed_spans = Scaler_ChangedSpans;
+	scaler_write_cache = &scalerWriteCache;
+}
@@ -67,6 +67,7 @@ extern uint8_t Scaler_Aspect[];
 extern uint8_t diff_table[];
 extern Bitu Scaler_ChangedLineIndex;
 extern uint16_t Scaler_ChangedLines[];
+extern GFX_ChangedSpan Scaler_ChangedSpans[];
 #if RENDER_USE_ADVANCED_SCALERS>1
 /* Not entirely happy about those +2's since they make a non power of 2, with muls instead of shift */
 typedef uint8_t scalerChangeCache_t [SCALER_COMPLEXHEIGHT][SCALER_COMPLEXWIDTH / SCALER_BLOCKSIZE] ;
@@ -104,10 +105,29 @@ typedef struct {
 } ScalerSimpleBlock_t;
 
 
+/* A band of source lines for the threaded scaler, see render.cpp */
+#define SCALER_BANDLINES	32
+
+typedef struct {
+	ScalerLineHandler_t handler;
+	bool clearCache;
+	Bitu lines;
+	const void *line[SCALER_BANDLINES];
+	uint8_t *cacheRead;
+	uint8_t *outWrite;
+	Bitu outLine;
+	Bitu changedIndex;
+	uint16_t changed[SCALER_BANDLINES+1];
+	GFX_ChangedSpan spans[SCALER_BANDLINES+1];
+} ScalerBand_t;
+
 #define SCALE_LEFT	0x1
 #define SCALE_RIGHT	0x2
 #define SCALE_FULL	0x4
 
+/* Span of a changed run when the scaler does not know which columns it touched */
+#define SCALER_SPAN_FULL	0xffff
+
 /* Simple scalers */
 extern ScalerSimpleBlock_t ScaleNormal1x;
 extern ScalerSimpleBlock_t ScaleNormalDw;
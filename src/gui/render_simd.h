@@ -0,0 +1,274 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_RENDER_SIMD_H
+#define DOSBOX_RENDER_SIMD_H
+
+/* SIMD row kernels for the common simple scalers. render_templates.h only uses them where a
+ * source pixel goes out unchanged (SBPP == DBPP, 15/16/32bpp, see SCALER_SIMD_DIRECT). A
+ * kernel copies the source pixels of a changed block to the cache, writes the output lines
+ * and returns how many source pixels it did; render_simple.h does the rest one at a time.
+ * x86 picks AVX2 or SSE2 at runtime like cacheHit_AVX2 in render.cpp, ARM uses NEON when
+ * the compiler targets it. */
+
+enum {
+	SCALER_SIMD_DW = 0,		/* one output line */
+	SCALER_SIMD_COPY,		/* second line is a copy of the first */
+	SCALER_SIMD_HALF,		/* second line at half brightness (tv) */
+	SCALER_SIMD_BLACK		/* second line black (scan) */
+};
+
+#if defined(_M_AMD64) || defined(__amd64__) || defined(__e2k__)
+# define SCALER_SIMD_X86 1
+extern bool avx2_available;
+# define scaler_sse2_available (1)
+# define scaler_avx2_available (avx2_available)
+#elif defined(__SSE__)
+# define SCALER_SIMD_X86 1
+# ifdef __AVX2__
+#  define scaler_sse2_available (1)
+#  define scaler_avx2_available (1)
+# else
+extern bool sse2_available;
+extern bool avx2_available;
+#  define scaler_sse2_available (sse2_available)
+#  define scaler_avx2_available (avx2_available)
+# endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# define SCALER_SIMD_NEON 1
+#endif
+
+/* Emscripten builds with -msimd128 -msse2 get the SSE2 kernels translated to WebAssembly
+ * SIMD128, which has no 256-bit counterpart */
+#if defined(SCALER_SIMD_X86) && !defined(C_EMSCRIPTEN)
+# define SCALER_SIMD_AVX2 1
+#endif
+
+#if defined(SCALER_SIMD_X86)
+#include <immintrin.h>
+
+template <typename T, unsigned int mode>
+static inline unsigned int ScalerSIMD_2x_SSE2(const T *src, T *cache, T *line0, T *line1, unsigned int count, T rbMask, T gMask) {
+	const unsigned int step = 16 / sizeof(T);
+	const __m128i rb = sizeof(T) == 2 ? _mm_set1_epi16((short)rbMask) : _mm_set1_epi32((int)rbMask);
+	const __m128i g = sizeof(T) == 2 ? _mm_set1_epi16((short)gMask) : _mm_set1_epi32((int)gMask);
+	unsigned int done = 0;
+
+	for (;(done + step) <= count;done += step) {
+		const __m128i v = _mm_loadu_si128((const __m128i*)(src + done));
+		_mm_storeu_si128((__m128i*)(cache + done), v);
+
+		__m128i lo = sizeof(T) == 2 ? _mm_unpacklo_epi16(v, v) : _mm_unpacklo_epi32(v, v);
+		__m128i hi = sizeof(T) == 2 ? _mm_unpackhi_epi16(v, v) : _mm_unpackhi_epi32(v, v);
+		_mm_storeu_si128((__m128i*)(line0 + done * 2), lo);
+		_mm_storeu_si128((__m128i*)(line0 + done * 2 + step), hi);
+		if (mode == SCALER_SIMD_DW) continue;
+
+		if (mode == SCALER_SIMD_HALF) {
+			const __m128i lrb = _mm_and_si128(lo, rb), lg = _mm_and_si128(lo, g);
+			const __m128i hrb = _mm_and_si128(hi, rb), hg = _mm_and_si128(hi, g);
+			if (sizeof(T) == 2) {
+				lo = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(lrb, 1), rb), _mm_and_si128(_mm_srli_epi16(lg, 1), g));
+				hi = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(hrb, 1), rb), _mm_and_si128(_mm_srli_epi16(hg, 1), g));
+			} else {
+				lo = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(lrb, 1), rb), _mm_and_si128(_mm_srli_epi32(lg, 1), g));
+				hi = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(hrb, 1), rb), _mm_and_si128(_mm_srli_epi32(hg, 1), g));
+			}
+		} else if (mode == SCALER_SIMD_BLACK) {
+			lo = hi = _mm_setzero_si128();
+		}
+		_mm_storeu_si128((__m128i*)(line1 + done * 2), lo);
+		_mm_storeu_si128((__m128i*)(line1 + done * 2 + step), hi);
+	}
+	return done;
+}
+
+/* 256-bit unpack works within 128-bit lanes, so the quadwords are put in 0,2,1,3 order first */
+#if defined(SCALER_SIMD_AVX2)
+template <typename T, unsigned int mode>
+#ifdef __GNUC__
+__attribute__((__target__("avx2")))
+#endif
+static inline unsigned int ScalerSIMD_2x_AVX2(const T *src, T *cache, T *line0, T *line1, unsigned int count, T rbMask, T gMask) {
+	const unsigned int step = 32 / sizeof(T);
+	const __m256i rb = sizeof(T) == 2 ? _mm256_set1_epi16((short)rbMask) : _mm256_set1_epi32((int)rbMask);
+	const __m256i g = sizeof(T) == 2 ? _mm256_set1_epi16((short)gMask) : _mm256_set1_epi32((int)gMask);
+	unsigned int done = 0;
+
+	for (;(done + step) <= count;done += step) {
+		const __m256i v = _mm256_loadu_si256((const __m256i*)(src + done));
+		_mm256_storeu_si256((__m256i*)(cache + done), v);
+
+		const __m256i p = _mm256_permute4x64_epi64(v, 0xD8);
+		__m256i lo = sizeof(T) == 2 ? _mm256_unpacklo_epi16(p, p) : _mm256_unpacklo_epi32(p, p);
+		__m256i hi = sizeof(T) == 2 ? _mm256_unpackhi_epi16(p, p) : _mm256_unpackhi_epi32(p, p);
+		_mm256_storeu_si256((__m256i*)(line0 + done * 2), lo);
+		_mm256_storeu_si256((__m256i*)(line0 + done * 2 + step), hi);
+		if (mode == SCALER_SIMD_DW) continue;
+
+		if (mode == SCALER_SIMD_HALF) {
+			const __m256i lrb = _mm256_and_si256(lo, rb), lg = _mm256_and_si256(lo, g);
+			const __m256i hrb = _mm256_and_si256(hi, rb), hg = _mm256_and_si256(hi, g);
+			if (sizeof(T) == 2) {
+				lo = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(lrb, 1), rb), _mm256_and_si256(_mm256_srli_epi16(lg, 1), g));
+				hi = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(hrb, 1), rb), _mm256_and_si256(_mm256_srli_epi16(hg, 1), g));
+			} else {
+				lo = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(lrb, 1), rb), _mm256_and_si256(_mm256_srli_epi32(lg, 1), g));
+				hi = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(hrb, 1), rb), _mm256_and_si256(_mm256_srli_epi32(hg, 1), g));
+			}
+		} else if (mode == SCALER_SIMD_BLACK) {
+			lo = hi = _mm256_setzero_si256();
+		}
+		_mm256_storeu_si256((__m256i*)(line1 + done * 2), lo);
+		_mm256_storeu_si256((__m256i*)(line1 + done * 2 + step), hi);
+	}
+	return done;
+}
+#endif
+
+static inline unsigned int ScalerSIMD_3x_SSE2(const uint32_t *src, uint32_t *cache, uint32_t *line0, uint32_t *line1, uint32_t *line2, unsigned int count) {
+	unsigned int done = 0;
+
+	for (;(done + 4) <= count;done += 4) {
+		const __m128i v = _mm_loadu_si128((const __m128i*)(src + done));
+		_mm_storeu_si128((__m128i*)(cache + done), v);
+
+		const __m128i a = _mm_shuffle_epi32(v, _MM_SHUFFLE(1,0,0,0));
+		const __m128i b = _mm_shuffle_epi32(v, _MM_SHUFFLE(2,2,1,1));
+		const __m128i c = _mm_shuffle_epi32(v, _MM_SHUFFLE(3,3,3,2));
+		uint32_t *lines[3] = { line0, line1, line2 };
+		for (unsigned int l=0;l < 3;l++) {
+			_mm_storeu_si128((__m128i*)(lines[l] + done * 3), a);
+			_mm_storeu_si128((__m128i*)(lines[l] + done * 3 + 4), b);
+			_mm_storeu_si128((__m128i*)(lines[l] + done * 3 + 8), c);
+		}
+	}
+	return done;
+}
+#endif // SCALER_SIMD_X86
+
+#if defined(SCALER_SIMD_NEON)
+#include <arm_neon.h>
+
+/* vst2/vst3 interleave their registers, which with the same register twice or three times
+ * is exactly the horizontal pixel doubling or tripling */
+static inline unsigned int ScalerSIMD_2x_NEON(const uint16_t *src, uint16_t *cache, uint16_t *line0, uint16_t *line1, unsigned int count, const unsigned int mode, uint16_t rbMask, uint16_t gMask) {
+	const uint16x8_t rb = vdupq_n_u16(rbMask), g = vdupq_n_u16(gMask);
+	unsigned int done = 0;
+
+	for (;(done + 8) <= count;done += 8) {
+		const uint16x8_t v = vld1q_u16(src + done);
+		vst1q_u16(cache + done, v);
+
+		uint16x8x2_t d = {{ v, v }};
+		vst2q_u16(line0 + done * 2, d);
+		if (mode == SCALER_SIMD_DW) continue;
+
+		if (mode == SCALER_SIMD_HALF)
+			d.val[0] = d.val[1] = vorrq_u16(vandq_u16(vshrq_n_u16(vandq_u16(v, rb), 1), rb), vandq_u16(vshrq_n_u16(vandq_u16(v, g), 1), g));
+		else if (mode == SCALER_SIMD_BLACK)
+			d.val[0] = d.val[1] = vdupq_n_u16(0);
+		vst2q_u16(line1 + done * 2, d);
+	}
+	return done;
+}
+
+static inline unsigned int ScalerSIMD_2x_NEON(const uint32_t *src, uint32_t *cache, uint32_t *line0, uint32_t *line1, unsigned int count, const unsigned int mode, uint32_t rbMask, uint32_t gMask) {
+	const uint32x4_t rb = vdupq_n_u32(rbMask), g = vdupq_n_u32(gMask);
+	unsigned int done = 0;
+
+	for (;(done + 4) <= count;done += 4) {
+		const uint32x4_t v = vld1q_u32(src + done);
+		vst1q_u32(cache + done, v);
+
+		uint32x4x2_t d = {{ v, v }};
+		vst2q_u32(line0 + done * 2, d);
+		if (mode == SCALER_SIMD_DW) continue;
+
+		if (mode == SCALER_SIMD_HALF)
+			d.val[0] = d.val[1] = vorrq_u32(vandq_u32(vshrq_n_u32(vandq_u32(v, rb), 1), rb), vandq_u32(vshrq_n_u32(vandq_u32(v, g), 1), g));
+		else if (mode == SCALER_SIMD_BLACK)
+			d.val[0] = d.val[1] = vdupq_n_u32(0);
+		vst2q_u32(line1 + done * 2, d);
+	}
+	return done;
+}
+
+static inline unsigned int ScalerSIMD_3x_NEON(const uint16_t *src, uint16_t *cache, uint16_t *line0, uint16_t *line1, uint16_t *line2, unsigned int count) {
+	unsigned int done = 0;
+
+	for (;(done + 8) <= count;done += 8) {
+		const uint16x8_t v = vld1q_u16(src + done);
+		vst1q_u16(cache + done, v);
+
+		const uint16x8x3_t d = {{ v, v, v }};
+		vst3q_u16(line0 + done * 3, d);
+		vst3q_u16(line1 + done * 3, d);
+		vst3q_u16(line2 + done * 3, d);
+	}
+	return done;
+}
+
+static inline unsigned int ScalerSIMD_3x_NEON(const uint32_t *src, uint32_t *cache, uint32_t *line0, uint32_t *line1, uint32_t *line2, unsigned int count) {
+	unsigned int done = 0;
+
+	for (;(done + 4) <= count;done += 4) {
+		const uint32x4_t v = vld1q_u32(src + done);
+		vst1q_u32(cache + done, v);
+
+		const uint32x4x3_t d = {{ v, v, v }};
+		vst3q_u32(line0 + done * 3, d);
+		vst3q_u32(line1 + done * 3, d);
+		vst3q_u32(line2 + done * 3, d);
+	}
+	return done;
+}
+#endif // SCALER_SIMD_NEON
+
+/* Horizontal doubling, with the second line (if any) as given by mode */
+template <typename T, unsigned int mode>
+static inline unsigned int ScalerSIMD_2x(const T *src, T *cache, T *line0, T *line1, unsigned int count, T rbMask = 0, T gMask = 0) {
+#if defined(SCALER_SIMD_X86)
+#if defined(SCALER_SIMD_AVX2)
+	if (scaler_avx2_available)
+		return ScalerSIMD_2x_AVX2<T,mode>(src, cache, line0, line1, count, rbMask, gMask);
+#endif
+	if (scaler_sse2_available)
+		return ScalerSIMD_2x_SSE2<T,mode>(src, cache, line0, line1, count, rbMask, gMask);
+#elif defined(SCALER_SIMD_NEON)
+	return ScalerSIMD_2x_NEON(src, cache, line0, line1, count, mode, rbMask, gMask);
+#endif
+	(void)src; (void)cache; (void)line0; (void)line1; (void)count; (void)rbMask; (void)gMask;
+	return 0;
+}
+
+/* Horizontal tripling into three identical lines. There is no SSE2 version for 16bpp, that
+ * would take more shuffling than it saves. */
+template <typename T>
+static inline unsigned int ScalerSIMD_3x(const T *src, T *cache, T *line0, T *line1, T *line2, unsigned int count) {
+#if defined(SCALER_SIMD_X86)
+	if (sizeof(T) == 4 && scaler_sse2_available)
+		return ScalerSIMD_3x_SSE2((const uint32_t*)src, (uint32_t*)cache, (uint32_t*)line0, (uint32_t*)line1, (uint32_t*)line2, count);
+#elif defined(SCALER_SIMD_NEON)
+	return ScalerSIMD_3x_NEON(src, cache, line0, line1, line2, count);
+#endif
+	(void)src; (void)cache; (void)line0; (void)line1; (void)line2; (void)count;
+	return 0;
+}
+
+#endif
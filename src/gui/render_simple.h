@@ -83,6 +83,26 @@ static inline void conc4d_sub_func(const SRCTYPE* &src, SRCTYPE* &cache, PTYPE*
 #endif //defined(SCALERLINEAR)
 			hadChange = 1;
             unsigned int i = block_proc; /* WARNING: assume block_proc != 0 */
+#if defined(SCALERSIMD)
+# if (SCALERHEIGHT > 2)
+            const unsigned int simd = SCALERSIMD(src,cache,line0,line1,line2,block_proc);
+# elif (SCALERHEIGHT > 1)
+            const unsigned int simd = SCALERSIMD(src,cache,line0,line1,nullptr,block_proc);
+# else
+            const unsigned int simd = SCALERSIMD(src,cache,line0,nullptr,nullptr,block_proc);
+# endif
+            src   += simd;
+            cache += simd;
+            line0 += simd*SCALERWIDTH;
+# if (SCALERHEIGHT > 1)
+            line1 += simd*SCALERWIDTH;
+# endif
+# if (SCALERHEIGHT > 2)
+            line2 += simd*SCALERWIDTH;
+# endif
+            i -= simd;
+            if (i != 0u)
+#endif
             do {
 				const SRCTYPE S = *src++;
 				*cache++ = S;
@@ -141,6 +161,8 @@ static inline void conc4d_func(const void *s) {
 #endif
 	/* Clear the complete line marker */
 	Bitu hadChange = 0;
+	/* source columns of the first and past the last changed block */
+	Bitu changeLeft = 0, changeRight = (Bitu)render.src.width;
 	const SRCTYPE *src = (SRCTYPE*)s;
 
 	SRCTYPE *cache = (SRCTYPE*)(render.scale.cacheRead);
@@ -160,11 +182,23 @@ static inline void conc4d_func(const void *s) {
 
     Bitu x = (Bitu)render.src.width;
     while (x >= block_size) {
+        Bitu blockChange = 0;
+        conc4d_sub_func(src,cache,line0,block_size,blockChange);
         x -= block_size;
-        conc4d_sub_func(src,cache,line0,block_size,hadChange);
+        if (blockChange) {
+            if (!hadChange) changeLeft = (Bitu)render.src.width - x - block_size;
+            changeRight = (Bitu)render.src.width - x;
+            hadChange = 1;
+        }
     }
     if (x > 0) {
-        conc4d_sub_func(src,cache,line0,(unsigned int)x,hadChange);
+        Bitu blockChange = 0;
+        conc4d_sub_func(src,cache,line0,(unsigned int)x,blockChange);
+        if (blockChange) {
+            if (!hadChange) changeLeft = (Bitu)render.src.width - x;
+            changeRight = (Bitu)render.src.width;
+            hadChange = 1;
+        }
 	}
 #endif
 
@@ -178,7 +212,7 @@ static inline void conc4d_func(const void *s) {
 			render.src.width * SCALERWIDTH * PSIZE);
 	}
 #endif
-	ScalerAddLines( hadChange, scaleLines );
+	ScalerAddLines( hadChange, scaleLines, changeLeft * SCALERWIDTH, changeRight * SCALERWIDTH );
 }
 
 #if !defined(SCALERLINEAR) 
@@ -92,6 +92,11 @@
 
 #define redblueMask (redMask | blueMask)
 
+/* the render_simd.h kernels apply when source pixels go out unchanged */
+#if (SBPP == DBPP) && (DBPP == 15 || DBPP == 16 || DBPP == 32) && !defined(WORDS_BIGENDIAN)
+#define SCALER_SIMD_DIRECT
+#endif
+
 
 #if SBPP == 8 || SBPP == 9
 #define SC scalerSourceCache.b8
@@ -288,7 +293,11 @@ static inline void conc3d(Cache,SBPP,DBPP) (const void * s) {
 	line0[1] = P;								\
 	line1[0] = P;								\
 	line1[1] = P;
+#if defined(SCALER_SIMD_DIRECT)
+#define SCALERSIMD(_S,_C,_L0,_L1,_L2,_N) ScalerSIMD_2x<PTYPE,SCALER_SIMD_COPY>(_S,_C,_L0,_L1,_N)
+#endif
 #include "render_simple.h"
+#undef SCALERSIMD
 #undef SCALERNAME
 #undef SCALERWIDTH
 #undef SCALERHEIGHT
@@ -307,7 +316,11 @@ static inline void conc3d(Cache,SBPP,DBPP) (const void * s) {
 	line2[0] = P;								\
 	line2[1] = P;								\
 	line2[2] = P;
+#if defined(SCALER_SIMD_DIRECT)
+#define SCALERSIMD(_S,_C,_L0,_L1,_L2,_N) ScalerSIMD_3x<PTYPE>(_S,_C,_L0,_L1,_L2,_N)
+#endif
 #include "render_simple.h"
+#undef SCALERSIMD
 #undef SCALERNAME
 #undef SCALERWIDTH
 #undef SCALERHEIGHT
@@ -426,7 +439,11 @@ static inline void conc3d(Cache,SBPP,DBPP) (const void * s) {
 #define SCALERFUNC								\
 	line0[0] = P;								\
 	line0[1] = P;
+#if defined(SCALER_SIMD_DIRECT)
+#define SCALERSIMD(_S,_C,_L0,_L1,_L2,_N) ScalerSIMD_2x<PTYPE,SCALER_SIMD_DW>(_S,_C,_L0,nullptr,_N)
+#endif
 #include "render_simple.h"
+#undef SCALERSIMD
 #undef SCALERNAME
 #undef SCALERWIDTH
 #undef SCALERHEIGHT
@@ -496,7 +513,11 @@ static inline void conc3d(Cache,SBPP,DBPP) (const void * s) {
 	line1[0]=halfpixel;						\
 	line1[1]=halfpixel;						\
 }
+#if defined(SCALER_SIMD_DIRECT)
+#define SCALERSIMD(_S,_C,_L0,_L1,_L2,_N) ScalerSIMD_2x<PTYPE,SCALER_SIMD_HALF>(_S,_C,_L0,_L1,_N,(PTYPE)redblueMask,(PTYPE)greenMask)
+#endif
 #include "render_simple.h"
+#undef SCALERSIMD
 #undef SCALERNAME
 #undef SCALERWIDTH
 #undef SCALERHEIGHT
@@ -603,7 +624,11 @@ static inline void conc3d(Cache,SBPP,DBPP) (const void * s) {
 	line0[1]=P;							\
 	line1[0]=0;							\
 	line1[1]=0;
+#if defined(SCALER_SIMD_DIRECT)
+#define SCALERSIMD(_S,_C,_L0,_L1,_L2,_N) ScalerSIMD_2x<PTYPE,SCALER_SIMD_BLACK>(_S,_C,_L0,_L1,_N)
+#endif
 #include "render_simple.h"
+#undef SCALERSIMD
 #undef SCALERNAME
 #undef SCALERWIDTH
 #undef SCALERHEIGHT
@@ -881,3 +906,4 @@ static inline void conc3d(Cache,SBPP,DBPP) (const void * s) {
 #undef greenShift
 #undef blueShift
 #undef SRCTYPE
+#undef SCALER_SIMD_DIRECT
@@ -222,6 +222,10 @@ int                                             joy2axes[8];
 static std::vector<CEvent *>                    events;
 static std::vector<CButton *>                   buttons;
 static std::vector<CBindGroup *>                bindgroups;
+/* dispatch tables built from bindgroups, so MAPPER_CheckEvent() hands an event straight to
+ * the groups that act on it instead of offering it to every group in turn */
+static std::vector<CBindGroup *>                keybindgroups;
+static std::vector< std::vector<CBindGroup *> > stickbindgroups; /* indexed by SDL joystick number */
 static std::vector<CHandlerEvent *>             handlergroup;
 
 static CModEvent*                               mod_event[8] = {NULL};
@@ -710,6 +714,10 @@ public:
     virtual const char * ConfigStart(void)=0;
     virtual const char * BindStart(void)=0;
 
+    /* which events CheckEvent() acts on, for the dispatch tables */
+    virtual bool WantsKeyEvents(void) const { return false; }
+    virtual int WantsStickEvents(void) const { return -1; } /* SDL joystick number, or -1 for none */
+
 protected:
 
 };
@@ -1550,6 +1558,7 @@ public:
         configname="key";
     }
     virtual ~CKeyBindGroup() { delete[] lists; }
+    bool WantsKeyEvents(void) const override { return true; }
     CBind * CreateConfigBind(char *& buf) override {
         if (strncasecmp(buf,configname,strlen(configname))) return nullptr;
         StripWord(buf);char * num=StripWord(buf);
@@ -1882,6 +1891,7 @@ public:
         if (button_lists != NULL) delete[] button_lists;
         if (hat_lists != NULL) delete[] hat_lists;
     }
+    int WantsStickEvents(void) const override { return (int)stick; }
 
     CBind * CreateConfigBind(char *& buf) override {
         if (is_dummy) return nullptr;
@@ -4897,8 +4907,35 @@ static bool MAPPER_LoadBinds(void) {
 }
 
 void MAPPER_CheckEvent(SDL_Event * event) {
-    for (CBindGroup_it it=bindgroups.begin();it!=bindgroups.end();++it) {
-        if ((*it)->CheckEvent(event)) return;
+    const std::vector<CBindGroup *> *groups = NULL;
+    int which = -1;
+
+    switch (event->type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            groups = &keybindgroups;
+            break;
+        case SDL_JOYAXISMOTION:
+            which = (int)event->jaxis.which;
+            break;
+        case SDL_JOYBUTTONDOWN:
+        case SDL_JOYBUTTONUP:
+            which = (int)event->jbutton.which;
+            break;
+        case SDL_JOYHATMOTION:
+            which = (int)event->jhat.which;
+            break;
+        default:
+            break;
+    }
+
+    if (which >= 0 && (size_t)which < stickbindgroups.size())
+        groups = &stickbindgroups[(size_t)which];
+
+    if (groups != NULL) {
+        for (auto &group : *groups) {
+            if (group->CheckEvent(event)) return;
+        }
     }
 
     if (log_keyboard_scan_codes) {
@@ -5226,6 +5263,24 @@ static void InitializeJoysticks(void) {
     }
 }
 
+static void RebuildBindGroupDispatch(void) {
+    keybindgroups.clear();
+    stickbindgroups.clear();
+
+    for (auto &group : bindgroups) {
+        if (group == NULL) continue;
+        if (group->WantsKeyEvents())
+            keybindgroups.push_back(group);
+
+        const int stick = group->WantsStickEvents();
+        if (stick >= 0) {
+            if ((size_t)stick >= stickbindgroups.size())
+                stickbindgroups.resize((size_t)stick + 1u);
+            stickbindgroups[(size_t)stick].push_back(group);
+        }
+    }
+}
+
 static void CreateBindGroups(void) {
     bindgroups.clear();
 #if defined(C_SDL2)
@@ -5660,7 +5715,10 @@ void MAPPER_Init(void) {
     MAPPER_CheckKeyboardLayout();
     if (initjoy) InitializeJoysticks();
     if (buttons.empty()) CreateLayout();
-    if (bindgroups.empty()) CreateBindGroups();
+    if (bindgroups.empty()) {
+        CreateBindGroups();
+        RebuildBindGroupDispatch();
+    }
     if (!MAPPER_LoadBinds()) CreateDefaultBinds();
     for (CButton_it but_it = buttons.begin(); but_it != buttons.end(); ++but_it) {
         (*but_it)->BindColor();
@@ -5999,6 +6057,7 @@ void MAPPER_Shutdown() {
         }
     }
     bindgroups.clear();
+    RebuildBindGroupDispatch();
 
     for (size_t i=0;i < handlergroup.size();i++) {
         if (handlergroup[i] != NULL) {
@@ -110,6 +110,7 @@ char* revert_escape_newlines(const char* aMessage);
 #include <stdarg.h>
 #include <sys/types.h>
 #include <algorithm> // std::transform
+#include <chrono>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <gtest/gtest.h>
@@ -132,6 +133,9 @@ char* revert_escape_newlines(const char* aMessage);
 #include "callback.h"
 #include "support.h"
 #include "debug.h"
+#include "cpulog.h"
+#include "perfreport.h"
+#include "startupprof.h"
 #include "ide.h"
 #include "bitop.h"
 #include "ptrop.h"
@@ -169,6 +173,7 @@ char* revert_escape_newlines(const char* aMessage);
 #endif
 
 #include <string>
+#include <deque>
 #if defined(_WIN32)
 #include <direct.h>
 #define getcwd _getcwd
@@ -178,6 +183,7 @@ char* revert_escape_newlines(const char* aMessage);
 #include <limits.h>
 
 #include <output/output_direct3d.h>
+#include <output/output_null.h>
 #include <output/output_opengl.h>
 #include <output/output_surface.h>
 #include <output/output_tools.h>
@@ -257,6 +263,8 @@ typedef enum PROCESS_DPI_AWARENESS {
 #include "cross.h"
 #include "keymap.h"
 #include "voodoo.h"
+#include "hosttime.h"
+#include "framepacing.h"
 #if C_OPENGL
 #include "../hardware/voodoo_types.h"
 #include "../hardware/voodoo_data.h"
@@ -746,6 +754,7 @@ void QuickEdit(bool bPressed);
 void ClipKeySelect(int sym);
 bool isModifierApplied(void);
 bool PasteClipboardNext(void);
+void PasteClipboardStream(void);
 
 #if C_DYNAMIC_X86
 void CPU_Core_Dyn_X86_Shutdown(void);
@@ -913,7 +922,7 @@ bool                        fullscreen_switch = true;
 bool                        startup_state_numlock = false; // Global for keyboard initialisation
 bool                        startup_state_capslock = false; // Global for keyboard initialisation
 bool                        startup_state_scrlock = false; // Global for keyboard initialisation
-int mouse_start_x=-1, mouse_start_y=-1, mouse_end_x=-1, mouse_end_y=-1, fx=-1, fy=-1, paste_speed=20, wheel_key=0, mbutton=3;
+int mouse_start_x=-1, mouse_start_y=-1, mouse_end_x=-1, mouse_end_y=-1, fx=-1, fy=-1, paste_speed=20, paste_rate=0, wheel_key=0, mbutton=3;
 bool wheel_guest = false, clipboard_dosapi = true, clipboard_biospaste =
 #if defined (WIN32) && (!defined(__MINGW32__) || defined(__MINGW64_VERSION_MAJOR))
 false;
@@ -1098,6 +1107,12 @@ void GFX_SetTitle(int32_t cycles, int frameskip, Bits timing, bool paused) {
         sprintf(p,", %2d%%/RT",(int)floor((rtdelta / 10) + 0.5));
     }
 
+    if (hosttime_enabled) {
+        char *p = title + strlen(title); // append to end of string
+
+        snprintf(p,sizeof(title)-strlen(title),", %s",HOSTTIME_Summary().c_str());
+    }
+
     if (titlebar != NULL && *titlebar != 0) {
         char *p = title + strlen(title); // append to end of string
 
@@ -1829,6 +1844,14 @@ SDL_Window* GFX_SetSDLWindowMode(uint16_t width, uint16_t height, SCREEN_TYPES s
 //          || (fullscreen != (SDL_WINDOW_FULLSCREEN == (SDL_GetWindowFlags(sdl.window) & SDL_WINDOW_FULLSCREEN)))
 //          || (fullscreen && ((width != currWidth) || (height != currHeight)))
        ) {
+#if C_VULKAN
+        /* the Vulkan surface and swapchain belong to the window about to go away */
+        if (lastType == SCREEN_VULKAN) OUTPUT_VULKAN_Shutdown();
+#endif
+#if C_DIRECT3D11
+        /* and so does the DXGI swap chain */
+        if (lastType == SCREEN_DIRECT3D11) OUTPUT_DIRECT3D11_Shutdown();
+#endif
         lastType = screenType;
         if (sdl.window) {
             SDL_DestroyWindow(sdl.window);
@@ -1839,7 +1862,11 @@ SDL_Window* GFX_SetSDLWindowMode(uint16_t width, uint16_t height, SCREEN_TYPES s
                                       SDL_WINDOWPOS_UNDEFINED_DISPLAY(sdl.displayNumber?sdl.displayNumber-1:0),
                                       width, height,
                                       (GFX_IsFullscreen() ? (sdl.desktop.full.display_res ? SDL_WINDOW_FULLSCREEN_DESKTOP : SDL_WINDOW_FULLSCREEN) : 0)
-                                      | ((screenType == SCREEN_OPENGL) ? SDL_WINDOW_OPENGL : 0) | (maximize && !TTF_using()? SDL_WINDOW_MAXIMIZED : 0)
+                                      | ((screenType == SCREEN_OPENGL) ? SDL_WINDOW_OPENGL : 0)
+#if C_VULKAN
+                                      | ((screenType == SCREEN_VULKAN) ? SDL_WINDOW_VULKAN : 0)
+#endif
+                                      | (maximize && !TTF_using()? SDL_WINDOW_MAXIMIZED : 0)
                                       | SDL_WINDOW_SHOWN | (SDL2_resize_enable ? SDL_WINDOW_RESIZABLE : 0)
                                       | (dpi_aware_enable ? SDL_WINDOW_ALLOW_HIGHDPI : 0));
         if (sdl.window) {
@@ -1981,6 +2008,10 @@ Bitu GFX_GetBestMode(Bitu flags)
             break;
 #endif
 
+        case SCREEN_NULL:
+            retFlags = GFX_CAN_32 | GFX_SCALING;
+            break;
+
         default:
             // we should never reach here
             retFlags = 0;
@@ -2239,6 +2270,22 @@ Bitu GFX_SetSize(Bitu width, Bitu height, Bitu flags, double scalex, double scal
             break;
 #endif
 
+#if C_VULKAN
+        case SCREEN_VULKAN:
+            retFlags = OUTPUT_VULKAN_SetSize();
+            break;
+#endif
+
+#if C_DIRECT3D11
+        case SCREEN_DIRECT3D11:
+            retFlags = OUTPUT_DIRECT3D11_SetSize();
+            break;
+#endif
+
+        case SCREEN_NULL:
+            retFlags = OUTPUT_NULL_SetSize();
+            break;
+
 #if C_DIRECT3D
         case SCREEN_DIRECT3D:
             retFlags = OUTPUT_DIRECT3D_SetSize();
@@ -3212,6 +3259,19 @@ bool GFX_StartUpdate(uint8_t* &pixels,Bitu &pitch)
             return OUTPUT_GAMELINK_StartUpdate(pixels, pitch);
 #endif
 
+#if C_VULKAN
+        case SCREEN_VULKAN:
+            return OUTPUT_VULKAN_StartUpdate(pixels, pitch);
+#endif
+
+#if C_DIRECT3D11
+        case SCREEN_DIRECT3D11:
+            return OUTPUT_DIRECT3D11_StartUpdate(pixels, pitch);
+#endif
+
+        case SCREEN_NULL:
+            return OUTPUT_NULL_StartUpdate(pixels, pitch);
+
 #if C_DIRECT3D
         case SCREEN_DIRECT3D:
             return OUTPUT_DIRECT3D_StartUpdate(pixels, pitch);
@@ -3246,10 +3306,28 @@ void GFX_OpenGLRedrawScreen(void) {
 #endif
 }
 
-void GFX_EndUpdate(const uint16_t *changedLines) {
+/* refresh rate of the display the window is on, 0 if it can't be queried */
+double GFX_GetHostRefreshRate(void) {
+#if defined(C_SDL2)
+    SDL_DisplayMode displayMode;
+    const int display = (sdl.window != NULL) ? SDL_GetWindowDisplayIndex(sdl.window) : 0;
+
+    if (SDL_GetCurrentDisplayMode(display >= 0 ? display : 0, &displayMode) == 0 && displayMode.refresh_rate > 0)
+        return displayMode.refresh_rate;
+#elif defined(WIN32)
+    DEVMODE devmode;
+
+    if (EnumDisplaySettings(NULL, ENUM_CURRENT_SETTINGS, &devmode) && devmode.dmDisplayFrequency > 1)
+        return devmode.dmDisplayFrequency;
+#endif
+    return 0;
+}
+
+void GFX_EndUpdate(const uint16_t *changedLines, const GFX_ChangedSpan *changedSpans) {
 #if C_EMSCRIPTEN
     emscripten_sleep(0);
 #endif
+    HostTimeScope scope(HOSTTIME_OUTPUT);
 
     /* don't present our output if 3Dfx is in OpenGL mode */
     if (sdl.desktop.prevent_fullscreen)
@@ -3273,10 +3351,13 @@ void GFX_EndUpdate(const uint16_t *changedLines) {
     }
 #endif
 
+    /* time the present for adaptive vsync, a present that waits on the host retrace blocks here */
+    const auto present_start = std::chrono::steady_clock::now();
+
     switch (sdl.desktop.type)
     {
         case SCREEN_SURFACE:
-            OUTPUT_SURFACE_EndUpdate(changedLines);
+            OUTPUT_SURFACE_EndUpdate(changedLines, changedSpans);
             break;
 
 #if C_OPENGL
@@ -3292,16 +3373,32 @@ void GFX_EndUpdate(const uint16_t *changedLines) {
                 sdl_opengl.actual_frame_count++;
                 return;
             }
-            OUTPUT_OPENGL_EndUpdate(changedLines);
+            OUTPUT_OPENGL_EndUpdate(changedLines, changedSpans);
             break;
 #endif
 
 #if C_GAMELINK
         case SCREEN_GAMELINK:
-            OUTPUT_GAMELINK_EndUpdate(changedLines);
+            OUTPUT_GAMELINK_EndUpdate(changedLines, changedSpans);
             break;
 #endif
 
+#if C_VULKAN
+        case SCREEN_VULKAN:
+            if (actually_updating) OUTPUT_VULKAN_EndUpdate(changedLines);
+            break;
+#endif
+
+#if C_DIRECT3D11
+        case SCREEN_DIRECT3D11:
+            if (actually_updating) OUTPUT_DIRECT3D11_EndUpdate(changedLines, changedSpans);
+            break;
+#endif
+
+        case SCREEN_NULL:
+            OUTPUT_NULL_EndUpdate(changedLines);
+            break;
+
 #if C_DIRECT3D
         case SCREEN_DIRECT3D:
             OUTPUT_DIRECT3D_EndUpdate(changedLines);
@@ -3312,6 +3409,15 @@ void GFX_EndUpdate(const uint16_t *changedLines) {
             break;
     }
 
+    {
+        const auto present_end = std::chrono::steady_clock::now();
+        const double blocked_ms = std::chrono::duration<double, std::milli>(present_end - present_start).count();
+        const double now_ms = std::chrono::duration<double, std::milli>(present_end.time_since_epoch()).count();
+
+        VGA_VsyncPresented(blocked_ms, now_ms);
+        FRAMEPACE_Presented();
+    }
+
 #if C_GAMELINK
     OUTPUT_GAMELINK_Transfer();
 #endif
@@ -3341,10 +3447,54 @@ void GFX_EndUpdate(const uint16_t *changedLines) {
     }
 }
 
+bool GFX_CanCompositeOverlay(void) {
+    switch (sdl.desktop.want_type) {
+#if C_OPENGL
+        case SCREEN_OPENGL:
+            return true;
+#endif
+#if C_DIRECT3D11
+        case SCREEN_DIRECT3D11:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+void GFX_SetOverlay(const uint32_t *pixels,Bitu width,Bitu height,Bitu pitch,Bitu top,Bitu bottom) {
+    (void)pixels;
+    (void)width;
+    (void)height;
+    (void)pitch;
+    (void)top;
+    (void)bottom;
+    switch (sdl.desktop.type) {
+#if C_OPENGL
+        case SCREEN_OPENGL:
+            OUTPUT_OPENGL_SetOverlay(pixels,width,height,pitch,top,bottom);
+            break;
+#endif
+#if C_DIRECT3D11
+        case SCREEN_DIRECT3D11:
+            OUTPUT_DIRECT3D11_SetOverlay(pixels,width,height,pitch,top,bottom);
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
 void GFX_SetPalette(Bitu start,Bitu count,GFX_PalEntry * entries) {
     (void)start;
     (void)count;
     (void)entries;
+#if C_OPENGL
+    if (sdl.desktop.type == SCREEN_OPENGL) {
+        OUTPUT_OPENGL_SetPalette(start,count,entries);
+        return;
+    }
+#endif
 #if !defined(C_SDL2)
     /* I should probably not change the GFX_PalEntry :) */
     if (sdl.surface->flags & SDL_HWPALETTE) {
@@ -3380,6 +3530,21 @@ Bitu GFX_GetRGB(uint8_t red, uint8_t green, uint8_t blue) {
             return (((unsigned long)blue <<  0ul) | ((unsigned long)green <<  8ul) | ((unsigned long)red << 16ul)) | (255ul << 24ul);
 #endif
 
+#if C_VULKAN
+        case SCREEN_VULKAN:
+            //USE ARGB, the source image is B8G8R8A8
+            return (((unsigned long)blue <<  0ul) | ((unsigned long)green <<  8ul) | ((unsigned long)red << 16ul)) | (255ul << 24ul);
+#endif
+
+#if C_DIRECT3D11
+        case SCREEN_DIRECT3D11:
+            //USE ARGB, the source texture is B8G8R8A8
+            return (((unsigned long)blue <<  0ul) | ((unsigned long)green <<  8ul) | ((unsigned long)red << 16ul)) | (255ul << 24ul);
+#endif
+
+        case SCREEN_NULL:
+            return (((unsigned long)blue <<  0ul) | ((unsigned long)green <<  8ul) | ((unsigned long)red << 16ul)) | (255ul << 24ul);
+
 #if C_DIRECT3D
         case SCREEN_DIRECT3D:
             return SDL_MapRGB(sdl.surface->format, red, green, blue);
@@ -3434,6 +3599,22 @@ static void GUI_ShutDown(Section * /*sec*/) {
             break;
 #endif
 
+#if C_VULKAN
+        case SCREEN_VULKAN:
+            OUTPUT_VULKAN_Shutdown();
+            break;
+#endif
+
+#if C_DIRECT3D11
+        case SCREEN_DIRECT3D11:
+            OUTPUT_DIRECT3D11_Shutdown();
+            break;
+#endif
+
+        case SCREEN_NULL:
+            OUTPUT_NULL_Shutdown();
+            break;
+
         default:
                 break;
     }
@@ -3611,6 +3792,8 @@ void Sendkeymapper(bool pressed) {
 
 bool has_GUI_StartUp = false;
 
+static void GFX_SetInputPollInterval(int us);
+
 static void GUI_StartUp() {
     DOSBoxMenu::item *item;
 
@@ -3832,7 +4015,9 @@ static void GUI_StartUp() {
     if (!strcasecmp(pastebios, "true") || !strcmp(pastebios, "1")) clipboard_biospaste = true;
     else if (!strcasecmp(pastebios, "false") || !strcmp(pastebios, "0")) clipboard_biospaste = false;
     paste_speed = (unsigned int)section->Get_int("clip_paste_speed");
+    paste_rate = section->Get_int("clip_paste_rate");
     wheel_key = section->Get_int("mouse_wheel_key");
+    GFX_SetInputPollInterval(section->Get_int("input poll interval"));
     wheel_guest=wheel_key>0;
     if (wheel_key<0) wheel_key=-wheel_key;
 
@@ -4001,6 +4186,7 @@ static void GUI_StartUp() {
     sdl.gamelink.enable = section->Get_bool("gamelink master");
     sdl.gamelink.snoop = section->Get_bool("gamelink snoop");
     sdl.gamelink.loadaddr = section->Get_int("gamelink load address");
+    sdl.gamelink.frame_slots = section->Get_int("gamelink frame slots");
 #endif
 
 
@@ -4024,6 +4210,12 @@ static void GUI_StartUp() {
 #if !C_GAMELINK
        || output == "gamelink"
 #endif
+#if !C_VULKAN
+       || output == "vulkan" || output == "vulkannb"
+#endif
+#if !C_DIRECT3D11
+       || output == "direct3d11" || output == "direct3d11nb"
+#endif
 #if !defined(USE_TTF)
        || output == "ttf"
 #endif
@@ -4073,6 +4265,26 @@ static void GUI_StartUp() {
     {
         OUTPUT_GAMELINK_Select();
 #endif
+#if C_VULKAN
+    }
+    else if (output == "vulkan")
+    {
+        OUTPUT_VULKAN_Select(false);
+    }
+    else if (output == "vulkannb")
+    {
+        OUTPUT_VULKAN_Select(true);
+#endif
+#if C_DIRECT3D11
+    }
+    else if (output == "direct3d11")
+    {
+        OUTPUT_DIRECT3D11_Select(false);
+    }
+    else if (output == "direct3d11nb")
+    {
+        OUTPUT_DIRECT3D11_Select(true);
+#endif
 #if C_DIRECT3D
     }
     else if (output == "direct3d")
@@ -4083,6 +4295,11 @@ static void GUI_StartUp() {
 #endif
 #endif
     }
+    else if (output == "null")
+    {
+        OUTPUT_NULL_Select();
+        init_output = true;
+    }
 #if defined(USE_TTF)
     else if (output == "ttf")
     {
@@ -4604,6 +4821,10 @@ void UpdateUserCursorScreenDimensions(void) {
 		user_cursor_sw     = (vga.draw.width*user_cursor_sw)/render.src.width;
 		user_cursor_sh     = (vga.draw.height*user_cursor_sh)/render.src.height;
 	}
+	else if (video_debug_overlay && render.overlay.composited) {
+		user_cursor_sw     = (render.src.width*user_cursor_sw)/(render.src.width+render.overlay.width);
+		user_cursor_sh     = (render.src.height*user_cursor_sh)/(render.src.height+render.overlay.height);
+	}
 }
 
 static void HandleMouseMotion(SDL_MouseMotionEvent * motion) {
@@ -5735,6 +5956,226 @@ bool gfx_in_mapper = false;
 #define DB_POLLSKIP 1
 #endif
 
+#if defined(C_SDL2) && defined(LINUX)
+# define OUTPUT_THREAD_SUPPORTED 1
+#endif
+
+#if OUTPUT_THREAD_SUPPORTED
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+/* The emulation holds "sdl_lock" at all times except while the CPU core runs or the
+ * emulation sleeps (GFX_SDLReleased, GFX_Delay). During those stretches the output
+ * thread takes it to present the last finished frame and to pump window system events
+ * into SDL's own event queue, which GFX_Events then drains without pumping itself. */
+static struct {
+    std::thread                 thread;
+    std::mutex                  sdl_lock;
+    std::mutex                  wake_lock;
+    std::condition_variable     wake;
+    std::atomic<bool>           running{false};
+    std::atomic<bool>           frame_ready{false};
+    bool                        active = false;     // only touched by the emulation thread
+    bool                        whole = false;      // protected by sdl_lock
+    int                         rect_count = 0;     // protected by sdl_lock
+    SDL_Rect                    rects[1024] = {};   // protected by sdl_lock
+} output_thread;
+
+static void GFX_OutputThreadMain(void) {
+    while (output_thread.running.load()) {
+        {
+            /* window events still want pumping when the guest draws nothing */
+            std::unique_lock<std::mutex> wl(output_thread.wake_lock);
+            output_thread.wake.wait_for(wl, std::chrono::milliseconds(4), [] {
+                return output_thread.frame_ready.load() || !output_thread.running.load();
+            });
+        }
+
+        std::lock_guard<std::mutex> guard(output_thread.sdl_lock);
+        if (!output_thread.running.load()) break;
+
+        if (output_thread.frame_ready.exchange(false)) {
+            if (sdl.window != NULL && sdl.desktop.type == SCREEN_SURFACE) {
+                if (output_thread.whole)
+                    SDL_UpdateWindowSurface(sdl.window);
+                else if (output_thread.rect_count > 0)
+                    SDL_UpdateWindowSurfaceRects(sdl.window, output_thread.rects, output_thread.rect_count);
+            }
+            output_thread.whole = false;
+            output_thread.rect_count = 0;
+        }
+
+        SDL_PumpEvents();
+    }
+}
+#endif
+
+void GFX_OutputThreadStart(void) {
+#if OUTPUT_THREAD_SUPPORTED
+    if (output_thread.active) return;
+
+    const Section_prop *section = static_cast<Section_prop *>(control->GetSection("sdl"));
+    if (section == NULL || !section->Get_bool("output thread")) return;
+    if (sdl.desktop.want_type != SCREEN_SURFACE) {
+        LOG_MSG("Output thread is only supported with output=surface, not starting it");
+        return;
+    }
+
+    output_thread.sdl_lock.lock();
+    output_thread.whole = false;
+    output_thread.rect_count = 0;
+    output_thread.frame_ready.store(false);
+    output_thread.running.store(true);
+    try {
+        output_thread.thread = std::thread(GFX_OutputThreadMain);
+    }
+    catch (const std::system_error &e) {
+        LOG_MSG("Unable to start output thread: %s", e.what());
+        output_thread.running.store(false);
+        output_thread.sdl_lock.unlock();
+        return;
+    }
+    output_thread.active = true;
+    LOG(LOG_MISC,LOG_DEBUG)("Output thread started");
+#endif
+}
+
+void GFX_OutputThreadStop(void) {
+#if OUTPUT_THREAD_SUPPORTED
+    if (!output_thread.active) return;
+
+    output_thread.active = false;
+    output_thread.running.store(false);
+    {
+        std::lock_guard<std::mutex> wl(output_thread.wake_lock);
+        output_thread.wake.notify_one();
+    }
+    output_thread.sdl_lock.unlock();
+    output_thread.thread.join();
+
+    /* whatever was still pending is presented here, on the emulation thread */
+    if (output_thread.frame_ready.exchange(false) && sdl.window != NULL && sdl.desktop.type == SCREEN_SURFACE)
+        SDL_UpdateWindowSurface(sdl.window);
+    LOG(LOG_MISC,LOG_DEBUG)("Output thread stopped");
+#endif
+}
+
+void GFX_ReleaseSDL(void) {
+#if OUTPUT_THREAD_SUPPORTED
+    if (output_thread.active) output_thread.sdl_lock.unlock();
+#endif
+}
+
+void GFX_AcquireSDL(void) {
+#if OUTPUT_THREAD_SUPPORTED
+    if (output_thread.active) output_thread.sdl_lock.lock();
+#endif
+}
+
+void GFX_Delay(uint32_t ms) {
+    GFX_SDLReleased released;
+    SDL_Delay(ms);
+}
+
+#if defined(C_SDL2)
+void GFX_PresentWindowSurface(const SDL_Rect *rects, int count) {
+#if OUTPUT_THREAD_SUPPORTED
+    if (output_thread.active) {
+        /* merge with a frame the output thread has not picked up yet */
+        if (rects == NULL || output_thread.rect_count + count > (int)(sizeof(output_thread.rects) / sizeof(output_thread.rects[0]))) {
+            output_thread.whole = true;
+        }
+        else if (!output_thread.whole) {
+            memcpy(&output_thread.rects[output_thread.rect_count], rects, sizeof(SDL_Rect) * (size_t)count);
+            output_thread.rect_count += count;
+        }
+
+        std::lock_guard<std::mutex> wl(output_thread.wake_lock);
+        output_thread.frame_ready.store(true);
+        output_thread.wake.notify_one();
+        return;
+    }
+#endif
+    if (rects == NULL)
+        SDL_UpdateWindowSurface(sdl.window);
+    else
+        SDL_UpdateWindowSurfaceRects(sdl.window, rects, count);
+}
+#endif
+
+/* [sdl] "input poll interval": the main loop takes host events once per emulated millisecond,
+ * which within the burst of ticks run after each sleep can be a few milliseconds late or early.
+ * With an interval set events are also taken that often within each millisecond, and on SDL2
+ * key and mouse events are held until the emulation gets to the host time they came in at. */
+#define INPUT_HOLD_MAX_MS       50.0    /* the emulation is this far behind, do not wait for it */
+#define INPUT_HOLD_MAX_EVENTS   256u
+
+static pic_tickindex_t input_poll_interval = 0; /* ms, 0 = once per tick */
+
+static void GFX_InputPollEvent(Bitu /*val*/) {
+    if (!runahead_ahead) GFX_Events();
+}
+
+static void GFX_InputPollTick(void) {
+    for (pic_tickindex_t t=input_poll_interval;t < 0.999;t += input_poll_interval)
+        PIC_AddEvent(GFX_InputPollEvent,t);
+}
+
+static void GFX_SetInputPollInterval(int us) {
+    TIMER_DelTickHandler(GFX_InputPollTick);
+    input_poll_interval = (us > 0 && us < 1000) ? (pic_tickindex_t)us / 1000 : 0;
+    if (input_poll_interval > 0) TIMER_AddTickHandler(GFX_InputPollTick);
+}
+
+static inline int GFX_PollEvent(SDL_Event *event) {
+#if OUTPUT_THREAD_SUPPORTED
+    /* the output thread already pumps, only take what is queued */
+    if (output_thread.active)
+        return SDL_PeepEvents(event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) > 0;
+#endif
+    return SDL_PollEvent(event);
+}
+
+#if defined(C_SDL2)
+static std::deque<SDL_Event> input_held;
+
+static inline bool GFX_IsInputEvent(const SDL_Event &event) {
+    return event.type >= SDL_KEYDOWN && event.type < SDL_JOYAXISMOTION; /* keyboard, text input and mouse */
+}
+
+/* GFX_PollEvent, holding key and mouse events back until their time, see GFX_InputPollTick */
+static int GFX_NextEvent(SDL_Event *event) {
+    if (input_poll_interval <= 0 && input_held.empty()) return GFX_PollEvent(event);
+
+    const double now = DOSBOX_EmulatedHostTicks();
+    const bool hold = input_poll_interval > 0 && now >= 0 && ((double)GetTicks() - now) < INPUT_HOLD_MAX_MS;
+
+    if (!input_held.empty() && (!hold || (double)input_held.front().common.timestamp <= now)) {
+        *event = input_held.front();
+        input_held.pop_front();
+        return 1;
+    }
+
+    while (GFX_PollEvent(event)) {
+        if (!GFX_IsInputEvent(*event)) return 1;
+        /* in order, behind any held already */
+        if (input_held.empty() && (!hold || (double)event->common.timestamp <= now)) return 1;
+        if (input_held.size() >= INPUT_HOLD_MAX_EVENTS) {
+            input_held.push_back(*event);
+            *event = input_held.front();
+            input_held.pop_front();
+            return 1;
+        }
+        input_held.push_back(*event);
+    }
+    return 0;
+}
+#endif
+
 void GFX_Events() {
     CheckMapperKeyboardLayout();
 #if defined(C_SDL2) /* SDL 2.x---------------------------------- */
@@ -5784,7 +6225,7 @@ void GFX_Events() {
     emscripten_sleep(0);
 #endif
 
-    while (SDL_PollEvent(&event)) {
+    while (GFX_NextEvent(&event)) {
 #if defined(C_SDL2)
         /* SDL2 hack: There seems to be a problem where calling the SetWindowSize function,
            even for the same size, still causes a resize event, and sometimes for no apparent
@@ -5797,6 +6238,8 @@ void GFX_Events() {
         }
 #endif
 
+        if (event.type == SDL_KEYDOWN || event.type == SDL_MOUSEBUTTONDOWN) DOSBOX_AutoTurboInput();
+
         switch (event.type) {
 #if defined(WIN32) && !defined(HX_DOS)
         case SDL_SYSWMEVENT:
@@ -6231,6 +6674,8 @@ void GFX_Events() {
 #endif
         /* end patch fragment */
 
+        if (event.type == SDL_KEYDOWN || event.type == SDL_MOUSEBUTTONDOWN) DOSBOX_AutoTurboInput();
+
         switch (event.type) {
 #ifdef __WIN32__
         case SDL_SYSWMEVENT : {
@@ -6637,7 +7082,9 @@ void GFX_Events() {
 	if (paste_speed < 0) paste_speed = 30;
 
     static Bitu iPasteTicker = 0;
-    if (paste_speed && (iPasteTicker++ % paste_speed) == 0) // emendelson: was 20 - good for WP51; Wengier: changed to 30 for better compatibility
+    if (paste_rate > 0)
+        PasteClipboardStream();
+    else if (paste_speed && (iPasteTicker++ % paste_speed) == 0) // emendelson: was 20 - good for WP51; Wengier: changed to 30 for better compatibility
         PasteClipboardNext();   // end added emendelson from dbDOS; improved by Wengier
 }
 
@@ -6686,7 +7133,13 @@ void SDL_SetupConfigSection() {
 #if C_GAMELINK
         "gamelink",
 #endif
-        "ddraw", "direct3d",
+#if C_VULKAN
+        "vulkan", "vulkannb",
+#endif
+#if C_DIRECT3D11
+        "direct3d11", "direct3d11nb",
+#endif
+        "ddraw", "direct3d", "null",
         nullptr };
 
     Pint = sdl_sec->Add_int("display", Property::Changeable::Always, 0);
@@ -6694,10 +7147,37 @@ void SDL_SetupConfigSection() {
     Pint->SetBasic(true);
 
     Pstring = sdl_sec->Add_string("output", Property::Changeable::Always, "default");
-    Pstring->Set_help("What video system to use for output (surface = software (SDL_Surface); openglnb = OpenGL nearest; openglpp = OpenGL perfect; ttf = TrueType font output).");
+    Pstring->Set_help("What video system to use for output (surface = software (SDL_Surface); openglnb = OpenGL nearest; openglpp = OpenGL perfect; vulkannb = Vulkan nearest; direct3d11nb = Direct3D 11 nearest; ttf = TrueType font output;\n"
+                      "null = no output at all, for unattended runs: frames are only rendered for captures and screenshots).");
     Pstring->Set_values(outputs);
     Pstring->SetBasic(true);
 
+    Pbool = sdl_sec->Add_bool("null output unthrottled", Property::Changeable::OnlyAtStart, true);
+    Pbool->Set_help("With output=null, run the emulation as fast as the host allows instead of in real time, and without sound.");
+
+#if C_VULKAN
+    const char* vulkan_present_modes[] = { "auto", "fifo", "mailbox", "immediate", nullptr };
+    Pstring = sdl_sec->Add_string("vulkan present mode", Property::Changeable::Always, "auto");
+    Pstring->Set_values(vulkan_present_modes);
+    Pstring->Set_help("How the Vulkan output hands frames to the display (output=vulkan or vulkannb).\n"
+                      "  fifo: wait for vertical retrace, never tears.\n"
+                      "  mailbox: wait for vertical retrace, but a newer frame replaces one still waiting; lowest latency without tearing.\n"
+                      "  immediate: show frames at once, may tear.\n"
+                      "  auto: mailbox if the driver supports it, otherwise fifo.");
+
+    Pint = sdl_sec->Add_int("vulkan frames", Property::Changeable::Always, 2);
+    Pint->SetMinMax(1,3);
+    Pint->Set_help("How many frames the Vulkan output may have queued on the GPU at once (1-3).\n"
+                   "  1 gives the lowest latency; more smooths out a busy GPU. Frames beyond this are dropped, never waited for.");
+#endif
+
+#if C_DIRECT3D11
+    Pint = sdl_sec->Add_int("direct3d11 frame latency", Property::Changeable::Always, 1);
+    Pint->SetMinMax(1,3);
+    Pint->Set_help("How many frames the Direct3D 11 output may have queued for the display at once (output=direct3d11 or direct3d11nb, 1-3).\n"
+                   "  With vsyncmode host or adaptive the emulation waits for a free slot, otherwise frames beyond this are dropped and presents may tear.");
+#endif
+
     Pstring = sdl_sec->Add_string("videodriver",Property::Changeable::OnlyAtStart, "");
     Pstring->Set_help("Forces a video driver (e.g. windib/windows, directx, x11, fbcon, dummy, etc) for the SDL library to use.");
     Pstring->SetBasic(true);
@@ -6758,6 +7238,12 @@ void SDL_SetupConfigSection() {
         "Or experiment with decreasing the number for applications that accept keystrokes quickly.");
     Pint->SetBasic(true);
 
+    Pint = sdl_sec->Add_int("clip_paste_rate", Property::Changeable::WhenIdle, 0);
+    Pint->SetMinMax(0,100000);
+    Pint->Set_help("If set, pasted text is streamed at up to this many characters per second instead of being paced by clip_paste_speed.\n"
+        "While the program reads the keyboard through the BIOS (INT 16h) the text goes straight into the BIOS keyboard buffer,\n"
+        "which is refilled as soon as the program reads from it; otherwise it is typed one key at a time as fast as allowed.");
+
     Pmulti = sdl_sec->Add_multi("sensitivity",Property::Changeable::Always, ",");
     Pmulti->Set_help("Mouse sensitivity. The optional second parameter specifies vertical sensitivity (e.g. 100,-50).");
     Pmulti->SetValue("100");
@@ -6800,6 +7286,13 @@ void SDL_SetupConfigSection() {
         "Putting a minus sign in front will disable the conversion for guest systems.");
     Pint->SetBasic(true);
 
+    Pint = sdl_sec->Add_int("input poll interval", Property::Changeable::WhenIdle, 0);
+    Pint->SetMinMax(0,999);
+    Pint->Set_help("If set, keyboard and mouse input is also taken this often, in microseconds of emulated time, within each\n"
+        "millisecond instead of once per millisecond. With SDL2 each key press and mouse event also reaches the guest\n"
+        "at the emulated time matching when it came in, instead of up to a few milliseconds early or late.\n"
+        "Useful for games that need exact input timing. 0 takes input once per millisecond.");
+
 #if defined(C_SDL2)
     Pbool = sdl_sec->Add_bool("keyboard_capture", Property::Changeable::Always, false);
     Pbool->Set_help("Capture the keyboard, inhibiting window manager shortcuts.\n"
@@ -6857,6 +7350,10 @@ void SDL_SetupConfigSection() {
     Pbool->Set_help("Connect to an existing Game Link session and output link data instead of sending own data. Compares memory contents to find a suitable memory offset of peeks.");
     Pint = sdl_sec->Add_int("gamelink load address", Property::Changeable::Always, 0);
     Pbool->Set_help("Configure the original load address of the software (when running in plain DOSBox) so that gamelink accesses are adjusted for different load addresses.");
+    Pint = sdl_sec->Add_int("gamelink frame slots", Property::Changeable::OnlyAtStart, 3);
+    Pint->SetMinMax(0,8);
+    Pint->Set_help("Number of frames in the Game Link frame ring, a second shared memory that readers can take frames from without locking.\n"
+                   "While it exists the emulator skips a frame rather than wait for a reader holding the Game Link mutex. 0 turns the ring off.");
 #endif
 
     Pint = sdl_sec->Add_int("overscan",Property::Changeable::Always, 0);
@@ -6880,6 +7377,11 @@ void SDL_SetupConfigSection() {
     Pbool->Set_help("Whether to show the menu bar (if supported). Default true.");
     Pbool->SetBasic(true);
 
+    Pbool = sdl_sec->Add_bool("output thread", Property::Changeable::OnlyAtStart, false);
+    Pbool->Set_help("If set, finished frames are presented and window events are pumped by a separate thread\n"
+                    "while the CPU emulation runs, so a slow window system does not stall emulated time.\n"
+                    "Only used with SDL2 on Linux and the surface output; ignored otherwise.");
+
 //  Pint = sdl_sec->Add_int("overscancolor",Property::Changeable::Always, 0);
 //  Pint->SetMinMax(0,1000);
 //  Pint->Set_help("Value of overscan color.");
@@ -7280,7 +7782,10 @@ bool DOSBOX_parse_argv() {
             fprintf(stderr,"                                          Make sure to surround the command in quotes to cover spaces.\n");
             fprintf(stderr,"  -set <section property=value>           Set the config option (overriding the config file).\n");
             fprintf(stderr,"                                          Make sure to surround the string in quotes to cover spaces.\n");
-            fprintf(stderr,"  -time-limit <n>                         Kill the emulator after 'n' seconds\n");
+            fprintf(stderr,"  -time-limit <n>                         Kill the emulator after 'n' emulated seconds\n");
+            fprintf(stderr,"  -headless                               No window, no sound, unthrottled (output=null) for automated test runs\n");
+            fprintf(stderr,"  -perf-report <file>                     Write the performance counters as JSON on exit (- for stdout)\n");
+            fprintf(stderr,"  -startup-profile                        Log how long each part of the startup took, at the first DOS prompt\n");
             fprintf(stderr,"  -fastlaunch                             Fast launch mode (skip the BIOS logo and welcome banner)\n");
 #if C_DEBUG
             fprintf(stderr,"  -helpdebug                              Show debug-related options\n");
@@ -7311,7 +7816,12 @@ bool DOSBOX_parse_argv() {
             fprintf(stderr,"  -log-fileio                             Log file I/O through INT 21h (debug level)\n");
             fprintf(stderr,"  -nolog                                  Do not log anything to log file\n");
             fprintf(stderr,"  -tests                                  Run unit tests to test the DOSBox-X code\n");
+            fprintf(stderr,"  -benchmark-out <file>                   Write the results of the -tests microbenchmarks as JSON\n");
             fprintf(stderr,"  -print-ticks                            (Debug) Print emulator time and SDL_GetTicks()\n");
+#if C_DEBUG
+            fprintf(stderr,"  -decodecpulog <file> [filter...]        Disassemble a binary CPU log (debugger LOGB) to stdout and exit\n");
+            fprintf(stderr,"                                          Filters: cs=XXXX eip=LO-HI lin=LO-HI match=TEXT from=N count=N\n");
+#endif
             fprintf(stderr,"\n");
 
 #if defined(WIN32)
@@ -7356,6 +7866,22 @@ bool DOSBOX_parse_argv() {
             control->opt_nomenu = true;
             control->opt_fastlaunch = true;
         }
+        else if (optname == "headless") {
+            /* the emulated machine is unchanged, only the host side is gone: output=null does not
+             * present frames, plays no sound and does not pace the emulation to real time */
+            putenv(const_cast<char*>("SDL_AUDIODRIVER=dummy"));
+            putenv(const_cast<char*>("SDL_VIDEODRIVER=dummy"));
+            control->opt_set.push_back("output=null");
+            control->opt_set.push_back("null output unthrottled=true");
+            control->opt_nomenu = true;
+            control->opt_fastlaunch = true;
+        }
+        else if (optname == "perf-report") {
+            if (!control->cmdline->NextOptArgv(control->opt_perf_report)) return false;
+        }
+        else if (optname == "startup-profile") {
+            control->opt_startup_profile = true;
+        }
         else if (optname == "test" || optname == "tests" || optname == "gtest_list_tests") {
             putenv(const_cast<char*>("SDL_VIDEODRIVER=dummy"));
             control->opt_test = true;
@@ -7365,6 +7891,9 @@ bool DOSBOX_parse_argv() {
             control->opt_nomenu = true;
             control->opt_fastlaunch = true;
         }
+        else if (optname == "benchmark-out") {
+            if (!control->cmdline->NextOptArgv(control->opt_benchmark_out)) return false;
+        }
         else if (optname == "exit") {
             control->opt_exit = true;
         }
@@ -7546,6 +8075,16 @@ bool DOSBOX_parse_argv() {
             control->opt_print_ticks = true;
             control->opt_console = true;
         }
+#if C_DEBUG
+        else if (optname == "decodecpulog") {
+            std::vector<std::string> filters;
+            if (!control->cmdline->NextOptArgv(tmp)) return false;
+            while (control->cmdline->NextOptArgv(localname)) filters.push_back(localname);
+
+            DOSBox_ShowConsole();
+            exit(CPULOG_Decode(tmp,filters) ? 0 : 1);
+        }
+#endif
         else if (optname == "socket") {
             if (!control->cmdline->NextOptArgv(tmp)) return false;
             socknum = std::stoi(tmp);
@@ -7663,6 +8202,7 @@ void DRIVES_Init();
 void IPX_Init();
 void IDE_Init();
 void NE2K_Init();
+void RTL8139_Init();
 void FDC_Primary_Init();
 void AUTOEXEC_Init();
 void DOS_InitClock();
@@ -9013,6 +9553,11 @@ int main(int argc, char* argv[]) SDL_MAIN_NOEXCEPT {
             videodriver = "SDL_VIDEODRIVER="+videodriver;
             putenv((char *)videodriver.c_str());
         }
+        else if (OUTPUT_NULL_Configured() && getenv("SDL_VIDEODRIVER") == NULL) {
+            /* output=null shows nothing, so it needs no window, display server or GPU */
+            LOG(LOG_GUI,LOG_DEBUG)("output=null: setting SDL_VIDEODRIVER=dummy");
+            putenv(const_cast<char*>("SDL_VIDEODRIVER=dummy"));
+        }
 
 #ifdef WIN32
         /* hack: Encourage SDL to use windib if not otherwise specified */
@@ -9280,77 +9825,78 @@ int main(int argc, char* argv[]) SDL_MAIN_NOEXCEPT {
 
         /* Start up main machine */
 
-        MAPPER_StartUp();
-        DOSBOX_InitTickLoop();
-        DOSBOX_RealInit();
+        STARTUP_PHASE(MAPPER_StartUp());
+        STARTUP_PHASE(DOSBOX_InitTickLoop());
+        STARTUP_PHASE(DOSBOX_RealInit());
 
         /* at this point: If the machine type is PC-98, and the mapper keyboard layout was "Japanese",
          * then change the mapper layout to "Japanese PC-98" */
         if (host_keyboard_layout == DKM_JPN && IS_PC98_ARCH)
             SetMapperKeyboardLayout(DKM_JPN_PC98);
 
-        RENDER_Init();
-        CAPTURE_Init();
-        IO_Init();
-        HARDWARE_Init();
-        CPU_PreInit();
-        Init_AddressLimitAndGateMask(); /* <- need to init address mask so Init_RAM knows the maximum amount of RAM possible */
-        Init_MemoryAccessArray(); /* <- NTS: In DOSBox-X this is the "cache" of devices that responded to memory access */
-        Init_A20_Gate(); // FIXME: Should be handled by motherboard!
-        Init_PS2_Port_92h(); // FIXME: Should be handled by motherboard!
-        Init_RAM();
-        Init_DMA();
-        Init_PIC();
-        TIMER_Init();
-        PCIBUS_Init();
-        PAGING_Init(); /* <- NTS: At this time, must come before memory init because paging is so well integrated into emulation code */
-        CMOS_Init();
-        ROMBIOS_Init();
-        CALLBACK_Init(); /* <- NTS: This relies on ROM BIOS allocation and it must happen AFTER ROMBIOS init */
+        STARTUP_PHASE(RENDER_Init());
+        STARTUP_PHASE(CAPTURE_Init());
+        STARTUP_PHASE(IO_Init());
+        STARTUP_PHASE(HARDWARE_Init());
+        STARTUP_PHASE(CPU_PreInit());
+        STARTUP_PHASE(Init_AddressLimitAndGateMask()); /* <- need to init address mask so Init_RAM knows the maximum amount of RAM possible */
+        STARTUP_PHASE(Init_MemoryAccessArray()); /* <- NTS: In DOSBox-X this is the "cache" of devices that responded to memory access */
+        STARTUP_PHASE(Init_A20_Gate()); // FIXME: Should be handled by motherboard!
+        STARTUP_PHASE(Init_PS2_Port_92h()); // FIXME: Should be handled by motherboard!
+        STARTUP_PHASE(Init_RAM());
+        STARTUP_PHASE(Init_DMA());
+        STARTUP_PHASE(Init_PIC());
+        STARTUP_PHASE(TIMER_Init());
+        STARTUP_PHASE(PCIBUS_Init());
+        STARTUP_PHASE(PAGING_Init()); /* <- NTS: At this time, must come before memory init because paging is so well integrated into emulation code */
+        STARTUP_PHASE(CMOS_Init());
+        STARTUP_PHASE(ROMBIOS_Init());
+        STARTUP_PHASE(CALLBACK_Init()); /* <- NTS: This relies on ROM BIOS allocation and it must happen AFTER ROMBIOS init */
 #if C_DEBUG
-        DEBUG_Init(); /* <- NTS: Relies on callback system */
-#endif
-        Init_VGABIOS();
-        VOODOO_Init();
-        GLIDE_Init();
-        PROGRAMS_Init(); /* <- NTS: Does not init programs, it inits the callback used later when creating the .COM programs on drive Z: */
-        PCSPEAKER_Init();
-        TANDYSOUND_Init();
-        MPU401_Init();
-        MIXER_Init();
-        MIDI_Init();
+        STARTUP_PHASE(DEBUG_Init()); /* <- NTS: Relies on callback system */
+#endif
+        STARTUP_PHASE(Init_VGABIOS());
+        STARTUP_PHASE(VOODOO_Init());
+        STARTUP_PHASE(GLIDE_Init());
+        STARTUP_PHASE(PROGRAMS_Init()); /* <- NTS: Does not init programs, it inits the callback used later when creating the .COM programs on drive Z: */
+        STARTUP_PHASE(PCSPEAKER_Init());
+        STARTUP_PHASE(TANDYSOUND_Init());
+        STARTUP_PHASE(MPU401_Init());
+        STARTUP_PHASE(MIXER_Init());
+        STARTUP_PHASE(MIDI_Init());
         {
             DOSBoxMenu::item *item;
 
             MAPPER_AddHandler(Sendkeymapper, MK_delete, MMODHOST, "sendkey_mapper", "Send special key", &item);
             item->set_text("Send special key");
         }
-        CPU_Init();
-        Weitek_Init();
+        STARTUP_PHASE(CPU_Init());
+        STARTUP_PHASE(Weitek_Init());
 #if C_FPU
-        FPU_Init();
-#endif
-        VGA_Init();
-        ISAPNP_Cfg_Init();
-        FDC_Primary_Init();
-        KEYBOARD_Init();
-        SBLASTER_Init();
-        JOYSTICK_Init();
-        PS1SOUND_Init();
-        DISNEY_Init();
-        GUS_Init();
-        IDE_Init();
-        IMFC_Init();
-        INNOVA_Init();
-        BIOS_Init();
-        INT10_Init();
-        SERIAL_Init();
-        DONGLE_Init();
+        STARTUP_PHASE(FPU_Init());
+#endif
+        STARTUP_PHASE(VGA_Init());
+        STARTUP_PHASE(ISAPNP_Cfg_Init());
+        STARTUP_PHASE(FDC_Primary_Init());
+        STARTUP_PHASE(KEYBOARD_Init());
+        STARTUP_PHASE(SBLASTER_Init());
+        STARTUP_PHASE(JOYSTICK_Init());
+        STARTUP_PHASE(PS1SOUND_Init());
+        STARTUP_PHASE(DISNEY_Init());
+        STARTUP_PHASE(GUS_Init());
+        STARTUP_PHASE(IDE_Init());
+        STARTUP_PHASE(IMFC_Init());
+        STARTUP_PHASE(INNOVA_Init());
+        STARTUP_PHASE(BIOS_Init());
+        STARTUP_PHASE(INT10_Init());
+        STARTUP_PHASE(SERIAL_Init());
+        STARTUP_PHASE(DONGLE_Init());
 #if C_PRINTER
-        PRINTER_Init();
+        STARTUP_PHASE(PRINTER_Init());
 #endif
-        PARALLEL_Init();
-        NE2K_Init();
+        STARTUP_PHASE(PARALLEL_Init());
+        STARTUP_PHASE(NE2K_Init());
+        STARTUP_PHASE(RTL8139_Init());
 
 #if DOSBOXMENU_TYPE == DOSBOXMENU_HMENU
         Reflect_Menu();
@@ -9359,7 +9905,7 @@ int main(int argc, char* argv[]) SDL_MAIN_NOEXCEPT {
 
         /* If PCjr emulation, map cartridge ROM */
         if (machine == MCH_PCJR)
-            Init_PCJR_CartridgeROM();
+            STARTUP_PHASE(Init_PCJR_CartridgeROM());
 
         /* let's assume motherboards are sane on boot because A20 gate is ENABLED on first boot */
         MEM_A20_Enable(true);
@@ -9397,30 +9943,30 @@ int main(int argc, char* argv[]) SDL_MAIN_NOEXCEPT {
 #endif
 
         /* OS init now */
-        DOS_Init();
-        DRIVES_Init();
-        DOS_KeyboardLayout_Init();
-        MOUSE_Init(); // FIXME: inits INT 15h and INT 33h at the same time. Also uses DOS_GetMemory() which is why DOS_Init must come first
-        XMS_Init();
-        EMS_Init();
-        AUTOEXEC_Init();
+        STARTUP_PHASE(DOS_Init());
+        STARTUP_PHASE(DRIVES_Init());
+        STARTUP_PHASE(DOS_KeyboardLayout_Init());
+        STARTUP_PHASE(MOUSE_Init()); // FIXME: inits INT 15h and INT 33h at the same time. Also uses DOS_GetMemory() which is why DOS_Init must come first
+        STARTUP_PHASE(XMS_Init());
+        STARTUP_PHASE(EMS_Init());
+        STARTUP_PHASE(AUTOEXEC_Init());
 #if C_IPX
-        IPX_Init();
+        STARTUP_PHASE(IPX_Init());
 #endif
-        MSCDEX_Init();
-        CDROM_Image_Init();
+        STARTUP_PHASE(MSCDEX_Init());
+        STARTUP_PHASE(CDROM_Image_Init());
 
         /* Init memhandle system. This part is used by DOSBox-X's XMS/EMS emulation to associate handles
          * per page. FIXME: I would like to push this down to the point that it's never called until
          * XMS/EMS emulation needs it. I would also like the code to free the mhandle array immediately
          * upon booting into a guest OS, since memory handles no longer have meaning in the guest OS
          * memory layout. */
-        Init_MemHandles();
+        STARTUP_PHASE(Init_MemHandles());
 
         /* finally, the mapper */
-        MAPPER_Init();
-        AllocCallback2();
-        MSG_Init();
+        STARTUP_PHASE(MAPPER_Init());
+        STARTUP_PHASE(AllocCallback2());
+        STARTUP_PHASE(MSG_Init());
 
         /* stop at this point, and show the configuration tool/mapper editor, if instructed */
         if (control->opt_startui) {
@@ -9714,6 +10260,8 @@ int main(int argc, char* argv[]) SDL_MAIN_NOEXCEPT {
         bool reboot_machine;
         bool dos_kernel_shutdown;
 
+        PERFREPORT_Start(control->opt_perf_report);
+
 fresh_boot:
         run_bios = false;
         reboot_dos = false;
@@ -9734,6 +10282,7 @@ fresh_boot:
 #if C_DEBUG
             if (control->opt_break_start) DEBUG_EnableDebugger();
 #endif
+            GFX_OutputThreadStart();
             DOSBOX_RunMachine();
         } catch (int x) {
             if (x == 2) { /* booting a guest OS. "boot" has already done the work to load the image and setup CPU registers */
@@ -10193,6 +10742,7 @@ void GFX_GetSize(int &width, int &height, bool &fullscreen) {
 
 void GFX_ShutDown(void) {
     LOG(LOG_MISC,LOG_DEBUG)("Shutting down GFX renderer");
+    GFX_OutputThreadStop();
     GFX_Stop();
     if (sdl.draw.callback) (sdl.draw.callback)( GFX_CallBackStop );
     if (sdl.mouse.locked) GFX_CaptureMouse();
@@ -21,6 +21,7 @@
 #include <string.h>
 #include <math.h>
 #include <sys/types.h>
+#include <vector>
 #include "adlib.h"
 
 #include "logging.h"
@@ -30,6 +31,7 @@
 #include "dbopl.h"
 #include "nukedopl.h"
 #include "cpu.h"
+#include "threadpool.h"
 
 #include "mame/emu.h"
 #include "mame/fmopl.h"
@@ -70,6 +72,17 @@ namespace OPL2 {
 				chan->AddSamples_m16( todo, buf );
 			}
 		}
+		bool Render( int32_t* out, Bitu samples ) override {
+			int16_t buf[1024];
+			while( samples > 0 ) {
+				Bitu todo = samples > 1024 ? 1024 : samples;
+				samples -= todo;
+				adlib_getsample(buf, (Bits)todo);
+				for (Bitu i = 0; i < todo; i++, out += 2)
+					out[0] = out[1] = buf[i];
+			}
+			return true;
+		}
 
 		void Init( Bitu rate ) override {
 			adlib_init((uint32_t)rate);
@@ -136,6 +149,17 @@ namespace OPL3 {
 				chan->AddSamples_s16( todo, buf );
 			}
 		}
+		bool Render( int32_t* out, Bitu samples ) override {
+			int16_t buf[1024*2];
+			while( samples > 0 ) {
+				Bitu todo = samples > 1024 ? 1024 : samples;
+				samples -= todo;
+				adlib_getsample(buf, (Bits)todo);
+				for (Bitu i = 0; i < todo*2; i++)
+					*out++ = buf[i];
+			}
+			return true;
+		}
 
 		void Init( Bitu rate ) override {
 			adlib_init((uint32_t)rate);
@@ -264,6 +288,19 @@ struct Handler : public Adlib::Handler {
 		}
 	}
 
+	bool Render(int32_t *out, Bitu samples) override {
+		int16_t buf[1024 * 2];
+
+		while (samples > 0) {
+			uint32_t todo = samples > 1024 ? 1024 : (uint32_t)samples;
+			ESFM_generate_stream(&chip, buf, todo);
+			for (uint32_t i = 0; i < todo * 2; i++)
+				*out++ = buf[i];
+			samples -= todo;
+		}
+		return true;
+	}
+
 	void Init(Bitu rate) override {
 		// ESFMu only ever runs at ~49716 Hz.
 		(void)rate;
@@ -285,7 +322,7 @@ struct Handler : public Adlib::Handler {
 	void WriteReg(uint32_t reg, uint8_t val) override {
 		OPL3_WriteRegBuffered(&chip, (uint16_t)reg, val);
 		if (reg == 0x105)
-			newm = reg & 0x01;
+			newm = val & 0x01;
 	}
 
 	uint32_t WriteAddr(uint32_t port, uint8_t val) override {
@@ -307,11 +344,83 @@ struct Handler : public Adlib::Handler {
 		}
 	}
 
+	bool Render(int32_t *out, Bitu samples) override {
+		int16_t buf[1024 * 2];
+		while (samples > 0) {
+			uint32_t todo = samples > 1024 ? 1024 : (uint32_t)samples;
+			OPL3_GenerateStream(&chip, buf, todo);
+			for (uint32_t i = 0; i < todo * 2; i++)
+				*out++ = buf[i];
+			samples -= todo;
+		}
+		return true;
+	}
+
 	void Init(Bitu rate) override {
 		newm = 0;
 		OPL3_Reset(&chip, (uint32_t)rate);
 	}
 
+	// the chip points into itself, move those pointers over from where it was saved
+	template <typename T> void Relocate(T* &p, uintptr_t base) {
+		if (p) p = (T*)((uintptr_t)&chip + ((uintptr_t)p - base));
+	}
+
+	void SaveState( std::ostream& stream ) override {
+		const char pod_name[32] = "NukedOPL";
+		const uintptr_t base = (uintptr_t)&chip;
+
+		if( stream.fail() ) return;
+
+
+		WRITE_POD( &pod_name, pod_name );
+
+		//************************************************
+		//************************************************
+		//************************************************
+
+		WRITE_POD( &base, base );
+		WRITE_POD( &chip, chip );
+		WRITE_POD( &newm, newm );
+	}
+
+	void LoadState( std::istream& stream ) override {
+		char pod_name[32] = {0};
+		uintptr_t base = 0;
+
+		if( stream.fail() ) return;
+
+
+		// error checking
+		READ_POD( &pod_name, pod_name );
+		if( strcmp( pod_name, "NukedOPL" ) ) {
+			stream.clear( std::istream::failbit | std::istream::badbit );
+			return;
+		}
+
+		//************************************************
+		//************************************************
+		//************************************************
+
+		READ_POD( &base, base );
+		READ_POD( &chip, chip );
+		READ_POD( &newm, newm );
+
+		for (opl3_slot &slot : chip.slot) {
+			Relocate(slot.channel, base);
+			Relocate(slot.chip, base);
+			Relocate(slot.mod, base);
+			Relocate(slot.trem, base);
+		}
+		for (opl3_channel &channel : chip.channel) {
+			Relocate(channel.slotz[0], base);
+			Relocate(channel.slotz[1], base);
+			Relocate(channel.pair, base);
+			Relocate(channel.chip, base);
+			for (int16_t* &out : channel.out) Relocate(out, base);
+		}
+	}
+
 	~Handler() {
 	}
 };
@@ -339,6 +448,17 @@ struct Handler : public Adlib::Handler {
 			chan->AddSamples_m16(todo, buf);
 		}
 	}
+	bool Render(int32_t* out, Bitu samples) override {
+		int16_t buf[1024];
+		while (samples > 0) {
+			Bitu todo = samples > 1024 ? 1024 : samples;
+			samples -= todo;
+			ym3812_update_one(chip, buf, (int)todo);
+			for (Bitu i = 0; i < todo; i++, out += 2)
+				out[0] = out[1] = buf[i];
+		}
+		return true;
+	}
 	void Init(Bitu rate) override {
 		chip = ym3812_init(nullptr, OPL2_INTERNAL_FREQ, (uint32_t)rate);
 	}
@@ -414,6 +534,21 @@ struct Handler : public Adlib::Handler {
 			chan->AddSamples_s16(todo, result[0]);
 		}
 	}
+	bool Render(int32_t* out, Bitu samples) override {
+		int16_t buf[4][1024];
+		int16_t* buffers[4] = { buf[0], buf[1], buf[2], buf[3] };
+
+		while (samples > 0) {
+			Bitu todo = samples > 1024 ? 1024 : samples;
+			samples -= todo;
+			ymf262_update_one(chip, buffers, (int)todo);
+			for (Bitu i = 0; i < todo; i++, out += 2) {
+				out[0] = buf[0][i];
+				out[1] = buf[1][i];
+			}
+		}
+		return true;
+	}
 	void Init(Bitu rate) override {
 		chip = ymf262_init(nullptr, OPL3_INTERNAL_FREQ, (int)rate);
 	}
@@ -589,6 +724,178 @@ namespace Retrowave_OPL3 {
 	};
 }
 
+namespace OPLThread {
+
+/* Runs another handler on the worker pool ("oplthread"). Register writes are stamped with the
+ * sample they land on and queued, a task applies them while rendering ahead into a ring and the
+ * mixer callback plays the ring back DELAY_MS behind, which leaves the task that long to catch
+ * up before the callback has to wait for it. Address writes are decoded here so they don't have
+ * to wait for the chip, except on ESFM where anything that looks at the chip waits for every
+ * write so far to be rendered and applied. */
+struct Handler : public Adlib::Handler {
+	enum Addressing {
+		ADDR_PLAIN,		//the address is the value written
+		ADDR_OPL3,		//the second register set on port 2 once OPL3 mode is on, or for register 5
+		ADDR_CHIP		//ask the chip
+	};
+	enum {
+		DELAY_MS = 4,
+		RING = 4096,		//frames, more than DELAY_MS plus the largest piece at any rate
+		PIECE = 1024		//largest number of frames handed to the mixer at once
+	};
+	struct Write {
+		uint64_t time;
+		uint32_t reg;
+		uint8_t val;
+	};
+
+	Adlib::Handler* inner;
+	const Addressing addressing;
+	uint8_t newm = 0;
+	ThreadPoolGroup group;
+	std::vector<Write> pending;		//writes the task hasn't been given yet
+	std::vector<Write> task_writes;	//owned by the task while it runs
+	uint64_t task_target = 0;
+	uint64_t clock = 0;				//frames asked for by the mixer, writes land before this one
+	uint64_t zero_before = 0;		//frames before this one were never rendered, play silence
+	uint64_t delay = 0;
+	std::atomic<uint64_t> rendered{0};
+	int32_t ring[RING][2] = {};
+
+	Handler( Adlib::Handler* _inner, Addressing _addressing ) : inner(_inner), addressing(_addressing) {
+	}
+
+	void RenderTo( uint64_t end ) {
+		uint64_t pos = rendered.load(std::memory_order_relaxed);
+		while ( pos < end ) {
+			Bitu todo = (Bitu)(end - pos);
+			const Bitu space = RING - (Bitu)(pos & (RING - 1));
+			if ( todo > space ) todo = space;
+			if ( todo > 512 ) todo = 512;
+			inner->Render( ring[pos & (RING - 1)], todo );
+			pos += todo;
+			rendered.store( pos, std::memory_order_release );
+		}
+	}
+
+	void Work() {
+		for ( const Write &w : task_writes ) {
+			RenderTo( w.time );
+			inner->WriteReg( w.reg, w.val );
+		}
+		RenderTo( task_target );
+	}
+
+	//Hand the queued writes to a new task, unless one is still busy
+	void Kick() {
+		if ( !group.done() ) return;
+		task_writes.swap( pending );
+		pending.clear();
+		task_target = clock;
+		group.run( [this]{ Work(); } );
+	}
+
+	//Render and apply everything up to now, the chip can be looked at after this
+	void Flush() {
+		group.wait();
+		Kick();
+		group.wait();
+	}
+
+	uint32_t WriteAddr( uint32_t port, uint8_t val ) override {
+		switch ( addressing ) {
+		case ADDR_OPL3:
+			if ( (port & 2) && (val == 0x05 || newm) )
+				return 0x100u | val;
+			return val;
+		case ADDR_CHIP:
+			Flush();
+			return inner->WriteAddr( port, val );
+		default:
+			return val;
+		}
+	}
+
+	void WriteReg( uint32_t reg, uint8_t val ) override {
+		if ( reg == 0x105 )
+			newm = val & 0x01;
+		pending.push_back( { clock, reg, val } );
+	}
+
+	uint8_t ReadbackReg( uint32_t reg ) override {
+		Flush();
+		return inner->ReadbackReg( reg );
+	}
+
+	void ESFMSetEmulationMode() override {
+		Flush();
+		inner->ESFMSetEmulationMode();
+	}
+
+	void Generate( MixerChannel* chan, Bitu samples ) override {
+		int32_t buf[PIECE][2];
+
+		while ( samples > 0 ) {
+			const Bitu todo = samples > (Bitu)PIECE ? (Bitu)PIECE : samples;
+			samples -= todo;
+			clock += todo;
+			Kick();
+
+			//play back the frames from delay ago, waiting for the task if it is behind
+			const uint64_t end = clock > delay ? clock - delay : 0;
+			if ( rendered.load(std::memory_order_acquire) < end ) {
+				group.wait();
+				if ( rendered.load(std::memory_order_acquire) < end ) Flush();
+			}
+			uint64_t pos = end - (end >= todo ? todo : end);
+			Bitu lead = todo - (Bitu)(end - pos);
+			for ( Bitu i = 0; i < todo; i++ ) {
+				if ( i < lead || pos < zero_before ) {
+					buf[i][0] = buf[i][1] = 0;
+				} else {
+					buf[i][0] = ring[pos & (RING - 1)][0];
+					buf[i][1] = ring[pos & (RING - 1)][1];
+				}
+				if ( i >= lead ) pos++;
+			}
+			chan->AddSamples_s32( todo, buf[0] );
+		}
+	}
+
+	bool Render( int32_t* buf, Bitu samples ) override {
+		(void)buf; (void)samples;
+		return false;
+	}
+
+	void Init( Bitu rate ) override {
+		delay = (uint64_t)rate * DELAY_MS / 1000u;
+		inner->Init( rate );
+	}
+
+	void SaveState( std::ostream& stream ) override {
+		Flush();
+		inner->SaveState( stream );
+	}
+
+	void LoadState( std::istream& stream ) override {
+		group.wait();
+		pending.clear();
+		inner->LoadState( stream );
+		//the OPL3 mode bit came back with the chip
+		if ( addressing == ADDR_OPL3 )
+			newm = ( inner->WriteAddr( 2, 0x00 ) & 0x100 ) ? 1 : 0;
+		rendered.store( clock, std::memory_order_release );
+		zero_before = clock;
+	}
+
+	~Handler() {
+		group.wait();
+		delete inner;
+	}
+};
+
+}
+
 #define RAW_SIZE 1024
 
 
@@ -1051,9 +1358,7 @@ void Module::PortWrite( Bitu port, Bitu val, Bitu iolen ) {
 	//Keep track of last write time
 	lastUsed = (uint32_t)PIC_Ticks;
 	//Maybe only enable with a keyon?
-	if ( !mixerChan->enabled ) {
-		mixerChan->Enable(true);
-	}
+	mixerChan->Wake();
 
 	if ( mode == MODE_ESFM && esfm_nativemode ) {
 		switch (port & 3)
@@ -1425,7 +1730,8 @@ Module::Module( Section* configuration ) : Module_base(configuration) {
 		else {
 			handler = new OPL3::Handler();
 		}
-	} else if (oplemu == "nuked") {
+	} else if (oplemu == "nuked" || oplemu == "default") {
+		oplemu = "nuked";
 		handler = new NukedOPL::Handler();
 	}
 	else if (oplemu == "opl2board") {
@@ -1452,15 +1758,33 @@ Module::Module( Section* configuration ) : Module_base(configuration) {
 		// ESFMu only supports 49716 Hz sample rate, override it here.
 		rate = 49716;
 	}
-	//Fall back to dbop, will also catch auto
+	//Fall back to dbop, will also catch anything unknown
 	else if (oplemu == "fast" || 1) {
 		const bool opl3Mode = oplmode >= OPL_opl3;
 		handler = new DBOPL::Handler( opl3Mode );
 	}
 
+	if ( section->Get_bool( "oplthread" ) ) {
+		//Only the emulators can render into memory, the hardware ones are left alone
+		if ( handler->Render( nullptr, 0 ) ) {
+			OPLThread::Handler::Addressing addressing = OPLThread::Handler::ADDR_OPL3;
+			if ( oplemu == "esfmu" )
+				addressing = OPLThread::Handler::ADDR_CHIP;
+			else if ( oplemu == "mame" || (oplemu == "compat" && oplmode == OPL_opl2) )
+				addressing = OPLThread::Handler::ADDR_PLAIN;
+			handler = new OPLThread::Handler( handler, addressing );
+			LOG(LOG_MISC,LOG_DEBUG)("Adlib: rendering on the worker threads");
+		}
+		else {
+			LOG_MSG("Adlib: oplthread has no effect with oplemu=%s", oplemu.c_str());
+		}
+	}
+
 	mixerChan = mixerObject.Install(OPL_CallBack,rate,"FM");
 	//Used to be 2.0, which was measured to be too high. Exact value depends on card/clone.
 	mixerChan->SetScale( 1.5f );
+	//The chip can't start making sound again without a register write
+	mixerChan->SetIdleTimeout( 1000 );
 
 	usedoplemu = oplemu;
 	handler->Init( rate );
@@ -157,6 +157,8 @@ public:
 	virtual void ESFMSetEmulationMode() {};
 	//Generate a certain amount of samples
 	virtual void Generate( MixerChannel* chan, Bitu samples ) = 0;
+	//Generate stereo samples into memory for the OPL thread, false if this handler can't
+	virtual bool Render( int32_t* buf, Bitu samples ) { (void)buf; (void)samples; return false; }
 	//Initialize at a specific sample rate and mode
 	virtual void Init( Bitu rate ) = 0;
 	virtual void SaveState( std::ostream& stream ) { (void)stream; }
@@ -171,7 +171,8 @@ static const uint16_t WaveStartTable[8] = {
 #endif
 
 #if ( DBOPL_WAVE == WAVE_TABLEMUL )
-static uint16_t MulTable[ 384 ];
+//One extra zero entry so a silent volume clamped to ENV_LIMIT multiplies to 0
+static uint16_t MulTable[ ENV_LIMIT + 1 ];
 #endif
 
 static uint8_t KslTable[ 8 * 16 ];
@@ -600,6 +601,125 @@ Bits /*INLINE*/ Operator::GetSample( Bits modulation ) {
 	}
 }
 
+/*
+	Run GetSample over a block of samples one operator at a time instead of one sample at a time.
+	The envelope still steps sample by sample, but only as long as it can change and into a
+	small table, after which the wave index, volume and multiply go several samples at a time.
+*/
+
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64)
+#include <emmintrin.h>
+#define DBOPL_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DBOPL_SIMD_NEON 1
+#endif
+#endif
+
+//Largest run of samples the operators are handled in
+#define OP_BLOCK 64
+
+//Fill vol with currentLevel + envelope for the coming samples, returns false if all of them are silent
+bool Operator::ForwardVolumes( uint16_t* vol, Bitu samples ) {
+	Bitu low;
+	if ( state == OFF || ( state == SUSTAIN && ( reg20 & MASK_SUSTAIN ) ) || ( state == ATTACK && ( rateZero & ( 1 << ATTACK ) ) ) ) {
+		//Envelope can't change until a register does
+		low = ForwardVolume();
+		for ( Bitu i = 0; i < samples; i++ )
+			vol[i] = (uint16_t)low;
+	} else {
+		low = ENV_MAX << 1;
+		for ( Bitu i = 0; i < samples; i++ ) {
+			const Bitu v = ForwardVolume();
+			vol[i] = (uint16_t)v;
+			if ( v < low )
+				low = v;
+		}
+	}
+	return !ENV_SILENT( low );
+}
+
+void Operator::GetSamples( int32_t* out, const int32_t* mod, Bitu samples ) {
+	uint16_t vol[ OP_BLOCK ];
+	if ( !ForwardVolumes( vol, samples ) ) {
+		waveIndex += (uint32_t)(waveCurrent * samples);
+		memset( out, 0, sizeof(int32_t) * samples );
+		return;
+	}
+	Bitu i = 0;
+#if DBOPL_SIMD_SSE2
+	{
+		alignas(16) uint32_t idx[8];
+		alignas(16) uint16_t mul[8];
+		const uint32_t w = waveIndex, c = waveCurrent;
+		__m128i p0 = _mm_setr_epi32( (int)(w + c), (int)(w + c * 2), (int)(w + c * 3), (int)(w + c * 4) );
+		__m128i p1 = _mm_add_epi32( p0, _mm_set1_epi32( (int)(c * 4) ) );
+		const __m128i step = _mm_set1_epi32( (int)(c * 8) );
+		const __m128i mask = _mm_set1_epi32( (int)waveMask );
+		const __m128i limit = _mm_set1_epi16( ENV_LIMIT );
+		for ( ; i + 8 <= samples; i += 8 ) {
+			__m128i i0 = _mm_srli_epi32( p0, WAVE_SH );
+			__m128i i1 = _mm_srli_epi32( p1, WAVE_SH );
+			if ( mod ) {
+				i0 = _mm_add_epi32( i0, _mm_loadu_si128( (const __m128i*)(mod + i) ) );
+				i1 = _mm_add_epi32( i1, _mm_loadu_si128( (const __m128i*)(mod + i + 4) ) );
+			}
+			_mm_store_si128( (__m128i*)idx, _mm_and_si128( i0, mask ) );
+			_mm_store_si128( (__m128i*)(idx + 4), _mm_and_si128( i1, mask ) );
+			//Silent volumes all land on the zero at the end of MulTable
+			_mm_store_si128( (__m128i*)mul, _mm_min_epi16( _mm_loadu_si128( (const __m128i*)(vol + i) ), limit ) );
+			const __m128i wv = _mm_setr_epi16( waveBase[ idx[0] ], waveBase[ idx[1] ], waveBase[ idx[2] ], waveBase[ idx[3] ],
+				waveBase[ idx[4] ], waveBase[ idx[5] ], waveBase[ idx[6] ], waveBase[ idx[7] ] );
+			const __m128i mv = _mm_setr_epi16( (short)MulTable[ mul[0] ], (short)MulTable[ mul[1] ], (short)MulTable[ mul[2] ], (short)MulTable[ mul[3] ],
+				(short)MulTable[ mul[4] ], (short)MulTable[ mul[5] ], (short)MulTable[ mul[6] ], (short)MulTable[ mul[7] ] );
+			//(wave * mul) >> MUL_SH with mul unsigned, mulhi takes it as signed so add the wave back where the top bit is set
+			const __m128i r = _mm_add_epi16( _mm_mulhi_epi16( wv, mv ), _mm_and_si128( wv, _mm_srai_epi16( mv, 15 ) ) );
+			_mm_storeu_si128( (__m128i*)(out + i), _mm_srai_epi32( _mm_unpacklo_epi16( r, r ), 16 ) );
+			_mm_storeu_si128( (__m128i*)(out + i + 4), _mm_srai_epi32( _mm_unpackhi_epi16( r, r ), 16 ) );
+			p0 = _mm_add_epi32( p0, step );
+			p1 = _mm_add_epi32( p1, step );
+		}
+		waveIndex += (uint32_t)(c * i);
+	}
+#elif DBOPL_SIMD_NEON
+	{
+		uint32_t idx[4];
+		const uint32_t w = waveIndex, c = waveCurrent;
+		const uint32_t init[4] = { w + c, w + c * 2, w + c * 3, w + c * 4 };
+		uint32x4_t p = vld1q_u32( init );
+		const uint32x4_t step = vdupq_n_u32( c * 4 );
+		const uint32x4_t mask = vdupq_n_u32( waveMask );
+		for ( ; i + 4 <= samples; i += 4 ) {
+			uint32x4_t ix = vshrq_n_u32( p, WAVE_SH );
+			if ( mod )
+				ix = vaddq_u32( ix, vreinterpretq_u32_s32( vld1q_s32( mod + i ) ) );
+			vst1q_u32( idx, vandq_u32( ix, mask ) );
+			const uint16x4_t v = vmin_u16( vld1_u16( vol + i ), vdup_n_u16( ENV_LIMIT ) );
+			const int16_t wv[4] = { waveBase[ idx[0] ], waveBase[ idx[1] ], waveBase[ idx[2] ], waveBase[ idx[3] ] };
+			const uint16_t mv[4] = { MulTable[ vget_lane_u16( v, 0 ) ], MulTable[ vget_lane_u16( v, 1 ) ],
+				MulTable[ vget_lane_u16( v, 2 ) ], MulTable[ vget_lane_u16( v, 3 ) ] };
+			const int32x4_t r = vmulq_s32( vmovl_s16( vld1_s16( wv ) ), vreinterpretq_s32_u32( vmovl_u16( vld1_u16( mv ) ) ) );
+			vst1q_s32( out + i, vshrq_n_s32( r, MUL_SH ) );
+			p = vaddq_u32( p, step );
+		}
+		waveIndex += (uint32_t)(c * i);
+	}
+#endif
+	for ( ; i < samples; i++ ) {
+		const Bitu v = vol[i];
+		if ( ENV_SILENT( v ) ) {
+			waveIndex += waveCurrent;
+			out[i] = 0;
+		} else {
+			Bitu index = ForwardWave();
+			if ( mod )
+				index += (Bitu)(Bits)mod[i];
+			out[i] = (int32_t)GetWave( index, v );
+		}
+	}
+}
+
 Operator::Operator() {
 	chanData = 0;
 	freqMul = 0;
@@ -906,49 +1026,63 @@ Channel* Channel::BlockTemplate( Chip* chip, uint32_t samples, int32_t* output )
 		Op( 4 )->Prepare( chip );
 		Op( 5 )->Prepare( chip );
 	}
-	for ( Bitu i = 0; i < samples; i++ ) {
-		//Early out for percussion handlers
-		if ( mode == sm2Percussion ) {
+	//Early out for percussion handlers
+	if ( mode == sm2Percussion ) {
+		for ( Bitu i = 0; i < samples; i++ )
 			GeneratePercussion<false>( chip, output + i );
-			continue;	//Prevent some uninitialized value bitching
-		} else if ( mode == sm3Percussion ) {
+		return ( this + 3 );
+	} else if ( mode == sm3Percussion ) {
+		for ( Bitu i = 0; i < samples; i++ )
 			GeneratePercussion<true>( chip, output + i * 2 );
-			continue;	//Prevent some uninitialized value bitching
+		return ( this + 3 );
+	}
+	//Only the first operator feeds back on itself, every other operator just takes the
+	//output of the one before it for the same sample, so the rest go one block at a time
+	int32_t out0[ OP_BLOCK ], a[ OP_BLOCK ], b[ OP_BLOCK ];
+	for ( Bitu done = 0; done < samples; ) {
+		const Bitu todo = ( samples - done ) < OP_BLOCK ? ( samples - done ) : OP_BLOCK;
+		for ( Bitu i = 0; i < todo; i++ ) {
+			//Do unsigned shift so we can shift out all bits but still stay in 10 bit range otherwise
+			int32_t mod = (int32_t)((uint32_t)((old[0] + old[1])) >> feedback);
+			old[0] = old[1];
+			old[1] = (int32_t)Op(0)->GetSample( mod );
+			out0[i] = old[0];
 		}
-
-		//Do unsigned shift so we can shift out all bits but still stay in 10 bit range otherwise
-		int32_t mod = (int32_t)((uint32_t)((old[0] + old[1])) >> feedback);
-		old[0] = old[1];
-		old[1] = (int32_t)Op(0)->GetSample( mod );
-		int32_t sample;
-		int32_t out0 = old[0];
 		if ( mode == sm2AM || mode == sm3AM ) {
-			sample = (int32_t)(out0 + Op(1)->GetSample( 0 ));
+			Op(1)->GetSamples( a, nullptr, todo );
+			for ( Bitu i = 0; i < todo; i++ )
+				a[i] += out0[i];
 		} else if ( mode == sm2FM || mode == sm3FM ) {
-			sample = (int32_t)Op(1)->GetSample( out0 );
+			Op(1)->GetSamples( a, out0, todo );
 		} else if ( mode == sm3FMFM ) {
-			Bits next = Op(1)->GetSample( out0 ); 
-			next = Op(2)->GetSample( next );
-			sample = (int32_t)Op(3)->GetSample( next );
+			Op(1)->GetSamples( a, out0, todo );
+			Op(2)->GetSamples( b, a, todo );
+			Op(3)->GetSamples( a, b, todo );
 		} else if ( mode == sm3AMFM ) {
-			sample = out0;
-			Bits next = Op(1)->GetSample( 0 ); 
-			next = Op(2)->GetSample( next );
-			sample += (int32_t)Op(3)->GetSample( next );
+			Op(1)->GetSamples( a, nullptr, todo );
+			Op(2)->GetSamples( b, a, todo );
+			Op(3)->GetSamples( a, b, todo );
+			for ( Bitu i = 0; i < todo; i++ )
+				a[i] += out0[i];
 		} else if ( mode == sm3FMAM ) {
-			sample = (int32_t)Op(1)->GetSample( out0 );
-			Bits next = Op(2)->GetSample( 0 );
-			sample += (int32_t)Op(3)->GetSample( next );
+			Op(1)->GetSamples( a, out0, todo );
+			Op(2)->GetSamples( b, nullptr, todo );
+			Op(3)->GetSamples( b, b, todo );
+			for ( Bitu i = 0; i < todo; i++ )
+				a[i] += b[i];
 		} else if ( mode == sm3AMAM ) {
-			sample = out0;
-			Bits next = Op(1)->GetSample( 0 ); 
-			sample += (int32_t)Op(2)->GetSample( next );
-			sample += (int32_t)Op(3)->GetSample( 0 );
+			Op(1)->GetSamples( a, nullptr, todo );
+			Op(2)->GetSamples( b, a, todo );
+			Op(3)->GetSamples( a, nullptr, todo );
+			for ( Bitu i = 0; i < todo; i++ )
+				a[i] += out0[i] + b[i];
 		}
+		int32_t* out = output + ( ( mode == sm2AM || mode == sm2FM ) ? done : done * 2 );
 		switch( mode ) {
 		case sm2AM:
 		case sm2FM:
-			output[ i ] += sample;
+			for ( Bitu i = 0; i < todo; i++ )
+				out[ i ] += a[ i ];
 			break;
 		case sm3AM:
 		case sm3FM:
@@ -956,12 +1090,15 @@ Channel* Channel::BlockTemplate( Chip* chip, uint32_t samples, int32_t* output )
 		case sm3AMFM:
 		case sm3FMAM:
 		case sm3AMAM:
-			output[ i * 2 + 0 ] += sample & maskLeft;
-			output[ i * 2 + 1 ] += sample & maskRight;
+			for ( Bitu i = 0; i < todo; i++ ) {
+				out[ i * 2 + 0 ] += a[ i ] & maskLeft;
+				out[ i * 2 + 1 ] += a[ i ] & maskRight;
+			}
 			break;
 		default:
 			break;
 		}
+		done += todo;
 	}
 	switch( mode ) {
 	case sm2AM:
@@ -1523,6 +1660,18 @@ void Handler::Generate( MixerChannel* chan, Bitu samples ) {
 	}
 }
 
+bool Handler::Render( int32_t* buf, Bitu samples ) {
+	if ( !chip.opl3Active ) {
+		chip.GenerateBlock2( samples, buf );
+		//Spread the mono samples out to stereo, from the back so nothing is overwritten early
+		for ( Bitu i = samples; i-- > 0; )
+			buf[i*2] = buf[i*2+1] = buf[i];
+	} else {
+		chip.GenerateBlock3( samples, buf );
+	}
+	return true;
+}
+
 void Handler::Init( Bitu rate ) {
 	InitTables();
 	chip.Setup( (uint32_t)rate );
@@ -151,6 +151,9 @@ public:
 
 	Bits GetSample( Bits modulation );
 	Bits GetWave( Bitu index, Bitu vol );
+	//Same as calling GetSample for each of the samples in a row, mod can be nullptr for none
+	bool ForwardVolumes( uint16_t* vol, Bitu samples );
+	void GetSamples( int32_t* out, const int32_t* mod, Bitu samples );
 public:
 	Operator();
 };
@@ -253,6 +256,7 @@ struct Handler : public Adlib::Handler {
 	uint32_t WriteAddr( uint32_t port, uint8_t val ) override;
 	void WriteReg( uint32_t addr, uint8_t val ) override;
 	void Generate( MixerChannel* chan, Bitu samples ) override;
+	bool Render( int32_t* buf, Bitu samples ) override;
 	void Init( Bitu rate ) override;
 	void SaveState( std::ostream& stream ) override;
 	void LoadState( std::istream& stream ) override;
@@ -439,6 +439,71 @@ DmaChannel::DmaChannel(uint8_t num, bool dma16) {
 	request = false;
 }
 
+/* Step the channel past "cando" transfer units that the caller has just moved, including the
+ * PC-98 bank increment and terminal count handling. Returns false if the channel masked itself
+ * at terminal count, in which case the transfer must stop. */
+bool DmaChannel::AdvanceTransfer(Bitu cando) {
+    if (increment) curraddr += (uint32_t)cando;
+    else curraddr -= (uint32_t)cando;
+
+    curraddr &= dma_wrapping;
+    currcnt -= (uint16_t)cando;
+
+    if (IS_PC98_ARCH) {
+        /* check wraparound, to emulate auto bank increment.
+         * do not check DMA16 because PC-98 does not have 16-bit DMA channels.
+         *
+         * The PC-98 port of Sim City 2000 needs this to properly play digitized speech,
+         * especially "reticulating splines". */
+        if ((( increment) && (curraddr & 0xFFFFu) == 0u) ||
+            ((!increment) && (curraddr & 0xFFFFu) == 0xFFFFu)) {
+            page_bank_increment();
+        }
+    }
+
+    if (currcnt == 0xFFFF) {
+        ReachedTC();
+        if (autoinit) {
+            currcnt = basecnt;
+            curraddr = baseaddr;
+            UpdateEMSMapping();
+        } else {
+            /* NTS: This is what the 8237 actually does: Sets TC and sets the mask bit of the channel.
+             *
+             *      "8237A
+             *      Table 1. Pin Description (Continued)
+             *      Symbol Type Name and Function
+             *      EOP I/O END OF PROCESS: End of Process is an active low bidirectional
+             *      signal. Information concerning the completion of DMA services is
+             *      available at the bidirectional EOP pin. The 8237A allows an
+             *      external signal to terminate an active DMA service. This is
+             *      accomplished by pulling the EOP input low with an external EOP
+             *      signal. The 8237A also generates a pulse when the terminal count
+             *      (TC) for any channel is reached. This generates an EOP signal
+             *      which is output through the EOP line. The reception of EOP, either
+             *      internal or external, will cause the 8237A to terminate the service,
+             *      reset the request, and, if Autoinitialize is enabled, to write the base
+             *      registers to the current registers of that channel. The mask bit and
+             *      TC bit in the status word will be set for the currently active channel
+             *      by EOP unless the channel is programmed for Autoinitialize. In that
+             *      case, the mask bit remains unchanged. During memory-to-memory
+             *      transfers, EOP will be output when the TC for channel 1 occurs.
+             *      EOP should be tied high with a pull-up resistor if it is not used to
+             *      prevent erroneous end of process inputs."
+             *
+             *      [http://hackipedia.org/browse.cgi/Computer/Platform/PC%2c%20IBM%20compatible/DMA%20controller/8237/8237A%20HIGH%20PERFORMANCE%20PROGRAMMABLE%20DMA%20CONTROLLER%20%288237A%2d5%29%20%281993%2d09%29%2epdf]
+             */
+            masked = true;
+            masked_by = DMAA_CONTROLLER;
+            UpdateEMSMapping();
+            DoCallBack(DMA_MASKED);
+            return false;
+        }
+    }
+
+    return true;
+}
+
 Bitu DmaChannel::Read(Bitu want, uint8_t * buffer) {
 	Bitu done=0;
 	curraddr &= dma_wrapping;
@@ -485,76 +550,55 @@ Bitu DmaChannel::Read(Bitu want, uint8_t * buffer) {
         if (increment) {
             assert((curraddr & (~addrmask)) == ((curraddr + ((uint32_t)cando - 1u)) & (~addrmask)));//check our work, must not cross a 4KB boundary
             DMA_BlockRead4KB<DMA_INCREMENT>(pagebase,curraddr,buffer,cando,DMA16,DMA16_ADDRMASK);
-            curraddr += (uint32_t)cando;
         }
         else {
             assert((curraddr & (~addrmask)) == ((curraddr - ((uint32_t)cando - 1u)) & (~addrmask)));//check our work, must not cross a 4KB boundary
             DMA_BlockRead4KB<DMA_DECREMENT>(pagebase,curraddr,buffer,cando,DMA16,DMA16_ADDRMASK);
-            curraddr -= (uint32_t)cando;
         }
 
-        curraddr &= dma_wrapping;
         buffer += cando << DMA16;
-        currcnt -= (uint16_t)cando;
         want -= cando;
         done += cando;
 
-        if (IS_PC98_ARCH) {
-            /* check wraparound, to emulate auto bank increment.
-             * do not check DMA16 because PC-98 does not have 16-bit DMA channels.
-             *
-             * The PC-98 port of Sim City 2000 needs this to properly play digitized speech,
-             * especially "reticulating splines". */
-            if ((( increment) && (curraddr & 0xFFFFu) == 0u) ||
-                ((!increment) && (curraddr & 0xFFFFu) == 0xFFFFu)) {
-                page_bank_increment();
-            }
-        }
-
-        if (currcnt == 0xFFFF) {
-            ReachedTC();
-            if (autoinit) {
-                currcnt = basecnt;
-                curraddr = baseaddr;
-                UpdateEMSMapping();
-            } else {
-                /* NTS: This is what the 8237 actually does: Sets TC and sets the mask bit of the channel.
-                 *
-                 *      "8237A
-                 *      Table 1. Pin Description (Continued)
-                 *      Symbol Type Name and Function
-                 *      EOP I/O END OF PROCESS: End of Process is an active low bidirectional
-                 *      signal. Information concerning the completion of DMA services is
-                 *      available at the bidirectional EOP pin. The 8237A allows an
-                 *      external signal to terminate an active DMA service. This is
-                 *      accomplished by pulling the EOP input low with an external EOP
-                 *      signal. The 8237A also generates a pulse when the terminal count
-                 *      (TC) for any channel is reached. This generates an EOP signal
-                 *      which is output through the EOP line. The reception of EOP, either
-                 *      internal or external, will cause the 8237A to terminate the service,
-                 *      reset the request, and, if Autoinitialize is enabled, to write the base
-                 *      registers to the current registers of that channel. The mask bit and
-                 *      TC bit in the status word will be set for the currently active channel
-                 *      by EOP unless the channel is programmed for Autoinitialize. In that
-                 *      case, the mask bit remains unchanged. During memory-to-memory
-                 *      transfers, EOP will be output when the TC for channel 1 occurs.
-                 *      EOP should be tied high with a pull-up resistor if it is not used to
-                 *      prevent erroneous end of process inputs."
-                 *
-                 *      [http://hackipedia.org/browse.cgi/Computer/Platform/PC%2c%20IBM%20compatible/DMA%20controller/8237/8237A%20HIGH%20PERFORMANCE%20PROGRAMMABLE%20DMA%20CONTROLLER%20%288237A%2d5%29%20%281993%2d09%29%2epdf]
-                 */
-                masked = true;
-                masked_by = DMAA_CONTROLLER;
-                UpdateEMSMapping();
-                DoCallBack(DMA_MASKED);
-                break;
-            }
-        }
+        if (!AdvanceTransfer(cando)) break;
     }
 
 	return done;
 }
 
+/* Zero-copy variant of Read(): instead of copying into a device buffer, point "span" directly at
+ * the guest RAM the channel would read next and advance the channel as if it had been read.
+ * At most one 4KB page is covered per call, so the caller loops until it has what it wants.
+ *
+ * Returns 0 if the next span cannot be handed out directly (channel masked or not set up for
+ * reading, decrement mode, or the span is not in system RAM), in which case the caller should
+ * fall back to Read(). The pointer is only valid until guest memory changes again, which means
+ * it must be consumed before returning to the CPU core.
+ *
+ * As with Read(), "want" and the return value are in DMA transfer units (WORDs for 16-bit DMA). */
+Bitu DmaChannel::ReadSpan(Bitu want, const uint8_t * &span) {
+    curraddr &= dma_wrapping;
+
+    if (want == 0 || masked || transfer_mode != DMAT_READ || !increment)
+        return 0;
+
+    const uint32_t addrmask = 0xFFFu >> DMA16;
+    const Bitu cando =
+        MIN(MIN(want,Bitu(currcnt+1u)),Bitu((addrmask + 1u) - (curraddr & addrmask)));
+    assert(cando != (Bitu)0);
+
+    unsigned int o_size;
+    PhysPt xfer;
+
+    DMA_BlockReadCommonSetup<DMA_INCREMENT>(/*&*/xfer,/*&*/o_size,pagebase,curraddr,cando,DMA16,DMA16_ADDRMASK);
+    if ((size_t)xfer + o_size > MemSize)
+        return 0;
+
+    span = MemBase + xfer;
+    AdvanceTransfer(cando);
+    return cando;
+}
+
 Bitu DmaChannel::Write(Bitu want, uint8_t * buffer) {
 	Bitu done=0;
 	curraddr &= dma_wrapping;
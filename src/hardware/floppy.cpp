@@ -475,7 +475,7 @@ FloppyController::FloppyController(Section* configuration,unsigned char index):M
 	update_ST3();
 
 	int13fakev86io = section->Get_bool("int13fakev86io");
-	instant_mode = section->Get_bool("instant mode");
+	instant_mode = section->Get_bool("instant mode") || static_cast<Section_prop *>(control->GetSection("dosbox"))->Get_bool("quickboot");
 	register_pnp = section->Get_bool("pnp");
 
 	i = section->Get_int("irq");
@@ -40,8 +40,13 @@ static uint32_t cmsBase;
 static saa1099_device* device[2];
 
 static void write_cms(Bitu port, Bitu val, Bitu /* iolen */) {
-	if(cms_chan && (!cms_chan->enabled)) cms_chan->Enable(true);
+	if(cms_chan) cms_chan->Wake();
 	lastWriteTicks = (uint32_t)PIC_Ticks;
+
+	// render up to now before a data write so the change lands on the right sample
+	// instead of at the start of the next mixer block
+	if ( cms_chan && !( ( port - cmsBase ) & 1 ) ) cms_chan->FillUp();
+
 	switch ( port - cmsBase ) {
 	case 1:
 		device[0]->control_w(0, 0, (u8)val);
@@ -73,6 +78,11 @@ static void CMS_CallBack(Bitu len) {
 			cms_chan->Enable( false );
 			return;
 		}
+		//Both chips silent, suspend them until the next write
+		if ( device[0]->muted() && device[1]->muted() ) {
+			cms_chan->Enable( false );
+			return;
+		}
 		int32_t result[BUFFER_SIZE][2];
 		int16_t work[2][BUFFER_SIZE];
 		int16_t* buffers[2] = { work[0], work[1] };
@@ -142,6 +152,7 @@ public:
 
 		/* Register the Mixer CallBack */
 		cms_chan = MixerChan.Install(CMS_CallBack,sampleRate,"CMS");
+		cms_chan->SetIdleTimeout(1000);
 
 		lastWriteTicks = (uint32_t)PIC_Ticks;
 
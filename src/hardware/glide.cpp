@@ -78,6 +78,7 @@ static float int_to_float(const uint32_t i)
 
 void VFILE_Remove(const char *name,const char *dir = "");
 static void process_msg(Bitu);
+static void run_batch(LinearPt ring);
 
 /** Global Variables **/
 GLIDE_Block glide;
@@ -142,6 +143,13 @@ static void write_gl(Bitu port,Bitu val,Bitu iolen)
     ret_value = G_FAIL;
     FP.grFunction0 = NULL;
 
+    // Run the command ring, its address is in the shared memory
+    if(val == GLIDE_BATCH && glsegment != 0) {
+	MEM_BlockRead32(PhysMake(glsegment,0), param, 4);
+	run_batch(param[0]);
+	return;
+    }
+
     // Allocate shared memory (80 bytes)
     if(val > GLIDE_MAX) {
 	if(glsegment==0 && !DOS_GetMemory_unmapped) {
@@ -162,6 +170,82 @@ static void write_gl(Bitu port,Bitu val,Bitu iolen)
 //  LOG_MSG("Glide:Function %s executed OK", grTable[val].name);
 }
 
+/*
+ * Command ring, so that the guest wrapper can queue many calls (vertices, state changes) and
+ * submit them with one port write instead of a trap per call. The ring is in guest memory and
+ * its linear address goes in the first dword of the shared memory before writing GLIDE_BATCH:
+ *
+ *   +0   FxU32 size    bytes of entries, a multiple of 4
+ *   +4   FxU32 head    offset of the next entry to run, written by the host
+ *   +8   FxU32 tail    offset after the last queued entry, written by the guest
+ *   +12  entries
+ *
+ * An entry is a dword with the call number in the low word and the number of parameter dwords
+ * (at most 20) in the high word, followed by the parameters as they would be in the shared
+ * memory for a single call. An entry ending at size, or a dword of 0xFFFFFFFF, continues at
+ * offset 0. Return values go to the address in the first parameter as usual and can be read
+ * once the doorbell returns. Calls that answer in the port (grLfbLock, ...) are better made the
+ * single way. The port answers G_OK if the ring ran up to tail, G_FAIL if it stopped at a bad
+ * entry, which head then points at. A ring address of 0 only answers G_OK, so that the wrapper
+ * can tell this from hosts without the ring, which take GLIDE_BATCH for activation.
+ */
+static void run_batch(LinearPt ring)
+{
+    ret_value = G_FAIL;
+    if(ring == 0) {
+	ret_value = G_OK;
+	return;
+    }
+
+    const FxU32 size = mem_readd(ring);
+    FxU32 head = mem_readd(ring+4);
+    const FxU32 tail = mem_readd(ring+8);
+    if((size & 3) || (head & 3) || (tail & 3) || head >= size || tail >= size) {
+	LOG_MSG("Glide:Bad command ring at 0x%x (size %u, head %u, tail %u)", (unsigned int)ring, size, head, tail);
+	return;
+    }
+
+    // Bounds a ring the guest broke, every entry or wrap takes at least one dword
+    FxU32 left = size / 4;
+    Bitu calls = 0;
+    while(head != tail) {
+	const FxU32 entry = mem_readd(ring+12+head);
+	if(entry == 0xFFFFFFFF && head != 0 && left-- > 0) {
+	    head = 0;
+	    continue;
+	}
+
+	const Bitu fn = entry & 0xFFFF;
+	const FxU32 count = entry >> 16;
+	if(fn > GLIDE_MAX || count > 20 || head + 4 + count*4 > size || 1 + count > left) {
+	    LOG_MSG("Glide:Bad command ring entry 0x%x at offset %u", entry, head);
+	    mem_writed(ring+4, head);
+	    ret_value = G_FAIL;
+	    return;
+	}
+	left -= 1 + count;
+
+	memset(param, 0, sizeof(param));
+	MEM_BlockRead32(ring+12+head+4, param, count*4);
+	head += 4 + count*4;
+	if(head == size) head = 0;
+
+	ret = 0;
+	ret_value = G_FAIL;
+	FP.grFunction0 = NULL;
+	process_msg(fn);
+	calls++;
+    }
+
+#if LOG_GLIDE
+    LOG_MSG("Glide:Ran %u calls from the command ring", (unsigned int)calls);
+#else
+    (void)calls;
+#endif
+    mem_writed(ring+4, head);
+    ret_value = G_OK;
+}
+
 static void statWMInfo(void)
 {
     // Get hwnd information
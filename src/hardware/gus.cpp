@@ -207,6 +207,71 @@ void GFGus::updateMasterVolume(void) {
 
 static GFGus myGUS;
 
+/* A running voice is rendered in runs of samples in which it can't reach its loop/end point
+ * or the end of its volume ramp, so that within a run the position and volume just step by
+ * a fixed amount. The memory reads are still done one at a time, the interpolation and mixing
+ * below go several samples at a time. */
+#define GUS_RUN 64
+
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64)
+#include <emmintrin.h>
+#define GUS_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GUS_SIMD_NEON 1
+#endif
+
+/* out[i] = (w[i*2] * f[i*2] + w[i*2+1] * f[i*2+1]) >> WAVE_FRACT, which with f[i*2] = (1 << WAVE_FRACT) - f[i*2+1]
+ * is exactly what InterpolateSample() does with the two samples and the fraction */
+static void GUS_Interpolate(int32_t *out, const int16_t *w, const int16_t *f, const unsigned int n) {
+	unsigned int i = 0;
+
+#if GUS_SIMD_SSE2
+	for (;(i + 4) <= n;i += 4) {
+		const __m128i a = _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(w + i * 2)), _mm_loadu_si128((const __m128i*)(f + i * 2)));
+		_mm_storeu_si128((__m128i*)(out + i), _mm_srai_epi32(a, WAVE_FRACT));
+	}
+#elif GUS_SIMD_NEON
+	for (;(i + 4) <= n;i += 4) {
+		const int16x4x2_t a = vld2_s16(w + i * 2), b = vld2_s16(f + i * 2);
+		vst1q_s32(out + i, vshrq_n_s32(vmlal_s16(vmull_s16(a.val[0], b.val[0]), a.val[1], b.val[1]), WAVE_FRACT));
+	}
+#endif
+	for (;i < n;i++)
+		out[i] = ((int32_t)w[i * 2] * f[i * 2] + (int32_t)w[i * 2 + 1] * f[i * 2 + 1]) >> WAVE_FRACT;
+}
+
+/* stream[i*2+c] += s[i] * g[i*2+c], s[] has to fit in 16 bits signed and g[] in 0...32767 */
+static void GUS_Mix(int32_t *stream, const int32_t *s, const int32_t *g, const unsigned int n) {
+	unsigned int i = 0;
+
+#if GUS_SIMD_SSE2
+	for (;(i + 4) <= n;i += 4) {
+		/* the sign extended high half of each sample meets the zero high half of the gain */
+		const __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+		__m128i *d = (__m128i*)(stream + i * 2);
+		_mm_storeu_si128(d, _mm_add_epi32(_mm_loadu_si128(d), _mm_madd_epi16(_mm_unpacklo_epi32(v, v), _mm_loadu_si128((const __m128i*)(g + i * 2)))));
+		_mm_storeu_si128(d + 1, _mm_add_epi32(_mm_loadu_si128(d + 1), _mm_madd_epi16(_mm_unpackhi_epi32(v, v), _mm_loadu_si128((const __m128i*)(g + i * 2 + 4)))));
+	}
+#elif GUS_SIMD_NEON
+	for (;(i + 4) <= n;i += 4) {
+		const int32x4x2_t v = vzipq_s32(vld1q_s32(s + i), vld1q_s32(s + i));
+		vst1q_s32(stream + i * 2, vmlaq_s32(vld1q_s32(stream + i * 2), v.val[0], vld1q_s32(g + i * 2)));
+		vst1q_s32(stream + i * 2 + 4, vmlaq_s32(vld1q_s32(stream + i * 2 + 4), v.val[1], vld1q_s32(g + i * 2 + 4)));
+	}
+#endif
+	for (;i < n;i++) {
+		stream[i * 2] += s[i] * g[i * 2];
+		stream[i * 2 + 1] += s[i] * g[i * 2 + 1];
+	}
+}
+
+/* Output gain of a voice on the left and right output, through the ICS mixer channel mapping if any */
+static inline void GUS_Gains(int32_t *g, const int32_t VolLeft, const int32_t VolRight, const unsigned char Lc, const unsigned char Rc) {
+	g[0] = ((Lc & 1) ? VolLeft : 0) + ((Rc & 1) ? VolRight : 0);
+	g[1] = ((Lc & 2) ? VolLeft : 0) + ((Rc & 2) ? VolRight : 0);
+}
+
 class GUSChannel {
 	public:
 		uint32_t WaveStart;
@@ -409,13 +474,16 @@ class GUSChannel {
 					myGUS.WaveIRQ |= irqmask;
 			}
 		}
-		INLINE void UpdateVolumes(void) {
-			int32_t templeft=(int32_t)RampVol - (int32_t)PanLeft;
+		INLINE void RampVolumes(const uint32_t vol,int32_t &left,int32_t &right) const {
+			int32_t templeft=(int32_t)vol - (int32_t)PanLeft;
 			templeft&=~(templeft >> 31); /* <- NTS: This is a rather elaborate way to clamp negative values to zero using negate and sign extend */
-			int32_t tempright=(int32_t)RampVol - (int32_t)PanRight;
+			int32_t tempright=(int32_t)vol - (int32_t)PanRight;
 			tempright&=~(tempright >> 31); /* <- NTS: This is a rather elaborate way to clamp negative values to zero using negate and sign extend */
-			VolLeft=vol16bit[templeft >> RAMP_FRACT];
-			VolRight=vol16bit[tempright >> RAMP_FRACT];
+			left=vol16bit[templeft >> RAMP_FRACT];
+			right=vol16bit[tempright >> RAMP_FRACT];
+		}
+		INLINE void UpdateVolumes(void) {
+			RampVolumes(RampVol,VolLeft,VolRight);
 		}
 		INLINE void RampUpdate(void) {
 			if (RampCtrl & 0x3) return; /* if the ramping is turned off, then don't change the ramp */
@@ -452,10 +520,103 @@ class GUSChannel {
 			UpdateVolumes();
 		}
 
-		void generateSamples(int32_t* stream, uint32_t len) {
-			int32_t tmpsamp;
-			int i;
+		/* How many more WaveUpdate() calls of a running voice can pass before one hits the loop/end point */
+		unsigned int WaveRun(const unsigned int max) const {
+			const uint32_t top = ((uint32_t)1 << ((uint32_t)WAVE_FRACT + 20u/*1MB*/)) - 1u;
+			uint32_t room;
 
+			if (WaveAddr > top) return 0;
+			if (WaveCtrl & WCTRL_DECREASING) {
+				if (WaveAddr < WaveStart) return 0;
+				room = WaveAddr - WaveStart;
+			}
+			else {
+				const uint32_t end = (WaveEnd < top) ? WaveEnd : top;
+				if (WaveAddr > end) return 0;
+				room = end - WaveAddr;
+			}
+			if (WaveAdd == 0 || (room / WaveAdd) >= max) return max;
+			return room / WaveAdd;
+		}
+		/* How many more RampUpdate() calls of a running ramp can pass before one hits the end or the limits */
+		unsigned int RampRun(const unsigned int max) const {
+			int32_t room;
+
+			if (RampCtrl & 0x40) {
+				room = (int32_t)RampVol - (int32_t)RampStart - 1;
+			}
+			else {
+				const int32_t end = ((int32_t)RampEnd <= (4096 << RAMP_FRACT)) ? ((int32_t)RampEnd - 1) : ((4096 << RAMP_FRACT)-1);
+				room = end - (int32_t)RampVol;
+			}
+			if (room < 0) return 0;
+			if (RampAdd == 0 || ((uint32_t)room / RampAdd) >= max) return max;
+			return (uint32_t)room / RampAdd;
+		}
+		/* One sample the long way, for when the voice or the ramp reaches its end */
+		void generateSample(int32_t* sp, const unsigned char Lc, const unsigned char Rc) {
+			const int32_t tmpsamp = (WaveCtrl & WCTRL_16BIT) ? GetSample16() : GetSample8();
+			const int32_t L = tmpsamp * VolLeft;
+			const int32_t R = tmpsamp * VolRight;
+
+			if (Lc & 1) sp[0] += L;
+			if (Lc & 2) sp[1] += L;
+			if (Rc & 1) sp[0] += R;
+			if (Rc & 2) sp[1] += R;
+
+			WaveUpdate();
+			RampUpdate();
+		}
+		/* n samples in which neither WaveUpdate() nor RampUpdate() reach an end */
+		void generateRun(int32_t* stream, const unsigned int n, const unsigned char Lc, const unsigned char Rc) {
+			int16_t w[GUS_RUN * 2], f[GUS_RUN * 2];
+			int32_t s[GUS_RUN], g[GUS_RUN * 2];
+			const bool bits16 = (WaveCtrl & WCTRL_16BIT) != 0;
+			unsigned int i;
+
+			if ((WaveCtrl & (WCTRL_STOP | WCTRL_STOPPED)) == 0) {
+				const uint32_t add = (WaveCtrl & WCTRL_DECREASING) ? (0u - WaveAdd) : WaveAdd;
+				uint32_t addr = WaveAddr;
+				for (i = 0;i < n;i++) {
+					const uint32_t useAddr = addr >> WAVE_FRACT;
+					w[i * 2] = (int16_t)(bits16 ? myGUS.LoadSample16(useAddr) : myGUS.LoadSample8(useAddr));
+					w[i * 2 + 1] = (int16_t)(bits16 ? myGUS.LoadSample16(useAddr + 1u) : myGUS.LoadSample8(useAddr + 1u));
+					f[i * 2 + 1] = (int16_t)(addr & WAVE_FRACT_MASK);
+					f[i * 2] = (int16_t)((1 << WAVE_FRACT) - f[i * 2 + 1]);
+					addr += add;
+				}
+				WaveAddr = addr;
+				GUS_Interpolate(s, w, f, n);
+			}
+			else {
+				/* stopped voices still play the sample they stopped on */
+				const int32_t tmpsamp = bits16 ? GetSample16() : GetSample8();
+				for (i = 0;i < n;i++) s[i] = tmpsamp;
+				WaveUpdate();
+			}
+
+			GUS_Gains(g, VolLeft, VolRight, Lc, Rc);
+			if ((RampCtrl & 0x3) == 0) {
+				const uint32_t add = (RampCtrl & 0x40) ? (0u - RampAdd) : RampAdd;
+				for (i = 1;i < n;i++) {
+					int32_t l,r;
+					RampVolumes(RampVol += add, l, r);
+					GUS_Gains(g + i * 2, l, r, Lc, Rc);
+				}
+				RampVol += add;
+				UpdateVolumes();
+			}
+			else {
+				for (i = 1;i < n;i++) {
+					g[i * 2] = g[0];
+					g[i * 2 + 1] = g[1];
+				}
+			}
+
+			GUS_Mix(stream, s, g, n);
+		}
+
+		void generateSamples(int32_t* stream, uint32_t len) {
 			/* NTS: The GUS is *always* rendering the audio sample at the current position,
 			 *      even if the voice is stopped. This can be confirmed using DOSLIB, loading
 			 *      the Ultrasound test program, loading a WAV file into memory, then using
@@ -464,50 +625,50 @@ class GUSChannel {
 			 *      is stopped. You will hear "popping" noises come out the GUS audio output
 			 *      as the current position changes and the piece of the sample rendered
 			 *      abruptly changes as well. */
+			// Nothing is output or stepped unless the DAC is enabled
+			if ((myGUS.GUS_reset_reg & 0x02/*DAC enable*/) == 0)
+				return;
+
+			// normal output, or mapped through ICS mixer including channel remapping
+			unsigned char Lc = 1, Rc = 2;
 			if (gus_ics_mixer) {
-				const unsigned char Lc = read_GF1_mapping_control(0);
-				const unsigned char Rc = read_GF1_mapping_control(1);
-
-				// output mapped through ICS mixer including channel remapping
-				for (i = 0; i < (int)len; i++) {
-					// Get sample
-					if (WaveCtrl & WCTRL_16BIT)
-						tmpsamp = GetSample16();
-					else
-						tmpsamp = GetSample8();
-					// Output stereo sample if DAC enable on
-					if ((myGUS.GUS_reset_reg & 0x02/*DAC enable*/) == 0x02) {
-						int32_t* const sp = stream + (i << 1);
-						const int32_t L = tmpsamp * VolLeft;
-						const int32_t R = tmpsamp * VolRight;
-
-						if (Lc & 1) sp[0] += L;
-						if (Lc & 2) sp[1] += L;
-						if (Rc & 1) sp[0] += R;
-						if (Rc & 2) sp[1] += R;
-
-						WaveUpdate();
-						RampUpdate();
+				Lc = read_GF1_mapping_control(0);
+				Rc = read_GF1_mapping_control(1);
+			}
+
+			uint32_t done = 0;
+			while (done < len) {
+				const bool waveRunning = (WaveCtrl & (WCTRL_STOP | WCTRL_STOPPED)) == 0;
+				const bool rampRunning = (RampCtrl & 0x3) == 0;
+
+				if (!waveRunning && !rampRunning) {
+					/* Held voice: the same sample at the same volume until the guest changes something.
+					 * The stopped voice IRQ check in WaveUpdate() gives the same answer every time too.
+					 * This is what most of the 32 voices a tracker asks for are doing most of the time. */
+					int32_t g[2];
+					WaveUpdate();
+					GUS_Gains(g, VolLeft, VolRight, Lc, Rc);
+					if (g[0] | g[1]) {
+						const int32_t tmpsamp = (WaveCtrl & WCTRL_16BIT) ? GetSample16() : GetSample8();
+						const int32_t L = tmpsamp * g[0], R = tmpsamp * g[1];
+						for (;done < len;done++) {
+							stream[done * 2] += L;
+							stream[done * 2 + 1] += R;
+						}
 					}
+					return;
 				}
-			}
-			else {
-				// normal output
-				for (i = 0; i < (int)len; i++) {
-					// Get sample
-					if (WaveCtrl & WCTRL_16BIT)
-						tmpsamp = GetSample16();
-					else
-						tmpsamp = GetSample8();
-
-					// Output stereo sample if DAC enable on
-					if ((myGUS.GUS_reset_reg & 0x02/*DAC enable*/) == 0x02) {
-						stream[i << 1] += tmpsamp * VolLeft;
-						stream[(i << 1) + 1] += tmpsamp * VolRight;
-
-						WaveUpdate();
-						RampUpdate();
-					}
+
+				unsigned int n = ((len - done) < GUS_RUN) ? (len - done) : GUS_RUN;
+				if (waveRunning) n = WaveRun(n);
+				if (rampRunning) n = RampRun(n);
+				if (n != 0) {
+					generateRun(stream + done * 2, n, Lc, Rc);
+					done += n;
+				}
+				else {
+					generateSample(stream + done * 2, Lc, Rc);
+					done++;
 				}
 			}
 		}
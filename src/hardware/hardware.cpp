@@ -37,6 +37,7 @@
 #include "render.h"
 #include "cross.h"
 #include "wave_mmreg.h"
+#include "tracerec.h"
 
 #if (C_SSHOT) || (C_AVCODEC)
 #include <zlib.h>
@@ -48,7 +49,16 @@
 #include "avi_writer.h"
 #include "rawint.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #if (C_AVCODEC)
 extern "C" {
@@ -59,6 +69,8 @@ extern "C" {
 #include <libavformat/avformat.h>
 #include <libavformat/avio.h>
 #include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/hwcontext.h>
 }
 
 /* This code now requires FFMPEG 4 or higher */
@@ -69,6 +81,7 @@ extern "C" {
 #endif
 
 bool video_debug_overlay = false;
+bool video_debug_composited = false;
 bool skip_encoding_unchanged_frames = false, show_recorded_filename = true;
 std::string pathvid = "", pathwav = "", pathmtw = "", pathmid = "", pathopl = "", pathscr = "", pathprt = "", pathpcap = "";
 static std::string last_screenshot_path = "";  // Persists after pathscr is cleared, for remote debugging
@@ -96,6 +109,10 @@ AVFrame*		ffmpeg_aud_frame = NULL;
 AVFrame*		ffmpeg_vid_frame = NULL;
 AVFrame*		ffmpeg_vidrgb_frame = NULL;
 SwsContext*		ffmpeg_sws_ctx = NULL;
+AVBufferRef*		ffmpeg_hw_device = NULL;
+AVBufferRef*		ffmpeg_hw_frames = NULL;
+AVFrame*		ffmpeg_hw_frame = NULL;
+bool			ffmpeg_rgb_direct = false; // encoder takes ffmpeg_vidrgb_frame as is, no swscale
 bool			ffmpeg_avformat_began = false;
 unsigned int		ffmpeg_aud_write = 0;
 uint64_t			ffmpeg_audio_sample_counter = 0;
@@ -103,6 +120,7 @@ uint64_t			ffmpeg_video_frame_time_offset = 0;
 uint64_t			ffmpeg_video_frame_last_time = 0;
 
 int             ffmpeg_yuv_format_choice = -1;  // -1 default  4 = 444   2 = 422   0 = 420
+std::string     ffmpeg_encoder_choice = "software"; // "capture video encoder"
 
 AVPixelFormat ffmpeg_choose_pixfmt(const int x) {
     (void)x;//UNUSED
@@ -118,6 +136,12 @@ AVPixelFormat ffmpeg_choose_pixfmt(const int x) {
     return AV_PIX_FMT_YUV444P;
 }
 
+void ffmpeg_close_hw() {
+	av_frame_free(&ffmpeg_hw_frame);
+	av_buffer_unref(&ffmpeg_hw_frames);
+	av_buffer_unref(&ffmpeg_hw_device);
+}
+
 void ffmpeg_closeall() {
 	if (ffmpeg_fmt_ctx != NULL) {
 		if (ffmpeg_avformat_began) {
@@ -156,6 +180,7 @@ void ffmpeg_closeall() {
 		sws_freeContext(ffmpeg_sws_ctx);
 		ffmpeg_sws_ctx = NULL;
 	}
+	ffmpeg_close_hw();
 	ffmpeg_video_frame_time_offset = 0;
 	ffmpeg_video_frame_last_time = 0;
 	ffmpeg_aud_codec = NULL;
@@ -423,29 +448,127 @@ int ffmpeg_bpp_pick_rgb_format(int bpp) {
 	return 0;
 }
 
-void ffmpeg_reopen_video(double fps,const int bpp) {
-	if (ffmpeg_vid_ctx != NULL) {
-		avcodec_free_context(&ffmpeg_vid_ctx);
-		ffmpeg_vid_ctx = NULL;
+/* [dosbox] "capture video encoder" names and the FFmpeg H.264 encoder behind each of them */
+static const struct {
+	const char *name;
+	const char *encoder;
+} ffmpeg_hw_encoders[] = {
+	{ "nvenc",        "h264_nvenc" },
+	{ "vaapi",        "h264_vaapi" },
+	{ "qsv",          "h264_qsv" },
+	{ "videotoolbox", "h264_videotoolbox" },
+	{ "amf",          "h264_amf" },
+};
+
+/* what "auto" tries, before the software encoder */
+static const char *ffmpeg_hw_auto[] = {
+#if defined(WIN32)
+	"nvenc", "qsv", "amf",
+#elif defined(MACOSX)
+	"videotoolbox",
+#else
+	"nvenc", "vaapi", "qsv",
+#endif
+	NULL
+};
+
+/* hardware frame formats an encoder may insist on, and the device that provides them */
+static const struct {
+	AVPixelFormat format;
+	AVHWDeviceType device;
+} ffmpeg_hw_devices[] = {
+	{ AV_PIX_FMT_VAAPI,        AV_HWDEVICE_TYPE_VAAPI },
+	{ AV_PIX_FMT_QSV,          AV_HWDEVICE_TYPE_QSV },
+	{ AV_PIX_FMT_CUDA,         AV_HWDEVICE_TYPE_CUDA },
+	{ AV_PIX_FMT_VIDEOTOOLBOX, AV_HWDEVICE_TYPE_VIDEOTOOLBOX },
+};
+
+static bool ffmpeg_pixfmt_listed(const AVPixelFormat *list,const AVPixelFormat fmt) {
+	if (fmt == AV_PIX_FMT_NONE) return false;
+	for (;*list != AV_PIX_FMT_NONE;list++) {
+		if (*list == fmt) return true;
 	}
-	if (ffmpeg_vidrgb_frame != NULL) {
-		av_frame_free(&ffmpeg_vidrgb_frame);
-		ffmpeg_vidrgb_frame = NULL;
+	return false;
+}
+
+/* Pick what the encoder is fed. A hardware encoder that takes the RGB layout of the capture
+ * gets it as is, so the colorspace conversion happens on the GPU. Otherwise the configured
+ * chroma format, then 4:2:0, converted by swscale. An encoder that only takes its own
+ * hardware frames gets NV12 uploaded to them, hwfmt returns that frame format then. */
+static AVPixelFormat ffmpeg_negotiate_pixfmt(const AVCodec *codec,const int bpp,const bool hardware,AVPixelFormat &hwfmt) {
+	/* 4:4:4, the software default, is an optional profile on most hardware */
+	const AVPixelFormat want = (hardware && ffmpeg_yuv_format_choice < 0) ? AV_PIX_FMT_NV12 : ffmpeg_choose_pixfmt(ffmpeg_yuv_format_choice);
+	const AVPixelFormat *list = codec->pix_fmts;
+
+	hwfmt = AV_PIX_FMT_NONE;
+	if (list == NULL) return want;
+
+	if (hardware) {
+		const AVPixelFormat rgb = (AVPixelFormat)ffmpeg_bpp_pick_rgb_format(bpp);
+
+		if (ffmpeg_pixfmt_listed(list,rgb)) return rgb;
+		/* same memory layout, the alpha byte is ignored */
+		if (rgb == AV_PIX_FMT_BGRA && ffmpeg_pixfmt_listed(list,AV_PIX_FMT_BGR0)) return AV_PIX_FMT_BGR0;
+		if (rgb == AV_PIX_FMT_RGBA && ffmpeg_pixfmt_listed(list,AV_PIX_FMT_RGB0)) return AV_PIX_FMT_RGB0;
 	}
-	if (ffmpeg_vid_frame != NULL) {
-		av_frame_free(&ffmpeg_vid_frame);
-		ffmpeg_vid_frame = NULL;
+
+	if (ffmpeg_pixfmt_listed(list,want)) return want;
+	if (ffmpeg_pixfmt_listed(list,AV_PIX_FMT_NV12)) return AV_PIX_FMT_NV12;
+	if (ffmpeg_pixfmt_listed(list,AV_PIX_FMT_YUV420P)) return AV_PIX_FMT_YUV420P;
+
+	for (size_t i=0;i < sizeof(ffmpeg_hw_devices)/sizeof(ffmpeg_hw_devices[0]);i++) {
+		if (ffmpeg_pixfmt_listed(list,ffmpeg_hw_devices[i].format)) {
+			hwfmt = ffmpeg_hw_devices[i].format;
+			return AV_PIX_FMT_NV12;
+		}
 	}
-	if (ffmpeg_sws_ctx != NULL) {
-		sws_freeContext(ffmpeg_sws_ctx);
-		ffmpeg_sws_ctx = NULL;
+
+	return AV_PIX_FMT_NONE;
+}
+
+static bool ffmpeg_open_hw_frames(const AVPixelFormat hwfmt,const AVPixelFormat swfmt) {
+	AVHWDeviceType type = AV_HWDEVICE_TYPE_NONE;
+
+	for (size_t i=0;i < sizeof(ffmpeg_hw_devices)/sizeof(ffmpeg_hw_devices[0]);i++) {
+		if (ffmpeg_hw_devices[i].format == hwfmt) type = ffmpeg_hw_devices[i].device;
 	}
 
-	LOG_MSG("Restarting video codec");
+	if (av_hwdevice_ctx_create(&ffmpeg_hw_device,type,NULL,NULL,0) < 0)
+		return false;
+
+	ffmpeg_hw_frames = av_hwframe_ctx_alloc(ffmpeg_hw_device);
+	if (ffmpeg_hw_frames == NULL)
+		return false;
+
+	AVHWFramesContext *frames = (AVHWFramesContext*)ffmpeg_hw_frames->data;
+	frames->format = hwfmt;
+	frames->sw_format = swfmt;
+	frames->width = ffmpeg_vid_ctx->width;
+	frames->height = ffmpeg_vid_ctx->height;
+	frames->initial_pool_size = 20;
+	if (av_hwframe_ctx_init(ffmpeg_hw_frames) < 0)
+		return false;
+
+	ffmpeg_vid_ctx->hw_frames_ctx = av_buffer_ref(ffmpeg_hw_frames);
+	return ffmpeg_vid_ctx->hw_frames_ctx != NULL;
+}
 
-	// FIXME: This is copypasta! Consolidate!
-	ffmpeg_vid_ctx = avcodec_alloc_context3(ffmpeg_vid_codec);
-	if (ffmpeg_vid_ctx == NULL) E_Exit("Error: Unable to reopen vid codec");
+/* Allocate and open ffmpeg_vid_ctx with the named hardware encoder, or the software one for NULL.
+ * Returns false with nothing left allocated if the encoder is missing or will not open. */
+static bool ffmpeg_open_video_encoder(const char *name,double fps,const int bpp) {
+	const bool hardware = name != NULL;
+	const AVCodec *codec = hardware ? avcodec_find_encoder_by_name(name) : avcodec_find_encoder(AV_CODEC_ID_H264);
+	AVPixelFormat hwfmt;
+
+	if (codec == NULL)
+		return false;
+
+	const AVPixelFormat pixfmt = ffmpeg_negotiate_pixfmt(codec,bpp,hardware,hwfmt);
+	if (pixfmt == AV_PIX_FMT_NONE)
+		return false;
+
+	ffmpeg_vid_ctx = avcodec_alloc_context3(codec);
+	if (ffmpeg_vid_ctx == NULL) E_Exit("Error: Unable to open vid context");
 	ffmpeg_vid_ctx->bit_rate = 25000000; // TODO: make configuration option!
 	ffmpeg_vid_ctx->keyint_min = 15; // TODO: make configuration option!
 	ffmpeg_vid_ctx->time_base.num = 1000000;
@@ -454,11 +577,14 @@ void ffmpeg_reopen_video(double fps,const int bpp) {
 	ffmpeg_vid_ctx->height = (int)capture.video.height;
 	ffmpeg_vid_ctx->gop_size = 15; // TODO: make config option
 	ffmpeg_vid_ctx->max_b_frames = 0;
-	ffmpeg_vid_ctx->pix_fmt = ffmpeg_choose_pixfmt(ffmpeg_yuv_format_choice);
+	ffmpeg_vid_ctx->pix_fmt = pixfmt;
 	ffmpeg_vid_ctx->thread_count = 0;		// auto-choose
 	ffmpeg_vid_ctx->flags2 = AV_CODEC_FLAG2_FAST;
-	ffmpeg_vid_ctx->qmin = 1;
-	ffmpeg_vid_ctx->qmax = 63;
+	if (!hardware) {
+		/* the hardware encoders have their own quantizer ranges, some refuse these */
+		ffmpeg_vid_ctx->qmin = 1;
+		ffmpeg_vid_ctx->qmax = 63;
+	}
 	ffmpeg_vid_ctx->rc_max_rate = ffmpeg_vid_ctx->bit_rate;
 	ffmpeg_vid_ctx->rc_min_rate = ffmpeg_vid_ctx->bit_rate;
 	ffmpeg_vid_ctx->rc_buffer_size = (4*1024*1024);
@@ -467,45 +593,106 @@ void ffmpeg_reopen_video(double fps,const int bpp) {
 	ffmpeg_vid_ctx->sample_aspect_ratio.num = 4 * (int)capture.video.height;
 	ffmpeg_vid_ctx->sample_aspect_ratio.den = 3 * (int)capture.video.width;
 
+	if (hwfmt != AV_PIX_FMT_NONE) {
+		if (!ffmpeg_open_hw_frames(hwfmt,pixfmt)) {
+			avcodec_free_context(&ffmpeg_vid_ctx);
+			ffmpeg_close_hw();
+			return false;
+		}
+		ffmpeg_vid_ctx->pix_fmt = hwfmt;
+	}
+
 	{
 		AVDictionary *opts = NULL;
 
-		av_dict_set(&opts,"crf","14",1); /* default is 20, this allows higher quality */
-		av_dict_set(&opts,"crf_max","20",1); /* don't let it get too low quality */
-		av_dict_set(&opts,"preset","superfast",1);
+		if (!hardware) {
+			av_dict_set(&opts,"crf","14",1); /* default is 20, this allows higher quality */
+			av_dict_set(&opts,"crf_max","20",1); /* don't let it get too low quality */
+			av_dict_set(&opts,"preset","superfast",1);
+		}
 		av_dict_set(&opts,"aud","1",1);
 
-		if (avcodec_open2(ffmpeg_vid_ctx,ffmpeg_vid_codec,&opts) < 0) {
-			E_Exit("Unable to open H.264 codec");
+		if (avcodec_open2(ffmpeg_vid_ctx,codec,&opts) < 0) {
+			av_dict_free(&opts);
+			avcodec_free_context(&ffmpeg_vid_ctx);
+			ffmpeg_close_hw();
+			return false;
 		}
 
 		av_dict_free(&opts);
 	}
 
-	if (avcodec_parameters_from_context(ffmpeg_vid_stream->codecpar, ffmpeg_vid_ctx) < 0) {
-		E_Exit("failed to copy video codec parameters");
+	ffmpeg_vid_codec = codec;
+	ffmpeg_rgb_direct = hwfmt == AV_PIX_FMT_NONE &&
+		(pixfmt == (AVPixelFormat)ffmpeg_bpp_pick_rgb_format(bpp) || pixfmt == AV_PIX_FMT_BGR0 || pixfmt == AV_PIX_FMT_RGB0);
+	return true;
+}
+
+/* Open the encoder "capture video encoder" asks for, falling back along the way to the
+ * software encoder, which is always the last one tried */
+static bool ffmpeg_open_video(double fps,const int bpp) {
+	std::vector<const char*> names;
+
+	if (ffmpeg_encoder_choice == "auto") {
+		for (const char **n = ffmpeg_hw_auto;*n != NULL;n++) names.push_back(*n);
+	}
+	else if (ffmpeg_encoder_choice != "software") {
+		names.push_back(ffmpeg_encoder_choice.c_str());
 	}
 
+	for (size_t i=0;i < names.size();i++) {
+		const char *encoder = NULL;
+
+		for (size_t j=0;j < sizeof(ffmpeg_hw_encoders)/sizeof(ffmpeg_hw_encoders[0]);j++) {
+			if (!strcmp(ffmpeg_hw_encoders[j].name,names[i])) encoder = ffmpeg_hw_encoders[j].encoder;
+		}
+		if (encoder == NULL) continue;
+
+		if (ffmpeg_open_video_encoder(encoder,fps,bpp)) {
+			LOG_MSG("Capture: using hardware encoder %s, input %s",encoder,av_get_pix_fmt_name(ffmpeg_vid_ctx->pix_fmt));
+			return true;
+		}
+		LOG_MSG("Capture: hardware encoder %s is not available",encoder);
+	}
+
+	if (ffmpeg_open_video_encoder(NULL,fps,bpp)) {
+		LOG_MSG("Capture: using software encoder %s, input %s",ffmpeg_vid_codec->name,av_get_pix_fmt_name(ffmpeg_vid_ctx->pix_fmt));
+		return true;
+	}
+
+	return false;
+}
+
+/* ffmpeg_vidrgb_frame takes the capture pixels. Unless the encoder takes those as they are,
+ * ffmpeg_vid_frame and the swscale context convert them, and ffmpeg_hw_frame is where they
+ * get uploaded for encoders that need hardware frames. */
+static bool ffmpeg_alloc_video_frames(const int bpp) {
 	ffmpeg_vid_frame = av_frame_alloc();
 	ffmpeg_vidrgb_frame = av_frame_alloc();
-	if (ffmpeg_aud_frame == NULL || ffmpeg_vid_frame == NULL || ffmpeg_vidrgb_frame == NULL)
-		E_Exit(" ");
+	if (ffmpeg_vid_frame == NULL || ffmpeg_vidrgb_frame == NULL)
+		return false;
 
 	ffmpeg_vidrgb_frame->colorspace = AVCOL_SPC_RGB;
 	ffmpeg_vidrgb_frame->width = (int)capture.video.width;
 	ffmpeg_vidrgb_frame->height = (int)capture.video.height;
-	ffmpeg_vidrgb_frame->format = ffmpeg_bpp_pick_rgb_format(bpp);
+	ffmpeg_vidrgb_frame->format = ffmpeg_rgb_direct ? ffmpeg_vid_ctx->pix_fmt : ffmpeg_bpp_pick_rgb_format(bpp);
 	if (av_frame_get_buffer(ffmpeg_vidrgb_frame,64) < 0) {
-		E_Exit(" ");
+		LOG_MSG("Failed to alloc videorgb frame buffer");
+		return false;
 	}
 
+	if (ffmpeg_rgb_direct)
+		return true;
+
 	ffmpeg_vid_frame->colorspace = AVCOL_SPC_SMPTE170M;
 	ffmpeg_vidrgb_frame->color_range = AVCOL_RANGE_MPEG;
 	ffmpeg_vid_frame->width = (int)capture.video.width;
 	ffmpeg_vid_frame->height = (int)capture.video.height;
-	ffmpeg_vid_frame->format = ffmpeg_vid_ctx->pix_fmt;
-	if (av_frame_get_buffer(ffmpeg_vid_frame,64) < 0)
-		E_Exit(" ");
+	ffmpeg_vid_frame->format = (ffmpeg_hw_frames != NULL) ? ((AVHWFramesContext*)ffmpeg_hw_frames->data)->sw_format : ffmpeg_vid_ctx->pix_fmt;
+	if (av_frame_get_buffer(ffmpeg_vid_frame,64) < 0) {
+		LOG_MSG("Failed to alloc video frame buffer");
+		return false;
+	}
 
 	ffmpeg_sws_ctx = sws_getContext(
 			// source
@@ -519,7 +706,49 @@ void ffmpeg_reopen_video(double fps,const int bpp) {
 			// and the rest
 			((ffmpeg_vid_frame->width == ffmpeg_vidrgb_frame->width && ffmpeg_vid_frame->height == ffmpeg_vidrgb_frame->height) ? SWS_POINT : SWS_BILINEAR),
 			NULL,NULL,NULL);
-	if (ffmpeg_sws_ctx == NULL)
+	if (ffmpeg_sws_ctx == NULL) {
+		LOG_MSG("Failed to init colorspace conversion");
+		return false;
+	}
+
+	if (ffmpeg_hw_frames != NULL) {
+		ffmpeg_hw_frame = av_frame_alloc();
+		if (ffmpeg_hw_frame == NULL)
+			return false;
+	}
+
+	return true;
+}
+
+void ffmpeg_reopen_video(double fps,const int bpp) {
+	if (ffmpeg_vid_ctx != NULL) {
+		avcodec_free_context(&ffmpeg_vid_ctx);
+		ffmpeg_vid_ctx = NULL;
+	}
+	if (ffmpeg_vidrgb_frame != NULL) {
+		av_frame_free(&ffmpeg_vidrgb_frame);
+		ffmpeg_vidrgb_frame = NULL;
+	}
+	if (ffmpeg_vid_frame != NULL) {
+		av_frame_free(&ffmpeg_vid_frame);
+		ffmpeg_vid_frame = NULL;
+	}
+	if (ffmpeg_sws_ctx != NULL) {
+		sws_freeContext(ffmpeg_sws_ctx);
+		ffmpeg_sws_ctx = NULL;
+	}
+	ffmpeg_close_hw();
+
+	LOG_MSG("Restarting video codec");
+
+	if (!ffmpeg_open_video(fps,bpp))
+		E_Exit("Unable to open H.264 codec");
+
+	if (avcodec_parameters_from_context(ffmpeg_vid_stream->codecpar, ffmpeg_vid_ctx) < 0) {
+		E_Exit("failed to copy video codec parameters");
+	}
+
+	if (ffmpeg_aud_frame == NULL || !ffmpeg_alloc_video_frames(bpp))
 		E_Exit(" ");
 }
 #endif
@@ -649,6 +878,737 @@ static void CAPTURE_AddAviChunk(const char * tag, uint32_t size, void * data, ui
 }
 #endif
 
+#if (C_SSHOT)
+extern uint32_t GFX_palette32bpp[256];
+
+/* Encode one frame and the audio that came with it into the open AVI or FFmpeg output.
+ * width and height are the captured size (after doubling), data/pitch the source lines.
+ * repeat writes no picture: a null chunk for ZMBV, a skipped timestamp for FFmpeg.
+ * Runs on the emulation thread, or on the capture worker while it exists. */
+static bool CAPTURE_EncodeVideoFrame(Bitu width, Bitu height, Bitu bpp, Bitu pitch, Bitu flags, uint8_t *data, uint8_t *pal, const uint32_t *pal32, zmbv_format_t format, bool repeat, const int16_t *audio, Bitu audioused) {
+	uint8_t doubleRow[SCALER_MAXWIDTH*4];
+	Bitu i;
+
+	(void)pal32;//FFmpeg only
+
+	if (native_zmbv) {
+		int codecFlags;
+
+		if (capture.video.frames % 300 == 0)
+			codecFlags = 1;
+		else
+			codecFlags = 0;
+
+        if (repeat) {
+            /* advance unless at keyframe */
+            if (codecFlags == 0) capture.video.frames++;
+
+            /* write null non-keyframe */
+            CAPTURE_AddAviChunk( "00dc", (uint32_t)0, capture.video.buf, (uint32_t)(0x0), 0u);
+        }
+        else {
+            if (!capture.video.codec->PrepareCompressFrame( codecFlags, format, (char *)pal, capture.video.buf, capture.video.bufSize))
+                return false;
+
+            for (i=0;i<height;i++) {
+                void * rowPointer;
+                if (flags & CAPTURE_FLAG_DBLW) {
+                    void *srcLine;
+                    Bitu x;
+                    Bitu countWidth = width >> 1;
+                    if (flags & CAPTURE_FLAG_DBLH)
+                        srcLine=(data+(i >> 1)*pitch);
+                    else
+                        srcLine=(data+(i >> 0)*pitch);
+                    switch ( bpp) {
+                        case 8:
+                            for (x=0;x<countWidth;x++)
+                                ((uint8_t *)doubleRow)[x*2+0] =
+                                    ((uint8_t *)doubleRow)[x*2+1] = ((uint8_t *)srcLine)[x];
+                            break;
+                        case 15:
+                        case 16:
+                            for (x=0;x<countWidth;x++)
+                                ((uint16_t *)doubleRow)[x*2+0] =
+                                    ((uint16_t *)doubleRow)[x*2+1] = ((uint16_t *)srcLine)[x];
+                            break;
+                        case 32:
+                            for (x=0;x<countWidth;x++)
+                                ((uint32_t *)doubleRow)[x*2+0] =
+                                    ((uint32_t *)doubleRow)[x*2+1] = ((uint32_t *)srcLine)[x];
+                            break;
+                    }
+                    rowPointer=doubleRow;
+                } else {
+                    if (flags & CAPTURE_FLAG_DBLH)
+                        rowPointer=(data+(i >> 1)*pitch);
+                    else
+                        rowPointer=(data+(i >> 0)*pitch);
+                }
+                capture.video.codec->CompressLines( 1, &rowPointer );
+            }
+
+            int written = capture.video.codec->FinishCompressFrame();
+            if (written < 0)
+                return false;
+
+            CAPTURE_AddAviChunk( "00dc", (uint32_t)written, capture.video.buf, (uint32_t)(codecFlags & 1 ? 0x10 : 0x0), 0u);
+            capture.video.frames++;
+        }
+
+		if ( audioused ) {
+			CAPTURE_AddAviChunk( "01wb", (uint32_t)(audioused * 4u), (void *)audio, /*keyframe*/0x10u, 1u);
+			capture.video.audiowritten = audioused*4;
+		}
+	}
+#if (C_AVCODEC)
+	else if (export_ffmpeg && ffmpeg_fmt_ctx != NULL) {
+		signed long long saved_dts;
+		AVPacket* pkt = av_packet_alloc();
+		int r;
+
+		if (!pkt) E_Exit("Error: Unable to alloc packet");
+		if (!repeat) {
+			unsigned char *srcline,*dstline;
+			Bitu countWidth = (flags & CAPTURE_FLAG_DBLW) ? (width >> 1) : width;
+			AVFrame *frame = ffmpeg_vidrgb_frame;
+			Bitu x;
+
+			// the encoder may still hold the last frame
+			if (av_frame_make_writable(ffmpeg_vidrgb_frame) < 0 || (ffmpeg_sws_ctx != NULL && av_frame_make_writable(ffmpeg_vid_frame) < 0))
+				LOG_MSG("WARNING: av_frame_make_writable() failed");
+
+			// copy from source to vidrgb frame
+			if (bpp == 8 && ffmpeg_vidrgb_frame->format != AV_PIX_FMT_PAL8) {
+				for (i=0;i<height;i++) {
+					dstline = ffmpeg_vidrgb_frame->data[0] + ((unsigned int)i * (unsigned int)ffmpeg_vidrgb_frame->linesize[0]);
+
+					if (flags & CAPTURE_FLAG_DBLH)
+						srcline=(data+(i >> 1)*pitch);
+					else
+						srcline=(data+(i >> 0)*pitch);
+
+					if (flags & CAPTURE_FLAG_DBLW) {
+						for (x=0;x < width;x++)
+							((uint32_t *)dstline)[(x*2)+0] =
+								((uint32_t *)dstline)[(x*2)+1] = pal32[srcline[x]];
+					}
+					else {
+						for (x=0;x < width;x++)
+							((uint32_t *)dstline)[x] = pal32[srcline[x]];
+					}
+				}
+			}
+			else {
+				for (i=0;i<height;i++) {
+					dstline = ffmpeg_vidrgb_frame->data[0] + ((unsigned int)i * (unsigned int)ffmpeg_vidrgb_frame->linesize[0]);
+
+					if (flags & CAPTURE_FLAG_DBLW) {
+						if (flags & CAPTURE_FLAG_DBLH)
+							srcline=(data+(i >> 1)*pitch);
+						else
+							srcline=(data+(i >> 0)*pitch);
+
+						switch (bpp) {
+							case 8:
+								for (x=0;x<countWidth;x++)
+									((uint8_t *)dstline)[x*2+0] =
+										((uint8_t *)dstline)[x*2+1] = ((uint8_t *)srcline)[x];
+								break;
+							case 15:
+							case 16:
+								for (x=0;x<countWidth;x++)
+									((uint16_t *)dstline)[x*2+0] =
+										((uint16_t *)dstline)[x*2+1] = ((uint16_t *)srcline)[x];
+								break;
+							case 32:
+								for (x=0;x<countWidth;x++)
+									((uint32_t *)dstline)[x*2+0] =
+										((uint32_t *)dstline)[x*2+1] = ((uint32_t *)srcline)[x];
+								break;
+						}
+					} else {
+						if (flags & CAPTURE_FLAG_DBLH)
+							srcline=(data+(i >> 1)*pitch);
+						else
+							srcline=(data+(i >> 0)*pitch);
+
+						memcpy(dstline,srcline,width*((bpp+7)/8));
+					}
+				}
+			}
+
+			// convert colorspace, unless the encoder takes the RGB frame as is
+			if (ffmpeg_sws_ctx != NULL) {
+				if (sws_scale(ffmpeg_sws_ctx,
+					// source
+					ffmpeg_vidrgb_frame->data,
+					ffmpeg_vidrgb_frame->linesize,
+					0,ffmpeg_vidrgb_frame->height,
+					// dest
+					ffmpeg_vid_frame->data,
+					ffmpeg_vid_frame->linesize) <= 0)
+					LOG_MSG("WARNING: sws_scale() failed");
+				frame = ffmpeg_vid_frame;
+			}
+
+			// upload to a fresh surface for encoders that only take hardware frames
+			if (ffmpeg_hw_frame != NULL) {
+				av_frame_unref(ffmpeg_hw_frame);
+				if (av_hwframe_get_buffer(ffmpeg_hw_frames,ffmpeg_hw_frame,0) < 0 || av_hwframe_transfer_data(ffmpeg_hw_frame,frame,0) < 0)
+					LOG_MSG("WARNING: uploading the frame to the hardware encoder failed");
+				frame = ffmpeg_hw_frame;
+			}
+
+			// encode it
+			frame->pts = (int64_t)capture.video.frames; // or else libx264 complains about non-monotonic timestamps
+            av_opt_set_int(ffmpeg_vid_ctx->priv_data, "g", 15, 0); // GOP size 15
+
+			r=avcodec_send_frame(ffmpeg_vid_ctx,frame);
+			if (r < 0 && r != AVERROR(EAGAIN))
+				LOG_MSG("WARNING: avcodec_send_frame() video failed to encode (err=%d)",r);
+
+			while ((r=avcodec_receive_packet(ffmpeg_vid_ctx,pkt)) >= 0) {
+				saved_dts = pkt->dts;
+				pkt->stream_index = ffmpeg_vid_stream->index;
+				av_packet_rescale_ts(pkt,ffmpeg_vid_ctx->time_base,ffmpeg_vid_stream->time_base);
+				pkt->pts += (int64_t)ffmpeg_video_frame_time_offset;
+				pkt->dts += (int64_t)ffmpeg_video_frame_time_offset;
+
+				if (av_interleaved_write_frame(ffmpeg_fmt_ctx,pkt) < 0)
+					LOG_MSG("WARNING: av_interleaved_write_frame failed");
+
+				pkt->pts = (int64_t)saved_dts + (int64_t)1;
+				pkt->dts = (int64_t)saved_dts + (int64_t)1;
+				av_packet_rescale_ts(pkt,ffmpeg_vid_ctx->time_base,ffmpeg_vid_stream->time_base);
+				ffmpeg_video_frame_last_time = (uint64_t)pkt->pts;
+			}
+
+			if (r != AVERROR(EAGAIN))
+				LOG_MSG("WARNING: avcodec_receive_packet() video failed to encode (err=%d)",r);
+		}
+		av_packet_free(&pkt);
+		capture.video.frames++;
+
+		if ( audioused ) {
+			ffmpeg_take_audio((int16_t*)audio,(unsigned int)audioused);
+			capture.video.audiowritten = audioused*4;
+		}
+	}
+#endif
+	else {
+		capture.video.audiowritten = audioused*4;
+	}
+	return true;
+}
+
+
+/* Video capture worker. With "video capture queue" above zero CAPTURE_AddImage only copies
+ * the frame (source lines, palette and the audio gathered since the last frame) into a queue
+ * and this thread does the compression and file writes. At most capture_queue_depth pictures
+ * wait at once; when full, "drop" turns the new frame into a repeat of the last picture so the
+ * audio and frame count stay in step, "block" makes the emulation thread wait instead. */
+struct CaptureVideoFrame {
+	Bitu width, height, bpp, pitch, flags;
+	zmbv_format_t format;
+	bool repeat;
+	std::vector<uint8_t> data;
+	uint8_t pal[256*4];
+	uint32_t pal32[256];
+	std::vector<int16_t> audio;
+	Bitu audioused;
+};
+
+static Bitu capture_queue_depth = 0;
+static bool capture_queue_block = false;
+
+static std::thread capture_worker;
+static std::mutex capture_queue_mutex;
+static std::condition_variable capture_queue_cond;
+static std::deque<CaptureVideoFrame*> capture_queue;
+static std::vector<CaptureVideoFrame*> capture_queue_free;
+static Bitu capture_queue_pictures = 0;
+static bool capture_worker_run = false;
+static std::atomic<bool> capture_worker_failed{false};
+static unsigned long capture_dropped = 0;
+
+static void CAPTURE_VideoWorkerThread(void) {
+	std::unique_lock<std::mutex> lock(capture_queue_mutex);
+
+	for (;;) {
+		capture_queue_cond.wait(lock, [] { return !capture_queue.empty() || !capture_worker_run; });
+		if (capture_queue.empty()) break; /* stopping and drained */
+
+		CaptureVideoFrame *f = capture_queue.front();
+		capture_queue.pop_front();
+		lock.unlock();
+
+		/* after a failure keep draining so the producer never waits on a dead encoder */
+		if (!capture_worker_failed.load() &&
+			!CAPTURE_EncodeVideoFrame(f->width, f->height, f->bpp, f->pitch, f->flags, f->data.data(), f->pal, f->pal32, f->format, f->repeat, f->audio.data(), f->audioused))
+			capture_worker_failed.store(true);
+
+		lock.lock();
+		if (!f->repeat) capture_queue_pictures--;
+		capture_queue_free.push_back(f);
+		capture_queue_cond.notify_all();
+	}
+}
+
+/* Drain the queue and join the worker. The encoder state belongs to this thread again afterwards. */
+static void CAPTURE_StopVideoWorker(void) {
+	if (!capture_worker.joinable()) return;
+
+	{
+		std::lock_guard<std::mutex> lock(capture_queue_mutex);
+		capture_worker_run = false;
+	}
+	capture_queue_cond.notify_all();
+	capture_worker.join();
+
+	for (auto f : capture_queue_free) delete f;
+	capture_queue_free.clear();
+	capture_queue_pictures = 0;
+}
+
+static bool CAPTURE_QueueVideoFrame(Bitu width, Bitu height, Bitu bpp, Bitu pitch, Bitu flags, uint8_t *data, uint8_t *pal, zmbv_format_t format, bool repeat) {
+	if (capture_worker_failed.load()) {
+		CAPTURE_StopVideoWorker();
+		capture_worker_failed.store(false);
+		return false;
+	}
+
+	if (!capture_worker.joinable()) {
+		capture_worker_run = true;
+		capture_worker = std::thread(CAPTURE_VideoWorkerThread);
+	}
+
+	std::unique_lock<std::mutex> lock(capture_queue_mutex);
+
+	if (!repeat && capture_queue_pictures >= capture_queue_depth) {
+		if (capture_queue_block) {
+			capture_queue_cond.wait(lock, [] { return capture_queue_pictures < capture_queue_depth || capture_worker_failed.load(); });
+		}
+		else {
+			repeat = true;
+			capture_dropped++;
+		}
+	}
+
+	CaptureVideoFrame *f;
+	if (!capture_queue_free.empty()) {
+		f = capture_queue_free.back();
+		capture_queue_free.pop_back();
+	}
+	else {
+		f = new CaptureVideoFrame();
+	}
+	if (!repeat) capture_queue_pictures++;
+	lock.unlock();
+
+	f->width = width;
+	f->height = height;
+	f->bpp = bpp;
+	f->flags = flags;
+	f->format = format;
+	f->repeat = repeat;
+
+	if (!repeat) {
+		/* keep only the source lines, packed: doubling is redone by the encoder */
+		const Bitu rows = (flags & CAPTURE_FLAG_DBLH) ? ((height + 1) >> 1) : height;
+		const Bitu cols = (flags & CAPTURE_FLAG_DBLW) ? (width >> 1) : width;
+
+		f->pitch = cols * ((bpp + 7) / 8);
+		f->data.resize(rows * f->pitch);
+		for (Bitu y = 0;y < rows;y++)
+			memcpy(&f->data[y * f->pitch], data + y * pitch, f->pitch);
+
+		if (pal != NULL) memcpy(f->pal, pal, sizeof(f->pal));
+		memcpy(f->pal32, GFX_palette32bpp, sizeof(f->pal32));
+	}
+	else {
+		f->pitch = 0;
+	}
+
+	f->audioused = capture.video.audioused;
+	f->audio.resize(f->audioused * 2);
+	if (f->audioused != 0) memcpy(f->audio.data(), capture.video.audiobuf, f->audioused * 4);
+	capture.video.audioused = 0;
+
+	lock.lock();
+	capture_queue.push_back(f);
+	capture_queue_cond.notify_all();
+	return true;
+}
+#endif
+
+#if (C_SSHOT)
+/* Screenshot writer. CAPTURE_AddImage only copies the source lines and palette of the frame,
+ * this thread expands them and writes the file as PNG ("screenshot png level" sets the zlib
+ * level), QOI or BMP. Callers that need the finished file (QMP screendump) wait for it with
+ * CAPTURE_WaitScreenshot instead of polling. */
+enum {
+	SCREENSHOT_PNG=0,
+	SCREENSHOT_QOI,
+	SCREENSHOT_BMP
+};
+
+struct CaptureScreenshot {
+	Bitu width, height, bpp, pitch, flags;	/* width and height after doubling */
+	std::vector<uint8_t> data;
+	uint8_t pal[256*4];
+	int format;
+	std::string path;
+	FILE *fp;
+};
+
+static int screenshot_format = SCREENSHOT_PNG;
+static int screenshot_png_level = Z_BEST_COMPRESSION;
+
+static std::thread screenshot_worker;
+static std::mutex screenshot_mutex;
+static std::condition_variable screenshot_cond;
+static std::deque<CaptureScreenshot*> screenshot_queue;
+static unsigned int screenshot_busy = 0;	/* queued or being written */
+static bool screenshot_worker_run = false;
+static std::vector<std::string> screenshot_saved;	/* for the "show recorded filename" message box */
+
+/* One output row: palette indexes at 8bpp, blue, green, red bytes otherwise */
+static void CAPTURE_ScreenshotRow(const CaptureScreenshot &s, Bitu y, uint8_t *row) {
+	const uint8_t *srcLine = s.data.data() + ((s.flags & CAPTURE_FLAG_DBLH) ? (y >> 1) : y) * s.pitch;
+	const Bitu dbl = (s.flags & CAPTURE_FLAG_DBLW) ? 2 : 1;
+	const Bitu countWidth = s.width / dbl;
+
+	for (Bitu x=0;x<countWidth;x++) {
+		uint8_t b,g,r;
+
+		if (s.bpp == 8) {
+			for (Bitu d=0;d<dbl;d++) row[x*dbl+d] = srcLine[x];
+			continue;
+		}
+
+		switch (s.bpp) {
+		case 15: {
+			Bitu pixel = ((const uint16_t *)srcLine)[x];
+			b = (uint8_t)(((pixel& 0x001f) * 0x21) >>  2);
+			g = (uint8_t)(((pixel& 0x03e0) * 0x21) >>  7);
+			r = (uint8_t)(((pixel& 0x7c00) * 0x21) >> 12);
+			} break;
+		case 16: {
+			Bitu pixel = ((const uint16_t *)srcLine)[x];
+			b = (uint8_t)(((pixel& 0x001f) * 0x21) >>  2);
+			g = (uint8_t)(((pixel& 0x07e0) * 0x41) >>  9);
+			r = (uint8_t)(((pixel& 0xf800) * 0x21) >> 13);
+			} break;
+		default:
+			b = srcLine[x*4+0];
+			g = srcLine[x*4+1];
+			r = srcLine[x*4+2];
+			break;
+		}
+
+		for (Bitu d=0;d<dbl;d++) {
+			row[(x*dbl+d)*3+0] = b;
+			row[(x*dbl+d)*3+1] = g;
+			row[(x*dbl+d)*3+2] = r;
+		}
+	}
+}
+
+#ifdef PNG_pHYs_SUPPORTED
+static inline unsigned long math_gcd_png_uint_32(const png_uint_32 a,const png_uint_32 b) {
+        if (b) return math_gcd_png_uint_32(b,a%b);
+        return a;
+}
+#endif
+
+static bool CAPTURE_WriteScreenshotPNG(const CaptureScreenshot &s, std::vector<uint8_t> &row) {
+	png_structp png_ptr;
+	png_infop info_ptr;
+	png_color palette[256];
+
+	/* First try to allocate the png structures */
+	png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL,NULL, NULL);
+	if (!png_ptr) return false;
+	info_ptr = png_create_info_struct(png_ptr);
+	if (!info_ptr) {
+		png_destroy_write_struct(&png_ptr,(png_infopp)NULL);
+		return false;
+	}
+
+	/* Finalize the initing of png library */
+	png_init_io(png_ptr, s.fp);
+	png_set_compression_level(png_ptr,screenshot_png_level);
+
+	/* set other zlib parameters */
+	png_set_compression_mem_level(png_ptr, 8);
+	png_set_compression_strategy(png_ptr,Z_DEFAULT_STRATEGY);
+	png_set_compression_window_bits(png_ptr, 15);
+	png_set_compression_method(png_ptr, 8);
+	png_set_compression_buffer_size(png_ptr, 8192);
+
+#ifdef PNG_pHYs_SUPPORTED
+	if (s.width >= 8 && s.height >= 8) {
+		png_uint_32 x=0,y=0,g;
+		x = (png_uint_32)(4 * s.height);
+		y = (png_uint_32)(3 * s.width);
+		g = math_gcd_png_uint_32(x,y);
+		png_set_pHYs(png_ptr, info_ptr, x/g, y/g, PNG_RESOLUTION_UNKNOWN);
+	}
+#endif
+
+	if (s.bpp==8) {
+		png_set_IHDR(png_ptr, info_ptr, (png_uint_32)s.width, (png_uint_32)s.height,
+			8, PNG_COLOR_TYPE_PALETTE, PNG_INTERLACE_NONE,
+			PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+		for (unsigned int i=0;i<256;i++) {
+			palette[i].red=s.pal[i*4+0];
+			palette[i].green=s.pal[i*4+1];
+			palette[i].blue=s.pal[i*4+2];
+		}
+		png_set_PLTE(png_ptr, info_ptr, palette,256);
+	} else {
+		png_set_bgr( png_ptr );
+		png_set_IHDR(png_ptr, info_ptr, (png_uint_32)s.width, (png_uint_32)s.height,
+			8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+			PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+	}
+#ifdef PNG_TEXT_SUPPORTED
+	png_text text[1] = {};
+	char ptext_s[] = "DOSBox-X " VERSION;
+	char software[9] = { 'S','o','f','t','w','a','r','e',0};
+	text[0].compression = PNG_TEXT_COMPRESSION_NONE;
+	text[0].key  = software;
+	text[0].text = ptext_s;
+	png_set_text(png_ptr, info_ptr, text, 1);
+#endif
+	png_write_info(png_ptr, info_ptr);
+	for (Bitu i=0;i<s.height;i++) {
+		CAPTURE_ScreenshotRow(s, i, row.data());
+		png_write_row(png_ptr, (png_bytep)row.data());
+	}
+	/* Finish writing */
+	png_write_end(png_ptr, nullptr);
+	/*Destroy PNG structs*/
+	png_destroy_write_struct(&png_ptr, &info_ptr);
+	return true;
+}
+
+/* QOI ("Quite OK Image"), RGB with no alpha. Far cheaper to encode than PNG at about the same size for DOS graphics. */
+static bool CAPTURE_WriteScreenshotQOI(const CaptureScreenshot &s, std::vector<uint8_t> &row) {
+	std::vector<uint8_t> out;
+	uint32_t index[64] = {};
+	uint32_t prev = 0xFF000000u;	/* a,b,g,r from high to low byte, alpha always 255 */
+	unsigned int run = 0;
+
+	out.reserve(14 + (s.width * s.height) + 8);
+	const uint8_t header[14] = { 'q','o','i','f',
+		(uint8_t)(s.width >> 24), (uint8_t)(s.width >> 16), (uint8_t)(s.width >> 8), (uint8_t)s.width,
+		(uint8_t)(s.height >> 24), (uint8_t)(s.height >> 16), (uint8_t)(s.height >> 8), (uint8_t)s.height,
+		3/*RGB*/, 0/*sRGB*/ };
+	out.insert(out.end(), header, header + sizeof(header));
+
+	for (Bitu y=0;y<s.height;y++) {
+		CAPTURE_ScreenshotRow(s, y, row.data());
+		for (Bitu x=0;x<s.width;x++) {
+			uint8_t r,g,b;
+
+			if (s.bpp == 8) {
+				const uint8_t *p = &s.pal[row[x]*4];
+				r = p[0]; g = p[1]; b = p[2];
+			}
+			else {
+				b = row[x*3+0]; g = row[x*3+1]; r = row[x*3+2];
+			}
+
+			const uint32_t px = 0xFF000000u | ((uint32_t)b << 16u) | ((uint32_t)g << 8u) | (uint32_t)r;
+			if (px == prev) {
+				if (++run == 62) {
+					out.push_back((uint8_t)(0xC0 | (run - 1)));
+					run = 0;
+				}
+				continue;
+			}
+			if (run != 0) {
+				out.push_back((uint8_t)(0xC0 | (run - 1)));
+				run = 0;
+			}
+
+			const unsigned int hash = (r * 3u + g * 5u + b * 7u + 255u * 11u) & 63u;
+			if (index[hash] == px) {
+				out.push_back((uint8_t)hash);
+			}
+			else {
+				index[hash] = px;
+
+				const int dr = (int8_t)(r - (uint8_t)prev);
+				const int dg = (int8_t)(g - (uint8_t)(prev >> 8u));
+				const int db = (int8_t)(b - (uint8_t)(prev >> 16u));
+				const int dr_dg = dr - dg, db_dg = db - dg;
+
+				if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+					out.push_back((uint8_t)(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2)));
+				}
+				else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+					out.push_back((uint8_t)(0x80 | (dg + 32)));
+					out.push_back((uint8_t)(((dr_dg + 8) << 4) | (db_dg + 8)));
+				}
+				else {
+					out.push_back(0xFE);
+					out.push_back(r);
+					out.push_back(g);
+					out.push_back(b);
+				}
+			}
+			prev = px;
+		}
+	}
+	if (run != 0) out.push_back((uint8_t)(0xC0 | (run - 1)));
+
+	static const uint8_t trailer[8] = { 0,0,0,0,0,0,0,1 };
+	out.insert(out.end(), trailer, trailer + sizeof(trailer));
+	return fwrite(out.data(), out.size(), 1, s.fp) == 1;
+}
+
+/* Uncompressed bottom-up BMP, 8-bit with the palette or 24-bit */
+static bool CAPTURE_WriteScreenshotBMP(const CaptureScreenshot &s, std::vector<uint8_t> &row) {
+	const uint32_t palsize = (s.bpp == 8) ? (256u * 4u) : 0u;
+	const uint32_t stride = (((uint32_t)s.width * ((s.bpp == 8) ? 1u : 3u)) + 3u) & ~3u;
+	const uint32_t offbits = (uint32_t)(sizeof(windows_BITMAPFILEHEADER) + sizeof(windows_BITMAPINFOHEADER)) + palsize;
+	windows_BITMAPFILEHEADER fh = WINDOWS_BITMAPFILEHEADER_INIT;
+	windows_BITMAPINFOHEADER ih = WINDOWS_BITMAPINFOHEADER_INIT;
+
+	__w_le_u16(&fh.bfType,0x4D42); /* 'BM' */
+	__w_le_u32(&fh.bfSize,offbits + stride * (uint32_t)s.height);
+	__w_le_u32(&fh.bfOffBits,offbits);
+	__w_le_u32(&ih.biSize,sizeof(ih));
+	__w_le_u32(&ih.biWidth,(uint32_t)s.width);
+	__w_le_u32(&ih.biHeight,(uint32_t)s.height);
+	__w_le_u16(&ih.biPlanes,1);
+	__w_le_u16(&ih.biBitCount,(s.bpp == 8) ? 8 : 24);
+	__w_le_u32(&ih.biSizeImage,stride * (uint32_t)s.height);
+	__w_le_u32(&ih.biClrUsed,(s.bpp == 8) ? 256 : 0);
+	if (fwrite(&fh, sizeof(fh), 1, s.fp) != 1 || fwrite(&ih, sizeof(ih), 1, s.fp) != 1) return false;
+
+	if (palsize != 0) {
+		uint8_t bmppal[256*4];
+		for (unsigned int i=0;i<256;i++) {
+			bmppal[i*4+0] = s.pal[i*4+2];
+			bmppal[i*4+1] = s.pal[i*4+1];
+			bmppal[i*4+2] = s.pal[i*4+0];
+			bmppal[i*4+3] = 0;
+		}
+		if (fwrite(bmppal, sizeof(bmppal), 1, s.fp) != 1) return false;
+	}
+
+	if (row.size() < stride) row.resize(stride);
+	for (Bitu y=s.height;y-- > 0;) {
+		memset(row.data(), 0, stride);
+		CAPTURE_ScreenshotRow(s, y, row.data());
+		if (fwrite(row.data(), stride, 1, s.fp) != 1) return false;
+	}
+	return true;
+}
+
+static void CAPTURE_ScreenshotSavedMessage(Bitu /*val*/) {
+	std::vector<std::string> saved;
+	{
+		std::lock_guard<std::mutex> lock(screenshot_mutex);
+		saved.swap(screenshot_saved);
+	}
+	for (auto &path : saved)
+		systemmessagebox("Recording completed",("Saved screenshot to the file:\n\n"+path).c_str(),"ok", "info", 1);
+}
+
+static void CAPTURE_ScreenshotWorkerThread(void) {
+	std::vector<uint8_t> row;
+	std::unique_lock<std::mutex> lock(screenshot_mutex);
+
+	for (;;) {
+		screenshot_cond.wait(lock, [] { return !screenshot_queue.empty() || !screenshot_worker_run; });
+		if (screenshot_queue.empty()) break; /* stopping and drained */
+
+		CaptureScreenshot *s = screenshot_queue.front();
+		screenshot_queue.pop_front();
+		lock.unlock();
+
+		bool ok;
+		row.resize(s->width * 3);
+		switch (s->format) {
+			case SCREENSHOT_QOI: ok = CAPTURE_WriteScreenshotQOI(*s, row); break;
+			case SCREENSHOT_BMP: ok = CAPTURE_WriteScreenshotBMP(*s, row); break;
+			default:             ok = CAPTURE_WriteScreenshotPNG(*s, row); break;
+		}
+		if (fclose(s->fp) != 0) ok = false;
+		if (!ok) LOG_MSG("Failed to write screenshot %s",s->path.c_str());
+
+		lock.lock();
+		if (ok && s->path.size()) {
+			// Save path for remote debugging
+			last_screenshot_path = s->path;
+			if (show_recorded_filename) {
+				if (screenshot_saved.empty()) PIC_PostEvent(CAPTURE_ScreenshotSavedMessage, 0);
+				screenshot_saved.push_back(s->path);
+			}
+		}
+		delete s;
+		screenshot_busy--;
+		screenshot_cond.notify_all();
+	}
+}
+
+/* Finish the screenshots still being written and join the worker */
+static void CAPTURE_StopScreenshotWorker(void) {
+	if (!screenshot_worker.joinable()) return;
+
+	{
+		std::lock_guard<std::mutex> lock(screenshot_mutex);
+		screenshot_worker_run = false;
+	}
+	screenshot_cond.notify_all();
+	screenshot_worker.join();
+}
+
+static bool CAPTURE_QueueScreenshot(Bitu width, Bitu height, Bitu bpp, Bitu pitch, Bitu flags, const uint8_t *data, const uint8_t *pal) {
+	static const char *exts[] = { ".png", ".qoi", ".bmp" };
+
+	FILE *fp = OpenCaptureFile("Screenshot",exts[screenshot_format]);
+	if (!fp) return false;
+
+	CaptureScreenshot *s = new CaptureScreenshot();
+	s->width = width;
+	s->height = height;
+	s->bpp = bpp;
+	s->flags = flags;
+	s->format = screenshot_format;
+	s->path = pathscr;
+	s->fp = fp;
+
+	/* keep only the source lines, packed: doubling is redone by the writer */
+	const Bitu rows = (flags & CAPTURE_FLAG_DBLH) ? (height >> 1) : height;
+	const Bitu cols = (flags & CAPTURE_FLAG_DBLW) ? (width >> 1) : width;
+
+	s->pitch = cols * ((bpp + 7) / 8);
+	s->data.resize(rows * s->pitch);
+	for (Bitu y = 0;y < rows;y++)
+		memcpy(&s->data[y * s->pitch], data + y * pitch, s->pitch);
+	if (bpp == 8 && pal != NULL) memcpy(s->pal, pal, sizeof(s->pal));
+
+	if (!screenshot_worker.joinable()) {
+		screenshot_worker_run = true;
+		screenshot_worker = std::thread(CAPTURE_ScreenshotWorkerThread);
+	}
+
+	std::unique_lock<std::mutex> lock(screenshot_mutex);
+	/* a few copies in flight at most, a held down hotkey must not pile up frames in memory */
+	screenshot_cond.wait(lock, [] { return screenshot_busy < 4; });
+	screenshot_busy++;
+	screenshot_queue.push_back(s);
+	screenshot_cond.notify_all();
+	return true;
+}
+#endif
+
 #if defined(USE_TTF)
 void ttf_switch_on(bool ss=true), ttf_switch_off(bool ss=true);
 #endif
@@ -666,6 +1626,12 @@ void CAPTURE_VideoEvent(bool pressed) {
 		if (!(CaptureState & CAPTURE_IMAGE) && !(CaptureState & CAPTURE_VIDEO))
 			ttf_switch_on();
 #endif
+		CAPTURE_StopVideoWorker();
+		if (capture_dropped != 0) {
+			LOG_MSG("Video capture: %lu frames dropped because the encoder fell behind",capture_dropped);
+			capture_dropped = 0;
+		}
+
 		if (capture.video.writer != NULL) {
 			if ( capture.video.audioused ) {
 				CAPTURE_AddAviChunk( "01wb", (uint32_t)(capture.video.audioused * 4), capture.video.audiobuf, 0x10, 1);
@@ -773,10 +1739,6 @@ void CAPTURE_StopOPL(void) {
 #endif
 }
 
-#if (C_SSHOT)
-extern uint32_t GFX_palette32bpp[256];
-#endif
-
 unsigned int GFX_GetBShift();
 
 void CAPTURE_VideoStart() {
@@ -799,19 +1761,8 @@ void CAPTURE_VideoStop() {
 #endif
 }
 
-#ifdef PNG_pHYs_SUPPORTED
-static inline unsigned long math_gcd_png_uint_32(const png_uint_32 a,const png_uint_32 b) {
-        if (b) return math_gcd_png_uint_32(b,a%b);
-        return a;
-}
-#endif
-
 void CAPTURE_AddImage(Bitu width, Bitu height, Bitu bpp, Bitu pitch, Bitu flags, float fps, uint8_t * data, uint8_t * pal) {
 #if (C_SSHOT)
-	Bitu i;
-	uint8_t doubleRow[SCALER_MAXWIDTH*4];
-	Bitu countWidth = width;
-
 	if (flags & CAPTURE_FLAG_DBLH)
 		height *= 2;
 	if (flags & CAPTURE_FLAG_DBLW)
@@ -823,159 +1774,10 @@ void CAPTURE_AddImage(Bitu width, Bitu height, Bitu bpp, Bitu pitch, Bitu flags,
 		return;
 	
 	if (CaptureState & CAPTURE_IMAGE) {
-		png_structp png_ptr;
-		png_infop info_ptr;
-		png_color palette[256];
-
+		/* counted as pending by the writer before the request flag goes away */
+		const bool queued = CAPTURE_QueueScreenshot(width, height, bpp, pitch, flags, data, pal);
 		CaptureState &= ~((unsigned int)CAPTURE_IMAGE);
-		/* Open the actual file */
-		FILE * fp=OpenCaptureFile("Screenshot",".png");
-		if (!fp) goto skip_shot;
-		/* First try to allocate the png structures */
-		png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL,NULL, NULL);
-		if (!png_ptr) goto skip_shot;
-		info_ptr = png_create_info_struct(png_ptr);
-		if (!info_ptr) {
-			png_destroy_write_struct(&png_ptr,(png_infopp)NULL);
-			goto skip_shot;
-		}
-	
-		/* Finalize the initing of png library */
-		png_init_io(png_ptr, fp);
-		png_set_compression_level(png_ptr,Z_BEST_COMPRESSION);
-		
-		/* set other zlib parameters */
-		png_set_compression_mem_level(png_ptr, 8);
-		png_set_compression_strategy(png_ptr,Z_DEFAULT_STRATEGY);
-		png_set_compression_window_bits(png_ptr, 15);
-		png_set_compression_method(png_ptr, 8);
-		png_set_compression_buffer_size(png_ptr, 8192);
-
-#ifdef PNG_pHYs_SUPPORTED
-		if (width >= 8 && height >= 8) {
-			png_uint_32 x=0,y=0,g;
-			x = (png_uint_32)(4 * height);
-			y = (png_uint_32)(3 * width);
-			g = math_gcd_png_uint_32(x,y);
-			png_set_pHYs(png_ptr, info_ptr, x/g, y/g, PNG_RESOLUTION_UNKNOWN);
-		}
-#endif
-
-		if (bpp==8) {
-			png_set_IHDR(png_ptr, info_ptr, (png_uint_32)width, (png_uint_32)height,
-				8, PNG_COLOR_TYPE_PALETTE, PNG_INTERLACE_NONE,
-				PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-			for (i=0;i<256;i++) {
-				palette[i].red=pal[i*4+0];
-				palette[i].green=pal[i*4+1];
-				palette[i].blue=pal[i*4+2];
-			}
-			png_set_PLTE(png_ptr, info_ptr, palette,256);
-		} else {
-			png_set_bgr( png_ptr );
-			png_set_IHDR(png_ptr, info_ptr, (png_uint_32)width, (png_uint_32)height,
-				8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
-				PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-		}
-#ifdef PNG_TEXT_SUPPORTED
-		int fields = 1;
-		png_text text[1] = {};
-		const char* text_s = "DOSBox-X " VERSION;
-		size_t strl = strlen(text_s);
-		char* ptext_s = new char[strl + 1];
-		strcpy(ptext_s, text_s);
-		char software[9] = { 'S','o','f','t','w','a','r','e',0};
-		text[0].compression = PNG_TEXT_COMPRESSION_NONE;
-		text[0].key  = software;
-		text[0].text = ptext_s;
-		png_set_text(png_ptr, info_ptr, text, fields);
-#endif
-		png_write_info(png_ptr, info_ptr);
-#ifdef PNG_TEXT_SUPPORTED
-		delete [] ptext_s;
-#endif
-		for (i=0;i<height;i++) {
-			void *rowPointer;
-			void *srcLine;
-			if (flags & CAPTURE_FLAG_DBLH)
-				srcLine=(data+(i >> 1)*pitch);
-			else
-				srcLine=(data+(i >> 0)*pitch);
-			rowPointer=srcLine;
-			switch (bpp) {
-			case 8:
-				if (flags & CAPTURE_FLAG_DBLW) {
-   					for (Bitu x=0;x<countWidth;x++)
-						doubleRow[x*2+0] =
-						doubleRow[x*2+1] = ((uint8_t *)srcLine)[x];
-					rowPointer = doubleRow;
-				}
-				break;
-			case 15:
-				if (flags & CAPTURE_FLAG_DBLW) {
-					for (Bitu x=0;x<countWidth;x++) {
-						Bitu pixel = ((uint16_t *)srcLine)[x];
-						doubleRow[x*6+0] = doubleRow[x*6+3] = ((pixel& 0x001f) * 0x21) >>  2;
-						doubleRow[x*6+1] = doubleRow[x*6+4] = (uint8_t)(((pixel& 0x03e0) * 0x21) >> 7);
-						doubleRow[x*6+2] = doubleRow[x*6+5] = ((pixel& 0x7c00) * 0x21) >>  12;
-					}
-				} else {
-					for (Bitu x=0;x<countWidth;x++) {
-						Bitu pixel = ((uint16_t *)srcLine)[x];
-						doubleRow[x*3+0] = ((pixel& 0x001f) * 0x21) >>  2;
-						doubleRow[x*3+1] = (uint8_t)(((pixel& 0x03e0) * 0x21) >> 7);
-						doubleRow[x*3+2] = ((pixel& 0x7c00) * 0x21) >>  12;
-					}
-				}
-				rowPointer = doubleRow;
-				break;
-			case 16:
-				if (flags & CAPTURE_FLAG_DBLW) {
-					for (Bitu x=0;x<countWidth;x++) {
-						Bitu pixel = ((uint16_t *)srcLine)[x];
-						doubleRow[x*6+0] = doubleRow[x*6+3] = ((pixel& 0x001f) * 0x21) >> 2;
-						doubleRow[x*6+1] = doubleRow[x*6+4] = ((pixel& 0x07e0) * 0x41) >> 9;
-						doubleRow[x*6+2] = doubleRow[x*6+5] = ((pixel& 0xf800) * 0x21) >> 13;
-					}
-				} else {
-					for (Bitu x=0;x<countWidth;x++) {
-						Bitu pixel = ((uint16_t *)srcLine)[x];
-						doubleRow[x*3+0] = ((pixel& 0x001f) * 0x21) >>  2;
-						doubleRow[x*3+1] = ((pixel& 0x07e0) * 0x41) >>  9;
-						doubleRow[x*3+2] = ((pixel& 0xf800) * 0x21) >>  13;
-					}
-				}
-				rowPointer = doubleRow;
-				break;
-			case 32:
-				if (flags & CAPTURE_FLAG_DBLW) {
-					for (Bitu x=0;x<countWidth;x++) {
-						doubleRow[x*6+0] = doubleRow[x*6+3] = ((uint8_t *)srcLine)[x*4+0];
-						doubleRow[x*6+1] = doubleRow[x*6+4] = ((uint8_t *)srcLine)[x*4+1];
-						doubleRow[x*6+2] = doubleRow[x*6+5] = ((uint8_t *)srcLine)[x*4+2];
-					}
-				} else {
-					for (Bitu x=0;x<countWidth;x++) {
-						doubleRow[x*3+0] = ((uint8_t *)srcLine)[x*4+0];
-						doubleRow[x*3+1] = ((uint8_t *)srcLine)[x*4+1];
-						doubleRow[x*3+2] = ((uint8_t *)srcLine)[x*4+2];
-					}
-				}
-				rowPointer = doubleRow;
-				break;
-			}
-			png_write_row(png_ptr, (png_bytep)rowPointer);
-		}
-		/* Finish writing */
-		png_write_end(png_ptr, nullptr);
-		/*Destroy PNG structs*/
-		png_destroy_write_struct(&png_ptr, &info_ptr);
-		/*close file*/
-		fclose(fp);
-		if (show_recorded_filename && pathscr.size()) systemmessagebox("Recording completed",("Saved screenshot to the file:\n\n"+pathscr).c_str(),"ok", "info", 1);
-
-		// Save path for remote debugging before clearing
-		if (pathscr.size()) last_screenshot_path = pathscr;
+		if (!queued) goto skip_shot;
 	}
 	pathscr = "";
 skip_shot:
@@ -993,6 +1795,7 @@ skip_shot:
 				CAPTURE_VideoEvent(true);
 #if (C_AVCODEC)
 			else if (export_ffmpeg && ffmpeg_fmt_ctx != NULL) {
+				CAPTURE_StopVideoWorker();
 				ffmpeg_flush_video();
 				ffmpeg_video_frame_time_offset += ffmpeg_video_frame_last_time;
 				ffmpeg_video_frame_last_time = 0;
@@ -1214,43 +2017,9 @@ skip_shot:
 				LOG_MSG("failed to open audio stream");
 				goto skip_video;
 			}
-			ffmpeg_vid_ctx = avcodec_alloc_context3(ffmpeg_vid_codec);
-			if (ffmpeg_vid_ctx == NULL) E_Exit("Error: Unable to open vid context");
-			ffmpeg_vid_ctx->bit_rate = 25000000; // TODO: make configuration option!
-			ffmpeg_vid_ctx->keyint_min = 15; // TODO: make configuration option!
-			ffmpeg_vid_ctx->time_base.num = 1000000;
-			ffmpeg_vid_ctx->time_base.den = (int)(1000000 * fps);
-			ffmpeg_vid_ctx->width = (int)capture.video.width;
-			ffmpeg_vid_ctx->height = (int)capture.video.height;
-			ffmpeg_vid_ctx->gop_size = 15; // TODO: make config option
-			ffmpeg_vid_ctx->max_b_frames = 0;
-			ffmpeg_vid_ctx->pix_fmt = ffmpeg_choose_pixfmt(ffmpeg_yuv_format_choice); // TODO: auto-choose according to what codec says is supported, and let user choose as well
-			ffmpeg_vid_ctx->thread_count = 0;		// auto-choose
-			ffmpeg_vid_ctx->flags2 = AV_CODEC_FLAG2_FAST;
-			ffmpeg_vid_ctx->qmin = 1;
-			ffmpeg_vid_ctx->qmax = 63;
-			ffmpeg_vid_ctx->rc_max_rate = ffmpeg_vid_ctx->bit_rate;
-			ffmpeg_vid_ctx->rc_min_rate = ffmpeg_vid_ctx->bit_rate;
-			ffmpeg_vid_ctx->rc_buffer_size = (4*1024*1024);
-
-			/* 4:3 aspect ratio. FFMPEG thinks in terms of Pixel Aspect Ratio not Display Aspect Ratio */
-			ffmpeg_vid_ctx->sample_aspect_ratio.num = 4 * (int)capture.video.height;
-			ffmpeg_vid_ctx->sample_aspect_ratio.den = 3 * (int)capture.video.width;
-
-			{
-				AVDictionary *opts = NULL;
-
-				av_dict_set(&opts,"crf","14",1); /* default is 20, this allows higher quality */
-				av_dict_set(&opts,"crf_max","20",1); /* don't let it get too low quality */
-				av_dict_set(&opts,"preset","superfast",1);
-				av_dict_set(&opts,"aud","1",1);
-
-				if (avcodec_open2(ffmpeg_vid_ctx,ffmpeg_vid_codec,&opts) < 0) {
-					LOG_MSG("Unable to open H.264 codec");
-					goto skip_video;
-				}
-
-				av_dict_free(&opts);
+			if (!ffmpeg_open_video(fps,(int)bpp)) {
+				LOG_MSG("Unable to open H.264 codec");
+				goto skip_video;
 			}
 
 			ffmpeg_vid_stream->time_base.num = (int)1000000;
@@ -1309,9 +2078,7 @@ skip_shot:
 
 			ffmpeg_aud_write = 0;
 			ffmpeg_aud_frame = av_frame_alloc();
-			ffmpeg_vid_frame = av_frame_alloc();
-			ffmpeg_vidrgb_frame = av_frame_alloc();
-			if (ffmpeg_aud_frame == NULL || ffmpeg_vid_frame == NULL || ffmpeg_vidrgb_frame == NULL)
+			if (ffmpeg_aud_frame == NULL)
 				goto skip_video;
 
 			#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(59,24,100)
@@ -1329,41 +2096,8 @@ skip_shot:
 				goto skip_video;
 			}
 
-			ffmpeg_vidrgb_frame->colorspace = AVCOL_SPC_RGB;
-			ffmpeg_vidrgb_frame->width = (int)capture.video.width;
-			ffmpeg_vidrgb_frame->height = (int)capture.video.height;
-			ffmpeg_vidrgb_frame->format = ffmpeg_bpp_pick_rgb_format((int)bpp);
-			if (av_frame_get_buffer(ffmpeg_vidrgb_frame,64) < 0) {
-				LOG_MSG("Failed to alloc videorgb frame buffer");
+			if (!ffmpeg_alloc_video_frames((int)bpp))
 				goto skip_video;
-			}
-
-			ffmpeg_vid_frame->colorspace = AVCOL_SPC_SMPTE170M;
-			ffmpeg_vidrgb_frame->color_range = AVCOL_RANGE_MPEG;
-			ffmpeg_vid_frame->width = (int)capture.video.width;
-			ffmpeg_vid_frame->height = (int)capture.video.height;
-			ffmpeg_vid_frame->format = ffmpeg_vid_ctx->pix_fmt;
-			if (av_frame_get_buffer(ffmpeg_vid_frame,64) < 0) {
-				LOG_MSG("Failed to alloc video frame buffer");
-				goto skip_video;
-			}
-
-			ffmpeg_sws_ctx = sws_getContext(
-				// source
-				ffmpeg_vidrgb_frame->width,
-				ffmpeg_vidrgb_frame->height,
-				(AVPixelFormat)ffmpeg_vidrgb_frame->format,
-				// dest
-				ffmpeg_vid_frame->width,
-				ffmpeg_vid_frame->height,
-				(AVPixelFormat)ffmpeg_vid_frame->format,
-				// and the rest
-				((ffmpeg_vid_frame->width == ffmpeg_vidrgb_frame->width && ffmpeg_vid_frame->height == ffmpeg_vidrgb_frame->height) ? SWS_POINT : SWS_BILINEAR),
-				NULL,NULL,NULL);
-			if (ffmpeg_sws_ctx == NULL) {
-				LOG_MSG("Failed to init colorspace conversion");
-				goto skip_video;
-			}
 
 #if defined(WIN32)
             char fullpath[MAX_PATH];
@@ -1376,200 +2110,20 @@ skip_shot:
 		}
 #endif
 
-		if (native_zmbv) {
-			int codecFlags;
+		{
+			/* a frame that repeats the last one needs no pixels, only a null chunk */
+			const bool repeat = native_zmbv && (flags & CAPTURE_FLAG_NOCHANGE) && skip_encoding_unchanged_frames;
 
-			if (capture.video.frames % 300 == 0)
-				codecFlags = 1;
-			else
-				codecFlags = 0;
-
-            if ((flags & CAPTURE_FLAG_NOCHANGE) && skip_encoding_unchanged_frames) {
-                /* advance unless at keyframe */
-                if (codecFlags == 0) capture.video.frames++;
-
-                /* write null non-keyframe */
-                CAPTURE_AddAviChunk( "00dc", (uint32_t)0, capture.video.buf, (uint32_t)(0x0), 0u);
-            }
-            else {
-                if (!capture.video.codec->PrepareCompressFrame( codecFlags, format, (char *)pal, capture.video.buf, capture.video.bufSize))
-                    goto skip_video;
-
-                for (i=0;i<height;i++) {
-                    void * rowPointer;
-                    if (flags & CAPTURE_FLAG_DBLW) {
-                        void *srcLine;
-                        Bitu x;
-                        Bitu countWidth = width >> 1;
-                        if (flags & CAPTURE_FLAG_DBLH)
-                            srcLine=(data+(i >> 1)*pitch);
-                        else
-                            srcLine=(data+(i >> 0)*pitch);
-                        switch ( bpp) {
-                            case 8:
-                                for (x=0;x<countWidth;x++)
-                                    ((uint8_t *)doubleRow)[x*2+0] =
-                                        ((uint8_t *)doubleRow)[x*2+1] = ((uint8_t *)srcLine)[x];
-                                break;
-                            case 15:
-                            case 16:
-                                for (x=0;x<countWidth;x++)
-                                    ((uint16_t *)doubleRow)[x*2+0] =
-                                        ((uint16_t *)doubleRow)[x*2+1] = ((uint16_t *)srcLine)[x];
-                                break;
-                            case 32:
-                                for (x=0;x<countWidth;x++)
-                                    ((uint32_t *)doubleRow)[x*2+0] =
-                                        ((uint32_t *)doubleRow)[x*2+1] = ((uint32_t *)srcLine)[x];
-                                break;
-                        }
-                        rowPointer=doubleRow;
-                    } else {
-                        if (flags & CAPTURE_FLAG_DBLH)
-                            rowPointer=(data+(i >> 1)*pitch);
-                        else
-                            rowPointer=(data+(i >> 0)*pitch);
-                    }
-                    capture.video.codec->CompressLines( 1, &rowPointer );
-                }
-
-                int written = capture.video.codec->FinishCompressFrame();
-                if (written < 0)
-                    goto skip_video;
-
-                CAPTURE_AddAviChunk( "00dc", (uint32_t)written, capture.video.buf, (uint32_t)(codecFlags & 1 ? 0x10 : 0x0), 0u);
-                capture.video.frames++;
-            }
-
-			if ( capture.video.audioused ) {
-				CAPTURE_AddAviChunk( "01wb", (uint32_t)(capture.video.audioused * 4u), capture.video.audiobuf, /*keyframe*/0x10u, 1u);
-				capture.video.audiowritten = capture.video.audioused*4;
-				capture.video.audioused = 0;
-			}
-		}
-#if (C_AVCODEC)
-		else if (export_ffmpeg && ffmpeg_fmt_ctx != NULL) {
-			signed long long saved_dts;
-			AVPacket* pkt = av_packet_alloc();
-			int r;
-
-			if (!pkt) E_Exit("Error: Unable to alloc packet");
-			{
-				unsigned char *srcline,*dstline;
-				Bitu x;
-
-				// copy from source to vidrgb frame
-				if (bpp == 8 && ffmpeg_vidrgb_frame->format != AV_PIX_FMT_PAL8) {
-					for (i=0;i<height;i++) {
-						dstline = ffmpeg_vidrgb_frame->data[0] + ((unsigned int)i * (unsigned int)ffmpeg_vidrgb_frame->linesize[0]);
-
-						if (flags & CAPTURE_FLAG_DBLH)
-							srcline=(data+(i >> 1)*pitch);
-						else
-							srcline=(data+(i >> 0)*pitch);
-
-						if (flags & CAPTURE_FLAG_DBLW) {
-							for (x=0;x < width;x++)
-								((uint32_t *)dstline)[(x*2)+0] =
-									((uint32_t *)dstline)[(x*2)+1] = GFX_palette32bpp[srcline[x]];
-						}
-						else {
-							for (x=0;x < width;x++)
-								((uint32_t *)dstline)[x] = GFX_palette32bpp[srcline[x]];
-						}
-					}
-				}
-				else {
-					for (i=0;i<height;i++) {
-						dstline = ffmpeg_vidrgb_frame->data[0] + ((unsigned int)i * (unsigned int)ffmpeg_vidrgb_frame->linesize[0]);
-
-						if (flags & CAPTURE_FLAG_DBLW) {
-							if (flags & CAPTURE_FLAG_DBLH)
-								srcline=(data+(i >> 1)*pitch);
-							else
-								srcline=(data+(i >> 0)*pitch);
-
-							switch (bpp) {
-								case 8:
-									for (x=0;x<countWidth;x++)
-										((uint8_t *)dstline)[x*2+0] =
-											((uint8_t *)dstline)[x*2+1] = ((uint8_t *)srcline)[x];
-									break;
-								case 15:
-								case 16:
-									for (x=0;x<countWidth;x++)
-										((uint16_t *)dstline)[x*2+0] =
-											((uint16_t *)dstline)[x*2+1] = ((uint16_t *)srcline)[x];
-									break;
-								case 32:
-									for (x=0;x<countWidth;x++)
-										((uint32_t *)dstline)[x*2+0] =
-											((uint32_t *)dstline)[x*2+1] = ((uint32_t *)srcline)[x];
-									break;
-							}
-						} else {
-							if (flags & CAPTURE_FLAG_DBLH)
-								srcline=(data+(i >> 1)*pitch);
-							else
-								srcline=(data+(i >> 0)*pitch);
-
-							memcpy(dstline,srcline,width*((bpp+7)/8));
-						}
-					}
-				}
-
-				// convert colorspace
-				if (sws_scale(ffmpeg_sws_ctx,
-					// source
-					ffmpeg_vidrgb_frame->data,
-					ffmpeg_vidrgb_frame->linesize,
-					0,ffmpeg_vidrgb_frame->height,
-					// dest
-					ffmpeg_vid_frame->data,
-					ffmpeg_vid_frame->linesize) <= 0)
-					LOG_MSG("WARNING: sws_scale() failed");
-
-				// encode it
-				ffmpeg_vid_frame->pts = (int64_t)capture.video.frames; // or else libx264 complains about non-monotonic timestamps
-                av_opt_set_int(ffmpeg_vid_ctx->priv_data, "g", 15, 0); // GOP size 15
-
-				r=avcodec_send_frame(ffmpeg_vid_ctx,ffmpeg_vid_frame);
-				if (r < 0 && r != AVERROR(EAGAIN))
-					LOG_MSG("WARNING: avcodec_send_frame() video failed to encode (err=%d)",r);
-
-				while ((r=avcodec_receive_packet(ffmpeg_vid_ctx,pkt)) >= 0) {
-					saved_dts = pkt->dts;
-					pkt->stream_index = ffmpeg_vid_stream->index;
-					av_packet_rescale_ts(pkt,ffmpeg_vid_ctx->time_base,ffmpeg_vid_stream->time_base);
-					pkt->pts += (int64_t)ffmpeg_video_frame_time_offset;
-					pkt->dts += (int64_t)ffmpeg_video_frame_time_offset;
-
-					if (av_interleaved_write_frame(ffmpeg_fmt_ctx,pkt) < 0)
-						LOG_MSG("WARNING: av_interleaved_write_frame failed");
-
-					pkt->pts = (int64_t)saved_dts + (int64_t)1;
-					pkt->dts = (int64_t)saved_dts + (int64_t)1;
-					av_packet_rescale_ts(pkt,ffmpeg_vid_ctx->time_base,ffmpeg_vid_stream->time_base);
-					ffmpeg_video_frame_last_time = (uint64_t)pkt->pts;
-				}
-
-				if (r != AVERROR(EAGAIN))
-					LOG_MSG("WARNING: avcodec_receive_packet() video failed to encode (err=%d)",r);
+			if (capture_queue_depth != 0) {
+				if (!CAPTURE_QueueVideoFrame(width, height, bpp, pitch, flags, data, pal, format, repeat))
+					goto skip_video;
 			}
-			av_packet_free(&pkt);
-			capture.video.frames++;
-
-			if ( capture.video.audioused ) {
-				ffmpeg_take_audio((int16_t*)capture.video.audiobuf/*NTS: Ewwwwww.... what if the compiler pads the 2-dimensional array?*/,capture.video.audioused);
-				capture.video.audiowritten = capture.video.audioused*4;
+			else {
+				if (!CAPTURE_EncodeVideoFrame(width, height, bpp, pitch, flags, data, pal, GFX_palette32bpp, format, repeat, &capture.video.audiobuf[0][0], capture.video.audioused))
+					goto skip_video;
 				capture.video.audioused = 0;
 			}
 		}
-#endif
-		else {
-			capture.video.audiowritten = capture.video.audioused*4;
-			capture.video.audioused = 0;
-		}
 
 		/* Everything went okay, set flag again for next frame */
 		CaptureState |= CAPTURE_VIDEO;
@@ -1583,6 +2137,7 @@ skip_shot:
 #endif
     return;
 skip_video:
+	CAPTURE_StopVideoWorker();
 	capture.video.writer = avi_writer_destroy(capture.video.writer);
 # if (C_AVCODEC)
 	ffmpeg_flushout();
@@ -1627,24 +2182,163 @@ void CAPTURE_TakeScreenshot() {
 
 bool CAPTURE_IsScreenshotPending() {
 #if (C_SSHOT) && !defined(C_EMSCRIPTEN)
-	return (CaptureState & CAPTURE_IMAGE) != 0;
+	std::lock_guard<std::mutex> lock(screenshot_mutex);
+	return (CaptureState & CAPTURE_IMAGE) != 0 || screenshot_busy != 0;
 #else
 	return false;
 #endif
 }
 
+bool CAPTURE_WaitScreenshot(unsigned int timeout_ms) {
+#if (C_SSHOT) && !defined(C_EMSCRIPTEN)
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+	std::unique_lock<std::mutex> lock(screenshot_mutex);
+
+	/* The request flag is cleared by the emulation thread, which does not signal: check it
+	 * every few milliseconds until the frame is taken, then sleep until the writer is done */
+	while ((CaptureState & CAPTURE_IMAGE) != 0 || screenshot_busy != 0) {
+		const auto step = ((CaptureState & CAPTURE_IMAGE) != 0) ? std::chrono::milliseconds(5) : std::chrono::milliseconds(timeout_ms);
+		if (screenshot_cond.wait_for(lock, step) == std::cv_status::timeout && std::chrono::steady_clock::now() >= deadline)
+			return false;
+	}
+#else
+	(void)timeout_ms;
+#endif
+	return true;
+}
+
 std::string CAPTURE_GetLastScreenshotPath() {
+#if (C_SSHOT)
+	std::lock_guard<std::mutex> lock(screenshot_mutex);
+#endif
 	std::string result = last_screenshot_path;
 	last_screenshot_path.clear();  // Clear after reading so subsequent calls don't return stale path
 	return result;
 }
 
 void CAPTURE_ClearLastScreenshotPath() {
+#if (C_SSHOT)
+	std::lock_guard<std::mutex> lock(screenshot_mutex);
+#endif
 	last_screenshot_path.clear();
 }
 
 MixerChannel * MIXER_FirstChannel(void);
 
+#if !defined(C_EMSCRIPTEN)
+/* Multitrack audio writer. CAPTURE_MultiTrackAddWave only copies each mixer frame into the
+ * ring of its track, and a thread empties the rings into the AVI file in chunks of at least
+ * MT_WAVE_CHUNK sample frames, one track after the other so the streams stay interleaved.
+ * The emulation thread makes no writer calls while recording. */
+#define MT_WAVE_RING		(1u << 16u)	/* stereo sample frames per track, power of two */
+#define MT_WAVE_CHUNK		4096u
+
+struct MultiTrackRing {
+	int16_t buf[MT_WAVE_RING*2];
+	std::atomic<uint32_t> head{0};		/* frames put in, by the emulation thread */
+	std::atomic<uint32_t> tail{0};		/* frames taken out, by the writer */
+};
+
+static std::vector< std::unique_ptr<MultiTrackRing> > mt_wave_rings;
+static std::thread mt_wave_worker;
+static std::mutex mt_wave_mutex;
+static std::condition_variable mt_wave_cond;
+static bool mt_wave_run = false;
+
+/* Write what the rings hold, only whole chunks unless flushing. Returns true if anything was written. */
+static bool CAPTURE_MultiTrackDrain(bool flush) {
+	bool wrote = false;
+
+	for (size_t i=0;i < mt_wave_rings.size();i++) {
+		MultiTrackRing &r = *mt_wave_rings[i];
+		const uint32_t head = r.head.load(std::memory_order_acquire);
+		uint32_t tail = r.tail.load(std::memory_order_relaxed);
+		uint32_t avail = head - tail;
+
+		if (avail == 0 || (!flush && avail < MT_WAVE_CHUNK))
+			continue;
+
+		avi_writer_stream *os = capture.multitrack_wave.writer->avi_stream + i;
+		while (avail > 0) {
+			const uint32_t at = tail & (MT_WAVE_RING - 1u);
+			const uint32_t n = std::min(avail, MT_WAVE_RING - at);
+
+			avi_writer_stream_write(capture.multitrack_wave.writer,os,&r.buf[at*2],n * 2 * 2,/*keyframe*/0x10);
+			tail += n;
+			avail -= n;
+		}
+		r.tail.store(tail, std::memory_order_release);
+		wrote = true;
+	}
+
+	return wrote;
+}
+
+static void CAPTURE_MultiTrackWorkerThread(void) {
+	std::unique_lock<std::mutex> lock(mt_wave_mutex);
+
+	while (mt_wave_run) {
+		lock.unlock();
+		const bool wrote = CAPTURE_MultiTrackDrain(false);
+		lock.lock();
+
+		if (wrote)
+			mt_wave_cond.notify_all(); /* room again for a track waiting on a full ring */
+		else if (mt_wave_run)
+			mt_wave_cond.wait_for(lock, std::chrono::milliseconds(50));
+	}
+}
+
+static void CAPTURE_MultiTrackPush(MultiTrackRing &r, const int16_t *data, uint32_t len) {
+	uint32_t head = r.head.load(std::memory_order_relaxed);
+
+	while (len > 0) {
+		const uint32_t space = MT_WAVE_RING - (head - r.tail.load(std::memory_order_acquire));
+		if (space == 0) {
+			/* the writer is a whole ring behind, wait for it rather than lose audio */
+			std::unique_lock<std::mutex> lock(mt_wave_mutex);
+			mt_wave_cond.notify_all();
+			mt_wave_cond.wait_for(lock, std::chrono::milliseconds(10));
+			continue;
+		}
+
+		const uint32_t at = head & (MT_WAVE_RING - 1u);
+		const uint32_t n = std::min(std::min(len, space), MT_WAVE_RING - at);
+
+		memcpy(&r.buf[at*2], data, n * 2 * 2);
+		head += n;
+		data += n * 2;
+		len -= n;
+		r.head.store(head, std::memory_order_release);
+	}
+}
+
+static void CAPTURE_MultiTrackStartWorker(void) {
+	mt_wave_rings.clear();
+	for (int i=0;i < capture.multitrack_wave.writer->avi_stream_max;i++)
+		mt_wave_rings.emplace_back(new MultiTrackRing());
+
+	mt_wave_run = true;
+	mt_wave_worker = std::thread(CAPTURE_MultiTrackWorkerThread);
+}
+
+/* Join the writer and write out whatever is left in the rings */
+static void CAPTURE_MultiTrackStopWorker(void) {
+	if (mt_wave_worker.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(mt_wave_mutex);
+			mt_wave_run = false;
+		}
+		mt_wave_cond.notify_all();
+		mt_wave_worker.join();
+	}
+
+	if (capture.multitrack_wave.writer != NULL)
+		CAPTURE_MultiTrackDrain(true);
+	mt_wave_rings.clear();
+}
+#endif
+
 void CAPTURE_MultiTrackAddWave(uint32_t freq, uint32_t len, int16_t * data,const char *name) {
 #if !defined(C_EMSCRIPTEN)
 	if (CaptureState & CAPTURE_MULTITRACK_WAVE) {
@@ -1765,6 +2459,7 @@ void CAPTURE_MultiTrackAddWave(uint32_t freq, uint32_t len, int16_t * data,const
 			if (realpath(path.c_str(), fullpath) != NULL) path = fullpath;
 #endif
 			LOG_MSG("Started capturing multitrack audio (%u channels) to: %s",streams, path.c_str());
+			CAPTURE_MultiTrackStartWorker();
 		}
 
 		if (capture.multitrack_wave.writer != NULL) {
@@ -1772,9 +2467,8 @@ void CAPTURE_MultiTrackAddWave(uint32_t freq, uint32_t len, int16_t * data,const
 			if (ni != capture.multitrack_wave.name_to_stream_index.end()) {
 				size_t index = ni->second;
 
-				if (index < (size_t)capture.multitrack_wave.writer->avi_stream_alloc) {
-					avi_writer_stream *os = capture.multitrack_wave.writer->avi_stream + index;
-					avi_writer_stream_write(capture.multitrack_wave.writer,os,data,len * 2 * 2,/*keyframe*/0x10);
+				if (index < mt_wave_rings.size()) {
+					CAPTURE_MultiTrackPush(*mt_wave_rings[index],data,len);
 				}
 				else {
 					LOG_MSG("Multitrack: Ignoring unknown track '%s', out of range\n",name);
@@ -1946,6 +2640,7 @@ void CAPTURE_MTWaveEvent(bool pressed) {
         if (capture.multitrack_wave.writer != NULL) {
             LOG_MSG("Stopped capturing multitrack wave output.");
             capture.multitrack_wave.name_to_stream_index.clear();
+            CAPTURE_MultiTrackStopWorker();
             avi_writer_end_data(capture.multitrack_wave.writer);
             avi_writer_finish(capture.multitrack_wave.writer);
             avi_writer_close_file(capture.multitrack_wave.writer);
@@ -1981,6 +2676,14 @@ void CAPTURE_NetworkEvent(bool pressed) {
 #endif
 }
 
+void CAPTURE_TraceEvent(bool pressed) {
+	if (!pressed)
+		return;
+
+	if (trace_recording) TRACE_Stop();
+	else TRACE_Start("");
+}
+
 void CAPTURE_WaveEvent(bool pressed) {
 	if (!pressed)
 		return;
@@ -2106,6 +2809,8 @@ void CAPTURE_Destroy(Section *sec) {
 	// if capture is active, fake mapper event to "toggle" it off for each capture case.
 #if (C_SSHOT)
 	if (capture.video.writer != NULL) CAPTURE_VideoEvent(true);
+	CAPTURE_StopVideoWorker();
+	CAPTURE_StopScreenshotWorker();
 #endif
     if (capture.multitrack_wave.writer) CAPTURE_MTWaveEvent(true);
 	if (capture.wave.writer) CAPTURE_WaveEvent(true);
@@ -2169,6 +2874,7 @@ void CAPTURE_Init() {
     SetGameState_Run(section->Get_int("saveslot")-1);
     noremark_save_state = !section->Get_bool("saveremark");
     video_debug_overlay = section->Get_bool("video debug at startup");
+    video_debug_composited = !strcmp(section->Get_string("video debug overlay"), "composited");
     mainMenu.get_item("video_debug_overlay").check(video_debug_overlay).refresh_item(mainMenu);
     mainMenu.get_item("noremark_savestate").check(noremark_save_state).refresh_item(mainMenu);
     force_load_state = section->Get_bool("forceloadstate");
@@ -2213,6 +2919,18 @@ void CAPTURE_Init() {
     else sendkeymap=0;
 
     skip_encoding_unchanged_frames = section->Get_bool("skip encoding unchanged frames");
+#if (C_SSHOT)
+    capture_queue_depth = (Bitu)section->Get_int("video capture queue");
+    capture_queue_block = !strcmp(section->Get_string("video capture queue policy"), "block");
+
+    {
+        std::string fmt = section->Get_string("screenshot format");
+        if (fmt == "qoi") screenshot_format = SCREENSHOT_QOI;
+        else if (fmt == "bmp") screenshot_format = SCREENSHOT_BMP;
+        else screenshot_format = SCREENSHOT_PNG;
+        screenshot_png_level = section->Get_int("screenshot png level");
+    }
+#endif
 
     std::string ffmpeg_pixfmt = section->Get_string("capture chroma format");
 
@@ -2225,6 +2943,8 @@ void CAPTURE_Init() {
         ffmpeg_yuv_format_choice = 0;
     else
         ffmpeg_yuv_format_choice = -1;
+
+    ffmpeg_encoder_choice = section->Get_string("capture video encoder");
 #endif
 
 	std::string capfmt = section->Get_string("capture format");
@@ -2269,6 +2989,9 @@ void CAPTURE_Init() {
 	MAPPER_AddHandler(CAPTURE_NetworkEvent,MK_nothing,0,"capnetrf","Record Network traffic",&item);
 	item->set_text("Record network traffic");
 
+	MAPPER_AddHandler(CAPTURE_TraceEvent,MK_nothing,0,"captrace","Record emulator trace",&item);
+	item->set_text("Record emulator activity trace");
+
 #if (C_SSHOT)
 	MAPPER_AddHandler(CAPTURE_VideoEvent,MK_i,MMODHOST,"video","Record video to AVI", &item);
 	item->set_text("Record video to AVI");
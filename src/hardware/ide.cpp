@@ -21,6 +21,7 @@
 
 #include <math.h>
 #include <assert.h>
+#include <vector>
 #include "dosbox.h"
 #include "inout.h"
 #include "pic.h"
@@ -35,6 +36,8 @@
 #include "bios_disk.h"
 #include "../src/dos/cdrom.h"
 #include "bios.h"
+#include "pci_bus.h"
+#include "hosttime.h"
 
 #if defined(_MSC_VER)
 # pragma warning(disable:4244) /* const fmath::local::uint64_t to double possible loss of data */
@@ -51,6 +54,16 @@
 # pragma warning(disable:4065) /* switch statement no case labels */
 #endif
 
+/* asynchronous disk I/O needs std::thread, which these targets do not have */
+#if !defined(HX_DOS) && !(defined(__MINGW32__) && !defined(__MINGW64_VERSION_MAJOR))
+# include <thread>
+# include <mutex>
+# include <condition_variable>
+# include <deque>
+# include <atomic>
+# define IDE_ASYNC_IO 1
+#endif
+
 struct IDEEventPack {
 #if defined(HX_DOS) || (defined(__MINGW32__) && !defined(__MINGW64_VERSION_MAJOR))
 	IDEEventPack() = default;
@@ -143,6 +156,20 @@ enum {
     IDE_STATUS_ERROR=0x01
 };
 
+/* PCI bus master (SFF-8038i) command and status register bits */
+enum {
+    IDE_BM_CMD_START=0x01,
+    IDE_BM_CMD_READ=0x08,           /* 1=bus master writes to memory (device to host) */
+    IDE_BM_STATUS_ACTIVE=0x01,
+    IDE_BM_STATUS_ERROR=0x02,
+    IDE_BM_STATUS_INTERRUPT=0x04,
+    IDE_BM_STATUS_DMA_CAPABLE=0x60  /* drive 0/1 DMA capable, set by BIOS/driver */
+};
+
+static inline bool ide_is_dma_command(uint8_t cmd) {
+    return cmd >= 0xC8 && cmd <= 0xCB; /* READ DMA, WRITE DMA (with and without retry) */
+}
+
 class IDEController;
 
 #if 0//unused
@@ -219,6 +246,18 @@ public:
     virtual void abort_silent();
 };
 
+/* one disk read or write handed to the I/O worker thread.
+ * The worker only touches these fields between being queued and setting "done". */
+struct IDEAsyncRequest {
+    imageDisk *disk = NULL;
+    uint32_t sectorn = 0;
+    uint32_t count = 0;
+    unsigned char *buf = NULL;
+    bool write = false;
+    uint8_t result = 0;
+    bool done = false;      /* protected by the worker mutex */
+};
+
 class IDEATADevice:public IDEDevice {
 public:
     IDEATADevice(IDEController *c,unsigned char disk_index,bool _slave);
@@ -238,7 +277,21 @@ public:
     virtual void prepare_write(Bitu offset,Bitu size);
     virtual void io_completion();
     virtual bool increment_current_address(Bitu count=1);
+    bool disk_io(imageDisk *disk,uint32_t sectorn,uint32_t count,unsigned char *buf,bool write,uint8_t &result);
+    void async_wait();
 public:
+    enum {
+        ASYNC_IDLE=0,
+        ASYNC_PENDING,      /* request queued or in progress on the worker thread */
+        ASYNC_DONE          /* request finished, result waiting for IDE_DelayedCommand */
+    };
+    unsigned int async_state;
+    uint8_t async_command;  /* command the request was issued for */
+    IDEAsyncRequest async_req;
+    std::vector<unsigned char> dma_buffer;
+    bool dma_prd_exact;     /* PRD table matched the transfer size exactly */
+    uint8_t transfer_mode;  /* DMA transfer mode as set by SET FEATURES 03h (20h+n = multiword DMA n, 40h+n = Ultra DMA n) */
+    bool dma_waiting;       /* DMA command issued, waiting for the host to start the bus master */
     Bitu multiple_sector_max,multiple_sector_count;
     Bitu heads,sects,cyls,progress_count;
     Bitu phys_heads,phys_sects,phys_cyls;
@@ -321,6 +374,7 @@ public:
     bool int13fakev86io;        /* on certain INT 13h calls in virtual 8086 mode, trigger fake CPU I/O traps */
     bool enable_pio32;      /* enable 32-bit PIO (if disabled, attempts at 32-bit PIO are handled as if two 16-bit I/O) */
     bool ignore_pio32;      /* if 32-bit PIO enabled, but ignored, writes do nothing, reads return 0xFFFFFFFF */
+    bool async_io;          /* carry out disk reads/writes on a worker thread while the drive shows BSY */
     bool register_pnp;
     unsigned short alt_io;
     unsigned short base_io;
@@ -333,6 +387,11 @@ public:
     bool interrupt_enable;      /* bit 1 of alt (0x3F6) */
     bool host_reset;        /* bit 2 of alt */
     bool irq_pending;
+    /* PCI bus master DMA (primary/secondary only) */
+    bool bus_master;
+    uint8_t bm_command;
+    uint8_t bm_status;
+    uint32_t bm_prd;
     /* defaults for CD-ROM emulation */
     double spinup_time;
     double spindown_timeout;
@@ -342,6 +401,8 @@ public:
     void register_isapnp();
     void install_io_port();
     void check_device_irq();
+    void bus_master_start();
+    Bitu bus_master_prd(unsigned char *buf,Bitu bytes,bool to_disk,bool &exact);
     ~IDEController();
 private:// Sorry, IDE devices and external code don't get to force IDE IRQs anymore
     void raise_irq();
@@ -376,6 +437,185 @@ int IDE_MatchCDROMDrive(char drv) {
 static void IDE_DelayedCommand(Bitu pk/*which IDE device*/);
 static IDEController* GetIDEController(Bitu idx);
 
+#if defined(IDE_ASYNC_IO)
+/* A single worker thread carries out IDE disk reads and writes in the order they were
+ * submitted, so that slow host storage does not stall emulation. The emulation thread
+ * polls for completion with a PIC event, meanwhile the drive keeps BSY asserted. */
+static struct {
+    std::thread                         thread;
+    std::mutex                          lock;
+    std::condition_variable             wake;       /* worker: new request or shutdown */
+    std::condition_variable             idle;       /* emulation: a request finished */
+    std::deque<IDEAsyncRequest*>        queue;
+    std::atomic<unsigned int>           inflight{0};    /* changed under lock, read without it by IDE_AsyncIO_Drain */
+    bool                                running = false;
+    bool                                shutdown = false;
+} ide_async;
+
+static void IDE_AsyncWorker(void) {
+    std::unique_lock<std::mutex> lk(ide_async.lock);
+
+    while (true) {
+        ide_async.wake.wait(lk,[]{ return ide_async.shutdown || !ide_async.queue.empty(); });
+        if (ide_async.queue.empty()) break; /* shutdown, and nothing left to do */
+
+        IDEAsyncRequest *req = ide_async.queue.front();
+        ide_async.queue.pop_front();
+        lk.unlock();
+
+        const uint8_t r = req->write ?
+            req->disk->Write_AbsoluteSectors(req->sectorn,req->count,req->buf) :
+            req->disk->Read_AbsoluteSectors(req->sectorn,req->count,req->buf);
+
+        lk.lock();
+        req->result = r;
+        req->done = true;
+        ide_async.inflight--;
+        ide_async.idle.notify_all();
+    }
+}
+
+static void IDE_AsyncSubmit(IDEAsyncRequest *req) {
+    std::lock_guard<std::mutex> lk(ide_async.lock);
+
+    if (!ide_async.running) {
+        ide_async.shutdown = false;
+        ide_async.thread = std::thread(IDE_AsyncWorker);
+        ide_async.running = true;
+    }
+
+    req->done = false;
+    ide_async.queue.push_back(req);
+    ide_async.inflight++;
+    ide_async.wake.notify_one();
+}
+
+static bool IDE_AsyncIsDone(IDEAsyncRequest *req) {
+    std::lock_guard<std::mutex> lk(ide_async.lock);
+    return req->done;
+}
+
+static void IDE_AsyncWaitFor(IDEAsyncRequest *req) {
+    std::unique_lock<std::mutex> lk(ide_async.lock);
+    ide_async.idle.wait(lk,[req]{ return req->done; });
+}
+
+static void IDE_AsyncShutdown(void) {
+    {
+        std::lock_guard<std::mutex> lk(ide_async.lock);
+        if (!ide_async.running) return;
+        ide_async.shutdown = true;
+        ide_async.wake.notify_one();
+    }
+
+    ide_async.thread.join();
+    ide_async.running = false;
+}
+#endif
+
+/* Wait for any IDE disk I/O still running on the worker thread. Anything else that reads
+ * or writes disk images from the emulation thread (INT 13h, FAT driver, unmounting) calls
+ * this first, so that it never touches an image at the same time as the worker. */
+void IDE_AsyncIO_Drain(void) {
+#if defined(IDE_ASYNC_IO)
+    if (ide_async.inflight.load() == 0) return;
+
+    std::unique_lock<std::mutex> lk(ide_async.lock);
+    ide_async.idle.wait(lk,[]{ return ide_async.inflight.load() == 0; });
+#endif
+}
+
+/* PIC event: poll the device's outstanding request, then resume the command */
+static void IDE_AsyncPoll(Bitu pk/*which IDE device*/) {
+#if defined(IDE_ASYNC_IO)
+    IDEEventPack ep(pk);
+
+    IDEController *ctrl = GetIDEController(ep.interface());
+    if (ctrl == NULL) return;
+
+    IDEDevice *dev = ctrl->device[ep.device()];
+    if (dev == NULL || dev->type != IDE_TYPE_HDD) return;
+
+    IDEATADevice *ata = (IDEATADevice*)dev;
+    if (ata->async_state != IDEATADevice::ASYNC_PENDING) return;
+
+    if (!IDE_AsyncIsDone(&ata->async_req)) {
+        PIC_AddEvent(IDE_AsyncPoll,0.1/*ms*/,pk);
+        return;
+    }
+
+    ata->async_state = IDEATADevice::ASYNC_DONE;
+
+    /* the command was aborted or replaced (device reset) while the request was in flight */
+    if (ata->state != IDE_DEV_BUSY || ata->command != ata->async_command || ctrl->host_reset) {
+        ata->async_state = IDEATADevice::ASYNC_IDLE;
+        return;
+    }
+
+    IDE_DelayedCommand(pk);
+#else
+    (void)pk;//UNUSED
+#endif
+}
+
+/* Read or write sectors for the current command. Returns true when the transfer has
+ * been done and result is valid. Returns false if the request went to the worker thread,
+ * in which case the caller returns with the drive still busy and IDE_DelayedCommand is
+ * called again once it completes, at which point this returns the result. */
+bool IDEATADevice::disk_io(imageDisk *disk,uint32_t sectorn,uint32_t count,unsigned char *buf,bool write,uint8_t &result) {
+#if defined(IDE_ASYNC_IO)
+    if (async_state == ASYNC_DONE) {
+        async_state = ASYNC_IDLE;
+        if (async_req.disk == disk && async_req.sectorn == sectorn && async_req.count == count &&
+            async_req.buf == buf && async_req.write == write) {
+            result = async_req.result;
+            if (result == 0) (write ? disk_io_bytes_written : disk_io_bytes_read) += (uint64_t)count * 512u;
+            return true;
+        }
+    }
+
+    /* BIOS emulation (faked_command) expects the command to complete immediately */
+    if (controller->async_io && !faked_command) {
+        const unsigned int pk = IDEEventPack(controller->interface_index,slave?1u:0u).get();
+
+        async_req.disk = disk;
+        async_req.sectorn = sectorn;
+        async_req.count = count;
+        async_req.buf = buf;
+        async_req.write = write;
+        async_command = command;
+        async_state = ASYNC_PENDING;
+        IDE_AsyncSubmit(&async_req);
+
+        PIC_RemoveSpecificEvents(IDE_AsyncPoll,pk);
+        PIC_AddEvent(IDE_AsyncPoll,0.1/*ms*/,pk);
+        return false;
+    }
+#endif
+
+    HostTimeScope scope(HOSTTIME_DISK);
+    result = write ? disk->Write_AbsoluteSectors(sectorn,count,buf) : disk->Read_AbsoluteSectors(sectorn,count,buf);
+    if (result == 0) (write ? disk_io_bytes_written : disk_io_bytes_read) += (uint64_t)count * 512u;
+    return true;
+}
+
+/* block until this device's outstanding request (if any) is done, e.g. before the
+ * sector buffer is reused for another command or the device goes away */
+void IDEATADevice::async_wait() {
+#if defined(IDE_ASYNC_IO)
+    if (async_state == ASYNC_PENDING) {
+        const unsigned int pk = IDEEventPack(controller->interface_index,slave?1u:0u).get();
+
+        {
+            HostTimeScope scope(HOSTTIME_DISK);
+            IDE_AsyncWaitFor(&async_req);
+        }
+        PIC_RemoveSpecificEvents(IDE_AsyncPoll,pk);
+        async_state = ASYNC_IDLE;
+    }
+#endif
+}
+
 static void IDE_ATAPI_SpinDown(Bitu pk/*which IDE device*/) {
 	IDEEventPack ep(pk);
 	const unsigned int idx = ep.interface();
@@ -1203,8 +1443,10 @@ void IDEATAPICDROMDevice::on_atapi_busy_time() {
             else {
                 /* OK, try to read */
                 CDROM_Interface *cdrom = getMSCDEXDrive();
+                HostTimeScope scope(HOSTTIME_DISK);
                 bool res = (cdrom != NULL ? cdrom->ReadSectorsHost(/*buffer*/sector,false,LBA,TransferLength) : false);
                 if (res) {
+                    disk_io_bytes_read += (uint64_t)TransferLength * 2048u;
                     prepare_read(0,MIN((unsigned int)(TransferLength*2048),(unsigned int)host_maximum_byte_count));
                     LBAnext = LBA + TransferLength;
                     feature = 0x00;
@@ -1261,6 +1503,7 @@ void IDEATAPICDROMDevice::on_atapi_busy_time() {
                     if (TransferSectorSize == 2048) {
                         if (cdrom && cdrom->ReadSectorsHost(/*buffer*/sector,false,(unsigned long)LBA,(unsigned long)TransferLength)) {
                             res = true;
+                            disk_io_bytes_read += (uint64_t)TransferLength * 2048u;
                             prepare_read(0,MIN((unsigned int)(TransferLength*2048),(unsigned int)host_maximum_byte_count));
                         }
                     }
@@ -1273,6 +1516,7 @@ void IDEATAPICDROMDevice::on_atapi_busy_time() {
                     if (TransferSectorSize == 2352) {
                         if (cdrom && cdrom->ReadSectorsHost(/*buffer*/sector,true,(unsigned long)LBA,(unsigned long)TransferLength)) {
                             res = true;
+                            disk_io_bytes_read += (uint64_t)TransferLength * 2352u;
                             prepare_read(0,MIN((unsigned int)(TransferLength*2352),(unsigned int)host_maximum_byte_count));
                         }
                     }
@@ -1493,6 +1737,7 @@ IDEATAPICDROMDevice::IDEATAPICDROMDevice(IDEController *c,unsigned char drive_in
     if (c->cd_insertion_time > 0) cd_insertion_time = c->cd_insertion_time;
 
     spinup_time = 1000; /* drive takes 1 second to spin up from idle */
+    if (static_cast<Section_prop *>(control->GetSection("dosbox"))->Get_bool("quickboot")) spinup_time = 10;
     if (c->spinup_time > 0) spinup_time = c->spinup_time;
 
     spindown_timeout = 10000; /* drive spins down automatically after 10 seconds */
@@ -2570,11 +2815,12 @@ void IDEATADevice::generate_identify_device() {
         host_writew(sector+(47*2),0x80|multiple_sector_max); /* <- READ/WRITE MULTIPLE MAX SECTORS */
 
     host_writew(sector+(48*2),0x0000);  /* :0  0=we do not support doubleword (32-bit) PIO */
-    host_writew(sector+(49*2),0x0A00);  /* :13 0=Standby timer values managed by device */
+    host_writew(sector+(49*2),controller->bus_master ? 0x0B00 : 0x0A00);
+                        /* :13 0=Standby timer values managed by device */
                         /* :11 1=IORDY supported */
                         /* :10 0=IORDY not disabled */
                         /* :9  1=LBA supported */
-                        /* :8  0=DMA not supported */
+                        /* :8  1=DMA supported (only if attached to a bus master controller) */
     host_writew(sector+(50*2),0x4000);  /* FIXME: ??? */
     host_writew(sector+(51*2),0x00F0);  /* PIO data transfer cycle timing mode */
     host_writew(sector+(52*2),0x00F0);  /* DMA data transfer cycle timing mode */
@@ -2592,8 +2838,13 @@ void IDEATADevice::generate_identify_device() {
 
     host_writed(sector+(60*2),ptotal);  /* total user addressable sectors (LBA) */
     host_writew(sector+(62*2),0x0000);  /* FIXME: ??? */
-    host_writew(sector+(63*2),0x0000);  /* :10 0=Multiword DMA mode 2 not selected */
-                        /* TODO: Basically, we don't do DMA. Fill out this comment */
+    if (controller->bus_master) {
+        /* 2:0 multiword DMA modes 0-2 supported, 10:8 mode selected */
+        host_writew(sector+(63*2),0x0007 | ((transfer_mode & 0xF8) == 0x20 ? (0x0100 << (transfer_mode & 7)) : 0));
+    }
+    else {
+        host_writew(sector+(63*2),0x0000);  /* no multiword DMA */
+    }
     host_writew(sector+(64*2),0x0003);  /* 7:0 PIO modes supported (FIXME ???) */
     host_writew(sector+(65*2),0x0000);  /* FIXME: ??? */
     host_writew(sector+(66*2),0x0000);  /* FIXME: ??? */
@@ -2607,7 +2858,13 @@ void IDEATADevice::generate_identify_device() {
     host_writew(sector+(85*2),0x4208);  /* commands in 82 enabled */
     host_writew(sector+(86*2),0x4000);  /* commands in 83 enabled */
     host_writew(sector+(87*2),0x4000);  /* FIXME: ??? */
-    host_writew(sector+(88*2),0x0000);  /* FIXME: ??? */
+    if (controller->bus_master) {
+        /* 2:0 Ultra DMA modes 0-2 supported, 10:8 mode selected */
+        host_writew(sector+(88*2),0x0007 | ((transfer_mode & 0xF8) == 0x40 ? (0x0100 << (transfer_mode & 7)) : 0));
+    }
+    else {
+        host_writew(sector+(88*2),0x0000);  /* no Ultra DMA */
+    }
     host_writew(sector+(93*3),0x0000);  /* FIXME: ??? */
 
     /* ATA-8 integrity checksum */
@@ -2623,6 +2880,11 @@ IDEATADevice::IDEATADevice(IDEController *c,unsigned char disk_index,bool _slave
     type = IDE_TYPE_HDD;
     multiple_sector_max = sizeof(sector) / 512;
     multiple_sector_count = 1;
+    transfer_mode = 0x22; /* multiword DMA mode 2, as a BIOS would leave it */
+    dma_waiting = false;
+    dma_prd_exact = false;
+    async_state = ASYNC_IDLE;
+    async_command = 0;
     geo_translate = false;
     heads = 0;
     sects = 0;
@@ -2634,6 +2896,7 @@ IDEATADevice::IDEATADevice(IDEController *c,unsigned char disk_index,bool _slave
 }
 
 IDEATADevice::~IDEATADevice() {
+    async_wait();
 }
 
 imageDisk *IDEATADevice::getBIOSdisk() {
@@ -3391,6 +3654,7 @@ static void IDE_DelayedCommand(Bitu pk/*which IDE device*/) {
         uint32_t sectorn = 0;/* FIXME: expand to uint64_t when adding LBA48 emulation */
         unsigned int sectcount;
         imageDisk *disk;
+        uint8_t result;
 //      int i;
 
         switch (dev->command) {
@@ -3439,7 +3703,10 @@ static void IDE_DelayedCommand(Bitu pk/*which IDE device*/) {
                         ((unsigned int)ata->lba[0] - 1u);
                 }
 
-                if (disk->Write_AbsoluteSector(sectorn, ata->sector) != 0) {
+                if (!ata->disk_io(disk, sectorn, 1, ata->sector, true, result))
+                    return; /* completes on the I/O worker thread */
+
+                if (result != 0) {
                     LOG_MSG("Failed to write sector\n");
                     ata->abort_error();
                     dev->raise_irq();
@@ -3521,7 +3788,10 @@ static void IDE_DelayedCommand(Bitu pk/*which IDE device*/) {
                         ((unsigned int)ata->lba[0] - 1u);
                 }
 
-                if (disk->Read_AbsoluteSector(sectorn, ata->sector) != 0) {
+                if (!ata->disk_io(disk, sectorn, 1, ata->sector, false, result))
+                    return; /* completes on the I/O worker thread */
+
+                if (result != 0) {
                     LOG_MSG("ATA read failed\n");
                     ata->abort_error();
                     dev->raise_irq();
@@ -3585,7 +3855,10 @@ static void IDE_DelayedCommand(Bitu pk/*which IDE device*/) {
                         ((unsigned int)ata->lba[0] - 1u);
                 }
 
-                if (disk->Read_AbsoluteSector(sectorn, ata->sector) != 0) {
+                if (!ata->disk_io(disk, sectorn, 1, ata->sector, false, result))
+                    return; /* completes on the I/O worker thread */
+
+                if (result != 0) {
                     LOG_MSG("ATA read failed\n");
                     ata->abort_error();
                     dev->raise_irq();
@@ -3665,14 +3938,14 @@ static void IDE_DelayedCommand(Bitu pk/*which IDE device*/) {
                 if ((512*ata->multiple_sector_count) > sizeof(ata->sector))
                     E_Exit("SECTOR OVERFLOW");
 
-                for (unsigned int cc=0;cc < MIN((Bitu)ata->multiple_sector_count,(Bitu)sectcount);cc++) {
-                    /* it would be great if the disk object had a "read multiple sectors" member function */
-                    if (disk->Read_AbsoluteSector(sectorn+cc, ata->sector+(cc*512)) != 0) {
-                        LOG_MSG("ATA read failed\n");
-                        ata->abort_error();
-                        dev->raise_irq();
-                        return;
-                    }
+                if (!ata->disk_io(disk, sectorn, (uint32_t)MIN((Bitu)ata->multiple_sector_count,(Bitu)sectcount), ata->sector, false, result))
+                    return; /* completes on the I/O worker thread */
+
+                if (result != 0) {
+                    LOG_MSG("ATA read failed\n");
+                    ata->abort_error();
+                    dev->raise_irq();
+                    return;
                 }
 
                 /* NTS: the way this command works is that the drive reads ONE sector, then fires the IRQ
@@ -3731,14 +4004,14 @@ static void IDE_DelayedCommand(Bitu pk/*which IDE device*/) {
                         ((unsigned int)ata->lba[0] - 1);
                 }
 
-                for (unsigned int cc=0;cc < MIN((Bitu)ata->multiple_sector_count,(Bitu)sectcount);cc++) {
-                    /* it would be great if the disk object had a "write multiple sectors" member function */
-                    if (disk->Write_AbsoluteSector(sectorn+cc, ata->sector+(cc*512)) != 0) {
-                        LOG_MSG("Failed to write sector\n");
-                        ata->abort_error();
-                        dev->raise_irq();
-                        return;
-                    }
+                if (!ata->disk_io(disk, sectorn, (uint32_t)MIN((Bitu)ata->multiple_sector_count,(Bitu)sectcount), ata->sector, true, result))
+                    return; /* completes on the I/O worker thread */
+
+                if (result != 0) {
+                    LOG_MSG("Failed to write sector\n");
+                    ata->abort_error();
+                    dev->raise_irq();
+                    return;
                 }
 
                 for (unsigned int cc=0;cc < MIN((Bitu)ata->multiple_sector_count,(Bitu)sectcount);cc++) {
@@ -3770,6 +4043,129 @@ static void IDE_DelayedCommand(Bitu pk/*which IDE device*/) {
                 ata->prepare_write(0,512*MIN((Bitu)ata->multiple_sector_count,(Bitu)sectcount));
                 dev->raise_irq();
                 break;
+            case 0xC8:/* READ DMA */
+            case 0xC9:/* READ DMA WITHOUT RETRY */
+            case 0xCA:/* WRITE DMA */
+            case 0xCB:/* WRITE DMA WITHOUT RETRY */
+                /* the host stopped the bus master before we got here, keep waiting for it */
+                if (!(ctrl->bm_command & IDE_BM_CMD_START)) {
+                    ata->dma_waiting = true;
+                    return;
+                }
+
+                disk = ata->getBIOSdisk();
+                if (disk == NULL) {
+                    LOG_MSG("ATA DMA fail, bios disk N/A\n");
+                    ctrl->bm_status &= ~IDE_BM_STATUS_ACTIVE;
+                    ata->abort_error();
+                    dev->raise_irq();
+                    return;
+                }
+
+                sectcount = ata->count & 0xFF;
+                if (sectcount == 0) sectcount = 256;
+                if (drivehead_is_lba(ata->drivehead)) {
+                    /* LBA */
+                    sectorn = (((unsigned int)ata->drivehead & 0xFu) << 24u) | (unsigned int)ata->lba[0] |
+                        ((unsigned int)ata->lba[1] << 8u) |
+                        ((unsigned int)ata->lba[2] << 16u);
+                }
+                else {
+                    /* C/H/S */
+                    if (ata->lba[0] == 0) {
+                        LOG_MSG("WARNING C/H/S access mode and sector==0\n");
+                        ctrl->bm_status &= ~IDE_BM_STATUS_ACTIVE;
+                        ata->abort_error();
+                        dev->raise_irq();
+                        return;
+                    }
+                    else if ((unsigned int)(ata->drivehead & 0xF) >= (unsigned int)ata->heads ||
+                        (unsigned int)ata->lba[0] > (unsigned int)ata->sects ||
+                        (unsigned int)(ata->lba[1] | ((unsigned int)ata->lba[2] << 8u)) >= (unsigned int)ata->cyls) {
+                        LOG_MSG("C/H/S %u/%u/%u out of bounds %u/%u/%u\n",
+                            (unsigned int)(ata->lba[1] | ((unsigned int)ata->lba[2] << 8u)),
+                            (unsigned int)(ata->drivehead&0xF),
+                            (unsigned int)ata->lba[0],
+                            (unsigned int)ata->cyls,
+                            (unsigned int)ata->heads,
+                            (unsigned int)ata->sects);
+                        ctrl->bm_status &= ~IDE_BM_STATUS_ACTIVE;
+                        ata->abort_error();
+                        dev->raise_irq();
+                        return;
+                    }
+
+                    sectorn = (((unsigned int)ata->drivehead & 0xFu) * ata->sects) +
+                        (((unsigned int)ata->lba[1] | ((unsigned int)ata->lba[2] << 8u)) * ata->sects * ata->heads) +
+                        ((unsigned int)ata->lba[0] - 1u);
+                }
+
+                {
+                    const bool to_disk = dev->command >= 0xCA;
+                    const Bitu bytes = (Bitu)sectcount * 512u;
+                    bool exact = false;
+
+                    if (ata->dma_buffer.size() < bytes)
+                        ata->dma_buffer.resize(256u * 512u);
+
+                    /* gather the data from guest memory, unless this is the write completing on the I/O worker */
+                    if (to_disk && ata->async_state != IDEATADevice::ASYNC_DONE) {
+                        if (ctrl->bus_master_prd(ata->dma_buffer.data(),bytes,true,exact) != bytes) {
+                            LOG_MSG("ATA DMA PRD table shorter than the transfer\n");
+                            ctrl->bm_status &= ~IDE_BM_STATUS_ACTIVE;
+                            ata->abort_error();
+                            dev->raise_irq();
+                            return;
+                        }
+                        ata->dma_prd_exact = exact;
+                    }
+
+                    if (!ata->disk_io(disk, sectorn, sectcount, ata->dma_buffer.data(), to_disk, result))
+                        return; /* completes on the I/O worker thread */
+
+                    if (result != 0) {
+                        LOG_MSG("ATA DMA %s failed\n",to_disk ? "write" : "read");
+                        ctrl->bm_status |= IDE_BM_STATUS_ERROR;
+                        ctrl->bm_status &= ~IDE_BM_STATUS_ACTIVE;
+                        ata->abort_error();
+                        dev->raise_irq();
+                        return;
+                    }
+
+                    /* scatter what was read into guest memory */
+                    if (!to_disk) {
+                        if (ctrl->bus_master_prd(ata->dma_buffer.data(),bytes,false,exact) != bytes) {
+                            LOG_MSG("ATA DMA PRD table shorter than the transfer\n");
+                            ctrl->bm_status &= ~IDE_BM_STATUS_ACTIVE;
+                            ata->abort_error();
+                            dev->raise_irq();
+                            return;
+                        }
+                        ata->dma_prd_exact = exact;
+                    }
+
+                    /* if the PRD table describes exactly the transfer, the bus master goes idle.
+                     * if it describes more, Active stays set along with Interrupt as per SFF-8038i */
+                    if (ata->dma_prd_exact)
+                        ctrl->bm_status &= ~IDE_BM_STATUS_ACTIVE;
+
+                    ata->progress_count += sectcount;
+
+                    /* like the PIO commands, the registers are left pointing at the last sector transferred */
+                    if (sectcount > 1 && !ata->increment_current_address(sectcount - 1)) {
+                        LOG_MSG("READ advance error\n");
+                        ata->abort_error();
+                        dev->raise_irq();
+                        return;
+                    }
+                }
+
+                ata->count = 0;
+                ata->status = IDE_STATUS_DRIVE_READY|IDE_STATUS_DRIVE_SEEK_COMPLETE;
+                ata->state = IDE_DEV_READY;
+                ata->allow_writing = true;
+                dev->raise_irq();
+                break;
             case 0xEC:/*IDENTIFY DEVICE (CONTINUED) */
                 dev->state = IDE_DEV_DATA_READ;
                 dev->status = IDE_STATUS_DRQ|IDE_STATUS_DRIVE_READY|IDE_STATUS_DRIVE_SEEK_COMPLETE;
@@ -3837,6 +4233,71 @@ static void IDE_DelayedCommand(Bitu pk/*which IDE device*/) {
 
 void PC98_IDE_UpdateIRQ(void);
 
+/* bus master DMA moves data between physical (system RAM) addresses and the drive buffer.
+ * Anything outside of RAM is dropped on write and reads back as all ones, like the phys_ functions. */
+static void IDE_BusMaster_PhysWrite(PhysPt addr,const unsigned char *src,Bitu len) {
+    if (addr >= MemSize) return;
+    if (len > (MemSize - addr)) len = MemSize - addr;
+    memcpy(MemBase+addr,src,len);
+    MEM_MarkDirtyRange(addr,len);
+}
+
+static void IDE_BusMaster_PhysRead(PhysPt addr,unsigned char *dst,Bitu len) {
+    Bitu avail = 0;
+
+    if (addr < MemSize) {
+        avail = MIN(len,(Bitu)(MemSize - addr));
+        memcpy(dst,MemBase+addr,avail);
+    }
+    if (avail < len)
+        memset(dst+avail,0xFF,len-avail);
+}
+
+/* host set the start bit. If the selected drive is already waiting on a DMA command, begin it now */
+void IDEController::bus_master_start() {
+    IDEDevice *dev = device[select];
+
+    if (dev == NULL || dev->type != IDE_TYPE_HDD)
+        return;
+
+    IDEATADevice *ata = (IDEATADevice*)dev;
+    if (ata->dma_waiting && ata->state == IDE_DEV_BUSY && ide_is_dma_command(ata->command)) {
+        const unsigned int pk = IDEEventPack(interface_index,(unsigned int)select).get();
+
+        ata->dma_waiting = false;
+        PIC_RemoveSpecificEvents(IDE_DelayedCommand,pk);
+        PIC_AddEvent(IDE_DelayedCommand,(ata->faked_command ? 0.000001 : 0.1)/*ms*/,pk);
+    }
+}
+
+/* walk the PRD table and copy bytes between buf and guest memory. Returns the number of bytes
+ * moved, which is less than requested if the table ends first. exact is set if the last PRD
+ * entry used was the end of the table and was used up completely. */
+Bitu IDEController::bus_master_prd(unsigned char *buf,Bitu bytes,bool to_disk,bool &exact) {
+    uint32_t prd = bm_prd;
+    bool eot = false;
+    Bitu ofs = 0;
+
+    exact = false;
+    while (ofs < bytes && !eot) {
+        /* PRD entry: DWORD physical address, WORD byte count (0=64KB), WORD bit 15 end of table */
+        const PhysPt addr = (PhysPt)(phys_readd(prd) & ~1u);
+        Bitu len = phys_readw(prd+4u) & 0xFFFEu;
+        if (len == 0) len = 0x10000;
+        eot = (phys_readw(prd+6u) & 0x8000u) != 0;
+        prd += 8u;
+
+        const Bitu n = MIN(len,bytes - ofs);
+        if (to_disk) IDE_BusMaster_PhysRead(addr,buf+ofs,n);
+        else IDE_BusMaster_PhysWrite(addr,buf+ofs,n);
+        ofs += n;
+
+        if (ofs == bytes) exact = eot && n == len;
+    }
+
+    return ofs;
+}
+
 void IDEController::check_device_irq() {
     IDEDevice* dev = device[select];
     bool sig = false;
@@ -3851,6 +4312,8 @@ void IDEController::check_device_irq() {
 
 void IDEController::raise_irq() {
     irq_pending = true;
+    /* the bus master latches the rising edge of the IDE interrupt line */
+    if (bus_master) bm_status |= IDE_BM_STATUS_INTERRUPT;
     if (IS_PC98_ARCH) {
         PC98_IDE_UpdateIRQ();
     }
@@ -4142,6 +4605,9 @@ void IDEATADevice::writecommand(uint8_t cmd) {
     if (!command_interruption_ok(cmd))
         return;
 
+    /* the sector buffer may still be in use by the I/O worker */
+    async_wait();
+
 #if 0//TODO: Enable debug
     if (!faked_command) {
         if (drivehead_is_lba(drivehead)) {
@@ -4269,6 +4735,30 @@ void IDEATADevice::writecommand(uint8_t cmd) {
             status = IDE_STATUS_DRIVE_READY|IDE_STATUS_DRQ;
             prepare_write(0UL,512UL*MIN((unsigned long)multiple_sector_count,(unsigned long)(count == 0 ? 256 : count)));
             break;
+        case 0xC8: /* READ DMA */
+        case 0xC9: /* READ DMA WITHOUT RETRY */
+        case 0xCA: /* WRITE DMA */
+        case 0xCB: /* WRITE DMA WITHOUT RETRY */
+            if (!controller->bus_master) {
+                LOG_MSG("IDE/ATA DMA command %02X without bus master DMA\n",cmd);
+                abort_error();
+                allow_writing = true;
+                raise_irq();
+                break;
+            }
+
+            /* the drive asserts DMARQ and waits for the host to start the bus master.
+             * the whole transfer then happens in one go from IDE_DelayedCommand */
+            progress_count = 0;
+            state = IDE_DEV_BUSY;
+            status = IDE_STATUS_BUSY;
+            dma_waiting = true;
+            PIC_RemoveSpecificEvents(IDE_DelayedCommand,pk);
+            if (controller->bm_command & IDE_BM_CMD_START) {
+                dma_waiting = false;
+                PIC_AddEvent(IDE_DelayedCommand,(faked_command ? 0.000001 : 0.1)/*ms*/,pk);
+            }
+            break;
         case 0xC6: /* SET MULTIPLE MODE */
             /* only sector counts 1, 2, 4, 8, 16, 32, 64, and 128 are legal by standard.
              * NTS: There's a bug in VirtualBox that makes 0 legal too! */
@@ -4324,7 +4814,11 @@ void IDEATADevice::writecommand(uint8_t cmd) {
             if (feature == 0x66/*Disable reverting to power on defaults*/ ||
                 feature == 0xCC/*Enable reverting to power on defaults*/ ||
                 feature == 0x03/*Set transfer mode according to sector count register (required by Linux kernel)*/) {
-                /* ignore */
+                /* remember the DMA mode so IDENTIFY reports it as selected, PIO modes are ignored */
+                if (feature == 0x03 && controller->bus_master &&
+                    ((count & 0xF8) == 0x20 || (count & 0xF8) == 0x40) && (count & 7) <= 2)
+                    transfer_mode = (uint8_t)count;
+
                 status = IDE_STATUS_DRIVE_READY|IDE_STATUS_DRIVE_SEEK_COMPLETE;
                 state = IDE_DEV_READY;
             }
@@ -4369,6 +4863,11 @@ IDEController::IDEController(Section* configuration,unsigned char index):Module_
     int13fakev86io = section->Get_bool("int13fakev86io");
     enable_pio32 = section->Get_bool("enable pio32");
     ignore_pio32 = section->Get_bool("ignore pio32");
+#if defined(IDE_ASYNC_IO)
+    async_io = section->Get_bool("async io");
+#else
+    async_io = false;
+#endif
     spinup_time = section->Get_int("cd-rom spinup time");
     spindown_timeout = section->Get_int("cd-rom spindown timeout");
     cd_insertion_time = section->Get_int("cd-rom insertion delay");
@@ -4377,6 +4876,10 @@ IDEController::IDEController(Section* configuration,unsigned char index):Module_
     irq_pending = false;
     interrupt_enable = true;
     interface_index = index;
+    bus_master = !IS_PC98_ARCH && index < 2 && has_pcibus_enable() && section->Get_bool("bus master dma");
+    bm_command = 0;
+    bm_status = IDE_BM_STATUS_DMA_CAPABLE;
+    bm_prd = 0;
     device[0] = NULL;
     device[1] = NULL;
     base_io = 0;
@@ -4804,8 +5307,106 @@ static void ide_baseio_w(Bitu port,Bitu val,Bitu iolen) {
     }
 }
 
+/* PCI bus master registers (BAR4 of the PCI IDE function): primary channel at +0, secondary at +8 */
+static IO_ReadHandleObject IDE_BusMaster_ReadHandler;
+static IO_WriteHandleObject IDE_BusMaster_WriteHandler;
+static unsigned int IDE_BusMaster_Base = 0;
+
+static IDEController *match_ide_busmaster(Bitu port) {
+    IDEController *ide = idecontroller[((port - IDE_BusMaster_Base) >> 3u) & 1u];
+    if (ide != NULL && ide->bus_master) return ide;
+    return NULL;
+}
+
+static Bitu ide_busmaster_readb(IDEController *ide,unsigned int reg) {
+    switch (reg) {
+        case 0: /* command */
+            return ide->bm_command;
+        case 2: /* status */
+            return ide->bm_status;
+        case 4: case 5: case 6: case 7: /* PRD table address */
+            return (ide->bm_prd >> ((reg - 4u) * 8u)) & 0xFFu;
+        default:
+            break;
+    }
+
+    return 0x00;
+}
+
+static void ide_busmaster_writeb(IDEController *ide,unsigned int reg,uint8_t val) {
+    switch (reg) {
+        case 0: { /* command */
+            const uint8_t old = ide->bm_command;
+
+            /* the direction bit may only be changed while the bus master is stopped */
+            if (old & IDE_BM_CMD_START)
+                val = (uint8_t)((val & IDE_BM_CMD_START) | (old & IDE_BM_CMD_READ));
+
+            ide->bm_command = val & (IDE_BM_CMD_START|IDE_BM_CMD_READ);
+
+            if (!(old & IDE_BM_CMD_START) && (val & IDE_BM_CMD_START)) {
+                ide->bm_status |= IDE_BM_STATUS_ACTIVE;
+                ide->bus_master_start();
+            }
+            else if ((old & IDE_BM_CMD_START) && !(val & IDE_BM_CMD_START)) {
+                /* stopping the bus master aborts whatever it was doing */
+                ide->bm_status &= ~IDE_BM_STATUS_ACTIVE;
+            }
+            break; }
+        case 2: /* status: drive DMA capable bits are R/W, error and interrupt are write 1 to clear */
+            ide->bm_status = (uint8_t)((ide->bm_status & ~IDE_BM_STATUS_DMA_CAPABLE) | (val & IDE_BM_STATUS_DMA_CAPABLE));
+            ide->bm_status &= (uint8_t)~(val & (IDE_BM_STATUS_ERROR|IDE_BM_STATUS_INTERRUPT));
+            break;
+        case 4: case 5: case 6: case 7: { /* PRD table address, DWORD aligned */
+            const unsigned int shf = (reg - 4u) * 8u;
+            ide->bm_prd = (ide->bm_prd & ~(0xFFu << shf)) | ((uint32_t)val << shf);
+            ide->bm_prd &= ~3u;
+            break; }
+        default:
+            break;
+    }
+}
+
+static Bitu ide_busmaster_r(Bitu port,Bitu iolen) {
+    IDEController *ide = match_ide_busmaster(port);
+    Bitu ret = 0;
+
+    if (ide == NULL)
+        return ~(0UL);
+
+    for (Bitu i=0;i < iolen;i++)
+        ret |= ide_busmaster_readb(ide,(unsigned int)((port + i) & 7u)) << (i * 8u);
+
+    return ret;
+}
+
+static void ide_busmaster_w(Bitu port,Bitu val,Bitu iolen) {
+    IDEController *ide = match_ide_busmaster(port);
+
+    if (ide == NULL)
+        return;
+
+    for (Bitu i=0;i < iolen;i++)
+        ide_busmaster_writeb(ide,(unsigned int)((port + i) & 7u),(uint8_t)(val >> (i * 8u)));
+}
+
+/* called by the PCI IDE function when BAR4 or the I/O enable bit changes */
+void IDE_BusMaster_SetIO(unsigned int base,bool enable) {
+    IDE_BusMaster_ReadHandler.Uninstall();
+    IDE_BusMaster_WriteHandler.Uninstall();
+    IDE_BusMaster_Base = 0;
+
+    if (enable && base != 0) {
+        IDE_BusMaster_Base = base;
+        IDE_BusMaster_ReadHandler.Install(base,ide_busmaster_r,IO_MA,16);
+        IDE_BusMaster_WriteHandler.Install(base,ide_busmaster_w,IO_MA,16);
+    }
+}
+
 static void IDE_Destroy(Section* sec) {
     (void)sec;//UNUSED
+    PCI_RemoveIDEBusMaster_Device();
+
     for (unsigned int i=0;i < MAX_IDE_CONTROLLERS;i++) {
         if (idecontroller[i] != NULL) {
             delete idecontroller[i];
@@ -4813,6 +5414,9 @@ static void IDE_Destroy(Section* sec) {
         }
     }
 
+#if defined(IDE_ASYNC_IO)
+    IDE_AsyncShutdown();
+#endif
     init_ide = 0;
 }
 
@@ -4843,6 +5447,9 @@ static void IDE_Init(Section* sec,unsigned char ide_interface) {
     ide = idecontroller[ide_interface] = new IDEController(sec,ide_interface);
     ide->install_io_port();
 
+    if (ide->bus_master)
+        PCI_AddIDEBusMaster_Device();
+
     PIC_SetIRQMask((unsigned int)ide->IRQ,false);
 }
 
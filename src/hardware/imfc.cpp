@@ -5011,6 +5011,7 @@ private:
 	bool m_interruptHandlerRunning            = {};
 	SDL_mutex* m_interruptHandlerRunningMutex = nullptr;
 	SDL_cond* m_interruptHandlerRunningCond   = nullptr;
+	uint32_t m_cardEvents                     = 0; // protected by m_interruptHandlerRunningMutex
 	std::atomic_bool keep_running             = {};
 
 	// memory allocation on the IMF
@@ -5150,6 +5151,32 @@ private:
 	{
 		m_irqTriggerImf.enableInterrupts();
 	}
+
+	// The card's processor threads sleep on m_interruptHandlerRunningCond
+	// instead of polling. Anything that may change what they are waiting
+	// for (port accesses from the PC, IRQ edges, buffer progress) bumps
+	// m_cardEvents through signalCardEvent(). Wait loops take the count before checking their
+	// condition so that a change in between is never missed; the timeout
+	// is only a safety net.
+	uint32_t currentCardEvent()
+	{
+		SDL_LockMutex(m_interruptHandlerRunningMutex);
+		const uint32_t events = m_cardEvents;
+		SDL_UnlockMutex(m_interruptHandlerRunningMutex);
+		return events;
+	}
+	void waitForCardEvent(uint32_t& seen)
+	{
+		SDL_LockMutex(m_interruptHandlerRunningMutex);
+		if (m_cardEvents == seen && keep_running.load()) {
+			SDL_CondWaitTimeout(m_interruptHandlerRunningCond,
+			                    m_interruptHandlerRunningMutex,
+			                    10);
+		}
+		seen = m_cardEvents;
+		SDL_UnlockMutex(m_interruptHandlerRunningMutex);
+	}
+
 	void delayNop()
 	{ /* FIXME:wait for 1xNOP */
 	}
@@ -5481,6 +5508,8 @@ private:
 
 		log_debug("softReboot - starting infinite loop");
 		m_finishedBootupSequence = true;
+		uint32_t seen = currentCardEvent();
+		signalCardEvent();
 		while (keep_running.load()) {
 			// log_debug("DEBUG: heartbeat in MUSIC_MODE_LOOP %i",
 			// debug_count++);
@@ -5488,7 +5517,7 @@ private:
 			// reenable
 			MUSIC_MODE_LOOP_read_System_And_Dispatch();
 			logSuccess();
-			SDL_Delay(1);
+			waitForCardEvent(seen);
 		}
 	}
 
@@ -5506,7 +5535,8 @@ private:
 		m_outgoingMusicCardMessageData[0] = 0xE0;
 		send_card_bytes_to_System((uint8_t*)&m_outgoingMusicCardMessageData,
 		                          1);
-		while (true) {
+		uint32_t seen = currentCardEvent();
+		while (keep_running.load()) {
 			ReadResult readResult = midiIn_readMidiDataByte();
 			if (readResult.status == READ_ERROR) {
 				disableInterrupts();
@@ -5525,6 +5555,8 @@ private:
 			} else if (systemReadResult.status == MIDI_DATA_AVAILABLE) {
 				send_midi_byte_to_MidiOut(systemReadResult.data);
 				clearIncomingMusicCardMessageBuffer();
+			} else if (readResult.status == NO_DATA) {
+				waitForCardEvent(seen);
 			}
 		}
 	}
@@ -5636,6 +5668,7 @@ private:
 	// ROM Address: 0x0422
 	ReadResult readMidiDataWithTimeout()
 	{
+		uint32_t seen = currentCardEvent();
 		m_readMidiDataTimeoutCountdown = 0xFF;
 		if ((m_midi_ReceiveSource_SendTarget & 2) == 0) {
 			// read midi data from midi in
@@ -5656,6 +5689,7 @@ private:
 						return midiInReadError(
 						        &m_midiDataPacketFromMidiIn);
 					}
+					waitForCardEvent(seen);
 					break;
 				case READ_SUCCESS:
 					if (readResult.data < 0xF8) {
@@ -5709,6 +5743,7 @@ private:
 					// log_debug("readMidiDataWithTimeout()
 					// - MidiDataPacket is in state 01_36_37_38
 					// and timeout not expired");
+					waitForCardEvent(seen);
 					break;
 				case SYSTEM_DATA_AVAILABLE:
 					// log_debug("readMidiDataWithTimeout()
@@ -7523,6 +7558,7 @@ private:
 		// clang-format on
 
 		m_bufferFromSystemState.unlock();
+		signalCardEvent();
 	}
 
 	// ROM Address: 0x1006
@@ -7655,6 +7691,7 @@ private:
 		// clang-format on
 
 		m_bufferToSystemState.unlock();
+		signalCardEvent();
 	}
 
 	// ROM Address: 0x10B1
@@ -7715,6 +7752,7 @@ private:
 	{
 		log_debug("IMF->PC: Adding data [%X%02X] to queue", dataMSB, dataLSB);
 		m_sendDataToSystemTimoutCountdown = 3;
+		uint32_t seen = currentCardEvent();
 		m_bufferToSystemState.lock();
 		while (m_bufferToSystemState.isBufferFull()) {
 			m_bufferToSystemState.unlock();
@@ -7726,6 +7764,7 @@ private:
 				        FIFO_OVERFLOW_ERROR_MUSICCARD_TO_SYSTEM);
 				return WRITE_ERROR;
 			}
+			waitForCardEvent(seen);
 			m_bufferToSystemState.lock();
 		}
 		m_bufferToSystemState.pushData((dataMSB << 8) | dataLSB);
@@ -7754,6 +7793,7 @@ private:
 		m_piuIMF.setPort2Bit(6, true); // Group 0 (OUTPUT) - Write
 		                               // interrupt enable = true
 		SDL_UnlockMutex(m_hardwareMutex);
+		signalCardEvent();
 		// enableInterrupts();
 		return WRITE_SUCCESS;
 	}
@@ -11993,17 +12033,21 @@ private:
 		// FIXME: Implementation that looks more like the original
 		if ((m_midi_ReceiveSource_SendTarget & 1) != 0) {
 			// target is "system"
+			uint32_t seen = currentCardEvent();
 			m_bufferToSystemState.lock();
-			while (!m_bufferToSystemState.isEmpty()) {
+			while (!m_bufferToSystemState.isEmpty() && keep_running.load()) {
 				m_bufferToSystemState.unlock();
+				waitForCardEvent(seen);
 				m_bufferToSystemState.lock();
 			};
 			m_bufferToSystemState.unlock();
 		} else {
 			// target is "midi out"
+			uint32_t seen = currentCardEvent();
 			m_bufferToMidiOutState.lock();
-			while (!m_bufferToMidiOutState.isEmpty()) {
+			while (!m_bufferToMidiOutState.isEmpty() && keep_running.load()) {
 				m_bufferToMidiOutState.unlock();
+				waitForCardEvent(seen);
 				m_bufferToMidiOutState.lock();
 			}
 			m_bufferToMidiOutState.unlock();
@@ -12530,14 +12574,16 @@ public:
 		                  SDL_LockMutex(m_interruptHandlerRunningMutex);
 		                  // log("m_interruptHandlerRunning = true");
 		                  m_interruptHandlerRunning = true;
-		                  SDL_CondSignal(m_interruptHandlerRunningCond);
+		                  m_cardEvents++;
+		                  SDL_CondBroadcast(m_interruptHandlerRunningCond);
 		                  SDL_UnlockMutex(m_interruptHandlerRunningMutex);
 	                  } /*callbackOnLowToHigh*/,
 	                  [this]() {
 		                  SDL_LockMutex(m_interruptHandlerRunningMutex);
 		                  // log("m_interruptHandlerRunning = false");
 		                  m_interruptHandlerRunning = false;
-		                  SDL_CondSignal(m_interruptHandlerRunningCond);
+		                  m_cardEvents++;
+		                  SDL_CondBroadcast(m_interruptHandlerRunningCond);
 		                  SDL_UnlockMutex(m_interruptHandlerRunningMutex);
 	                  } /*callbackOnToHighToLow*/),
 	          keep_running(true)
@@ -12654,9 +12700,12 @@ public:
 
 		// wait until we're ready to receive data... it's a workaround
 		// for now, but well....
+		SDL_LockMutex(m_interruptHandlerRunningMutex);
 		while (!m_finishedBootupSequence) {
-			;
+			SDL_CondWait(m_interruptHandlerRunningCond,
+			             m_interruptHandlerRunningMutex);
 		}
+		SDL_UnlockMutex(m_interruptHandlerRunningMutex);
 	}
 
 	static int SDLCALL imfMainThreadStart(void* data)
@@ -12681,16 +12730,32 @@ public:
 		log_debug("IMF processor interrupt thread started");
 		while (keep_running.load()) {
 			SDL_LockMutex(m_interruptHandlerRunningMutex);
-			while (!m_interruptHandlerRunning) {
+			while (!m_interruptHandlerRunning && keep_running.load()) {
 				SDL_CondWait(m_interruptHandlerRunningCond,
 				             m_interruptHandlerRunningMutex);
 			}
+			uint32_t seen = m_cardEvents;
 			SDL_UnlockMutex(m_interruptHandlerRunningMutex);
+			if (!keep_running.load()) {
+				break;
+			}
 			interruptHandler();
+			// The interrupt line can stay high while the handler has
+			// nothing to do (e.g. the PC has not read the last byte
+			// yet), so only run it again once something changed
+			waitForCardEvent(seen);
 		}
 		return 0;
 	}
 
+	void signalCardEvent()
+	{
+		SDL_LockMutex(m_interruptHandlerRunningMutex);
+		m_cardEvents++;
+		SDL_CondBroadcast(m_interruptHandlerRunningCond);
+		SDL_UnlockMutex(m_interruptHandlerRunningMutex);
+	}
+
 	Bitu readPortPIU0()
 	{
 		SDL_LockMutex(m_hardwareMutex);
@@ -12842,8 +12907,9 @@ public:
 	~MusicFeatureCard()
 	{
 		keep_running = false;
+		signalCardEvent();
 		SDL_WaitThread(m_mainThread, nullptr);
-		//SDL_WaitThread(m_interruptThread, nullptr); // DOSBox-X hangs on exit with this
+		SDL_WaitThread(m_interruptThread, nullptr);
 	}
 };
 
@@ -12870,13 +12936,16 @@ static Bitu readPortPIU0(Bitu port, Bitu iolen)
 {
 	(void)port;
 	check8bit(iolen);
-	return imfcSingleton->readPortPIU0();
+	const Bitu val = imfcSingleton->readPortPIU0();
+	imfcSingleton->signalCardEvent(); // the card may send its next byte
+	return val;
 }
 static void writePortPIU0(Bitu port, Bitu val, Bitu iolen)
 {
 	(void)port;
 	check8bit(iolen);
 	imfcSingleton->writePortPIU0(val);
+	imfcSingleton->signalCardEvent();
 }
 static Bitu readPortPIU1(Bitu port, Bitu iolen)
 {
@@ -12889,6 +12958,7 @@ static void writePortPIU1(Bitu port, Bitu val, Bitu iolen)
 	(void)port;
 	check8bit(iolen);
 	imfcSingleton->writePortPIU1(val);
+	imfcSingleton->signalCardEvent();
 }
 static Bitu readPortPIU2(Bitu port, Bitu iolen)
 {
@@ -12901,6 +12971,7 @@ static void writePortPIU2(Bitu port, Bitu val, Bitu iolen)
 	(void)port;
 	check8bit(iolen);
 	imfcSingleton->writePortPIU2(val);
+	imfcSingleton->signalCardEvent();
 }
 static Bitu readPortPCR(Bitu port, Bitu iolen)
 {
@@ -12913,6 +12984,7 @@ static void writePortPCR(Bitu port, Bitu val, Bitu iolen)
 	(void)port;
 	check8bit(iolen);
 	imfcSingleton->writePortPCR(val);
+	imfcSingleton->signalCardEvent();
 }
 static Bitu readPortCNTR0(Bitu port, Bitu iolen)
 {
@@ -12925,6 +12997,7 @@ static void writePortCNTR0(Bitu port, Bitu val, Bitu iolen)
 	(void)port;
 	check8bit(iolen);
 	imfcSingleton->writePortCNTR0(val);
+	imfcSingleton->signalCardEvent();
 }
 static Bitu readPortCNTR1(Bitu port, Bitu iolen)
 {
@@ -12937,6 +13010,7 @@ static void writePortCNTR1(Bitu port, Bitu val, Bitu iolen)
 	(void)port;
 	check8bit(iolen);
 	imfcSingleton->writePortCNTR1(val);
+	imfcSingleton->signalCardEvent();
 }
 static Bitu readPortCNTR2(Bitu port, Bitu iolen)
 {
@@ -12949,6 +13023,7 @@ static void writePortCNTR2(Bitu port, Bitu val, Bitu iolen)
 	(void)port;
 	check8bit(iolen);
 	imfcSingleton->writePortCNTR2(val);
+	imfcSingleton->signalCardEvent();
 }
 static Bitu readPortTCWR(Bitu port, Bitu iolen)
 {
@@ -12961,6 +13036,7 @@ static void writePortTCWR(Bitu port, Bitu val, Bitu iolen)
 	(void)port;
 	check8bit(iolen);
 	imfcSingleton->writePortTCWR(val);
+	imfcSingleton->signalCardEvent();
 }
 static Bitu readPortTCR(Bitu port, Bitu iolen)
 {
@@ -12973,6 +13049,7 @@ static void writePortTCR(Bitu port, Bitu val, Bitu iolen)
 	(void)port;
 	check8bit(iolen);
 	imfcSingleton->writePortTCR(val);
+	imfcSingleton->signalCardEvent();
 }
 static Bitu readPortTSR(Bitu port, Bitu iolen)
 {
@@ -12985,6 +13062,7 @@ static void writePortTSR(Bitu port, Bitu val, Bitu iolen)
 	(void)port;
 	check8bit(iolen);
 	imfcSingleton->writePortTSR(val);
+	imfcSingleton->signalCardEvent();
 }
 
 static void IMFC_Mixer_Callback(Bitu len)
@@ -16,7 +16,10 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#define _USE_MATH_DEFINES // needed for M_PI in Visual Studio
+#include <math.h>
 #include <string.h>
+#include <vector>
 #include "dosbox.h"
 #include "inout.h"
 #include "logging.h"
@@ -29,14 +32,39 @@
 
 #define SID_FREQ 894886
 
+#if !defined(M_PI)
+# define M_PI (3.141592654)
+#endif
+
+/* quality 4: reSID samples at INNOVA_OVERSAMPLE times the output rate in its cheap
+ * SAMPLE_FAST mode and a short windowed-sinc FIR decimates that to the output rate.
+ * Cleaner than 0 and 1, far cheaper than reSID's own resampler (2 and 3). */
+#define INNOVA_OVERSAMPLE 4
+#define INNOVA_FIR_TAPS (12*INNOVA_OVERSAMPLE)
+
+/* register writes, stamped with the emulated time they happened at */
+struct innova_write_t {
+	double time; /* PIC_FullIndex() */
+	uint8_t reg,val;
+};
+
 static struct {
 	SID2* sid;
 	Bitu rate;
 	Bitu basePort;
 	Bitu last_used;
 	MixerChannel * chan;
+	std::vector<innova_write_t> writes;
+	bool decimate;
+	float fir[INNOVA_FIR_TAPS];
+	std::vector<float> over; /* oversampled input, the first INNOVA_FIR_TAPS-1 are history */
 } innova;
 
+/* Writes are not applied right away. The mixer callback clocks the SID up to the time of
+ * each one, so the chip runs in one go per callback and writes still land where the guest
+ * made them. Past this many, the SID is brought up to date early. */
+#define INNOVA_MAX_QUEUED 4096
+
 static void innova_write(Bitu port,Bitu val,Bitu iolen) {
     (void)iolen;//UNUSED
 	if (!innova.last_used) {
@@ -44,8 +72,13 @@ static void innova_write(Bitu port,Bitu val,Bitu iolen) {
 	}
 	innova.last_used=PIC_Ticks;
 
-	Bitu sidPort = port-innova.basePort;
-	innova.sid->write((reg8)sidPort, (reg8)val);
+	if (innova.writes.size() >= INNOVA_MAX_QUEUED) innova.chan->FillUp();
+
+	innova_write_t w;
+	w.time = PIC_FullIndex();
+	w.reg = (uint8_t)(port-innova.basePort);
+	w.val = (uint8_t)val;
+	innova.writes.push_back(w);
 }
 
 static Bitu innova_read(Bitu port,Bitu iolen) {
@@ -55,16 +88,74 @@ static Bitu innova_read(Bitu port,Bitu iolen) {
 }
 
 
+/* Clock the SID for exactly count samples at rate. reSID keeps the fractional cycles itself,
+ * the budget only has to be large enough and it stops once the buffer is full. */
+static void INNOVA_Clock(short *buffer, Bitu count, Bitu rate) {
+	Bitu done = 0;
+	while (done != count) {
+		cycle_count delta_t = (cycle_count)((SID_FREQ*(count-done))/rate + SID_FREQ/rate + 1);
+		done += (Bitu)innova.sid->clock(delta_t, buffer+done, (int)(count-done));
+	}
+}
+
+static void INNOVA_Render(short *buffer, Bitu count) {
+	if (!count) return;
+	if (!innova.decimate) {
+		INNOVA_Clock(buffer, count, innova.rate);
+		return;
+	}
+
+	const Bitu hist = INNOVA_FIR_TAPS-1;
+	const Bitu n = count*INNOVA_OVERSAMPLE;
+	short tmp[1024];
+
+	innova.over.resize(hist+n);
+	for (Bitu i=0;i < n;) {
+		Bitu todo = n-i;
+		if (todo > 1024) todo = 1024;
+		INNOVA_Clock(tmp, todo, innova.rate*INNOVA_OVERSAMPLE);
+		for (Bitu j=0;j < todo;j++) innova.over[hist+i+j] = (float)tmp[j];
+		i += todo;
+	}
+
+	/* plain loops over float arrays, which the compiler vectorizes */
+	const float *in = &innova.over[0];
+	for (Bitu i=0;i < count;i++) {
+		const float *x = in + i*INNOVA_OVERSAMPLE;
+		float acc = 0;
+		for (unsigned int t=0;t < INNOVA_FIR_TAPS;t++) acc += x[t]*innova.fir[t];
+		if (acc > 32767.0f) acc = 32767.0f;
+		else if (acc < -32768.0f) acc = -32768.0f;
+		buffer[i] = (short)lrintf(acc);
+	}
+	memmove(&innova.over[0], &innova.over[n], hist*sizeof(float));
+}
+
 static void INNOVA_CallBack(Bitu len) {
 	if (!len) return;
 
-	cycle_count delta_t = (cycle_count)(SID_FREQ*len/innova.rate);
 	short* buffer = (short*)MixTemp;
 	Bitu bufindex = 0;
 
-	while(delta_t && bufindex != len) {
-		bufindex += (Bitu)innova.sid->clock(delta_t, buffer+bufindex, (int)(len-bufindex));
+	/* the len samples end now, place each queued write at its sample within them */
+	if (!innova.writes.empty()) {
+		const double end = PIC_FullIndex();
+		const double start = end - ((double)len * 1000.0) / (double)innova.rate;
+		for (const auto &w : innova.writes) {
+			Bitu at = 0;
+			if (w.time > start) {
+				at = (Bitu)(((w.time - start) * (double)innova.rate) / 1000.0);
+				if (at > len) at = len;
+			}
+			if (at > bufindex) {
+				INNOVA_Render(buffer+bufindex, at-bufindex);
+				bufindex = at;
+			}
+			innova.sid->write((reg8)w.reg, (reg8)w.val);
+		}
+		innova.writes.clear();
 	}
+	INNOVA_Render(buffer+bufindex, len-bufindex);
 	innova.chan->AddSamples_m16(len, buffer);
 
 	if (innova.last_used+5000<PIC_Ticks) {
@@ -86,10 +177,12 @@ public:
 		innova.basePort = (unsigned int)section->Get_hex("sidbase");
 		sampling_method method = SAMPLE_FAST;
 		int m = section->Get_int("quality");
+		innova.decimate = false;
 		switch(m) {
 		case 1: method = SAMPLE_INTERPOLATE; break;
 		case 2: method = SAMPLE_RESAMPLE_FAST; break;
 		case 3: method = SAMPLE_RESAMPLE_INTERPOLATE; break;
+		case 4: innova.decimate = true; break;
 		}
 
 		LOG_MSG("INNOVA:Initializing Innovation SSI-2001 (SID) emulation...");
@@ -103,8 +196,28 @@ public:
 		innova.sid->set_chip_model(MOS6581);
 		innova.sid->enable_filter(true);
 		innova.sid->enable_external_filter(true);
-		innova.sid->set_sampling_parameters(SID_FREQ, method, (double)innova.rate, -1, 0.97);
+		if (innova.decimate) {
+			innova.sid->set_sampling_parameters(SID_FREQ, SAMPLE_FAST, (double)(innova.rate*INNOVA_OVERSAMPLE), -1, 0.97);
+
+			/* Blackman windowed sinc, cut off at 90% of the output Nyquist frequency */
+			const double fc = 0.45 / INNOVA_OVERSAMPLE;
+			const double mid = (INNOVA_FIR_TAPS - 1) / 2.0;
+			double sum = 0;
+			for (unsigned int t=0;t < INNOVA_FIR_TAPS;t++) {
+				const double x = t - mid;
+				const double sinc = (x == 0) ? 2.0 * fc : sin(2.0 * M_PI * fc * x) / (M_PI * x);
+				const double win = 0.42 - 0.5 * cos(2.0 * M_PI * t / (INNOVA_FIR_TAPS - 1)) + 0.08 * cos(4.0 * M_PI * t / (INNOVA_FIR_TAPS - 1));
+				innova.fir[t] = (float)(sinc * win);
+				sum += sinc * win;
+			}
+			for (unsigned int t=0;t < INNOVA_FIR_TAPS;t++) innova.fir[t] = (float)(innova.fir[t] / sum);
+			innova.over.assign(INNOVA_FIR_TAPS-1, 0.0f);
+		}
+		else {
+			innova.sid->set_sampling_parameters(SID_FREQ, method, (double)innova.rate, -1, 0.97);
+		}
 
+		innova.writes.clear();
 		innova.last_used=0;
 
 		LOG_MSG("INNOVA:... finished.");
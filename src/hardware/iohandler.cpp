@@ -26,12 +26,14 @@
 #include "cpu.h"
 #include "../src/cpu/lazyflags.h"
 #include "callback.h"
+#include "bintrace.h"
 
 //#define ENABLE_PORTLOG
 
 #include <math.h> /* floor */
 
 #include <vector>
+#include <unordered_map>
 
 extern bool pcibus_enable;
 
@@ -51,6 +53,28 @@ IO_ReadHandler * io_readhandlers[3][IO_MAX];
 
 static IO_callout_vector IO_callouts[IO_callouts_max];
 
+/* Ports where more than one device answered during the slow path (ISA devices pulling the data
+ * lines down together, ISA devices probed behind a PCI device, ...) can't be cached as a single
+ * handler. The handlers that answered are kept here per port and width instead, so that the next
+ * access replays them without going through the callouts again. Entries are only reached through
+ * io_readhandlers/io_writehandlers and are dropped by IO_InvalidateCachedHandler. */
+struct IO_ResolvedRead {
+    IO_ReadHandler*                 primary;        /* provides the value */
+    std::vector<IO_ReadHandler*>    and_with;       /* ANDed into the value */
+    std::vector<IO_ReadHandler*>    discard;        /* called, value ignored */
+};
+
+static std::unordered_map<Bitu,IO_ResolvedRead> io_resolved_read;
+static std::unordered_map<Bitu,std::vector<IO_WriteHandler*> > io_resolved_write;
+
+static inline Bitu IO_ResolvedKey(Bitu port,Bitu iolen) {
+    return (port << 3u) | iolen;
+}
+
+/* how often each port went through the slow path, see IO_GetSlowPathHits */
+static uint32_t io_slowpath_reads[IO_MAX];
+static uint32_t io_slowpath_writes[IO_MAX];
+
 #if C_DEBUG
 void DEBUG_EnableDebugger(void);
 #endif
@@ -100,7 +124,7 @@ void IO_WriteDefault(Bitu port,Bitu val,Bitu iolen) {
 	}
 }
 
-template <enum IO_Type_t iotype> static unsigned int IO_Gen_Callout_Read(Bitu &ret,IO_ReadHandler* &f,Bitu port,Bitu iolen) {
+template <enum IO_Type_t iotype> static unsigned int IO_Gen_Callout_Read(Bitu &ret,IO_ReadHandler* &f,Bitu port,Bitu iolen,std::vector<IO_ReadHandler*> &called) {
     int actual = iotype - IO_TYPE_MIN;
     IO_callout_vector &vec = IO_callouts[actual];
     unsigned int match = 0;
@@ -115,6 +139,7 @@ template <enum IO_Type_t iotype> static unsigned int IO_Gen_Callout_Read(Bitu &r
 
         t_f = obj.m_r_handler(obj,port,iolen);
         if (t_f != NULL) {
+            called.push_back(t_f);
             if (match != 0) {
                 if (iotype == IO_TYPE_ISA)
                     ret &= t_f(port,iolen); /* ISA pullup resisters vs ISA devices pulling data lines down (two conflicting devices) */
@@ -132,7 +157,7 @@ template <enum IO_Type_t iotype> static unsigned int IO_Gen_Callout_Read(Bitu &r
     return match;
 }
 
-template <enum IO_Type_t iotype> static unsigned int IO_Gen_Callout_Write(IO_WriteHandler* &f,Bitu port,Bitu val,Bitu iolen) {
+template <enum IO_Type_t iotype> static unsigned int IO_Gen_Callout_Write(IO_WriteHandler* &f,Bitu port,Bitu val,Bitu iolen,std::vector<IO_WriteHandler*> &called) {
     int actual = iotype - IO_TYPE_MIN;
     IO_callout_vector &vec = IO_callouts[actual];
     unsigned int match = 0;
@@ -147,6 +172,7 @@ template <enum IO_Type_t iotype> static unsigned int IO_Gen_Callout_Write(IO_Wri
 
         t_f = obj.m_w_handler(obj,port,iolen);
         if (t_f != NULL) {
+            called.push_back(t_f);
             t_f(port,val,iolen);
             if (match == 0) f = t_f;
             match++;
@@ -156,38 +182,57 @@ template <enum IO_Type_t iotype> static unsigned int IO_Gen_Callout_Write(IO_Wri
     return match;
 }
 
-static unsigned int IO_Motherboard_Callout_Read(Bitu &ret,IO_ReadHandler* &f,Bitu port,Bitu iolen) {
-    return IO_Gen_Callout_Read<IO_TYPE_MB>(ret,f,port,iolen);
+static unsigned int IO_Motherboard_Callout_Read(Bitu &ret,IO_ReadHandler* &f,Bitu port,Bitu iolen,std::vector<IO_ReadHandler*> &called) {
+    return IO_Gen_Callout_Read<IO_TYPE_MB>(ret,f,port,iolen,called);
 }
 
-static unsigned int IO_PCI_Callout_Read(Bitu &ret,IO_ReadHandler* &f,Bitu port,Bitu iolen) {
-    return IO_Gen_Callout_Read<IO_TYPE_PCI>(ret,f,port,iolen);
+static unsigned int IO_PCI_Callout_Read(Bitu &ret,IO_ReadHandler* &f,Bitu port,Bitu iolen,std::vector<IO_ReadHandler*> &called) {
+    return IO_Gen_Callout_Read<IO_TYPE_PCI>(ret,f,port,iolen,called);
 }
 
-static unsigned int IO_ISA_Callout_Read(Bitu &ret,IO_ReadHandler* &f,Bitu port,Bitu iolen) {
-    return IO_Gen_Callout_Read<IO_TYPE_ISA>(ret,f,port,iolen);
+static unsigned int IO_ISA_Callout_Read(Bitu &ret,IO_ReadHandler* &f,Bitu port,Bitu iolen,std::vector<IO_ReadHandler*> &called) {
+    return IO_Gen_Callout_Read<IO_TYPE_ISA>(ret,f,port,iolen,called);
 }
 
-static unsigned int IO_Motherboard_Callout_Write(IO_WriteHandler* &f,Bitu port,Bitu val,Bitu iolen) {
-    return IO_Gen_Callout_Write<IO_TYPE_MB>(f,port,val,iolen);
+static unsigned int IO_Motherboard_Callout_Write(IO_WriteHandler* &f,Bitu port,Bitu val,Bitu iolen,std::vector<IO_WriteHandler*> &called) {
+    return IO_Gen_Callout_Write<IO_TYPE_MB>(f,port,val,iolen,called);
 }
 
-static unsigned int IO_PCI_Callout_Write(IO_WriteHandler* &f,Bitu port,Bitu val,Bitu iolen) {
-    return IO_Gen_Callout_Write<IO_TYPE_PCI>(f,port,val,iolen);
+static unsigned int IO_PCI_Callout_Write(IO_WriteHandler* &f,Bitu port,Bitu val,Bitu iolen,std::vector<IO_WriteHandler*> &called) {
+    return IO_Gen_Callout_Write<IO_TYPE_PCI>(f,port,val,iolen,called);
 }
 
-static unsigned int IO_ISA_Callout_Write(IO_WriteHandler* &f,Bitu port,Bitu val,Bitu iolen) {
-    return IO_Gen_Callout_Write<IO_TYPE_ISA>(f,port,val,iolen);
+static unsigned int IO_ISA_Callout_Write(IO_WriteHandler* &f,Bitu port,Bitu val,Bitu iolen,std::vector<IO_WriteHandler*> &called) {
+    return IO_Gen_Callout_Write<IO_TYPE_ISA>(f,port,val,iolen,called);
+}
+
+static Bitu IO_ReadResolved(Bitu port,Bitu iolen) {
+    const IO_ResolvedRead &r = io_resolved_read[IO_ResolvedKey(port,iolen)];
+    Bitu ret = r.primary(port,iolen);
+
+    for (size_t i=0;i < r.and_with.size();i++) ret &= r.and_with[i](port,iolen);
+    for (size_t i=0;i < r.discard.size();i++) r.discard[i](port,iolen);
+
+    return ret;
+}
+
+static void IO_WriteResolved(Bitu port,Bitu val,Bitu iolen) {
+    const std::vector<IO_WriteHandler*> &r = io_resolved_write[IO_ResolvedKey(port,iolen)];
+
+    for (size_t i=0;i < r.size();i++) r[i](port,val,iolen);
 }
 
 static Bitu IO_ReadSlowPath(Bitu port,Bitu iolen) {
     IO_ReadHandler *f = iolen > 1 ? IO_ReadDefault : IO_ReadBlocked;
+    std::vector<IO_ReadHandler*> mb_called,pci_called,isa_called;
     unsigned int match = 0;
     unsigned int porti;
     Bitu ret = ~0ul;
 
+    io_slowpath_reads[port]++;
+
     /* check motherboard devices */
-    match = IO_Motherboard_Callout_Read(/*&*/ret,/*&*/f,port,iolen);
+    match = IO_Motherboard_Callout_Read(/*&*/ret,/*&*/f,port,iolen,mb_called);
 
     if (match == 0) {
         /* first PCI bus device, then ISA.
@@ -211,44 +256,67 @@ static Bitu IO_ReadSlowPath(Bitu port,Bitu iolen) {
          * I wish I had tools to watch I/O transactions on the ISA bus to verify this. --J.C. */
         if (pcibus_enable) {
             /* PCI and PCI/ISA bridge emulation */
-            match = IO_PCI_Callout_Read(/*&*/ret,/*&*/f,port,iolen);
+            match = IO_PCI_Callout_Read(/*&*/ret,/*&*/f,port,iolen,pci_called);
 
             if (match == 0) {
                 /* PCI didn't take it, ask ISA bus */
-                match = IO_ISA_Callout_Read(/*&*/ret,/*&*/f,port,iolen);
+                match = IO_ISA_Callout_Read(/*&*/ret,/*&*/f,port,iolen,isa_called);
             }
             else {
                 Bitu dummy;
 
                 /* PCI did match. Based on behavior noted above, probe ISA bus anyway and discard data. */
-                match += IO_ISA_Callout_Read(/*&*/dummy,/*&*/f,port,iolen);
+                match += IO_ISA_Callout_Read(/*&*/dummy,/*&*/f,port,iolen,isa_called);
             }
         }
         else {
             /* Pure ISA emulation */
-            match = IO_ISA_Callout_Read(/*&*/ret,/*&*/f,port,iolen);
+            match = IO_ISA_Callout_Read(/*&*/ret,/*&*/f,port,iolen,isa_called);
         }
     }
 
     /* if nothing matched, assign default handler to IO handler slot.
      * if one device responded, assign its handler to the IO handler slot.
-     * if more than one responded, then do not update the IO handler slot. */
+     * if more than one responded, replay the same devices in the same order from now on. */
     assert(iolen >= 1 && iolen <= 4);
     porti = (iolen >= 4) ? 2 : (unsigned int)(iolen - 1); /* 1 2 x 4 -> 0 1 1 2 */
     LOG(LOG_MISC,LOG_DEBUG)("IO read slow path port=%x iolen=%u: device matches=%u",(unsigned int)port,(unsigned int)iolen,(unsigned int)match);
     if (match == 0) ret = f(port,iolen); /* if nobody responded, then call the default */
-    if (match <= 1) io_readhandlers[porti][port] = f;
+    if (match <= 1) {
+        io_readhandlers[porti][port] = f;
+    }
+    else if (!mb_called.empty()) {
+        /* only the first motherboard device is ever read */
+        io_readhandlers[porti][port] = mb_called[0];
+    }
+    else {
+        IO_ResolvedRead &r = io_resolved_read[IO_ResolvedKey(port,iolen)];
+        r.and_with.clear();
+        r.discard.clear();
+        if (!pci_called.empty()) {
+            r.primary = pci_called[0];
+            r.discard = isa_called;
+        }
+        else {
+            r.primary = isa_called[0];
+            r.and_with.assign(isa_called.begin()+1,isa_called.end());
+        }
+        io_readhandlers[porti][port] = IO_ReadResolved;
+    }
 
 	return ret;
 }
 
 void IO_WriteSlowPath(Bitu port,Bitu val,Bitu iolen) {
     IO_WriteHandler *f = iolen > 1 ? IO_WriteDefault : IO_WriteBlocked;
+    std::vector<IO_WriteHandler*> called;
     unsigned int match = 0;
     unsigned int porti;
 
+    io_slowpath_writes[port]++;
+
     /* check motherboard devices */
-    match = IO_Motherboard_Callout_Write(/*&*/f,port,val,iolen);
+    match = IO_Motherboard_Callout_Write(/*&*/f,port,val,iolen,called);
 
     if (match == 0) {
         /* first PCI bus device, then ISA.
@@ -272,31 +340,37 @@ void IO_WriteSlowPath(Bitu port,Bitu val,Bitu iolen) {
          * I wish I had tools to watch I/O transactions on the ISA bus to verify this. --J.C. */
         if (pcibus_enable) {
             /* PCI and PCI/ISA bridge emulation */
-            match = IO_PCI_Callout_Write(/*&*/f,port,val,iolen);
+            match = IO_PCI_Callout_Write(/*&*/f,port,val,iolen,called);
 
             if (match == 0) {
                 /* PCI didn't take it, ask ISA bus */
-                match = IO_ISA_Callout_Write(/*&*/f,port,val,iolen);
+                match = IO_ISA_Callout_Write(/*&*/f,port,val,iolen,called);
             }
             else {
                 /* PCI did match. Based on behavior noted above, probe ISA bus anyway and discard data. */
-                match += IO_ISA_Callout_Write(/*&*/f,port,val,iolen);
+                match += IO_ISA_Callout_Write(/*&*/f,port,val,iolen,called);
             }
         }
         else {
             /* Pure ISA emulation */
-            match = IO_ISA_Callout_Write(/*&*/f,port,val,iolen);
+            match = IO_ISA_Callout_Write(/*&*/f,port,val,iolen,called);
         }
     }
 
     /* if nothing matched, assign default handler to IO handler slot.
      * if one device responded, assign its handler to the IO handler slot.
-     * if more than one responded, then do not update the IO handler slot. */
+     * if more than one responded, write to the same devices in the same order from now on. */
     assert(iolen >= 1 && iolen <= 4);
     porti = (iolen >= 4) ? 2 : (unsigned int)(iolen - 1); /* 1 2 x 4 -> 0 1 1 2 */
     LOG(LOG_MISC,LOG_DEBUG)("IO write slow path port=%x data=%x iolen=%u: device matches=%u",(unsigned int)port,(unsigned int)val,(unsigned int)iolen,(unsigned int)match);
     if (match == 0) f(port,val,iolen); /* if nobody responded, then call the default */
-    if (match <= 1) io_writehandlers[porti][port] = f;
+    if (match <= 1) {
+        io_writehandlers[porti][port] = f;
+    }
+    else {
+        io_resolved_write[IO_ResolvedKey(port,iolen)].swap(called);
+        io_writehandlers[porti][port] = IO_WriteResolved;
+    }
 
 #if C_DEBUG && 0
     if (match == 0) DEBUG_EnableDebugger();
@@ -354,6 +428,20 @@ void IO_InvalidateCachedHandler(Bitu port,Bitu range) {
             p++;
         }
     }
+
+    if (!io_resolved_read.empty() || !io_resolved_write.empty()) {
+        for (Bitu p=port;p < (port+range);p++) {
+            for (Bitu iolen=1;iolen <= 4;iolen <<= 1) {
+                io_resolved_read.erase(IO_ResolvedKey(p,iolen));
+                io_resolved_write.erase(IO_ResolvedKey(p,iolen));
+            }
+        }
+    }
+}
+
+uint32_t IO_GetSlowPathHits(Bitu port,bool write) {
+    assert(port < IO_MAX);
+    return write ? io_slowpath_writes[port] : io_slowpath_reads[port];
 }
 
 void IO_ReadHandleObject::Install(Bitu port,IO_ReadHandler * handler,Bitu mask,Bitu range) {
@@ -492,6 +580,7 @@ void log_io(Bitu width, bool write, Bitu port, Bitu val) {
 
 void IO_WriteB(Bitu port,uint8_t val) {
 	log_io(0, true, port, val);
+	BINTRACE_IO(true, 1, port, val);
 	if (GCC_UNLIKELY(GETFLAG(VM) && (CPU_IO_Exception(port,1)))) {
 		CPU_ForceV86FakeIO_Out(port,val,1);
 	}
@@ -503,6 +592,7 @@ void IO_WriteB(Bitu port,uint8_t val) {
 
 void IO_WriteW(Bitu port,uint16_t val) {
 	log_io(1, true, port, val);
+	BINTRACE_IO(true, 2, port, val);
 	if (GCC_UNLIKELY(GETFLAG(VM) && (CPU_IO_Exception(port,2)))) {
 		CPU_ForceV86FakeIO_Out(port,val,2);
 	}
@@ -514,6 +604,7 @@ void IO_WriteW(Bitu port,uint16_t val) {
 
 void IO_WriteD(Bitu port,uint32_t val) {
 	log_io(2, true, port, val);
+	BINTRACE_IO(true, 4, port, val);
 	if (GCC_UNLIKELY(GETFLAG(VM) && (CPU_IO_Exception(port,4)))) {
 		CPU_ForceV86FakeIO_Out(port,val,4);
 	}
@@ -533,6 +624,7 @@ uint8_t IO_ReadB(Bitu port) {
 		retval = (uint8_t)io_readhandlers[0][port](port,1);
 	}
 	log_io(0, false, port, retval);
+	BINTRACE_IO(false, 1, port, retval);
 	return retval;
 }
 
@@ -546,6 +638,7 @@ uint16_t IO_ReadW(Bitu port) {
 		retval = (uint16_t)io_readhandlers[1][port](port,2);
 	}
 	log_io(1, false, port, retval);
+	BINTRACE_IO(false, 2, port, retval);
 	return retval;
 }
 
@@ -559,6 +652,7 @@ uint32_t IO_ReadD(Bitu port) {
 		retval = (uint32_t)io_readhandlers[2][port](port,4);
 	}
 	log_io(2, false, port, retval);
+	BINTRACE_IO(false, 4, port, retval);
 	return retval;
 }
 
@@ -24,22 +24,40 @@
 #include "dosbox.h"
 #include "ipxserver.h"
 #include "logging.h"
-#include "timer.h"
 #include <stdlib.h>
 #include <string.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include "ipx.h"
 
+/* The server relays on a thread of its own, independent of the emulation speed. Every wakeup
+ * drains all pending datagrams (up to IPXRELAYBATCH per receive call) and each one is relayed with
+ * a single send call to all of its destinations. Clients are found through a hash table keyed by
+ * their guest address, broadcasts go to the list of connected clients only. */
+#define IPXRELAYBATCH 32
+
 IPaddress ipxServerIp;  // IPAddress for server's listening port
 UDPsocket ipxServerSocket;  // Listening server socket
 
 packetBuffer connBuffer[SOCKETTABLESIZE];
 
-uint8_t inBuffer[IPXBUFFERSIZE];
 PackedIP ipconnguest[SOCKETTABLESIZE]; // the MAC address associated with each connection
 IPaddress ipconn[SOCKETTABLESIZE];  // Active TCP/IP connection 
-UDPsocket tcpconn[SOCKETTABLESIZE];  // Active TCP/IP connections
 SDLNet_SocketSet serverSocketSet;
-TIMER_TickHandler* serverTimer;
+
+static std::unordered_map<uint64_t,uint16_t> ipxServerClients; // guest address -> connection
+static std::vector<uint16_t> ipxServerActive; // connected connections, for broadcasts
+static std::mutex ipxServerLock; // connection tables, against IPXNET STATUS on the emulator thread
+static std::thread ipxServerThread;
+static std::atomic<bool> ipxServerQuit{false};
+static UDPpacket **ipxServerPackets = NULL;
+
+static inline uint64_t guestKey(uint32_t host, uint16_t port) {
+	return ((uint64_t)host << 16u) | port;
+}
 
 uint8_t packetCRC(uint8_t *buffer, uint16_t bufSize) {
 	uint8_t tmpCRC = 0;
@@ -51,30 +69,12 @@ uint8_t packetCRC(uint8_t *buffer, uint16_t bufSize) {
 	return tmpCRC;
 }
 
-/*
-static void closeSocket(uint16_t sockidx) {
-	uint32_t host;
-
-	host = ipconn[sockidx].host;
-	LOG_MSG("IPXSERVER: %d.%d.%d.%d disconnected", CONVIP(host));
-
-	SDLNet_TCP_DelSocket(serverSocketSet,tcpconn[sockidx]);
-	SDLNet_TCP_Close(tcpconn[sockidx]);
-	connBuffer[sockidx].connected = false;
-	connBuffer[sockidx].waitsize = false;
-}
-*/
-
 static void sendIPXPacket(uint8_t *buffer, int16_t bufSize) {
 	uint16_t srcport, destport;
 	uint32_t srchost, desthost;
-	uint16_t i;
-	Bits result;
-	UDPpacket outPacket;
-	outPacket.channel = -1;
-	outPacket.data = buffer;
-	outPacket.len = bufSize;
-	outPacket.maxlen = bufSize;
+	static UDPpacket outPacket[SOCKETTABLESIZE];
+	static UDPpacket *outPackets[SOCKETTABLESIZE];
+	int count = 0;
 	IPXHeader *tmpHeader;
 	tmpHeader = (IPXHeader *)buffer;
 
@@ -86,39 +86,31 @@ static void sendIPXPacket(uint8_t *buffer, int16_t bufSize) {
 
 	if(desthost == 0xffffffff) {
 		// Broadcast
-		for(i=0;i<SOCKETTABLESIZE;i++) {
-			if(connBuffer[i].connected && ((ipconnguest[i].host != srchost)||(ipconnguest[i].port!=srcport))) {
-				outPacket.address = ipconn[i];
-				result = SDLNet_UDP_Send(ipxServerSocket,-1,&outPacket);
-				if(result == 0) {
-					LOG_MSG("IPXSERVER: %s", SDLNet_GetError());
-					continue;
-				}
-				//LOG_MSG("IPXSERVER: Packet of %d bytes sent from %d.%d.%d.%d to %d.%d.%d.%d (BROADCAST) (%x CRC)", bufSize, CONVIP(srchost), CONVIP(ipconn[i].host), packetCRC(&buffer[30], bufSize-30));
-			}
+		for(uint16_t i : ipxServerActive) {
+			if((ipconnguest[i].host != srchost)||(ipconnguest[i].port!=srcport))
+				outPacket[count++].address = ipconn[i];
 		}
 	} else {
 		// Specific address
-		for(i=0;i<SOCKETTABLESIZE;i++) {
-			if((connBuffer[i].connected) && (ipconnguest[i].host == desthost) && (ipconnguest[i].port == destport)) {
-				outPacket.address = ipconn[i];
-				result = SDLNet_UDP_Send(ipxServerSocket,-1,&outPacket);
-				if(result == 0) {
-					LOG_MSG("IPXSERVER: %s", SDLNet_GetError());
-					continue;
-				}
-				//LOG_MSG("IPXSERVER: Packet sent from %d.%d.%d.%d to %d.%d.%d.%d", CONVIP(srchost), CONVIP(desthost));
-			}
-		}
+		auto it = ipxServerClients.find(guestKey(desthost,destport));
+		if(it != ipxServerClients.end())
+			outPacket[count++].address = ipconn[it->second];
 	}
 
-
-
-
+	for(int i=0;i<count;i++) {
+		outPacket[i].channel = -1;
+		outPacket[i].data = buffer;
+		outPacket[i].len = bufSize;
+		outPacket[i].maxlen = bufSize;
+		outPackets[i] = &outPacket[i];
+	}
+	if(count != 0 && SDLNet_UDP_SendV(ipxServerSocket,outPackets,count) < count)
+		LOG_MSG("IPXSERVER: %s", SDLNet_GetError());
 }
 
 bool IPX_isConnectedToServer(Bits tableNum, IPaddress ** ptrAddr) {
 	if(tableNum >= SOCKETTABLESIZE) return false;
+	std::lock_guard<std::mutex> guard(ipxServerLock);
 	*ptrAddr = &ipconn[tableNum];
 	return connBuffer[tableNum].connected;
 }
@@ -149,84 +141,101 @@ static void ackClient(IPaddress clientAddr,bool extAck,PackedIP *guestmac) {
 	regPacket.len = sizeof(regHeader);
 	regPacket.maxlen = sizeof(regHeader);
 	regPacket.address = clientAddr;
+	regPacket.channel = -1;
 	// Send registration string to client.  If client doesn't get this, client will not be registered
 	SDLNet_UDP_Send(ipxServerSocket,-1,&regPacket);
 }
 
-static void IPX_ServerLoop() {
-	UDPpacket inPacket;
+static void IPX_ServerPacket(UDPpacket &inPacket) {
 	IPaddress tmpAddr;
-
-	//char regString[] = "IPX Register\0";
+	uint8_t *inBuffer = inPacket.data;
 
 	uint16_t i;
 	uint32_t host;
-	Bits result;
-
-	inPacket.channel = -1;
-	inPacket.data = &inBuffer[0];
-	inPacket.maxlen = IPXBUFFERSIZE;
-
-
-	result = SDLNet_UDP_Recv(ipxServerSocket, &inPacket);
-	if (result != 0) {
-		// Check to see if incoming packet is a registration packet
-		// For this, I just spoofed the echo protocol packet designation 0x02
-		IPXHeader *tmpHeader;
-		tmpHeader = (IPXHeader *)&inBuffer[0];
-
-		// Check to see if echo packet
-		if(SDLNet_Read16(tmpHeader->dest.socket) == 0x2) {
-			// Null destination node means it's a server registration packet
-			if(tmpHeader->dest.addr.byIP.host == 0x0) {
-				UnpackIP(tmpHeader->src.addr.byIP, &tmpAddr);
-				for(i=0;i<SOCKETTABLESIZE;i++) {
-					if(!connBuffer[i].connected) {
-						bool extAck = false;
-
-						// Use preferred host IP rather than the reported source IP
-						// It may be better to use the reported source
-						ipconn[i] = inPacket.address;
-
-						// Other DOSBox forks may expect the MAC address to match the IP host + port combined. Default behavior.
-						ipconnguest[i].host = inPacket.address.host;
-						ipconnguest[i].port = inPacket.address.port;
-
-						// Allow client to register their own MAC address. Guest MAC address sits just after header at offset 30.
-						if (tmpHeader->transControl == (unsigned char)'M' && inPacket.len >= (30+6)) {
-							LOG_MSG("IPXSERVER: Allowing client to register their own MAC address (DOSBox-X extension) %02x:%02x:%02x:%02x:%02x:%02x",
-								inBuffer[30],inBuffer[31],inBuffer[32],inBuffer[33],inBuffer[34],inBuffer[35]);
-							memcpy(&ipconnguest[i],&inBuffer[30],6);
-							extAck = true;
-						}
-
-						connBuffer[i].connected = true;
-						host = ipconn[i].host;
-						LOG_MSG("IPXSERVER: Connect from %d.%d.%d.%d", CONVIP(host));
-						ackClient(inPacket.address,extAck,&ipconnguest[i]);
-						return;
-					} else {
-						if((ipconnguest[i].host == tmpAddr.host) && (ipconnguest[i].port == tmpAddr.port)) {
-							LOG_MSG("IPXSERVER: Reconnect from %d.%d.%d.%d", CONVIP(tmpAddr.host));
-							// Update anonymous port number if changed
-							ipconn[i].port = inPacket.address.port;
-							ackClient(inPacket.address,false,&ipconnguest[i]);
-							return;
-						}
+
+	if (inPacket.len < (int)sizeof(IPXHeader)) return;
+
+	// Check to see if incoming packet is a registration packet
+	// For this, I just spoofed the echo protocol packet designation 0x02
+	IPXHeader *tmpHeader;
+	tmpHeader = (IPXHeader *)&inBuffer[0];
+
+	// Check to see if echo packet
+	if(SDLNet_Read16(tmpHeader->dest.socket) == 0x2) {
+		// Null destination node means it's a server registration packet
+		if(tmpHeader->dest.addr.byIP.host == 0x0) {
+			UnpackIP(tmpHeader->src.addr.byIP, &tmpAddr);
+			auto it = ipxServerClients.find(guestKey(tmpAddr.host,tmpAddr.port));
+			if(it != ipxServerClients.end()) {
+				i = it->second;
+				LOG_MSG("IPXSERVER: Reconnect from %d.%d.%d.%d", CONVIP(tmpAddr.host));
+				// Update anonymous port number if changed
+				ipconn[i].port = inPacket.address.port;
+				ackClient(inPacket.address,false,&ipconnguest[i]);
+				return;
+			}
+			for(i=0;i<SOCKETTABLESIZE;i++) {
+				if(!connBuffer[i].connected) {
+					bool extAck = false;
+
+					// Use preferred host IP rather than the reported source IP
+					// It may be better to use the reported source
+					ipconn[i] = inPacket.address;
+
+					// Other DOSBox forks may expect the MAC address to match the IP host + port combined. Default behavior.
+					ipconnguest[i].host = inPacket.address.host;
+					ipconnguest[i].port = inPacket.address.port;
+
+					// Allow client to register their own MAC address. Guest MAC address sits just after header at offset 30.
+					if (tmpHeader->transControl == (unsigned char)'M' && inPacket.len >= (30+6)) {
+						LOG_MSG("IPXSERVER: Allowing client to register their own MAC address (DOSBox-X extension) %02x:%02x:%02x:%02x:%02x:%02x",
+							inBuffer[30],inBuffer[31],inBuffer[32],inBuffer[33],inBuffer[34],inBuffer[35]);
+						memcpy(&ipconnguest[i],&inBuffer[30],6);
+						extAck = true;
 					}
-					
+
+					connBuffer[i].connected = true;
+					ipxServerClients[guestKey(ipconnguest[i].host,ipconnguest[i].port)] = i;
+					ipxServerActive.push_back(i);
+					host = ipconn[i].host;
+					LOG_MSG("IPXSERVER: Connect from %d.%d.%d.%d", CONVIP(host));
+					ackClient(inPacket.address,extAck,&ipconnguest[i]);
+					return;
 				}
 			}
 		}
+	}
+
+	// IPX packet is complete.  Now interpret IPX header and send to respective IP address
+	sendIPXPacket((uint8_t *)inPacket.data, (int16_t)inPacket.len);
+}
 
-		// IPX packet is complete.  Now interpret IPX header and send to respective IP address
-		sendIPXPacket((uint8_t *)inPacket.data, inPacket.len);
+static void IPX_ServerLoop() {
+	while(!ipxServerQuit) {
+		/* wake up on the first datagram, or now and then to notice IPX_StopServer() */
+		const int ready = SDLNet_CheckSockets(serverSocketSet, 50);
+		if(ready < 0) SDL_Delay(50);
+		if(ready <= 0) continue;
+
+		int result;
+		while((result = SDLNet_UDP_RecvV(ipxServerSocket, ipxServerPackets)) > 0) {
+			std::lock_guard<std::mutex> guard(ipxServerLock);
+			for(int i=0;i<result;i++) IPX_ServerPacket(*ipxServerPackets[i]);
+			if(result < IPXRELAYBATCH) break;
+		}
+		if(result < 0) LOG_MSG("IPXSERVER: %s", SDLNet_GetError());
 	}
 }
 
 void IPX_StopServer() {
-	TIMER_DelTickHandler(&IPX_ServerLoop);
+	ipxServerQuit = true;
+	if(ipxServerThread.joinable()) ipxServerThread.join();
+	SDLNet_FreeSocketSet(serverSocketSet);
+	SDLNet_FreePacketV(ipxServerPackets);
+	ipxServerPackets = NULL;
 	SDLNet_UDP_Close(ipxServerSocket);
+	ipxServerClients.clear();
+	ipxServerActive.clear();
 }
 
 bool IPX_StartServer(uint16_t portnum) {
@@ -234,13 +243,27 @@ bool IPX_StartServer(uint16_t portnum) {
 
 	if(!SDLNet_ResolveHost(&ipxServerIp, NULL, portnum)) {
 	
-		//serverSocketSet = SDLNet_AllocSocketSet(SOCKETTABLESIZE);
 		ipxServerSocket = SDLNet_UDP_Open(portnum);
 		if(!ipxServerSocket) return false;
 
+		serverSocketSet = SDLNet_AllocSocketSet(1);
+		/* the packet vector is NULL terminated, which is where SDLNet_UDP_RecvV() stops */
+		ipxServerPackets = SDLNet_AllocPacketV(IPXRELAYBATCH, IPXBUFFERSIZE);
+		if(!serverSocketSet || !ipxServerPackets) {
+			if(serverSocketSet) SDLNet_FreeSocketSet(serverSocketSet);
+			SDLNet_FreePacketV(ipxServerPackets);
+			ipxServerPackets = NULL;
+			SDLNet_UDP_Close(ipxServerSocket);
+			return false;
+		}
+		SDLNet_UDP_AddSocket(serverSocketSet, ipxServerSocket);
+
 		for(i=0;i<SOCKETTABLESIZE;i++) connBuffer[i].connected = false;
+		ipxServerClients.clear();
+		ipxServerActive.clear();
 
-		TIMER_AddTickHandler(&IPX_ServerLoop);
+		ipxServerQuit = false;
+		ipxServerThread = std::thread(IPX_ServerLoop);
 		return true;
 	}
 	return false;
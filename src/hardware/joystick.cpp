@@ -24,8 +24,12 @@
 #include "setup.h"
 #include "joystick.h"
 #include "pic.h"
+#include "cpu.h"
+#include "regs.h"
+#include "mem.h"
 #include "support.h"
 #include "control.h"
+#include "inputjournal.h"
 
 #define RANGE 64
 #define TIMEOUT 10
@@ -48,8 +52,11 @@ static JoyStick stick[2];
 static uint32_t last_write = 0;
 static bool write_active = false;
 static bool swap34 = false;
+static bool fast_poll = false;
 bool button_wrapping_enabled = true;
 
+extern int io_delay_ns[3]; //iohandler.cpp
+
 extern bool autofire; //sdl_mapper.cpp
 extern int joy1axes[]; //sdl_mapper.cpp
 extern int joy2axes[]; //sdl_mapper.cpp
@@ -92,6 +99,119 @@ static Bitu read_p201(Bitu port,Bitu iolen) {
 	return ret;
 }
 
+/* A timed axis read spinning on port 201h until the tested bits drop, in one of these shapes:
+ *
+ *   l: in al,dx / test al,m / loopnz l
+ *   l: in al,dx / inc r / test al,m / jnz l
+ *   l: in al,dx / test al,m / jz done / inc r / jmp l
+ *
+ * where the test is TEST AL,imm8, AND AL,imm8 or TEST AL with an 8-bit register. Until an axis
+ * times out every pass reads the same value, so the passes up to just before the earliest one
+ * are skipped: the counter moves on by the number of passes and the cycles they would have
+ * taken are used up, so that the game counts what the full loop would have counted. Only the
+ * current slice is skipped, anything else goes the normal way. */
+static void JOYSTICK_SkipPoll(uint8_t value) {
+	if (CPU_Cycles <= 0) return;
+
+	/* the cores leave EIP at the IN instruction during the I/O call */
+	const PhysPt start = (PhysPt)(SegPhys(cs) + reg_eip);
+	PhysPt p = start;
+	if (mem_readb(p++) != 0xEC) return;	/* IN AL,DX */
+
+	int counter = -1;	/* register counted up, -1 for CX counted down by LOOPNZ */
+	uint8_t op = mem_readb(p);
+	if (op >= 0x40 && op <= 0x47) {
+		counter = op & 7;
+		p++;
+	}
+
+	int maskreg = -1;
+	uint8_t mask;
+	op = mem_readb(p++);
+	if (op == 0xA8 || op == 0x24) {		/* TEST/AND AL,imm8 */
+		mask = mem_readb(p++);
+	}
+	else if (op == 0x84) {				/* TEST r/m8,r8 with AL on one side */
+		const uint8_t modrm = mem_readb(p++);
+		if ((modrm & 0xC0) != 0xC0) return;
+		if ((modrm & 7) == 0) maskreg = (modrm >> 3) & 7;
+		else if ((modrm & 0x38) == 0) maskreg = modrm & 7;
+		else return;
+		mask = reg_8(maskreg);
+	}
+	else return;
+
+	op = mem_readb(p++);
+	const int8_t rel = (int8_t)mem_readb(p++);
+	unsigned int instructions;
+	if (op == 0xE0 && counter < 0 && (PhysPt)(p + rel) == start) {			/* LOOPNZ */
+		instructions = 3;
+	}
+	else if (op == 0x75 && counter >= 0 && (PhysPt)(p + rel) == start) {	/* INC before, JNZ */
+		instructions = 4;
+	}
+	else if (op == 0x74 && counter < 0) {										/* JZ out, INC, JMP */
+		op = mem_readb(p++);
+		if (op < 0x40 || op > 0x47) return;
+		counter = op & 7;
+		if (mem_readb(p++) != 0xEB) return;
+		const int8_t back = (int8_t)mem_readb(p++);
+		if ((PhysPt)(p + back) != start) return;
+		instructions = 5;
+	}
+	else return;
+
+	/* the counter must not be what is read, tested or the port */
+	const int loopreg = counter < 0 ? (int)REGI_CX : counter;
+	if (loopreg == REGI_AX || loopreg == REGI_DX || loopreg == REGI_SP) return;
+	if (maskreg >= 0 && (maskreg & 3) == loopreg) return;
+
+	const uint8_t pending = value & mask;
+	if (pending == 0) return;
+
+	/* buttons do not change within the slice, the earliest axis ends the loop */
+	double until = -1;
+	for (unsigned int i=0;i < 4;i++) {
+		if (!(pending & (1u << i))) continue;
+		const double tick = (i & 1) ? stick[i >> 1].ytick : stick[i >> 1].xtick;
+		if (until < 0 || tick < until) until = tick;
+	}
+	if (until < 0) return;
+
+	cpu_cycles_count_t cost = (cpu_cycles_count_t)instructions;
+	if (io_delay_ns[0] > 0) cost += (CPU_CycleMax * io_delay_ns[0]) / 1000000;
+
+	const double left = (until - PIC_FullIndex()) * (double)CPU_CycleMax / (double)cost;
+	if (left < 2) return;
+	/* leave the last pass before the axis times out to the normal path */
+	uint64_t passes = (uint64_t)left - 1;
+	if (passes > (uint64_t)(CPU_Cycles / cost)) passes = (uint64_t)(CPU_Cycles / cost);
+
+	const bool big = cpu.code.big;
+	if (counter < 0) {
+		/* LOOPNZ ends the loop once CX hits 0, 0 to start with means a full wrap */
+		uint64_t cx = big ? reg_ecx : reg_cx;
+		if (cx == 0) cx = big ? 0x100000000ull : 0x10000ull;
+		if (passes > cx - 1) passes = cx - 1;
+		if (passes == 0) return;
+		if (big) reg_ecx = (uint32_t)(cx - passes);
+		else reg_cx = (uint16_t)(cx - passes);
+	}
+	else {
+		/* stop short of a wrap, which would change the flags INC leaves */
+		const uint64_t cur = big ? reg_32(counter) : reg_16(counter);
+		const uint64_t max = big ? 0xFFFFFFFFull : 0xFFFFull;
+		if (passes > max - cur) passes = max - cur;
+		if (passes == 0) return;
+		if (big) reg_32(counter) = (uint32_t)(cur + passes);
+		else reg_16(counter) = (uint16_t)(cur + passes);
+	}
+
+	const cpu_cycles_count_t used = (cpu_cycles_count_t)passes * cost;
+	CPU_Cycles -= used;
+	CPU_IODelayRemoved += used;
+}
+
 static Bitu read_p201_timed(Bitu port,Bitu iolen) {
     (void)port;//UNUSED
     (void)iolen;//UNUSED
@@ -114,6 +234,7 @@ static Bitu read_p201_timed(Bitu port,Bitu iolen) {
 		if (stick[1].button[0]) ret&=~64;
 		if (stick[1].button[1]) ret&=~128;
 	}
+	if (fast_poll) JOYSTICK_SkipPoll(ret);
 	return ret;
 }
 
@@ -163,16 +284,19 @@ void JOYSTICK_Enable(Bitu which,bool enabled) {
 }
 
 void JOYSTICK_Button(Bitu which,Bitu num,bool pressed) {
+	if (GCC_UNLIKELY(input_journal_active) && !INPUTJOURNAL_JoyButton(which,num,pressed)) return;
 	if ((which<2) && (num<2)) stick[which].button[num]=pressed;
 }
 
 void JOYSTICK_Move_X(Bitu which,float x) {
+	if (GCC_UNLIKELY(input_journal_active) && !INPUTJOURNAL_JoyMove(which,false,x)) return;
 	if (which<2) {
 		stick[which].xpos=x;
 	}
 }
 
 void JOYSTICK_Move_Y(Bitu which,float y) {
+	if (GCC_UNLIKELY(input_journal_active) && !INPUTJOURNAL_JoyMove(which,true,y)) return;
 	if (which<2) {
 		stick[which].ypos=y;
 	}
@@ -207,6 +331,7 @@ public:
 		Section_prop * section=static_cast<Section_prop *>(configuration);
 
 		bool timed = section->Get_bool("timed");
+		fast_poll = timed && section->Get_bool("fastpoll");
 		if(timed) {
 			ReadHandler.Install(0x201,read_p201_timed,IO_MB);
 			WriteHandler.Install(0x201,write_p201_timed,IO_MB);
@@ -36,6 +36,7 @@
 #include "jfont.h"
 #include "keymap.h"
 #include "control.h"
+#include "inputjournal.h"
 
 #if defined(_MSC_VER)
 # pragma warning(disable:4244) /* const fmath::local::uint64_t to double possible loss of data */
@@ -43,6 +44,7 @@
 
 #define KEYBUFSIZE 32*3
 #define RESETDELAY 400
+static pic_tickindex_t keyb_resetdelay=RESETDELAY; // 1ms with quickboot
 static pic_tickindex_t KEYDELAY=0.300f;         //Considering 20-30 khz serial clock and 11 bits/char
 
 #define AUX 0x100
@@ -101,6 +103,10 @@ struct ps2mouse {
     uint8_t       resolution;     /* current resolution */
     uint8_t       last_srate[3];      /* last 3 "set sample rate" values */
     float       acx,acy;        /* accumulator */
+    int         wheel;          /* scroll wheel movement not sent yet */
+    uint8_t     sent_buttons;   /* button bits of the last packet */
+    pic_tickindex_t last_packet;    /* when the last packet went out */
+    bool        flush_pending;  /* KEYBOARD_AUX_Flush is scheduled */
     bool        reporting;      /* reporting */
     bool        scale21;        /* 2:1 scaling */
     bool        intellimouse_mode;  /* intellimouse scroll wheel */
@@ -184,6 +190,94 @@ bool MouseTypeNone() {
     return (keyb.ps2mouse.type == MOUSE_NONE);
 }
 
+static void KEYBOARD_AUX_Flush(Bitu val);
+
+/* the motion still to send, in packet counts */
+static int KEYBOARD_AUX_Count(float ac) {
+    return (int)(ac * (1 << keyb.ps2mouse.resolution)) / 16; /* FIXME: Or else the cursor is WAY too sensitive in Windows 3.1 */
+}
+
+static void KEYBOARD_AUX_ScheduleFlush(pic_tickindex_t delay) {
+    if (keyb.ps2mouse.flush_pending) return;
+    keyb.ps2mouse.flush_pending = true;
+    PIC_AddEvent(KEYBOARD_AUX_Flush,delay < 0.01 ? 0.01 : delay);
+}
+
+/* Sends what has built up since the last packet. Host mice may move a thousand times a second
+ * or more, so motion goes out at most once per sample at the rate the guest set, and whatever
+ * does not fit in a packet or in the buffer waits for the next one instead of being lost.
+ * Button and wheel changes go out at once. */
+static void KEYBOARD_AUX_SendPacket(void) {
+    const uint8_t buttons = (keyb.ps2mouse.l ? 1 : 0) | (keyb.ps2mouse.r ? 2 : 0) | (keyb.ps2mouse.m ? 4 : 0);
+    const pic_tickindex_t now = PIC_FullIndex();
+    const pic_tickindex_t interval = 1000.0 / (keyb.ps2mouse.samplerate != 0 ? keyb.ps2mouse.samplerate : 100);
+
+    if (buttons == keyb.ps2mouse.sent_buttons && keyb.ps2mouse.wheel == 0) {
+        if (KEYBOARD_AUX_Count(keyb.ps2mouse.acx) == 0 && KEYBOARD_AUX_Count(keyb.ps2mouse.acy) == 0) return;
+        if ((now - keyb.ps2mouse.last_packet) < interval) {
+            KEYBOARD_AUX_ScheduleFlush(keyb.ps2mouse.last_packet + interval - now);
+            return;
+        }
+    }
+    if ((keyb.used+4) >= KEYBUFSIZE) {
+        KEYBOARD_AUX_ScheduleFlush(interval);
+        return;
+    }
+
+    int x2,y2,scrollwheel;
+
+    x2 = KEYBOARD_AUX_Count(keyb.ps2mouse.acx);
+    if (x2 < -256) x2 = -256;
+    else if (x2 > 255) x2 = 255;
+
+    y2 = -KEYBOARD_AUX_Count(keyb.ps2mouse.acy);
+    if (y2 < -256) y2 = -256;
+    else if (y2 > 255) y2 = 255;
+
+    /* "Valid ranges are -8 to 7"
+     * http://www.computer-engineering.org/ps2mouse/ */
+    scrollwheel = keyb.ps2mouse.wheel;
+    if (scrollwheel < -8)
+        scrollwheel = -8;
+    else if (scrollwheel > 7)
+        scrollwheel = 7;
+
+    KEYBOARD_AddBuffer(AUX|
+        ((y2 == -256 || y2 == 255) ? 0x80 : 0x00) |   /* Y overflow */
+        ((x2 == -256 || x2 == 255) ? 0x40 : 0x00) |   /* X overflow */
+        ((y2 & 0x100) ? 0x20 : 0x00) |         /* Y sign bit */
+        ((x2 & 0x100) ? 0x10 : 0x00) |         /* X sign bit */
+        0x08 |                      /* always 1? */
+        (keyb.ps2mouse.m ? 4 : 0) |         /* M */
+        (keyb.ps2mouse.r ? 2 : 0) |         /* R */
+        (keyb.ps2mouse.l ? 1 : 0));         /* L */
+    KEYBOARD_AddBuffer(AUX|(x2&0xFF));
+    KEYBOARD_AddBuffer(AUX|(y2&0xFF));
+    if (keyb.ps2mouse.intellimouse_btn45) {
+        KEYBOARD_AddBuffer(AUX|(scrollwheel&0xFF)); /* TODO: 4th & 5th buttons */
+    }
+    else if (keyb.ps2mouse.intellimouse_mode) {
+        KEYBOARD_AddBuffer(AUX|(scrollwheel&0xFF));
+    }
+
+    /* what the packet could not hold goes in the next one */
+    keyb.ps2mouse.acx -= (float)(x2 * 16) / (1 << keyb.ps2mouse.resolution);
+    keyb.ps2mouse.acy += (float)(y2 * 16) / (1 << keyb.ps2mouse.resolution);
+    keyb.ps2mouse.wheel -= scrollwheel;
+    keyb.ps2mouse.sent_buttons = buttons;
+    keyb.ps2mouse.last_packet = now;
+
+    if (keyb.ps2mouse.wheel != 0 || KEYBOARD_AUX_Count(keyb.ps2mouse.acx) != 0 || KEYBOARD_AUX_Count(keyb.ps2mouse.acy) != 0)
+        KEYBOARD_AUX_ScheduleFlush(interval);
+}
+
+static void KEYBOARD_AUX_Flush(Bitu val) {
+    (void)val;//UNUSED
+    keyb.ps2mouse.flush_pending = false;
+    if (keyb.ps2mouse.reporting && keyb.ps2mouse.mode == MM_STREAM)
+        KEYBOARD_AUX_SendPacket();
+}
+
 /* NTS: INT33H emulation is coded to call this ONLY if it hasn't taken over the role of mouse input */
 void KEYBOARD_AUX_Event(float x,float y,Bitu buttons,int scrollwheel) {
     if (IS_PC98_ARCH) {
@@ -201,48 +295,10 @@ void KEYBOARD_AUX_Event(float x,float y,Bitu buttons,int scrollwheel) {
     keyb.ps2mouse.r = (buttons & 2)>0;
     keyb.ps2mouse.m = (buttons & 4)>0;
 
-    /* "Valid ranges are -8 to 7"
-     * http://www.computer-engineering.org/ps2mouse/ */
-    if (scrollwheel < -8)
-        scrollwheel = -8;
-    else if (scrollwheel > 7)
-        scrollwheel = 7;
-
     if (keyb.ps2mouse.reporting && keyb.ps2mouse.mode == MM_STREAM) {
-        if ((keyb.used+4) < KEYBUFSIZE) {
-            int x2,y2;
-
-            x2 = (int)(keyb.ps2mouse.acx * (1 << keyb.ps2mouse.resolution));
-            x2 /= 16; /* FIXME: Or else the cursor is WAY too sensitive in Windows 3.1 */
-            if (x2 < -256) x2 = -256;
-            else if (x2 > 255) x2 = 255;
-
-            y2 = -((int)(keyb.ps2mouse.acy * (1 << keyb.ps2mouse.resolution)));
-            y2 /= 16; /* FIXME: Or else the cursor is WAY too sensitive in Windows 3.1 */
-            if (y2 < -256) y2 = -256;
-            else if (y2 > 255) y2 = 255;
-
-            KEYBOARD_AddBuffer(AUX|
-                ((y2 == -256 || y2 == 255) ? 0x80 : 0x00) |   /* Y overflow */
-                ((x2 == -256 || x2 == 255) ? 0x40 : 0x00) |   /* X overflow */
-                ((y2 & 0x100) ? 0x20 : 0x00) |         /* Y sign bit */
-                ((x2 & 0x100) ? 0x10 : 0x00) |         /* X sign bit */
-                0x08 |                      /* always 1? */
-                (keyb.ps2mouse.m ? 4 : 0) |         /* M */
-                (keyb.ps2mouse.r ? 2 : 0) |         /* R */
-                (keyb.ps2mouse.l ? 1 : 0));         /* L */
-            KEYBOARD_AddBuffer(AUX|(x2&0xFF));
-            KEYBOARD_AddBuffer(AUX|(y2&0xFF));
-            if (keyb.ps2mouse.intellimouse_btn45) {
-                KEYBOARD_AddBuffer(AUX|(scrollwheel&0xFF)); /* TODO: 4th & 5th buttons */
-            }
-            else if (keyb.ps2mouse.intellimouse_mode) {
-                KEYBOARD_AddBuffer(AUX|(scrollwheel&0xFF));
-            }
-        }
-
-        keyb.ps2mouse.acx = 0;
-        keyb.ps2mouse.acy = 0;
+        if (keyb.ps2mouse.intellimouse_mode || keyb.ps2mouse.intellimouse_btn45)
+            keyb.ps2mouse.wheel += scrollwheel;
+        KEYBOARD_AUX_SendPacket();
     }
 }
 
@@ -623,7 +679,7 @@ static void write_p60(Bitu port,Bitu val,Bitu iolen) {
             KEYBOARD_Add8042Response(0xFA); /* ACK (TODO: The host has to read the ACK byte first before starting reset?? According to IBM, anyway) */
             keyb.reset=true;
             KEYBOARD_SetLEDs(7); /* most keyboard I test with tend to flash the LEDs during reset */
-            PIC_AddEvent(KEYBOARD_ResetDelay,RESETDELAY);
+            PIC_AddEvent(KEYBOARD_ResetDelay,keyb_resetdelay);
             break;
         default:
             /* Just always acknowledge strange commands */
@@ -866,6 +922,8 @@ static Bitu read_p64(Bitu port,Bitu iolen) {
     (void)port;//UNUSED
     (void)iolen;//UNUSED
     uint8_t status= 0x1c | (keyb.p60changed?0x1:0x0) | (keyb.auxchanged?0x20:0x00);
+    if (status & 0x01) CPU_IdleProgress();
+    else CPU_IdlePoll();
     return status;
 }
 
@@ -1902,6 +1960,9 @@ static void KEYBOARD_TickHandler(void) {
 void APM_Suspend_Wakeup_Key(void);
 
 void KEYBOARD_AddKey(KBD_KEYS keytype,bool pressed) {
+    if (GCC_UNLIKELY(input_journal_active) && !INPUTJOURNAL_Key(keytype,pressed))
+        return;
+
     /* If the BIOS has put the system into APM suspend, let certain keys wake it up again.
      * Send on RELEASE so that the key isn't also typed into the guest OS. */
     if (!pressed && (keytype == KBD_space))
@@ -2838,6 +2899,7 @@ void KEYBOARD_OnReset(Section *sec) {
     TIMER_DelTickHandler(&KEYBOARD_TickHandler);
 
     allow_keyb_reset = section->Get_bool("allow output port reset");
+    keyb_resetdelay = static_cast<Section_prop *>(control->GetSection("dosbox"))->Get_bool("quickboot") ? 1 : RESETDELAY;
 
     keyb.ps2mouse.int33_taken = 0;
     keyb.ps2mouse.reset_mode = MM_STREAM; /* NTS: I was wrong: PS/2 mice default to streaming after reset */
@@ -2894,6 +2956,11 @@ void AUX_Reset() {
     keyb.ps2mouse.mode = keyb.ps2mouse.reset_mode;
     keyb.ps2mouse.acx = 0;
     keyb.ps2mouse.acy = 0;
+    keyb.ps2mouse.wheel = 0;
+    keyb.ps2mouse.sent_buttons = 0;
+    keyb.ps2mouse.last_packet = 0;
+    keyb.ps2mouse.flush_pending = false;
+    PIC_RemoveEvents(KEYBOARD_AUX_Flush);
     keyb.ps2mouse.samplerate = 80;
     keyb.ps2mouse.last_srate[0] = keyb.ps2mouse.last_srate[1] = keyb.ps2mouse.last_srate[2] = 0;
     keyb.ps2mouse.intellimouse_btn45 = false;
@@ -318,6 +318,22 @@ void saa1099_device::sound_stream_update(sound_stream &stream, stream_sample_t *
 }
 
 
+bool saa1099_device::muted() const
+{
+	if (!m_all_ch_enable)
+		return true;
+
+	for (int ch = 0; ch < 6; ch++)
+	{
+		if ((m_channels[ch].freq_enable || m_channels[ch].noise_enable) &&
+			(m_channels[ch].amplitude[LEFT] != 0 || m_channels[ch].amplitude[RIGHT] != 0))
+			return false;
+	}
+
+	return true;
+}
+
+
 void saa1099_device::envelope_w(int ch)
 {
 	if (m_env_enable[ch])
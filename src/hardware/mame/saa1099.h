@@ -65,6 +65,9 @@ public:
 	void SaveState( std::ostream& stream );
 	void LoadState( std::istream& stream );
 
+	// true if nothing can be heard until the next register write
+	bool muted() const;
+
 private:
 	struct saa1099_channel
 	{
@@ -232,6 +232,8 @@ void sn76496_base_device::device_start()
 	sample_rate = clock()/2;
 	rate_add = RATE_MAX;
 	rate_counter = 0;
+	block_step = 1u << 16u;
+	block_frac = 0;
 
 	int i;
 	double out;
@@ -392,11 +394,60 @@ void sn76496_base_device::countdown_cycles()
 	}
 }
 
+void sn76496_base_device::clock_divided()
+{
+	int i;
+
+	// decrement Cycles to READY by one
+	countdown_cycles();
+
+	// handle channels 0,1,2
+	for (i = 0; i < 3; i++)
+	{
+		m_count[i]--;
+		if (m_count[i] <= 0)
+		{
+			m_output[i] ^= 1;
+			m_count[i] = m_period[i];
+		}
+	}
+
+	// handle channel 3
+	m_count[3]--;
+	if (m_count[3] <= 0)
+	{
+		// if noisemode is 1, both taps are enabled
+		// if noisemode is 0, the lower tap, whitenoisetap2, is held at 0
+		// The != was a bit-XOR (^) before
+		if (((m_RNG & m_whitenoise_tap1)!=0) != (((m_RNG & m_whitenoise_tap2)!=(m_ncr_style_psg?(uint32_t)m_whitenoise_tap2:0)) && in_noise_mode()))
+		{
+			m_RNG >>= 1;
+			m_RNG |= m_feedback_mask;
+		}
+		else
+		{
+			m_RNG >>= 1;
+		}
+		m_output[3] = m_RNG & 1;
+
+		m_count[3] = m_period[3];
+	}
+}
+
+inline int32_t sn76496_base_device::mono_level() const
+{
+	int32_t out = ((m_output[0]!=0)? m_volume[0]:0)
+		+((m_output[1]!=0)? m_volume[1]:0)
+		+((m_output[2]!=0)? m_volume[2]:0)
+		+((m_output[3]!=0)? m_volume[3]:0);
+
+	return m_negate ? -out : out;
+}
+
 void sn76496_base_device::sound_stream_update(sound_stream &stream, stream_sample_t **inputs, stream_sample_t **outputs, int samples)
 {
     (void)stream;
     (void)inputs;
-	int i;
 	stream_sample_t *lbuffer = outputs[0];
 	stream_sample_t *rbuffer = (m_stereo)? outputs[1] : nullptr;
 
@@ -413,40 +464,7 @@ void sn76496_base_device::sound_stream_update(sound_stream &stream, stream_sampl
 		else // ready for new divided clock, make a new sample
 		{
 			m_current_clock = m_clock_divider-1;
-			// decrement Cycles to READY by one
-			countdown_cycles();
-
-			// handle channels 0,1,2
-			for (i = 0; i < 3; i++)
-			{
-				m_count[i]--;
-				if (m_count[i] <= 0)
-				{
-					m_output[i] ^= 1;
-					m_count[i] = m_period[i];
-				}
-			}
-
-			// handle channel 3
-			m_count[3]--;
-			if (m_count[3] <= 0)
-			{
-				// if noisemode is 1, both taps are enabled
-				// if noisemode is 0, the lower tap, whitenoisetap2, is held at 0
-				// The != was a bit-XOR (^) before
-				if (((m_RNG & m_whitenoise_tap1)!=0) != (((m_RNG & m_whitenoise_tap2)!=(m_ncr_style_psg?(uint32_t)m_whitenoise_tap2:0)) && in_noise_mode()))
-				{
-					m_RNG >>= 1;
-					m_RNG |= m_feedback_mask;
-				}
-				else
-				{
-					m_RNG >>= 1;
-				}
-				m_output[3] = m_RNG & 1;
-
-				m_count[3] = m_period[3];
-			}
+			clock_divided();
 		}
 
 		//Skip final generation if you don't need an actual sample
@@ -489,6 +507,79 @@ void sn76496_base_device::convert_samplerate(int32_t target_rate) {
 	rate_counter = 0;
 }
 
+// Block renderer (mono chips only).
+// Steps the chip a whole divided clock at a time instead of one input clock per iteration, skips
+// straight over stretches in which none of the four generators toggles, and box-averages the
+// output over each sample period instead of point sampling it. Meant to run at a few times the
+// mixer rate with the caller decimating the result down, see tandy_sound.cpp.
+void sn76496_base_device::set_block_rate(int32_t target_rate) {
+	const double divided = (double)sample_rate / m_clock_divider;
+
+	block_step = (uint32_t)((divided * 65536.0) / target_rate);
+	if (block_step == 0) block_step = 1;
+	block_frac = 0;
+}
+
+void sn76496_base_device::render_block(float *out, int samples) {
+	while (samples-- > 0)
+	{
+		block_frac += block_step;
+		int32_t ticks = (int32_t)(block_frac >> 16u);
+		block_frac &= 0xFFFFu;
+
+		// sample period shorter than one divided clock, hold the level
+		if (ticks == 0)
+		{
+			*out++ = (float)mono_level();
+			continue;
+		}
+
+		const int32_t total = ticks;
+		int64_t acc = 0;
+
+		while (ticks > 0)
+		{
+			// number of divided clocks during which every counter stays above zero, i.e. nothing toggles
+			int32_t run = m_count[0];
+			if (run > m_count[1]) run = m_count[1];
+			if (run > m_count[2]) run = m_count[2];
+			if (run > m_count[3]) run = m_count[3];
+			run--;
+			if (run > ticks) run = ticks;
+
+			if (run > 0)
+			{
+				acc += (int64_t)mono_level() * run;
+				m_count[0] -= run;
+				m_count[1] -= run;
+				m_count[2] -= run;
+				m_count[3] -= run;
+
+				// same as that many calls to countdown_cycles()
+				if (m_cycles_to_ready >= run)
+				{
+					m_cycles_to_ready -= run;
+					m_ready_state = false;
+				}
+				else
+				{
+					m_cycles_to_ready = 0;
+					m_ready_state = true;
+				}
+
+				ticks -= run;
+				if (ticks == 0) break;
+			}
+
+			clock_divided();
+			acc += mono_level();
+			ticks--;
+		}
+
+		*out++ = (float)acc / (float)total;
+	}
+}
+
 void sn76496_base_device::SaveState( std::ostream& stream ) {
     WRITE_POD(&m_vol_table, m_vol_table);
     WRITE_POD(&m_register, m_register);
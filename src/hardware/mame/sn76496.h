@@ -39,6 +39,9 @@ public:
 //	auto ready_cb() { return m_ready_handler.bind(); }
 
 	void convert_samplerate(int32_t target_rate);
+	void set_block_rate(int32_t target_rate);
+	void render_block(float *out, int samples);
+	bool muted() const { return (m_volume[0] | m_volume[1] | m_volume[2] | m_volume[3]) == 0; }
 	void SaveState( std::ostream& stream );
     void LoadState( std::istream& stream );
 protected:
@@ -65,6 +68,8 @@ private:
 	inline bool     in_noise_mode();
 	void            register_for_save_states();
 	void            countdown_cycles();
+	void            clock_divided();
+	inline int32_t  mono_level() const;
 
 
 
@@ -100,6 +105,9 @@ private:
 	//Sample rate conversion
 	int32_t			  rate_add;
 	int32_t			  rate_counter;
+	//Block renderer, divided clocks per output sample in 16.16 fixed point
+	uint32_t		  block_step;
+	uint32_t		  block_frac;
 };
 
 // SN76496: Whitenoise verified, phase verified, periodic verified (by Michael Zapf)
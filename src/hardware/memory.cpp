@@ -18,6 +18,7 @@
 
 
 #include <stdint.h>
+#include <algorithm>
 #include <assert.h>
 #include "dosbox.h"
 #include "dos_inc.h"
@@ -31,6 +32,7 @@
 #include "zipfile.h"
 #include "regs.h"
 #include "bitop.h"
+#include "hostmem.h"
 #ifndef WIN32
 # include <stdlib.h>
 # include <unistd.h>
@@ -68,6 +70,20 @@ HANDLE      memory_file_map = INVALID_HANDLE_VALUE;
 
 std::string		memory_file;
 void*			memory_file_base = NULL;
+
+/* how MemBase is allocated when no memory file is used ("memory allocation" setting) */
+enum {
+    MEMALLOC_EAGER=0,
+    MEMALLOC_LAZY,
+    MEMALLOC_HUGEPAGES,
+    MEMALLOC_MERGEABLE
+};
+
+static unsigned int     memory_alloc_mode = MEMALLOC_LAZY;
+static bool             memory_host_zeroed = false; /* host gave us zero filled pages, no need to touch them */
+#if defined(WIN32) && !defined(HX_DOS) && !C_HAVE_MMAP
+# define WIN32_VIRTUALALLOC
+#endif
 size_t			memory_file_size = 0;
 bool			memory_file_already_zero = false;
 
@@ -260,6 +276,7 @@ uint32_t MEM_get_address_bits4GB() { /* some code cannot yet handle values large
  *          the 384KB wasted at the 8086 1MB limit is too small to worry about. */
 HostPt MemBase = NULL;
 size_t MemSize = 0;
+uint8_t *MemDirty = NULL;
 
 class UnmappedPageHandler : public PageHandler {
 public:
@@ -317,8 +334,10 @@ public:
     }
     HostPt GetHostWritePt(PageNum phys_page) override {
         if (!a20_fast_changeable || (phys_page & (~0xFul/*64KB*/)) == 0x100ul/*@1MB*/)
-            return MemBase+(phys_page&memory.mem_alias_pagemask_active)*MEM_PAGESIZE;
+            phys_page &= memory.mem_alias_pagemask_active;
 
+        /* whoever asks for the write pointer may write the page until the TLB is cleared */
+        MemDirty[phys_page] = 1;
         return MemBase+phys_page*MEM_PAGESIZE;
     }
 };
@@ -375,6 +394,10 @@ PageHandler &Get_ROM_page_handler(void) {
 
 extern bool pcibus_enable;
 
+static uint64_t mem_slowpath_lookups = 0;
+static uint64_t mem_slowpath_unmapped = 0;
+static uint64_t mem_slowpath_conflicts = 0;
+
 template <enum MEM_Type_t iotype> static unsigned int MEM_Gen_Callout(Bitu &ret,PageHandler* &f,Bitu page) {
     int actual = iotype - MEM_TYPE_MIN;
     MEM_callout_vector &vec = MEM_callouts[actual];
@@ -394,6 +417,7 @@ template <enum MEM_Type_t iotype> static unsigned int MEM_Gen_Callout(Bitu &ret,
         if (t_f != NULL) {
             if (match == 0) {
                 f = t_f;
+                obj.resolvecounter++;
             }
             else {
                 /* device conflict! */
@@ -460,13 +484,22 @@ static PageHandler *MEM_SlowPath(Bitu page) {
         }
     }
 
-    /* if nothing matched, assign default handler to MEM handler slot.
+    /* if nothing matched, assign default handler to MEM handler slot. this is the negative
+     * cache for unmapped pages, probing option ROM and adapter space again costs nothing until
+     * a device calls MEM_CalloutObject::InvalidateCachedHandlers() for the page.
      * if one device responded, assign its handler to the MEM handler slot.
-     * if more than one responded, then do not update the MEM handler slot. */
+     * if more than one responded, the first one always wins anyway (see MEM_Gen_Callout), so
+     * cache that too rather than walk every callout list again on each access. */
 //    assert(iolen >= 1 && iolen <= 4);
 //    porti = (iolen >= 4) ? 2 : (iolen - 1); /* 1 2 x 4 -> 0 1 1 2 */
     LOG(LOG_MISC,LOG_DEBUG)("MEM slow path page=%x: device matches=%u",(unsigned int)page,(unsigned int)match);
-    if (match <= 1) memory.phandlers[page] = f;
+    mem_slowpath_lookups++;
+    if (match == 0)
+        mem_slowpath_unmapped++;
+    else if (match > 1)
+        mem_slowpath_conflicts++;
+
+    memory.phandlers[page] = f;
 
     return f;
 }
@@ -621,6 +654,7 @@ try_again:
 
         if (!obj.alloc) {
             obj.alloc = true;
+            obj.resolvecounter = 0;
             assert(obj.isInstalled() == false);
             return MEM_Callout_t_comb(t,vec.alloc_from++); /* make combination, then increment alloc_from */
         }
@@ -691,6 +725,29 @@ void MEM_PutCallout(MEM_CalloutObject *obj) {
     obj->getcounter--;
 }
 
+unsigned int MEM_GetCalloutSlots(MEM_Type_t t) {
+    if (t < MEM_TYPE_MIN || t >= MEM_TYPE_MAX)
+        return 0;
+
+    return (unsigned int)MEM_callouts[t - MEM_TYPE_MIN].size();
+}
+
+void MEM_GetSlowPathStats(uint64_t &lookups,uint64_t &unmapped,uint64_t &conflicts) {
+    lookups = mem_slowpath_lookups;
+    unmapped = mem_slowpath_unmapped;
+    conflicts = mem_slowpath_conflicts;
+}
+
+void MEM_GetHostMemory(HostMemSize &sz) {
+    if (memory_file_base != NULL)
+        sz.add(memory_file_base,memory_file_size);
+    else if (MemBase != NULL)
+        sz.add(MemBase,MemSize);
+    if (MemDirty != NULL) sz.add_heap(memory.pages);
+    if (memory.phandlers != NULL) sz.add_heap(memory.handler_pages * sizeof(PageHandler*));
+    if (memory.mhandles != NULL) sz.add_heap(memory.pages * sizeof(MemHandle));
+}
+
 void lfb_mem_cb_free(void) {
     if (lfb_mem_cb != MEM_Callout_t_none) {
         MEM_FreeCallout(lfb_mem_cb);
@@ -857,7 +914,7 @@ PageHandler * MEM_GetPageHandler(Bitu phys_page) {
 		if (memory.phandlers[phys_page] != NULL) /*likely*/
 			return memory.phandlers[phys_page];
 
-		return MEM_SlowPath(phys_page); /* will also fill in phandlers[] if zero or one matches, so the next access is very fast */
+		return MEM_SlowPath(phys_page); /* will also fill in phandlers[], so the next access is very fast */
 	}
 
 	if (phys_page >= 0x100000ul && phys_page < (0x100000ul+(unsigned long)memory.reported_pages_4gb)) {
@@ -869,6 +926,8 @@ PageHandler * MEM_GetPageHandler(Bitu phys_page) {
 }
 
 void MEM_SetPageHandler(Bitu phys_page,Bitu pages,PageHandler * handler) {
+    /* the dynamic core's code page handlers write RAM on their own, catch the page when they give it back */
+    MEM_MarkDirtyRange((PhysPt)(phys_page*MEM_PAGESIZE),pages*MEM_PAGESIZE);
     for (;pages>0;pages--) {
         memory.phandlers[phys_page]=handler;
         phys_page++;
@@ -969,6 +1028,53 @@ void MEM_BlockCopy(LinearPt dest,LinearPt src,Bitu size) {
     mem_memcpy(dest,src,size);
 }
 
+void MEM_BlockMove(LinearPt dest,LinearPt src,Bitu size) {
+    if (size == 0 || dest == src) return;
+
+    /* like memmove(), a destination above an overlapping source is copied from the end */
+    const bool backward = dest > src && (Bitu)(dest - src) < size;
+
+    while (size > 0) {
+        /* the span up to the next page boundary of either side */
+        LinearPt s,d;
+        Bitu n;
+        if (!backward) {
+            n = std::min(std::min((Bitu)(0x1000u - (src & 0xFFFu)),(Bitu)(0x1000u - (dest & 0xFFFu))),size);
+            s = src;
+            d = dest;
+        }
+        else {
+            const LinearPt src_last = (LinearPt)(src + size - 1u);
+            const LinearPt dest_last = (LinearPt)(dest + size - 1u);
+            n = std::min(std::min((Bitu)((src_last & 0xFFFu) + 1u),(Bitu)((dest_last & 0xFFFu) + 1u)),size);
+            s = (LinearPt)(src_last - n + 1u);
+            d = (LinearPt)(dest_last - n + 1u);
+        }
+
+        const HostPt r = get_tlb_read(s);
+        const HostPt w = get_tlb_write(d);
+        if (r != nullptr && w != nullptr) {
+            memmove(w + d,r + s,n);
+        }
+        else {
+            /* not RAM or not linked yet: one byte through the page handlers, which links the
+             * page if it is RAM, then look again */
+            n = 1;
+            if (backward) {
+                s = (LinearPt)(src + size - 1u);
+                d = (LinearPt)(dest + size - 1u);
+            }
+            mem_writeb_inline(d,mem_readb_inline(s));
+        }
+
+        if (!backward) {
+            src = (LinearPt)(src + n);
+            dest = (LinearPt)(dest + n);
+        }
+        size -= n;
+    }
+}
+
 void MEM_StrCopy(LinearPt pt,char * data,Bitu size) {
     while (size--) {
         uint8_t r=mem_readb_inline(pt++);
@@ -1414,6 +1520,7 @@ void mem_writed(LinearPt address,uint32_t val) {
 
 void phys_writes(PhysPt addr, const char* string, Bitu length) {
     for(Bitu i = 0; i < length && (addr+i) < MemSize; i++) host_writeb(MemBase+addr+i,(uint8_t)string[i]);
+    MEM_MarkDirtyRange(addr,length);
 }
 
 #include "control.h"
@@ -1806,7 +1913,58 @@ bool MEM_map_ROM_alias_physmem(Bitu start,Bitu end) {
     return true;
 }
 
-HostPt GetMemBase(void) { return MemBase; }
+bool MEM_Mergeable(void) {
+    return memory_alloc_mode == MEMALLOC_MERGEABLE;
+}
+
+/* callers write MemBase directly (ROM images, clearing areas at boot), mark it all */
+HostPt GetMemBase(void) { MEM_ResetDirty(true); return MemBase; }
+
+void MEM_MarkDirtyRange(PhysPt addr,Bitu len) {
+    if (MemDirty == NULL || len == 0 || addr >= MemSize) return;
+    size_t end = (size_t)addr + len;
+    if (end > MemSize) end = MemSize;
+    for (Bitu page = addr >> 12u;page <= (Bitu)((end - 1u) >> 12u);page++) MemDirty[page] = 1;
+}
+
+/* start tracking from the current contents (all=false), or mark every page (all=true).
+ * The TLB holds host write pointers handed out before, so it has to be cleared for those
+ * pages to be marked again on their next write. */
+void MEM_ResetDirty(bool all) {
+    if (MemDirty == NULL) return;
+    memset(MemDirty,all ? 1 : 0,MemSize >> 12u);
+    if (!all) PAGING_ClearTLB();
+}
+
+/* loading a save state: map guest memory at dst copy-on-write from the file, so the host pages it
+ * in when the guest touches it instead of copying all of it up front. False if the memory cannot be
+ * mapped this way, the caller then reads it instead. */
+bool MEM_MapHostFromFile(void *dst,size_t size,int fd,uint64_t offset) {
+#if C_HAVE_MMAP && !C_GAMELINK
+    /* memory files are shared with the outside, and the VM maps MemBase itself */
+    if (memory_file_base != NULL || MemBase == NULL || size == 0) return false;
+    /* the host only merges anonymous memory, read it in instead */
+    if (memory_alloc_mode == MEMALLOC_MERGEABLE) return false;
+# if defined(C_HAVE_LINUX_KVM_X86)
+    if (cpudecoder == &CPU_Core_KVM_Run || cpudecoder == &CPU_Core_KVM_Trap_Run) return false;
+# endif
+    const uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    if ((uint8_t*)dst < MemBase || (uint8_t*)dst + size > MemBase + MemSize ||
+        ((uintptr_t)dst % page) != 0 || (size % page) != 0 || (offset % page) != 0) return false;
+
+    if (mmap(dst,size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_FIXED,fd,(off_t)offset) != MAP_FAILED) {
+        MEM_MarkDirtyRange((PhysPt)((uint8_t*)dst - MemBase),(Bitu)size);
+        return true;
+    }
+    /* MAP_FIXED may have dropped the old mapping before failing */
+    if (mmap(dst,size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_FIXED|MAP_ANONYMOUS,-1,0) == MAP_FAILED)
+        E_Exit("Failed to remap guest memory");
+    return false;
+#else
+    (void)dst; (void)size; (void)fd; (void)offset;
+    return false;
+#endif
+}
 
 /*! \brief          REDOS.COM utility command on drive Z: to trigger restart of the DOS kernel
  */
@@ -1982,6 +2140,8 @@ void ShutDownRAM(Section * sec) {
             GameLink::FreeRAM(MemBase);
 #elif C_HAVE_MMAP
             munmap(MemBase,MemSize);
+#elif defined(WIN32_VIRTUALALLOC)
+            VirtualFree(MemBase,0,MEM_RELEASE);
 #else
             delete [] MemBase;
 #endif
@@ -1989,6 +2149,8 @@ void ShutDownRAM(Section * sec) {
         MemBase = NULL;
     }
     MemSize = 0;
+    delete [] MemDirty;
+    MemDirty = NULL;
     ACPI_free();
 }
 
@@ -2208,6 +2370,12 @@ bool alloc_mem_file() {
 }
 #endif
 
+/* the BIOS and DOS set up RAM again on reset, writing some of it directly */
+static void MEM_DirtyOnReset(Section *sec) {
+    (void)sec;//UNUSED
+    MEM_ResetDirty(true);
+}
+
 void Init_RAM() {
     Section_prop * section=static_cast<Section_prop *>(control->GetSection("dosbox"));
     Bitu i;
@@ -2215,6 +2383,7 @@ void Init_RAM() {
     /* please let me know about shutdown! */
     if (!has_Init_RAM) {
         AddExitFunction(AddExitFunctionFuncPair(ShutDownRAM));
+        AddVMEventFunction(VM_EVENT_RESET,AddVMEventFunctionFuncPair(MEM_DirtyOnReset));
         has_Init_RAM = true;
     }
 
@@ -2232,6 +2401,18 @@ void Init_RAM() {
         memory_file = str;
     }
 
+    {
+        const std::string str = section->Get_string("memory allocation");
+        if (str == "eager")
+            memory_alloc_mode = MEMALLOC_EAGER;
+        else if (str == "hugepages")
+            memory_alloc_mode = MEMALLOC_HUGEPAGES;
+        else if (str == "mergeable")
+            memory_alloc_mode = MEMALLOC_MERGEABLE;
+        else
+            memory_alloc_mode = MEMALLOC_LAZY;
+    }
+
     /* Setup the Physical Page Links */
     uint64_t memsizekb4gb = 0;
     uint64_t memsizekb = (uint64_t)section->Get_int("memsizekb");
@@ -2361,19 +2542,73 @@ void Init_RAM() {
 #if C_GAMELINK
         MemBase = GameLink::AllocRAM(memory.pages*4096);
 #elif C_HAVE_MMAP
-        MemBase = (uint8_t*)mmap(NULL,memory.pages*4096u,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,0,0);
+        /* anonymous mappings only reserve address space. the host commits zero filled pages
+         * the first time the guest touches them, so do not write to them here. */
+        MemBase = (uint8_t*)mmap(NULL,memory.pages*4096u,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
         if (MemBase == (uint8_t*)MAP_FAILED) E_Exit("Failed to mmap allocate memory");
+        memory_host_zeroed = true;
+# if defined(MADV_HUGEPAGE)
+        if (memory_alloc_mode == MEMALLOC_HUGEPAGES && madvise(MemBase,memory.pages*4096u,MADV_HUGEPAGE) != 0)
+            LOG_MSG("Transparent huge pages are not available for guest memory, %s",strerror(errno));
+# else
+        if (memory_alloc_mode == MEMALLOC_HUGEPAGES)
+            LOG_MSG("Huge pages for guest memory are not supported on this host");
+# endif
+        /* the mapping starts on a host page, so each guest page is one host page that the host
+         * can merge with the same page of another instance booted from the same image */
+# if defined(MADV_MERGEABLE)
+        if (memory_alloc_mode == MEMALLOC_MERGEABLE && madvise(MemBase,memory.pages*4096u,MADV_MERGEABLE) != 0) {
+            LOG_MSG("Guest memory cannot be merged with other instances, %s",strerror(errno));
+            memory_alloc_mode = MEMALLOC_LAZY;
+        }
+# else
+        if (memory_alloc_mode == MEMALLOC_MERGEABLE) {
+            LOG_MSG("Merging guest memory with other instances is not supported on this host");
+            memory_alloc_mode = MEMALLOC_LAZY;
+        }
+# endif
+#elif defined(WIN32_VIRTUALALLOC)
+        /* VirtualAlloc() charges the commit up front, but physical pages are zero filled on first touch.
+         * Large pages are nonpageable and must be committed all at once, and need SeLockMemoryPrivilege. */
+        MemBase = NULL;
+        if (memory_alloc_mode == MEMALLOC_HUGEPAGES) {
+            const SIZE_T large = GetLargePageMinimum();
+            if (large != 0) {
+                const SIZE_T sz = (SIZE_T(memory.pages*4096u) + large - 1u) & ~(large - 1u);
+                MemBase = (uint8_t*)VirtualAlloc(NULL,sz,MEM_RESERVE|MEM_COMMIT|MEM_LARGE_PAGES,PAGE_READWRITE);
+            }
+            if (MemBase == NULL)
+                LOG_MSG("Large pages are not available for guest memory, err=0x%08x",(unsigned int)GetLastError());
+        }
+        if (MemBase == NULL)
+            MemBase = (uint8_t*)VirtualAlloc(NULL,memory.pages*4096u,MEM_RESERVE|MEM_COMMIT,PAGE_READWRITE);
+        memory_host_zeroed = (MemBase != NULL);
 #else // C_GAMELINK
         MemBase = new(std::nothrow) uint8_t[memory.pages*4096];
 #endif // C_GAMELINK
     }
-    MemSize = size_t(memory.pages*4096);
     if (!MemBase) E_Exit("Can't allocate main memory of %d KB",(int)memsizekb);
+#if !C_HAVE_MMAP || C_GAMELINK
+    if (memory_alloc_mode == MEMALLOC_MERGEABLE) {
+        LOG_MSG("Merging guest memory with other instances is not supported on this host");
+        memory_alloc_mode = MEMALLOC_LAZY;
+    }
+#endif
+    if (memory_file_base != NULL && memory_alloc_mode == MEMALLOC_MERGEABLE) {
+        LOG_MSG("A memory file is shared with the outside and cannot be merged with other instances");
+        memory_alloc_mode = MEMALLOC_LAZY;
+    }
+    MemDirty = new uint8_t[memory.pages];
+    memset(MemDirty,1,memory.pages);
+    MemSize = size_t(memory.pages*4096);
     /* Clear the memory, as new doesn't always give zeroed memory
      * (Visual C debug mode). We want zeroed memory though. */
     if (memory_file_base && memory_file_already_zero) {
         LOG_MSG("Host OS should treat memory map as all zeros, skipping memory clear");
     }
+    else if (!memory_file_base && memory_host_zeroed && memory_alloc_mode != MEMALLOC_EAGER) {
+        LOG(LOG_MISC,LOG_DEBUG)("Guest memory is committed by the host on first use, skipping memory clear");
+    }
     else {
         memset((void*)MemBase,0,memory.reported_pages*4096);
     }
@@ -2658,10 +2893,10 @@ uint8_t physdev_readb(const PhysPt64 addr) {
 
 	/* This hack is necessary because of the weird way that CPU linear addresses
 	 * make their way down to the hardware read/write callbacks */
-	const uint32_t orig = paging.tlb.phys_page[pagenum];
-	paging.tlb.phys_page[pagenum] = (uint32_t)pagenum;
+	const uint32_t orig = tlb_phys_page(pagenum);
+	tlb_phys_page(pagenum) = (uint32_t)pagenum;
 	const uint8_t ch = ph->readb((PhysPt)addr); /* WARNING: 4GB wraparound here */
-	paging.tlb.phys_page[pagenum] = orig;
+	tlb_phys_page(pagenum) = orig;
 	return ch;
 }
 
@@ -2675,10 +2910,10 @@ uint16_t physdev_readw(const PhysPt64 addr) {
 
 		/* This hack is necessary because of the weird way that CPU linear addresses
 		 * make their way down to the hardware read/write callbacks */
-		const uint32_t orig = paging.tlb.phys_page[pagenum];
-		paging.tlb.phys_page[pagenum] = (uint32_t)pagenum;
+		const uint32_t orig = tlb_phys_page(pagenum);
+		tlb_phys_page(pagenum) = (uint32_t)pagenum;
 		const uint16_t ch = ph->readw((PhysPt)addr); /* WARNING: 4GB wraparound here */
-		paging.tlb.phys_page[pagenum] = orig;
+		tlb_phys_page(pagenum) = orig;
 		return ch;
 	}
 	else {
@@ -2697,10 +2932,10 @@ uint32_t physdev_readd(const PhysPt64 addr) {
 
 		/* This hack is necessary because of the weird way that CPU linear addresses
 		 * make their way down to the hardware read/write callbacks */
-		const uint32_t orig = paging.tlb.phys_page[pagenum];
-		paging.tlb.phys_page[pagenum] = (uint32_t)pagenum;
+		const uint32_t orig = tlb_phys_page(pagenum);
+		tlb_phys_page(pagenum) = (uint32_t)pagenum;
 		const uint32_t ch = ph->readd((PhysPt)addr); /* WARNING: 4GB wraparound here */
-		paging.tlb.phys_page[pagenum] = orig;
+		tlb_phys_page(pagenum) = orig;
 		return ch;
 	}
 	else {
@@ -2721,10 +2956,10 @@ void physdev_writeb(const PhysPt64 addr,const uint8_t val) {
 	else {
 		/* This hack is necessary because of the weird way that CPU linear addresses
 		 * make their way down to the hardware read/write callbacks */
-		const uint32_t orig = paging.tlb.phys_page[pagenum];
-		paging.tlb.phys_page[pagenum] = (uint32_t)pagenum;
+		const uint32_t orig = tlb_phys_page(pagenum);
+		tlb_phys_page(pagenum) = (uint32_t)pagenum;
 		ph->writeb((PhysPt)addr,val); /* WARNING: 4GB wraparound here */
-		paging.tlb.phys_page[pagenum] = orig;
+		tlb_phys_page(pagenum) = orig;
 	}
 }
 
@@ -2739,10 +2974,10 @@ void physdev_writew(const PhysPt64 addr,const uint16_t val) {
 		else {
 			/* This hack is necessary because of the weird way that CPU linear addresses
 			 * make their way down to the hardware read/write callbacks */
-			const uint32_t orig = paging.tlb.phys_page[pagenum];
-			paging.tlb.phys_page[pagenum] = (uint32_t)pagenum;
+			const uint32_t orig = tlb_phys_page(pagenum);
+			tlb_phys_page(pagenum) = (uint32_t)pagenum;
 			ph->writew((PhysPt)addr,val); /* WARNING: 4GB wraparound here */
-			paging.tlb.phys_page[pagenum] = orig;
+			tlb_phys_page(pagenum) = orig;
 		}
 	}
 	else {
@@ -2762,10 +2997,10 @@ void physdev_writed(const PhysPt64 addr,const uint32_t val) {
 		else {
 			/* This hack is necessary because of the weird way that CPU linear addresses
 			 * make their way down to the hardware read/write callbacks */
-			const uint32_t orig = paging.tlb.phys_page[pagenum];
-			paging.tlb.phys_page[pagenum] = (uint32_t)pagenum;
+			const uint32_t orig = tlb_phys_page(pagenum);
+			tlb_phys_page(pagenum) = (uint32_t)pagenum;
 			ph->writed((PhysPt)addr,val); /* WARNING: 4GB wraparound here */
-			paging.tlb.phys_page[pagenum] = orig;
+			tlb_phys_page(pagenum) = orig;
 		}
 	}
 	else {
@@ -2815,6 +3050,86 @@ public:
 
 private:
 	void getBytes(std::ostream& stream) override
+	{
+		SerializeGlobalPOD::getBytes(stream);
+
+		// - near-pure data
+		WRITE_POD( &memory, memory );
+
+		// - static 'new' ptr
+		WRITE_POD_SIZE( MemBase, memory.pages*4096 );
+
+		writeTables(stream);
+	}
+
+	bool hasDelta() override
+	{
+		return MemDirty != NULL;
+	}
+
+	/* only the pages written since the last state saved or loaded, as page number and contents.
+	 * Pages that are not plain RAM or ROM (video memory, code pages of the dynamic core) always go in. */
+	void getDelta(std::ostream& stream) override
+	{
+		const uint32_t end = 0xFFFFFFFFu;
+
+		SerializeGlobalPOD::getBytes(stream);
+		WRITE_POD( &memory, memory );
+
+		for( uint32_t page=0; page<memory.pages; page++ ) {
+			const PageHandler *ph = memory.phandlers[page];
+
+			if( !MemDirty[page] && (ph == NULL || ph == &ram_page_handler || ph == &rom_page_handler) )
+				continue;
+
+			WRITE_POD( &page, page );
+			WRITE_POD_SIZE( MemBase+page*4096, 4096 );
+		}
+		WRITE_POD( &end, end );
+
+		writeTables(stream);
+	}
+
+	void setDelta(std::istream& stream) override
+	{
+		void *old_ptrs[4];
+		uint32_t page;
+
+		savePointers(old_ptrs);
+		SerializeGlobalPOD::setBytes(stream);
+		READ_POD( &memory, memory );
+		restorePointers(old_ptrs);
+
+		for (;;) {
+			page = 0xFFFFFFFFu;
+			READ_POD( &page, page );
+			if( page == 0xFFFFFFFFu || !stream )
+				break;
+
+			if( page < memory.pages ) {
+				READ_POD_SIZE( MemBase+page*4096, 4096 );
+			}
+			else {
+				stream.ignore(4096);
+			}
+		}
+
+		readTables(stream);
+	}
+
+	void resetDelta() override
+	{
+#if defined(C_HAVE_LINUX_KVM_X86)
+		/* the guest writes the RAM mapped into the VM directly, nothing marks those pages */
+		if( cpudecoder == &CPU_Core_KVM_Run || cpudecoder == &CPU_Core_KVM_Trap_Run ) {
+			MEM_ResetDirty(true);
+			return;
+		}
+#endif
+		MEM_ResetDirty(false);
+	}
+
+	void writeTables(std::ostream& stream)
 	{
 		uint8_t pagehandler_idx[0x40000];
 		unsigned int size_table;
@@ -2833,20 +3148,6 @@ private:
 			}
 		}
 
-		//*******************************************
-		//*******************************************
-
-		SerializeGlobalPOD::getBytes(stream);
-
-		// - near-pure data
-		WRITE_POD( &memory, memory );
-
-		// - static 'new' ptr
-		WRITE_POD_SIZE( MemBase, memory.pages*4096 );
-
-		//***********************************************
-		//***********************************************
-
 		if (!dos_kernel_disabled) {
 			WRITE_POD_SIZE( memory.mhandles, sizeof(MemHandle) * memory.pages );
 		}
@@ -2862,34 +3163,43 @@ private:
 
 	void setBytes(std::istream& stream) override
 	{
-		uint8_t pagehandler_idx[0x40000];
 		void *old_ptrs[4];
 
-		old_ptrs[0] = (void *) memory.phandlers;
-		old_ptrs[1] = (void *) memory.mhandles;
-		old_ptrs[2] = (void *) memory.lfb.handler;
-		old_ptrs[3] = (void *) memory.lfb_mmio.handler;
-
-		//***********************************************
-		//***********************************************
+		savePointers(old_ptrs);
 
 		SerializeGlobalPOD::setBytes(stream);
 
-
 		// - near-pure data
 		READ_POD( &memory, memory );
 
 		// - static 'new' ptr
 		READ_POD_SIZE( MemBase, memory.pages*4096 );
 
-		//***********************************************
-		//***********************************************
+		restorePointers(old_ptrs);
 
+		readTables(stream);
+	}
+
+	// the pointers in the memory struct stay those of this run
+	void savePointers(void *old_ptrs[4])
+	{
+		old_ptrs[0] = (void *) memory.phandlers;
+		old_ptrs[1] = (void *) memory.mhandles;
+		old_ptrs[2] = (void *) memory.lfb.handler;
+		old_ptrs[3] = (void *) memory.lfb_mmio.handler;
+	}
+
+	void restorePointers(void *old_ptrs[4])
+	{
 		memory.phandlers = (PageHandler **) old_ptrs[0];
 		memory.mhandles = (MemHandle *) old_ptrs[1];
 		memory.lfb.handler = (PageHandler *) old_ptrs[2];
 		memory.lfb_mmio.handler = (PageHandler *) old_ptrs[3];
+	}
 
+	void readTables(std::istream& stream)
+	{
+		uint8_t pagehandler_idx[0x40000];
 
 		if (!dos_kernel_disabled) {
 			READ_POD_SIZE( memory.mhandles, sizeof(MemHandle) * memory.pages );
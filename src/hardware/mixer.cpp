@@ -23,8 +23,14 @@
 */
 
 #include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <float.h>
+#include <map>
+#include <memory>
 #include <string.h>
 #include <sys/types.h>
+#include <vector>
 #define _USE_MATH_DEFINES // needed for M_PI in Visual Studio as documented [https://msdn.microsoft.com/en-us/library/4hwaceh6.aspx]
 #include <math.h>
 
@@ -48,6 +54,7 @@
 #include "SDL.h"
 #include "mem.h"
 #include "pic.h"
+#include "cpu.h"
 #include "dosbox.h"
 #include "logging.h"
 #include "mixer.h"
@@ -59,19 +66,23 @@
 #include "mapper.h"
 #include "hardware.h"
 #include "programs.h"
+#include "output/output_null.h"
 #include "midi.h"
+#include "hosttime.h"
+#include "hostmem.h"
 
-#define MIXER_SSIZE 4
 #define MIXER_VOLSHIFT 13
 
+#include "mixer_simd.h"
+
 #ifdef C_SDL2
 SDL_AudioDeviceID SDL2_AudioDevice = 0; /* valid IDs are 2 or higher, 1 for compat, 0 is never a valid ID */
 #endif
 
-static INLINE int16_t MIXER_CLIP(Bits SAMP) {
+static INLINE int16_t MIXER_CLIP(float SAMP) {
     if (SAMP < MAX_AUDIO) {
         if (SAMP > MIN_AUDIO)
-            return SAMP;
+            return (int16_t)lrintf(SAMP);
         else
             return MIN_AUDIO;
     } else {
@@ -79,14 +90,36 @@ static INLINE int16_t MIXER_CLIP(Bits SAMP) {
     }
 }
 
+/* The mixer works in float from the channel's sample load to the output, in 16-bit sample units.
+ * These are the only places it is converted: to 16-bit for the sound device or capture, or to
+ * -1.0 ... 1.0 float for a sound device that takes float. */
+static void MIXER_ToS16(int16_t *dst,const float *src,Bitu frames,float vol0,float vol1) {
+    Bitu i = MixerSIMD_ToS16(dst,src,(unsigned int)frames,vol0,vol1);
+
+    for (;i < frames;i++) {
+        dst[i*2+0] = MIXER_CLIP(src[i*2+0] * vol0);
+        dst[i*2+1] = MIXER_CLIP(src[i*2+1] * vol1);
+    }
+}
+
+static void MIXER_ToF32(float *dst,const float *src,Bitu frames,float vol0,float vol1) {
+    Bitu i = MixerSIMD_ToF32(dst,src,(unsigned int)frames,vol0,vol1);
+
+    vol0 /= 32768.0f;
+    vol1 /= 32768.0f;
+    for (;i < frames;i++) {
+        dst[i*2+0] = clamp(src[i*2+0] * vol0,-1.0f,1.0f);
+        dst[i*2+1] = clamp(src[i*2+1] * vol1,-1.0f,1.0f);
+    }
+}
+
 struct mixedFraction {
     unsigned int        w;
     unsigned int        fn,fd;
 };
 
 static struct {
-    int32_t          work[MIXER_BUFSIZE][2];
-    Bitu            work_in,work_out,work_wrap;
+    float           work[MIXER_BUFSIZE][2];     /* the millisecond being mixed */
     Bitu            pos,done;
     float           mastervol[2];
     float           recordvol[2];
@@ -97,13 +130,216 @@ static struct {
     struct mixedFraction samples_this_ms;
     struct mixedFraction samples_rendered_ms;
     bool            nosound;
+    bool            output_float;   /* the sound device takes AUDIO_F32SYS, else AUDIO_S16SYS */
     bool            swapstereo;
     bool            sampleaccurate;
-    bool            prebuffer_wait;
-    Bitu            prebuffer_samples;
+    bool            prebuffer_wait;             /* owned by MIXER_CallBack */
     bool            mute;
+    unsigned int    resampler;                  /* MIXER_RESAMPLER_* */
 } mixer;
 
+enum {
+    MIXER_RESAMPLER_LINEAR=0,
+    MIXER_RESAMPLER_FAST,
+    MIXER_RESAMPLER_MEDIUM,
+    MIXER_RESAMPLER_HIGH
+};
+
+/* Mixed frames on their way to the sound device. MIXER_Mix is the only producer and MIXER_CallBack
+ * the only consumer, so neither side takes a lock: each one owns one of the free running indices
+ * and publishes it with release ordering. Keeping time against the device clock is done by the
+ * producer, which drops frames when too many pile up, so the callback only converts and copies. */
+static struct {
+    float                   frames[MIXER_BUFSIZE][2];
+    std::atomic<uint32_t>   head{0};        /* frames written, by MIXER_Mix */
+    std::atomic<uint32_t>   tail{0};        /* frames read, by MIXER_CallBack */
+    std::atomic<uint32_t>   prebuffer{0};   /* frames to collect before playing starts again */
+    std::atomic<uint32_t>   underruns{0};   /* callbacks that ran out of frames */
+    std::atomic<uint32_t>   overruns{0};    /* frames dropped because the ring was full */
+    std::atomic<uint32_t>   dropped{0};     /* frames dropped to keep time */
+    std::atomic<uint32_t>   jitter_us{0};   /* how far apart callbacks come from the block period, smoothed */
+    uint32_t                reported[3] = {0,0,0};
+    unsigned int            report_ms = 0;
+} mixer_ring;
+
+/* Adaptive buffering, run by MIXER_Mix. Underruns grow the prebuffer, then the device block size;
+ * a long quiet stretch with low callback jitter shrinks them again. In between, the fill level is
+ * held near its target by playing the mix up to 0.25% faster or slower instead of dropping frames. */
+static struct {
+    bool                    enabled = false;
+    unsigned int            eval_ms = 0;
+    unsigned int            stable_ms = 0;
+    uint32_t                underruns = 0;  /* at the last evaluation */
+    double                  fill_avg = 0;
+    double                  rate_adjust = 1.0;  /* output frames per mixed frame */
+    std::atomic<int32_t>    rate_ppm{0};    /* rate_adjust for the stats, in parts per million */
+    double                  rs_pos = 1.0;   /* position of the next output frame, 1.0 = first frame of the chunk */
+    float                   rs_prev[2] = {0,0};
+    float                   rs_out[MIXER_BUFSIZE][2];
+} mixer_adapt;
+
+static void MIXER_RingPush(const float (*src)[2],Bitu frames) {
+    const uint32_t head = mixer_ring.head.load(std::memory_order_relaxed);
+    const uint32_t fill = head - mixer_ring.tail.load(std::memory_order_acquire);
+    const uint32_t prebuffer = mixer_ring.prebuffer.load(std::memory_order_relaxed);
+    Bitu drop = 0;
+
+    if (mixer_adapt.enabled) {
+        /* a fixed threshold would fight the controller, so only drop when it has clearly lost */
+        if (fill >= (prebuffer + (mixer.blocksize*4UL)))
+            drop = frames;
+    }
+    /* the fill seen here is anywhere up to a block above what the callback leaves behind */
+    else if (fill >= (mixer.blocksize*4UL)) // hard drop
+        drop = frames;
+    else if (fill >= (mixer.blocksize*3UL)) // subtle drop
+        drop = ((fill - (mixer.blocksize*3U)) / 50U) + 1;
+
+    if (drop > frames) drop = frames;
+    mixer_ring.dropped.fetch_add((uint32_t)drop,std::memory_order_relaxed);
+    frames -= drop;
+
+    /* drift correction: linear interpolation across the chunk, starting from the last frame of the previous one */
+    if (mixer_adapt.enabled && frames > 0 && !drop) {
+        const double step = 1.0 / mixer_adapt.rate_adjust;
+        double p = mixer_adapt.rs_pos - 1.0;
+        Bitu out = 0;
+
+        while (p <= (double)(frames - 1) && out < MIXER_BUFSIZE) {
+            const Bits i = (Bits)floor(p);
+            const float f = (float)(p - (double)i);
+            const float *a = (i < 0) ? mixer_adapt.rs_prev : src[i];
+
+            if (f == 0.0f) {
+                mixer_adapt.rs_out[out][0] = a[0];
+                mixer_adapt.rs_out[out][1] = a[1];
+            }
+            else {
+                mixer_adapt.rs_out[out][0] = a[0] + ((src[i+1][0] - a[0]) * f);
+                mixer_adapt.rs_out[out][1] = a[1] + ((src[i+1][1] - a[1]) * f);
+            }
+            out++;
+            p += step;
+        }
+
+        mixer_adapt.rs_pos = p - (double)(frames - 1);
+        mixer_adapt.rs_prev[0] = src[frames-1][0];
+        mixer_adapt.rs_prev[1] = src[frames-1][1];
+        src = mixer_adapt.rs_out;
+        frames = out;
+    }
+
+    if (frames > (MIXER_BUFSIZE - fill)) {
+        mixer_ring.overruns.fetch_add((uint32_t)(frames - (MIXER_BUFSIZE - fill)),std::memory_order_relaxed);
+        frames = MIXER_BUFSIZE - fill;
+    }
+
+    const uint32_t pos = head & MIXER_BUFMASK;
+    Bitu n = MIXER_BUFSIZE - pos;
+    if (n > frames) n = frames;
+    memcpy(&mixer_ring.frames[pos][0],&src[0][0],n*sizeof(src[0]));
+    if (n < frames) memcpy(&mixer_ring.frames[0][0],&src[n][0],(frames-n)*sizeof(src[0]));
+
+    mixer_ring.head.store(head + (uint32_t)frames,std::memory_order_release);
+}
+
+/* once a second, log whatever the ring counters picked up since the last time */
+static void MIXER_RingReport(void) {
+    if (++mixer_ring.report_ms < 1000) return;
+    mixer_ring.report_ms = 0;
+
+    const uint32_t now[3] = {
+        mixer_ring.underruns.load(std::memory_order_relaxed),
+        mixer_ring.overruns.load(std::memory_order_relaxed),
+        mixer_ring.dropped.load(std::memory_order_relaxed) };
+
+    if (now[0] != mixer_ring.reported[0] || now[1] != mixer_ring.reported[1] || now[2] != mixer_ring.reported[2]) {
+        LOG(LOG_MISC,LOG_DEBUG)("Mixer: %u underruns, %u frames overrun, %u frames dropped to keep time",
+            (unsigned int)(now[0] - mixer_ring.reported[0]),
+            (unsigned int)(now[1] - mixer_ring.reported[1]),
+            (unsigned int)(now[2] - mixer_ring.reported[2]));
+        for (unsigned int i=0;i < 3;i++) mixer_ring.reported[i] = now[i];
+    }
+}
+
+static bool MIXER_ReopenDevice(uint32_t blocksize);
+
+static void MIXER_AdaptBuffering(void) {
+    const uint32_t fill = mixer_ring.head.load(std::memory_order_relaxed) - mixer_ring.tail.load(std::memory_order_acquire);
+    uint32_t prebuffer = mixer_ring.prebuffer.load(std::memory_order_relaxed);
+
+    /* the producer sees the fill swing between what the callback leaves and one block more */
+    const double target = (double)prebuffer + (mixer.blocksize / 2.0);
+    mixer_adapt.fill_avg += ((double)fill - mixer_adapt.fill_avg) / 256.0;
+    double adj = 0.0025 * (mixer_adapt.fill_avg - target) / (target > 1.0 ? target : 1.0);
+    if (adj > 0.0025) adj = 0.0025;
+    else if (adj < -0.0025) adj = -0.0025;
+    mixer_adapt.rate_adjust = 1.0 - adj;
+    mixer_adapt.rate_ppm.store((int32_t)((mixer_adapt.rate_adjust - 1.0) * 1000000.0),std::memory_order_relaxed);
+
+    if (++mixer_adapt.eval_ms < 1000) return;
+    mixer_adapt.eval_ms = 0;
+
+    const uint32_t underruns = mixer_ring.underruns.load(std::memory_order_relaxed);
+    const uint32_t jitter = (uint32_t)(((uint64_t)mixer_ring.jitter_us.load(std::memory_order_relaxed) * mixer.freq) / 1000000u);
+    const uint32_t max_prebuffer = MIXER_BUFSIZE / 4;
+    const uint32_t min_prebuffer = mixer.freq / 1000u;
+    const uint32_t old_prebuffer = prebuffer;
+    const uint32_t old_blocksize = mixer.blocksize;
+
+    if (underruns != mixer_adapt.underruns) {
+        mixer_adapt.underruns = underruns;
+        mixer_adapt.stable_ms = 0;
+
+        if (prebuffer < max_prebuffer) {
+            prebuffer += (prebuffer / 2u) + min_prebuffer;
+            if (prebuffer > max_prebuffer) prebuffer = max_prebuffer;
+        }
+        else if (mixer.blocksize < 4096u) {
+            MIXER_ReopenDevice(mixer.blocksize * 2u);
+        }
+    }
+    else {
+        mixer_adapt.stable_ms += 1000;
+
+        /* after 10 quiet seconds, come down an eighth at a time while staying well clear of the jitter */
+        if (mixer_adapt.stable_ms >= 10000) {
+            uint32_t floor_frames = jitter * 3u;
+            if (floor_frames < min_prebuffer) floor_frames = min_prebuffer;
+
+            if (prebuffer > floor_frames) {
+                prebuffer -= (prebuffer / 8u) + 1u;
+                if (prebuffer < floor_frames) prebuffer = floor_frames;
+                mixer_adapt.stable_ms = 5000;
+            }
+            else if (mixer_adapt.stable_ms >= 30000 && mixer.blocksize > 256u && (jitter * 4u) < mixer.blocksize) {
+                MIXER_ReopenDevice(mixer.blocksize / 2u);
+                mixer_adapt.stable_ms = 0;
+            }
+        }
+    }
+
+    if (prebuffer != old_prebuffer || mixer.blocksize != old_blocksize) {
+        mixer_ring.prebuffer.store(prebuffer,std::memory_order_relaxed);
+        LOG(LOG_MISC,LOG_DEBUG)("Mixer: adaptive buffering now at prebuffer=%u blocksize=%u (jitter %u frames)",
+            (unsigned int)prebuffer,(unsigned int)mixer.blocksize,(unsigned int)jitter);
+    }
+}
+
+void MIXER_GetAudioStats(MIXER_AudioStats &st) {
+    st.adaptive = mixer_adapt.enabled;
+    st.rate = mixer.freq;
+    st.blocksize = mixer.blocksize;
+    st.prebuffer = mixer_ring.prebuffer.load(std::memory_order_relaxed);
+    st.buffered = mixer_ring.head.load(std::memory_order_acquire) - mixer_ring.tail.load(std::memory_order_acquire);
+    st.latency_ms = mixer.freq ? (((double)st.buffered + st.blocksize) * 1000.0 / mixer.freq) : 0.0;
+    st.jitter_ms = mixer_ring.jitter_us.load(std::memory_order_relaxed) / 1000.0;
+    st.rate_adjust_ppm = mixer_adapt.rate_ppm.load(std::memory_order_relaxed);
+    st.underruns = mixer_ring.underruns.load(std::memory_order_relaxed);
+    st.overruns = mixer_ring.overruns.load(std::memory_order_relaxed);
+    st.dropped = mixer_ring.dropped.load(std::memory_order_relaxed);
+}
+
 uint32_t Mixer_MIXQ(void) {
 	return  ((uint32_t)mixer.freq) |
 		((uint32_t)2u/*channels*/ << (uint32_t)20u) |
@@ -122,9 +358,129 @@ inline void MixerChannel::updateSlew(void) {
     if (freq_nslew < freq_n) freq_nslew = freq_n;
 
     if (freq_nslew_want > 0 && freq_nslew_want < freq_n)
-        max_change = ((uint64_t)freq_nslew_want * (uint64_t)0x8000) / (uint64_t)freq_n;
+        max_change = (float)(((double)freq_nslew_want * 32768.0) / freq_n);
     else
-        max_change = 0x7FFFFFFFUL;
+        max_change = FLT_MAX;
+}
+
+/* for the host memory report, which may run on another thread than the one adding channels */
+static std::atomic<unsigned int> mixer_channel_count{0};
+static std::atomic<size_t> mixer_sinc_bytes{0};
+
+/* Windowed sinc polyphase filter. Row p holds the taps that interpolate at p / phases of the way
+ * from tap (taps / 2 - 1) to the next one, so the output runs taps / 2 loaded samples behind the
+ * linear interpolation. When the source rate is above the mixer rate the cutoff comes down with
+ * it, and the filter gets longer to match, up to MIXER_SINC_MAXTAPS. */
+struct MixerSincTable {
+    unsigned int        taps,phases;
+    bool                interpolate;        /* blend the two nearest rows instead of taking the nearest */
+    std::vector<float>  coef;               /* phases + 1 rows of taps */
+
+    const float *row(const unsigned int p) const {
+        return &coef[(size_t)p * taps];
+    }
+};
+
+static const MixerSincTable *MIXER_GetSincTable(unsigned int freq_n,unsigned int freq_d) {
+    static const struct {
+        unsigned int    taps,phases;
+        bool            interpolate;
+        double          rolloff;
+    } quality[4] = {
+        {  0,  0,false,0.00 },      /* linear */
+        {  8, 64,false,0.85 },      /* fast */
+        { 16,256,false,0.90 },      /* medium */
+        { 32,256,true, 0.94 }       /* high */
+    };
+    static std::map< uint64_t,std::unique_ptr<MixerSincTable> > cache;
+
+    if (mixer.resampler == MIXER_RESAMPLER_LINEAR || mixer.resampler > MIXER_RESAMPLER_HIGH) return nullptr;
+    const auto &q = quality[mixer.resampler];
+
+    const double ratio = (double)freq_d / freq_n; /* mixer rate / source rate */
+    const double cutoff = (ratio < 1.0 ? ratio : 1.0) * q.rolloff;
+    unsigned int taps = q.taps;
+    if (ratio < 1.0) taps = ((unsigned int)ceil(q.taps / ratio) + 7u) & ~7u;
+    if (taps > MIXER_SINC_MAXTAPS) taps = MIXER_SINC_MAXTAPS;
+
+    const uint64_t key = ((uint64_t)mixer.resampler << 56ull) | ((uint64_t)taps << 40ull) | (uint64_t)(cutoff * 1000000.0);
+    auto i = cache.find(key);
+    if (i != cache.end()) return i->second.get();
+
+    std::unique_ptr<MixerSincTable> t(new MixerSincTable);
+    t->taps = taps;
+    t->phases = q.phases;
+    t->interpolate = q.interpolate;
+    t->coef.resize((size_t)(q.phases + 1u) * taps);
+
+    const double half = taps / 2.0;
+    for (unsigned int p=0;p <= q.phases;p++) {
+        float *h = &t->coef[(size_t)p * taps];
+        double sum = 0;
+
+        for (unsigned int k=0;k < taps;k++) {
+            const double d = (double)k - (half - 1.0) - ((double)p / q.phases);
+            const double x = d / half; /* Blackman window over -1 ... 1 */
+            double v = 0;
+
+            if (x > -1.0 && x < 1.0) {
+                const double w = 0.42 + (0.5 * cos(M_PI * x)) + (0.08 * cos(2.0 * M_PI * x));
+                const double s = (d == 0) ? 1.0 : (sin(M_PI * cutoff * d) / (M_PI * cutoff * d));
+                v = w * s;
+            }
+
+            h[k] = (float)v;
+            sum += v;
+        }
+
+        /* unity gain at DC for every phase */
+        for (unsigned int k=0;k < taps;k++) h[k] = (float)(h[k] / sum);
+    }
+
+    LOG(LOG_MISC,LOG_DEBUG)("Mixer: sinc filter for %u/%u, %u taps, %u phases, cutoff %.3f",freq_n,freq_d,taps,q.phases,cutoff);
+    mixer_sinc_bytes += sizeof(MixerSincTable) + t->coef.size() * sizeof(float);
+    return (cache[key] = std::move(t)).get();
+}
+
+void MixerChannel::sincUpdate(void) {
+    /* slew limiting shapes the linear ramp itself, and equal rates need no filter at all */
+    if (freq_nslew_want == 0 && freq_n != freq_d)
+        sinc = MIXER_GetSincTable(freq_n,freq_d);
+    else
+        sinc = nullptr;
+}
+
+void MixerChannel::sincRender(float out[2]) {
+    const unsigned int taps = sinc->taps;
+    const float *x0 = &sinc_hist[0][sinc_pos + MIXER_SINC_MAXTAPS + 1u - taps];
+    const float *x1 = &sinc_hist[1][sinc_pos + MIXER_SINC_MAXTAPS + 1u - taps];
+    const uint64_t pp = (uint64_t)freq_f * (uint64_t)sinc->phases;
+    unsigned int p = (unsigned int)(pp / freq_d);
+    const uint64_t rem = pp % freq_d;
+
+    if (!sinc->interpolate && (rem * 2u) >= freq_d) p++;
+
+    const float *h = sinc->row(p);
+    unsigned int k = MixerSIMD_Dot2(h,x0,x1,taps,out[0],out[1]);
+    for (;k < taps;k++) {
+        out[0] += h[k] * x0[k];
+        out[1] += h[k] * x1[k];
+    }
+
+    if (sinc->interpolate) {
+        float nx[2];
+
+        h = sinc->row(p + 1u);
+        k = MixerSIMD_Dot2(h,x0,x1,taps,nx[0],nx[1]);
+        for (;k < taps;k++) {
+            nx[0] += h[k] * x0[k];
+            nx[1] += h[k] * x1[k];
+        }
+
+        const float t = (float)rem / (float)freq_d;
+        out[0] += (nx[0] - out[0]) * t;
+        out[1] += (nx[1] - out[1]) * t;
+    }
 }
 
 void MIXER_SetMaster(float vol0, float vol1) {
@@ -138,6 +494,8 @@ MixerChannel * MIXER_AddChannel(MIXER_Handler handler,Bitu freq,const char * nam
     chan->freq_nslew_want = 0;
     chan->freq_nslew = 0;
     chan->last_sample_write = 0;
+    chan->idle_timeout = 0;
+    chan->idle_silent = 0;
     chan->current_loaded = false;
     chan->handler=handler;
     chan->name=name;
@@ -145,15 +503,18 @@ MixerChannel * MIXER_AddChannel(MIXER_Handler handler,Bitu freq,const char * nam
     chan->msbuffer_o = 0;
     chan->freq_n = chan->freq_d = 1;
     chan->lowpass_freq = 0;
-    chan->lowpass_alpha = 0;
+    chan->lowpass_alpha = 0.0f;
 
     for (unsigned int i=0;i < LOWPASS_ORDER;i++) {
         for (unsigned int j=0;j < 2;j++)
-            chan->lowpass[i][j] = 0;
+            chan->lowpass[i][j] = 0.0f;
     }
 
     chan->lowpass_on_load = false;
     chan->lowpass_on_out = false;
+    chan->sinc = nullptr;
+    chan->sinc_pos = 0;
+    memset(chan->sinc_hist,0,sizeof(chan->sinc_hist));
     chan->freq_d_orig = 1;
     chan->freq_f = 0;
     chan->SetFreq(freq);
@@ -166,6 +527,7 @@ MixerChannel * MIXER_AddChannel(MIXER_Handler handler,Bitu freq,const char * nam
     chan->current[0] = chan->current[1] = 0;
 
     mixer.channels=chan;
+    mixer_channel_count++;
     return chan;
 }
 
@@ -189,6 +551,7 @@ void MIXER_DelChannel(MixerChannel* delchan) {
         if (chan==delchan) {
             *where=chan->next;
             delete delchan;
+            mixer_channel_count--;
             return;
         }
         where=&chan->next;
@@ -196,9 +559,16 @@ void MIXER_DelChannel(MixerChannel* delchan) {
     }
 }
 
+void MIXER_GetHostMemory(HostMemSize &sz) {
+    sz.add_heap(sizeof(mixer) + sizeof(mixer_ring) + sizeof(mixer_adapt));
+    sz.add_heap(mixer_channel_count * sizeof(MixerChannel) + mixer_sinc_bytes);
+}
+
 void MixerChannel::UpdateVolume(void) {
     volmul[0]=(Bits)((1 << MIXER_VOLSHIFT)*scale[0]*volmain[0]);
     volmul[1]=(Bits)((1 << MIXER_VOLSHIFT)*scale[1]*volmain[1]);
+    volgain[0]=scale[0]*volmain[0];
+    volgain[1]=scale[1]*volmain[1];
 }
 
 void MixerChannel::SetVolume(float _left,float _right) {
@@ -229,9 +599,25 @@ static void MIXER_FillUp(void);
 void MixerChannel::Enable(bool _yesno) {
     if (_yesno==enabled) return;
     enabled=_yesno;
+    idle_silent=0;
     if (!enabled) freq_f=0;
 }
 
+/* Devices whose output can only change when the guest writes to them (the FM and PSG chips)
+ * set a timeout and call Wake() from their write handlers. Once the channel has produced
+ * nothing but silence for the timeout, EndFrame() disables it, so neither the handler nor
+ * the chip emulation runs until the next write. Devices that keep time with silent output
+ * (GUS voices driving IRQs, DMA playback) must not use this. */
+void MixerChannel::SetIdleTimeout(unsigned int ms) {
+    idle_timeout=ms;
+    idle_silent=0;
+}
+
+void MixerChannel::Wake(void) {
+    idle_silent=0;
+    if (!enabled) Enable(true);
+}
+
 void MixerChannel::lowpassUpdate() {
     if (lowpass_freq != 0) {
         double timeInterval;
@@ -250,7 +636,7 @@ void MixerChannel::lowpassUpdate() {
 
         tau = 1.0 / (lowpass_freq * 2 * M_PI);
         talpha = timeInterval / (tau + timeInterval);
-        lowpass_alpha = (int32_t)(talpha * 0x10000); // double -> 16.16 fixed point
+        lowpass_alpha = (float)talpha;
 
 //      LOG_MSG("Lowpass freq_n=%u freq_d=%u timeInterval=%.12f tau=%.12f alpha=%.6f onload=%u onout=%u",
 //          freq_n,freq_d_orig,timeInterval,tau,talpha,lowpass_on_load,lowpass_on_out);
@@ -261,15 +647,13 @@ void MixerChannel::lowpassUpdate() {
     }
 }
 
-inline int32_t MixerChannel::lowpassStep(int32_t in,const unsigned int iteration,const unsigned int channel) {
-    const int64_t m1 = (int64_t)in * (int64_t)lowpass_alpha;
-    const int64_t m2 = ((int64_t)lowpass[iteration][channel] << ((int64_t)16)) - ((int64_t)lowpass[iteration][channel] * (int64_t)lowpass_alpha);
-    const int32_t ns = (int32_t)((m1 + m2) >> (int64_t)16);
+inline float MixerChannel::lowpassStep(float in,const unsigned int iteration,const unsigned int channel) {
+    const float ns = lowpass[iteration][channel] + ((in - lowpass[iteration][channel]) * lowpass_alpha);
     lowpass[iteration][channel] = ns;
     return ns;
 }
 
-inline void MixerChannel::lowpassProc(int32_t ch[2]) {
+inline void MixerChannel::lowpassProc(float ch[2]) {
     for (unsigned int i=0;i < lowpass_order;i++) {
         for (unsigned int c=0;c < 2;c++)
             ch[c] = lowpassStep(ch[c],i,c);
@@ -287,6 +671,7 @@ void MixerChannel::SetLowpassFreq(Bitu _freq,unsigned int order) {
 void MixerChannel::SetSlewFreq(Bitu _freq) {
     freq_nslew_want = _freq;
     updateSlew();
+    sincUpdate();
 }
 
 void MixerChannel::SetFreq(Bitu _freq,Bitu _den) {
@@ -303,6 +688,7 @@ void MixerChannel::SetFreq(Bitu _freq,Bitu _den) {
     freq_d_orig = _den;
     updateSlew();
     lowpassUpdate();
+    sincUpdate();
 }
 
 void CAPTURE_MultiTrackAddWave(uint32_t freq, uint32_t len, int16_t * data,const char *name);
@@ -319,14 +705,8 @@ void MixerChannel::EndFrame(Bitu samples) {
             padding = samples - cnv;
 
         if (cnv > 0) {
-            int32_t volscale1 = (int32_t)(mixer.recordvol[0] * (1 << MIXER_VOLSHIFT));
-            int32_t volscale2 = (int32_t)(mixer.recordvol[1] * (1 << MIXER_VOLSHIFT));
-
             if (cnv > 1024) cnv = 1024;
-            for (Bitu i=0;i<cnv;i++) {
-                convert[i][0]=MIXER_CLIP(((int64_t)msbuffer[i][0] * (int64_t)volscale1) >> (MIXER_VOLSHIFT + MIXER_VOLSHIFT));
-                convert[i][1]=MIXER_CLIP(((int64_t)msbuffer[i][1] * (int64_t)volscale2) >> (MIXER_VOLSHIFT + MIXER_VOLSHIFT));
-            }
+            MIXER_ToS16(&convert[0][0],&msbuffer[0][0],cnv,mixer.recordvol[0],mixer.recordvol[1]);
             CAPTURE_MultiTrackAddWave(mixer.freq,cnv,(int16_t*)convert,name);
         }
 
@@ -337,6 +717,21 @@ void MixerChannel::EndFrame(Bitu samples) {
         }
     }
 
+    if (idle_timeout != 0 && enabled) {
+        const Bitu n = msbuffer_o < samples ? msbuffer_o : samples;
+        Bitu i = 0;
+
+        /* silence is anything that rounds to zero on output */
+        while (i < n && fabsf(msbuffer[i][0]) < 0.5f && fabsf(msbuffer[i][1]) < 0.5f) i++;
+
+        if (i < n)
+            idle_silent = 0;
+        else if (++idle_silent >= idle_timeout) {
+            LOG(LOG_MISC,LOG_DEBUG)("Mixer: channel %s silent for %ums, disabling until written to",name,idle_timeout);
+            Enable(false);
+        }
+    }
+
     rend_n = rend_d = 0;
     if (msbuffer_o <= samples) {
         msbuffer_o = 0;
@@ -346,7 +741,7 @@ void MixerChannel::EndFrame(Bitu samples) {
         msbuffer_o -= samples;
         if (msbuffer_i >= samples) msbuffer_i -= samples;
         else msbuffer_i = 0;
-        memmove(&msbuffer[0][0],&msbuffer[samples][0],msbuffer_o*sizeof(int32_t)*2/*stereo*/);
+        memmove(&msbuffer[0][0],&msbuffer[samples][0],msbuffer_o*sizeof(msbuffer[0]));
     }
 
     last_sample_write -= (int)samples;
@@ -359,7 +754,7 @@ void MixerChannel::Mix(Bitu whole,Bitu frac) {
     if (whole <= rend_n) return;
     assert(whole <= mixer.samples_this_ms.w);
     assert(rend_n < mixer.samples_this_ms.w);
-    int32_t *outptr = &mixer.work[mixer.work_in+rend_n][0];
+    float *outptr = &mixer.work[rend_n][0];
 
     if (!enabled) {
         rend_n = whole;
@@ -367,6 +762,8 @@ void MixerChannel::Mix(Bitu whole,Bitu frac) {
         return;
     }
 
+    HostTimeScope scope(HOSTTIME_MIXER,this,name);
+
     // HACK: We iterate twice only because of the Sound Blaster emulation. No other emulation seems to need this.
     rendering_to_n = whole;
     rendering_to_d = frac;
@@ -391,6 +788,14 @@ void MixerChannel::Mix(Bitu whole,Bitu frac) {
         Bitu t_rend_n = rend_n;
         Bitu t_msbuffer_i = msbuffer_i;
 
+        if (t_rend_n < whole && t_msbuffer_i < upto) {
+            Bitu n = whole - t_rend_n;
+            if (n > (upto - t_msbuffer_i)) n = upto - t_msbuffer_i;
+            n = MixerSIMD_Lowpass(&msbuffer[t_msbuffer_i],(unsigned int)n,lowpass,lowpass_order,lowpass_alpha);
+            t_msbuffer_i += n;
+            t_rend_n += n;
+        }
+
         while (t_rend_n < whole && t_msbuffer_i < upto) {
             lowpassProc(msbuffer[t_msbuffer_i]);
             t_msbuffer_i++;
@@ -398,6 +803,15 @@ void MixerChannel::Mix(Bitu whole,Bitu frac) {
         }
     }
 
+    if (rend_n < whole && msbuffer_i < upto) {
+        Bitu n = whole - rend_n;
+        if (n > (upto - msbuffer_i)) n = upto - msbuffer_i;
+        n = MixerSIMD_Accumulate(outptr,&msbuffer[msbuffer_i][0],(unsigned int)n,mixer.swapstereo);
+        outptr += n * 2;
+        msbuffer_i += n;
+        rend_n += n;
+    }
+
     if (mixer.swapstereo) {
         while (rend_n < whole && msbuffer_i < upto) {
             *outptr++ += msbuffer[msbuffer_i][1];
@@ -431,9 +845,9 @@ inline void MixerChannel::loadCurrentSample(Bitu &len, const Type* &data) {
         const uint8_t xr = signeddata ? 0x00 : 0x80;
 
         len--;
-        current[0] = ((int8_t)((*data++) ^ xr)) << 8;
+        current[0] = (float)((int8_t)((*data++) ^ xr)) * 256.0f;
         if (stereo)
-            current[1] = ((int8_t)((*data++) ^ xr)) << 8;
+            current[1] = (float)((int8_t)((*data++) ^ xr)) * 256.0f;
         else
             current[1] = current[0];
     }
@@ -444,11 +858,11 @@ inline void MixerChannel::loadCurrentSample(Bitu &len, const Type* &data) {
         len--;
         if (nativeorder) d = ((uint16_t)((*data++) ^ xr));
         else d = host_readw((HostPt)(data++)) ^ xr;
-        current[0] = (int16_t)d;
+        current[0] = (float)((int16_t)d);
         if (stereo) {
             if (nativeorder) d = ((uint16_t)((*data++) ^ xr));
             else d = host_readw((HostPt)(data++)) ^ xr;
-            current[1] = (int16_t)d;
+            current[1] = (float)((int16_t)d);
         }
         else {
             current[1] = current[0];
@@ -461,24 +875,29 @@ inline void MixerChannel::loadCurrentSample(Bitu &len, const Type* &data) {
         len--;
         if (nativeorder) d = ((uint32_t)((*data++) ^ xr));
         else d = host_readd((HostPt)(data++)) ^ xr;
-        current[0] = (int32_t)d;
+        current[0] = (float)((int32_t)d);
         if (stereo) {
             if (nativeorder) d = ((uint32_t)((*data++) ^ xr));
             else d = host_readd((HostPt)(data++)) ^ xr;
-            current[1] = (int32_t)d;
+            current[1] = (float)((int32_t)d);
         }
         else {
             current[1] = current[0];
         }
     }
     else {
-        current[0] = current[1] = 0;
+        current[0] = current[1] = 0.0f;
         len = 0;
     }
 
     if (T_lowpass && lowpass_on_load)
         lowpassProc(current);
 
+    /* always kept up to date, so the sinc filter has its history ready when the rate changes to need it */
+    sinc_pos = (sinc_pos + 1u) % MIXER_SINC_MAXTAPS;
+    sinc_hist[0][sinc_pos] = sinc_hist[0][sinc_pos + MIXER_SINC_MAXTAPS] = current[0];
+    sinc_hist[1][sinc_pos] = sinc_hist[1][sinc_pos + MIXER_SINC_MAXTAPS] = current[1];
+
     if (stereo) {
         delta[0] = current[0] - last[0];
         delta[1] = current[1] - last[1];
@@ -508,9 +927,13 @@ inline void MixerChannel::padFillSampleInterpolation(const Bitu upto) {
     if (msbuffer_o < upto) {
         if (freq_f > freq_d) freq_f = freq_d; // this is an abrupt stop, so interpolation must not carry over, to help avoid popping artifacts
 
+        /* the fill has always been written without the channel volume, which in the old
+         * fixed point mix left it at 1 / (1 << MIXER_VOLSHIFT) of the held sample */
+        const float pad[2] = { current[0] / (1 << MIXER_VOLSHIFT), current[1] / (1 << MIXER_VOLSHIFT) };
+
         while (msbuffer_o < upto) {
-            msbuffer[msbuffer_o][0] = current[0];
-            msbuffer[msbuffer_o][1] = current[1];
+            msbuffer[msbuffer_o][0] = pad[0];
+            msbuffer[msbuffer_o][1] = pad[1];
             msbuffer_o++;
         }
     }
@@ -530,11 +953,25 @@ inline bool MixerChannel::runSampleInterpolation(const Bitu upto) {
     if (msbuffer_o >= upto)
         return false;
 
+    if (sinc != nullptr) {
+        while (freq_f < freq_d) {
+            sincRender(msbuffer[msbuffer_o]);
+            msbuffer[msbuffer_o][0] *= volgain[0];
+            msbuffer[msbuffer_o][1] *= volgain[1];
+
+            freq_f += freq_n;
+            freq_fslew += freq_nslew;
+            if ((++msbuffer_o) >= upto)
+                return false;
+        }
+
+        return true;
+    }
+
     while (freq_fslew < freq_d) {
-        int sample = last[0] + (int)(((int64_t)delta[0] * (int64_t)freq_fslew) / (int64_t)freq_d);
-        msbuffer[msbuffer_o][0] = sample * volmul[0];
-        sample = last[1] + (int)(((int64_t)delta[1] * (int64_t)freq_fslew) / (int64_t)freq_d);
-        msbuffer[msbuffer_o][1] = sample * volmul[1];
+        const float t = (float)freq_fslew / (float)freq_d;
+        msbuffer[msbuffer_o][0] = (last[0] + delta[0] * t) * volgain[0];
+        msbuffer[msbuffer_o][1] = (last[1] + delta[1] * t) * volgain[1];
 
         freq_f += freq_n;
         freq_fslew += freq_nslew;
@@ -545,8 +982,8 @@ inline bool MixerChannel::runSampleInterpolation(const Bitu upto) {
     current[0] = last[0] + delta[0];
     current[1] = last[1] + delta[1];
     while (freq_f < freq_d) {
-        msbuffer[msbuffer_o][0] = current[0] * volmul[0];
-        msbuffer[msbuffer_o][1] = current[1] * volmul[1];
+        msbuffer[msbuffer_o][0] = current[0] * volgain[0];
+        msbuffer[msbuffer_o][1] = current[1] * volgain[1];
 
         freq_f += freq_n;
         if ((++msbuffer_o) >= upto)
@@ -689,18 +1126,11 @@ static void MIXER_MixData(Bitu fracs/*render up to*/) {
     }
 
     if (CaptureState & (CAPTURE_WAVE|CAPTURE_VIDEO)) {
-        int32_t volscale1 = (int32_t)(mixer.recordvol[0] * (1 << MIXER_VOLSHIFT));
-        int32_t volscale2 = (int32_t)(mixer.recordvol[1] * (1 << MIXER_VOLSHIFT));
         int16_t convert[1024][2];
         Bitu added = whole - prev_rendered;
         if (added>1024) added=1024;
-        Bitu readpos = mixer.work_in + prev_rendered;
-        for (Bitu i=0;i<added;i++) {
-            convert[i][0]=MIXER_CLIP(((int64_t)mixer.work[readpos][0] * (int64_t)volscale1) >> (MIXER_VOLSHIFT + MIXER_VOLSHIFT));
-            convert[i][1]=MIXER_CLIP(((int64_t)mixer.work[readpos][1] * (int64_t)volscale2) >> (MIXER_VOLSHIFT + MIXER_VOLSHIFT));
-            readpos++;
-        }
-        assert(readpos <= MIXER_BUFSIZE);
+        assert((prev_rendered + added) <= MIXER_BUFSIZE);
+        MIXER_ToS16(&convert[0][0],&mixer.work[prev_rendered][0],added,mixer.recordvol[0],mixer.recordvol[1]);
         CAPTURE_AddWave( mixer.freq, added, (int16_t*)convert );
     }
 
@@ -710,19 +1140,9 @@ static void MIXER_MixData(Bitu fracs/*render up to*/) {
 }
 
 static void MIXER_FillUp(void) {
-#ifdef C_SDL2
-    SDL_LockAudioDevice(SDL2_AudioDevice);
-#else
-    SDL_LockAudio();
-#endif
     float index = PIC_TickIndex();
     if (index < 0) index = 0;
     MIXER_MixData((Bitu)((double)index * ((Bitu)mixer.samples_this_ms.w * mixer.samples_this_ms.fd)));
-#ifdef C_SDL2
-    SDL_UnlockAudioDevice(SDL2_AudioDevice);
-#else
-    SDL_UnlockAudio();
-#endif
 }
 
 void MixerChannel::FillUp(void) {
@@ -735,18 +1155,17 @@ void MIXER_MixSingle(Bitu /*val*/) {
 }
 
 static void MIXER_Mix(void) {
-    Bitu thr;
-
-#ifdef C_SDL2
-    SDL_LockAudioDevice(SDL2_AudioDevice);
-#else
-    SDL_LockAudio();
-#endif
+    HostTimeScope scope(HOSTTIME_MIXER);
+    const uint64_t governor_start = (CPU_GovernorMode != CPU_GOVERNOR_OFF) ? CPU_Governor_Clock() : 0;
 
     /* render */
-    assert((mixer.work_in+mixer.samples_per_ms.w) <= MIXER_BUFSIZE);
     MIXER_MixData((Bitu)mixer.samples_this_ms.w * (Bitu)mixer.samples_this_ms.fd);
-    mixer.work_in += mixer.samples_this_ms.w;
+    /* run-ahead frames are rolled back, their sound is mixed over by the next ms */
+    if (!runahead_ahead && !mixer.nosound) {
+        MIXER_RingPush(mixer.work,mixer.samples_this_ms.w);
+        MIXER_RingReport();
+        if (mixer_adapt.enabled) MIXER_AdaptBuffering();
+    }
 
     /* how many samples for the next ms? */
     mixer.samples_this_ms.w = mixer.samples_per_ms.w;
@@ -756,93 +1175,117 @@ static void MIXER_Mix(void) {
         mixer.samples_this_ms.w++;
     }
 
-    /* advance. we use in/out & wrap pointers to make sure the rendering code
-     * doesn't have to worry about circular buffer wraparound. */
-    thr = mixer.blocksize;
-    if (thr < mixer.samples_this_ms.w) thr = mixer.samples_this_ms.w;
-    if ((mixer.work_in+thr) > MIXER_BUFSIZE) {
-        mixer.work_wrap = mixer.work_in;
-        mixer.work_in = 0;
-    }
-    assert((mixer.work_in+thr) <= MIXER_BUFSIZE);
-    assert((mixer.work_in+mixer.samples_this_ms.w) <= MIXER_BUFSIZE);
-    memset(&mixer.work[mixer.work_in][0],0,sizeof(int32_t)*2*mixer.samples_this_ms.w);
+    assert(mixer.samples_this_ms.w <= MIXER_BUFSIZE);
+    memset(&mixer.work[0][0],0,sizeof(mixer.work[0])*mixer.samples_this_ms.w);
     mixer.samples_rendered_ms.fn = 0;
     mixer.samples_rendered_ms.w = 0;
-#ifdef C_SDL2
-    SDL_UnlockAudioDevice(SDL2_AudioDevice);
-#else
-    SDL_UnlockAudio();
-#endif
     MIXER_FillUp();
+
+    if (CPU_GovernorMode != CPU_GOVERNOR_OFF)
+        CPU_Governor_Account(CPU_GOVERNOR_AUDIO,governor_start);
 }
 
 static void SDLCALL MIXER_CallBack(void * userdata, Uint8 *stream, int len) {
     (void)userdata;//UNUSED
-    int32_t volscale1 = (int32_t)(mixer.mastervol[0] * (1 << MIXER_VOLSHIFT));
-    int32_t volscale2 = (int32_t)(mixer.mastervol[1] * (1 << MIXER_VOLSHIFT));
-    Bitu need = (Bitu)len/MIXER_SSIZE;
-    int16_t *output = (int16_t*)stream;
-    int remains;
+    const Bitu frame_size = mixer.output_float ? (sizeof(float) * 2) : (sizeof(int16_t) * 2);
+    Bitu need = (Bitu)len/frame_size;
+    uint8_t *output = (uint8_t*)stream;
+    uint32_t tail = mixer_ring.tail.load(std::memory_order_relaxed);
+    uint32_t avail = mixer_ring.head.load(std::memory_order_acquire) - tail;
 
-    if (mixer.mute) {
-        if ((CaptureState & (CAPTURE_WAVE|CAPTURE_VIDEO|CAPTURE_MULTITRACK_WAVE)) != 0)
-            mixer.work_out = mixer.work_in;
-        else
-            mixer.work_out = mixer.work_in = 0;
-    }
+    /* how far this callback is from one block period after the last, smoothed over 16 callbacks */
+    {
+        static std::chrono::steady_clock::time_point last;
+        static bool seen = false;
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        if (seen && mixer.freq != 0) {
+            const int64_t interval = (int64_t)std::chrono::duration_cast<std::chrono::microseconds>(now - last).count();
+            int64_t dev = interval - (int64_t)(((uint64_t)need * 1000000u) / mixer.freq);
+            if (dev < 0) dev = -dev;
 
-    if (mixer.prebuffer_wait) {
-        remains = (int)mixer.work_in - (int)mixer.work_out;
-        if (remains < 0) remains += (int)mixer.work_wrap;
-        if (remains < 0) remains = 0;
+            const int64_t j = (int64_t)mixer_ring.jitter_us.load(std::memory_order_relaxed);
+            mixer_ring.jitter_us.store((uint32_t)(j + ((dev - j) / 16)),std::memory_order_relaxed);
+        }
+        last = now;
+        seen = true;
+    }
 
-        if ((unsigned int)remains >= mixer.prebuffer_samples)
-            mixer.prebuffer_wait = false;
+    if (mixer.mute) {
+        tail += avail;
+        avail = 0;
     }
 
+    if (mixer.prebuffer_wait && avail >= mixer_ring.prebuffer.load(std::memory_order_relaxed))
+        mixer.prebuffer_wait = false;
+
     if (!mixer.prebuffer_wait && !mixer.mute) {
-        int32_t *in = &mixer.work[mixer.work_out][0];
-        while (need > 0) {
-            if (mixer.work_out == mixer.work_in) break;
-            *output++ = MIXER_CLIP((((int64_t)(*in++)) * (int64_t)volscale1) >> (MIXER_VOLSHIFT + MIXER_VOLSHIFT));
-            *output++ = MIXER_CLIP((((int64_t)(*in++)) * (int64_t)volscale2) >> (MIXER_VOLSHIFT + MIXER_VOLSHIFT));
-            mixer.work_out++;
-            if (mixer.work_out >= mixer.work_wrap) {
-                mixer.work_out = 0;
-                in = &mixer.work[mixer.work_out][0];
-            }
-            need--;
+        /* convert in at most two contiguous runs, up to the end of the ring and then from the start */
+        while (need > 0 && avail > 0) {
+            const uint32_t pos = tail & MIXER_BUFMASK;
+            Bitu n = MIXER_BUFSIZE - pos;
+            if (n > avail) n = avail;
+            if (n > need) n = need;
+
+            if (mixer.output_float)
+                MIXER_ToF32((float*)output,&mixer_ring.frames[pos][0],n,mixer.mastervol[0],mixer.mastervol[1]);
+            else
+                MIXER_ToS16((int16_t*)output,&mixer_ring.frames[pos][0],n,mixer.mastervol[0],mixer.mastervol[1]);
+            output += n * frame_size;
+            need -= n;
+            avail -= (uint32_t)n;
+            tail += (uint32_t)n;
         }
+
+        if (need > 0) mixer_ring.underruns.fetch_add(1,std::memory_order_relaxed);
     }
 
-    if (need > 0)
-        mixer.prebuffer_wait = true;
+    mixer_ring.tail.store(tail,std::memory_order_release);
 
-    while (need > 0) {
-        *output++ = 0;
-        *output++ = 0;
-        need--;
+    if (need > 0) {
+        mixer.prebuffer_wait = true;
+        memset(output,0,need * frame_size);
     }
+}
 
-    remains = (int)mixer.work_in - (int)mixer.work_out;
-    if (remains < 0) remains += (int)mixer.work_wrap;
-
-    if ((unsigned long)remains >= (mixer.blocksize*2UL)) {
-        /* drop some samples to keep time */
-        unsigned int drop;
+/* Change the device block size for adaptive buffering. The ring and everything in it stays, the
+ * callback is simply not running while the device is closed. SDL 1.x can only have one audio
+ * device open for the life of the program, so there the block size stays as it is. */
+static bool MIXER_ReopenDevice(uint32_t blocksize) {
+#ifdef C_SDL2
+    SDL_AudioSpec spec,obtained;
 
-        if ((unsigned long)remains >= (mixer.blocksize*3UL)) // hard drop
-            drop = ((unsigned int)remains - (unsigned int)(mixer.blocksize));
-        else // subtle drop
-            drop = (((unsigned int)remains - (unsigned int)(mixer.blocksize*2)) / 50U) + 1;
+    if (SDL2_AudioDevice == 0) return false;
 
-        while (drop > 0) {
-            mixer.work_out++;
-            if (mixer.work_out >= mixer.work_wrap) mixer.work_out = 0;
-            drop--;
+    memset(&spec,0,sizeof(spec));
+    spec.freq=(int)mixer.freq;
+    spec.format=mixer.output_float ? AUDIO_F32SYS : AUDIO_S16SYS;
+    spec.channels=2;
+    spec.callback=MIXER_CallBack;
+    spec.userdata=NULL;
+    spec.samples=(Uint16)blocksize;
+
+    SDL_CloseAudioDevice(SDL2_AudioDevice);
+    SDL2_AudioDevice = SDL_OpenAudioDevice(NULL, 0, &spec, &obtained, SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+    if (SDL2_AudioDevice == 0) {
+        /* try to get the old block size back, else carry on without sound */
+        spec.samples=(Uint16)mixer.blocksize;
+        SDL2_AudioDevice = SDL_OpenAudioDevice(NULL, 0, &spec, &obtained, SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+        if (SDL2_AudioDevice == 0) {
+            LOG(LOG_MISC,LOG_WARN)("MIXER:Can't reopen audio: %s , running in nosound mode.",SDL_GetError());
+            mixer.nosound = true;
+            mixer_adapt.enabled = false;
+            return false;
         }
     }
+
+    mixer.blocksize=obtained.samples;
+    SDL_PauseAudioDevice(SDL2_AudioDevice, 0);
+    return true;
+#else
+    (void)blocksize;
+    return false;
+#endif
 }
 
 std::string mixerinfo() {
@@ -1070,12 +1513,22 @@ void MIXER_Init() {
     mixer.nosound=section->Get_bool("nosound");
     mixer.blocksize=(unsigned int)section->Get_int("blocksize");
     mixer.swapstereo=section->Get_bool("swapstereo");
+    mixer.output_float=false;
     mixer.sampleaccurate=section->Get_bool("sample accurate");
+    {
+        const std::string r = section->Get_string("resampler");
+
+        if (r == "fast") mixer.resampler = MIXER_RESAMPLER_FAST;
+        else if (r == "medium") mixer.resampler = MIXER_RESAMPLER_MEDIUM;
+        else if (r == "high") mixer.resampler = MIXER_RESAMPLER_HIGH;
+        else mixer.resampler = MIXER_RESAMPLER_LINEAR;
+    }
     mixer.mute=false;
     if (control->opt_silent) mixer.nosound = true;
+    /* unthrottled output=null runs faster than any sound device plays */
+    if (OUTPUT_NULL_Unthrottled()) mixer.nosound = true;
 
     /* Initialize the internal stuff */
-    mixer.prebuffer_samples=0;
     mixer.prebuffer_wait=true;
     mixer.channels = nullptr;
     mixer.pos=0;
@@ -1091,7 +1544,11 @@ void MIXER_Init() {
     SDL_AudioSpec obtained;
 
     spec.freq=(int)mixer.freq;
+#ifdef C_SDL2
+    spec.format=AUDIO_F32SYS;
+#else
     spec.format=AUDIO_S16SYS;
+#endif
     spec.channels=2;
     spec.callback=MIXER_CallBack;
     spec.userdata=NULL;
@@ -1108,14 +1565,18 @@ void MIXER_Init() {
         LOG(LOG_MISC,LOG_DEBUG)("MIXER:No Sound Mode Selected.");
         TIMER_AddTickHandler(MIXER_Mix);
 #ifdef C_SDL2
-    } else if ((SDL2_AudioDevice=SDL_OpenAudioDevice(NULL, 0, &spec, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE)) == 0) {
+    } else if ((SDL2_AudioDevice=SDL_OpenAudioDevice(NULL, 0, &spec, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE | SDL_AUDIO_ALLOW_FORMAT_CHANGE)) == 0) {
 #else
     } else if (SDL_OpenAudio(&spec, &obtained) <0 ) {
 #endif
         mixer.nosound = true;
         LOG(LOG_MISC,LOG_DEBUG)("MIXER:Can't open audio: %s , running in nosound mode.",SDL_GetError());
         TIMER_AddTickHandler(MIXER_Mix);
+#ifdef C_SDL2
+    } else if (obtained.format != AUDIO_F32SYS && obtained.format != AUDIO_S16SYS) {
+#else
     } else if (obtained.format != AUDIO_S16SYS) {
+#endif
         mixer.nosound = true;
         LOG(LOG_MISC,LOG_DEBUG)("MIXER:Failed to get the sample format I wanted.");
         TIMER_AddTickHandler(MIXER_Mix);
@@ -1131,6 +1592,9 @@ void MIXER_Init() {
 
         mixer.freq=(unsigned int)obtained.freq;
         mixer.blocksize=obtained.samples;
+#ifdef C_SDL2
+        mixer.output_float=(obtained.format == AUDIO_F32SYS);
+#endif
         TIMER_AddTickHandler(MIXER_Mix);
         if (mixer.sampleaccurate) PIC_AddEvent(MIXER_MixSingle,1000.0 / mixer.freq);
 #ifdef C_SDL2
@@ -1141,18 +1605,18 @@ void MIXER_Init() {
     }
     mixer_start_pic_time = PIC_FullIndex();
     mixer_sample_counter = 0;
-    mixer.work_in = mixer.work_out = 0;
-    mixer.work_wrap = MIXER_BUFSIZE;
-    if (mixer.work_wrap <= mixer.blocksize) E_Exit("blocksize too large");
+    if (MIXER_BUFSIZE <= mixer.blocksize) E_Exit("blocksize too large");
 
     {
         int ms = section->Get_int("prebuffer");
 
         if (ms < 0) ms = 20;
 
-        mixer.prebuffer_samples = ((unsigned int)ms * (unsigned int)mixer.freq) / 1000u;
-        if (mixer.prebuffer_samples > (mixer.work_wrap / 2))
-            mixer.prebuffer_samples = (mixer.work_wrap / 2);
+        uint32_t prebuffer = ((unsigned int)ms * (unsigned int)mixer.freq) / 1000u;
+        if (prebuffer > (MIXER_BUFSIZE / 2))
+            prebuffer = (MIXER_BUFSIZE / 2);
+        mixer_ring.prebuffer.store(prebuffer,std::memory_order_relaxed);
+        mixer_adapt.enabled = section->Get_bool("adaptive buffering") && !mixer.nosound;
     }
 
     // how many samples per millisecond? compute as improper fraction (sample rate / 1000)
@@ -1179,7 +1643,7 @@ void MIXER_Init() {
         (unsigned int)mixer.samples_per_ms.w,
         (unsigned int)mixer.samples_per_ms.fn,
         (unsigned int)mixer.samples_per_ms.fd,
-        (unsigned int)mixer.prebuffer_samples);
+        (unsigned int)mixer_ring.prebuffer.load(std::memory_order_relaxed));
 
     AddVMEventFunction(VM_EVENT_DOS_INIT_KERNEL_READY,AddVMEventFunctionFuncPair(MIXER_DOS_Boot));
 
@@ -1210,6 +1674,7 @@ void MixerChannel::LoadState( std::istream& stream )
 	READ_POD( &volmul, volmul );
 	//READ_POD( &freq_add, freq_add );
 	READ_POD( &enabled, enabled );
+	UpdateVolume();
 
 	//********************************************
 	//********************************************
@@ -0,0 +1,370 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_MIXER_SIMD_H
+#define DOSBOX_MIXER_SIMD_H
+
+/* SIMD kernels for the mixer, all on interleaved stereo frames of float in 16-bit sample units:
+ *   ToS16       out = in * vol, rounded and clipped to int16_t
+ *   ToF32       out = in * vol / 32768, clipped to -1.0 ... 1.0
+ *   Accumulate  out += in, optionally with left and right swapped
+ *   Lowpass     the MixerChannel lowpass filter over a run of frames
+ *   Dot2        one polyphase filter row against the left and right input history
+ * A kernel returns how many frames it did, mixer.cpp does the rest one at a time.
+ * x86 picks AVX2 or SSE2 at runtime like render_simd.h, ARM uses NEON when the compiler
+ * targets it. */
+
+#if defined(_M_AMD64) || defined(__amd64__) || defined(__e2k__)
+# define MIXER_SIMD_X86 1
+# define mixer_sse2_available (1)
+# define mixer_avx2_available (avx2_available)
+#elif defined(__SSE__)
+# define MIXER_SIMD_X86 1
+# define mixer_sse2_available (sse2_available)
+# define mixer_avx2_available (avx2_available)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# define MIXER_SIMD_NEON 1
+#endif
+
+/* no AVX2 under Emscripten, see render_simd.h */
+#if defined(MIXER_SIMD_X86) && !defined(C_EMSCRIPTEN)
+# define MIXER_SIMD_AVX2 1
+#endif
+
+#if defined(MIXER_SIMD_X86)
+#include <immintrin.h>
+
+#ifdef __GNUC__
+__attribute__((__target__("sse2")))
+#endif
+static inline unsigned int MixerSIMD_ToS16_SSE2(int16_t *dst, const float *src, const unsigned int frames, const float vol0, const float vol1) {
+	const __m128 vol = _mm_setr_ps(vol0, vol1, vol0, vol1);
+	const __m128 lo = _mm_set1_ps((float)MIN_AUDIO), hi = _mm_set1_ps((float)MAX_AUDIO);
+	unsigned int done = 0;
+
+	for (;(done + 4) <= frames;done += 4) {
+		const __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + done * 2), vol), lo), hi);
+		const __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + done * 2 + 4), vol), lo), hi);
+		_mm_storeu_si128((__m128i*)(dst + done * 2), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+	}
+	return done;
+}
+
+#if defined(MIXER_SIMD_AVX2)
+#ifdef __GNUC__
+__attribute__((__target__("avx2")))
+#endif
+static inline unsigned int MixerSIMD_ToS16_AVX2(int16_t *dst, const float *src, const unsigned int frames, const float vol0, const float vol1) {
+	const __m256 vol = _mm256_setr_ps(vol0, vol1, vol0, vol1, vol0, vol1, vol0, vol1);
+	const __m256 lo = _mm256_set1_ps((float)MIN_AUDIO), hi = _mm256_set1_ps((float)MAX_AUDIO);
+	unsigned int done = 0;
+
+	for (;(done + 4) <= frames;done += 4) {
+		const __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + done * 2), vol), lo), hi);
+		const __m256i i = _mm256_cvtps_epi32(a);
+		_mm_storeu_si128((__m128i*)(dst + done * 2), _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1)));
+	}
+	return done;
+}
+#endif
+
+#ifdef __GNUC__
+__attribute__((__target__("sse2")))
+#endif
+static inline unsigned int MixerSIMD_ToF32_SSE2(float *dst, const float *src, const unsigned int frames, const float vol0, const float vol1) {
+	const __m128 vol = _mm_setr_ps(vol0 / 32768.0f, vol1 / 32768.0f, vol0 / 32768.0f, vol1 / 32768.0f);
+	const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+	unsigned int done = 0;
+
+	for (;(done + 2) <= frames;done += 2)
+		_mm_storeu_ps(dst + done * 2, _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + done * 2), vol), lo), hi));
+	return done;
+}
+
+#if defined(MIXER_SIMD_AVX2)
+#ifdef __GNUC__
+__attribute__((__target__("avx2")))
+#endif
+static inline unsigned int MixerSIMD_ToF32_AVX2(float *dst, const float *src, const unsigned int frames, const float vol0, const float vol1) {
+	const float v0 = vol0 / 32768.0f, v1 = vol1 / 32768.0f;
+	const __m256 vol = _mm256_setr_ps(v0, v1, v0, v1, v0, v1, v0, v1);
+	const __m256 lo = _mm256_set1_ps(-1.0f), hi = _mm256_set1_ps(1.0f);
+	unsigned int done = 0;
+
+	for (;(done + 4) <= frames;done += 4)
+		_mm256_storeu_ps(dst + done * 2, _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + done * 2), vol), lo), hi));
+	return done;
+}
+#endif
+
+#ifdef __GNUC__
+__attribute__((__target__("sse2")))
+#endif
+static inline unsigned int MixerSIMD_Accumulate_SSE2(float *dst, const float *src, const unsigned int frames, const bool swap) {
+	unsigned int done = 0;
+
+	for (;(done + 2) <= frames;done += 2) {
+		__m128 v = _mm_loadu_ps(src + done * 2);
+		if (swap) v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2,3,0,1));
+		_mm_storeu_ps(dst + done * 2, _mm_add_ps(_mm_loadu_ps(dst + done * 2), v));
+	}
+	return done;
+}
+
+#if defined(MIXER_SIMD_AVX2)
+#ifdef __GNUC__
+__attribute__((__target__("avx2")))
+#endif
+static inline unsigned int MixerSIMD_Accumulate_AVX2(float *dst, const float *src, const unsigned int frames, const bool swap) {
+	unsigned int done = 0;
+
+	for (;(done + 4) <= frames;done += 4) {
+		__m256 v = _mm256_loadu_ps(src + done * 2);
+		if (swap) v = _mm256_permute_ps(v, _MM_SHUFFLE(2,3,0,1));
+		_mm256_storeu_ps(dst + done * 2, _mm256_add_ps(_mm256_loadu_ps(dst + done * 2), v));
+	}
+	return done;
+}
+#endif
+
+/* lowpass[i] += (in - lowpass[i]) * alpha per order, both channels in the low half of one register */
+#ifdef __GNUC__
+__attribute__((__target__("sse2")))
+#endif
+static inline unsigned int MixerSIMD_Lowpass_SSE2(float (*buf)[2], const unsigned int frames, float (*state)[2], const unsigned int order, const float alpha) {
+	const __m128 a = _mm_set1_ps(alpha);
+	__m128 lp[LOWPASS_ORDER];
+
+	for (unsigned int i = 0;i < order;i++)
+		lp[i] = _mm_castpd_ps(_mm_load_sd((const double*)state[i]));
+
+	for (unsigned int f = 0;f < frames;f++) {
+		__m128 x = _mm_castpd_ps(_mm_load_sd((const double*)buf[f]));
+		for (unsigned int i = 0;i < order;i++) {
+			lp[i] = _mm_add_ps(lp[i], _mm_mul_ps(_mm_sub_ps(x, lp[i]), a));
+			x = lp[i];
+		}
+		_mm_store_sd((double*)buf[f], _mm_castps_pd(x));
+	}
+
+	for (unsigned int i = 0;i < order;i++)
+		_mm_store_sd((double*)state[i], _mm_castps_pd(lp[i]));
+	return frames;
+}
+#ifdef __GNUC__
+__attribute__((__target__("sse2")))
+#endif
+static inline unsigned int MixerSIMD_Dot2_SSE2(const float *h, const float *x0, const float *x1, const unsigned int taps, float &s0, float &s1) {
+	__m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+	unsigned int done = 0;
+
+	for (;(done + 4) <= taps;done += 4) {
+		const __m128 c = _mm_loadu_ps(h + done);
+		a0 = _mm_add_ps(a0, _mm_mul_ps(c, _mm_loadu_ps(x0 + done)));
+		a1 = _mm_add_ps(a1, _mm_mul_ps(c, _mm_loadu_ps(x1 + done)));
+	}
+
+	/* fold both sums at once: {a0 lo, a1 lo} + {a0 hi, a1 hi}, then the two halves of each */
+	const __m128 t = _mm_add_ps(_mm_movelh_ps(a0, a1), _mm_movehl_ps(a1, a0));
+	const __m128 r = _mm_add_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(3,3,1,1)));
+	s0 = _mm_cvtss_f32(r);
+	s1 = _mm_cvtss_f32(_mm_shuffle_ps(r, r, _MM_SHUFFLE(2,2,2,2)));
+	return done;
+}
+
+#if defined(MIXER_SIMD_AVX2)
+#ifdef __GNUC__
+__attribute__((__target__("avx2")))
+#endif
+static inline unsigned int MixerSIMD_Dot2_AVX2(const float *h, const float *x0, const float *x1, const unsigned int taps, float &s0, float &s1) {
+	__m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+	unsigned int done = 0;
+
+	for (;(done + 8) <= taps;done += 8) {
+		const __m256 c = _mm256_loadu_ps(h + done);
+		a0 = _mm256_add_ps(a0, _mm256_mul_ps(c, _mm256_loadu_ps(x0 + done)));
+		a1 = _mm256_add_ps(a1, _mm256_mul_ps(c, _mm256_loadu_ps(x1 + done)));
+	}
+
+	const __m128 b0 = _mm_add_ps(_mm256_castps256_ps128(a0), _mm256_extractf128_ps(a0, 1));
+	const __m128 b1 = _mm_add_ps(_mm256_castps256_ps128(a1), _mm256_extractf128_ps(a1, 1));
+	const __m128 t = _mm_add_ps(_mm_movelh_ps(b0, b1), _mm_movehl_ps(b1, b0));
+	const __m128 r = _mm_add_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(3,3,1,1)));
+	s0 = _mm_cvtss_f32(r);
+	s1 = _mm_cvtss_f32(_mm_shuffle_ps(r, r, _MM_SHUFFLE(2,2,2,2)));
+	return done;
+}
+#endif
+#endif // MIXER_SIMD_X86
+
+#if defined(MIXER_SIMD_NEON)
+#include <arm_neon.h>
+
+static inline unsigned int MixerSIMD_ToS16_NEON(int16_t *dst, const float *src, const unsigned int frames, const float vol0, const float vol1) {
+	const float volpair[4] = { vol0, vol1, vol0, vol1 };
+	const float32x4_t vol = vld1q_f32(volpair);
+	unsigned int done = 0;
+
+	/* the float to int conversion and the narrowing both saturate, so there is nothing to clip */
+	for (;(done + 4) <= frames;done += 4) {
+		const float32x4_t a = vmulq_f32(vld1q_f32(src + done * 2), vol);
+		const float32x4_t b = vmulq_f32(vld1q_f32(src + done * 2 + 4), vol);
+#if defined(__aarch64__)
+		const int32x4_t ia = vcvtnq_s32_f32(a), ib = vcvtnq_s32_f32(b);
+#else
+		const float32x4_t half = vdupq_n_f32(0.5f), nhalf = vdupq_n_f32(-0.5f), zero = vdupq_n_f32(0.0f);
+		const int32x4_t ia = vcvtq_s32_f32(vaddq_f32(a, vbslq_f32(vcltq_f32(a, zero), nhalf, half)));
+		const int32x4_t ib = vcvtq_s32_f32(vaddq_f32(b, vbslq_f32(vcltq_f32(b, zero), nhalf, half)));
+#endif
+		vst1q_s16(dst + done * 2, vcombine_s16(vqmovn_s32(ia), vqmovn_s32(ib)));
+	}
+	return done;
+}
+
+static inline unsigned int MixerSIMD_ToF32_NEON(float *dst, const float *src, const unsigned int frames, const float vol0, const float vol1) {
+	const float volpair[4] = { vol0 / 32768.0f, vol1 / 32768.0f, vol0 / 32768.0f, vol1 / 32768.0f };
+	const float32x4_t vol = vld1q_f32(volpair);
+	const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+	unsigned int done = 0;
+
+	for (;(done + 2) <= frames;done += 2)
+		vst1q_f32(dst + done * 2, vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(src + done * 2), vol), lo), hi));
+	return done;
+}
+
+static inline unsigned int MixerSIMD_Accumulate_NEON(float *dst, const float *src, const unsigned int frames, const bool swap) {
+	unsigned int done = 0;
+
+	for (;(done + 2) <= frames;done += 2) {
+		float32x4_t v = vld1q_f32(src + done * 2);
+		if (swap) v = vrev64q_f32(v);
+		vst1q_f32(dst + done * 2, vaddq_f32(vld1q_f32(dst + done * 2), v));
+	}
+	return done;
+}
+
+static inline unsigned int MixerSIMD_Lowpass_NEON(float (*buf)[2], const unsigned int frames, float (*state)[2], const unsigned int order, const float alpha) {
+	const float32x2_t a = vdup_n_f32(alpha);
+	float32x2_t lp[LOWPASS_ORDER];
+
+	for (unsigned int i = 0;i < order;i++)
+		lp[i] = vld1_f32(state[i]);
+
+	for (unsigned int f = 0;f < frames;f++) {
+		float32x2_t x = vld1_f32(buf[f]);
+		for (unsigned int i = 0;i < order;i++) {
+			lp[i] = vmla_f32(lp[i], vsub_f32(x, lp[i]), a);
+			x = lp[i];
+		}
+		vst1_f32(buf[f], x);
+	}
+
+	for (unsigned int i = 0;i < order;i++)
+		vst1_f32(state[i], lp[i]);
+	return frames;
+}
+static inline unsigned int MixerSIMD_Dot2_NEON(const float *h, const float *x0, const float *x1, const unsigned int taps, float &s0, float &s1) {
+	float32x4_t a0 = vdupq_n_f32(0.0f), a1 = vdupq_n_f32(0.0f);
+	unsigned int done = 0;
+
+	for (;(done + 4) <= taps;done += 4) {
+		const float32x4_t c = vld1q_f32(h + done);
+		a0 = vmlaq_f32(a0, c, vld1q_f32(x0 + done));
+		a1 = vmlaq_f32(a1, c, vld1q_f32(x1 + done));
+	}
+
+	const float32x2_t r = vpadd_f32(vadd_f32(vget_low_f32(a0), vget_high_f32(a0)), vadd_f32(vget_low_f32(a1), vget_high_f32(a1)));
+	s0 = vget_lane_f32(r, 0);
+	s1 = vget_lane_f32(r, 1);
+	return done;
+}
+#endif // MIXER_SIMD_NEON
+
+static inline unsigned int MixerSIMD_ToS16(int16_t *dst, const float *src, const unsigned int frames, const float vol0, const float vol1) {
+#if defined(MIXER_SIMD_X86)
+#if defined(MIXER_SIMD_AVX2)
+	if (mixer_avx2_available)
+		return MixerSIMD_ToS16_AVX2(dst, src, frames, vol0, vol1);
+#endif
+	if (mixer_sse2_available)
+		return MixerSIMD_ToS16_SSE2(dst, src, frames, vol0, vol1);
+#elif defined(MIXER_SIMD_NEON)
+	return MixerSIMD_ToS16_NEON(dst, src, frames, vol0, vol1);
+#endif
+	(void)dst; (void)src; (void)frames; (void)vol0; (void)vol1;
+	return 0;
+}
+
+static inline unsigned int MixerSIMD_ToF32(float *dst, const float *src, const unsigned int frames, const float vol0, const float vol1) {
+#if defined(MIXER_SIMD_X86)
+#if defined(MIXER_SIMD_AVX2)
+	if (mixer_avx2_available)
+		return MixerSIMD_ToF32_AVX2(dst, src, frames, vol0, vol1);
+#endif
+	if (mixer_sse2_available)
+		return MixerSIMD_ToF32_SSE2(dst, src, frames, vol0, vol1);
+#elif defined(MIXER_SIMD_NEON)
+	return MixerSIMD_ToF32_NEON(dst, src, frames, vol0, vol1);
+#endif
+	(void)dst; (void)src; (void)frames; (void)vol0; (void)vol1;
+	return 0;
+}
+
+static inline unsigned int MixerSIMD_Accumulate(float *dst, const float *src, const unsigned int frames, const bool swap) {
+#if defined(MIXER_SIMD_X86)
+#if defined(MIXER_SIMD_AVX2)
+	if (mixer_avx2_available)
+		return MixerSIMD_Accumulate_AVX2(dst, src, frames, swap);
+#endif
+	if (mixer_sse2_available)
+		return MixerSIMD_Accumulate_SSE2(dst, src, frames, swap);
+#elif defined(MIXER_SIMD_NEON)
+	return MixerSIMD_Accumulate_NEON(dst, src, frames, swap);
+#endif
+	(void)dst; (void)src; (void)frames; (void)swap;
+	return 0;
+}
+
+static inline unsigned int MixerSIMD_Dot2(const float *h, const float *x0, const float *x1, const unsigned int taps, float &s0, float &s1) {
+#if defined(MIXER_SIMD_X86)
+#if defined(MIXER_SIMD_AVX2)
+	if (mixer_avx2_available)
+		return MixerSIMD_Dot2_AVX2(h, x0, x1, taps, s0, s1);
+#endif
+	if (mixer_sse2_available)
+		return MixerSIMD_Dot2_SSE2(h, x0, x1, taps, s0, s1);
+#elif defined(MIXER_SIMD_NEON)
+	return MixerSIMD_Dot2_NEON(h, x0, x1, taps, s0, s1);
+#endif
+	(void)h; (void)x0; (void)x1; (void)taps;
+	s0 = s1 = 0.0f;
+	return 0;
+}
+
+static inline unsigned int MixerSIMD_Lowpass(float (*buf)[2], const unsigned int frames, float (*state)[2], const unsigned int order, const float alpha) {
+#if defined(MIXER_SIMD_X86)
+	if (mixer_sse2_available)
+		return MixerSIMD_Lowpass_SSE2(buf, frames, state, order, alpha);
+#elif defined(MIXER_SIMD_NEON)
+	return MixerSIMD_Lowpass_NEON(buf, frames, state, order, alpha);
+#endif
+	(void)buf; (void)frames; (void)state; (void)order; (void)alpha;
+	return 0;
+}
+
+#endif
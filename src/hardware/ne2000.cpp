@@ -1600,14 +1600,19 @@ public:
 		load_success = true;
 		// enabled?
 
-		if(!section->Get_bool("ne2000")) {
+		/* the "ne2000" setting enables networking, "nic type" picks the card (see rtl8139.cpp) */
+		if(!section->Get_bool("ne2000") || strcmp(section->Get_string("nic type"),"ne2000")) {
 			addne2k = false;
 			load_success = false;
 			return;
 		}
 
+		// mac address
+		uint8_t mac[6];
+		ETHERNET_ParseMacAddress(section->Get_string("macaddr"),mac);
+
 		const char* backendstring = section->Get_string("backend");
-		ethernet = OpenEthernetConnection(backendstring);
+		ethernet = OpenEthernetConnection(backendstring, section->Get_bool("backend thread"), mac);
 		if(!ethernet)
 		{
 			LOG_MSG("NE2000: Failed to open Ethernet backend %s", backendstring);
@@ -1629,28 +1634,6 @@ public:
 
         LOG_MSG("NE2000: Base=0x%x irq=%u",(unsigned int)base,(unsigned int)irq);
 
-		// mac address
-		const char* macstring=section->Get_string("macaddr");
-		unsigned int macint[6];
-		uint8_t mac[6];
-		if(!strcmp(macstring,"random")) {
-			mac[0]=((unsigned char)rand() & 0xFE) | 0x02; // unicast local admin
-			mac[1]= (unsigned char)rand();
-			mac[2]= (unsigned char)rand();
-			mac[3]= (unsigned char)rand();
-			mac[4]= (unsigned char)rand();
-			mac[5]= (unsigned char)rand();
-		}
-		else if(sscanf(macstring,"%02x:%02x:%02x:%02x:%02x:%02x",
-			&macint[0],&macint[1],&macint[2],&macint[3],&macint[4],&macint[5]) != 6) {
-			mac[0]=0xac;mac[1]=0xde;mac[2]=0x48;
-			mac[3]=0x88;mac[4]=0xbb;mac[5]=0xaa;
-		} else {
-			mac[0]=macint[0]; mac[1]=macint[1];
-			mac[2]=macint[2]; mac[3]=macint[3];
-			mac[4]=macint[4]; mac[5]=macint[5];
-		}
-
 		// create the bochs NIC class
 		theNE2kDevice = new bx_ne2k_c ();
 		memcpy(theNE2kDevice->s.physaddr, mac, 6);
@@ -546,24 +546,17 @@ static void OPL3_EnvelopeKeyOff(opl3_slot *slot, uint8_t type)
     Phase Generator
 */
 
-static void OPL3_PhaseGenerate(opl3_slot *slot)
+static uint32_t OPL3_PhaseStep(const opl3_slot *slot, uint8_t vibpos)
 {
-    opl3_chip *chip;
     uint16_t f_num;
     uint32_t basefreq;
-    uint8_t rm_xor, n_bit;
-    uint32_t noise;
-    uint16_t phase;
 
-    chip = slot->chip;
     f_num = slot->channel->f_num;
     if (slot->reg_vib)
     {
         int8_t range;
-        uint8_t vibpos;
 
         range = (f_num >> 7) & 7;
-        vibpos = slot->chip->vibpos;
 
         if (!(vibpos & 3))
         {
@@ -582,14 +575,24 @@ static void OPL3_PhaseGenerate(opl3_slot *slot)
         f_num += range;
     }
     basefreq = (f_num << slot->channel->block) >> 1;
-    phase = (uint16_t)(slot->pg_phase >> 9);
-    if (slot->pg_reset)
-    {
-        slot->pg_phase = 0;
-    }
-    slot->pg_phase += (basefreq * mt[slot->reg_mult]) >> 1;
+    return (basefreq * mt[slot->reg_mult]) >> 1;
+}
+
+static uint32_t OPL3_NoiseStep(uint32_t noise)
+{
+    uint8_t n_bit;
+
+    n_bit = ((noise >> 14) ^ noise) & 0x01;
+    return (noise >> 1) | (n_bit << 22);
+}
+
+static void OPL3_PhaseRhythm(opl3_slot *slot, uint16_t phase, uint32_t noise)
+{
+    opl3_chip *chip;
+    uint8_t rm_xor;
+
+    chip = slot->chip;
     /* Rhythm mode */
-    noise = chip->noise;
     slot->pg_phase_out = phase;
     if (slot->slot_num == 13) /* hh */
     {
@@ -632,8 +635,22 @@ static void OPL3_PhaseGenerate(opl3_slot *slot)
             break;
         }
     }
-    n_bit = ((noise >> 14) ^ noise) & 0x01;
-    chip->noise = (noise >> 1) | (n_bit << 22);
+}
+
+static void OPL3_PhaseGenerate(opl3_slot *slot)
+{
+    opl3_chip *chip;
+    uint16_t phase;
+
+    chip = slot->chip;
+    phase = (uint16_t)(slot->pg_phase >> 9);
+    if (slot->pg_reset)
+    {
+        slot->pg_phase = 0;
+    }
+    slot->pg_phase += OPL3_PhaseStep(slot, chip->vibpos);
+    OPL3_PhaseRhythm(slot, phase, chip->noise);
+    chip->noise = OPL3_NoiseStep(chip->noise);
 }
 
 /*
@@ -1109,27 +1126,13 @@ static void OPL3_ProcessSlot(opl3_slot *slot)
     OPL3_SlotGenerate(slot);
 }
 
-inline void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4)
+static void OPL3_MixChannels(opl3_chip *chip, uint8_t right)
 {
     opl3_channel *channel;
-    opl3_writebuf *writebuf;
     int16_t **out;
     int32_t mix[2];
     uint8_t ii;
     int16_t accm;
-    uint8_t shift = 0;
-
-    buf4[1] = OPL3_ClipSample(chip->mixbuff[1]);
-    buf4[3] = OPL3_ClipSample(chip->mixbuff[3]);
-
-#if OPL_QUIRK_CHANNELSAMPLEDELAY
-    for (ii = 0; ii < 15; ii++)
-#else
-    for (ii = 0; ii < 36; ii++)
-#endif
-    {
-        OPL3_ProcessSlot(&chip->slot[ii]);
-    }
 
     mix[0] = mix[1] = 0;
     for (ii = 0; ii < 18; ii++)
@@ -1138,54 +1141,19 @@ inline void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4)
         out = channel->out;
         accm = *out[0] + *out[1] + *out[2] + *out[3];
 #if OPL_ENABLE_STEREOEXT
-        mix[0] += (int16_t)((accm * channel->leftpan) >> 16);
+        mix[0] += (int16_t)((accm * (right ? channel->rightpan : channel->leftpan)) >> 16);
 #else
-        mix[0] += (int16_t)(accm & channel->cha);
-#endif
-        mix[1] += (int16_t)(accm & channel->chc);
-    }
-    chip->mixbuff[0] = mix[0];
-    chip->mixbuff[2] = mix[1];
-
-#if OPL_QUIRK_CHANNELSAMPLEDELAY
-    for (ii = 15; ii < 18; ii++)
-    {
-        OPL3_ProcessSlot(&chip->slot[ii]);
-    }
+        mix[0] += (int16_t)(accm & (right ? channel->chb : channel->cha));
 #endif
-
-    buf4[0] = OPL3_ClipSample(chip->mixbuff[0]);
-    buf4[2] = OPL3_ClipSample(chip->mixbuff[2]);
-
-#if OPL_QUIRK_CHANNELSAMPLEDELAY
-    for (ii = 18; ii < 33; ii++)
-    {
-        OPL3_ProcessSlot(&chip->slot[ii]);
-    }
-#endif
-
-    mix[0] = mix[1] = 0;
-    for (ii = 0; ii < 18; ii++)
-    {
-        channel = &chip->channel[ii];
-        out = channel->out;
-        accm = *out[0] + *out[1] + *out[2] + *out[3];
-#if OPL_ENABLE_STEREOEXT
-        mix[0] += (int16_t)((accm * channel->rightpan) >> 16);
-#else
-        mix[0] += (int16_t)(accm & channel->chb);
- #endif
-        mix[1] += (int16_t)(accm & channel->chd);
+        mix[1] += (int16_t)(accm & (right ? channel->chd : channel->chc));
     }
-    chip->mixbuff[1] = mix[0];
-    chip->mixbuff[3] = mix[1];
+    chip->mixbuff[right] = mix[0];
+    chip->mixbuff[right + 2] = mix[1];
+}
 
-#if OPL_QUIRK_CHANNELSAMPLEDELAY
-    for (ii = 33; ii < 36; ii++)
-    {
-        OPL3_ProcessSlot(&chip->slot[ii]);
-    }
-#endif
+static void OPL3_AdvanceTimers(opl3_chip *chip)
+{
+    uint8_t shift = 0;
 
     if ((chip->timer & 0x3f) == 0x3f)
     {
@@ -1239,6 +1207,11 @@ inline void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4)
     }
 
     chip->eg_state ^= 1;
+}
+
+static void OPL3_ProcessWrites(opl3_chip *chip)
+{
+    opl3_writebuf *writebuf;
 
     while ((writebuf = &chip->writebuf[chip->writebuf_cur]), writebuf->time <= chip->writebuf_samplecnt)
     {
@@ -1253,6 +1226,54 @@ inline void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4)
     chip->writebuf_samplecnt++;
 }
 
+inline void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4)
+{
+    uint8_t ii;
+
+    buf4[1] = OPL3_ClipSample(chip->mixbuff[1]);
+    buf4[3] = OPL3_ClipSample(chip->mixbuff[3]);
+
+#if OPL_QUIRK_CHANNELSAMPLEDELAY
+    for (ii = 0; ii < 15; ii++)
+#else
+    for (ii = 0; ii < 36; ii++)
+#endif
+    {
+        OPL3_ProcessSlot(&chip->slot[ii]);
+    }
+
+    OPL3_MixChannels(chip, 0);
+
+#if OPL_QUIRK_CHANNELSAMPLEDELAY
+    for (ii = 15; ii < 18; ii++)
+    {
+        OPL3_ProcessSlot(&chip->slot[ii]);
+    }
+#endif
+
+    buf4[0] = OPL3_ClipSample(chip->mixbuff[0]);
+    buf4[2] = OPL3_ClipSample(chip->mixbuff[2]);
+
+#if OPL_QUIRK_CHANNELSAMPLEDELAY
+    for (ii = 18; ii < 33; ii++)
+    {
+        OPL3_ProcessSlot(&chip->slot[ii]);
+    }
+#endif
+
+    OPL3_MixChannels(chip, 1);
+
+#if OPL_QUIRK_CHANNELSAMPLEDELAY
+    for (ii = 33; ii < 36; ii++)
+    {
+        OPL3_ProcessSlot(&chip->slot[ii]);
+    }
+#endif
+
+    OPL3_AdvanceTimers(chip);
+    OPL3_ProcessWrites(chip);
+}
+
 void OPL3_Generate(opl3_chip *chip, int16_t *buf)
 {
     int16_t samples[4];
@@ -1502,30 +1523,426 @@ void OPL3_WriteRegBuffered(opl3_chip *chip, uint16_t reg, uint8_t v)
     chip->writebuf_last = (writebuf_last + 1) % OPL_WRITEBUF_SIZE;
 }
 
-void OPL3_Generate4ChStream(opl3_chip *chip, int16_t *sndptr1, int16_t *sndptr2, uint32_t numsamples)
+/*
+    Batched generation
+
+    Gives the same samples as calling OPL3_Generate4Ch once per sample, but works on a block
+    of samples at a time. The chip wide timers are stepped for the whole block first, then
+    each slot runs its envelope and phase over the block on its own (they only depend on the
+    slot's registers and those timers), and only the operator outputs and the mix, which
+    depend on each other, are left to go sample by sample. A block never runs past the sample
+    the next buffered register write is due on, so writes land exactly where they did.
+
+    A slot whose envelope can't move until a register changes (released to silence, or
+    holding at a zero rate) and whose phase isn't being reset steps at a fixed increment,
+    which the SIMD kernels below fill in several samples at a time.
+*/
+
+#define OPL_BATCH_SIZE 128
+
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64)
+#include <emmintrin.h>
+#define OPL_BATCH_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define OPL_BATCH_NEON 1
+#endif
+
+typedef struct _opl3_batch {
+    uint8_t tremolo[OPL_BATCH_SIZE];
+    uint8_t vibpos[OPL_BATCH_SIZE];
+    uint8_t eg_state[OPL_BATCH_SIZE];
+    uint8_t eg_add[OPL_BATCH_SIZE];
+    uint8_t eg_timer_lo[OPL_BATCH_SIZE];
+    uint8_t reset[OPL_BATCH_SIZE];
+    uint32_t noise[3][OPL_BATCH_SIZE]; /* as slots 13, 16 and 17 see it */
+    uint16_t eg_out[36][OPL_BATCH_SIZE];
+    uint16_t phase[36][OPL_BATCH_SIZE];
+} opl3_batch;
+
+static const uint8_t opl3_batch_notrem[OPL_BATCH_SIZE] = { 0 };
+
+/* dst[i] = base + trem[i] */
+static void OPL3_BatchEnvelope(uint16_t *dst, uint16_t base, const uint8_t *trem, uint32_t n)
 {
-    uint_fast32_t i;
-    int16_t samples[4];
+    uint32_t i = 0;
 
-    for(i = 0; i < numsamples; i++)
+#if OPL_BATCH_SSE2
+    const __m128i b = _mm_set1_epi16((short)base);
+    const __m128i z = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8)
     {
-        OPL3_Generate4ChResampled(chip, samples);
-        sndptr1[0] = samples[0];
-        sndptr1[1] = samples[1];
-        sndptr2[0] = samples[2];
-        sndptr2[1] = samples[3];
-        sndptr1 += 2;
-        sndptr2 += 2;
+        const __m128i t = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(trem + i)), z);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_add_epi16(b, t));
+    }
+#elif OPL_BATCH_NEON
+    const uint16x8_t b = vdupq_n_u16(base);
+    for (; i + 8 <= n; i += 8)
+    {
+        vst1q_u16(dst + i, vaddw_u8(b, vld1_u8(trem + i)));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        dst[i] = (uint16_t)(base + trem[i]);
     }
 }
 
-void OPL3_GenerateStream(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples)
+/* dst[i] = (phase + i * inc) >> 9, returns the phase after n steps */
+static uint32_t OPL3_BatchPhase(uint16_t *dst, uint32_t phase, uint32_t inc, uint32_t n)
 {
+    uint32_t i = 0;
+
+#if OPL_BATCH_SSE2
+    __m128i p0 = _mm_setr_epi32((int)phase, (int)(phase + inc), (int)(phase + inc * 2), (int)(phase + inc * 3));
+    __m128i p1 = _mm_add_epi32(p0, _mm_set1_epi32((int)(inc * 4)));
+    const __m128i step = _mm_set1_epi32((int)(inc * 8));
+    for (; i + 8 <= n; i += 8)
+    {
+        /* keep the low 16 bits sign extended so the saturating pack leaves them alone */
+        const __m128i a = _mm_srai_epi32(_mm_slli_epi32(_mm_srli_epi32(p0, 9), 16), 16);
+        const __m128i b = _mm_srai_epi32(_mm_slli_epi32(_mm_srli_epi32(p1, 9), 16), 16);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(a, b));
+        p0 = _mm_add_epi32(p0, step);
+        p1 = _mm_add_epi32(p1, step);
+    }
+    phase += inc * i;
+#elif OPL_BATCH_NEON
+    const uint32_t init[4] = { phase, phase + inc, phase + inc * 2, phase + inc * 3 };
+    uint32x4_t p0 = vld1q_u32(init);
+    uint32x4_t p1 = vaddq_u32(p0, vdupq_n_u32(inc * 4));
+    const uint32x4_t step = vdupq_n_u32(inc * 8);
+    for (; i + 8 <= n; i += 8)
+    {
+        vst1q_u16(dst + i, vcombine_u16(vmovn_u32(vshrq_n_u32(p0, 9)), vmovn_u32(vshrq_n_u32(p1, 9))));
+        p0 = vaddq_u32(p0, step);
+        p1 = vaddq_u32(p1, step);
+    }
+    phase += inc * i;
+#endif
+    for (; i < n; i++)
+    {
+        dst[i] = (uint16_t)(phase >> 9);
+        phase += inc;
+    }
+    return phase;
+}
+
+/* Would OPL3_EnvelopeCalc leave eg_rout, eg_gen and pg_reset as they are until a register changes? */
+static uint8_t OPL3_EnvelopeSteady(const opl3_slot *slot)
+{
+    uint8_t reg_rate;
+
+    if (slot->key)
+    {
+        switch (slot->eg_gen)
+        {
+        case envelope_gen_num_decay:
+            if ((slot->eg_rout >> 4) == slot->reg_sl)
+            {
+                return 0;
+            }
+            reg_rate = slot->reg_dr;
+            break;
+        case envelope_gen_num_sustain:
+            reg_rate = slot->reg_type ? 0 : slot->reg_rr;
+            break;
+        default: /* attack, or a release about to restart it */
+            return 0;
+        }
+    }
+    else
+    {
+        if (slot->eg_gen != envelope_gen_num_release)
+        {
+            return 0;
+        }
+        reg_rate = slot->reg_rr;
+    }
+    if (slot->eg_rout == 0x1ff)
+    {
+        return 1;
+    }
+    return reg_rate == 0 && (slot->eg_rout & 0x1f8) != 0x1f8;
+}
+
+static void OPL3_BatchTimers(opl3_chip *chip, opl3_batch *batch, uint32_t n)
+{
+    uint32_t i;
+    uint8_t ii;
+    uint32_t noise;
+
+    for (i = 0; i < n; i++)
+    {
+        batch->tremolo[i] = chip->tremolo;
+        batch->vibpos[i] = chip->vibpos;
+        batch->eg_state[i] = chip->eg_state;
+        batch->eg_add[i] = chip->eg_add;
+        batch->eg_timer_lo[i] = chip->eg_timer_lo;
+
+        /* every slot steps the noise generator once */
+        noise = chip->noise;
+        for (ii = 0; ii < 36; ii++)
+        {
+            if (ii == 13)
+            {
+                batch->noise[0][i] = noise;
+            }
+            else if (ii == 16)
+            {
+                batch->noise[1][i] = noise;
+            }
+            else if (ii == 17)
+            {
+                batch->noise[2][i] = noise;
+            }
+            noise = OPL3_NoiseStep(noise);
+        }
+        chip->noise = noise;
+
+        OPL3_AdvanceTimers(chip);
+    }
+}
+
+static void OPL3_BatchSlot(opl3_chip *chip, opl3_slot *slot, opl3_batch *batch, uint32_t n)
+{
+    uint16_t *eg_out = batch->eg_out[slot->slot_num];
+    uint16_t *phase = batch->phase[slot->slot_num];
+    const uint8_t *trem = (slot->trem == &chip->tremolo) ? batch->tremolo : opl3_batch_notrem;
+    uint8_t resets = 0;
+    uint32_t i, j;
+
+    if (OPL3_EnvelopeSteady(slot))
+    {
+        OPL3_BatchEnvelope(eg_out, (uint16_t)(slot->eg_rout + (slot->reg_tl << 2)
+                           + (slot->eg_ksl >> kslshift[slot->reg_ksl])), trem, n);
+        slot->pg_reset = 0;
+    }
+    else
+    {
+        /* OPL3_EnvelopeCalc reads the timers from the chip, give it the ones of each sample */
+        for (i = 0; i < n; i++)
+        {
+            chip->tremolo = batch->tremolo[i];
+            chip->eg_state = batch->eg_state[i];
+            chip->eg_add = batch->eg_add[i];
+            chip->eg_timer_lo = batch->eg_timer_lo[i];
+            OPL3_EnvelopeCalc(slot);
+            eg_out[i] = slot->eg_out;
+            batch->reset[i] = (uint8_t)slot->pg_reset;
+            resets |= batch->reset[i];
+        }
+    }
+
+    if (resets)
+    {
+        for (i = 0; i < n; i++)
+        {
+            phase[i] = (uint16_t)(slot->pg_phase >> 9);
+            if (batch->reset[i])
+            {
+                slot->pg_phase = 0;
+            }
+            slot->pg_phase += OPL3_PhaseStep(slot, batch->vibpos[i]);
+        }
+    }
+    else if (!slot->reg_vib)
+    {
+        slot->pg_phase = OPL3_BatchPhase(phase, slot->pg_phase, OPL3_PhaseStep(slot, 0), n);
+    }
+    else
+    {
+        /* vibrato only moves every 1024 samples */
+        for (i = 0; i < n; i = j)
+        {
+            for (j = i + 1; j < n && batch->vibpos[j] == batch->vibpos[i]; j++)
+            {
+            }
+            slot->pg_phase = OPL3_BatchPhase(phase + i, slot->pg_phase,
+                                             OPL3_PhaseStep(slot, batch->vibpos[i]), j - i);
+        }
+    }
+}
+
+static void OPL3_BatchOutput(opl3_chip *chip, const opl3_batch *batch, uint32_t i, uint8_t first, uint8_t last)
+{
+    opl3_slot *slot;
+    uint8_t ii;
+
+    for (ii = first; ii < last; ii++)
+    {
+        slot = &chip->slot[ii];
+        OPL3_SlotCalcFB(slot);
+        slot->eg_out = batch->eg_out[ii][i];
+        switch (ii)
+        {
+        case 13:
+            OPL3_PhaseRhythm(slot, batch->phase[ii][i], batch->noise[0][i]);
+            break;
+        case 16:
+            OPL3_PhaseRhythm(slot, batch->phase[ii][i], batch->noise[1][i]);
+            break;
+        case 17:
+            OPL3_PhaseRhythm(slot, batch->phase[ii][i], batch->noise[2][i]);
+            break;
+        default:
+            slot->pg_phase_out = batch->phase[ii][i];
+            break;
+        }
+        OPL3_SlotGenerate(slot);
+    }
+}
+
+static uint32_t OPL3_GenerateBlock(opl3_chip *chip, int16_t *buf4, uint32_t numsamples)
+{
+    opl3_batch batch;
+    opl3_writebuf *writebuf;
+    uint8_t tremolo, eg_state, eg_add, eg_timer_lo;
+    uint32_t i;
+    uint8_t ii;
+
+    if (numsamples > OPL_BATCH_SIZE)
+    {
+        numsamples = OPL_BATCH_SIZE;
+    }
+    /* stop on the sample that applies the next register write */
+    writebuf = &chip->writebuf[chip->writebuf_cur];
+    if (writebuf->reg & 0x200)
+    {
+        if (writebuf->time <= chip->writebuf_samplecnt)
+        {
+            numsamples = 1;
+        }
+        else if (writebuf->time - chip->writebuf_samplecnt < numsamples)
+        {
+            numsamples = (uint32_t)(writebuf->time - chip->writebuf_samplecnt) + 1;
+        }
+    }
+
+    OPL3_BatchTimers(chip, &batch, numsamples);
+
+    tremolo = chip->tremolo;
+    eg_state = chip->eg_state;
+    eg_add = chip->eg_add;
+    eg_timer_lo = chip->eg_timer_lo;
+    for (ii = 0; ii < 36; ii++)
+    {
+        OPL3_BatchSlot(chip, &chip->slot[ii], &batch, numsamples);
+    }
+    chip->tremolo = tremolo;
+    chip->eg_state = eg_state;
+    chip->eg_add = eg_add;
+    chip->eg_timer_lo = eg_timer_lo;
+
+    for (i = 0; i < numsamples; i++, buf4 += 4)
+    {
+        buf4[1] = OPL3_ClipSample(chip->mixbuff[1]);
+        buf4[3] = OPL3_ClipSample(chip->mixbuff[3]);
+#if OPL_QUIRK_CHANNELSAMPLEDELAY
+        OPL3_BatchOutput(chip, &batch, i, 0, 15);
+#else
+        OPL3_BatchOutput(chip, &batch, i, 0, 36);
+#endif
+        OPL3_MixChannels(chip, 0);
+#if OPL_QUIRK_CHANNELSAMPLEDELAY
+        OPL3_BatchOutput(chip, &batch, i, 15, 18);
+#endif
+        buf4[0] = OPL3_ClipSample(chip->mixbuff[0]);
+        buf4[2] = OPL3_ClipSample(chip->mixbuff[2]);
+#if OPL_QUIRK_CHANNELSAMPLEDELAY
+        OPL3_BatchOutput(chip, &batch, i, 18, 33);
+#endif
+        OPL3_MixChannels(chip, 1);
+#if OPL_QUIRK_CHANNELSAMPLEDELAY
+        OPL3_BatchOutput(chip, &batch, i, 33, 36);
+#endif
+    }
+
+    chip->writebuf_samplecnt += numsamples - 1;
+    OPL3_ProcessWrites(chip);
+    return numsamples;
+}
+
+void OPL3_Generate4ChBatch(opl3_chip *chip, int16_t *buf4, uint32_t numsamples)
+{
+    uint32_t done;
+
+    while (numsamples > 0)
+    {
+        done = OPL3_GenerateBlock(chip, buf4, numsamples);
+        buf4 += done * 4;
+        numsamples -= done;
+    }
+}
+
+/* OPL3_Generate4ChResampled for a whole stream, sndptr2 may be NULL */
+static void OPL3_GenerateStreamResampled(opl3_chip *chip, int16_t *sndptr1, int16_t *sndptr2, uint32_t numsamples)
+{
+    int16_t native[OPL_BATCH_SIZE][4];
+    uint32_t need = 0, avail = 0, pos = 0;
+    int32_t samplecnt;
     uint_fast32_t i;
+    uint8_t ch;
 
-    for(i = 0; i < numsamples; i++)
+    /* count the chip samples this takes up front, running ahead would move later register writes */
+    samplecnt = chip->samplecnt;
+    for (i = 0; i < numsamples; i++)
     {
-        OPL3_GenerateResampled(chip, sndptr);
-        sndptr += 2;
+        while (samplecnt >= chip->rateratio)
+        {
+            samplecnt -= chip->rateratio;
+            need++;
+        }
+        samplecnt += 1 << RSM_FRAC;
+    }
+
+    for (i = 0; i < numsamples; i++)
+    {
+        while (chip->samplecnt >= chip->rateratio)
+        {
+            if (pos == avail)
+            {
+                avail = need < OPL_BATCH_SIZE ? need : OPL_BATCH_SIZE;
+                OPL3_Generate4ChBatch(chip, native[0], avail);
+                need -= avail;
+                pos = 0;
+            }
+            for (ch = 0; ch < 4; ch++)
+            {
+                chip->oldsamples[ch] = chip->samples[ch];
+                chip->samples[ch] = native[pos][ch];
+            }
+            pos++;
+            chip->samplecnt -= chip->rateratio;
+        }
+        for (ch = 0; ch < (sndptr2 ? 4 : 2); ch++)
+        {
+            const int16_t s = (int16_t)((chip->oldsamples[ch] * (chip->rateratio - chip->samplecnt)
+                                        + chip->samples[ch] * chip->samplecnt) / chip->rateratio);
+            if (ch < 2)
+            {
+                sndptr1[ch] = s;
+            }
+            else
+            {
+                sndptr2[ch - 2] = s;
+            }
+        }
+        chip->samplecnt += 1 << RSM_FRAC;
+        sndptr1 += 2;
+        if (sndptr2)
+        {
+            sndptr2 += 2;
+        }
     }
 }
+
+void OPL3_Generate4ChStream(opl3_chip *chip, int16_t *sndptr1, int16_t *sndptr2, uint32_t numsamples)
+{
+    OPL3_GenerateStreamResampled(chip, sndptr1, sndptr2, numsamples);
+}
+
+void OPL3_GenerateStream(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples)
+{
+    OPL3_GenerateStreamResampled(chip, sndptr, NULL, numsamples);
+}
@@ -22,6 +22,7 @@
 
 #include <math.h>
 #include <sys/stat.h>
+#include <zlib.h>
 
 #include "logging.h"
 #include "setup.h"
@@ -75,6 +76,44 @@ static bool confmultipageOutput, shellhide;
 static int printdbcs;
 static std::string actstd, acterr;
 
+// Encoding a page can take longer than printing the next one, but every queued page holds a
+// copy of the page surface
+#define MAX_QUEUED_PAGES 4
+
+// The standard 14 fonts need not be embedded. Courier, Helvetica and Times, each regular,
+// bold, italic and bold italic
+static const char* const pdfFontNames[12] =
+{
+	"Courier", "Courier-Bold", "Courier-Oblique", "Courier-BoldOblique",
+	"Helvetica", "Helvetica-Bold", "Helvetica-Oblique", "Helvetica-BoldOblique",
+	"Times-Roman", "Times-Bold", "Times-Italic", "Times-BoldItalic"
+};
+
+// A PDF document, written object by object as the pages come in. The page tree and the
+// cross-reference table follow once the document is done. Used by the worker thread only
+struct PrinterPDF
+{
+	FILE* f;
+	std::string fname;
+	double width, height;				// Media box (in points)
+	std::vector<long> offsets;			// File offset of each object, empty until the header is written
+	std::vector<uint32_t> kids;			// Page objects
+
+	PrinterPDF(FILE* f, const char* fname, double width, double height) : f(f), fname(fname), width(width), height(height) {}
+
+	void writeHeader();
+	void beginObject(uint32_t num);
+	uint32_t newObject();
+	uint32_t writeImage(SDL_Surface* surface);
+	void writePage(const std::vector<PrinterText>& text, SDL_Surface* surface);
+	void finish();
+};
+
+static bool isBlankSurface(SDL_Surface* surface);
+#ifdef C_LIBPNG
+static void writePNG(FILE* fp, SDL_Surface* surface);
+#endif
+
 void UpdateDefaultPrinterFont() {
     if (defaultPrinter!=NULL) {
         defaultPrinter->curFont = NULL;
@@ -144,6 +183,7 @@ CPrinter::CPrinter(uint16_t dpi, uint16_t width, uint16_t height, char* output,
 		this->dpi = dpi;
 		this->output = output;
 		this->multipageOutput = multipageOutput;
+		pdfOutput = strcasecmp(output, "pdf") == 0;
 
 		defaultPageWidth = (double)width / (double)10;
 		defaultPageHeight = (double)height / (double)10;
@@ -259,6 +299,7 @@ void CPrinter::resetPrinter()
 CPrinter::~CPrinter(void)
 {
 	finishMultipage();
+	pageTasks.wait();
 	if (page != NULL)
 	{
 		SDL_FreeSurface(page);
@@ -456,8 +497,8 @@ void CPrinter::updateFont()
 	}
     }
 
-	double horizPoints = 10.5;
-	double vertPoints = 10.5;
+	horizPoints = 10.5;
+	vertPoints = 10.5;
 
 	if (!multipoint)
     {
@@ -1370,6 +1411,7 @@ void CPrinter::newPage(bool save, bool resetx)
         timeout_dirty=false;
 	if (save)
 		outputPage();
+	pdfText.clear();
 	if (resetx)
         curX = leftMargin;
 	curY = topMargin;
@@ -1568,36 +1610,40 @@ void CPrinter::printChar(uint8_t ch, int box)
 	// Load the glyph 
 	FT_Load_Glyph(curFont, index, FT_LOAD_DEFAULT);
 
-	// Render a high-quality bitmap
-	FT_Render_Glyph(curFont->glyph, FT_RENDER_MODE_NORMAL);
+	// PDF output keeps the character as text where a standard font has it
+	if (dbcs || !pdfOutput || !addPDFText(printch))
+	{
+		// Render a high-quality bitmap
+		FT_Render_Glyph(curFont->glyph, FT_RENDER_MODE_NORMAL);
 
-	uint16_t penX = (uint16_t)(PIXX + curFont->glyph->bitmap_left);
-	uint16_t penY = (uint16_t)(PIXY - curFont->glyph->bitmap_top + curFont->size->metrics.ascender / 64);
+		uint16_t penX = (uint16_t)(PIXX + curFont->glyph->bitmap_left);
+		uint16_t penY = (uint16_t)(PIXY - curFont->glyph->bitmap_top + curFont->size->metrics.ascender / 64);
 
-	if (style & STYLE_SUBSCRIPT) penY += curFont->glyph->bitmap.rows / 2;
+		if (style & STYLE_SUBSCRIPT) penY += curFont->glyph->bitmap.rows / 2;
 
-	// Copy bitmap into page
-	SDL_LockSurface(page);
+		// Copy bitmap into page
+		SDL_LockSurface(page);
 
-	blitGlyph(curFont->glyph->bitmap, penX, penY, false);
-	blitGlyph(curFont->glyph->bitmap, penX+1, penY, true);
+		blitGlyph(curFont->glyph->bitmap, penX, penY, false);
+		blitGlyph(curFont->glyph->bitmap, penX+1, penY, true);
 
-	// Doublestrike => Print the glyph a second time one pixel below
-	if (style & STYLE_DOUBLESTRIKE)
-    {
-		blitGlyph(curFont->glyph->bitmap, penX, penY+1, true);
-		blitGlyph(curFont->glyph->bitmap, penX+1, penY+1, true);
-	}
+		// Doublestrike => Print the glyph a second time one pixel below
+		if (style & STYLE_DOUBLESTRIKE)
+		{
+			blitGlyph(curFont->glyph->bitmap, penX, penY+1, true);
+			blitGlyph(curFont->glyph->bitmap, penX+1, penY+1, true);
+		}
 
-	// Bold => Print the glyph a second time one pixel to the right
-	// or be a bit more bold...
-	if (style & STYLE_BOLD)
-    {
-		blitGlyph(curFont->glyph->bitmap, penX+1, penY, true);
-		blitGlyph(curFont->glyph->bitmap, penX+2, penY, true);
-		blitGlyph(curFont->glyph->bitmap, penX+3, penY, true);
+		// Bold => Print the glyph a second time one pixel to the right
+		// or be a bit more bold...
+		if (style & STYLE_BOLD)
+		{
+			blitGlyph(curFont->glyph->bitmap, penX+1, penY, true);
+			blitGlyph(curFont->glyph->bitmap, penX+2, penY, true);
+			blitGlyph(curFont->glyph->bitmap, penX+3, penY, true);
+		}
+		SDL_UnlockSurface(page);
 	}
-	SDL_UnlockSurface(page);
 
 	// For line printing
 	uint16_t lineStart = (uint16_t)PIXX;
@@ -1676,6 +1722,35 @@ void CPrinter::blitGlyph(FT_Bitmap bitmap, uint16_t destx, uint16_t desty, bool
 	}
 }
 
+bool CPrinter::addPDFText(uint16_t unicode)
+{
+	// The standard fonts use WinAnsi, which is Latin-1 apart from 80h-9Fh
+	if (unicode < 0x20 || (unicode >= 0x7F && unicode < 0xA0) || unicode > 0xFF) return false;
+	if (unicode == 0x20) return true;
+
+	// FT_Set_Char_Size got whole points
+	PrinterText t;
+	t.size = (double)(uint16_t)vertPoints;
+	if (t.size < 1) return false;
+	t.hscale = 100.0 * (double)(uint16_t)horizPoints / t.size;
+
+	t.x = curX;
+	t.y = curY + (double)(curFont->size->metrics.ascender / 64) / (double)dpi;
+	if (style & STYLE_SUBSCRIPT) t.y += t.size / 3 / 72;
+
+	uint8_t family = 2;
+	if (FT_IS_FIXED_WIDTH(curFont)) family = 0;
+	else if (LQtypeFace == sansserif || LQtypeFace == sansserifh) family = 1;
+	t.font = family * 4;
+	if (style & (STYLE_BOLD|STYLE_DOUBLESTRIKE)) t.font += 1;
+	if ((style & STYLE_ITALICS) || charTables[curCharTable] == 0) t.font += 2;
+
+	t.color = color;
+	t.ch = (uint8_t)unicode;
+	pdfText.push_back(t);
+	return true;
+}
+
 void CPrinter::drawLine(Bitu fromx, Bitu tox, Bitu y, bool broken)
 {
 	SDL_LockSurface(page);
@@ -1905,7 +1980,7 @@ void CPrinter::formFeed()
     box2=box3=false;
 
 	// Don't output blank pages
-	newPage(!isBlank(), true);
+	newPage(!isBlank() || !pdfText.empty(), true);
 	finishMultipage();
 }
 
@@ -2094,19 +2169,54 @@ void CPrinter::outputPage()
 		LOG_MSG("PRINTER: Direct printing not supported under this OS");
 #endif
 	}
+	else if (pdfOutput)
+	{
+		PrinterPDF* pdf = (PrinterPDF*)outputHandle;
+
+		// Create new file?
+		if (pdf == NULL)
+		{
+			if (!multipageOutput)
+				findNextName("page", ".pdf", &fname[0]);
+			else
+				findNextName("doc", ".pdf", &fname[0]);
+
+			FILE* pdffile = fopen(fname, "wb");
+			if (!pdffile)
+			{
+				LOG(LOG_MISC,LOG_ERROR)("PRINTER: Can't open file %s for printer output", fname);
+				return;
+			}
+			pdf = new PrinterPDF(pdffile, fname, defaultPageWidth * 72, defaultPageHeight * 72);
+		}
+
+		// The page surface only holds what was not kept as text: bit images, lines and
+		// characters the standard fonts do not have
+		SDL_Surface* surface = SDL_ConvertSurface(page, page->format, SDL_SWSURFACE);
+		std::vector<PrinterText> text;
+		text.swap(pdfText);
+		const bool close = !multipageOutput;
+
+		queuePage([this, pdf, surface, text, close]() {
+			pdf->writePage(text, surface);
+			if (surface) SDL_FreeSurface(surface);
+			if (close)
+			{
+				std::string name = pdf->fname;
+				pdf->finish();
+				delete pdf;
+				doAction(name.c_str());
+			}
+		});
+		outputHandle = close ? NULL : pdf;
+	}
 #ifdef C_LIBPNG
 	else if (strcasecmp(output, "png") == 0)
 	{
 		// Find a page that does not exists
 		findNextName("page", ".png", &fname[0]);
-	
-		png_structp png_ptr;
-		png_infop info_ptr;
-		png_bytep* row_pointers;
-		png_color palette[256];
-		Bitu i;
 
-		/* Open the actual file */
+		/* Open the actual file, which also keeps the name from being picked for the next page */
 		FILE* fp = fopen(fname,"wb");
 		if (!fp) 
 		{
@@ -2114,67 +2224,25 @@ void CPrinter::outputPage()
 			return;
 		}
 
-		/* First try to allocate the png structures */
-		png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-		if (!png_ptr) return;
-		info_ptr = png_create_info_struct(png_ptr);
-		if (!info_ptr)
-        {
-			png_destroy_write_struct(&png_ptr, (png_infopp)NULL);
-			return;
-		}
-
-		/* Finalize the initing of png library */
-		png_init_io(png_ptr, fp);
-		png_set_compression_level(png_ptr, Z_BEST_COMPRESSION);
-		
-		/* set other zlib parameters */
-		png_set_compression_mem_level(png_ptr, 8);
-		png_set_compression_strategy(png_ptr, Z_DEFAULT_STRATEGY);
-		png_set_compression_window_bits(png_ptr, 15);
-		png_set_compression_method(png_ptr, 8);
-		png_set_compression_buffer_size(png_ptr, 8192);
-		
-		png_set_IHDR(png_ptr, info_ptr, page->w, page->h,
-			8, PNG_COLOR_TYPE_PALETTE, PNG_INTERLACE_NONE,
-			PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-		for (i = 0; i < 256; i++) 
+		SDL_Surface* surface = SDL_ConvertSurface(page, page->format, SDL_SWSURFACE);
+		if (!surface)
 		{
-			palette[i].red = page->format->palette->colors[i].r;
-			palette[i].green = page->format->palette->colors[i].g;
-			palette[i].blue = page->format->palette->colors[i].b;
+			fclose(fp);
+			return;
 		}
-		png_set_PLTE(png_ptr, info_ptr, palette,256);
-		
-		SDL_LockSurface(page);
-
-		// Allocate an array of scanline pointers
-		row_pointers = (png_bytep*)malloc(page->h * sizeof(png_bytep));
-		for (i = 0; i < (Bitu)page->h; i++) 
-			row_pointers[i] = ((uint8_t*)page->pixels + (i * page->pitch));
 
-		// tell the png library what to encode.
-		png_set_rows(png_ptr, info_ptr, row_pointers);
-		
-		// Write image to file
-		png_write_png(png_ptr, info_ptr, 0, NULL);
-
-		SDL_UnlockSurface(page);
-		
-		/*close file*/
-		fclose(fp);
-	
-		/*Destroy PNG structs*/
-		png_destroy_write_struct(&png_ptr, &info_ptr);
-		
-		/*clean up dynamically allocated RAM.*/
-		free(row_pointers);
-		doAction(fname);
+		std::string name = fname;
+		queuePage([this, fp, surface, name]() {
+			writePNG(fp, surface);
+			SDL_FreeSurface(surface);
+			doAction(name.c_str());
+		});
 	}
 #endif
 	else if (strcasecmp(output, "ps") == 0)
 	{
 		FILE* psfile = NULL;
+		bool header = false;
 		
 		// Continue postscript file?
 		if (outputHandle != NULL)
@@ -2194,73 +2262,33 @@ void CPrinter::outputPage()
 				LOG(LOG_MISC,LOG_ERROR)("PRINTER: Can't open file %s for printer output", fname);
 				return;
 			}
-
-			// Print header
-			fprintf(psfile, "%%!PS-Adobe-3.0\n");
-			fprintf(psfile, "%%%%Pages: (atend)\n");
-			fprintf(psfile, "%%%%BoundingBox: 0 0 %i %i\n", (uint16_t)(defaultPageWidth * 72), (uint16_t)(defaultPageHeight * 72));
-			fprintf(psfile, "%%%%Creator: DOSBox-X Virtual Printer\n");
-			fprintf(psfile, "%%%%DocumentData: Clean7Bit\n");
-			fprintf(psfile, "%%%%LanguageLevel: 2\n");
-			fprintf(psfile, "%%%%EndComments\n");
+			header = true;
 			multiPageCounter = 1;
 		}
 
-		fprintf(psfile, "%%%%Page: %i %i\n", multiPageCounter, multiPageCounter);
-		fprintf(psfile, "%i %i scale\n", (uint16_t)(defaultPageWidth * 72), (uint16_t)(defaultPageHeight * 72));
-		fprintf(psfile, "%i %i 8 [%i 0 0 -%i 0 %i]\n", page->w, page->h, page->w, page->h, page->h);
-		fprintf(psfile, "currentfile\n");
-		fprintf(psfile, "/ASCII85Decode filter\n");
-		fprintf(psfile, "/RunLengthDecode filter\n");
-		fprintf(psfile, "image\n");
-
-		SDL_LockSurface(page);
-
-		uint32_t pix = 0;
-		uint32_t numpix = page->h * page->w;
-		ASCII85BufferPos = ASCII85CurCol = 0;
-
-		while (pix < numpix)
+		SDL_Surface* surface = SDL_ConvertSurface(page, page->format, SDL_SWSURFACE);
+		if (!surface)
 		{
-			// Compress data using RLE
-			if ((pix < numpix - 2) && (getPixel(pix) == getPixel(pix + 1)) && (getPixel(pix) == getPixel(pix + 2)))
-			{
-				// Found three or more pixels with the same color
-				uint8_t sameCount = 3;
-				uint8_t col = getPixel(pix);
-				while (sameCount < 128 && sameCount + pix < numpix && col == getPixel(pix + sameCount))
-					sameCount++;
+			if (header) fclose(psfile);
+			outputHandle = NULL;
+			return;
+		}
 
-				fprintASCII85(psfile, 257 - sameCount);
-				fprintASCII85(psfile, 255 - col);
+		const uint16_t pageNum = multiPageCounter;
+		const bool close = !multipageOutput;
+		std::string name = fname;
 
-				// Skip ahead
-				pix += sameCount;
-			}
-			else
+		queuePage([this, psfile, surface, pageNum, header, close, name]() {
+			writePSPage(psfile, surface, pageNum, header);
+			SDL_FreeSurface(surface);
+			if (close)
 			{
-				// Find end of heterogeneous area
-				uint8_t diffCount = 1;
-				while (
-                    diffCount < 128 && diffCount + pix < numpix && 
-					(
-				        (diffCount + pix < numpix - 2) || (getPixel(pix + diffCount) != getPixel(pix + diffCount+1)) || (getPixel(pix + diffCount) != getPixel(pix + diffCount+2))
-					)
-                ) diffCount++;
-
-				fprintASCII85(psfile, diffCount-1);
-				for (uint8_t i = 0; i < diffCount; i++)
-					fprintASCII85(psfile, 255 - getPixel(pix++));
+				fprintf(psfile, "%%%%Pages: 1\n");
+				fprintf(psfile, "%%%%EOF\n");
+				fclose(psfile);
+				doAction(name.c_str());
 			}
-		}
-
-		// Write EOD for RLE and ASCII85
-		fprintASCII85(psfile, 128);
-		fprintASCII85(psfile, 256);
-
-		SDL_UnlockSurface(page);
-
-		fprintf(psfile, "showpage\n");
+		});
 
 		if (multipageOutput)
 		{
@@ -2268,21 +2296,352 @@ void CPrinter::outputPage()
 			outputHandle = psfile;
 		}
 		else
-		{
-			fprintf(psfile, "%%%%Pages: 1\n");
-			fprintf(psfile, "%%%%EOF\n");
-			fclose(psfile);
 			outputHandle = NULL;
-			doAction(fname);
-		}
 	}
 	else
 	{	
 		// Find a page that does not exists
 		findNextName("page", ".bmp", &fname[0]);
-		SDL_SaveBMP(page, fname);
-		doAction(fname);
+
+		// Create the file now so that the next page does not pick the same name
+		FILE* fp = fopen(fname, "wb");
+		if (!fp)
+		{
+			LOG(LOG_MISC,LOG_ERROR)("PRINTER: Can't open file %s for printer output", fname);
+			return;
+		}
+		fclose(fp);
+
+		SDL_Surface* surface = SDL_ConvertSurface(page, page->format, SDL_SWSURFACE);
+		if (!surface) return;
+
+		std::string name = fname;
+		queuePage([this, surface, name]() {
+			SDL_SaveBMP(surface, name.c_str());
+			SDL_FreeSurface(surface);
+			doAction(name.c_str());
+		});
+	}
+}
+
+void CPrinter::queuePage(std::function<void()> job)
+{
+	std::unique_lock<std::mutex> guard(pageLock);
+
+	while (pageQueue.size() >= MAX_QUEUED_PAGES)
+	{
+		guard.unlock();
+		pageTasks.wait();
+		guard.lock();
+	}
+
+	pageQueue.push_back(std::move(job));
+	if (pageDraining) return;
+	pageDraining = true;
+	guard.unlock();
+
+	// One task at a time keeps the pages in order
+	pageTasks.run([this]() { drainPages(); });
+}
+
+void CPrinter::drainPages()
+{
+	std::unique_lock<std::mutex> guard(pageLock);
+
+	while (!pageQueue.empty())
+	{
+		std::function<void()> job = std::move(pageQueue.front());
+		pageQueue.pop_front();
+		guard.unlock();
+		job();
+		guard.lock();
+	}
+	pageDraining = false;
+}
+
+#ifdef C_LIBPNG
+static void writePNG(FILE* fp, SDL_Surface* surface)
+{
+	png_structp png_ptr;
+	png_infop info_ptr;
+	png_bytep* row_pointers;
+	png_color palette[256];
+	Bitu i;
+
+	/* First try to allocate the png structures */
+	png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+	if (!png_ptr)
+	{
+		fclose(fp);
+		return;
+	}
+	info_ptr = png_create_info_struct(png_ptr);
+	if (!info_ptr)
+	{
+		png_destroy_write_struct(&png_ptr, (png_infopp)NULL);
+		fclose(fp);
+		return;
+	}
+
+	/* Finalize the initing of png library */
+	png_init_io(png_ptr, fp);
+	png_set_compression_level(png_ptr, Z_BEST_COMPRESSION);
+	
+	/* set other zlib parameters */
+	png_set_compression_mem_level(png_ptr, 8);
+	png_set_compression_strategy(png_ptr, Z_DEFAULT_STRATEGY);
+	png_set_compression_window_bits(png_ptr, 15);
+	png_set_compression_method(png_ptr, 8);
+	png_set_compression_buffer_size(png_ptr, 8192);
+	
+	png_set_IHDR(png_ptr, info_ptr, surface->w, surface->h,
+		8, PNG_COLOR_TYPE_PALETTE, PNG_INTERLACE_NONE,
+		PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+	for (i = 0; i < 256; i++) 
+	{
+		palette[i].red = surface->format->palette->colors[i].r;
+		palette[i].green = surface->format->palette->colors[i].g;
+		palette[i].blue = surface->format->palette->colors[i].b;
+	}
+	png_set_PLTE(png_ptr, info_ptr, palette,256);
+
+	// Allocate an array of scanline pointers
+	row_pointers = (png_bytep*)malloc(surface->h * sizeof(png_bytep));
+	for (i = 0; i < (Bitu)surface->h; i++) 
+		row_pointers[i] = ((uint8_t*)surface->pixels + (i * surface->pitch));
+
+	// tell the png library what to encode.
+	png_set_rows(png_ptr, info_ptr, row_pointers);
+	
+	// Write image to file
+	png_write_png(png_ptr, info_ptr, 0, NULL);
+	
+	/*close file*/
+	fclose(fp);
+
+	/*Destroy PNG structs*/
+	png_destroy_write_struct(&png_ptr, &info_ptr);
+	
+	/*clean up dynamically allocated RAM.*/
+	free(row_pointers);
+}
+#endif
+
+void CPrinter::writePSPage(FILE* psfile, SDL_Surface* surface, uint16_t pageNum, bool header)
+{
+	if (header)
+	{
+		fprintf(psfile, "%%!PS-Adobe-3.0\n");
+		fprintf(psfile, "%%%%Pages: (atend)\n");
+		fprintf(psfile, "%%%%BoundingBox: 0 0 %i %i\n", (uint16_t)(defaultPageWidth * 72), (uint16_t)(defaultPageHeight * 72));
+		fprintf(psfile, "%%%%Creator: DOSBox-X Virtual Printer\n");
+		fprintf(psfile, "%%%%DocumentData: Clean7Bit\n");
+		fprintf(psfile, "%%%%LanguageLevel: 2\n");
+		fprintf(psfile, "%%%%EndComments\n");
+	}
+
+	fprintf(psfile, "%%%%Page: %i %i\n", pageNum, pageNum);
+	fprintf(psfile, "%i %i scale\n", (uint16_t)(defaultPageWidth * 72), (uint16_t)(defaultPageHeight * 72));
+	fprintf(psfile, "%i %i 8 [%i 0 0 -%i 0 %i]\n", surface->w, surface->h, surface->w, surface->h, surface->h);
+	fprintf(psfile, "currentfile\n");
+	fprintf(psfile, "/ASCII85Decode filter\n");
+	fprintf(psfile, "/RunLengthDecode filter\n");
+	fprintf(psfile, "image\n");
+
+	uint32_t pix = 0;
+	uint32_t numpix = surface->h * surface->w;
+	ASCII85BufferPos = ASCII85CurCol = 0;
+
+	while (pix < numpix)
+	{
+		// Compress data using RLE
+		if ((pix < numpix - 2) && (getPixel(surface, pix) == getPixel(surface, pix + 1)) && (getPixel(surface, pix) == getPixel(surface, pix + 2)))
+		{
+			// Found three or more pixels with the same color
+			uint8_t sameCount = 3;
+			uint8_t col = getPixel(surface, pix);
+			while (sameCount < 128 && sameCount + pix < numpix && col == getPixel(surface, pix + sameCount))
+				sameCount++;
+
+			fprintASCII85(psfile, 257 - sameCount);
+			fprintASCII85(psfile, 255 - col);
+
+			// Skip ahead
+			pix += sameCount;
+		}
+		else
+		{
+			// Find end of heterogeneous area
+			uint8_t diffCount = 1;
+			while (
+                diffCount < 128 && diffCount + pix < numpix && 
+				(
+			        (diffCount + pix < numpix - 2) || (getPixel(surface, pix + diffCount) != getPixel(surface, pix + diffCount+1)) || (getPixel(surface, pix + diffCount) != getPixel(surface, pix + diffCount+2))
+				)
+            ) diffCount++;
+
+			fprintASCII85(psfile, diffCount-1);
+			for (uint8_t i = 0; i < diffCount; i++)
+				fprintASCII85(psfile, 255 - getPixel(surface, pix++));
+		}
+	}
+
+	// Write EOD for RLE and ASCII85
+	fprintASCII85(psfile, 128);
+	fprintASCII85(psfile, 256);
+
+	fprintf(psfile, "showpage\n");
+}
+
+void PrinterPDF::writeHeader()
+{
+	fprintf(f, "%%PDF-1.4\n%%\xE2\xE3\xCF\xD3\n");
+
+	// 1 is the catalog and 2 the page tree, written last. 3 is the font resources
+	offsets.assign(4 + 12, 0);
+	for (uint32_t i = 0; i < 12; i++)
+	{
+		beginObject(4 + i);
+		fprintf(f, "<< /Type /Font /Subtype /Type1 /BaseFont /%s /Encoding /WinAnsiEncoding >>\nendobj\n", pdfFontNames[i]);
+	}
+	beginObject(3);
+	fprintf(f, "<<");
+	for (uint32_t i = 0; i < 12; i++)
+		fprintf(f, " /F%u %u 0 R", i + 1, 4 + i);
+	fprintf(f, " >>\nendobj\n");
+}
+
+void PrinterPDF::beginObject(uint32_t num)
+{
+	offsets[num] = ftell(f);
+	fprintf(f, "%u 0 obj\n", num);
+}
+
+uint32_t PrinterPDF::newObject()
+{
+	offsets.push_back(0);
+	beginObject((uint32_t)offsets.size() - 1);
+	return (uint32_t)offsets.size() - 1;
+}
+
+uint32_t PrinterPDF::writeImage(SDL_Surface* surface)
+{
+	std::vector<uint8_t> raw((size_t)surface->w * surface->h);
+	for (int y = 0; y < surface->h; y++)
+		memcpy(&raw[(size_t)y * surface->w], (uint8_t*)surface->pixels + y * surface->pitch, surface->w);
+
+	uLongf packedSize = compressBound((uLong)raw.size());
+	std::vector<uint8_t> packed(packedSize);
+	if (compress2(&packed[0], &packedSize, &raw[0], (uLong)raw.size(), Z_BEST_SPEED) != Z_OK)
+		return 0;
+
+	const uint32_t num = newObject();
+	fprintf(f, "<< /Type /XObject /Subtype /Image /Width %d /Height %d /ColorSpace [/Indexed /DeviceRGB 255 <", surface->w, surface->h);
+	for (int i = 0; i < 256; i++)
+	{
+		const SDL_Color& c = surface->format->palette->colors[i];
+		fprintf(f, "%02X%02X%02X", c.r, c.g, c.b);
+	}
+	fprintf(f, ">] /BitsPerComponent 8 /Filter /FlateDecode /Length %lu >>\nstream\n", (unsigned long)packedSize);
+	fwrite(&packed[0], 1, packedSize, f);
+	fprintf(f, "\nendstream\nendobj\n");
+	return num;
+}
+
+void PrinterPDF::writePage(const std::vector<PrinterText>& text, SDL_Surface* surface)
+{
+	if (offsets.empty()) writeHeader();
+
+	// The rest of the page goes below the text as one image
+	uint32_t image = 0;
+	if (surface != NULL && !isBlankSurface(surface)) image = writeImage(surface);
+
+	std::string content;
+	char buf[128];
+	if (image)
+	{
+		sprintf(buf, "q %.2f 0 0 %.2f 0 0 cm /Im%u Do Q\n", width, height, image);
+		content += buf;
+	}
+	if (!text.empty())
+	{
+		int font = -1, color = -1;
+		double size = -1, hscale = -1;
+
+		content += "BT\n";
+		for (const PrinterText& t : text)
+		{
+			if (t.font != font || t.size != size)
+			{
+				font = t.font;
+				size = t.size;
+				sprintf(buf, "/F%u %.2f Tf\n", t.font + 1, t.size);
+				content += buf;
+			}
+			if (t.hscale != hscale)
+			{
+				hscale = t.hscale;
+				sprintf(buf, "%.1f Tz\n", t.hscale);
+				content += buf;
+			}
+			if (t.color != color)
+			{
+				// The color bits take away magenta, cyan and yellow ink from white, see FillPalette
+				color = t.color;
+				const uint8_t ink = t.color >> 5;
+				sprintf(buf, "%u %u %u rg\n", (ink & 2) ? 0 : 1, (ink & 1) ? 0 : 1, (ink & 4) ? 0 : 1);
+				content += buf;
+			}
+			sprintf(buf, "1 0 0 1 %.2f %.2f Tm (", t.x * 72, height - t.y * 72);
+			content += buf;
+			if (t.ch == '(' || t.ch == ')' || t.ch == '\\')
+			{
+				content += '\\';
+				content += (char)t.ch;
+			}
+			else if (t.ch >= 0x80)
+			{
+				sprintf(buf, "\\%03o", t.ch);
+				content += buf;
+			}
+			else
+				content += (char)t.ch;
+			content += ") Tj\n";
+		}
+		content += "ET\n";
 	}
+
+	const uint32_t contents = newObject();
+	fprintf(f, "<< /Length %u >>\nstream\n", (unsigned int)content.size());
+	fwrite(content.data(), 1, content.size(), f);
+	fprintf(f, "\nendstream\nendobj\n");
+
+	kids.push_back(newObject());
+	fprintf(f, "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 %.2f %.2f] /Resources << /Font 3 0 R", width, height);
+	if (image) fprintf(f, " /XObject << /Im%u %u 0 R >>", image, image);
+	fprintf(f, " >> /Contents %u 0 R >>\nendobj\n", contents);
+}
+
+void PrinterPDF::finish()
+{
+	if (offsets.empty()) writeHeader();
+
+	beginObject(2);
+	fprintf(f, "<< /Type /Pages /Kids [");
+	for (uint32_t kid : kids)
+		fprintf(f, " %u 0 R", kid);
+	fprintf(f, " ] /Count %u >>\nendobj\n", (unsigned int)kids.size());
+
+	beginObject(1);
+	fprintf(f, "<< /Type /Catalog /Pages 2 0 R >>\nendobj\n");
+
+	const long xref = ftell(f);
+	fprintf(f, "xref\n0 %u\n", (unsigned int)offsets.size());
+	fprintf(f, "0000000000 65535 f \n");
+	for (size_t i = 1; i < offsets.size(); i++)
+		fprintf(f, "%010ld 00000 n \n", offsets[i]);
+	fprintf(f, "trailer\n<< /Size %u /Root 1 0 R >>\nstartxref\n%ld\n%%%%EOF\n", (unsigned int)offsets.size(), xref);
+	fclose(f);
 }
 
 void CPrinter::fprintASCII85(FILE* f, uint16_t b)
@@ -2358,9 +2717,20 @@ void CPrinter::finishMultipage()
 		if (strcasecmp(output, "ps") == 0)
 		{
 			FILE* psfile = (FILE*)outputHandle;
-			fprintf(psfile, "%%%%Pages: %i\n", multiPageCounter);
-			fprintf(psfile, "%%%%EOF\n");
-			fclose(psfile);
+			const uint16_t pages = multiPageCounter;
+			queuePage([psfile, pages]() {
+				fprintf(psfile, "%%%%Pages: %i\n", pages);
+				fprintf(psfile, "%%%%EOF\n");
+				fclose(psfile);
+			});
+		}
+		else if (pdfOutput)
+		{
+			PrinterPDF* pdf = (PrinterPDF*)outputHandle;
+			queuePage([pdf]() {
+				pdf->finish();
+				delete pdf;
+			});
 		}
 		else if (strcasecmp(output, "printer") == 0)
 		{
@@ -2372,25 +2742,33 @@ void CPrinter::finishMultipage()
 	}
 }
 
-bool CPrinter::isBlank()
+static bool isBlankSurface(SDL_Surface* surface)
 {
 	bool blank = true;
 
-	SDL_LockSurface(page);
+	SDL_LockSurface(surface);
 
-	for (uint16_t y = 0; y < page->h; y++)
-		for (uint16_t x = 0; x < page->w; x++)
-			if (*((uint8_t*)page->pixels + x + (y * page->pitch)) != 0)
+	for (uint16_t y = 0; y < surface->h && blank; y++)
+		for (uint16_t x = 0; x < surface->w; x++)
+			if (*((uint8_t*)surface->pixels + x + (y * surface->pitch)) != 0)
+			{
 				blank = false;
+				break;
+			}
 
-	SDL_UnlockSurface(page);
+	SDL_UnlockSurface(surface);
 	return blank;
 }
 
-uint8_t CPrinter::getPixel(uint32_t num)
+bool CPrinter::isBlank()
+{
+	return isBlankSurface(page);
+}
+
+uint8_t CPrinter::getPixel(SDL_Surface* surface, uint32_t num)
 {
 	// Respect the pitch
-	return *((uint8_t*)page->pixels + (num % page->w) + ((num / page->w) * page->pitch));
+	return *((uint8_t*)surface->pixels + (num % surface->w) + ((num / surface->w) * surface->pitch));
 }
 
 static uint8_t dataregister; // contents of the parallel port data register
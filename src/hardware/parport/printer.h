@@ -30,6 +30,13 @@
 
 #include "SDL.h"
 
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "threadpool.h"
+
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
@@ -84,6 +91,18 @@ enum Typeface
 	svjittra = 31
 };
 
+// A character kept as text for PDF output instead of being rendered on the page
+struct PrinterText
+{
+	double x, y;						// Left end of the baseline (in inch from the top left)
+	double size, hscale;				// Point size and horizontal scaling (in percent)
+	uint8_t font;						// Standard PDF font, see pdfFontNames
+	uint8_t color;						// yyy color bits, see COLOR_BLACK
+	uint8_t ch;							// WinAnsi code
+};
+
+struct PrinterPDF;
+
 class CPrinter {
 public:
 
@@ -158,6 +177,18 @@ private:
 	// Output current page 
 	void outputPage();
 
+	// Queues encoding a finished page. The jobs run one at a time on a worker thread, in order
+	void queuePage(std::function<void()> job);
+
+	// Runs queued jobs until there are none left
+	void drainPages();
+
+	// Writes a page of a PostScript document. Runs on the worker thread
+	void writePSPage(FILE* psfile, SDL_Surface* surface, uint16_t pageNum, bool header);
+
+	// Keeps a character as text for PDF output. False if no standard PDF font has it
+	bool addPDFText(uint16_t unicode);
+
 	// Prints out a byte using ASCII85 encoding (only outputs something every four bytes). When b>255, closes the ASCII85 string
 	void fprintASCII85(FILE* f, uint16_t b);
 
@@ -165,7 +196,7 @@ private:
 	void finishMultipage();
 
 	// Returns value of the num-th pixel (counting left-right, top-down) in a safe way
-	uint8_t getPixel(uint32_t num);
+	static uint8_t getPixel(SDL_Surface* surface, uint32_t num);
 
 	FT_Library FTlib;					// FreeType2 library used to render the characters
 
@@ -184,6 +215,7 @@ private:
     uint8_t params[20] = {};					// Buffer for the read params
 	uint16_t style = 0;						// Style of font (see STYLE_* constants)
 	double cpi = 0, actcpi = 0;					// CPI value set by program and the actual one (taking in account font types)
+	double horizPoints = 0, vertPoints = 0;		// Size of the current font (in points)
 	uint8_t score = 0;						// Score for lines (see SCORE_* constants)
 
 	double topMargin = 0, bottomMargin = 0, rightMargin = 0, leftMargin = 0;	// Margins of the page (in inch)
@@ -242,6 +274,13 @@ private:
 	void* outputHandle = NULL;					// If not null, additional pages will be appended to the given handle
 	bool multipageOutput = false;				// If true, all pages are combined to one file/print job etc. until the "eject page" button is pressed
 	uint16_t multiPageCounter = 0;			// Current page (when printing multipages)
+	bool pdfOutput = false;						// Output is PDF, characters are kept in pdfText instead of rendered
+	std::vector<PrinterText> pdfText;			// Text of the current page
+
+	std::mutex pageLock;
+	std::deque<std::function<void()>> pageQueue;	// Finished pages waiting to be encoded, protected by pageLock
+	bool pageDraining = false;					// A worker task is running the queue, protected by pageLock
+	ThreadPoolGroup pageTasks;
 
     uint8_t ASCII85Buffer[4] = {};				// Buffer used in ASCII85 encoding
 	uint8_t ASCII85BufferPos = 0;				// Position in ASCII85 encode buffer
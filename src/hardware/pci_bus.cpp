@@ -31,6 +31,8 @@
 #include "../ints/int10.h"
 #include "voodoo.h"
 #include "control.h"
+#include "ide.h"
+#include "rtl8139.h"
 
 bool pcibus_enable = false;
 bool log_pci = false;
@@ -73,6 +75,15 @@ static void write_pci(Bitu port,Bitu val,Bitu iolen) {
 
 		PCI_Device* dev=pci_devices[busnum][devnum];
 		if (dev == NULL) return;
+		if (!dev->configHooked(regnum,iolen,PCI_CONFIG_HOOK_WRITE)) {
+			/* plain register: apply the write mask without involving the device model */
+			for (Bitu i=0;i < iolen;i++) {
+				const unsigned char mask = dev->config_writemask[regnum+i];
+				dev->config[regnum+i] = (dev->config[regnum+i] & (unsigned char)~mask) + ((unsigned char)val & mask);
+				val >>= 8U;
+			}
+			return;
+		}
 		dev->config_write(regnum,iolen,(uint32_t)val);
 	}
 }
@@ -100,6 +111,14 @@ static Bitu read_pci(Bitu port,Bitu iolen) {
 
 		PCI_Device* dev=pci_devices[busnum][devnum];
 		if (dev == NULL) return ~0UL;
+		if (!dev->configHooked(regnum,iolen,PCI_CONFIG_HOOK_READ)) {
+			switch (iolen) {
+				case 1: return dev->config[regnum];
+				case 2: return host_readw(dev->config+regnum);
+				case 4: return host_readd(dev->config+regnum);
+				default: break;
+			}
+		}
 		return dev->config_read(regnum,iolen);
 	}
 
@@ -118,6 +137,7 @@ PCI_Device::~PCI_Device() {
 PCI_Device::PCI_Device(uint16_t vendor, uint16_t device) {
 	memset(config,0,256);		/* zero config space */
 	memset(config_writemask,0,256);	/* none of it is writeable */
+	memset(config_hooks,0,256);	/* no side effects, served from config[] */
 	setVendorID(vendor);
 	setDeviceID(device);
 
@@ -267,6 +287,13 @@ public:
 		host_writed(config_writemask+0x10,0xFF000000);	/* BAR0: memory resource 16MB aligned */
 		host_writed(config+0x10,(((uint32_t)VOODOO_INITIAL_LFB)&0xfffffff0) | 0x8);
 
+		setConfigHooks(0x10,4,PCI_CONFIG_HOOK_WRITE);	/* BAR0 moves the LFB */
+		setConfigHooks(0x40,1,PCI_CONFIG_HOOK_WRITE);	/* init enable */
+		setConfigHooks(0xc0,1,PCI_CONFIG_HOOK_WRITE);	/* enable */
+		setConfigHooks(0xe0,1,PCI_CONFIG_HOOK_WRITE);	/* disable */
+		setConfigHooks(0x4c,4,PCI_CONFIG_HOOK_READ);	/* status (logged) */
+		setConfigHooks(0x54,4,PCI_CONFIG_HOOK_READ);	/* oscillator/PCI counters */
+
 		if (getDeviceID() >= 2) {
 			config[0x40] = 0x00;
 			config[0x41] = 0x40;	// voodoo2 revision ID (rev4)
@@ -350,7 +377,153 @@ public:
 	}
 };
 
+/* Intel PIIX4 IDE function. The controller stays in legacy (compatibility) mode, meaning the
+ * IDE channels remain at 1F0h/170h with IRQ 14/15, and only the bus master registers are
+ * decoded through BAR4. Primary channel registers are at +0, secondary at +8. */
+class PCI_IDEBusMasterDevice:public PCI_Device {
+private:
+	static const uint16_t vendor=0x8086;	// Intel
+	static const uint16_t device=0x7111;	// 82371AB PIIX4 IDE
+public:
+	PCI_IDEBusMasterDevice():PCI_Device(vendor,device) {
+		config[0x08] = 0x01;	// revision
+		config[0x09] = 0x80;	// interface (bus master capable, both channels in compatibility mode)
+		config[0x0a] = 0x01;	// subclass code (IDE controller)
+		config[0x0b] = 0x01;	// class code (mass storage controller)
+		config[0x0d] = 0x40;	// latency timer
+		config[0x0e] = 0x00;	// header type (other)
+
+		// reset
+		config[0x04] = 0x05;	// command register (bus master, I/O space enabled)
+		config[0x05] = 0x00;
+		config[0x06] = 0x80;	// status register (fast back-to-back)
+		config[0x07] = 0x02;	// DEVSEL medium timing
+
+		host_writew(config_writemask+0x04,0x0005);	/* allow changing I/O enable and bus master enable */
+
+		host_writed(config_writemask+0x20,0x0000FFF0);	/* BAR4: I/O resource, 16 ports */
+		host_writed(config+0x20,IDE_BUSMASTER_DEFAULT_IO | 0x1);
+
+		host_writew(config+0x40,0x8000);	// primary IDE timing (IDE decode enable)
+		host_writew(config+0x42,0x8000);	// secondary IDE timing (IDE decode enable)
+		host_writew(config_writemask+0x40,0xFFFF);
+		host_writew(config_writemask+0x42,0xFFFF);
+		config_writemask[0x44] = 0xFF;		// slave IDE timing
+		config_writemask[0x48] = 0x0F;		// Ultra DMA/33 control
+		host_writew(config_writemask+0x4a,0x3333);	// Ultra DMA/33 timing
+
+		setConfigHooks(0x04,1,PCI_CONFIG_HOOK_WRITE);	/* I/O enable */
+		setConfigHooks(0x20,2,PCI_CONFIG_HOOK_WRITE);	/* BAR4 */
+
+		update_io();
+	}
+	~PCI_IDEBusMasterDevice() {
+		IDE_BusMaster_SetIO(0,false);
+	}
+
+	void update_io() {
+		IDE_BusMaster_SetIO(host_readd(config+0x20)&0xFFF0u,(config[0x04]&0x01) != 0);
+	}
+
+	void config_write(uint8_t regnum,Bitu iolen,uint32_t value) override {
+		if (iolen == 1) {
+			const unsigned char mask = config_writemask[regnum];
+			const unsigned char nmask = ~mask;
+
+			config[regnum] = (config[regnum] & nmask) + ((unsigned char)value & mask);
+
+			switch (regnum) {
+				case 0x04:
+				case 0x20:
+				case 0x21:
+					update_io(); /* need to act on the new (masked off) value */
+					break;
+				default:
+					break;
+			}
+		}
+		else {
+			PCI_Device::config_write(regnum,iolen,value); /* which will break down I/O into 8-bit */
+		}
+	}
+};
+
+/* Realtek RTL8139 Fast Ethernet controller. The registers are decoded through the I/O BAR only,
+ * the memory mapped copy of them (BAR1) is not implemented. */
+class PCI_RTL8139Device:public PCI_Device {
+private:
+	static const uint16_t vendor=0x10ec;	// Realtek
+	static const uint16_t device=0x8139;	// RTL8139
+public:
+	PCI_RTL8139Device(unsigned int irq):PCI_Device(vendor,device) {
+		config[0x08] = 0x10;	// revision (RTL8139C)
+		config[0x09] = 0x00;	// interface
+		config[0x0a] = 0x00;	// subclass code (Ethernet controller)
+		config[0x0b] = 0x02;	// class code (network controller)
+		config[0x0d] = 0x40;	// latency timer
+		config[0x0e] = 0x00;	// header type (other)
+
+		// reset
+		config[0x04] = 0x05;	// command register (bus master, I/O space enabled)
+		config[0x05] = 0x00;
+		config[0x06] = 0x80;	// status register (fast back-to-back)
+		config[0x07] = 0x02;	// DEVSEL medium timing
+
+		host_writew(config_writemask+0x04,0x0005);	/* allow changing I/O enable and bus master enable */
+
+		host_writed(config_writemask+0x10,0x0000FF00);	/* BAR0: I/O resource, 256 ports */
+		host_writed(config+0x10,RTL8139_DEFAULT_IO | 0x1);
+
+		host_writew(config+0x2c,vendor);	// subsystem vendor
+		host_writew(config+0x2e,device);	// subsystem
+
+		config[0x3c] = (uint8_t)irq;	// interrupt line
+		config[0x3d] = 0x01;		// interrupt pin (INTA#)
+		config[0x3e] = 0x20;		// min grant
+		config[0x3f] = 0x40;		// max latency
+		config_writemask[0x3c] = 0xFF;
+
+		setConfigHooks(0x04,1,PCI_CONFIG_HOOK_WRITE);	/* I/O and bus master enable */
+		setConfigHooks(0x10,2,PCI_CONFIG_HOOK_WRITE);	/* BAR0 */
+		setConfigHooks(0x3c,1,PCI_CONFIG_HOOK_WRITE);	/* interrupt line */
+
+		update_io();
+	}
+	~PCI_RTL8139Device() {
+		RTL8139_SetPCIState(0,false,false,0xFF);
+	}
+
+	void update_io() {
+		RTL8139_SetPCIState(host_readd(config+0x10)&0xFF00u,(config[0x04]&0x01) != 0,(config[0x04]&0x04) != 0,config[0x3c]);
+	}
+
+	void config_write(uint8_t regnum,Bitu iolen,uint32_t value) override {
+		if (iolen == 1) {
+			const unsigned char mask = config_writemask[regnum];
+			const unsigned char nmask = ~mask;
+
+			config[regnum] = (config[regnum] & nmask) + ((unsigned char)value & mask);
+
+			switch (regnum) {
+				case 0x04:
+				case 0x10:
+				case 0x11:
+				case 0x3c:
+					update_io(); /* need to act on the new (masked off) value */
+					break;
+				default:
+					break;
+			}
+		}
+		else {
+			PCI_Device::config_write(regnum,iolen,value); /* which will break down I/O into 8-bit */
+		}
+	}
+};
+
 static bool initialized = false;
+static PCI_Device *IDE_PCI=NULL;
+static PCI_Device *RTL8139_PCI=NULL;
 
 static IO_WriteHandleObject PCI_WriteHandler[5];
 static IO_ReadHandleObject PCI_ReadHandler[5];
@@ -463,6 +636,9 @@ static void Deinitialize(void) {
 			}
 		}
 	}
+
+	IDE_PCI = NULL;
+	RTL8139_PCI = NULL;
 }
 
 static PCI_Device *S3_PCI=NULL;
@@ -539,6 +715,46 @@ void PCI_RemoveSST_Device(void) {
 	}
 }
 
+void PCI_AddIDEBusMaster_Device(void) {
+	if (!pcibus_enable) return;
+
+	if (IDE_PCI == NULL) {
+		LOG(LOG_MISC,LOG_DEBUG)("Initializing PCI IDE bus master device");
+		if ((IDE_PCI=new PCI_IDEBusMasterDevice()) == NULL)
+			return;
+
+		RegisterPCIDevice(IDE_PCI);
+	}
+}
+
+void PCI_RemoveIDEBusMaster_Device(void) {
+	if (IDE_PCI != NULL) {
+		UnregisterPCIDevice(IDE_PCI);
+		delete IDE_PCI;
+		IDE_PCI = NULL;
+	}
+}
+
+void PCI_AddRTL8139_Device(unsigned int irq) {
+	if (!pcibus_enable) return;
+
+	if (RTL8139_PCI == NULL) {
+		LOG(LOG_MISC,LOG_DEBUG)("Initializing PCI RTL8139 network device");
+		if ((RTL8139_PCI=new PCI_RTL8139Device(irq)) == NULL)
+			return;
+
+		RegisterPCIDevice(RTL8139_PCI);
+	}
+}
+
+void PCI_RemoveRTL8139_Device(void) {
+	if (RTL8139_PCI != NULL) {
+		UnregisterPCIDevice(RTL8139_PCI);
+		delete RTL8139_PCI;
+		RTL8139_PCI = NULL;
+	}
+}
+
 PhysPt PCI_GetPModeInterface(void) {
 	if (!pcibus_enable) return 0;
 	return GetPModeCallbackPointer();
@@ -25,6 +25,7 @@
  
 //#define SPKR_DEBUGGING
 #include <math.h>
+#include <string.h>
 #include "dosbox.h"
 #include "logging.h"
 #include "mixer.h"
@@ -66,6 +67,9 @@ typedef struct {
 
 #define SPKR_ENTRIES 8192
 #define SPKR_VOLUME 10000
+#define SPKR_BLEP_WIDTH 16
+#define SPKR_BLEP_PHASES 64
+#define SPKR_BLEP_SHIFT 14
 //#define SPKR_SHIFT 8
 pic_tickindex_t SPKR_SPEED = 1.0;
 
@@ -96,8 +100,59 @@ static struct {
 	Bitu minimum_counter;
 	DelayEntry entries[SPKR_ENTRIES];
 	Bitu used;
+	int32_t blep_level;
+	int32_t blep_accum;
+	int32_t blep_carry[SPKR_BLEP_WIDTH];
 } spkr;
 
+/* Band-limited step synthesis (pcspeaker synthesis=blep).
+ * Each output transition adds a windowed sinc impulse, scaled by the size of
+ * the step, into a delta buffer at its fractional sample position. The output
+ * is the running sum of the delta buffer, which is the band-limited step.
+ * The taps of every phase sum to exactly 1 << SPKR_BLEP_SHIFT so the level
+ * never drifts no matter how many transitions are added. */
+static bool spkr_blep = false;
+static int32_t spkr_blep_kernel[SPKR_BLEP_PHASES][SPKR_BLEP_WIDTH];
+static int32_t spkr_blep_delta[(MIXER_BUFSIZE/sizeof(int16_t)) + SPKR_BLEP_WIDTH];
+
+static void PCSPEAKER_InitBLEP(void) {
+	const double pi = 3.14159265358979323846;
+	const double cutoff = 0.45; /* relative to the sample rate */
+
+	for (unsigned int ph=0;ph < SPKR_BLEP_PHASES;ph++) {
+		const double frac = (double)ph / SPKR_BLEP_PHASES;
+		double taps[SPKR_BLEP_WIDTH],total = 0;
+
+		for (unsigned int j=0;j < SPKR_BLEP_WIDTH;j++) {
+			const double t = (double)j - frac - (SPKR_BLEP_WIDTH/2 - 1);
+			const double x = 2.0 * cutoff * t;
+			const double w = (t + (SPKR_BLEP_WIDTH/2)) / SPKR_BLEP_WIDTH;
+			double h = (x == 0) ? 1.0 : (sin(pi * x) / (pi * x));
+
+			h *= 0.42 - (0.5 * cos(2.0 * pi * w)) + (0.08 * cos(4.0 * pi * w)); /* Blackman */
+			taps[j] = h;
+			total += h;
+		}
+
+		int32_t sum = 0;
+		for (unsigned int j=0;j < SPKR_BLEP_WIDTH;j++) {
+			spkr_blep_kernel[ph][j] = (int32_t)floor(((taps[j] / total) * (1 << SPKR_BLEP_SHIFT)) + 0.5);
+			sum += spkr_blep_kernel[ph][j];
+		}
+		spkr_blep_kernel[ph][SPKR_BLEP_WIDTH/2 - 1] += (1 << SPKR_BLEP_SHIFT) - sum;
+	}
+}
+
+static inline void PCSPEAKER_AddBLEP(pic_tickindex_t sample_pos, int32_t delta) {
+	if (sample_pos < 0) sample_pos = 0;
+	const Bitu at = (Bitu)sample_pos;
+	const int32_t *k = spkr_blep_kernel[(unsigned int)((sample_pos - (pic_tickindex_t)at) * SPKR_BLEP_PHASES) & (SPKR_BLEP_PHASES - 1)];
+	int32_t *d = spkr_blep_delta + at;
+
+	for (unsigned int j=0;j < SPKR_BLEP_WIDTH;j++)
+		d[j] += k[j] * delta;
+}
+
 inline static void AddDelayEntry(pic_tickindex_t index, bool new_output_level) {
 #ifdef SPKR_DEBUGGING
 	if (index < 0 || index > 1) {
@@ -560,6 +615,120 @@ void PCSPEAKER_SetType(bool pit_clock_gate_enabled, bool pit_output_enabled) {
     CheckPITSynchronization();
 }
 
+static void PCSPEAKER_Transition(const DelayEntry &entry, bool &ultrasonic) {
+	spkr.volwant=SPKR_VOLUME*(pic_tickindex_t)entry.output_level;
+
+	/* A change in PC speaker output means to keep rendering.
+	 * Do not allow timeout to occur unless speaker is idle too long. */
+	if (spkr.pit_mode == 3 && spkr.pit_max < (1000.0/spkr.rate)) {
+		/* Unless the speaker is cycling at ultrasonic frequencies, meaning games
+		 * that "silence" the output by setting the counter way above audible frequencies. */
+		ultrasonic = true;
+	}
+	else {
+		spkr.last_ticks=PIC_Ticks;
+	}
+
+#ifdef SPKR_DEBUGGING
+	fprintf(
+			PCSpeakerOutputLevelLog,
+			"%f %u\n",
+			PIC_Ticks + entry.index,
+			entry.output_level);
+	double tempIndex = PIC_Ticks + entry.index;
+	unsigned char tempOutputLevel = entry.output_level;
+	fwrite(&tempIndex, sizeof(double), 1, PCSpeakerOutput);
+	fwrite(&tempOutputLevel, sizeof(unsigned char), 1, PCSpeakerOutput);
+#endif
+}
+
+/* Render len samples from the delay queue with band-limited steps, returns the number of entries consumed */
+static Bitu PCSPEAKER_RenderBLEP(int16_t *stream, Bitu len, pic_tickindex_t sample_add, bool &ultrasonic) {
+	memcpy(spkr_blep_delta, spkr.blep_carry, sizeof(spkr.blep_carry));
+	memset(spkr_blep_delta + SPKR_BLEP_WIDTH, 0, len * sizeof(int32_t));
+
+	/* the idle timeout below decays volwant without a queue entry */
+	if ((int32_t)spkr.volwant != spkr.blep_level) {
+		PCSPEAKER_AddBLEP(0, (int32_t)spkr.volwant - spkr.blep_level);
+		spkr.blep_level = (int32_t)spkr.volwant;
+	}
+
+	Bitu pos = 0;
+	const pic_tickindex_t end = sample_add * len;
+	while (pos < spkr.used && spkr.entries[pos].index < end) {
+		PCSPEAKER_Transition(spkr.entries[pos], ultrasonic);
+
+		const int32_t level = (int32_t)spkr.volwant;
+		if (level != spkr.blep_level) {
+			PCSPEAKER_AddBLEP(spkr.entries[pos].index / sample_add, level - spkr.blep_level);
+			spkr.blep_level = level;
+		}
+		pos++;
+	}
+	spkr.used -= pos;
+
+	int32_t accum = spkr.blep_accum;
+	for (Bitu i=0;i < len;i++) {
+		accum += spkr_blep_delta[i];
+		stream[i] = (int16_t)(accum >> SPKR_BLEP_SHIFT);
+	}
+	spkr.blep_accum = accum;
+
+	memcpy(spkr.blep_carry, spkr_blep_delta + len, sizeof(spkr.blep_carry));
+	return pos;
+}
+
+static void PCSPEAKER_Finish(Bitu len, Bitu pos, pic_tickindex_t sample_base, bool ultrasonic) {
+	if(spkr.chan) spkr.chan->AddSamples_m16(len,(int16_t*)MixTemp);
+
+	//Turn off speaker after 10 seconds of idle or one second idle when in off mode
+	bool turnoff = false;
+	Bitu test_ticks = PIC_Ticks;
+	if ((spkr.last_ticks + 10000) < test_ticks) turnoff = true;
+	if((!spkr.pit_output_enabled) && ((spkr.last_ticks + 1000) < test_ticks)) turnoff = true;
+
+	if(turnoff){
+		if(spkr.volwant == 0) { 
+			spkr.last_ticks = 0;
+			if(spkr.chan) {
+				if (!spkr.pit_output_enabled)
+					LOG(LOG_MISC,LOG_DEBUG)("Silencing PC speaker output (output disabled)");
+				else if (ultrasonic)
+					LOG(LOG_MISC,LOG_DEBUG)("Silencing PC speaker output (timeout and ultrasonic frequency)");
+				else
+					LOG(LOG_MISC,LOG_DEBUG)("Silencing PC speaker output (timeout and non-changing output)");
+
+				spkr.chan->Enable(false);
+			}
+		} else {
+			if(spkr.volwant > 0) spkr.volwant--; else spkr.volwant++;
+		
+		}
+	}
+	if (spkr.used != 0) {
+        if (pos != 0) {
+            /* well then roll the queue back */
+            for (Bitu i=0;i < spkr.used;i++)
+                spkr.entries[i] = spkr.entries[pos+i];
+        }
+
+        /* hack: some indexes come out at 1.001, fix that for the next round.
+         *       this is a consequence of DOSBox-X allowing the CPU cycles
+         *       count use to overrun slightly for accuracy. if we DON'T fix
+         *       this the delay queue will get stuck and PC speaker output
+         *       will stop. */
+        for (Bitu i=0;i < spkr.used;i++) {
+            if (spkr.entries[i].index >= 1.000)
+                spkr.entries[i].index -= 1.000;
+            else
+                break;
+        }
+
+        LOG(LOG_MISC,LOG_DEBUG)("PC speaker queue render, %u entries left, %u rendered",(unsigned int)spkr.used,(unsigned int)pos);
+        LOG(LOG_MISC,LOG_DEBUG)("Next entry waits for index %.3f, stopped at %.3f",spkr.entries[0].index,sample_base);
+	}
+}
+
 /* NTS: This code stinks. Sort of. The way it handles the delay entry queue
  *      could have been done better. The event queue idea isn't needed anymore because
  *      DOSBox-X allows any code to render audio "up to" the current time.
@@ -577,6 +746,13 @@ static void PCSPEAKER_CallBack(Bitu len) {
 	ForwardPIT(1.0 + PIC_TickIndex());
     CheckPITSynchronization();
 	spkr.last_index = PIC_TickIndex();
+	if (spkr_blep) {
+		if (len > (MIXER_BUFSIZE/sizeof(int16_t))) len = MIXER_BUFSIZE/sizeof(int16_t);
+		const pic_tickindex_t sample_add=(pic_tickindex_t)(1.0001/len);
+		const Bitu pos = PCSPEAKER_RenderBLEP(stream, len, sample_add, ultrasonic);
+		PCSPEAKER_Finish(len, pos, sample_add * len, ultrasonic);
+		return;
+	}
 	Bitu count=len;
 	Bitu pos=0;
 	pic_tickindex_t sample_base=0;
@@ -589,30 +765,7 @@ static void PCSPEAKER_CallBack(Bitu len) {
 		while(index<end) {
 			/* Check if there is an upcoming event */
 			if (spkr.used && spkr.entries[pos].index<=index) {
-				spkr.volwant=SPKR_VOLUME*(pic_tickindex_t)spkr.entries[pos].output_level;
-
-				/* A change in PC speaker output means to keep rendering.
-				 * Do not allow timeout to occur unless speaker is idle too long. */
-				if (spkr.pit_mode == 3 && spkr.pit_max < (1000.0/spkr.rate)) {
-					/* Unless the speaker is cycling at ultrasonic frequencies, meaning games
-					 * that "silence" the output by setting the counter way above audible frequencies. */
-					ultrasonic = true;
-				}
-				else {
-					spkr.last_ticks=PIC_Ticks;
-				}
-
-#ifdef SPKR_DEBUGGING
-				fprintf(
-						PCSpeakerOutputLevelLog,
-						"%f %u\n",
-						PIC_Ticks + spkr.entries[pos].index,
-						spkr.entries[pos].output_level);
-				double tempIndex = PIC_Ticks + spkr.entries[pos].index;
-				unsigned char tempOutputLevel = spkr.entries[pos].output_level;
-				fwrite(&tempIndex, sizeof(double), 1, PCSpeakerOutput);
-				fwrite(&tempOutputLevel, sizeof(unsigned char), 1, PCSpeakerOutput);
-#endif
+				PCSPEAKER_Transition(spkr.entries[pos], ultrasonic);
 				pos++;spkr.used--;
 				continue;
 			}
@@ -651,55 +804,9 @@ static void PCSPEAKER_CallBack(Bitu len) {
 		}
 		*stream++=(int16_t)(value/sample_add);
 	}
-	if(spkr.chan) spkr.chan->AddSamples_m16(len,(int16_t*)MixTemp);
-
-	//Turn off speaker after 10 seconds of idle or one second idle when in off mode
-	bool turnoff = false;
-	Bitu test_ticks = PIC_Ticks;
-	if ((spkr.last_ticks + 10000) < test_ticks) turnoff = true;
-	if((!spkr.pit_output_enabled) && ((spkr.last_ticks + 1000) < test_ticks)) turnoff = true;
-
-	if(turnoff){
-		if(spkr.volwant == 0) { 
-			spkr.last_ticks = 0;
-			if(spkr.chan) {
-				if (!spkr.pit_output_enabled)
-					LOG(LOG_MISC,LOG_DEBUG)("Silencing PC speaker output (output disabled)");
-				else if (ultrasonic)
-					LOG(LOG_MISC,LOG_DEBUG)("Silencing PC speaker output (timeout and ultrasonic frequency)");
-				else
-					LOG(LOG_MISC,LOG_DEBUG)("Silencing PC speaker output (timeout and non-changing output)");
-
-				spkr.chan->Enable(false);
-			}
-		} else {
-			if(spkr.volwant > 0) spkr.volwant--; else spkr.volwant++;
-		
-		}
-	}
-	if (spkr.used != 0) {
-        if (pos != 0) {
-            /* well then roll the queue back */
-            for (Bitu i=0;i < spkr.used;i++)
-                spkr.entries[i] = spkr.entries[pos+i];
-        }
-
-        /* hack: some indexes come out at 1.001, fix that for the next round.
-         *       this is a consequence of DOSBox-X allowing the CPU cycles
-         *       count use to overrun slightly for accuracy. if we DON'T fix
-         *       this the delay queue will get stuck and PC speaker output
-         *       will stop. */
-        for (Bitu i=0;i < spkr.used;i++) {
-            if (spkr.entries[i].index >= 1.000)
-                spkr.entries[i].index -= 1.000;
-            else
-                break;
-        }
-
-        LOG(LOG_MISC,LOG_DEBUG)("PC speaker queue render, %u entries left, %u rendered",(unsigned int)spkr.used,(unsigned int)pos);
-        LOG(LOG_MISC,LOG_DEBUG)("Next entry waits for index %.3f, stopped at %.3f",spkr.entries[0].index,sample_base);
-	}
+	PCSPEAKER_Finish(len, pos, sample_base, ultrasonic);
 }
+
 class PCSPEAKER:public Module_base {
 private:
 	MixerObject MixerChan;
@@ -731,6 +838,13 @@ public:
 		spkr.minimum_counter = PIT_TICK_RATE/(spkr.rate*10);
 		SPKR_SPEED = (pic_tickindex_t)((SPKR_VOLUME*2*44100)/(0.010*spkr.rate));
 		spkr.used=0;
+
+		spkr_blep = !strcmp(section->Get_string("pcspeaker synthesis"),"blep");
+		spkr.blep_level = 0;
+		spkr.blep_accum = 0;
+		memset(spkr.blep_carry, 0, sizeof(spkr.blep_carry));
+		if (spkr_blep) PCSPEAKER_InitBLEP();
+
 		/* Register the sound channel */
 		spkr.chan=MixerChan.Install(&PCSPEAKER_CallBack,spkr.rate,"SPKR");
 		if (!spkr.chan) {
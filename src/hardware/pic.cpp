@@ -17,6 +17,8 @@
  */
 
 #include <assert.h>
+#include <algorithm>
+#include <atomic>
 
 #include "dosbox.h"
 #include "inout.h"
@@ -27,6 +29,7 @@
 #include "timer.h"
 #include "setup.h"
 #include "control.h"
+#include "hosttime.h"
 
 #if defined(_MSC_VER)
 # pragma warning(disable:4244) /* const fmath::local::uint64_t to double possible loss of data */
@@ -168,6 +171,9 @@ void PIC_Controller::set_imr(uint8_t val) {
     //Test if changed bits are set in irr and are not being served at the moment
     //Those bits have impact on whether the cpu emulation should be paused or not.
     if((irr & change)&isrr) check_for_irq();
+
+    //The PIT stops scheduling IRQ 0 events nobody can see while it is masked
+    if (this == &master && (change & imrr & 1u)) TIMER_IRQ0Unmasked();
 }
 
 void PIC_Controller::activate() { 
@@ -225,17 +231,27 @@ void PIC_Controller::start_irq(uint8_t val){
     }
 }
 
+#define PIC_NOT_QUEUED (~0u)
+
 struct PICEntry {
     pic_tickindex_t index;
     Bitu value;
     PIC_EventHandler pic_event;
-    PICEntry * next;
+    PICEntry * next;            // free list link
+    uint32_t serial;            // insertion order, keeps events with the same index first in first out
+    unsigned int heap_pos;      // slot in pic_queue.heap, PIC_NOT_QUEUED if not scheduled
+    uint16_t generation;        // bumped whenever the entry leaves the queue, invalidates old handles
 };
 
+/* Pending events are kept in a binary min-heap ordered by (index,serial), so scheduling and
+ * servicing an event costs O(log n) instead of walking a sorted list. Every entry tracks its own
+ * heap slot so it can be pulled out of the middle of the heap through a PIC_EventHandle. */
 static struct {
     PICEntry entries[PIC_QUEUESIZE];
+    PICEntry * heap[PIC_QUEUESIZE];
+    unsigned int count;
     PICEntry * free_entry;
-    PICEntry * next_entry;
+    uint32_t serial;
 } pic_queue;
 
 static void write_command(Bitu port,Bitu val,Bitu iolen) {
@@ -585,6 +601,10 @@ void PIC_runIRQs(void) {
     }
 }
 
+unsigned int PIC_QueueDepth(void) {
+    return pic_queue.count;
+}
+
 void PIC_SetIRQMask(Bitu irq, bool masked) {
     Bitu t = irq>7 ? (irq - 8): irq;
     PIC_Controller * pic=&pics[irq>7 ? 1 : 0];
@@ -596,6 +616,11 @@ void PIC_SetIRQMask(Bitu irq, bool masked) {
     pic->set_imr(newmask);
 }
 
+bool PIC_IRQMasked(Bitu irq) {
+    const PIC_Controller * pic=&pics[irq>7 ? 1 : 0];
+    return (pic->imr & (1u << (irq & 7u))) != 0;
+}
+
 void DEBUG_PICSignal(int irq,bool raise) {
     if (irq >= 0 && irq <= 15) {
         if (raise)
@@ -620,31 +645,86 @@ void DEBUG_PICMask(int irq,bool mask) {
         PIC_SetIRQMask((unsigned int)irq,mask);
 }
 
-static void AddEntry(PICEntry * entry) {
-    PICEntry * find_entry=pic_queue.next_entry;
-    if (GCC_UNLIKELY(!find_entry)) {
-        entry->next = nullptr;
-        pic_queue.next_entry=entry;
-    } else if (find_entry->index>entry->index) {
-        pic_queue.next_entry=entry;
-        entry->next=find_entry;
-    } else while (find_entry) {
-        if (find_entry->next) {
-            /* See if the next index comes later than this one */
-            if (find_entry->next->index > entry->index) {
-                entry->next=find_entry->next;
-                find_entry->next=entry;
-                break;
-            } else {
-                find_entry=find_entry->next;
-            }
-        } else {
-            entry->next=find_entry->next;
-            find_entry->next=entry;
-            break;
+static inline bool PIC_EntryBefore(const PICEntry * a,const PICEntry * b) {
+    if (a->index != b->index) return a->index < b->index;
+    return (int32_t)(a->serial - b->serial) < 0;
+}
+
+static inline void PIC_HeapPlace(unsigned int pos,PICEntry * entry) {
+    pic_queue.heap[pos] = entry;
+    entry->heap_pos = pos;
+}
+
+static void PIC_HeapUp(unsigned int pos) {
+    PICEntry * entry = pic_queue.heap[pos];
+    while (pos > 0) {
+        const unsigned int parent = (pos - 1u) >> 1u;
+        if (!PIC_EntryBefore(entry,pic_queue.heap[parent])) break;
+        PIC_HeapPlace(pos,pic_queue.heap[parent]);
+        pos = parent;
+    }
+    PIC_HeapPlace(pos,entry);
+}
+
+static void PIC_HeapDown(unsigned int pos) {
+    PICEntry * entry = pic_queue.heap[pos];
+    for (;;) {
+        unsigned int child = (pos * 2u) + 1u;
+        if (child >= pic_queue.count) break;
+        if ((child + 1u) < pic_queue.count && PIC_EntryBefore(pic_queue.heap[child+1u],pic_queue.heap[child])) child++;
+        if (!PIC_EntryBefore(pic_queue.heap[child],entry)) break;
+        PIC_HeapPlace(pos,pic_queue.heap[child]);
+        pos = child;
+    }
+    PIC_HeapPlace(pos,entry);
+}
+
+/* take an entry out of the heap. the caller decides when it goes back on the free list */
+static void PIC_HeapRemove(PICEntry * entry) {
+    const unsigned int pos = entry->heap_pos;
+    assert(pos < pic_queue.count && pic_queue.heap[pos] == entry);
+
+    entry->heap_pos = PIC_NOT_QUEUED;
+    entry->generation++;
+    if (pos != --pic_queue.count) {
+        PICEntry * last = pic_queue.heap[pic_queue.count];
+        PIC_HeapPlace(pos,last);
+        PIC_HeapUp(pos);
+        PIC_HeapDown(last->heap_pos);
+    }
+}
+
+static inline void PIC_FreeEntry(PICEntry * entry) {
+    entry->next = pic_queue.free_entry;
+    pic_queue.free_entry = entry;
+}
+
+/* drop every queued event the predicate matches. A whole scan is needed anyway, so compact the
+ * heap array and rebuild it bottom up instead of removing entries one at a time. */
+template <typename Match> static void PIC_RemoveMatching(Match match) {
+    unsigned int keep = 0;
+    for (unsigned int i = 0;i < pic_queue.count;i++) {
+        PICEntry * entry = pic_queue.heap[i];
+        if (GCC_UNLIKELY(match(entry))) {
+            entry->heap_pos = PIC_NOT_QUEUED;
+            entry->generation++;
+            PIC_FreeEntry(entry);
+        }
+        else {
+            PIC_HeapPlace(keep++,entry);
         }
     }
-    Bits cycles=PIC_MakeCycles(pic_queue.next_entry->index-PIC_TickIndex());
+    if (keep == pic_queue.count) return;
+    pic_queue.count = keep;
+    for (unsigned int i = keep / 2u;i-- > 0;) PIC_HeapDown(i);
+}
+
+static void AddEntry(PICEntry * entry) {
+    entry->serial = pic_queue.serial++;
+    PIC_HeapPlace(pic_queue.count,entry);
+    PIC_HeapUp(pic_queue.count++);
+
+    Bits cycles=PIC_MakeCycles(pic_queue.heap[0]->index-PIC_TickIndex());
     if (cycles<CPU_Cycles) {
         CPU_CycleLeft+=CPU_Cycles;
         CPU_Cycles=0;
@@ -661,10 +741,10 @@ pic_tickindex_t PIC_GetCurrentEventTime(void) {
         return PIC_FullIndex();
 }
 
-void PIC_AddEvent(PIC_EventHandler handler,pic_tickindex_t delay,Bitu val) {
+PIC_EventHandle PIC_AddEventHandle(PIC_EventHandler handler,pic_tickindex_t delay,Bitu val) {
     if (GCC_UNLIKELY(!pic_queue.free_entry)) {
         LOG(LOG_PIC,LOG_ERROR)("Event queue full");
-        return;
+        return 0;
     }
     PICEntry * entry=pic_queue.free_entry;
     if(InEventService) entry->index = delay + srv_lag;
@@ -674,54 +754,83 @@ void PIC_AddEvent(PIC_EventHandler handler,pic_tickindex_t delay,Bitu val) {
     entry->value=val;
     pic_queue.free_entry=pic_queue.free_entry->next;
     AddEntry(entry);
+
+    /* generation 0 is skipped so that a valid handle is never 0 */
+    if (GCC_UNLIKELY(entry->generation == 0)) entry->generation = 1;
+    return ((PIC_EventHandle)entry->generation << 16u) | (PIC_EventHandle)(entry - pic_queue.entries);
+}
+
+void PIC_AddEvent(PIC_EventHandler handler,pic_tickindex_t delay,Bitu val) {
+    PIC_AddEventHandle(handler,delay,val);
+}
+
+bool PIC_RemoveEventHandle(PIC_EventHandle handle) {
+    const unsigned int slot = handle & 0xFFFFu;
+    if (slot >= PIC_QUEUESIZE) return false;
+
+    PICEntry * entry = &pic_queue.entries[slot];
+    if (entry->heap_pos == PIC_NOT_QUEUED || entry->generation != (uint16_t)(handle >> 16u))
+        return false; /* already fired or removed */
+
+    PIC_HeapRemove(entry);
+    PIC_FreeEntry(entry);
+    return true;
+}
+
+/* Events posted by other host threads. Producers push onto a lock-free stack, the emulation
+ * thread takes the whole stack in one exchange and reverses it to get posting order back. */
+struct PICPostedEvent {
+    PIC_EventHandler handler;
+    pic_tickindex_t delay;
+    Bitu value;
+    PICPostedEvent * next;
+};
+
+static std::atomic<PICPostedEvent*> pic_posted{nullptr};
+
+void PIC_PostEvent(PIC_EventHandler handler,pic_tickindex_t delay,Bitu val) {
+    PICPostedEvent * ev = new PICPostedEvent;
+    ev->handler = handler;
+    ev->delay = delay;
+    ev->value = val;
+    ev->next = pic_posted.load(std::memory_order_relaxed);
+    while (!pic_posted.compare_exchange_weak(ev->next,ev,std::memory_order_release,std::memory_order_relaxed));
+}
+
+static void PIC_TakePostedEvents(void) {
+    PICPostedEvent * ev = pic_posted.exchange(nullptr,std::memory_order_acquire);
+    PICPostedEvent * fifo = nullptr;
+
+    while (ev) {
+        PICPostedEvent * n = ev->next;
+        ev->next = fifo;
+        fifo = ev;
+        ev = n;
+    }
+    while (fifo) {
+        PICPostedEvent * n = fifo->next;
+        PIC_AddEvent(fifo->handler,fifo->delay,fifo->value);
+        delete fifo;
+        fifo = n;
+    }
 }
 
 void PIC_RemoveSpecificEvents(PIC_EventHandler handler, Bitu val) {
-    PICEntry * entry=pic_queue.next_entry;
-    PICEntry * prev_entry = nullptr;
-    while (entry) {
-        if (GCC_UNLIKELY((entry->pic_event == handler)) && (entry->value == val)) {
-            if (prev_entry) {
-                prev_entry->next=entry->next;
-                entry->next=pic_queue.free_entry;
-                pic_queue.free_entry=entry;
-                entry=prev_entry->next;
-                continue;
-            } else {
-                pic_queue.next_entry=entry->next;
-                entry->next=pic_queue.free_entry;
-                pic_queue.free_entry=entry;
-                entry=pic_queue.next_entry;
-                continue;
-            }
-        }
-        prev_entry=entry;
-        entry=entry->next;
-    }   
+    PIC_RemoveMatching([handler,val](const PICEntry * entry) {
+        return entry->pic_event == handler && entry->value == val;
+    });
+}
+
+void PIC_RemoveMaskedEvents(PIC_EventHandler handler, Bitu val, Bitu mask) {
+    PIC_RemoveMatching([handler,val,mask](const PICEntry * entry) {
+        return entry->pic_event == handler && (entry->value & mask) == val;
+    });
 }
 
 void PIC_RemoveEvents(PIC_EventHandler handler) {
-    PICEntry * entry=pic_queue.next_entry;
-    PICEntry * prev_entry = nullptr;
-    while (entry) {
-        if (GCC_UNLIKELY(entry->pic_event==handler)) {
-            if (prev_entry) {
-                prev_entry->next=entry->next;
-                entry->next=pic_queue.free_entry;
-                pic_queue.free_entry=entry;
-                entry=prev_entry->next;
-                continue;
-            } else {
-                pic_queue.next_entry=entry->next;
-                entry->next=pic_queue.free_entry;
-                pic_queue.free_entry=entry;
-                entry=pic_queue.next_entry;
-                continue;
-            }
-        }
-        prev_entry=entry;
-        entry=entry->next;
-    }   
+    PIC_RemoveMatching([handler](const PICEntry * entry) {
+        return entry->pic_event == handler;
+    });
 }
 
 extern ClockDomain clockdom_DOSBox_cycles;
@@ -758,28 +867,32 @@ bool PIC_RunQueue(void) {
         if (PIC_IRQCheck)
             PIC_runIRQs();
 
+        if (GCC_UNLIKELY(pic_posted.load(std::memory_order_relaxed) != nullptr))
+            PIC_TakePostedEvents();
+
         /* Check the queue for an entry */
         Bits index_nd=PIC_TickIndexND();
         InEventService = true;
-        while (pic_queue.next_entry && (pic_queue.next_entry->index*CPU_CycleMax<=index_nd)) {
-            PICEntry * entry=pic_queue.next_entry;
-            pic_queue.next_entry=entry->next;
+        while (pic_queue.count != 0 && (pic_queue.heap[0]->index*CPU_CycleMax<=index_nd)) {
+            PICEntry * entry=pic_queue.heap[0];
+            PIC_HeapRemove(entry);
             srv_lag = entry->index;
 
-            if (entry->pic_event != NULL)
+            if (entry->pic_event != NULL) {
+                HostTimeScope scope(HOSTTIME_EVENTS,(const void*)((uintptr_t)entry->pic_event));
                 (entry->pic_event)(entry->value); // call the event handler
+            }
             else
                 LOG(LOG_MISC,LOG_WARN)("PIC: Event in queue with NULL handler"); // This can happen after save state / load state
 
             /* Put the entry in the free list */
-            entry->next=pic_queue.free_entry;
-            pic_queue.free_entry=entry;
+            PIC_FreeEntry(entry);
         }
         InEventService = false;
 
         /* Check when to set the new cycle end */
-        if (pic_queue.next_entry) {
-            Bits cycles=(Bits)(pic_queue.next_entry->index*CPU_CycleMax-index_nd);
+        if (pic_queue.count != 0) {
+            Bits cycles=(Bits)(pic_queue.heap[0]->index*CPU_CycleMax-index_nd);
             if (GCC_UNLIKELY(!cycles)) cycles=1;
             if (cycles<CPU_CycleLeft) {
                 CPU_Cycles=cycles;
@@ -863,22 +976,22 @@ void TIMER_AddTick(void) {
     }
     CPU_CycleLeft += CPU_CycleMax + CPU_Cycles;
     CPU_Cycles = 0;
+    CPU_CyclesTotal += (uint64_t)CPU_CycleMax;
 
     /* timeout */
     if (time_limit_ms != 0 && PIC_Ticks >= time_limit_ms)
         throw int(1);
 
-    /* Go through the list of scheduled events and lower their index with 1000 */
-    PICEntry * entry=pic_queue.next_entry;
-    while (entry) {
-        entry->index -= 1.0;
-        entry=entry->next;
-    }
+    /* Go through the list of scheduled events and lower their index with 1000.
+     * Every entry moves by the same amount, so the heap order is unchanged. */
+    for (unsigned int i=0;i<pic_queue.count;i++)
+        pic_queue.heap[i]->index -= 1.0;
 
     /* Call our list of ticker handlers */
     TickerBlock * ticker=firstticker;
     while (ticker) {
         TickerBlock * nextticker=ticker->next;
+        HostTimeScope scope(HOSTTIME_EVENTS,(const void*)((uintptr_t)ticker->handler));
         ticker->handler();
         ticker=nextticker;
     }
@@ -1049,15 +1162,17 @@ void Init_PIC() {
     LOG(LOG_MISC,LOG_DEBUG)("Init_PIC()");
 
     /* Initialize the pic queue */
-    for (i=0;i<PIC_QUEUESIZE-1;i++) {
-        pic_queue.entries[i].next=&pic_queue.entries[i+1];
+    for (i=0;i<PIC_QUEUESIZE;i++) {
+        pic_queue.entries[i].next=(i+1 < PIC_QUEUESIZE) ? &pic_queue.entries[i+1] : nullptr;
+        pic_queue.entries[i].heap_pos = PIC_NOT_QUEUED;
+        pic_queue.entries[i].generation = 1;
 
         // savestate compatibility
         pic_queue.entries[i].pic_event = nullptr;
     }
-    pic_queue.entries[PIC_QUEUESIZE-1].next = nullptr;
     pic_queue.free_entry=&pic_queue.entries[0];
-    pic_queue.next_entry = nullptr;
+    pic_queue.count = 0;
+    pic_queue.serial = 0;
 
     AddExitFunction(AddExitFunctionFuncPair(PIC_Destroy));
     AddVMEventFunction(VM_EVENT_RESET,AddVMEventFunctionFuncPair(PIC_Reset));
@@ -1265,19 +1380,25 @@ private:
 				uint16_t ticker_handler_idx;
 
 
-				for( int lcv=0; lcv<PIC_QUEUESIZE; lcv++ ) {
-					Bitu pic_addr;
+				// the state format stores the pending events as a list sorted by time, as they were
+				// kept before the heap: free entries keep their free list link, queued entries are
+				// chained in the order they will fire
+				PICEntry *pic_sorted[PIC_QUEUESIZE];
+				std::copy( pic_queue.heap, pic_queue.heap + pic_queue.count, pic_sorted );
+				std::sort( pic_sorted, pic_sorted + pic_queue.count, PIC_EntryBefore );
 
-					pic_addr = (Bitu) pic_queue.entries[lcv].next;
+				for( int lcv=0; lcv<PIC_QUEUESIZE; lcv++ ) {
 					pic_next_ptr[lcv] = 0xffff;
-
-					for( int lcv2=0; lcv2<PIC_QUEUESIZE; lcv2++ ) {
-						if( pic_addr == (Bitu) &pic_queue.entries[lcv2] ) {
-							pic_next_ptr[lcv] = lcv2;
-							break;
-						}
-					}
+					if( pic_queue.entries[lcv].heap_pos == PIC_NOT_QUEUED && pic_queue.entries[lcv].next != NULL )
+						pic_next_ptr[lcv] = (uint16_t)(pic_queue.entries[lcv].next - pic_queue.entries);
 				}
+				for( unsigned int lcv=0; lcv+1<pic_queue.count; lcv++ )
+					pic_next_ptr[pic_sorted[lcv] - pic_queue.entries] = (uint16_t)(pic_sorted[lcv+1] - pic_queue.entries);
+
+				pic_free_idx = 0xffff;
+				if( pic_queue.free_entry != NULL ) pic_free_idx = (uint16_t)(pic_queue.free_entry - pic_queue.entries);
+				pic_next_idx = 0xffff;
+				if( pic_queue.count != 0 ) pic_next_idx = (uint16_t)(pic_sorted[0] - pic_queue.entries);
 
 
 				ticker_size = 0;
@@ -1303,8 +1424,6 @@ private:
         stream.write(reinterpret_cast<const char*>(&pics), sizeof(pics) );
 
 
-				pic_free_idx = 0xffff;
-				pic_next_idx = 0xffff;
 				for( int lcv=0; lcv<PIC_QUEUESIZE; lcv++ ) {
 					uint16_t event_idx;
 
@@ -1318,10 +1437,6 @@ private:
 
 					// - reloc ptr
 					stream.write(reinterpret_cast<const char*>(&pic_next_ptr[lcv]), sizeof(pic_next_ptr[lcv]) );
-
-
-					if( &pic_queue.entries[lcv] == pic_queue.free_entry ) pic_free_idx = lcv;
-					if( &pic_queue.entries[lcv] == pic_queue.next_entry ) pic_next_idx = lcv;
 				}
 
 				// - reloc ptrs
@@ -1405,9 +1520,18 @@ private:
 				if( free_idx != 0xffff )
 					pic_queue.free_entry = &pic_queue.entries[free_idx];
 
-				pic_queue.next_entry = NULL;
-				if( next_idx != 0xffff )
-					pic_queue.next_entry = &pic_queue.entries[next_idx];
+				// rebuild the heap from the sorted list. a sorted array already is a valid heap
+				for( int lcv=0; lcv<PIC_QUEUESIZE; lcv++ ) {
+					pic_queue.entries[lcv].heap_pos = PIC_NOT_QUEUED;
+					pic_queue.entries[lcv].generation++;
+				}
+				pic_queue.count = 0;
+				pic_queue.serial = 0;
+				for( PICEntry *entry = (next_idx != 0xffff) ? &pic_queue.entries[next_idx] : NULL;
+					entry != NULL && entry->heap_pos == PIC_NOT_QUEUED; entry = entry->next ) {
+					entry->serial = pic_queue.serial++;
+					PIC_HeapPlace( pic_queue.count++, entry );
+				}
 
 
 				// - data
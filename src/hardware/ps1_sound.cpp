@@ -147,10 +147,8 @@ static void PS1SOUNDWrite(Bitu port,Bitu data,Bitu iolen) {
 	else
 	{
 		ps1.last_writeSN=PIC_Ticks;
-		if (!ps1.enabledSN) {
-			ps1.chanSN->Enable(true);
-			ps1.enabledSN=true;
-		}
+		ps1.chanSN->Wake();
+		ps1.enabledSN=true;
 	}
 
 #if C_DEBUG != 0
@@ -372,6 +370,7 @@ public:
 		uint32_t sample_rate = (uint32_t)section->Get_int("ps1audiorate");
 		ps1.chanDAC=MixerChanDAC.Install(&PS1SOUNDUpdate,sample_rate,"PS1 DAC");
 		ps1.chanSN=MixerChanSN.Install(&PS1SN76496Update,sample_rate,"PS1 SN76496");
+		ps1.chanSN->SetIdleTimeout(1000);
 
 		ps1.SampleRate=(int)sample_rate;
 		ps1.enabledDAC=false;
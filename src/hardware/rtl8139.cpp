@@ -0,0 +1,584 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Realtek RTL8139C PCI Ethernet controller.
+ *
+ * Unlike the NE2000, which moves every byte through its data port, the RTL8139 is a bus master:
+ * received frames are written into a ring buffer in guest RAM and frames to send are fetched
+ * from guest RAM by the chip, so the packet driver only touches a few registers per frame.
+ * Only the parts of the chip DOS packet drivers and the Windows 9x/Linux drivers use are
+ * emulated: the I/O register window, the receive ring, the four transmit descriptors, the
+ * 93C46 EEPROM and a PHY that always reports a 100 Mbit/s full duplex link. The C+ mode
+ * descriptor rings and the memory mapped register window (BAR1) are not. */
+
+#include <algorithm>
+#include <string.h>
+#include "dosbox.h"
+#include "logging.h"
+#include "inout.h"
+#include "pic.h"
+#include "mem.h"
+#include "timer.h"
+#include "setup.h"
+#include "control.h"
+#include "pci_bus.h"
+#include "ethernet.h"
+#include "rtl8139.h"
+#include "../dos/crc32.h"
+
+#ifdef _MSC_VER
+# define MIN(a,b) ((a) < (b) ? (a) : (b))
+#else
+# define MIN(a,b) std::min(a,b)
+#endif
+
+enum {
+	RTL_IDR0	= 0x00,		/* MAC address */
+	RTL_MAR0	= 0x08,		/* multicast hash */
+	RTL_TSD0	= 0x10,		/* transmit status of descriptor 0-3 */
+	RTL_TSAD0	= 0x20,		/* transmit start address of descriptor 0-3 */
+	RTL_RBSTART	= 0x30,		/* receive buffer start address */
+	RTL_CR		= 0x37,		/* command */
+	RTL_CAPR	= 0x38,		/* current address of packet read */
+	RTL_CBR		= 0x3A,		/* current buffer address */
+	RTL_IMR		= 0x3C,		/* interrupt mask */
+	RTL_ISR		= 0x3E,		/* interrupt status */
+	RTL_TCR		= 0x40,		/* transmit configuration */
+	RTL_RCR		= 0x44,		/* receive configuration */
+	RTL_TCTR	= 0x48,		/* timer count */
+	RTL_MPC		= 0x4C,		/* missed packet counter */
+	RTL_9346CR	= 0x50,		/* 93C46 command */
+	RTL_CONFIG1	= 0x52,
+	RTL_MSR		= 0x58,		/* media status */
+	RTL_TSAD	= 0x60,		/* transmit status of all descriptors */
+	RTL_BMCR	= 0x62,		/* PHY basic mode control */
+	RTL_BMSR	= 0x64,		/* PHY basic mode status */
+	RTL_ANAR	= 0x66,		/* PHY auto-negotiation advertisement */
+	RTL_ANLPAR	= 0x68,		/* PHY auto-negotiation link partner */
+	RTL_ANER	= 0x6A		/* PHY auto-negotiation expansion */
+};
+
+enum {
+	CR_BUFE		= 0x01,		/* receive buffer empty */
+	CR_TE		= 0x04,		/* transmitter enable */
+	CR_RE		= 0x08,		/* receiver enable */
+	CR_RST		= 0x10,		/* reset */
+
+	INT_ROK		= 0x0001,
+	INT_TOK		= 0x0004,
+	INT_RXOVW	= 0x0010,
+
+	TSD_OWN		= 0x00002000,	/* set by the chip once the descriptor was sent */
+	TSD_TOK		= 0x00008000,
+
+	RCR_AAP		= 0x01,		/* accept all packets */
+	RCR_APM		= 0x02,		/* accept physical match */
+	RCR_AM		= 0x04,		/* accept multicast */
+	RCR_AB		= 0x08,		/* accept broadcast */
+	RCR_WRAP	= 0x80,		/* write frames past the end of the ring instead of wrapping */
+
+	RX_ROK		= 0x0001,	/* receive status in the header of each frame in the ring */
+	RX_BAR		= 0x2000,
+	RX_PAM		= 0x4000,
+	RX_MAR		= 0x8000,
+
+	TCR_HWVERID	= 0x74000000,	/* RTL8139C */
+	TCR_LOOPBACK	= 0x00060000
+};
+
+/* bus master DMA moves data between physical (system RAM) addresses and the chip.
+ * Anything outside of RAM is dropped on write and reads back as all ones, like the phys_ functions. */
+static void RTL8139_PhysWrite(PhysPt addr,const uint8_t *src,Bitu len) {
+	if (addr >= MemSize) return;
+	if (len > (MemSize - addr)) len = MemSize - addr;
+	memcpy(MemBase+addr,src,len);
+	MEM_MarkDirtyRange(addr,len);
+}
+
+static void RTL8139_PhysRead(PhysPt addr,uint8_t *dst,Bitu len) {
+	Bitu avail = 0;
+
+	if (addr < MemSize) {
+		avail = MIN(len,(Bitu)(MemSize - addr));
+		memcpy(dst,MemBase+addr,avail);
+	}
+	if (avail < len)
+		memset(dst+avail,0xFF,len-avail);
+}
+
+class RTL8139Device {
+public:
+	RTL8139Device(EthernetConnection *conn,const uint8_t *mac) : ethernet(conn) {
+		/* 93C46 contents as read by the drivers: ID, PCI IDs and the MAC address at word 7 */
+		memset(eeprom,0,sizeof(eeprom));
+		eeprom[0] = 0x8129;
+		eeprom[1] = 0x10EC;
+		eeprom[2] = 0x8139;
+		eeprom[7] = (uint16_t)(mac[0] | (mac[1] << 8));
+		eeprom[8] = (uint16_t)(mac[2] | (mac[3] << 8));
+		eeprom[9] = (uint16_t)(mac[4] | (mac[5] << 8));
+
+		memset(regs,0,sizeof(regs));
+		LoadMAC();
+		Reset();
+	}
+
+	~RTL8139Device() {
+		SetPCIState(0,false,false,irq);
+	}
+
+	void SetPCIState(unsigned int new_base,bool io_enable,bool new_bus_master,unsigned int new_irq) {
+		if (irq_raised) PIC_DeActivateIRQ(irq);
+		irq_raised = false;
+
+		ReadHandler.Uninstall();
+		WriteHandler.Uninstall();
+		base = 0;
+		if (io_enable && new_base != 0) {
+			base = new_base;
+			ReadHandler.Install(base,io_read,IO_MB|IO_MW|IO_MD,256);
+			WriteHandler.Install(base,io_write,IO_MB|IO_MW|IO_MD,256);
+		}
+		bus_master = new_bus_master;
+		irq = (new_irq < 16) ? new_irq : 0xFF;
+		UpdateIRQ();
+	}
+
+	/* a frame from the network */
+	void Receive(const uint8_t *packet,int len) {
+		if (!(regs[RTL_CR] & CR_RE) || !bus_master || len < 14) return;
+
+		const uint32_t rcr = ReadDword(RTL_RCR);
+		uint16_t status = RX_ROK;
+		if (!memcmp(packet,"\xFF\xFF\xFF\xFF\xFF\xFF",6)) {
+			if (!(rcr & (RCR_AB|RCR_AAP))) return;
+			status |= RX_BAR;
+		}
+		else if (packet[0] & 1) {
+			/* the hash is the upper 6 bits of the bit reversed Ethernet CRC of the address */
+			const uint32_t crc = crc32(0,(uint8_t*)packet,6) ^ 0xFFFFFFFFu;
+			unsigned int bit = 0;
+			for (unsigned int i=0;i < 6;i++) bit |= ((crc >> i) & 1u) << (5u - i);
+			if (!(rcr & RCR_AAP) && (!(rcr & RCR_AM) || !(regs[RTL_MAR0 + (bit >> 3u)] & (1u << (bit & 7u))))) return;
+			status |= RX_MAR;
+		}
+		else if (!memcmp(packet,regs+RTL_IDR0,6)) {
+			if (!(rcr & (RCR_APM|RCR_AAP))) return;
+			status |= RX_PAM;
+		}
+		else if (!(rcr & RCR_AAP)) return;
+
+		/* pad runt frames like the network would, then add the CRC */
+		uint8_t frame[4 + 0x2000 + 4];
+		uint32_t size = (uint32_t)len;
+		if (size > 0x2000) return;
+		memcpy(frame+4,packet,size);
+		if (size < 60) {
+			memset(frame+4+size,0,60 - size);
+			size = 60;
+		}
+		const uint32_t crc = crc32(0,frame+4,size);
+		host_writed(frame+4+size,crc);
+		size += 4;
+		host_writew(frame,status);
+		host_writew(frame+2,(uint16_t)size);
+
+		const uint32_t ring = RingSize();
+		const uint32_t avail = (ring + rx_read - rx_write) % ring;
+		if (avail != 0 && ((size + 4 + 3u) & ~3u) >= avail) {
+			/* no room, the frame is lost */
+			WriteDword(RTL_MPC,ReadDword(RTL_MPC) + 1);
+			SetInterrupt(INT_RXOVW);
+			return;
+		}
+
+		const PhysPt start = ReadDword(RTL_RBSTART);
+		if (rcr & RCR_WRAP) {
+			RTL8139_PhysWrite(start + rx_write,frame,size + 4);
+		}
+		else {
+			uint32_t done = 0;
+			while (done < size + 4) {
+				const uint32_t offset = (rx_write + done) % ring;
+				const uint32_t chunk = MIN(size + 4 - done,ring - offset);
+				RTL8139_PhysWrite(start + offset,frame + done,chunk);
+				done += chunk;
+			}
+		}
+		rx_write = (rx_write + ((size + 4 + 3u) & ~3u)) % ring;
+		SetInterrupt(INT_ROK);
+	}
+
+	void Reset(void) {
+		memset(regs+RTL_MAR0,0,0x100-RTL_MAR0);
+		for (unsigned int i=0;i < 4;i++) WriteDword(RTL_TSD0+(i*4u),TSD_OWN);
+		regs[RTL_CR] = CR_BUFE;
+		WriteDword(RTL_TCR,TCR_HWVERID);
+		host_writew(regs+RTL_BMCR,0x3100);	/* auto-negotiation, 100 Mbit/s, full duplex */
+		host_writew(regs+RTL_BMSR,0x782D);	/* link up, auto-negotiation complete */
+		host_writew(regs+RTL_ANAR,0x05E1);
+		host_writew(regs+RTL_ANLPAR,0x45E1);
+		host_writew(regs+RTL_ANER,0x0001);
+		rx_read = rx_write = 0;
+		timer_start = PIC_FullIndex();
+		eeprom_state = EEPROM_IDLE;
+		UpdateIRQ();
+	}
+private:
+	static Bitu io_read(Bitu port,Bitu iolen);
+	static void io_write(Bitu port,Bitu val,Bitu iolen);
+
+	uint32_t RingSize(void) const {
+		return 8192u << ((ReadDword(RTL_RCR) >> 11u) & 3u);
+	}
+
+	uint32_t ReadDword(unsigned int reg) const {
+		return host_readd(regs+reg);
+	}
+	void WriteDword(unsigned int reg,uint32_t val) {
+		host_writed(regs+reg,val);
+	}
+
+	void LoadMAC(void) {
+		for (unsigned int i=0;i < 3;i++)
+			host_writew(regs+RTL_IDR0+(i*2u),eeprom[7+i]);
+	}
+
+	void SetInterrupt(uint16_t bits) {
+		host_writew(regs+RTL_ISR,host_readw(regs+RTL_ISR) | bits);
+		UpdateIRQ();
+	}
+
+	void UpdateIRQ(void) {
+		const bool raise = (host_readw(regs+RTL_ISR) & host_readw(regs+RTL_IMR)) != 0 && irq != 0xFF;
+		if (raise == irq_raised) return;
+		irq_raised = raise;
+		if (raise) PIC_ActivateIRQ(irq);
+		else PIC_DeActivateIRQ(irq);
+	}
+
+	/* the guest handed descriptor n to the chip */
+	void Transmit(unsigned int n) {
+		uint32_t tsd = ReadDword(RTL_TSD0+(n*4u));
+		if ((tsd & TSD_OWN) || !(regs[RTL_CR] & CR_TE) || !bus_master) return;
+
+		uint8_t frame[0x2000];
+		const uint32_t size = tsd & 0x1FFFu;
+		RTL8139_PhysRead(ReadDword(RTL_TSAD0+(n*4u)),frame,size);
+		if ((ReadDword(RTL_TCR) & TCR_LOOPBACK) == TCR_LOOPBACK) Receive(frame,(int)size);
+		else if (ethernet != NULL) ethernet->SendPacket(frame,(int)size);
+
+		tsd |= TSD_OWN | TSD_TOK;
+		WriteDword(RTL_TSD0+(n*4u),tsd);
+		SetInterrupt(INT_TOK);
+	}
+
+	/* 93C46 serial EEPROM in 64 x 16 bit mode, of which only READ is implemented */
+	void WriteEEPROM(uint8_t val) {
+		const uint8_t old = regs[RTL_9346CR];
+		regs[RTL_9346CR] = val & 0xFE;
+		if ((val & 0xC0) == 0x40) {
+			/* auto-load: reload the MAC address and return to normal mode */
+			LoadMAC();
+			regs[RTL_9346CR] = 0;
+			return;
+		}
+		if ((val & 0xC0) != 0x80 || !(val & 0x08)) { /* not programming or chip select low */
+			eeprom_state = EEPROM_IDLE;
+			eeprom_out = 1;
+			return;
+		}
+		if ((old & 0x04) || !(val & 0x04)) return; /* act on rising clock edges only */
+
+		const unsigned int bit = (val >> 1u) & 1u;
+		switch (eeprom_state) {
+			case EEPROM_IDLE:	/* wait for the start bit */
+				if (bit) {
+					eeprom_state = EEPROM_COMMAND;
+					eeprom_shift = 0;
+					eeprom_bits = 0;
+				}
+				break;
+			case EEPROM_COMMAND:	/* 2 opcode bits and 6 address bits */
+				eeprom_shift = (eeprom_shift << 1u) | bit;
+				if (++eeprom_bits == 8) {
+					if ((eeprom_shift >> 6u) == 2u) {
+						eeprom_state = EEPROM_READ;
+						eeprom_addr = eeprom_shift & 0x3Fu;
+						eeprom_shift = eeprom[eeprom_addr];
+						eeprom_bits = 0;
+						eeprom_out = 0; /* dummy zero bit */
+					}
+					else {
+						eeprom_state = EEPROM_IGNORE;
+						eeprom_out = 1;
+					}
+				}
+				break;
+			case EEPROM_READ:	/* shift out 16 bits, then continue with the next word */
+				eeprom_out = (eeprom_shift >> 15u) & 1u;
+				eeprom_shift = (eeprom_shift << 1u) & 0xFFFFu;
+				if (++eeprom_bits == 16) {
+					eeprom_addr = (eeprom_addr + 1u) & 0x3Fu;
+					eeprom_shift = eeprom[eeprom_addr];
+					eeprom_bits = 0;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	uint8_t ReadByte(unsigned int reg) {
+		switch (reg) {
+			case RTL_CR:
+				return (uint8_t)((regs[RTL_CR] & ~CR_BUFE) | ((rx_read % RingSize()) == rx_write ? CR_BUFE : 0));
+			case RTL_CAPR: case RTL_CAPR+1:
+				return (uint8_t)(((rx_read - 16u) & 0xFFFFu) >> ((reg - RTL_CAPR) * 8u));
+			case RTL_CBR: case RTL_CBR+1:
+				return (uint8_t)((rx_write & 0xFFFFu) >> ((reg - RTL_CBR) * 8u));
+			case RTL_TCTR: case RTL_TCTR+1: case RTL_TCTR+2: case RTL_TCTR+3: {
+				/* counts the 33 MHz PCI clock */
+				const uint32_t count = (uint32_t)((PIC_FullIndex() - timer_start) * 33000.0);
+				return (uint8_t)(count >> ((reg - RTL_TCTR) * 8u));
+			}
+			case RTL_9346CR:
+				return (uint8_t)((regs[RTL_9346CR] & 0xFE) | (((regs[RTL_9346CR] & 0xC0) == 0x80) ? eeprom_out : 0));
+			case RTL_TSAD: case RTL_TSAD+1: {
+				uint16_t summary = 0;
+				for (unsigned int i=0;i < 4;i++) {
+					const uint32_t tsd = ReadDword(RTL_TSD0+(i*4u));
+					if (tsd & TSD_OWN) summary |= 1u << i;
+					if (tsd & 0x40000000) summary |= 1u << (i + 4u);	/* aborted */
+					if (tsd & 0x00004000) summary |= 1u << (i + 8u);	/* underrun */
+					if (tsd & TSD_TOK) summary |= 1u << (i + 12u);
+				}
+				return (uint8_t)(summary >> ((reg - RTL_TSAD) * 8u));
+			}
+			default:
+				return regs[reg];
+		}
+	}
+
+	void WriteByte(unsigned int reg,uint8_t val) {
+		switch (reg) {
+			case RTL_CR:
+				if (val & CR_RST) {
+					Reset();
+					return;
+				}
+				regs[RTL_CR] = val & (CR_TE|CR_RE);
+				break;
+			case RTL_ISR: case RTL_ISR+1:	/* write 1 to clear */
+				regs[reg] &= (uint8_t)~val;
+				UpdateIRQ();
+				break;
+			case RTL_IMR: case RTL_IMR+1:
+				regs[reg] = val;
+				UpdateIRQ();
+				break;
+			case RTL_9346CR:
+				WriteEEPROM(val);
+				break;
+			case RTL_TCR+3:
+				regs[reg] = (uint8_t)((val & 0x03) | (TCR_HWVERID >> 24u));
+				break;
+			case RTL_TCR+2:
+				regs[reg] = (uint8_t)((val & 0x07) | ((TCR_HWVERID >> 16u) & 0xC0));
+				break;
+			case RTL_TCTR: case RTL_TCTR+1: case RTL_TCTR+2: case RTL_TCTR+3:
+				timer_start = PIC_FullIndex();
+				break;
+			case RTL_MPC: case RTL_MPC+1: case RTL_MPC+2: case RTL_MPC+3:
+				WriteDword(RTL_MPC,0);
+				break;
+			case RTL_BMCR+1:
+				regs[reg] = val & 0x7F;	/* PHY reset completes at once */
+				break;
+			case RTL_CBR: case RTL_CBR+1: case RTL_MSR:
+			case RTL_TSAD: case RTL_TSAD+1:
+			case RTL_BMSR: case RTL_BMSR+1:
+			case RTL_ANLPAR: case RTL_ANLPAR+1:
+			case RTL_ANER: case RTL_ANER+1:
+				break;	/* read only */
+			default:
+				regs[reg] = val;
+				break;
+		}
+	}
+
+	void Write(unsigned int reg,uint32_t val,unsigned int len) {
+		for (unsigned int i=0;i < len && (reg + i) < 0x100;i++) {
+			const unsigned int r = reg + i;
+			if (r == RTL_CAPR || r == RTL_CAPR+1) {
+				uint16_t capr = (uint16_t)(rx_read - 16u);
+				if (r == RTL_CAPR) capr = (uint16_t)((capr & 0xFF00) | (val & 0xFF));
+				else capr = (uint16_t)((capr & 0x00FF) | ((val & 0xFF) << 8u));
+				rx_read = (capr + 16u) % RingSize();
+			}
+			else {
+				WriteByte(r,(uint8_t)(val & 0xFF));
+			}
+			val >>= 8u;
+		}
+		/* a write to the upper half of TSDn (with the OWN bit) hands the descriptor to the chip */
+		for (unsigned int n=0;n < 4;n++) {
+			const unsigned int own = RTL_TSD0 + (n*4u) + 1u;
+			if (reg <= own && own < reg + len) Transmit(n);
+		}
+	}
+
+	uint32_t Read(unsigned int reg,unsigned int len) {
+		uint32_t val = 0;
+		for (unsigned int i=0;i < len && (reg + i) < 0x100;i++)
+			val |= (uint32_t)ReadByte(reg + i) << (i * 8u);
+		return val;
+	}
+
+	enum EEPROMState { EEPROM_IDLE, EEPROM_COMMAND, EEPROM_READ, EEPROM_IGNORE };
+
+	EthernetConnection*	ethernet;
+	uint8_t			regs[0x100];
+	uint16_t		eeprom[64];
+	EEPROMState		eeprom_state = EEPROM_IDLE;
+	uint32_t		eeprom_shift = 0;
+	unsigned int		eeprom_bits = 0;
+	unsigned int		eeprom_addr = 0;
+	uint8_t			eeprom_out = 1;
+	uint32_t		rx_read = 0;		/* CAPR + 16, where the driver reads the next frame */
+	uint32_t		rx_write = 0;		/* CBR, where the next frame is stored */
+	pic_tickindex_t		timer_start = 0;
+	unsigned int		base = 0;
+	bool			bus_master = false;
+	unsigned int		irq = 0xFF;
+	bool			irq_raised = false;
+	IO_ReadHandleObject	ReadHandler;
+	IO_WriteHandleObject	WriteHandler;
+
+	friend void RTL8139_SetPCIState(unsigned int base,bool io_enable,bool bus_master,unsigned int irq);
+};
+
+static RTL8139Device *rtl8139 = NULL;
+static EthernetConnection *rtl8139_ethernet = NULL;
+
+Bitu RTL8139Device::io_read(Bitu port,Bitu iolen) {
+	if (rtl8139 == NULL) return ~0ul;
+	return rtl8139->Read((unsigned int)(port - rtl8139->base),(unsigned int)iolen);
+}
+
+void RTL8139Device::io_write(Bitu port,Bitu val,Bitu iolen) {
+	if (rtl8139 == NULL) return;
+	rtl8139->Write((unsigned int)(port - rtl8139->base),(uint32_t)val,(unsigned int)iolen);
+}
+
+void RTL8139_SetPCIState(unsigned int base,bool io_enable,bool bus_master,unsigned int irq) {
+	if (rtl8139 != NULL) rtl8139->SetPCIState(base,io_enable,bus_master,irq);
+}
+
+static void RTL8139_Poller(void) {
+	rtl8139_ethernet->GetPackets([](const uint8_t* packet, int len) {
+		rtl8139->Receive(packet,len);
+	});
+}
+
+class RTL8139: public Module_base {
+public:
+	bool load_success = false;
+	unsigned int irq = 11;
+
+	RTL8139(Section* configuration):Module_base(configuration) {
+		Section_prop * section=static_cast<Section_prop *>(configuration);
+
+		if (!section->Get_bool("ne2000") || strcmp(section->Get_string("nic type"),"rtl8139")) return;
+		if (!pcibus_enable) {
+			LOG_MSG("RTL8139: The PCI bus is disabled, no network card emulated");
+			return;
+		}
+
+		uint8_t mac[6];
+		ETHERNET_ParseMacAddress(section->Get_string("macaddr"),mac);
+
+		const char* backendstring = section->Get_string("backend");
+		rtl8139_ethernet = OpenEthernetConnection(backendstring, section->Get_bool("backend thread"), mac);
+		if (!rtl8139_ethernet) {
+			LOG_MSG("RTL8139: Failed to open Ethernet backend %s", backendstring);
+			return;
+		}
+
+		irq = (unsigned int)section->Get_int("nicirq");
+		if (!(irq==3 || irq==4  || irq==5  || irq==6 ||irq==7 ||
+			irq==9 || irq==10 || irq==11 || irq==12 ||irq==14 ||irq==15)) {
+			irq=11;
+		}
+
+		rtl8139 = new RTL8139Device(rtl8139_ethernet,mac);
+		PCI_AddRTL8139_Device(irq);
+		LOG_MSG("RTL8139: PCI network card, irq=%u",irq);
+
+		TIMER_AddTickHandler(RTL8139_Poller);
+		load_success = true;
+	}
+
+	~RTL8139() {
+		if (!load_success) {
+			if (rtl8139_ethernet) delete rtl8139_ethernet;
+			rtl8139_ethernet = nullptr;
+			return;
+		}
+		TIMER_DelTickHandler(RTL8139_Poller);
+		PCI_RemoveRTL8139_Device();
+		delete rtl8139;
+		rtl8139 = NULL;
+		delete rtl8139_ethernet;
+		rtl8139_ethernet = nullptr;
+	}
+};
+
+static RTL8139* rtl8139_module = NULL;
+
+void RTL8139_ShutDown(Section* sec) {
+	(void)sec;//UNUSED
+	if (rtl8139_module) {
+		delete rtl8139_module;
+		rtl8139_module = NULL;
+	}
+}
+
+void RTL8139_OnReset(Section* sec) {
+	(void)sec;//UNUSED
+	if (rtl8139_module == NULL && !IS_PC98_ARCH) {
+		rtl8139_module = new RTL8139(control->GetSection("ne2000"));
+
+		if (!rtl8139_module->load_success) {
+			delete rtl8139_module;
+			rtl8139_module = NULL;
+		}
+	}
+	/* the PCI bus drops its devices on power on, put the card back into its slot */
+	else if (rtl8139_module != NULL) {
+		rtl8139->Reset();
+		PCI_AddRTL8139_Device(rtl8139_module->irq);
+	}
+}
+
+void RTL8139_Init() {
+	LOG(LOG_MISC,LOG_DEBUG)("Initializing RTL8139 network card emulation");
+
+	AddExitFunction(AddExitFunctionFuncPair(RTL8139_ShutDown),true);
+	AddVMEventFunction(VM_EVENT_RESET,AddVMEventFunctionFuncPair(RTL8139_OnReset));
+}
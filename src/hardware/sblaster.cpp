@@ -437,6 +437,8 @@ struct SB_INFO {
 			      The DMA emulation here does not handle that well. */
 	bool goldplay;
 	bool goldplay_stereo;
+	bool block_dma; /* render DMA audio on mixer ticks only, with the end of each block on its own event */
+	PIC_EventHandle dma_end_event; /* pending END_DMA_Event of block_dma mode, 0 if none */
 	bool write_status_must_return_7f; // WRITE_STATUS (port base+0xC) must return 0x7F or 0xFF if set. Some very early demos rely on it.
 	bool busy_cycle_always;
 	bool ess_playback_mode;
@@ -587,6 +589,7 @@ struct SB_INFO {
 	void DSP_FlushData(void);
 	std::string GetSBtype();
 	void CheckDMAEnd(void);
+	void RemoveDMAEndEvent(void);
 	bool DSP_busy_cycle();
 	void DSP_Reset(void);
 	void ESS_StartDMA();
@@ -812,7 +815,7 @@ void SB_INFO::sb_update_recording_source_settings() {
 void SB_INFO::SB_OnEndOfDMA(void) {
 	bool was_irq=false;
 
-	PIC_RemoveEvents(END_DMA_Event);
+	RemoveDMAEndEvent();
 	if (ess_type == ESS_NONE && reveal_sc_type == RSC_NONE && dma.mode >= DSP_DMA_16) {
 		was_irq = irq.pending_16bit;
 		SB_RaiseIRQ(SB_IRQ_16);
@@ -846,6 +849,9 @@ void SB_INFO::SB_OnEndOfDMA(void) {
 			LOG(LOG_SB,LOG_WARN)("DMA ended when previous IRQ had not yet been acked");
 			mode=MODE_DMA_REQUIRE_IRQ_ACK;
 		}
+		else if (block_dma && mode==MODE_DMA) {
+			CheckDMAEnd();
+		}
 	}
 }
 
@@ -861,7 +867,7 @@ void SB_INFO::GenerateDMASound(Bitu size) {
 
 	if(dma.autoinit) {
 		if (dma.left <= size) size = dma.left;
-	} else {
+	} else if (!dma_end_event) {
 		if (dma.left <= dma.min)
 			size = dma.left;
 	}
@@ -1008,9 +1014,20 @@ void SB_INFO::GenerateDMASound(Bitu size) {
 						dma.buf.b8[0]=dma.buf.b8[total-1];
 					} else dma.remain_size=0;
 				} else {
-					read=dma.chan->Read(size,dma.buf.b8);
-					if (!dma.sign) chan->AddSamples_m8(read,dma.buf.b8);
-					else chan->AddSamples_m8s(read,(int8_t *)dma.buf.b8);
+					/* mono samples need no carry-over, so hand guest RAM straight to the mixer */
+					read=0;
+					while (read < size) {
+						const uint8_t *span;
+						Bitu got=dma.chan->ReadSpan(size-read,span);
+						if (got == 0) {
+							got=dma.chan->Read(size-read,dma.buf.b8);
+							span=dma.buf.b8;
+							if (got == 0) break;
+						}
+						if (!dma.sign) chan->AddSamples_m8(got,span);
+						else chan->AddSamples_m8s(got,(const int8_t *)span);
+						read+=got;
+					}
 				}
 				break;
 			case DSP_DMA_16:
@@ -1033,6 +1050,25 @@ void SB_INFO::GenerateDMASound(Bitu size) {
 						dma.remain_size=1;
 						dma.buf.b16[0]=dma.buf.b16[total-1];
 					} else dma.remain_size=0;
+				} else if (dma.mode==DSP_DMA_16) {
+					read=0;
+					while (read < size) {
+						const uint8_t *span;
+						Bitu got=dma.chan->ReadSpan(size-read,span);
+						if (got == 0) {
+							got=dma.chan->Read(size-read,(uint8_t *)dma.buf.b16);
+							span=(const uint8_t *)dma.buf.b16;
+							if (got == 0) break;
+						}
+#if defined(WORDS_BIGENDIAN)
+						if (dma.sign) chan->AddSamples_m16_nonnative(got,(const int16_t *)span);
+						else chan->AddSamples_m16u_nonnative(got,(const uint16_t *)span);
+#else
+						if (dma.sign) chan->AddSamples_m16(got,(const int16_t *)span);
+						else chan->AddSamples_m16u(got,(const uint16_t *)span);
+#endif
+						read+=got;
+					}
 				} else {
 					read=dma.chan->Read(size,(uint8_t *)dma.buf.b16)
 						>> (dma.mode==DSP_DMA_16_ALIASED ? 1:0);
@@ -1064,6 +1100,12 @@ void SB_INFO::CheckDMAEnd(void) {
 		float delay=(bigger*1000.0f)/dma.rate;
 		PIC_AddEvent(DMA_Silent_Event,delay,bigger | (card_index << CARD_INDEX_BIT));
 		LOG(LOG_SB,LOG_NORMAL)("Silent DMA Transfer scheduling IRQ in %.3f milliseconds",delay);
+	} else if (block_dma && !dma_dac_mode) {
+		/* The mixer ticks render the block up to its last sample, END_DMA_Event renders
+		 * the rest and raises the IRQ at the emulated time the block ends */
+		const double delay=(dma.left*1000.0)/dma.rate;
+		if (dma_end_event) PIC_RemoveEventHandle(dma_end_event);
+		dma_end_event=PIC_AddEventHandle(END_DMA_Event,delay,dma.left | (card_index << CARD_INDEX_BIT));
 	} else if (dma.left<dma.min) {
 		float delay=(dma.left*1000.0f)/dma.rate;
 		LOG(LOG_SB,LOG_NORMAL)("Short transfer scheduling IRQ in %.3f milliseconds",delay);
@@ -1071,6 +1113,14 @@ void SB_INFO::CheckDMAEnd(void) {
 	}
 }
 
+void SB_INFO::RemoveDMAEndEvent(void) {
+	/* only this card's events, other cards keep theirs pending. Block DMA holds a handle,
+	 * the other path tags the event value with the card index */
+	if (dma_end_event) PIC_RemoveEventHandle(dma_end_event);
+	dma_end_event=0;
+	PIC_RemoveMaskedEvents(END_DMA_Event,card_index << CARD_INDEX_BIT,~((Bitu(1u) << CARD_INDEX_BIT) - 1u));
+}
+
 void SB_INFO::DSP_ChangeMode(DSP_MODES new_mode) {
 	if (mode == new_mode) return;
 	else chan->FillUp();
@@ -1193,7 +1243,7 @@ void SB_INFO::DSP_DoDMATransfer(DMA_MODES new_mode,Bitu freq,bool stereo,bool do
 	}
 	dma.mode=dma.mode_assigned=new_mode;
 	PIC_RemoveEvents(DMA_DAC_Event);
-	PIC_RemoveEvents(END_DMA_Event);
+	RemoveDMAEndEvent();
 
 	if (dma_dac_mode)
 		PIC_AddEvent(DMA_DAC_Event,1000.0 / dma_dac_srcrate,(card_index << CARD_INDEX_BIT));
@@ -1450,7 +1500,7 @@ void SB_INFO::DSP_Reset(void) {
 	chan->SetFreq(22050);
 	updateSoundBlasterFilter(22050);
 	//  DSP_SetSpeaker(false);
-	PIC_RemoveEvents(END_DMA_Event);
+	RemoveDMAEndEvent();
 	PIC_RemoveEvents(DMA_DAC_Event);
 }
 
@@ -1506,6 +1556,7 @@ void SB_INFO::ESS_StartDMA() {
 		(ESSreg(0xB7/*Audio Control 1*/)&4)?DSP_DMA_16_ALIASED:DSP_DMA_8,
 		freq,(ESSreg(0xA8/*Analog control*/)&3)==1?1:0/*stereo*/,true/*don't change dma.left*/);
 	mode = MODE_DMA;
+	if (block_dma) CheckDMAEnd();
 	ess_playback_mode = true;
 }
 
@@ -1513,7 +1564,7 @@ void SB_INFO::ESS_StopDMA() {
 	// DMA stop
 	DSP_ChangeMode(MODE_NONE);
 	if (dma.chan) dma.chan->Clear_Request();
-	PIC_RemoveEvents(END_DMA_Event);
+	RemoveDMAEndEvent();
 	PIC_RemoveEvents(DMA_DAC_Event);
 }
 
@@ -2263,7 +2314,7 @@ is responsible for some failures such as [https://github.com/joncampbell123/dosb
 				// possibly different code here that does not switch to MODE_DMA_PAUSE
 			}
 			mode=MODE_DMA_PAUSE;
-			PIC_RemoveEvents(END_DMA_Event);
+			RemoveDMAEndEvent();
 			PIC_RemoveEvents(DMA_DAC_Event);
 			break;
 		case 0xd1:  /* Enable Speaker */
@@ -3116,6 +3167,7 @@ Bitu SB_INFO::read_sb(Bitu port,Bitu /*iolen*/) {
 			if (mode == MODE_DMA_REQUIRE_IRQ_ACK) {
 				chan->FillUp();
 				mode = MODE_DMA;
+				if (block_dma) CheckDMAEnd();
 			}
 
 			extern const char* RunningProgram; // Wengier: Hack for Desert Strike & Jungle Strike
@@ -3137,6 +3189,7 @@ Bitu SB_INFO::read_sb(Bitu port,Bitu /*iolen*/) {
 				if (mode == MODE_DMA_REQUIRE_IRQ_ACK) {
 					chan->FillUp();
 					mode = MODE_DMA;
+					if (block_dma) CheckDMAEnd();
 				}
 			}
 			break;
@@ -3262,6 +3315,12 @@ static void SBLASTER_CallBack(const size_t ci,Bitu len) {
 			if (len&SB_SH_MASK) len+=1 << SB_SH;
 			len>>=SB_SH;
 			if (len>sb[ci].dma.left) len=sb[ci].dma.left;
+			if (sb[ci].dma_end_event) {
+				/* leave the last sample of the block to END_DMA_Event so the IRQ comes on time */
+				Bitu hold=sb[ci].dma.mul >> SB_SH;
+				if (!hold) hold=1;
+				if ((len+hold) > sb[ci].dma.left) len=(sb[ci].dma.left > hold) ? (sb[ci].dma.left-hold) : 0;
+			}
 			sb[ci].GenerateDMASound(len);
 			break;
 	}
@@ -3581,7 +3640,8 @@ static void DSP_DMA_CallBack(DmaChannel * chan, DMAEvent event) {
 	assert(ci < MAX_CARDS);
 	if (chan!=sb[ci].dma.chan || event==DMA_REACHED_TC) return;
 	else if (event==DMA_READ_COUNTER) {
-		sb[ci].chan->FillUp();
+		/* in block mode the counter moves on mixer ticks, not on every read of it */
+		if (!sb[ci].block_dma) sb[ci].chan->FillUp();
 	}
 	else if (event==DMA_MASKED) {
 		if (sb[ci].mode==MODE_DMA) {
@@ -3756,6 +3816,13 @@ static void DMA_DAC_Event(Bitu val) {
 static void END_DMA_Event(Bitu val) {
 	const size_t ci = (size_t)(val >> (Bitu)CARD_INDEX_BIT); val &= (1u << CARD_INDEX_BIT) - 1u;
 	assert(ci < MAX_CARDS);
+	if (sb[ci].block_dma) {
+		/* not ours if it was cancelled, or came back with a save state */
+		if (!sb[ci].dma_end_event) return;
+		sb[ci].dma_end_event = 0;
+		if (sb[ci].mode != MODE_DMA) return;
+		val = sb[ci].dma.left;
+	}
 	sb[ci].GenerateDMASound(val);
 }
 
@@ -4003,6 +4070,8 @@ class SBLASTER: public Module_base {
 			sb[ci].ASP_mode = 0x00;
 			sb[ci].goldplay=section->Get_bool("goldplay");
 			sb[ci].min_dma_user=section->Get_int("mindma");
+			sb[ci].block_dma=section->Get_bool("block dma");
+			sb[ci].dma_end_event=0;
 			sb[ci].goldplay_stereo=section->Get_bool("goldplay stereo");
 			sb[ci].emit_blaster_var=section->Get_bool("blaster environment variable");
 			sb[ci].sample_rate_limits=section->Get_bool("sample rate limits");
@@ -4660,6 +4729,9 @@ void POD_Load_Sblaster( std::istream& stream )
 	sb[ci].dma.chan = NULL;
 	if( dma_idx != 0xff ) sb[ci].dma.chan = GetDMAChannel(dma_idx);
 
+	// - event handles don't survive, the next block end schedules a new one
+	sb[ci].dma_end_event = 0;
+
 	//*******************************************
 	//*******************************************
 	//*******************************************
@@ -41,6 +41,7 @@
 #include "logging.h"
 #include "misc_util.h"
 #include "timer.h"
+#include <algorithm>
 #include <cassert>
 #include <limits.h>
 
@@ -625,6 +626,7 @@ TCPClientSocket::TCPClientSocket(int platformsocket)
 		if(!listensocketset) return;
 		SDLNet_TCP_AddSocket(listensocketset, mysock);
 		isopen=true;
+		StartReceiver();
 		return;
 	}
 	return;
@@ -643,6 +645,7 @@ TCPClientSocket::TCPClientSocket(TCPsocket source)
 		SDLNet_TCP_AddSocket(listensocketset, source);
 
 		isopen=true;
+		StartReceiver();
 	}
 }
 
@@ -661,11 +664,16 @@ TCPClientSocket::TCPClientSocket(const char *destination, uint16_t port)
 			return;
 		SDLNet_TCP_AddSocket(listensocketset, mysock);
 		isopen=true;
+		StartReceiver();
 	}
 }
 
 TCPClientSocket::~TCPClientSocket()
 {
+	receiveQuit = true;
+	if (receiver.joinable())
+		receiver.join();
+
 #ifdef NATIVESOCKETS
 	delete nativetcpstruct;
 #endif
@@ -693,38 +701,73 @@ bool TCPClientSocket::GetRemoteAddressString(char *buffer)
 	return true;
 }
 
+void TCPClientSocket::StartReceiver()
+{
+	receiver = std::thread(&TCPClientSocket::Receiver, this);
+}
+
+void TCPClientSocket::Receiver()
+{
+	// don't read ahead without bounds when the guest stops reading
+	constexpr size_t max_buffered = 64 * 1024;
+	uint8_t chunk[4096];
+
+	while (!receiveQuit) {
+		bool full;
+		{
+			std::lock_guard<std::mutex> guard(receiveLock);
+			full = receiveBuffer.size() >= max_buffered;
+		}
+		if (full) {
+			SDL_Delay(5);
+			continue;
+		}
+		// wake up now and then to notice the destructor
+		const int ready = SDLNet_CheckSockets(listensocketset, 20);
+		if (ready < 0) {
+			SDL_Delay(20);
+			continue;
+		}
+		if (ready == 0)
+			continue;
+		const int result = SDLNet_TCP_Recv(mysock, chunk, sizeof(chunk));
+		if (result < 1) {
+			receiveClosed = true;
+			return;
+		}
+		std::lock_guard<std::mutex> guard(receiveLock);
+		receiveBuffer.insert(receiveBuffer.end(), chunk, chunk + result);
+	}
+}
+
 bool TCPClientSocket::ReceiveArray(uint8_t *data, size_t &n)
 {
 	assert(data);
-	if (SDLNet_CheckSockets(listensocketset, 0)) {
-		const int result = SDLNet_TCP_Recv(mysock, data, static_cast<int>(n));
-		if(result < 1) {
-			isopen = false;
-			n = 0;
-			return false;
-		} else {
-			n = result;
-			return true;
-		}
-	} else {
+	std::lock_guard<std::mutex> guard(receiveLock);
+	if (receiveBuffer.empty() && receiveClosed) {
+		isopen = false;
 		n = 0;
-		return true;
+		return false;
 	}
+	n = std::min(n, receiveBuffer.size());
+	std::copy(receiveBuffer.begin(), receiveBuffer.begin() + n, data);
+	receiveBuffer.erase(receiveBuffer.begin(), receiveBuffer.begin() + n);
+	return true;
 }
 
 SocketState TCPClientSocket::GetcharNonBlock(uint8_t &val)
 {
-	SocketState state = SocketState::Empty;
-	if(SDLNet_CheckSockets(listensocketset,0))
-	{
-		if (SDLNet_TCP_Recv(mysock, &val, 1) == 1)
-			state = SocketState::Good;
-		else {
-			isopen = false;
-			state = SocketState::Closed;
-		}
+	std::lock_guard<std::mutex> guard(receiveLock);
+	if (!receiveBuffer.empty()) {
+		val = receiveBuffer.front();
+		receiveBuffer.pop_front();
+		return SocketState::Good;
 	}
-	return state;
+	if (receiveClosed) {
+		isopen = false;
+		return SocketState::Closed;
+	}
+	return SocketState::Empty;
 }
 
 bool TCPClientSocket::Putchar(uint8_t val)
@@ -57,7 +57,11 @@
 // This is basically how TCP behaves anyway.
 //#define ENET_BLOCKING_CONNECT
 
+#include <atomic>
+#include <deque>
+#include <mutex>
 #include <queue>
+#include <thread>
 #ifndef ENET_BLOCKING_CONNECT
 #include <ctime>
 #endif
@@ -215,6 +219,11 @@ public:
 	bool GetRemoteAddressString(char *buffer) override;
 
 private:
+	// Incoming data is read by a network thread of its own into receiveBuffer,
+	// in chunks as large as the socket has ready, so that the emulated serial
+	// port never waits for (or polls) the socket itself.
+	void StartReceiver();
+	void Receiver();
 
 #ifdef NATIVESOCKETS
 	_TCPsocketX *nativetcpstruct = nullptr;
@@ -222,6 +231,12 @@ private:
 
 	TCPsocket mysock = nullptr;
 	SDLNet_SocketSet listensocketset = nullptr;
+
+	std::thread          receiver      = {};
+	std::mutex           receiveLock   = {};
+	std::deque<uint8_t>  receiveBuffer = {}; // protected by receiveLock
+	std::atomic<bool>    receiveQuit   = {false};
+	std::atomic<bool>    receiveClosed = {false}; // set after the last byte was buffered
 };
 
 class TCPServerSocket : public NETServerSocket {
@@ -22,6 +22,8 @@
 
 #if C_MODEM
 
+#include <algorithm>
+
 #include "control.h"
 #include "logging.h"
 #include "serialport.h"
@@ -43,6 +45,8 @@ CNullModem::CNullModem(Bitu id, CommandLine* cmd):CSerial (id, cmd) {
 	rx_state=N_RX_DISC;
 
 	tx_gather = 12;
+	tx_idle = 2;
+	tx_start = 0;
 	
 	dtrrespect=false;
 	tx_block=false;
@@ -103,6 +107,15 @@ CNullModem::CNullModem(Bitu id, CommandLine* cmd):CSerial (id, cmd) {
 			tx_gather=12;
 		}
 	}
+	// txidle: Send the gathered data as soon as the application stopped
+	// writing for this many characters, instead of always waiting txdelay.
+	// Bulk transfers still go out in txdelay sized chunks while typed
+	// characters and short replies don't wait for the whole window.
+	if (getBituSubstring("txidle:", &tx_idle, cmd)) {
+		if (!(tx_idle<=1000)) {
+			tx_idle=2;
+		}
+	}
 	// port is for both server and client
 	if (getBituSubstring("port:", &temptcpport, cmd)) {
 		if (!(temptcpport>0&&temptcpport<65536)) {
@@ -180,9 +193,18 @@ void CNullModem::WriteChar(uint8_t data) {
 	if (clientsocket)clientsocket->SendByteBuffered(data);
 	if (!tx_block) {
 		//LOG_MSG("setevreduct");
-		setEvent(SERIAL_TX_REDUCTION, (float)tx_gather);
+		tx_start = PIC_FullIndex();
+		if (!tx_idle) setEvent(SERIAL_TX_REDUCTION, (float)tx_gather);
 		tx_block=true;
 	}
+	if (tx_idle) {
+		// restart the idle window, but never beyond txdelay after the first byte
+		const pic_tickindex_t now = PIC_FullIndex();
+		const pic_tickindex_t flush = std::min(now + (pic_tickindex_t)bytetime * tx_idle,
+		                                       tx_start + (pic_tickindex_t)tx_gather);
+		removeEvent(SERIAL_TX_REDUCTION);
+		setEvent(SERIAL_TX_REDUCTION, (float)std::max(flush - now, (pic_tickindex_t)0.01));
+	}
 }
 
 Bits CNullModem::readChar(uint8_t &val) {
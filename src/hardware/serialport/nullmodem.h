@@ -26,6 +26,7 @@
 #if C_MODEM
 
 #include "misc_util.h"
+#include "pic.h"
 #include "serialport.h"
 
 #define SERIAL_SERVER_POLLING_EVENT	SERIAL_BASE_EVENT_COUNT+1
@@ -90,6 +91,11 @@ private:
 	Bitu tx_gather;		// how long to gather tx data before
 						// sending all of them [milliseconds]
 
+	Bitu tx_idle;		// send gathered data once no more was written
+						// for this many character times (0: wait tx_gather)
+
+	pic_tickindex_t tx_start;	// when the first gathered byte was written
+
 	
 	bool dtrrespect;	// dtr behavior - only send data to the serial
 						// port when DTR is on
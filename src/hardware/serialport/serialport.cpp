@@ -302,6 +302,16 @@ void CSerial::handleEvent(uint16_t type) {
 			break;					  
 		}
 		case SERIAL_RX_TIMEOUT_EVENT: {
+			rx_timeout_queued=false;
+			if(!rx_timeout_armed) break;
+			const pic_tickindex_t remain = rx_timeout_deadline - PIC_FullIndex();
+			if(remain > 0.001) {
+				// bytes moved since this was scheduled
+				rx_timeout_queued=true;
+				setEvent(SERIAL_RX_TIMEOUT_EVENT,(float)remain);
+				break;
+			}
+			rx_timeout_armed=false;
 			rise(TIMEOUT_PRIORITY);
 			break;
 		}
@@ -376,6 +386,22 @@ void CSerial::ComputeInterrupts () {
 	}
 }
 
+/*****************************************************************************/
+/* FIFO timeout: 4 character times without a byte received or read          **/
+/*****************************************************************************/
+void CSerial::armRxTimeout() {
+	rx_timeout_deadline = PIC_FullIndex() + bytetime*4.0f;
+	rx_timeout_armed = true;
+	if(!rx_timeout_queued) {
+		rx_timeout_queued = true;
+		setEvent(SERIAL_RX_TIMEOUT_EVENT,bytetime*4.0f);
+	}
+}
+
+void CSerial::disarmRxTimeout() {
+	rx_timeout_armed = false;
+}
+
 /*****************************************************************************/
 /* Can a byte be received?                                                  **/
 /*****************************************************************************/
@@ -395,9 +421,11 @@ void CSerial::receiveByteEx (uint8_t data, uint8_t error) {
 		// Overrun error ;o
 		error |= LSR_OVERRUN_ERROR_MASK;
 	}
-	removeEvent(SERIAL_RX_TIMEOUT_EVENT);
-	if(rxfifo->getUsage()==rx_interrupt_threshold) rise (RX_PRIORITY);
-	else setEvent(SERIAL_RX_TIMEOUT_EVENT,bytetime*4.0f);
+	if(rxfifo->getUsage()==rx_interrupt_threshold) {
+		disarmRxTimeout();
+		rise (RX_PRIORITY);
+	}
+	else armRxTimeout();
 
 	if(error) {
 		// A lot of UART chips generate a framing error too when receiving break
@@ -578,8 +606,8 @@ Bitu CSerial::Read_RHR () {
 		clear (TIMEOUT_PRIORITY);
 		// RX int. is cleared if the buffer holds less data than the threshold
 		if(rxfifo->getUsage()<rx_interrupt_threshold)clear(RX_PRIORITY);
-		removeEvent(SERIAL_RX_TIMEOUT_EVENT);
-		if(!rxfifo->isEmpty()) setEvent(SERIAL_RX_TIMEOUT_EVENT,bytetime*4.0f);
+		if(!rxfifo->isEmpty()) armRxTimeout();
+		else disarmRxTimeout();
 		return data;
 	}
 }
@@ -1113,6 +1141,9 @@ CSerial::CSerial(Bitu id, CommandLine* cmd) {
     loopback_data = 0;
     errors_in_fifo = 0;
     rx_interrupt_threshold = 0;
+    rx_timeout_deadline = 0;
+    rx_timeout_armed = false;
+    rx_timeout_queued = false;
     FCR = 0;
     sync_guardtime = false;
 
@@ -38,12 +38,25 @@
 
 #define SOUND_CLOCK (14318180 / 4)
 
+#if !defined(M_PI)
+# define M_PI (3.141592654)
+#endif
+
+/* The PSG is rendered in blocks at TANDY_OVERSAMPLE times the output rate, each sample the
+ * average of the chip output over its period, and a short windowed-sinc FIR decimates that to
+ * the output rate. Only every TANDY_OVERSAMPLE'th output of the FIR is computed. */
+#define TANDY_OVERSAMPLE 4
+#define TANDY_FIR_TAPS (12*TANDY_OVERSAMPLE)
+
 #define TDAC_DMA_BUFSIZE 1024
 
 static struct {
 	MixerChannel * chan;
 	bool enabled;
 	Bitu last_write;
+	float fir[TANDY_FIR_TAPS];
+	float over[(TANDY_FIR_TAPS-1)+(2048*TANDY_OVERSAMPLE)]; /* oversampled input, the first TANDY_FIR_TAPS-1 are history */
+	Bitu muted_samples; /* oversampled samples fed since all four voices went silent */
 	struct {
 		MixerChannel * chan;
 		bool enabled;
@@ -73,10 +86,8 @@ static sn76496_base_device* activeDevice = &device_ncr8496;
 
 static void SN76496Write(Bitu /*port*/,Bitu data,Bitu /*iolen*/) {
 	tandy.last_write=PIC_Ticks;
-	if (!tandy.enabled) {
-		tandy.chan->Enable(true);
-		tandy.enabled=true;
-	}
+	tandy.chan->Wake();
+	tandy.enabled=true;
 
 	// assume state change, always.
 	// this hack allows sample accurate rendering without enabling sample accurate mode in the mixer.
@@ -97,11 +108,44 @@ static void SN76496Update(Bitu length) {
 	const Bitu MAX_SAMPLES = 2048;
 	if (length > MAX_SAMPLES)
 		return;
+
+	const Bitu hist = TANDY_FIR_TAPS-1;
+	const Bitu n = length*TANDY_OVERSAMPLE;
+
+	/* All four voices at full attenuation: the output is flat, so there is no need to run
+	 * the chip. Once the filter has rung out, suspend the channel until the next write. */
+	if (device.muted()) {
+		if (tandy.muted_samples >= hist) {
+			tandy.chan->Enable(false);
+			return;
+		}
+		for (Bitu i=0;i < n;i++) tandy.over[hist+i] = 0.0f;
+		tandy.muted_samples += n;
+	}
+	else {
+		device.render_block(&tandy.over[hist], (int)n);
+		tandy.muted_samples = 0;
+	}
+
 	int16_t buffer[MAX_SAMPLES];
-	int16_t* outputs = buffer;
 
-	device_sound_interface::sound_stream stream;
-	static_cast<device_sound_interface&>(device).sound_stream_update(stream, nullptr, &outputs, (int)length);
+	/* four independent accumulators over float arrays, which the compiler vectorizes */
+	for (Bitu i=0;i < length;i++) {
+		const float *x = &tandy.over[i*TANDY_OVERSAMPLE];
+		float acc0 = 0,acc1 = 0,acc2 = 0,acc3 = 0;
+		for (unsigned int t=0;t < TANDY_FIR_TAPS;t += 4) {
+			acc0 += x[t+0]*tandy.fir[t+0];
+			acc1 += x[t+1]*tandy.fir[t+1];
+			acc2 += x[t+2]*tandy.fir[t+2];
+			acc3 += x[t+3]*tandy.fir[t+3];
+		}
+		float acc = (acc0 + acc1) + (acc2 + acc3);
+		if (acc > 32767.0f) acc = 32767.0f;
+		else if (acc < -32768.0f) acc = -32768.0f;
+		buffer[i] = (int16_t)lrintf(acc);
+	}
+	memmove(&tandy.over[0], &tandy.over[n], hist*sizeof(float));
+
 	tandy.chan->AddSamples_m16(length, buffer);
 }
 
@@ -338,6 +382,7 @@ public:
 
 		uint32_t sample_rate = section->Get_int("tandyrate");
 		tandy.chan=MixerChan.Install(&SN76496Update,sample_rate,"TANDY");
+		tandy.chan->SetIdleTimeout(1000);
 
 		WriteHandler[0].Install(0xc0,SN76496Write,IO_MB,2);
 
@@ -373,7 +418,24 @@ public:
 		BIOS_tandy_D4_flag = 0xFF;
 
 		((device_t&)device).device_start();
-		device.convert_samplerate(sample_rate);
+		device.set_block_rate((int32_t)(sample_rate*TANDY_OVERSAMPLE));
+
+		/* Blackman windowed sinc, cut off at 90% of the output Nyquist frequency */
+		{
+			const double fc = 0.45 / TANDY_OVERSAMPLE;
+			const double mid = (TANDY_FIR_TAPS - 1) / 2.0;
+			double sum = 0;
+			for (unsigned int t=0;t < TANDY_FIR_TAPS;t++) {
+				const double x = t - mid;
+				const double sinc = (x == 0) ? 2.0 * fc : sin(2.0 * M_PI * fc * x) / (M_PI * x);
+				const double win = 0.42 - 0.5 * cos(2.0 * M_PI * t / (TANDY_FIR_TAPS - 1)) + 0.08 * cos(4.0 * M_PI * t / (TANDY_FIR_TAPS - 1));
+				tandy.fir[t] = (float)(sinc * win);
+				sum += sinc * win;
+			}
+			for (unsigned int t=0;t < TANDY_FIR_TAPS;t++) tandy.fir[t] = (float)(tandy.fir[t] / sum);
+			for (unsigned int t=0;t < TANDY_FIR_TAPS-1;t++) tandy.over[t] = 0.0f;
+			tandy.muted_samples = 0;
+		}
 
 	}
 	~TANDYSOUND(){ }
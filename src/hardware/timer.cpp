@@ -373,6 +373,13 @@ unsigned long PIT_TICK_RATE = PIT_TICK_RATE_IBM;
 
 pic_tickindex_t VGA_PITSync_delay(void);
 
+/* While IRQ 0 is masked, periodic PIT 0 events are not observable past the first one: that one
+ * latches IRR, and counter reads are computed from elapsed time anyway. So the event stops
+ * rescheduling itself and TIMER_IRQ0Unmasked() picks the period back up in phase. */
+static bool pit0_coalesce = true;
+static bool pit0_coalesced = false;
+static pic_tickindex_t pit0_coalesce_base = 0;
+
 static void PIT0_Event(Bitu /*val*/) {
 	/* HACK: Despite edge trigger, force IRQ */
 	PIC_DeActivateIRQ(0);
@@ -383,6 +390,12 @@ static void PIT0_Event(Bitu /*val*/) {
 	if (pit[0].mode == 2 || pit[0].mode == 3) {
 		pit[0].track_time(PIC_FullIndex());
 
+		if (pit0_coalesce && PIC_IRQMasked(0)) {
+			pit0_coalesced = true;
+			pit0_coalesce_base = PIC_GetCurrentEventTime();
+			return;
+		}
+
 		/* If enabled option and VGA refresh rate is close to PIT 0 timer tick rate,
 		 * make them line up so that demos that use PIT0 for vsync can run without
 		 * shearing artifacts */
@@ -417,6 +430,21 @@ static void PIT0_Event(Bitu /*val*/) {
 	}
 }
 
+static void PIT0_RemoveEvents(void) {
+	PIC_RemoveEvents(PIT0_Event);
+	pit0_coalesced = false;
+}
+
+void TIMER_IRQ0Unmasked(void) {
+	if (!pit0_coalesced) return;
+	pit0_coalesced = false;
+
+	if (pit[0].mode == 2 || pit[0].mode == 3) {
+		const pic_tickindex_t elapsed = PIC_FullIndex() - pit0_coalesce_base;
+		PIC_AddEvent(PIT0_Event,pit[0].delay - pic_tickfmod(elapsed,pit[0].delay));
+	}
+}
+
 uint32_t PIT0_GetAssignedCounter(void) {
     return (uint32_t)pit[0].cntr;
 }
@@ -605,7 +633,7 @@ static void write_latch(Bitu port,Bitu val,Bitu /*iolen*/) {
 			p->latch_next_counter();
 
 			if (counter == 0) {
-				PIC_RemoveEvents(PIT0_Event);
+				PIT0_RemoveEvents();
 				PIC_AddEvent(PIT0_Event,p->delay);
 
 				counter_output(counter);
@@ -685,7 +713,7 @@ static void write_latch(Bitu port,Bitu val,Bitu /*iolen*/) {
 		 * be loaded on the next CLK pulse. */
 		if (p->mode == 0 || p->mode == 4) {
 			if (counter == 0) {
-				PIC_RemoveEvents(PIT0_Event);
+				PIT0_RemoveEvents();
 
 				counter_output(counter);
 				if(pit[counter].output)
@@ -825,7 +853,7 @@ static void write_p43(Bitu /*port*/,Bitu val,Bitu /*iolen*/) {
 			 *        game that relies on that behavior: Steel Gun Nyan! */
 
 			if (latch == 0) {
-				PIC_RemoveEvents(PIT0_Event);
+				PIT0_RemoveEvents();
 
 				counter_output(latch);
 				if(pit[latch].output)
@@ -943,7 +971,7 @@ static IO_ReadHandleObject ReadHandler2[4];
 static IO_WriteHandleObject WriteHandler2[4];
 
 void TIMER_BIOS_INIT_Configure() {
-	PIC_RemoveEvents(PIT0_Event);
+	PIT0_RemoveEvents();
 	PIC_DeActivateIRQ(0);
 	PIC_EdgeTrigger(0,true);
 
@@ -1064,7 +1092,9 @@ void TIMER_OnPowerOn(Section*) {
 	// log
 	LOG(LOG_MISC,LOG_DEBUG)("TIMER_OnPowerOn(): Reinitializing PIT timer emulation");
 
-	PIC_RemoveEvents(PIT0_Event);
+	pit0_coalesce = static_cast<Section_prop *>(control->GetSection("dosbox"))->Get_bool("coalesce masked timer irq");
+
+	PIT0_RemoveEvents();
 
         /* I/O port map (8254)
          *
@@ -1184,7 +1214,7 @@ void TIMER_OnEnterPC98_Phase2_UpdateBDA(void) {
 }
 
 void TIMER_Destroy(Section*) {
-	PIC_RemoveEvents(PIT0_Event);
+	PIT0_RemoveEvents();
 }
 
 void TIMER_Init() {
@@ -1226,6 +1256,8 @@ public:
         //registerPOD(gate2);
         registerPOD(latched_timerstatus);
 		registerPOD(latched_timerstatus_locked);
+		registerPOD(pit0_coalesced);
+		registerPOD(pit0_coalesce_base);
     }
 } dummy;
 }
@@ -190,6 +190,7 @@ bool                                ignore_sequencer_blanking = false;
 bool                                memio_complexity_optimization = true;
 bool                                vga_render_on_demand = false; // Render at vsync or specific changes to hardware instead of every scanline
 signed char                         vga_render_on_demand_user = -1;
+bool                                vga_render_on_demand_adaptive = false; // decide per frame from mid frame changes seen in the previous frame
 
 bool                                pc98_crt_mode = false;      // see port 6Ah command 40h/41h.
                                                                 // this boolean is the INVERSE of the bit.
@@ -283,6 +284,7 @@ void vsync_poll_debug_notify() {
 void VGA_SetModeNow(VGAModes mode) {
 	if (vga.mode == mode) return;
 	vga.mode=mode;
+	vga.draw.indexed_blocked=false;
 	VGA_SetupHandlers();
 	VGA_StartResize(0);
 }
@@ -290,6 +292,7 @@ void VGA_SetModeNow(VGAModes mode) {
 void VGA_SetMode(VGAModes mode) {
 	if (vga.mode == mode) return;
 	vga.mode=mode;
+	vga.draw.indexed_blocked=false;
 	VGA_SetupHandlers();
 	VGA_StartResize();
 }
@@ -570,6 +573,7 @@ VGA_Vsync VGA_Vsync_Decode(const char *vsyncmodestr) {
 	else if (!strcasecmp(vsyncmodestr,"on")) return VS_On;
 	else if (!strcasecmp(vsyncmodestr,"force")) return VS_Force;
 	else if (!strcasecmp(vsyncmodestr,"host")) return VS_Host;
+	else if (!strcasecmp(vsyncmodestr,"adaptive")) return VS_Adaptive;
 	else
 		LOG_MSG("Illegal vsync type %s, falling back to off.",vsyncmodestr);
 
@@ -886,10 +890,15 @@ void VGA_Reset(Section*) {
 	memio_complexity_optimization = section->Get_bool("memory io optimization 1");
 
 	vga_render_on_demand = false;
+	vga_render_on_demand_adaptive = false;
 
 	{
 		const char *str = section->Get_string("scanline render on demand");
-		if (!strcmp(str,"true") || !strcmp(str,"1"))
+		if (!strcmp(str,"adaptive")) {
+			vga_render_on_demand_user = 1;
+			vga_render_on_demand_adaptive = true;
+		}
+		else if (!strcmp(str,"true") || !strcmp(str,"1"))
 			vga_render_on_demand_user = 1;
 		else if (!strcmp(str,"false") || !strcmp(str,"0"))
 			vga_render_on_demand_user = 0;
@@ -900,7 +909,9 @@ void VGA_Reset(Section*) {
 	if (memio_complexity_optimization)
 		LOG_MSG("Memory I/O complexity optimization enabled aka option 'memory io optimization 1'. If the game or demo is unable to draw to the screen properly, set the option to false.");
 
-	if (vga_render_on_demand_user > 0)
+	if (vga_render_on_demand_adaptive)
+		LOG_MSG("'scanline render on demand' option is adaptive. Frames are rendered at vsync unless the previous frame changed video registers mid frame.");
+	else if (vga_render_on_demand_user > 0)
 		LOG_MSG("'scanline render on demand' option is enabled. If this option breaks the game or demo effects or display, set the option to false.");
 	else if (vga_render_on_demand_user < 0)
 		LOG_MSG("The 'scanline render on demand' option is available and may provide a modest boost in video render performance if set to true.");
@@ -1130,7 +1141,15 @@ void VGA_Reset(Section*) {
 	const char * vsyncratestr;
 	vsyncratestr=section2->Get_string("vsyncrate");
 	double vsyncrate=70;
-	if (!strcasecmp(vsyncmodestr,"host")) {
+	if (!strcasecmp(vsyncmodestr,"adaptive")) {
+		/* start from what the host reports, VGA_VsyncPresented refines it */
+		extern int vsync_adaptive_range;
+
+		vsyncrate = GFX_GetHostRefreshRate();
+		if (vsyncrate <= 0) sscanf(vsyncratestr,"%lf",&vsyncrate);
+		vsync_adaptive_range = section2->Get_int("adaptive vsync range");
+	}
+	else if (!strcasecmp(vsyncmodestr,"host")) {
 #if defined (WIN32)
 		DEVMODE devmode;
 
@@ -2157,6 +2176,9 @@ private:
 
 		if( tandy_membase_idx == 0xffffffff ) vga.tandy.mem_base = vga.mem.linear;
 		else vga.tandy.mem_base = MemBase + tandy_membase_idx;
+
+		VGA_MarkAllDirty();
+		VGA_MarkRegsDirty();
 	}
 } dummy;
 }
@@ -110,6 +110,7 @@ void VGA_ATTR_SetEGAMonitorPalette(EGAMonitorMode m) {
 }
 
 void VGA_ATTR_SetPalette(uint8_t index, uint8_t val) {
+	VGA_MarkRegsDirty();
 	// the attribute table stores only 6 bits
 	val &= 63; 
 	vga.attr.palette[index] = val;
@@ -190,6 +191,7 @@ Bitu read_p3c0(Bitu /*port*/,Bitu /*iolen*/) {
 bool J3_IsCga4Dcga();
 
 void write_p3c0(Bitu /*port*/,Bitu val,Bitu iolen) {
+	VGA_MarkRegsDirty();
 	unsigned int cmplx = 0;
 
 	if (vga.dosboxig.vga_reg_lockout)
@@ -79,6 +79,7 @@ Bitu vga_read_p3d4(Bitu port,Bitu iolen) {
 }
 
 void vga_write_p3d5(Bitu port,Bitu val,Bitu iolen) {
+	VGA_MarkRegsDirty();
 	if (vga.dosboxig.vga_reg_lockout)
 		return;
 
@@ -137,6 +137,18 @@ static void VGA_DAC_SendColor( Bitu index, Bitu src ) {
             vga.dac.xlat32[index] = (uint32_t)(blue << 16U) | (uint32_t)(green << 8U) | (uint32_t)(red << 0U);
     }
 
+    /* the same entry rewritten during active display of one frame is a palette split (raster bars),
+     * which the once-per-frame palette of indexed output cannot show */
+    if (vga.draw.indexed) {
+        static double dac_written_frame[256];
+
+        if (dac_written_frame[index&0xFF] == vga.draw.delay.framestart &&
+            vga.draw.lines_done > 0 && vga.draw.lines_done < vga.draw.lines_total)
+            VGA_IndexedPaletteSplit();
+
+        dac_written_frame[index&0xFF] = vga.draw.delay.framestart;
+    }
+
     RENDER_SetPal( (uint8_t)index, red, green, blue );
 }
 
@@ -212,6 +224,7 @@ void VGA_DAC_DeferredUpdateColorPalette() {
 }
 
 void write_p3c6(Bitu port,Bitu val,Bitu iolen) {
+    VGA_MarkRegsDirty();
     (void)iolen;//UNUSED
     (void)port;//UNUSED
 
@@ -297,6 +310,7 @@ extern bool vga_palette_update_on_full_load;
 static unsigned char tmp_dac[3] = {0,0,0};
 
 void write_p3c9(Bitu port,Bitu val,Bitu iolen) {
+    VGA_MarkRegsDirty();
     bool update = false;
 
     if (vga.dosboxig.vga_dac_lockout)
@@ -427,6 +441,7 @@ void VGA_DAC_CombineColor(uint8_t attr,uint8_t pal) {
 }
 
 void VGA_DAC_SetEntry(Bitu entry,uint8_t red,uint8_t green,uint8_t blue) {
+    VGA_MarkRegsDirty();
     //Should only be called in machine != vga
     vga.dac.rgb[entry].red=red;
     vga.dac.rgb[entry].green=green;
@@ -21,6 +21,7 @@
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
+#include <algorithm>
 #include "dosbox.h"
 #if defined (WIN32)
 #include <d3d9.h>
@@ -35,6 +36,7 @@
 #include "render.h"
 #include "../gui/render_scalers.h"
 #include "vga.h"
+#include "vga_draw_simd.h"
 #include "pic.h"
 #include "jfont.h"
 #include "menu.h"
@@ -47,6 +49,8 @@
 #include "pc98_cg.h"
 #include "pc98_gdc.h"
 #include "pc98_gdc_const.h"
+#include "hosttime.h"
+#include "framepacing.h"
 
 #if (C_SSHOT) || (C_AVCODEC)
 #include <zlib.h>
@@ -69,8 +73,11 @@ bool dbg_event_color_plane_enable = false;
 bool enable_supermegazeux_256colortext = false;
 
 static bool is_vga_rendering_on_demand = false;
+static bool vga_frame_raster_change = false;	/* raster-relevant register written during active display */
+static unsigned int vga_quiet_frames = 0;	/* consecutive frames without such writes */
 
 extern bool vga_render_on_demand;
+extern bool vga_render_on_demand_adaptive;
 extern signed char vga_render_on_demand_user;
 extern bool vga_ignore_extended_memory_bit;
 
@@ -310,7 +317,6 @@ void memxor_greendotted_32bpp(uint32_t *d,unsigned int count,unsigned int line)
 }
 
 typedef void (* VGA_RawLine_Handler)(uint8_t *dst,Bitu vidstart, Bitu line);
-typedef uint8_t * (* VGA_Line_Handler)(Bitu vidstart, Bitu line);
 
 static VGA_Line_Handler VGA_DrawLine;
 static VGA_RawLine_Handler VGA_DrawRawLine;
@@ -443,13 +449,31 @@ float uservsyncjolt=0.0f;
 
 VGA_Vsync vsyncmode_current = VS_Off;
 
+/* Adaptive vsync. GFX_EndUpdate reports every present: how long it blocked waiting for the host
+ * and when it finished. Presents that come one host refresh apart give the real host period, the
+ * blocked time says how early the frame was. If the guest refresh rate is within the configured
+ * range of the host, the emulated frame is stretched or shrunk to the host period (emulated time
+ * runs slightly fast or slow) and nudged so frames arrive just ahead of the host retrace.
+ * Otherwise the guest runs at its own rate, which is what a VRR display wants to see. */
+int vsync_adaptive_range = 5;           /* percent the guest frame may be stretched or shrunk */
+static double vsync_host_period = 0;    /* measured host refresh period in ms, 0 if not known yet */
+static double vsync_host_blocked = 0;   /* smoothed time a present blocked in ms */
+static double vsync_last_present = -1;
+static bool vsync_locked = false;
+
 void VGA_VsyncUpdateMode(VGA_Vsync vsyncmode) {
     vsyncmode_current = vsyncmode;
 
+    /* measure the host again, the mode or vsyncrate may have changed with it */
+    vsync_host_period = 0;
+    vsync_host_blocked = 0;
+    vsync_last_present = -1;
+
     mainMenu.get_item("vsync_off").check(vsyncmode_current == VS_Off).refresh_item(mainMenu);
     mainMenu.get_item("vsync_on").check(vsyncmode_current == VS_On).refresh_item(mainMenu);
     mainMenu.get_item("vsync_force").check(vsyncmode_current == VS_Force).refresh_item(mainMenu);
     mainMenu.get_item("vsync_host").check(vsyncmode_current == VS_Host).refresh_item(mainMenu);
+    mainMenu.get_item("vsync_adaptive").check(vsyncmode_current == VS_Adaptive).refresh_item(mainMenu);
 
     switch(vsyncmode) {
     case VS_Off:
@@ -468,6 +492,12 @@ void VGA_VsyncUpdateMode(VGA_Vsync vsyncmode) {
         vsync.persistent= true;
         vsync.faithful  = false;
         break;
+    case VS_Adaptive:
+        /* standard timing unless VGA_VerticalTimer locks to the host */
+        vsync.manual    = false;
+        vsync.persistent= false;
+        vsync.faithful  = false;
+        break;
     default:
         LOG_MSG("VGA_VsyncUpdateMode: Invalid mode, using defaults.");
         vsync.manual    = false;
@@ -479,6 +509,39 @@ void VGA_VsyncUpdateMode(VGA_Vsync vsyncmode) {
 
 void VGA_TweakUserVsyncOffset(float val) { uservsyncjolt = val; }
 
+void VGA_VsyncPresented(double blocked_ms,double now_ms) {
+    if (vsyncmode_current != VS_Adaptive) return;
+
+    if (vsync_last_present >= 0 && vsync.period > 0) {
+        const double interval = now_ms - vsync_last_present;
+
+        /* skip missed refreshes and frames that did not wait for the host at all */
+        if (fabs(interval - vsync.period) < vsync.period * 0.08)
+            vsync_host_period = (vsync_host_period > 0) ? (vsync_host_period * 0.95) + (interval * 0.05) : interval;
+    }
+
+    vsync_last_present = now_ms;
+    vsync_host_blocked = (vsync_host_blocked * 0.9) + (blocked_ms * 0.1);
+}
+
+static double VGA_VsyncAdaptivePeriod(void) {
+    const double vtotal = vga.draw.delay.vtotal;
+    const double limit = vtotal * vsync_adaptive_range / 100.0;
+    double fv = vsync_host_period;
+
+    /* aim for a little blocking: a long wait means frames come too early, none means too late */
+    if (vsync_host_blocked > 0.25) {
+        double nudge = (vsync_host_blocked - 1.5) * 0.05;
+        if (nudge < -0.1) nudge = -0.1;
+        else if (nudge > 0.1) nudge = 0.1;
+        fv += nudge;
+    }
+
+    if (fv < vtotal - limit) fv = vtotal - limit;
+    else if (fv > vtotal + limit) fv = vtotal + limit;
+    return fv;
+}
+
 template <const unsigned int card,typename templine_type_t> static inline templine_type_t InColor_Planar_Common_Block_xlat(const uint8_t t) {
     if (card == MCH_RAW_SNAPSHOT)
         return t;
@@ -972,12 +1035,12 @@ static void VGA_RawDraw_Xlat32_VGA_CRTC_bmode_Line(uint8_t *dst,Bitu vidstart, B
 }
 
 /* WARNING: This routine assumes (vidstart&3) == 0 */
-static uint8_t * VGA_Draw_Xlat32_VGA_CRTC_bmode_Line(Bitu vidstart, Bitu line) {
+static uint8_t * VGA_Draw_Xlat32_VGA_CRTC_bmode_LineTo(uint8_t *dst, Bitu vidstart, Bitu line) {
     if (vga.crtc.maximum_scan_line & 0x80) line >>= 1u; /* CGA modes (and 200-line EGA) have the VGA doublescan bit set. We need to compensate to properly map lines. */
     const uint8_t *vram = vga.draw.linear_base + (((line & vga.tandy.line_mask) << (2+vga.tandy.line_shift)) & vga.draw.linear_mask);
     const Bitu vidmask = vga.tandy.line_mask ? ((vga.tandy.addr_mask << 2) | 3) : vga.draw.linear_mask;
     const Bitu skip = 4u << vga.config.addr_shift; /* how much to skip after drawing 4 pixels */
-    uint32_t* temps = (uint32_t*) TempLine;
+    uint32_t* temps = (uint32_t*) dst;
     unsigned int poff = 0;
 
     /* *sigh* it looks like DOSBox's VGA scanline code will pass nonzero bits 0-1 in vidstart */
@@ -1025,7 +1088,11 @@ static uint8_t * VGA_Draw_Xlat32_VGA_CRTC_bmode_Line(Bitu vidstart, Bitu line) {
         vidstart += skip;
     }
 
-    return TempLine + (poff * 4);
+    return dst + (poff * 4);
+}
+
+static uint8_t * VGA_Draw_Xlat32_VGA_CRTC_bmode_Line(Bitu vidstart, Bitu line) {
+    return VGA_Draw_Xlat32_VGA_CRTC_bmode_LineTo(TempLine, vidstart, line);
 }
 
 static void VGA_RawDraw_Xlat32_Linear_Line(uint8_t *dst,Bitu vidstart, Bitu /*line*/) {
@@ -1033,8 +1100,8 @@ static void VGA_RawDraw_Xlat32_Linear_Line(uint8_t *dst,Bitu vidstart, Bitu /*li
         dst[i]=vga.draw.linear_base[(vidstart+i)&vga.draw.linear_mask];
 }
 
-static uint8_t * VGA_Draw_Xlat32_Linear_Line(Bitu vidstart, Bitu /*line*/) {
-    uint32_t* temps = (uint32_t*) TempLine;
+static uint8_t * VGA_Draw_Xlat32_Linear_LineTo(uint8_t *dst, Bitu vidstart, Bitu /*line*/) {
+    uint32_t* temps = (uint32_t*) dst;
 
     /* hack for Surprise! productions "copper" demo.
      * when the demo talks about making the picture waver, what it's doing is diddling
@@ -1065,6 +1132,54 @@ static uint8_t * VGA_Draw_Xlat32_Linear_Line(Bitu vidstart, Bitu /*line*/) {
     for(Bitu i = 0; i < (vga.draw.line_length>>2); i++)
         temps[i]=vga.dac.xlat32[vga.draw.linear_base[(vidstart+i)&vga.draw.linear_mask]];
 
+    return dst;
+}
+
+static uint8_t * VGA_Draw_Xlat32_Linear_Line(Bitu vidstart, Bitu line) {
+    return VGA_Draw_Xlat32_Linear_LineTo(TempLine, vidstart, line);
+}
+
+/* 256-color lines passed on as DAC indices (vga.draw.indexed). The renderer gets 8bpp and the
+ * output (or the scaler) applies the palette, so there is no per-pixel xlat32 lookup here.
+ * Only used when hretrace effects are off, see VGA_SetupDrawing. */
+
+/* WARNING: This routine assumes (vidstart&3) == 0 */
+static uint8_t * VGA_Draw_Indexed_VGA_CRTC_bmode_Line(Bitu vidstart, Bitu line) {
+    if (vga.crtc.maximum_scan_line & 0x80) line >>= 1u; /* see VGA_Draw_Xlat32_VGA_CRTC_bmode_Line */
+    const uint8_t *vram = vga.draw.linear_base + (((line & vga.tandy.line_mask) << (2+vga.tandy.line_shift)) & vga.draw.linear_mask);
+    const Bitu vidmask = vga.tandy.line_mask ? ((vga.tandy.addr_mask << 2) | 3) : vga.draw.linear_mask;
+    const Bitu skip = 4u << vga.config.addr_shift; /* how much to skip after drawing 4 pixels */
+    const unsigned int poff = vidstart & 3u;
+    uint8_t *temps = TempLine;
+
+    vidstart &= ~3ul;
+
+    const Bitu count = ((vga.draw.line_length>>2/*4 pixels*/)+((poff+3)>>2));
+
+    /* byte mode (unchained Mode X) keeps the groups next to each other in memory */
+    if (skip == 4 && ((vidstart & vidmask) + (count * 4u)) <= (vidmask + 1u)) {
+        memcpy(TempLine,&vram[ vidstart & vidmask ],count * 4u);
+        return TempLine + poff;
+    }
+
+    for(Bitu i = 0; i < count; i++) {
+        memcpy(temps,&vram[ vidstart & vidmask ],4);
+        temps += 4;
+        vidstart += skip;
+    }
+
+    return TempLine + poff;
+}
+
+static uint8_t * VGA_Draw_Indexed_Linear_Line(Bitu vidstart, Bitu /*line*/) {
+    const Bitu start = vidstart & vga.draw.linear_mask;
+    const Bitu first = std::min((Bitu)vga.draw.line_length,(Bitu)(vga.draw.linear_mask + 1u - start));
+
+    /* copied rather than returned in place, the debug and invert paths modify the line */
+    memcpy(TempLine,vga.draw.linear_base + start,first);
+    if (first < vga.draw.line_length)
+        memcpy(TempLine + first,vga.draw.linear_base,vga.draw.line_length - first);
+
     return TempLine;
 }
 
@@ -1133,6 +1248,19 @@ template <const unsigned int card,typename templine_type_t> static uint8_t * EGA
      * Also, even though it is rarely used, EGA/VGA do have another bit that enables a
      * 4-way interleave that was obviously added with Hercules graphics mode in mind. */
 
+#if defined(VGA_PLANAR_SIMD)
+    {
+        VGA_PlanarSIMD_Palette pal;
+        for (unsigned int c = 0;c < 16;c++)
+            pal.pal[c] = (uint32_t)EGA_Planar_Common_Block_xlat<card,templine_type_t>((uint8_t)c);
+        VGA_PlanarSIMD_SplitPalette(pal);
+
+        const unsigned int done = VGA_PlanarSIMD_Line<templine_type_t>(temps,vram,vidstart,vidmask,(Bitu)4u << (Bitu)vga.config.addr_shift,(unsigned int)count,pal);
+        count -= done;
+        i += (Bitu)done * 8u;
+    }
+#endif
+
     while (count > 0u) {
         t1 = t2 = *((const uint32_t*)(&vram[ vidstart & vidmask ]));
         t1 = (t1 >> 4) & 0x0f0f0f0f;
@@ -1951,6 +2079,25 @@ static uint8_t * VGA_Draw_LIN32_Line_HWMouse(Bitu vidstart, Bitu /*line*/) {
 #endif
 }
 
+VGA_Line_Handler VGA_GetLineDrawer(const char *name) {
+    static const struct {
+        const char*         name;
+        VGA_Line_Handler    handler;
+    } drawers[] = {
+        { "linear",         VGA_Draw_Linear_Line },
+        { "indexed_linear", VGA_Draw_Indexed_Linear_Line },
+        { "xlat32_linear",  VGA_Draw_Xlat32_Linear_Line },
+        { "planar_xlat32",  VGA_Draw_VGA_Planar_Xlat32_Line },
+        { "packed4_xlat32", VGA_Draw_VGA_Packed4_Xlat32_Line }
+    };
+
+    for (const auto &drawer : drawers) {
+        if (!strcmp(name, drawer.name))
+            return drawer.handler;
+    }
+    return NULL;
+}
+
 static const uint32_t* VGA_Planar_Memwrap(Bitu vidstart) {
     return (const uint32_t*)vga.mem.linear + (vidstart & vga.draw.planar_mask);
 }
@@ -2937,6 +3084,93 @@ struct Text_Draw_State {
 
 Text_Draw_State     pc98_text_draw;
 
+// Text layer glyph row cache.
+// One entry per character cell per scanline, holding the CG bitmap byte of the cell after the
+// secret, blink and reverse attributes have been applied. An entry is reused as long as the
+// character code, attribute, CG row and half (double-wide) of the cell are the same as when it
+// was rendered, which means only cells that actually changed in text VRAM go back to the CG.
+// Anything else the glyph depends on (font RAM, blink phase, blank-at row) is folded into the
+// cache serial, and a change there invalidates every scanline at once. The cursor and the
+// vertical line/underline overlays depend on position, not cell contents, and are applied on
+// top of the cached byte as before.
+#define PC98_TEXT_CACHE_LINES       512
+#define PC98_TEXT_CACHE_CELLS       128
+
+struct PC98_Text_Cell_Cache {
+    uint16_t            chr;
+    uint16_t            attr;
+    uint8_t             fline;
+    uint8_t             half;
+    uint8_t             font;
+};
+
+static PC98_Text_Cell_Cache pc98_text_cell_cache[PC98_TEXT_CACHE_LINES][PC98_TEXT_CACHE_CELLS];
+static uint32_t     pc98_text_cache_line_serial[PC98_TEXT_CACHE_LINES] = {0};
+static uint32_t     pc98_text_cache_serial = 1;
+
+/* state the glyph row depends on other than the cell itself */
+static uint32_t     pc98_text_cache_font_serial = 0;
+static uint8_t      pc98_text_cache_blink_state = 0xFF;
+static uint8_t      pc98_text_cache_blank_at = 0xFF;
+
+void PC98_Text_Cache_Invalidate(void) {
+    pc98_text_cache_serial++;
+    if (pc98_text_cache_serial == 0) { /* never let a stale line serial match after wraparound */
+        memset(pc98_text_cache_line_serial,0,sizeof(pc98_text_cache_line_serial));
+        pc98_text_cache_serial = 1;
+    }
+}
+
+static inline void PC98_Text_Cache_Check(void) {
+    const uint8_t blink = (pc98_gdc[GDC_MASTER].cursor_blink_state == 0) ? 1 : 0;
+
+    if (pc98_text_cache_font_serial != pc98_font_serial || pc98_text_cache_blink_state != blink ||
+        pc98_text_cache_blank_at != pc98_text_row_scanline_blank_at) {
+        pc98_text_cache_font_serial = pc98_font_serial;
+        pc98_text_cache_blink_state = blink;
+        pc98_text_cache_blank_at = pc98_text_row_scanline_blank_at;
+        PC98_Text_Cache_Invalidate();
+    }
+}
+
+/* secret, blink and reverse attributes, which depend only on the cell */
+static inline uint8_t PC98_Text_Cell_Attr(uint8_t font,const uint16_t attr) {
+    /* the character is not rendered if "~secret" (bit 0) is not set */
+    if (!(attr & 1)) font = 0;
+
+    /* "blink" seems to count at the same speed as the cursor blink rate,
+     * through a 4-cycle pattern in which the character is invisible only
+     * at the first count. */
+    if ((attr & 0x02/*blink*/) && pc98_gdc[GDC_MASTER].cursor_blink_state == 0) font = 0;
+
+    /* reverse attribute. seems to take effect BEFORE vertical & underline attributes */
+    if (attr & 0x04/*reverse*/) font ^= 0xFF;
+
+    return font;
+}
+
+static inline uint8_t PC98_Text_Cell_Glyph(PC98_Text_Cell_Cache *ce,const uint16_t chr,const uint16_t attr,const uint8_t fline,const uint8_t half) {
+    if (ce != NULL && ce->chr == chr && ce->attr == attr && ce->fline == fline && ce->half == half)
+        return ce->font;
+
+    uint8_t font = 0;
+
+    if (fline < pc98_text_row_scanline_blank_at)
+        font = pc98_font_char_read(chr,fline,half);
+
+    font = PC98_Text_Cell_Attr(font,attr);
+
+    if (ce != NULL) {
+        ce->chr = chr;
+        ce->attr = attr;
+        ce->fline = fline;
+        ce->half = half;
+        ce->font = font;
+    }
+
+    return font;
+}
+
 /* NEC PC-9821Lt2 memory layout notes:
  *
  * - At first glance, the 8/16 color modes appear to be a sequence of bytes that are read
@@ -3279,6 +3513,19 @@ static uint8_t* VGA_PC98_Xlat32_Draw_Line(Bitu vidstart, Bitu line) {
             fline = pc98_text_draw.row_scanline_cg;
         }
 
+        /* glyph row cache for this scanline, if it fits */
+        PC98_Text_Cell_Cache *cache_row = NULL;
+        unsigned int cell = 0;
+
+        PC98_Text_Cache_Check();
+        if (vga.draw.lines_done < PC98_TEXT_CACHE_LINES && blocks <= PC98_TEXT_CACHE_CELLS) {
+            cache_row = pc98_text_cell_cache[vga.draw.lines_done];
+            if (pc98_text_cache_line_serial[vga.draw.lines_done] != pc98_text_cache_serial) {
+                for (unsigned int i=0;i < PC98_TEXT_CACHE_CELLS;i++) cache_row[i].half = 0xFF; /* matches nothing */
+                pc98_text_cache_line_serial[vga.draw.lines_done] = pc98_text_cache_serial;
+            }
+        }
+
         /* NTS: This code will render the cursor in the scroll region with a weird artifact
          *      when the character under it is double-wide, and the cursor covers the top half.
          *
@@ -3332,6 +3579,8 @@ interrupted_char_begin:
                     else {
                         font = 0;
                     }
+
+                    font = PC98_Text_Cell_Attr(font,attr);
                 }
                 else {
                     // NTS: The display handles single-wide vs double-wide by whether or not the 8 bits are nonzero.
@@ -3351,10 +3600,7 @@ interrupted_char_begin:
                         doublewide = true;
                     }
 
-                    if (fline < pc98_text_row_scanline_blank_at)
-                        font = pc98_font_char_read(chr,fline,0);
-                    else
-                        font = 0;
+                    font = PC98_Text_Cell_Glyph(cache_row != NULL ? &cache_row[cell] : NULL,chr,attr,fline,0);
                 }
             }
             else {
@@ -3388,25 +3634,12 @@ interrupted_char_begin:
                         goto interrupted_char_begin;
                 }
 
-                if (fline < pc98_text_row_scanline_blank_at)
-                    font = pc98_font_char_read(chr,fline,1);
-                else
-                    font = 0;
+                font = PC98_Text_Cell_Glyph(cache_row != NULL ? &cache_row[cell] : NULL,chr,attr,fline,1);
             }
 
+            cell++;
             lineoverlay <<= 8;
 
-            /* the character is not rendered if "~secret" (bit 0) is not set */
-            if (!(attr & 1)) font = 0;
-
-            /* "blink" seems to count at the same speed as the cursor blink rate,
-             * through a 4-cycle pattern in which the character is invisible only
-             * at the first count. */
-            if ((attr & 0x02/*blink*/) && pc98_gdc[GDC_MASTER].cursor_blink_state == 0) font = 0;
-
-            /* reverse attribute. seems to take effect BEFORE vertical & underline attributes */
-            if (attr & 0x04/*reverse*/) font ^= 0xFF;
-
             /* based on real hardware, the cursor seems to act like a reverse attribute */
             /* if the character is double-wide, and the cursor is on the left half, the cursor affects the right half too. */
             if (((gdcvidmem == vga.draw.cursor.address) || (was_doublewide && gdcvidmem == (vga.draw.cursor.address+1))) &&
@@ -3434,7 +3667,15 @@ interrupted_char_begin:
              *      any bit in the font overlays the graphic output (after reverse, etc) or else does not output anything. */
             if (!pc98_40col_text) {
                 /* 80-col */
-                for (Bitu n = 0; n < 8; n++) {
+                if (font == 0 && !monoproc) {
+                    /* nothing to overlay, the graphics layer shows through */
+                    draw += 8;
+                }
+                else if (font == 0xFF) {
+                    const uint32_t c = pc98_text_palette[foreground];
+                    for (Bitu n = 0; n < 8; n++) *draw++ = c;
+                }
+                else for (Bitu n = 0; n < 8; n++) {
                     if (font & 0x80)
                         *draw++ = pc98_text_palette[foreground];
                     else if (monoproc && *draw != 0) /* monochrome mode: text attribute colors graphics, therefore color if pixel set */
@@ -3559,6 +3800,19 @@ void VGA_DAC_DeferredUpdateColorPalette();
 void VGA_DebugAddEvent(debugline_event &ev);
 void VGA_DrawDebugLine(uint8_t *line,unsigned int w);
 
+/* Composited debug overlay: the part right of the scanline goes into the overlay layer rather
+ * than into the line, so the line stays as wide as the guest drew it. */
+static void VGA_DrawDebugStrip(void) {
+	static std::vector<uint8_t> strip;
+	const unsigned int w = (unsigned int)render.overlay.width;
+	if (w == 0) return;
+
+	strip.resize(w * 4u);
+	memset(strip.data(),0,strip.size());
+	VGA_DrawDebugLine(strip.data(),w);
+	RENDER_OverlayLine(render.scale.inLine,render.src.width,strip.data(),w);
+}
+
 /* BIOS logo overlay */
 struct BIOSlogo_t {
 	unsigned char*		bmp = NULL;
@@ -3693,7 +3947,161 @@ void VGA_FreeBiosLogo(void) {
 	BIOSlogo.free();
 }
 
+/* Scanline skipping driven by VRAM write tracking (see VGA_Dirty in vga.h). Everything that decides
+ * how VRAM turns into pixels is collected into a key at the start of each frame. While the key holds,
+ * each scanline remembers where it read from and the serial it was last cached by the renderer at,
+ * and if nothing it reads has been written since then, it is handed to the renderer as a cache hit. */
+struct VGA_DirtyLine {
+	Bitu			address = 0;
+	Bitu			address_line = 0;
+	Bitu			panning = 0;
+	uint32_t		stamp = 0;		/* serial the renderer cached this line at, 0 if not cached */
+};
+
+struct VGA_DirtyFrameKey {
+	VGA_Line_Handler	drawline;
+	VGAModes		mode;
+	Bitu			address,address_add,address_line,address_line_total;
+	Bitu			linear_mask,split_line,lines_total,line_length,blocks;
+	Bitu			byte_panning_shift,panning,addr_shift;
+	Bitu			cursor_address,blinking;
+	uint8_t			cursor_sline,cursor_eline,cursor_enabled,cursor_phase;
+	bool			blink;
+};
+
+static std::vector<VGA_DirtyLine> vga_dirty_lines;
+static VGA_DirtyFrameKey vga_dirty_key;
+static bool vga_dirty_track = false;		/* this frame may record line stamps */
+static bool vga_dirty_skip = false;		/* this frame may skip lines */
+
+static void VGA_DirtyStartFrame(void) {
+	VGA_DirtyFrameKey key;
+
+	memset(&key,0,sizeof(key)); /* the key is compared with memcmp, padding included */
+	key.drawline = VGA_DrawLine;
+	key.mode = vga.mode;
+	key.address = vga.draw.address;
+	key.address_add = vga.draw.address_add;
+	key.address_line = vga.draw.address_line;
+	key.address_line_total = vga.draw.address_line_total;
+	key.linear_mask = vga.draw.linear_mask;
+	key.split_line = vga.draw.split_line;
+	key.lines_total = vga.draw.lines_total;
+	key.line_length = vga.draw.line_length;
+	key.blocks = vga.draw.blocks;
+	key.byte_panning_shift = vga.draw.byte_panning_shift;
+	key.panning = vga.draw.panning;
+	key.addr_shift = vga.config.addr_shift;
+	key.cursor_address = vga.draw.cursor.address;
+	key.blinking = vga.draw.blinking;
+	key.cursor_sline = vga.draw.cursor.sline;
+	key.cursor_eline = vga.draw.cursor.eline;
+	key.cursor_enabled = vga.draw.cursor.enabled;
+	key.cursor_phase = vga.draw.cursor.count & 0x18u; /* cursor blink (bit 3) and attribute blink (bit 4) */
+	key.blink = vga.draw.blink;
+
+	vga.dirty.serial++;
+	if (GCC_UNLIKELY(vga.dirty.serial == 0)) {
+		/* wrapped around, old stamps would look newer than they are */
+		for (uint32_t c=0;c < vga.dirty.chunks;c++) vga.dirty.stamp[c] = 0;
+		vga.dirty.last_write = vga.dirty.all = vga.dirty.regs = 0;
+		vga_dirty_lines.clear();
+		vga.dirty.serial = 1;
+	}
+
+	vga_dirty_track = vga.draw.mode == DRAWLINE && IS_EGAVGA_ARCH && machine != MCH_EGA &&
+		(vga.mode == M_VGA || vga.mode == M_EGA || vga.mode == M_TEXT) &&
+		vga.draw.render_max <= 1 && !vga.dosboxig.svga && !BIOSlogo.visible && !S3SSdraw.draw &&
+		!video_debug_overlay && !vga_enable_hretrace_effects && !(CaptureState & CAPTURE_RAWIMAGE);
+	vga_dirty_skip = vga_dirty_track && !vga.dirty.direct && memcmp(&key,&vga_dirty_key,sizeof(key)) == 0;
+	vga_dirty_key = key;
+
+	if (vga_dirty_lines.size() != vga.draw.lines_total) {
+		vga_dirty_lines.clear();
+		vga_dirty_lines.resize(vga.draw.lines_total);
+	}
+}
+
+/* true if the current scanline would come out exactly as the renderer has it cached */
+static bool VGA_DirtyLineClean(const VGA_DirtyLine &dl) {
+	if (dl.stamp == 0 || dl.address != vga.draw.address || dl.address_line != vga.draw.address_line || dl.panning != vga.draw.panning)
+		return false;
+	if (vga.dirty.regs >= dl.stamp || vga.dirty.all >= dl.stamp)
+		return false;
+	if (vga.dirty.last_write < dl.stamp)
+		return true;
+
+	/* something was written, check only the part of VRAM this line reads */
+	Bitu start,len;
+
+	if (vga.draw.linear_base != vga.mem.linear || vga.tandy.line_mask != 0)
+		return false;
+
+	if (VGA_DrawLine == VGA_Draw_Xlat32_Linear_Line) {
+		start = vga.draw.address;
+		len = vga.draw.line_length >> 2u;
+	}
+	else if (VGA_DrawLine == VGA_Draw_Xlat32_VGA_CRTC_bmode_Line) {
+		start = vga.draw.address & ~((Bitu)3u);
+		len = ((vga.draw.line_length >> 4u) + (((vga.draw.address & 3u) + 3u) >> 2u)) * ((Bitu)4u << vga.config.addr_shift);
+	}
+	else if (VGA_DrawLine == VGA_Draw_Indexed_Linear_Line) {
+		start = vga.draw.address;
+		len = vga.draw.line_length;
+	}
+	else if (VGA_DrawLine == VGA_Draw_Indexed_VGA_CRTC_bmode_Line) {
+		start = vga.draw.address & ~((Bitu)3u);
+		len = ((vga.draw.line_length >> 2u) + (((vga.draw.address & 3u) + 3u) >> 2u)) * ((Bitu)4u << vga.config.addr_shift);
+	}
+	else {
+		return false;
+	}
+
+	start &= vga.draw.linear_mask;
+	if (len == 0 || (start + len) > (vga.draw.linear_mask + 1u))
+		return false; /* wraps around */
+
+	const Bitu last = (start + len - 1u) >> VGA_DIRTY_SHIFT;
+	if (last >= vga.dirty.chunks)
+		return false;
+
+	for (Bitu c=start >> VGA_DIRTY_SHIFT;c <= last;c++) {
+		if (vga.dirty.stamp[c] >= dl.stamp)
+			return false;
+	}
+
+	return true;
+}
+
+/* Draw the line at dst instead of TempLine, for the line handlers that can (RENDER_DirectLine).
+ * Returns NULL without drawing anything unless the line comes out as exactly vga.draw.width
+ * pixels starting at dst, the caller then uses VGA_DrawLine as usual. */
+static uint8_t * VGA_DrawLineDirect(uint8_t *dst, Bitu vidstart, Bitu line) {
+	if (VGA_DrawLine == VGA_Draw_Xlat32_Linear_Line) {
+		if ((vga.draw.line_length >> 2u) != vga.draw.width) return NULL;
+		return VGA_Draw_Xlat32_Linear_LineTo(dst, vidstart, line);
+	}
+	if (VGA_DrawLine == VGA_Draw_Xlat32_VGA_CRTC_bmode_Line) {
+		/* no pixel offset, and whole groups of 4 */
+		if ((vidstart & 3u) != 0 || vga_enable_hretrace_effects) return NULL;
+		if ((vga.draw.line_length & 15u) != 0 || (vga.draw.line_length >> 2u) != vga.draw.width) return NULL;
+		return VGA_Draw_Xlat32_VGA_CRTC_bmode_LineTo(dst, vidstart, line);
+	}
+	if (VGA_DrawLine == VGA_Draw_VGA_Planar_Xlat32_Line) {
+		if (vga.draw.panning != 0 || (vga.draw.blocks * 8u) != vga.draw.width) return NULL;
+		return EGA_Planar_Common_Line<MCH_VGA,uint32_t>(dst, vidstart, line);
+	}
+	return NULL;
+}
+
+/* the scaler's part of drawing a line */
+static inline void VGA_RenderLine(const void *s) {
+    HostTimeScope scope(HOSTTIME_RENDER);
+    RENDER_DrawLine(s);
+}
+
 static void VGA_DrawSingleLine(Bitu /*blah*/) {
+    HostTimeScope scope(HOSTTIME_VGA);
     unsigned int lines = 0;
     bool skiprender;
 
@@ -3796,8 +4204,17 @@ again:
                     memxor_greendotted_16bpp((uint16_t*)TempLine,(vga.draw.width>>1)*(vga.draw.bpp>>3),vga.draw.lines_done);
                 vga_3da_polled = false;
             }
-            RENDER_DrawLine(TempLine);
+            VGA_RenderLine(TempLine);
+            if (vga.draw.lines_done < vga_dirty_lines.size())
+                vga_dirty_lines[vga.draw.lines_done].stamp = 0;
+        } else if (vga_dirty_skip && vga.draw.lines_done < vga_dirty_lines.size() &&
+            !vga_page_flip_occurred && !vga_3da_polled &&
+            VGA_DirtyLineClean(vga_dirty_lines[vga.draw.lines_done]) && RENDER_SkipLine()) {
+            /* nothing this line reads has changed since the renderer cached it */
+            vga_dirty_lines[vga.draw.lines_done].stamp = vga.dirty.serial;
         } else {
+            const bool dirty_overlay = vga_page_flip_occurred || vga_3da_polled;
+
             if ((CaptureState & CAPTURE_RAWIMAGE) && VGA_DrawRawLine && rawshot.capturing) {
                 if (rawshot.render_y < rawshot.image_height && rawshot.image != NULL) {
                     VGA_DrawRawLine(
@@ -3806,7 +4223,23 @@ again:
                     rawshot.render_y++;
                 }
             }
-            uint8_t * data=VGA_DrawLine( vga.draw.address, vga.draw.address_line );
+            if (vga.draw.lines_done < vga_dirty_lines.size()) {
+                VGA_DirtyLine &dl = vga_dirty_lines[vga.draw.lines_done];
+
+                dl.address = vga.draw.address;
+                dl.address_line = vga.draw.address_line;
+                dl.panning = vga.draw.panning;
+                dl.stamp = (vga_dirty_track && !dirty_overlay && RENDER_CachingLines()) ? vga.dirty.serial : 0;
+            }
+            /* with scaler none the renderer may take the line in its output buffer, saving it a copy */
+            uint8_t * data = NULL;
+            if (!dirty_overlay && (!video_debug_overlay || render.overlay.composited) && vga.draw.width == render.src.width) {
+                uint8_t * const direct = RENDER_DirectLine();
+                if (direct != NULL)
+                    data = VGA_DrawLineDirect(direct, vga.draw.address, vga.draw.address_line);
+            }
+            if (data == NULL)
+                data = VGA_DrawLine( vga.draw.address, vga.draw.address_line );
             /* WARNING: For magic reasons possibly related to gremlins added by the GNU C++ compiler or other otherworldly phenomena,
              *          modifying the rendered scanline pointed to by *data somehow corrupts the video memory of the guest, even though
              *          *data is 8bpp or 32bpp pixel data that was translated FROM the guest video memory TO a host bitmap and writing
@@ -3828,7 +4261,7 @@ again:
             if (!(data >= TempLine && data < (TempLine+(64*4)))) {
                 renderOK = false;
 
-                if (video_debug_overlay || vga_page_flip_occurred || vga_3da_polled) {
+                if ((video_debug_overlay && !render.overlay.composited) || vga_page_flip_occurred || vga_3da_polled) {
                    memcpy(TempLine,data,vga.draw.width*((vga.draw.bpp+7u)>>3u));
                    data = TempLine;
                    renderOK = true;
@@ -3854,7 +4287,10 @@ again:
                 }
             }
 
-            RENDER_DrawLine(data);
+            if (video_debug_overlay && render.overlay.composited)
+                VGA_DrawDebugStrip();
+
+            VGA_RenderLine(data);
         }
     }
 
@@ -3911,6 +4347,7 @@ again:
 }
 
 static void VGA_DrawEGASingleLine(Bitu /*blah*/) {
+    HostTimeScope scope(HOSTTIME_VGA);
     bool skiprender;
 
     if (vga.draw.render_step == 0)
@@ -3924,7 +4361,7 @@ static void VGA_DrawEGASingleLine(Bitu /*blah*/) {
     if (!skiprender) {
         if (GCC_UNLIKELY(vga.attr.disabled)) {
             memset(TempLine, 0, sizeof(TempLine));
-            RENDER_DrawLine(TempLine);
+            VGA_RenderLine(TempLine);
         } else {
             Bitu address = vga.draw.address;
             if (machine != MCH_EGA) {
@@ -3951,8 +4388,9 @@ static void VGA_DrawEGASingleLine(Bitu /*blah*/) {
             }
             uint8_t * data=VGA_DrawLine(address, vga.draw.address_line ); 
             if (video_debug_overlay && vga.draw.width < render.src.width) VGA_DrawDebugLine(data+(vga.draw.width*((vga.draw.bpp+7u)>>3u)),render.src.width-vga.draw.width);
+            else if (video_debug_overlay && render.overlay.composited) VGA_DrawDebugStrip();
 
-            RENDER_DrawLine(data);
+            VGA_RenderLine(data);
         }
     }
 
@@ -4019,6 +4457,13 @@ void VGA_RenderOnDemandUpTo(void) {
 //assert(vga_render_on_demand);
 
     if (scanline < 0) scanline = 0;
+    if (scanline > 0 && (unsigned int)scanline < vga.draw.lines_total)
+        vga_frame_raster_change = true;
+
+    /* rendering scanline by scanline this frame, the PIC events are already there */
+    if (!is_vga_rendering_on_demand)
+        return;
+
     while (vga.draw.lines_done < vga.draw.lines_total && vga.draw.hsync_events < (unsigned int)scanline && patience-- > 0)
         VGA_DrawSingleLine(0);
 }
@@ -4255,6 +4700,13 @@ static void VGA_debug_screen_resize(size_t w,size_t h,size_t bpp) {
 void VGA_DebugOverlay() {
     if (VGA_debug_screen == NULL || VGA_debug_screen_w < render.src.width) return;
 
+    /* composited, the panel is the part of the layer below the frame */
+    if (render.overlay.composited) {
+        for (unsigned int y=0;y < VGA_debug_screen_h;y++)
+            RENDER_OverlayLine(render.src.height+y,0,VGA_debug_screen+(y*VGA_debug_screen_stride),VGA_debug_screen_w);
+        return;
+    }
+
     for (unsigned int y=0;y < VGA_debug_screen_h && render.scale.inLine < render.src.height;y++)
         RENDER_DrawLine(VGA_debug_screen+(y*VGA_debug_screen_stride));
 }
@@ -4269,6 +4721,7 @@ static unsigned int debugline_event_alloc_x = 0;
 
 void VGA_DebugAddEvent(debugline_event &ev) {
 	bool is_ega64 = (machine == MCH_EGA) && (egaMonitorMode() == EGA);
+	const Bitu stripw = render.overlay.composited ? render.overlay.width : (render.src.width-vga.draw.width);
 	unsigned int minw = 0;
 
 	if (machine == MCH_EGA) {
@@ -4294,7 +4747,7 @@ void VGA_DebugAddEvent(debugline_event &ev) {
 
 	if (debugline_events.empty()) debugline_event_alloc_x = minw;
 
-	if ((debugline_event_alloc_x+ev.drawwidth()) > (render.src.width-vga.draw.width))
+	if ((debugline_event_alloc_x+ev.drawwidth()) > stripw)
 		debugline_event_alloc_x = minw;
 
 	debugline_event_alloc_x += 8;
@@ -4302,7 +4755,7 @@ void VGA_DebugAddEvent(debugline_event &ev) {
 	ev.x = debugline_event_alloc_x;
 
 	debugline_event_alloc_x += ev.drawwidth();
-	if (debugline_event_alloc_x >= (render.src.width-vga.draw.width))
+	if (debugline_event_alloc_x >= stripw)
 		debugline_event_alloc_x = minw;
 
 	if (ev.colorline == 0) {
@@ -5465,6 +5918,40 @@ void VGA_sof_debug_video_info(void) {
 			VGA_debug_screen_puts8(x,y+16,"E",0);
 		}
 	}
+
+	y = (int)VGA_debug_screen_h;
+	if (framepace_graph) {
+		/* one column per presented frame, the full height is two frame periods. Missed deadlines fill
+		 * the column, the green line is the frame period. */
+		static float recent[FRAMEPACE_RECENT];
+		FramePacingStats st;
+		FRAMEPACE_GetStats(st);
+
+		const double full_ms = (st.period_ms > 0) ? st.period_ms * 2 : 50.0;
+		const unsigned int cols = (VGA_debug_screen_w > 8) ? (unsigned int)std::min<size_t>(VGA_debug_screen_w - 8,FRAMEPACE_RECENT) : 0u;
+		const unsigned int n = FRAMEPACE_GetRecent(recent,cols);
+		const int bottom = y - 4;
+		const int top = bottom - FRAMEPACE_GRAPH_HEIGHT;
+
+		for (unsigned int i=0;i < n;i++) {
+			int h = FRAMEPACE_GRAPH_HEIGHT;
+			if (recent[i] >= 0) {
+				h = (int)((recent[i] * FRAMEPACE_GRAPH_HEIGHT) / full_ms);
+				if (h > FRAMEPACE_GRAPH_HEIGHT) h = FRAMEPACE_GRAPH_HEIGHT;
+				else if (h < 1) h = 1;
+			}
+			x = 4 + (int)(cols - n + i);
+			VGA_debug_screen_func->rect(x,bottom-h,x+1,bottom,white);
+		}
+		VGA_debug_screen_func->rect(4,bottom-(FRAMEPACE_GRAPH_HEIGHT/2),4+(int)cols,bottom-(FRAMEPACE_GRAPH_HEIGHT/2)+1,green);
+
+		sprintf(tmp,"%.1fms missed %llu",st.period_ms,(unsigned long long)st.missed);
+		VGA_debug_screen_puts8(4,top,tmp,green);
+		y = top - 4;
+	}
+
+	if (hosttime_enabled)
+		VGA_debug_screen_puts8(4,y-8,HOSTTIME_Summary().c_str(),white);
 }
 
 static inline uint8_t dacexpand(const uint8_t v,const uint8_t dacshl,const uint8_t dacshr) {
@@ -5825,6 +6312,11 @@ static void VGA_VerticalTimer(Bitu /*val*/) {
 
 	if (BIOSlogo.visible) BIOSlogo.vsync_enable = true;
 
+	/* before RENDER_StartUpdate, it decides whether this frame is presented */
+	REWIND_Retrace();
+	RUNAHEAD_Retrace();
+	if (!runahead_hidden) FRAMEPACE_Retrace(vga_fps > 0 ? 1000.0 / vga_fps : 0);
+
 	dbg_event_maxscan = false;
 	dbg_event_scanstep = false;
 	dbg_event_hretrace = false;
@@ -5840,7 +6332,21 @@ static void VGA_VerticalTimer(Bitu /*val*/) {
 	if (is_vga_rendering_on_demand)
 		VGA_RenderOnDemandComplete();
 
-	is_vga_rendering_on_demand = vga_render_on_demand;
+	if (vga_render_on_demand && vga_render_on_demand_adaptive) {
+		/* raster effects tend to repeat every frame, so a frame that changed registers mid frame
+		 * puts the next ones back on scanline events until two frames in a row come through quiet */
+		if (vga_frame_raster_change)
+			vga_quiet_frames = 0;
+		else if (vga_quiet_frames < 2)
+			vga_quiet_frames++;
+
+		is_vga_rendering_on_demand = vga_quiet_frames >= 2;
+	}
+	else {
+		is_vga_rendering_on_demand = vga_render_on_demand;
+	}
+	vga_frame_raster_change = false;
+
 	if (CaptureState & CAPTURE_RAWIMAGE) {
 		if (!rawshot.capturing) {
 			if (VGA_DrawRawLine != NULL) {
@@ -5881,6 +6387,30 @@ static void VGA_VerticalTimer(Bitu /*val*/) {
 	if (vsync_adj < -0.1) vsync_adj = -0.1;
 	else if (vsync_adj > 0.1) vsync_adj = 0.1;
 
+	if (vsyncmode_current == VS_Adaptive) {
+		if (vsync_host_period <= 0) vsync_host_period = vsync.period;
+
+		const bool lock = vsync_host_period > 0 &&
+			fabs(vsync_host_period - vga.draw.delay.vtotal) <= (vga.draw.delay.vtotal * vsync_adaptive_range / 100.0);
+
+		if (lock != vsync_locked) {
+			LOG(LOG_VGAMISC,LOG_NORMAL)("Adaptive vsync: %s (guest %.3fHz, host %.3fHz)",lock ? "locked to host" : "running at guest rate",
+				1000.0 / vga.draw.delay.vtotal,1000.0 / vsync_host_period);
+			vsync_locked = lock;
+
+			/* start the drift compensation over, else it fights the change in rate */
+			vga_mode_time_base = current_time;
+			vga_mode_frames_since_time_base = 0;
+			vsync_adj = 0;
+		}
+	}
+	else {
+		vsync_locked = false;
+	}
+
+	/* the host sets the pace while locked, not the guest refresh rate */
+	if (vsync_locked) vsync_adj = 0;
+
 	//  LOG_MSG("Vsync err %.6fms adj=%.6fms",vsync_err,vsync_adj);
 
 	float vsynctimerval;
@@ -5982,6 +6512,11 @@ static void VGA_VerticalTimer(Bitu /*val*/) {
 		if( vdisplayendtimerval < 0.0f ) vdisplayendtimerval = 0.0f;
 
 		uservsyncjolt = 0.0f;
+	} else if (vsync_locked) {
+		// Adaptive vsync, locked to the host refresh
+		vsynctimerval       = (float)VGA_VsyncAdaptivePeriod();
+		vdisplayendtimerval = vsynctimerval - (float)(vga.draw.delay.vtotal - vga.draw.delay.vrstart);
+		if( vdisplayendtimerval < 0.0f ) vdisplayendtimerval = 0.0f;
 	} else {
 		// Standard vsync behaviour
 		vsynctimerval       = (float)vga.draw.delay.vtotal;
@@ -6579,7 +7114,9 @@ static void VGA_VerticalTimer(Bitu /*val*/) {
 	}
 #endif
 
-	if (video_debug_overlay && render.src.height > vga.draw.height && vga.draw.bpp == render.src.bpp)
+	if (video_debug_overlay && render.overlay.composited && render.overlay.height > 0 && vga.draw.bpp == render.src.bpp)
+		VGA_debug_screen_resize(render.src.width + render.overlay.width,render.overlay.height,vga.draw.bpp);
+	else if (video_debug_overlay && render.src.height > vga.draw.height && vga.draw.bpp == render.src.bpp)
 		VGA_debug_screen_resize(render.src.width,render.src.height - vga.draw.height,vga.draw.bpp);
 	else
 		VGA_debug_screen_free();
@@ -6589,6 +7126,8 @@ static void VGA_VerticalTimer(Bitu /*val*/) {
 		VGA_sof_debug_video_info();
 	}
 
+	VGA_DirtyStartFrame();
+
 	// add the draw event
 	switch (vga.draw.mode) {
 		case DRAWLINE:
@@ -6839,7 +7378,21 @@ void ChooseRenderOnDemand(void) {
 	LOG(LOG_VGAMISC,LOG_DEBUG)("Render On Demand mode is %s for RodU %d",vga_render_on_demand?"on":"off",vga_render_on_demand_user);
 }
 
+/* The DAC was rewritten mid-frame while 256-color lines go out indexed. The output applies one
+ * palette per frame, so go back to expanding through xlat32 on the CPU until the mode changes. */
+void VGA_IndexedPaletteSplit(void) {
+	if (!vga.draw.indexed || vga.draw.indexed_blocked) return;
+
+	LOG(LOG_VGAMISC,LOG_DEBUG)("Palette changed mid-frame, expanding 256-color lines on the CPU");
+	vga.draw.indexed_blocked = true;
+	VGA_StartResize();
+}
+
 void VGA_SetupDrawing(Bitu /*val*/) {
+	VGA_MarkAllDirty();
+	VGA_MarkRegsDirty();
+	vga.draw.indexed = false;
+
 	if (vga.mode==M_ERROR) {
 		PIC_RemoveEvents(VGA_VerticalTimer);
 		PIC_RemoveEvents(VGA_PanningLatch);
@@ -7474,6 +8027,17 @@ void VGA_SetupDrawing(Bitu /*val*/) {
 					VGA_DrawLine = VGA_Draw_Xlat32_VGA_CRTC_bmode_Line;
 					VGA_DrawRawLine = VGA_RawDraw_Xlat32_VGA_CRTC_bmode_Line;
 				}
+				/* hand the DAC indices to the renderer instead, unless something needs per-line
+				 * CPU work: hretrace effects shift pixels, the debug overlay draws in 32bpp, and
+				 * a palette rewritten mid-frame (raster bars) needs a per-scanline palette */
+				if (vga.draw.indexed_set && !vga.draw.indexed_blocked && !vga_enable_hretrace_effects && !video_debug_overlay) {
+					bpp = 8;
+					vga.draw.indexed = true;
+					if (VGA_DrawLine == VGA_Draw_Xlat32_Linear_Line)
+						VGA_DrawLine = VGA_Draw_Indexed_Linear_Line;
+					else
+						VGA_DrawLine = VGA_Draw_Indexed_VGA_CRTC_bmode_Line;
+				}
 				break;
 			case M_LIN8:
 				bpp = 32;
@@ -8161,6 +8725,9 @@ void POD_Load_VGA_Draw( std::istream& stream )
 	// - near-pure (struct) data
 	READ_POD( &vga.draw, vga.draw );
 
+	// font RAM came back with it, rendered glyph rows are stale
+	PC98_Text_Cache_Invalidate();
+
 
 	// - reloc ptr
 	READ_POD( &linear_base_idx, linear_base_idx );
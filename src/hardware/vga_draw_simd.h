@@ -0,0 +1,198 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_VGA_DRAW_SIMD_H
+#define DOSBOX_VGA_DRAW_SIMD_H
+
+/* SIMD planar to chunky conversion for EGA_Planar_Common_Line. One group is the 4 plane bytes
+ * at one address, 8 pixels where pixel 0 is bit 7 and plane n gives bit n of the color. The
+ * kernels turn groups into 4-bit colors by testing each bit, then map them through the 16
+ * entry palette of the line: SSSE3 and NEON with byte table lookups, SSE2 one at a time.
+ * A kernel returns how many groups it did, EGA_Planar_Common_Block does the rest.
+ * x86 picks SSSE3 or SSE2 at runtime like render_simd.h, ARM uses NEON when the compiler
+ * targets it (little endian only, the tables are split into bytes in memory order). */
+
+#if defined(_M_AMD64) || defined(__amd64__) || defined(__e2k__)
+# define VGA_PLANAR_SIMD_X86 1
+# define vga_planar_sse2_available (1)
+# define vga_planar_ssse3_available (ssse3_available)
+#elif defined(__SSE__)
+# define VGA_PLANAR_SIMD_X86 1
+# define vga_planar_sse2_available (sse2_available)
+# define vga_planar_ssse3_available (ssse3_available)
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(WORDS_BIGENDIAN)
+# define VGA_PLANAR_SIMD_NEON 1
+#endif
+
+#if defined(VGA_PLANAR_SIMD_X86) || defined(VGA_PLANAR_SIMD_NEON)
+# define VGA_PLANAR_SIMD 1
+#endif
+
+struct VGA_PlanarSIMD_Palette {
+	uint32_t pal[16];						/* what each 4-bit color comes out as */
+	alignas(16) uint8_t bytes[4][16];		/* byte n of each pal entry */
+};
+
+static inline void VGA_PlanarSIMD_SplitPalette(VGA_PlanarSIMD_Palette &p) {
+	for (unsigned int c = 0;c < 16;c++) {
+		for (unsigned int b = 0;b < 4;b++)
+			p.bytes[b][c] = (uint8_t)(p.pal[c] >> (b * 8u));
+	}
+}
+
+#if defined(VGA_PLANAR_SIMD_X86)
+#include <immintrin.h>
+
+/* 16 colors from two groups, one per byte */
+#ifdef __GNUC__
+__attribute__((__target__("sse2")))
+#endif
+static inline __m128i VGA_PlanarSIMD_Colors_SSE2(const uint32_t g0, const uint32_t g1) {
+	const __m128i bits = _mm_setr_epi8((char)0x80,0x40,0x20,0x10,8,4,2,1,(char)0x80,0x40,0x20,0x10,8,4,2,1);
+	const __m128i w01 = _mm_setr_epi8(1,1,1,1,1,1,1,1,2,2,2,2,2,2,2,2);
+	const __m128i w23 = _mm_setr_epi8(4,4,4,4,4,4,4,4,8,8,8,8,8,8,8,8);
+
+	/* spread each plane byte over 8 lanes, planes 0+1 in one register and 2+3 in another */
+	const __m128i w = _mm_unpacklo_epi32(_mm_cvtsi32_si128((int)g0), _mm_cvtsi32_si128((int)g1));
+	const __m128i v = _mm_unpacklo_epi8(w, w);
+	__m128i r[2];
+
+	for (unsigned int g = 0;g < 2;g++) {
+		const __m128i x = g ? _mm_unpackhi_epi16(v, v) : _mm_unpacklo_epi16(v, v);
+		const __m128i p01 = _mm_unpacklo_epi32(x, x), p23 = _mm_unpackhi_epi32(x, x);
+		const __m128i s = _mm_or_si128(
+			_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(p01, bits), bits), w01),
+			_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(p23, bits), bits), w23));
+		r[g] = _mm_or_si128(s, _mm_srli_si128(s, 8));
+	}
+
+	return _mm_unpacklo_epi64(r[0], r[1]);
+}
+
+template <typename T>
+#ifdef __GNUC__
+__attribute__((__target__("sse2")))
+#endif
+static inline unsigned int VGA_PlanarSIMD_Line_SSE2(T *dst, const uint8_t *vram, Bitu &vidstart, const Bitu vidmask, const Bitu step, const unsigned int count, const VGA_PlanarSIMD_Palette &p) {
+	alignas(16) uint8_t c[16];
+	unsigned int done = 0;
+
+	for (;(done + 2) <= count;done += 2,dst += 16) {
+		const uint32_t g0 = *((const uint32_t*)(&vram[ vidstart & vidmask ]));
+		vidstart += step;
+		const uint32_t g1 = *((const uint32_t*)(&vram[ vidstart & vidmask ]));
+		vidstart += step;
+
+		_mm_store_si128((__m128i*)c, VGA_PlanarSIMD_Colors_SSE2(g0, g1));
+		for (unsigned int i = 0;i < 16;i++)
+			dst[i] = (T)p.pal[c[i]];
+	}
+	return done;
+}
+
+template <typename T>
+#ifdef __GNUC__
+__attribute__((__target__("ssse3")))
+#endif
+static inline unsigned int VGA_PlanarSIMD_Line_SSSE3(T *dst, const uint8_t *vram, Bitu &vidstart, const Bitu vidmask, const Bitu step, const unsigned int count, const VGA_PlanarSIMD_Palette &p) {
+	const __m128i t0 = _mm_load_si128((const __m128i*)p.bytes[0]);
+	const __m128i t1 = _mm_load_si128((const __m128i*)p.bytes[1]);
+	const __m128i t2 = _mm_load_si128((const __m128i*)p.bytes[2]);
+	const __m128i t3 = _mm_load_si128((const __m128i*)p.bytes[3]);
+	unsigned int done = 0;
+
+	for (;(done + 2) <= count;done += 2,dst += 16) {
+		const uint32_t g0 = *((const uint32_t*)(&vram[ vidstart & vidmask ]));
+		vidstart += step;
+		const uint32_t g1 = *((const uint32_t*)(&vram[ vidstart & vidmask ]));
+		vidstart += step;
+
+		const __m128i c = VGA_PlanarSIMD_Colors_SSE2(g0, g1);
+		if (sizeof(T) == 1) {
+			_mm_storeu_si128((__m128i*)dst, _mm_shuffle_epi8(t0, c));
+			continue;
+		}
+
+		/* look up each byte of the 32-bit colors, then interleave them back together */
+		const __m128i b0 = _mm_shuffle_epi8(t0, c), b1 = _mm_shuffle_epi8(t1, c);
+		const __m128i b2 = _mm_shuffle_epi8(t2, c), b3 = _mm_shuffle_epi8(t3, c);
+		const __m128i lo01 = _mm_unpacklo_epi8(b0, b1), hi01 = _mm_unpackhi_epi8(b0, b1);
+		const __m128i lo23 = _mm_unpacklo_epi8(b2, b3), hi23 = _mm_unpackhi_epi8(b2, b3);
+		_mm_storeu_si128((__m128i*)(dst +  0), _mm_unpacklo_epi16(lo01, lo23));
+		_mm_storeu_si128((__m128i*)(dst +  4), _mm_unpackhi_epi16(lo01, lo23));
+		_mm_storeu_si128((__m128i*)(dst +  8), _mm_unpacklo_epi16(hi01, hi23));
+		_mm_storeu_si128((__m128i*)(dst + 12), _mm_unpackhi_epi16(hi01, hi23));
+	}
+	return done;
+}
+#endif // VGA_PLANAR_SIMD_X86
+
+#if defined(VGA_PLANAR_SIMD_NEON)
+#include <arm_neon.h>
+
+/* vtst gives all ones for each pixel bit that is set, vst4 interleaves the looked up bytes */
+template <typename T>
+static inline unsigned int VGA_PlanarSIMD_Line_NEON(T *dst, const uint8_t *vram, Bitu &vidstart, const Bitu vidmask, const Bitu step, const unsigned int count, const VGA_PlanarSIMD_Palette &p) {
+	static const uint8_t bitmask[8] = { 0x80,0x40,0x20,0x10,0x08,0x04,0x02,0x01 };
+	const uint8x8_t bits = vld1_u8(bitmask);
+	uint8x8x2_t t[4];
+	unsigned int done = 0;
+
+	for (unsigned int b = 0;b < 4;b++) {
+		t[b].val[0] = vld1_u8(p.bytes[b]);
+		t[b].val[1] = vld1_u8(p.bytes[b] + 8);
+	}
+
+	for (;done < count;done++,dst += 8) {
+		const uint8_t *s = &vram[ vidstart & vidmask ];
+		vidstart += step;
+
+		uint8x8_t c = vand_u8(vtst_u8(vdup_n_u8(s[0]), bits), vdup_n_u8(1));
+		c = vorr_u8(c, vand_u8(vtst_u8(vdup_n_u8(s[1]), bits), vdup_n_u8(2)));
+		c = vorr_u8(c, vand_u8(vtst_u8(vdup_n_u8(s[2]), bits), vdup_n_u8(4)));
+		c = vorr_u8(c, vand_u8(vtst_u8(vdup_n_u8(s[3]), bits), vdup_n_u8(8)));
+
+		if (sizeof(T) == 1) {
+			vst1_u8((uint8_t*)dst, vtbl2_u8(t[0], c));
+		}
+		else {
+			const uint8x8x4_t d = {{ vtbl2_u8(t[0], c), vtbl2_u8(t[1], c), vtbl2_u8(t[2], c), vtbl2_u8(t[3], c) }};
+			vst4_u8((uint8_t*)dst, d);
+		}
+	}
+	return done;
+}
+#endif // VGA_PLANAR_SIMD_NEON
+
+/* Convert up to count groups starting at vidstart (advanced by step per group) into dst.
+ * T is uint8_t (low byte of each palette entry) or uint32_t. */
+template <typename T>
+static inline unsigned int VGA_PlanarSIMD_Line(T *dst, const uint8_t *vram, Bitu &vidstart, const Bitu vidmask, const Bitu step, const unsigned int count, const VGA_PlanarSIMD_Palette &p) {
+#if defined(VGA_PLANAR_SIMD_X86)
+	if (vga_planar_ssse3_available)
+		return VGA_PlanarSIMD_Line_SSSE3<T>(dst, vram, vidstart, vidmask, step, count, p);
+	if (vga_planar_sse2_available)
+		return VGA_PlanarSIMD_Line_SSE2<T>(dst, vram, vidstart, vidmask, step, count, p);
+#elif defined(VGA_PLANAR_SIMD_NEON)
+	return VGA_PlanarSIMD_Line_NEON<T>(dst, vram, vidstart, vidmask, step, count, p);
+#endif
+	(void)dst; (void)vram; (void)vidstart; (void)vidmask; (void)step; (void)count; (void)p;
+	return 0;
+}
+
+#endif
@@ -37,6 +37,7 @@ static Bitu read_p3ce(Bitu /*port*/,Bitu /*iolen*/) {
 }
 
 static void write_p3cf(Bitu /*port*/,Bitu val,Bitu iolen) {
+	VGA_MarkRegsDirty();
 	unsigned int cmplx = 0;
 
 	if (vga.dosboxig.vga_reg_lockout)
@@ -34,7 +34,14 @@
 #include "pc98_cg.h"
 #include "pc98_gdc.h"
 #include "zipfile.h"
+#include "hostmem.h"
 #include "src/ints/int10.h"
+#if C_HAVE_MMAP
+# include <sys/mman.h>
+#endif
+
+/* video memory comes from mmap() instead of new[] when it is offered for merging, see MEM_Mergeable */
+static bool vga_mem_mapped = false;
 
 unsigned char pc98_pegc_mmio[0x200] = {0}; /* PC-98 memory-mapped PEGC registers at E0000h */
 uint32_t pc98_pegc_banks[2] = {0x0000,0x0000}; /* bank switching offsets */
@@ -85,14 +92,17 @@ template <class baseLFBHandler> class VGA_SlowLFBHandler : public baseLFBHandler
 		void writeb(PhysPt addr,uint8_t val) override {
 			VGAMEM_USEC_write_delay();
 			PageHandler_HostPtWriteB(this,addr,val);
+			VGA_MarkAllDirty();
 		}
 		void writew(PhysPt addr,uint16_t val) override {
 			VGAMEM_USEC_write_delay();
 			PageHandler_HostPtWriteW(this,addr,val);
+			VGA_MarkAllDirty();
 		}
 		void writed(PhysPt addr,uint32_t val) override {
 			VGAMEM_USEC_write_delay();
 			PageHandler_HostPtWriteD(this,addr,val);
+			VGA_MarkAllDirty();
 		}
 
 		uint8_t readb(PhysPt addr) override {
@@ -365,6 +375,7 @@ template <const bool chained> static inline void VGA_Generic_Write_Handler(PhysP
 	pixels.d|=(data & mask);
 
 	((uint32_t*)vga.mem.linear)[planeaddr]=pixels.d;
+	VGA_MarkDirty(planeaddr << 2u);
 }
 
 // Fast version especially for 256-color mode.
@@ -406,6 +417,7 @@ public:
 	}
 	template <typename T=uint8_t> static INLINE void do_write_aligned(const PhysPt a,const T v) {
 		*((T*)(&vga.mem.linear[a])) = v;
+		VGA_MarkDirty(a);
 	}
 	template <typename T=uint8_t> static INLINE void do_write(const PhysPt a,const T v) {
 		if (withinplanes<T>(a)) /* aligned, do a fast typecast write */
@@ -625,6 +637,7 @@ public:
 	static INLINE void writeHandler8(PhysPt addr, uint8_t val) {
 		((uint32_t*)vga.mem.linear)[addr] =
 			(((uint32_t*)vga.mem.linear)[addr] & vga.config.full_not_map_mask) + (ExpandTable[val] & vga.config.full_map_mask);
+		VGA_MarkDirty(addr << 2u);
 	}
 
 	template <typename T=uint8_t> static INLINE void do_write(const PhysPt a,const T v) {
@@ -778,6 +791,14 @@ struct pc98_egc_shifter {
 	template <class AWT> inline void bi(const uint16_t ofs,const AWT val) {
 		size_t ip = (bufi + ofs) & (sizeof(buffer) - 1);
 
+#ifndef WORDS_BIGENDIAN
+		/* unless it wraps around the end of the buffer, this is just a little endian store */
+		if (ip + sizeof(AWT) <= sizeof(buffer)) {
+			memcpy(buffer+ip,&val,sizeof(AWT));
+			return;
+		}
+#endif
+
 		for (size_t i=0;i < sizeof(AWT);) {
 			buffer[ip] = (uint8_t)(val >> ((AWT)(i * 8U)));
 			if ((++ip) == sizeof(buffer)) ip = 0;
@@ -794,6 +815,13 @@ struct pc98_egc_shifter {
 		size_t op = (bufo + ofs) & (sizeof(buffer) - 1);
 		AWT ret = 0;
 
+#ifndef WORDS_BIGENDIAN
+		if (op + sizeof(AWT) <= sizeof(buffer)) {
+			memcpy(&ret,buffer+op,sizeof(AWT));
+			return ret;
+		}
+#endif
+
 		for (size_t i=0;i < sizeof(AWT);) {
 			ret += ((AWT)buffer[op]) << ((AWT)(i * 8U));
 			if ((++op) == sizeof(buffer)) op = 0;
@@ -1002,272 +1030,107 @@ template <class AWT> static inline void egc_fetch_planar(egc_quad &dst,const Phy
 	dst[3].w = *((uint16_t*)(pc98_pgraph_current_cpu_page+vramoff+pc98_pgram_bitplane_offset(3)));
 }
 
-/* Generic EGC ROP handling according to Neko Project II.
- * I assume it uses specialized functions for common ROPs as an optimization method
- * since this generic handler does a lot of conditional bit operations. This is
- * ope_xx transcribed for DOSBox-X. */
-static egc_quad &ope_xx(uint8_t ope, const PhysPt vramoff) {
-	egc_quad pat;
+/* The four planes of an egc_quad are 64 contiguous bits, so the ROP handlers below work on
+ * all 16 pixels of all 4 planes at once as one 64-bit value instead of plane by plane. */
+static_assert(sizeof(egc_quad) == 8, "egc_quad must be 4 packed 16-bit planes");
+
+static inline uint64_t egc_quad_load(const egc_quad &q) {
+	uint64_t r;
+	memcpy(&r,q,sizeof(r));
+	return r;
+}
+
+static inline egc_quad &egc_quad_store(egc_quad &q,const uint64_t v) {
+	memcpy(q,&v,sizeof(v));
+	return q;
+}
+
+static inline uint64_t egc_fetch_planar64(const PhysPt vramoff) {
 	egc_quad dst;
 
 	egc_fetch_planar<uint16_t>(/*&*/dst,vramoff);
+	return egc_quad_load(dst);
+}
 
+static inline uint64_t egc_pattern64(void) {
 	switch(pc98_egc_fgc) {
 		case 1:
-			pat[0].w = pc98_egc_bgcm[0].w;
-			pat[1].w = pc98_egc_bgcm[1].w;
-			pat[2].w = pc98_egc_bgcm[2].w;
-			pat[3].w = pc98_egc_bgcm[3].w;
-			break;
-
+			return egc_quad_load(pc98_egc_bgcm);
 		case 2:
-			pat[0].w = pc98_egc_fgcm[0].w;
-			pat[1].w = pc98_egc_fgcm[1].w;
-			pat[2].w = pc98_egc_fgcm[2].w;
-			pat[3].w = pc98_egc_fgcm[3].w;
-			break;
+			return egc_quad_load(pc98_egc_fgcm);
 
 		// TODO: NP2kai source code (Neko Project II KAI) suggests the illegal value 11b (3) returns one foreground and one background color.
 		//       Ref: https://github.com/AZO234/NP2kai mem/memegc.c line 774 ope_nd and ope_xx. I don't know if any games rely on that, but
 		//       it might improve emulation accuracy to support it.
 
 		default:
-			if (pc98_egc_regload & 1) {
-				pat[0].w = pc98_egc_src[0].w;
-				pat[1].w = pc98_egc_src[1].w;
-				pat[2].w = pc98_egc_src[2].w;
-				pat[3].w = pc98_egc_src[3].w;
-			}
-			else {
-				pat[0].w = pc98_gdc_tiles[0].w;
-				pat[1].w = pc98_gdc_tiles[1].w;
-				pat[2].w = pc98_gdc_tiles[2].w;
-				pat[3].w = pc98_gdc_tiles[3].w;
-			}
-			break;
+			if (pc98_egc_regload & 1)
+				return egc_quad_load(pc98_egc_src);
+			else
+				return egc_quad_load(pc98_gdc_tiles);
 	}
+}
 
-	pc98_egc_data[0].w = 0;
-	pc98_egc_data[1].w = 0;
-	pc98_egc_data[2].w = 0;
-	pc98_egc_data[3].w = 0;
-
-	if (ope & 0x80) {
-		pc98_egc_data[0].w |= (pat[0].w & pc98_egc_src[0].w & dst[0].w);
-		pc98_egc_data[1].w |= (pat[1].w & pc98_egc_src[1].w & dst[1].w);
-		pc98_egc_data[2].w |= (pat[2].w & pc98_egc_src[2].w & dst[2].w);
-		pc98_egc_data[3].w |= (pat[3].w & pc98_egc_src[3].w & dst[3].w);
-	}
-	if (ope & 0x40) {
-		pc98_egc_data[0].w |= ((~pat[0].w) & pc98_egc_src[0].w & dst[0].w);
-		pc98_egc_data[1].w |= ((~pat[1].w) & pc98_egc_src[1].w & dst[1].w);
-		pc98_egc_data[2].w |= ((~pat[2].w) & pc98_egc_src[2].w & dst[2].w);
-		pc98_egc_data[3].w |= ((~pat[3].w) & pc98_egc_src[3].w & dst[3].w);
-	}
-	if (ope & 0x20) {
-		pc98_egc_data[0].w |= (pat[0].w & pc98_egc_src[0].w & (~dst[0].w));
-		pc98_egc_data[1].w |= (pat[1].w & pc98_egc_src[1].w & (~dst[1].w));
-		pc98_egc_data[2].w |= (pat[2].w & pc98_egc_src[2].w & (~dst[2].w));
-		pc98_egc_data[3].w |= (pat[3].w & pc98_egc_src[3].w & (~dst[3].w));
-	}
-	if (ope & 0x10) {
-		pc98_egc_data[0].w |= ((~pat[0].w) & pc98_egc_src[0].w & (~dst[0].w));
-		pc98_egc_data[1].w |= ((~pat[1].w) & pc98_egc_src[1].w & (~dst[1].w));
-		pc98_egc_data[2].w |= ((~pat[2].w) & pc98_egc_src[2].w & (~dst[2].w));
-		pc98_egc_data[3].w |= ((~pat[3].w) & pc98_egc_src[3].w & (~dst[3].w));
-	}
-	if (ope & 0x08) {
-		pc98_egc_data[0].w |= (pat[0].w & (~pc98_egc_src[0].w) & dst[0].w);
-		pc98_egc_data[1].w |= (pat[1].w & (~pc98_egc_src[1].w) & dst[1].w);
-		pc98_egc_data[2].w |= (pat[2].w & (~pc98_egc_src[2].w) & dst[2].w);
-		pc98_egc_data[3].w |= (pat[3].w & (~pc98_egc_src[3].w) & dst[3].w);
-	}
-	if (ope & 0x04) {
-		pc98_egc_data[0].w |= ((~pat[0].w) & (~pc98_egc_src[0].w) & dst[0].w);
-		pc98_egc_data[1].w |= ((~pat[1].w) & (~pc98_egc_src[1].w) & dst[1].w);
-		pc98_egc_data[2].w |= ((~pat[2].w) & (~pc98_egc_src[2].w) & dst[2].w);
-		pc98_egc_data[3].w |= ((~pat[3].w) & (~pc98_egc_src[3].w) & dst[3].w);
-	}
-	if (ope & 0x02) {
-		pc98_egc_data[0].w |= (pat[0].w & (~pc98_egc_src[0].w) & (~dst[0].w));
-		pc98_egc_data[1].w |= (pat[1].w & (~pc98_egc_src[1].w) & (~dst[1].w));
-		pc98_egc_data[2].w |= (pat[2].w & (~pc98_egc_src[2].w) & (~dst[2].w));
-		pc98_egc_data[3].w |= (pat[3].w & (~pc98_egc_src[3].w) & (~dst[3].w));
-	}
-	if (ope & 0x01) {
-		pc98_egc_data[0].w |= ((~pat[0].w) & (~pc98_egc_src[0].w) & (~dst[0].w));
-		pc98_egc_data[1].w |= ((~pat[1].w) & (~pc98_egc_src[1].w) & (~dst[1].w));
-		pc98_egc_data[2].w |= ((~pat[2].w) & (~pc98_egc_src[2].w) & (~dst[2].w));
-		pc98_egc_data[3].w |= ((~pat[3].w) & (~pc98_egc_src[3].w) & (~dst[3].w));
-	}
+/* Evaluate ROP "ope" without branching. Bit 7 of ope is the result for P&S&D, bit 6 for ~P&S&D,
+ * bit 5 for P&S&~D and so on down to bit 0 for ~P&~S&~D, same as the terms Neko Project II ORs
+ * together one by one. */
+static inline uint64_t egc_rop64(const uint8_t ope,const uint64_t pat,const uint64_t src,const uint64_t dst) {
+#define OPEBIT(b) ((uint64_t)0 - (uint64_t)((ope >> (b)) & 1u))
+#define MUX(c,a,b) (((c) & (a)) | (~(c) & (b)))
+	const uint64_t r11 = MUX(dst,OPEBIT(7),OPEBIT(5)); /*  P  S */
+	const uint64_t r10 = MUX(dst,OPEBIT(3),OPEBIT(1)); /*  P ~S */
+	const uint64_t r01 = MUX(dst,OPEBIT(6),OPEBIT(4)); /* ~P  S */
+	const uint64_t r00 = MUX(dst,OPEBIT(2),OPEBIT(0)); /* ~P ~S */
+
+	return MUX(pat,MUX(src,r11,r10),MUX(src,r01,r00));
+#undef MUX
+#undef OPEBIT
+}
 
-	return pc98_egc_data;
+/* Generic EGC ROP handling according to Neko Project II.
+ * Neko Project II has ope_gg as well, which does the same thing here. */
+static egc_quad &ope_xx(uint8_t ope, const PhysPt vramoff) {
+	return egc_quad_store(pc98_egc_data,egc_rop64(ope,egc_pattern64(),egc_quad_load(pc98_egc_src),egc_fetch_planar64(vramoff)));
 }
 
 static egc_quad &ope_00(uint8_t ope, const PhysPt vramoff) {
 	(void)vramoff;
 	(void)ope;
 
-	pc98_egc_data[0].w = 0;
-	pc98_egc_data[1].w = 0;
-	pc98_egc_data[2].w = 0;
-	pc98_egc_data[3].w = 0;
-
-	return pc98_egc_data;
+	return egc_quad_store(pc98_egc_data,0);
 }
 
 static egc_quad &ope_0f(uint8_t ope, const PhysPt vramoff) {
 	(void)vramoff;
 	(void)ope;
 
-	pc98_egc_data[0].w = ~pc98_egc_src[0].w;
-	pc98_egc_data[1].w = ~pc98_egc_src[1].w;
-	pc98_egc_data[2].w = ~pc98_egc_src[2].w;
-	pc98_egc_data[3].w = ~pc98_egc_src[3].w;
-
-	return pc98_egc_data;
+	return egc_quad_store(pc98_egc_data,~egc_quad_load(pc98_egc_src));
 }
 
 static egc_quad &ope_ff(uint8_t ope, const PhysPt vramoff) {
 	(void)vramoff;
 	(void)ope;
 
-	pc98_egc_data[0].w = (uint16_t)(~0u);
-	pc98_egc_data[1].w = (uint16_t)(~0u);
-	pc98_egc_data[2].w = (uint16_t)(~0u);
-	pc98_egc_data[3].w = (uint16_t)(~0u);
-
-	return pc98_egc_data;
+	return egc_quad_store(pc98_egc_data,~(uint64_t)0);
 }
 
+/* no pattern: ope only uses the terms where P is set */
 static egc_quad &ope_np(uint8_t ope, const PhysPt vramoff) {
-	egc_quad dst;
-
-	egc_fetch_planar<uint16_t>(/*&*/dst,vramoff);
-
-	pc98_egc_data[0].w = 0;
-	pc98_egc_data[1].w = 0;
-	pc98_egc_data[2].w = 0;
-	pc98_egc_data[3].w = 0;
-
-	if (ope & 0x80) {
-		pc98_egc_data[0].w |= (pc98_egc_src[0].w & dst[0].w);
-		pc98_egc_data[1].w |= (pc98_egc_src[1].w & dst[1].w);
-		pc98_egc_data[2].w |= (pc98_egc_src[2].w & dst[2].w);
-		pc98_egc_data[3].w |= (pc98_egc_src[3].w & dst[3].w);
-	}
-	if (ope & 0x20) {
-		pc98_egc_data[0].w |= (pc98_egc_src[0].w & (~dst[0].w));
-		pc98_egc_data[1].w |= (pc98_egc_src[1].w & (~dst[1].w));
-		pc98_egc_data[2].w |= (pc98_egc_src[2].w & (~dst[2].w));
-		pc98_egc_data[3].w |= (pc98_egc_src[3].w & (~dst[3].w));
-	}
-	if (ope & 0x08) {
-		pc98_egc_data[0].w |= ((~pc98_egc_src[0].w) & dst[0].w);
-		pc98_egc_data[1].w |= ((~pc98_egc_src[1].w) & dst[1].w);
-		pc98_egc_data[2].w |= ((~pc98_egc_src[2].w) & dst[2].w);
-		pc98_egc_data[3].w |= ((~pc98_egc_src[3].w) & dst[3].w);
-	}
-	if (ope & 0x02) {
-		pc98_egc_data[0].w |= ((~pc98_egc_src[0].w) & (~dst[0].w));
-		pc98_egc_data[1].w |= ((~pc98_egc_src[1].w) & (~dst[1].w));
-		pc98_egc_data[2].w |= ((~pc98_egc_src[2].w) & (~dst[2].w));
-		pc98_egc_data[3].w |= ((~pc98_egc_src[3].w) & (~dst[3].w));
-	}
-
-	(void)ope;
-	(void)vramoff;
-	return pc98_egc_data;
+	return egc_quad_store(pc98_egc_data,egc_rop64(ope,~(uint64_t)0,egc_quad_load(pc98_egc_src),egc_fetch_planar64(vramoff)));
 }
 
+/* no destination: ope only uses the terms where D is set */
 static egc_quad &ope_nd(uint8_t ope, const PhysPt vramoff) {
-	egc_quad pat;
-
-	switch(pc98_egc_fgc) {
-		case 1:
-			pat[0].w = pc98_egc_bgcm[0].w;
-			pat[1].w = pc98_egc_bgcm[1].w;
-			pat[2].w = pc98_egc_bgcm[2].w;
-			pat[3].w = pc98_egc_bgcm[3].w;
-			break;
-
-		case 2:
-			pat[0].w = pc98_egc_fgcm[0].w;
-			pat[1].w = pc98_egc_fgcm[1].w;
-			pat[2].w = pc98_egc_fgcm[2].w;
-			pat[3].w = pc98_egc_fgcm[3].w;
-			break;
-
-		// TODO: NP2kai source code (Neko Project II KAI) suggests the illegal value 11b (3) returns one foreground and one background color.
-		//       Ref: https://github.com/AZO234/NP2kai mem/memegc.c line 774 ope_nd and ope_xx. I don't know if any games rely on that, but
-		//       it might improve emulation accuracy to support it.
-
-		default:
-			if (pc98_egc_regload & 1) {
-				pat[0].w = pc98_egc_src[0].w;
-				pat[1].w = pc98_egc_src[1].w;
-				pat[2].w = pc98_egc_src[2].w;
-				pat[3].w = pc98_egc_src[3].w;
-			}
-			else {
-				pat[0].w = pc98_gdc_tiles[0].w;
-				pat[1].w = pc98_gdc_tiles[1].w;
-				pat[2].w = pc98_gdc_tiles[2].w;
-				pat[3].w = pc98_gdc_tiles[3].w;
-			}
-			break;
-	}
-
-	pc98_egc_data[0].w = 0;
-	pc98_egc_data[1].w = 0;
-	pc98_egc_data[2].w = 0;
-	pc98_egc_data[3].w = 0;
-
-	if (ope & 0x80) {
-		pc98_egc_data[0].w |= (pat[0].w & pc98_egc_src[0].w);
-		pc98_egc_data[1].w |= (pat[1].w & pc98_egc_src[1].w);
-		pc98_egc_data[2].w |= (pat[2].w & pc98_egc_src[2].w);
-		pc98_egc_data[3].w |= (pat[3].w & pc98_egc_src[3].w);
-	}
-	if (ope & 0x40) {
-		pc98_egc_data[0].w |= ((~pat[0].w) & pc98_egc_src[0].w);
-		pc98_egc_data[1].w |= ((~pat[1].w) & pc98_egc_src[1].w);
-		pc98_egc_data[2].w |= ((~pat[2].w) & pc98_egc_src[2].w);
-		pc98_egc_data[3].w |= ((~pat[3].w) & pc98_egc_src[3].w);
-	}
-	if (ope & 0x08) {
-		pc98_egc_data[0].w |= (pat[0].w & (~pc98_egc_src[0].w));
-		pc98_egc_data[1].w |= (pat[1].w & (~pc98_egc_src[1].w));
-		pc98_egc_data[2].w |= (pat[2].w & (~pc98_egc_src[2].w));
-		pc98_egc_data[3].w |= (pat[3].w & (~pc98_egc_src[3].w));
-	}
-	if (ope & 0x04) {
-		pc98_egc_data[0].w |= ((~pat[0].w) & (~pc98_egc_src[0].w));
-		pc98_egc_data[1].w |= ((~pat[1].w) & (~pc98_egc_src[1].w));
-		pc98_egc_data[2].w |= ((~pat[2].w) & (~pc98_egc_src[2].w));
-		pc98_egc_data[3].w |= ((~pat[3].w) & (~pc98_egc_src[3].w));
-	}
-
-	(void)ope;
 	(void)vramoff;
-	return pc98_egc_data;
+
+	return egc_quad_store(pc98_egc_data,egc_rop64(ope,egc_pattern64(),egc_quad_load(pc98_egc_src),~(uint64_t)0));
 }
 
 static egc_quad &ope_c0(uint8_t ope, const PhysPt vramoff) {
-	egc_quad dst;
-
 	/* assume: ad is word aligned */
-
-	egc_fetch_planar<uint16_t>(/*&*/dst,vramoff);
-
-	pc98_egc_data[0].w = pc98_egc_src[0].w & dst[0].w;
-	pc98_egc_data[1].w = pc98_egc_src[1].w & dst[1].w;
-	pc98_egc_data[2].w = pc98_egc_src[2].w & dst[2].w;
-	pc98_egc_data[3].w = pc98_egc_src[3].w & dst[3].w;
-
 	(void)ope;
-	(void)vramoff;
-	return pc98_egc_data;
+
+	return egc_quad_store(pc98_egc_data,egc_quad_load(pc98_egc_src) & egc_fetch_planar64(vramoff));
 }
 
 static egc_quad &ope_f0(uint8_t ope, const PhysPt vramoff) {
@@ -1277,121 +1140,10 @@ static egc_quad &ope_f0(uint8_t ope, const PhysPt vramoff) {
 }
 
 static egc_quad &ope_fc(uint8_t ope, const PhysPt vramoff) {
-	egc_quad dst;
-
 	/* assume: ad is word aligned */
-
-	egc_fetch_planar<uint16_t>(/*&*/dst,vramoff);
-
-	pc98_egc_data[0].w  =    pc98_egc_src[0].w;
-	pc98_egc_data[0].w |= ((~pc98_egc_src[0].w) & dst[0].w);
-	pc98_egc_data[1].w  =    pc98_egc_src[1].w;
-	pc98_egc_data[1].w |= ((~pc98_egc_src[1].w) & dst[1].w);
-	pc98_egc_data[2].w  =    pc98_egc_src[2].w;
-	pc98_egc_data[2].w |= ((~pc98_egc_src[2].w) & dst[2].w);
-	pc98_egc_data[3].w  =    pc98_egc_src[3].w;
-	pc98_egc_data[3].w |= ((~pc98_egc_src[3].w) & dst[3].w);
-
 	(void)ope;
-	(void)vramoff;
-	return pc98_egc_data;
-}
-
-static egc_quad &ope_gg(uint8_t ope, const PhysPt vramoff) {
-	egc_quad pat,dst;
-
-	switch(pc98_egc_fgc) {
-		case 1:
-			pat[0].w = pc98_egc_bgcm[0].w;
-			pat[1].w = pc98_egc_bgcm[1].w;
-			pat[2].w = pc98_egc_bgcm[2].w;
-			pat[3].w = pc98_egc_bgcm[3].w;
-			break;
 
-		case 2:
-			pat[0].w = pc98_egc_fgcm[0].w;
-			pat[1].w = pc98_egc_fgcm[1].w;
-			pat[2].w = pc98_egc_fgcm[2].w;
-			pat[3].w = pc98_egc_fgcm[3].w;
-			break;
-
-		// TODO: NP2kai source code (Neko Project II KAI) suggests the illegal value 11b (3) returns one foreground and one background color.
-		//       Ref: https://github.com/AZO234/NP2kai mem/memegc.c line 774 ope_nd and ope_xx. I don't know if any games rely on that, but
-		//       it might improve emulation accuracy to support it.
-
-		default:
-			if (pc98_egc_regload & 1) {
-				pat[0].w = pc98_egc_src[0].w;
-				pat[1].w = pc98_egc_src[1].w;
-				pat[2].w = pc98_egc_src[2].w;
-				pat[3].w = pc98_egc_src[3].w;
-			}
-			else {
-				pat[0].w = pc98_gdc_tiles[0].w;
-				pat[1].w = pc98_gdc_tiles[1].w;
-				pat[2].w = pc98_gdc_tiles[2].w;
-				pat[3].w = pc98_gdc_tiles[3].w;
-			}
-			break;
-	}
-
-	egc_fetch_planar<uint16_t>(/*&*/dst,vramoff);
-
-	pc98_egc_data[0].w = 0;
-	pc98_egc_data[1].w = 0;
-	pc98_egc_data[2].w = 0;
-	pc98_egc_data[3].w = 0;
-
-	if (ope & 0x80) {
-		pc98_egc_data[0].w |=  ( pat[0].w  &   pc98_egc_src[0].w &    dst[0].w);
-		pc98_egc_data[1].w |=  ( pat[1].w  &   pc98_egc_src[1].w &    dst[1].w);
-		pc98_egc_data[2].w |=  ( pat[2].w  &   pc98_egc_src[2].w &    dst[2].w);
-		pc98_egc_data[3].w |=  ( pat[3].w  &   pc98_egc_src[3].w &    dst[3].w);
-	}
-	if (ope & 0x40) {
-		pc98_egc_data[0].w |= ((~pat[0].w) &   pc98_egc_src[0].w &    dst[0].w);
-		pc98_egc_data[1].w |= ((~pat[1].w) &   pc98_egc_src[1].w &    dst[1].w);
-		pc98_egc_data[2].w |= ((~pat[2].w) &   pc98_egc_src[2].w &    dst[2].w);
-		pc98_egc_data[3].w |= ((~pat[3].w) &   pc98_egc_src[3].w &    dst[3].w);
-	}
-	if (ope & 0x20) {
-		pc98_egc_data[0].w |= (  pat[0].w  &   pc98_egc_src[0].w &  (~dst[0].w));
-		pc98_egc_data[1].w |= (  pat[1].w  &   pc98_egc_src[1].w &  (~dst[1].w));
-		pc98_egc_data[2].w |= (  pat[2].w  &   pc98_egc_src[2].w &  (~dst[2].w));
-		pc98_egc_data[3].w |= (  pat[3].w  &   pc98_egc_src[3].w &  (~dst[3].w));
-	}
-	if (ope & 0x10) {
-		pc98_egc_data[0].w |= ((~pat[0].w) &   pc98_egc_src[0].w &  (~dst[0].w));
-		pc98_egc_data[1].w |= ((~pat[1].w) &   pc98_egc_src[1].w &  (~dst[1].w));
-		pc98_egc_data[2].w |= ((~pat[2].w) &   pc98_egc_src[2].w &  (~dst[2].w));
-		pc98_egc_data[3].w |= ((~pat[3].w) &   pc98_egc_src[3].w &  (~dst[3].w));
-	}
-	if (ope & 0x08) {
-		pc98_egc_data[0].w |= (  pat[0].w  & (~pc98_egc_src[0].w) &   dst[0].w);
-		pc98_egc_data[1].w |= (  pat[1].w  & (~pc98_egc_src[1].w) &   dst[1].w);
-		pc98_egc_data[2].w |= (  pat[2].w  & (~pc98_egc_src[2].w) &   dst[2].w);
-		pc98_egc_data[3].w |= (  pat[3].w  & (~pc98_egc_src[3].w) &   dst[3].w);
-	}
-	if (ope & 0x04) {
-		pc98_egc_data[0].w |= ((~pat[0].w) & (~pc98_egc_src[0].w) &   dst[0].w);
-		pc98_egc_data[1].w |= ((~pat[1].w) & (~pc98_egc_src[1].w) &   dst[1].w);
-		pc98_egc_data[2].w |= ((~pat[2].w) & (~pc98_egc_src[2].w) &   dst[2].w);
-		pc98_egc_data[3].w |= ((~pat[3].w) & (~pc98_egc_src[3].w) &   dst[3].w);
-	}
-	if (ope & 0x02) {
-		pc98_egc_data[0].w |= (  pat[0].w  & (~pc98_egc_src[0].w) & (~dst[0].w));
-		pc98_egc_data[1].w |= (  pat[1].w  & (~pc98_egc_src[1].w) & (~dst[1].w));
-		pc98_egc_data[2].w |= (  pat[2].w  & (~pc98_egc_src[2].w) & (~dst[2].w));
-		pc98_egc_data[3].w |= (  pat[3].w  & (~pc98_egc_src[3].w) & (~dst[3].w));
-	}
-	if (ope & 0x01) {
-		pc98_egc_data[0].w |= ((~pat[0].w) & (~pc98_egc_src[0].w) & (~dst[0].w));
-		pc98_egc_data[1].w |= ((~pat[1].w) & (~pc98_egc_src[1].w) & (~dst[1].w));
-		pc98_egc_data[2].w |= ((~pat[2].w) & (~pc98_egc_src[2].w) & (~dst[2].w));
-		pc98_egc_data[3].w |= ((~pat[3].w) & (~pc98_egc_src[3].w) & (~dst[3].w));
-	}
-
-	return pc98_egc_data;
+	return egc_quad_store(pc98_egc_data,egc_quad_load(pc98_egc_src) | egc_fetch_planar64(vramoff));
 }
 
 static const PC98_OPEFN pc98_egc_opfn[256] = {
@@ -1407,24 +1159,24 @@ static const PC98_OPEFN pc98_egc_opfn[256] = {
 			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
 			ope_nd, ope_xx, ope_xx, ope_xx, ope_xx, ope_nd, ope_xx, ope_xx,
 			ope_xx, ope_xx, ope_nd, ope_xx, ope_xx, ope_xx, ope_xx, ope_nd,
-			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_gg, ope_xx,
-			ope_xx, ope_xx, ope_xx, ope_xx, ope_gg, ope_xx, ope_xx, ope_xx,
 			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
 			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
 			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
-			ope_gg, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
 			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
-			ope_xx, ope_xx, ope_xx, ope_xx, ope_gg, ope_xx, ope_xx, ope_xx,
+			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
+			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
+			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
+			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
 			ope_nd, ope_xx, ope_xx, ope_xx, ope_xx, ope_nd, ope_xx, ope_xx,
-			ope_xx, ope_xx, ope_nd, ope_xx, ope_gg, ope_xx, ope_xx, ope_nd,
+			ope_xx, ope_xx, ope_nd, ope_xx, ope_xx, ope_xx, ope_xx, ope_nd,
 			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
 			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
 			ope_c0, ope_xx, ope_xx, ope_np, ope_xx, ope_xx, ope_xx, ope_xx,
-			ope_gg, ope_xx, ope_gg, ope_xx, ope_np, ope_gg, ope_xx, ope_np,
+			ope_xx, ope_xx, ope_xx, ope_xx, ope_np, ope_xx, ope_xx, ope_np,
+			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
 			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
 			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
 			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx,
-			ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_xx, ope_gg, ope_xx,
 			ope_f0, ope_xx, ope_xx, ope_np, ope_xx, ope_nd, ope_xx, ope_xx,
 			ope_xx, ope_xx, ope_nd, ope_xx, ope_fc, ope_xx, ope_xx, ope_ff};
 
@@ -1802,6 +1554,13 @@ public:
 		return *((AWT*)(pc98_pgraph_current_cpu_page+fulloff));
 	}
 
+	/* one read/modify/write of the plane: keep the bits outside the mask, take the ROP result inside */
+	template <class AWT> static inline void modeEGC_plane_w(const unsigned int plane,const PhysPt vramoff,const AWT accmask,const egc_quad &ropdata) {
+		AWT &d = *((AWT*)(pc98_pgraph_current_cpu_page+vramoff+pc98_pgram_bitplane_offset(plane)));
+
+		d = (AWT)((d & ~accmask) | (accmask & *((const AWT*)(ropdata[plane].b+(vramoff&1)))));
+	}
+
 	template <class AWT> static inline void modeEGC_w(const PhysPt vramoff,const AWT val) {
 		/* assume: vramoff is even IF AWT is 16-bit wide */
 
@@ -1828,22 +1587,10 @@ public:
 		const AWT accmask = *((AWT*)(pc98_egc_maskef+(vramoff&1)));
 
 		if (accmask != 0) {
-			if (!(pc98_egc_access & 1)) {
-				*((AWT*)(pc98_pgraph_current_cpu_page+vramoff+pc98_pgram_bitplane_offset(0))) &= ~accmask;
-				*((AWT*)(pc98_pgraph_current_cpu_page+vramoff+pc98_pgram_bitplane_offset(0))) |=  accmask & *((AWT*)(ropdata[0].b+(vramoff&1)));
-			}
-			if (!(pc98_egc_access & 2)) {
-				*((AWT*)(pc98_pgraph_current_cpu_page+vramoff+pc98_pgram_bitplane_offset(1))) &= ~accmask;
-				*((AWT*)(pc98_pgraph_current_cpu_page+vramoff+pc98_pgram_bitplane_offset(1))) |=  accmask & *((AWT*)(ropdata[1].b+(vramoff&1)));
-			}
-			if (!(pc98_egc_access & 4)) {
-				*((AWT*)(pc98_pgraph_current_cpu_page+vramoff+pc98_pgram_bitplane_offset(2))) &= ~accmask;
-				*((AWT*)(pc98_pgraph_current_cpu_page+vramoff+pc98_pgram_bitplane_offset(2))) |=  accmask & *((AWT*)(ropdata[2].b+(vramoff&1)));
-			}
-			if (!(pc98_egc_access & 8)) {
-				*((AWT*)(pc98_pgraph_current_cpu_page+vramoff+pc98_pgram_bitplane_offset(3))) &= ~accmask;
-				*((AWT*)(pc98_pgraph_current_cpu_page+vramoff+pc98_pgram_bitplane_offset(3))) |=  accmask & *((AWT*)(ropdata[3].b+(vramoff&1)));
-			}
+			if (!(pc98_egc_access & 1)) modeEGC_plane_w<AWT>(0,vramoff,accmask,ropdata);
+			if (!(pc98_egc_access & 2)) modeEGC_plane_w<AWT>(1,vramoff,accmask,ropdata);
+			if (!(pc98_egc_access & 4)) modeEGC_plane_w<AWT>(2,vramoff,accmask,ropdata);
+			if (!(pc98_egc_access & 8)) modeEGC_plane_w<AWT>(3,vramoff,accmask,ropdata);
 		}
 	}
 
@@ -2036,6 +1783,7 @@ public:
 	}
 	HostPt GetHostWritePt(PageNum phys_page) override {
 		phys_page-=vgapages.base;
+		vga.dirty.direct = true;
 		return &vga.mem.linear[(vga.svga.bank_write_full+phys_page*4096)&vga.mem.memmask];
 	}
 };
@@ -2071,6 +1819,7 @@ public:
 		return &vga.mem.linear[(phys_page*4096)&vga.mem.memmask];
 	}
 	HostPt GetHostWritePt( PageNum phys_page ) override {
+		vga.dirty.direct = true;
 		return GetHostReadPt( phys_page );
 	}
 };
@@ -2114,6 +1863,12 @@ public:
 	}
 };
 
+/* Tandy and PCjr video memory is system RAM, writes through the window have to mark it for save states */
+static HostPt TandyWritePt(HostPt ptr) {
+	if (ptr >= MemBase && ptr < MemBase+MemSize) MEM_MarkDirtyRange((PhysPt)(ptr-MemBase),4096);
+	return ptr;
+}
+
 class VGA_TANDY_PageHandler : public PageHandler { // with slow adapter
 public:
 	VGA_TANDY_PageHandler() : PageHandler(PFLAG_READABLE|PFLAG_WRITEABLE) {}
@@ -2127,7 +1882,7 @@ public:
 		return vga.tandy.mem_base + (phys_page * 4096);
 	}
 	HostPt GetHostWritePt(PageNum phys_page) override {
-		return GetHostReadPt( phys_page );
+		return TandyWritePt(GetHostReadPt( phys_page ));
 	}
 };
 
@@ -2144,7 +1899,7 @@ public:
 		return vga.tandy.mem_base + (phys_page * 4096);
 	}
 	HostPt GetHostWritePt(PageNum phys_page) override {
-		return GetHostReadPt( phys_page );
+		return TandyWritePt(GetHostReadPt( phys_page ));
 	}
 };
 
@@ -2809,9 +2564,43 @@ range_done:
 #if C_DEBUG
 	if (control->opt_display2) DISP2_SetPageHandler();
 #endif
+	/* host pointers handed out so far die with the TLB, writes made through them went untracked */
+	if (vga.dirty.direct) {
+		vga.dirty.direct = false;
+		VGA_MarkAllDirty();
+	}
 	PAGING_ClearTLB();
 }
 
+/* SVGA bank switch. The window page handlers add bank_read_full/bank_write_full
+ * themselves, so moving the bank only has to invalidate what the TLB cached for
+ * the A0000-BFFFF aperture. Without paging linear and physical addresses agree
+ * there and only those 32 entries are dropped instead of the whole TLB. */
+void VGA_SetupBankWindow(void) {
+	if (svgaCard == SVGA_DOSBoxIG) {
+		vga.svga.bank_read_full = vga.dosboxig.bank_offset & (~0xFFFu);
+		vga.svga.bank_write_full = vga.dosboxig.bank_offset & (~0xFFFu);
+	}
+	else {
+		vga.svga.bank_read_full = vga.svga.bank_read*vga.svga.bank_size;
+		vga.svga.bank_write_full = vga.svga.bank_write*vga.svga.bank_size;
+	}
+#if C_DEBUG
+	if (control->opt_display2) {
+		VGA_SetupHandlers();
+		return;
+	}
+#endif
+	if (vga.dirty.direct) {
+		vga.dirty.direct = false;
+		VGA_MarkAllDirty();
+	}
+	if (PAGING_Enabled())
+		PAGING_ClearTLB();
+	else
+		PAGING_UnlinkPages(VGA_PAGE_A0, 32);
+}
+
 void VGA_StartUpdateLFB(void) {
 	if (svgaCard == SVGA_DOSBoxIG) {
 		/* TODO: Perhaps the DOSBox Integrated Device could have an MMIO region */
@@ -2897,10 +2686,26 @@ static void VGA_Memory_ShutDown(Section * /*sec*/) {
 	PAGING_ClearTLB();
 
 	if (vga.mem.linear_orgptr != NULL) {
+#if C_HAVE_MMAP
+		if (vga_mem_mapped) munmap(vga.mem.linear_orgptr,vga.mem.memsize+32u);
+		else
+#endif
 		delete[] vga.mem.linear_orgptr;
+		vga_mem_mapped = false;
 		vga.mem.linear_orgptr = NULL;
 		vga.mem.linear = NULL;
 	}
+
+	if (vga.dirty.stamp != NULL) {
+		delete[] vga.dirty.stamp;
+		vga.dirty.stamp = NULL;
+		vga.dirty.chunks = 0;
+	}
+}
+
+void VGA_GetHostMemory(HostMemSize &sz) {
+	if (vga.mem.linear_orgptr != NULL) sz.add(vga.mem.linear_orgptr,vga.mem.memsize+32u);
+	if (vga.dirty.stamp != NULL) sz.add_heap(vga.dirty.chunks * sizeof(uint32_t));
 }
 
 void VGA_SetupMemory() {
@@ -2910,10 +2715,28 @@ void VGA_SetupMemory() {
     if (vga.mem.linear == NULL) {
         VGA_Memory_ShutDown(NULL);
 
-        vga.mem.linear_orgptr = new uint8_t[vga.mem.memsize+32u];
-        memset(vga.mem.linear_orgptr,0,vga.mem.memsize+32u);
+#if C_HAVE_MMAP && defined(MADV_MERGEABLE)
+        /* page aligned and zero filled by the host, so that identical screens and fonts of
+         * other instances line up page for page */
+        if (MEM_Mergeable()) {
+            void *p = mmap(NULL,vga.mem.memsize+32u,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+            if (p != MAP_FAILED) {
+                madvise(p,vga.mem.memsize+32u,MADV_MERGEABLE);
+                vga.mem.linear_orgptr = (uint8_t*)p;
+                vga_mem_mapped = true;
+            }
+        }
+#endif
+        if (vga.mem.linear_orgptr == NULL) {
+            vga.mem.linear_orgptr = new uint8_t[vga.mem.memsize+32u];
+            memset(vga.mem.linear_orgptr,0,vga.mem.memsize+32u);
+        }
         vga.mem.linear=(uint8_t*)(((uintptr_t)vga.mem.linear_orgptr + 16ull-1ull) & ~(16ull-1ull));
 
+        vga.dirty.chunks = (uint32_t)((vga.mem.memsize + (1u << VGA_DIRTY_SHIFT) - 1u) >> VGA_DIRTY_SHIFT);
+        vga.dirty.stamp = new uint32_t[vga.dirty.chunks]();
+        VGA_MarkAllDirty();
+
         /* HACK. try to avoid stale pointers */
 	    vga.draw.linear_base = vga.mem.linear;
         vga.tandy.draw_base = vga.mem.linear;
@@ -101,6 +101,7 @@ Bitu vga_read_p3da(Bitu port,Bitu iolen) {
 }
 
 static void write_p3c2(Bitu port,Bitu val,Bitu iolen) {
+    VGA_MarkRegsDirty();
     (void)port;//UNUSED
     (void)iolen;//UNUSED
 
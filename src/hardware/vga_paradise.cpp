@@ -66,7 +66,7 @@ static void bank_setup_pvga1a() {
 		else
 			vga.svga.bank_size = 4*1024;
 
-		VGA_SetupHandlers();
+		VGA_SetupBankWindow();
 	}
 }
 
@@ -49,6 +49,7 @@
 bool                        pc98_cg_kanji_dot_access_mode = false;
 uint16_t                    a1_font_load_addr = 0;
 uint8_t                     a1_font_char_offset = 0;
+uint32_t                    pc98_font_serial = 0;
 
 /* Character Generator ports.
  * This is in fact officially documented by NEC in
@@ -234,6 +234,59 @@ void PC98_GDC_state::draw_dot(uint16_t x, uint16_t y) {
     dot_count++;
 }
 
+/* count dots along a horizontal line from x, moving x by step (+1 or -1) after each one.
+ * Same result as calling draw_dot for each of them, but in plain VRAM access mode the dots
+ * that fall in the same word are done with one read/modify/write. With the GRCG or EGC
+ * active each dot has to go through them on its own, see draw_dot. */
+void PC98_GDC_state::draw_hline(uint16_t &x, uint16_t y, int16_t step, uint32_t count) {
+    if (pc98_gdc_vramop & 0x8) {
+        while (count--) {
+            draw_dot(x, y);
+            x += step;
+        }
+        return;
+    }
+
+    const uint32_t dpitch = pc98_gdc[GDC_SLAVE].display_pitch;
+
+    while (count) {
+        const uint32_t word = x >> 4;
+        uint16_t set = 0, clr = 0, inv = 0;
+        unsigned int n = 0;
+
+        /* dots in this word */
+        do {
+            const uint16_t dot = draw.pattern & 1;
+            const uint16_t mask = 0x8000 >> ((x ^ 8) & 15);
+
+            draw.pattern = (draw.pattern >> 1) + (dot << 15);
+            draw.dots++;
+            n++;
+
+            if (dot == 0) {
+                if (draw.mode == 0x00) clr |= mask;                         // REPLACE
+            } else if (draw.mode == 0x00 || draw.mode == 0x03) {
+                set |= mask;                                                // REPLACE or SET
+            } else if (draw.mode == 0x01) {
+                inv |= mask;                                                // COMPLEMENT
+            } else {
+                clr |= mask;                                                // CLEAR
+            }
+
+            x += step;
+            count--;
+        } while (count && (uint32_t)(x >> 4) == word);
+
+        if (word >= dpitch) continue;
+        const uint32_t addr = word + y * dpitch;
+        if (addr >= 16384u) continue;
+
+        if (set | clr | inv)
+            pc98_gdc_vwritew(draw.base + addr * 2u, (uint16_t)(((pc98_gdc_vreadw(draw.base + addr * 2u) & ~clr) | set) ^ inv));
+        dot_count += (int)n;
+    }
+}
+
 void PC98_GDC_state::pset(void) {
     prepare();
 
@@ -256,11 +309,19 @@ void PC98_GDC_state::line(void) {
                 }
                 break;
             case 1:
+                if (draw.d1 == 0) { /* horizontal */
+                    draw_hline(x, y, 1, (uint32_t)draw.dc + 1u);
+                    break;
+                }
                 for(i = 0 ; i <= draw.dc ; i++) {
                     draw_dot(x++, y + (uint16_t)((((draw.d1 * i) / draw.dc) + 1) >> 1));
                 }
                 break;
             case 2:
+                if (draw.d1 == 0) {
+                    draw_hline(x, y, 1, (uint32_t)draw.dc + 1u);
+                    break;
+                }
                 for(i = 0 ; i <= draw.dc ; i++) {
                     draw_dot(x++, y - (uint16_t)((((draw.d1 * i) / draw.dc) + 1) >> 1));
                 }
@@ -276,11 +337,19 @@ void PC98_GDC_state::line(void) {
                 }
                 break;
             case 5:
+                if (draw.d1 == 0) {
+                    draw_hline(x, y, -1, (uint32_t)draw.dc + 1u);
+                    break;
+                }
                 for(i = 0 ; i <= draw.dc ; i++) {
                     draw_dot(x--, y - (uint16_t)((((draw.d1 * i) / draw.dc) + 1) >> 1));
                 }
                 break;
             case 6:
+                if (draw.d1 == 0) {
+                    draw_hline(x, y, -1, (uint32_t)draw.dc + 1u);
+                    break;
+                }
                 for(i = 0 ; i <= draw.dc ; i++) {
                     draw_dot(x--, y + (uint16_t)((((draw.d1 * i) / draw.dc) + 1) >> 1));
                 }
@@ -434,32 +503,31 @@ void PC98_GDC_state::circle(void) {
     }
 }
 
+/* one side of a box, horizontal sides go through draw_hline */
+void PC98_GDC_state::box_edge(uint16_t &x, uint16_t &y, int16_t dx, int16_t dy, uint16_t count) {
+    if (dy == 0 && (dx == 1 || dx == -1)) {
+        draw_hline(x, y, dx, count);
+        return;
+    }
+
+    for(uint16_t i = 0 ; i < count ; i++) {
+        draw_dot(x, y);
+        x += dx;
+        y += dy;
+    }
+}
+
 void PC98_GDC_state::box(void) {
     prepare();
 
-    uint16_t i;
     uint16_t x = draw.x;
     uint16_t y = draw.y;
-    for(i = 0 ; i < draw.d ; i++) {
-        draw_dot(x, y);
-        x += vectdir[draw.dir].x;
-        y += vectdir[draw.dir].y;
-    }
-    for(i = 0 ; i < draw.d2 ; i++) {
-        draw_dot(x, y);
-        x += vectdir[draw.dir].x2;
-        y += vectdir[draw.dir].y2;
-    }
-    for(i = 0 ; i < draw.d ; i++) {
-        draw_dot(x, y);
-        x -= vectdir[draw.dir].x;
-        y -= vectdir[draw.dir].y;
-    }
-    for(i = 0 ; i < draw.d2 ; i++) {
-        draw_dot(x, y);
-        x -= vectdir[draw.dir].x2;
-        y -= vectdir[draw.dir].y2;
-    }
+    const VECTDIR &v = vectdir[draw.dir];
+
+    box_edge(x, y,  v.x,  v.y,  draw.d);
+    box_edge(x, y,  v.x2, v.y2, draw.d2);
+    box_edge(x, y, -v.x, -v.y,  draw.d);
+    box_edge(x, y, -v.x2,-v.y2, draw.d2);
 }
 
 void PC98_GDC_state::exec(uint8_t command) {
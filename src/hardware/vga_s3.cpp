@@ -73,7 +73,7 @@ void SVGA_S3_WriteCRTC(Bitu reg,Bitu val,Bitu iolen) {
             vga.svga.bank_read&=0xf0;
             vga.svga.bank_read|=val & 0xf;
             vga.svga.bank_write = vga.svga.bank_read;
-            VGA_SetupHandlers();
+            VGA_SetupBankWindow();
         }
         break;
         /*
@@ -193,7 +193,7 @@ void SVGA_S3_WriteCRTC(Bitu reg,Bitu val,Bitu iolen) {
             vga.svga.bank_read&=0xcfu;
             vga.svga.bank_read|=((uint8_t)val&0xcu)<<2u;
             vga.svga.bank_write = vga.svga.bank_read;
-            VGA_SetupHandlers();
+            VGA_SetupBankWindow();
         }
         if (((val & 0x30u) ^ (vga.config.scan_len >> 4u)) & 0x30u) {
             vga.config.scan_len&=0xffu;
@@ -420,7 +420,7 @@ void SVGA_S3_WriteCRTC(Bitu reg,Bitu val,Bitu iolen) {
 		vga.svga.bank_read=(uint8_t)val & 0xff;
 
         vga.svga.bank_write = vga.svga.bank_read;
-        VGA_SetupHandlers();
+        VGA_SetupBankWindow();
         break;
     case 0x6b:  // BIOS scratchpad: LFB address
         vga.s3.reg_6b=(uint8_t)val;
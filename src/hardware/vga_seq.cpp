@@ -136,6 +136,7 @@ unsigned int VGA_ComplexityCheck_ODDEVEN(void) {
 }
 
 void write_p3c5(Bitu /*port*/,Bitu val,Bitu iolen) {
+	VGA_MarkRegsDirty();
 	unsigned int cmplx = 0;
 
 	if (vga.dosboxig.vga_reg_lockout)
@@ -272,7 +272,7 @@ void write_p3cd_et4k(Bitu port,Bitu val,Bitu iolen) {
     (void)iolen;//UNUSED
     vga.svga.bank_write = val & 0x0fu;
     vga.svga.bank_read = (val>>4u) & 0x0fu;
-    VGA_SetupHandlers();
+    VGA_SetupBankWindow();
 }
 
 Bitu read_p3cd_et4k(Bitu port,Bitu iolen) {
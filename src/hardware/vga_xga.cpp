@@ -18,6 +18,7 @@
 
 
 #include <string.h>
+#include <algorithm>
 #include "dosbox.h"
 #include "inout.h"
 #include "logging.h"
@@ -381,6 +382,7 @@ void XGA_DrawPoint(Bitu x, Bitu y, Bitu c) {
 		default:
 			break;
 	}
+	VGA_MarkAllDirty();
 }
 
 Bitu XGA_PointMask() {
@@ -483,6 +485,278 @@ Bitu XGA_GetMixResult(Bitu mixmode, Bitu srcval, Bitu dstdata) {
 	return destval;
 }
 
+/* Span fast paths for XGA_DrawRectangle, XGA_BlitRect and XGA_DrawPattern. They take the
+ * common cases where no mix needs the destination (solid fill, source copy, pattern fill and
+ * mono expand with a transparent background) and work on VRAM a row at a time instead of
+ * going through XGA_GetPoint/XGA_DrawPoint for every pixel. The result is what the per pixel
+ * loops would draw: rows and pixels are visited in the same order, pixels outside the
+ * scissors are left alone and values are masked like XGA_DrawPoint does. Anything else
+ * (LIN4, color compare, PIX_TRANS data, reaching past the end of video memory) returns false
+ * and the per pixel loop runs instead. */
+enum {
+	XGA_SPAN_NONE = 0,		/* needs the destination, not handled here */
+	XGA_SPAN_SRC,			/* SRC */
+	XGA_SPAN_ZERO,			/* 0 (false) */
+	XGA_SPAN_ONE,			/* 1 (true) */
+	XGA_SPAN_KEEP			/* DST, pixel is left as is */
+};
+
+struct XGA_SpanBox {
+	Bits x1, y1, x2, y2;	/* target rectangle after scissoring, inclusive */
+};
+
+static unsigned int XGA_SpanMix(Bitu mixmode, bool bitmap) {
+	switch ((mixmode >> 5) & 0x03) {
+		case 0x00: /* Src is background color */
+		case 0x01: /* Src is foreground color */
+			break;
+		case 0x03: /* Src is bitmap data */
+			if (bitmap) break;
+			return XGA_SPAN_NONE;
+		default:
+			return XGA_SPAN_NONE;
+	}
+
+	switch (mixmode & 0xf) {
+		case 0x01: return XGA_SPAN_ZERO;
+		case 0x02: return XGA_SPAN_ONE;
+		case 0x03: return XGA_SPAN_KEEP;
+		case 0x07: return XGA_SPAN_SRC;
+		default: break;
+	}
+	return XGA_SPAN_NONE;
+}
+
+static INLINE bool XGA_SpanValue(unsigned int op, Bitu mixmode, Bitu srcdata, Bitu &c) {
+	switch (op) {
+		case XGA_SPAN_SRC:
+			switch ((mixmode >> 5) & 0x03) {
+				case 0x00: c = xga.backcolor; break;
+				case 0x01: c = xga.forecolor; break;
+				default: c = srcdata; break;
+			}
+			return true;
+		case XGA_SPAN_ZERO:
+			c = 0;
+			return true;
+		case XGA_SPAN_ONE:
+			c = 0xffffffff;
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+/* bytes per pixel, 0 if the span paths can't draw in this mode */
+static Bitu XGA_SpanBytes(void) {
+	if ((xga.curcommand & 0x11) != 0x11) return 0;
+
+	switch (XGA_COLOR_MODE) {
+		case M_LIN8: return 1;
+		case M_LIN15:
+		case M_LIN16: return 2;
+		case M_LIN32: return 4;
+		default: break;
+	}
+	return 0;
+}
+
+static Bitu XGA_SpanMask(void) {
+	return (XGA_COLOR_MODE == M_LIN15) ? 0x7ffful : 0xfffffffful;
+}
+
+/* Scissor a w x h rectangle whose first pixel is (x,y) and that is drawn in direction dx,dy.
+ * Returns false if nothing is left. */
+static bool XGA_SpanClip(Bits x, Bits y, Bits dx, Bits dy, Bitu w, Bitu h, XGA_SpanBox &b) {
+	b.x1 = (dx > 0) ? x : (x - (Bits)w + 1);
+	b.y1 = (dy > 0) ? y : (y - (Bits)h + 1);
+	b.x2 = b.x1 + (Bits)w - 1;
+	b.y2 = b.y1 + (Bits)h - 1;
+
+	if (b.x1 < (Bits)xga.scissors.x1) b.x1 = xga.scissors.x1;
+	if (b.x2 > (Bits)xga.scissors.x2) b.x2 = xga.scissors.x2;
+	if (b.y1 < (Bits)xga.scissors.y1) b.y1 = xga.scissors.y1;
+	if (b.y2 > (Bits)xga.scissors.y2) b.y2 = xga.scissors.y2;
+
+	return b.x1 <= b.x2 && b.y1 <= b.y2;
+}
+
+static bool XGA_SpanInVRAM(Bits x1, Bits y1, Bits x2, Bits y2, Bitu bpp) {
+	if (x1 < 0 || y1 < 0) return false;
+	return (((Bitu)y2 * XGA_SCREEN_WIDTH) + (Bitu)x2 + 1u) * bpp <= vga.mem.memsize;
+}
+
+template <typename T> static void XGA_DrawRectangleSpan(const XGA_SpanBox &b, T c) {
+	T *vram = (T*)vga.mem.linear;
+
+	for (Bits y = b.y1;y <= b.y2;y++) {
+		T *d = vram + ((Bitu)y * XGA_SCREEN_WIDTH) + (Bitu)b.x1;
+		std::fill(d, d + (b.x2 + 1 - b.x1), c);
+	}
+}
+
+static bool XGA_DrawRectangleFast(Bits x, Bits y, Bits dx, Bits dy, Bitu w, Bitu h) {
+	if (((xga.pix_cntl >> 6) & 0x3) != 0x00) return false;
+
+	const unsigned int op = XGA_SpanMix(xga.foremix, false);
+	const Bitu bpp = XGA_SpanBytes();
+	if (op == XGA_SPAN_NONE || bpp == 0) return false;
+
+	XGA_SpanBox b;
+	if (!XGA_SpanClip(x, y, dx, dy, w, h, b)) return true;
+	if (!XGA_SpanInVRAM(b.x1, b.y1, b.x2, b.y2, bpp)) return false;
+
+	Bitu c;
+	if (!XGA_SpanValue(op, xga.foremix, 0, c)) return true;
+	c &= XGA_SpanMask();
+
+	switch (bpp) {
+		case 1: XGA_DrawRectangleSpan<uint8_t>(b, (uint8_t)c); break;
+		case 2: XGA_DrawRectangleSpan<uint16_t>(b, (uint16_t)c); break;
+		case 4: XGA_DrawRectangleSpan<uint32_t>(b, (uint32_t)c); break;
+	}
+	VGA_MarkAllDirty();
+	return true;
+}
+
+/* sox,soy is where the source is relative to the target */
+template <typename T> static void XGA_BlitRectSpan(const XGA_SpanBox &b, Bits sox, Bits soy, Bits dx, Bits dy, Bitu mixselect, bool copy) {
+	const unsigned int fop = XGA_SpanMix(xga.foremix, true);
+	const unsigned int bop = XGA_SpanMix(xga.backmix, true);
+	const Bitu mask = XGA_SpanMask();
+	T *vram = (T*)vga.mem.linear;
+
+	for (Bits y = (dy > 0) ? b.y1 : b.y2;y >= b.y1 && y <= b.y2;y += dy) {
+		T *d = vram + ((Bitu)y * XGA_SCREEN_WIDTH);
+		const T *s = vram + ((Bitu)(y + soy) * XGA_SCREEN_WIDTH);
+
+		if (copy) {
+			memmove(d + b.x1, s + b.x1 + sox, (size_t)(b.x2 + 1 - b.x1) * sizeof(T));
+			continue;
+		}
+
+		for (Bits x = (dx > 0) ? b.x1 : b.x2;x >= b.x1 && x <= b.x2;x += dx) {
+			const Bitu srcdata = s[x + sox];
+			Bitu mixmode = xga.foremix;
+			unsigned int op = fop;
+			Bitu c;
+
+			if (mixselect == 0x3 && (srcdata&xga.readmask) != xga.readmask) {
+				mixmode = xga.backmix;
+				op = bop;
+			}
+			if (XGA_SpanValue(op, mixmode, srcdata, c))
+				d[x] = (T)(c & mask);
+		}
+	}
+}
+
+static bool XGA_BlitRectFast(Bits srcx, Bits srcy, Bits tarx, Bits tary, Bits dx, Bits dy) {
+	const Bitu mixselect = (xga.pix_cntl >> 6) & 0x3;
+	if (mixselect != 0x0 && mixselect != 0x3) return false;
+	if (xga.control1 & 0x100) return false; /* COLOR_CMP */
+
+	const unsigned int fop = XGA_SpanMix(xga.foremix, true);
+	const unsigned int bop = XGA_SpanMix(xga.backmix, true);
+	const Bitu bpp = XGA_SpanBytes();
+	if (fop == XGA_SPAN_NONE || bpp == 0) return false;
+	if (mixselect == 0x3 && bop == XGA_SPAN_NONE) return false;
+
+	XGA_SpanBox b;
+	if (!XGA_SpanClip(tarx, tary, dx, dy, (Bitu)xga.MAPcount + 1u, (Bitu)xga.MIPcount + 1u, b)) return true;
+
+	const Bits sox = srcx - tarx, soy = srcy - tary;
+	if (!XGA_SpanInVRAM(b.x1, b.y1, b.x2, b.y2, bpp)) return false;
+	if (!XGA_SpanInVRAM(b.x1 + sox, b.y1 + soy, b.x2 + sox, b.y2 + soy, bpp)) return false;
+
+	/* A plain copy can be a memmove per row, unless the pixel loop would read back pixels
+	 * it already wrote on this row, which is when the source trails the target. */
+	bool copy = false;
+	if (mixselect == 0x0 && fop == XGA_SPAN_SRC && ((xga.foremix >> 5) & 0x03) == 0x03 && XGA_COLOR_MODE != M_LIN15) {
+		const Bits off = (soy * (Bits)XGA_SCREEN_WIDTH) + sox;
+		const Bits n = b.x2 + 1 - b.x1;
+		copy = (dx > 0) ? !(off < 0 && -off < n) : !(off > 0 && off < n);
+	}
+
+	switch (bpp) {
+		case 1: XGA_BlitRectSpan<uint8_t>(b, sox, soy, dx, dy, mixselect, copy); break;
+		case 2: XGA_BlitRectSpan<uint16_t>(b, sox, soy, dx, dy, mixselect, copy); break;
+		case 4: XGA_BlitRectSpan<uint32_t>(b, sox, soy, dx, dy, mixselect, copy); break;
+	}
+	VGA_MarkAllDirty();
+	return true;
+}
+
+/* The 8 pixels a pattern row turns into are worked out once per target row */
+template <typename T> static void XGA_DrawPatternSpan(const XGA_SpanBox &b, Bits srcx, Bits srcy, Bitu mixselect) {
+	const unsigned int fop = XGA_SpanMix(xga.foremix, true);
+	const unsigned int bop = XGA_SpanMix(xga.backmix, true);
+	const Bitu mask = XGA_SpanMask();
+	T *vram = (T*)vga.mem.linear;
+
+	for (Bits y = b.y1;y <= b.y2;y++) {
+		const T *s = vram + ((Bitu)(srcy + (y & 0x7)) * XGA_SCREEN_WIDTH) + srcx;
+		T *d = vram + ((Bitu)y * XGA_SCREEN_WIDTH);
+		T val[8];
+		bool put[8];
+		bool solid = true;
+
+		for (unsigned int i = 0;i < 8;i++) {
+			Bitu mixmode = xga.foremix;
+			unsigned int op = fop;
+			Bitu c = 0;
+
+			if (mixselect == 0x3 && (s[i]&xga.readmask) != xga.readmask) {
+				mixmode = xga.backmix;
+				op = bop;
+			}
+			put[i] = XGA_SpanValue(op, mixmode, s[i], c);
+			val[i] = (T)(c & mask);
+			solid = solid && put[i] && val[i] == val[0];
+		}
+
+		if (solid) {
+			std::fill(d + b.x1, d + b.x2 + 1, val[0]);
+		}
+		else {
+			for (Bits x = b.x1;x <= b.x2;x++) {
+				if (put[x & 0x7]) d[x] = val[x & 0x7];
+			}
+		}
+	}
+}
+
+static bool XGA_DrawPatternFast(Bits srcx, Bits srcy, Bits tarx, Bits tary, Bits dx, Bits dy) {
+	const Bitu mixselect = (xga.pix_cntl >> 6) & 0x3;
+	if (mixselect != 0x0 && mixselect != 0x3) return false;
+
+	const unsigned int fop = XGA_SpanMix(xga.foremix, true);
+	const unsigned int bop = XGA_SpanMix(xga.backmix, true);
+	const Bitu bpp = XGA_SpanBytes();
+	if (fop == XGA_SPAN_NONE || bpp == 0) return false;
+	if (mixselect == 0x3 && bop == XGA_SPAN_NONE) return false;
+
+	XGA_SpanBox b;
+	if (!XGA_SpanClip(tarx, tary, dx, dy, (Bitu)xga.MAPcount + 1u, (Bitu)xga.MIPcount + 1u, b)) return true;
+	if (!XGA_SpanInVRAM(b.x1, b.y1, b.x2, b.y2, bpp)) return false;
+	if (!XGA_SpanInVRAM(srcx, srcy, srcx + 7, srcy + 7, bpp)) return false;
+
+	/* the pattern is read once per row, so it must not be drawn over */
+	const Bitu W = XGA_SCREEN_WIDTH;
+	if (((Bitu)srcy * W) + (Bitu)srcx <= ((Bitu)b.y2 * W) + (Bitu)b.x2 &&
+		((Bitu)b.y1 * W) + (Bitu)b.x1 <= ((Bitu)(srcy + 7) * W) + (Bitu)(srcx + 7))
+		return false;
+
+	switch (bpp) {
+		case 1: XGA_DrawPatternSpan<uint8_t>(b, srcx, srcy, mixselect); break;
+		case 2: XGA_DrawPatternSpan<uint16_t>(b, srcx, srcy, mixselect); break;
+		case 4: XGA_DrawPatternSpan<uint32_t>(b, srcx, srcy, mixselect); break;
+	}
+	VGA_MarkAllDirty();
+	return true;
+}
+
 void XGA_DrawLineVector(Bitu val) {
 	Bits xat, yat;
 	Bitu srcval;
@@ -759,6 +1033,12 @@ void XGA_DrawRectangle(Bitu val) {
 		else return;
 	}
 
+	if (XGA_DrawRectangleFast(xga.curx, srcy, dx, dy, (Bitu)xrun + 1u, (Bitu)xga.MIPcount + 1u)) {
+		xga.curx = (uint16_t)(xga.curx + (dx * ((Bits)xrun + 1)));
+		xga.cury = (uint16_t)(srcy + (dy * ((Bits)xga.MIPcount + 1)));
+		return;
+	}
+
 	for(yat=0;yat<=xga.MIPcount;yat++) {
 		srcx = xga.curx;
 		for(xat=0;xat<=xrun;xat++) {
@@ -1063,6 +1343,8 @@ void XGA_BlitRect(Bitu val) {
 			break;
 	}
 
+	if (XGA_BlitRectFast(srcx, srcy, tarx, tary, dx, dy))
+		return;
 
 	/* Copy source to video ram */
 	for(yat=0;yat<=xga.MIPcount ;yat++) {
@@ -1166,6 +1448,9 @@ void XGA_DrawPattern(Bitu val) {
 			break;
 	}
 
+	if (XGA_DrawPatternFast(srcx, srcy, xga.destx, tary, dx, dy))
+		return;
+
 	for(yat=0;yat<=xga.MIPcount;yat++) {
 		Bits tarx = xga.destx;
 		for(xat=0;xat<=xga.MAPcount;xat++) {
@@ -1615,6 +1900,7 @@ void XGA_DrawVirgePixel(XGAStatus::XGA_VirgeState::reggroup &rset,unsigned int x
 		default:
 			break;
 	}
+	VGA_MarkAllDirty();
 }
 
 inline void XGA_DrawVirgePixelCR(XGAStatus::XGA_VirgeState::reggroup &rset,unsigned int x,unsigned int y,uint32_t c) {
@@ -72,6 +72,13 @@ enum
 /* size of the rasterizer hash table */
 #define RASTER_HASH_SIZE		97
 
+/* software rasterizer: a triangle is split into at most this many scanline bands */
+#define MAX_RASTER_BANDS		16
+
+/* bands are at least this many scanlines, and a triangle needs roughly this many pixels to be split */
+#define RASTER_BAND_MIN_LINES	16
+#define RASTER_BAND_MIN_PIXELS	4096
+
 /* flags for LFB writes */
 #define LFB_RGB_PRESENT			1
 #define LFB_ALPHA_PRESENT		2
@@ -618,6 +625,7 @@ struct _tmu_shared_state
 	rgb_t				rgb565[65536];			/* RGB 5-6-5 lookup table */
 	rgb_t				argb1555[65536];		/* ARGB 1-5-5-5 lookup table */
 	rgb_t				argb4444[65536];		/* ARGB 4-4-4-4 lookup table */
+	bool				built;					/* tables above are filled in */
 };
 
 
@@ -724,6 +732,7 @@ struct _poly_extra_data
 {
 	voodoo_state *		state;					/* pointer back to the voodoo state */
 	raster_info *		info;					/* pointer to rasterizer information */
+	stats_block *		stats;					/* statistics of the band being drawn */
 
 	INT16				ax, ay;					/* vertex A x,y (12.4) */
 	INT32				startr, startg, startb, starta; /* starting R,G,B,A (12.12) */
@@ -782,7 +791,7 @@ struct _voodoo_state
 	tmu_state			tmu[MAX_TMU];			/* TMU states */
 	tmu_shared_state	tmushare;				/* TMU shared state */
 
-	stats_block	*		thread_stats;			/* per-thread statistics */
+	stats_block	*		thread_stats;			/* per-band statistics (MAX_RASTER_BANDS) */
 
 	int					next_rasterizer;		/* next rasterizer index */
 	raster_info			rasterizer[MAX_RASTERIZERS];	/* array of rasterizers */
@@ -75,6 +75,8 @@ iterated W    = 18.32 [48 bits]
 #include <string.h>
 #include <math.h>
 
+#include <algorithm>
+
 #include "dosbox.h"
 #include "cross.h"
 #include "logging.h"
@@ -84,6 +86,8 @@ iterated W    = 18.32 [48 bits]
 
 #include "voodoo_def.h"
 
+#include "threadpool.h"
+
 
 voodoo_state *v;
 
@@ -101,6 +105,7 @@ static UINT8 dither2_lookup[256*16*2];
 
 /* fast reciprocal+log2 lookup */
 UINT32 voodoo_reciplog[(2 << RECIPLOG_LOOKUP_BITS) + 2];
+static bool voodoo_tables_built = false;
 
 
 
@@ -133,12 +138,16 @@ static void raster_fastfill(void *dest, INT32 scanline, const poly_extent *exten
     RASTERIZER MANAGEMENT
 ***************************************************************************/
 
-void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbase,
+/* The whole pixel pipeline for one scanline. The mode registers are passed in so that the
+   specialized rasterizers below can hand in constants and let the compiler drop every test
+   that does not apply, the generic ones pass the live register values. */
+static INLINE void raster_pipeline(UINT32 TMUS, UINT32 FBZCOLORPATH, UINT32 ALPHAMODE, UINT32 FOGMODE, UINT32 FBZMODE,
+					UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbase,
 					INT32 y, const poly_extent *extent,	const void *extradata)
 {
 	const poly_extra_data *extra = (const poly_extra_data *)extradata;
 	voodoo_state *v = extra->state;
-	stats_block *stats = &v->thread_stats[0];
+	stats_block *stats = extra->stats;
 	DECLARE_DITHER_POINTERS;
 	INT32 startx = extent->startx;
 	INT32 stopx = extent->stopx;
@@ -155,14 +164,14 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 
 	/* determine the screen Y */
 	scry = y;
-	if (FBZMODE_Y_ORIGIN(v->reg[fbzMode].u))
+	if (FBZMODE_Y_ORIGIN(FBZMODE))
 		scry = (v->fbi.yorigin - y) & 0x3ff;
 
 	/* compute the dithering pointers */
-	if (FBZMODE_ENABLE_DITHERING(v->reg[fbzMode].u))
+	if (FBZMODE_ENABLE_DITHERING(FBZMODE))
 	{
 		dither4 = &dither_matrix_4x4[(y & 3) * 4];
-		if (FBZMODE_DITHER_TYPE(v->reg[fbzMode].u) == 0)
+		if (FBZMODE_DITHER_TYPE(FBZMODE) == 0)
 		{
 			dither = dither4;
 			dither_lookup = &dither4_lookup[(y & 3) << 11];
@@ -175,7 +184,7 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 	}
 
 	/* apply clipping */
-	if (FBZMODE_ENABLE_CLIPPING(v->reg[fbzMode].u))
+	if (FBZMODE_ENABLE_CLIPPING(FBZMODE))
 	{
 		INT32 tempclip;
 
@@ -236,7 +245,7 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 		rgb_union texel = { 0 };
 
 		/* pixel pipeline part 1 handles depth testing and stippling */
-		PIXEL_PIPELINE_BEGIN(v, x, y, v->reg[fbzColorPath].u, v->reg[fbzMode].u, iterz, iterw);
+		PIXEL_PIPELINE_BEGIN(v, x, y, FBZCOLORPATH, FBZMODE, iterz, iterw);
 
 		/* run the texture pipeline on TMU1 to produce a value in texel */
 		/* note that they set LOD min to 8 to "disable" a TMU */
@@ -260,7 +269,7 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 		}
 
 		/* colorpath pipeline selects source colors and does blending */
-		CLAMPED_ARGB(iterr, iterg, iterb, itera, v->reg[fbzColorPath].u, iterargb);
+		CLAMPED_ARGB(iterr, iterg, iterb, itera, FBZCOLORPATH, iterargb);
 
 
 		INT32 blendr, blendg, blendb, blenda;
@@ -268,7 +277,7 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 		rgb_union c_local;
 
 		/* compute c_other */
-		switch (FBZCP_CC_RGBSELECT(v->reg[fbzColorPath].u))
+		switch (FBZCP_CC_RGBSELECT(FBZCOLORPATH))
 		{
 			case 0:		/* iterated RGB */
 				c_other.u = iterargb.u;
@@ -285,10 +294,10 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 		}
 
 		/* handle chroma key */
-		APPLY_CHROMAKEY(v, stats, v->reg[fbzMode].u, c_other);
+		APPLY_CHROMAKEY(v, stats, FBZMODE, c_other);
 
 		/* compute a_other */
-		switch (FBZCP_CC_ASELECT(v->reg[fbzColorPath].u))
+		switch (FBZCP_CC_ASELECT(FBZCOLORPATH))
 		{
 			case 0:		/* iterated alpha */
 				c_other.rgb.a = iterargb.rgb.a;
@@ -305,15 +314,15 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 		}
 
 		/* handle alpha mask */
-		APPLY_ALPHAMASK(v, stats, v->reg[fbzMode].u, c_other.rgb.a);
+		APPLY_ALPHAMASK(v, stats, FBZMODE, c_other.rgb.a);
 
 		/* handle alpha test */
-		APPLY_ALPHATEST(v, stats, v->reg[alphaMode].u, c_other.rgb.a);
+		APPLY_ALPHATEST(v, stats, ALPHAMODE, c_other.rgb.a);
 
 		/* compute c_local */
-		if (FBZCP_CC_LOCALSELECT_OVERRIDE(v->reg[fbzColorPath].u) == 0)
+		if (FBZCP_CC_LOCALSELECT_OVERRIDE(FBZCOLORPATH) == 0)
 		{
-			if (FBZCP_CC_LOCALSELECT(v->reg[fbzColorPath].u) == 0)	/* iterated RGB */
+			if (FBZCP_CC_LOCALSELECT(FBZCOLORPATH) == 0)	/* iterated RGB */
 				c_local.u = iterargb.u;
 			else											/* color0 RGB */
 				c_local.u = v->reg[color0].u;
@@ -327,7 +336,7 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 		}
 
 		/* compute a_local */
-		switch (FBZCP_CCA_LOCALSELECT(v->reg[fbzColorPath].u))
+		switch (FBZCP_CCA_LOCALSELECT(FBZCOLORPATH))
 		{
 			default:
 			case 0:		/* iterated alpha */
@@ -339,21 +348,21 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 			case 2:		/* clamped iterated Z[27:20] */
 			{
 				int temp;
-				CLAMPED_Z(iterz, v->reg[fbzColorPath].u, temp);
+				CLAMPED_Z(iterz, FBZCOLORPATH, temp);
 				c_local.rgb.a = (UINT8)temp;
 				break;
 			}
 			case 3:		/* clamped iterated W[39:32] */
 			{
 				int temp;
-				CLAMPED_W(iterw, v->reg[fbzColorPath].u, temp);			/* Voodoo 2 only */
+				CLAMPED_W(iterw, FBZCOLORPATH, temp);			/* Voodoo 2 only */
 				c_local.rgb.a = (UINT8)temp;
 				break;
 			}
 		}
 
 		/* select zero or c_other */
-		if (FBZCP_CC_ZERO_OTHER(v->reg[fbzColorPath].u) == 0)
+		if (FBZCP_CC_ZERO_OTHER(FBZCOLORPATH) == 0)
 		{
 			r = c_other.rgb.r;
 			g = c_other.rgb.g;
@@ -363,13 +372,13 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 			r = g = b = 0;
 
 		/* select zero or a_other */
-		if (FBZCP_CCA_ZERO_OTHER(v->reg[fbzColorPath].u) == 0)
+		if (FBZCP_CCA_ZERO_OTHER(FBZCOLORPATH) == 0)
 			a = c_other.rgb.a;
 		else
 			a = 0;
 
 		/* subtract c_local */
-		if (FBZCP_CC_SUB_CLOCAL(v->reg[fbzColorPath].u))
+		if (FBZCP_CC_SUB_CLOCAL(FBZCOLORPATH))
 		{
 			r -= c_local.rgb.r;
 			g -= c_local.rgb.g;
@@ -377,11 +386,11 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 		}
 
 		/* subtract a_local */
-		if (FBZCP_CCA_SUB_CLOCAL(v->reg[fbzColorPath].u))
+		if (FBZCP_CCA_SUB_CLOCAL(FBZCOLORPATH))
 			a -= c_local.rgb.a;
 
 		/* blend RGB */
-		switch (FBZCP_CC_MSELECT(v->reg[fbzColorPath].u))
+		switch (FBZCP_CC_MSELECT(FBZCOLORPATH))
 		{
 			default:	/* reserved */
 			case 0:		/* 0 */
@@ -409,7 +418,7 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 		}
 
 		/* blend alpha */
-		switch (FBZCP_CCA_MSELECT(v->reg[fbzColorPath].u))
+		switch (FBZCP_CCA_MSELECT(FBZCOLORPATH))
 		{
 			default:	/* reserved */
 			case 0:		/* 0 */
@@ -430,7 +439,7 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 		}
 
 		/* reverse the RGB blend */
-		if (!FBZCP_CC_REVERSE_BLEND(v->reg[fbzColorPath].u))
+		if (!FBZCP_CC_REVERSE_BLEND(FBZCOLORPATH))
 		{
 			blendr ^= 0xff;
 			blendg ^= 0xff;
@@ -438,7 +447,7 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 		}
 
 		/* reverse the alpha blend */
-		if (!FBZCP_CCA_REVERSE_BLEND(v->reg[fbzColorPath].u))
+		if (!FBZCP_CCA_REVERSE_BLEND(FBZCOLORPATH))
 			blenda ^= 0xff;
 
 		/* do the blend */
@@ -448,7 +457,7 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 		a = (a * (blenda + 1)) >> 8;
 
 		/* add clocal or alocal to RGB */
-		switch (FBZCP_CC_ADD_ACLOCAL(v->reg[fbzColorPath].u))
+		switch (FBZCP_CC_ADD_ACLOCAL(FBZCOLORPATH))
 		{
 			case 3:		/* reserved */
 			case 0:		/* nothing */
@@ -466,7 +475,7 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 		}
 
 		/* add clocal or alocal to alpha */
-		if (FBZCP_CCA_ADD_ACLOCAL(v->reg[fbzColorPath].u))
+		if (FBZCP_CCA_ADD_ACLOCAL(FBZCOLORPATH))
 			a += c_local.rgb.a;
 
 		/* clamp */
@@ -476,21 +485,21 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 		CLAMP(a, 0x00, 0xff);
 
 		/* invert */
-		if (FBZCP_CC_INVERT_OUTPUT(v->reg[fbzColorPath].u))
+		if (FBZCP_CC_INVERT_OUTPUT(FBZCOLORPATH))
 		{
 			r ^= 0xff;
 			g ^= 0xff;
 			b ^= 0xff;
 		}
-		if (FBZCP_CCA_INVERT_OUTPUT(v->reg[fbzColorPath].u))
+		if (FBZCP_CCA_INVERT_OUTPUT(FBZCOLORPATH))
 			a ^= 0xff;
 
 
 		/* pixel pipeline part 2 handles fog, alpha, and final output */
 		PIXEL_PIPELINE_MODIFY(v, dither, dither4, x,
-							v->reg[fbzMode].u, v->reg[fbzColorPath].u, v->reg[alphaMode].u, v->reg[fogMode].u,
+							FBZMODE, FBZCOLORPATH, ALPHAMODE, FOGMODE,
 							iterz, iterw, iterargb);
-		PIXEL_PIPELINE_FINISH(v, dither_lookup, x, dest, depth, v->reg[fbzMode].u);
+		PIXEL_PIPELINE_FINISH(v, dither_lookup, x, dest, depth, FBZMODE);
 		PIXEL_PIPELINE_END(stats);
 
 		/* update the iterated parameters */
@@ -521,18 +530,85 @@ void raster_generic(UINT32 TMUS, UINT32 TEXMODE0, UINT32 TEXMODE1, void *destbas
 ***************************************************************************/
 
 void raster_generic_0tmu(void *destbase, INT32 y, const poly_extent *extent, const void *extradata) {
-	raster_generic(0, 0, 0, destbase, y, extent, extradata);
+	raster_pipeline(0, v->reg[fbzColorPath].u, v->reg[alphaMode].u, v->reg[fogMode].u, v->reg[fbzMode].u,
+					0, 0, destbase, y, extent, extradata);
 }
 
 void raster_generic_1tmu(void *destbase, INT32 y, const poly_extent *extent, const void *extradata) {
-	raster_generic(1, v->tmu[0].reg[textureMode].u, 0, destbase, y, extent, extradata);
+	raster_pipeline(1, v->reg[fbzColorPath].u, v->reg[alphaMode].u, v->reg[fogMode].u, v->reg[fbzMode].u,
+					v->tmu[0].reg[textureMode].u, 0, destbase, y, extent, extradata);
 }
 
 void raster_generic_2tmu(void *destbase, INT32 y, const poly_extent *extent, const void *extradata) {
-	raster_generic(2, v->tmu[0].reg[textureMode].u, v->tmu[1].reg[textureMode].u, destbase, y, extent, extradata);
+	raster_pipeline(2, v->reg[fbzColorPath].u, v->reg[alphaMode].u, v->reg[fogMode].u, v->reg[fbzMode].u,
+					v->tmu[0].reg[textureMode].u, v->tmu[1].reg[textureMode].u, destbase, y, extent, extradata);
 }
 
 
+/***************************************************************************
+    SPECIALIZED RASTERIZERS
+***************************************************************************/
+
+/* Same pipeline with the normalized mode registers as constants, like the MAME
+   RASTERIZER_ENTRY functions. normalize_*() only clears bits the pipeline does not
+   look at (or reads from the live register, like the alpha reference), so a
+   specialized rasterizer gives the same pixels as the generic one. */
+template <UINT32 FBZCOLORPATH, UINT32 ALPHAMODE, UINT32 FOGMODE, UINT32 FBZMODE, UINT32 TEXMODE0, UINT32 TEXMODE1>
+static void raster_specialized(void *destbase, INT32 y, const poly_extent *extent, const void *extradata) {
+	raster_pipeline((TEXMODE0 == 0xffffffff) ? 0 : (TEXMODE1 == 0xffffffff) ? 1 : 2,
+					FBZCOLORPATH, ALPHAMODE, FOGMODE, FBZMODE, TEXMODE0, TEXMODE1, destbase, y, extent, extradata);
+}
+
+struct raster_entry
+{
+	UINT32				eff_color_path;
+	UINT32				eff_alpha_mode;
+	UINT32				eff_fog_mode;
+	UINT32				eff_fbz_mode;
+	UINT32				eff_tex_mode_0;			/* 0xffffffff if TMU #0 is unused */
+	UINT32				eff_tex_mode_1;			/* 0xffffffff if TMU #1 is unused */
+	poly_draw_scanline_func callback;
+};
+
+#define RASTERIZER_ENTRY(fbzcp, alpha, fog, fbz, tex0, tex1) \
+	{ fbzcp, alpha, fog, fbz, tex0, tex1, raster_specialized<fbzcp, alpha, fog, fbz, tex0, tex1> }
+
+/* Normalized register values, built from the usual Glide combine modes:
+     fbzColorPath  0x0824100:  iterated RGBA (combine LOCAL, local = iterated)
+                   0x0000005:  texture RGBA (decal)
+                   0x0482405:  texture RGBA * iterated RGBA (modulate)
+     alphaMode     0x0005110:  blend SRC_ALPHA / ONE_MINUS_SRC_ALPHA
+                   0x0000009:  alpha test GREATER
+     fbzMode       0x0000301:  clip, dither, RGB write
+                   0x0000731:  clip, Z buffer LESS, dither, RGB + depth write
+                   0x0000739:  same with W buffer
+     textureMode   0x08241A07: perspective, bilinear, 16-bit format, TMU combine LOCAL
+                   0x08241007: same with an 8-bit format
+   The generic fallback statistic in voodoo_shutdown() lists what else games use. */
+static const raster_entry predef_rasterizers[] =
+{
+	/* untextured */
+	RASTERIZER_ENTRY( 0x00824100, 0x00000000, 0x00000000, 0x00000301, 0xFFFFFFFF, 0xFFFFFFFF ),
+	RASTERIZER_ENTRY( 0x00824100, 0x00000000, 0x00000000, 0x00000731, 0xFFFFFFFF, 0xFFFFFFFF ),
+	RASTERIZER_ENTRY( 0x00824100, 0x00000000, 0x00000000, 0x00000739, 0xFFFFFFFF, 0xFFFFFFFF ),
+	RASTERIZER_ENTRY( 0x00824100, 0x00005110, 0x00000000, 0x00000731, 0xFFFFFFFF, 0xFFFFFFFF ),
+
+	/* decal */
+	RASTERIZER_ENTRY( 0x00000005, 0x00000000, 0x00000000, 0x00000301, 0x08241A07, 0xFFFFFFFF ),
+	RASTERIZER_ENTRY( 0x00000005, 0x00000000, 0x00000000, 0x00000731, 0x08241A07, 0xFFFFFFFF ),
+	RASTERIZER_ENTRY( 0x00000005, 0x00000000, 0x00000000, 0x00000739, 0x08241A07, 0xFFFFFFFF ),
+	RASTERIZER_ENTRY( 0x00000005, 0x00000000, 0x00000000, 0x00000731, 0x08241007, 0xFFFFFFFF ),
+	RASTERIZER_ENTRY( 0x00000005, 0x00000009, 0x00000000, 0x00000731, 0x08241A07, 0xFFFFFFFF ),
+
+	/* modulate */
+	RASTERIZER_ENTRY( 0x00482405, 0x00000000, 0x00000000, 0x00000731, 0x08241A07, 0xFFFFFFFF ),
+	RASTERIZER_ENTRY( 0x00482405, 0x00000000, 0x00000000, 0x00000739, 0x08241A07, 0xFFFFFFFF ),
+	RASTERIZER_ENTRY( 0x00482405, 0x00005110, 0x00000000, 0x00000731, 0x08241A07, 0xFFFFFFFF ),
+	RASTERIZER_ENTRY( 0x00482405, 0x00000000, 0x00000000, 0x00000731, 0x08241007, 0xFFFFFFFF ),
+	RASTERIZER_ENTRY( 0x00482405, 0x00000000, 0x00000000, 0x00000731, 0x08241A07, 0x08241A07 ),
+};
+
+
 
 /*************************************
  *
@@ -587,6 +663,9 @@ void init_tmu_shared(tmu_shared_state *s)
 {
 	int val;
 
+	if (s->built) return;
+	s->built = true;
+
 	/* build static 8-bit texel tables */
 	for (val = 0; val < 256; val++)
 	{
@@ -994,6 +1073,9 @@ void recompute_texture_params(tmu_state *t)
 	UINT32 base;
 	int lod;
 
+	/* every texture lookup comes through here first, the first one builds the texel tables */
+	init_tmu_shared(&v->tmushare);
+
 	/* extract LOD parameters */
 	t->lodmin = TEXLOD_LODMIN(t->reg[tLOD].u) << 6;
 	t->lodmax = TEXLOD_LODMAX(t->reg[tLOD].u) << 6;
@@ -1127,11 +1209,54 @@ INLINE INT32 round_coordinate(float value)
 	return result + (value - (float)result > 0.5f);
 }
 
+/* draw scanlines first..last-1 of a triangle sorted by Y */
+static void poly_render_scanlines(void *dest, poly_draw_scanline_func callback, const poly_vertex *v1, const poly_vertex *v2,
+					float dxdy_v1v2, float dxdy_v1v3, float dxdy_v2v3, INT32 first, INT32 last, const poly_extra_data *extra)
+{
+	INT32 curscan, scaninc=1;
+	poly_extent extent;
+	int extnum=0;
+	for (curscan = first; curscan < last; curscan += scaninc)
+	{
+		{
+			float fully = (float)(curscan + extnum) + 0.5f;
+			float startx = v1->x + (fully - v1->y) * dxdy_v1v3;
+			float stopx;
+			INT32 istartx, istopx;
+
+			/* compute the ending X based on which part of the triangle we're in */
+			if (fully < v2->y)
+				stopx = v1->x + (fully - v1->y) * dxdy_v1v2;
+			else
+				stopx = v2->x + (fully - v2->y) * dxdy_v2v3;
+
+			/* clamp to full pixels */
+			istartx = round_coordinate(startx);
+			istopx = round_coordinate(stopx);
+
+			/* force start < stop */
+			if (istartx > istopx)
+			{
+				INT32 temp = istartx;
+				istartx = istopx;
+				istopx = temp;
+			}
+
+			/* set the extent and update the total pixel count */
+			if (istartx >= istopx)
+				istartx = istopx = 0;
+
+			extent.startx = istartx;
+			extent.stopx = istopx;
+			(callback)(dest,curscan,&extent,extra);
+		}
+	}
+}
+
 void poly_render_triangle(void *dest, poly_draw_scanline_func callback, const poly_vertex *v1, const poly_vertex *v2, const poly_vertex *v3, poly_extra_data *extra)
 {
 	float dxdy_v1v2, dxdy_v1v3, dxdy_v2v3;
 	const poly_vertex *tv;
-	INT32 curscan, scaninc=1;
 
 	INT32 v1yclip, v3yclip;
     INT32 v1y, v3y;
@@ -1173,45 +1298,51 @@ void poly_render_triangle(void *dest, poly_draw_scanline_func callback, const po
 	dxdy_v1v3 = (v3->y == v1->y) ? 0.0f : (v3->x - v1->x) / (v3->y - v1->y);
 	dxdy_v2v3 = (v3->y == v2->y) ? 0.0f : (v3->x - v2->x) / (v3->y - v2->y);
 
-	poly_extent *extent = new poly_extent;
-	int extnum=0;
-	for (curscan = v1yclip; curscan < v3yclip; curscan += scaninc)
+	/* big triangles are split into bands of scanlines drawn by the worker pool. The
+	   bands of one triangle never touch the same pixel, and all of them are finished
+	   before the next triangle, so framebuffer and depth writes happen in the same
+	   order as when drawing serially. Rotating stipple advances the stipple register
+	   per pixel and must stay in scanline order. */
+	int bands = 1;
+	UINT32 fbzmode = extra->state->reg[fbzMode].u;
+	if (THREADPOOL_Workers() > 0 &&
+		!(FBZMODE_ENABLE_STIPPLE(fbzmode) && FBZMODE_STIPPLE_PATTERN(fbzmode) == 0))
 	{
-		{
-			float fully = (float)(curscan + extnum) + 0.5f;
-			float startx = v1->x + (fully - v1->y) * dxdy_v1v3;
-			float stopx;
-			INT32 istartx, istopx;
+		float minx = MIN(v1->x, MIN(v2->x, v3->x));
+		float maxx = MAX(v1->x, MAX(v2->x, v3->x));
+		INT32 lines = v3yclip - v1yclip;
 
-			/* compute the ending X based on which part of the triangle we're in */
-			if (fully < v2->y)
-				stopx = v1->x + (fully - v1->y) * dxdy_v1v2;
-			else
-				stopx = v2->x + (fully - v2->y) * dxdy_v2v3;
+		if ((maxx - minx) * (float)lines * 0.5f >= (float)RASTER_BAND_MIN_PIXELS)
+		{
+			bands = MIN((int)THREADPOOL_Workers() + 1, (int)(lines / RASTER_BAND_MIN_LINES));
+			bands = MIN(bands, MAX_RASTER_BANDS);
+		}
+	}
 
-			/* clamp to full pixels */
-			istartx = round_coordinate(startx);
-			istopx = round_coordinate(stopx);
+	if (bands > 1)
+	{
+		poly_extra_data bandextra[MAX_RASTER_BANDS];
+		ThreadPoolGroup group;
+		INT32 lines = v3yclip - v1yclip;
 
-			/* force start < stop */
-			if (istartx > istopx)
-			{
-				INT32 temp = istartx;
-				istartx = istopx;
-				istopx = temp;
-			}
+		for (int band = 0; band < bands; band++)
+		{
+			INT32 first = v1yclip + (INT32)(((INT64)lines * band) / bands);
+			INT32 last = v1yclip + (INT32)(((INT64)lines * (band + 1)) / bands);
 
-			/* set the extent and update the total pixel count */
-			if (istartx >= istopx)
-				istartx = istopx = 0;
+			bandextra[band] = *extra;
+			bandextra[band].stats = &extra->state->thread_stats[band];
 
-			extent->startx = istartx;
-			extent->stopx = istopx;
-			(callback)(dest,curscan,extent,extra);
+			poly_extra_data *bextra = &bandextra[band];
+			group.run([=]() {
+				poly_render_scanlines(dest, callback, v1, v2, dxdy_v1v2, dxdy_v1v3, dxdy_v2v3, first, last, bextra);
+			});
 		}
+		group.wait();
+		return;
 	}
 
-	delete extent;
+	poly_render_scanlines(dest, callback, v1, v2, dxdy_v1v2, dxdy_v1v3, dxdy_v2v3, v1yclip, v3yclip, extra);
 }
 
 
@@ -1277,9 +1408,12 @@ static void accumulate_statistics(voodoo_state *v, const stats_block *stats)
 static void update_statistics(voodoo_state *v, bool accumulate)
 {
 	/* accumulate/reset statistics from all units */
-	if (accumulate)
-		accumulate_statistics(v, &v->thread_stats[0]);
-	memset(&v->thread_stats[0], 0, sizeof(v->thread_stats[0]));
+	for (int band = 0; band < MAX_RASTER_BANDS; band++)
+	{
+		if (accumulate)
+			accumulate_statistics(v, &v->thread_stats[band]);
+		memset(&v->thread_stats[band], 0, sizeof(v->thread_stats[band]));
+	}
 
 	/* accumulate/reset statistics from the LFB */
 	if (accumulate)
@@ -2941,48 +3075,47 @@ void voodoo_init(int type) {
 	for (UINT32 rct=0; rct<MAX_RASTERIZERS; rct++)
 		v->rasterizer[rct] = raster_info();
 
-	v->thread_stats = new stats_block[1];
-	v->thread_stats[0].pixels_in = 0;
-	v->thread_stats[0].pixels_out = 0;
-	v->thread_stats[0].chroma_fail = 0;
-	v->thread_stats[0].zfunc_fail = 0;
-	v->thread_stats[0].afunc_fail = 0;
-	v->thread_stats[0].clip_fail = 0;
-	v->thread_stats[0].stipple_count = 0;
+	v->thread_stats = new stats_block[MAX_RASTER_BANDS];
+	memset(v->thread_stats, 0, sizeof(stats_block) * MAX_RASTER_BANDS);
 
 	v->alt_regmap = false;
 	v->regnames = voodoo_reg_name;
 
-	/* create a table of precomputed 1/n and log2(n) values */
-	/* n ranges from 1.0000 to 2.0000 */
-	for (UINT32 val = 0; val <= (1 << RECIPLOG_LOOKUP_BITS); val++)
-	{
-		UINT32 value = (1 << RECIPLOG_LOOKUP_BITS) + val;
-		voodoo_reciplog[val*2 + 0] = (1 << (RECIPLOG_LOOKUP_PREC + RECIPLOG_LOOKUP_BITS)) / value;
-		voodoo_reciplog[val*2 + 1] = (UINT32)(LOGB2((double)value / (double)(1 << RECIPLOG_LOOKUP_BITS)) * (double)(1 << RECIPLOG_LOOKUP_PREC));
-	}
-
 	for (UINT32 val = 0; val < RASTER_HASH_SIZE; val++)
 		v->raster_hash[val] = NULL;
 
-	/* create dithering tables */
-	for (UINT32 val = 0; val < 256*16*2; val++)
+	/* the lookup tables are the same for every card, build them once */
+	if (!voodoo_tables_built)
 	{
-		int g = (val >> 0) & 1;
-		int x = (val >> 1) & 3;
-		int color = (val >> 3) & 0xff;
-		int y = (val >> 11) & 3;
-
-		if (!g)
+		/* create a table of precomputed 1/n and log2(n) values */
+		/* n ranges from 1.0000 to 2.0000 */
+		for (UINT32 val = 0; val <= (1 << RECIPLOG_LOOKUP_BITS); val++)
 		{
-			dither4_lookup[val] = (UINT8)(DITHER_RB(color, dither_matrix_4x4[y * 4 + x]) >> 3);
-			dither2_lookup[val] = (UINT8)(DITHER_RB(color, dither_matrix_2x2[y * 4 + x]) >> 3);
+			UINT32 value = (1 << RECIPLOG_LOOKUP_BITS) + val;
+			voodoo_reciplog[val*2 + 0] = (1 << (RECIPLOG_LOOKUP_PREC + RECIPLOG_LOOKUP_BITS)) / value;
+			voodoo_reciplog[val*2 + 1] = (UINT32)(LOGB2((double)value / (double)(1 << RECIPLOG_LOOKUP_BITS)) * (double)(1 << RECIPLOG_LOOKUP_PREC));
 		}
-		else
+
+		/* create dithering tables */
+		for (UINT32 val = 0; val < 256*16*2; val++)
 		{
-			dither4_lookup[val] = (UINT8)(DITHER_G(color, dither_matrix_4x4[y * 4 + x]) >> 2);
-			dither2_lookup[val] = (UINT8)(DITHER_G(color, dither_matrix_2x2[y * 4 + x]) >> 2);
+			int g = (val >> 0) & 1;
+			int x = (val >> 1) & 3;
+			int color = (val >> 3) & 0xff;
+			int y = (val >> 11) & 3;
+
+			if (!g)
+			{
+				dither4_lookup[val] = (UINT8)(DITHER_RB(color, dither_matrix_4x4[y * 4 + x]) >> 3);
+				dither2_lookup[val] = (UINT8)(DITHER_RB(color, dither_matrix_2x2[y * 4 + x]) >> 3);
+			}
+			else
+			{
+				dither4_lookup[val] = (UINT8)(DITHER_G(color, dither_matrix_4x4[y * 4 + x]) >> 2);
+				dither2_lookup[val] = (UINT8)(DITHER_G(color, dither_matrix_2x2[y * 4 + x]) >> 2);
+			}
 		}
+		voodoo_tables_built = true;
 	}
 
 	v->tmu_config = 0x11;	// revision 1
@@ -3047,8 +3180,8 @@ void voodoo_init(int type) {
 	v->tmu[0].lookup = NULL;
 	v->tmu[1].lookup = NULL;
 
-	/* build shared TMU tables */
-	init_tmu_shared(&v->tmushare);
+	/* shared TMU tables, built when a texture is first used */
+	v->tmushare.built = false;
 
 	/* set up the TMUs */
 	init_tmu(v, &v->tmu[0], &v->reg[0x100], tmumem0 << 20);
@@ -3074,12 +3207,45 @@ void voodoo_init(int type) {
 	recompute_video_memory(v);
 }
 
+/* Report which mode combinations the software path drew with a generic rasterizer, most used
+   first. These are the candidates for new predef_rasterizers entries. */
+static void log_generic_rasterizers(voodoo_state *v)
+{
+	raster_info *generic[MAX_RASTERIZERS];
+	UINT32 generic_polys = 0, total_polys = 0;
+	int count = 0;
+
+	for (int i = 0; i < v->next_rasterizer; i++)
+	{
+		raster_info *info = &v->rasterizer[i];
+		total_polys += info->polys;
+		if (info->is_generic && info->polys != 0)
+		{
+			generic_polys += info->polys;
+			generic[count++] = info;
+		}
+	}
+	if (total_polys == 0)
+		return;
+
+	LOG(LOG_VOODOO,LOG_NORMAL)("Voodoo: %u of %u triangles used a generic rasterizer\n", generic_polys, total_polys);
+
+	std::sort(generic, generic + count, [](const raster_info *a, const raster_info *b) { return a->polys > b->polys; });
+	for (int i = 0; i < count && i < 16; i++)
+		LOG(LOG_VOODOO,LOG_NORMAL)("Voodoo: generic %08X %08X %08X %08X %08X %08X: %u triangles\n",
+				generic[i]->eff_color_path, generic[i]->eff_alpha_mode, generic[i]->eff_fog_mode, generic[i]->eff_fbz_mode,
+				generic[i]->eff_tex_mode_0, generic[i]->eff_tex_mode_1, generic[i]->polys);
+}
+
 void voodoo_shutdown() {
 	if (v->ogl)
 		voodoo_ogl_shutdown(v);
 
 	if (v!=NULL) {
+		if (!v->ogl)
+			log_generic_rasterizers(v);
 		free(v->fbi.ram);
+		v->fbi.ram = NULL;
 		if (v->tmu[0].ram != NULL) {
 			free(v->tmu[0].ram);
 			v->tmu[0].ram = NULL;
@@ -3175,6 +3341,7 @@ void fastfill(voodoo_state *v)
 			int count = MIN(ey - y, ARRAY_LENGTH(extents));
 
 			extra->state = v;
+			extra->stats = &v->thread_stats[0];
 			memcpy(extra->dither, dithermatrix, sizeof(extra->dither));
 
 			poly_render_triangle_custom(drawbuf, y, count, extents, extra);
@@ -3490,6 +3657,7 @@ void triangle_create_work_item(voodoo_state *v, UINT16 *drawbuf, int texcount)
 	/* fill in the extra data */
 	extra->state = v;
 	extra->info = info;
+	extra->stats = &v->thread_stats[0];
 
 	/* fill in triangle parameters */
 	extra->ax = v->fbi.ax;
@@ -3600,8 +3768,8 @@ static raster_info *add_rasterizer(voodoo_state *v, const raster_info *cinfo)
 	v->raster_hash[hash] = info;
 
 	if (LOG_RASTERIZERS)
-		LOG_MSG("Adding rasterizer @ %p : %08X %08X %08X %08X %08X %08X (hash=%d)\n",
-				(void*)(info->callback),
+		LOG_MSG("Adding %s rasterizer @ %p : %08X %08X %08X %08X %08X %08X (hash=%d)\n",
+				info->is_generic ? "generic" : "specialized", (void*)(info->callback),
 				info->eff_color_path, info->eff_alpha_mode, info->eff_fog_mode, info->eff_fbz_mode,
 				info->eff_tex_mode_0, info->eff_tex_mode_1, hash);
 
@@ -3653,9 +3821,24 @@ static raster_info *find_rasterizer(voodoo_state *v, int texcount)
 			return info;
 		}
 
-	/* generate a new one using the generic entry */
+	/* use a specialized rasterizer if there is one, else the generic entry */
 	curinfo.callback = (texcount == 0) ? raster_generic_0tmu : (texcount == 1) ? raster_generic_1tmu : raster_generic_2tmu;
 	curinfo.is_generic = true;
+	for (size_t i = 0; i < ARRAY_LENGTH(predef_rasterizers); i++)
+	{
+		const raster_entry *entry = &predef_rasterizers[i];
+		if (entry->eff_color_path == curinfo.eff_color_path &&
+			entry->eff_alpha_mode == curinfo.eff_alpha_mode &&
+			entry->eff_fog_mode == curinfo.eff_fog_mode &&
+			entry->eff_fbz_mode == curinfo.eff_fbz_mode &&
+			entry->eff_tex_mode_0 == curinfo.eff_tex_mode_0 &&
+			entry->eff_tex_mode_1 == curinfo.eff_tex_mode_1)
+		{
+			curinfo.callback = entry->callback;
+			curinfo.is_generic = false;
+			break;
+		}
+	}
 	curinfo.display = 0;
 	curinfo.polys = 0;
 	curinfo.hits = 0;
@@ -3679,7 +3862,7 @@ static void raster_fastfill(void *destbase, INT32 y, const poly_extent *extent,
 {
 	const poly_extra_data *extra = (const poly_extra_data *)extradata;
 	voodoo_state *v = extra->state;
-	stats_block *stats = &v->thread_stats[0];
+	stats_block *stats = extra->stats;
 	INT32 startx = extent->startx;
 	INT32 stopx = extent->stopx;
 	int scry, x;
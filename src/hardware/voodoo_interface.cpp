@@ -30,6 +30,7 @@
 
 #include "voodoo_interface.h"
 #include "voodoo_emu.h"
+#include "hostmem.h"
 
 
 static voodoo_draw vdraw;
@@ -320,3 +321,12 @@ void Voodoo_PCI_Enable(bool enable) {
 PageHandler* Voodoo_GetPageHandler() {
 	return voodoo_pagehandler;
 }
+
+void Voodoo_GetHostMemory(HostMemSize &sz) {
+	if (v == NULL) return;
+	sz.add_heap(sizeof(voodoo_state));
+	if (v->fbi.ram != NULL) sz.add(v->fbi.ram, v->fbi.mask+1);
+	for (int i=0;i<MAX_TMU;i++) {
+		if (v->tmu[i].ram != NULL) sz.add(v->tmu[i].ram, v->tmu[i].mask+1);
+	}
+}
@@ -428,6 +428,7 @@ void ogl_cache_texture(const poly_extra_data *extra, ogl_texture_data *td) {
 						valid_texid = false;
 //						LOG_MSG("texture removed... size %d",t->second.ids->size());
 						if (t->second.ids->size() > 8) {
+							VOGL_ClearBeginMode();
 							for (u=t->second.ids->begin(); u!=t->second.ids->end(); ++u) {
 								glDeleteTextures(1,&u->second);
 							}
@@ -440,6 +441,8 @@ void ogl_cache_texture(const poly_extra_data *extra, ogl_texture_data *td) {
 				valid_texid = false;
 			}
 			if (!valid_texid) {
+				VOGL_ClearBeginMode();
+
 				smax = (INT32)(v->tmu[j].wmask >> ilod) + 1;
 				tmax = (INT32)(v->tmu[j].hmask >> ilod) + 1;
 
@@ -1122,13 +1125,102 @@ void ogl_shaders(const poly_extra_data *extra) {
 }
 
 
+/* Triangles are queued while the shader, textures, uniforms and fragment state stay the same,
+ * and drawn together with one glDrawArrays when something changes. VOGL_ClearBeginMode, which
+ * runs before every state change, readback and swap, flushes the queue. */
+#define OGL_BATCH_MAX_VERTICES		(3*1024)
+
+struct ogl_batch_state {
+	const raster_info *info;
+	GLuint texID[2];
+	bool tex_enable[2];
+	UINT32 fbzmode, alphamode;
+	UINT32 texmode[2];
+	INT32 lodmin[2], lodmax[2];
+	UINT32 r_color0, r_color1, r_chromaKey, r_chromaRange, r_zaColor, r_fogColor;
+};
+
+static ogl_batch_state ogl_batch;
+static ogl_vertex_data ogl_batch_vertices[OGL_BATCH_MAX_VERTICES];
+static unsigned int ogl_batch_count = 0;
+
+static void ogl_flush_triangles(void) {
+	if (ogl_batch_count == 0) return;
+
+	const raster_info *info = ogl_batch.info;
+	const INT32 *locations = info->shader_ready ? info->shader_ulocations : NULL;
+	const ogl_vertex_data *vd = ogl_batch_vertices;
+	const unsigned int count = ogl_batch_count;
+
+	/* clear first, anything below that ends up in VOGL_ClearBeginMode must not draw again */
+	ogl_batch_count = 0;
+
+	if (locations == NULL || glVertexAttribPointerARB != NULL) {
+		const GLsizei stride = sizeof(ogl_vertex_data);
+
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(3, GL_FLOAT, stride, &vd->x);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glColorPointer(4, GL_FLOAT, stride, &vd->r);
+		for (unsigned int t=0;t<2;t++) {
+			if (!ogl_batch.tex_enable[t]) continue;
+			glClientActiveTexture(GL_TEXTURE0_ARB+t);
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			glTexCoordPointer(4, GL_FLOAT, stride, &vd->m[t].sw);
+			if (locations != NULL && locations[10u+t] >= 0) {
+				glEnableVertexAttribArrayARB((GLuint)locations[10u+t]);
+				glVertexAttribPointerARB((GLuint)locations[10u+t], 1, GL_FLOAT, GL_FALSE, stride, &vd->m[t].lodblend);
+			}
+		}
+		if (locations != NULL && locations[9] >= 0) {
+			glEnableVertexAttribArrayARB((GLuint)locations[9]);
+			glVertexAttribPointerARB((GLuint)locations[9], 1, GL_FLOAT, GL_FALSE, stride, &vd->fogblend);
+		}
+
+		glDrawArrays(GL_TRIANGLES, 0, (GLsizei)count);
+
+		if (locations != NULL && locations[9] >= 0)
+			glDisableVertexAttribArrayARB((GLuint)locations[9]);
+		for (unsigned int t=0;t<2;t++) {
+			if (!ogl_batch.tex_enable[t]) continue;
+			if (locations != NULL && locations[10u+t] >= 0)
+				glDisableVertexAttribArrayARB((GLuint)locations[10u+t]);
+			glClientActiveTexture(GL_TEXTURE0_ARB+t);
+			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		}
+		glClientActiveTexture(GL_TEXTURE0_ARB);
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+	} else {
+		glBegin(GL_TRIANGLES);
+		for (unsigned int i=0;i<count;i++) {
+			glColor4fv(&vd[i].r);
+
+			for (unsigned int t=0;t<2;t++)
+				if (ogl_batch.tex_enable[t]) {
+					glMultiTexCoord4fv(GL_TEXTURE0_ARB+t,&vd[i].m[t].sw);
+					if (locations[10u+t] >= 0)
+						glVertexAttrib1fARB((GLuint)locations[10u+t],vd[i].m[t].lodblend);
+				}
+
+			if (locations[9] >= 0)
+				glVertexAttrib1fARB((GLuint)locations[9],vd[i].fogblend);
+
+			glVertex3fv(&vd[i].x);
+		}
+		glEnd();
+	}
+
+	if (!info->shader_ready) {
+		glDisable (GL_TEXTURE_2D);
+	}
+}
+
 void voodoo_ogl_draw_triangle(poly_extra_data *extra) {
 	v=extra->state;
 	ogl_texture_data td[2];
 	ogl_vertex_data vd[3];
 
-	VOGL_ClearBeginMode();
-
 	td[0].enable = false;
 	td[1].enable = false;
 
@@ -1146,7 +1238,49 @@ void voodoo_ogl_draw_triangle(poly_extra_data *extra) {
 		vd[i].y = (vd[i].y * new_height) / v->fbi.height;
 	}
 
-	if (FBZMODE_DEPTH_SOURCE_COMPARE(FBZMODE) && VOGL_CheckFeature(VOGL_HAS_STENCIL_BUFFER)) {
+	/* flushes the queue itself if it has to upload a texture */
+	ogl_cache_texture(extra,td);
+
+	/* depth source compare draws the stencil mask first, so it is never queued */
+	bool stencil = FBZMODE_DEPTH_SOURCE_COMPARE(FBZMODE) && VOGL_CheckFeature(VOGL_HAS_STENCIL_BUFFER);
+
+	ogl_batch_state state;
+	memset(&state, 0, sizeof(state));
+	state.info = extra->info;
+	state.fbzmode = v->reg[fbzMode].u;
+	state.alphamode = v->reg[alphaMode].u;
+	state.r_color0 = v->reg[color0].u;
+	state.r_color1 = v->reg[color1].u;
+	state.r_chromaKey = v->reg[chromaKey].u;
+	state.r_chromaRange = v->reg[chromaRange].u;
+	state.r_zaColor = v->reg[zaColor].u;
+	state.r_fogColor = v->reg[fogColor].u;
+	for (unsigned int t=0;t<2;t++) {
+		if (!td[t].enable) continue;
+		state.tex_enable[t] = true;
+		state.texID[t] = td[t].texID;
+		state.texmode[t] = v->tmu[t].reg[textureMode].u;
+		state.lodmin[t] = v->tmu[t].lodmin;
+		state.lodmax[t] = v->tmu[t].lodmax;
+	}
+
+	if (FBZMODE_DRAW_BUFFER(v->reg[fbzMode].u)==0) {
+		v->fbi.vblank_flush_pending=true;
+		cached_line_front_y=-1;
+	} else {
+		cached_line_back_y=-1;
+	}
+
+	if (!stencil && ogl_batch_count > 0 && ogl_batch_count + 3 <= OGL_BATCH_MAX_VERTICES &&
+		memcmp(&state, &ogl_batch, sizeof(state)) == 0) {
+		memcpy(&ogl_batch_vertices[ogl_batch_count], vd, sizeof(vd));
+		ogl_batch_count += 3;
+		return;
+	}
+
+	VOGL_ClearBeginMode();
+
+	if (stencil) {
 		if (m_hProgramObject != 0) {
 			glUseProgramObjectARB(0);
 			m_hProgramObject = 0;
@@ -1185,7 +1319,6 @@ void voodoo_ogl_draw_triangle(poly_extra_data *extra) {
 		glEnd();
 	}
 
-	ogl_cache_texture(extra,td);
 	ogl_shaders(extra);
 
 	if (extra->texcount > 0) {
@@ -1214,7 +1347,7 @@ void voodoo_ogl_draw_triangle(poly_extra_data *extra) {
 		}
 	}
 
-	if (FBZMODE_DEPTH_SOURCE_COMPARE(FBZMODE) && VOGL_CheckFeature(VOGL_HAS_STENCIL_BUFFER)) {
+	if (stencil) {
 		glStencilFunc(GL_EQUAL, 1, 1);
 		glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 		if (FBZMODE_ENABLE_DEPTHBUF(FBZMODE)) {
@@ -1256,43 +1389,17 @@ void voodoo_ogl_draw_triangle(poly_extra_data *extra) {
 		VOGL_SetAlphaMode(0, 0,0,0,0);
 	}
 
-	if (FBZMODE_DRAW_BUFFER(v->reg[fbzMode].u)==0) {
-		VOGL_SetDrawMode(true);
-		v->fbi.vblank_flush_pending=true;
-		cached_line_front_y=-1;
-	} else {
-		VOGL_SetDrawMode(false);
-		cached_line_back_y=-1;
-	}
-
-
-	glBegin(GL_TRIANGLES);
+	VOGL_SetDrawMode(FBZMODE_DRAW_BUFFER(v->reg[fbzMode].u)==0);
 
-	for (unsigned int i=0;i<3;i++) {
-		glColor4fv(&vd[i].r);
+	/* the state is set up, start a new queue with this triangle */
+	memcpy(&ogl_batch, &state, sizeof(state));
+	memcpy(ogl_batch_vertices, vd, sizeof(vd));
+	ogl_batch_count = 3;
 
-		for (unsigned int t=0;t<2;t++)
-			if (td[t].enable) {
-				glMultiTexCoord4fv(GL_TEXTURE0_ARB+t,&vd[i].m[t].sw);
-				if (extra->info->shader_ulocations[10u+t] >= 0)
-					glVertexAttrib1fARB((GLuint)extra->info->shader_ulocations[10u+t],vd[i].m[t].lodblend);
-			}
-
-		if (extra->info->shader_ulocations[9] >= 0)
-			glVertexAttrib1fARB((GLuint)extra->info->shader_ulocations[9],vd[i].fogblend);
-
-		glVertex3fv(&vd[i].x);
-	}
-
-	glEnd();
-
-	if (FBZMODE_DEPTH_SOURCE_COMPARE(FBZMODE) && VOGL_CheckFeature(VOGL_HAS_STENCIL_BUFFER)) {
+	if (stencil) {
+		ogl_flush_triangles();
 		glDisable(GL_STENCIL_TEST);
 	}
-
-	if (!extra->info->shader_ready) {
-		glDisable (GL_TEXTURE_2D);
-	}
 }
 
 
@@ -1331,6 +1438,8 @@ void voodoo_ogl_texture_clear(UINT32 texbase, int TMU) {
 }
 
 void voodoo_ogl_draw_pixel(int x, int y, bool has_rgb, bool has_alpha, int r, int g, int b, int a) {
+	ogl_flush_triangles();
+
 	if (m_hProgramObject != 0) {
 		glUseProgramObjectARB(0);
 		m_hProgramObject = 0;
@@ -1370,6 +1479,7 @@ void voodoo_ogl_draw_pixel(int x, int y, bool has_rgb, bool has_alpha, int r, in
 
 void voodoo_ogl_draw_z(int x, int y, int z) {
 //	VOGL_ClearBeginMode();
+	ogl_flush_triangles();
 
 	if (m_hProgramObject != 0) {
 		glUseProgramObjectARB(0);
@@ -1411,6 +1521,7 @@ void voodoo_ogl_draw_z(int x, int y, int z) {
 
 void voodoo_ogl_draw_pixel_pipeline(int x, int y, int r, int g, int b) {
 //	VOGL_ClearBeginMode();
+	ogl_flush_triangles();
 
 	// TODO redo everything //
 	if (m_hProgramObject != 0) {
@@ -1885,6 +1996,7 @@ bool voodoo_ogl_init(voodoo_state *v) {
 		// reset video mode etc.
 		return false;
 	}
+	VOGL_SetFlushCallback(ogl_flush_triangles);
 
     transparency = 0;
     SetWindowTransparency(static_cast<Section_prop *>(control->GetSection("sdl"))->Get_int("transparency"));
@@ -38,6 +38,7 @@
 PFNGLMULTITEXCOORD4FVARBPROC __glMultiTexCoord4fvARB = NULL;
 PFNGLMULTITEXCOORD4FARBPROC __glMultiTexCoord4fARB = NULL;
 PFNGLACTIVETEXTUREARBPROC __glActiveTextureARB = NULL;
+PFNGLCLIENTACTIVETEXTUREARBPROC __glClientActiveTextureARB = NULL;
 #endif
 
 PFNGLCREATESHADEROBJECTARBPROC glCreateShaderObjectARB = NULL;
@@ -61,6 +62,9 @@ PFNGLBLENDFUNCSEPARATEEXTPROC glBlendFuncSeparateEXT = NULL;
 PFNGLGENERATEMIPMAPEXTPROC glGenerateMipmapEXT = NULL;
 PFNGLGETATTRIBLOCATIONARBPROC glGetAttribLocationARB = NULL;
 PFNGLVERTEXATTRIB1FARBPROC glVertexAttrib1fARB = NULL;
+PFNGLVERTEXATTRIBPOINTERARBPROC glVertexAttribPointerARB = NULL;
+PFNGLENABLEVERTEXATTRIBARRAYARBPROC glEnableVertexAttribArrayARB = NULL;
+PFNGLDISABLEVERTEXATTRIBARRAYARBPROC glDisableVertexAttribArrayARB = NULL;
 
 
 static int32_t opengl_version = -1;
@@ -71,6 +75,7 @@ static bool has_alpha = false;
 
 
 static INT32 current_begin_mode = -1;
+static void (*flush_callback)(void) = NULL;
 
 static int32_t current_depth_mode = -1;
 static int32_t current_depth_func = -1;
@@ -166,6 +171,9 @@ void VOGL_ClearShaderFunctions(void) {
 	glDeleteObjectARB  = NULL;
 	glGetObjectParameterivARB = NULL;
 	glGetInfoLogARB = NULL;
+	glVertexAttribPointerARB = NULL;
+	glEnableVertexAttribArrayARB = NULL;
+	glDisableVertexAttribArrayARB = NULL;
 }
 
 bool VOGL_Initialize(void) {
@@ -191,6 +199,12 @@ bool VOGL_Initialize(void) {
 		LOG_MSG("opengl: glMultiTexCoord4fvARB extension not supported");
 		return false;
 	}
+
+	__glClientActiveTextureARB = (PFNGLCLIENTACTIVETEXTUREARBPROC)((uintptr_t)SDL_GL_GetProcAddress("glClientActiveTextureARB"));
+	if (!__glClientActiveTextureARB) {
+		LOG_MSG("opengl: glClientActiveTextureARB extension not supported");
+		return false;
+	}
 #endif
 
 	glBlendFuncSeparateEXT = (PFNGLBLENDFUNCSEPARATEEXTPROC)((uintptr_t)SDL_GL_GetProcAddress("glBlendFuncSeparateEXT"));
@@ -268,6 +282,11 @@ bool VOGL_Initialize(void) {
 				glVertexAttrib1fARB = (PFNGLVERTEXATTRIB1FARBPROC)((uintptr_t)SDL_GL_GetProcAddress("glVertexAttrib1fARB"));
 				if (!glVertexAttrib1fARB) LOG_MSG("opengl: glVertexAttrib1fARB extension not supported");
 
+				/* optional, triangle batches are drawn with glBegin/glEnd without them */
+				glVertexAttribPointerARB = (PFNGLVERTEXATTRIBPOINTERARBPROC)((uintptr_t)SDL_GL_GetProcAddress("glVertexAttribPointerARB"));
+				glEnableVertexAttribArrayARB = (PFNGLENABLEVERTEXATTRIBARRAYARBPROC)((uintptr_t)SDL_GL_GetProcAddress("glEnableVertexAttribArrayARB"));
+				glDisableVertexAttribArrayARB = (PFNGLDISABLEVERTEXATTRIBARRAYARBPROC)((uintptr_t)SDL_GL_GetProcAddress("glDisableVertexAttribArrayARB"));
+
 				if (glShaderSourceARB && glCompileShaderARB && glCreateProgramObjectARB &&
 					glAttachObjectARB && glLinkProgramARB && glUseProgramObjectARB &&
 					glUniform1iARB && glUniform1fARB && glUniform2fARB && glUniform3fARB &&
@@ -353,6 +372,12 @@ void VOGL_ClearBeginMode(void) {
 		glEnd();
 		current_begin_mode = -1;
 	}
+	if (flush_callback != NULL)
+		flush_callback();
+}
+
+void VOGL_SetFlushCallback(void (*callback)(void)) {
+	flush_callback = callback;
 }
 
 
@@ -432,6 +457,7 @@ void VOGL_SetDepthMaskMode(bool masked) {
 
 void VOGL_SetColorMaskMode(bool cmasked, bool amasked) {
 	if ((color_masked!=cmasked) || (alpha_masked!=amasked)) {
+		VOGL_ClearBeginMode();
 		color_masked=cmasked;
 		alpha_masked=amasked;
 		GLboolean cm = (color_masked ? GL_TRUE : GL_FALSE);
@@ -29,8 +29,10 @@
 extern PFNGLACTIVETEXTUREARBPROC __glActiveTextureARB;
 extern PFNGLMULTITEXCOORD4FARBPROC __glMultiTexCoord4fARB;
 extern PFNGLMULTITEXCOORD4FVARBPROC __glMultiTexCoord4fvARB;
+extern PFNGLCLIENTACTIVETEXTUREARBPROC __glClientActiveTextureARB;
 # define glMultiTexCoord4fv __glMultiTexCoord4fvARB
 # define glActiveTexture __glActiveTextureARB
+# define glClientActiveTexture __glClientActiveTextureARB
 #endif
 
 extern PFNGLCREATESHADEROBJECTARBPROC glCreateShaderObjectARB;
@@ -54,6 +56,9 @@ extern PFNGLBLENDFUNCSEPARATEEXTPROC glBlendFuncSeparateExt;
 extern PFNGLGENERATEMIPMAPEXTPROC glGenerateMipmapExt;
 extern PFNGLGETATTRIBLOCATIONARBPROC glGetAttribLocationARB;
 extern PFNGLVERTEXATTRIB1FARBPROC glVertexAttrib1fARB;
+extern PFNGLVERTEXATTRIBPOINTERARBPROC glVertexAttribPointerARB;
+extern PFNGLENABLEVERTEXATTRIBARRAYARBPROC glEnableVertexAttribArrayARB;
+extern PFNGLDISABLEVERTEXATTRIBARRAYARBPROC glDisableVertexAttribArrayARB;
 
 
 #define VOGL_ATLEAST_V20			0x00000001
@@ -112,6 +117,8 @@ void VOGL_FlagFeature(uint32_t feat);
 
 void VOGL_BeginMode(INT32 new_mode);
 void VOGL_ClearBeginMode(void);
+/* called by VOGL_ClearBeginMode, before every state change, to draw queued primitives */
+void VOGL_SetFlushCallback(void (*callback)(void));
 
 void VOGL_SetDepthMode(int32_t mode, int32_t func);
 void VOGL_SetAlphaMode(int32_t enabled_mode,GLuint src_rgb_fac,GLuint dst_rgb_fac,
@@ -143,6 +143,7 @@ extern bool is_ttfswitched_on;
 
 /* vga_pc98_cg.cpp */
 extern bool pc98_cg_kanji_dot_access_mode;
+extern uint32_t pc98_font_serial;
 
 bool pc98_timestamp5c = true; // port 5ch and 5eh "time stamp/hardware wait"
 
@@ -1265,7 +1266,7 @@ void dosbox_integration_trigger_write() {
 			{
 				uint32_t nr = dosbox_int_register & (~0xFFFul);
 				vga.dosboxig.bank_offset = nr;
-				VGA_SetupHandlers();
+				VGA_SetupBankWindow();
 			}
 			break;
 
@@ -3011,7 +3012,11 @@ static Bitu INT1A_Handler(void) {
     switch (reg_ah) {
     case 0x00:  /* Get System time */
         {
+            static uint32_t last_ticks = 0;
             uint32_t ticks=mem_readd(BIOS_TIMER);
+            if (ticks == last_ticks) CPU_IdlePoll(); /* waiting for the next tick */
+            else CPU_IdleProgress();
+            last_ticks = ticks;
             reg_al=mem_readb(BIOS_24_HOURS_FLAG);
             mem_writeb(BIOS_24_HOURS_FLAG,0); // reset the "flag"
             reg_cx=(uint16_t)(ticks >> 16u);
@@ -4329,6 +4334,8 @@ static Bitu INT18_PC98_Handler(void) {
                         vga.draw.font[o+0u] = mem_readb(i+(r*2u)+0u);
                         vga.draw.font[o+1u] = mem_readb(i+(r*2u)+1u);
                     }
+
+                    pc98_font_serial++;
                 }
                 else {
                     LOG_MSG("PC-98 INT 18h AH=1Ah font RAM load ignored, code 0x%04x out of range",reg_dx);
@@ -5659,7 +5666,7 @@ void PC98_EXTMEMCPY(void) {
     LOG_MSG("PC-98 memcpy: src=0x%x dst=0x%x data=0x%x count=0x%x",
         (unsigned int)source,(unsigned int)dest,(unsigned int)data,(unsigned int)bytes);
 
-    MEM_BlockCopy(dest,source,bytes);
+    MEM_BlockMove(dest,source,bytes);
     MEM_A20_Enable(enabled);
     Segs.limit[cs] = 0xFFFF;
     Segs.limit[ds] = 0xFFFF;
@@ -7010,7 +7017,7 @@ static Bitu INT15_Handler(void) {
             PhysPt data     = SegPhys(es)+reg_si;
             PhysPt source   = (mem_readd(data+0x12u) & 0x00FFFFFFu) + ((unsigned int)mem_readb(data+0x17u)<<24u);
             PhysPt dest     = (mem_readd(data+0x1Au) & 0x00FFFFFFu) + ((unsigned int)mem_readb(data+0x1Fu)<<24u);
-            MEM_BlockCopy(dest,source,bytes);
+            MEM_BlockMove(dest,source,bytes);
             reg_ax = 0x00;
             MEM_A20_Enable(enabled);
             Segs.limit[cs] = 0xFFFF;
@@ -9717,7 +9724,7 @@ private:
 		int val = section->Get_int("reboot delay");
 
 		if (val < 0)
-			val = IS_PC98_ARCH ? 1000 : 500;
+			val = section->Get_bool("quickboot") ? 0 : (IS_PC98_ARCH ? 1000 : 500);
 
 		reset_post_delay = (unsigned int)val;
 
@@ -11042,12 +11049,13 @@ private:
         const Section_prop* section = static_cast<Section_prop *>(control->GetSection("dosbox"));
         const char *logo_text = section->Get_string("logo text");
         const char *logo = section->Get_string("logo");
-        bool fastbioslogo=section->Get_bool("fastbioslogo")||control->opt_fastbioslogo||control->opt_fastlaunch;
+        const bool quickboot=section->Get_bool("quickboot");
+        bool fastbioslogo=section->Get_bool("fastbioslogo")||control->opt_fastbioslogo||control->opt_fastlaunch||quickboot;
         if (fastbioslogo && machine != MCH_PC98) {
 #if defined(USE_TTF)
             if (TTF_using()) {
                 uint32_t lasttick=GetTicks();
-                while ((GetTicks()-lasttick)<500) {
+                while (!quickboot && (GetTicks()-lasttick)<500) {
                     reg_eax = 0x0100;
                     CALLBACK_RunRealInt(0x16);
                 }
@@ -11055,7 +11063,7 @@ private:
                 CALLBACK_RunRealInt(0x10);
             }
 #endif
-            if (control->opt_fastlaunch) return CBRET_NONE;
+            if (control->opt_fastlaunch || quickboot) return CBRET_NONE;
         }
         extern const char* RunningProgram;
         extern void GFX_SetTitle(int32_t cycles, int frameskip, Bits timing, bool paused);
@@ -0,0 +1,111 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#include "dosbox.h"
+#include "logging.h"
+#include "bios_disk.h"
+#include "chd_hunk_cache.h"
+#include "../libs/libchdr/chd.h"
+
+imageDiskCHD* imageDiskCHD::Open(const char* fileName) {
+    chd_file* chd = NULL;
+    if (chd_open(fileName, CHD_OPEN_READ, NULL, &chd) != CHDERR_NONE) return NULL;
+
+    const chd_header* header = chd_get_header(chd);
+    char metadata[256];
+    uint32_t cyls = 0, heads = 0, secs = 0, bps = 0;
+    int c, h, s, b;
+
+    /* hard disk CHDs carry their geometry in GDDD metadata, CD-ROM CHDs do not */
+    if (header == NULL || header->hunkbytes == 0 ||
+        chd_get_metadata(chd, HARD_DISK_METADATA_TAG, 0, metadata, sizeof(metadata), NULL, NULL, NULL) != CHDERR_NONE) {
+        chd_close(chd);
+        return NULL;
+    }
+    metadata[sizeof(metadata) - 1] = 0;
+    if (sscanf(metadata, HARD_DISK_METADATA_FORMAT, &c, &h, &s, &b) == 4 && c > 0 && h > 0 && s > 0 && b > 0) {
+        cyls = (uint32_t)c; heads = (uint32_t)h; secs = (uint32_t)s; bps = (uint32_t)b;
+    }
+    if (bps == 0 || (header->hunkbytes % bps) != 0 || (uint64_t)cyls * heads * secs * bps > header->logicalbytes) {
+        LOG_MSG("CHD %s: unsupported hard disk geometry '%s'", fileName, metadata);
+        chd_close(chd);
+        return NULL;
+    }
+
+    imageDiskCHD* disk = new imageDiskCHD(chd, fileName);
+    disk->sector_size = bps;
+    disk->cylinders = cyls;
+    disk->heads = heads;
+    disk->sectors = secs;
+    disk->image_length = (uint64_t)cyls * heads * secs * bps;
+    disk->diskSizeK = disk->image_length / 1024;
+    return disk;
+}
+
+imageDiskCHD::imageDiskCHD(chd_file* chd, const char* fileName) : imageDisk(ID_CHD), chd(chd) {
+    if (fileName) diskname = fileName;
+    hardDrive = true;
+    active = true;
+    hunks = new CHDHunkCache(chd, fileName);
+}
+
+imageDiskCHD::~imageDiskCHD() {
+    delete hunks; /* waits for prefetch tasks still using the file */
+    chd_close(chd);
+}
+
+uint8_t imageDiskCHD::Read_AbsoluteSector(uint32_t sectnum, void * data) {
+    return Read_AbsoluteSectors(sectnum, 1, data);
+}
+
+uint8_t imageDiskCHD::Read_AbsoluteSectors(uint32_t sectnum, uint32_t count, void * data) {
+    uint8_t* dst = (uint8_t*)data;
+    const uint32_t hunkbytes = hunks->HunkBytes();
+    uint64_t offset = (uint64_t)sectnum * sector_size;
+    uint64_t bytes = (uint64_t)count * sector_size;
+
+    if (offset + bytes > image_length) return 0x05;
+    while (bytes > 0) {
+        const uint8_t* hunk = hunks->GetHunk((uint32_t)(offset / hunkbytes));
+        if (hunk == NULL) return 0x05;
+        const uint32_t skip = (uint32_t)(offset % hunkbytes);
+        const uint32_t run = (uint32_t)std::min<uint64_t>(bytes, hunkbytes - skip);
+        memcpy(dst, hunk + skip, run);
+        dst += run;
+        offset += run;
+        bytes -= run;
+    }
+    return 0x00;
+}
+
+uint8_t imageDiskCHD::Write_AbsoluteSector(uint32_t sectnum, const void * data) {
+    (void)sectnum;
+    (void)data;
+    return 0x05; /* read only */
+}
+
+uint8_t imageDiskCHD::Write_AbsoluteSectors(uint32_t sectnum, uint32_t count, const void * data) {
+    (void)sectnum;
+    (void)count;
+    (void)data;
+    return 0x05; /* read only */
+}
@@ -18,6 +18,7 @@
 
 #include <assert.h>
 #include <cmath>
+#include <typeinfo>
 
 #include "dosbox.h"
 #include "callback.h"
@@ -31,6 +32,16 @@
 #include "mapper.h"
 #include "ide.h"
 #include "cpu.h"
+#include "hosttime.h"
+#include "hostmem.h"
+#if C_HAVE_MMAP
+# include <fcntl.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+#elif defined(WIN32) && !defined(HX_DOS)
+# include <windows.h>
+# include <io.h>
+#endif
 
 #if defined(_MSC_VER)
 # pragma warning(disable:4244) /* const fmath::local::uint64_t to double possible loss of data */
@@ -48,6 +59,14 @@ extern const uint8_t freedos_mbr[];
 extern int bootdrive, tryconvertcp;
 extern bool int13_disk_change_detect_enable, skipintprog, rsize;
 extern bool int13_extensions_enable, bootguest, bootvm, use_quick_reboot;
+
+int disk_image_cache_size = 2048; /* KB, 0 to disable */
+bool disk_image_mmap = true;
+
+/* 32-bit builds do not have the address space to map big images, use the file I/O path */
+#define IMAGE_MMAP_MAX_32BIT    (512ull << 20ull)
+/* how far ahead to ask the OS to page in when the guest scans the mapped image in order */
+#define IMAGE_MMAP_READAHEAD    (256u << 10u)
 bool isDBCSCP(), isKanji1_gbk(uint8_t chr), shiftjis_lead_byte(int c), CheckDBCSCP(int32_t codepage);
 extern bool CodePageGuestToHostUTF16(uint16_t *d/*CROSS_LEN*/,const char *s/*CROSS_LEN*/);
 
@@ -1141,6 +1160,7 @@ void CMOS_SetRegister(Bitu regNr, uint8_t val); //For setting equipment word
 bool imageDiskChange[MAX_DISK_IMAGES]={false};
 imageDisk *imageDiskList[MAX_DISK_IMAGES]={NULL};
 imageDisk *diskSwap[MAX_SWAPPABLE_DISKS]={NULL};
+uint64_t disk_io_bytes_read = 0, disk_io_bytes_written = 0;
 int32_t swapPosition;
 
 imageDisk *GetINT13FloppyDrive(unsigned char drv) {
@@ -1156,7 +1176,20 @@ imageDisk *GetINT13HardDrive(unsigned char drv) {
     return imageDiskList[drv-0x80];
 }
 
+/* write back sectors held in the disk image caches, e.g. on INT 21h AH=0Dh (disk reset) */
+void FlushBIOSDiskCaches(void) {
+    IDE_AsyncIO_Drain();
+    for (int i=0;i < MAX_DISK_IMAGES;i++) {
+        if (imageDiskList[i] != NULL) imageDiskList[i]->FlushCache();
+    }
+    for (int i=0;i < DOS_DRIVES;i++) {
+        fatDrive *fdp = dynamic_cast<fatDrive*>(Drives[i]);
+        if (fdp != NULL && fdp->loadedDisk != NULL) fdp->loadedDisk->FlushCache();
+    }
+}
+
 void FreeBIOSDiskList() {
+    FlushBIOSDiskCaches();
     for (int i=0;i < MAX_DISK_IMAGES;i++) {
         if (imageDiskList[i] != NULL) {
             if (i >= 2) IDE_Hard_Disk_Detach(i);
@@ -1353,6 +1386,20 @@ uint8_t imageDisk::Read_AbsoluteSector(uint32_t sectnum, void * data) {
     }
     bytenum += image_base;
 
+    if (MapImage() && (bytenum + sector_size) <= mapped_size) {
+        MapAdviseSequential(sectnum, bytenum);
+        memcpy(data, mapped + bytenum, sector_size);
+        return 0x00;
+    }
+
+    if (cacheEnabled()) {
+        const cacheBlock *blk = cacheLookup(bytenum);
+        if (blk != NULL && (bytenum + sector_size) <= (blk->offset + blk->length)) {
+            memcpy(data, &blk->data[bytenum - blk->offset], sector_size);
+            return 0x00;
+        }
+    }
+
     //LOG_MSG("Reading sectors %ld at bytenum %I64d", sectnum, bytenum);
 
     fseeko64(diskimg,(fseek_ofs_t)bytenum,SEEK_SET);
@@ -1399,6 +1446,21 @@ uint8_t imageDisk::Write_AbsoluteSector(uint32_t sectnum, const void *data) {
     }
     bytenum += image_base;
 
+    if (MapImage() && mapped_writable && (bytenum + sector_size) <= mapped_size) {
+        memcpy(mapped + bytenum, data, sector_size);
+        mapped_dirty = true;
+        return 0x00;
+    }
+
+    if (cacheEnabled() && cacheWritable()) {
+        cacheBlock *blk = cacheLookup(bytenum);
+        if (blk != NULL && (bytenum + sector_size) <= (blk->offset + blk->length)) {
+            memcpy(&blk->data[bytenum - blk->offset], data, sector_size);
+            blk->dirty = true;
+            return 0x00;
+        }
+    }
+
     //LOG_MSG("Writing sectors to %ld at bytenum %d", sectnum, bytenum);
 
     fseeko64(diskimg,(fseek_ofs_t)bytenum,SEEK_SET);
@@ -1411,6 +1473,167 @@ uint8_t imageDisk::Write_AbsoluteSector(uint32_t sectnum, const void *data) {
 
 }
 
+/* A plain raw image can move a whole run of sectors with one copy from the mapping or one
+ * fread()/fwrite(). Anything else (subclasses, converted drives, requests running past the
+ * end of the image) goes a sector at a time so errors are reported exactly as before. */
+uint8_t imageDisk::Read_AbsoluteSectors(uint32_t sectnum, uint32_t count, void * data) {
+    uint8_t *dst = (uint8_t*)data;
+    const uint64_t bytes = (uint64_t)count * sector_size;
+    uint64_t bytenum = (uint64_t)sectnum * sector_size;
+
+    if (typeid(*this) == typeid(imageDisk) && ffdd == NULL && count > 1 && (bytenum + bytes) <= image_length) {
+        bytenum += image_base;
+
+        if (MapImage() && (bytenum + bytes) <= mapped_size) {
+            memcpy(dst, mapped + bytenum, (size_t)bytes);
+            return 0x00;
+        }
+
+        if (!cacheEnabled()) {
+            if (fseeko64(diskimg,(fseek_ofs_t)bytenum,SEEK_SET) == 0 && fread(dst, 1, (size_t)bytes, diskimg) == bytes)
+                return 0x00;
+
+            LOG_MSG("fread() failed in Read_AbsoluteSectors for sectors %lu-%lu\n",
+                (unsigned long)sectnum,(unsigned long)(sectnum+count-1u));
+            return 0x05;
+        }
+    }
+
+    for (uint32_t i=0;i < count;i++) {
+        const uint8_t r = Read_AbsoluteSector(sectnum+i, dst + ((size_t)i * sector_size));
+        if (r != 0x00) return r;
+    }
+
+    return 0x00;
+}
+
+uint8_t imageDisk::Write_AbsoluteSectors(uint32_t sectnum, uint32_t count, const void * data) {
+    const uint8_t *src = (const uint8_t*)data;
+    const uint64_t bytes = (uint64_t)count * sector_size;
+    uint64_t bytenum = (uint64_t)sectnum * sector_size;
+
+    if (typeid(*this) == typeid(imageDisk) && ffdd == NULL && count > 1 && (bytenum + bytes) <= image_length) {
+        bytenum += image_base;
+
+        if (MapImage() && mapped_writable && (bytenum + bytes) <= mapped_size) {
+            memcpy(mapped + bytenum, src, (size_t)bytes);
+            mapped_dirty = true;
+            return 0x00;
+        }
+
+        if (map_state != MAP_ACTIVE && !cacheEnabled()) {
+            if (fseeko64(diskimg,(fseek_ofs_t)bytenum,SEEK_SET) == 0 && fwrite(src, 1, (size_t)bytes, diskimg) == bytes)
+                return 0x00;
+
+            return 0x05;
+        }
+    }
+
+    for (uint32_t i=0;i < count;i++) {
+        const uint8_t r = Write_AbsoluteSector(sectnum+i, src + ((size_t)i * sector_size));
+        if (r != 0x00) return r;
+    }
+
+    return 0x00;
+}
+
+bool imageDisk::cacheEnabled(void) {
+    if (map_state == MAP_ACTIVE || disk_image_cache_size <= 0 || diskimg == NULL || (IMAGE_CACHE_BLOCK % sector_size) != 0) {
+        if (!cache_lru.empty()) FlushCache(true);
+        return false;
+    }
+
+    return true;
+}
+
+/* return the cached block holding the given file offset, reading it in if necessary */
+imageDisk::cacheBlock *imageDisk::cacheLookup(uint64_t bytenum) {
+    const uint64_t offset = image_base + (((bytenum - image_base) / IMAGE_CACHE_BLOCK) * IMAGE_CACHE_BLOCK);
+
+    auto i = cache_index.find(offset);
+    if (i != cache_index.end()) {
+        cache_lru.splice(cache_lru.begin(), cache_lru, i->second);
+        return &cache_lru.front();
+    }
+
+    const size_t max_blocks = std::max((size_t)1, ((size_t)disk_image_cache_size * 1024u) / IMAGE_CACHE_BLOCK);
+    while (cache_lru.size() >= max_blocks) {
+        cacheBlock &old = cache_lru.back();
+        /* a block that could not be written back stays cached, the caller goes to the file directly */
+        if (old.dirty && !cacheWriteBack(old)) return NULL;
+        cache_index.erase(old.offset);
+        cache_lru.pop_back();
+        HOSTMEM_Count(HOSTMEM_IMAGECACHE, -(int64_t)IMAGE_CACHE_BLOCK);
+    }
+
+    cacheBlock blk;
+    blk.offset = offset;
+    blk.data.resize(IMAGE_CACHE_BLOCK);
+
+    const uint64_t end = std::min(offset + IMAGE_CACHE_BLOCK, image_base + image_length);
+    if (fseeko64(diskimg,(fseek_ofs_t)offset,SEEK_SET) != 0) return NULL;
+    blk.length = (uint32_t)fread(&blk.data[0], 1, (size_t)(end - offset), diskimg);
+    if (blk.length == 0) return NULL;
+
+    cache_lru.push_front(std::move(blk));
+    cache_index[offset] = cache_lru.begin();
+    HOSTMEM_Count(HOSTMEM_IMAGECACHE, IMAGE_CACHE_BLOCK);
+    return &cache_lru.front();
+}
+
+bool imageDisk::cacheWriteBack(cacheBlock &blk) {
+    if (fseeko64(diskimg,(fseek_ofs_t)blk.offset,SEEK_SET) != 0 ||
+        fwrite(&blk.data[0], blk.length, 1, diskimg) != 1) {
+        LOG(LOG_MISC,LOG_ERROR)("Failed to write back cached sectors at offset %llu of disk image %s",(unsigned long long)blk.offset,diskname.c_str());
+        return false;
+    }
+
+    blk.dirty = false;
+    return true;
+}
+
+/* Writes may only be held in the cache if the image file can take them later,
+ * that is if it was opened for writing */
+bool imageDisk::cacheWritable(void) {
+    if (cache_writable < 0) {
+        cache_writable = 0;
+#if C_HAVE_MMAP
+        if ((fcntl(fileno(diskimg), F_GETFL) & O_ACCMODE) != O_RDONLY) cache_writable = 1;
+#elif defined(WIN32) && !defined(HX_DOS)
+        HANDLE mh = CreateFileMapping((HANDLE)_get_osfhandle(_fileno(diskimg)), NULL, PAGE_READWRITE, 0, 0, NULL);
+        if (mh != NULL) {
+            CloseHandle(mh);
+            cache_writable = 1;
+        }
+#endif
+    }
+
+    return cache_writable > 0;
+}
+
+/* write back all dirty blocks, and optionally empty the cache */
+void imageDisk::FlushCache(bool discard) {
+    for (auto &blk : cache_lru) {
+        if (blk.dirty) cacheWriteBack(blk);
+    }
+    if (diskimg != NULL) fflush(diskimg);
+
+    if (mapped != NULL && mapped_dirty) {
+#if C_HAVE_MMAP
+        msync(mapped, (size_t)mapped_size, MS_ASYNC);
+#elif defined(WIN32) && !defined(HX_DOS)
+        FlushViewOfFile(mapped, 0);
+#endif
+        mapped_dirty = false;
+    }
+
+    if (discard) {
+        HOSTMEM_Count(HOSTMEM_IMAGECACHE, -(int64_t)(cache_lru.size() * IMAGE_CACHE_BLOCK));
+        cache_lru.clear();
+        cache_index.clear();
+    }
+}
+
 void imageDisk::Set_Reserved_Cylinders(Bitu resCyl) {
     reserved_cylinders = resCyl;
 }
@@ -1679,8 +1902,114 @@ imageDisk::imageDisk(class DOS_Drive *useDrive, unsigned int letter, uint32_t fr
 	Set_GeometryForHardDisk();
 }
 
+/* Map the raw image file into memory on first access, if enabled and possible */
+bool imageDisk::MapImage(void) {
+    if (map_state != MAP_UNTRIED) return map_state == MAP_ACTIVE;
+    map_state = MAP_UNAVAILABLE;
+    if (!disk_image_mmap || diskimg == NULL || ffdd != NULL) return false;
+
+    /* anything written through stdio or the sector cache must reach the file first */
+    FlushCache(true);
+
+    uint64_t size = image_base + image_length;
+#if C_HAVE_MMAP
+    const int fd = fileno(diskimg);
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return false;
+    if ((uint64_t)st.st_size < size) size = (uint64_t)st.st_size; /* never map past EOF, that faults */
+    if (size == 0) return false;
+    if (sizeof(void*) < 8 && size > IMAGE_MMAP_MAX_32BIT) {
+        LOG(LOG_MISC,LOG_DEBUG)("Disk image %s too large to memory-map in a 32-bit build",diskname.c_str());
+        return false;
+    }
+
+    mapped_writable = (fcntl(fd, F_GETFL) & O_ACCMODE) == O_RDWR;
+    void *p = mmap(NULL, (size_t)size, mapped_writable ? (PROT_READ|PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        LOG(LOG_MISC,LOG_WARN)("Unable to memory-map disk image %s, errno=%d",diskname.c_str(),errno);
+        return false;
+    }
+    mapped = (uint8_t*)p;
+#elif defined(WIN32) && !defined(HX_DOS)
+    HANDLE fh = (HANDLE)_get_osfhandle(_fileno(diskimg));
+    LARGE_INTEGER fsz;
+
+    if (fh == INVALID_HANDLE_VALUE || GetFileType(fh) != FILE_TYPE_DISK || !GetFileSizeEx(fh, &fsz)) return false;
+    if ((uint64_t)fsz.QuadPart < size) size = (uint64_t)fsz.QuadPart;
+    if (size == 0) return false;
+    if (sizeof(void*) < 8 && size > IMAGE_MMAP_MAX_32BIT) {
+        LOG(LOG_MISC,LOG_DEBUG)("Disk image %s too large to memory-map in a 32-bit build",diskname.c_str());
+        return false;
+    }
+
+    /* read-only image files cannot be mapped for writing */
+    HANDLE mh = CreateFileMapping(fh, NULL, PAGE_READWRITE, 0, 0, NULL);
+    mapped_writable = (mh != NULL);
+    if (mh == NULL) mh = CreateFileMapping(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mh == NULL) return false;
+
+    void *p = MapViewOfFile(mh, mapped_writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, (SIZE_T)size);
+    if (p == NULL) {
+        LOG(LOG_MISC,LOG_WARN)("Unable to memory-map disk image %s, error=%lu",diskname.c_str(),(unsigned long)GetLastError());
+        CloseHandle(mh);
+        return false;
+    }
+    mapped_handle = (void*)mh;
+    mapped = (uint8_t*)p;
+#else
+    return false;
+#endif
+
+    mapped_size = size;
+    mapped_dirty = false;
+    map_state = MAP_ACTIVE;
+    LOG(LOG_MISC,LOG_DEBUG)("Disk image %s memory-mapped (%llu bytes, %s)",diskname.c_str(),(unsigned long long)size,mapped_writable ? "read/write" : "read-only");
+    return true;
+}
+
+/* When the guest reads the mapped image in order, have the OS page in what comes next
+ * ahead of time instead of faulting it in a page at a time. */
+void imageDisk::MapAdviseSequential(uint32_t sectnum, uint64_t bytenum) {
+    if (sectnum == mapped_next_sect) mapped_run++;
+    else mapped_run = 0;
+    mapped_next_sect = sectnum + 1u;
+
+#if C_HAVE_MMAP && defined(MADV_WILLNEED)
+    /* once per readahead window, when the first sector of the window is read */
+    if (mapped_run >= 8 && (bytenum % IMAGE_MMAP_READAHEAD) < sector_size) {
+        const uint64_t start = bytenum - (bytenum % IMAGE_MMAP_READAHEAD) + IMAGE_MMAP_READAHEAD;
+        if (start < mapped_size)
+            madvise(mapped + start, (size_t)std::min<uint64_t>(IMAGE_MMAP_READAHEAD, mapped_size - start), MADV_WILLNEED);
+    }
+#else
+    (void)bytenum;
+#endif
+}
+
+void imageDisk::UnmapImage(void) {
+    if (mapped != NULL) {
+#if C_HAVE_MMAP
+        if (mapped_dirty) msync(mapped, (size_t)mapped_size, MS_SYNC);
+        munmap(mapped, (size_t)mapped_size);
+#elif defined(WIN32) && !defined(HX_DOS)
+        if (mapped_dirty) FlushViewOfFile(mapped, 0);
+        UnmapViewOfFile(mapped);
+        CloseHandle((HANDLE)mapped_handle);
+        mapped_handle = NULL;
+#endif
+        mapped = NULL;
+        mapped_size = 0;
+        mapped_dirty = false;
+    }
+    map_state = MAP_UNTRIED;
+}
+
 imageDisk::~imageDisk()
 {
+    IDE_AsyncIO_Drain();
+    FlushCache(true);
+    UnmapImage();
     if(diskimg != NULL) {
         fclose(diskimg);
         diskimg=NULL;
@@ -1833,12 +2162,20 @@ char INT13_ElTorito_NoEmuCDROMDrive = 0;
 
 bool GetMSCDEXDrive(unsigned char drive_letter, CDROM_Interface **_cdrom);
 
+/* Extended reads and writes (AH=42h/43h) move up to this many sectors per imageDisk call */
+#define INT13_MULTI_SECTORS 64u
+static std::vector<uint8_t> int13_multi_buffer;
 
 static Bitu INT13_DiskHandler(void) {
+    HostTimeScope scope(HOSTTIME_DISK);
     uint16_t segat, bufptr;
     uint8_t sectbuf[2048/*CD-ROM support*/];
     uint8_t  drivenum;
     Bitu  i,t;
+
+    /* the IDE emulation may still be reading/writing a disk image on its I/O thread */
+    IDE_AsyncIO_Drain();
+
     last_drive = reg_dl;
     drivenum = GetDosDriveNumber(reg_dl);
     bool any_images = false;
@@ -1955,6 +2292,7 @@ static Bitu INT13_DiskHandler(void) {
         bufptr = reg_bx;
         for(i=0;i<reg_al;i++) {
             last_status = imageDiskList[drivenum]->Read_Sector((uint32_t)reg_dh, (uint32_t)(reg_ch | ((reg_cl & 0xc0)<< 2)), (uint32_t)((reg_cl & 63)+i), sectbuf);
+            if (last_status == 0x00) disk_io_bytes_read += imageDiskList[drivenum]->getSectSize();
 
             if (drivenum < 2)
                 diskio_delay(512, 0); // Floppy
@@ -2014,6 +2352,7 @@ static Bitu INT13_DiskHandler(void) {
                 diskio_delay(512);
 
             last_status = imageDiskList[drivenum]->Write_Sector((uint32_t)reg_dh, (uint32_t)(reg_ch | ((reg_cl & 0xc0) << 2)), (uint32_t)((reg_cl & 63) + i), &sectbuf[0]);
+            if (last_status == 0x00) disk_io_bytes_written += imageDiskList[drivenum]->getSectSize();
             if(last_status != 0x00) {
             CALLBACK_SCF(true);
                 return CBRET_NONE;
@@ -2090,10 +2429,10 @@ static Bitu INT13_DiskHandler(void) {
         reg_ah = 0x00;
         break;
     case 0x08: /* Get drive parameters */
-        if(driveInactive(drivenum)) {
-            if(drivenum == 0) {
-                // if no floppy drive 0 mounted, return fixed values for 1.44MB drive
-                // This fixes a problem in some DOS applications that occurred when booting from the hard disk without a mounted floppy disk.
+        if(driveInactive(drivenum)) {
+            if(drivenum == 0) {
+                // if no floppy drive 0 mounted, return fixed values for 1.44MB drive
+                // This fixes a problem in some DOS applications that occurred when booting from the hard disk without a mounted floppy disk.
                 reg_ax = 0x00;
                 reg_bl = 4;
                 reg_ch = 79;
@@ -2102,7 +2441,7 @@ static Bitu INT13_DiskHandler(void) {
                 reg_dl = 1;
                 last_status = 0x00;
                 CALLBACK_SCF(false);
-                return CBRET_NONE;
+                return CBRET_NONE;
             }
             last_status = 0x07;
             reg_ah = last_status;
@@ -2294,28 +2633,52 @@ static Bitu INT13_DiskHandler(void) {
 
         segat = dap.seg;
         bufptr = dap.off;
-        for(i=0;i<dap.num;i++) {
-            last_status = imageDiskList[drivenum]->Read_AbsoluteSector(dap.sector+i, sectbuf);
-
-            if(drivenum < 2)
-                diskio_delay(512, 0); // Floppy
-            else
-                diskio_delay(512);
-
-            IDE_EmuINT13DiskReadByBIOS_LBA(reg_dl,dap.sector+i);
-
-            if((last_status != 0x00) || killRead) {
-                real_writew(SegValue(ds),reg_si+2,i); // According to RBIL this should update the number of blocks field to what was successfully transferred
-                LOG_MSG("Error in disk read");
-                killRead = false;
-                reg_ah = 0x04;
-                CALLBACK_SCF(true);
-                return CBRET_NONE;
-            }
-            for(t=0;t<512;t++) {
-                real_writeb(segat,bufptr,sectbuf[t]);
-                bufptr++;
-            }
+        {
+            const uint32_t ss = imageDiskList[drivenum]->getSectSize();
+            Bitu chunk_start = 0, chunk_count = 0;
+            bool chunk_ok = false;
+
+            if (int13_multi_buffer.size() < (size_t)INT13_MULTI_SECTORS * ss)
+                int13_multi_buffer.resize((size_t)INT13_MULTI_SECTORS * ss);
+
+            for(i=0;i<dap.num;i++) {
+                /* read ahead the next run of sectors in one go, falling back to
+                 * one sector at a time to find out exactly where a failure is */
+                if ((i - chunk_start) >= chunk_count) {
+                    chunk_start = i;
+                    chunk_count = std::min((Bitu)dap.num - i, (Bitu)INT13_MULTI_SECTORS);
+                    chunk_ok = ss <= sizeof(sectbuf) &&
+                        imageDiskList[drivenum]->Read_AbsoluteSectors(dap.sector+i, (uint32_t)chunk_count, &int13_multi_buffer[0]) == 0x00;
+                }
+                if (chunk_ok) {
+                    memcpy(sectbuf, &int13_multi_buffer[(i - chunk_start) * ss], ss);
+                    last_status = 0x00;
+                }
+                else {
+                    last_status = imageDiskList[drivenum]->Read_AbsoluteSector(dap.sector+i, sectbuf);
+                }
+                if (last_status == 0x00) disk_io_bytes_read += ss;
+
+                if(drivenum < 2)
+                    diskio_delay(512, 0); // Floppy
+                else
+                    diskio_delay(512);
+
+                IDE_EmuINT13DiskReadByBIOS_LBA(reg_dl,dap.sector+i);
+
+                if((last_status != 0x00) || killRead) {
+                    real_writew(SegValue(ds),reg_si+2,i); // According to RBIL this should update the number of blocks field to what was successfully transferred
+                    LOG_MSG("Error in disk read");
+                    killRead = false;
+                    reg_ah = 0x04;
+                    CALLBACK_SCF(true);
+                    return CBRET_NONE;
+                }
+                for(t=0;t<512;t++) {
+                    real_writeb(segat,bufptr,sectbuf[t]);
+                    bufptr++;
+                }
+        }
         }
         reg_ah = 0x00;
         CALLBACK_SCF(false);
@@ -2337,22 +2700,35 @@ static Bitu INT13_DiskHandler(void) {
         }
 
         bufptr = dap.off;
-        for(i=0;i<dap.num;i++) {
-            for(t=0;t<imageDiskList[drivenum]->getSectSize();t++) {
-                sectbuf[t] = real_readb(dap.seg,bufptr);
-                bufptr++;
-            }
+        {
+            const uint32_t ss = imageDiskList[drivenum]->getSectSize();
 
-            if(drivenum < 2)
-                diskio_delay(512, 0); // Floppy
-            else
-                diskio_delay(512);
+            if (int13_multi_buffer.size() < (size_t)INT13_MULTI_SECTORS * ss)
+                int13_multi_buffer.resize((size_t)INT13_MULTI_SECTORS * ss);
 
-            last_status = imageDiskList[drivenum]->Write_AbsoluteSector(dap.sector+i, &sectbuf[0]);
-            if(last_status != 0x00) {
-                CALLBACK_SCF(true);
-                return CBRET_NONE;
-            }
+            for(i=0;i<dap.num;) {
+                const Bitu chunk_count = std::min((Bitu)dap.num - i, (Bitu)INT13_MULTI_SECTORS);
+
+                for(Bitu c=0;c<chunk_count;c++) {
+                    for(t=0;t<ss;t++) {
+                        int13_multi_buffer[(c * ss) + t] = real_readb(dap.seg,bufptr);
+                        bufptr++;
+                    }
+
+                    if(drivenum < 2)
+                        diskio_delay(512, 0); // Floppy
+                    else
+                        diskio_delay(512);
+                }
+
+                last_status = imageDiskList[drivenum]->Write_AbsoluteSectors(dap.sector+i, (uint32_t)chunk_count, &int13_multi_buffer[0]);
+                if (last_status == 0x00) disk_io_bytes_written += (uint64_t)chunk_count * ss;
+                if(last_status != 0x00) {
+                    CALLBACK_SCF(true);
+                    return CBRET_NONE;
+                }
+                i += chunk_count;
+        }
         }
         reg_ah = 0x00;
         CALLBACK_SCF(false);
@@ -20,6 +20,7 @@
 
 #include "dosbox.h"
 #include "callback.h"
+#include "cpu.h"
 #include "logging.h"
 #include "mem.h"
 #include "bios.h"
@@ -456,6 +457,33 @@ bool BIOS_AddKeyToBuffer(uint16_t code) {
     return true;
 }
 
+unsigned int BIOS_KeyboardBufferFree(void) {
+    uint16_t start,end,head,tail;
+    if (IS_PC98_ARCH) {
+        start=0x502;
+        end=0x522;
+        head =mem_readw(0x524/*head*/);
+        tail =mem_readw(0x526/*tail*/);
+    }
+    else {
+        if (mem_readb(BIOS_KEYBOARD_FLAGS2)&8) return 0;
+        if (machine==MCH_PCJR || machine==MCH_CGA) {
+            start=0x1e;
+            end=0x3e;
+        } else {
+            start=mem_readw(BIOS_KEYBOARD_BUFFER_START);
+            end  =mem_readw(BIOS_KEYBOARD_BUFFER_END);
+        }
+        head =mem_readw(BIOS_KEYBOARD_BUFFER_HEAD);
+        tail =mem_readw(BIOS_KEYBOARD_BUFFER_TAIL);
+    }
+    if (end <= start+2u || head < start || head >= end || tail < start || tail >= end) return 0;
+
+    /* one slot always stays empty, or a full buffer would look empty */
+    const unsigned int used = (tail >= head) ? (unsigned int)(tail-head) : (unsigned int)(end-start) - (unsigned int)(head-tail);
+    return ((unsigned int)(end-start) - used) / 2u - 1u;
+}
+
 static void add_key(uint16_t code) {
     if (code!=0 || IS_PC98_ARCH) BIOS_AddKeyToBuffer(code);
 }
@@ -1314,8 +1342,14 @@ extern bool INT28_AllowOnce;
 bool int16_unmask_irq1_on_read = true;
 bool int16_ah_01_cf_undoc = true;
 
+extern std::string strPasteBuffer;
+void PasteClipboardINT16(void);
+
 Bitu INT16_Handler(void) {
     uint16_t temp=0;
+    /* a paste in progress tops up the buffer when the guest reads or checks it */
+    if (GCC_UNLIKELY(!strPasteBuffer.empty()) && (reg_ah & 0xEEu) == 0x00u)
+        PasteClipboardINT16();
     switch (reg_ah) {
     case 0x00: /* GET KEYSTROKE */
         if (int16_unmask_irq1_on_read)
@@ -1332,9 +1366,11 @@ Bitu INT16_Handler(void) {
         if ((get_key(temp)) && (!IsEnhancedKey(temp))) {
             /* normal key found, return translated key in ax */
             reg_ax=temp;
+            CPU_IdleProgress();
         } else {
             /* enter small idle loop to allow for irqs to happen */
             reg_ip+=1;
+            CPU_IdlePoll();
         }
         break;
     case 0x10: /* GET KEYSTROKE (enhanced keyboards only) */
@@ -1355,9 +1391,11 @@ Bitu INT16_Handler(void) {
                 if(!IsKanjiCode(temp)) temp&=0xff00;
             }
             reg_ax=temp;
+            CPU_IdleProgress();
         } else {
             /* enter small idle loop to allow for irqs to happen */
             reg_ip+=1;
+            CPU_IdlePoll();
         }
         break;
     case 0x01: /* CHECK FOR KEYSTROKE */
@@ -1374,6 +1412,7 @@ Bitu INT16_Handler(void) {
                     CALLBACK_SZF(false);
                     if (int16_ah_01_cf_undoc) CALLBACK_SCF(true);
                     reg_ax=temp;
+                    CPU_IdleProgress();
                     break;
                 } else {
                     /* remove enhanced key from buffer and ignore it */
@@ -1383,6 +1422,7 @@ Bitu INT16_Handler(void) {
                 /* no key available */
                 CALLBACK_SZF(true);
                 if (int16_ah_01_cf_undoc) CALLBACK_SCF(false);
+                CPU_IdlePoll();
                 break;
             }
 //          CALLBACK_Idle();
@@ -1407,8 +1447,10 @@ Bitu INT16_Handler(void) {
         INT28_AllowOnce = true;
         if (!check_key(temp)) {
             CALLBACK_SZF(true);
+            CPU_IdlePoll();
         } else {
             CALLBACK_SZF(false);
+            CPU_IdleProgress();
             if (!IS_PC98_ARCH && ((temp&0xff)==0xf0) && (temp>>8)) {
                 /* special enhanced key, clear low part before returning key */
                 temp&=0xff00;
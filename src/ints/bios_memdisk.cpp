@@ -26,6 +26,8 @@
 #include "dos_inc.h" /* for Drives[] */
 #include "../dos/drives.h"
 #include "mapper.h"
+#include "pic.h"
+#include "ide.h"
 
 /* imageDiskMemory simulates a hard drive image or floppy drive image in RAM
 *
@@ -38,8 +40,15 @@
 *   upon allocation
 * Writes of all zeros do not allocate memory if none has yet been assigned
 *
+* Given an underlying image, it is a copy-on-write overlay of that image:
+*   chunks are copied from it when first written, and changed chunks can be
+*   committed back to it, on release or periodically
+*
 */
 
+// overlays that commit periodically
+static std::list<imageDiskMemory*> periodic_commit_overlays;
+
 // Create a hard drive image of a specified size; automatically select c/h/s
 imageDiskMemory::imageDiskMemory(uint32_t imgSizeK) : imageDisk(ID_MEMORY) {
 	//notes:
@@ -142,13 +151,13 @@ imageDiskMemory::imageDiskMemory(imageDisk* underlyingImage) : imageDisk(ID_MEMO
 	diskParams.cylcount = (uint16_t)cylinders;
 	diskParams.secttrack = (uint16_t)sectors;
 	diskParams.bytespersect = (uint16_t)bytesPerSector;
-	diskParams.biosval = 0;
+	diskParams.biosval = underlyingImage->GetBiosType();
 	diskParams.ksize = 0;
 	diskParams.mediaid = 0xF0;
 	diskParams.rootentries = 0;
-	diskParams.biosval = 0;
 	diskParams.sectcluster = 0;
-	init(diskParams, true, underlyingImage);
+	init(diskParams, underlyingImage->hardDrive, underlyingImage);
+	if (this->active) this->diskname = underlyingImage->diskname;
 }
 
 // Internal initialization code to create an image of a specified geometry
@@ -200,6 +209,7 @@ void imageDiskMemory::init(diskGeo diskParams, bool isHardDrive, imageDisk* unde
 	}
 	//clear memory map
 	memset((void*)ChunkMap, 0, total_chunks * sizeof(uint8_t*));
+	if (underlyingImage) dirty_chunks.assign(total_chunks, false);
 
 	//set internal variables
 	this->diskname = "RAM drive";
@@ -219,6 +229,12 @@ void imageDiskMemory::init(diskGeo diskParams, bool isHardDrive, imageDisk* unde
 imageDiskMemory::~imageDiskMemory() {
 	//quit if the map is already not allocated
 	if (!active) return;
+	if (commit_interval_ms != 0) {
+		periodic_commit_overlays.remove(this);
+		if (periodic_commit_overlays.empty()) PIC_RemoveEvents(CommitEvent);
+	}
+	if (commit_on_release && Commit() != 0x00)
+		LOG_MSG("Could not commit all changes of the overlay to %s.\n", diskname.c_str());
 	//release the underlying image
 	if (this->underlyingImage) this->underlyingImage->Release();
 	//loop through each chunk and release it if it has been allocated
@@ -282,6 +298,36 @@ uint8_t imageDiskMemory::Read_AbsoluteSector(uint32_t sectnum, void * data) {
 	return 0x00;
 }
 
+// Read a run of sectors from the ramdrive, a chunk at a time
+uint8_t imageDiskMemory::Read_AbsoluteSectors(uint32_t sectnum, uint32_t count, void * data) {
+	//let the single sector version report out of range sectors
+	if ((uint64_t)sectnum + count > total_sectors)
+		return imageDisk::Read_AbsoluteSectors(sectnum, count, data);
+
+	uint8_t* dst = (uint8_t*)data;
+	while (count > 0) {
+		const uint32_t chunknum = sectnum / sectors_per_chunk;
+		const uint32_t chunksect = sectnum % sectors_per_chunk;
+		const uint32_t run = std::min(count, sectors_per_chunk - chunksect);
+
+		if (ChunkMap[chunknum]) {
+			memcpy(dst, &ChunkMap[chunknum][chunksect * sector_size], (size_t)run * sector_size);
+		}
+		else if (this->underlyingImage) {
+			const uint8_t result = this->underlyingImage->Read_AbsoluteSectors(sectnum, run, dst);
+			if (result != 0x00) return result;
+		}
+		else {
+			memset(dst, 0, (size_t)run * sector_size);
+		}
+
+		sectnum += run;
+		count -= run;
+		dst += (size_t)run * sector_size;
+	}
+	return 0x00;
+}
+
 // Write a specific sector from the ramdrive
 uint8_t imageDiskMemory::Write_AbsoluteSector(uint32_t sectnum, const void * data) {
 	//sector number is a zero-based offset
@@ -330,13 +376,10 @@ uint8_t imageDiskMemory::Write_AbsoluteSector(uint32_t sectnum, const void * dat
 			//if this is the last chunk, don't read past the end of the original image
 			if ((chunknum + 1) == this->total_chunks) sectorsToCopy = this->total_sectors - chunkFirstSector;
 			//copy the sectors
-			uint8_t* target = datalocation;
-			for (uint32_t i = 0; i < sectorsToCopy; i++) {
-				this->underlyingImage->Read_AbsoluteSector(i + chunkFirstSector, target);
-				datalocation += this->sector_size;
-			}
+			this->underlyingImage->Read_AbsoluteSectors(chunkFirstSector, sectorsToCopy, datalocation);
 		}
 	}
+	if (this->underlyingImage) dirty_chunks[chunknum] = true;
 
 	//update the address to the specific sector within the chunk
 	datalocation = &datalocation[chunksect * sector_size];
@@ -346,6 +389,65 @@ uint8_t imageDiskMemory::Write_AbsoluteSector(uint32_t sectnum, const void * dat
 	return 0x00;
 }
 
+// Write the chunks changed since the last commit back to the underlying image
+uint8_t imageDiskMemory::Commit() {
+	if (!active || this->underlyingImage == NULL) return 0x00;
+	//the IDE worker thread must not be writing chunks while they are copied out
+	IDE_AsyncIO_Drain();
+	uint8_t result = 0x00;
+	for (uint32_t i = 0; i < total_chunks; i++) {
+		if (!dirty_chunks[i]) continue;
+		const uint32_t chunkFirstSector = i * sectors_per_chunk;
+		const uint32_t sectorsToCopy = std::min(sectors_per_chunk, total_sectors - chunkFirstSector);
+		if (this->underlyingImage->Write_AbsoluteSectors(chunkFirstSector, sectorsToCopy, ChunkMap[i]) != 0x00) {
+			result = 0x05;
+			continue;
+		}
+		dirty_chunks[i] = false;
+	}
+	return result;
+}
+
+void imageDiskMemory::SetCommitMode(bool commit_on_release, uint32_t interval_ms) {
+	this->commit_on_release = commit_on_release;
+	if (this->commit_interval_ms != 0) periodic_commit_overlays.remove(this);
+	this->commit_interval_ms = interval_ms;
+	if (interval_ms == 0 || !active) {
+		this->commit_interval_ms = 0;
+		if (periodic_commit_overlays.empty()) PIC_RemoveEvents(CommitEvent);
+		return;
+	}
+	this->next_commit = PIC_FullIndex() + interval_ms;
+	if (periodic_commit_overlays.empty()) PIC_AddEvent(CommitEvent, 1000.0f);
+	periodic_commit_overlays.push_back(this);
+}
+
+bool imageDiskMemory::ParseOverlayMode(const std::string& mode, bool* commit_on_release, uint32_t* interval_ms) {
+	*commit_on_release = false;
+	*interval_ms = 0;
+	if (mode.empty() || mode == "discard") return true;
+	*commit_on_release = true;
+	if (mode == "commit") return true;
+	char* end;
+	const unsigned long seconds = strtoul(mode.c_str(), &end, 10);
+	if (*end != 0 || seconds == 0 || seconds > 86400) return false;
+	*interval_ms = (uint32_t)seconds * 1000u;
+	return true;
+}
+
+// Checks once a second for overlays that are due for a commit
+void imageDiskMemory::CommitEvent(Bitu val) {
+	(void)val;//UNUSED
+	const double now = PIC_FullIndex();
+	for (imageDiskMemory* overlay : periodic_commit_overlays) {
+		if (now < overlay->next_commit) continue;
+		overlay->next_commit = now + overlay->commit_interval_ms;
+		if (overlay->Commit() != 0x00)
+			LOG_MSG("Could not commit all changes of the overlay to %s.\n", overlay->diskname.c_str());
+	}
+	PIC_AddEvent(CommitEvent, 1000.0f);
+}
+
 // Partition and format the ramdrive
 uint8_t imageDiskMemory::Format() {
 	//verify that the geometry of the drive is valid
@@ -270,8 +270,11 @@ imageDiskVHD::ErrorCodes imageDiskVHD::Open(const char* fileName, const bool rea
 	vhd->blockMapSectors = blockMapSectors;
 	vhd->blockMapSize = blockMapSectors * 512;
 	vhd->sectorsPerBlock = sectorsPerBlock;
-	vhd->currentBlockDirtyMap = (uint8_t*)malloc(vhd->blockMapSize);
-	if (!vhd->currentBlockDirtyMap) { delete vhd; return INVALID_DATA; }
+	//keep the BAT in memory
+	vhd->blockTable.resize(dynHeader.maxTableEntries);
+	if (fseeko64(file, (off_t)dynHeader.tableOffset, SEEK_SET)) { delete vhd; return INVALID_DATA; }
+	if (fread(vhd->blockTable.data(), sizeof(uint32_t), dynHeader.maxTableEntries, file) != dynHeader.maxTableEntries) { delete vhd; return INVALID_DATA; }
+	for (uint32_t i = 0; i < dynHeader.maxTableEntries; i++) vhd->blockTable[i] = SDL_SwapBE32(vhd->blockTable[i]);
 
 	//try loading the first block
 	if (!vhd->loadBlock(0)) {
@@ -389,28 +392,92 @@ imageDiskVHD::ErrorCodes imageDiskVHD::TryOpenParent(const char* childFileName,
 }
 
 uint8_t imageDiskVHD::Read_AbsoluteSector(uint32_t sectnum, void * data) {
-    if(vhdType == VHD_TYPE_FIXED) return fixedDisk->Read_AbsoluteSector(sectnum, data);
-	uint32_t blockNumber = sectnum / sectorsPerBlock;
-	uint32_t sectorOffset = sectnum % sectorsPerBlock;
-	if (!loadBlock(blockNumber)) return 0x05; //can't load block
-	if (currentBlockAllocated) {
-		uint32_t byteNum = sectorOffset / 8;
-		uint32_t bitNum = sectorOffset % 8;
-		bool hasData = currentBlockDirtyMap[byteNum] & (1 << (7 - bitNum));
-		if (hasData) {
-			if (fseeko64(diskimg, (off_t)(((uint64_t)currentBlockSectorOffset + blockMapSectors + sectorOffset) * 512ull), SEEK_SET)) return 0x05; //can't seek
-			if (fread(data, sizeof(uint8_t), 512, diskimg) != 512) return 0x05; //can't read
-			return 0;
-		}
-	}
-    //NOTE: should come first?
-	if (parentDisk) {
-		return parentDisk->Read_AbsoluteSector(sectnum, data);
-	}
-	else {
-		memset(data, 0, 512);
-		return 0;
-	}
+    return Read_AbsoluteSectors(sectnum, 1, data);
+}
+
+uint8_t imageDiskVHD::Read_AbsoluteSectors(uint32_t sectnum, uint32_t count, void * data) {
+    if(vhdType == VHD_TYPE_FIXED) return fixedDisk->Read_AbsoluteSectors(sectnum, count, data);
+    uint8_t* dst = (uint8_t*)data;
+    while(count > 0) {
+        SectorExtent extent;
+        bool cached = false;
+        for(const SectorExtent& e : extentCache) {
+            if(sectnum >= e.sector && sectnum - e.sector < e.count) {
+                extent = e;
+                cached = true;
+                break;
+            }
+        }
+        if(!cached) {
+            //resolve up to the end of the block, so following reads hit the cache
+            if(!ResolveExtent(sectnum, sectorsPerBlock - (sectnum % sectorsPerBlock), extent)) return 0x05;
+            //only worth remembering when a lookup has to walk a differencing chain
+            if(parentDisk) {
+                if(extentCache.size() < extentCacheSize) extentCache.push_back(extent);
+                else extentCache[extentCacheNext] = extent;
+                extentCacheNext = (extentCacheNext + 1) % extentCacheSize;
+            }
+        }
+        const uint32_t skip = sectnum - extent.sector;
+        const uint32_t run = std::min(count, extent.count - skip);
+        if(extent.layer == NULL) {
+            memset(dst, 0, 512u * run);
+        }
+        else if(extent.layer->vhdType == VHD_TYPE_FIXED) {
+            if(extent.layer->fixedDisk->Read_AbsoluteSectors(sectnum, run, dst) != 0) return 0x05;
+        }
+        else {
+            if(fseeko64(extent.layer->diskimg, (off_t)(extent.offset + skip * 512ull), SEEK_SET)) return 0x05; //can't seek
+            if(fread(dst, sizeof(uint8_t), 512u * run, extent.layer->diskimg) != 512u * run) return 0x05; //can't read
+        }
+        sectnum += run;
+        count -= run;
+        dst += 512u * run;
+    }
+    return 0;
+}
+
+//finds the layer of the chain holding sectnum, and how many of the following sectors (up to count) it also holds
+bool imageDiskVHD::ResolveExtent(uint32_t sectnum, uint32_t count, SectorExtent& extent) {
+    extent.sector = sectnum;
+    extent.offset = 0;
+    if(vhdType == VHD_TYPE_FIXED) {
+        extent.count = count;
+        extent.layer = this;
+        return true;
+    }
+    const uint32_t sectorOffset = sectnum % sectorsPerBlock;
+    uint32_t run = std::min(count, sectorsPerBlock - sectorOffset);
+    if (!loadBlock(sectnum / sectorsPerBlock)) return false; //can't load block
+    bool hasData = false;
+    if (currentBlockAllocated) {
+        //coalesce neighbouring sectors with the same bitmap state into one extent
+        hasData = (currentBlockDirtyMap[sectorOffset / 8] & (1 << (7 - (sectorOffset % 8)))) != 0;
+        uint32_t n = 1;
+        while (n < run && ((currentBlockDirtyMap[(sectorOffset + n) / 8] & (1 << (7 - ((sectorOffset + n) % 8)))) != 0) == hasData) n++;
+        run = n;
+    }
+    if (hasData) {
+        extent.count = run;
+        extent.layer = this;
+        extent.offset = ((uint64_t)currentBlockSectorOffset + blockMapSectors + sectorOffset) * 512ull;
+        return true;
+    }
+    if (parentDisk) return ((imageDiskVHD*)parentDisk)->ResolveExtent(sectnum, run, extent);
+    extent.count = run;
+    extent.layer = NULL;
+    return true;
+}
+
+void imageDiskVHD::InvalidateExtents() {
+    extentCache.clear();
+    extentCacheNext = 0;
+}
+
+uint8_t imageDiskVHD::Write_AbsoluteSectors(uint32_t sectnum, uint32_t count, const void * data) {
+    if(vhdType == VHD_TYPE_FIXED) return fixedDisk->Write_AbsoluteSectors(sectnum, count, data);
+    //dynamic and differencing images may have to allocate blocks, go one sector at a time
+    return imageDisk::Write_AbsoluteSectors(sectnum, count, data);
 }
 
 bool imageDiskVHD::is_zeroed_sector(const void* data) {
@@ -457,8 +524,13 @@ uint8_t imageDiskVHD::Write_AbsoluteSector(uint32_t sectnum, const void * data)
 		//save the new block location and new footer position
 		uint32_t newBlockSectorNumber = (uint32_t)((footerPosition + 511ul) / 512ul);
 		footerPosition = newFooterPosition;
-		//clear the dirty flags for the new footer position
-		for (uint32_t i = 0; i < blockMapSize; i++) currentBlockDirtyMap[i] = 0;
+		//start a cleared bitmap for the new block
+		BlockBitmap bitmap;
+		bitmap.block = blockNumber;
+		bitmap.map.assign(blockMapSize, 0);
+		bitmapCache.push_front(std::move(bitmap));
+		if (bitmapCache.size() > bitmapCacheBlocks) bitmapCache.pop_back();
+		currentBlockDirtyMap = bitmapCache.front().map.data();
 		//write the dirty map
 		if (fseeko64(diskimg, (off_t)(newBlockSectorNumber * 512ull), SEEK_SET)) return 0x05;
 		if (fwrite(currentBlockDirtyMap, sizeof(uint8_t), blockMapSize, diskimg) != blockMapSize) return 0x05;
@@ -468,6 +540,7 @@ uint8_t imageDiskVHD::Write_AbsoluteSector(uint32_t sectnum, const void * data)
 		if (fseeko64(diskimg, (off_t)(dynamicHeader.tableOffset + (blockNumber * 4ull)), SEEK_SET)) return 0x05;
 		uint32_t newBlockSectorNumberBE = SDL_SwapBE32(newBlockSectorNumber);
 		if (fwrite(&newBlockSectorNumberBE, sizeof(uint8_t), 4, diskimg) != 4) return false;
+		blockTable[blockNumber] = newBlockSectorNumber;
 		currentBlockAllocated = true;
 		currentBlockSectorOffset = newBlockSectorNumber;
 		//flush the data to disk after allocating a block
@@ -480,6 +553,7 @@ uint8_t imageDiskVHD::Write_AbsoluteSector(uint32_t sectnum, const void * data)
 	//if the sector hasn't been marked as dirty, mark it as dirty
 	if (!hasData) {
 		currentBlockDirtyMap[byteNum] |= 1 << (7 - bitNum);
+		InvalidateExtents();
 		if (fseeko64(diskimg, (off_t)(currentBlockSectorOffset * 512ull), SEEK_SET)) return 0x05; //can't seek
 		if (fwrite(currentBlockDirtyMap, sizeof(uint8_t), blockMapSize, diskimg) != blockMapSize) return 0x05;
 	}
@@ -506,31 +580,36 @@ imageDiskVHD::VHDTypes imageDiskVHD::GetVHDType(const char* fileName) {
 
 bool imageDiskVHD::loadBlock(const uint32_t blockNumber) {
 	if (currentBlock == blockNumber) return true;
-	if (blockNumber >= dynamicHeader.maxTableEntries) return false;
-	if (fseeko64(diskimg, (off_t)(dynamicHeader.tableOffset + (blockNumber * 4ull)), SEEK_SET)) return false;
-	uint32_t blockSectorOffset;
-	if (fread(&blockSectorOffset, sizeof(uint8_t), 4, diskimg) != 4) return false;
-	blockSectorOffset = SDL_SwapBE32(blockSectorOffset);
+	if (blockNumber >= blockTable.size()) return false;
+	const uint32_t blockSectorOffset = blockTable[blockNumber];
 	if (blockSectorOffset == 0xFFFFFFFFul) {
 		currentBlock = blockNumber;
 		currentBlockAllocated = false;
+		return true;
+	}
+	currentBlock = 0xFFFFFFFFul;
+	std::list<BlockBitmap>::iterator it = bitmapCache.begin();
+	while (it != bitmapCache.end() && it->block != blockNumber) ++it;
+	if (it != bitmapCache.end()) {
+		bitmapCache.splice(bitmapCache.begin(), bitmapCache, it);
 	}
 	else {
+		BlockBitmap bitmap;
+		bitmap.block = blockNumber;
+		bitmap.map.resize(blockMapSize);
 		if (fseeko64(diskimg, (off_t)(blockSectorOffset * (uint64_t)512), SEEK_SET)) return false;
-		currentBlock = 0xFFFFFFFFul;
-		currentBlockAllocated = true;
-		currentBlockSectorOffset = blockSectorOffset;
-		if (fread(currentBlockDirtyMap, sizeof(uint8_t), blockMapSize, diskimg) != blockMapSize) return false;
-		currentBlock = blockNumber;
+		if (fread(bitmap.map.data(), sizeof(uint8_t), blockMapSize, diskimg) != blockMapSize) return false;
+		bitmapCache.push_front(std::move(bitmap));
+		if (bitmapCache.size() > bitmapCacheBlocks) bitmapCache.pop_back();
 	}
+	currentBlockAllocated = true;
+	currentBlockSectorOffset = blockSectorOffset;
+	currentBlockDirtyMap = bitmapCache.front().map.data();
+	currentBlock = blockNumber;
 	return true;
 }
 
 imageDiskVHD::~imageDiskVHD() {
-	if (currentBlockDirtyMap) {
-		free(currentBlockDirtyMap);
-		currentBlockDirtyMap = nullptr;
-	}
 	if (parentDisk) {
 		parentDisk->Release();
 		parentDisk = nullptr;
@@ -913,11 +992,8 @@ uint32_t imageDiskVHD::GetInfo(VHDInfo* info) {
     if(vhdType != VHD_TYPE_FIXED) {
         info->blockSize = dynamicHeader.blockSize;
         info->totalBlocks = dynamicHeader.maxTableEntries;
-        fseeko64(diskimg, dynamicHeader.tableOffset, SEEK_SET);
-        for(int i = 0; i < info->totalBlocks; i++) {
-            uint32_t n;
-            if(fread(&n, 1, 4, diskimg) != 4) return ERROR_OPENING;
-            if(n != 0xFFFFFFFF) info->allocatedBlocks++;
+        for(uint32_t i = 0; i < info->totalBlocks; i++) {
+            if(blockTable[i] != 0xFFFFFFFF) info->allocatedBlocks++;
         }
     }
     else {
@@ -957,15 +1033,13 @@ bool imageDiskVHD::MergeSnapshot(uint32_t* totalSectorsMerged, uint32_t* totalBl
         return false;
     }
     parentDisk->Addref();
+    InvalidateExtents();
     //scan BAT
     uint32_t sectorsPerBlock = dynamicHeader.blockSize / 512;
     *totalSectorsMerged = 0;
     *totalBlocksUpdated = 0;
     for(uint32_t block = 0; block < dynamicHeader.maxTableEntries; block++) {
-        uint32_t n;
-        fseeko64(diskimg, dynamicHeader.tableOffset+block*4, SEEK_SET);
-        if(fread(&n, 1, 4, diskimg) != 4) { return false; }
-        if(n == 0xFFFFFFFF) continue;
+        if(blockTable[block] == 0xFFFFFFFF) continue;
         loadBlock(block);
         bool blockUpdated = false;
         //scan bitmap
@@ -995,6 +1069,44 @@ bool imageDiskVHD::MergeSnapshot(uint32_t* totalSectorsMerged, uint32_t* totalBl
     return true;
 }
 
+//copies what a VHD (and its parents, if differencing) reads as into a new standalone Dynamic VHD
+uint32_t imageDiskVHD::Flatten(const char* filename, const char* newname, uint32_t* totalBlocksCopied) {
+    if(filename == NULL || newname == NULL || totalBlocksCopied == NULL) return ERROR_OPENING;
+    *totalBlocksCopied = 0;
+    imageDiskVHD* vhd;
+    if(Open(filename, true, (imageDisk**)&vhd) != OPEN_SUCCESS) return ERROR_OPENING;
+    uint32_t STATUS = CreateDynamic(newname, vhd->footer.currentSize);
+    if(STATUS == ERROR_OPENING) STATUS = ERROR_WRITING;
+    imageDiskVHD* flat = NULL;
+    if(STATUS == OPEN_SUCCESS && Open(newname, false, (imageDisk**)&flat) != OPEN_SUCCESS) STATUS = ERROR_WRITING;
+    if(STATUS == OPEN_SUCCESS) {
+        const uint32_t blockSectors = flat->sectorsPerBlock;
+        const uint32_t totalSectors = (uint32_t)(vhd->footer.currentSize / 512);
+        std::vector<uint8_t> buffer(blockSectors * 512u);
+        for(uint32_t sector = 0; sector < totalSectors && STATUS == OPEN_SUCCESS; sector += blockSectors) {
+            const uint32_t count = std::min(blockSectors, totalSectors - sector);
+            if(vhd->Read_AbsoluteSectors(sector, count, buffer.data()) != 0) {
+                STATUS = ERROR_OPENING;
+                break;
+            }
+            //the new image reads as zeros already, only sectors with data need to be written
+            bool blockCopied = false;
+            for(uint32_t i = 0; i < count; i++) {
+                if(vhd->is_zeroed_sector(&buffer[i * 512u])) continue;
+                if(flat->Write_AbsoluteSector(sector + i, &buffer[i * 512u]) != 0) {
+                    STATUS = ERROR_WRITING;
+                    break;
+                }
+                blockCopied = true;
+            }
+            if(blockCopied) (*totalBlocksCopied)++;
+        }
+    }
+    if(flat) delete flat;
+    delete vhd;
+    return STATUS;
+}
+
 //creates a snapshot of current VHD state, with a random name
 uint32_t imageDiskVHD::CreateSnapshot() {
     uint8_t buf[16];
@@ -34,6 +34,7 @@
 #include "cpu.h"
 #include "dma.h"
 #include "control.h"
+#include "pic.h"
 
 /* TODO: Make EMS page frame address (and size) user configurable.
  *       With auto setting to fit in automatically with BIOS and UMBs.
@@ -432,6 +433,46 @@ static uint8_t EMM_ReallocatePages(uint16_t handle, const uint16_t& pages) {
 Bitu XMS_EnableA20(bool enable);
 Bitu XMS_GetEnabledA20(void);
 
+// 16KB window remaps, same windowing as the TLB flush statistics
+static struct {
+	uint64_t total;
+	Bitu window_start;		// PIC_Ticks at the start of the current window
+	uint64_t count;			// remaps in the current window
+	uint64_t rate;			// remaps of the last complete window, per second
+} emm_remap_stats;
+
+// reading does not roll the window, EMM_RemapWindow() does
+void EMS_GetRemapStats(uint64_t &remaps,uint64_t &remaps_per_sec) {
+	const Bitu elapsed=PIC_Ticks-emm_remap_stats.window_start;
+	remaps=emm_remap_stats.total;
+	remaps_per_sec=(elapsed<2000) ? emm_remap_stats.rate : (emm_remap_stats.count*1000/elapsed);
+}
+
+/* Point the four 4KB pages of a 16KB window at lin_page to the pages of memh, or back at
+ * themselves if memh is 0. PAGING_MapPage() drops the TLB entry of each page it remaps, which
+ * is everything a remap changes, so there is no full TLB flush here. Programs that bank switch
+ * the page frame several times per frame would otherwise throw away the whole TLB each time. */
+static void EMM_RemapWindow(PageNum lin_page,MemHandle memh) {
+	const Bitu elapsed=PIC_Ticks-emm_remap_stats.window_start;
+	if (elapsed>=1000) {
+		emm_remap_stats.rate=(elapsed<2000) ? emm_remap_stats.count : (emm_remap_stats.count*1000/elapsed);
+		emm_remap_stats.count=0;
+		emm_remap_stats.window_start=PIC_Ticks;
+	}
+	emm_remap_stats.total++;
+	emm_remap_stats.count++;
+
+	for (Bitu i=0;i<4;i++) {
+		if (memh > 0) {
+			PAGING_MapPage(lin_page+i,(PageNum)memh);
+			memh=MEM_NextHandle(memh);
+		}
+		else {
+			PAGING_MapPage(lin_page+i,lin_page+i);
+		}
+	}
+}
+
 static uint8_t EMM_MapPage(Bitu phys_page,uint16_t handle,uint16_t log_page) {
 //	LOG_MSG("EMS MapPage handle %d phys %d log %d",handle,phys_page,log_page);
 	/* Check for too high physical page */
@@ -450,9 +491,7 @@ static uint8_t EMM_MapPage(Bitu phys_page,uint16_t handle,uint16_t log_page) {
 		/* Unmapping */
 		emm_mappings[phys_page].handle=NULL_HANDLE;
 		emm_mappings[phys_page].page=NULL_PAGE;
-		for (Bitu i=0;i<4;i++) 
-			PAGING_MapPage(EMM_PAGEFRAME4K+phys_page*4u+i,EMM_PAGEFRAME4K+phys_page*4u+i);
-		PAGING_ClearTLB();
+		EMM_RemapWindow(EMM_PAGEFRAME4K+phys_page*4u,0);
 		return EMM_NO_ERROR;
 	}
 	/* Check for valid handle */
@@ -463,12 +502,7 @@ static uint8_t EMM_MapPage(Bitu phys_page,uint16_t handle,uint16_t log_page) {
 		emm_mappings[phys_page].handle=handle;
 		emm_mappings[phys_page].page=log_page;
 		
-		MemHandle memh=MEM_NextHandleAt(emm_handles[handle].mem,log_page*4u);
-		for (Bitu i=0;i<4;i++) {
-			PAGING_MapPage(EMM_PAGEFRAME4K+(unsigned int)phys_page*4u+i,(Bitu)memh);
-			memh=MEM_NextHandle(memh);
-		}
-		PAGING_ClearTLB();
+		EMM_RemapWindow(EMM_PAGEFRAME4K+(unsigned int)phys_page*4u,MEM_NextHandleAt(emm_handles[handle].mem,log_page*4u));
 		return EMM_NO_ERROR;
 	} else  {
 		/* Illegal logical page it is */
@@ -508,9 +542,7 @@ static uint8_t EMM_MapSegment(Bitu segment,uint16_t handle,uint16_t log_page) {
 				emm_segmentmappings[segment>>10].handle=NULL_HANDLE;
 				emm_segmentmappings[segment>>10].page=NULL_PAGE;
 			}
-			for (Bitu i=0;i<4;i++) 
-				PAGING_MapPage(segment*16u/4096u+i,segment*16u/4096u+i);
-			PAGING_ClearTLB();
+			EMM_RemapWindow(segment*16u/4096u,0);
 			return EMM_NO_ERROR;
 		}
 		/* Check for valid handle */
@@ -526,12 +558,7 @@ static uint8_t EMM_MapSegment(Bitu segment,uint16_t handle,uint16_t log_page) {
 				emm_segmentmappings[segment>>10u].page=log_page;
 			}
 			
-			MemHandle memh=MEM_NextHandleAt(emm_handles[handle].mem,log_page*4u);
-			for (Bitu i=0;i<4;i++) {
-				PAGING_MapPage(segment*16u/4096u+i,(Bitu)memh);
-				memh=MEM_NextHandle(memh);
-			}
-			PAGING_ClearTLB();
+			EMM_RemapWindow(segment*16u/4096u,MEM_NextHandleAt(emm_handles[handle].mem,log_page*4u));
 			return EMM_NO_ERROR;
 		} else  {
 			/* Illegal logical page it is */
@@ -58,6 +58,7 @@ void INT10_SetJ3ModeCGA4(uint16_t mode);
 bool J3_IsCga4Dcga();
 #if defined(USE_TTF)
 extern bool colorChanged, justChanged;
+extern uint32_t pc98_font_serial;
 extern bool ttf_dosv;
 void ttf_reset(void);
 #endif
@@ -1401,6 +1402,7 @@ void INT10_OnResetComplete() {
 extern int vesa_set_display_vsync_wait;
 extern bool vesa_bank_switch_window_range_check;
 extern bool vesa_bank_switch_window_mirror;
+extern bool vesa_prefer_lfb;
 extern bool vesa_zero_on_get_information;
 extern bool unmask_irq0_on_int10_setmode;
 extern bool int16_unmask_irq1_on_read;
@@ -1821,6 +1823,7 @@ void INT10_Startup(Section *sec) {
 	vesa_set_display_vsync_wait = video_section->Get_int("vesa set display vsync");
 	vesa_bank_switch_window_range_check = video_section->Get_bool("vesa bank switching window range check");
 	vesa_bank_switch_window_mirror = video_section->Get_bool("vesa bank switching window mirroring");
+	vesa_prefer_lfb = video_section->Get_bool("vesa prefer lfb");
 	vesa_zero_on_get_information = video_section->Get_bool("vesa zero buffer on get information");
 	unmask_irq0_on_int10_setmode = video_section->Get_bool("unmask timer on int 10 setmode");
 	int16_unmask_irq1_on_read = static_cast<Section_prop *>(control->GetSection("dosbox"))->Get_bool("unmask keyboard on int 16 read");
@@ -1887,6 +1890,8 @@ void INT10_Startup(Section *sec) {
             if(!sbcs_ok || !dbcs_ok) Load_Anex86_Font(anex86_font, sbcs_ok, dbcs_ok);
             /* Failing all else we can use the internal FREECG 8x16 font and default Japanese font to show text on the screen. */
             if(!sbcs_ok || !dbcs_ok) Load_JFont_As_PC98(sbcs_ok, dbcs_ok);
+
+            pc98_font_serial++;
         }
 
         CurMode = &PC98_Mode;
@@ -508,11 +508,13 @@ static void TEXT_FillRow(uint8_t cleft,uint8_t cright,uint8_t row,PhysPt base,ui
     /* Do some filing */
     PhysPt dest;
     dest=base+(row*ncols+cleft)*2;
-    uint16_t fill=(attr<<8)+' ';
-    for (uint8_t x=0;x<(Bitu)(cright-cleft);x++) {
-        mem_writew(dest,fill);
-        dest+=2;
+    uint8_t fill[256*2];
+    Bitu cells=(Bitu)(cright-cleft);
+    for (Bitu x=0;x<cells;x++) {
+        fill[x*2+0]=' ';
+        fill[x*2+1]=attr;
     }
+    MEM_BlockWrite(dest,fill,cells*2u);
 }
 
 #define _pushregs \
@@ -721,112 +723,99 @@ uint8_t CheckBankSelect(uint8_t select, Bitu &off)
 	return select;
 }
 
+/* Draw a 24-line glyph cell in a planar 16-color mode one plane at a time.
+   glyph holds 24 rows of 'bytes' bytes already shifted to the cell's nibble
+   position, mask selects the bits of each byte column that belong to the cell.
+   Each byte is composed on the host from the foreground/background color bits
+   so the graphics controller is reprogrammed once per plane instead of several
+   times for every byte of the glyph. */
+static void DOSV_BlitGlyph24(Bitu off, Bitu width, const uint8_t *glyph, const uint8_t *mask, uint8_t bytes, uint8_t attr, uint8_t back)
+{
+	IO_Write(0x3ce, 5); IO_Write(0x3cf, 0);
+	IO_Write(0x3ce, 1); IO_Write(0x3cf, 0);
+	IO_Write(0x3ce, 3); IO_Write(0x3cf, 0);
+	IO_Write(0x3ce, 8); IO_Write(0x3cf, 0xff);
+	for(uint8_t plane = 0 ; plane < 4 ; plane++) {
+		const uint8_t fg = (attr & (1 << plane)) ? 0xff : 0x00;
+		const uint8_t bg = (back & (1 << plane)) ? 0xff : 0x00;
+		const uint8_t *data = glyph;
+		Bitu pos = off;
+		uint8_t select = StartBankSelect(pos);
+
+		IO_Write(0x3c4, 2); IO_Write(0x3c5, 1 << plane);
+		IO_Write(0x3ce, 4); IO_Write(0x3cf, plane);
+		for(uint8_t y = 0 ; y < 24 ; y++) {
+			for(uint8_t x = 0 ; x < bytes ; x++) {
+				if(mask[x] != 0) {
+					uint8_t val = ((data[x] & fg) | (~data[x] & bg)) & mask[x];
+					if(mask[x] != 0xff) val |= real_readb(0xa000, pos) & ~mask[x];
+					real_writeb(0xa000, pos, val);
+				}
+				pos++;
+				select = CheckBankSelect(select, pos);
+			}
+			data += bytes;
+			pos += width - bytes;
+			select = CheckBankSelect(select, pos);
+		}
+	}
+	IO_Write(0x3c4, 2); IO_Write(0x3c5, 0xf);
+	IO_Write(0x3ce, 4); IO_Write(0x3cf, 0);
+	IO_Write(0x3cd, 0x00);
+}
+
 void WriteCharDOSVSbcs24(uint8_t col, uint8_t row, uint8_t chr, uint8_t attr)
 {
-	uint8_t back, select;
 	uint8_t *font;
 	Bitu off;
 	Bitu width = (real_readw(BIOSMEM_SEG, BIOSMEM_NB_COLS) == 85) ? 128 : 160;
-	volatile uint8_t dummy;
 
 	font = GetSbcs24Font(chr);
 
-	back = attr >> 4;
-	attr &= 0x0f;
-
 	off = row * width * 24 + (col * 12) / 8;
-	select = StartBankSelect(off);
-
-	IO_Write(0x3ce, 5); IO_Write(0x3cf, 0);
-	IO_Write(0x3ce, 1); IO_Write(0x3cf, 0xf);
 
-	uint8_t data[2];
-	uint8_t mask_data[2][2] = {{ 0xff, 0xf0 }, { 0x0f, 0xff }};
+	uint8_t data[24 * 2];
+	static const uint8_t mask_data[2][2] = {{ 0xff, 0xf0 }, { 0x0f, 0xff }};
 	for(uint8_t y = 0 ; y < 24 ; y++) {
 		if(col & 1) {
-			data[0] = *font >> 4;
-			data[1] = (*font << 4) | (*(font + 1) >> 4);
+			data[y * 2 + 0] = *font >> 4;
+			data[y * 2 + 1] = (*font << 4) | (*(font + 1) >> 4);
 			font += 2;
 		} else {
-			data[0] = *font++;
-			data[1] = *font++;
-		}
-		for(uint8_t x = 0 ; x < 2 ; x++) {
-			IO_Write(0x3ce, 8); IO_Write(0x3cf, data[x]);
-			IO_Write(0x3ce, 0); IO_Write(0x3cf, attr);
-			dummy = real_readb(0xa000, off);
-			real_writeb(0xa000, off, 0xff);
-
-			IO_Write(0x3ce, 8); IO_Write(0x3cf, data[x] ^ mask_data[col & 1][x]);
-			IO_Write(0x3ce, 0); IO_Write(0x3cf, back);
-			dummy = real_readb(0xa000, off);
-			real_writeb(0xa000, off, 0xff);
-
-			off++;
-			select = CheckBankSelect(select, off);
+			data[y * 2 + 0] = *font++;
+			data[y * 2 + 1] = *font++;
 		}
-		off += width - 2;
-		select = CheckBankSelect(select, off);
 	}
-	IO_Write(0x3ce, 8); IO_Write(0x3cf, 0xff);
-	IO_Write(0x3ce, 1); IO_Write(0x3cf, 0);
-	IO_Write(0x3cd, 0x00);
+	DOSV_BlitGlyph24(off, width, data, mask_data[col & 1], 2, attr & 0x0f, attr >> 4);
 }
 
 void WriteCharDOSVDbcs24(uint16_t col, uint16_t row, uint16_t chr, uint8_t attr)
 {
-	uint8_t back, select;
 	uint8_t *font;
 	Bitu off;
 	Bitu width = (real_readw(BIOSMEM_SEG, BIOSMEM_NB_COLS) == 85) ? 128 : 160;
-	volatile uint8_t dummy;
 
 	font = GetDbcs24Font(chr);
 
-	back = attr >> 4;
-	attr &= 0x0f;
-
 	off = row * width * 24 + (col * 12) / 8;
-	select = StartBankSelect(off);
-
-	IO_Write(0x3ce, 5); IO_Write(0x3cf, 0);
-	IO_Write(0x3ce, 1); IO_Write(0x3cf, 0xf);
 
-	uint8_t data[4];
-	uint8_t mask_data[2][4] = {{ 0xff, 0xff, 0xff, 0x00 }, { 0x0f, 0xff, 0xff, 0xf0 }};
+	uint8_t data[24 * 4];
+	static const uint8_t mask_data[2][4] = {{ 0xff, 0xff, 0xff, 0x00 }, { 0x0f, 0xff, 0xff, 0xf0 }};
 	for(uint8_t y = 0 ; y < 24 ; y++) {
 		if(col & 1) {
-			data[0] = *font >> 4;
-			data[1] = (*font << 4) | (*(font + 1) >> 4);
-			data[2] = (*(font + 1) << 4) | (*(font + 2) >> 4);
-			data[3] = *(font + 2) << 4;
+			data[y * 4 + 0] = *font >> 4;
+			data[y * 4 + 1] = (*font << 4) | (*(font + 1) >> 4);
+			data[y * 4 + 2] = (*(font + 1) << 4) | (*(font + 2) >> 4);
+			data[y * 4 + 3] = *(font + 2) << 4;
 			font += 3;
 		} else {
-			data[0] = *font++;
-			data[1] = *font++;
-			data[2] = *font++;
+			data[y * 4 + 0] = *font++;
+			data[y * 4 + 1] = *font++;
+			data[y * 4 + 2] = *font++;
+			data[y * 4 + 3] = 0;
 		}
-		for(uint8_t x = 0 ; x < 4 ; x++) {
-			if(mask_data[col & 1][x] != 0) {
-				IO_Write(0x3ce, 8); IO_Write(0x3cf, data[x]);
-				IO_Write(0x3ce, 0); IO_Write(0x3cf, attr);
-				dummy = real_readb(0xa000, off);
-				real_writeb(0xa000, off, 0xff);
-
-				IO_Write(0x3ce, 8); IO_Write(0x3cf, data[x] ^ mask_data[col & 1][x]);
-				IO_Write(0x3ce, 0); IO_Write(0x3cf, back);
-				dummy = real_readb(0xa000, off);
-				real_writeb(0xa000, off, 0xff);
-			}
-			off++;
-			select = CheckBankSelect(select, off);
-		}
-		off += width - 4;
-		select = CheckBankSelect(select, off);
 	}
-	IO_Write(0x3ce, 8); IO_Write(0x3cf, 0xff);
-	IO_Write(0x3ce, 1); IO_Write(0x3cf, 0);
-	IO_Write(0x3cd, 0x00);
+	DOSV_BlitGlyph24(off, width, data, mask_data[col & 1], 4, attr & 0x0f, attr >> 4);
 }
 
 void WriteCharDOSVSbcs(uint16_t col, uint16_t row, uint8_t chr, uint8_t attr) {
@@ -1060,6 +1049,19 @@ void INT10_ScrollWindow(uint8_t rul,uint8_t cul,uint8_t rlr,uint8_t clr,int8_t n
         }
     }
 
+    /* Full-width text scroll: the moved rows are one contiguous span of text RAM,
+       so move them with a single block move instead of row by row */
+    if (CurMode->type==M_TEXT && cul==0 && clr==ncols && nlines!=0 &&
+        (nlines>0 ? nlines : -nlines)<=(rlr-rul+1)) {
+        Bitu rowbytes=(Bitu)ncols*2u;
+        Bitu moved=(Bitu)(rlr-rul+1)-(Bitu)(nlines>0 ? nlines : -nlines);
+        if (moved) {
+            if (nlines<0) MEM_BlockMove(base+rul*rowbytes,base+(rul-nlines)*rowbytes,moved*rowbytes);
+            else MEM_BlockMove(base+(rul+nlines)*rowbytes,base+rul*rowbytes,moved*rowbytes);
+        }
+        goto filling;
+    }
+
     /* See how much lines need to be copied */
     uint8_t start,end;Bits next;
     /* Copy some lines */
@@ -1792,6 +1794,10 @@ void INT10_WriteChar(uint16_t chr,uint8_t attr,uint8_t page,uint16_t count,bool
     }
 }
 
+/* Set while INT10_TeletypeOutputString runs: only the BIOS data area cursor is
+   updated per character and the CRTC cursor is programmed once at the end */
+static bool teletype_batch = false;
+
 static void INT10_TeletypeOutputAttr(uint8_t chr,uint8_t attr,bool useattr,uint8_t page) {
 	BIOS_NCOLS;BIOS_NROWS;
 	uint8_t cur_row=CURSOR_POS_ROW(page);
@@ -1864,7 +1870,13 @@ static void INT10_TeletypeOutputAttr(uint8_t chr,uint8_t attr,bool useattr,uint8
 		cur_row--;
 	}
 	// Set the cursor for the page
-	INT10_SetCursorPos(cur_row,cur_col,page);
+	if (teletype_batch) {
+		real_writeb(BIOSMEM_SEG,BIOSMEM_CURSOR_POS+page*2u,cur_col);
+		real_writeb(BIOSMEM_SEG,BIOSMEM_CURSOR_POS+page*2u+1u,cur_row);
+	}
+	else {
+		INT10_SetCursorPos(cur_row,cur_col,page);
+	}
 }
 
 void INT10_TeletypeOutputAttr(uint8_t chr,uint8_t attr,bool useattr) {
@@ -1875,6 +1887,22 @@ void INT10_TeletypeOutput(uint8_t chr,uint8_t attr) {
     INT10_TeletypeOutputAttr(chr,attr,CurMode->type!=M_TEXT);
 }
 
+/* Same as calling INT10_TeletypeOutput() for each character, but the hardware
+   cursor is moved only once after the whole string has been written. */
+void INT10_TeletypeOutputString(const uint8_t *str,Bitu len,uint8_t attr) {
+    if (len == 0) return;
+    if (IS_PC98_ARCH || IS_DOSV || J3_IsJapanese() || CurMode->type != M_TEXT) {
+        while (len--) INT10_TeletypeOutput(*str++,attr);
+        return;
+    }
+
+    uint8_t page=real_readb(BIOSMEM_SEG,BIOSMEM_CURRENT_PAGE);
+    teletype_batch = true;
+    while (len--) INT10_TeletypeOutputAttr(*str++,attr,false,page);
+    teletype_batch = false;
+    INT10_SetCursorPos(CURSOR_POS_ROW(page),CURSOR_POS_COL(page),page);
+}
+
 #define	EXTEND_ATTRIBUTE_HORIZON_LINE	0x04
 #define	EXTEND_ATTRIBUTE_VERTICAL_LINE	0x08
 #define	EXTEND_ATTRIBUTE_UNDER_LINE		0x80
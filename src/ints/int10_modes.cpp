@@ -869,6 +869,7 @@ static void FinishSetMode(bool clearmem) {
         case M_PACKED4:
 			/* Hack we just access the memory directly */
 			memset(vga.mem.linear,0,vga.mem.memsize);
+			VGA_MarkAllDirty();
 			break;
 		default:
 			break;
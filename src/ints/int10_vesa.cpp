@@ -44,6 +44,7 @@ int hack_lfb_xadjust = 0;
 int vesa_set_display_vsync_wait = -1;
 bool vesa_bank_switch_window_range_check = true;
 bool vesa_bank_switch_window_mirror = false;
+bool vesa_prefer_lfb = false;
 bool vesa_zero_on_get_information = true;
 
 extern unsigned int vbe_window_granularity;
@@ -483,6 +484,10 @@ foundit:
 	if (int10.vesa_oldvbe10)
 		modeAttributes &= ~2; /* clear D1, which indicates whether the optional XResolution, etc. fields are present */
 
+	/* D6 (VBE 2.0): windowed memory model not available, steer the program to the LFB */
+	if (vesa_prefer_lfb && (modeAttributes & 0x80))
+		modeAttributes |= 0x40;
+
 	if (!int10.vesa_oldvbe10)
 		var_write(&minfo.NumberOfImagePages, (uint8_t)pages); /* did not exist until VBE 1.1 */
 
@@ -578,7 +583,7 @@ uint8_t VESA_SetCPUWindow(uint8_t window,uint16_t address) {
 			dosbox_int_push_save_state();
 			dosbox_integration_trigger_write_direct32(DOSBOX_ID_REG_VGAIG_BANKWINDOW,(uint32_t)address * (uint32_t)vga.svga.bank_size);
 			dosbox_int_pop_save_state();
-			VGA_SetupHandlers();
+			VGA_SetupBankWindow();
 		}
 		else {
 			IO_Write(0x3d4,0x6a);
@@ -31,6 +31,7 @@
 #include "dos_inc.h"
 #define INCJFONT 1
 #include "jfont.h"
+#include "hostmem.h"
 #include <limits.h>
 #if defined(LINUX) && C_X11
 #include <X11/Xlib.h>
@@ -79,6 +80,15 @@ static uint8_t jfont_kana[32*64];
 static uint8_t jfont_kanji[96];
 static uint16_t gaiji_seg;
 
+void DOSV_GetHostMemory(HostMemSize &sz) {
+	sz.add_heap(sizeof(jfont_sbcs_16) + sizeof(jfont_sbcs_19) + sizeof(jfont_sbcs_24));
+	sz.add_heap(sizeof(jfont_cache_dbcs_14) + sizeof(jfont_cache_dbcs_16) + sizeof(jfont_cache_dbcs_24));
+	sz.add(jfont_dbcs_14, sizeof(jfont_dbcs_14));
+	sz.add(jfont_dbcs_16, sizeof(jfont_dbcs_16));
+	sz.add(jfont_dbcs_24, sizeof(jfont_dbcs_24));
+	sz.add_heap(fontsize14 + fontsize16 + fontsize24);
+}
+
 typedef struct {
     char id[ID_LEN];
     char name[NAME_LEN];
@@ -1233,7 +1243,7 @@ uint8_t *GetDbcsFont(Bitu code)
 					if (c==code) {
 						memcpy(&jfont_dbcs_16[code * 32], JPNZN16X+p, 32);
 						jfont_cache_dbcs_16[code] = 1;
-						return JPNZN16X+p;
+						return &jfont_dbcs_16[code * 32];
 					}
 					p+=32;
 				}
@@ -41,6 +41,7 @@
 #include "support.h"
 #include "setup.h"
 #include "control.h"
+#include "inputjournal.h"
 #include "SDL.h"
 
 #if defined(_MSC_VER)
@@ -610,6 +611,101 @@ void ClipCursorArea(int16_t& x1, int16_t& x2, int16_t& y1, int16_t& y2,
     }
 }
 
+/* The graphics cursor is saved and drawn a row at a time where the mode allows it, instead of
+ * through INT10_GetPixel/INT10_PutPixel per pixel. In planar EGA/VGA modes that costs a few
+ * register writes per byte rather than per pixel, in 256-color modes it is a block copy. */
+static bool CursorRowFastPath(void) {
+    if (IS_PC98_ARCH) return false;
+    switch (CurMode->type) {
+        case M_VGA:
+        case M_LIN8:
+            return true;
+        case M_EGA:
+            return IS_EGAVGA_ARCH;
+        default:
+            break;
+    }
+    return false;
+}
+
+static PhysPt CursorRowAddress(int16_t x, int16_t y) {
+    const unsigned int pitch = real_readw(BIOSMEM_SEG,BIOSMEM_NB_COLS);
+
+    switch (CurMode->type) {
+        case M_VGA:
+            return PhysMake(0xa000,(uint16_t)((unsigned int)y*320u+(unsigned int)x));
+        case M_LIN8:
+            return S3_LFB_BASE+(unsigned int)y*pitch*8u+(unsigned int)x;
+        default: /* M_EGA, address of the byte holding pixel 0 */
+            return 0xa0000u+(unsigned int)real_readw(BIOSMEM_SEG,BIOSMEM_PAGE_SIZE)*mouse.page+(unsigned int)y*pitch;
+    }
+}
+
+static void CursorGetRow(int16_t x1, int16_t x2, int16_t y, uint8_t *dst) {
+    if (x2 < x1) return;
+    const Bitu count = (Bitu)(x2 - x1 + 1);
+
+    if (CurMode->type != M_EGA) {
+        MEM_BlockRead(CursorRowAddress(x1,y),dst,count);
+        return;
+    }
+
+    const PhysPt base = CursorRowAddress(0,y);
+    memset(dst,0,count);
+    IO_Write(0x3ce,0x4);
+    for (uint8_t plane=0;plane < 4;plane++) {
+        IO_Write(0x3cf,plane); /* read map select */
+        for (int16_t x=x1;x <= x2;) {
+            const uint8_t val = mem_readb(base+((unsigned int)x>>3u));
+            do {
+                dst[x-x1] |= ((val >> (7u-((unsigned int)x&7u))) & 1u) << plane;
+                x++;
+            } while (x <= x2 && (x&7) != 0);
+        }
+    }
+}
+
+static void CursorPutRow(int16_t x1, int16_t x2, int16_t y, const uint8_t *src) {
+    if (x2 < x1) return;
+    const Bitu count = (Bitu)(x2 - x1 + 1);
+
+    if (CurMode->type != M_EGA) {
+        MEM_BlockWrite(CursorRowAddress(x1,y),src,count);
+        return;
+    }
+
+    /* write mode 0, no set/reset: the bit mask selects the pixels, the map mask the plane */
+    const PhysPt base = CursorRowAddress(0,y);
+    IO_Write(0x3ce,0x1); IO_Write(0x3cf,0);
+    IO_Write(0x3ce,0x3); IO_Write(0x3cf,0);
+    if (!IS_VGA_ARCH) { IO_Write(0x3ce,0x5); IO_Write(0x3cf,0); }
+    IO_Write(0x3c4,0x2);
+    IO_Write(0x3ce,0x8);
+    for (int16_t x=x1;x <= x2;) {
+        const PhysPt off = base+((unsigned int)x>>3u);
+        uint8_t planes[4] = {0,0,0,0};
+        uint8_t mask = 0;
+        do {
+            const uint8_t bit = (uint8_t)(0x80u >> ((unsigned int)x&7u));
+            const uint8_t color = src[x-x1];
+            mask |= bit;
+            for (uint8_t plane=0;plane < 4;plane++) {
+                if (color & (1u << plane)) planes[plane] |= bit;
+            }
+            x++;
+        } while (x <= x2 && (x&7) != 0);
+
+        IO_Write(0x3cf,mask);
+        mem_readb(off); /* load the latches, they supply the pixels outside the mask */
+        for (uint8_t plane=0;plane < 4;plane++) {
+            IO_Write(0x3c5,(uint8_t)(1u << plane));
+            mem_writeb(off,planes[plane]);
+        }
+    }
+    IO_Write(0x3cf,0xff);
+    IO_Write(0x3c5,0xf);
+}
+
 static uint16_t pc98_graph_seg[4] = { 0xa800,0xb000,0xb800,0xe000 };
 
 void PC98_XorPixel(uint16_t x, uint16_t y, uint8_t plane)
@@ -675,6 +771,15 @@ void RestoreCursorBackground() {
                 }
                 dataPos += addx2;
             }
+        } else if (CursorRowFastPath()) {
+            for (y=y1; y<=y2; y++) {
+                dataPos += addx1;
+                if (x2 >= x1) {
+                    CursorPutRow(x1, x2, y, &mouse.backData[dataPos]);
+                    dataPos += (uint16_t)(x2 - x1 + 1);
+                }
+                dataPos += addx2;
+            }
         } else {
             for (y=y1; y<=y2; y++) {
                 dataPos += addx1;
@@ -754,7 +859,18 @@ void DrawCursor() {
 
     ClipCursorArea(x1,x2,y1,y2, addx1, addx2, addy);
 
-    if(!pc98_nec_mouse) {
+    const bool fastRows = !pc98_nec_mouse && CursorRowFastPath();
+    if (fastRows) {
+        dataPos = addy * CURSORX;
+        for (y=y1; y<=y2; y++) {
+            dataPos += addx1;
+            if (x2 >= x1) {
+                CursorGetRow(x1, x2, y, &mouse.backData[dataPos]);
+                dataPos += (uint16_t)(x2 - x1 + 1);
+            }
+            dataPos += addx2;
+        }
+    } else if(!pc98_nec_mouse) {
         dataPos = addy * CURSORX;
         for (y=y1; y<=y2; y++) {
             dataPos += addx1;
@@ -770,6 +886,7 @@ void DrawCursor() {
     mouse.backposy  = POS_Y - mouse.hoty;
 
     // Draw Mousecursor
+    uint8_t row[CURSORX];
     dataPos = addy * CURSORX;
     for (y=y1; y<=y2; y++) {
         uint16_t scMask = mouse.screenMask[addy+y-y1];
@@ -788,11 +905,13 @@ void DrawCursor() {
                 if (cuMask & HIGHESTBIT) pixel = pixel ^ 0x0F;
                 cuMask<<=1;
                 // Set Pixel
-                if(IS_PC98_ARCH) PC98_PutPixel((uint16_t)x, (uint16_t)y, pixel);
+                if (fastRows) row[x-x1] = pixel;
+                else if(IS_PC98_ARCH) PC98_PutPixel((uint16_t)x, (uint16_t)y, pixel);
                 else INT10_PutPixel((uint16_t)x,(uint16_t)y,mouse.page,pixel);
             }
             dataPos++;
         }
+        if (fastRows) CursorPutRow(x1, x2, y, row);
         dataPos += addx2;
     }
     RestoreVgaRegisters();
@@ -840,6 +959,9 @@ bool IsDebuggerActive(void);
 
 /* FIXME: Re-test this code */
 void Mouse_CursorMoved(float xrel,float yrel,float x,float y,bool emulate) {
+    if (GCC_UNLIKELY(input_journal_active) && !INPUTJOURNAL_MouseMove(xrel,yrel,x,y,emulate))
+        return;
+
     extern bool Mouse_Vertical;
     float dx = xrel * mouse.pixelPerMickey_x;
     float dy = (Mouse_Vertical?-yrel:yrel) * mouse.pixelPerMickey_y;
@@ -1214,6 +1336,9 @@ void Mouse_Select(int x1, int y1, int x2, int y2, int w, int h, bool select) {
 #endif
 
 void Mouse_ButtonPressed(uint8_t button) {
+    if (GCC_UNLIKELY(input_journal_active) && !INPUTJOURNAL_MouseButton(button,true))
+        return;
+
     if (!IS_PC98_ARCH && KEYBOARD_AUX_Active()) {
         switch (button) {
             case 0:
@@ -1271,6 +1396,9 @@ void Mouse_ButtonPressed(uint8_t button) {
 }
 
 void Mouse_ButtonReleased(uint8_t button) {
+    if (GCC_UNLIKELY(input_journal_active) && !INPUTJOURNAL_MouseButton(button,false))
+        return;
+
     if (!IS_PC98_ARCH && KEYBOARD_AUX_Active()) {
         switch (button) {
             case 0:
@@ -1985,7 +2113,12 @@ static Bitu INT33_Handler(void) {
         LOG(LOG_MOUSE, LOG_NORMAL)("Get sensitivity %d %d", reg_bx, reg_cx);
         break;
     case 0x1c:  /* MS MOUSE v6.0+ - SET INTERRUPT RATE */
-        /* Can't really set a rate this is host determined */
+        /* BX = 1: 30/s  2: 50/s  3: 100/s  4: 200/s. Motion in between is added up, so this only
+         * sets how often the guest hears about it. 0 (no interrupts) is left at the current rate. */
+        {
+            static const unsigned int int33_rates[] = { 0, 30, 50, 100, 200 };
+            if (reg_bx >= 1 && reg_bx <= 4) ChangeMouseReportRate(int33_rates[reg_bx]);
+        }
         break;
     case 0x1d:  /* MS MOUSE v6.0+ - DEFINE DISPLAY PAGE NUMBER */
         mouse.page = reg_bl;
@@ -19,6 +19,12 @@
 
 #include "qcow2_disk.h"
 
+#include <algorithm>
+#include <string.h>
+#if C_LIBZ
+#include <zlib.h>
+#endif
+
 #if defined(_MSC_VER)
 # pragma warning(disable:4244) /* const fmath::local::uint64_t to double possible loss of data */
 #endif
@@ -63,7 +69,7 @@ using namespace std;
 
 
 //Public Constructor.
-	QCow2Image::QCow2Image(QCow2Image::QCow2Header& qcow2Header, FILE *qcow2File, const char* imageName, uint32_t sectorSizeBytes) : file(qcow2File), header(qcow2Header), sector_size(sectorSizeBytes), backing_image(NULL)
+	QCow2Image::QCow2Image(QCow2Image::QCow2Header& qcow2Header, FILE *qcow2File, const char* imageName, uint32_t sectorSizeBytes) : file(qcow2File), header(qcow2Header), sector_size(sectorSizeBytes), backing_image(NULL), file_end(0), compressed_entry(0)
 	{
 		cluster_mask = mask64(header.cluster_bits);
 		cluster_size = cluster_mask + 1;
@@ -73,6 +79,12 @@ using namespace std;
 		l1_bits = header.cluster_bits + l2_bits;
 		refcount_bits = header.cluster_bits - 1;
 		refcount_mask = mask64(refcount_bits);
+		if (0 != load_table(header.l1_table_offset, header.l1_size, l1_table)){
+			LOG(LOG_IO, LOG_ERROR) ("Failed to read QCow2 L1 table\n");
+		}
+		if (0 != load_table(header.refcount_table_offset, (uint64_t)header.refcount_table_clusters * cluster_size / 8, refcount_table)){
+			LOG(LOG_IO, LOG_ERROR) ("Failed to read QCow2 refcount table\n");
+		}
 		if (header.backing_file_offset != 0 && header.backing_file_size != 0){
 			char* backing_file_name = new char[header.backing_file_size + 1];
 			backing_file_name[header.backing_file_size] = 0;
@@ -124,96 +136,185 @@ using namespace std;
 
 //Public function to a read a sector.
 	uint8_t QCow2Image::read_sector(uint32_t sectnum, uint8_t* data){
-		const uint64_t address = (uint64_t)sectnum * sector_size;
-		if (address >= header.size){
-			return 0x05;
-		}
-		uint64_t l2_table_offset;
-		if (0 != read_l1_table(address, l2_table_offset)){
-			return 0x05;
-		}
-		if (0 == l2_table_offset){
-			return read_unallocated_sector(sectnum, data);
-		}
-		uint64_t data_cluster_offset;
-		if (0 != read_l2_table(l2_table_offset, address, data_cluster_offset)){
-			return 0x05;
-		}
-		if (0 == data_cluster_offset){
-			return read_unallocated_sector(sectnum, data);
-		}
-		return read_allocated_data(data_cluster_offset + (address & cluster_mask), data, sector_size);
+		return read_sectors(sectnum, 1, data);
 	}
 
 
-//Public function to a write a sector.
-	uint8_t QCow2Image::write_sector(uint32_t sectnum, const uint8_t* data){
-		const uint64_t address = (uint64_t)sectnum * sector_size;
-		if (address >= header.size){
-			return 0x05;
-		}
-		uint64_t l2_table_offset;
-		if (0 != read_l1_table(address, l2_table_offset)){
-			return 0x05;
-		}
-		if (0 == l2_table_offset){
-			if (0 != pad_file(l2_table_offset)){
+//Public function to read a run of sectors, merging clusters that are contiguous in the image file into one read.
+	uint8_t QCow2Image::read_sectors(uint32_t sectnum, uint32_t count, uint8_t* data){
+		while (count > 0){
+			const uint64_t address = (uint64_t)sectnum * sector_size;
+			if (address >= header.size){
 				return 0x05;
 			}
-			if (0 != write_l1_table_entry(address, l2_table_offset)){
-				return 0x05;
+			uint32_t run = (uint32_t)std::min<uint64_t>(count, (cluster_size - (address & cluster_mask)) / sector_size);
+			if (run == 0){
+				run = 1;
 			}
-			uint8_t* cluster_buffer = new uint8_t[cluster_size];
-			std::fill(cluster_buffer, cluster_buffer + cluster_size, 0);
-			if (0 != write_data(l2_table_offset, cluster_buffer, cluster_size)){
-				delete[] cluster_buffer;
+			uint64_t l2_table_offset, l2_entry;
+			if (0 != lookup_cluster(address, l2_table_offset, l2_entry)){
 				return 0x05;
 			}
-			if (0 != update_reference_count(l2_table_offset, cluster_buffer)){
-				delete[] cluster_buffer;
-				return 0x05;
+			const uint64_t data_cluster_offset = l2_entry & cluster_offset_mask;
+			if (0 != (l2_entry & compressed_flag)){
+				if (0 != read_compressed_data(l2_entry, address & cluster_mask, data, (uint64_t)run * sector_size)){
+					return 0x05;
+				}
 			}
-			delete[] cluster_buffer;
-		}
-		uint64_t data_cluster_offset;
-		if (0 != read_l2_table(l2_table_offset, address, data_cluster_offset)){
-			return 0x05;
+			else if (0 == data_cluster_offset){
+				if (backing_image == NULL){
+					std::fill(data, data + (uint64_t)run * sector_size, 0);
+				}
+				else if (0 != backing_image->read_sectors(sectnum, run, data)){
+					return 0x05;
+				}
+			}
+			else {
+				//Extend the run over following clusters that directly follow this one in the image file.
+				uint64_t next_offset = data_cluster_offset + cluster_size;
+				while (run < count){
+					const uint64_t next_address = address + (uint64_t)run * sector_size;
+					uint64_t next_entry;
+					if (next_address >= header.size || 0 != lookup_cluster(next_address, l2_table_offset, next_entry)){
+						break;
+					}
+					if (0 != (next_entry & compressed_flag) || next_offset != (next_entry & cluster_offset_mask)){
+						break;
+					}
+					run += (uint32_t)std::min<uint64_t>(count - run, sectors_per_cluster);
+					next_offset += cluster_size;
+				}
+				if (0 != read_allocated_data(data_cluster_offset + (address & cluster_mask), data, (uint64_t)run * sector_size)){
+					return 0x05;
+				}
+			}
+			sectnum += run;
+			count -= run;
+			data += (uint64_t)run * sector_size;
 		}
-		if (data_cluster_offset == 0){
-			if (0 != pad_file(data_cluster_offset)){
+		return 0;
+	}
+
+
+//Public function to a write a sector.
+	uint8_t QCow2Image::write_sector(uint32_t sectnum, const uint8_t* data){
+		return write_sectors(sectnum, 1, data);
+	}
+
+
+//Public function to write a run of sectors. Clusters that have to be allocated are allocated together and written with one write.
+	uint8_t QCow2Image::write_sectors(uint32_t sectnum, uint32_t count, const uint8_t* data){
+		const uint64_t max_batch_clusters = std::max<uint64_t>(1, (1024 * 1024) / cluster_size);
+		while (count > 0){
+			const uint64_t address = (uint64_t)sectnum * sector_size;
+			if (address >= header.size){
 				return 0x05;
 			}
-			if (0 != write_l2_table_entry(l2_table_offset, address, data_cluster_offset)){
-				return 0x05;
+			const uint64_t cluster_offset = address & cluster_mask;
+			uint32_t run = (uint32_t)std::min<uint64_t>(count, (cluster_size - cluster_offset) / sector_size);
+			if (run == 0){
+				run = 1;
 			}
-			uint8_t* cluster_buffer = new uint8_t[cluster_size];
-			if ( 0 != read_unallocated_cluster(address/cluster_size, cluster_buffer)){
-				delete[] cluster_buffer;
+			uint64_t l2_table_offset, l2_entry;
+			if (0 != lookup_cluster(address, l2_table_offset, l2_entry)){
 				return 0x05;
 			}
-			const uint64_t cluster_buffer_sector_offset = address & cluster_mask;
-			for (uint64_t i = 0; i < sector_size; i++){
-				cluster_buffer[cluster_buffer_sector_offset + i] = data[i];
+			if (0 == l2_table_offset){
+				if (0 != allocate_clusters(1, l2_table_offset)){
+					return 0x05;
+				}
+				std::vector<uint8_t> zero_cluster(cluster_size, 0);
+				if (0 != write_data(l2_table_offset, zero_cluster.data(), cluster_size)){
+					return 0x05;
+				}
+				if (0 != update_reference_count(l2_table_offset, 1)){
+					return 0x05;
+				}
+				if (0 != write_l1_table_entry(address, l2_table_offset)){
+					return 0x05;
+				}
+				l2_entry = 0;
 			}
-			if (0 != write_data(data_cluster_offset, cluster_buffer, cluster_size)){
-				delete[] cluster_buffer;
-				return 0x05;
+			if (0 == (l2_entry & compressed_flag) && 0 != (l2_entry & cluster_offset_mask)){
+				//Allocated cluster, write in place. Extend the run over clusters that directly follow it in the image file.
+				const uint64_t data_cluster_offset = l2_entry & cluster_offset_mask;
+				uint64_t next_offset = data_cluster_offset + cluster_size;
+				while (run < count){
+					const uint64_t next_address = address + (uint64_t)run * sector_size;
+					uint64_t next_table, next_entry;
+					if (next_address >= header.size || 0 != lookup_cluster(next_address, next_table, next_entry)){
+						break;
+					}
+					if (0 != (next_entry & compressed_flag) || next_offset != (next_entry & cluster_offset_mask)){
+						break;
+					}
+					run += (uint32_t)std::min<uint64_t>(count - run, sectors_per_cluster);
+					next_offset += cluster_size;
+				}
+				if (0 != write_data(data_cluster_offset + cluster_offset, data, (uint64_t)run * sector_size)){
+					return 0x05;
+				}
 			}
-			if (0 != update_reference_count(data_cluster_offset, cluster_buffer)){
-				delete[] cluster_buffer;
-				return 0x05;
+			else {
+				//Unallocated or compressed cluster. Take in the following unallocated clusters that share the L2 table
+				//and allocate them all at the end of the file.
+				const uint64_t first_address = address - cluster_offset;
+				uint64_t clusters = 1;
+				while (run < count && clusters < max_batch_clusters){
+					const uint64_t next_address = first_address + clusters * cluster_size;
+					uint64_t next_table, next_entry;
+					if (next_address >= header.size || (next_address >> l1_bits) != (address >> l1_bits)){
+						break;
+					}
+					if (0 != lookup_cluster(next_address, next_table, next_entry) || 0 != (next_entry & (compressed_flag | cluster_offset_mask))){
+						break;
+					}
+					run += (uint32_t)std::min<uint64_t>(count - run, sectors_per_cluster);
+					clusters++;
+				}
+				const uint64_t run_end = cluster_offset + (uint64_t)run * sector_size;
+				std::vector<uint8_t> buffer(clusters * cluster_size);
+				if (0 != cluster_offset || run_end < cluster_size){
+					if (0 != read_existing_cluster(first_address, l2_entry, buffer.data())){
+						return 0x05;
+					}
+				}
+				if (clusters > 1 && 0 != (run_end & cluster_mask)){
+					if (0 != read_existing_cluster(first_address + (clusters - 1) * cluster_size, 0, buffer.data() + (clusters - 1) * cluster_size)){
+						return 0x05;
+					}
+				}
+				std::copy(data, data + (uint64_t)run * sector_size, buffer.begin() + cluster_offset);
+				uint64_t data_cluster_offset;
+				if (0 != allocate_clusters(clusters, data_cluster_offset)){
+					return 0x05;
+				}
+				if (0 != write_data(data_cluster_offset, buffer.data(), buffer.size())){
+					return 0x05;
+				}
+				if (0 != update_reference_count(data_cluster_offset, clusters)){
+					return 0x05;
+				}
+				if (0 != write_l2_table_entries(l2_table_offset, address, clusters, data_cluster_offset)){
+					return 0x05;
+				}
+				if (0 != (l2_entry & compressed_flag) && 0 != release_compressed_cluster(l2_entry)){
+					return 0x05;
+				}
 			}
-			delete[] cluster_buffer;
-			return 0;
+			sectnum += run;
+			count -= run;
+			data += (uint64_t)run * sector_size;
 		}
-		return write_data(data_cluster_offset + (address & cluster_mask), data, sector_size);
+		return 0;
 	}
 
 
 //Private constants.
 	const uint64_t QCow2Image::copy_flag = 0x8000000000000000;
-	const uint64_t QCow2Image::empty_mask = 0xFFFFFFFFFFFFFFFF;
+	const uint64_t QCow2Image::compressed_flag = 0x4000000000000000;
 	const uint64_t QCow2Image::table_entry_mask = 0x00FFFFFFFFFFFFFF;
+	const uint64_t QCow2Image::cluster_offset_mask = 0x00FFFFFFFFFFFE00;
 
 
 //Helper functions for endianness. QCOW format is big endian so we need different functions than those defined in mem.h.
@@ -294,57 +395,175 @@ using namespace std;
 		if (address >= header.size){
 			return 0x05;
 		}
-		uint64_t l2_table_offset;
-		if (0 != read_l1_table(address, l2_table_offset)){
+		uint64_t l2_table_offset, l2_entry;
+		if (0 != lookup_cluster(address, l2_table_offset, l2_entry)){
 			return 0x05;
 		}
-		if (0 == l2_table_offset){
-			return read_unallocated_cluster(data_cluster_number, data);
+		return read_existing_cluster(address, l2_entry, data);
+	}
+
+
+//Read a big endian table of 64 bit entries from the image file into host byte order.
+	uint8_t QCow2Image::load_table(uint64_t file_offset, uint64_t entries, std::vector<uint64_t>& table){
+		table.resize(entries);
+		if (0 == entries){
+			return 0;
 		}
-		uint64_t data_cluster_offset;
-		if (0 != read_l2_table(l2_table_offset, address, data_cluster_offset)){
+		if (0 != read_allocated_data(file_offset, (uint8_t*)table.data(), entries * sizeof(uint64_t))){
+			table.clear();
 			return 0x05;
 		}
-		if (0 == data_cluster_offset){
-			return read_unallocated_cluster(data_cluster_number, data);
+		for (uint64_t i = 0; i < entries; i++){
+			table[i] = host_read64(table[i]);
 		}
-		return read_allocated_data(data_cluster_offset, data, cluster_size);
+		return 0;
 	}
 
 
-//Read the L1 table to get the offset of the L2 table for a given address.
-	inline uint8_t QCow2Image::read_l1_table(uint64_t address, uint64_t& l2_table_offset){
-		const uint64_t l1_entry_offset = header.l1_table_offset + ((address >> l1_bits) << 3);
-		return read_table(l1_entry_offset, table_entry_mask, l2_table_offset);
+//Reserve a run of clusters at the end of the image file.
+	uint8_t QCow2Image::allocate_clusters(uint64_t count, uint64_t& cluster_offset){
+		if (0 == file_end && 0 != pad_file(file_end)){
+			return 0x05;
+		}
+		cluster_offset = file_end;
+		file_end += count * cluster_size;
+		return 0;
 	}
 
 
-//Read an L2 table to get the offset of the data cluster for a given address.
-	inline uint8_t QCow2Image::read_l2_table(uint64_t l2_table_offset, uint64_t address, uint64_t& data_cluster_offset){
-		const uint64_t l2_entry_offset = l2_table_offset + (((address >> header.cluster_bits) & l2_mask) << 3);
-		return read_table(l2_entry_offset, table_entry_mask, data_cluster_offset);
+//Get an L2 table from the cache, loading it (and evicting the least recently used one) if needed.
+	uint8_t QCow2Image::get_l2_table(uint64_t l2_table_offset, std::vector<uint64_t>*& table){
+		for (std::list< CachedTable<uint64_t> >::iterator i = l2_cache.begin(); i != l2_cache.end(); ++i){
+			if (i->offset == l2_table_offset){
+				if (i != l2_cache.begin()){
+					l2_cache.splice(l2_cache.begin(), l2_cache, i);
+				}
+				table = &l2_cache.front().entries;
+				return 0;
+			}
+		}
+		CachedTable<uint64_t> entry;
+		entry.offset = l2_table_offset;
+		if (0 != load_table(l2_table_offset, cluster_size / sizeof(uint64_t), entry.entries)){
+			return 0x05;
+		}
+		if (l2_cache.size() >= l2_cache_tables){
+			l2_cache.pop_back();
+		}
+		l2_cache.push_front(std::move(entry));
+		table = &l2_cache.front().entries;
+		return 0;
 	}
 
 
-//Read the refcount table to get the offset of the refcount cluster for a given address.
-	inline uint8_t QCow2Image::read_refcount_table(uint64_t data_cluster_offset, uint64_t& refcount_cluster_offset){
-		const uint64_t refcount_entry_offset = header.refcount_table_offset + (((data_cluster_offset/cluster_size) >> refcount_bits) << 3);
-		return read_table(refcount_entry_offset, empty_mask, refcount_cluster_offset);
+//Get a refcount block from the cache, loading it (and evicting the least recently used one) if needed.
+	uint8_t QCow2Image::get_refcount_block(uint64_t refcount_cluster_offset, std::vector<uint16_t>*& block){
+		for (std::list< CachedTable<uint16_t> >::iterator i = refcount_cache.begin(); i != refcount_cache.end(); ++i){
+			if (i->offset == refcount_cluster_offset){
+				if (i != refcount_cache.begin()){
+					refcount_cache.splice(refcount_cache.begin(), refcount_cache, i);
+				}
+				block = &refcount_cache.front().entries;
+				return 0;
+			}
+		}
+		CachedTable<uint16_t> entry;
+		entry.offset = refcount_cluster_offset;
+		entry.entries.resize(cluster_size / sizeof(uint16_t));
+		if (0 != read_allocated_data(refcount_cluster_offset, (uint8_t*)entry.entries.data(), cluster_size)){
+			return 0x05;
+		}
+		for (size_t i = 0; i < entry.entries.size(); i++){
+			entry.entries[i] = host_read16(entry.entries[i]);
+		}
+		if (refcount_cache.size() >= refcount_cache_blocks){
+			refcount_cache.pop_back();
+		}
+		refcount_cache.push_front(std::move(entry));
+		block = &refcount_cache.front().entries;
+		return 0;
 	}
 
 
-//Read a table entry at the given offset.
-	inline uint8_t QCow2Image::read_table(uint64_t entry_offset, uint64_t entry_mask, uint64_t& entry_value){
-        (void)entry_mask;//UNUSED
-		uint64_t buffer;
-		if (0 != read_allocated_data(entry_offset, (uint8_t*)&buffer, sizeof buffer)){
+//Find the L2 table and L2 entry for a given address. Both are 0 if not allocated.
+	uint8_t QCow2Image::lookup_cluster(uint64_t address, uint64_t& l2_table_offset, uint64_t& l2_entry){
+		const uint64_t l1_index = address >> l1_bits;
+		l2_table_offset = 0;
+		l2_entry = 0;
+		if (l1_index >= l1_table.size()){
 			return 0x05;
 		}
-		entry_value = host_read64(buffer) & table_entry_mask;
+		l2_table_offset = l1_table[l1_index] & cluster_offset_mask;
+		if (0 == l2_table_offset){
+			return 0;
+		}
+		std::vector<uint64_t>* table;
+		if (0 != get_l2_table(l2_table_offset, table)){
+			return 0x05;
+		}
+		l2_entry = (*table)[(address >> header.cluster_bits) & l2_mask];
 		return 0;
 	}
 
 
+//Read from a compressed cluster. The most recently inflated cluster is kept around for the following sectors.
+	uint8_t QCow2Image::read_compressed_data(uint64_t l2_entry, uint64_t offset, uint8_t* data, uint64_t data_size){
+#if C_LIBZ
+		if (compressed_entry != l2_entry || compressed_data.size() != cluster_size){
+			const uint64_t offset_bits = 62 - (header.cluster_bits - 8);
+			const uint64_t host_offset = l2_entry & mask64(offset_bits);
+			const uint64_t sectors = ((l2_entry >> offset_bits) & mask64(header.cluster_bits - 8)) + 1;
+			std::vector<uint8_t> deflated(sectors * 512 - (host_offset & 511));
+			if (0 != fseeko64(file, (off_t)host_offset, SEEK_SET)){
+				return 0x05;
+			}
+			/* the last compressed cluster may end before the sector count says */
+			const size_t length = fread(deflated.data(), 1, deflated.size(), file);
+			clearerr(file);
+			compressed_entry = 0;
+			compressed_data.resize(cluster_size);
+			z_stream stream;
+			memset(&stream, 0, sizeof(stream));
+			if (Z_OK != inflateInit2(&stream, -12)){
+				return 0x05;
+			}
+			stream.next_in = deflated.data();
+			stream.avail_in = (uInt)length;
+			stream.next_out = compressed_data.data();
+			stream.avail_out = (uInt)cluster_size;
+			const int result = inflate(&stream, Z_FINISH);
+			inflateEnd(&stream);
+			if ((result != Z_STREAM_END && result != Z_BUF_ERROR) || 0 != stream.avail_out){
+				LOG(LOG_IO, LOG_ERROR) ("Failed to inflate QCow2 compressed cluster\n");
+				return 0x05;
+			}
+			compressed_entry = l2_entry;
+		}
+		std::copy(compressed_data.begin() + offset, compressed_data.begin() + offset + data_size, data);
+		return 0;
+#else
+		(void)l2_entry;
+		(void)offset;
+		(void)data;
+		(void)data_size;
+		LOG(LOG_IO, LOG_ERROR) ("QCow2 compressed clusters need zlib support\n");
+		return 0x05;
+#endif
+	}
+
+
+//Read an entire cluster given its L2 entry, whether allocated, compressed or unallocated.
+	uint8_t QCow2Image::read_existing_cluster(uint64_t address, uint64_t l2_entry, uint8_t* data){
+		if (0 != (l2_entry & compressed_flag)){
+			return read_compressed_data(l2_entry, 0, data, cluster_size);
+		}
+		if (0 != (l2_entry & cluster_offset_mask)){
+			return read_allocated_data(l2_entry & cluster_offset_mask, data, cluster_size);
+		}
+		return read_unallocated_cluster(address / cluster_size, data);
+	}
+
+
 //Read a cluster not currently allocated in the image file.
 	inline uint8_t QCow2Image::read_unallocated_cluster(uint64_t data_cluster_number, uint8_t* data)
 	{
@@ -356,36 +575,73 @@ using namespace std;
 	}
 
 
-//Read a sector not currently allocated in the image file.
-	inline uint8_t QCow2Image::read_unallocated_sector(uint32_t sectnum, uint8_t* data){
-		if(backing_image == NULL){
-			std::fill(data, data+sector_size, 0);
-			return 0;
+//Drop the references a replaced compressed cluster held on the host clusters its data spans.
+//Several compressed clusters may share a host cluster, so each refcount is decremented rather than cleared.
+	uint8_t QCow2Image::release_compressed_cluster(uint64_t l2_entry){
+		const uint64_t offset_bits = 62 - (header.cluster_bits - 8);
+		const uint64_t host_offset = l2_entry & mask64(offset_bits) & ~(uint64_t)511;
+		const uint64_t sectors = ((l2_entry >> offset_bits) & mask64(header.cluster_bits - 8)) + 1;
+		const uint64_t last_cluster = (host_offset + sectors * 512 - 1) / cluster_size;
+		if (compressed_entry == l2_entry){
+			compressed_entry = 0;
+		}
+		for (uint64_t cluster_index = host_offset / cluster_size; cluster_index <= last_cluster; cluster_index++){
+			const uint64_t refcount_table_index = cluster_index >> refcount_bits;
+			if (refcount_table_index >= refcount_table.size()){
+				return 0x05;
+			}
+			const uint64_t refcount_cluster_offset = refcount_table[refcount_table_index] & table_entry_mask;
+			if (0 == refcount_cluster_offset){
+				return 0x05;
+			}
+			std::vector<uint16_t>* block;
+			if (0 != get_refcount_block(refcount_cluster_offset, block)){
+				return 0x05;
+			}
+			const uint16_t refcount = (*block)[cluster_index & refcount_mask];
+			if (0 == refcount){
+				LOG(LOG_IO, LOG_WARN) ("QCow2 compressed cluster at %llu already has a refcount of 0\n", (unsigned long long)(cluster_index * cluster_size));
+				continue;
+			}
+			if (0 != write_refcounts(cluster_index * cluster_size, 1, refcount_cluster_offset, refcount - 1)){
+				return 0x05;
+			}
 		}
-		return backing_image->read_sector(sectnum, data);
+		return 0;
 	}
 
-//Update the reference count for a cluster.
-	uint8_t QCow2Image::update_reference_count(uint64_t cluster_offset, uint8_t* cluster_buffer){
-		uint64_t refcount_cluster_offset;
-		if (0 != read_refcount_table(cluster_offset, refcount_cluster_offset)){
-			return 0x05;
-		}
-		if (0 == refcount_cluster_offset){
-			refcount_cluster_offset = cluster_offset + cluster_size;
-			std::fill(cluster_buffer, cluster_buffer + cluster_size, 0);
-			if (0 != write_refcount_table_entry(cluster_offset, refcount_cluster_offset)){
+
+//Set the reference count of a run of newly allocated clusters to 1, allocating refcount blocks as needed.
+	uint8_t QCow2Image::update_reference_count(uint64_t cluster_offset, uint64_t count){
+		while (count > 0){
+			const uint64_t cluster_index = cluster_offset / cluster_size;
+			const uint64_t refcount_table_index = cluster_index >> refcount_bits;
+			if (refcount_table_index >= refcount_table.size()){
+				LOG(LOG_IO, LOG_ERROR) ("QCow2 refcount table is full\n");
 				return 0x05;
 			}
-			if (0 != write_data(refcount_cluster_offset, cluster_buffer, cluster_size)){
-			return 0x05;
+			uint64_t refcount_cluster_offset = refcount_table[refcount_table_index] & table_entry_mask;
+			if (0 == refcount_cluster_offset){
+				if (0 != allocate_clusters(1, refcount_cluster_offset)){
+					return 0x05;
+				}
+				std::vector<uint8_t> zero_cluster(cluster_size, 0);
+				if (0 != write_data(refcount_cluster_offset, zero_cluster.data(), cluster_size)){
+					return 0x05;
+				}
+				if (0 != write_refcount_table_entry(cluster_offset, refcount_cluster_offset)){
+					return 0x05;
+				}
+				if (0 != update_reference_count(refcount_cluster_offset, 1)){
+					return 0x05;
+				}
 			}
-			if (0 != write_refcount(refcount_cluster_offset, refcount_cluster_offset, 0x1)){
+			const uint64_t block_count = std::min<uint64_t>(count, refcount_mask + 1 - (cluster_index & refcount_mask));
+			if (0 != write_refcounts(cluster_offset, block_count, refcount_cluster_offset, 0x1)){
 				return 0x05;
 			}
-		}
-		if (0 != write_refcount(cluster_offset, refcount_cluster_offset, 0x1)){
-			return 0x05;
+			cluster_offset += block_count * cluster_size;
+			count -= block_count;
 		}
 		return 0;
 	}
@@ -405,30 +661,49 @@ using namespace std;
 
 //Write an L2 table offset into the L1 table.
 	inline uint8_t QCow2Image::write_l1_table_entry(uint64_t address, uint64_t l2_table_offset){
-		const uint64_t l1_entry_offset = header.l1_table_offset + ((address >> l1_bits) << 3);
-		return write_table_entry(l1_entry_offset, l2_table_offset | copy_flag);
+		const uint64_t l1_index = address >> l1_bits;
+		l1_table[l1_index] = l2_table_offset | copy_flag;
+		return write_table_entry(header.l1_table_offset + (l1_index << 3), l1_table[l1_index]);
 	}
 
 
-//Write a data cluster offset into an L2 table.
-	inline uint8_t QCow2Image::write_l2_table_entry(uint64_t l2_table_offset, uint64_t address, uint64_t data_cluster_offset){
-		const uint64_t l2_entry_offset = l2_table_offset + (((address >> header.cluster_bits) & l2_mask) << 3);
-		return write_table_entry(l2_entry_offset, data_cluster_offset | copy_flag);
+//Write the offsets of a run of contiguous data clusters into an L2 table.
+	uint8_t QCow2Image::write_l2_table_entries(uint64_t l2_table_offset, uint64_t address, uint64_t count, uint64_t data_cluster_offset){
+		std::vector<uint64_t>* table;
+		if (0 != get_l2_table(l2_table_offset, table)){
+			return 0x05;
+		}
+		const uint64_t l2_index = (address >> header.cluster_bits) & l2_mask;
+		std::vector<uint64_t> buffer(count);
+		for (uint64_t i = 0; i < count; i++){
+			(*table)[l2_index + i] = (data_cluster_offset + i * cluster_size) | copy_flag;
+			buffer[i] = host_read64((*table)[l2_index + i]);
+		}
+		return write_data(l2_table_offset + (l2_index << 3), (uint8_t*)buffer.data(), count * sizeof(uint64_t));
 	}
 
 
-//Write a refcount.
-	inline uint8_t QCow2Image::write_refcount(uint64_t cluster_offset, uint64_t refcount_cluster_offset, uint16_t refcount){
-		const uint64_t refcount_offset = refcount_cluster_offset + (((cluster_offset/cluster_size) & refcount_mask) << 1);
-		uint16_t buffer = host_read16(refcount);
-		return write_data(refcount_offset, (uint8_t*)&buffer, sizeof buffer);
+//Write the refcounts of a run of clusters that share a refcount block.
+	uint8_t QCow2Image::write_refcounts(uint64_t cluster_offset, uint64_t count, uint64_t refcount_cluster_offset, uint16_t refcount){
+		std::vector<uint16_t>* block;
+		if (0 != get_refcount_block(refcount_cluster_offset, block)){
+			return 0x05;
+		}
+		const uint64_t refcount_index = (cluster_offset / cluster_size) & refcount_mask;
+		std::vector<uint16_t> buffer(count);
+		for (uint64_t i = 0; i < count; i++){
+			(*block)[refcount_index + i] = refcount;
+			buffer[i] = host_read16(refcount);
+		}
+		return write_data(refcount_cluster_offset + (refcount_index << 1), (uint8_t*)buffer.data(), count * sizeof(uint16_t));
 	}
 
 
 //Write a refcount table entry.
 	inline uint8_t QCow2Image::write_refcount_table_entry(uint64_t cluster_offset, uint64_t refcount_cluster_offset){
-		const uint64_t refcount_entry_offset = header.refcount_table_offset + (((cluster_offset/cluster_size) >> refcount_bits) << 3);
-		return write_table_entry(refcount_entry_offset, refcount_cluster_offset);
+		const uint64_t refcount_table_index = (cluster_offset / cluster_size) >> refcount_bits;
+		refcount_table[refcount_table_index] = refcount_cluster_offset;
+		return write_table_entry(header.refcount_table_offset + (refcount_table_index << 3), refcount_cluster_offset);
 	}
 
 
@@ -455,7 +730,19 @@ using namespace std;
 	}
 
 
+//Public function to read a run of sectors.
+	uint8_t QCow2Disk::Read_AbsoluteSectors(uint32_t sectnum, uint32_t count, void* data){
+		return qcowImage.read_sectors(sectnum, count, (uint8_t*)data);
+	}
+
+
 //Public function to a write a sector.
 	uint8_t QCow2Disk::Write_AbsoluteSector(uint32_t sectnum,const void* data){
 		return qcowImage.write_sector(sectnum, (const uint8_t*)data);
 	}
+
+
+//Public function to write a run of sectors.
+	uint8_t QCow2Disk::Write_AbsoluteSectors(uint32_t sectnum, uint32_t count, const void* data){
+		return qcowImage.write_sectors(sectnum, count, (const uint8_t*)data);
+	}
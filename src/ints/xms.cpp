@@ -328,7 +328,7 @@ Bitu XMS_MoveMemory(PhysPt bpt) {
 			LOG(LOG_MISC,LOG_DEBUG)("XMS: Memory move/copy is enabling flat real mode");
 		}
 
-		mem_memcpy(destpt,srcpt,length);
+		MEM_BlockMove(destpt,srcpt,length);
 
 		xms_local_enable_count--;
 		if (!a20_was_enabled) XMS_EnableA20(false);
@@ -31,6 +31,26 @@
  */
 #define ZIP_READBUFSIZE   (16 * 1024)
 
+/*
+ * Deflated entries are read through a cache of decompressed blocks of
+ *  ZIP_BLOCKSIZE bytes, shared by all files opened from the archive, so
+ *  seeking back does not decompress the same data again and again. A block
+ *  that is not cached is decompressed from the nearest checkpoint before it:
+ *  a copy of the inflate state taken every few hundred KB the first time the
+ *  entry is decompressed that far, so no seek has to start over from the
+ *  beginning of a large entry. Entries with "traditional" encryption are
+ *  decompressed directly, as the crypto keys would have to be saved too.
+ *
+ * The checkpoint interval is doubled for large entries so that they get no
+ *  more than ZIP_MAX_CHECKPOINTS checkpoints, and an archive stops taking new
+ *  checkpoints once they use ZIP_CHECKPOINT_MEMORY bytes.
+ */
+#define ZIP_BLOCKSIZE             (32 * 1024)
+#define ZIP_BLOCK_CACHE_COUNT     64
+#define ZIP_CHECKPOINT_INTERVAL   (256 * 1024)
+#define ZIP_MAX_CHECKPOINTS       64
+#define ZIP_CHECKPOINT_MEMORY     (32 * 1024 * 1024)
+
 
 /*
  * Entries are "unresolved" until they are first opened. At that time,
@@ -70,8 +90,33 @@ typedef struct _ZIPentry
     PHYSFS_uint64 uncompressed_size;    /* uncompressed size              */
     PHYSFS_sint64 last_mod_time;        /* last file mod time             */
     PHYSFS_uint32 dos_mod_time;         /* original MS-DOS style mod time */
+    struct _ZIPcheckpoint **checkpoints; /* NULL or ZIP_MAX_CHECKPOINTS   */
+    PHYSFS_uint32 checkpoint_count;     /* checkpoints taken so far       */
+    struct _ZIPentry *next_checkpointed; /* list of entries to clean up   */
 } ZIPentry;
 
+/*
+ * Inflate state at (k + 1) checkpoint intervals into an entry, where k is
+ *  the index in (entry->checkpoints).
+ */
+typedef struct _ZIPcheckpoint
+{
+    PHYSFS_uint32 compressed_position;  /* input consumed by (state).     */
+    inflate_state state;                /* miniz state, incl. dictionary  */
+} ZIPcheckpoint;
+
+/*
+ * One decompressed block of an entry, in the archive's block cache.
+ */
+typedef struct
+{
+    ZIPentry *entry;                    /* NULL if unused.                */
+    PHYSFS_uint32 index;                /* offset / ZIP_BLOCKSIZE.        */
+    PHYSFS_uint32 length;               /* short at the end of the entry. */
+    PHYSFS_uint32 last_use;             /* for least recently used.       */
+    PHYSFS_uint8 *data;
+} ZIPblock;
+
 /*
  * One ZIPinfo is kept for each open ZIP archive.
  */
@@ -81,6 +126,11 @@ typedef struct
     PHYSFS_Io *io;            /* the i/o interface for this archive.    */
     int zip64;                /* non-zero if this is a Zip64 archive.   */
     int has_crypto;           /* non-zero if any entry uses encryption. */
+    void *cache_lock;         /* protects blocks and checkpoints.       */
+    ZIPblock blocks[ZIP_BLOCK_CACHE_COUNT];
+    PHYSFS_uint32 block_clock;
+    ZIPentry *checkpointed;   /* entries with checkpoints.              */
+    PHYSFS_uint64 checkpoint_bytes;
 } ZIPinfo;
 
 /*
@@ -88,10 +138,12 @@ typedef struct
  */
 typedef struct
 {
+    ZIPinfo *info;                        /* archive, for the caches.   */
     ZIPentry *entry;                      /* Info on file.              */
     PHYSFS_Io *io;                        /* physical file handle.      */
     PHYSFS_uint32 compressed_position;    /* offset in compressed data. */
     PHYSFS_uint32 uncompressed_position;  /* tell() position.           */
+    PHYSFS_uint32 stream_position;        /* output of (stream) so far. */
     PHYSFS_uint8 *buffer;                 /* decompression buffer.      */
     PHYSFS_uint32 crypto_keys[3];         /* for "traditional" crypto.  */
     PHYSFS_uint32 initial_crypto_keys[3]; /* for "traditional" crypto.  */
@@ -299,6 +351,269 @@ static int readui16(PHYSFS_Io *io, PHYSFS_uint16 *val)
 } /* readui16 */
 
 
+/*
+ * Decompress the next (len) bytes of the stream into (buf).
+ */
+static PHYSFS_sint64 zip_inflate(ZIPfileinfo *finfo, void *buf, PHYSFS_uint64 len)
+{
+    ZIPentry *entry = finfo->entry;
+    PHYSFS_sint64 retval = 0;
+
+    finfo->stream.next_out = (unsigned char *)buf;
+    finfo->stream.avail_out = (uInt) len;
+
+    while (retval < (PHYSFS_sint64) len)
+    {
+        const PHYSFS_uint32 before = (PHYSFS_uint32) finfo->stream.total_out;
+        int rc;
+
+        if (finfo->stream.avail_in == 0)
+        {
+            PHYSFS_sint64 br;
+
+            br = entry->compressed_size - finfo->compressed_position;
+            if (br > 0)
+            {
+                if (br > ZIP_READBUFSIZE)
+                    br = ZIP_READBUFSIZE;
+
+                br = zip_read_decrypt(finfo, finfo->buffer, (PHYSFS_uint64) br);
+                if (br <= 0)
+                    break;
+
+                finfo->compressed_position += (PHYSFS_uint32) br;
+                finfo->stream.next_in = finfo->buffer;
+                finfo->stream.avail_in = (unsigned int) br;
+            } /* if */
+        } /* if */
+
+        rc = zlib_err(inflate(&finfo->stream, Z_SYNC_FLUSH));
+        retval += (finfo->stream.total_out - before);
+
+        if (rc != Z_OK)
+            break;
+    } /* while */
+
+    if (retval > 0)
+        finfo->stream_position += (PHYSFS_uint32) retval;
+
+    return retval;
+} /* zip_inflate */
+
+
+/*
+ * Start the stream over at the beginning of the entry.
+ */
+static int zip_restart_inflate(ZIPfileinfo *finfo)
+{
+    ZIPentry *entry = finfo->entry;
+    PHYSFS_Io *io = finfo->io;
+    const int encrypted = zip_entry_is_tradional_crypto(entry);
+
+    /* we do a copy so state is sane if inflateInit2() fails. */
+    z_stream str;
+    initializeZStream(&str);
+    if (zlib_err(inflateInit2(&str, -MAX_WBITS)) != Z_OK)
+        return 0;
+
+    if (!io->seek(io, entry->offset + (encrypted ? 12 : 0)))
+    {
+        inflateEnd(&str);
+        return 0;
+    } /* if */
+
+    inflateEnd(&finfo->stream);
+    memcpy(&finfo->stream, &str, sizeof (z_stream));
+    finfo->compressed_position = finfo->stream_position = 0;
+
+    if (encrypted)
+        memcpy(finfo->crypto_keys, finfo->initial_crypto_keys, 12);
+
+    return 1;
+} /* zip_restart_inflate */
+
+
+static int zip_entry_is_cached(const ZIPentry *entry)
+{
+    return (entry->compression_method != COMPMETH_NONE) &&
+           !zip_entry_is_tradional_crypto(entry);
+} /* zip_entry_is_cached */
+
+
+static PHYSFS_uint32 zip_checkpoint_interval(const ZIPentry *entry)
+{
+    PHYSFS_uint64 interval = ZIP_CHECKPOINT_INTERVAL;
+    while ((entry->uncompressed_size / interval) > ZIP_MAX_CHECKPOINTS)
+        interval *= 2;
+    return (PHYSFS_uint32) interval;
+} /* zip_checkpoint_interval */
+
+
+/*
+ * Save the inflate state if the stream is at the next checkpoint of the
+ *  entry. Running out of memory here only means there is no checkpoint.
+ */
+static void zip_take_checkpoint(ZIPfileinfo *finfo)
+{
+    ZIPinfo *info = finfo->info;
+    ZIPentry *entry = finfo->entry;
+    const PHYSFS_uint32 interval = zip_checkpoint_interval(entry);
+    ZIPcheckpoint *cp;
+
+    if ((finfo->stream_position == 0) || (finfo->stream_position % interval))
+        return;
+    else if ((finfo->stream_position / interval) != (entry->checkpoint_count + 1))
+        return;  /* have it already, or a gap would come before it. */
+    else if (entry->checkpoint_count >= ZIP_MAX_CHECKPOINTS)
+        return;
+    else if ((info->checkpoint_bytes + sizeof (ZIPcheckpoint)) > ZIP_CHECKPOINT_MEMORY)
+        return;
+
+    if (entry->checkpoints == NULL)
+    {
+        entry->checkpoints = (ZIPcheckpoint **) allocator.Malloc(sizeof (ZIPcheckpoint *) * ZIP_MAX_CHECKPOINTS);
+        if (entry->checkpoints == NULL)
+            return;
+        entry->next_checkpointed = info->checkpointed;
+        info->checkpointed = entry;
+    } /* if */
+
+    cp = (ZIPcheckpoint *) allocator.Malloc(sizeof (ZIPcheckpoint));
+    if (cp == NULL)
+        return;
+
+    /* input still buffered is read again when resuming from here. */
+    cp->compressed_position = finfo->compressed_position - finfo->stream.avail_in;
+    memcpy(&cp->state, finfo->stream.state, sizeof (inflate_state));
+    entry->checkpoints[entry->checkpoint_count++] = cp;
+    info->checkpoint_bytes += sizeof (ZIPcheckpoint);
+} /* zip_take_checkpoint */
+
+
+/*
+ * Move the stream to uncompressed offset (pos), a multiple of ZIP_BLOCKSIZE,
+ *  resuming from a checkpoint when that beats decompressing from where the
+ *  stream is now. (scratch) holds ZIP_BLOCKSIZE bytes.
+ */
+static int zip_inflate_to(ZIPfileinfo *finfo, PHYSFS_uint32 pos, PHYSFS_uint8 *scratch)
+{
+    ZIPentry *entry = finfo->entry;
+    const PHYSFS_uint32 interval = zip_checkpoint_interval(entry);
+    PHYSFS_uint32 k = pos / interval;
+
+    if (k > entry->checkpoint_count)
+        k = entry->checkpoint_count;
+
+    if ((pos < finfo->stream_position) || ((k * interval) > finfo->stream_position))
+    {
+        if (k == 0)
+            BAIL_IF_ERRPASS(!zip_restart_inflate(finfo), 0);
+        else
+        {
+            const ZIPcheckpoint *cp = entry->checkpoints[k - 1];
+            BAIL_IF_ERRPASS(!finfo->io->seek(finfo->io, entry->offset + cp->compressed_position), 0);
+            memcpy(finfo->stream.state, &cp->state, sizeof (inflate_state));
+            finfo->stream.next_in = finfo->buffer;
+            finfo->stream.avail_in = 0;
+            finfo->compressed_position = cp->compressed_position;
+            finfo->stream_position = k * interval;
+        } /* else */
+    } /* if */
+
+    /* one block at a time, so every checkpoint boundary is met exactly. */
+    while (finfo->stream_position < pos)
+    {
+        const PHYSFS_uint32 maxread = ZIP_BLOCKSIZE - (finfo->stream_position % ZIP_BLOCKSIZE);
+        BAIL_IF_ERRPASS(zip_inflate(finfo, scratch, maxread) != maxread, 0);
+        zip_take_checkpoint(finfo);
+    } /* while */
+
+    return 1;
+} /* zip_inflate_to */
+
+
+/*
+ * Find block (index) of the entry in the cache, or decompress it into the
+ *  least recently used block. Call with (cache_lock) held.
+ */
+static const ZIPblock *zip_get_block(ZIPfileinfo *finfo, PHYSFS_uint32 index)
+{
+    ZIPinfo *info = finfo->info;
+    ZIPentry *entry = finfo->entry;
+    ZIPblock *block = NULL;
+    PHYSFS_uint64 start = (PHYSFS_uint64) index * ZIP_BLOCKSIZE;
+    PHYSFS_uint32 length;
+    int i;
+
+    for (i = 0; i < ZIP_BLOCK_CACHE_COUNT; i++)
+    {
+        ZIPblock *b = &info->blocks[i];
+        if ((b->entry == entry) && (b->index == index))
+        {
+            b->last_use = ++info->block_clock;
+            return b;
+        } /* if */
+
+        if ((block == NULL) || (b->last_use < block->last_use))
+            block = b;
+    } /* for */
+
+    if (block->data == NULL)
+    {
+        block->data = (PHYSFS_uint8 *) allocator.Malloc(ZIP_BLOCKSIZE);
+        BAIL_IF(!block->data, PHYSFS_ERR_OUT_OF_MEMORY, NULL);
+    } /* if */
+
+    block->entry = NULL;
+    block->last_use = 0;
+
+    length = ZIP_BLOCKSIZE;
+    if ((entry->uncompressed_size - start) < length)
+        length = (PHYSFS_uint32) (entry->uncompressed_size - start);
+
+    BAIL_IF_ERRPASS(!zip_inflate_to(finfo, (PHYSFS_uint32) start, block->data), NULL);
+    BAIL_IF_ERRPASS(zip_inflate(finfo, block->data, length) != length, NULL);
+    zip_take_checkpoint(finfo);
+
+    block->entry = entry;
+    block->index = index;
+    block->length = length;
+    block->last_use = ++info->block_clock;
+    return block;
+} /* zip_get_block */
+
+
+static PHYSFS_sint64 zip_read_cached(ZIPfileinfo *finfo, void *buf, PHYSFS_uint64 len)
+{
+    ZIPinfo *info = finfo->info;
+    PHYSFS_uint8 *dst = (PHYSFS_uint8 *) buf;
+    PHYSFS_uint64 pos = finfo->uncompressed_position;
+    PHYSFS_sint64 retval = 0;
+
+    __PHYSFS_platformGrabMutex(info->cache_lock);
+    while (retval < (PHYSFS_sint64) len)
+    {
+        const ZIPblock *block = zip_get_block(finfo, (PHYSFS_uint32) (pos / ZIP_BLOCKSIZE));
+        const PHYSFS_uint32 skip = (PHYSFS_uint32) (pos % ZIP_BLOCKSIZE);
+        PHYSFS_uint64 n;
+
+        if ((block == NULL) || (block->length <= skip))
+            break;
+
+        n = block->length - skip;
+        if (n > (len - retval))
+            n = len - retval;
+
+        memcpy(dst + retval, block->data + skip, (size_t) n);
+        retval += n;
+        pos += n;
+    } /* while */
+    __PHYSFS_platformReleaseMutex(info->cache_lock);
+
+    return retval;
+} /* zip_read_cached */
+
+
 static PHYSFS_sint64 ZIP_read(PHYSFS_Io *_io, void *buf, PHYSFS_uint64 len)
 {
     ZIPfileinfo *finfo = (ZIPfileinfo *) _io->opaque;
@@ -315,43 +630,10 @@ static PHYSFS_sint64 ZIP_read(PHYSFS_Io *_io, void *buf, PHYSFS_uint64 len)
 
     if (entry->compression_method == COMPMETH_NONE)
         retval = zip_read_decrypt(finfo, buf, maxread);
+    else if (zip_entry_is_cached(entry))
+        retval = zip_read_cached(finfo, buf, maxread);
     else
-    {
-        finfo->stream.next_out = (unsigned char *)buf;
-        finfo->stream.avail_out = (uInt) maxread;
-
-        while (retval < maxread)
-        {
-            const PHYSFS_uint32 before = (PHYSFS_uint32) finfo->stream.total_out;
-            int rc;
-
-            if (finfo->stream.avail_in == 0)
-            {
-                PHYSFS_sint64 br;
-
-                br = entry->compressed_size - finfo->compressed_position;
-                if (br > 0)
-                {
-                    if (br > ZIP_READBUFSIZE)
-                        br = ZIP_READBUFSIZE;
-
-                    br = zip_read_decrypt(finfo, finfo->buffer, (PHYSFS_uint64) br);
-                    if (br <= 0)
-                        break;
-
-                    finfo->compressed_position += (PHYSFS_uint32) br;
-                    finfo->stream.next_in = finfo->buffer;
-                    finfo->stream.avail_in = (unsigned int) br;
-                } /* if */
-            } /* if */
-
-            rc = zlib_err(inflate(&finfo->stream, Z_SYNC_FLUSH));
-            retval += (finfo->stream.total_out - before);
-
-            if (rc != Z_OK)
-                break;
-        } /* while */
-    } /* else */
+        retval = zip_inflate(finfo, buf, maxread);
 
     if (retval > 0)
         finfo->uncompressed_position += (PHYSFS_uint32) retval;
@@ -391,6 +673,12 @@ static int ZIP_seek(PHYSFS_Io *_io, PHYSFS_uint64 offset)
         finfo->uncompressed_position = (PHYSFS_uint32) offset;
     } /* if */
 
+    else if (zip_entry_is_cached(entry))
+    {
+        /* the block cache decompresses whatever is needed on the next read. */
+        finfo->uncompressed_position = (PHYSFS_uint32) offset;
+    } /* else if */
+
     else
     {
         /*
@@ -401,21 +689,9 @@ static int ZIP_seek(PHYSFS_Io *_io, PHYSFS_uint64 offset)
          */
         if (offset < finfo->uncompressed_position)
         {
-            /* we do a copy so state is sane if inflateInit2() fails. */
-            z_stream str;
-            initializeZStream(&str);
-            if (zlib_err(inflateInit2(&str, -MAX_WBITS)) != Z_OK)
+            if (!zip_restart_inflate(finfo))
                 return 0;
-
-            if (!io->seek(io, entry->offset + (encrypted ? 12 : 0)))
-                return 0;
-
-            inflateEnd(&finfo->stream);
-            memcpy(&finfo->stream, &str, sizeof (z_stream));
-            finfo->uncompressed_position = finfo->compressed_position = 0;
-
-            if (encrypted)
-                memcpy(finfo->crypto_keys, finfo->initial_crypto_keys, 12);
+            finfo->uncompressed_position = 0;
         } /* if */
 
         while (finfo->uncompressed_position != offset)
@@ -454,6 +730,7 @@ static PHYSFS_Io *ZIP_duplicate(PHYSFS_Io *io)
     GOTO_IF(!finfo, PHYSFS_ERR_OUT_OF_MEMORY, failed);
     memset(finfo, '\0', sizeof (*finfo));
 
+    finfo->info = origfinfo->info;
     finfo->entry = origfinfo->entry;
     finfo->io = zip_get_io(origfinfo->io, NULL, finfo->entry);
     GOTO_IF_ERRPASS(!finfo->io, failed);
@@ -1451,6 +1728,7 @@ static int zip_parse_end_of_central_dir(ZIPinfo *info,
 static void ZIP_closeArchive(void *opaque)
 {
     ZIPinfo *info = (ZIPinfo *) (opaque);
+    int i;
 
     if (!info)
         return;
@@ -1458,6 +1736,25 @@ static void ZIP_closeArchive(void *opaque)
     if (info->io)
         info->io->destroy(info->io);
 
+    while (info->checkpointed != NULL)
+    {
+        ZIPentry *entry = info->checkpointed;
+        PHYSFS_uint32 i;
+        for (i = 0; i < entry->checkpoint_count; i++)
+            allocator.Free(entry->checkpoints[i]);
+        allocator.Free(entry->checkpoints);
+        info->checkpointed = entry->next_checkpointed;
+    } /* while */
+
+    for (i = 0; i < ZIP_BLOCK_CACHE_COUNT; i++)
+    {
+        if (info->blocks[i].data != NULL)
+            allocator.Free(info->blocks[i].data);
+    } /* for */
+
+    if (info->cache_lock)
+        __PHYSFS_platformDestroyMutex(info->cache_lock);
+
     __PHYSFS_DirTreeDeinit(&info->tree);
 
     allocator.Free(info);
@@ -1487,6 +1784,10 @@ static void *ZIP_openArchive(PHYSFS_Io *io, const char *name,
 
     info->io = io;
 
+    info->cache_lock = __PHYSFS_platformCreateMutex();
+    if (!info->cache_lock)
+        goto ZIP_openarchive_failed;
+
     if (!zip_parse_end_of_central_dir(info, &dstart, &cdir_ofs, &count))
         goto ZIP_openarchive_failed;
     else if (!__PHYSFS_DirTreeInit(&info->tree, sizeof (ZIPentry)))
@@ -1577,6 +1878,7 @@ static PHYSFS_Io *ZIP_openRead(void *opaque, const char *filename)
     io = zip_get_io(info->io, info, entry);
     GOTO_IF_ERRPASS(!io, ZIP_openRead_failed);
     finfo->io = io;
+    finfo->info = info;
     finfo->entry = ((entry->symlink != NULL) ? entry->symlink : entry);
     initializeZStream(&finfo->stream);
 
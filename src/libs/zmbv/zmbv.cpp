@@ -25,10 +25,14 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <limits.h>
 #include <math.h>
 #include <png.h>
+#include <algorithm>
+#include <vector>
 
 #include "zmbv.h"
+#include "threadpool.h"
 
 #define DBZV_VERSION_HIGH 0
 #define DBZV_VERSION_LOW 1
@@ -41,6 +45,85 @@
 #define Mask_KeyFrame			0x01
 #define	Mask_DeltaPalette		0x02
 
+/* The compressor runs raw deflate and writes the zlib header of a level 4 stream itself
+ * at each keyframe, so keyframes can be deflated in slices and spliced together */
+#define ZLIB_HEADER_CMF			0x78
+#define ZLIB_HEADER_FLG			0x5e
+#define KEYFRAME_SLICE			(128*1024)
+
+/* Row compare kernels for CompareBlock. The compressor is a library of its own without the
+ * emulator's CPU detection, so this goes by what the compiler targets: SSE2 on x86-64 (and
+ * 32-bit builds with SSE2 enabled), NEON on ARM. */
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define ZMBV_SIMD_SSE2 1
+# include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# define ZMBV_SIMD_NEON 1
+# include <arm_neon.h>
+#endif
+
+#if defined(ZMBV_SIMD_SSE2)
+static INLINE int ZMBV_PopCount(unsigned int v) {
+#if defined(__GNUC__)
+	return __builtin_popcount(v);
+#else
+	v = v - ((v >> 1) & 0x55555555u);
+	v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+	return (int)((((v + (v >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24);
+#endif
+}
+#endif
+
+/* Count the pixels of one row that differ, comparing the low 24 bits like the scalar code */
+template<class P>
+static INLINE int ZMBV_DiffRow(const P *pold,const P *pnew,int count) {
+	int ret=0,x=0;
+#if defined(ZMBV_SIMD_SSE2)
+	const int step = 16 / (int)sizeof(P);
+	const __m128i rgb = _mm_set1_epi32(0x00ffffff);
+	for (;(x+step)<=count;x+=step) {
+		__m128i a = _mm_loadu_si128((const __m128i*)(pold+x));
+		__m128i b = _mm_loadu_si128((const __m128i*)(pnew+x));
+		if (sizeof(P) == 1) {
+			ret += 16 - ZMBV_PopCount((unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(a,b)));
+		}
+		else if (sizeof(P) == 2) {
+			ret += 8 - (ZMBV_PopCount((unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi16(a,b))) >> 1);
+		}
+		else {
+			a = _mm_and_si128(a,rgb);
+			b = _mm_and_si128(b,rgb);
+			ret += 4 - ZMBV_PopCount((unsigned int)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a,b))));
+		}
+	}
+#elif defined(ZMBV_SIMD_NEON)
+	const int step = 16 / (int)sizeof(P);
+	uint32x4_t acc = vdupq_n_u32(0);
+	for (;(x+step)<=count;x+=step) {
+		const uint8x16_t a = vld1q_u8((const uint8_t*)(pold+x));
+		const uint8x16_t b = vld1q_u8((const uint8_t*)(pnew+x));
+		/* one per differing pixel, widened into the 32-bit lanes of acc */
+		if (sizeof(P) == 1) {
+			acc = vpadalq_u16(acc, vpaddlq_u8(vshrq_n_u8(vmvnq_u8(vceqq_u8(a,b)),7)));
+		}
+		else if (sizeof(P) == 2) {
+			acc = vpadalq_u16(acc, vshrq_n_u16(vmvnq_u16(vceqq_u16(vreinterpretq_u16_u8(a),vreinterpretq_u16_u8(b))),15));
+		}
+		else {
+			const uint32x4_t rgb = vdupq_n_u32(0x00ffffff);
+			const uint32x4_t eq = vceqq_u32(vandq_u32(vreinterpretq_u32_u8(a),rgb),vandq_u32(vreinterpretq_u32_u8(b),rgb));
+			acc = vaddq_u32(acc, vshrq_n_u32(vmvnq_u32(eq),31));
+		}
+	}
+	ret = (int)(vgetq_lane_u32(acc,0) + vgetq_lane_u32(acc,1) + vgetq_lane_u32(acc,2) + vgetq_lane_u32(acc,3));
+#endif
+	for (;x<count;x++) {
+		int test=0-(int)((pold[x]-pnew[x])&0x00ffffffu);
+		ret-=(test>>31);
+	}
+	return ret;
+}
+
 zmbv_format_t BPPFormat( int bpp ) {
 	switch (bpp) {
 	case 8:
@@ -101,6 +184,8 @@ bool VideoCodec::SetupBuffers(zmbv_format_t _format, int blockwidth, int blockhe
 	int yleft = height % blockheight;
 	if (yleft) yblocks++;
 	blockcount=yblocks*xblocks;
+	blockcols=xblocks;
+	blockrows=yblocks;
 	blocks=new FrameBlock[blockcount];
 
 	if (!buf1 || !buf2 || !work || !blocks) {
@@ -168,16 +253,14 @@ INLINE int VideoCodec::PossibleBlock(int vx,int vy,FrameBlock * block) {
 	return ret;
 }
 
+/* Stops counting once limit is reached, the caller only wants to know if it beats limit */
 template<class P>
-INLINE int VideoCodec::CompareBlock(int vx,int vy,FrameBlock * block) {
+INLINE int VideoCodec::CompareBlock(int vx,int vy,FrameBlock * block,int limit) {
 	int ret=0;
 	P * pold=((P*)oldframe)+block->start+(vy*pitch)+vx;
 	P * pnew=((P*)newframe)+block->start;;	
-	for (int y=0;y<block->dy;y++) {
-		for (int x=0;x<block->dx;x++) {
-			int test=0-(int)((pold[x]-pnew[x])&0x00ffffffu);
-			ret-=(test>>31);
-		}
+	for (int y=0;y<block->dy && ret<limit;y++) {
+		ret+=ZMBV_DiffRow<P>(pold,pnew,block->dx);
 		pold+=pitch;
 		pnew+=pitch;
 	}
@@ -188,30 +271,23 @@ template<class P>
 INLINE void VideoCodec::AddXorBlock(int vx,int vy,FrameBlock * block) {
 	P * pold=((P*)oldframe)+block->start+(vy*pitch)+vx;
 	P * pnew=((P*)newframe)+block->start;
+	P * pxor=(P*)&work[block->xorpos];
 	for (int y=0;y<block->dy;y++) {
-		for (int x=0;x<block->dx;x++) {
-			*((P*)&work[workUsed])=pnew[x] ^ pold[x];
-			workUsed+=(int)sizeof(P);
-		}
+		for (int x=0;x<block->dx;x++)
+			*pxor++=pnew[x] ^ pold[x];
 		pold+=pitch;
 		pnew+=pitch;
 	}
 }
 
+/* Motion vector search for blocks first to last-1, the result goes into the blocks */
 template<class P>
-void VideoCodec::AddXorFrame(void) {
-//	int written=0;
-//	int lastvector=0;
-	signed char * vectors=(signed char*)&work[workUsed];
-	/* Align the following xor data on 4 byte boundary*/
-	workUsed=(workUsed + blockcount*2 +3) & ~3;
-//	int totalx=0;
-//	int totaly=0;
-	for (int b=0;b<blockcount;b++) {
+void VideoCodec::SearchBlocks(int first,int last) {
+	for (int b=first;b<last;b++) {
 		FrameBlock * block=&blocks[b];
 		int bestvx = 0;
 		int bestvy = 0;
-		int bestchange=CompareBlock<P>(0,0, block);
+		int bestchange=CompareBlock<P>(0,0, block, INT_MAX);
 		int possibles=64;
 		for (int v=0;v<VectorCount && possibles;v++) {
 			if (bestchange<4) break;
@@ -220,7 +296,7 @@ void VideoCodec::AddXorFrame(void) {
 			if (PossibleBlock<P>(vx, vy, block) < 4) {
 				possibles--;
 //				if (!possibles) Msg("Ran out of possibles, at %d of %d best %d\n",v,VectorCount,bestchange);
-				int testchange=CompareBlock<P>(vx,vy, block);
+				int testchange=CompareBlock<P>(vx,vy, block, bestchange);
 				if (testchange<bestchange) {
 					bestchange=testchange;
 					bestvx = vx;
@@ -228,13 +304,104 @@ void VideoCodec::AddXorFrame(void) {
 				}
 			}
 		}
-		vectors[b*2+0]=(bestvx << 1);
-		vectors[b*2+1]=(bestvy << 1);
-		if (bestchange) {
+		block->vx = bestvx;
+		block->vy = bestvy;
+		block->changed = bestchange != 0;
+	}
+}
+
+template<class P>
+void VideoCodec::XorBlocks(int first,int last) {
+	for (int b=first;b<last;b++) {
+		if (blocks[b].changed)
+			AddXorBlock<P>(blocks[b].vx, blocks[b].vy, &blocks[b]);
+	}
+}
+
+/* Each row of blocks is a task for the thread pool, first the vector search and then, once
+ * the xor data offsets are known, the xor blocks themselves. The output does not depend on
+ * how the rows were spread over the workers. */
+template<class P>
+void VideoCodec::AddXorFrame(void) {
+	signed char * vectors=(signed char*)&work[workUsed];
+	/* Align the following xor data on 4 byte boundary*/
+	workUsed=(workUsed + blockcount*2 +3) & ~3;
+
+	ThreadPoolGroup group;
+	for (int row=0;row<blockrows;row++) {
+		const int first=row*blockcols;
+		group.run([this,first] { SearchBlocks<P>(first,first+blockcols); });
+	}
+	group.wait();
+
+	for (int b=0;b<blockcount;b++) {
+		FrameBlock * block=&blocks[b];
+		vectors[b*2+0]=(signed char)(block->vx << 1);
+		vectors[b*2+1]=(signed char)(block->vy << 1);
+		if (block->changed) {
 			vectors[b*2+0]|=1;
-			AddXorBlock<P>(bestvx, bestvy, block);
+			block->xorpos=workUsed;
+			workUsed+=block->dx*block->dy*(int)sizeof(P);
 		}
 	}
+
+	for (int row=0;row<blockrows;row++) {
+		const int first=row*blockcols;
+		group.run([this,first] { XorBlocks<P>(first,first+blockcols); });
+	}
+	group.wait();
+}
+
+/* pigz style: slices of the keyframe are deflated on the thread pool, each primed with the
+ * 32KB before it and ended with a sync flush, so that together they form one deflate stream.
+ * Returns the size written to out, or -1 to have the caller deflate the frame itself. */
+int VideoCodec::DeflateKeyframe(unsigned char *out,int outSize) {
+	const int slices=(workUsed+KEYFRAME_SLICE-1)/KEYFRAME_SLICE;
+	if (THREADPOOL_Workers() == 0 || slices < 2)
+		return -1;
+
+	std::vector< std::vector<unsigned char> > sliceOut((size_t)slices);
+	std::vector<int> sliceSize((size_t)slices,-1);
+	ThreadPoolGroup group;
+
+	for (int s=0;s<slices;s++) {
+		group.run([this,s,&sliceOut,&sliceSize] {
+			const int start=s*KEYFRAME_SLICE;
+			const int len=std::min(KEYFRAME_SLICE,workUsed-start);
+			std::vector<unsigned char> &dst=sliceOut[(size_t)s];
+			z_stream zs;
+
+			memset(&zs,0,sizeof(zs));
+			if (deflateInit2(&zs,4,Z_DEFLATED,-MAX_WBITS,8,Z_DEFAULT_STRATEGY) != Z_OK)
+				return;
+			if (start) {
+				const int dict=std::min(start,32768);
+				deflateSetDictionary(&zs,(Bytef *)work+start-dict,(unsigned int)dict);
+			}
+			dst.resize(deflateBound(&zs,(uLong)len)+16);
+			zs.next_in=(Bytef *)work+start;
+			zs.avail_in=(unsigned int)len;
+			zs.next_out=(Bytef *)dst.data();
+			zs.avail_out=(unsigned int)dst.size();
+			if (deflate(&zs,Z_SYNC_FLUSH) == Z_OK && zs.avail_in == 0 && zs.avail_out != 0)
+				sliceSize[(size_t)s]=(int)zs.total_out;
+			deflateEnd(&zs);
+		});
+	}
+	group.wait();
+
+	int total=0;
+	for (int s=0;s<slices;s++) {
+		if (sliceSize[(size_t)s] < 0 || (total+sliceSize[(size_t)s]) > outSize)
+			return -1;
+		memcpy(out+total,sliceOut[(size_t)s].data(),(size_t)sliceSize[(size_t)s]);
+		total+=sliceSize[(size_t)s];
+	}
+
+	/* the delta frames that follow continue this stream and may refer back into the keyframe */
+	const int dict=std::min(workUsed,32768);
+	deflateSetDictionary(&zstream,(Bytef *)work+workUsed-dict,(unsigned int)dict);
+	return total;
 }
 
 bool VideoCodec::SetupCompress( int _width, int _height ) {
@@ -242,7 +409,7 @@ bool VideoCodec::SetupCompress( int _width, int _height ) {
 	height = _height;
 	pitch = _width + 2*MAX_VECTOR;
 	format = ZMBV_FORMAT_NONE;
-	if (deflateInit (&zstream, 4) != Z_OK)
+	if (deflateInit2 (&zstream, 4, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
 		return false;
 	return true;
 }
@@ -334,6 +501,8 @@ void VideoCodec::CompressLines(int lineCount, void *lineData[]) {
 
 int VideoCodec::FinishCompressFrame( void ) {
 	unsigned char firstByte = *compress.writeBuf;
+	unsigned char *out = compress.writeBuf + compress.writeDone;
+	int outSize = compress.writeSize - compress.writeDone;
 	if (firstByte & Mask_KeyFrame) {
 		int i;
 		/* Add the full frame data */
@@ -361,15 +530,25 @@ int VideoCodec::FinishCompressFrame( void ) {
 		}
 	}
 	/* Create the actual frame with compression */
+	if (firstByte & Mask_KeyFrame) {
+		out[0] = ZLIB_HEADER_CMF;
+		out[1] = ZLIB_HEADER_FLG;
+		out += 2;
+		outSize -= 2;
+
+		int written = DeflateKeyframe(out, outSize);
+		if (written >= 0)
+			return (int)compress.writeDone + 2 + written;
+	}
 	zstream.next_in = (Bytef *)work;
 	zstream.avail_in = (unsigned int)workUsed;
 	zstream.total_in = 0;
 
-	zstream.next_out = (Bytef *)(compress.writeBuf + compress.writeDone);
-	zstream.avail_out = (unsigned int)compress.writeSize - (unsigned int)compress.writeDone;
+	zstream.next_out = (Bytef *)out;
+	zstream.avail_out = (unsigned int)outSize;
 	zstream.total_out = 0;
 	deflate(&zstream, Z_SYNC_FLUSH);
-	return (int)compress.writeDone + (int)zstream.total_out;
+	return (int)(out - compress.writeBuf) + (int)zstream.total_out;
 }
 
 template<class P>
@@ -46,6 +46,10 @@ private:
 	struct FrameBlock {
 		int start;
 		int dx,dy;
+		/* compressor: result of the vector search and where the xor data goes */
+		int vx,vy;
+		bool changed;
+		int xorpos;
 	};
 	struct CodecVector {
 		int x,y;
@@ -74,6 +78,7 @@ private:
 	int bufsize;
 
 	int blockcount; 
+	int blockcols, blockrows;
 	FrameBlock * blocks;
 
 	int workUsed, workPos;
@@ -98,7 +103,12 @@ private:
 	template<class P>
 		INLINE int PossibleBlock(int vx,int vy,FrameBlock * block);
 	template<class P>
-		INLINE int CompareBlock(int vx,int vy,FrameBlock * block);
+		INLINE int CompareBlock(int vx,int vy,FrameBlock * block,int limit);
+	template<class P>
+		void SearchBlocks(int first,int last);
+	template<class P>
+		void XorBlocks(int first,int last);
+	int DeflateKeyframe(unsigned char *out,int outSize);
 	template<class P>
 		INLINE void AddXorBlock(int vx,int vy,FrameBlock * block);
 	template<class P>
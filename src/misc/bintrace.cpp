@@ -0,0 +1,213 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "dosbox.h"
+#include "logging.h"
+#include "regs.h"
+#include "pic.h"
+#include "setup.h"
+#include "control.h"
+#include "bintrace.h"
+
+void ResolvePath(std::string& in);
+
+static_assert(sizeof(BinTraceRecord) == 24, "BinTraceRecord layout changed, bump BINTRACE_VERSION");
+
+bool bintrace_io = false;
+bool bintrace_mem = false;
+uint32_t bintrace_mem_base = 0;
+uint32_t bintrace_mem_size = 0;
+
+/* Single producer (emulation thread), single consumer (writer thread). head and tail count
+ * records forever and are masked on use, so head - tail is always the fill level. */
+#define BINTRACE_RING_RECORDS (1u << 16u)
+
+static BinTraceRecord *bintrace_ring = NULL;
+static std::atomic<uint32_t> bintrace_head{0};
+static std::atomic<uint32_t> bintrace_tail{0};
+
+static FILE *bintrace_fp = NULL;
+static std::thread bintrace_writer;
+static std::atomic<bool> bintrace_writer_run{false};
+
+static uint64_t bintrace_records = 0;
+static uint64_t bintrace_dropped = 0;
+
+void BINTRACE_Record(uint8_t kind,uint8_t width,uint32_t addr,uint32_t value) {
+    const uint32_t head = bintrace_head.load(std::memory_order_relaxed);
+
+    if ((head - bintrace_tail.load(std::memory_order_acquire)) >= BINTRACE_RING_RECORDS) {
+        bintrace_dropped++;
+        return;
+    }
+
+    BinTraceRecord &r = bintrace_ring[head & (BINTRACE_RING_RECORDS - 1u)];
+    r.time = PIC_FullIndex();
+    r.addr = addr;
+    r.value = value;
+    r.eip = reg_eip;
+    r.cs = (uint16_t)SegValue(cs);
+    r.kind = kind;
+    r.width = width;
+
+    bintrace_head.store(head + 1u,std::memory_order_release);
+    bintrace_records++;
+}
+
+static void BINTRACE_WriterThread(void) {
+    for (;;) {
+        /* read the flag first so that the last pass drains whatever was recorded before Stop */
+        const bool stopping = !bintrace_writer_run.load(std::memory_order_acquire);
+        const uint32_t head = bintrace_head.load(std::memory_order_acquire);
+        uint32_t tail = bintrace_tail.load(std::memory_order_relaxed);
+
+        while (tail != head) {
+            const uint32_t idx = tail & (BINTRACE_RING_RECORDS - 1u);
+            uint32_t count = head - tail;
+            if (count > (BINTRACE_RING_RECORDS - idx)) count = BINTRACE_RING_RECORDS - idx;
+
+            fwrite(&bintrace_ring[idx],sizeof(BinTraceRecord),count,bintrace_fp);
+            tail += count;
+            bintrace_tail.store(tail,std::memory_order_release);
+        }
+
+        if (stopping) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+bool BINTRACE_Running(void) {
+    return bintrace_fp != NULL;
+}
+
+void BINTRACE_GetStats(uint64_t &records,uint64_t &dropped) {
+    records = bintrace_records;
+    dropped = bintrace_dropped;
+}
+
+bool BINTRACE_Start(const char *path,bool io,uint32_t mem_base,uint32_t mem_size) {
+    if (BINTRACE_Running()) BINTRACE_Stop();
+
+    bintrace_fp = fopen(path,"wb");
+    if (bintrace_fp == NULL) {
+        LOG_MSG("Binary trace: cannot open '%s': %s",path,strerror(errno));
+        return false;
+    }
+
+    BinTraceHeader hdr;
+    memset(&hdr,0,sizeof(hdr));
+    memcpy(hdr.magic,BINTRACE_MAGIC,sizeof(hdr.magic));
+    hdr.version = BINTRACE_VERSION;
+    hdr.record_size = sizeof(BinTraceRecord);
+    hdr.byte_order = 0x01020304u;
+    fwrite(&hdr,sizeof(hdr),1,bintrace_fp);
+
+    if (bintrace_ring == NULL) bintrace_ring = new BinTraceRecord[BINTRACE_RING_RECORDS];
+    bintrace_head.store(0);
+    bintrace_tail.store(0);
+    bintrace_records = 0;
+    bintrace_dropped = 0;
+
+    bintrace_writer_run.store(true);
+    bintrace_writer = std::thread(BINTRACE_WriterThread);
+
+    bintrace_mem_base = mem_base;
+    bintrace_mem_size = mem_size;
+    bintrace_mem = mem_size != 0;
+    bintrace_io = io;
+
+    if (mem_size != 0)
+        LOG_MSG("Binary trace: writing to '%s' (I/O %s, memory %08x-%08x)",path,io ? "on" : "off",
+            (unsigned int)mem_base,(unsigned int)(mem_base + mem_size - 1u));
+    else
+        LOG_MSG("Binary trace: writing to '%s' (I/O %s, memory off)",path,io ? "on" : "off");
+
+    return true;
+}
+
+void BINTRACE_Stop(void) {
+    if (!BINTRACE_Running()) return;
+
+    bintrace_io = false;
+    bintrace_mem = false;
+
+    bintrace_writer_run.store(false,std::memory_order_release);
+    if (bintrace_writer.joinable()) bintrace_writer.join();
+
+    fclose(bintrace_fp);
+    bintrace_fp = NULL;
+
+    LOG_MSG("Binary trace: stopped, %llu records, %llu dropped",
+        (unsigned long long)bintrace_records,(unsigned long long)bintrace_dropped);
+}
+
+static void BINTRACE_Shutdown(Section* /*sec*/) {
+    BINTRACE_Stop();
+    delete[] bintrace_ring;
+    bintrace_ring = NULL;
+}
+
+/* "base-end" or "base+length", hex */
+bool BINTRACE_ParseRange(const char *s,uint32_t &base,uint32_t &size) {
+    char *end;
+
+    base = (uint32_t)strtoul(s,&end,16);
+    if (end == s) return false;
+
+    if (*end == '-') {
+        const uint32_t last = (uint32_t)strtoul(end + 1,&end,16);
+        if (last < base) return false;
+        size = last - base + 1u;
+    }
+    else if (*end == '+') {
+        size = (uint32_t)strtoul(end + 1,&end,16);
+    }
+    else {
+        return false;
+    }
+
+    return size != 0;
+}
+
+void BINTRACE_Init(void) {
+    Section_prop *sect = static_cast<Section_prop *>(control->GetSection("log"));
+    assert(sect != NULL);
+
+    AddExitFunction(AddExitFunctionFuncPair(BINTRACE_Shutdown));
+
+    std::string path = sect->Get_string("binary trace file");
+    if (path.empty()) return;
+
+    uint32_t base = 0,size = 0;
+    const char *range = sect->Get_string("binary trace memory");
+    if (range != NULL && *range != 0 && !BINTRACE_ParseRange(range,base,size))
+        LOG_MSG("Binary trace: ignoring bad memory range '%s'",range);
+
+    ResolvePath(path);
+    BINTRACE_Start(path.c_str(),sect->Get_bool("binary trace io"),base,size);
+}
@@ -23,6 +23,7 @@
 #include "render.h"
 #include "jfont.h"
 #include "bios.h"
+#include "timer.h"
 #include "../ints/int10.h"
 
 #ifdef __WIN32__
@@ -478,6 +479,55 @@ bool PasteClipboardNext() {
     return true;
 }
 
+/* Streamed paste, with [sdl] clip_paste_rate set: up to that many characters a second. While the
+ * guest takes its keys from INT 16h, or with BIOS pasting on, they go straight into the BIOS keyboard
+ * buffer, which is topped up every time INT 16h looks at it so a guest that reads quickly does not
+ * wait on the host. Otherwise one typed key goes out per host event poll through PasteClipboardNext. */
+#define PASTE_STREAM_BURST      32.0    /* characters the rate limit lets through at once */
+#define PASTE_INT16_RECENT_MS   500u    /* INT 16h used this recently, the guest reads the BIOS buffer */
+
+extern int paste_rate;
+static double paste_budget = 0;
+static uint32_t paste_last = 0;
+static uint32_t paste_int16_last = 0;
+static bool paste_int16_seen = false;
+
+void PasteClipboardStream(void) {
+    const uint32_t now = GetTicks();
+    if (strPasteBuffer.empty()) {
+        paste_budget = 0;
+        paste_last = now;
+        return;
+    }
+
+    paste_budget += (double)paste_rate * (double)(now - paste_last) / 1000.0;
+    if (paste_budget > PASTE_STREAM_BURST) paste_budget = PASTE_STREAM_BURST;
+    paste_last = now;
+    if (paste_budget < 1) return;
+
+    if (clipboard_biospaste || (paste_int16_seen && (now - paste_int16_last) < PASTE_INT16_RECENT_MS)) {
+        unsigned int room = BIOS_KeyboardBufferFree();
+        size_t n = 0;
+        while (paste_budget >= 1 && room > 0 && n < strPasteBuffer.length()) {
+            const unsigned char c = (unsigned char)strPasteBuffer[n++];
+            BIOS_AddKeyToBuffer(c == 13 ? 0x1C0D/*Enter*/ : c);
+            paste_budget -= 1;
+            room--;
+        }
+        strPasteBuffer.erase(0, n);
+    }
+    else if (PasteClipboardNext()) {
+        paste_budget -= 1;
+    }
+}
+
+/* INT 16h is about to read or check the BIOS keyboard buffer */
+void PasteClipboardINT16(void) {
+    paste_int16_last = GetTicks();
+    paste_int16_seen = true;
+    if (paste_rate > 0) PasteClipboardStream();
+}
+
 // added emendelson from dbDos; improved by Wengier
 #if defined(WIN32) && !defined(C_SDL2) && !defined(__MINGW32__)
 void PasteClipboard(bool bPressed)
@@ -803,6 +853,7 @@ void CopyClipboard(int all) {
 void PasteClipStop(bool bPressed) {
     if (!bPressed) return;
     strPasteBuffer = "";
+    paste_int16_seen = false;
 }
 
 #if defined(WIN32) || defined(MACOSX) || defined(C_SDL2)
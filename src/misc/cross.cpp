@@ -564,6 +564,310 @@ void close_directory(dir_information* dirp) {
 
 #endif
 
+#if defined(WIN32) && !defined(HX_DOS) && !defined(_WIN32_WINDOWS)
+
+#include <unordered_map>
+
+/* One overlapped ReadDirectoryChangesW per directory, all completing on one I/O completion port.
+ * Only the fact that a directory changed is used, so the notification buffer is never parsed. */
+struct dir_watch_entry {
+	OVERLAPPED	ov;			// must stay first, the completion packet hands it back
+	HANDLE		dir;
+	uint32_t	id;
+	bool		closed;
+	DWORD		buf[256];
+};
+
+struct dir_watch_struct {
+	HANDLE		port;
+	std::unordered_map<uint32_t,dir_watch_entry*> entries;
+	size_t		zombies;	// closed entries whose cancelled read hasn't completed yet
+};
+
+static bool issue_dir_watch(dir_watch_entry* e) {
+	memset(&e->ov,0,sizeof(e->ov));
+	return ReadDirectoryChangesW(e->dir,e->buf,sizeof(e->buf),FALSE,FILE_NOTIFY_CHANGE_FILE_NAME|FILE_NOTIFY_CHANGE_DIR_NAME,NULL,&e->ov,NULL) != 0;
+}
+
+dir_watch_information* open_dir_watch(void) {
+	HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE,NULL,0,1);
+	if (port == NULL) return NULL;
+	dir_watch_information* watch = new dir_watch_information;
+	watch->port = port;
+	watch->zombies = 0;
+	return watch;
+}
+
+bool add_dir_watchw(dir_watch_information* watch, const wchar_t* dirname, uint32_t id) {
+	if (!watch) return false;
+	HANDLE h = CreateFileW(dirname,FILE_LIST_DIRECTORY,FILE_SHARE_READ|FILE_SHARE_WRITE|FILE_SHARE_DELETE,NULL,OPEN_EXISTING,FILE_FLAG_BACKUP_SEMANTICS|FILE_FLAG_OVERLAPPED,NULL);
+	if (h == INVALID_HANDLE_VALUE) return false;
+	if (CreateIoCompletionPort(h,watch->port,(ULONG_PTR)id,0) == NULL) {
+		CloseHandle(h);
+		return false;
+	}
+	dir_watch_entry* e = new dir_watch_entry;
+	e->dir = h;
+	e->id = id;
+	e->closed = false;
+	if (!issue_dir_watch(e)) {
+		CloseHandle(h);
+		delete e;
+		return false;
+	}
+	watch->entries[id] = e;
+	return true;
+}
+
+bool add_dir_watch(dir_watch_information* watch, const char* dirname, uint32_t id) {
+	wchar_t wname[MAX_PATH+1];
+	if (MultiByteToWideChar(CP_ACP,0,dirname,-1,wname,MAX_PATH+1) == 0) return false;
+	return add_dir_watchw(watch,wname,id);
+}
+
+void remove_dir_watch(dir_watch_information* watch, uint32_t id) {
+	if (!watch) return;
+	std::unordered_map<uint32_t,dir_watch_entry*>::iterator it = watch->entries.find(id);
+	if (it == watch->entries.end()) return;
+	// the cancelled read still posts a packet that points at the entry, free it from there
+	dir_watch_entry* e = it->second;
+	e->closed = true;
+	CancelIo(e->dir);
+	CloseHandle(e->dir);
+	watch->entries.erase(it);
+	watch->zombies++;
+}
+
+bool read_dir_watch(dir_watch_information* watch, std::vector<uint32_t>& changed) {
+	if (!watch) return true;
+	DWORD bytes;
+	ULONG_PTR key;
+	LPOVERLAPPED ov;
+	for (;;) {
+		ov = NULL;
+		BOOL ok = GetQueuedCompletionStatus(watch->port,&bytes,&key,&ov,0);
+		if (ov == NULL) break; // no more packets
+		dir_watch_entry* e = (dir_watch_entry*)ov;
+		if (e->closed) {
+			delete e;
+			watch->zombies--;
+			continue;
+		}
+		// zero bytes means the buffer overflowed, which still just says "this directory changed"
+		changed.push_back(e->id);
+		if (!ok || !issue_dir_watch(e)) {
+			// directory is gone, nothing is pending on it anymore
+			CloseHandle(e->dir);
+			watch->entries.erase(e->id);
+			delete e;
+		}
+	}
+	return true;
+}
+
+void close_dir_watch(dir_watch_information* watch) {
+	if (!watch) return;
+	while (!watch->entries.empty()) remove_dir_watch(watch,watch->entries.begin()->first);
+	// collect the cancelled reads, give up (and leak) if they take unreasonably long
+	while (watch->zombies > 0) {
+		DWORD bytes;
+		ULONG_PTR key;
+		LPOVERLAPPED ov = NULL;
+		GetQueuedCompletionStatus(watch->port,&bytes,&key,&ov,100);
+		if (ov == NULL) break;
+		delete (dir_watch_entry*)ov;
+		watch->zombies--;
+	}
+	CloseHandle(watch->port);
+	delete watch;
+}
+
+#elif defined(LINUX) || defined(__linux__)
+
+#include <sys/inotify.h>
+#include <unordered_map>
+
+struct dir_watch_struct {
+	int		fd;
+	std::unordered_map<int,uint32_t> wd_to_id;
+	std::unordered_map<uint32_t,int> id_to_wd;
+};
+
+dir_watch_information* open_dir_watch(void) {
+	int fd = inotify_init1(IN_NONBLOCK|IN_CLOEXEC);
+	if (fd < 0) return NULL;
+	dir_watch_information* watch = new dir_watch_information;
+	watch->fd = fd;
+	return watch;
+}
+
+bool add_dir_watch(dir_watch_information* watch, const char* dirname, uint32_t id) {
+	if (!watch) return false;
+	int wd = inotify_add_watch(watch->fd,dirname,IN_CREATE|IN_DELETE|IN_MOVED_FROM|IN_MOVED_TO|IN_DELETE_SELF|IN_MOVE_SELF|IN_ONLYDIR);
+	if (wd < 0) return false;
+	watch->wd_to_id[wd] = id;
+	watch->id_to_wd[id] = wd;
+	return true;
+}
+
+void remove_dir_watch(dir_watch_information* watch, uint32_t id) {
+	if (!watch) return;
+	std::unordered_map<uint32_t,int>::iterator it = watch->id_to_wd.find(id);
+	if (it == watch->id_to_wd.end()) return;
+	// inotify hands out the same wd if a directory is watched twice, only drop it if it is still ours
+	std::unordered_map<int,uint32_t>::iterator wt = watch->wd_to_id.find(it->second);
+	if (wt != watch->wd_to_id.end() && wt->second == id) {
+		inotify_rm_watch(watch->fd,it->second);
+		watch->wd_to_id.erase(wt);
+	}
+	watch->id_to_wd.erase(it);
+}
+
+bool read_dir_watch(dir_watch_information* watch, std::vector<uint32_t>& changed) {
+	if (!watch) return true;
+	alignas(struct inotify_event) char buf[4096];
+	bool complete = true;
+	ssize_t len;
+	while ((len = read(watch->fd,buf,sizeof(buf))) > 0) {
+		const char* p = buf;
+		while (p < buf + len) {
+			const struct inotify_event* ev = (const struct inotify_event*)p;
+			p += sizeof(struct inotify_event) + ev->len;
+
+			if (ev->mask & IN_Q_OVERFLOW) {
+				complete = false;
+				continue;
+			}
+			std::unordered_map<int,uint32_t>::iterator it = watch->wd_to_id.find(ev->wd);
+			if (it == watch->wd_to_id.end()) continue;
+			if (ev->mask & IN_IGNORED) {
+				// watch went away with the directory
+				watch->id_to_wd.erase(it->second);
+				watch->wd_to_id.erase(it);
+				continue;
+			}
+			changed.push_back(it->second);
+		}
+	}
+	return complete;
+}
+
+void close_dir_watch(dir_watch_information* watch) {
+	if (!watch) return;
+	close(watch->fd);
+	delete watch;
+}
+
+#elif defined(MACOSX) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) || defined(__DragonFly__)
+
+#include <sys/event.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <unordered_map>
+
+/* kqueue needs an open descriptor per watched directory. Only a quarter of the descriptor
+ * limit (256 by default on macOS) is used for that. Directories past it, or any that fail
+ * to open, are not watched and need RESCAN after host changes, as without notification. */
+#define DIR_WATCH_MAX_FDS	4096
+
+struct dir_watch_struct {
+	int		kq;
+	size_t		max_fds;
+	std::unordered_map<uint32_t,int> id_to_fd;
+};
+
+dir_watch_information* open_dir_watch(void) {
+	int kq = kqueue();
+	if (kq < 0) return NULL;
+	fcntl(kq,F_SETFD,FD_CLOEXEC);
+	dir_watch_information* watch = new dir_watch_information;
+	watch->kq = kq;
+	watch->max_fds = DIR_WATCH_MAX_FDS;
+	struct rlimit rl;
+	if (getrlimit(RLIMIT_NOFILE,&rl) == 0 && rl.rlim_cur != RLIM_INFINITY && rl.rlim_cur / 4 < DIR_WATCH_MAX_FDS)
+		watch->max_fds = (size_t)(rl.rlim_cur / 4);
+	return watch;
+}
+
+bool add_dir_watch(dir_watch_information* watch, const char* dirname, uint32_t id) {
+	if (!watch || watch->id_to_fd.size() >= watch->max_fds) return false;
+#if defined(O_EVTONLY)
+	int fd = open(dirname,O_EVTONLY|O_DIRECTORY|O_CLOEXEC);
+#else
+	int fd = open(dirname,O_RDONLY|O_DIRECTORY|O_CLOEXEC);
+#endif
+	if (fd < 0) return false;
+	struct kevent ev;
+	EV_SET(&ev,fd,EVFILT_VNODE,EV_ADD|EV_CLEAR,NOTE_WRITE|NOTE_DELETE|NOTE_RENAME|NOTE_REVOKE,0,(void*)(uintptr_t)id);
+	if (kevent(watch->kq,&ev,1,NULL,0,NULL) < 0) {
+		close(fd);
+		return false;
+	}
+	watch->id_to_fd[id] = fd;
+	return true;
+}
+
+void remove_dir_watch(dir_watch_information* watch, uint32_t id) {
+	if (!watch) return;
+	std::unordered_map<uint32_t,int>::iterator it = watch->id_to_fd.find(id);
+	if (it == watch->id_to_fd.end()) return;
+	close(it->second); // also removes the kevent
+	watch->id_to_fd.erase(it);
+}
+
+bool read_dir_watch(dir_watch_information* watch, std::vector<uint32_t>& changed) {
+	if (!watch) return true;
+	struct kevent evs[64];
+	const struct timespec poll = { 0, 0 };
+	int n;
+	do {
+		n = kevent(watch->kq,NULL,0,evs,64,&poll);
+		for (int i=0; i<n; i++) changed.push_back((uint32_t)(uintptr_t)evs[i].udata);
+	} while (n == 64);
+	return true;
+}
+
+void close_dir_watch(dir_watch_information* watch) {
+	if (!watch) return;
+	for (std::unordered_map<uint32_t,int>::iterator it = watch->id_to_fd.begin(); it != watch->id_to_fd.end(); ++it)
+		close(it->second);
+	close(watch->kq);
+	delete watch;
+}
+
+#else
+
+dir_watch_information* open_dir_watch(void) {
+	return NULL;
+}
+
+bool add_dir_watch(dir_watch_information* watch, const char* dirname, uint32_t id) {
+	(void)watch; (void)dirname; (void)id;
+	return false;
+}
+
+#if defined (WIN32)
+bool add_dir_watchw(dir_watch_information* watch, const wchar_t* dirname, uint32_t id) {
+	(void)watch; (void)dirname; (void)id;
+	return false;
+}
+#endif
+
+void remove_dir_watch(dir_watch_information* watch, uint32_t id) {
+	(void)watch; (void)id;
+}
+
+bool read_dir_watch(dir_watch_information* watch, std::vector<uint32_t>& changed) {
+	(void)watch; (void)changed;
+	return true;
+}
+
+void close_dir_watch(dir_watch_information* watch) {
+	(void)watch;
+}
+
+#endif
+
 FILE *fopen_wrap(const char *path, const char *mode) {
 #if !defined(WIN32) && !defined(OS2) && !defined(MACOSX) && defined(HAVE_REALPATH)
 	char work[CROSS_LEN] = {0};
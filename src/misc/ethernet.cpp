@@ -17,6 +17,12 @@
  */
 
 #include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "ethernet.h"
 #include "ethernet_pcap.h"
@@ -24,10 +30,109 @@
 #include "ethernet_nothing.h"
 #include "logging.h"
 #include <cstring>
+#include <cstdio>
+#include <cstdlib>
 #include "dosbox.h"
 #include "control.h"
 
-EthernetConnection* OpenEthernetConnection(std::string backendstr)
+/* Ethernet frames on their way between the emulation and the network thread. Only one thread
+ * pushes and only the other pops, so the two indexes are all the synchronization needed. */
+class EthernetFrameQueue {
+public:
+    bool Empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    /* false if the queue is full and the frame was dropped */
+    bool Push(const uint8_t* packet, int len) {
+        const unsigned int t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= slots) return false;
+        frames[t % slots].assign(packet, packet + len);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* the oldest frame, valid until Pop */
+    const std::vector<uint8_t>* Front() const {
+        const unsigned int h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return nullptr;
+        return &frames[h % slots];
+    }
+
+    void Pop() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+private:
+    static const unsigned int slots = 256;
+    std::vector<uint8_t> frames[slots];
+    std::atomic<unsigned int> head{0}, tail{0};
+};
+
+/* Runs a slirp or pcap connection on a network thread, so host socket polling and libslirp
+ * timers no longer run inside the emulation loop and packets flow at host speed. The wrapped
+ * connection is only used by that thread once it started. */
+class ThreadedEthernetConnection : public EthernetConnection {
+public:
+    ThreadedEthernetConnection(EthernetConnection* connection) : conn(connection) {
+        thread = std::thread(&ThreadedEthernetConnection::Run, this);
+    }
+
+    ~ThreadedEthernetConnection() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            quit = true;
+        }
+        wake.notify_one();
+        thread.join();
+        delete conn;
+    }
+
+    bool Initialize(Section* config) override {
+        (void)config;//UNUSED
+        return true; /* the wrapped connection was initialized before */
+    }
+
+    void SendPacket(const uint8_t* packet, int size) override {
+        if (!tx.Push(packet, size)) return; /* lossy, like the hardware */
+        wake.notify_one();
+    }
+
+    void GetPackets(std::function<void(const uint8_t*, int)> callback) override {
+        while (const std::vector<uint8_t>* frame = rx.Front()) {
+            callback(frame->data(), (int)frame->size());
+            rx.Pop();
+        }
+    }
+private:
+    void Run() {
+        while (!quit) {
+            bool busy = false;
+            while (const std::vector<uint8_t>* frame = tx.Front()) {
+                conn->SendPacket(frame->data(), (int)frame->size());
+                tx.Pop();
+                busy = true;
+            }
+            conn->GetPackets([this, &busy](const uint8_t* packet, int len) {
+                rx.Push(packet, len); /* dropped if the guest does not keep up */
+                busy = true;
+            });
+            if (!busy) {
+                /* nothing to do, wait for a frame from the guest or for the next poll */
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait_for(guard, std::chrono::milliseconds(1), [this] { return quit || !tx.Empty(); });
+            }
+        }
+    }
+
+    EthernetConnection* conn;
+    EthernetFrameQueue rx, tx;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::atomic<bool> quit{false}; /* set with lock held so that the wait sees it */
+    std::thread thread;
+};
+
+EthernetConnection* OpenEthernetConnection(std::string backendstr, bool threaded, const uint8_t* mac)
 {
     EthernetConnection* conn = nullptr;
     Section* settings = nullptr;
@@ -80,7 +185,30 @@ EthernetConnection* OpenEthernetConnection(std::string backendstr)
             LOG_MSG("ETHERNET: Unknown ethernet backend: %s", backend.c_str());
     } else {
         LOG_MSG("ETHERNET: NE2000 Ethernet emulation backend selected: %s", backend.c_str());
+        if (mac) conn->SetReceiveFilter(mac); /* before the network thread owns the connection */
+        if (threaded && backend != "nothing") conn = new ThreadedEthernetConnection(conn);
     }
 
     return conn;
 }
+
+void ETHERNET_ParseMacAddress(const char *macstring, uint8_t mac[6])
+{
+    unsigned int macint[6];
+    if (!strcmp(macstring, "random")) {
+        mac[0] = ((unsigned char)rand() & 0xFE) | 0x02; // unicast local admin
+        mac[1] = (unsigned char)rand();
+        mac[2] = (unsigned char)rand();
+        mac[3] = (unsigned char)rand();
+        mac[4] = (unsigned char)rand();
+        mac[5] = (unsigned char)rand();
+    }
+    else if (sscanf(macstring, "%02x:%02x:%02x:%02x:%02x:%02x",
+        &macint[0], &macint[1], &macint[2], &macint[3], &macint[4], &macint[5]) != 6) {
+        mac[0] = 0xac; mac[1] = 0xde; mac[2] = 0x48;
+        mac[3] = 0x88; mac[4] = 0xbb; mac[5] = 0xaa;
+    }
+    else {
+        for (unsigned int i = 0; i < 6; i++) mac[i] = (uint8_t)macint[i];
+    }
+}
@@ -40,6 +40,9 @@ extern std::string niclist;
 #define pcap_next_ex(A,B,C)				PacketNextEx(A,B,C)
 #define pcap_findalldevs_ex(A,B,C,D)	PacketFindALlDevsEx(A,B,C,D)
 #define pcap_geterr(A)	PacketGetError(A)
+#define pcap_compile(A,B,C,D,E)			PacketCompile(A,B,C,D,E)
+#define pcap_setfilter(A,B)				PacketSetFilter(A,B)
+#define pcap_freecode(A)				PacketFreeCode(A)
 
 int (*PacketSendPacket)(pcap_t *, const u_char *, int) = 0;
 void (*PacketClose)(pcap_t *) = 0;
@@ -48,6 +51,9 @@ pcap_t* (*PacketOpen)(char const *,int,int,int,struct pcap_rmtauth *,char *) = 0
 int (*PacketNextEx)(pcap_t *, struct pcap_pkthdr **, const u_char **) = 0;
 int (*PacketFindALlDevsEx)(char *, struct pcap_rmtauth *, pcap_if_t **, char *) = 0;
 char* (*PacketGetError)(pcap_t *) = nullptr;
+int (*PacketCompile)(pcap_t *, struct bpf_program *, const char *, int, bpf_u_int32) = 0;
+int (*PacketSetFilter)(pcap_t *, struct bpf_program *) = 0;
+void (*PacketFreeCode)(struct bpf_program *) = 0;
 
 char pcap_src_if_string[] = PCAP_SRC_IF_STRING;
 
@@ -105,6 +111,19 @@ bool LoadPcapLibrary() {
 	if(!PacketGetError) PacketGetError =
 		(char* (__cdecl *)(pcap_t *)) psp;
 
+	// optional, only used for the capture filter
+	psp = GetProcAddress(pcapinst,"pcap_compile");
+	if(!PacketCompile) PacketCompile =
+		(int (__cdecl *)(pcap_t *, struct bpf_program *, const char *, int, bpf_u_int32)) psp;
+
+	psp = GetProcAddress(pcapinst,"pcap_setfilter");
+	if(!PacketSetFilter) PacketSetFilter =
+		(int (__cdecl *)(pcap_t *, struct bpf_program *)) psp;
+
+	psp = GetProcAddress(pcapinst,"pcap_freecode");
+	if(!PacketFreeCode) PacketFreeCode =
+		(void (__cdecl *)(struct bpf_program *)) psp;
+
 #ifdef __MINGW32__
 #pragma GCC diagnostic pop
 #endif
@@ -123,6 +142,10 @@ bool LoadPcapLibrary() {
 
 #endif
 
+#ifndef PCAP_NETMASK_UNKNOWN
+#define PCAP_NETMASK_UNKNOWN 0xffffffff
+#endif
+
 PcapEthernetConnection::PcapEthernetConnection()
       : EthernetConnection()
 {
@@ -137,6 +160,7 @@ bool PcapEthernetConnection::Initialize(Section* config)
 {
 	Section_prop *section = static_cast<Section_prop*>(config);
 	const char* realnicstring = section->Get_string("realnic");
+	filter = section->Get_bool("filter");
 
 #ifdef WIN32
 	if(!LoadPcapLibrary()) {
@@ -231,23 +255,33 @@ bool PcapEthernetConnection::Initialize(Section* config)
 					errbuf            // error buffer
 				 ) ) == NULL)
 #else
-		/*pcap_t *pcap_open_live(const char *device, int snaplen,
-		  int promisc, int to_ms, char *errbuf)*/
-		if ( (adhandle= pcap_open_live(
-						currentdev->name, // name of the device
-						65536,            // portion of the packet to capture
-						// 65536 = whole packet 
-						true,    // promiscuous mode
-						timeout,          // read timeout
-						errbuf            // error buffer
-					      ) ) == NULL)
-
+		/* pcap_create()/pcap_activate() instead of pcap_open_live() so that the kernel buffer can be sized.
+		 * On Linux, libpcap activates a memory mapped (PACKET_MMAP, TPACKET_V3 where the kernel has it)
+		 * capture ring of that size, so frames are read without a system call per frame. */
+		if ( (adhandle= pcap_create(currentdev->name,errbuf)) == NULL)
 #endif        
 		{
 			LOG_MSG("\nUnable to open the interface: %s.", errbuf);
 			pcap_freealldevs(alldevs);
 			return false;
 		}
+#ifndef WIN32
+	pcap_set_snaplen(adhandle,65536);	// 65536 = whole packet
+	pcap_set_promisc(adhandle,1);
+	pcap_set_timeout(adhandle,timeout);
+	pcap_set_buffer_size(adhandle,4*1024*1024);
+	int status = pcap_activate(adhandle);
+	if (status < 0) {
+		LOG_MSG("\nUnable to open the interface: %s.", pcap_geterr(adhandle));
+		pcap_close(adhandle);
+		adhandle = nullptr;
+		pcap_freealldevs(alldevs);
+		return false;
+	}
+	else if (status > 0) {
+		LOG_MSG("PCAP warning: %s", pcap_geterr(adhandle));
+	}
+#endif
 	pcap_freealldevs(alldevs);
 #ifndef WIN32
 	pcap_setnonblock(adhandle,1,errbuf);
@@ -255,6 +289,31 @@ bool PcapEthernetConnection::Initialize(Section* config)
 	return true;
 }
 
+void PcapEthernetConnection::SetReceiveFilter(const uint8_t* mac)
+{
+	if (!filter) return;
+#ifdef WIN32
+	if (PacketCompile==0 || PacketSetFilter==0 || PacketFreeCode==0) return;
+#endif
+
+	/* frames for the emulated card, broadcasts and multicasts; everything else
+	 * seen by the promiscuous host interface is dropped in the kernel */
+	char expr[64];
+	sprintf(expr,"ether dst %02x:%02x:%02x:%02x:%02x:%02x or ether multicast",
+		mac[0],mac[1],mac[2],mac[3],mac[4],mac[5]);
+
+	struct bpf_program program;
+	if (pcap_compile(adhandle,&program,expr,1,PCAP_NETMASK_UNKNOWN) == -1) {
+		LOG_MSG("PCAP: Unable to compile the capture filter: %s", pcap_geterr(adhandle));
+		return;
+	}
+	if (pcap_setfilter(adhandle,&program) == -1)
+		LOG_MSG("PCAP: Unable to set the capture filter: %s", pcap_geterr(adhandle));
+	else
+		LOG_MSG("PCAP: Capture filter: %s", expr);
+	pcap_freecode(&program);
+}
+
 void PcapEthernetConnection::SendPacket(const uint8_t* packet, int len)
 {
 	int ret = pcap_sendpacket(adhandle, packet, len);
@@ -45,9 +45,11 @@ class PcapEthernetConnection : public EthernetConnection {
 		bool Initialize(Section* config) override;
 		void SendPacket(const uint8_t* packet, int len) override;
 		void GetPackets(std::function<void(const uint8_t*, int)> callback) override;
+		void SetReceiveFilter(const uint8_t* mac) override;
 
 	private:
 		pcap_t* adhandle = nullptr; /*!< The pcap handle used for this device */
+		bool filter = true; /*!< Install a capture filter for the adapter's MAC address */
 };
 
 #endif
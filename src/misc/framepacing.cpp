@@ -0,0 +1,116 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <mutex>
+
+#include "dosbox.h"
+#include "cpu.h"
+#include "framepacing.h"
+
+bool framepace_graph = false;
+
+/* QMP reads and resets the statistics from its own thread */
+static std::mutex framepace_mutex;
+static FramePacingStats framepace;
+static uint64_t framepace_retrace_ns = 0;       // host time of the last retrace
+static uint64_t framepace_end_ns = 0;           // host time of RENDER_EndUpdate, 0 if nothing to present
+static uint64_t framepace_end_frame = 0;        // retrace count at RENDER_EndUpdate
+static uint64_t framepace_present_ns = 0;
+static uint64_t framepace_present_frame = 0;
+
+static float framepace_recent[FRAMEPACE_RECENT];
+static unsigned int framepace_recent_pos = 0;
+static unsigned int framepace_recent_count = 0;
+
+static void FRAMEPACE_Add(uint32_t *hist,double ms,double bucket) {
+    unsigned int i = (ms > 0) ? (unsigned int)(ms / bucket) : 0u;
+    if (i >= FRAMEPACE_BUCKETS) i = FRAMEPACE_BUCKETS - 1;
+    hist[i]++;
+}
+
+void FRAMEPACE_Retrace(double period_ms) {
+    const uint64_t now = CPU_Governor_Clock();
+    std::lock_guard<std::mutex> guard(framepace_mutex);
+
+    if (framepace_retrace_ns != 0)
+        FRAMEPACE_Add(framepace.retrace_interval,(double)(now - framepace_retrace_ns) / 1000000.0,FRAMEPACE_INTERVAL_BUCKET);
+    framepace_retrace_ns = now;
+    framepace.period_ms = period_ms;
+    framepace.retraces++;
+}
+
+void FRAMEPACE_EndUpdate(void) {
+    std::lock_guard<std::mutex> guard(framepace_mutex);
+    framepace_end_ns = CPU_Governor_Clock();
+    framepace_end_frame = framepace.retraces;
+}
+
+void FRAMEPACE_Presented(void) {
+    const uint64_t now = CPU_Governor_Clock();
+    std::lock_guard<std::mutex> guard(framepace_mutex);
+    if (framepace_end_ns == 0) return;
+
+    FRAMEPACE_Add(framepace.present_latency,(double)(now - framepace_end_ns) / 1000000.0,FRAMEPACE_LATENCY_BUCKET);
+    framepace.presents++;
+
+    /* an unchanged screen is not presented, only frames that follow each other say something */
+    if (framepace_present_ns != 0 && framepace_present_frame + 1 == framepace_end_frame) {
+        const double interval = (double)(now - framepace_present_ns) / 1000000.0;
+        const bool missed = framepace.period_ms > 0 && interval > framepace.period_ms * 1.5;
+
+        FRAMEPACE_Add(framepace.present_interval,interval,FRAMEPACE_INTERVAL_BUCKET);
+        if (missed) framepace.missed++;
+
+        framepace_recent[framepace_recent_pos] = missed ? -(float)interval : (float)interval;
+        framepace_recent_pos = (framepace_recent_pos + 1) % FRAMEPACE_RECENT;
+        if (framepace_recent_count < FRAMEPACE_RECENT) framepace_recent_count++;
+    }
+
+    framepace_present_ns = now;
+    framepace_present_frame = framepace_end_frame;
+    framepace_end_ns = 0;
+}
+
+void FRAMEPACE_GetStats(FramePacingStats &st) {
+    std::lock_guard<std::mutex> guard(framepace_mutex);
+    st = framepace;
+}
+
+void FRAMEPACE_Reset(void) {
+    std::lock_guard<std::mutex> guard(framepace_mutex);
+    const double period_ms = framepace.period_ms;
+    framepace = FramePacingStats();
+    framepace.period_ms = period_ms;
+    framepace_retrace_ns = 0;
+    framepace_end_ns = 0;
+    framepace_present_ns = 0;
+    framepace_recent_pos = 0;
+    framepace_recent_count = 0;
+}
+
+unsigned int FRAMEPACE_GetRecent(float *intervals,unsigned int count) {
+    std::lock_guard<std::mutex> guard(framepace_mutex);
+    if (count > framepace_recent_count) count = framepace_recent_count;
+
+    unsigned int pos = (framepace_recent_pos + FRAMEPACE_RECENT - count) % FRAMEPACE_RECENT;
+    for (unsigned int i=0;i < count;i++) {
+        intervals[i] = framepace_recent[pos];
+        pos = (pos + 1) % FRAMEPACE_RECENT;
+    }
+    return count;
+}
@@ -0,0 +1,166 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <vector>
+
+#include "dosbox.h"
+#include "mem.h"
+#include "render.h"
+#include "hostmem.h"
+
+#if defined(__linux__)
+# include <sys/mman.h>
+# include <unistd.h>
+#elif defined(WIN32)
+# include <windows.h>
+# define PSAPI_VERSION 2 /* K32GetProcessMemoryInfo, in kernel32 */
+# include <psapi.h>
+#elif defined(MACOSX)
+# include <mach/mach.h>
+#endif
+
+/* blocks below this are not worth asking the host about */
+#define HOSTMEM_MINCORE_MIN     (64u * 1024u)
+
+static std::atomic<int64_t> hostmem_counted[HOSTMEM_MAX];
+
+static const char *hostmem_names[HOSTMEM_MAX] = {
+    "guest-ram", "tlb", "dynrec", "vga", "render", "voodoo", "mixer", "drive-cache", "image-cache", "fonts"
+};
+
+const char *HOSTMEM_Name(unsigned int what) {
+    return what < HOSTMEM_MAX ? hostmem_names[what] : "?";
+}
+
+uint64_t HOSTMEM_Resident(const void *p,size_t size) {
+#if defined(__linux__)
+    if (p == NULL || size < HOSTMEM_MINCORE_MIN) return size;
+
+    const uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    const uintptr_t start = (uintptr_t)p & ~(page - 1u);
+    const uintptr_t end = ((uintptr_t)p + size + page - 1u) & ~(page - 1u);
+    std::vector<unsigned char> vec((end - start) / page);
+    if (mincore((void*)start,end - start,&vec[0]) != 0) return size;
+
+    uint64_t resident = 0;
+    for (const unsigned char v : vec) {
+        if (v & 1u) resident += page;
+    }
+    /* the pages at either end may hold other data too */
+    return resident < size ? resident : size;
+#else
+    (void)p;
+    return size;
+#endif
+}
+
+void HostMemSize::add(const void *p,size_t size) {
+    allocated += size;
+    resident += HOSTMEM_Resident(p,size);
+}
+
+void HOSTMEM_Count(unsigned int what,int64_t bytes) {
+    if (what < HOSTMEM_MAX) hostmem_counted[what].fetch_add(bytes,std::memory_order_relaxed);
+}
+
+static void HOSTMEM_GetRSS(uint64_t &rss,uint64_t &peak) {
+    rss = peak = 0;
+#if defined(__linux__)
+    FILE *fp = fopen("/proc/self/statm","r");
+    if (fp != NULL) {
+        unsigned long long size = 0,resident = 0;
+        if (fscanf(fp,"%llu %llu",&size,&resident) == 2) rss = resident * (uint64_t)sysconf(_SC_PAGESIZE);
+        fclose(fp);
+    }
+    fp = fopen("/proc/self/status","r");
+    if (fp != NULL) {
+        char line[128];
+        unsigned long long kb;
+        while (fgets(line,sizeof(line),fp) != NULL) {
+            if (sscanf(line,"VmHWM: %llu kB",&kb) == 1) peak = kb * 1024u;
+        }
+        fclose(fp);
+    }
+#elif defined(WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(),&pmc,sizeof(pmc))) {
+        rss = pmc.WorkingSetSize;
+        peak = pmc.PeakWorkingSetSize;
+    }
+#elif defined(MACOSX)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(),MACH_TASK_BASIC_INFO,(task_info_t)&info,&count) == KERN_SUCCESS) {
+        rss = info.resident_size;
+        peak = info.resident_size_max;
+    }
+#endif
+}
+
+/* Linux KSM, the per process count needs Linux 6.1 or later */
+static void HOSTMEM_GetMerged(HostMemUsage &usage) {
+#if defined(__linux__)
+    FILE *fp = fopen("/sys/kernel/mm/ksm/run","r");
+    if (fp != NULL) {
+        int run = 0;
+        if (fscanf(fp,"%d",&run) == 1) usage.merging = (run == 1);
+        fclose(fp);
+    }
+    fp = fopen("/proc/self/ksm_merging_pages","r");
+    if (fp != NULL) {
+        unsigned long long pages = 0;
+        if (fscanf(fp,"%llu",&pages) == 1) usage.merged = pages * (uint64_t)sysconf(_SC_PAGESIZE);
+        fclose(fp);
+    }
+#else
+    (void)usage;
+#endif
+}
+
+void HOSTMEM_GetUsage(HostMemUsage &usage) {
+    usage = HostMemUsage();
+
+    MEM_GetHostMemory(usage.what[HOSTMEM_GUESTRAM]);
+    PAGING_GetHostMemory(usage.what[HOSTMEM_TLB]);
+#if C_DYNREC
+    CPU_Core_Dynrec_GetHostMemory(usage.what[HOSTMEM_DYNREC]);
+#endif
+#if C_DYNAMIC_X86
+    CPU_Core_Dyn_X86_GetHostMemory(usage.what[HOSTMEM_DYNREC]);
+#endif
+    VGA_GetHostMemory(usage.what[HOSTMEM_VGA]);
+    RENDER_GetHostMemory(usage.what[HOSTMEM_RENDER]);
+    Voodoo_GetHostMemory(usage.what[HOSTMEM_VOODOO]);
+    MIXER_GetHostMemory(usage.what[HOSTMEM_MIXER]);
+    DOSV_GetHostMemory(usage.what[HOSTMEM_FONTS]);
+#if defined(USE_TTF)
+    TTF_GetHostMemory(usage.what[HOSTMEM_FONTS]);
+#endif
+
+    for (unsigned int i=0;i < HOSTMEM_MAX;i++) {
+        const int64_t counted = hostmem_counted[i].load(std::memory_order_relaxed);
+        if (counted > 0) usage.what[i].add_heap((size_t)counted);
+    }
+
+    HOSTMEM_GetRSS(usage.rss,usage.peak_rss);
+    usage.mergeable = MEM_Mergeable();
+    if (usage.mergeable) HOSTMEM_GetMerged(usage);
+}
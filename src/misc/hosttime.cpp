@@ -0,0 +1,188 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dosbox.h"
+#include "cpu.h"
+#include "hosttime.h"
+#include "tracerec.h"
+
+extern void GFX_SetTitle(int32_t cycles, int frameskip, Bits timing, bool paused);
+
+bool hosttime_enabled = false;
+bool hosttime_scopes = false;
+
+/* only the emulation thread is timed, the IDE and output threads have their own time */
+static thread_local bool hosttime_thread = false;
+
+struct HostTimeFrame {
+    unsigned int    what;
+    const void*     key;
+    uint64_t        start;
+    uint64_t        child_ns;       // time of the scopes inside this one
+    bool            accounted;
+    bool            traced;
+};
+
+struct HostTimeKeyed {
+    unsigned int    what;
+    std::string     name;
+    uint64_t        ns = 0;
+    double          avg = 0;
+};
+
+static HostTimeFrame hosttime_stack[32];
+static unsigned int hosttime_depth = 0;
+static uint64_t hosttime_ns[HOSTTIME_MAX];
+static double hosttime_avg[HOSTTIME_MAX];
+static std::unordered_map<const void*,HostTimeKeyed> hosttime_keyed;
+static uint64_t hosttime_window = 0;
+static bool hosttime_have_avg = false;
+
+static const char* const hosttime_names[HOSTTIME_MAX] = {
+    "cpu", "ev", "vga", "rnd", "out", "mix", "io", "idle"
+};
+
+const char *HOSTTIME_Name(unsigned int what) {
+    return what < HOSTTIME_MAX ? hosttime_names[what] : "?";
+}
+
+bool HOSTTIME_Begin(unsigned int what,const void *key,const char *name) {
+    if (!hosttime_thread || hosttime_depth >= (sizeof(hosttime_stack) / sizeof(hosttime_stack[0]))) return false;
+
+    if (key != NULL && hosttime_enabled) {
+        HostTimeKeyed &k = hosttime_keyed[key];
+        if (k.name.empty()) {
+            char tmp[64];
+            if (name != NULL) snprintf(tmp,sizeof(tmp),"%s",name);
+            else snprintf(tmp,sizeof(tmp),"handler %p",key);
+            k.name = tmp;
+            k.what = what;
+        }
+    }
+
+    HostTimeFrame &f = hosttime_stack[hosttime_depth++];
+    f.what = what;
+    f.key = key;
+    f.child_ns = 0;
+    f.accounted = hosttime_enabled;
+    f.traced = trace_recording && TRACE_Begin(what,key,name);
+    f.start = CPU_Governor_Clock();
+    return true;
+}
+
+void HOSTTIME_End(void) {
+    const uint64_t now = CPU_Governor_Clock();
+    const HostTimeFrame &f = hosttime_stack[--hosttime_depth];
+    const uint64_t total = now - f.start;
+    const uint64_t self = total > f.child_ns ? total - f.child_ns : 0;
+
+    if (f.traced) TRACE_End();
+    if (f.accounted) {
+        hosttime_ns[f.what] += self;
+        if (f.key != NULL) {
+            auto i = hosttime_keyed.find(f.key);
+            if (i != hosttime_keyed.end()) i->second.ns += self;
+        }
+    }
+    if (hosttime_depth != 0) hosttime_stack[hosttime_depth-1].child_ns += total;
+}
+
+void HOSTTIME_Enable(bool enable) {
+    hosttime_thread = true;
+    if (enable && !hosttime_enabled) {
+        for (unsigned int i=0;i < HOSTTIME_MAX;i++) {
+            hosttime_ns[i] = 0;
+            hosttime_avg[i] = 0;
+        }
+        hosttime_keyed.clear();
+        hosttime_window = CPU_Governor_Clock();
+        hosttime_have_avg = false;
+    }
+    hosttime_enabled = enable;
+    hosttime_scopes = enable || trace_recording;
+    GFX_SetTitle(-1,-1,-1,false);
+}
+
+void HOSTTIME_Update(void) {
+    const uint64_t now = CPU_Governor_Clock();
+    if ((now - hosttime_window) < 500000000u) return;
+
+    const double wall = (double)(now - hosttime_window);
+    for (unsigned int i=0;i < HOSTTIME_MAX;i++) {
+        const double share = (double)hosttime_ns[i] / wall;
+        hosttime_avg[i] = hosttime_have_avg ? (hosttime_avg[i] + share) / 2 : share;
+        hosttime_ns[i] = 0;
+    }
+    for (auto i = hosttime_keyed.begin();i != hosttime_keyed.end();) {
+        HostTimeKeyed &k = i->second;
+        const double share = (double)k.ns / wall;
+        k.avg = hosttime_have_avg ? (k.avg + share) / 2 : share;
+        /* handlers that stopped running, or channels that went away */
+        if (k.ns == 0 && k.avg < 0.0001) {
+            i = hosttime_keyed.erase(i);
+            continue;
+        }
+        k.ns = 0;
+        ++i;
+    }
+    hosttime_window = now;
+    hosttime_have_avg = true;
+
+    GFX_SetTitle(-1,-1,-1,false);
+}
+
+std::string HOSTTIME_Summary(void) {
+    std::string r;
+    char tmp[32];
+
+    for (unsigned int i=0;i < HOSTTIME_MAX;i++) {
+        snprintf(tmp,sizeof(tmp),"%s%s %d%%",r.empty() ? "" : " ",hosttime_names[i],(int)(hosttime_avg[i] * 100 + 0.5));
+        r += tmp;
+    }
+
+    return r;
+}
+
+void HOSTTIME_GetShares(double share[HOSTTIME_MAX],double &other) {
+    other = 1;
+    for (unsigned int i=0;i < HOSTTIME_MAX;i++) {
+        share[i] = hosttime_avg[i];
+        other -= share[i];
+    }
+    if (other < 0) other = 0;
+}
+
+void HOSTTIME_GetStats(double share[HOSTTIME_MAX],double &other,std::vector<HostTimeEntry> &entries) {
+    HOSTTIME_GetShares(share,other);
+
+    entries.clear();
+    for (const auto &i : hosttime_keyed) {
+        HostTimeEntry e;
+        e.name = i.second.name;
+        e.what = i.second.what;
+        e.share = i.second.avg;
+        entries.push_back(e);
+    }
+    std::sort(entries.begin(),entries.end(),[](const HostTimeEntry &a,const HostTimeEntry &b) { return a.share > b.share; });
+}
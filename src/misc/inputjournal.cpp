@@ -0,0 +1,278 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "dosbox.h"
+#include "logging.h"
+#include "setup.h"
+#include "control.h"
+#include "cpu.h"
+#include "pic.h"
+#include "timer.h"
+#include "mouse.h"
+#include "joystick.h"
+#include "inputjournal.h"
+
+void ResolvePath(std::string& in);
+
+static_assert(sizeof(InputJournalRecord) == 32, "InputJournalRecord layout changed, bump INPUTJOURNAL_VERSION");
+
+bool input_journal_active = false;
+
+static FILE *journal_fp = NULL;                     // recording
+static bool journal_header = false;                 // recording: the header is written
+
+static std::vector<InputJournalRecord> journal;     // replaying
+static size_t journal_pos = 0;
+static bool journal_replay = false;
+static bool journal_injecting = false;              // the event comes from the journal, not live
+static bool journal_started = false;
+static uint32_t journal_host_start = 0;
+
+static void INPUTJOURNAL_WriteHeader(void) {
+    InputJournalHeader hdr;
+    memset(&hdr,0,sizeof(hdr));
+    memcpy(hdr.magic,INPUTJOURNAL_MAGIC,sizeof(hdr.magic));
+    hdr.version = INPUTJOURNAL_VERSION;
+    hdr.record_size = sizeof(InputJournalRecord);
+    hdr.byte_order = 0x01020304u;
+    hdr.cycles = CPU_CycleAutoAdjust ? 0u : (uint32_t)CPU_CycleMax;
+    fwrite(&hdr,sizeof(hdr),1,journal_fp);
+    journal_header = true;
+
+    if (CPU_CycleAutoAdjust)
+        LOG_MSG("Input journal: cycles are not fixed, replaying this recording will not be repeatable");
+}
+
+/* true if the event goes on to the guest */
+static bool INPUTJOURNAL_Record(uint8_t kind,uint8_t which,uint8_t num,uint8_t flags,float v0=0,float v1=0,float v2=0,float v3=0) {
+    if (journal_replay) return journal_injecting;
+    if (journal_fp == NULL) return true;
+    if (!journal_header) INPUTJOURNAL_WriteHeader();
+
+    const Bits cycle = PIC_TickIndexND();
+    InputJournalRecord r;
+    memset(&r,0,sizeof(r));
+    r.tick = (uint64_t)PIC_Ticks;
+    r.cycle = cycle > 0 ? (uint32_t)cycle : 0u;
+    r.kind = kind;
+    r.which = which;
+    r.num = num;
+    r.flags = flags;
+    r.v[0] = v0;
+    r.v[1] = v1;
+    r.v[2] = v2;
+    r.v[3] = v3;
+    fwrite(&r,sizeof(r),1,journal_fp);
+    return true;
+}
+
+bool INPUTJOURNAL_Key(KBD_KEYS key,bool pressed) {
+    return INPUTJOURNAL_Record(INPUTJOURNAL_KEY,(uint8_t)key,0,pressed ? INPUTJOURNAL_PRESSED : 0);
+}
+
+bool INPUTJOURNAL_MouseButton(uint8_t button,bool pressed) {
+    return INPUTJOURNAL_Record(INPUTJOURNAL_MOUSE_BUTTON,button,0,pressed ? INPUTJOURNAL_PRESSED : 0);
+}
+
+bool INPUTJOURNAL_MouseMove(float xrel,float yrel,float x,float y,bool emulate) {
+    return INPUTJOURNAL_Record(INPUTJOURNAL_MOUSE_MOVE,0,0,emulate ? INPUTJOURNAL_EMULATE : 0,xrel,yrel,x,y);
+}
+
+bool INPUTJOURNAL_JoyButton(Bitu which,Bitu num,bool pressed) {
+    return INPUTJOURNAL_Record(INPUTJOURNAL_JOY_BUTTON,(uint8_t)which,(uint8_t)num,pressed ? INPUTJOURNAL_PRESSED : 0);
+}
+
+bool INPUTJOURNAL_JoyMove(Bitu which,bool y,float pos) {
+    return INPUTJOURNAL_Record(y ? INPUTJOURNAL_JOY_Y : INPUTJOURNAL_JOY_X,(uint8_t)which,0,0,pos);
+}
+
+static void INPUTJOURNAL_Inject(const InputJournalRecord &r) {
+    const bool pressed = (r.flags & INPUTJOURNAL_PRESSED) != 0;
+
+    journal_injecting = true;
+    switch (r.kind) {
+        case INPUTJOURNAL_KEY:
+            KEYBOARD_AddKey((KBD_KEYS)r.which,pressed);
+            break;
+        case INPUTJOURNAL_MOUSE_BUTTON:
+            if (pressed) Mouse_ButtonPressed(r.which);
+            else Mouse_ButtonReleased(r.which);
+            break;
+        case INPUTJOURNAL_MOUSE_MOVE:
+            Mouse_CursorMoved(r.v[0],r.v[1],r.v[2],r.v[3],(r.flags & INPUTJOURNAL_EMULATE) != 0);
+            break;
+        case INPUTJOURNAL_JOY_BUTTON:
+            JOYSTICK_Button(r.which,r.num,pressed);
+            break;
+        case INPUTJOURNAL_JOY_X:
+            JOYSTICK_Move_X(r.which,r.v[0]);
+            break;
+        case INPUTJOURNAL_JOY_Y:
+            JOYSTICK_Move_Y(r.which,r.v[0]);
+            break;
+    }
+    journal_injecting = false;
+}
+
+/* every event up to the current tick and cycle */
+static void INPUTJOURNAL_InjectDue(bool whole_tick) {
+    const uint64_t tick = (uint64_t)PIC_Ticks;
+    const Bits cycle = PIC_TickIndexND();
+
+    while (journal_pos < journal.size()) {
+        const InputJournalRecord &r = journal[journal_pos];
+        if (r.tick > tick || (r.tick == tick && !whole_tick && (Bits)r.cycle > cycle)) break;
+        journal_pos++;
+        INPUTJOURNAL_Inject(r);
+    }
+
+    if (journal_pos == journal.size()) {
+        LOG_MSG("Input journal: replay finished at %llu ms emulated time, %.3f s host time",
+            (unsigned long long)PIC_Ticks,(double)(GetTicks() - journal_host_start) / 1000.0);
+        journal_replay = false;
+        input_journal_active = false;
+        std::vector<InputJournalRecord>().swap(journal);
+    }
+}
+
+static void INPUTJOURNAL_Event(Bitu /*val*/);
+
+/* the next event within this tick, at its cycle. Events at or past the end of the tick were
+ * delivered between ticks, where INPUTJOURNAL_Poll picks them up. */
+static void INPUTJOURNAL_Schedule(void) {
+    if (!journal_replay || journal_pos >= journal.size()) return;
+
+    const InputJournalRecord &r = journal[journal_pos];
+    if (r.tick != (uint64_t)PIC_Ticks || (Bits)r.cycle >= CPU_CycleMax) return;
+    PIC_AddEvent(INPUTJOURNAL_Event,(pic_tickindex_t)((Bits)r.cycle - PIC_TickIndexND()) / (pic_tickindex_t)CPU_CycleMax);
+}
+
+static void INPUTJOURNAL_Event(Bitu /*val*/) {
+    if (!journal_replay) return;
+    INPUTJOURNAL_InjectDue(false);
+    INPUTJOURNAL_Schedule();
+}
+
+static void INPUTJOURNAL_Tick(void) {
+    if (!journal_replay) return;
+
+    if (!journal_started) {
+        journal_started = true;
+        journal_host_start = GetTicks();
+    }
+    INPUTJOURNAL_InjectDue(false);
+    INPUTJOURNAL_Schedule();
+}
+
+void INPUTJOURNAL_Poll(void) {
+    if (journal_replay) INPUTJOURNAL_InjectDue(true);
+}
+
+bool INPUTJOURNAL_Replaying(void) {
+    return journal_replay;
+}
+
+static void INPUTJOURNAL_Shutdown(Section* /*sec*/) {
+    if (journal_fp != NULL) {
+        fclose(journal_fp);
+        journal_fp = NULL;
+    }
+    journal_replay = false;
+    input_journal_active = false;
+    std::vector<InputJournalRecord>().swap(journal);
+}
+
+static bool INPUTJOURNAL_Load(const std::string& path) {
+    FILE *fp = fopen(path.c_str(),"rb");
+    if (fp == NULL) {
+        LOG_MSG("Input journal: cannot open '%s': %s",path.c_str(),strerror(errno));
+        return false;
+    }
+
+    InputJournalHeader hdr;
+    if (fread(&hdr,sizeof(hdr),1,fp) != 1 || memcmp(hdr.magic,INPUTJOURNAL_MAGIC,sizeof(hdr.magic)) != 0 ||
+        hdr.version != INPUTJOURNAL_VERSION || hdr.record_size != sizeof(InputJournalRecord) || hdr.byte_order != 0x01020304u) {
+        LOG_MSG("Input journal: '%s' is not an input journal of this version and host",path.c_str());
+        fclose(fp);
+        return false;
+    }
+
+    InputJournalRecord r;
+    journal.clear();
+    while (fread(&r,sizeof(r),1,fp) == 1) journal.push_back(r);
+    fclose(fp);
+
+    if (hdr.cycles == 0)
+        LOG_MSG("Input journal: recorded without fixed cycles, the guest may not get the input at the same point");
+    else if (CPU_CycleAutoAdjust || (uint32_t)CPU_CycleMax != hdr.cycles)
+        LOG_MSG("Input journal: recorded with cycles=%u, set the same fixed cycles for an exact replay",(unsigned int)hdr.cycles);
+
+    LOG_MSG("Input journal: replaying %u events from '%s'",(unsigned int)journal.size(),path.c_str());
+    return true;
+}
+
+void INPUTJOURNAL_Init(const std::string& record,const std::string& replay) {
+    static bool registered = false;
+    if (!registered) {
+        registered = true;
+        AddExitFunction(AddExitFunctionFuncPair(INPUTJOURNAL_Shutdown));
+        TIMER_AddTickHandler(INPUTJOURNAL_Tick);
+    }
+    INPUTJOURNAL_Shutdown(NULL);
+
+    std::string path;
+    if (!replay.empty()) {
+        path = replay;
+        ResolvePath(path);
+        if (!INPUTJOURNAL_Load(path)) return;
+        journal_pos = 0;
+        journal_started = false;
+        journal_replay = true;
+    }
+    else if (!record.empty()) {
+        path = record;
+        ResolvePath(path);
+        journal_fp = fopen(path.c_str(),"wb");
+        if (journal_fp == NULL) {
+            LOG_MSG("Input journal: cannot open '%s': %s",path.c_str(),strerror(errno));
+            return;
+        }
+        journal_header = false;
+        LOG_MSG("Input journal: recording to '%s'",path.c_str());
+    }
+    else {
+        return;
+    }
+
+    input_journal_active = true;
+
+    /* both roll emulated time back, the journal only goes forward */
+    if (runahead_frames != 0 || rewind_interval != 0) {
+        LOG_MSG("Input journal: run-ahead and rewind are turned off while input is recorded or replayed");
+        runahead_frames = 0;
+        rewind_interval = 0;
+        RUNAHEAD_Reset();
+        REWIND_Reset();
+    }
+}
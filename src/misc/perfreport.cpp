@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "dosbox.h"
+#include "logging.h"
+#include "setup.h"
+#include "cpu.h"
+#include "pic.h"
+#include "paging.h"
+#include "render.h"
+#include "mixer.h"
+#include "bios_disk.h"
+#include "hosttime.h"
+#include "perfreport.h"
+#include "startupprof.h"
+
+static std::string perf_path;
+static uint64_t perf_host_start = 0;        // CPU_Governor_Clock at the start
+static uint64_t perf_cycles_start = 0;
+static Bitu perf_ticks_start = 0;
+
+static void PERFREPORT_Write(Section* /*sec*/) {
+    if (perf_path.empty()) return;
+
+    const double host_s = (double)(CPU_Governor_Clock() - perf_host_start) / 1e9;
+    const double emu_s = (double)(PIC_Ticks - perf_ticks_start) / 1000.0;
+    const uint64_t cycles = CPU_CyclesTotal - perf_cycles_start;
+
+    FILE *fp = (perf_path == "-") ? stdout : fopen(perf_path.c_str(),"w");
+    if (fp == NULL) {
+        LOG_MSG("Perf report: cannot open '%s': %s",perf_path.c_str(),strerror(errno));
+        return;
+    }
+
+    uint64_t tlb_flushes, tlb_flushes_per_sec;
+    PAGING_GetTLBFlushStats(tlb_flushes,tlb_flushes_per_sec);
+    MIXER_AudioStats audio;
+    MIXER_GetAudioStats(audio);
+
+    fprintf(fp,"{\"host-seconds\": %.3f, \"emulated-seconds\": %.3f, \"emulated-speed\": %.3f, ",
+        host_s,emu_s,host_s > 0 ? emu_s / host_s : 0.0);
+    fprintf(fp,"\"cycles\": %llu, \"mips\": %.3f, ",
+        (unsigned long long)cycles,host_s > 0 ? (double)cycles / host_s / 1000000.0 : 0.0);
+    fprintf(fp,"\"frames-rendered\": %llu, \"frames-skipped\": %llu, \"audio-underruns\": %llu, \"tlb-flushes\": %llu, ",
+        (unsigned long long)render_frames_rendered,(unsigned long long)render_frames_skipped,
+        (unsigned long long)audio.underruns,(unsigned long long)tlb_flushes);
+    fprintf(fp,"\"disk-bytes-read\": %llu, \"disk-bytes-written\": %llu, ",
+        (unsigned long long)disk_io_bytes_read,(unsigned long long)disk_io_bytes_written);
+    /* process start to the first DOS prompt */
+    if (STARTUP_PromptMs() >= 0)
+        fprintf(fp,"\"startup-ms\": %.1f, \"dynrec\": ",STARTUP_PromptMs());
+    else
+        fprintf(fp,"\"startup-ms\": null, \"dynrec\": ");
+#if C_DYNREC
+    DynrecCacheStats dynrec;
+    if (CPU_Core_Dynrec_GetCacheStats(dynrec))
+        fprintf(fp,"{\"pages-used\": %llu, \"pages-total\": %llu, \"page-flushes\": %llu, \"wraps\": %llu, \"resets\": %llu}",
+            (unsigned long long)dynrec.pages_used,(unsigned long long)dynrec.pages_total,(unsigned long long)dynrec.page_flushes,
+            (unsigned long long)dynrec.wraps,(unsigned long long)dynrec.resets);
+    else
+        fprintf(fp,"null");
+#else
+    fprintf(fp,"null");
+#endif
+
+    /* only measured with "host time accounting" on */
+    if (hosttime_enabled) {
+        static const char *const host_time_names[HOSTTIME_MAX] = {
+            "cpu", "events", "vga", "render", "output", "mixer", "disk", "idle"
+        };
+        double share[HOSTTIME_MAX], other;
+        HOSTTIME_GetShares(share,other);
+        fprintf(fp,", \"host-time\": {");
+        for (unsigned int i = 0;i < HOSTTIME_MAX;i++)
+            fprintf(fp,"\"%s\": %.4f, ",host_time_names[i],share[i]);
+        fprintf(fp,"\"other\": %.4f}",other);
+    }
+    fprintf(fp,"}\n");
+
+    if (fp == stdout) fflush(fp);
+    else fclose(fp);
+    perf_path.clear();
+}
+
+void PERFREPORT_Start(const std::string& path) {
+    if (path.empty() || !perf_path.empty()) return;
+
+    perf_path = path;
+    perf_host_start = CPU_Governor_Clock();
+    perf_cycles_start = CPU_CyclesTotal;
+    perf_ticks_start = PIC_Ticks;
+    AddExitFunction(AddExitFunctionFuncPair(PERFREPORT_Write));
+}
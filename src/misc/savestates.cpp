@@ -6,6 +6,10 @@
 #include <string>
 #include <cstring>
 #include <fstream>
+#include <random>
+#include <atomic>
+#include <thread>
+#include <deque>
 #include "SDL.h"
 #include "menu.h"
 #include "shell.h"
@@ -15,6 +19,7 @@
 #include "control.h"
 #include "logging.h"
 #include "mixer.h"
+#include "hardware.h"
 #include "build_timestamp.h"
 #ifdef WIN32
 #include "direct.h"
@@ -26,6 +31,13 @@
 #if defined(unix) || defined(__APPLE__)
 # include <utime.h>
 #endif
+/* snapshot save states: fork() a child that writes a copy-on-write image of the emulator */
+#if (defined(unix) || defined(__APPLE__)) && !defined(C_EMSCRIPTEN)
+# define SAVESTATE_SNAPSHOT
+# include <errno.h>
+# include <unistd.h>
+# include <sys/wait.h>
+#endif
 
 #define MAXU32 0xffffffff
 #include "zip.h"
@@ -35,6 +47,23 @@
 #include "vs/zlib/contrib/minizip/unzip.c"
 #include "vs/zlib/contrib/minizip/ioapi.c"
 #include "zipcppstdbuf.h"
+/* zstd save state files. The decompressor is built with the CHD support in cdrom_image.cpp */
+#include "threadpool.h"
+#include "tracerec.h"
+#include "src/libs/libchdr/zstd/zstd.h"
+#include "src/libs/libchdr/zstd/common/xxhash.c"
+#include "src/libs/libchdr/zstd/compress/hist.c"
+#include "src/libs/libchdr/zstd/compress/fse_compress.c"
+#include "src/libs/libchdr/zstd/compress/huf_compress.c"
+#include "src/libs/libchdr/zstd/compress/zstd_compress_literals.c"
+#include "src/libs/libchdr/zstd/compress/zstd_compress_sequences.c"
+#include "src/libs/libchdr/zstd/compress/zstd_compress_superblock.c"
+#include "src/libs/libchdr/zstd/compress/zstd_double_fast.c"
+#include "src/libs/libchdr/zstd/compress/zstd_fast.c"
+#include "src/libs/libchdr/zstd/compress/zstd_lazy.c"
+#include "src/libs/libchdr/zstd/compress/zstd_ldm.c"
+#include "src/libs/libchdr/zstd/compress/zstd_opt.c"
+#include "src/libs/libchdr/zstd/compress/zstd_compress.c"
 #if !defined(HX_DOS)
 #include "../libs/tinyfiledialogs/tinyfiledialogs.h"
 #endif
@@ -52,6 +81,37 @@ bool auto_save_state=false;
 bool noremark_save_state = false;
 bool force_load_state = false;
 std::string saveloaderr="";
+bool savestate_snapshot_running = false;
+unsigned int runahead_frames = 0;
+bool runahead_hidden = false;
+bool runahead_ahead = false;
+bool runahead_pending = false;
+static unsigned int runahead_left = 0;
+static bool runahead_restore = false;
+static SaveState::MemoryState runahead_state;
+unsigned int rewind_interval = 0;
+size_t rewind_budget = 0;
+bool rewind_pending = false;
+static unsigned int rewind_frames = 0;                  /* real frames since the last capture */
+static bool rewind_step = false;
+static SaveState::MemoryState rewind_state, rewind_scratch;
+static std::deque<std::string> rewind_ring;             /* reverse deltas, oldest first */
+static size_t rewind_ring_bytes = 0;
+static size_t background_slot = 0;
+static bool snapshot_child = false; /* the pool workers did not survive fork(), do not queue tasks to them */
+#if defined(SAVESTATE_SNAPSHOT)
+static pid_t snapshot_pid = -1;
+#endif
+
+/* background save states: captured in memory, then compressed and written on a thread of their own */
+static struct SaveStateWriter {
+	std::thread thread;
+	std::atomic<bool> done{false};
+	bool failed = false;
+	SaveState::Entries entries;
+
+	~SaveStateWriter() { if (thread.joinable()) thread.join(); } /* finish the file when quitting */
+} savestate_writer;
 
 #if C_REMOTEDEBUG
 // Async save/load state request mechanism for QMP
@@ -59,13 +119,23 @@ std::string saveloaderr="";
 #include <mutex>
 #include <condition_variable>
 
-enum class SaveStateRequest { NONE, SAVE, LOAD };
+enum class SaveStateRequest { NONE, SAVE, LOAD, SAVE_SLOT, LOAD_SLOT, PERSIST_SLOT, DELETE_SLOT };
 static std::atomic<SaveStateRequest> pending_savestate_request{SaveStateRequest::NONE};
 static std::string pending_savestate_path;
+static std::string pending_savestate_slot;
 static std::string savestate_result_error;
 static std::atomic<bool> savestate_request_complete{false};
 static std::mutex savestate_mutex;
 static std::condition_variable savestate_cv;
+static bool savestate_qmp_writing = false; /* the requested save is still written in the background */
+
+/* named states kept in host memory for QMP clients, they never touch the file system unless persisted.
+ * Only the main loop changes them, with savestate_mutex held so the QMP thread can list them. */
+struct SaveStateSlot {
+	SaveState::MemoryState state;
+	std::string program;    /* RunningProgram when saved, for the state file if it is persisted */
+};
+static std::map<std::string,SaveStateSlot> savestate_slots;
 #endif
 void refresh_slots(void);
 void GFX_LosingFocus(void), GFX_ReleaseMouse(void), MAPPER_ReleaseAllKeys(void), resetFontSize(void);
@@ -336,6 +406,34 @@ void SAVESTATE_RequestLoad(const std::string& filepath) {
     pending_savestate_request.store(SaveStateRequest::LOAD);
 }
 
+// Request an in-memory slot operation (called from QMP thread), filepath is for PERSIST_SLOT only
+static void SAVESTATE_RequestSlot(SaveStateRequest req, const std::string& slot, const std::string& filepath) {
+    std::lock_guard<std::mutex> lock(savestate_mutex);
+    pending_savestate_slot = slot;
+    pending_savestate_path = filepath;
+    savestate_result_error.clear();
+    savestate_request_complete.store(false);
+    pending_savestate_request.store(req);
+}
+
+void SAVESTATE_RequestSaveSlot(const std::string& slot) { SAVESTATE_RequestSlot(SaveStateRequest::SAVE_SLOT, slot, ""); }
+void SAVESTATE_RequestLoadSlot(const std::string& slot) { SAVESTATE_RequestSlot(SaveStateRequest::LOAD_SLOT, slot, ""); }
+void SAVESTATE_RequestDeleteSlot(const std::string& slot) { SAVESTATE_RequestSlot(SaveStateRequest::DELETE_SLOT, slot, ""); }
+void SAVESTATE_RequestPersistSlot(const std::string& slot, const std::string& filepath) {
+    SAVESTATE_RequestSlot(SaveStateRequest::PERSIST_SLOT, slot, filepath);
+}
+
+// Names and sizes of the in-memory slots (called from QMP thread)
+void SAVESTATE_ListSlots(std::vector<std::pair<std::string, size_t> >& slots) {
+    std::lock_guard<std::mutex> lock(savestate_mutex);
+    slots.clear();
+    for (auto i = savestate_slots.begin(); i != savestate_slots.end(); ++i) {
+        size_t bytes = 0;
+        for (size_t c = 0; c < i->second.state.size(); c++) bytes += i->second.state[c].size();
+        slots.push_back(std::make_pair(i->first, bytes));
+    }
+}
+
 // Check if request is still pending
 bool SAVESTATE_IsPending() {
     return pending_savestate_request.load() != SaveStateRequest::NONE;
@@ -351,17 +449,75 @@ bool SAVESTATE_IsComplete(std::string& error_out) {
     return false;
 }
 
+// Wait for the request to complete and get error (empty string = success), false on timeout
+bool SAVESTATE_WaitComplete(int timeout_ms, std::string& error_out) {
+    std::unique_lock<std::mutex> lock(savestate_mutex);
+    if (!savestate_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [] { return savestate_request_complete.load(); }))
+        return false;
+    error_out = savestate_result_error;
+    return true;
+}
+
 // Called from main loop to process pending save/load requests
+static void SAVESTATE_QMPComplete(const std::string& error) {
+    {
+        // under the lock, so SAVESTATE_WaitComplete cannot miss the notification
+        std::lock_guard<std::mutex> lock(savestate_mutex);
+        savestate_result_error = error;
+        pending_savestate_request.store(SaveStateRequest::NONE);
+        savestate_request_complete.store(true);
+    }
+    savestate_cv.notify_all();
+}
+
+// In-memory slot requests, no files and no dialogs. Loading is what fuzzing clients do most, it costs
+// one copy of every component, like a run-ahead frame.
+static std::string SAVESTATE_RunSlotRequest(SaveStateRequest req, const std::string& slot, const std::string& filepath) {
+    auto i = savestate_slots.find(slot);
+    if (req != SaveStateRequest::SAVE_SLOT && i == savestate_slots.end())
+        return "No in-memory state named '" + slot + "'";
+
+    if (req == SaveStateRequest::SAVE_SLOT) {
+        if((MEM_TotalPages()*4096/1024/1024)>1024)
+            return "Unsupported memory size for saving states.";
+        /* a slot saved over keeps its buffers, saving the same slot again does not allocate */
+        SaveStateSlot s;
+        if (i != savestate_slots.end()) {
+            std::lock_guard<std::mutex> lock(savestate_mutex);
+            s.state.swap(i->second.state);
+        }
+        SaveState::instance().saveMemory(s.state);
+        s.program = RunningProgram;
+        std::lock_guard<std::mutex> lock(savestate_mutex);
+        savestate_slots[slot] = std::move(s);
+    } else if (req == SaveStateRequest::LOAD_SLOT) {
+        const bool updating = render.updating;
+        SaveState::instance().loadMemory(i->second.state);
+        render.updating = updating;
+        /* neither the run-ahead state nor the pages written since the last save state apply any more */
+        RUNAHEAD_Reset();
+        SaveState::instance().resetChain();
+    } else if (req == SaveStateRequest::PERSIST_SLOT) {
+        if (SaveState::instance().writeMemory(filepath, i->second.state, i->second.program.c_str()))
+            return "Writing " + filepath + " failed";
+    } else if (req == SaveStateRequest::DELETE_SLOT) {
+        std::lock_guard<std::mutex> lock(savestate_mutex);
+        savestate_slots.erase(i);
+    }
+    return "";
+}
+
 bool SAVESTATE_CheckPendingRequest() {
     SaveStateRequest req = pending_savestate_request.load();
-    if (req == SaveStateRequest::NONE) {
+    if (req == SaveStateRequest::NONE || savestate_qmp_writing) {
         return false;
     }
 
-    std::string filepath;
+    std::string filepath, slot;
     {
         std::lock_guard<std::mutex> lock(savestate_mutex);
         filepath = pending_savestate_path;
+        slot = pending_savestate_slot;
     }
 
     // Set up to use file instead of slot, and disable dialogs
@@ -376,9 +532,13 @@ bool SAVESTATE_CheckPendingRequest() {
 
     std::string error;
     try {
-        if (req == SaveStateRequest::SAVE) {
+        if (req != SaveStateRequest::SAVE && req != SaveStateRequest::LOAD) {
+            error = SAVESTATE_RunSlotRequest(req, slot, filepath);
+        } else if (req == SaveStateRequest::SAVE) {
             LOG_MSG("SAVESTATE: Saving to file: %s", filepath.c_str());
             SaveState::instance().save(0);  // Slot doesn't matter when use_save_file is true
+            // The client expects the file to be complete, a background save answers when it is done
+            savestate_qmp_writing = savestate_snapshot_running;
         } else if (req == SaveStateRequest::LOAD) {
             LOG_MSG("SAVESTATE: Loading from file: %s", filepath.c_str());
             if (!GFX_IsFullscreen() && render.aspect) GFX_LosingFocus();
@@ -405,18 +565,58 @@ bool SAVESTATE_CheckPendingRequest() {
     force_load_state = old_force_load_state;
 
     // Signal completion
-    {
-        std::lock_guard<std::mutex> lock(savestate_mutex);
-        savestate_result_error = error;
+    if (!savestate_qmp_writing || !error.empty()) {
+        savestate_qmp_writing = false;
+        SAVESTATE_QMPComplete(error);
     }
-    pending_savestate_request.store(SaveStateRequest::NONE);
-    savestate_request_complete.store(true);
-    savestate_cv.notify_all();
 
     return true;
 }
 #endif
 
+static void SAVESTATE_BackgroundDone(bool failed) {
+	savestate_snapshot_running = false;
+	if (failed) {
+		SaveState::instance().resetChain(); /* nothing may be saved on top of it */
+		notifyError(MSG_Get("SAVE_FAILED"));
+	}
+	else
+		LOG_MSG("[%s]: Saved. (Slot %d)", getTime().c_str(), (int)background_slot+1);
+#if C_REMOTEDEBUG
+	if (savestate_qmp_writing) {
+		savestate_qmp_writing = false;
+		SAVESTATE_QMPComplete(failed ? "Save state failed" : "");
+	}
+#endif
+}
+
+/* Collect a background save state, the writer thread or the child of a snapshot save state. With wait=false
+ * this only checks whether it is done, the main loop calls it that way while savestate_snapshot_running is set. */
+void SAVESTATE_FinishSnapshot(bool wait) {
+	if (savestate_writer.thread.joinable()) {
+		if (!wait && !savestate_writer.done) return; /* still writing */
+
+		savestate_writer.thread.join();
+		SaveState::Entries().swap(savestate_writer.entries);
+		SAVESTATE_BackgroundDone(savestate_writer.failed);
+	}
+#if defined(SAVESTATE_SNAPSHOT)
+	if (snapshot_pid <= 0) return;
+
+	int status = 0;
+	pid_t r;
+	do {
+		r = waitpid(snapshot_pid,&status,wait ? 0 : WNOHANG);
+	} while (r < 0 && errno == EINTR);
+	if (r == 0) return; /* still writing */
+
+	snapshot_pid = -1;
+	SAVESTATE_BackgroundDone(r < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0);
+#else
+	(void)wait;
+#endif
+}
+
 void ShowStateInfo(bool pressed) {
 	if (!pressed) return;
 	std::string message = "Save to: "+(use_save_file&&savefilename.size()?"File "+savefilename:"Slot "+std::to_string(GetGameState_Run()+1))+"\n"+SaveState::instance().getName(GetGameState_Run(), true);
@@ -435,6 +635,8 @@ void AddSaveStateMapper() {
 	item->set_text("Select previous slot");
 	MAPPER_AddHandler(NextSaveSlot, MK_period, MMODHOST,"nextslot","Next save slot", &item);
 	item->set_text("Select next slot");
+	MAPPER_AddHandler(REWIND_Step, MK_z, MMODHOST,"rewind","Rewind", &item);
+	item->set_text("Rewind");
 }
 
 #ifndef WIN32
@@ -477,6 +679,340 @@ void SaveState::registerComponent(const std::string& uniqueName, Component& comp
 	components.insert(std::make_pair(uniqueName, CompData(comp)));
 }
 
+/* unbuffered streams over a SaveState::Writer or Reader, every write() and read() is passed on as one span */
+class writer_ostreambuf : public std::streambuf {
+public:
+	writer_ostreambuf(SaveState::Writer &n_out) : basic_streambuf(), out(n_out) { }
+protected:
+	std::streamsize xsputn(const char_type *p, std::streamsize count) override {
+		out.write(p,(size_t)count);
+		return count;
+	}
+	int_type overflow(int_type c) override {
+		if (c != traits_type::eof()) {
+			const char_type ch = traits_type::to_char_type(c);
+			out.write(&ch,1);
+		}
+		return traits_type::not_eof(c);
+	}
+private:
+	SaveState::Writer &out;
+};
+
+class reader_istreambuf : public std::streambuf {
+public:
+	reader_istreambuf(SaveState::Reader &n_in) : basic_streambuf(), in(n_in) { }
+protected:
+	std::streamsize xsgetn(char_type *p, std::streamsize count) override {
+		std::streamsize got = 0;
+		if (count > 0 && gptr() < egptr()) { /* the character underflow() read ahead */
+			*p++ = *gptr();
+			gbump(1);
+			count--;
+			got++;
+		}
+		return got + (std::streamsize)in.read(p,(size_t)count);
+	}
+	int_type underflow() override {
+		if (in.read(&ch,1) != 1) return traits_type::eof();
+		setg(&ch,&ch,&ch + 1);
+		return traits_type::to_int_type(ch);
+	}
+private:
+	SaveState::Reader &in;
+	char_type ch = 0;
+};
+
+/* a state held in memory: background save states, run-ahead and entries of zstd state files */
+class string_writer : public SaveState::Writer {
+public:
+	string_writer(std::string &n_s) : s(n_s) { }
+	void write(const void *data, size_t size) override {
+		s.append((const char*)data,size);
+	}
+private:
+	std::string &s;
+};
+
+class string_reader : public SaveState::Reader {
+public:
+	string_reader(const std::string &n_s) : s(n_s) { }
+	size_t read(void *data, size_t size) override {
+		if (size > s.size() - pos) size = s.size() - pos;
+		memcpy(data,s.data() + pos,size);
+		pos += size;
+		return size;
+	}
+private:
+	const std::string &s;
+	size_t pos = 0;
+};
+
+void SaveState::Component::getChunks(Writer& out) {
+	writer_ostreambuf sb(out); std::ostream ss(&sb);
+	getBytes(ss);
+}
+
+void SaveState::Component::setChunks(Reader& in) {
+	reader_istreambuf sb(in); std::istream ss(&sb);
+	setBytes(ss);
+}
+
+/* a component in a state file, all of it or only what changed since the state it is saved on top of */
+static void WriteComponent(SaveState::Component& comp, bool delta, SaveState::Writer& out) {
+	if (delta) {
+		writer_ostreambuf sb(out); std::ostream ss(&sb);
+		comp.getDelta(ss);
+	}
+	else {
+		comp.getChunks(out);
+	}
+}
+
+static void ReadComponent(SaveState::Component& comp, bool delta, SaveState::Reader& in) {
+	if (delta) {
+		reader_istreambuf sb(in); std::istream ss(&sb);
+		comp.setDelta(ss);
+	}
+	else {
+		comp.setChunks(in);
+	}
+}
+
+void SaveState::saveMemory(MemoryState& state) {
+	TraceScope trace("state save to memory");
+	state.resize(components.size());
+
+	size_t n = 0;
+	for (CompEntry::iterator i = components.begin(); i != components.end(); ++i, ++n) {
+		state[n].clear(); /* keeps its capacity, so run-ahead does not allocate frame after frame */
+		string_writer out(state[n]);
+		i->second.comp.getChunks(out);
+	}
+}
+
+void SaveState::loadMemory(const MemoryState& state) const {
+	TraceScope trace("state load from memory");
+	if (state.size() != components.size()) return;
+
+	size_t n = 0;
+	for (CompEntry::const_iterator i = components.begin(); i != components.end(); ++i, ++n) {
+		string_reader in(state[n]);
+		i->second.comp.setChunks(in);
+	}
+}
+
+/* Run-ahead. VGA_VerticalTimer calls RUNAHEAD_Retrace at every emulated retrace:
+ *
+ *   real frame ends    -> save, then run runahead_frames frames ahead with the input as it is now
+ *   ahead frames       -> no input, no sound, not throttled, only the last one is presented
+ *   last ahead frame   -> roll back to the save and run the next real frame (not presented)
+ *
+ * A game that takes a frame or two to react to input then shows the reaction that much sooner.
+ * Saving and loading happen in RUNAHEAD_Check from the main loop, outside the CPU core and PIC
+ * events, the same place QMP save states are handled. */
+void RUNAHEAD_Retrace(void) {
+	if (runahead_frames == 0 || (CaptureState & (CAPTURE_WAVE|CAPTURE_VIDEO|CAPTURE_MULTITRACK_WAVE|CAPTURE_IMAGE)) != 0) {
+		if (runahead_ahead) {
+			/* turned off or capture started while ahead, go back to the real frame first */
+			runahead_left = 0;
+			runahead_restore = true;
+			runahead_pending = true;
+		}
+		runahead_hidden = false;
+		return;
+	}
+
+	if (!runahead_ahead) {
+		runahead_left = runahead_frames;
+		runahead_restore = false;
+		runahead_pending = true;
+		runahead_ahead = true;
+	}
+	else if (--runahead_left == 0) {
+		runahead_restore = true;
+		runahead_pending = true;
+		runahead_ahead = false;
+	}
+
+	runahead_hidden = !(runahead_ahead && runahead_left == 1);
+}
+
+void RUNAHEAD_Check(void) {
+	runahead_pending = false;
+
+	if (!runahead_restore) {
+		if((MEM_TotalPages()*4096/1024/1024)>1024) {
+			LOG_MSG("Run-ahead disabled, 1 GB is the maximum memory size for saving states.");
+			runahead_frames = 0;
+			RUNAHEAD_Reset();
+			return;
+		}
+		SaveState::instance().saveMemory(runahead_state);
+	}
+	else {
+		/* the host output belongs to what was just presented, not to the frame being restored */
+		const bool updating = render.updating;
+		SaveState::instance().loadMemory(runahead_state);
+		render.updating = updating;
+		runahead_ahead = false;
+		runahead_hidden = runahead_frames != 0;
+	}
+}
+
+/* forget the run-ahead state, after a regular load or when run-ahead is turned off */
+void RUNAHEAD_Reset(void) {
+	runahead_pending = false;
+	runahead_restore = false;
+	runahead_ahead = false;
+	runahead_hidden = false;
+	runahead_left = 0;
+	runahead_state.clear();
+}
+
+/* Rewind. Every rewind_interval real frames the state is captured in memory, like run-ahead does,
+ * and the ring gets a reverse delta: the blocks of the capture before that the new one changed. The
+ * latest capture is kept whole, a step back loads it or applies the newest delta to it first. The
+ * oldest deltas are dropped to keep the ring within rewind_budget bytes. */
+struct RewindBlock {
+	uint32_t comp;          /* index of the component in the state */
+	uint32_t size;          /* size of the component in the older state */
+	uint32_t offset;
+	uint32_t length;        /* bytes of the older state that follow */
+};
+
+static const size_t rewind_block = 256;
+
+static void RewindAddBlock(std::string& delta, uint32_t comp, const std::string& older, size_t offset, size_t length) {
+	RewindBlock b;
+	b.comp = comp;
+	b.size = (uint32_t)older.size();
+	b.offset = (uint32_t)offset;
+	b.length = (uint32_t)length;
+	delta.append((const char*)&b,sizeof(b));
+	delta.append(older,offset,length);
+}
+
+/* what turns newer back into older, runs of changed blocks in each component */
+static void RewindDiff(const SaveState::MemoryState& newer, const SaveState::MemoryState& older, std::string& delta) {
+	for (size_t n = 0; n < older.size(); n++) {
+		const std::string &o = older[n], &c = newer[n];
+		if (o.size() != c.size()) {
+			RewindAddBlock(delta,(uint32_t)n,o,0,o.size());
+			continue;
+		}
+
+		size_t run = 0, run_length = 0;
+		for (size_t ofs = 0; ofs < o.size(); ofs += rewind_block) {
+			const size_t len = o.size() - ofs < rewind_block ? o.size() - ofs : rewind_block;
+			if (memcmp(o.data() + ofs,c.data() + ofs,len) != 0) {
+				if (run_length == 0) run = ofs;
+				run_length += len;
+			}
+			else if (run_length != 0) {
+				RewindAddBlock(delta,(uint32_t)n,o,run,run_length);
+				run_length = 0;
+			}
+		}
+		if (run_length != 0) RewindAddBlock(delta,(uint32_t)n,o,run,run_length);
+	}
+}
+
+static void RewindApply(SaveState::MemoryState& state, const std::string& delta) {
+	for (size_t pos = 0; pos + sizeof(RewindBlock) <= delta.size();) {
+		RewindBlock b;
+		memcpy(&b,delta.data() + pos,sizeof(b));
+		pos += sizeof(b);
+		if (b.comp < state.size()) {
+			state[b.comp].resize(b.size);
+			memcpy(&state[b.comp][b.offset],delta.data() + pos,b.length);
+		}
+		pos += b.length;
+	}
+}
+
+/* VGA_VerticalTimer calls this at every emulated retrace, before RUNAHEAD_Retrace. Frames run ahead
+ * are rolled back later, so only real frames count. */
+void REWIND_Retrace(void) {
+	if (rewind_interval == 0 || runahead_ahead) return;
+	if (++rewind_frames >= rewind_interval) rewind_pending = true;
+}
+
+/* step back one capture, from the mapper. The main loop does it, outside the CPU core. */
+void REWIND_Step(bool pressed) {
+	if (!pressed) return;
+	if (rewind_interval == 0) {
+		LOG_MSG("Rewind is disabled, set \"rewind interval\" to enable it.");
+		return;
+	}
+	rewind_step = true;
+	rewind_pending = true;
+}
+
+void REWIND_Check(void) {
+	rewind_pending = false;
+
+	if (!rewind_step) {
+		if (rewind_frames < rewind_interval) return;
+		rewind_frames = 0;
+		if((MEM_TotalPages()*4096/1024/1024)>1024) {
+			LOG_MSG("Rewind disabled, 1 GB is the maximum memory size for saving states.");
+			rewind_interval = 0;
+			REWIND_Reset();
+			return;
+		}
+
+		SaveState::instance().saveMemory(rewind_scratch);
+		if (rewind_state.size() == rewind_scratch.size()) {
+			std::string delta;
+			RewindDiff(rewind_scratch,rewind_state,delta);
+			rewind_ring_bytes += delta.size();
+			rewind_ring.push_back(std::move(delta));
+			while (!rewind_ring.empty() && rewind_ring_bytes > rewind_budget) {
+				rewind_ring_bytes -= rewind_ring.front().size();
+				rewind_ring.pop_front();
+			}
+		}
+		rewind_state.swap(rewind_scratch);
+		return;
+	}
+
+	rewind_step = false;
+	if (rewind_state.empty()) return;
+
+	/* back to the latest capture, or if that is where the guest is, to the one before it */
+	if (rewind_frames == 0) {
+		if (rewind_ring.empty()) {
+			LOG_MSG("Rewind: no earlier state");
+			return;
+		}
+		RewindApply(rewind_state,rewind_ring.back());
+		rewind_ring_bytes -= rewind_ring.back().size();
+		rewind_ring.pop_back();
+	}
+	rewind_frames = 0;
+
+	const bool updating = render.updating;
+	SaveState::instance().loadMemory(rewind_state);
+	render.updating = updating;
+
+	/* neither the run-ahead state nor the pages written since the last save state apply any more */
+	RUNAHEAD_Reset();
+	SaveState::instance().resetChain();
+	LOG_MSG("Rewind: %u step(s) left, %u KB",(unsigned int)rewind_ring.size(),(unsigned int)(rewind_ring_bytes/1024));
+}
+
+/* forget every capture, when rewind is turned off or its settings change */
+void REWIND_Reset(void) {
+	rewind_pending = false;
+	rewind_step = false;
+	rewind_frames = 0;
+	rewind_state.clear();
+	rewind_scratch.clear();
+	rewind_ring.clear();
+	rewind_ring_bytes = 0;
+}
+
 #define CASESENSITIVITY (0)
 #define MAXFILENAME (256)
 
@@ -528,20 +1064,587 @@ int zipOutOpenFile(zipFile zf,const char *zfname,zip_fileinfo &zi,const bool com
 		NULL/*password*/,0/*crcFile*/,1/*zip64*/);
 }
 
+/* ids tie an incremental state to the exact state it was saved on top of, not just its file name */
+/* zstd level of new state files, -1 for ZIP */
+static int StateFileLevel(void) {
+	Section_prop *section = static_cast<Section_prop *>(control->GetSection("dosbox"));
+	return !strcmp(section->Get_string("savestate format"),"zstd") ? section->Get_int("savestate compression level") : -1;
+}
+
+static std::string NewStateId(void) {
+	static std::random_device rd;
+	static unsigned int counter = 0;
+	std::ostringstream ss;
+	ss << std::hex << rd() << rd() << '-' << (unsigned long long)time(NULL) << '-' << ++counter;
+	return ss.str();
+}
+
+static unzFile OpenStateFile(const std::string& save) {
+	zlib_filefunc64_def ffunc;
+#ifdef USEWIN32IOAPI
+	fill_win32_filefunc64A(&ffunc);
+#else
+	fill_fopen64_filefunc(&ffunc);
+#endif
+	return unzOpen2_64(save.c_str(),&ffunc);
+}
+
+/* zstd save state files: the magic, the chunks, then the index of every entry (name, size and where
+ * each of its chunks is) and the offset of the index. Chunks are compressed and decompressed
+ * independently of each other on the worker pool, so even the memory image does not go through a
+ * single core. With compression level 0 chunks are stored as they are, large spans starting at an
+ * offset aligned for mmap(), so loading can map guest RAM from the file instead of reading it. */
+static const char zstd_state_magic[] = "DOSBox-X zstd state\x1a";
+static const size_t zstd_state_chunk = 1024*1024;
+static const uint64_t zstd_state_align = 65536;        /* larger than the page size of any host */
+
+struct StateChunk {
+	uint64_t offset;
+	uint32_t raw;
+	uint32_t packed;                /* 0 for a chunk stored as it is */
+};
+
+static void PutStateLE(std::string& s, uint64_t v, unsigned int bytes) {
+	for (unsigned int i = 0; i < bytes; i++) s.push_back((char)(v >> (i * 8u)));
+}
+
+static bool GetStateLE(FILE *fp, uint64_t& v, unsigned int bytes) {
+	unsigned char b[8];
+	if (fread(b,bytes,1,fp) != 1) return false;
+	v = 0;
+	for (unsigned int i = 0; i < bytes; i++) v |= (uint64_t)b[i] << (i * 8u);
+	return true;
+}
+
+/* writes a state file entry by entry, ZIP or zstd. Entries are handed over in spans, which are
+ * compressed where they are: a component's memory is not copied into a buffer first. For zstd a
+ * large span starts chunks of its own, which are compressed in parallel before write() returns.
+ * Smaller spans are gathered into the next chunk, compressed while the following ones are written.
+ * Chunks are written in order as soon as they are done. */
+class StateWriter : public SaveState::Writer {
+public:
+	~StateWriter() { close(); }
+
+	/* zstd_level: -1 for a ZIP file, 0 for a zstd file with uncompressed chunks */
+	bool open(const std::string& save, bool n_compress, int n_zstd_level) {
+		compress = n_compress;
+		zstd_level = n_zstd_level;
+		failed = false;
+		/* never rewrite the file in place: the RAM of a state loaded from it may still be mapped from it */
+		remove(save.c_str());
+		if (zstd_level >= 0) {
+			fp = FOPEN_FUNC(save.c_str(),"wb");
+			if (fp == NULL) return false;
+			pos = 0;
+			put(zstd_state_magic,sizeof(zstd_state_magic) - 1);
+			return !failed;
+		}
+
+		const char *global_comment = "DOSBox-X save state";
+		zlib_filefunc64_def ffunc;
+#ifdef USEWIN32IOAPI
+		fill_win32_filefunc64A(&ffunc);
+#else
+		fill_fopen64_filefunc(&ffunc);
+#endif
+		zf = zipOpen2_64(save.c_str(),APPEND_STATUS_CREATE,&global_comment,&ffunc);
+		zipSetCurrentTime(zi);
+		return zf != NULL;
+	}
+
+	bool begin(const std::string& name) {
+		if (zf != NULL) return zipOutOpenFile(zf,name.c_str(),zi,compress) == ZIP_OK;
+		Entry entry;
+		entry.name = name;
+		index.push_back(entry);
+		return fp != NULL;
+	}
+
+	void write(const void *data, size_t size) override {
+		const char *p = (const char*)data;
+
+		if (zf != NULL) {
+			for (size_t ofs = 0; ofs < size; ofs += 0x1000000u) {
+				const size_t left = size - ofs;
+				if (zipWriteInFileInZip(zf,p + ofs,(unsigned int)(left < 0x1000000u ? left : 0x1000000u)) != ZIP_OK) failed = true;
+			}
+			return;
+		}
+		if (index.empty()) {
+			failed = true;
+			return;
+		}
+
+		index.back().size += size;
+
+		/* whole chunks straight from the caller's memory, which is only valid until this returns */
+		bool direct = false;
+		if (size >= zstd_state_chunk) {
+			if (!pending.empty()) chunk(NULL,pending.size());
+			if (zstd_level == 0) pad(zstd_state_align);
+			while (size >= zstd_state_chunk) {
+				chunk(p,zstd_state_chunk);
+				p += zstd_state_chunk;
+				size -= zstd_state_chunk;
+			}
+			direct = true;
+		}
+		while (size > 0) {
+			const size_t n = zstd_state_chunk - pending.size() < size ? zstd_state_chunk - pending.size() : size;
+			pending.append(p,n);
+			p += n;
+			size -= n;
+			if (pending.size() == zstd_state_chunk) chunk(NULL,pending.size());
+		}
+		if (direct) tasks.wait();
+		drain();
+	}
+
+	bool end(void) {
+		if (zf != NULL) return zipCloseFileInZip(zf) == ZIP_OK && !failed;
+		if (!pending.empty()) chunk(NULL,pending.size());
+		drain();
+		return !failed;
+	}
+
+	bool close(void) {
+		bool ok = !failed;
+		if (zf != NULL) {
+			if (zipClose(zf,NULL) != ZIP_OK) ok = false;
+			zf = NULL;
+		}
+		if (fp != NULL) {
+			tasks.wait();
+			drain();
+			ok = ok && !failed;
+
+			std::string trailer;
+			const uint64_t index_pos = pos;
+			PutStateLE(trailer,index.size(),4);
+			for (size_t e = 0; e < index.size(); e++) {
+				PutStateLE(trailer,index[e].name.size(),4);
+				trailer += index[e].name;
+				PutStateLE(trailer,index[e].size,8);
+				PutStateLE(trailer,index[e].chunks.size(),4);
+				for (size_t i = 0; i < index[e].chunks.size(); i++) {
+					PutStateLE(trailer,index[e].chunks[i].offset,8);
+					PutStateLE(trailer,index[e].chunks[i].raw,4);
+					PutStateLE(trailer,index[e].chunks[i].packed,4);
+				}
+			}
+			PutStateLE(trailer,index_pos,8);
+			if (ok) put(trailer.data(),trailer.size());
+
+			if (fclose(fp) != 0 || failed) ok = false;
+			fp = NULL;
+			index.clear();
+			chunks.clear();
+		}
+		failed = true; /* closed */
+		return ok;
+	}
+private:
+	struct Entry {
+		std::string name;
+		uint64_t size = 0;
+		std::vector<StateChunk> chunks;
+	};
+	struct Chunk {
+		std::string in;                 // for chunks gathered from smaller spans
+		const char *src = NULL;
+		size_t len = 0;
+		size_t entry = 0;
+		std::string out;
+		bool err = false;
+		std::atomic<bool> done{false};
+	};
+
+	void put(const void *data, size_t size) {
+		if (size > 0 && fwrite(data,size,1,fp) != 1) failed = true;
+		pos += size;
+	}
+
+	void pad(uint64_t align) {
+		static const char zero[4096] = {0};
+		while (pos % align != 0) {
+			const uint64_t n = align - pos % align;
+			put(zero,n < sizeof(zero) ? (size_t)n : sizeof(zero));
+		}
+	}
+
+	/* the next chunk of the current entry, straight from the caller's memory or what was gathered in pending */
+	void chunk(const char *src, size_t len) {
+		if (zstd_level == 0) {
+			StateChunk c = { pos, (uint32_t)len, 0 };
+			index.back().chunks.push_back(c);
+			put(src != NULL ? src : pending.data(),len);
+			if (src == NULL) pending.clear();
+			return;
+		}
+
+		chunks.emplace_back();
+		Chunk *c = &chunks.back();
+		if (src != NULL) {
+			c->src = src;
+		}
+		else {
+			c->in.swap(pending);
+			c->src = c->in.data();
+		}
+		c->len = len;
+		c->entry = index.size() - 1;
+
+		const int level = zstd_level;
+		auto compress = [c,level]() {
+			c->out.resize(ZSTD_compressBound(c->len));
+			const size_t r = ZSTD_compress(&c->out[0],c->out.size(),c->src,c->len,level);
+			if (ZSTD_isError(r)) c->err = true;
+			else c->out.resize(r);
+			c->done.store(true,std::memory_order_release);
+		};
+		if (snapshot_child) compress();
+		else tasks.run(compress);
+	}
+
+	/* write the compressed chunks that are done, in order */
+	void drain(void) {
+		while (!chunks.empty() && chunks.front().done.load(std::memory_order_acquire)) {
+			Chunk &c = chunks.front();
+			if (c.err) failed = true;
+			StateChunk info = { pos, (uint32_t)c.len, (uint32_t)c.out.size() };
+			index[c.entry].chunks.push_back(info);
+			put(c.out.data(),c.out.size());
+			chunks.pop_front();
+		}
+	}
+
+	zipFile zf = NULL;
+	zip_fileinfo zi;
+	bool compress = true;
+
+	FILE *fp = NULL;
+	uint64_t pos = 0;
+	int zstd_level = -1;
+	std::vector<Entry> index;
+	std::deque<Chunk> chunks;           // not written yet. tasks hold pointers, a deque does not move its elements
+	std::string pending;
+	ThreadPoolGroup tasks;
+
+	bool failed = false;
+};
+
+/* the current entry of a ZIP file */
+class zip_reader : public SaveState::Reader {
+public:
+	zip_reader(unzFile n_zf) : zf(n_zf) { }
+	size_t read(void *data, size_t size) override {
+		size_t got = 0;
+		while (got < size) {
+			const size_t left = size - got;
+			const int r = unzReadCurrentFile(zf,(char*)data + got,(unsigned int)(left < 0x1000000u ? left : 0x1000000u));
+			if (r < 0) failed = true;
+			if (r <= 0) break;
+			got += (size_t)r;
+		}
+		return got;
+	}
+
+	bool failed = false;
+private:
+	unzFile zf;
+};
+
+/* an entry of a zstd state file with uncompressed chunks, read straight from the file into the
+ * component. Guest RAM is mapped from the file copy-on-write where it lines up, the host then reads
+ * the pages in when the guest first touches them. */
+class stored_reader : public SaveState::Reader {
+public:
+	stored_reader(FILE *n_fp, const std::vector<StateChunk>& n_chunks) : fp(n_fp), chunks(n_chunks) { }
+	size_t read(void *data, size_t size) override {
+		size_t got = 0;
+		while (got < size && chunk < chunks.size()) {
+			const StateChunk &c = chunks[chunk];
+			const size_t n = size - got < c.raw - in_chunk ? size - got : c.raw - in_chunk;
+			char *dst = (char*)data + got;
+
+			if (in_chunk != 0 || n != c.raw || !MEM_MapHostFromFile(dst,n,fileno(fp),c.offset)) {
+				if ((file_pos != c.offset + in_chunk && FSEEKO_FUNC(fp,c.offset + in_chunk,SEEK_SET) != 0) ||
+					fread(dst,n,1,fp) != 1) {
+					failed = true;
+					break;
+				}
+				file_pos = c.offset + in_chunk + n;
+			}
+			got += n;
+			in_chunk += n;
+			if (in_chunk == c.raw) {
+				chunk++;
+				in_chunk = 0;
+			}
+		}
+		return got;
+	}
+
+	bool failed = false;
+private:
+	FILE *fp;
+	const std::vector<StateChunk> &chunks;
+	size_t chunk = 0;
+	size_t in_chunk = 0;
+	uint64_t file_pos = ~(uint64_t)0;
+};
+
+/* the entries of a save state file, ZIP or zstd. ZIP entries are inflated while they are read,
+ * compressed zstd entries are decompressed whole, on the worker pool, the first time they are needed. */
+class StateReader {
+public:
+	~StateReader() { close(); }
+
+	bool open(const std::string& save) {
+		char magic[sizeof(zstd_state_magic) - 1];
+		fp = FOPEN_FUNC(save.c_str(),"rb");
+		if (fp == NULL) return false;
+		if (fread(magic,sizeof(magic),1,fp) != 1 || memcmp(magic,zstd_state_magic,sizeof(magic))) {
+			fclose(fp);
+			fp = NULL;
+			zf = OpenStateFile(save);
+			return zf != NULL;
+		}
+
+		uint64_t index_pos, count, v;
+		if (FSEEKO_FUNC(fp,-8,SEEK_END) != 0 || !GetStateLE(fp,index_pos,8) ||
+			FSEEKO_FUNC(fp,index_pos,SEEK_SET) != 0 || !GetStateLE(fp,count,4)) return false;
+		for (uint64_t e = 0; e < count; e++) {
+			Entry entry;
+			uint64_t raw = 0;
+			if (!GetStateLE(fp,v,4) || v > 4096) return false;
+			entry.name.resize((size_t)v);
+			if (v > 0 && fread(&entry.name[0],(size_t)v,1,fp) != 1) return false;
+			if (!GetStateLE(fp,v,8) || v > ((uint64_t)1 << 40)) return false;
+			entry.size = (size_t)v;
+			if (!GetStateLE(fp,v,4) || v > entry.size) return false;
+			entry.chunks.resize((size_t)v);
+			for (size_t i = 0; i < entry.chunks.size(); i++) {
+				StateChunk &c = entry.chunks[i];
+				if (!GetStateLE(fp,c.offset,8) || !GetStateLE(fp,v,4)) return false;
+				c.raw = (uint32_t)v;
+				if (!GetStateLE(fp,v,4)) return false;
+				c.packed = (uint32_t)v;
+				if (c.packed != 0) entry.stored = false;
+				raw += c.raw;
+			}
+			if (raw != entry.size) return false;
+			index.push_back(entry);
+		}
+		return true;
+	}
+
+	bool has(const std::string& name) {
+		if (zf != NULL) return unzLocateFile(zf,name.c_str(),1/*case sensitive*/) == UNZ_OK;
+		return find(name) != NULL;
+	}
+
+	/* contents of one entry, false if it is missing or damaged */
+	bool read(const std::string& name, std::string& data) {
+		if (zf != NULL) {
+			bool ok = unzLocateFile(zf,name.c_str(),1/*case sensitive*/) == UNZ_OK && unzOpenCurrentFile(zf) == UNZ_OK;
+			if (ok) {
+				zip_istreambuf zis(zf);
+				char buffer[4096];
+				std::streamsize sz;
+
+				data.clear();
+				while ((sz = zis.xsgetn((zip_istreambuf::char_type*)buffer,sizeof(buffer))) > 0)
+					data.append(buffer,(size_t)sz);
+				ok = zis.close() == ZIP_OK;
+			}
+			return ok;
+		}
+
+		Entry *entry = find(name);
+		if (entry == NULL || !decompress(std::vector<Entry*>(1,entry))) return false;
+		data = entry->data;
+		return true;
+	}
+
+	/* one entry in spans, ZIP entries are inflated straight into the memory of the component */
+	bool load(const std::string& name, const std::function<void(SaveState::Reader&)>& f) {
+		if (zf != NULL) {
+			if (unzLocateFile(zf,name.c_str(),1/*case sensitive*/) != UNZ_OK || unzOpenCurrentFile(zf) != UNZ_OK) return false;
+			zip_reader in(zf);
+			f(in);
+			return unzCloseCurrentFile(zf) == UNZ_OK && !in.failed;
+		}
+
+		Entry *entry = find(name);
+		if (entry == NULL) return false;
+		if (entry->stored && !entry->loaded) {
+			stored_reader in(fp,entry->chunks);
+			f(in);
+			return !in.failed;
+		}
+
+		if (!decompress(std::vector<Entry*>(1,entry))) return false;
+		string_reader in(entry->data);
+		f(in);
+		/* restored, the component has its own copy now */
+		entry->data.clear(); entry->data.shrink_to_fit();
+		entry->loaded = false;
+		return true;
+	}
+
+	/* decompress every compressed entry of a zstd state at once, which keeps all workers busy */
+	bool preload(void) {
+		if (zf != NULL) return true;
+		std::vector<Entry*> all;
+		for (size_t i = 0; i < index.size(); i++)
+			if (!index[i].stored) all.push_back(&index[i]);
+		return decompress(all);
+	}
+
+	bool close(void) {
+		bool ok = true;
+		if (zf != NULL) ok = unzClose(zf) == UNZ_OK;
+		if (fp != NULL) fclose(fp);
+		zf = NULL;
+		fp = NULL;
+		index.clear();
+		return ok;
+	}
+private:
+	struct Entry {
+		std::string name;
+		size_t size = 0;
+		std::vector<StateChunk> chunks;
+		bool stored = true;             // every chunk uncompressed
+		bool loaded = false;
+		std::string data;
+	};
+
+	Entry *find(const std::string& name) {
+		for (size_t i = 0; i < index.size(); i++)
+			if (index[i].name == name) return &index[i];
+		return NULL;
+	}
+
+	bool decompress(const std::vector<Entry*>& entries) {
+		std::deque<std::string> packed;
+		std::atomic<bool> failed{false};
+		ThreadPoolGroup tasks;
+
+		/* the file is read here while the chunks read before are decompressed */
+		for (size_t e = 0; e < entries.size() && !failed; e++) {
+			Entry *entry = entries[e];
+			if (entry->loaded) continue;
+
+			entry->data.resize(entry->size);
+			size_t ofs = 0;
+			for (size_t i = 0; i < entry->chunks.size(); i++) {
+				const StateChunk &c = entry->chunks[i];
+				char *dst = &entry->data[ofs];
+				ofs += c.raw;
+
+				if (FSEEKO_FUNC(fp,c.offset,SEEK_SET) != 0) {
+					failed = true;
+					break;
+				}
+				if (c.packed == 0) {
+					if (c.raw > 0 && fread(dst,c.raw,1,fp) != 1) failed = true;
+					continue;
+				}
+
+				packed.emplace_back(c.packed,'\0');
+				const std::string *src = &packed.back();
+				if (fread(&packed.back()[0],c.packed,1,fp) != 1) {
+					failed = true;
+					break;
+				}
+				const size_t len = c.raw;
+				tasks.run([dst,len,src,&failed]() {
+					if (ZSTD_decompress(dst,len,src->data(),src->size()) != len) failed = true;
+				});
+			}
+		}
+		tasks.wait();
+		if (failed) return false;
+		for (size_t e = 0; e < entries.size(); e++) entries[e]->loaded = true;
+		return true;
+	}
+
+	unzFile zf = NULL;
+	FILE *fp = NULL;
+	std::vector<Entry> index;
+};
+
+/* contents of one entry of a save state file, false if the file or the entry is missing */
+static bool ReadStateEntry(const std::string& save, const char *entry, std::string& data) {
+	StateReader state;
+	return state.open(save) && state.read(entry,data);
+}
+
+/* the files an incremental state is made of, from the full state it starts with to save itself.
+ * false if one of them is missing or was overwritten by another state since. */
+bool SaveState::readChain(const std::string& save, std::vector<ChainLink>& files) const {
+	std::string file = save, want;
+
+	files.clear();
+	for (;;) {
+		ChainLink link;
+		std::string base;
+
+		link.file = file;
+		ReadStateEntry(file,"State_Id",link.id); /* older states have none */
+		if (files.size() > 0 && (link.id.empty() || link.id != want)) {
+			LOG_MSG("Save state %s is not the state %s was saved on top of",file.c_str(),files.front().file.c_str());
+			return false;
+		}
+		files.insert(files.begin(),link);
+		if (!ReadStateEntry(file,"Base_State",base)) return true; /* a full state */
+
+		const size_t nl = base.find('\n');
+		if (nl == std::string::npos || files.size() > 100000) return false;
+		std::string parent = base.substr(0,nl);
+		want = base.substr(nl+1);
+
+		/* the save folder may have moved since, then look next to the state that refers to it */
+		std::ifstream check(parent.c_str());
+		if (!check.good()) {
+			const size_t slash = file.find_last_of("\\/"), pslash = parent.find_last_of("\\/");
+			if (slash != std::string::npos)
+				parent = file.substr(0,slash+1) + parent.substr(pslash == std::string::npos ? 0 : pslash+1);
+		}
+		file = parent;
+	}
+}
+
+/* a component with incremental data: its full state first, then every delta on top of it in order */
+bool SaveState::loadDelta(const std::vector<ChainLink>& files, const std::string& name, Component& comp) const {
+	for (size_t f = 0; f < files.size(); f++) {
+		StateReader state;
+		if (!state.open(files[f].file)) return false;
+
+		const bool delta = f > 0 && state.has(name+".delta");
+		const bool ok = state.load(delta ? name+".delta" : name,[&](Reader& in) { ReadComponent(comp,delta,in); });
+		if (!state.close() || !ok) return false;
+	}
+	return true;
+}
+
 void SaveState::save(size_t slot) { //throw (Error)
+	TraceScope trace("state save");
 	if (slot >= SLOT_COUNT*MAX_PAGE)  return;
 #ifdef C_SDL2
         SDL_PauseAudioDevice(SDL2_AudioDevice, 0);
 #else
         SDL_PauseAudio(0);
 #endif
-	bool save_err=false;
 	if((MEM_TotalPages()*4096/1024/1024)>1024) {
 		LOG_MSG("Stopped. 1 GB is the maximum memory size for saving/loading states.");
 		notifyError("Unsupported memory size for saving states.", false);
 		return;
 	}
 	bool compresssaveparts = static_cast<Section_prop *>(control->GetSection("dosbox"))->Get_bool("compresssaveparts");
+	const int zstd_level = StateFileLevel();
 	const char *save_remark = "";
 #if !defined(HX_DOS)
 	if (auto_save_state)
@@ -572,7 +1675,6 @@ void SaveState::save(size_t slot) { //throw (Error)
 		save_remark = new_remark;
 	}
 #endif
-	int errclose;
 	std::string path;
 	bool Get_Custom_SaveDir(std::string& savedir);
 	if(Get_Custom_SaveDir(path)) {
@@ -597,100 +1699,172 @@ void SaveState::save(size_t slot) { //throw (Error)
 	temp=path;
 	std::string save=use_save_file&&savefilename.size()?savefilename:temp+slotname.str()+".sav";
 
-	zipFile zf;
-	{
-		const char *global_comment = "DOSBox-X save state";
-		zlib_filefunc64_def ffunc;
-#ifdef USEWIN32IOAPI
-		fill_win32_filefunc64A(&ffunc);
-#else
-		fill_fopen64_filefunc(&ffunc);
-#endif
-		remove(save.c_str());
-		zf = zipOpen2_64(save.c_str(),APPEND_STATUS_CREATE,&global_comment,&ffunc);
+	SAVESTATE_FinishSnapshot(true); /* one background save at a time */
+
+	/* incremental save states: only what changed since the state saved or loaded before, unless
+	 * the chain is long enough already or this file is part of it */
+	const unsigned int maxdelta = (unsigned int)static_cast<Section_prop *>(control->GetSection("dosbox"))->Get_int("incremental savestates");
+	const ChainLink *base = NULL;
+	if (maxdelta > 0 && !chain.empty() && chain.size() <= maxdelta) {
+		base = &chain.back();
+		for (size_t i = 0; i < chain.size(); i++)
+			if (chain[i].file == save) base = NULL;
 	}
-	if (zf == NULL) { save_err = true; goto done; }
+	const std::string id = NewStateId();
 
-	{
-		zip_fileinfo zi; zipSetCurrentTime(zi);
-		if ((errclose=zipOutOpenFile(zf,"DOSBox-X_Version",zi,compresssaveparts)) != ZIP_OK) { save_err = true; goto done; }
-		zip_ostreambuf zos(zf); std::ostream emulatorversion(&zos);
+	/* the state being written is the base of the next one, tracking starts over from here */
+	auto rebase = [&]() {
+		if (maxdelta == 0) {
+			chain.clear();
+			return;
+		}
+		if (base == NULL) chain.clear();
+		ChainLink link;
+		link.file = save;
+		link.id = id;
+		chain.push_back(link);
+		for (CompEntry::iterator i = components.begin(); i != components.end(); ++i)
+			i->second.comp.resetDelta();
+	};
 
-		emulatorversion << "DOSBox-X " << VERSION << " (" << SDL_STRING << ")" << std::endl << GetPlatform(true) << std::endl << UPDATED_STR;
-		/* 2025/01/12: Backwards compat: The old code compressed data to zlib, even though the ZIP support code
-		 *             already applies compression. This is to tell the old code that we did not compress the
-		 *             data (the ZIP support code did though). */
-		emulatorversion << std::endl << "No compression";
+#if defined(SAVESTATE_SNAPSHOT)
+	if (static_cast<Section_prop *>(control->GetSection("dosbox"))->Get_bool("snapshot savestates")) {
+		fflush(NULL); /* or the child flushes pending stdio output a second time */
+		const pid_t pid = fork();
+		if (pid == 0) {
+			/* the child sees guest RAM and every component as they were at fork() time, copy-on-write,
+			 * and serialises them while the parent goes on running the guest. it must never return
+			 * into the emulator, and _exit() skips the atexit handlers and destructors. */
+			snapshot_child = true;
+			_exit(writeState(save,save_remark,compresssaveparts,zstd_level,id,base) ? 1 : 0);
+		}
+		else if (pid > 0) {
+			rebase();
+			snapshot_pid = pid;
+			background_slot = slot;
+			savestate_snapshot_running = true;
+			if (!dos_kernel_disabled) flagged_backup((char *)save.c_str());
+			return;
+		}
 
-		if ((errclose=zos.close()) != ZIP_OK) { save_err = true; goto done; }
+		LOG_MSG("Cannot fork for a snapshot save state, %s. Saving in the foreground",strerror(errno));
+	}
+	else
+#endif
+	if (static_cast<Section_prop *>(control->GetSection("dosbox"))->Get_bool("background savestates")) {
+		/* the emulation only stops to copy the state, deflating and writing the file happen on the writer thread */
+		captureState(savestate_writer.entries,save_remark,id,base);
+		rebase();
+		savestate_writer.done = false;
+		savestate_writer.failed = false;
+		savestate_writer.thread = std::thread([save,compresssaveparts,zstd_level]() {
+			savestate_writer.failed = writeEntries(save,savestate_writer.entries,compresssaveparts,zstd_level);
+			savestate_writer.done = true;
+		});
+		background_slot = slot;
+		savestate_snapshot_running = true;
+		if (!dos_kernel_disabled) flagged_backup((char *)save.c_str());
+		return;
 	}
-	{
-		zip_fileinfo zi; zipSetCurrentTime(zi);
-		if ((errclose=zipOutOpenFile(zf,"Program_Name",zi,compresssaveparts)) != ZIP_OK) { save_err = true; goto done; }
-		zip_ostreambuf zos(zf); std::ostream programname(&zos);
 
-		programname << RunningProgram;
+	const bool save_err = writeState(save,save_remark,compresssaveparts,zstd_level,id,base);
 
-		if ((errclose=zos.close()) != ZIP_OK) { save_err = true; goto done; }
-	}
-	{
-		zip_fileinfo zi; zipSetCurrentTime(zi);
-		if ((errclose=zipOutOpenFile(zf,"Memory_Size",zi,compresssaveparts)) != ZIP_OK) { save_err = true; goto done; }
-		zip_ostreambuf zos(zf); std::ostream memorysize(&zos);
+	if (save_err) chain.clear();
+	else rebase();
 
-		memorysize << MEM_TotalPages();
+	if (!dos_kernel_disabled) flagged_backup((char *)save.c_str());
 
-		if ((errclose=zos.close()) != ZIP_OK) { save_err = true; goto done; }
-	}
-	{
-		zip_fileinfo zi; zipSetCurrentTime(zi);
-		if ((errclose=zipOutOpenFile(zf,"Machine_Type",zi,compresssaveparts)) != ZIP_OK) { save_err = true; goto done; }
-		zip_ostreambuf zos(zf); std::ostream machinetype(&zos);
+	if (save_err)
+		notifyError(MSG_Get("SAVE_FAILED"));
+	else
+		LOG_MSG("[%s]: Saved. (Slot %d)", getTime().c_str(), (int)slot+1);
+}
 
-		machinetype << getType();
+/* the entries every state file starts with, before the components */
+void SaveState::captureHeader(Entries& entries, const char *save_remark, const std::string& id, const ChainLink *base) {
+	std::ostringstream emulatorversion, memorysize;
+
+	emulatorversion << "DOSBox-X " << VERSION << " (" << SDL_STRING << ")" << std::endl << GetPlatform(true) << std::endl << UPDATED_STR;
+	/* 2025/01/12: Backwards compat: The old code compressed data to zlib, even though the ZIP support code
+	 *             already applies compression. This is to tell the old code that we did not compress the
+	 *             data (the ZIP support code did though). */
+	emulatorversion << std::endl << "No compression";
+	memorysize << MEM_TotalPages();
+
+	entries.clear();
+	entries.push_back(Entries::value_type("DOSBox-X_Version",emulatorversion.str()));
+	entries.push_back(Entries::value_type("Program_Name",RunningProgram));
+	entries.push_back(Entries::value_type("Memory_Size",memorysize.str()));
+	entries.push_back(Entries::value_type("Machine_Type",getType()));
+	entries.push_back(Entries::value_type("Time_Stamp",getTime(true)));
+	entries.push_back(Entries::value_type("Save_Remark",save_remark));
+	entries.push_back(Entries::value_type("State_Id",id));
+	/* an incremental state: file and id of the state it is saved on top of */
+	if (base != NULL) entries.push_back(Entries::value_type("Base_State",base->file + '\n' + base->id));
+}
 
-		if ((errclose=zos.close()) != ZIP_OK) { save_err = true; goto done; }
+/* everything that goes into the state file, in memory. This is the only part that needs the emulation stopped. */
+void SaveState::captureState(Entries& entries, const char *save_remark, const std::string& id, const ChainLink *base) {
+	TraceScope trace("state capture");
+	captureHeader(entries,save_remark,id,base);
+	for (CompEntry::iterator i = components.begin(); i != components.end(); ++i) {
+		const bool delta = base != NULL && i->second.comp.hasDelta();
+		entries.push_back(Entries::value_type(delta ? i->first + ".delta" : i->first,std::string()));
+		string_writer out(entries.back().second);
+		WriteComponent(i->second.comp,delta,out);
 	}
-	{
-		zip_fileinfo zi; zipSetCurrentTime(zi);
-		if ((errclose=zipOutOpenFile(zf,"Time_Stamp",zi,compresssaveparts)) != ZIP_OK) { save_err = true; goto done; }
-		zip_ostreambuf zos(zf); std::ostream timestamp(&zos);
-
-		timestamp << getTime(true);
+}
 
-		if ((errclose=zos.close()) != ZIP_OK) { save_err = true; goto done; }
+/* the state file, where compressing takes most of the time. Runs on its own thread for background save states. */
+static bool WriteEntryList(StateWriter& out, const SaveState::Entries& entries) {
+	for (SaveState::Entries::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+		if (!out.begin(i->first)) return false;
+		out.write(i->second.data(),i->second.size());
+		if (!out.end()) return false;
 	}
-	{
-		zip_fileinfo zi; zipSetCurrentTime(zi);
-		if ((errclose=zipOutOpenFile(zf,"Save_Remark",zi,compresssaveparts)) != ZIP_OK) { save_err = true; goto done; }
-		zip_ostreambuf zos(zf); std::ostream saveremark(&zos);
+	return true;
+}
 
-		saveremark << std::string(save_remark);
+bool SaveState::writeEntries(const std::string& save, const Entries& entries, bool compresssaveparts, int zstd_level) {
+	TraceScope trace("state write");
+	StateWriter out;
+	if (!out.open(save,compresssaveparts,zstd_level) || !WriteEntryList(out,entries)) return true;
+	return !out.close();
+}
 
-		if ((errclose=zos.close()) != ZIP_OK) { save_err = true; goto done; }
-	}
-	for (CompEntry::iterator i = components.begin(); i != components.end(); ++i) {
-		zip_fileinfo zi; zipSetCurrentTime(zi);
-		if ((errclose=zipOutOpenFile(zf,i->first.c_str(),zi,compresssaveparts)) != ZIP_OK) { save_err = true; goto done; }
-		zip_ostreambuf zos(zf); std::ostream ss(&zos);
+/* a state captured by saveMemory as a full state file, in the configured format */
+bool SaveState::writeMemory(const std::string& save, const MemoryState& state, const char *program) {
+	if (state.size() != components.size()) return true;
 
-		i->second.comp.getBytes(ss);
+	Entries entries;
+	captureHeader(entries,"",NewStateId(),NULL);
+	for (Entries::iterator i = entries.begin(); i != entries.end(); ++i)
+		if (i->first == "Program_Name") i->second = program;
 
-		if ((errclose=zos.close()) != ZIP_OK) { save_err = true; goto done; }
-	}
+	size_t n = 0;
+	for (CompEntry::const_iterator i = components.begin(); i != components.end(); ++i, ++n)
+		entries.push_back(Entries::value_type(i->first,state[n]));
+	return writeEntries(save,entries,static_cast<Section_prop *>(control->GetSection("dosbox"))->Get_bool("compresssaveparts"),StateFileLevel());
+}
 
-done:
-	if (zf != NULL) {
-		errclose = zipClose(zf,NULL);
-		if (errclose != ZIP_OK) save_err = true;
-	}
+/* a state saved in the foreground or by a snapshot: the components go to the compressor straight from
+ * their own memory, the state is never held in memory as a whole */
+bool SaveState::writeState(const std::string& save, const char *save_remark, bool compresssaveparts, int zstd_level,
+                           const std::string& id, const ChainLink *base) {
+	TraceScope trace("state write");
+	Entries header;
+	captureHeader(header,save_remark,id,base);
 
-	if (!dos_kernel_disabled) flagged_backup((char *)save.c_str());
+	StateWriter out;
+	if (!out.open(save,compresssaveparts,zstd_level) || !WriteEntryList(out,header)) return true;
 
-	if (save_err)
-		notifyError(MSG_Get("SAVE_FAILED"));
-	else
-		LOG_MSG("[%s]: Saved. (Slot %d)", getTime().c_str(), (int)slot+1);
+	for (CompEntry::iterator i = components.begin(); i != components.end(); ++i) {
+		const bool delta = base != NULL && i->second.comp.hasDelta();
+		if (!out.begin(delta ? i->first + ".delta" : i->first)) return true;
+		WriteComponent(i->second.comp,delta,out);
+		if (!out.end()) return true;
+	}
+	return !out.close();
 }
 
 void savestatecorrupt(const char* part) {
@@ -709,8 +1883,11 @@ bool loadstateconfirm(int ind) {
 }
 
 void SaveState::load(size_t slot) const { //throw (Error)
+	TraceScope trace("state load");
+	SAVESTATE_FinishSnapshot(true); /* do not read a state that is still being written */
 	//	if (isEmpty(slot)) return;
 	bool load_err=false;
+	std::vector<ChainLink> files;
 	if((MEM_TotalPages()*4096/1024/1024)>1024) {
 		LOG_MSG("Stopped. 1 GB is the maximum memory size for saving/loading states.");
 		notifyError("Unsupported memory size for loading states.", false);
@@ -723,7 +1900,6 @@ void SaveState::load(size_t slot) const { //throw (Error)
 #endif
 	extern const char* RunningProgram;
 	std::string path;
-	int err;
 	bool Get_Custom_SaveDir(std::string& savedir);
 	if(Get_Custom_SaveDir(path)) {
 		path+=CROSS_FILESPLIT;
@@ -754,27 +1930,15 @@ void SaveState::load(size_t slot) const { //throw (Error)
 	}
 	check_slot.close();
 
-	unz_file_info64 file_info;
-	unzFile zf;
-	{
-		zlib_filefunc64_def ffunc;
-#ifdef USEWIN32IOAPI
-		fill_win32_filefunc64A(&ffunc);
-#else
-		fill_fopen64_filefunc(&ffunc);
-#endif
-		zf = unzOpen2_64(save.c_str(),&ffunc);
-	}
-	if (zf == NULL) { load_err=true; goto done; }
+	StateReader state;
+	if (!state.open(save)) { load_err=true; goto done; }
 
 	{
-		if ((err=unzLocateFile(zf,"DOSBox-X_Version",1/*case sensitive*/)) != UNZ_OK) { load_err=true; goto done; }
-		if ((err=unzGetCurrentFileInfo64(zf,&file_info,NULL,0,NULL,0,NULL,0)) != UNZ_OK) { load_err=true; goto done; }
-		if ((err=unzOpenCurrentFile(zf)) != UNZ_OK) { load_err=true; goto done; }
-		zip_istreambuf zis(zf);
+		std::string entry;
+		if (!state.read("DOSBox-X_Version",entry)) { load_err=true; goto done; }
 
 		char buffer[4096];
-		std::streamsize sz = zis.xsgetn((zip_istreambuf::char_type*)buffer,sizeof(buffer)-1); buffer[sz] = 0;
+		size_t sz = entry.copy(buffer,sizeof(buffer)-1); buffer[sz] = 0;
 
 		char *p;
 		if (strstr(buffer, "\nNo compression") != NULL) {
@@ -792,18 +1956,14 @@ void SaveState::load(size_t slot) const { //throw (Error)
 				goto done;
 			}
 		}
-
-		if ((err=zis.close()) != ZIP_OK) { load_err=true; goto done; }
 	}
 
 	{
-		if ((err=unzLocateFile(zf,"Program_Name",1/*case sensitive*/)) != UNZ_OK) { load_err=true; goto done; }
-		if ((err=unzGetCurrentFileInfo64(zf,&file_info,NULL,0,NULL,0,NULL,0)) != UNZ_OK) { load_err=true; goto done; }
-		if ((err=unzOpenCurrentFile(zf)) != UNZ_OK) { load_err=true; goto done; }
-		zip_istreambuf zis(zf);
+		std::string entry;
+		if (!state.read("Program_Name",entry)) { load_err=true; goto done; }
 
 		char buffer[4096];
-		size_t length = (size_t)zis.xsgetn((zip_istreambuf::char_type*)buffer,sizeof(buffer)-1); buffer[length] = 0;
+		size_t length = entry.copy(buffer,sizeof(buffer)-1); buffer[length] = 0;
 
 		if (!length||(size_t)length!=strlen(RunningProgram)||strncmp(buffer,RunningProgram,length)) {
 			if(!force_load_state&&!loadstateconfirm(1)) {
@@ -824,18 +1984,14 @@ void SaveState::load(size_t slot) const { //throw (Error)
 				GFX_SetTitle(-1,-1,-1,false);
 			}
 		}
-
-		if ((err=zis.close()) != ZIP_OK) { load_err=true; goto done; }
 	}
 
 	{
-		if ((err=unzLocateFile(zf,"Memory_Size",1/*case sensitive*/)) != UNZ_OK) { load_err=true; goto done; }
-		if ((err=unzGetCurrentFileInfo64(zf,&file_info,NULL,0,NULL,0,NULL,0)) != UNZ_OK) { load_err=true; goto done; }
-		if ((err=unzOpenCurrentFile(zf)) != UNZ_OK) { load_err=true; goto done; }
-		zip_istreambuf zis(zf);
+		std::string entry;
+		if (!state.read("Memory_Size",entry)) { load_err=true; goto done; }
 
 		char buffer[4096];
-		size_t length = (size_t)zis.xsgetn((zip_istreambuf::char_type*)buffer,sizeof(buffer)-1); buffer[length] = 0;
+		size_t length = entry.copy(buffer,sizeof(buffer)-1); buffer[length] = 0;
 
 		char str[10];
 		itoa((int)MEM_TotalPages(), str, 10);
@@ -848,18 +2004,14 @@ void SaveState::load(size_t slot) const { //throw (Error)
 				goto done;
 			}
 		}
-
-		if ((err=zis.close()) != ZIP_OK) { load_err=true; goto done; }
 	}
 
 	{
-		if ((err=unzLocateFile(zf,"Machine_Type",1/*case sensitive*/)) != UNZ_OK) { load_err=true; goto done; }
-		if ((err=unzGetCurrentFileInfo64(zf,&file_info,NULL,0,NULL,0,NULL,0)) != UNZ_OK) { load_err=true; goto done; }
-		if ((err=unzOpenCurrentFile(zf)) != UNZ_OK) { load_err=true; goto done; }
-		zip_istreambuf zis(zf);
+		std::string entry;
+		if (!state.read("Machine_Type",entry)) { load_err=true; goto done; }
 
 		char buffer[4096];
-		size_t length = (size_t)zis.xsgetn((zip_istreambuf::char_type*)buffer,sizeof(buffer)-1); buffer[length] = 0;
+		size_t length = entry.copy(buffer,sizeof(buffer)-1); buffer[length] = 0;
 
 		char str[20];
 		strcpy(str, getType().c_str());
@@ -870,29 +2022,40 @@ void SaveState::load(size_t slot) const { //throw (Error)
 				goto done;
 			}
 		}
-
-		if ((err=zis.close()) != ZIP_OK) { load_err=true; goto done; }
 	}
 
-	for (CompEntry::const_iterator i = components.begin(); i != components.end(); ++i) {
-		if ((err=unzLocateFile(zf,i->first.c_str(),1/*case sensitive*/)) != UNZ_OK) { load_err=true; goto done; }
-		if ((err=unzGetCurrentFileInfo64(zf,&file_info,NULL,0,NULL,0,NULL,0)) != UNZ_OK) { load_err=true; goto done; }
-		if ((err=unzOpenCurrentFile(zf)) != UNZ_OK) { load_err=true; goto done; }
-		zip_istreambuf zis(zf); std::istream ss(&zis);
+	/* an incremental state needs every state it was saved on top of, check before changing anything */
+	if (!readChain(save,files)) {
+		notifyError("A save state this state was saved on top of is missing or was overwritten.", false);
+		load_err=true;
+		goto done;
+	}
 
-		i->second.comp.setBytes(ss);
+	/* a zstd state is decompressed on every worker at once, ahead of the components taking it in turn */
+	if (!state.preload()) { load_err=true; goto done; }
 
-		if ((err=zis.close()) != ZIP_OK) { load_err=true; goto done; }
+	for (CompEntry::const_iterator i = components.begin(); i != components.end(); ++i) {
+		if (files.size() > 1 && state.has(i->first+".delta")) {
+			if (!loadDelta(files,i->first,i->second.comp)) { load_err=true; goto done; }
+			continue;
+		}
+		if (!state.load(i->first,[&](Reader& in) { ReadComponent(i->second.comp,false,in); })) { load_err=true; goto done; }
 	}
 
 done:
-	if (zf != NULL) {
-		err = unzClose(zf);
-		if (err != UNZ_OK) load_err = true;
+	if (!state.close()) load_err = true;
+
+	/* the loaded state is the base of the next incremental one */
+	chain.clear();
+	if (!load_err && !files.empty() && !files.back().id.empty()) {
+		chain = files;
+		for (CompEntry::const_iterator i = components.begin(); i != components.end(); ++i)
+			i->second.comp.resetDelta();
 	}
 
 	if (!dos_kernel_disabled) flagged_restore((char *)save.c_str());
 	if (!load_err) LOG_MSG("[%s]: Loaded. (Slot %d)", getTime().c_str(), (int)slot+1);
+	RUNAHEAD_Reset();
 }
 
 bool SaveState::isEmpty(size_t slot) const {
@@ -924,6 +2087,7 @@ bool SaveState::isEmpty(size_t slot) const {
 }
 
 void SaveState::removeState(size_t slot) const {
+	SAVESTATE_FinishSnapshot(true);
 	if (slot >= SLOT_COUNT*MAX_PAGE) return;
 	std::string path;
 	bool Get_Custom_SaveDir(std::string& savedir);
@@ -956,6 +2120,8 @@ void SaveState::removeState(size_t slot) const {
 	if (loadstateconfirm(4)) {
 		check_slot.close();
 		remove(save.c_str());
+		for (size_t i = 0; i < chain.size(); i++)
+			if (chain[i].file == save) chain.clear(); /* next save is a full state again */
 		check_slot.open(save.c_str(), std::ifstream::in);
 		if (!check_slot.fail()) notifyError("Failed to remove the state in the save slot.");
 		if (page!=GetGameState()/SaveState::SLOT_COUNT)
@@ -993,53 +2159,26 @@ std::string SaveState::getName(size_t slot, bool nl) const {
 	if (check_slot.fail()) return nl?"(Empty state)":"["+std::string(MSG_Get("EMPTY_SLOT"))+"]";
 	check_slot.close();
 
-	unzFile zf;
-	{
-		zlib_filefunc64_def ffunc;
-#ifdef USEWIN32IOAPI
-		fill_win32_filefunc64A(&ffunc);
-#else
-		fill_fopen64_filefunc(&ffunc);
-#endif
-		zf = unzOpen2_64(save.c_str(),&ffunc);
-	}
-	if (zf == NULL) return "(Error slot)";
+	StateReader state;
+	if (!state.open(save)) return "(Error slot)";
 
-	int err;
-	std::string ret;
+	std::string ret, entry;
 	char buffer1[4096];
-	unz_file_info64 file_info;
-
-	if (	(err=unzLocateFile(zf,"Program_Name",1/*case sensitive*/)) == UNZ_OK &&
-		(err=unzGetCurrentFileInfo64(zf,&file_info,NULL,0,NULL,0,NULL,0)) == UNZ_OK) {
-		if ((err=unzOpenCurrentFile(zf)) == UNZ_OK) {
-			zip_istreambuf zis(zf);
-			size_t length = (size_t)zis.xsgetn((zip_istreambuf::char_type*)buffer1,sizeof(buffer1)-1); buffer1[length] = 0;
-			zis.close();
-			ret += nl?"Program: "+(!strlen(buffer1)?"-":std::string(buffer1))+"\n":"[Program: "+std::string(buffer1)+"]";
-		}
+
+	if (state.read("Program_Name",entry)) {
+		buffer1[entry.copy(buffer1,sizeof(buffer1)-1)] = 0;
+		ret += nl?"Program: "+(!strlen(buffer1)?"-":std::string(buffer1))+"\n":"[Program: "+std::string(buffer1)+"]";
 	}
 
-	if (	(err=unzLocateFile(zf,"Time_Stamp",1/*case sensitive*/)) == UNZ_OK &&
-		(err=unzGetCurrentFileInfo64(zf,&file_info,NULL,0,NULL,0,NULL,0)) == UNZ_OK) {
-		if ((err=unzOpenCurrentFile(zf)) == UNZ_OK) {
-			zip_istreambuf zis(zf);
-			size_t length = (size_t)zis.xsgetn((zip_istreambuf::char_type*)buffer1,sizeof(buffer1)-1); buffer1[length] = 0;
-			zis.close();
-			ret += nl?"Timestamp: "+(!strlen(buffer1)?"-":std::string(buffer1))+"\n":" ("+std::string(buffer1)+")";
-		}
+	if (state.read("Time_Stamp",entry)) {
+		buffer1[entry.copy(buffer1,sizeof(buffer1)-1)] = 0;
+		ret += nl?"Timestamp: "+(!strlen(buffer1)?"-":std::string(buffer1))+"\n":" ("+std::string(buffer1)+")";
 	}
 
-	if (	(err=unzLocateFile(zf,"Save_Remark",1/*case sensitive*/)) == UNZ_OK &&
-		(err=unzGetCurrentFileInfo64(zf,&file_info,NULL,0,NULL,0,NULL,0)) == UNZ_OK) {
-		if ((err=unzOpenCurrentFile(zf)) == UNZ_OK) {
-			zip_istreambuf zis(zf);
-			size_t length = (size_t)zis.xsgetn((zip_istreambuf::char_type*)buffer1,sizeof(buffer1)-1); buffer1[length] = 0;
-			zis.close();
-			if (length != 0) ret += nl?"Remark: "+(!strlen(buffer1)?"-":std::string(buffer1))+"\n":" - "+std::string(buffer1);
-		}
+	if (state.read("Save_Remark",entry)) {
+		size_t length = entry.copy(buffer1,sizeof(buffer1)-1); buffer1[length] = 0;
+		if (length != 0) ret += nl?"Remark: "+(!strlen(buffer1)?"-":std::string(buffer1))+"\n":" - "+std::string(buffer1);
 	}
-    unzClose(zf);
 	return ret;
 }
 
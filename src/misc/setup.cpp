@@ -23,6 +23,7 @@
 #include "setup.h"
 #include "control.h"
 #include "support.h"
+#include "startupprof.h"
 
 #include <assert.h>
 #include <fstream>
@@ -1167,7 +1168,14 @@ void DispatchVMEvent(enum vm_event event) {
     vm_dispatch_state.begin_event(event);
     for (std::list<Function_wrapper>::iterator i=vm_event_functions[event].begin();i!=vm_event_functions[event].end();++i) {
         LOG(LOG_MISC,LOG_DEBUG)("Calling event %s handler (%p) '%s'",GetVMEventName(event),(void*)((uintptr_t)((*i).function)),(*i).name.c_str());
-        (*i).function(NULL);
+        if (STARTUP_Profiling()) {
+            const std::string phase = std::string(GetVMEventName(event)) + " " + (*i).name;
+            StartupPhase startup_phase(phase.c_str());
+            (*i).function(NULL);
+        }
+        else {
+            (*i).function(NULL);
+        }
     }
 
     vm_dispatch_state.end_event();
@@ -0,0 +1,124 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "dosbox.h"
+#include "logging.h"
+#include "control.h"
+#include "cross.h"
+#include "setup.h"
+#include "sharedasset.h"
+
+#if C_HAVE_MMAP
+# include <sys/mman.h>
+#elif defined(WIN32) && !defined(HX_DOS)
+# include <windows.h>
+# include <io.h>
+#endif
+#if defined(WIN32)
+# include <process.h>
+# define getpid _getpid
+#else
+# include <unistd.h>
+#endif
+
+const void *SHARED_MapFile(FILE *fp,size_t size) {
+    if (fp == NULL || size == 0) return NULL;
+
+#if C_HAVE_MMAP
+    void *map = mmap(NULL,size,PROT_READ,MAP_SHARED,fileno(fp),0);
+    if (map != MAP_FAILED) return map;
+#elif defined(WIN32) && !defined(HX_DOS)
+    const HANDLE fh = (HANDLE)_get_osfhandle(_fileno(fp));
+    if (fh != INVALID_HANDLE_VALUE) {
+        const HANDLE mh = CreateFileMapping(fh,NULL,PAGE_READONLY,0,0,NULL);
+        if (mh != NULL) {
+            void *map = MapViewOfFile(mh,FILE_MAP_READ,0,0,size);
+            CloseHandle(mh); /* the view keeps the mapping alive */
+            if (map != NULL) return map;
+        }
+    }
+#endif
+
+    void *buf = malloc(size);
+    if (buf == NULL) return NULL;
+    if (fseek(fp,0,SEEK_SET) != 0 || fread(buf,1,size,fp) != size) {
+        free(buf);
+        return NULL;
+    }
+    return buf;
+}
+
+static std::string SHARED_Directory(void) {
+    if (control == NULL) return std::string();
+    Section_prop *section = static_cast<Section_prop *>(control->GetSection("dosbox"));
+    return section != NULL ? std::string(section->Get_string("shared asset directory")) : std::string();
+}
+
+/* only a complete file of the right size, a shorter one would fault when touched */
+static const void *SHARED_MapPath(const std::string &path,size_t size) {
+    FILE *fp = fopen(path.c_str(),"rb");
+    if (fp == NULL) return NULL;
+
+    const void *data = NULL;
+    if (fseek(fp,0,SEEK_END) == 0 && ftell(fp) == (long)size) data = SHARED_MapFile(fp,size);
+    fclose(fp);
+    return data;
+}
+
+const void *SHARED_Build(const char *name,size_t size,SHARED_BuildFunc build,const void *ctx) {
+    const std::string dir = SHARED_Directory();
+    if (dir.empty() || size == 0) return NULL;
+
+    const std::string path = dir + CROSS_FILESPLIT + name;
+    const void *data = SHARED_MapPath(path,size);
+    if (data != NULL) {
+        LOG(LOG_MISC,LOG_DEBUG)("Shared asset %s mapped",path.c_str());
+        return data;
+    }
+
+    /* the first process builds it, and writes it under a name of its own so that nobody maps
+     * a file half written. If two race, the last rename wins with the same content. */
+    void *buf = malloc(size);
+    if (buf == NULL) return NULL;
+    if (!build(buf,size,ctx)) {
+        free(buf);
+        return NULL;
+    }
+
+    char suffix[32];
+    snprintf(suffix,sizeof(suffix),".%ld.tmp",(long)getpid());
+    const std::string tmp = path + suffix;
+    FILE *fp = fopen(tmp.c_str(),"wb");
+    bool ok = fp != NULL && fwrite(buf,1,size,fp) == size;
+    if (fp != NULL && fclose(fp) != 0) ok = false;
+    if (ok && rename(tmp.c_str(),path.c_str()) != 0) ok = false; /* Windows does not replace, another process was first */
+    if (!ok) remove(tmp.c_str());
+
+    data = SHARED_MapPath(path,size);
+    if (data == NULL) {
+        LOG(LOG_MISC,LOG_WARN)("Cannot share asset %s, keeping a private copy",path.c_str());
+        return buf;
+    }
+    free(buf);
+    LOG(LOG_MISC,LOG_DEBUG)("Shared asset %s created",path.c_str());
+    return data;
+}
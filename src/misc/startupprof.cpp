@@ -0,0 +1,106 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "dosbox.h"
+#include "logging.h"
+#include "control.h"
+#include "startupprof.h"
+
+/* the phases worth a line of their own in the log */
+#define STARTUP_LOG_MAX     30
+
+struct StartupPhaseTime {
+    std::string name;
+    uint64_t    ns;
+};
+
+/* taken while the static constructors run, as close to the process start as we can get */
+static const std::chrono::steady_clock::time_point startup_origin = std::chrono::steady_clock::now();
+
+static std::vector<StartupPhaseTime> startup_phases;
+static unsigned int startup_depth = 0;
+static bool startup_done = false;
+static double startup_prompt_ms = -1;
+
+static uint64_t STARTUP_Now(void) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startup_origin).count();
+}
+
+bool STARTUP_Profiling(void) {
+    return !startup_done;
+}
+
+void STARTUP_AddPhase(const char *name,uint64_t ns) {
+    if (startup_done) return;
+
+    StartupPhaseTime p;
+    p.name = name;
+    p.ns = ns;
+    startup_phases.push_back(p);
+}
+
+StartupPhase::StartupPhase(const char *name) : name(name), start(0), counted(false), outer(false) {
+    if (startup_done) return;
+    counted = true;
+    outer = startup_depth++ == 0;
+    if (outer) start = STARTUP_Now();
+}
+
+StartupPhase::~StartupPhase() {
+    if (!counted) return;
+    startup_depth--;
+    if (outer) STARTUP_AddPhase(name,STARTUP_Now() - start);
+}
+
+double STARTUP_PromptMs(void) {
+    return startup_prompt_ms;
+}
+
+void STARTUP_PromptReached(void) {
+    if (startup_done) return;
+    startup_done = true;
+
+    const uint64_t total = STARTUP_Now();
+    startup_prompt_ms = (double)total / 1e6;
+    LOG(LOG_MISC,LOG_DEBUG)("Startup: DOS prompt after %.1f ms",startup_prompt_ms);
+
+    if (control == NULL || !control->opt_startup_profile) {
+        startup_phases.clear();
+        return;
+    }
+
+    uint64_t timed = 0;
+    for (const auto &p : startup_phases) timed += p.ns;
+
+    std::stable_sort(startup_phases.begin(),startup_phases.end(),
+        [](const StartupPhaseTime &a,const StartupPhaseTime &b) { return a.ns > b.ns; });
+
+    LOG_MSG("Startup: DOS prompt after %.1f ms, %u phases timed",startup_prompt_ms,(unsigned int)startup_phases.size());
+    for (size_t i=0;i < startup_phases.size() && i < STARTUP_LOG_MAX;i++)
+        LOG_MSG("Startup: %9.2f ms  %s",(double)startup_phases[i].ns / 1e6,startup_phases[i].name.c_str());
+    /* SDL and config setup, the emulated BIOS POST and the shell up to the prompt */
+    LOG_MSG("Startup: %9.2f ms  (everything else)",(double)(total > timed ? total - timed : 0) / 1e6);
+
+    startup_phases.clear();
+    startup_phases.shrink_to_fit();
+}
@@ -0,0 +1,270 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "dosbox.h"
+#include "logging.h"
+#include "setup.h"
+#include "control.h"
+#include "threadpool.h"
+
+#if defined(WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+struct ThreadPoolTask {
+    std::function<void()>       fn;
+    ThreadPoolGroup*            group = nullptr;
+};
+
+struct ThreadPoolQueue {
+    std::mutex                  lock;
+    std::deque<ThreadPoolTask>  tasks;              // protected by lock
+};
+
+static struct {
+    std::vector<std::thread>    workers;
+    std::unique_ptr<ThreadPoolQueue[]> queues;      // one per worker
+    unsigned int                count = 0;          // number of queues, only changed while no worker runs
+    std::atomic<unsigned int>   queued{0};          // tasks in all queues
+    std::atomic<unsigned int>   next{0};            // round robin for tasks queued from outside the pool
+    std::mutex                  sleep;
+    std::condition_variable     work;               // a task was queued, or quit
+    std::condition_variable     idle;               // a group finished
+    bool                        quit = false;       // protected by sleep
+    std::vector<int>            affinity;
+} threadpool;
+
+/* index of the worker running on this thread, -1 outside the pool */
+static thread_local int threadpool_self = -1;
+
+/* own queue newest first, then the other queues oldest first */
+static bool THREADPOOL_Take(ThreadPoolTask &task) {
+    if (threadpool.queued.load(std::memory_order_acquire) == 0) return false;
+
+    const int self = threadpool_self;
+    if (self >= 0) {
+        ThreadPoolQueue &q = threadpool.queues[self];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+            threadpool.queued--;
+            return true;
+        }
+    }
+
+    const unsigned int start = (self >= 0) ? (unsigned int)self + 1u : 0u;
+    for (unsigned int i = 0;i < threadpool.count;i++) {
+        ThreadPoolQueue &q = threadpool.queues[(start + i) % threadpool.count];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            threadpool.queued--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void THREADPOOL_Run(ThreadPoolTask &task) {
+    task.fn();
+    /* the group may go away as soon as pending reaches zero, do not touch it after this */
+    if (task.group->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> guard(threadpool.sleep);
+        threadpool.idle.notify_all();
+    }
+}
+
+static void THREADPOOL_SetAffinity(int cpu) {
+#if defined(WIN32)
+    if (cpu < (int)(sizeof(DWORD_PTR) * 8))
+        SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << (unsigned int)cpu);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+static void THREADPOOL_Worker(unsigned int index) {
+    threadpool_self = (int)index;
+    if (!threadpool.affinity.empty())
+        THREADPOOL_SetAffinity(threadpool.affinity[index % threadpool.affinity.size()]);
+
+    for (;;) {
+        ThreadPoolTask task;
+        if (THREADPOOL_Take(task)) {
+            THREADPOOL_Run(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(threadpool.sleep);
+        threadpool.work.wait(guard, [] { return threadpool.quit || threadpool.queued.load() != 0; });
+        if (threadpool.quit && threadpool.queued.load() == 0) break;
+    }
+}
+
+void ThreadPoolGroup::run(std::function<void()> task) {
+    if (threadpool.count == 0) {
+        task();
+        return;
+    }
+
+    pending++;
+
+    const unsigned int index = (threadpool_self >= 0) ?
+        (unsigned int)threadpool_self : (threadpool.next++ % threadpool.count);
+    {
+        ThreadPoolQueue &q = threadpool.queues[index];
+        std::lock_guard<std::mutex> guard(q.lock);
+        ThreadPoolTask t;
+        t.fn = std::move(task);
+        t.group = this;
+        q.tasks.push_back(std::move(t));
+        threadpool.queued++;
+    }
+    {
+        std::lock_guard<std::mutex> guard(threadpool.sleep);
+    }
+    threadpool.work.notify_one();
+}
+
+void ThreadPoolGroup::wait(void) {
+    while (!done()) {
+        ThreadPoolTask task;
+        if (THREADPOOL_Take(task)) {
+            THREADPOOL_Run(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(threadpool.sleep);
+        threadpool.idle.wait(guard, [this] { return done() || threadpool.queued.load() != 0; });
+    }
+}
+
+unsigned int THREADPOOL_Workers(void) {
+    return threadpool.count;
+}
+
+static void THREADPOOL_Stop(void) {
+    {
+        std::lock_guard<std::mutex> guard(threadpool.sleep);
+        threadpool.quit = true;
+    }
+    threadpool.work.notify_all();
+    for (auto &worker : threadpool.workers)
+        worker.join();
+    threadpool.workers.clear();
+    threadpool.quit = false;
+    threadpool.count = 0;
+    threadpool.queues.reset();
+}
+
+static void THREADPOOL_Shutdown(Section* /*sec*/) {
+    THREADPOOL_Stop();
+}
+
+/* "0,2,4-7" */
+static bool THREADPOOL_ParseAffinity(const char *s,std::vector<int> &cpus) {
+    cpus.clear();
+    while (*s != 0) {
+        char *end;
+        const long first = strtol(s,&end,10);
+        if (end == s || first < 0) return false;
+
+        long last = first;
+        if (*end == '-') {
+            s = end + 1;
+            last = strtol(s,&end,10);
+            if (end == s || last < first) return false;
+        }
+        for (long cpu = first;cpu <= last;cpu++)
+            cpus.push_back((int)cpu);
+
+        s = end;
+        while (*s == ',' || *s == ' ') s++;
+    }
+
+    return true;
+}
+
+void THREADPOOL_Init(void) {
+    Section_prop *sect = static_cast<Section_prop *>(control->GetSection("dosbox"));
+    assert(sect != NULL);
+
+    AddExitFunction(AddExitFunctionFuncPair(THREADPOOL_Shutdown));
+
+    int count = sect->Get_int("worker threads");
+    if (count < 0) count = (int)std::thread::hardware_concurrency() - 1;
+    if (count <= 0) {
+        LOG(LOG_MISC,LOG_DEBUG)("Worker pool: no worker threads, tasks run on the calling thread");
+        return;
+    }
+
+    const char *affinity = sect->Get_string("worker thread affinity");
+    if (affinity != NULL && *affinity != 0) {
+        if (!THREADPOOL_ParseAffinity(affinity,threadpool.affinity)) {
+            LOG_MSG("Worker pool: ignoring bad CPU list '%s'",affinity);
+            threadpool.affinity.clear();
+        }
+#if !defined(WIN32) && !defined(__linux__)
+        else {
+            LOG_MSG("Worker pool: thread affinity is not supported on this platform");
+            threadpool.affinity.clear();
+        }
+#endif
+    }
+
+    /* queues must exist before the first worker looks at them */
+    threadpool.queues.reset(new ThreadPoolQueue[(unsigned int)count]);
+    threadpool.count = (unsigned int)count;
+    try {
+        while (threadpool.workers.size() < (size_t)count)
+            threadpool.workers.emplace_back(THREADPOOL_Worker, (unsigned int)threadpool.workers.size());
+    }
+    catch (const std::system_error &e) {
+        LOG_MSG("Worker pool: unable to start all worker threads: %s", e.what());
+    }
+
+    /* the queues of workers that did not start are still emptied by the others */
+    if (threadpool.workers.empty()) {
+        THREADPOOL_Stop();
+        return;
+    }
+
+    LOG(LOG_MISC,LOG_DEBUG)("Worker pool: %u worker threads",(unsigned int)threadpool.workers.size());
+}
@@ -0,0 +1,229 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include "dosbox.h"
+#include "logging.h"
+#include "cpu.h"
+#include "pic.h"
+#include "menu.h"
+#include "tracerec.h"
+
+std::string GetCaptureFilePath(const char * type,const char * ext);
+void ResolvePath(std::string& in);
+
+bool trace_recording = false;
+
+/* scopes of other threads (save state workers) are not written */
+static thread_local bool trace_thread = false;
+
+struct TraceFrame {
+    unsigned int    what;
+    const void*     key;
+    const char*     name;
+    uint64_t        host;
+    double          emu;
+};
+
+static FILE *trace_fp = NULL;
+static std::string trace_path;
+static TraceFrame trace_stack[32];
+static unsigned int trace_depth = 0;
+static uint64_t trace_host_base = 0;        // CPU_Governor_Clock at the start
+static double trace_emu_base = 0;           // PIC_FullIndex at the start
+static uint64_t trace_events = 0;
+
+static bool trace_in_frame = false;
+static uint64_t trace_frame_host = 0;
+static double trace_frame_emu = 0;
+static uint64_t trace_frame_count = 0;
+
+static std::mutex trace_request_mutex;
+static std::atomic<bool> trace_request_pending(false);
+static bool trace_request_start = false;
+static std::string trace_request_path;
+
+static const char* const trace_categories[TRACE_STATE+1] = {
+    "cpu", "events", "vga", "render", "output", "mixer", "disk", "idle", "state"
+};
+
+enum {
+    TRACE_TID_EMULATION = 1,
+    TRACE_TID_FRAMES
+};
+
+/* one span on both time lines, in microseconds */
+static void TRACE_Write(const char *name,unsigned int what,unsigned int tid,uint64_t host_start,uint64_t host_end,double emu_start,double emu_end) {
+    char safe[64];
+    size_t i = 0;
+    for (;*name && i < sizeof(safe) - 1;name++)
+        if (*name != '"' && *name != '\\' && (unsigned char)*name >= 0x20) safe[i++] = *name;
+    safe[i] = 0;
+
+    const char *cat = trace_categories[what];
+    fprintf(trace_fp,",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+        safe,cat,tid,(double)(host_start - trace_host_base) / 1000.0,(double)(host_end - host_start) / 1000.0);
+    fprintf(trace_fp,",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":2,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+        safe,cat,tid,(emu_start - trace_emu_base) * 1000.0,(emu_end - emu_start) * 1000.0);
+    trace_events++;
+}
+
+bool TRACE_Begin(unsigned int what,const void *key,const char *name) {
+    if (!trace_thread || trace_fp == NULL || trace_depth >= (sizeof(trace_stack) / sizeof(trace_stack[0]))) return false;
+
+    TraceFrame &f = trace_stack[trace_depth++];
+    f.what = what;
+    f.key = key;
+    f.name = name;
+    f.emu = PIC_FullIndex();
+    f.host = CPU_Governor_Clock();
+    return true;
+}
+
+/* scopes still open when the trace stopped end with nothing on the stack */
+void TRACE_End(void) {
+    if (trace_depth == 0) return;
+
+    const uint64_t host = CPU_Governor_Clock();
+    const TraceFrame &f = trace_stack[--trace_depth];
+    char tmp[48];
+    const char *name = f.name;
+    if (name == NULL) {
+        if (f.key != NULL) {
+            snprintf(tmp,sizeof(tmp),"handler %p",f.key);
+            name = tmp;
+        }
+        else {
+            name = trace_categories[f.what];
+        }
+    }
+    TRACE_Write(name,f.what,TRACE_TID_EMULATION,f.host,host,f.emu,PIC_FullIndex());
+}
+
+void TRACE_Frame(bool start) {
+    if (!trace_thread || trace_fp == NULL) return;
+
+    if (start) {
+        trace_in_frame = true;
+        trace_frame_emu = PIC_FullIndex();
+        trace_frame_host = CPU_Governor_Clock();
+    }
+    else if (trace_in_frame) {
+        char tmp[32];
+        trace_in_frame = false;
+        snprintf(tmp,sizeof(tmp),"frame %llu",(unsigned long long)(trace_frame_count++));
+        TRACE_Write(tmp,HOSTTIME_RENDER,TRACE_TID_FRAMES,trace_frame_host,CPU_Governor_Clock(),trace_frame_emu,PIC_FullIndex());
+    }
+}
+
+static void TRACE_UpdateMenu(void) {
+    if (mainMenu.item_exists("mapper_captrace"))
+        mainMenu.get_item("mapper_captrace").check(trace_recording).refresh_item(mainMenu);
+}
+
+void TRACE_Stop(void) {
+    if (trace_fp == NULL) return;
+
+    fprintf(trace_fp,"\n]}\n");
+    fclose(trace_fp);
+    trace_fp = NULL;
+    trace_depth = 0;
+    trace_in_frame = false;
+    trace_recording = false;
+    hosttime_scopes = hosttime_enabled;
+    LOG_MSG("Trace: %llu spans written to %s",(unsigned long long)trace_events,trace_path.c_str());
+    TRACE_UpdateMenu();
+}
+
+static void TRACE_Shutdown(Section* /*sec*/) {
+    TRACE_Stop();
+}
+
+bool TRACE_Start(const std::string& path) {
+    static bool registered = false;
+    if (!registered) {
+        registered = true;
+        AddExitFunction(AddExitFunctionFuncPair(TRACE_Shutdown));
+    }
+    TRACE_Stop();
+
+    if (path.empty()) {
+        trace_path = GetCaptureFilePath("Trace",".json");
+        if (trace_path.empty()) return false;
+    }
+    else {
+        trace_path = path;
+        ResolvePath(trace_path);
+    }
+
+    trace_fp = fopen(trace_path.c_str(),"w");
+    if (trace_fp == NULL) {
+        LOG_MSG("Trace: cannot open '%s': %s",trace_path.c_str(),strerror(errno));
+        return false;
+    }
+    setvbuf(trace_fp,NULL,_IOFBF,1u << 20u);
+
+    fprintf(trace_fp,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(trace_fp,"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"host time\"}},\n");
+    fprintf(trace_fp,"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"emulated time\"}}");
+    for (unsigned int pid = 1;pid <= 2;pid++) {
+        fprintf(trace_fp,",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"emulation\"}}",pid,(unsigned int)TRACE_TID_EMULATION);
+        fprintf(trace_fp,",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"frames\"}}",pid,(unsigned int)TRACE_TID_FRAMES);
+    }
+
+    trace_thread = true;
+    trace_depth = 0;
+    trace_events = 0;
+    trace_in_frame = false;
+    trace_frame_count = 0;
+    trace_emu_base = PIC_FullIndex();
+    trace_host_base = CPU_Governor_Clock();
+    trace_recording = true;
+    hosttime_scopes = true;
+    LOG_MSG("Trace: recording to %s",trace_path.c_str());
+    TRACE_UpdateMenu();
+    return true;
+}
+
+void TRACE_Request(bool start,const std::string& path) {
+    std::lock_guard<std::mutex> guard(trace_request_mutex);
+    trace_request_start = start;
+    trace_request_path = path;
+    trace_request_pending.store(true);
+}
+
+void TRACE_CheckPending(void) {
+    if (!trace_request_pending.load()) return;
+
+    bool start;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> guard(trace_request_mutex);
+        start = trace_request_start;
+        path = trace_request_path;
+        trace_request_pending.store(false);
+    }
+    if (start) TRACE_Start(path);
+    else TRACE_Stop();
+}
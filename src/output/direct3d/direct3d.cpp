@@ -139,7 +139,7 @@ HRESULT CDirect3D::InitializeDX(HWND wnd, bool triplebuf)
     d3dpp.FullScreen_RefreshRateInHz = D3DPRESENT_RATE_DEFAULT;
 	Section_prop * sec=static_cast<Section_prop *>(control->GetSection("vsync"));
 	if(sec) {
-			d3dpp.PresentationInterval = (!strcmp(sec->Get_string("vsyncmode"),"host"))?D3DPRESENT_INTERVAL_DEFAULT:D3DPRESENT_INTERVAL_IMMEDIATE;
+			d3dpp.PresentationInterval = (!strcmp(sec->Get_string("vsyncmode"),"host") || !strcmp(sec->Get_string("vsyncmode"),"adaptive"))?D3DPRESENT_INTERVAL_DEFAULT:D3DPRESENT_INTERVAL_IMMEDIATE;
 	}
 
 
@@ -14,6 +14,7 @@
 #include <output/output_tools_xbrz.h>
 
 #include "sdlmain.h"
+#include "threadpool.h"
 
 using namespace std;
 
@@ -355,8 +356,7 @@ void OUTPUT_DIRECT3D_EndUpdate(const uint16_t *changedLines)
             if (d3d->LockTexture(tgtPix, tgtPitch) && tgtPix) // if locking fails, target texture can be nullptr
             {
                 uint32_t* tgtTex = reinterpret_cast<uint32_t*>(tgtPix);
-# if defined(XBRZ_PPL)
-                concurrency::task_group tg;
+                ThreadPoolGroup tg;
                 for (int i = 0; i < xbrzHeight; i += sdl_xbrz.task_granularity)
                 {
                     tg.run([=] {
@@ -365,9 +365,6 @@ void OUTPUT_DIRECT3D_EndUpdate(const uint16_t *changedLines)
                     });
                 }
                 tg.wait();
-# else
-                xbrz::pitchChange(&xbrzBuf[0], &tgtTex[0], xbrzWidth, xbrzHeight, xbrzWidth * sizeof(uint32_t), tgtPitch, 0, xbrzHeight, [](uint32_t pix) { return pix; });
-# endif
             }
         }
     }
@@ -0,0 +1,649 @@
+#include <sys/types.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "control.h"
+#include "dosbox.h"
+#include "logging.h"
+#include "menudef.h"
+#include "render.h"
+#include "setup.h"
+#include "sdlmain.h"
+
+#include <output/output_tools.h>
+#include <output/output_direct3d11.h>
+
+using namespace std;
+
+#if C_DIRECT3D11
+
+#include <windows.h>
+#include <d3d11.h>
+#include <dxgi1_5.h>
+#include <d3dcompiler.h>
+#include "SDL_syswm.h"
+
+/* Direct3D 11 output with a DXGI flip model swap chain. d3d11.dll and the HLSL compiler are
+ * loaded at run time, so a host without them simply falls back to surface output.
+ *
+ * The emulated screen is kept in framebuf, as with OpenGL and Vulkan, because the scalers only
+ * redraw what changed. Each frame the changed rectangles are copied into a texture that holds
+ * the whole screen, which is drawn scaled into the clip rectangle of the back buffer.
+ *
+ * Flip model presents skip the DWM copy in windowed mode and can go straight to the display.
+ * The swap chain allows "direct3d11 frame latency" frames to be queued. Before drawing, the
+ * output waits on the frame latency waitable object: with vsync (vsyncmode host or adaptive)
+ * that wait paces the emulation like a blocking present would, without vsync a frame for
+ * which the queue is full is not presented (the texture is still updated) and presents use
+ * DXGI_PRESENT_ALLOW_TEARING when the system supports it.
+ *
+ * A composited video debug overlay is a second texture, drawn over the frame with alpha
+ * blending. Its rows are copied from the renderer's layer only when they change. */
+
+#define D3D11_MAX_LATENCY   3u
+
+typedef HRESULT (WINAPI *D3D11_CreateDevice_t)(IDXGIAdapter*, D3D_DRIVER_TYPE, HMODULE, UINT,
+    const D3D_FEATURE_LEVEL*, UINT, UINT, ID3D11Device**, D3D_FEATURE_LEVEL*, ID3D11DeviceContext**);
+
+static struct {
+    HMODULE                     d3d11_dll;
+    HMODULE                     compiler_dll;
+    D3D11_CreateDevice_t        create_device;
+    pD3DCompile                 compile;
+
+    ID3D11Device*               device;
+    ID3D11DeviceContext*        context;
+    ID3D11VertexShader*         vs;
+    ID3D11PixelShader*          ps;
+    ID3D11PixelShader*          ps_overlay;
+    ID3D11BlendState*           blend;
+    ID3D11SamplerState*         point;
+    ID3D11SamplerState*         linear;
+
+    HWND                        hwnd;
+    IDXGISwapChain1*            swapchain;
+    UINT                        swap_flags;
+    HANDLE                      waitable;
+    bool                        tearing;
+    ID3D11RenderTargetView*     target;
+    UINT                        target_width;
+    UINT                        target_height;
+
+    ID3D11Texture2D*            source;
+    ID3D11ShaderResourceView*   source_view;
+    uint32_t                    width;
+    uint32_t                    height;
+    Bitu                        pitch;
+    uint8_t*                    framebuf;
+    bool                        full_upload;
+
+    struct {
+        ID3D11Texture2D*            texture;
+        ID3D11ShaderResourceView*   view;
+        const uint32_t*             pixels;     // NULL when there is no layer
+        Bitu                        width, height, pitch;
+        Bitu                        top, bottom;    // rows not uploaded yet
+    } overlay;
+
+    // configuration
+    bool                        nearest;
+    bool                        vsync;
+    unsigned int                latency;
+} d3d11;
+
+/* Draws one triangle that covers the viewport, so no vertex buffer or input layout is needed */
+static const char d3d11_shader_source[] =
+    "Texture2D screen : register(t0);\n"
+    "SamplerState screen_sampler : register(s0);\n"
+    "struct VSOut { float4 pos : SV_Position; float2 uv : TEXCOORD0; };\n"
+    "VSOut vs_main(uint id : SV_VertexID) {\n"
+    "    VSOut o;\n"
+    "    o.uv = float2((id << 1) & 2, id & 2);\n"
+    "    o.pos = float4(o.uv * float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);\n"
+    "    return o;\n"
+    "}\n"
+    "float4 ps_main(VSOut i) : SV_Target {\n"
+    "    return float4(screen.Sample(screen_sampler, i.uv).rgb, 1.0);\n"
+    "}\n"
+    "float4 ps_overlay(VSOut i) : SV_Target {\n"
+    "    return screen.Sample(screen_sampler, i.uv);\n"
+    "}\n";
+
+template <class T> static void D3D11_Release(T* &p)
+{
+    if (p != NULL) {
+        p->Release();
+        p = NULL;
+    }
+}
+
+static bool D3D11_Check(HRESULT hr, const char *what)
+{
+    if (SUCCEEDED(hr)) return true;
+    LOG_MSG("Direct3D 11: %s failed (0x%08lx)", what, (unsigned long)hr);
+    return false;
+}
+
+static bool D3D11_LoadLibraries()
+{
+    if (d3d11.create_device != NULL && d3d11.compile != NULL) return true;
+
+    if (d3d11.d3d11_dll == NULL) d3d11.d3d11_dll = LoadLibraryA("d3d11.dll");
+    if (d3d11.compiler_dll == NULL) d3d11.compiler_dll = LoadLibraryA("d3dcompiler_47.dll");
+    if (d3d11.d3d11_dll == NULL || d3d11.compiler_dll == NULL) {
+        LOG_MSG("Direct3D 11: d3d11.dll or d3dcompiler_47.dll is not available");
+        return false;
+    }
+
+    d3d11.create_device = (D3D11_CreateDevice_t)GetProcAddress(d3d11.d3d11_dll, "D3D11CreateDevice");
+    d3d11.compile = (pD3DCompile)GetProcAddress(d3d11.compiler_dll, "D3DCompile");
+    return d3d11.create_device != NULL && d3d11.compile != NULL;
+}
+
+static ID3DBlob* D3D11_Compile(const char *entry, const char *target)
+{
+    ID3DBlob *code = NULL, *errors = NULL;
+    const HRESULT hr = d3d11.compile(d3d11_shader_source, sizeof(d3d11_shader_source) - 1, "dosbox-x", NULL, NULL,
+        entry, target, D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &code, &errors);
+    if (FAILED(hr)) {
+        LOG_MSG("Direct3D 11: cannot compile %s: %s", entry,
+            errors ? (const char*)errors->GetBufferPointer() : "unknown error");
+        D3D11_Release(code);
+    }
+    D3D11_Release(errors);
+    return code;
+}
+
+static void D3D11_DestroyOverlay()
+{
+    D3D11_Release(d3d11.overlay.view);
+    D3D11_Release(d3d11.overlay.texture);
+    d3d11.overlay.pixels = NULL;
+    d3d11.overlay.top = d3d11.overlay.bottom = 0;
+}
+
+static void D3D11_DestroySource()
+{
+    D3D11_Release(d3d11.source_view);
+    D3D11_Release(d3d11.source);
+    free(d3d11.framebuf);
+    d3d11.framebuf = NULL;
+    d3d11.width = d3d11.height = 0;
+}
+
+static void D3D11_DestroySwapchain()
+{
+    if (d3d11.context) d3d11.context->ClearState();
+    D3D11_Release(d3d11.target);
+    if (d3d11.waitable != NULL) CloseHandle(d3d11.waitable);
+    d3d11.waitable = NULL;
+    D3D11_Release(d3d11.swapchain);
+    d3d11.hwnd = NULL;
+}
+
+static void D3D11_DestroyDevice()
+{
+    D3D11_DestroySwapchain();
+    D3D11_DestroySource();
+    D3D11_DestroyOverlay();
+    D3D11_Release(d3d11.blend);
+    D3D11_Release(d3d11.point);
+    D3D11_Release(d3d11.linear);
+    D3D11_Release(d3d11.vs);
+    D3D11_Release(d3d11.ps);
+    D3D11_Release(d3d11.ps_overlay);
+    D3D11_Release(d3d11.context);
+    D3D11_Release(d3d11.device);
+}
+
+static bool D3D11_CreateDevice()
+{
+    if (d3d11.device != NULL) return true;
+    if (!D3D11_LoadLibraries()) return false;
+
+    static const D3D_FEATURE_LEVEL levels[] = { D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_10_1, D3D_FEATURE_LEVEL_10_0 };
+    D3D_FEATURE_LEVEL level;
+    if (!D3D11_Check(d3d11.create_device(NULL, D3D_DRIVER_TYPE_HARDWARE, NULL, D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+            levels, (UINT)(sizeof(levels) / sizeof(levels[0])), D3D11_SDK_VERSION, &d3d11.device, &level, &d3d11.context), "D3D11CreateDevice"))
+        return false;
+
+    ID3DBlob *vs = D3D11_Compile("vs_main", "vs_4_0");
+    ID3DBlob *ps = D3D11_Compile("ps_main", "ps_4_0");
+    ID3DBlob *pso = D3D11_Compile("ps_overlay", "ps_4_0");
+    bool ok = vs != NULL && ps != NULL && pso != NULL;
+    if (ok) ok = D3D11_Check(d3d11.device->CreateVertexShader(vs->GetBufferPointer(), vs->GetBufferSize(), NULL, &d3d11.vs), "CreateVertexShader");
+    if (ok) ok = D3D11_Check(d3d11.device->CreatePixelShader(ps->GetBufferPointer(), ps->GetBufferSize(), NULL, &d3d11.ps), "CreatePixelShader");
+    if (ok) ok = D3D11_Check(d3d11.device->CreatePixelShader(pso->GetBufferPointer(), pso->GetBufferSize(), NULL, &d3d11.ps_overlay), "CreatePixelShader");
+    D3D11_Release(vs);
+    D3D11_Release(ps);
+    D3D11_Release(pso);
+
+    D3D11_BLEND_DESC bd = {};
+    bd.RenderTarget[0].BlendEnable = TRUE;
+    bd.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+    bd.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+    bd.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+    bd.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+    bd.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ZERO;
+    bd.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+    bd.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+    if (ok) ok = D3D11_Check(d3d11.device->CreateBlendState(&bd, &d3d11.blend), "CreateBlendState");
+
+    D3D11_SAMPLER_DESC sd = {};
+    sd.AddressU = sd.AddressV = sd.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+    sd.ComparisonFunc = D3D11_COMPARISON_NEVER;
+    sd.MaxLOD = D3D11_FLOAT32_MAX;
+    sd.Filter = D3D11_FILTER_MIN_MAG_MIP_POINT;
+    if (ok) ok = D3D11_Check(d3d11.device->CreateSamplerState(&sd, &d3d11.point), "CreateSamplerState");
+    sd.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    if (ok) ok = D3D11_Check(d3d11.device->CreateSamplerState(&sd, &d3d11.linear), "CreateSamplerState");
+
+    if (!ok) {
+        D3D11_DestroyDevice();
+        return false;
+    }
+
+    LOG(LOG_MISC, LOG_DEBUG)("Direct3D 11: device created, feature level %x", (unsigned int)level);
+    return true;
+}
+
+static bool D3D11_CreateTarget()
+{
+    ID3D11Texture2D *back = NULL;
+    if (!D3D11_Check(d3d11.swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&back), "GetBuffer"))
+        return false;
+
+    D3D11_TEXTURE2D_DESC desc;
+    back->GetDesc(&desc);
+    d3d11.target_width = desc.Width;
+    d3d11.target_height = desc.Height;
+
+    const bool ok = D3D11_Check(d3d11.device->CreateRenderTargetView(back, NULL, &d3d11.target), "CreateRenderTargetView");
+    D3D11_Release(back);
+    return ok;
+}
+
+static bool D3D11_CreateSwapchain(HWND hwnd)
+{
+    IDXGIDevice *dxgi_device = NULL;
+    IDXGIAdapter *adapter = NULL;
+    IDXGIFactory2 *factory = NULL;
+    bool ok = D3D11_Check(d3d11.device->QueryInterface(__uuidof(IDXGIDevice), (void**)&dxgi_device), "QueryInterface(IDXGIDevice)");
+    if (ok) ok = D3D11_Check(dxgi_device->GetAdapter(&adapter), "GetAdapter");
+    if (ok) ok = D3D11_Check(adapter->GetParent(__uuidof(IDXGIFactory2), (void**)&factory), "GetParent(IDXGIFactory2)");
+    D3D11_Release(adapter);
+    D3D11_Release(dxgi_device);
+    if (!ok) {
+        D3D11_Release(factory);
+        return false;
+    }
+
+    /* tearing needs Windows 10 with DXGI 1.5 and a driver that supports it */
+    d3d11.tearing = false;
+    IDXGIFactory5 *factory5 = NULL;
+    if (SUCCEEDED(factory->QueryInterface(__uuidof(IDXGIFactory5), (void**)&factory5))) {
+        BOOL allow = FALSE;
+        if (SUCCEEDED(factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allow, sizeof(allow))))
+            d3d11.tearing = (allow != FALSE);
+        D3D11_Release(factory5);
+    }
+
+    DXGI_SWAP_CHAIN_DESC1 desc = {};
+    desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    desc.BufferCount = 2;
+    desc.Scaling = DXGI_SCALING_STRETCH;
+    desc.AlphaMode = DXGI_ALPHA_MODE_IGNORE;
+    desc.Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT | (d3d11.tearing ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0);
+
+    /* flip discard is Windows 10, flip sequential Windows 8 */
+    desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+    HRESULT hr = factory->CreateSwapChainForHwnd(d3d11.device, hwnd, &desc, NULL, NULL, &d3d11.swapchain);
+    if (FAILED(hr)) {
+        desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
+        desc.Flags &= ~(UINT)DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+        d3d11.tearing = false;
+        hr = factory->CreateSwapChainForHwnd(d3d11.device, hwnd, &desc, NULL, NULL, &d3d11.swapchain);
+    }
+    if (!D3D11_Check(hr, "CreateSwapChainForHwnd")) {
+        D3D11_Release(factory);
+        return false;
+    }
+
+    /* SDL handles fullscreen switching, DXGI must not do it behind its back */
+    factory->MakeWindowAssociation(hwnd, DXGI_MWA_NO_ALT_ENTER);
+    D3D11_Release(factory);
+
+    d3d11.hwnd = hwnd;
+    d3d11.swap_flags = desc.Flags;
+
+    IDXGISwapChain2 *swapchain2 = NULL;
+    if (SUCCEEDED(d3d11.swapchain->QueryInterface(__uuidof(IDXGISwapChain2), (void**)&swapchain2))) {
+        swapchain2->SetMaximumFrameLatency(d3d11.latency);
+        d3d11.waitable = swapchain2->GetFrameLatencyWaitableObject();
+        D3D11_Release(swapchain2);
+    }
+
+    LOG(LOG_MISC, LOG_DEBUG)("Direct3D 11: %s swap chain, frame latency %u, tearing %s",
+        desc.SwapEffect == DXGI_SWAP_EFFECT_FLIP_DISCARD ? "flip discard" : "flip sequential",
+        d3d11.latency, d3d11.tearing ? "supported" : "not supported");
+
+    return D3D11_CreateTarget();
+}
+
+static bool D3D11_ResizeSwapchain()
+{
+    RECT client;
+    GetClientRect(d3d11.hwnd, &client);
+    const UINT w = (UINT)std::max(1L, client.right - client.left);
+    const UINT h = (UINT)std::max(1L, client.bottom - client.top);
+    if (d3d11.target != NULL && w == d3d11.target_width && h == d3d11.target_height) return true;
+
+    d3d11.context->ClearState();
+    D3D11_Release(d3d11.target);
+    if (!D3D11_Check(d3d11.swapchain->ResizeBuffers(0, w, h, DXGI_FORMAT_UNKNOWN, d3d11.swap_flags), "ResizeBuffers"))
+        return false;
+    return D3D11_CreateTarget();
+}
+
+static bool D3D11_CreateSource(uint32_t width, uint32_t height)
+{
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = width;
+    desc.Height = height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    if (!D3D11_Check(d3d11.device->CreateTexture2D(&desc, NULL, &d3d11.source), "CreateTexture2D") ||
+        !D3D11_Check(d3d11.device->CreateShaderResourceView(d3d11.source, NULL, &d3d11.source_view), "CreateShaderResourceView"))
+        return false;
+
+    d3d11.width = width;
+    d3d11.height = height;
+    d3d11.pitch = (Bitu)width * 4u;
+    d3d11.framebuf = (uint8_t*)calloc(height, d3d11.pitch);
+    d3d11.full_upload = true;
+    return d3d11.framebuf != NULL;
+}
+
+/* copy the columns left to right-1 of lines y to y+height-1 from framebuf into the texture */
+static void D3D11_Upload(Bitu left, Bitu y, Bitu right, Bitu height)
+{
+    D3D11_BOX box;
+    box.left = (UINT)left;
+    box.right = (UINT)right;
+    box.top = (UINT)y;
+    box.bottom = (UINT)(y + height);
+    box.front = 0;
+    box.back = 1;
+    d3d11.context->UpdateSubresource(d3d11.source, 0, &box, d3d11.framebuf + y * d3d11.pitch + left * 4u, (UINT)d3d11.pitch, 0);
+}
+
+/* create the overlay texture if needed and copy the rows of the layer that changed */
+static bool D3D11_UpdateOverlay()
+{
+    if (d3d11.overlay.pixels == NULL) return false;
+
+    if (d3d11.overlay.texture == NULL) {
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = (UINT)d3d11.overlay.width;
+        desc.Height = (UINT)d3d11.overlay.height;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        if (!D3D11_Check(d3d11.device->CreateTexture2D(&desc, NULL, &d3d11.overlay.texture), "CreateTexture2D") ||
+            !D3D11_Check(d3d11.device->CreateShaderResourceView(d3d11.overlay.texture, NULL, &d3d11.overlay.view), "CreateShaderResourceView")) {
+            D3D11_DestroyOverlay();
+            return false;
+        }
+        d3d11.overlay.top = 0;
+        d3d11.overlay.bottom = d3d11.overlay.height;
+    }
+
+    if (d3d11.overlay.top < d3d11.overlay.bottom) {
+        D3D11_BOX box;
+        box.left = 0;
+        box.right = (UINT)d3d11.overlay.width;
+        box.top = (UINT)d3d11.overlay.top;
+        box.bottom = (UINT)d3d11.overlay.bottom;
+        box.front = 0;
+        box.back = 1;
+        d3d11.context->UpdateSubresource(d3d11.overlay.texture, 0, &box,
+            d3d11.overlay.pixels + d3d11.overlay.top * d3d11.overlay.pitch, (UINT)(d3d11.overlay.pitch * 4u), 0);
+        d3d11.overlay.top = d3d11.overlay.height;
+        d3d11.overlay.bottom = 0;
+    }
+    return true;
+}
+
+// output API below
+
+void OUTPUT_DIRECT3D11_Select(bool nearest)
+{
+    sdl.desktop.want_type = SCREEN_DIRECT3D11;
+    render.aspectOffload = true;
+
+    Section_prop *section = static_cast<Section_prop *>(control->GetSection("sdl"));
+    d3d11.nearest = nearest;
+    d3d11.latency = (unsigned int)section->Get_int("direct3d11 frame latency");
+    if (d3d11.latency < 1) d3d11.latency = 1;
+    if (d3d11.latency > D3D11_MAX_LATENCY) d3d11.latency = D3D11_MAX_LATENCY;
+
+    void GFX_SetResizeable(bool enable);
+    GFX_SetResizeable(true);
+}
+
+bool OUTPUT_DIRECT3D11_Nearest()
+{
+    return d3d11.nearest;
+}
+
+Bitu OUTPUT_DIRECT3D11_SetSize()
+{
+    uint16_t windowWidth, windowHeight;
+    uint16_t fixedWidth, fixedHeight;
+
+retry:
+    if (sdl.desktop.fullscreen) {
+        fixedWidth = sdl.desktop.full.fixed ? sdl.desktop.full.width : 0;
+        fixedHeight = sdl.desktop.full.fixed ? sdl.desktop.full.height : 0;
+    }
+    else {
+        fixedWidth = sdl.desktop.window.width;
+        fixedHeight = sdl.desktop.window.height;
+    }
+    if (fixedWidth == 0 || fixedHeight == 0) {
+        Bitu consider_height = menu.maxwindow ? currentWindowHeight : 0;
+        Bitu consider_width = menu.maxwindow ? currentWindowWidth : 0;
+        fixedWidth = (uint16_t)max(consider_width, userResizeWindowWidth);
+        fixedHeight = (uint16_t)max(consider_height, userResizeWindowHeight);
+    }
+
+    sdl.clip.x = 0; sdl.clip.y = 0;
+    if (fixedWidth && fixedHeight) {
+        windowWidth = fixedWidth;
+        windowHeight = fixedHeight;
+        sdl.clip.w = windowWidth;
+        sdl.clip.h = windowHeight;
+        if (render.aspect) aspectCorrectFitClip(sdl.clip.w, sdl.clip.h, sdl.clip.x, sdl.clip.y, fixedWidth, fixedHeight);
+    }
+    else {
+        windowWidth = (uint16_t)(sdl.draw.width * sdl.draw.scalex);
+        windowHeight = (uint16_t)(sdl.draw.height * sdl.draw.scaley);
+        if (render.aspect) aspectCorrectExtend(windowWidth, windowHeight);
+        sdl.clip.w = windowWidth; sdl.clip.h = windowHeight;
+    }
+
+    sdl.window = GFX_SetSDLWindowMode(windowWidth, windowHeight, SCREEN_DIRECT3D11);
+    if (sdl.window == NULL) {
+        if (sdl.desktop.fullscreen) {
+            LOG_MSG("Fullscreen not supported: %s", SDL_GetError());
+            sdl.desktop.fullscreen = false;
+            GFX_CaptureMouse();
+            goto retry;
+        }
+        return 0;
+    }
+
+    SDL_SysWMinfo wmi;
+    SDL_VERSION(&wmi.version);
+    if (!SDL_GetWindowWMInfo(sdl.window, &wmi)) {
+        LOG_MSG("Direct3D 11: cannot get the window handle: %s", SDL_GetError());
+        return 0;
+    }
+
+    Section_prop *vsync = static_cast<Section_prop *>(control->GetSection("vsync"));
+    d3d11.vsync = vsync != NULL && (!strcmp(vsync->Get_string("vsyncmode"), "host") || !strcmp(vsync->Get_string("vsyncmode"), "adaptive"));
+
+    if (!D3D11_CreateDevice()) return 0;
+
+    /* the swap chain belongs to the window, a new window needs a new one */
+    if (d3d11.swapchain != NULL && d3d11.hwnd != wmi.info.win.window)
+        D3D11_DestroySwapchain();
+    if ((d3d11.swapchain == NULL && !D3D11_CreateSwapchain(wmi.info.win.window)) || !D3D11_ResizeSwapchain()) {
+        D3D11_DestroyDevice();
+        return 0;
+    }
+
+    D3D11_DestroySource();
+    D3D11_DestroyOverlay();
+    if (!D3D11_CreateSource((uint32_t)sdl.draw.width, (uint32_t)sdl.draw.height)) {
+        D3D11_DestroyDevice();
+        return 0;
+    }
+
+    LOG(LOG_MISC, LOG_DEBUG)("GFX_SetSize Direct3D 11 window=%ux%u clip=x,y,w,h=%d,%d,%d,%d",
+        (unsigned int)windowWidth, (unsigned int)windowHeight,
+        (unsigned int)sdl.clip.x, (unsigned int)sdl.clip.y, (unsigned int)sdl.clip.w, (unsigned int)sdl.clip.h);
+
+    sdl.deferred_resize = false;
+    sdl.must_redraw_all = true;
+    UpdateWindowDimensions();
+    GFX_LogSDLState();
+
+    return GFX_CAN_32 | GFX_SCALING | GFX_CAN_DIRECT;
+}
+
+bool OUTPUT_DIRECT3D11_StartUpdate(uint8_t* &pixels, Bitu &pitch)
+{
+    if (d3d11.framebuf == NULL) return false;
+
+    pixels = d3d11.framebuf;
+    pitch = d3d11.pitch;
+    sdl.updating = true;
+    return true;
+}
+
+void OUTPUT_DIRECT3D11_EndUpdate(const uint16_t *changedLines, const GFX_ChangedSpan *changedSpans)
+{
+    if (d3d11.swapchain == NULL || d3d11.source == NULL || changedLines == NULL) return;
+    if (changedLines[0] == d3d11.height && !d3d11.full_upload && d3d11.overlay.top >= d3d11.overlay.bottom) return;
+
+    if (d3d11.full_upload) {
+        D3D11_Upload(0, 0, d3d11.width, d3d11.height);
+        d3d11.full_upload = false;
+    }
+    else {
+        Bitu y = 0, index = 0;
+        while (y < d3d11.height) {
+            if (index & 1) {
+                Bitu left = 0, right = d3d11.width;
+                if (changedSpans) {
+                    left = changedSpans[index].left;
+                    if (right > changedSpans[index].right) right = changedSpans[index].right;
+                }
+                if (left < right)
+                    D3D11_Upload(left, y, right, changedLines[index]);
+            }
+            y += changedLines[index];
+            index++;
+        }
+    }
+
+    /* with vsync the wait paces the emulation, without it a full queue drops the frame */
+    if (d3d11.waitable != NULL && WaitForSingleObjectEx(d3d11.waitable, d3d11.vsync ? 1000 : 0, TRUE) != WAIT_OBJECT_0)
+        return;
+
+    /* clip rectangle is in window coordinates, the back buffer in pixels */
+    int win_w = 1, win_h = 1;
+    SDL_GetWindowSize(sdl.window, &win_w, &win_h);
+    const float sx = (float)d3d11.target_width / std::max(win_w, 1);
+    const float sy = (float)d3d11.target_height / std::max(win_h, 1);
+
+    D3D11_VIEWPORT vp;
+    vp.TopLeftX = sdl.clip.x * sx;
+    vp.TopLeftY = sdl.clip.y * sy;
+    vp.Width = sdl.clip.w * sx;
+    vp.Height = sdl.clip.h * sy;
+    vp.MinDepth = 0.0f;
+    vp.MaxDepth = 1.0f;
+
+    static const FLOAT black[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    ID3D11SamplerState *sampler = d3d11.nearest ? d3d11.point : d3d11.linear;
+    d3d11.context->OMSetRenderTargets(1, &d3d11.target, NULL);
+    d3d11.context->ClearRenderTargetView(d3d11.target, black);
+    d3d11.context->RSSetViewports(1, &vp);
+    d3d11.context->IASetInputLayout(NULL);
+    d3d11.context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    d3d11.context->VSSetShader(d3d11.vs, NULL, 0);
+    d3d11.context->PSSetShader(d3d11.ps, NULL, 0);
+    d3d11.context->PSSetShaderResources(0, 1, &d3d11.source_view);
+    d3d11.context->PSSetSamplers(0, 1, &sampler);
+    d3d11.context->Draw(3, 0);
+
+    if (D3D11_UpdateOverlay()) {
+        static const FLOAT factor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        d3d11.context->OMSetBlendState(d3d11.blend, factor, 0xFFFFFFFFu);
+        d3d11.context->PSSetShader(d3d11.ps_overlay, NULL, 0);
+        d3d11.context->PSSetShaderResources(0, 1, &d3d11.overlay.view);
+        d3d11.context->PSSetSamplers(0, 1, &d3d11.point);
+        d3d11.context->Draw(3, 0);
+        d3d11.context->OMSetBlendState(NULL, factor, 0xFFFFFFFFu);
+    }
+
+    const UINT interval = d3d11.vsync ? 1 : 0;
+    const UINT flags = (interval == 0 && d3d11.tearing) ? DXGI_PRESENT_ALLOW_TEARING : 0;
+    const HRESULT hr = d3d11.swapchain->Present(interval, flags);
+    if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET) {
+        /* everything has to be created again, which the next mode set does */
+        LOG_MSG("Direct3D 11: device lost (0x%08lx), resetting the screen", (unsigned long)d3d11.device->GetDeviceRemovedReason());
+        D3D11_DestroyDevice();
+        GFX_ResetScreen();
+        return;
+    }
+
+    if (!menu.hidecycles && !sdl.desktop.fullscreen) frames++;
+}
+
+void OUTPUT_DIRECT3D11_SetOverlay(const uint32_t *pixels, Bitu width, Bitu height, Bitu pitch, Bitu top, Bitu bottom)
+{
+    if (pixels != d3d11.overlay.pixels || width != d3d11.overlay.width || height != d3d11.overlay.height) {
+        D3D11_DestroyOverlay();
+        d3d11.overlay.pixels = pixels;
+        d3d11.overlay.width = width;
+        d3d11.overlay.height = height;
+        d3d11.overlay.pitch = pitch;
+        d3d11.overlay.top = 0;
+        d3d11.overlay.bottom = height;
+        return;
+    }
+    if (d3d11.overlay.top > top) d3d11.overlay.top = top;
+    if (d3d11.overlay.bottom < bottom) d3d11.overlay.bottom = bottom;
+}
+
+void OUTPUT_DIRECT3D11_Shutdown()
+{
+    D3D11_DestroyDevice();
+}
+
+#endif /*C_DIRECT3D11*/
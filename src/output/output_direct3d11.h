@@ -0,0 +1,22 @@
+#include "dosbox.h"
+#include "video.h"
+
+#ifndef DOSBOX_OUTPUT_DIRECT3D11_H
+#define DOSBOX_OUTPUT_DIRECT3D11_H
+
+#if C_DIRECT3D11
+
+// output API
+void OUTPUT_DIRECT3D11_Select(bool nearest);
+Bitu OUTPUT_DIRECT3D11_SetSize();
+bool OUTPUT_DIRECT3D11_StartUpdate(uint8_t* &pixels, Bitu &pitch);
+void OUTPUT_DIRECT3D11_EndUpdate(const uint16_t *changedLines, const GFX_ChangedSpan *changedSpans);
+void OUTPUT_DIRECT3D11_Shutdown();
+void OUTPUT_DIRECT3D11_SetOverlay(const uint32_t *pixels, Bitu width, Bitu height, Bitu pitch, Bitu top, Bitu bottom);
+
+// specific additions
+bool OUTPUT_DIRECT3D11_Nearest();
+
+#endif /*C_DIRECT3D11*/
+
+#endif /*DOSBOX_OUTPUT_DIRECT3D11_H*/
@@ -5,6 +5,7 @@
 #include <sys/types.h>
 #include <assert.h>
 #include <math.h>
+#include <algorithm>
 
 #include "dosbox.h"
 #include "logging.h"
@@ -254,6 +255,28 @@ bool OUTPUT_GAMELINK_StartUpdate(uint8_t* &pixels, Bitu &pitch)
     return true;
 }
 
+// Grow the dirty rectangle of the next transfer to cover this area of framebuf
+static void OUTPUT_GAMELINK_AddDirty(Bitu x, Bitu y, Bitu w, Bitu h)
+{
+    GameLink::sFrameRect &dirty = sdl.gamelink.dirty;
+    if (w == 0 || h == 0) return;
+
+    if (dirty.width == 0 || dirty.height == 0) {
+        dirty.x = (uint16_t)x;
+        dirty.y = (uint16_t)y;
+        dirty.width = (uint16_t)w;
+        dirty.height = (uint16_t)h;
+        return;
+    }
+
+    const Bitu x1 = std::max<Bitu>(dirty.x + dirty.width, x + w);
+    const Bitu y1 = std::max<Bitu>(dirty.y + dirty.height, y + h);
+    dirty.x = (uint16_t)std::min<Bitu>(dirty.x, x);
+    dirty.y = (uint16_t)std::min<Bitu>(dirty.y, y);
+    dirty.width = (uint16_t)(x1 - dirty.x);
+    dirty.height = (uint16_t)(y1 - dirty.y);
+}
+
 void OUTPUT_GAMELINK_Transfer()
 {
     //LOG_MSG("OUTPUT_GAMELINK: Transfer");
@@ -262,10 +285,13 @@ void OUTPUT_GAMELINK_Transfer()
         RunningProgram,
         RunningProgramHash,
         (const uint8_t*)sdl.gamelink.framebuf,
+        sdl.gamelink.dirty,
         MemBase );
+
+    sdl.gamelink.dirty.width = sdl.gamelink.dirty.height = 0;
 }
 
-void OUTPUT_GAMELINK_EndUpdate(const uint16_t *changedLines)
+void OUTPUT_GAMELINK_EndUpdate(const uint16_t *changedLines, const GFX_ChangedSpan *changedSpans)
 {
     //LOG_MSG("OUTPUT_GAMELINK: EndUpdate");
 #if C_XBRZ
@@ -299,9 +325,31 @@ void OUTPUT_GAMELINK_EndUpdate(const uint16_t *changedLines)
                 &clipTrg[0], clipWidth, clipHeight, sdl.gamelink.pitch, 
                 sdl_xbrz.postscale_bilinear, sdl_xbrz.task_granularity);
 
+            OUTPUT_GAMELINK_AddDirty(0, 0, (Bitu)(clipX + clipWidth), (Bitu)(clipY + clipHeight));
         }
     }
+    else
 #endif /*C_XBRZ*/
+    if (changedLines == NULL) {
+        OUTPUT_GAMELINK_AddDirty(0, 0, sdl.draw.width, sdl.draw.height);
+    }
+    else {
+        // only what the renderer reports, the shared memory keeps the rest of the last frame
+        Bitu y = 0, index = 0;
+        while (y < sdl.draw.height) {
+            if (index & 1) {
+                Bitu left = 0, right = sdl.draw.width;
+                if (changedSpans) {
+                    left = changedSpans[index].left;
+                    if (right > changedSpans[index].right) right = changedSpans[index].right;
+                }
+                if (left < right)
+                    OUTPUT_GAMELINK_AddDirty(left, y, right - left, changedLines[index]);
+            }
+            y += changedLines[index];
+            index++;
+        }
+    }
     if (!menu.hidecycles) frames++;
     SDL_UpdateWindowSurface(sdl.window);
 }
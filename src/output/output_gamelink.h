@@ -6,6 +6,7 @@
 #if C_GAMELINK
 
 #include "dosbox.h"
+#include "video.h"
 
 #include "../gamelink/gamelink.h"
 
@@ -15,7 +16,7 @@ void OUTPUT_GAMELINK_Select();
 Bitu OUTPUT_GAMELINK_GetBestMode(Bitu flags);
 Bitu OUTPUT_GAMELINK_SetSize();
 bool OUTPUT_GAMELINK_StartUpdate(uint8_t* &pixels, Bitu &pitch);
-void OUTPUT_GAMELINK_EndUpdate(const uint16_t *changedLines);
+void OUTPUT_GAMELINK_EndUpdate(const uint16_t *changedLines, const GFX_ChangedSpan *changedSpans);
 void OUTPUT_GAMELINK_Shutdown();
 
 // specific additions
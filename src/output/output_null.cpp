@@ -0,0 +1,80 @@
+#include <sys/types.h>
+#include <assert.h>
+#include <string.h>
+
+#include <vector>
+
+#include "control.h"
+#include "dosbox.h"
+#include "hardware.h"
+#include "logging.h"
+#include "render.h"
+#include "setup.h"
+#include "sdlmain.h"
+
+#include <output/output_null.h>
+
+using namespace std;
+
+/* output=null is for unattended runs (regression tests, batch conversion). Nothing is shown:
+ * GFX_StartUpdate refuses the frame, so RENDER_StartUpdate skips the scalers entirely. Only
+ * while a screenshot or video capture (including QMP screendump) wants a frame is it rendered
+ * into a private buffer, which keeps the render line cache current for the capture code.
+ * The SDL dummy video driver is used unless another one is configured, so no host window,
+ * X server or GPU is needed. */
+
+static struct {
+    vector<uint32_t>    framebuf;
+    Bitu                pitch = 0;
+} null_output;
+
+void OUTPUT_NULL_Select()
+{
+    sdl.desktop.want_type = SCREEN_NULL;
+    render.aspectOffload = true;
+}
+
+Bitu OUTPUT_NULL_SetSize()
+{
+    sdl.clip.x = 0; sdl.clip.y = 0;
+    sdl.clip.w = sdl.draw.width; sdl.clip.h = sdl.draw.height;
+
+    null_output.pitch = sdl.draw.width * sizeof(uint32_t);
+    null_output.framebuf.assign((size_t)sdl.draw.width * sdl.draw.height, 0);
+
+    return GFX_CAN_32 | GFX_SCALING;
+}
+
+bool OUTPUT_NULL_StartUpdate(uint8_t* &pixels, Bitu &pitch)
+{
+    if ((CaptureState & (CAPTURE_IMAGE|CAPTURE_VIDEO)) == 0 || null_output.framebuf.empty())
+        return false;
+
+    pixels = reinterpret_cast<uint8_t*>(&null_output.framebuf[0]);
+    pitch = null_output.pitch;
+    sdl.updating = true;
+    return true;
+}
+
+void OUTPUT_NULL_EndUpdate(const uint16_t *changedLines)
+{
+    (void)changedLines; /* the capture code already took the frame in RENDER_EndUpdate */
+}
+
+void OUTPUT_NULL_Shutdown()
+{
+    vector<uint32_t>().swap(null_output.framebuf);
+}
+
+bool OUTPUT_NULL_Configured()
+{
+    Section_prop *section = static_cast<Section_prop *>(control->GetSection("sdl"));
+    return section != NULL && !strcmp(section->Get_string("output"), "null");
+}
+
+/* with nobody watching there is nothing to pace the emulation for */
+bool OUTPUT_NULL_Unthrottled()
+{
+    Section_prop *section = static_cast<Section_prop *>(control->GetSection("sdl"));
+    return OUTPUT_NULL_Configured() && section->Get_bool("null output unthrottled");
+}
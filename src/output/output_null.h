@@ -0,0 +1,17 @@
+#include "dosbox.h"
+
+#ifndef DOSBOX_OUTPUT_NULL_H
+#define DOSBOX_OUTPUT_NULL_H
+
+// output API
+void OUTPUT_NULL_Select();
+Bitu OUTPUT_NULL_SetSize();
+bool OUTPUT_NULL_StartUpdate(uint8_t* &pixels, Bitu &pitch);
+void OUTPUT_NULL_EndUpdate(const uint16_t *changedLines);
+void OUTPUT_NULL_Shutdown();
+
+// specific additions
+bool OUTPUT_NULL_Configured();
+bool OUTPUT_NULL_Unthrottled();
+
+#endif /*DOSBOX_OUTPUT_NULL_H*/
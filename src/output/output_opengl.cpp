@@ -68,6 +68,12 @@ PFNGLUNIFORM2FPROC glUniform2f = NULL;
 PFNGLUNIFORM1IPROC glUniform1i = NULL;
 PFNGLUSEPROGRAMPROC glUseProgram = NULL;
 PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointer = NULL;
+PFNGLBUFFERSTORAGEPROC_NP glBufferStorage = NULL;
+PFNGLMAPBUFFERRANGEPROC_NP glMapBufferRange = NULL;
+PFNGLFENCESYNCPROC_NP glFenceSync = NULL;
+PFNGLCLIENTWAITSYNCPROC_NP glClientWaitSync = NULL;
+PFNGLDELETESYNCPROC_NP glDeleteSync = NULL;
+PFNGLACTIVETEXTUREPROC_NP glActiveTexture = NULL;
 }
 
 /* "using" is meant to hide identical names declared in outer scope
@@ -92,6 +98,12 @@ PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointer = NULL;
 #define glUniform1i               gl2::glUniform1i
 #define glUseProgram              gl2::glUseProgram
 #define glVertexAttribPointer     gl2::glVertexAttribPointer
+#define glBufferStorage           gl2::glBufferStorage
+#define glMapBufferRange          gl2::glMapBufferRange
+#define glFenceSync               gl2::glFenceSync
+#define glClientWaitSync          gl2::glClientWaitSync
+#define glDeleteSync              gl2::glDeleteSync
+#define glActiveTexture           gl2::glActiveTexture
 
 #if C_OPENGL && DOSBOXMENU_TYPE == DOSBOXMENU_SDLDRAW
 extern unsigned int SDLDrawGenFontTextureWidth;
@@ -104,6 +116,7 @@ extern int initgl, lastcp;
 extern bool font_16_init;
 
 SDL_OpenGL sdl_opengl = {0};
+static bool indexed_failed = false;
 
 int Voodoo_OGL_GetWidth();
 int Voodoo_OGL_GetHeight();
@@ -404,15 +417,25 @@ void OUTPUT_OPENGL_Select( GLKind kind )
         glBufferDataARB = (PFNGLBUFFERDATAARBPROC)SDL_GL_GetProcAddress("glBufferDataARB");
         glMapBufferARB = (PFNGLMAPBUFFERARBPROC)SDL_GL_GetProcAddress("glMapBufferARB");
         glUnmapBufferARB = (PFNGLUNMAPBUFFERARBPROC)SDL_GL_GetProcAddress("glUnmapBufferARB");
+        glBufferStorage = (PFNGLBUFFERSTORAGEPROC_NP)SDL_GL_GetProcAddress("glBufferStorage");
+        glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC_NP)SDL_GL_GetProcAddress("glMapBufferRange");
+        glFenceSync = (PFNGLFENCESYNCPROC_NP)SDL_GL_GetProcAddress("glFenceSync");
+        glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC_NP)SDL_GL_GetProcAddress("glClientWaitSync");
+        glDeleteSync = (PFNGLDELETESYNCPROC_NP)SDL_GL_GetProcAddress("glDeleteSync");
+        glActiveTexture = (PFNGLACTIVETEXTUREPROC_NP)SDL_GL_GetProcAddress("glActiveTexture");
         const char * gl_ext = (const char *)glGetString (GL_EXTENSIONS);
         if(gl_ext && *gl_ext){
             sdl_opengl.packed_pixel=(strstr(gl_ext,"EXT_packed_pixels") != NULL);
             sdl_opengl.paletted_texture=(strstr(gl_ext,"EXT_paletted_texture") != NULL);
             //sdl_opengl.pixel_buffer_object=(strstr(gl_ext,"GL_ARB_pixel_buffer_object") != NULL ) && glGenBuffersARB && glBindBufferARB && glDeleteBuffersARB && glBufferDataARB && glMapBufferARB && glUnmapBufferARB;
+            sdl_opengl.buffer_storage=(strstr(gl_ext,"GL_ARB_buffer_storage") != NULL) && (strstr(gl_ext,"GL_ARB_sync") != NULL) &&
+                glGenBuffersARB && glBindBufferARB && glDeleteBuffersARB && glUnmapBufferARB &&
+                glBufferStorage && glMapBufferRange && glFenceSync && glClientWaitSync && glDeleteSync;
         } else {
             sdl_opengl.packed_pixel = false;
             sdl_opengl.paletted_texture = false;
             //sdl_opengl.pixel_buffer_object = false;
+            sdl_opengl.buffer_storage = false;
         }
 #ifdef DB_DISABLE_DBO
         sdl_opengl.pixel_buffer_object = false;
@@ -582,6 +605,267 @@ void UpdateSDLDrawDBCSTexture(Bitu code) {
 }
 #endif
 
+static void OUTPUT_OPENGL_FreeUploadRing(void)
+{
+    auto &up = sdl_opengl.upload;
+    if (up.buffer == 0) return;
+
+    for (unsigned int i = 0; i < OPENGL_UPLOAD_SLOTS_MAX; i++) {
+        if (up.fence[i]) glDeleteSync(up.fence[i]);
+        up.fence[i] = nullptr;
+    }
+    glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, up.buffer);
+    glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB);
+    glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+    glDeleteBuffersARB(1, &up.buffer);
+    up.buffer = 0;
+    up.map = nullptr;
+    up.slots = 0;
+    up.next = 0;
+    up.active = nullptr;
+}
+
+static void OUTPUT_OPENGL_AllocUploadRing(unsigned int slots, Bitu slot_size)
+{
+    auto &up = sdl_opengl.upload;
+    if (slots < 2 || !sdl_opengl.buffer_storage) return;
+    if (slots > OPENGL_UPLOAD_SLOTS_MAX) slots = OPENGL_UPLOAD_SLOTS_MAX;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr total = (GLsizeiptr)(slots * slot_size);
+
+    glGetError(); /* read and discard last error */
+    glGenBuffersARB(1, &up.buffer);
+    glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, up.buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER_ARB, total, NULL, flags);
+    up.map = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER_ARB, 0, total, flags);
+    glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+
+    if (up.map == nullptr || glGetError() != GL_NO_ERROR) {
+        LOG_MSG("OpenGL: unable to map upload buffers, uploading from client memory");
+        glDeleteBuffersARB(1, &up.buffer);
+        up.buffer = 0;
+        up.map = nullptr;
+        return;
+    }
+
+    up.slot_size = slot_size;
+    up.slots = slots;
+    up.next = 0;
+    LOG(LOG_MISC, LOG_DEBUG)("OpenGL: %u persistently mapped upload buffers of %u bytes", slots, (unsigned int)slot_size);
+}
+
+/* Take the next upload slot for this frame. If the GPU may still be reading it, leave the
+ * frame to be uploaded from framebuf instead of waiting for the fence. */
+static void OUTPUT_OPENGL_BeginUpload(void)
+{
+    auto &up = sdl_opengl.upload;
+    up.active = nullptr;
+    if (up.slots == 0) return;
+
+    GLsync_NP &fence = up.fence[up.next];
+    if (fence) {
+        const GLenum r = glClientWaitSync(fence, 0, 0);
+        if (r == GL_TIMEOUT_EXPIRED)
+            return;
+        if (r == GL_WAIT_FAILED) {
+            OUTPUT_OPENGL_FreeUploadRing();
+            return;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    up.active = up.map + up.next * up.slot_size;
+    glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, up.buffer);
+}
+
+/* Upload columns x to x+width-1 of lines y to y+height-1 of framebuf to the bound texture */
+static void OUTPUT_OPENGL_UploadRect(Bitu x, Bitu y, Bitu width, Bitu height)
+{
+    auto &up = sdl_opengl.upload;
+    const Bitu pixel_size = sdl_opengl.indexed ? 1 : 4;
+    const Bitu offset = y * sdl_opengl.pitch + x * pixel_size;
+    const void *pixels = (uint8_t *)sdl_opengl.framebuf + offset;
+
+    if (up.active) {
+        for (Bitu row = 0; row < height; row++)
+            memcpy(up.active + offset + row * sdl_opengl.pitch, (uint8_t *)pixels + row * sdl_opengl.pitch, width * pixel_size);
+        /* with a buffer bound the pointer is an offset into it */
+        pixels = (const void*)(uintptr_t)((Bitu)(up.active - up.map) + offset);
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)(sdl_opengl.pitch / pixel_size));
+    if (sdl_opengl.indexed) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, (int)x, (int)y,
+            (int)width, (int)height, GL_LUMINANCE, GL_UNSIGNED_BYTE, pixels);
+    }
+    else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, (int)x, (int)y,
+            (int)width, (int)height, GL_BGRA_EXT,
+#if defined (MACOSX) && !defined(C_SDL2)
+            // needed for proper looking graphics on macOS 10.12, 10.13
+            GL_UNSIGNED_INT_8_8_8_8,
+#else
+            // works on Linux
+            GL_UNSIGNED_INT_8_8_8_8_REV,
+#endif
+            pixels);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+/* Columns of the changed run at index of changedLines, clipped to the drawing width */
+static void OUTPUT_OPENGL_ChangedColumns(const GFX_ChangedSpan *changedSpans, Bitu index, Bitu &left, Bitu &right)
+{
+    left = 0;
+    right = sdl.draw.width;
+    if (changedSpans == NULL) return;
+
+    if (right > changedSpans[index].right) right = changedSpans[index].right;
+    left = changedSpans[index].left;
+}
+
+/* Bind the palette to texture unit 1 and upload it if it changed since the last frame */
+static void OUTPUT_OPENGL_UploadPalette(void)
+{
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, sdl_opengl.palette_texture);
+    if (sdl_opengl.palette_dirty) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 256, 1, GL_BGRA_EXT, GL_UNSIGNED_BYTE, sdl_opengl.palette);
+        sdl_opengl.palette_dirty = false;
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sdl_opengl.texture);
+}
+
+void OUTPUT_OPENGL_SetPalette(Bitu start, Bitu count, const GFX_PalEntry *entries)
+{
+    for (Bitu i = 0; i < count && (start + i) < 256; i++) {
+        uint8_t *p = &sdl_opengl.palette[(start + i) * 4];
+        p[0] = entries[i].b;
+        p[1] = entries[i].g;
+        p[2] = entries[i].r;
+        p[3] = 0xFF;
+    }
+    sdl_opengl.palette_dirty = true;
+}
+
+void OUTPUT_OPENGL_SetOverlay(const uint32_t *pixels, Bitu width, Bitu height, Bitu pitch, Bitu top, Bitu bottom)
+{
+    auto &ov = sdl_opengl.overlay;
+    if (pixels != ov.pixels || width != ov.width || height != ov.height) {
+        if (ov.texture > 0) glDeleteTextures(1, &ov.texture);
+        ov.texture = 0;
+        ov.pixels = pixels;
+        ov.width = width;
+        ov.height = height;
+        ov.pitch = pitch;
+        ov.top = 0;
+        ov.bottom = height;
+        return;
+    }
+    if (ov.top > top) ov.top = top;
+    if (ov.bottom < bottom) ov.bottom = bottom;
+}
+
+/* Upload the changed rows of the overlay layer and blend it over the clip rectangle. Drawn with
+ * the fixed function pipeline in clip space so it does not depend on the shader or projection
+ * the frame was drawn with. */
+static void OUTPUT_OPENGL_DrawOverlay(void)
+{
+    auto &ov = sdl_opengl.overlay;
+    if (ov.pixels == nullptr) return;
+
+    if (ov.texture == 0) {
+        GLsizei tw = 1, th = 1;
+        while ((Bitu)tw < ov.width) tw <<= 1;
+        while ((Bitu)th < ov.height) th <<= 1;
+        if (tw > sdl_opengl.max_texsize || th > sdl_opengl.max_texsize) {
+            LOG_MSG("OpenGL: video debug overlay of %u x %u is too large for a texture",
+                (unsigned int)ov.width, (unsigned int)ov.height);
+            ov.pixels = nullptr;
+            ov.top = ov.bottom = 0;
+            return;
+        }
+        glGenTextures(1, &ov.texture);
+        glBindTexture(GL_TEXTURE_2D, ov.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, tw, th, 0, GL_BGRA_EXT, GL_UNSIGNED_BYTE, nullptr);
+        ov.texwidth = tw;
+        ov.texheight = th;
+        ov.top = 0;
+        ov.bottom = ov.height;
+    }
+    else {
+        glBindTexture(GL_TEXTURE_2D, ov.texture);
+    }
+
+    if (ov.top < ov.bottom) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)ov.pitch);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, (int)ov.top, (int)ov.width, (int)(ov.bottom - ov.top),
+            GL_BGRA_EXT, GL_UNSIGNED_INT_8_8_8_8_REV, ov.pixels + ov.top * ov.pitch);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, sdl_opengl.indexed ? 1 : 4);
+        ov.top = ov.height;
+        ov.bottom = 0;
+    }
+
+    if (sdl_opengl.program_object) glUseProgram(0);
+    glViewport(sdl.clip.x, sdl.surface->h - sdl.clip.y - sdl.clip.h, sdl.clip.w, sdl.clip.h);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    glMatrixMode(GL_TEXTURE);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_BLEND);
+
+    const GLfloat u = (GLfloat)ov.width / ov.texwidth, v = (GLfloat)ov.height / ov.texheight;
+    glBegin(GL_QUADS);
+    glTexCoord2f(0, 0); glVertex2f(-1, 1);
+    glTexCoord2f(u, 0); glVertex2f(1, 1);
+    glTexCoord2f(u, v); glVertex2f(1, -1);
+    glTexCoord2f(0, v); glVertex2f(-1, -1);
+    glEnd();
+
+    glDisable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ZERO);
+
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+
+    if (sdl_opengl.use_shader)
+        glViewport((sdl.surface->w-sdl.clip.w)/2,(sdl.surface->h-sdl.clip.h)/2,sdl.clip.w,sdl.clip.h);
+    else
+        glViewport(0, 0, sdl.surface->w, sdl.surface->h);
+    if (sdl_opengl.program_object) glUseProgram(sdl_opengl.program_object);
+    glBindTexture(GL_TEXTURE_2D, sdl_opengl.texture);
+}
+
+static void OUTPUT_OPENGL_EndUpload(void)
+{
+    auto &up = sdl_opengl.upload;
+    if (up.active == nullptr) return;
+
+    up.fence[up.next] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+    up.next = (up.next + 1) % up.slots;
+    up.active = nullptr;
+}
+
 Bitu OUTPUT_OPENGL_SetSize()
 {
     Bitu retFlags = 0;
@@ -600,6 +884,7 @@ Bitu OUTPUT_OPENGL_SetSize()
 	    if (sdl_opengl.buffer) glDeleteBuffersARB(1, &sdl_opengl.buffer);
 	    sdl_opengl.buffer = 0;
     }
+    OUTPUT_OPENGL_FreeUploadRing();
     if (sdl_opengl.framebuf != NULL) {
 	    free(sdl_opengl.framebuf);
 	    sdl_opengl.framebuf = NULL;
@@ -609,9 +894,9 @@ Bitu OUTPUT_OPENGL_SetSize()
     Section_prop* sec = static_cast<Section_prop*>(control->GetSection("vsync"));
     if (sec) {
 #if defined(C_SDL2)
-        SDL_GL_SetSwapInterval((!strcmp(sec->Get_string("vsyncmode"), "host")) ? 1 : 0);
+        SDL_GL_SetSwapInterval((!strcmp(sec->Get_string("vsyncmode"), "host") || !strcmp(sec->Get_string("vsyncmode"), "adaptive")) ? 1 : 0);
 #elif SDL_VERSION_ATLEAST(1, 2, 11)
-        SDL_GL_SetAttribute(SDL_GL_SWAP_CONTROL, (!strcmp(sec->Get_string("vsyncmode"), "host")) ? 1 : 0);
+        SDL_GL_SetAttribute(SDL_GL_SWAP_CONTROL, (!strcmp(sec->Get_string("vsyncmode"), "host") || !strcmp(sec->Get_string("vsyncmode"), "adaptive")) ? 1 : 0);
 #endif
     }
 
@@ -650,7 +935,27 @@ Bitu OUTPUT_OPENGL_SetSize()
         return 0;
     }
 
+    Section_prop* rsec = static_cast<Section_prop*>(control->GetSection("render"));
+
+    /* take 8-bit scaler output and expand it in shader_src_indexed. Not with a user shader,
+     * which expects RGB, nor with xBRZ, which scales 32-bit pixels on the CPU. The SDL-drawn
+     * menu is hidden whenever a shader program is in use, so leave it alone while it shows. */
+    sdl_opengl.indexed = (sdl.draw.flags & GFX_LOVE_8) && initgl == 2 && glActiveTexture != NULL &&
+        sdl_opengl.shader_src == NULL && !sdl_opengl.pixel_buffer_object && !indexed_failed && rsec->Get_bool("indexed color");
+#if C_XBRZ
+    if (sdl_xbrz.enable) sdl_opengl.indexed = false;
+#endif
+#if DOSBOXMENU_TYPE == DOSBOXMENU_SDLDRAW
+    if (mainMenu.isVisible()) sdl_opengl.indexed = false;
+#endif
+    if (sdl_opengl.program_object && sdl_opengl.program_indexed != sdl_opengl.indexed) {
+        glUseProgram(0);
+        glDeleteProgram(sdl_opengl.program_object);
+        sdl_opengl.program_object = 0;
+    }
+
     if (sdl_opengl.use_shader && sdl_opengl.shader_src == NULL && !sdl_opengl.shader_def) sdl_opengl.use_shader = false;
+    if (sdl_opengl.indexed) sdl_opengl.use_shader = true;
     if (sdl_opengl.use_shader) {
         GLuint prog=0;
         // reset error
@@ -671,10 +976,15 @@ Bitu OUTPUT_OPENGL_SetSize()
             // does program need to be rebuilt?
             if (sdl_opengl.program_object == 0) {
                 GLuint vertexShader, fragmentShader;
-                const char *src = sdl_opengl.shader_src;
+                const char *src = sdl_opengl.indexed ? shader_src_indexed : sdl_opengl.shader_src;
                 if (src && !LoadGLShaders(src, &vertexShader, &fragmentShader)) {
                     LOG_MSG("SDL:OPENGL:Failed to compile shader, falling back to default");
                     src = NULL;
+                    if (sdl_opengl.indexed) {
+                        /* the default shader cannot show indices, stay with 32-bit output from now on */
+                        sdl_opengl.indexed = false;
+                        indexed_failed = true;
+                    }
                 }
                 if (src == NULL && !LoadGLShaders(shader_src_default, &vertexShader, &fragmentShader)) {
                     LOG_MSG("SDL:OPENGL:Failed to compile default shader!");
@@ -690,7 +1000,7 @@ Bitu OUTPUT_OPENGL_SetSize()
                 }
 #if DOSBOXMENU_TYPE == DOSBOXMENU_SDLDRAW
                 // Todo: Make SDL-drawn menu work with custom GLSL shaders
-                if (!sdl.desktop.prevent_fullscreen) {
+                if (!sdl.desktop.prevent_fullscreen && !sdl_opengl.indexed) {
                     menu.toggle=false;
                     mainMenu.showMenu(false);
                     mainMenu.get_item("mapper_togmenu").check(!menu.toggle).refresh_item(mainMenu);
@@ -746,6 +1056,9 @@ Bitu OUTPUT_OPENGL_SetSize()
 
                 u = glGetUniformLocation(sdl_opengl.program_object, "rubyTexture");
                 glUniform1i(u, 0);
+                u = glGetUniformLocation(sdl_opengl.program_object, "paletteTexture");
+                if (u != (GLint)-1) glUniform1i(u, 1);
+                sdl_opengl.program_indexed = sdl_opengl.indexed;
 
                 sdl_opengl.ruby.texture_size = glGetUniformLocation(sdl_opengl.program_object, "rubyTextureSize");
                 sdl_opengl.ruby.input_size = glGetUniformLocation(sdl_opengl.program_object, "rubyInputSize");
@@ -767,9 +1080,13 @@ Bitu OUTPUT_OPENGL_SetSize()
     }
     else
     {
-        sdl_opengl.framebuf = calloc(adjTexWidth*adjTexHeight, 4); //32 bit color
+        const Bitu pixel_size = sdl_opengl.indexed ? 1 : 4; //palette index or 32 bit color
+        sdl_opengl.framebuf = calloc(adjTexWidth*adjTexHeight, pixel_size);
+
+        OUTPUT_OPENGL_AllocUploadRing((unsigned int)rsec->Get_int("glpbo"), adjTexWidth*adjTexHeight*pixel_size);
     }
-    sdl_opengl.pitch = adjTexWidth * 4;
+    sdl_opengl.pitch = adjTexWidth * (sdl_opengl.indexed ? 1 : 4);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, sdl_opengl.indexed ? 1 : 4);
 
     glBindTexture(GL_TEXTURE_2D, 0);
 
@@ -786,6 +1103,10 @@ Bitu OUTPUT_OPENGL_SetSize()
         glViewport((sdl.surface->w-sdl.clip.w)/2,(sdl.surface->h-sdl.clip.h)/2,sdl.clip.w,sdl.clip.h);
     else
         glViewport(0, 0, sdl.surface->w, sdl.surface->h);
+    /* the renderer sends the whole debug overlay layer again after a mode set */
+    if (sdl_opengl.overlay.texture > 0) glDeleteTextures(1, &sdl_opengl.overlay.texture);
+    sdl_opengl.overlay.texture = 0;
+    sdl_opengl.overlay.pixels = nullptr;
     if (sdl_opengl.texture > 0) glDeleteTextures(1, &sdl_opengl.texture);
     glGenTextures(1, &sdl_opengl.texture);
     glBindTexture(GL_TEXTURE_2D, sdl_opengl.texture);
@@ -797,13 +1118,32 @@ Bitu OUTPUT_OPENGL_SetSize()
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
 
     GLint interp;
-    if( sdl_opengl.kind == GLNearest || sdl_opengl.kind == GLPerfect )
+    if( sdl_opengl.kind == GLNearest || sdl_opengl.kind == GLPerfect || sdl_opengl.indexed )
         interp = GL_NEAREST; else
         interp = GL_LINEAR ;
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, interp );
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, interp );
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texsize, texsize, 0, GL_BGRA_EXT, GL_UNSIGNED_BYTE, nullptr);
+    if (sdl_opengl.indexed)
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE8, texsize, texsize, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, nullptr);
+    else
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texsize, texsize, 0, GL_BGRA_EXT, GL_UNSIGNED_BYTE, nullptr);
+
+    if (sdl_opengl.palette_texture > 0) glDeleteTextures(1, &sdl_opengl.palette_texture);
+    sdl_opengl.palette_texture = 0;
+    if (sdl_opengl.indexed) {
+        glActiveTexture(GL_TEXTURE1);
+        glGenTextures(1, &sdl_opengl.palette_texture);
+        glBindTexture(GL_TEXTURE_2D, sdl_opengl.palette_texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 256, 1, 0, GL_BGRA_EXT, GL_UNSIGNED_BYTE, sdl_opengl.palette);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, sdl_opengl.texture);
+        sdl_opengl.palette_dirty = false;
+    }
 
     // NTS: I'm told that nVidia hardware seems to triple buffer despite our
     //      request to double buffer (according to @pixelmusement), therefore
@@ -908,10 +1248,16 @@ Bitu OUTPUT_OPENGL_SetSize()
     glFlush();
 
     sdl_opengl.inited = true;
-    retFlags = GFX_CAN_32 | GFX_SCALING;
+    retFlags = (sdl_opengl.indexed ? GFX_CAN_8 : GFX_CAN_32) | GFX_SCALING;
 
     if (sdl_opengl.pixel_buffer_object)
         retFlags |= GFX_HARDWARE;
+#if C_XBRZ
+    else if (!(sdl_xbrz.enable && sdl_xbrz.scale_on))
+#else
+    else
+#endif
+        retFlags |= GFX_CAN_DIRECT; /* framebuf is ours and only read back on upload */
 
     return retFlags;
 }
@@ -944,7 +1290,7 @@ bool OUTPUT_OPENGL_StartUpdate(uint8_t* &pixels, Bitu &pitch)
     return true;
 }
 
-void OUTPUT_OPENGL_EndUpdate(const uint16_t *changedLines)
+void OUTPUT_OPENGL_EndUpdate(const uint16_t *changedLines, const GFX_ChangedSpan *changedSpans)
 {
     if (!(sdl.must_redraw_all && changedLines == NULL)) 
     {
@@ -1009,50 +1355,76 @@ void OUTPUT_OPENGL_EndUpdate(const uint16_t *changedLines)
             else
             {
                 glBindTexture(GL_TEXTURE_2D, sdl_opengl.texture);
-                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
-                    (int)(sdl.draw.width * (unsigned int)sdl_xbrz.scale_factor), (int)(sdl.draw.height * (unsigned int)sdl_xbrz.scale_factor), GL_BGRA_EXT,
-#if defined (MACOSX) && !defined(C_SDL2)
-                    // needed for proper looking graphics on macOS 10.12, 10.13
-                    GL_UNSIGNED_INT_8_8_8_8,
-#else
-                    // works on Linux
-                    GL_UNSIGNED_INT_8_8_8_8_REV,
-#endif
-                    (uint8_t *)sdl_opengl.framebuf);
+                OUTPUT_OPENGL_BeginUpload();
+                OUTPUT_OPENGL_UploadRect(0, 0, sdl.draw.width * (unsigned int)sdl_xbrz.scale_factor, sdl.draw.height * (unsigned int)sdl_xbrz.scale_factor);
+                OUTPUT_OPENGL_EndUpload();
             }
             glCallList(sdl_opengl.displaylist);
+            OUTPUT_OPENGL_DrawOverlay();
             SDL_GL_SwapBuffers();
         }
         else
 #endif /*C_XBRZ*/
         if (sdl_opengl.pixel_buffer_object) 
         {
-            if (changedLines && (changedLines[0] == sdl.draw.height))
+            if (changedLines && (changedLines[0] == sdl.draw.height) && sdl_opengl.overlay.top >= sdl_opengl.overlay.bottom)
                 return;
 
+            /* the buffer is one upload, so send the bounding box of the changed runs */
+            Bitu top = 0, bottom = sdl.draw.height, left = 0, right = sdl.draw.width;
+            if (changedLines)
+            {
+                Bitu y = 0, index = 0;
+                top = sdl.draw.height; bottom = 0; left = sdl.draw.width; right = 0;
+                while (y < sdl.draw.height)
+                {
+                    if (index & 1)
+                    {
+                        Bitu l, r;
+                        OUTPUT_OPENGL_ChangedColumns(changedSpans, index, l, r);
+                        if (l < r)
+                        {
+                            if (top > y) top = y;
+                            bottom = y + changedLines[index];
+                            if (left > l) left = l;
+                            if (right < r) right = r;
+                        }
+                    }
+                    y += changedLines[index];
+                    index++;
+                }
+            }
+
             glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_EXT);
             glBindTexture(GL_TEXTURE_2D, sdl_opengl.texture);
-            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
-                (int)sdl.draw.width, (int)sdl.draw.height, GL_BGRA_EXT,
+            if (top < bottom && left < right)
+            {
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)(sdl_opengl.pitch / 4));
+                glTexSubImage2D(GL_TEXTURE_2D, 0, (int)left, (int)top,
+                    (int)(right - left), (int)(bottom - top), GL_BGRA_EXT,
 #if defined (MACOSX)
-                // needed for proper looking graphics on macOS 10.12, 10.13
-                GL_UNSIGNED_INT_8_8_8_8,
+                    // needed for proper looking graphics on macOS 10.12, 10.13
+                    GL_UNSIGNED_INT_8_8_8_8,
 #else
-                // works on Linux
-                GL_UNSIGNED_INT_8_8_8_8_REV,
+                    // works on Linux
+                    GL_UNSIGNED_INT_8_8_8_8_REV,
 #endif
-                (void*)0);
+                    (void*)(uintptr_t)(top * sdl_opengl.pitch + left * 4));
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            }
             glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_EXT, 0);
             //glCallList(sdl_opengl.displaylist);
             //SDL_GL_SwapBuffers();
         }
         else if (changedLines) 
         {
-            if (changedLines[0] == sdl.draw.height)
+            if (changedLines[0] == sdl.draw.height && !(sdl_opengl.indexed && sdl_opengl.palette_dirty) &&
+                sdl_opengl.overlay.top >= sdl_opengl.overlay.bottom)
                 return;
 
             Bitu y = 0, index = 0;
             glBindTexture(GL_TEXTURE_2D, sdl_opengl.texture);
+            OUTPUT_OPENGL_BeginUpload();
             while (y < sdl.draw.height) 
             {
                 if (!(index & 1)) 
@@ -1061,29 +1433,25 @@ void OUTPUT_OPENGL_EndUpdate(const uint16_t *changedLines)
                 }
                 else 
                 {
-                    uint8_t *pixels = (uint8_t *)sdl_opengl.framebuf + y * sdl_opengl.pitch;
-                    Bitu height = changedLines[index];
-                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, (int)y,
-                        (int)sdl.draw.width, (int)height, GL_BGRA_EXT,
-#if defined (MACOSX) && !defined(C_SDL2)
-                        // needed for proper looking graphics on macOS 10.12, 10.13
-                        GL_UNSIGNED_INT_8_8_8_8,
-#else
-                        // works on Linux
-                        GL_UNSIGNED_INT_8_8_8_8_REV,
-#endif
-                        (void*)pixels);
+                    Bitu height = changedLines[index], left, right;
+                    OUTPUT_OPENGL_ChangedColumns(changedSpans, index, left, right);
+                    if (left < right)
+                        OUTPUT_OPENGL_UploadRect(left, y, right - left, height);
                     y += height;
                 }
                 index++;
             }
+            OUTPUT_OPENGL_EndUpload();
         } else
             return;
+        if (sdl_opengl.indexed)
+            OUTPUT_OPENGL_UploadPalette();
         if (sdl_opengl.program_object) {
             glUniform1i(sdl_opengl.ruby.frame_count, sdl_opengl.actual_frame_count++);
             glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
         } else
             glCallList(sdl_opengl.displaylist);
+        OUTPUT_OPENGL_DrawOverlay();
 
 #if 0 /* DEBUG Prove to me that you're drawing the damn texture */
             glBindTexture(GL_TEXTURE_2D, SDLDrawGenFontTexture);
@@ -1130,6 +1498,7 @@ void OUTPUT_OPENGL_Shutdown()
 		if (sdl_opengl.buffer) glDeleteBuffersARB(1, &sdl_opengl.buffer);
 		sdl_opengl.buffer = 0;
 	}
+	OUTPUT_OPENGL_FreeUploadRing();
 	if (sdl_opengl.framebuf != NULL) {
 		free(sdl_opengl.framebuf);
 		sdl_opengl.framebuf = NULL;
@@ -1,4 +1,5 @@
 #include "dosbox.h"
+#include "video.h"
 
 #ifndef DOSBOX_OUTPUT_OPENGL_H
 #define DOSBOX_OUTPUT_OPENGL_H
@@ -31,6 +32,36 @@ typedef GLvoid* (APIENTRYP PFNGLMAPBUFFERARBPROC) (GLenum target, GLenum access)
 typedef GLboolean(APIENTRYP PFNGLUNMAPBUFFERARBPROC) (GLenum target);
 #endif
 
+/* ARB_buffer_storage and ARB_sync, for the persistently mapped upload buffers. The GL headers
+ * of some platforms lack them, so the types get their own names, as with glShaderSource. */
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT                   0x0002
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT              0x0040
+#define GL_MAP_COHERENT_BIT                0x0080
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE      0x9117
+#define GL_ALREADY_SIGNALED                0x911A
+#define GL_TIMEOUT_EXPIRED                 0x911B
+#define GL_CONDITION_SATISFIED             0x911C
+#define GL_WAIT_FAILED                     0x911D
+#endif
+
+typedef struct __GLsync *GLsync_NP;
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC_NP) (GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+typedef void* (APIENTRYP PFNGLMAPBUFFERRANGEPROC_NP) (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef GLsync_NP (APIENTRYP PFNGLFENCESYNCPROC_NP) (GLenum condition, GLbitfield flags);
+typedef GLenum (APIENTRYP PFNGLCLIENTWAITSYNCPROC_NP) (GLsync_NP sync, GLbitfield flags, uint64_t timeout);
+typedef void (APIENTRYP PFNGLDELETESYNCPROC_NP) (GLsync_NP sync);
+typedef void (APIENTRYP PFNGLACTIVETEXTUREPROC_NP) (GLenum texture);
+
+#ifndef GL_TEXTURE0
+#define GL_TEXTURE0                        0x84C0
+#define GL_TEXTURE1                        0x84C1
+#endif
+
 extern PFNGLGENBUFFERSARBPROC glGenBuffersARB;
 extern PFNGLBINDBUFFERARBPROC glBindBufferARB;
 extern PFNGLDELETEBUFFERSARBPROC glDeleteBuffersARB;
@@ -70,6 +101,8 @@ typedef void (APIENTRYP PFNGLVERTEXATTRIBPOINTERPROC) (GLuint index, GLint size,
 
 enum GLKind {GLNearest, GLBilinear, GLPerfect};
 
+#define OPENGL_UPLOAD_SLOTS_MAX 3
+
 struct SDL_OpenGL {
     bool inited;
     Bitu pitch;
@@ -82,6 +115,21 @@ struct SDL_OpenGL {
     bool packed_pixel;
     bool paletted_texture;
     bool pixel_buffer_object;
+    bool buffer_storage;
+    /* Ring of upload buffers ("glpbo" in [render]). The scaler keeps drawing into framebuf, and
+     * the changed lines of each frame are copied into the next slot of one persistently mapped
+     * buffer and uploaded from there, so glTexSubImage2D returns at once. A fence per slot tells
+     * when the GPU is done reading it. If the next slot is still busy, that frame is uploaded
+     * from framebuf as before rather than waiting. */
+    struct {
+        GLuint buffer;
+        uint8_t *map;
+        Bitu slot_size;
+        unsigned int slots;                 // 0 when not in use
+        unsigned int next;
+        GLsync_NP fence[OPENGL_UPLOAD_SLOTS_MAX];
+        uint8_t *active;                    // slot being filled this frame, or nullptr
+    } upload;
     int menudraw_countdown;
     int clear_countdown;
     bool use_shader;
@@ -96,6 +144,23 @@ struct SDL_OpenGL {
     } ruby;
     GLuint actual_frame_count;
     GLfloat vertex_data[2*4];
+    /* Indexed frames ("indexed color" in [render]). With an 8-bit scaler output the texture holds
+     * palette indices and shader_src_indexed looks each one up in a 256x1 palette texture on
+     * texture unit 1, so neither the CPU nor the upload deals with 32-bit pixels. */
+    bool indexed;
+    bool program_indexed;                   // program_object was built from shader_src_indexed
+    GLuint palette_texture;
+    bool palette_dirty;
+    uint8_t palette[256*4];                 // BGRA
+    /* Composited video debug overlay, see GFX_SetOverlay. The layer stays in render's memory,
+     * changed rows are uploaded at the end of the frame and the texture is blended over it. */
+    struct {
+        GLuint texture;                     // 0 until the first frame with the layer
+        const uint32_t *pixels;             // nullptr when there is no layer
+        Bitu width, height, pitch;
+        Bitu top, bottom;                   // rows not uploaded yet
+        GLsizei texwidth, texheight;
+    } overlay;
 #if defined(C_SDL2)
     SDL_GLContext context;
 #endif
@@ -119,6 +184,40 @@ static char const shader_src_default[] =
 	"}\n"
 	"#endif\n";
 
+/* Nearest or (without OPENGLNB) bilinear filtering has to be done on the looked up colors,
+ * never on the indices, so the index texture is always sampled GL_NEAREST. */
+static char const shader_src_indexed[] =
+	"varying vec2 v_texCoord;\n"
+	"uniform vec2 rubyTextureSize;\n"
+	"#if defined(VERTEX)\n"
+	"uniform vec2 rubyInputSize;\n"
+	"attribute vec4 a_position;\n"
+	"void main() {\n"
+	"  gl_Position = a_position;\n"
+	"  v_texCoord = vec2(a_position.x+1.0,1.0-a_position.y)/2.0*rubyInputSize/rubyTextureSize;\n"
+	"}\n"
+	"#elif defined(FRAGMENT)\n"
+	"uniform sampler2D rubyTexture;\n"
+	"uniform sampler2D paletteTexture;\n\n"
+	"vec4 lookup(vec2 tc) {\n"
+	"  float i = texture2D(rubyTexture, tc).r;\n"
+	"  return texture2D(paletteTexture, vec2((i*255.0+0.5)/256.0, 0.5));\n"
+	"}\n\n"
+	"void main() {\n"
+	"#if defined(OPENGLNB)\n"
+	"  gl_FragColor = lookup(v_texCoord);\n"
+	"#else\n"
+	"  vec2 texel = v_texCoord*rubyTextureSize - 0.5;\n"
+	"  vec2 f = fract(texel);\n"
+	"  vec2 d = 1.0/rubyTextureSize;\n"
+	"  vec2 tc = (floor(texel)+0.5)*d;\n"
+	"  vec4 top = mix(lookup(tc), lookup(tc+vec2(d.x,0.0)), f.x);\n"
+	"  vec4 bottom = mix(lookup(tc+vec2(0.0,d.y)), lookup(tc+d), f.x);\n"
+	"  gl_FragColor = mix(top, bottom, f.y);\n"
+	"#endif\n"
+	"}\n"
+	"#endif\n";
+
 extern SDL_OpenGL sdl_opengl;
 
 // output API
@@ -130,7 +229,9 @@ void OUTPUT_OPENGL_Select( GLKind );
 Bitu OUTPUT_OPENGL_GetBestMode(Bitu flags);
 Bitu OUTPUT_OPENGL_SetSize();
 bool OUTPUT_OPENGL_StartUpdate(uint8_t* &pixels, Bitu &pitch);
-void OUTPUT_OPENGL_EndUpdate(const uint16_t *changedLines);
+void OUTPUT_OPENGL_EndUpdate(const uint16_t *changedLines, const GFX_ChangedSpan *changedSpans);
+void OUTPUT_OPENGL_SetPalette(Bitu start, Bitu count, const GFX_PalEntry *entries);
+void OUTPUT_OPENGL_SetOverlay(const uint32_t *pixels, Bitu width, Bitu height, Bitu pitch, Bitu top, Bitu bottom);
 void OUTPUT_OPENGL_Shutdown();
 
 #endif //C_OPENGL
@@ -640,7 +640,7 @@ bool OUTPUT_SURFACE_StartUpdate(uint8_t* &pixels, Bitu &pitch)
     return true;
 }
 
-void OUTPUT_SURFACE_EndUpdate(const uint16_t *changedLines)
+void OUTPUT_SURFACE_EndUpdate(const uint16_t *changedLines, const GFX_ChangedSpan *changedSpans)
 {
 #if DOSBOXMENU_TYPE == DOSBOXMENU_SDLDRAW
     GFX_DrawSDLMenu(mainMenu, mainMenu.display_list);
@@ -684,7 +684,7 @@ void OUTPUT_SURFACE_EndUpdate(const uint16_t *changedLines)
             if (mustLock) SDL_UnlockSurface(sdl.surface);
             if (!menu.hidecycles && !sdl.desktop.fullscreen) frames++;
 #if defined(C_SDL2)
-            SDL_UpdateWindowSurface(sdl.window);
+            GFX_PresentWindowSurface(NULL, 0);
 #else
             SDL_Flip(sdl.surface);
 #endif
@@ -713,7 +713,7 @@ void OUTPUT_SURFACE_EndUpdate(const uint16_t *changedLines)
         if (mustLock) SDL_UnlockSurface(sdl.surface);
         if (!menu.hidecycles && !sdl.desktop.fullscreen) frames++;
 #if defined(C_SDL2)
-        SDL_UpdateWindowSurfaceRects(sdl.window, sdl.updateRects, 1);
+        GFX_PresentWindowSurface(sdl.updateRects, 1);
 #else
         SDL_Flip(sdl.surface);
 #endif
@@ -734,14 +734,14 @@ void OUTPUT_SURFACE_EndUpdate(const uint16_t *changedLines)
                 return;
             if (!menu.hidecycles && !sdl.desktop.fullscreen) frames++;
 #if defined(C_SDL2)
-            SDL_UpdateWindowSurface(sdl.window);
+            GFX_PresentWindowSurface(NULL, 0);
 #else
             SDL_Flip(sdl.surface);
 #endif
         }
         else if (sdl.must_redraw_all) {
 #if defined(C_SDL2)
-            if (changedLines != NULL) SDL_UpdateWindowSurface(sdl.window);
+            if (changedLines != NULL) GFX_PresentWindowSurface(NULL, 0);
 #else
             if (changedLines != NULL) SDL_Flip(sdl.surface);
 #endif
@@ -756,19 +756,27 @@ void OUTPUT_SURFACE_EndUpdate(const uint16_t *changedLines)
                     y += changedLines[index];
                 }
                 else {
-                    SDL_Rect *rect = &sdl.updateRects[rectCount++];
-                    rect->x = sdl.clip.x;
-                    rect->y = sdl.clip.y + (int)y;
-                    rect->w = (uint16_t)sdl.draw.width;
-                    rect->h = changedLines[index];
+                    /* only the columns the renderer reports for this run */
+                    Bitu left = 0, right = sdl.draw.width;
+                    if (changedSpans) {
+                        left = changedSpans[index].left;
+                        if (right > changedSpans[index].right) right = changedSpans[index].right;
+                    }
+                    if (left < right) {
+                        SDL_Rect *rect = &sdl.updateRects[rectCount++];
+                        rect->x = sdl.clip.x + (int)left;
+                        rect->y = sdl.clip.y + (int)y;
+                        rect->w = (uint16_t)(right - left);
+                        rect->h = changedLines[index];
+                        SDL_rect_cliptoscreen(*rect);
+                    }
                     y += changedLines[index];
-                    SDL_rect_cliptoscreen(*rect);
                 }
                 index++;
             }
             if (rectCount) {
 #if defined(C_SDL2)
-                SDL_UpdateWindowSurfaceRects(sdl.window, sdl.updateRects, (int)rectCount);
+                GFX_PresentWindowSurface(sdl.updateRects, (int)rectCount);
 #else
                 SDL_UpdateRects(sdl.surface, (int)rectCount, sdl.updateRects);
 #endif
@@ -33,6 +33,7 @@
 
 #include <output/output_direct3d.h>
 #include <output/output_opengl.h>
+#include <output/output_null.h>
 #include <output/output_surface.h>
 #include <output/output_ttf.h>
 
@@ -170,6 +171,28 @@ void change_output(int output) {
         break;
 #endif
 
+#if C_VULKAN
+    case 13:
+        OUTPUT_VULKAN_Select(false);
+        break;
+    case 14:
+        OUTPUT_VULKAN_Select(true);
+        break;
+#endif
+
+#if C_DIRECT3D11
+    case 16:
+        OUTPUT_DIRECT3D11_Select(false);
+        break;
+    case 17:
+        OUTPUT_DIRECT3D11_Select(true);
+        break;
+#endif
+
+    case 15:
+        OUTPUT_NULL_Select();
+        break;
+
     default:
         LOG_MSG("SDL: Unsupported output device %d, switching back to surface",output);
         OUTPUT_SURFACE_Select();
@@ -298,6 +321,14 @@ void OutputSettingMenuUpdate(void) {
 #if C_GAMELINK
     mainMenu.get_item("output_gamelink").check(sdl.desktop.want_type == SCREEN_GAMELINK).refresh_item(mainMenu);
 #endif
+#if C_VULKAN
+    mainMenu.get_item("output_vulkan").check(sdl.desktop.want_type == SCREEN_VULKAN && !OUTPUT_VULKAN_Nearest()).refresh_item(mainMenu);
+    mainMenu.get_item("output_vulkannb").check(sdl.desktop.want_type == SCREEN_VULKAN && OUTPUT_VULKAN_Nearest()).refresh_item(mainMenu);
+#endif
+#if C_DIRECT3D11
+    mainMenu.get_item("output_direct3d11").check(sdl.desktop.want_type == SCREEN_DIRECT3D11 && !OUTPUT_DIRECT3D11_Nearest()).refresh_item(mainMenu);
+    mainMenu.get_item("output_direct3d11nb").check(sdl.desktop.want_type == SCREEN_DIRECT3D11 && OUTPUT_DIRECT3D11_Nearest()).refresh_item(mainMenu);
+#endif
 }
 
 void SwitchFS(Bitu val) {
@@ -423,6 +454,39 @@ bool toOutput(const char *what) {
         reset = true;
 #endif
     }
+    else if (!strcmp(what,"vulkan")) {
+#if C_VULKAN
+        if (sdl.desktop.want_type == SCREEN_VULKAN && !OUTPUT_VULKAN_Nearest()) return false;
+        change_output(13);
+        reset = true;
+#endif
+    }
+    else if (!strcmp(what,"vulkannb")) {
+#if C_VULKAN
+        if (sdl.desktop.want_type == SCREEN_VULKAN && OUTPUT_VULKAN_Nearest()) return false;
+        change_output(14);
+        reset = true;
+#endif
+    }
+    else if (!strcmp(what,"direct3d11")) {
+#if C_DIRECT3D11
+        if (sdl.desktop.want_type == SCREEN_DIRECT3D11 && !OUTPUT_DIRECT3D11_Nearest()) return false;
+        change_output(16);
+        reset = true;
+#endif
+    }
+    else if (!strcmp(what,"direct3d11nb")) {
+#if C_DIRECT3D11
+        if (sdl.desktop.want_type == SCREEN_DIRECT3D11 && OUTPUT_DIRECT3D11_Nearest()) return false;
+        change_output(17);
+        reset = true;
+#endif
+    }
+    else if (!strcmp(what,"null")) {
+        if (sdl.desktop.want_type == SCREEN_NULL) return false;
+        change_output(15);
+        reset = true;
+    }
     if (reset) RENDER_Reset();
     OutputSettingMenuUpdate();
     return true;
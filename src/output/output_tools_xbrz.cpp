@@ -7,6 +7,7 @@
 #include "logging.h"
 #include "render.h"
 #include "sdlmain.h"
+#include "threadpool.h"
 
 #include <output/output_tools_xbrz.h>
 
@@ -74,11 +75,10 @@ bool xBRZ_SetScaleParameters(int srcWidth, int srcHeight, int dstWidth, int dstH
 
 void xBRZ_Render(const uint32_t* renderBuf, uint32_t* xbrzBuf, const uint16_t *changedLines, const int srcWidth, const int srcHeight, int scalingFactor)
 {
-#ifdef XBRZ_PPL
+    ThreadPoolGroup tg; // slices run in the shared worker pool, see threadpool.h
+
     if (changedLines) // perf: in worst case similar to full input scaling
     {
-        concurrency::task_group tg; // perf: task_group is slightly faster than pure parallel_for
-
         int yLast = 0;
         Bitu y = 0, index = 0;
         while (y < sdl.draw.height)
@@ -95,96 +95,49 @@ void xBRZ_Render(const uint32_t* renderBuf, uint32_t* xbrzBuf, const uint16_t *c
                 yLast = min(srcHeight, sliceLast + 2);   // (and make sure to not overlap with last slice!)
                 for (int i = yFirst; i < yLast; i += sdl_xbrz.task_granularity)
                 {
-                    tg.run([=] { 
-                        const int iLast = min(i + sdl_xbrz.task_granularity, yLast);
-                        xbrz::scale(scalingFactor, renderBuf, xbrzBuf, srcWidth, srcHeight, xbrz::ColorFormat::RGB, xbrz::ScalerCfg(), i, iLast);
+                    const int iLast = min(i + sdl_xbrz.task_granularity, yLast);
+                    tg.run([=] {
+                        xbrz::scale((size_t)scalingFactor, renderBuf, xbrzBuf, srcWidth, srcHeight, xbrz::ColorFormat::RGB, xbrz::ScalerCfg(), i, iLast);
                     });
                 }
             }
             index++;
         }
-        tg.wait();
     }
     else // process complete input image
     {
-        concurrency::task_group tg;
         for (int i = 0; i < srcHeight; i += sdl_xbrz.task_granularity)
         {
-            tg.run([=] { 
-                const int iLast = min(i + sdl_xbrz.task_granularity, srcHeight);
-                xbrz::scale(scalingFactor, renderBuf, xbrzBuf, srcWidth, srcHeight, xbrz::ColorFormat::RGB, xbrz::ScalerCfg(), i, iLast);
+            const int iLast = min(i + sdl_xbrz.task_granularity, srcHeight);
+            tg.run([=] {
+                xbrz::scale((size_t)scalingFactor, renderBuf, xbrzBuf, srcWidth, srcHeight, xbrz::ColorFormat::RGB, xbrz::ScalerCfg(), i, iLast);
             });
         }
-        tg.wait();
-    }
-#else
-    /* non-PPL for non-Windows.
-    * combine the code above, cleanly, if possible. */
-    if (changedLines)
-    {
-        int yLast = 0;
-        Bitu y = 0, index = 0;
-        while (y < sdl.draw.height)
-        {
-            if (!(index & 1))
-                y += changedLines[index];
-            else
-            {
-                const int sliceFirst = int(y);
-                const int sliceLast = int(y + changedLines[index]);
-                y += changedLines[index];
-
-                int yFirst = max(yLast, sliceFirst - 2); // we need to update two adjacent lines as well since they are analyzed by xBRZ!
-                yLast = min(srcHeight, sliceLast + 2);  // (and make sure to not overlap with last slice!)
-                xbrz::scale((size_t)scalingFactor, renderBuf, xbrzBuf, srcWidth, srcHeight, xbrz::ColorFormat::RGB, xbrz::ScalerCfg(), yFirst, yLast);
-            }
-            index++;
-        }
     }
-    else // process complete input image
-    {
-        xbrz::scale((size_t)scalingFactor, renderBuf, xbrzBuf, srcWidth, srcHeight, xbrz::ColorFormat::RGB, xbrz::ScalerCfg(), 0, srcHeight);
-    }
-#endif /*XBRZ_PPL*/
+    tg.wait();
 }
 
-#endif /*C_XBRZ*/
-
-#if C_XBRZ || C_SURFACE_POSTRENDER_ASPECT
-
 void xBRZ_PostScale(const uint32_t* src, const int srcWidth, const int srcHeight, const int srcPitch, 
                     uint32_t* tgt, const int tgtWidth, const int tgtHeight, const int tgtPitch, 
                     const bool bilinear, const int task_granularity)
 {
-    (void)task_granularity;
+    ThreadPoolGroup tg;
 
-# if defined(XBRZ_PPL)
-    if (bilinear) {
-        concurrency::task_group tg;
-        for (int i = 0; i < tgtHeight; i += task_granularity)
+    for (int i = 0; i < tgtHeight; i += task_granularity)
+    {
+        const int iLast = min(i + task_granularity, tgtHeight);
+        if (bilinear)
             tg.run([=] {
-                const int iLast = min(i + task_granularity, tgtHeight);
-                xbrz::bilinearScale(&src[0], srcWidth, srcHeight, srcPitch, &tgt[0], tgtWidth, tgtHeight, tgtPitch, i, iLast, [](uint32_t pix) { return pix; });  
+                xbrz::bilinearScale(&src[0], srcWidth, srcHeight, srcPitch, &tgt[0], tgtWidth, tgtHeight, tgtPitch, i, iLast, [](uint32_t pix) { return pix; });
             });
-        tg.wait();
-    }
-    else
-    {
-        concurrency::task_group tg;
-        for (int i = 0; i < tgtHeight; i += task_granularity)
+        else
             tg.run([=] {
-                const int iLast = min(i + task_granularity, tgtHeight);
                 // perf: going over target is by factor 4 faster than going over source for similar image sizes
                 xbrz::nearestNeighborScale(&src[0], srcWidth, srcHeight, srcPitch, &tgt[0], tgtWidth, tgtHeight, tgtPitch, i, iLast, [](uint32_t pix) { return pix; });
             });
-        tg.wait();
     }
-#else
-    if (bilinear)
-        xbrz::bilinearScale(&src[0], srcWidth, srcHeight, srcPitch, &tgt[0], tgtWidth, tgtHeight, tgtPitch, 0, tgtHeight, [](uint32_t pix) { return pix; });
-    else
-        xbrz::nearestNeighborScale(&src[0], srcWidth, srcHeight, srcPitch, &tgt[0], tgtWidth, tgtHeight, tgtPitch, 0, tgtHeight, [](uint32_t pix) { return pix; });
-#endif
+    tg.wait();
 }
 
+
 #endif /*C_XBRZ || C_SURFACE_POSTRENDER_ASPECT*/
@@ -8,11 +8,6 @@
 #include <libs/xBRZ/xbrz_tools.h>
 #include <cmath>
 
-#if defined(WIN32) && !defined(__MINGW32__) && !defined(HX_DOS)
-#define XBRZ_PPL 1
-#include <ppl.h>
-#endif
-
 #endif /*C_XBRZ || C_SURFACE_POSTRENDER_ASPECT*/
 
 #if C_XBRZ
@@ -33,9 +33,12 @@
 #include "control.h"
 #include "menudef.h"
 #include "callback.h"
+#include "hostmem.h"
+#include "sharedasset.h"
 #include "../ints/int10.h"
 
 #include <output/output_ttf.h>
+#include <unordered_map>
 
 using namespace std;
 
@@ -98,6 +101,11 @@ int checkcol = 0;
 
 static unsigned long ttfSize = sizeof(DOSBoxTTFbi), ttfSizeb = 0, ttfSizei = 0, ttfSizebi = 0;
 static void * ttfFont = DOSBoxTTFbi, * ttfFontb = NULL, * ttfFonti = NULL, * ttfFontbi = NULL;
+
+/* the font files, the glyphs FreeType renders from them are not counted */
+void TTF_GetHostMemory(HostMemSize &sz) {
+    sz.add_heap(ttfSize + ttfSizeb + ttfSizei + ttfSizebi);
+}
 extern int posx, posy, eurAscii, transparency, NonUserResizeCounter;
 extern bool rtl, gbk, chinasea, switchttf, force_conversion, blinking, showdbcs, loadlang, window_was_maximized;
 extern const char* RunningProgram;
@@ -124,6 +132,60 @@ bool init_once = false, init_twice = false;
 extern bool finish_prepare;
 bool is_ttfswitched_on=false;
 
+/* Glyph cache for GFX_EndTextLines. Changed cells used to be rendered by TTF_RenderUNICODE_Shaded
+ * every time, which adds up with DBCS text and large consoles. A rendered cell only depends on its
+ * one or two code points, the font style and both colors, so the surfaces are kept by that and
+ * reused. All of them are dropped when the font is reopened or the cache is full. */
+#define TTF_GLYPH_CACHE_MAX 4096
+
+struct ttf_glyph_key {
+    Uint16      chr[2];
+    Uint8       fg[3], bg[3];
+    Uint8       style;
+    Uint8       dw;
+
+    bool operator==(const ttf_glyph_key &o) const {
+        return memcmp(this, &o, sizeof(*this)) == 0;
+    }
+};
+
+struct ttf_glyph_hash {
+    size_t operator()(const ttf_glyph_key &k) const {
+        uint64_t h = ((uint64_t)k.chr[0] << 48) | ((uint64_t)k.chr[1] << 32) | ((uint64_t)k.style << 25) | ((uint64_t)k.dw << 24) | ((uint64_t)k.fg[0] << 16) | ((uint64_t)k.fg[1] << 8) | k.fg[2];
+        h ^= (((uint64_t)k.bg[0] << 16) | ((uint64_t)k.bg[1] << 8) | k.bg[2]) * 0x9E3779B97F4A7C15ull;
+        return (size_t)(h ^ (h >> 29));
+    }
+};
+
+static std::unordered_map<ttf_glyph_key, SDL_Surface*, ttf_glyph_hash> ttf_glyphs;
+
+static void TTF_FlushGlyphCache() {
+    for (auto &g : ttf_glyphs) SDL_FreeSurface(g.second);
+    ttf_glyphs.clear();
+}
+
+/* text is one code point, or two for a double wide cell. The surface belongs to the cache. */
+static SDL_Surface *TTF_CachedGlyph(const Uint16 *text, const SDL_Color &fg, const SDL_Color &bg, bool dw) {
+    ttf_glyph_key key;
+    memset(&key, 0, sizeof(key));
+    key.chr[0] = text[0];
+    key.chr[1] = text[0] ? text[1] : 0;
+    key.fg[0] = fg.r; key.fg[1] = fg.g; key.fg[2] = fg.b;
+    key.bg[0] = bg.r; key.bg[1] = bg.g; key.bg[2] = bg.b;
+    key.style = (Uint8)TTF_GetFontStyle(ttf.SDL_font);
+    key.dw = dw ? 1 : 0;
+
+    auto it = ttf_glyphs.find(key);
+    if (it != ttf_glyphs.end()) return it->second;
+
+    SDL_Surface *surface = TTF_RenderUNICODE_Shaded(ttf.SDL_font, text, fg, bg, ttf.width*(dw?2:1));
+    if (surface == NULL) return NULL;
+
+    if (ttf_glyphs.size() >= TTF_GLYPH_CACHE_MAX) TTF_FlushGlyphCache();
+    ttf_glyphs[key] = surface;
+    return surface;
+}
+
 int menuwidth_atleast(int width), FileDirExistCP(const char *name), FileDirExistUTF8(std::string &localname, const char *name);
 void AdjustIMEFontSize(void),refreshExtChar(void), initcodepagefont(void), change_output(int output), drawmenu(Bitu val), KEYBOARD_Clear(void), RENDER_Reset(void), DOSBox_SetSysMenu(void), GetMaxWidthHeight(unsigned int *pmaxWidth, unsigned int *pmaxHeight), SetWindowTransparency(int trans), resetFontSize(void), RENDER_CallBack( GFX_CallBackFunctions_t function );
 bool isDBCSCP(void), InitCodePage(void), CodePageGuestToHostUTF16(uint16_t *d/*CROSS_LEN*/,const char *s/*CROSS_LEN*/), systemmessagebox(char const * aTitle, char const * aMessage, char const * aDialogType, char const * aIconType, int aDefaultButton);
@@ -303,8 +365,9 @@ bool readTTFStyle(unsigned long& size, void*& font, FILE * fh) {
     long pos = ftell(fh);
     if (pos != -1L) {
         size = pos;
-        font = malloc((size_t)size);
-        if (font && !fseek(fh, 0, SEEK_SET) && fread(font, 1, (size_t)size, fh) == (size_t)size) {
+        /* mapped, so that every instance using this font shares one copy */
+        font = (void*)SHARED_MapFile(fh, (size_t)size);
+        if (font) {
             fclose(fh);
             return true;
         }
@@ -563,6 +626,7 @@ int setTTFCodePage() {
 
 void GFX_SelectFontByPoints(int ptsize) {
 	bool initCP = true;
+	TTF_FlushGlyphCache();
 	if (ttf.SDL_font) {
 		TTF_CloseFont(ttf.SDL_font);
 		initCP = false;
@@ -1152,10 +1216,9 @@ void GFX_EndTextLines(bool force) {
                     unimap[x-x1] = 0;
                     xmax = max((int)(x-1), xmax);
 
-                    SDL_Surface* textSurface = TTF_RenderUNICODE_Shaded(ttf.SDL_font, unimap, ttf_fgColor, ttf_bgColor, ttf.width*(dw?2:1));
+                    SDL_Surface* textSurface = TTF_CachedGlyph(unimap, ttf_fgColor, ttf_bgColor, dw);
                     ttf_textClip.w = (x-x1)*ttf.width;
                     SDL_BlitSurface(textSurface, &ttf_textClip, sdl.surface, &ttf_textRect);
-                    SDL_FreeSurface(textSurface);
                     x--;
                 }
 			}
@@ -1233,20 +1296,18 @@ void GFX_EndTextLines(bool force) {
                 } else
                     unimap[1] = 0;
 				// first redraw character
-				SDL_Surface* textSurface = TTF_RenderUNICODE_Shaded(ttf.SDL_font, unimap, ttf_fgColor, ttf_bgColor, ttf.width*(dw?2:1));
+				SDL_Surface* textSurface = TTF_CachedGlyph(unimap, ttf_fgColor, ttf_bgColor, dw);
 				ttf_textClip.w = ttf.width*(dw?2:1);
 				ttf_textRect.x = ttf.offX+(rtl?(ttf.cols-x-(dw?2:1)):x)*ttf.width;
 				ttf_textRect.y = ttf.offY+y*ttf.height;
 				SDL_BlitSurface(textSurface, &ttf_textClip, sdl.surface, &ttf_textRect);
-				SDL_FreeSurface(textSurface);
 				if (vga.draw.cursor.blinkon || blinkCursor<0) {
                     // second reverse lower lines
-                    textSurface = TTF_RenderUNICODE_Shaded(ttf.SDL_font, unimap, ttf_bgColor, ttf_fgColor, ttf.width*(dw?2:1));
+                    textSurface = TTF_CachedGlyph(unimap, ttf_bgColor, ttf_fgColor, dw);
                     ttf_textClip.y = (ttf.height*(vga.draw.cursor.sline>15?15:vga.draw.cursor.sline))>>4;
                     ttf_textClip.h = ttf.height - ttf_textClip.y;								// for now, cursor to bottom
                     ttf_textRect.y = ttf.offY+y*ttf.height + ttf_textClip.y;
                     SDL_BlitSurface(textSurface, &ttf_textClip, sdl.surface, &ttf_textRect);
-                    SDL_FreeSurface(textSurface);
 				}
 			}
 		}
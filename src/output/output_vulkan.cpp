@@ -0,0 +1,852 @@
+#include <sys/types.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "control.h"
+#include "dosbox.h"
+#include "logging.h"
+#include "menudef.h"
+#include "render.h"
+#include "setup.h"
+#include "sdlmain.h"
+
+#include <output/output_tools.h>
+#include <output/output_vulkan.h>
+
+using namespace std;
+
+#if C_VULKAN
+
+/* The loader is opened through SDL at run time, so nothing links against libvulkan
+ * and a host without Vulkan simply falls back to surface output. */
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <SDL_vulkan.h>
+
+/* The emulated screen is kept in framebuf, as with OpenGL, because the scalers only redraw
+ * the lines that changed. Each frame the changed lines are copied into the staging buffer
+ * of the next frame slot and from there into a device image that holds the whole screen.
+ * That image is blitted, scaled to the clip rectangle, into the acquired swapchain image.
+ *
+ * Frame pacing: at most "vulkan frames" frames are in flight. The emulation thread never
+ * waits on the GPU or the presentation engine. If the next slot is still in use or no
+ * swapchain image is free, the frame is dropped and the next one uploads the whole screen. */
+
+#define VULKAN_MAX_FRAMES   3u
+#define VULKAN_MAX_IMAGES   8u
+
+#define VULKAN_INSTANCE_FUNCTIONS \
+    VKFN(vkDestroyInstance) \
+    VKFN(vkEnumeratePhysicalDevices) \
+    VKFN(vkGetPhysicalDeviceProperties) \
+    VKFN(vkGetPhysicalDeviceQueueFamilyProperties) \
+    VKFN(vkGetPhysicalDeviceFormatProperties) \
+    VKFN(vkGetPhysicalDeviceMemoryProperties) \
+    VKFN(vkGetPhysicalDeviceSurfaceSupportKHR) \
+    VKFN(vkGetPhysicalDeviceSurfaceCapabilitiesKHR) \
+    VKFN(vkGetPhysicalDeviceSurfaceFormatsKHR) \
+    VKFN(vkGetPhysicalDeviceSurfacePresentModesKHR) \
+    VKFN(vkEnumerateDeviceExtensionProperties) \
+    VKFN(vkDestroySurfaceKHR) \
+    VKFN(vkCreateDevice) \
+    VKFN(vkGetDeviceProcAddr)
+
+#define VULKAN_DEVICE_FUNCTIONS \
+    VKFN(vkDestroyDevice) \
+    VKFN(vkGetDeviceQueue) \
+    VKFN(vkDeviceWaitIdle) \
+    VKFN(vkCreateSwapchainKHR) \
+    VKFN(vkDestroySwapchainKHR) \
+    VKFN(vkGetSwapchainImagesKHR) \
+    VKFN(vkAcquireNextImageKHR) \
+    VKFN(vkQueuePresentKHR) \
+    VKFN(vkQueueSubmit) \
+    VKFN(vkCreateImage) \
+    VKFN(vkDestroyImage) \
+    VKFN(vkGetImageMemoryRequirements) \
+    VKFN(vkBindImageMemory) \
+    VKFN(vkCreateBuffer) \
+    VKFN(vkDestroyBuffer) \
+    VKFN(vkGetBufferMemoryRequirements) \
+    VKFN(vkBindBufferMemory) \
+    VKFN(vkAllocateMemory) \
+    VKFN(vkFreeMemory) \
+    VKFN(vkMapMemory) \
+    VKFN(vkUnmapMemory) \
+    VKFN(vkCreateCommandPool) \
+    VKFN(vkDestroyCommandPool) \
+    VKFN(vkAllocateCommandBuffers) \
+    VKFN(vkResetCommandBuffer) \
+    VKFN(vkBeginCommandBuffer) \
+    VKFN(vkEndCommandBuffer) \
+    VKFN(vkCmdPipelineBarrier) \
+    VKFN(vkCmdCopyBufferToImage) \
+    VKFN(vkCmdBlitImage) \
+    VKFN(vkCmdClearColorImage) \
+    VKFN(vkCreateFence) \
+    VKFN(vkDestroyFence) \
+    VKFN(vkResetFences) \
+    VKFN(vkGetFenceStatus) \
+    VKFN(vkCreateSemaphore) \
+    VKFN(vkDestroySemaphore)
+
+static PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr = NULL;
+static PFN_vkCreateInstance vkCreateInstance = NULL;
+#define VKFN(name) static PFN_##name name = NULL;
+VULKAN_INSTANCE_FUNCTIONS
+VULKAN_DEVICE_FUNCTIONS
+#undef VKFN
+
+struct VulkanFrame {
+    VkBuffer            staging;
+    VkDeviceMemory      staging_memory;
+    uint8_t*            staging_map;
+    VkCommandBuffer     cmd;
+    VkFence             done;
+    VkSemaphore         acquired;
+};
+
+static struct {
+    bool                library;
+    VkInstance          instance;
+
+    SDL_Window*         surface_window;
+    VkSurfaceKHR        surface;
+    VkPhysicalDevice    gpu;
+    VkPhysicalDeviceMemoryProperties memory;
+    uint32_t            queue_family;
+    VkDevice            device;
+    VkQueue             queue;
+    VkCommandPool       pool;
+    bool                linear_blit;
+
+    VkSwapchainKHR      swapchain;
+    VkExtent2D          extent;
+    uint32_t            image_count;
+    VkImage             images[VULKAN_MAX_IMAGES];
+    VkSemaphore         present_ready[VULKAN_MAX_IMAGES];
+    bool                recreate_swapchain;
+
+    VkImage             source;
+    VkDeviceMemory      source_memory;
+    bool                source_valid;
+    uint32_t            width;
+    uint32_t            height;
+    Bitu                pitch;
+    uint8_t*            framebuf;
+
+    VulkanFrame         frame[VULKAN_MAX_FRAMES];
+    unsigned int        frames;
+    unsigned int        next;
+    bool                full_upload;
+
+    // configuration
+    bool                nearest;
+    unsigned int        want_frames;
+    std::string         want_present;
+} vk;
+
+static const VkFormat vulkan_source_format = VK_FORMAT_B8G8R8A8_UNORM;
+
+static bool VULKAN_Check(VkResult r, const char *what)
+{
+    if (r == VK_SUCCESS) return true;
+    LOG_MSG("Vulkan: %s failed (%d)", what, (int)r);
+    return false;
+}
+
+static uint32_t VULKAN_FindMemory(uint32_t type_bits, VkMemoryPropertyFlags flags)
+{
+    for (uint32_t i = 0; i < vk.memory.memoryTypeCount; i++) {
+        if ((type_bits & (1u << i)) && (vk.memory.memoryTypes[i].propertyFlags & flags) == flags)
+            return i;
+    }
+    return UINT32_MAX;
+}
+
+static bool VULKAN_CreateInstance()
+{
+    if (vk.instance != VK_NULL_HANDLE) return true;
+
+    if (!vk.library) {
+        if (SDL_Vulkan_LoadLibrary(NULL) != 0) {
+            LOG_MSG("Vulkan: cannot load the Vulkan loader: %s", SDL_GetError());
+            return false;
+        }
+        vk.library = true;
+    }
+
+    vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr)SDL_Vulkan_GetVkGetInstanceProcAddr();
+    if (vkGetInstanceProcAddr == NULL) return false;
+    vkCreateInstance = (PFN_vkCreateInstance)vkGetInstanceProcAddr(VK_NULL_HANDLE, "vkCreateInstance");
+    if (vkCreateInstance == NULL) return false;
+
+    unsigned int count = 0;
+    if (!SDL_Vulkan_GetInstanceExtensions(sdl.window, &count, NULL)) {
+        LOG_MSG("Vulkan: no surface extensions for this window: %s", SDL_GetError());
+        return false;
+    }
+    std::vector<const char*> extensions(count);
+    SDL_Vulkan_GetInstanceExtensions(sdl.window, &count, extensions.data());
+
+    VkApplicationInfo app = {};
+    app.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    app.pApplicationName = "DOSBox-X";
+    app.pEngineName = "DOSBox-X";
+    app.apiVersion = VK_API_VERSION_1_0;
+
+    VkInstanceCreateInfo ci = {};
+    ci.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    ci.pApplicationInfo = &app;
+    ci.enabledExtensionCount = count;
+    ci.ppEnabledExtensionNames = extensions.data();
+    if (!VULKAN_Check(vkCreateInstance(&ci, NULL, &vk.instance), "vkCreateInstance")) {
+        vk.instance = VK_NULL_HANDLE;
+        return false;
+    }
+
+    bool ok = true;
+#define VKFN(name) name = (PFN_##name)vkGetInstanceProcAddr(vk.instance, #name); if (name == NULL) ok = false;
+    VULKAN_INSTANCE_FUNCTIONS
+#undef VKFN
+    if (!ok) {
+        LOG_MSG("Vulkan: instance is missing required functions");
+        if (vkDestroyInstance) vkDestroyInstance(vk.instance, NULL);
+        vk.instance = VK_NULL_HANDLE;
+        return false;
+    }
+    return true;
+}
+
+static void VULKAN_DestroySwapchain(VkSwapchainKHR keep = VK_NULL_HANDLE)
+{
+    for (uint32_t i = 0; i < VULKAN_MAX_IMAGES; i++) {
+        if (vk.present_ready[i] != VK_NULL_HANDLE) vkDestroySemaphore(vk.device, vk.present_ready[i], NULL);
+        vk.present_ready[i] = VK_NULL_HANDLE;
+        vk.images[i] = VK_NULL_HANDLE;
+    }
+    vk.image_count = 0;
+    if (vk.swapchain != VK_NULL_HANDLE && vk.swapchain != keep) vkDestroySwapchainKHR(vk.device, vk.swapchain, NULL);
+    vk.swapchain = VK_NULL_HANDLE;
+}
+
+static VkPresentModeKHR VULKAN_PickPresentMode()
+{
+    uint32_t count = 0;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(vk.gpu, vk.surface, &count, NULL);
+    std::vector<VkPresentModeKHR> modes(count);
+    vkGetPhysicalDeviceSurfacePresentModesKHR(vk.gpu, vk.surface, &count, modes.data());
+
+    auto has = [&](VkPresentModeKHR m) { return std::find(modes.begin(), modes.end(), m) != modes.end(); };
+
+    if (vk.want_present == "immediate" && has(VK_PRESENT_MODE_IMMEDIATE_KHR)) return VK_PRESENT_MODE_IMMEDIATE_KHR;
+    if ((vk.want_present == "mailbox" || vk.want_present == "auto") && has(VK_PRESENT_MODE_MAILBOX_KHR)) return VK_PRESENT_MODE_MAILBOX_KHR;
+    return VK_PRESENT_MODE_FIFO_KHR; // always supported
+}
+
+static bool VULKAN_CreateSwapchain()
+{
+    vk.recreate_swapchain = false;
+    if (vk.swapchain != VK_NULL_HANDLE) vkDeviceWaitIdle(vk.device);
+
+    VkSurfaceCapabilitiesKHR caps;
+    if (!VULKAN_Check(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vk.gpu, vk.surface, &caps), "vkGetPhysicalDeviceSurfaceCapabilitiesKHR"))
+        return false;
+
+    VkExtent2D extent = caps.currentExtent;
+    if (extent.width == UINT32_MAX) {
+        int w = 0, h = 0;
+        SDL_Vulkan_GetDrawableSize(sdl.window, &w, &h);
+        extent.width = std::max(caps.minImageExtent.width, std::min(caps.maxImageExtent.width, (uint32_t)w));
+        extent.height = std::max(caps.minImageExtent.height, std::min(caps.maxImageExtent.height, (uint32_t)h));
+    }
+    if (extent.width == 0 || extent.height == 0) {
+        /* minimized: no swapchain until the window comes back */
+        VULKAN_DestroySwapchain();
+        return true;
+    }
+    if (!(caps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT)) {
+        LOG_MSG("Vulkan: swapchain images cannot be blitted to");
+        return false;
+    }
+
+    uint32_t count = 0;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(vk.gpu, vk.surface, &count, NULL);
+    std::vector<VkSurfaceFormatKHR> formats(count);
+    vkGetPhysicalDeviceSurfaceFormatsKHR(vk.gpu, vk.surface, &count, formats.data());
+
+    VkSurfaceFormatKHR format = {};
+    format.format = VK_FORMAT_UNDEFINED;
+    for (const auto &f : formats) {
+        VkFormatProperties props;
+        vkGetPhysicalDeviceFormatProperties(vk.gpu, f.format, &props);
+        if (!(props.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT)) continue;
+        if (format.format == VK_FORMAT_UNDEFINED || f.format == VK_FORMAT_B8G8R8A8_UNORM) format = f;
+    }
+    if (format.format == VK_FORMAT_UNDEFINED) {
+        LOG_MSG("Vulkan: no swapchain format can be blitted to");
+        return false;
+    }
+
+    const VkPresentModeKHR mode = VULKAN_PickPresentMode();
+    uint32_t images = caps.minImageCount + 1;
+    if (caps.maxImageCount != 0 && images > caps.maxImageCount) images = caps.maxImageCount;
+    if (images > VULKAN_MAX_IMAGES) images = std::max(caps.minImageCount, VULKAN_MAX_IMAGES);
+
+    VkSwapchainCreateInfoKHR ci = {};
+    ci.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    ci.surface = vk.surface;
+    ci.minImageCount = images;
+    ci.imageFormat = format.format;
+    ci.imageColorSpace = format.colorSpace;
+    ci.imageExtent = extent;
+    ci.imageArrayLayers = 1;
+    ci.imageUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    ci.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ci.preTransform = (caps.supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR) ? VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR : caps.currentTransform;
+    ci.compositeAlpha = (caps.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR) ? VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR : (VkCompositeAlphaFlagBitsKHR)(caps.supportedCompositeAlpha & (~caps.supportedCompositeAlpha + 1));
+    ci.presentMode = mode;
+    ci.clipped = VK_TRUE;
+    ci.oldSwapchain = vk.swapchain;
+
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+    const VkResult r = vkCreateSwapchainKHR(vk.device, &ci, NULL, &swapchain);
+    VULKAN_DestroySwapchain();
+    if (!VULKAN_Check(r, "vkCreateSwapchainKHR")) return false;
+
+    vk.swapchain = swapchain;
+    vk.extent = extent;
+    vkGetSwapchainImagesKHR(vk.device, vk.swapchain, &vk.image_count, NULL);
+    if (vk.image_count > VULKAN_MAX_IMAGES) vk.image_count = VULKAN_MAX_IMAGES;
+    vkGetSwapchainImagesKHR(vk.device, vk.swapchain, &vk.image_count, vk.images);
+
+    VkSemaphoreCreateInfo si = {};
+    si.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    for (uint32_t i = 0; i < vk.image_count; i++) {
+        if (!VULKAN_Check(vkCreateSemaphore(vk.device, &si, NULL, &vk.present_ready[i]), "vkCreateSemaphore"))
+            return false;
+    }
+
+    static const char* const mode_names[] = { "immediate", "mailbox", "fifo", "fifo relaxed" };
+    LOG_MSG("Vulkan: %ux%u swapchain, %u images, %s present mode, %u frames in flight",
+        extent.width, extent.height, vk.image_count, (unsigned int)mode < 4 ? mode_names[mode] : "other", vk.frames);
+    vk.full_upload = true;
+    return true;
+}
+
+static void VULKAN_DestroyFrames()
+{
+    for (unsigned int i = 0; i < VULKAN_MAX_FRAMES; i++) {
+        VulkanFrame &f = vk.frame[i];
+        if (f.staging_map) vkUnmapMemory(vk.device, f.staging_memory);
+        if (f.staging != VK_NULL_HANDLE) vkDestroyBuffer(vk.device, f.staging, NULL);
+        if (f.staging_memory != VK_NULL_HANDLE) vkFreeMemory(vk.device, f.staging_memory, NULL);
+        if (f.done != VK_NULL_HANDLE) vkDestroyFence(vk.device, f.done, NULL);
+        if (f.acquired != VK_NULL_HANDLE) vkDestroySemaphore(vk.device, f.acquired, NULL);
+        /* command buffers go away with the pool */
+        f = VulkanFrame();
+    }
+    vk.frames = 0;
+
+    if (vk.source != VK_NULL_HANDLE) vkDestroyImage(vk.device, vk.source, NULL);
+    if (vk.source_memory != VK_NULL_HANDLE) vkFreeMemory(vk.device, vk.source_memory, NULL);
+    vk.source = VK_NULL_HANDLE;
+    vk.source_memory = VK_NULL_HANDLE;
+    vk.source_valid = false;
+
+    free(vk.framebuf);
+    vk.framebuf = NULL;
+}
+
+static bool VULKAN_CreateFrames(uint32_t width, uint32_t height)
+{
+    vk.width = width;
+    vk.height = height;
+    vk.pitch = (Bitu)width * 4u;
+    vk.framebuf = (uint8_t*)calloc(vk.pitch, height);
+    if (vk.framebuf == NULL) return false;
+
+    VkImageCreateInfo ii = {};
+    ii.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    ii.imageType = VK_IMAGE_TYPE_2D;
+    ii.format = vulkan_source_format;
+    ii.extent.width = width;
+    ii.extent.height = height;
+    ii.extent.depth = 1;
+    ii.mipLevels = 1;
+    ii.arrayLayers = 1;
+    ii.samples = VK_SAMPLE_COUNT_1_BIT;
+    ii.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ii.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    ii.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ii.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (!VULKAN_Check(vkCreateImage(vk.device, &ii, NULL, &vk.source), "vkCreateImage")) return false;
+
+    VkMemoryRequirements req;
+    vkGetImageMemoryRequirements(vk.device, vk.source, &req);
+    VkMemoryAllocateInfo ai = {};
+    ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    ai.allocationSize = req.size;
+    ai.memoryTypeIndex = VULKAN_FindMemory(req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (ai.memoryTypeIndex == UINT32_MAX) ai.memoryTypeIndex = VULKAN_FindMemory(req.memoryTypeBits, 0);
+    if (!VULKAN_Check(vkAllocateMemory(vk.device, &ai, NULL, &vk.source_memory), "vkAllocateMemory")) return false;
+    vkBindImageMemory(vk.device, vk.source, vk.source_memory, 0);
+
+    VkCommandBufferAllocateInfo cai = {};
+    cai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cai.commandPool = vk.pool;
+    cai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cai.commandBufferCount = 1;
+
+    VkFenceCreateInfo fi = {};
+    fi.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fi.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    VkSemaphoreCreateInfo si = {};
+    si.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (unsigned int i = 0; i < vk.want_frames; i++) {
+        VulkanFrame &f = vk.frame[i];
+
+        VkBufferCreateInfo bi = {};
+        bi.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bi.size = (VkDeviceSize)vk.pitch * height;
+        bi.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        bi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (!VULKAN_Check(vkCreateBuffer(vk.device, &bi, NULL, &f.staging), "vkCreateBuffer")) return false;
+
+        vkGetBufferMemoryRequirements(vk.device, f.staging, &req);
+        ai.allocationSize = req.size;
+        ai.memoryTypeIndex = VULKAN_FindMemory(req.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        if (ai.memoryTypeIndex == UINT32_MAX) {
+            LOG_MSG("Vulkan: no host visible coherent memory for staging");
+            return false;
+        }
+        if (!VULKAN_Check(vkAllocateMemory(vk.device, &ai, NULL, &f.staging_memory), "vkAllocateMemory")) return false;
+        vkBindBufferMemory(vk.device, f.staging, f.staging_memory, 0);
+        void *map = NULL;
+        if (!VULKAN_Check(vkMapMemory(vk.device, f.staging_memory, 0, VK_WHOLE_SIZE, 0, &map), "vkMapMemory")) return false;
+        f.staging_map = (uint8_t*)map;
+
+        if (!VULKAN_Check(vkAllocateCommandBuffers(vk.device, &cai, &f.cmd), "vkAllocateCommandBuffers")) return false;
+        if (!VULKAN_Check(vkCreateFence(vk.device, &fi, NULL, &f.done), "vkCreateFence")) return false;
+        if (!VULKAN_Check(vkCreateSemaphore(vk.device, &si, NULL, &f.acquired), "vkCreateSemaphore")) return false;
+        vk.frames++;
+    }
+
+    vk.next = 0;
+    vk.full_upload = true;
+    return true;
+}
+
+static void VULKAN_DestroyDevice()
+{
+    if (vk.device != VK_NULL_HANDLE) {
+        vkDeviceWaitIdle(vk.device);
+        VULKAN_DestroyFrames();
+        VULKAN_DestroySwapchain();
+        if (vk.pool != VK_NULL_HANDLE) vkDestroyCommandPool(vk.device, vk.pool, NULL);
+        vk.pool = VK_NULL_HANDLE;
+        vkDestroyDevice(vk.device, NULL);
+        vk.device = VK_NULL_HANDLE;
+    }
+    if (vk.surface != VK_NULL_HANDLE) vkDestroySurfaceKHR(vk.instance, vk.surface, NULL);
+    vk.surface = VK_NULL_HANDLE;
+    vk.surface_window = NULL;
+    vk.gpu = VK_NULL_HANDLE;
+}
+
+static bool VULKAN_HasSwapchainExtension(VkPhysicalDevice gpu)
+{
+    uint32_t count = 0;
+    vkEnumerateDeviceExtensionProperties(gpu, NULL, &count, NULL);
+    std::vector<VkExtensionProperties> exts(count);
+    vkEnumerateDeviceExtensionProperties(gpu, NULL, &count, exts.data());
+    for (const auto &e : exts)
+        if (!strcmp(e.extensionName, VK_KHR_SWAPCHAIN_EXTENSION_NAME)) return true;
+    return false;
+}
+
+static bool VULKAN_CreateDevice()
+{
+    if (!SDL_Vulkan_CreateSurface(sdl.window, vk.instance, &vk.surface)) {
+        LOG_MSG("Vulkan: cannot create a surface for the window: %s", SDL_GetError());
+        vk.surface = VK_NULL_HANDLE;
+        return false;
+    }
+    vk.surface_window = sdl.window;
+
+    uint32_t count = 0;
+    vkEnumeratePhysicalDevices(vk.instance, &count, NULL);
+    std::vector<VkPhysicalDevice> gpus(count);
+    vkEnumeratePhysicalDevices(vk.instance, &count, gpus.data());
+
+    /* any device that can blit and present to this window, a discrete GPU if there is one */
+    bool discrete = false;
+    for (VkPhysicalDevice gpu : gpus) {
+        if (!VULKAN_HasSwapchainExtension(gpu)) continue;
+
+        VkPhysicalDeviceProperties props;
+        vkGetPhysicalDeviceProperties(gpu, &props);
+        const bool is_discrete = props.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
+        if (vk.gpu != VK_NULL_HANDLE && (discrete || !is_discrete)) continue;
+
+        uint32_t families = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(gpu, &families, NULL);
+        std::vector<VkQueueFamilyProperties> fprops(families);
+        vkGetPhysicalDeviceQueueFamilyProperties(gpu, &families, fprops.data());
+        for (uint32_t q = 0; q < families; q++) {
+            VkBool32 present = VK_FALSE;
+            vkGetPhysicalDeviceSurfaceSupportKHR(gpu, q, vk.surface, &present);
+            if ((fprops[q].queueFlags & VK_QUEUE_GRAPHICS_BIT) && present) {
+                vk.gpu = gpu;
+                vk.queue_family = q;
+                discrete = is_discrete;
+                break;
+            }
+        }
+    }
+    if (vk.gpu == VK_NULL_HANDLE) {
+        LOG_MSG("Vulkan: no device can present to this window");
+        return false;
+    }
+
+    VkFormatProperties fmt;
+    vkGetPhysicalDeviceFormatProperties(vk.gpu, vulkan_source_format, &fmt);
+    if (!(fmt.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT)) {
+        LOG_MSG("Vulkan: device cannot blit from BGRA8 images");
+        return false;
+    }
+    vk.linear_blit = (fmt.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) != 0;
+    vkGetPhysicalDeviceMemoryProperties(vk.gpu, &vk.memory);
+
+    const float priority = 1.0f;
+    VkDeviceQueueCreateInfo qi = {};
+    qi.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    qi.queueFamilyIndex = vk.queue_family;
+    qi.queueCount = 1;
+    qi.pQueuePriorities = &priority;
+
+    const char *extension = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+    VkDeviceCreateInfo di = {};
+    di.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    di.queueCreateInfoCount = 1;
+    di.pQueueCreateInfos = &qi;
+    di.enabledExtensionCount = 1;
+    di.ppEnabledExtensionNames = &extension;
+    if (!VULKAN_Check(vkCreateDevice(vk.gpu, &di, NULL, &vk.device), "vkCreateDevice")) {
+        vk.device = VK_NULL_HANDLE;
+        return false;
+    }
+
+    bool ok = true;
+#define VKFN(name) name = (PFN_##name)vkGetDeviceProcAddr(vk.device, #name); if (name == NULL) ok = false;
+    VULKAN_DEVICE_FUNCTIONS
+#undef VKFN
+    if (!ok) {
+        LOG_MSG("Vulkan: device is missing required functions");
+        return false;
+    }
+
+    vkGetDeviceQueue(vk.device, vk.queue_family, 0, &vk.queue);
+
+    VkCommandPoolCreateInfo pi = {};
+    pi.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pi.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pi.queueFamilyIndex = vk.queue_family;
+    return VULKAN_Check(vkCreateCommandPool(vk.device, &pi, NULL, &vk.pool), "vkCreateCommandPool");
+}
+
+static void VULKAN_Barrier(VkCommandBuffer cmd, VkImage image, VkImageLayout from, VkImageLayout to,
+    VkAccessFlags src_access, VkAccessFlags dst_access, VkPipelineStageFlags src_stage, VkPipelineStageFlags dst_stage)
+{
+    VkImageMemoryBarrier b = {};
+    b.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    b.srcAccessMask = src_access;
+    b.dstAccessMask = dst_access;
+    b.oldLayout = from;
+    b.newLayout = to;
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.image = image;
+    b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    b.subresourceRange.levelCount = 1;
+    b.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(cmd, src_stage, dst_stage, 0, 0, NULL, 0, NULL, 1, &b);
+}
+
+// output API below
+
+void OUTPUT_VULKAN_Select(bool nearest)
+{
+    sdl.desktop.want_type = SCREEN_VULKAN;
+    render.aspectOffload = true;
+
+    Section_prop *section = static_cast<Section_prop *>(control->GetSection("sdl"));
+    vk.nearest = nearest;
+    vk.want_frames = (unsigned int)section->Get_int("vulkan frames");
+    if (vk.want_frames < 1) vk.want_frames = 1;
+    if (vk.want_frames > VULKAN_MAX_FRAMES) vk.want_frames = VULKAN_MAX_FRAMES;
+    vk.want_present = section->Get_string("vulkan present mode");
+
+    void GFX_SetResizeable(bool enable);
+    GFX_SetResizeable(true);
+}
+
+bool OUTPUT_VULKAN_Nearest()
+{
+    return vk.nearest;
+}
+
+Bitu OUTPUT_VULKAN_SetSize()
+{
+    uint16_t windowWidth, windowHeight;
+    uint16_t fixedWidth, fixedHeight;
+
+retry:
+    if (sdl.desktop.fullscreen) {
+        fixedWidth = sdl.desktop.full.fixed ? sdl.desktop.full.width : 0;
+        fixedHeight = sdl.desktop.full.fixed ? sdl.desktop.full.height : 0;
+    }
+    else {
+        fixedWidth = sdl.desktop.window.width;
+        fixedHeight = sdl.desktop.window.height;
+    }
+    if (fixedWidth == 0 || fixedHeight == 0) {
+        Bitu consider_height = menu.maxwindow ? currentWindowHeight : 0;
+        Bitu consider_width = menu.maxwindow ? currentWindowWidth : 0;
+        fixedWidth = (uint16_t)max(consider_width, userResizeWindowWidth);
+        fixedHeight = (uint16_t)max(consider_height, userResizeWindowHeight);
+    }
+
+    sdl.clip.x = 0; sdl.clip.y = 0;
+    if (fixedWidth && fixedHeight) {
+        windowWidth = fixedWidth;
+        windowHeight = fixedHeight;
+        sdl.clip.w = windowWidth;
+        sdl.clip.h = windowHeight;
+        if (render.aspect) aspectCorrectFitClip(sdl.clip.w, sdl.clip.h, sdl.clip.x, sdl.clip.y, fixedWidth, fixedHeight);
+    }
+    else {
+        windowWidth = (uint16_t)(sdl.draw.width * sdl.draw.scalex);
+        windowHeight = (uint16_t)(sdl.draw.height * sdl.draw.scaley);
+        if (render.aspect) aspectCorrectExtend(windowWidth, windowHeight);
+        sdl.clip.w = windowWidth; sdl.clip.h = windowHeight;
+    }
+
+    sdl.window = GFX_SetSDLWindowMode(windowWidth, windowHeight, SCREEN_VULKAN);
+    if (sdl.window == NULL) {
+        if (sdl.desktop.fullscreen) {
+            LOG_MSG("Fullscreen not supported: %s", SDL_GetError());
+            sdl.desktop.fullscreen = false;
+            GFX_CaptureMouse();
+            goto retry;
+        }
+        return 0;
+    }
+
+    if (!VULKAN_CreateInstance()) return 0;
+
+    if (vk.surface_window != sdl.window) {
+        VULKAN_DestroyDevice();
+        if (!VULKAN_CreateDevice()) {
+            VULKAN_DestroyDevice();
+            return 0;
+        }
+    }
+    else {
+        vkDeviceWaitIdle(vk.device);
+    }
+
+    VULKAN_DestroyFrames();
+    if (!VULKAN_CreateFrames((uint32_t)sdl.draw.width, (uint32_t)sdl.draw.height) || !VULKAN_CreateSwapchain()) {
+        VULKAN_DestroyDevice();
+        return 0;
+    }
+
+    LOG(LOG_MISC, LOG_DEBUG)("GFX_SetSize Vulkan window=%ux%u clip=x,y,w,h=%d,%d,%d,%d",
+        (unsigned int)windowWidth, (unsigned int)windowHeight,
+        (unsigned int)sdl.clip.x, (unsigned int)sdl.clip.y, (unsigned int)sdl.clip.w, (unsigned int)sdl.clip.h);
+
+    sdl.deferred_resize = false;
+    sdl.must_redraw_all = true;
+    UpdateWindowDimensions();
+    GFX_LogSDLState();
+
+    return GFX_CAN_32 | GFX_SCALING | GFX_CAN_DIRECT;
+}
+
+bool OUTPUT_VULKAN_StartUpdate(uint8_t* &pixels, Bitu &pitch)
+{
+    if (vk.framebuf == NULL) return false;
+
+    pixels = vk.framebuf;
+    pitch = vk.pitch;
+    sdl.updating = true;
+    return true;
+}
+
+void OUTPUT_VULKAN_EndUpdate(const uint16_t *changedLines)
+{
+    if (vk.device == VK_NULL_HANDLE || vk.frames == 0 || changedLines == NULL) return;
+    if (changedLines[0] == vk.height && !vk.full_upload) return;
+
+    if (vk.recreate_swapchain && !VULKAN_CreateSwapchain()) return;
+    if (vk.swapchain == VK_NULL_HANDLE) {
+        vk.recreate_swapchain = true;
+        return;
+    }
+
+    /* the GPU is still busy with the frame that used this slot last: drop this one */
+    VulkanFrame &f = vk.frame[vk.next];
+    if (vkGetFenceStatus(vk.device, f.done) != VK_SUCCESS) {
+        vk.full_upload = true;
+        return;
+    }
+
+    uint32_t image = 0;
+    VkResult r = vkAcquireNextImageKHR(vk.device, vk.swapchain, 0, f.acquired, VK_NULL_HANDLE, &image);
+    if (r == VK_ERROR_OUT_OF_DATE_KHR) {
+        vk.recreate_swapchain = true;
+        vk.full_upload = true;
+        return;
+    }
+    if (r != VK_SUCCESS && r != VK_SUBOPTIMAL_KHR) {
+        /* VK_NOT_READY or VK_TIMEOUT: every image is queued for presentation */
+        vk.full_upload = true;
+        return;
+    }
+    if (r == VK_SUBOPTIMAL_KHR) vk.recreate_swapchain = true;
+
+    static std::vector<VkBufferImageCopy> regions;
+    regions.clear();
+
+    VkBufferImageCopy region = {};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent.width = vk.width;
+    region.imageExtent.depth = 1;
+
+    if (vk.full_upload) {
+        memcpy(f.staging_map, vk.framebuf, vk.pitch * vk.height);
+        region.imageExtent.height = vk.height;
+        regions.push_back(region);
+    }
+    else {
+        Bitu y = 0, index = 0;
+        while (y < vk.height) {
+            if (!(index & 1)) {
+                y += changedLines[index];
+            }
+            else {
+                const Bitu height = changedLines[index];
+                memcpy(f.staging_map + y * vk.pitch, vk.framebuf + y * vk.pitch, height * vk.pitch);
+                region.bufferOffset = (VkDeviceSize)(y * vk.pitch);
+                region.imageOffset.y = (int32_t)y;
+                region.imageExtent.height = (uint32_t)height;
+                regions.push_back(region);
+                y += height;
+            }
+            index++;
+        }
+    }
+
+    /* clip rectangle is in window coordinates, the swapchain in pixels */
+    int win_w = 1, win_h = 1;
+    SDL_GetWindowSize(sdl.window, &win_w, &win_h);
+    const double sx = (double)vk.extent.width / std::max(win_w, 1);
+    const double sy = (double)vk.extent.height / std::max(win_h, 1);
+
+    VkImageBlit blit = {};
+    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.srcSubresource.layerCount = 1;
+    blit.srcOffsets[1].x = (int32_t)vk.width;
+    blit.srcOffsets[1].y = (int32_t)vk.height;
+    blit.srcOffsets[1].z = 1;
+    blit.dstSubresource = blit.srcSubresource;
+    blit.dstOffsets[0].x = (int32_t)(sdl.clip.x * sx);
+    blit.dstOffsets[0].y = (int32_t)(sdl.clip.y * sy);
+    blit.dstOffsets[1].x = std::min((int32_t)((sdl.clip.x + sdl.clip.w) * sx), (int32_t)vk.extent.width);
+    blit.dstOffsets[1].y = std::min((int32_t)((sdl.clip.y + sdl.clip.h) * sy), (int32_t)vk.extent.height);
+    blit.dstOffsets[1].z = 1;
+
+    vkResetCommandBuffer(f.cmd, 0);
+    VkCommandBufferBeginInfo bi = {};
+    bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(f.cmd, &bi);
+
+    VULKAN_Barrier(f.cmd, vk.source,
+        vk.source_valid ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    vkCmdCopyBufferToImage(f.cmd, f.staging, vk.source, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+    VULKAN_Barrier(f.cmd, vk.source, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VULKAN_Barrier(f.cmd, vk.images[image], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkClearColorValue black = {};
+    black.float32[3] = 1.0f;
+    VkImageSubresourceRange all = {};
+    all.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    all.levelCount = 1;
+    all.layerCount = 1;
+    vkCmdClearColorImage(f.cmd, vk.images[image], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &black, 1, &all);
+    VULKAN_Barrier(f.cmd, vk.images[image], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    if (blit.dstOffsets[1].x > blit.dstOffsets[0].x && blit.dstOffsets[1].y > blit.dstOffsets[0].y)
+        vkCmdBlitImage(f.cmd, vk.source, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vk.images[image], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &blit, (vk.nearest || !vk.linear_blit) ? VK_FILTER_NEAREST : VK_FILTER_LINEAR);
+    VULKAN_Barrier(f.cmd, vk.images[image], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+        VK_ACCESS_TRANSFER_WRITE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    vkEndCommandBuffer(f.cmd);
+
+    const VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    VkSubmitInfo si = {};
+    si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    si.waitSemaphoreCount = 1;
+    si.pWaitSemaphores = &f.acquired;
+    si.pWaitDstStageMask = &wait_stage;
+    si.commandBufferCount = 1;
+    si.pCommandBuffers = &f.cmd;
+    si.signalSemaphoreCount = 1;
+    si.pSignalSemaphores = &vk.present_ready[image];
+
+    vkResetFences(vk.device, 1, &f.done);
+    if (!VULKAN_Check(vkQueueSubmit(vk.queue, 1, &si, f.done), "vkQueueSubmit")) {
+        /* leave the fence signalled so the slot is not stuck */
+        vkQueueSubmit(vk.queue, 0, NULL, f.done);
+        vk.full_upload = true;
+        return;
+    }
+    vk.source_valid = true;
+    vk.full_upload = false;
+
+    VkPresentInfoKHR pi = {};
+    pi.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    pi.waitSemaphoreCount = 1;
+    pi.pWaitSemaphores = &vk.present_ready[image];
+    pi.swapchainCount = 1;
+    pi.pSwapchains = &vk.swapchain;
+    pi.pImageIndices = &image;
+    r = vkQueuePresentKHR(vk.queue, &pi);
+    if (r == VK_ERROR_OUT_OF_DATE_KHR || r == VK_SUBOPTIMAL_KHR) vk.recreate_swapchain = true;
+
+    vk.next = (vk.next + 1) % vk.frames;
+    if (!menu.hidecycles && !sdl.desktop.fullscreen) frames++;
+}
+
+void OUTPUT_VULKAN_Shutdown()
+{
+    if (vk.instance == VK_NULL_HANDLE) return;
+
+    VULKAN_DestroyDevice();
+    vkDestroyInstance(vk.instance, NULL);
+    vk.instance = VK_NULL_HANDLE;
+}
+
+#endif /*C_VULKAN*/
@@ -0,0 +1,20 @@
+#include "dosbox.h"
+
+#ifndef DOSBOX_OUTPUT_VULKAN_H
+#define DOSBOX_OUTPUT_VULKAN_H
+
+#if C_VULKAN
+
+// output API
+void OUTPUT_VULKAN_Select(bool nearest);
+Bitu OUTPUT_VULKAN_SetSize();
+bool OUTPUT_VULKAN_StartUpdate(uint8_t* &pixels, Bitu &pitch);
+void OUTPUT_VULKAN_EndUpdate(const uint16_t *changedLines);
+void OUTPUT_VULKAN_Shutdown();
+
+// specific additions
+bool OUTPUT_VULKAN_Nearest();
+
+#endif /*C_VULKAN*/
+
+#endif /*DOSBOX_OUTPUT_VULKAN_H*/
@@ -19,6 +19,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 
 #include "logging.h"
 #include "shell.h"
@@ -48,54 +49,112 @@ BatchFile::~BatchFile() {
 	shell->echo=echo;
 }
 
+/* Reads the batch file into memory unless the copy we have still matches its size and date,
+ * then indexes the lines and labels. The file is kept closed between lines like before. */
+bool BatchFile::LoadContents(void) {
+	if (!DOS_OpenFile(filename.c_str(),(DOS_NOT_INHERIT|OPEN_READ),&file_handle)) return false;
+
+	uint16_t time=0,date=0;
+	uint32_t size=0;
+	if (!DOS_GetFileDate(file_handle,&time,&date)) time=date=0;
+	DOS_SeekFile(file_handle,&size,DOS_SEEK_END);
+	if (loaded && size==file_size && time==file_time && date==file_date) {
+		DOS_CloseFile(file_handle);
+		return true;
+	}
+
+	contents.resize(size);
+	uint32_t pos=0,got=0;
+	DOS_SeekFile(file_handle,&pos,DOS_SEEK_SET);
+	while (got<size) {
+		uint16_t n=(uint16_t)std::min<uint32_t>(size-got,0x8000);
+		if (!DOS_ReadFile(file_handle,(uint8_t*)&contents[got],&n) || !n) break;
+		got+=n;
+	}
+	DOS_CloseFile(file_handle);
+	contents.resize(got);
+	// Stop at EOF character
+	contents.erase(std::find(contents.begin(),contents.end(),(char)0x1a),contents.end());
+
+	line_starts.clear();
+	labels.clear();
+	for (uint32_t start=0;start<contents.size();) {
+		line_starts.push_back(start);
+		uint32_t end=start;
+		while (end<contents.size() && contents[end++]!='\n');
+
+		/* Same parsing as the old label scan of Goto: control characters are dropped,
+		 * the label runs from the ':' until space, '=' or the end of the line. */
+		char cmd_buffer[CMD_MAXLINE];
+		char * cmd_write=cmd_buffer;
+		for (uint32_t i=start;i<end;i++) {
+			if ((uint8_t)contents[i]>31 && ((cmd_write - cmd_buffer) + 1) < (CMD_MAXLINE - 1))
+				*cmd_write++ = contents[i];
+		}
+		*cmd_write = 0;
+		char *nospace = trim(cmd_buffer);
+		if (nospace[0] == ':') {
+			nospace++; //Skip :
+			//Strip spaces and = from it.
+			while(*nospace && (isspace(*reinterpret_cast<unsigned char*>(nospace)) || (*nospace == '=')))
+				nospace++;
+
+			//label is until space/=/eol
+			char* beginlabel = nospace;
+			while(*nospace && !isspace(*reinterpret_cast<unsigned char*>(nospace)) && (*nospace != '='))
+				nospace++;
+
+			*nospace = 0;
+			//the first definition of a label wins
+			labels.insert(std::make_pair(std::string(upcase(beginlabel)),end));
+		}
+		start=end;
+	}
+
+	file_size=size;
+	file_time=time;
+	file_date=date;
+	loaded=true;
+	return true;
+}
+
 bool BatchFile::ReadLine(char * line) {
-	//Open the batchfile and seek to stored position
-	if (!DOS_OpenFile(filename.c_str(),(DOS_NOT_INHERIT|OPEN_READ),&file_handle)) {
+	//Make sure the copy of the batchfile is current
+	if (!LoadContents()) {
 		LOG(LOG_MISC,LOG_ERROR)("ReadLine Can't open BatchFile %s",filename.c_str());
 		delete this;
 		return false;
 	}
-	DOS_SeekFile(file_handle,&(this->location),DOS_SEEK_SET);
 
-	uint8_t c=0;uint16_t n=1;
 	char temp[CMD_MAXLINE];
 	char temp_cycles_hack[CMD_MAXLINE];
 emptyline:
 	char * cmd_write=temp;
-	do {
-		n=1;
-		DOS_ReadFile(file_handle,&c,&n);
-		if (n>0) {
-			if (c==0x1a) {
-				// Stop at EOF character
-				n=0;
-				this->location=0;
-				DOS_SeekFile(file_handle,&(this->location),DOS_SEEK_END);
-				break;
-			}
-			/* Why are we filtering this ?
-			 * Exclusion list: tab for batch files 
-			 * escape for ansi
-			 * backspace for alien odyssey */
-			if (c>31 || c==0x1b || c=='\t' || c==7 || c==8) {
-				//Only add it if room for it (and trailing zero) in the buffer, but do the check here instead at the end
-				//So we continue reading till EOL/EOF
-				if (((cmd_write - temp) + 1) < (CMD_MAXLINE - 1))
-					*cmd_write++ = (char)c;
-			} else if (c==0x1a) {
-				n = 0;
-				break;
-			} else if (c != '\n' && c != '\r')
-				LOG(LOG_MISC,LOG_DEBUG)("Encountered non-standard control character in batch file: Dec %03u and Hex %#04x.\n", c, c);
-		}
-	} while (c!='\n' && n);
-	*cmd_write=0;
-	if (!n && cmd_write==temp) {
-		//Close file and delete bat file
-		DOS_CloseFile(file_handle);
+	if (this->location>=contents.size()) {
+		//delete bat file
 		delete this;
-		return false;	
+		return false;
 	}
+	/* The line ends at the start of the next one, or at the EOF character/end of the file after which
+	 * the position is the end of the file */
+	const std::vector<uint32_t>::const_iterator next=std::upper_bound(line_starts.begin(),line_starts.end(),this->location);
+	const uint32_t end=(next!=line_starts.end()) ? *next : (uint32_t)contents.size();
+	for (uint32_t i=this->location;i<end;i++) {
+		const uint8_t c=(uint8_t)contents[i];
+		/* Why are we filtering this ?
+		 * Exclusion list: tab for batch files 
+		 * escape for ansi
+		 * backspace for alien odyssey */
+		if (c>31 || c==0x1b || c=='\t' || c==7 || c==8) {
+			//Only add it if room for it (and trailing zero) in the buffer, but do the check here instead at the end
+			//So we continue reading till EOL/EOF
+			if (((cmd_write - temp) + 1) < (CMD_MAXLINE - 1))
+				*cmd_write++ = (char)c;
+		} else if (c != '\n' && c != '\r')
+			LOG(LOG_MISC,LOG_DEBUG)("Encountered non-standard control character in batch file: Dec %03u and Hex %#04x.\n", c, c);
+	}
+	this->location=(next!=line_starts.end()) ? end : file_size;
+	*cmd_write=0;
 	if (!strlen(temp)) goto emptyline;
 	if (temp[0]==':') goto emptyline;
 
@@ -181,74 +240,27 @@ emptyline:
 		}
 	}
 	*cmd_write = 0;
-	//Store current location and close bat file
-	this->location = 0;
-	DOS_SeekFile(file_handle,&(this->location),DOS_SEEK_CUR);
-	DOS_CloseFile(file_handle);
 	return true;	
 }
 
 bool BatchFile::Goto(const char * where) {
-	//Open bat file and search for the where string
-	if (!DOS_OpenFile(filename.c_str(),128,&file_handle)) {
+	//Make sure the copy of the batchfile is current and look up the label
+	if (!LoadContents()) {
 		LOG(LOG_MISC,LOG_ERROR)("SHELL:Goto Can't open BatchFile %s",filename.c_str());
 		delete this;
 		return false;
 	}
 
-	char cmd_buffer[CMD_MAXLINE];
-	char * cmd_write;
-
-	/* Scan till we have a match or return false */
-	uint8_t c;uint16_t n;
-again:
-	cmd_write=cmd_buffer;
-	do {
-		n=1;
-		DOS_ReadFile(file_handle,&c,&n);
-		if (n>0) {
-			if (c>31) {
-				if (((cmd_write - cmd_buffer) + 1) < (CMD_MAXLINE - 1))
-					*cmd_write++ = (char)c;
-			} else if (c==0x1a) {
-				n = 0;
-				break;
-			} else if (c!=0x1b && c!='\t' && c!=7 && c!=8) {
-					if (c != '\n' && c != '\r')
-					LOG(LOG_MISC,LOG_DEBUG)("Encountered non-standard control character in batch file: Dec %03u and Hex %#04x.\n", c, c);
-			}
-		}
-	} while (c!='\n' && n);
-	*cmd_write++ = 0;
-	char *nospace = trim(cmd_buffer);
-	if (nospace[0] == ':') {
-		nospace++; //Skip :
-		//Strip spaces and = from it.
-		while(*nospace && (isspace(*reinterpret_cast<unsigned char*>(nospace)) || (*nospace == '=')))
-			nospace++;
-
-		//label is until space/=/eol
-		const char* beginlabel = nospace;
-		while(*nospace && !isspace(*reinterpret_cast<unsigned char*>(nospace)) && (*nospace != '=')) 
-			nospace++;
-
-		*nospace = 0;
-		if (strcasecmp(beginlabel,where)==0) {
-		//Found it! Store location and continue
-			this->location = 0;
-			DOS_SeekFile(file_handle,&(this->location),DOS_SEEK_CUR);
-			DOS_CloseFile(file_handle);
-			return true;
-		}
-	   
-	}
-	if (!n) {
-		DOS_CloseFile(file_handle);
+	std::string label = where;
+	upcase(&label[0]);
+	const std::map<std::string,uint32_t>::const_iterator found = labels.find(label);
+	if (found == labels.end()) {
 		delete this;
-		return false;	
+		return false;
 	}
-	goto again;
-	return false;
+	//Found it! Store location and continue
+	this->location = found->second;
+	return true;
 }
 
 void BatchFile::Shift(void) {
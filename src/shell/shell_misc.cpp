@@ -33,6 +33,7 @@
 #include "support.h"
 #include "inout.h"
 #include "render.h"
+#include "startupprof.h"
 #include "../ints/int10.h"
 #include "../dos/drives.h"
 
@@ -68,6 +69,7 @@ void DOS_Shell::ShowPrompt(void) {
 	std::string line;
 	const char * promptstr = "\0";
     inshell = true;
+    STARTUP_PromptReached();
 
 	if(GetEnvStr("PROMPT",line)) {
 		std::string::size_type idx = line.find('=');
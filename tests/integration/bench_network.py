@@ -0,0 +1,390 @@
+#!/usr/bin/env -S uv run --script
+# /// script
+# requires-python = ">=3.11"
+# dependencies = [
+#     "psutil>=5.9",
+# ]
+# ///
+"""
+Network throughput and latency benchmark for the emulated network cards.
+
+Every test starts a fresh DOSBox-X with the NIC, backend and packet driver
+under test, runs one guest command from AUTOEXEC and measures on the host:
+
+    tcp-tx    guest -> host TCP bulk transfer      (host endpoint: TCP sink)
+    tcp-rx    host -> guest TCP bulk transfer      (host endpoint: TCP source)
+    udp-tx    guest -> host UDP bulk transfer      (host endpoint: UDP sink)
+    ping      ICMP ping-pong between guest and the backend gateway
+
+Reported are throughput (MB/s, timed at the host endpoint from the first to
+the last byte), latency percentiles (ping, parsed from the guest output) and
+the host CPU time DOSBox-X used per emulated MB.
+
+The guest programs are not part of DOSBox-X. By default the commands are
+those of mTCP (NC.EXE and PING.EXE); put them in a directory and pass it
+with --tools. The script writes MTCP.CFG with a static address for the
+packet driver interrupt 0x60. Other TCP/IP stacks work by overriding the
+command templates, e.g.
+
+    --cmd tcp-tx="NC -target {host} {port} -bin < {file}"
+
+Templates may use {host}, {port}, {file}, {size} and {count}. udp-tx has no
+default, as mTCP has no UDP sender; it only runs when a command is given.
+
+Run with:
+    uv run tests/integration/bench_network.py --tools ~/mtcp
+    uv run tests/integration/bench_network.py --tools ~/mtcp --nic rtl8139 --driver "RTSPKT 0x60"
+    uv run tests/integration/bench_network.py --tools ~/mtcp --json result.json
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import socket
+import statistics
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+from pathlib import Path
+
+import psutil
+
+DEFAULT_EXECUTABLE = "./src/dosbox-x"
+HOST_PORT = 5401
+TEST_TIMEOUT = 300.0
+
+DEFAULT_COMMANDS = {
+    "tcp-tx": "NC -target {host} {port} -bin < {file}",
+    "tcp-rx": "NC -target {host} {port} -bin > NUL",
+    "ping": "PING -count {count} {host} > T:\\PING.TXT",
+}
+
+DEFAULT_DRIVERS = {
+    "ne2000": "Z:\\NE2000 0x60 3 0x300",
+}
+
+
+# =============================================================================
+# Host endpoints
+# =============================================================================
+
+class Endpoint:
+    """A host endpoint running on a thread, recording bytes and timing."""
+
+    def __init__(self, port: int):
+        self.port = port
+        self.bytes = 0
+        self.first = None
+        self.last = None
+        self.error = None
+        self._thread = threading.Thread(target=self._guarded, daemon=True)
+
+    def start(self):
+        self._thread.start()
+
+    def join(self, timeout: float):
+        self._thread.join(timeout)
+
+    def _guarded(self):
+        try:
+            self.run()
+        except Exception as e:  # reported with the result
+            self.error = str(e)
+
+    def _count(self, n: int):
+        now = time.perf_counter()
+        if self.first is None:
+            self.first = now
+        self.last = now
+        self.bytes += n
+
+    @property
+    def seconds(self) -> float:
+        if self.first is None or self.last is None:
+            return 0.0
+        return self.last - self.first
+
+
+class TCPSink(Endpoint):
+    """Accepts one connection and reads until the guest closes it."""
+
+    def run(self):
+        with socket.create_server(("127.0.0.1", self.port)) as server:
+            server.settimeout(TEST_TIMEOUT)
+            conn, _ = server.accept()
+            with conn:
+                conn.settimeout(TEST_TIMEOUT)
+                while data := conn.recv(65536):
+                    self._count(len(data))
+
+
+class TCPSource(Endpoint):
+    """Accepts one connection, sends size bytes and closes it."""
+
+    def __init__(self, port: int, size: int):
+        super().__init__(port)
+        self.size = size
+
+    def run(self):
+        block = os.urandom(65536)
+        with socket.create_server(("127.0.0.1", self.port)) as server:
+            server.settimeout(TEST_TIMEOUT)
+            conn, _ = server.accept()
+            with conn:
+                conn.settimeout(TEST_TIMEOUT)
+                self._count(0)
+                left = self.size
+                while left > 0:
+                    sent = conn.send(block[:min(left, len(block))])
+                    left -= sent
+                    self._count(sent)
+                conn.shutdown(socket.SHUT_WR)
+                # the transfer is done once the guest has read everything and closes
+                while conn.recv(65536):
+                    pass
+                self._count(0)
+
+
+class UDPSink(Endpoint):
+    """Counts datagrams until none arrived for two seconds after the first."""
+
+    def __init__(self, port: int):
+        super().__init__(port)
+        self.datagrams = 0
+
+    def run(self):
+        with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+            sock.bind(("127.0.0.1", self.port))
+            sock.settimeout(TEST_TIMEOUT)
+            while True:
+                try:
+                    data = sock.recv(65536)
+                except socket.timeout:
+                    break
+                self._count(len(data))
+                self.datagrams += 1
+                sock.settimeout(2.0)
+
+
+# =============================================================================
+# Guest setup
+# =============================================================================
+
+def write_config(work: Path, args, command: str) -> Path:
+    """Write the DOSBox-X config that runs one guest command and exits."""
+    driver = args.driver or DEFAULT_DRIVERS.get(args.nic)
+    if not driver:
+        sys.exit(f"--driver is required for nic type {args.nic}")
+
+    conf = work / "bench.conf"
+    conf.write_text(
+        "[sdl]\n"
+        "autolock=false\n"
+        "[dosbox]\n"
+        "quit warning=false\n"
+        "[cpu]\n"
+        f"core={args.core}\n"
+        f"cycles={args.cycles}\n"
+        "[ne2000]\n"
+        "ne2000=true\n"
+        f"nic type={args.nic}\n"
+        f"backend={args.backend}\n"
+        f"backend thread={'true' if args.backend_thread else 'false'}\n"
+        "[ethernet, pcap]\n"
+        f"realnic={args.realnic}\n"
+        "[autoexec]\n"
+        f"mount t: \"{work / 'T'}\"\n"
+        "t:\n"
+        "set MTCPCFG=T:\\MTCP.CFG\n"
+        f"{driver}\n"
+        f"{command}\n"
+        "echo done > T:\\DONE.TXT\n"
+        "exit\n"
+    )
+    return conf
+
+
+def prepare_guest(work: Path, args) -> Path:
+    """Copy the guest tools and write the files the guest commands use."""
+    guest = work / "T"
+    guest.mkdir()
+    if args.tools:
+        for f in Path(args.tools).iterdir():
+            if f.is_file():
+                shutil.copy(f, guest / f.name.upper())
+    (guest / "MTCP.CFG").write_text(
+        "PACKETINT 0x60\r\n"
+        f"IPADDR {args.guest_ip}\r\n"
+        "NETMASK 255.255.255.0\r\n"
+        f"GATEWAY {args.gateway}\r\n"
+        f"NAMESERVER {args.gateway}\r\n"
+    )
+    with open(guest / "BULK.BIN", "wb") as f:
+        for _ in range(args.size):
+            f.write(os.urandom(1 << 20))
+    return guest
+
+
+# =============================================================================
+# Test runs
+# =============================================================================
+
+def percentile(values: list, p: float) -> float:
+    values = sorted(values)
+    k = (len(values) - 1) * p / 100.0
+    lo = int(k)
+    hi = min(lo + 1, len(values) - 1)
+    return values[lo] + (values[hi] - values[lo]) * (k - lo)
+
+
+def run_test(name: str, args, work: Path, guest: Path) -> dict:
+    template = args.commands.get(name)
+    if not template:
+        return {"test": name, "skipped": "no guest command"}
+
+    size = args.size << 20
+    host = args.host_ip
+    command = template.format(host=host, port=HOST_PORT, file="T:\\BULK.BIN",
+                              size=size, count=args.pings)
+
+    endpoint = None
+    if name == "tcp-tx":
+        endpoint = TCPSink(HOST_PORT)
+    elif name == "tcp-rx":
+        endpoint = TCPSource(HOST_PORT, size)
+    elif name == "udp-tx":
+        endpoint = UDPSink(HOST_PORT)
+    if endpoint:
+        endpoint.start()
+
+    for f in ("DONE.TXT", "PING.TXT"):
+        (guest / f).unlink(missing_ok=True)
+
+    conf = write_config(work, args, command)
+    proc = subprocess.Popen([args.dosbox, "-conf", str(conf)],
+                            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    ps = psutil.Process(proc.pid)
+    cpu_start = None
+    cpu_end = None
+    deadline = time.time() + TEST_TIMEOUT
+    result = {"test": name, "command": command}
+    try:
+        while time.time() < deadline and proc.poll() is None:
+            times = ps.cpu_times()
+            cpu = times.user + times.system
+            if endpoint is None or endpoint.first is not None:
+                # CPU time is counted while data moves, boot time is left out
+                if cpu_start is None:
+                    cpu_start = cpu
+                if endpoint is None or endpoint.last is None or time.perf_counter() - endpoint.last < 0.5:
+                    cpu_end = cpu
+            if (guest / "DONE.TXT").exists():
+                break
+            time.sleep(0.05)
+        else:
+            if proc.poll() is None:
+                result["error"] = "timeout"
+    finally:
+        proc.kill()
+        proc.wait()
+
+    if endpoint:
+        endpoint.join(5.0)
+        if endpoint.error:
+            result["error"] = endpoint.error
+        mb = endpoint.bytes / (1 << 20)
+        result["bytes"] = endpoint.bytes
+        result["seconds"] = round(endpoint.seconds, 3)
+        if endpoint.seconds > 0:
+            result["mb_per_s"] = round(mb / endpoint.seconds, 3)
+        if isinstance(endpoint, UDPSink):
+            result["datagrams"] = endpoint.datagrams
+        if cpu_start is not None and cpu_end is not None and mb > 0:
+            result["cpu_s_per_mb"] = round((cpu_end - cpu_start) / mb, 4)
+    if name == "ping":
+        text = (guest / "PING.TXT").read_text(errors="replace") if (guest / "PING.TXT").exists() else ""
+        rtts = [float(m) for m in re.findall(r"in (\d+(?:\.\d+)?) ms", text)]
+        result["replies"] = len(rtts)
+        result["lost"] = args.pings - len(rtts)
+        if rtts:
+            for p in (50, 90, 99):
+                result[f"p{p}_ms"] = round(percentile(rtts, p), 3)
+            result["max_ms"] = max(rtts)
+            result["mean_ms"] = round(statistics.fmean(rtts), 3)
+        if cpu_start is not None and cpu_end is not None:
+            result["cpu_s"] = round(cpu_end - cpu_start, 3)
+    return result
+
+
+def print_result(r: dict):
+    if "skipped" in r:
+        print(f"  {r['test']:<8} skipped ({r['skipped']})")
+        return
+    parts = []
+    for key, fmt in (("mb_per_s", "{:.2f} MB/s"), ("cpu_s_per_mb", "{:.3f} CPU s/MB"),
+                     ("p50_ms", "p50 {:.2f} ms"), ("p90_ms", "p90 {:.2f} ms"),
+                     ("p99_ms", "p99 {:.2f} ms"), ("lost", "{} lost"), ("error", "ERROR: {}")):
+        if key in r:
+            parts.append(fmt.format(r[key]))
+    print(f"  {r['test']:<8} " + ", ".join(parts))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--dosbox", default=DEFAULT_EXECUTABLE, help="DOSBox-X executable")
+    parser.add_argument("--tools", help="directory with the guest programs (e.g. mTCP)")
+    parser.add_argument("--nic", default="ne2000", choices=["ne2000", "rtl8139"], help="[ne2000] nic type")
+    parser.add_argument("--driver", help="packet driver command line (default: built-in NE2000.COM)")
+    parser.add_argument("--backend", default="slirp", choices=["slirp", "pcap"])
+    parser.add_argument("--no-backend-thread", dest="backend_thread", action="store_false")
+    parser.add_argument("--realnic", default="list", help="[ethernet, pcap] realnic for --backend pcap")
+    parser.add_argument("--guest-ip", default="10.0.2.15")
+    parser.add_argument("--gateway", default="10.0.2.2")
+    parser.add_argument("--host-ip", default="10.0.2.2", help="host address as seen by the guest")
+    parser.add_argument("--core", default="dynamic")
+    parser.add_argument("--cycles", default="max")
+    parser.add_argument("--size", type=int, default=16, help="bulk transfer size in MB")
+    parser.add_argument("--pings", type=int, default=100)
+    parser.add_argument("--tests", default="tcp-tx,tcp-rx,udp-tx,ping")
+    parser.add_argument("--repeat", type=int, default=1)
+    parser.add_argument("--cmd", action="append", default=[], metavar="TEST=TEMPLATE",
+                        help="guest command template for a test")
+    parser.add_argument("--json", help="write the results to this file")
+    args = parser.parse_args()
+
+    args.commands = dict(DEFAULT_COMMANDS)
+    for c in args.cmd:
+        test, _, template = c.partition("=")
+        args.commands[test] = template
+
+    print("DOSBox-X Network Benchmark")
+    print("=" * 50)
+    print(f"nic={args.nic} backend={args.backend} thread={args.backend_thread} "
+          f"core={args.core} cycles={args.cycles} size={args.size}MB")
+
+    results = []
+    with tempfile.TemporaryDirectory(prefix="dbxnet") as tmp:
+        work = Path(tmp)
+        guest = prepare_guest(work, args)
+        for run in range(args.repeat):
+            if args.repeat > 1:
+                print(f"run {run + 1}/{args.repeat}")
+            for name in args.tests.split(","):
+                r = run_test(name.strip(), args, work, guest)
+                r["run"] = run
+                print_result(r)
+                results.append(r)
+
+    if args.json:
+        settings = {k: v for k, v in vars(args).items() if k not in ("json", "cmd")}
+        Path(args.json).write_text(json.dumps({"settings": settings, "results": results}, indent=2))
+
+    return 1 if any("error" in r for r in results) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -290,6 +290,22 @@ class GDBClient:
         response = self._send_packet(f"z0,{addr:x},1")
         return response == "OK"
 
+    def set_hw_breakpoint(self, addr: int) -> bool:
+        """Set a hardware breakpoint (linear address, also stops the dynamic core)."""
+        return self._send_packet(f"Z1,{addr:x},1") == "OK"
+
+    def remove_hw_breakpoint(self, addr: int) -> bool:
+        """Remove a hardware breakpoint."""
+        return self._send_packet(f"z1,{addr:x},1") == "OK"
+
+    def set_watchpoint(self, addr: int, length: int) -> bool:
+        """Set a write watchpoint on a linear address range."""
+        return self._send_packet(f"Z2,{addr:x},{length:x}") == "OK"
+
+    def remove_watchpoint(self, addr: int, length: int) -> bool:
+        """Remove a write watchpoint."""
+        return self._send_packet(f"z2,{addr:x},{length:x}") == "OK"
+
     def step(self) -> str:
         """Single step execution."""
         return self._send_packet("s")
@@ -612,6 +628,74 @@ class QMPClient:
         """Query emulator status."""
         return self._send_command("query-status")
 
+    def dynrec_profile(self, enable: bool = True, reset: bool = False) -> dict:
+        """Start/stop the dynrec hot-block profiler."""
+        return self._send_command("dynrec-profile", {"enable": enable, "reset": reset})
+
+    def query_dynrec_profile(self, top: int = 20, sort: str = "time") -> dict:
+        """Query the dynrec hot-block profile."""
+        return self._send_command("query-dynrec-profile", {"top": top, "sort": sort})
+
+    def guest_profile_start(self, rate: int = 1000, reset: bool = True) -> dict:
+        """Start sampling guest CS:EIP."""
+        return self._send_command("guest-profile-start", {"rate": rate, "reset": reset})
+
+    def guest_profile_stop(self, format: str = "histogram", top: int = 50) -> dict:
+        """Stop sampling and return the guest profile."""
+        return self._send_command("guest-profile-stop", {"format": format, "top": top})
+
+    def query_tlb_stats(self) -> dict:
+        """Query the paging TLB flush statistics."""
+        return self._send_command("query-tlb-stats")
+
+    def query_io_stats(self, top: int = 20) -> dict:
+        """Query the I/O slow path statistics."""
+        return self._send_command("query-io-stats", {"top": top})
+
+    def query_audio_stats(self) -> dict:
+        """Query the audio buffering, latency and underrun statistics."""
+        return self._send_command("query-audio-stats")
+
+    def query_perf(self) -> dict:
+        """Query the performance counters, rates are since the previous query."""
+        return self._send_command("query-perf")
+
+    def trace_start(self, file: str = "") -> dict:
+        """Start the Chrome trace-event recorder, to the capture directory without a file."""
+        return self._send_command("trace-start", {"file": file} if file else None)
+
+    def trace_stop(self) -> dict:
+        """Stop the trace recorder and finish the file."""
+        return self._send_command("trace-stop")
+
+    def query_frame_pacing(self, reset: bool = False) -> dict:
+        """Query the frame interval and present latency histograms, optionally clearing them."""
+        return self._send_command("query-frame-pacing", {"reset": reset} if reset else None)
+
+    def query_host_memory(self) -> dict:
+        """Query the host memory used per subsystem and the process RSS."""
+        return self._send_command("query-host-memory")
+
+    def memstate_save(self, slot: str) -> dict:
+        """Save the state to a named slot in emulator memory."""
+        return self._send_command("memstate-save", {"slot": slot})
+
+    def memstate_load(self, slot: str) -> dict:
+        """Load the state from a named slot in emulator memory."""
+        return self._send_command("memstate-load", {"slot": slot})
+
+    def memstate_persist(self, slot: str, file: str) -> dict:
+        """Write a named slot in emulator memory to a state file."""
+        return self._send_command("memstate-persist", {"slot": slot, "file": file})
+
+    def memstate_delete(self, slot: str) -> dict:
+        """Free a named slot in emulator memory."""
+        return self._send_command("memstate-delete", {"slot": slot})
+
+    def query_memstates(self) -> dict:
+        """List the named slots in emulator memory and their sizes."""
+        return self._send_command("query-memstates")
+
     def stop(self) -> dict:
         """Stop/pause the emulator."""
         return self._send_command("stop")
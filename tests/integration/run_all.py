@@ -18,7 +18,12 @@ Prerequisites:
         qmpserver port=4444
 
 Run with:
-    uv run tests/integration/run_all.py [pytest args...]
+    uv run tests/integration/run_all.py [--launch [DOSBOX]] [pytest args...]
+
+With --launch the script starts DOSBox-X itself with test.conf and -headless: no window,
+no sound and no pacing to real time, so the suite runs at the host's full speed. The
+emulator's performance counters (-perf-report) are printed when it exits, which makes
+every run a throughput benchmark too.
 
 Examples:
     uv run tests/integration/run_all.py              # Run all tests
@@ -26,10 +31,17 @@ Examples:
     uv run tests/integration/run_all.py -k gdb       # Only GDB tests
     uv run tests/integration/run_all.py -x           # Stop on first failure
     uv run tests/integration/run_all.py --tb=long    # Full tracebacks
+    uv run tests/integration/run_all.py --launch     # Start ./src/dosbox-x headless
+    uv run tests/integration/run_all.py --launch --time-limit 600 --perf-report perf.json
 """
 
+import argparse
+import json
 import socket
+import subprocess
 import sys
+import tempfile
+import time
 from pathlib import Path
 
 import pytest
@@ -40,6 +52,9 @@ GDB_PORT = 2159
 QMP_HOST = "localhost"
 QMP_PORT = 4444
 
+DEFAULT_EXECUTABLE = "./src/dosbox-x"
+LAUNCH_TIMEOUT = 30.0
+
 
 def check_server(name: str, host: str, port: int) -> bool:
     """Check if a server is reachable."""
@@ -52,7 +67,70 @@ def check_server(name: str, host: str, port: int) -> bool:
         return False
 
 
+def launch(args) -> subprocess.Popen:
+    """Start DOSBox-X headless with test.conf and wait for its servers."""
+    repo = Path(__file__).resolve().parents[2]
+    cmd = [args.launch, "-headless", "-conf", str(repo / "tests" / "integration" / "test.conf"),
+           "-perf-report", args.perf_report]
+    if args.time_limit:
+        cmd += ["-time-limit", str(args.time_limit)]
+    print("Starting " + " ".join(cmd))
+    proc = subprocess.Popen(cmd, cwd=repo, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+    deadline = time.time() + LAUNCH_TIMEOUT
+    while time.time() < deadline and proc.poll() is None:
+        try:
+            with socket.create_connection((QMP_HOST, QMP_PORT), timeout=0.5):
+                break
+        except OSError:
+            time.sleep(0.2)
+    return proc
+
+
+def stop(proc: subprocess.Popen, perf_report: str) -> None:
+    """Let DOSBox-X exit normally, so that it writes the perf report, then show it."""
+    if proc.poll() is None:
+        proc.terminate()
+        try:
+            proc.wait(10)
+        except subprocess.TimeoutExpired:
+            proc.kill()
+            proc.wait()
+
+    try:
+        report = json.loads(Path(perf_report).read_text())
+    except (OSError, ValueError):
+        print("No perf report from DOSBox-X")
+        return
+    print()
+    print(f"DOSBox-X: {report['emulated-seconds']:.1f} emulated s in {report['host-seconds']:.1f} host s "
+          f"(speed {report['emulated-speed']:.2f}x, {report['mips']:.1f} MIPS, "
+          f"{report['frames-rendered']} frames)")
+    if report.get("startup-ms") is not None:
+        print(f"DOSBox-X: DOS prompt {report['startup-ms']:.0f} ms after start")
+
+
 def main():
+    parser = argparse.ArgumentParser(add_help=False)
+    parser.add_argument("--launch", nargs="?", const=DEFAULT_EXECUTABLE, metavar="DOSBOX",
+                        help="start DOSBox-X headless (default " + DEFAULT_EXECUTABLE + ")")
+    parser.add_argument("--time-limit", type=float, help="stop DOSBox-X after this many emulated seconds")
+    parser.add_argument("--perf-report", help="where DOSBox-X writes its performance counters (JSON)")
+    args, pytest_extra = parser.parse_known_args()
+
+    proc = None
+    if args.launch:
+        if not args.perf_report:
+            args.perf_report = str(Path(tempfile.gettempdir()) / "dosbox-x-perf.json")
+        proc = launch(args)
+    try:
+        return run(pytest_extra)
+    finally:
+        if proc is not None:
+            stop(proc, args.perf_report)
+
+
+def run(pytest_extra):
     print("DOSBox-X Remote Debugging Integration Tests")
     print("=" * 50)
     print()
@@ -96,7 +174,7 @@ def main():
     ]
 
     # Add any additional arguments passed to this script
-    pytest_args.extend(sys.argv[1:])
+    pytest_args.extend(pytest_extra)
 
     # Run pytest
     return pytest.main(pytest_args)
@@ -254,6 +254,32 @@ class TestBreakpoints:
         assert result is True
         gdb.remove_breakpoint("0100:0000")
 
+    def test_hardware_breakpoint(self, gdb):
+        """Set and remove a hardware breakpoint."""
+        assert gdb.set_hw_breakpoint(0x1000) is True
+        assert gdb.remove_hw_breakpoint(0x1000) is True
+        # Already gone
+        assert gdb.remove_hw_breakpoint(0x1000) is False
+
+    def test_write_watchpoint(self, gdb):
+        """Set and remove a write watchpoint."""
+        assert gdb.set_watchpoint(0x2000, 4) is True
+        assert gdb.remove_watchpoint(0x2000, 4) is True
+        assert gdb.remove_watchpoint(0x2000, 4) is False
+
+    def test_debugger_write_does_not_trigger_watchpoint(self, gdb):
+        """Memory written by GDB itself does not stop the CPU."""
+        assert gdb.set_watchpoint(0x2000, 4) is True
+        try:
+            assert gdb.write_memory(0x2000, b"\x12\x34\x56\x78") is True
+            assert gdb.read_memory(0x2000, 4) == b"\x12\x34\x56\x78"
+        finally:
+            gdb.remove_watchpoint(0x2000, 4)
+
+    def test_read_watchpoint_unsupported(self, gdb):
+        """Read watchpoints get the empty (unsupported) reply."""
+        assert gdb._send_packet("Z3,2000,4") == ""
+
 
 # =============================================================================
 # Execution Control Tests
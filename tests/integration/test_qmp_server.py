@@ -19,6 +19,7 @@ Or with pytest:
     uv run --with pytest pytest tests/integration/test_qmp_server.py -v
 """
 
+import json
 import socket
 import sys
 import time
@@ -301,6 +302,215 @@ class TestKeyCodeCoverage:
                 pass
 
 
+# =============================================================================
+# Dynrec Profiler Tests
+# =============================================================================
+
+class TestDynrecProfile:
+    """Test the dynrec hot-block profiler commands."""
+
+    def test_profile_roundtrip(self, qmp):
+        """Profiler can be started, queried and stopped."""
+        response = qmp.dynrec_profile(enable=True, reset=True)
+        if "error" in response:
+            pytest.skip("dynrec core not available")
+        assert response["return"]["enabled"] is True
+
+        time.sleep(0.5)
+        result = qmp.query_dynrec_profile(top=5)
+        if "error" in result:
+            pytest.skip(result["error"].get("desc", "dynrec core not initialized"))
+        profile = result["return"]
+        assert "blocks" in profile
+        assert len(profile["blocks"]) <= 5
+        for key in ("exec-ns", "lookup-ns", "translate-ns", "invalidations", "invalidations-per-sec"):
+            assert key in profile
+
+        qmp.dynrec_profile(enable=False)
+
+
+# =============================================================================
+# Guest Profiler Tests
+# =============================================================================
+
+class TestGuestProfile:
+    """Test the guest CS:EIP sampling profiler."""
+
+    def test_histogram(self, qmp):
+        """Histogram entries are sorted and limited to top."""
+        response = qmp.guest_profile_start(rate=2000)
+        assert response["return"]["running"] is True
+
+        time.sleep(0.5)
+        result = qmp.guest_profile_stop(top=5)
+        profile = result["return"]
+        assert profile["samples"] > 0
+        hist = profile["histogram"]
+        assert 0 < len(hist) <= 5
+        counts = [e["count"] for e in hist]
+        assert counts == sorted(counts, reverse=True)
+        for e in hist:
+            assert e["mode"] in ("real", "v86", "ring0", "ring1", "ring2", "ring3")
+
+    def test_folded(self, qmp):
+        """Folded output adds up to the number of samples."""
+        qmp.guest_profile_start(rate=2000)
+        time.sleep(0.5)
+        profile = qmp.guest_profile_stop(format="folded")["return"]
+        lines = [l for l in profile["folded"].split("\n") if l]
+        assert lines
+        assert sum(int(l.rsplit(" ", 1)[1]) for l in lines) == profile["samples"]
+        assert all(l.count(";") == 2 for l in lines)
+
+
+# =============================================================================
+# Paging Statistics Tests
+# =============================================================================
+
+class TestTLBStats:
+    """Test the paging TLB statistics."""
+
+    def test_query(self, qmp):
+        """Flush counters are reported and never go backwards."""
+        first = qmp.query_tlb_stats()["return"]
+        assert first["flushes"] >= 0
+        assert first["flushes-per-sec"] >= 0
+        time.sleep(0.2)
+        second = qmp.query_tlb_stats()["return"]
+        assert second["flushes"] >= first["flushes"]
+
+
+class TestIOStats:
+    """Test the I/O slow path statistics."""
+
+    def test_query(self, qmp):
+        """Per-port counters add up to no more than the totals, busiest port first."""
+        stats = qmp.query_io_stats(top=5)["return"]
+        ports = stats["ports"]
+        assert len(ports) <= 5
+        assert sum(p["reads"] for p in ports) <= stats["slow-reads"]
+        assert sum(p["writes"] for p in ports) <= stats["slow-writes"]
+        totals = [p["reads"] + p["writes"] for p in ports]
+        assert totals == sorted(totals, reverse=True)
+        assert all(0 <= p["port"] < 0x10003 for p in ports)
+
+
+class TestAudioStats:
+    """Test the audio buffering statistics."""
+
+    def test_query(self, qmp):
+        """The buffer state is consistent and the counters never go backwards."""
+        first = qmp.query_audio_stats()["return"]
+        assert first["rate"] > 0
+        assert first["latency-ms"] >= 0
+        assert first["buffered"] < 16384
+        assert abs(first["rate-adjust-ppm"]) <= 2500
+        time.sleep(0.2)
+        second = qmp.query_audio_stats()["return"]
+        for key in ("underruns", "overruns", "dropped"):
+            assert second[key] >= first[key]
+
+
+class TestPerf:
+    """Test the performance counter query."""
+
+    def test_query(self, qmp):
+        """Emulation advances between two polls and the counters never go backwards."""
+        first = qmp.query_perf()["return"]
+        assert first["cycle-max"] > 0
+        assert first["pic-queue-depth"] >= 0
+        time.sleep(0.5)
+        second = qmp.query_perf()["return"]
+        assert second["interval-ms"] > 0
+        assert second["cycles"] > first["cycles"]
+        assert second["cycles-per-sec"] > 0
+        assert second["emulated-ms"] > first["emulated-ms"]
+        for key in ("frames-rendered", "frames-skipped", "audio-underruns", "tlb-flushes",
+                    "disk-bytes-read", "disk-bytes-written"):
+            assert second[key] >= first[key]
+        host = second["host-time"]
+        assert 0 <= host["other"] <= 1
+        assert all(0 <= host[k] <= 1 for k in ("cpu", "events", "vga", "render", "output", "mixer", "disk", "idle"))
+
+
+class TestFramePacing:
+    """Test the frame pacing histograms."""
+
+    def test_histograms(self, qmp):
+        """Retraces are counted into the histogram and a reset clears it."""
+        qmp.query_frame_pacing(reset=True)
+        time.sleep(0.5)
+        stats = qmp.query_frame_pacing()["return"]
+        assert stats["period-ms"] > 0
+        assert stats["retraces"] > 0
+        assert stats["missed"] <= stats["presents"]
+        interval = stats["retrace-interval"]
+        assert interval["count"] == sum(interval["buckets"])
+        assert interval["count"] >= stats["retraces"] - 1
+        assert interval["p50-ms"] <= interval["p95-ms"] <= interval["p99-ms"]
+        for name in ("present-interval", "present-latency"):
+            assert stats[name]["count"] == sum(stats[name]["buckets"])
+
+        cleared = qmp.query_frame_pacing(reset=True)["return"]
+        assert cleared["retraces"] >= stats["retraces"]
+        assert qmp.query_frame_pacing()["return"]["retraces"] < cleared["retraces"]
+
+
+class TestHostMemory:
+    """Test the host memory report."""
+
+    def test_query(self, qmp):
+        """Every subsystem is listed and guest RAM takes host memory."""
+        mem = qmp.query_host_memory()["return"]
+        subsystems = mem["subsystems"]
+        assert set(subsystems) == {"guest-ram", "tlb", "dynrec", "vga", "render", "voodoo", "mixer",
+                                   "drive-cache", "image-cache", "fonts"}
+        assert all(0 <= s["resident"] <= s["allocated"] for s in subsystems.values())
+        assert subsystems["guest-ram"]["allocated"] >= 640 * 1024
+        assert subsystems["vga"]["allocated"] > 0
+        assert mem["peak-rss"] >= mem["rss"] >= 0
+        assert set(mem["merge"]) == {"mergeable", "merging", "merged"}
+        assert mem["merge"]["merged"] >= 0
+
+
+class TestMemoryStates:
+    """Test the named in-memory save state slots."""
+
+    def test_roundtrip(self, qmp, tmp_path):
+        """A slot is listed once saved, loads again and again, persists to a file and goes away when deleted."""
+        assert "error" not in qmp.memstate_save("qmp-test")
+        slots = {s["slot"]: s["bytes"] for s in qmp.query_memstates()["return"]}
+        assert slots.get("qmp-test", 0) > 0
+        for _ in range(3):
+            assert "error" not in qmp.memstate_load("qmp-test")
+
+        state_file = tmp_path / "slot.sav"
+        assert "error" not in qmp.memstate_persist("qmp-test", str(state_file))
+        assert state_file.stat().st_size > 0
+
+        assert "error" not in qmp.memstate_delete("qmp-test")
+        assert "qmp-test" not in [s["slot"] for s in qmp.query_memstates()["return"]]
+        assert "error" in qmp.memstate_load("qmp-test")
+
+
+class TestTrace:
+    """Test the Chrome trace-event recorder."""
+
+    def test_roundtrip(self, qmp, tmp_path):
+        """A short recording is a complete trace with CPU slices on both time lines."""
+        trace_file = tmp_path / "trace.json"
+        assert "error" not in qmp.trace_start(str(trace_file))
+        time.sleep(0.5)
+        assert "error" not in qmp.trace_stop()
+        time.sleep(0.2)
+
+        events = json.loads(trace_file.read_text())["traceEvents"]
+        spans = [e for e in events if e["ph"] == "X"]
+        assert {e["pid"] for e in spans} == {1, 2}
+        assert any(e["cat"] == "cpu" for e in spans)
+        assert all(e["dur"] >= 0 for e in spans)
+
+
 # =============================================================================
 # Main entry point
 # =============================================================================
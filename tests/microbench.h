@@ -0,0 +1,124 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_TESTS_MICROBENCH_H
+#define DOSBOX_TESTS_MICROBENCH_H
+
+/* Microbenchmarks of the hot kernels. They are tests named DISABLED_Benchmark, so a plain
+ * -tests run skips them. "make microbench" runs all of them:
+ *
+ *   dosbox-x -tests --gtest_also_run_disabled_tests --gtest_filter=*.DISABLED_Benchmark -benchmark-out FILE
+ *
+ * Every kernel repeats until it ran for at least MICROBENCH_MIN_NS. With -benchmark-out the
+ * results are written in the JSON format of Google Benchmark, so its compare.py and the usual
+ * CI dashboards can track them from commit to commit. */
+
+#include "dosbox.h"
+#include "control.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define MICROBENCH_MIN_NS   200000000ull
+
+struct MicrobenchResult {
+	std::string name;
+	uint64_t iterations;
+	double real_ns;             // per iteration
+	double cpu_ns;
+	double items_per_second;    // 0 if the benchmark did not say what an item is
+	double bytes_per_second;
+};
+
+static std::vector<MicrobenchResult> microbench_results;
+
+static void MICROBENCH_WriteJSON(const std::string &path) {
+	FILE *fp = fopen(path.c_str(), "w");
+	if (fp == NULL) {
+		fprintf(stderr, "Microbench: cannot write %s\n", path.c_str());
+		return;
+	}
+
+	char date[64];
+	const time_t now = time(NULL);
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+	fprintf(fp, "{\n  \"context\": {\n");
+	fprintf(fp, "    \"date\": \"%s\",\n", date);
+	fprintf(fp, "    \"executable\": \"dosbox-x\",\n");
+	fprintf(fp, "    \"dosbox_version\": \"%s\",\n", VERSION);
+	fprintf(fp, "    \"num_cpus\": %u\n", std::thread::hardware_concurrency());
+	fprintf(fp, "  },\n  \"benchmarks\": [");
+	for (size_t i = 0;i < microbench_results.size();i++) {
+		const MicrobenchResult &r = microbench_results[i];
+		fprintf(fp, "%s\n    {\"name\": \"%s\", \"run_name\": \"%s\", \"run_type\": \"iteration\", \"repetitions\": 1, \"repetition_index\": 0, \"threads\": 1, ",
+			i ? "," : "", r.name.c_str(), r.name.c_str());
+		fprintf(fp, "\"iterations\": %llu, \"real_time\": %.3f, \"cpu_time\": %.3f, \"time_unit\": \"ns\"",
+			(unsigned long long)r.iterations, r.real_ns, r.cpu_ns);
+		if (r.items_per_second > 0) fprintf(fp, ", \"items_per_second\": %.3f", r.items_per_second);
+		if (r.bytes_per_second > 0) fprintf(fp, ", \"bytes_per_second\": %.3f", r.bytes_per_second);
+		fprintf(fp, "}");
+	}
+	fprintf(fp, "\n  ]\n}\n");
+	fclose(fp);
+}
+
+/* Times body(), one iteration of the kernel, growing the count until the run is long enough.
+ * items and bytes are what one iteration processes, for the per second rates. */
+template <typename F> static void MICROBENCH_Run(const std::string &name, double items, double bytes, F body) {
+	uint64_t iterations = 1;
+	uint64_t real_ns, cpu_ns;
+
+	for (;;) {
+		const clock_t cpu_start = clock();
+		const auto start = std::chrono::steady_clock::now();
+		for (uint64_t i = 0;i < iterations;i++) body();
+		real_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		cpu_ns = (uint64_t)((double)(clock() - cpu_start) * 1e9 / CLOCKS_PER_SEC);
+
+		if (real_ns >= MICROBENCH_MIN_NS) break;
+		/* aim a bit past the minimum so the next round is usually the last */
+		const uint64_t want = real_ns ? (uint64_t)((double)iterations * MICROBENCH_MIN_NS * 1.4 / real_ns) : iterations * 100;
+		iterations = std::max(iterations * 2, std::min(want, iterations * 100));
+	}
+
+	MicrobenchResult r;
+	r.name = name;
+	r.iterations = iterations;
+	r.real_ns = (double)real_ns / iterations;
+	r.cpu_ns = (double)cpu_ns / iterations;
+	r.items_per_second = items > 0 ? items * 1e9 / r.real_ns : 0;
+	r.bytes_per_second = bytes > 0 ? bytes * 1e9 / r.real_ns : 0;
+	microbench_results.push_back(r);
+
+	if (r.bytes_per_second > 0)
+		printf("%-40s %12.1f ns %10llu iterations %10.1f MB/s\n", name.c_str(), r.real_ns, (unsigned long long)iterations, r.bytes_per_second / 1e6);
+	else
+		printf("%-40s %12.1f ns %10llu iterations\n", name.c_str(), r.real_ns, (unsigned long long)iterations);
+
+	/* rewritten after every result, there is no hook at the end of the test run */
+	if (!control->opt_benchmark_out.empty())
+		MICROBENCH_WriteJSON(control->opt_benchmark_out);
+}
+
+#endif
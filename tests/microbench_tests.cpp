@@ -0,0 +1,372 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Microbenchmarks of the hot kernels, see microbench.h. They run inside the emulator after
+ * it started, so the kernels see the same tables and settings as in real use. Whatever global
+ * state a benchmark needs is saved and put back afterwards. */
+
+#include "dosbox.h"
+#include "cross.h"
+#include "render.h"
+#include "vga.h"
+#include "mixer.h"
+#include "bios_disk.h"
+#include "../src/dos/drives.h"
+#include "../src/hardware/dbopl.h"
+#include "../src/hardware/nukedopl.h"
+#if (C_SSHOT)
+#include <zlib.h>
+#include "../src/libs/zmbv/zmbv.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#if defined(WIN32)
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <gtest/gtest.h>
+
+#include "microbench.h"
+
+namespace {
+
+/* scratch directory for the host file benchmarks */
+std::string microbench_tempdir(void)
+{
+#if defined(WIN32)
+	const char *base = getenv("TEMP");
+#else
+	const char *base = getenv("TMPDIR");
+#endif
+	std::string dir = std::string(base != NULL && *base ? base : ".") + CROSS_FILESPLIT + "dbxbench";
+	Cross::CreateDir(dir);
+	return dir + CROSS_FILESPLIT;
+}
+
+void microbench_removedir(const std::string &dir)
+{
+	std::string path = dir;
+	if (!path.empty() && path.back() == CROSS_FILESPLIT) path.pop_back();
+#if defined(WIN32)
+	_rmdir(path.c_str());
+#else
+	rmdir(path.c_str());
+#endif
+}
+
+/* A frame through a simple scaler, with every line changed: two source frames take turns, so
+ * the scaler finds a difference to its cache on every line, as while a game scrolls. */
+void microbench_scaler(const char *name, ScalerSimpleBlock_t &block, unsigned int inIndex, Bitu inBytes, Bitu width, Bitu height)
+{
+	ScalerLineHandler_t handler = block.Linear[inIndex][3/*32bpp out*/];
+	if (handler == NULL) return;
+
+	const Bitu inPitch = width * inBytes;
+	const Bitu outPitch = width * block.xscale * 4;
+	std::vector<uint8_t> frames[2], cache(inPitch * height), out(outPitch * height * block.yscale + outPitch);
+	for (unsigned int f = 0;f < 2;f++) {
+		frames[f].resize(inPitch * height);
+		for (size_t i = 0;i < frames[f].size();i++) frames[f][i] = (uint8_t)((i * 7u) + f * 0x55u);
+	}
+
+	const auto saved_scale = render.scale;
+	const auto saved_src = render.src;
+	const Bitu saved_index = Scaler_ChangedLineIndex;
+
+	render.src.width = width;
+	render.scale.outPitch = outPitch;
+	render.scale.cachePitch = inPitch;
+	unsigned int frame = 0;
+
+	MICROBENCH_Run(std::string("Scaler/") + name + "/" + std::to_string((unsigned long long)width) + "x" + std::to_string((unsigned long long)height) + "x" + std::to_string((unsigned long long)(inBytes * 8)),
+		(double)(width * height), (double)(inPitch * height), [&]() {
+		const uint8_t *src = frames[frame++ & 1].data();
+		render.scale.cacheRead = cache.data();
+		render.scale.outWrite = out.data();
+		render.scale.outLine = 0;
+		Scaler_ChangedLines[0] = 0;
+		Scaler_ChangedLineIndex = 0;
+		for (Bitu y = 0;y < height;y++)
+			handler(src + y * inPitch);
+	});
+
+	render.scale = saved_scale;
+	render.src = saved_src;
+	Scaler_ChangedLineIndex = saved_index;
+}
+
+TEST(RenderScaler, DISABLED_Benchmark)
+{
+	/* 320x200 256 colors and 640x480 true color, the usual DOS game and Windows cases */
+	microbench_scaler("normal1x", ScaleNormal1x, 0, 1, 320, 200);
+	microbench_scaler("normal2x", ScaleNormal2x, 0, 1, 320, 200);
+	microbench_scaler("normal3x", ScaleNormal3x, 0, 1, 320, 200);
+	microbench_scaler("tv2x", ScaleTV2x, 0, 1, 320, 200);
+	microbench_scaler("scan2x", ScaleScan2x, 0, 1, 320, 200);
+	microbench_scaler("rgb2x", ScaleRGB2x, 0, 1, 320, 200);
+	microbench_scaler("normal1x", ScaleNormal1x, 3, 4, 640, 480);
+	microbench_scaler("normal2x", ScaleNormal2x, 3, 4, 640, 480);
+}
+
+/* 480 lines of a 640 pixel mode through a VGA line drawer, from VGA memory */
+void microbench_vgadraw(const char *name, Bitu line_length, Bitu stride)
+{
+	VGA_Line_Handler drawer = VGA_GetLineDrawer(name);
+	ASSERT_TRUE(drawer != NULL) << name;
+
+	/* not all of vga.draw, it holds the 516KB font */
+	uint8_t * const saved_base = vga.draw.linear_base;
+	const Bitu saved_mask = vga.draw.linear_mask, saved_length = vga.draw.line_length;
+	const Bitu saved_width = vga.draw.width, saved_blocks = vga.draw.blocks, saved_panning = vga.draw.panning;
+	const uint8_t saved_addr_shift = vga.config.addr_shift;
+	const uint8_t saved_line_mask = vga.tandy.line_mask;
+
+	vga.draw.linear_base = vga.mem.linear;
+	vga.draw.linear_mask = vga.mem.memmask;
+	vga.draw.line_length = line_length;
+	vga.draw.width = 640;
+	vga.draw.blocks = 640 / 8;
+	vga.draw.panning = 0;
+	vga.config.addr_shift = 0;
+	vga.tandy.line_mask = 0;
+
+	uint32_t sum = 0;
+	MICROBENCH_Run(std::string("VGADraw/") + name, 640.0 * 480, 0, [&]() {
+		for (Bitu y = 0;y < 480;y++)
+			sum += drawer(y * stride, 0)[y & 63];
+	});
+	printf("(checksum %08x)\n", (unsigned int)sum);
+
+	vga.draw.linear_base = saved_base;
+	vga.draw.linear_mask = saved_mask;
+	vga.draw.line_length = saved_length;
+	vga.draw.width = saved_width;
+	vga.draw.blocks = saved_blocks;
+	vga.draw.panning = saved_panning;
+	vga.config.addr_shift = saved_addr_shift;
+	vga.tandy.line_mask = saved_line_mask;
+}
+
+TEST(VGADraw, DISABLED_Benchmark)
+{
+	microbench_vgadraw("linear", 640, 640);
+	microbench_vgadraw("indexed_linear", 640, 640);
+	microbench_vgadraw("xlat32_linear", 640 * 4, 640);
+	microbench_vgadraw("planar_xlat32", 640 * 4, 640 / 2);
+	microbench_vgadraw("packed4_xlat32", 640 * 4, 640 / 2);
+}
+
+void microbench_mixer_handler(Bitu /*len*/)
+{
+}
+
+/* Sample load and rate conversion of one channel, the per channel part of the mixer */
+TEST(MixerChannel, DISABLED_Benchmark)
+{
+	const Bitu frames = 256; // less than a ms of output at any mixer rate, msbuffer holds it
+	std::vector<int16_t> samples(frames * 2);
+	for (Bitu i = 0;i < samples.size();i++) samples[i] = (int16_t)((i * 2654435761u) >> 16);
+
+	MixerChannel *chan = MIXER_AddChannel(microbench_mixer_handler, 22050, "BENCH");
+	ASSERT_TRUE(chan != NULL);
+
+	if (chan->sinc != nullptr) {
+		MICROBENCH_Run("Mixer/AddSamples_s16/22050/sinc", (double)frames, 0, [&]() {
+			chan->msbuffer_o = 0;
+			chan->AddSamples_s16(frames, samples.data());
+		});
+	}
+
+	chan->sinc = nullptr;
+	MICROBENCH_Run("Mixer/AddSamples_s16/22050/linear", (double)frames, 0, [&]() {
+		chan->msbuffer_o = 0;
+		chan->AddSamples_s16(frames, samples.data());
+	});
+	MICROBENCH_Run("Mixer/AddSamples_m8/22050/linear", (double)frames, 0, [&]() {
+		chan->msbuffer_o = 0;
+		chan->AddSamples_m8(frames, (const uint8_t*)samples.data());
+	});
+
+	MIXER_DelChannel(chan);
+}
+
+/* all nine melodic channels playing a note */
+template <typename W> void microbench_opl_notes(W write, bool opl3)
+{
+	static const uint8_t modulator[9] = { 0x00, 0x01, 0x02, 0x08, 0x09, 0x0a, 0x10, 0x11, 0x12 };
+
+	write(0x01, 0x20);
+	if (opl3) write(0x105, 0x01);
+	for (unsigned int ch = 0;ch < 9;ch++) {
+		for (unsigned int op = 0;op < 2;op++) {
+			const unsigned int slot = modulator[ch] + op * 3u;
+			write(0x20 + slot, 0x21);
+			write(0x40 + slot, op ? 0x00 : 0x18);
+			write(0x60 + slot, 0xf4);
+			write(0x80 + slot, 0x57);
+			write(0xe0 + slot, ch & 3);
+		}
+		write(0xc0 + ch, 0x3e);
+		write(0xa0 + ch, 0x40 + ch * 0x10);
+		write(0xb0 + ch, 0x31);
+	}
+}
+
+TEST(DBOPL, DISABLED_Benchmark)
+{
+	const Bitu samples = 512;
+	std::vector<int32_t> buf(samples * 2);
+
+	for (unsigned int opl3 = 0;opl3 < 2;opl3++) {
+		DBOPL::Handler handler(opl3 != 0);
+		handler.Init(49716);
+		microbench_opl_notes([&](uint32_t reg, uint8_t val) { handler.WriteReg(reg, val); }, opl3 != 0);
+
+		MICROBENCH_Run(opl3 ? "OPL/dbopl/opl3" : "OPL/dbopl/opl2", (double)samples, 0, [&]() {
+			handler.Render(buf.data(), samples);
+		});
+	}
+}
+
+TEST(NukedOPL, DISABLED_Benchmark)
+{
+	const uint32_t samples = 512;
+	std::vector<int16_t> buf(samples * 2);
+	opl3_chip *chip = new opl3_chip();
+
+	OPL3_Reset(chip, 49716);
+	microbench_opl_notes([&](uint32_t reg, uint8_t val) { OPL3_WriteReg(chip, (uint16_t)reg, val); }, true);
+	MICROBENCH_Run("OPL/nuked/opl3", (double)samples, 0, [&]() {
+		OPL3_GenerateStream(chip, buf.data(), samples);
+	});
+
+	delete chip;
+}
+
+#if (C_SSHOT)
+/* 640x480 256 colors, the picture scrolls down a line per frame like a game would */
+TEST(ZMBV, DISABLED_Benchmark)
+{
+	const int width = 640, height = 480, extra = 64;
+	std::vector<uint8_t> picture((size_t)width * (height + extra));
+	for (size_t i = 0;i < picture.size();i++)
+		picture[i] = (uint8_t)(((i % width) / 16) ^ ((i / width) / 8) ^ ((i * 31u) >> 9));
+	char pal[256 * 4];
+	for (unsigned int i = 0;i < sizeof(pal);i++) pal[i] = (char)i;
+
+	VideoCodec codec;
+	ASSERT_TRUE(codec.SetupCompress(width, height));
+	std::vector<uint8_t> out((size_t)codec.NeededSize(width, height, ZMBV_FORMAT_8BPP));
+
+	for (int keyframes = 1;keyframes >= 0;keyframes--) {
+		unsigned int frame = 0;
+		int written = 0;
+
+		MICROBENCH_Run(keyframes ? "ZMBV/keyframe/640x480x8" : "ZMBV/delta/640x480x8", 1, (double)(width * height), [&]() {
+			ASSERT_TRUE(codec.PrepareCompressFrame((keyframes || frame == 0) ? 1 : 0, ZMBV_FORMAT_8BPP, pal, out.data(), (int)out.size()));
+			const uint8_t *top = picture.data() + (size_t)width * (extra - 1 - (frame++ % extra));
+			for (int y = 0;y < height;y++) {
+				void *line = (void*)(top + (size_t)y * width);
+				codec.CompressLines(1, &line);
+			}
+			written = codec.FinishCompressFrame();
+		});
+		EXPECT_GT(written, 0);
+	}
+}
+#endif
+
+/* Name lookups in a large host directory through the directory cache of a local drive */
+TEST(DriveCache, DISABLED_Benchmark)
+{
+	const unsigned int files = 4096;
+	const std::string dir = microbench_tempdir();
+	std::vector<std::string> shortnames, longnames;
+	char tmp[64];
+
+	for (unsigned int i = 0;i < files;i++) {
+		snprintf(tmp, sizeof(tmp), "F%07u.TXT", i);
+		shortnames.push_back(tmp);
+		snprintf(tmp, sizeof(tmp), "Long file name %u.txt", i);
+		longnames.push_back(tmp);
+		for (const std::string &name : { shortnames.back(), longnames.back() }) {
+			FILE *fp = fopen((dir + name).c_str(), "wb");
+			ASSERT_TRUE(fp != NULL) << dir + name;
+			fclose(fp);
+		}
+	}
+
+	std::vector<std::string> options;
+	localDrive *drive = new localDrive(dir.c_str(), 512, 32, 32765, 16000, 0xF8, options);
+	char sysName[CROSS_LEN];
+	unsigned int n = 0;
+
+	/* the first lookup fills the cache, that is not what is measured */
+	ASSERT_TRUE(drive->GetSystemFilename(sysName, shortnames[0].c_str()));
+	MICROBENCH_Run("DriveCache/lookup/short", 1, 0, [&]() {
+		drive->GetSystemFilename(sysName, shortnames[(n++ * 2654435761u) % files].c_str());
+	});
+	MICROBENCH_Run("DriveCache/lookup/long", 1, 0, [&]() {
+		drive->GetSystemFilename(sysName, longnames[(n++ * 2654435761u) % files].c_str());
+	});
+	delete drive;
+
+	for (unsigned int i = 0;i < files;i++) {
+		remove((dir + shortnames[i]).c_str());
+		remove((dir + longnames[i]).c_str());
+	}
+	microbench_removedir(dir);
+}
+
+/* Sector reads from a raw hard disk image, the host file is in the page cache after the first round */
+TEST(ImageDisk, DISABLED_Benchmark)
+{
+	const uint32_t cylinders = 16, heads = 16, sectors = 64, sector_size = 512;
+	const uint32_t total = cylinders * heads * sectors;
+	const std::string dir = microbench_tempdir();
+	const std::string path = dir + "bench.img";
+
+	FILE *fp = fopen(path.c_str(), "wb+");
+	ASSERT_TRUE(fp != NULL) << path;
+	std::vector<uint8_t> buf(sector_size * 16, 0x5A);
+	for (uint32_t s = 0;s < total;s += 16)
+		ASSERT_EQ(1u, fwrite(buf.data(), buf.size(), 1, fp));
+
+	imageDisk *disk = new imageDisk(fp, path.c_str(), cylinders, heads, sectors, sector_size, true);
+	disk->Addref();
+	uint32_t lba = 0;
+
+	MICROBENCH_Run("ImageDisk/read/sequential/16", 16, (double)buf.size(), [&]() {
+		disk->Read_AbsoluteSectors(lba, 16, buf.data());
+		lba = (lba + 16) % total;
+	});
+	MICROBENCH_Run("ImageDisk/read/random/1", 1, (double)sector_size, [&]() {
+		disk->Read_AbsoluteSector((lba++ * 2654435761u) % total, buf.data());
+	});
+
+	disk->Release(); // closes fp
+	remove(path.c_str());
+	microbench_removedir(dir);
+}
+
+} // namespace
@@ -0,0 +1,79 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "dosbox.h"
+#include "render.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "microbench.h"
+
+namespace {
+
+const char *cachehit_names[] = { "c", "sse2", "avx2", "neon" };
+
+TEST(RenderCacheHit, VariantsAgreeWithC)
+{
+	RENDER_CacheHitHandler_t ref = RENDER_GetCacheHit("c");
+	ASSERT_TRUE(ref != NULL);
+
+	for (const char *name : cachehit_names) {
+		RENDER_CacheHitHandler_t hit = RENDER_GetCacheHit(name);
+		if (hit == NULL) continue;
+
+		/* every length up to a few SIMD rounds, so that the C tail gets exercised too */
+		for (Bits count = 0;count < 70;count++) {
+			std::vector<Bitu> src((size_t)count + 1), cache((size_t)count + 1);
+			for (Bits i = 0;i < count;i++)
+				src[(size_t)i] = cache[(size_t)i] = (Bitu)(i * 0x9E3779B9u);
+			/* past the end, must be ignored */
+			cache[(size_t)count] = ~src[(size_t)count];
+
+			EXPECT_TRUE(hit(src.data(), cache.data(), count)) << name << " count " << count;
+			for (Bits i = 0;i < count;i++) {
+				cache[(size_t)i] ^= 1;
+				EXPECT_FALSE(hit(src.data(), cache.data(), count)) << name << " count " << count << " diff at " << i;
+				EXPECT_EQ(ref(src.data(), cache.data(), count), hit(src.data(), cache.data(), count));
+				cache[(size_t)i] ^= 1;
+			}
+		}
+	}
+}
+
+/* Microbenchmark, see microbench.h */
+TEST(RenderCacheHit, DISABLED_Benchmark)
+{
+	/* one unchanged 800x600 32bpp scanline */
+	const Bits count = (Bits)((800 * 4) / sizeof(Bitu));
+	std::vector<Bitu> src((size_t)count, 0x12345678u), cache((size_t)count, 0x12345678u);
+
+	for (const char *name : cachehit_names) {
+		RENDER_CacheHitHandler_t hit = RENDER_GetCacheHit(name);
+		if (hit == NULL) continue;
+
+		uint64_t misses = 0;
+		MICROBENCH_Run(std::string("RenderCacheHit/") + name + "/800x32", 1, 800.0 * 4, [&]() {
+			if (!hit(src.data(), cache.data(), count)) misses++;
+		});
+		EXPECT_EQ(0u, misses);
+	}
+}
+
+} // namespace
@@ -23,6 +23,8 @@
 
 #include "dos_files_tests.cpp"
 #include "drives_tests.cpp"
+#include "microbench_tests.cpp"
+#include "render_cachehit_tests.cpp"
 #include "shell_cmds_tests.cpp"
 #include "shell_redirection_tests.cpp"
 
@@ -155,6 +155,8 @@
 #ifdef C_SDL2
 /* Define to 1 to enable gamelink support (needs SDL2) */
 #define C_GAMELINK 1
+/* Define to 1 to enable the Direct3D 11 output (needs SDL2) */
+#define C_DIRECT3D11 1
 #endif
 
 /* Set to 1 to enable XBRZ support */
@@ -171,6 +173,9 @@
 /* Define to 1 to enable screenshots, requires libpng */
 #define C_SSHOT 1
 
+/* Define to 1 to allocate the paging TLB on demand instead of as flat 1M entry arrays */
+#undef C_SPARSE_TLB
+
 /* Define to 1 to use a unaligned memory access */
 #define C_UNALIGNED_MEMORY		1
 